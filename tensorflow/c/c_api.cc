@@ -44,8 +44,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -2281,44 +2284,124 @@ static bool ExtendSessionGraphHelper(TF_Session* session, TF_Status* status) {
   return true;
 }
 
-void TF_SessionRun(TF_Session* session, const TF_Buffer* run_options,
-                   const TF_Output* inputs, TF_Tensor* const* input_values,
-                   int ninputs, const TF_Output* outputs,
-                   TF_Tensor** output_values, int noutputs,
-                   const TF_Operation* const* target_opers, int ntargets,
-                   TF_Buffer* run_metadata, TF_Status* status) {
+}  // end extern "C"
+
+namespace {
+
+// The feeds, fetches and targets of a TF_SessionRun call, converted to the
+// form expected by Session::Run.
+struct SessionRunArgs {
+  std::vector<std::pair<tensorflow::string, Tensor>> input_pairs;
+  std::vector<tensorflow::string> output_names;
+  std::vector<tensorflow::string> target_names;
+};
+
+bool TF_SessionRun_Setup(TF_Session* session, const TF_Output* inputs,
+                         TF_Tensor* const* input_values, int ninputs,
+                         const TF_Output* outputs, TF_Tensor** output_values,
+                         int noutputs, const TF_Operation* const* target_opers,
+                         int ntargets, SessionRunArgs* args,
+                         TF_Status* status) {
   // TODO(josh11b,mrry): Change Session to be able to use a Graph*
   // directly, instead of requiring us to serialize to a GraphDef and
   // call Session::Extend().
   if (!ExtendSessionGraphHelper(session, status)) {
-    return;
+    return false;
   }
 
   TF_Run_Setup(noutputs, output_values, status);
 
   // Convert from TF_Output and TF_Tensor to a string and Tensor.
-  std::vector<std::pair<tensorflow::string, Tensor>> input_pairs(ninputs);
-  if (!TF_Run_Inputs(input_values, &input_pairs, status)) return;
+  args->input_pairs.resize(ninputs);
+  if (!TF_Run_Inputs(input_values, &args->input_pairs, status)) return false;
   for (int i = 0; i < ninputs; ++i) {
-    input_pairs[i].first = OutputName(inputs[i]);
+    args->input_pairs[i].first = OutputName(inputs[i]);
   }
 
   // Convert from TF_Output to string names.
-  std::vector<tensorflow::string> output_names(noutputs);
+  args->output_names.resize(noutputs);
   for (int i = 0; i < noutputs; ++i) {
-    output_names[i] = OutputName(outputs[i]);
+    args->output_names[i] = OutputName(outputs[i]);
   }
 
   // Convert from TF_Operation* to string names.
-  std::vector<tensorflow::string> target_names(ntargets);
+  args->target_names.resize(ntargets);
   for (int i = 0; i < ntargets; ++i) {
-    target_names[i] = target_opers[i]->node.name();
+    args->target_names[i] = target_opers[i]->node.name();
+  }
+  return true;
+}
+
+// Runs the closures of TF_SessionRunAsync. Never deleted, as runs may still be
+// in flight at exit.
+tensorflow::thread::ThreadPool* AsyncRunThreadPool() {
+  static tensorflow::thread::ThreadPool* pool =
+      new tensorflow::thread::ThreadPool(
+          tensorflow::Env::Default(), "tf_c_api_session_run",
+          std::max(tensorflow::port::NumSchedulableCPUs(), 2));
+  return pool;
+}
+
+}  // namespace
+
+extern "C" {
+
+void TF_SessionRun(TF_Session* session, const TF_Buffer* run_options,
+                   const TF_Output* inputs, TF_Tensor* const* input_values,
+                   int ninputs, const TF_Output* outputs,
+                   TF_Tensor** output_values, int noutputs,
+                   const TF_Operation* const* target_opers, int ntargets,
+                   TF_Buffer* run_metadata, TF_Status* status) {
+  SessionRunArgs args;
+  if (!TF_SessionRun_Setup(session, inputs, input_values, ninputs, outputs,
+                           output_values, noutputs, target_opers, ntargets,
+                           &args, status)) {
+    return;
   }
 
   // Actually run.
-  TF_Run_Helper(session->session, nullptr, run_options, input_pairs,
-                output_names, output_values, target_names, run_metadata,
-                status);
+  TF_Run_Helper(session->session, nullptr, run_options, args.input_pairs,
+                args.output_names, output_values, args.target_names,
+                run_metadata, status);
+}
+
+void TF_SessionRunAsync(TF_Session* session, const TF_Buffer* run_options,
+                        const TF_Output* inputs,
+                        TF_Tensor* const* input_values, int ninputs,
+                        const TF_Output* outputs, TF_Tensor** output_values,
+                        int noutputs, const TF_Operation* const* target_opers,
+                        int ntargets, TF_Buffer* run_metadata,
+                        TF_Status* status, void (*done)(void* done_arg),
+                        void* done_arg) {
+  auto args = std::make_shared<SessionRunArgs>();
+  if (!TF_SessionRun_Setup(session, inputs, input_values, ninputs, outputs,
+                           output_values, noutputs, target_opers, ntargets,
+                           args.get(), status)) {
+    done(done_arg);
+    return;
+  }
+
+  // Copy the options so that the caller may release them right away.
+  auto options = std::make_shared<tensorflow::string>();
+  if (run_options != nullptr) {
+    options->assign(static_cast<const char*>(run_options->data),
+                    run_options->length);
+  }
+  const bool has_options = run_options != nullptr;
+
+  Session* const s = session->session;
+  AsyncRunThreadPool()->Schedule([s, args, options, has_options,
+                                  output_values, run_metadata, status, done,
+                                  done_arg]() {
+    TF_Buffer options_buffer;
+    options_buffer.data = options->data();
+    options_buffer.length = options->size();
+    options_buffer.data_deallocator = nullptr;
+    TF_Run_Helper(s, nullptr, has_options ? &options_buffer : nullptr,
+                  args->input_pairs, args->output_names, output_values,
+                  args->target_names, run_metadata, status);
+    done(done_arg);
+  });
 }
 
 void TF_SessionPRunSetup(TF_Session* session, const TF_Output* inputs,
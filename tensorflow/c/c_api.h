@@ -223,6 +223,13 @@ typedef struct TF_Tensor TF_Tensor;
 //      (*deallocator)(data, len, deallocator_arg)
 // Clients must provide a custom deallocator function so they can pass in
 // memory managed by something like numpy.
+//
+// If `data` satisfies TensorFlow's alignment requirements (memory returned by
+// TF_AllocateTensor always does; 64-byte aligned memory does on all
+// platforms), the tensor refers to `data` directly and no copy is made,
+// including when it is fed to or fetched from a session. Otherwise the
+// contents are copied into a newly allocated aligned buffer and `deallocator`
+// is called on `data` before TF_NewTensor returns.
 TF_CAPI_EXPORT extern TF_Tensor* TF_NewTensor(
     TF_DataType, const int64_t* dims, int num_dims, void* data, size_t len,
     void (*deallocator)(void* data, size_t len, void* arg),
@@ -237,6 +244,12 @@ TF_CAPI_EXPORT extern TF_Tensor* TF_NewTensor(
 //
 // The caller must set the Tensor values by writing them to the pointer returned
 // by TF_TensorData with length TF_TensorByteSize.
+//
+// Tensors of any type other than TF_STRING are exchanged with sessions
+// without copying: TF_SessionRun feeds them by sharing their buffer, and the
+// non-string tensors it returns share the buffer the graph produced. TF_STRING
+// tensors are always copied, as their encoding differs from the one used by
+// TensorFlow internally.
 TF_CAPI_EXPORT extern TF_Tensor* TF_AllocateTensor(TF_DataType,
                                                    const int64_t* dims,
                                                    int num_dims, size_t len);
@@ -1093,6 +1106,40 @@ TF_CAPI_EXPORT extern void TF_SessionRun(
     // Output status
     TF_Status*);
 
+// Asynchronous version of TF_SessionRun. Starts running the graph and returns
+// immediately; `done(done_arg)` is called exactly once when the run has
+// finished, at which point `output_values`, `run_metadata` and the status are
+// set as by TF_SessionRun. `done` is called from a thread owned by the C API,
+// or from the calling thread if the run fails before it is started.
+//
+// The feeds, fetches, targets, `input_values` and `run_options` are consumed
+// before TF_SessionRunAsync returns, so the caller may release them right
+// away; non-string `input_values` stay alive through their shared buffers for
+// as long as the run needs them. `output_values`, `run_metadata` and the
+// status must remain valid until `done` is called, and the session must not be
+// closed or deleted before then.
+//
+// Runs are executed by a process-wide pool with one thread per schedulable
+// CPU, so many runs can be in flight without one caller thread each. Runs
+// beyond the pool size are queued, which means that a run blocking on another
+// run (e.g. through a queue op) can deadlock if it occupies every thread.
+TF_CAPI_EXPORT extern void TF_SessionRunAsync(
+    TF_Session* session,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input tensors
+    const TF_Output* inputs, TF_Tensor* const* input_values, int ninputs,
+    // Output tensors
+    const TF_Output* outputs, TF_Tensor** output_values, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*,
+    // Completion callback
+    void (*done)(void* done_arg), void* done_arg);
+
 // Set up the graph with the intended feeds (inputs) and fetches (outputs) for a
 // sequence of partial run calls.
 //
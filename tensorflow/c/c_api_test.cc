@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/util/equal_graph_def.h"
@@ -46,6 +47,7 @@ using tensorflow::int32;
 using tensorflow::string;
 using tensorflow::GraphDef;
 using tensorflow::NodeDef;
+using tensorflow::Notification;
 using tensorflow::Tensor;
 using tensorflow::TensorShape;
 
@@ -1047,6 +1049,67 @@ TEST(CAPI, Session) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionRunAsync) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // Start several runs at once, releasing the inputs immediately.
+  const int kNumRuns = 8;
+  std::vector<TF_Tensor*> outputs(kNumRuns, nullptr);
+  std::vector<TF_Status*> statuses(kNumRuns);
+  std::vector<Notification> done(kNumRuns);
+  auto notify = [](void* arg) { static_cast<Notification*>(arg)->Notify(); };
+  TF_Output input{feed, 0};
+  TF_Output output{add, 0};
+  for (int i = 0; i < kNumRuns; ++i) {
+    statuses[i] = TF_NewStatus();
+    TF_Tensor* value = Int32Tensor(i);
+    TF_SessionRunAsync(session, nullptr, &input, &value, 1, &output,
+                       &outputs[i], 1, nullptr, 0, nullptr, statuses[i],
+                       notify, &done[i]);
+    TF_DeleteTensor(value);
+  }
+  for (int i = 0; i < kNumRuns; ++i) {
+    done[i].WaitForNotification();
+    ASSERT_EQ(TF_OK, TF_GetCode(statuses[i])) << TF_Message(statuses[i]);
+    ASSERT_TRUE(outputs[i] != nullptr);
+    EXPECT_EQ(TF_INT32, TF_TensorType(outputs[i]));
+    EXPECT_EQ(i + 2, *static_cast<int32*>(TF_TensorData(outputs[i])));
+    TF_DeleteTensor(outputs[i]);
+    TF_DeleteStatus(statuses[i]);
+  }
+
+  // Errors are reported through the status and still call `done`.
+  TF_Status* run_status = TF_NewStatus();
+  TF_Tensor* out = nullptr;
+  Notification failed;
+  TF_SessionRunAsync(session, nullptr, nullptr, nullptr, 0, &output, &out, 1,
+                     nullptr, 0, nullptr, run_status, notify, &failed);
+  failed.WaitForNotification();
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(run_status));
+  EXPECT_EQ(nullptr, out);
+  TF_DeleteStatus(run_status);
+
+  TF_CloseSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, SessionPRun) {
   TF_Status* s = TF_NewStatus();
   TF_Graph* graph = TF_NewGraph();
@@ -45,6 +45,11 @@ constexpr char kSavedModelVariablesDirectory[] = "variables";
 /// SavedModel variables filename.
 constexpr char kSavedModelVariablesFilename[] = "variables";
 
+/// Name of the file in the assets.extra directory that holds the warmup
+/// requests.  It is a TFRecord file of serialized RunStepRequest protos, each
+/// of which is run once at load time.
+constexpr char kSavedModelWarmupRequestsFilename[] = "tf_warmup_requests";
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CC_SAVED_MODEL_CONSTANTS_H_
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -43,6 +47,10 @@ auto* load_latency = monitoring::Counter<1>::New(
 constexpr char kLoadAttemptFail[] = "fail";
 constexpr char kLoadAttemptSuccess[] = "success";
 
+// Upper bound on the number of warmup requests replayed at load time, so that
+// a large warmup file cannot delay the load indefinitely.
+constexpr int kMaxWarmupRequests = 1000;
+
 Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -116,20 +124,10 @@ void AddAssetsTensorsToInputs(const StringPiece export_dir,
   }
 }
 
-bool HasMainOp(const MetaGraphDef& meta_graph_def) {
-  const auto& collection_def_map = meta_graph_def.collection_def();
-  if (collection_def_map.find(kSavedModelMainOpKey) !=
-      collection_def_map.end()) {
-    return true;
-  }
-  return false;
-}
-
-Status RunMainOp(const RunOptions& run_options, const string& export_dir,
-                 const MetaGraphDef& meta_graph_def,
-                 const std::vector<AssetFileDef>& asset_file_defs,
-                 Session* session) {
-  LOG(INFO) << "Running MainOp on SavedModel bundle.";
+// Sets *init_op_name to the main op of the meta graph if it has one, and else
+// to its legacy init op.  Leaves it empty if the meta graph has neither.
+Status GetInitOp(const string& export_dir, const MetaGraphDef& meta_graph_def,
+                 string* init_op_name) {
   const auto& collection_def_map = meta_graph_def.collection_def();
   const auto main_op_it = collection_def_map.find(kSavedModelMainOpKey);
   if (main_op_it != collection_def_map.end()) {
@@ -137,22 +135,90 @@ Status RunMainOp(const RunOptions& run_options, const string& export_dir,
       return errors::FailedPrecondition(
           strings::StrCat("Expected exactly one main op in : ", export_dir));
     }
-    std::vector<std::pair<string, Tensor>> inputs;
-    AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
-    RunMetadata run_metadata;
-    const StringPiece main_op_name = main_op_it->second.node_list().value(0);
-    return session->Run(run_options, inputs, {}, {main_op_name.ToString()},
-                        nullptr /* outputs */, &run_metadata);
+    *init_op_name = main_op_it->second.node_list().value(0);
+    return Status::OK();
+  }
+  const auto init_op_it = collection_def_map.find(kSavedModelLegacyInitOpKey);
+  if (init_op_it != collection_def_map.end()) {
+    if (init_op_it->second.node_list().value_size() != 1) {
+      return errors::FailedPrecondition(strings::StrCat(
+          "Expected exactly one serving init op in : ", export_dir));
+    }
+    *init_op_name = init_op_it->second.node_list().value(0);
   }
   return Status::OK();
 }
 
+// Returns the names of the nodes that 'target' transitively depends on,
+// through data and control edges, including 'target' itself.
+std::unordered_set<string> GetAncestors(
+    const std::unordered_map<string, const NodeDef*>& nodes,
+    const string& target) {
+  std::unordered_set<string> visited;
+  std::vector<string> stack = {ParseTensorName(target).first.ToString()};
+  while (!stack.empty()) {
+    const string name = stack.back();
+    stack.pop_back();
+    if (!visited.insert(name).second) continue;
+    const auto it = nodes.find(name);
+    if (it == nodes.end()) continue;
+    for (const string& input : it->second->input()) {
+      stack.push_back(ParseTensorName(input).first.ToString());
+    }
+  }
+  return visited;
+}
+
+// Returns true if the init op can run in the same step as the restore op,
+// i.e. if it does not depend on any of the variables that the restore op
+// assigns, so that it cannot observe them before they are restored or
+// overwrite them.  The variables touched by the restore op are the reference
+// and resource variables among its ancestors.
+bool CanInitConcurrentlyWithRestore(const GraphDef& graph_def,
+                                    const string& restore_op_name,
+                                    const string& init_op_name) {
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes[node.name()] = &node;
+  }
+  // Functions may capture variables without naming them as inputs.
+  if (graph_def.library().function_size() > 0) return false;
+  const std::unordered_set<string> restore_ancestors =
+      GetAncestors(nodes, restore_op_name);
+  for (const string& name : GetAncestors(nodes, init_op_name)) {
+    const auto it = nodes.find(name);
+    if (it == nodes.end()) continue;
+    const string& op = it->second->op();
+    if ((op == "Variable" || op == "VariableV2" || op == "VarHandleOp") &&
+        restore_ancestors.count(name) > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status RunInitOp(const RunOptions& run_options, const string& export_dir,
+                 const string& init_op_name,
+                 const std::vector<AssetFileDef>& asset_file_defs,
+                 Session* session) {
+  LOG(INFO) << "Running " << init_op_name << " on SavedModel bundle.";
+  std::vector<std::pair<string, Tensor>> inputs;
+  AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
+  RunMetadata run_metadata;
+  return session->Run(run_options, inputs, {}, {init_op_name},
+                      nullptr /* outputs */, &run_metadata);
+}
+
+// Runs the restore op.  If 'concurrent_init_op_name' is not empty, it is run
+// in the same step, and *ran_init_op is set to true.
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
                   const StringPiece restore_op_name,
                   const StringPiece variable_filename_const_op_name,
                   const std::vector<AssetFileDef>& asset_file_defs,
-                  Session* session) {
+                  const string& concurrent_init_op_name, Session* session,
+                  bool* ran_init_op) {
   LOG(INFO) << "Restoring SavedModel bundle.";
+  *ran_init_op = false;
   // Find path to variables to be restored in export directory.
   const string variables_directory =
       io::JoinPath(export_dir, kSavedModelVariablesDirectory);
@@ -178,32 +244,85 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
 
   AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
 
+  std::vector<string> target_node_names = {restore_op_name.ToString()};
+  if (!concurrent_init_op_name.empty()) {
+    LOG(INFO) << "Running " << concurrent_init_op_name
+              << " concurrently with the restore.";
+    target_node_names.push_back(concurrent_init_op_name);
+  }
   RunMetadata run_metadata;
-  return session->Run(run_options, inputs, {}, {restore_op_name.ToString()},
-                      nullptr /* outputs */, &run_metadata);
+  TF_RETURN_IF_ERROR(session->Run(run_options, inputs, {}, target_node_names,
+                                  nullptr /* outputs */, &run_metadata));
+  *ran_init_op = !concurrent_init_op_name.empty();
+  return Status::OK();
 }
 
-Status RunLegacyInitOp(const RunOptions& run_options, const string& export_dir,
-                       const MetaGraphDef& meta_graph_def,
-                       const std::vector<AssetFileDef>& asset_file_defs,
-                       Session* session) {
-  LOG(INFO) << "Running LegacyInitOp on SavedModel bundle.";
-  const auto& collection_def_map = meta_graph_def.collection_def();
-  const auto init_op_it = collection_def_map.find(kSavedModelLegacyInitOpKey);
-  if (init_op_it != collection_def_map.end()) {
-    if (init_op_it->second.node_list().value_size() != 1) {
-      return errors::FailedPrecondition(strings::StrCat(
-          "Expected exactly one serving init op in : ", export_dir));
+// Replays the requests of the warmup file of the SavedModel, if it has one.
+// Running them creates the executors of their feeds and fetches, and warms up
+// the caches of the kernels (e.g. autotuning and compilation), so that the
+// first requests after the load do not pay for it.
+Status RunWarmupRequests(const RunOptions& run_options,
+                         const string& export_dir, Session* session) {
+  const string warmup_path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(warmup_path).ok()) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Running warmup requests from: " << warmup_path;
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(warmup_path, &file));
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  int num_requests = 0;
+  string record;
+  while (true) {
+    Status s = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    if (num_requests == kMaxWarmupRequests) {
+      return errors::InvalidArgument("The warmup file ", warmup_path,
+                                     " has more than ", kMaxWarmupRequests,
+                                     " requests");
+    }
+    RunStepRequest request;
+    if (!request.ParseFromString(record)) {
+      return errors::DataLoss("Could not parse warmup request ", num_requests,
+                              " in ", warmup_path);
+    }
+    if (!request.partial_run_handle().empty()) {
+      return errors::InvalidArgument("Warmup request ", num_requests, " in ",
+                                     warmup_path, " is a partial run");
     }
     std::vector<std::pair<string, Tensor>> inputs;
-    AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
+    for (const NamedTensorProto& feed : request.feed()) {
+      Tensor tensor;
+      if (!tensor.FromProto(feed.tensor())) {
+        return errors::InvalidArgument("Invalid feed ", feed.name(),
+                                       " in warmup request ", num_requests,
+                                       " in ", warmup_path);
+      }
+      inputs.emplace_back(feed.name(), tensor);
+    }
+    const std::vector<string> output_names(request.fetch().begin(),
+                                           request.fetch().end());
+    const std::vector<string> target_node_names(request.target().begin(),
+                                                request.target().end());
+    // The options of the load apply to the warmup, unless the request has
+    // its own.
+    const RunOptions& options =
+        request.has_options() ? request.options() : run_options;
+    std::vector<Tensor> outputs;
     RunMetadata run_metadata;
-    const StringPiece legacy_init_op_name =
-        init_op_it->second.node_list().value(0);
-    return session->Run(run_options, inputs, {},
-                        {legacy_init_op_name.ToString()}, nullptr /* outputs */,
-                        &run_metadata);
+    s = session->Run(options, inputs, output_names, target_node_names,
+                     &outputs, &run_metadata);
+    if (!s.ok()) {
+      return errors::Internal("Warmup request ", num_requests, " in ",
+                              warmup_path, " failed: ", s.error_message());
+    }
+    ++num_requests;
   }
+  LOG(INFO) << "Ran " << num_requests << " warmup requests.";
   return Status::OK();
 }
 
@@ -247,20 +366,29 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
+  string init_op_name;
   TF_RETURN_IF_ERROR(
-      RunRestore(run_options, export_dir,
-                 bundle->meta_graph_def.saver_def().restore_op_name(),
-                 bundle->meta_graph_def.saver_def().filename_tensor_name(),
-                 asset_file_defs, bundle->session.get()));
-  if (HasMainOp(bundle->meta_graph_def)) {
-    TF_RETURN_IF_ERROR(RunMainOp(run_options, export_dir,
-                                 bundle->meta_graph_def, asset_file_defs,
-                                 bundle->session.get()));
-  } else {
-    TF_RETURN_IF_ERROR(RunLegacyInitOp(run_options, export_dir,
-                                       bundle->meta_graph_def, asset_file_defs,
-                                       bundle->session.get()));
+      GetInitOp(export_dir, bundle->meta_graph_def, &init_op_name));
+  const string& restore_op_name =
+      bundle->meta_graph_def.saver_def().restore_op_name();
+  // The init op usually only initializes tables and local variables, which
+  // can overlap with reading the checkpoint.
+  const bool init_concurrently =
+      !init_op_name.empty() && !restore_op_name.empty() &&
+      CanInitConcurrentlyWithRestore(bundle->meta_graph_def.graph_def(),
+                                     restore_op_name, init_op_name);
+  bool ran_init_op = false;
+  TF_RETURN_IF_ERROR(RunRestore(
+      run_options, export_dir, restore_op_name,
+      bundle->meta_graph_def.saver_def().filename_tensor_name(),
+      asset_file_defs, init_concurrently ? init_op_name : "",
+      bundle->session.get(), &ran_init_op));
+  if (!init_op_name.empty() && !ran_init_op) {
+    TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, init_op_name,
+                                 asset_file_defs, bundle->session.get()));
   }
+  TF_RETURN_IF_ERROR(
+      RunWarmupRequests(run_options, export_dir, bundle->session.get()));
   return Status::OK();
 }
 
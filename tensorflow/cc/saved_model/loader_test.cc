@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -64,6 +66,54 @@ class LoaderTest : public ::testing::Test {
         test::AsTensor<string>({"foo.txt"}, TensorShape({})), path_outputs[0]);
   }
 
+  // Copies the SavedModel in 'src' to a new directory, writes 'requests' to
+  // its warmup file, and returns the new directory.
+  string CopyWithWarmupRequests(const string& src,
+                                const std::vector<RunStepRequest>& requests) {
+    Env* env = Env::Default();
+    const string dst = io::JoinPath(testing::TmpDir(), "warmup_saved_model");
+    int64 undeleted_files, undeleted_dirs;
+    env->DeleteRecursively(dst, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+    for (const string& file :
+         {string(kSavedModelFilenamePb),
+          io::JoinPath(kSavedModelAssetsDirectory, "foo.txt"),
+          io::JoinPath(kSavedModelVariablesDirectory, "variables.index"),
+          io::JoinPath(kSavedModelVariablesDirectory,
+                       "variables.data-00000-of-00001")}) {
+      string contents;
+      TF_CHECK_OK(ReadFileToString(env, io::JoinPath(src, file), &contents));
+      TF_CHECK_OK(env->RecursivelyCreateDir(
+          io::Dirname(io::JoinPath(dst, file)).ToString()));
+      TF_CHECK_OK(WriteStringToFile(env, io::JoinPath(dst, file), contents));
+    }
+    const string extra_dir = io::JoinPath(dst, kSavedModelAssetsExtraDirectory);
+    TF_CHECK_OK(env->RecursivelyCreateDir(extra_dir));
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(
+        io::JoinPath(extra_dir, kSavedModelWarmupRequestsFilename), &file));
+    io::RecordWriter writer(file.get());
+    for (const RunStepRequest& request : requests) {
+      TF_CHECK_OK(writer.WriteRecord(request.SerializeAsString()));
+    }
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(file->Close());
+    return dst;
+  }
+
+  // Returns a request that runs the regression signature of half plus two.
+  RunStepRequest MakeRegressRequest(const MetaGraphDef& meta_graph_def) {
+    const auto& signature_def =
+        meta_graph_def.signature_def().at("regress_x_to_y");
+    RunStepRequest request;
+    NamedTensorProto* feed = request.add_feed();
+    feed->set_name(signature_def.inputs().at(kRegressInputs).name());
+    test::AsTensor<string>({MakeSerializedExample(1)}, TensorShape({1}))
+        .AsProtoField(feed->mutable_tensor());
+    request.add_fetch(signature_def.outputs().at(kRegressOutputs).name());
+    return request;
+  }
+
   void CheckSavedModelBundle(const string& export_dir,
                              const SavedModelBundle& bundle) {
     ValidateAssets(export_dir, bundle);
@@ -179,6 +229,46 @@ TEST_F(LoaderTest, MainOpFormat) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, WarmupRequests) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string src_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, src_dir,
+                              {kSavedModelTagServe}, &bundle));
+  const RunStepRequest request = MakeRegressRequest(bundle.meta_graph_def);
+
+  const string export_dir =
+      CopyWithWarmupRequests(src_dir, {request, request});
+  SavedModelBundle warm_bundle;
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &warm_bundle));
+  CheckSavedModelBundle(export_dir, warm_bundle);
+}
+
+TEST_F(LoaderTest, FailingWarmupRequest) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string src_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, src_dir,
+                              {kSavedModelTagServe}, &bundle));
+  RunStepRequest request = MakeRegressRequest(bundle.meta_graph_def);
+  request.set_fetch(0, "missing_node:0");
+
+  const string export_dir = CopyWithWarmupRequests(src_dir, {request});
+  SavedModelBundle warm_bundle;
+  Status st = LoadSavedModel(session_options, run_options, export_dir,
+                             {kSavedModelTagServe}, &warm_bundle);
+  EXPECT_FALSE(st.ok());
+  EXPECT_TRUE(StringPiece(st.error_message()).contains("Warmup request 0"))
+      << st.error_message();
+}
+
 TEST_F(LoaderTest, InvalidExportPath) {
   SavedModelBundle bundle;
   RunOptions run_options;
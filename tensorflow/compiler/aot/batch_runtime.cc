@@ -0,0 +1,47 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_runtime.h"
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace runtime {
+
+void ParallelFor(size_t n, void (*fn)(void* arg, size_t i), void* arg,
+                 const Eigen::ThreadPoolDevice* pool) {
+  if (pool == nullptr || n <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(arg, i);
+    }
+    return;
+  }
+  Eigen::Barrier barrier(n - 1);
+  for (size_t i = 1; i < n; ++i) {
+    pool->enqueueNoNotification([fn, arg, i, &barrier]() {
+      fn(arg, i);
+      barrier.Notify();
+    });
+  }
+  fn(arg, 0);
+  barrier.Wait();
+}
+
+}  // namespace runtime
+}  // namespace tfcompile
+}  // namespace tensorflow
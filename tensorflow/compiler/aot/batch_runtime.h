@@ -0,0 +1,43 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This file contains the runtime support for the batch API of the classes
+// generated by tfcompile with --gen_batch_api.
+
+#ifndef TENSORFLOW_COMPILER_AOT_BATCH_RUNTIME_H_
+#define TENSORFLOW_COMPILER_AOT_BATCH_RUNTIME_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace Eigen {
+struct ThreadPoolDevice;
+}
+
+namespace tensorflow {
+namespace tfcompile {
+namespace runtime {
+
+// ParallelFor calls `fn(arg, i)` for each i in [0, n), and returns once all
+// calls are done.  Call 0 runs on the calling thread and the others are
+// scheduled on `pool`.  If `pool` is nullptr, all calls run in order on the
+// calling thread.
+void ParallelFor(size_t n, void (*fn)(void* arg, size_t i), void* arg,
+                 const Eigen::ThreadPoolDevice* pool);
+
+}  // namespace runtime
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_BATCH_RUNTIME_H_
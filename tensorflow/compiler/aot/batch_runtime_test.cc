@@ -0,0 +1,55 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+#define EIGEN_USE_CUSTOM_THREAD_POOL
+
+#include "tensorflow/compiler/aot/batch_runtime.h"
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace runtime {
+namespace {
+
+void Square(void* arg, size_t i) {
+  (*static_cast<std::vector<size_t>*>(arg))[i] = i * i;
+}
+
+TEST(BatchRuntime, ParallelForWithoutPool) {
+  std::vector<size_t> values(5, 0);
+  ParallelFor(values.size(), &Square, &values, nullptr);
+  EXPECT_EQ(std::vector<size_t>({0, 1, 4, 9, 16}), values);
+}
+
+TEST(BatchRuntime, ParallelForWithPool) {
+  Eigen::ThreadPool tp(3);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+  std::vector<size_t> values(100, 0);
+  ParallelFor(values.size(), &Square, &values, &device);
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(i * i, values[i]);
+  }
+  ParallelFor(0, &Square, &values, &device);
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace tfcompile
+}  // namespace tensorflow
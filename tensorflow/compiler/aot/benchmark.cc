@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/aot/benchmark.h"
 
+#include <string.h>
 #include <sys/time.h>
 
 #include <algorithm>
@@ -109,6 +110,52 @@ void DumpStatsToStdout(const Stats& stats) {
   }
 }
 
+void DumpProfileCountersToStdout(const ProfileCounters& counters,
+                                 const Stats& stats) {
+  const size_t iters = stats.per_iter_us.size();
+  if (counters.num == 0 || iters == 0) {
+    return;
+  }
+  // The last counter covers the whole function, so it also gives the clock
+  // rate the cycle counts were taken at, which converts them into time.
+  double sum_us = 0;
+  for (const int64 us : stats.per_iter_us) {
+    sum_us += us;
+  }
+  const double total_cycles = counters.cycles[counters.num - 1];
+  const double cycles_per_ns = sum_us > 0 ? total_cycles / (sum_us * 1000) : 0;
+  // Order the counters by decreasing cycles, keeping the total last.
+  std::vector<size_t> order;
+  for (size_t i = 0; i + 1 < counters.num; ++i) {
+    order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&counters](size_t a, size_t b) {
+    return counters.cycles[a] > counters.cycles[b];
+  });
+  order.push_back(counters.num - 1);
+  int max_name_size = 0;
+  for (size_t i = 0; i < counters.num; ++i) {
+    const int name_size = strlen(counters.names[i]);
+    if (name_size > max_name_size) {
+      max_name_size = name_size;
+    }
+  }
+  printf("HLO profile over %zu iterations at %.3f GHz:\n", iters,
+         cycles_per_ns);
+  printf("  %-*s %14s %7s %11s %11s\n", max_name_size, "HLO",
+         "cycles/iter", "%total", "flop/cycle", "GB/s");
+  for (const size_t i : order) {
+    const double cycles = static_cast<double>(counters.cycles[i]) / iters;
+    const double percent =
+        total_cycles > 0 ? 100.0 * counters.cycles[i] / total_cycles : 0;
+    const double flops_per_cycle = cycles > 0 ? counters.flops[i] / cycles : 0;
+    const double ns = cycles_per_ns > 0 ? cycles / cycles_per_ns : 0;
+    const double gb_per_s = ns > 0 ? counters.bytes_accessed[i] / ns : 0;
+    printf("  %-*s %14.0f %6.2f%% %11.3f %11.3f\n", max_name_size,
+           counters.names[i], cycles, percent, flops_per_cycle, gb_per_s);
+  }
+}
+
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
   // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
   const int64 max_us = (options.max_micros <= 0 && options.max_iters <= 0)
@@ -56,6 +56,26 @@ struct Stats {
 // form.
 void DumpStatsToStdout(const Stats& stats);
 
+// ProfileCounters describes the HLO profile counters of a function generated by
+// tfcompile with HLO profiling enabled; see the kNumProfileCounters methods of
+// the generated class.  Each array has num entries, and the last counter
+// covers the whole function.
+struct ProfileCounters {
+  size_t num = 0;
+  const char* const* names = nullptr;
+  const int64* flops = nullptr;           // Estimated flops per execution.
+  const int64* bytes_accessed = nullptr;  // Estimated bytes per execution.
+  const uint64* cycles = nullptr;         // Cycles summed over all iterations.
+};
+
+// DumpProfileCountersToStdout printfs to stdout the per-HLO breakdown of the
+// benchmark that produced `stats`: cycles per iteration and share of the total
+// for each counter, along with the achieved flops per cycle and memory
+// bandwidth.  The counters must have been accumulated over exactly the
+// iterations recorded in `stats`.
+void DumpProfileCountersToStdout(const ProfileCounters& counters,
+                                 const Stats& stats);
+
 // BenchmarkFn is the signature of the function generated by tfcompile.
 typedef std::function<void()> BenchmarkFn;
 
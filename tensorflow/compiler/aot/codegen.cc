@@ -333,6 +333,98 @@ Status GenerateHeader(const HeaderOpts& opts, const Config& config,
     error_msg = "context_.error_msg";
   }
 
+  // Create rewrite strings for the optional batch API.
+  string batch_include, batch_methods, batch_member_var;
+  if (opts.gen_batch_api) {
+    batch_include = "#include \"tensorflow/compiler/aot/batch_runtime.h\"\n";
+    batch_methods = R"(
+  // Runs the `n` distinct instances in `computations` in parallel on `pool`,
+  // e.g. one per input of a batch, as if Run was called on each of them.
+  // Returns true if all of them succeeded; error_msg may be called on the
+  // instances that failed.  If `pool` is nullptr the instances run in order
+  // on the calling thread.
+  //
+  // Since the calling thread waits for the pool, an instance must not also run
+  // its own computation on `pool` via set_thread_pool.
+  static bool RunBatch({{CLASS}}* const* computations, size_t n,
+                       const Eigen::ThreadPoolDevice* pool) {
+    tensorflow::tfcompile::runtime::ParallelFor(
+        n,
+        [](void* arg, size_t i) {
+          {{CLASS}}* computation = static_cast<{{CLASS}}**>(arg)[i];
+          computation->batch_run_ok_ = computation->Run();
+        },
+        const_cast<{{CLASS}}**>(computations), pool);
+    for (size_t i = 0; i < n; ++i) {
+      if (!computations[i]->batch_run_ok_) return false;
+    }
+    return true;
+  }
+)";
+    batch_member_var = "  bool batch_run_ok_ = false;\n";
+  }
+
+  // Create rewrite strings for the optional HLO profile counters.
+  const xla::cpu::CpuAotCompilationResult::ProfileCounters& profile_counters =
+      compile_result.aot->profile_counters();
+  string entry_args = "temps_[kResultIndex], &run_options_, args_, temps_";
+  string profile_entry_param;
+  string profile_methods, profile_member_var;
+  if (!profile_counters.empty()) {
+    std::vector<string> names, flops, bytes;
+    for (const auto& counter : profile_counters) {
+      names.push_back(
+          strings::StrCat("\"", str_util::CEscape(counter.name), "\""));
+      flops.push_back(strings::StrCat(counter.flop_count));
+      bytes.push_back(strings::StrCat(counter.bytes_accessed));
+    }
+    profile_entry_param = ",\n    tensorflow::uint64* prof_counters";
+    entry_args += ", profile_counters_";
+    profile_methods = R"(
+  // HLO profile counter methods.  The computation was compiled with HLO
+  // profiling enabled, so each Run call adds the cycles spent in each HLO
+  // instruction to a counter; the last counter covers the whole computation.
+  static constexpr size_t kNumProfileCounters = {{PROFILE_NUM}};
+
+  // Returns the cycles accumulated by all Run calls since construction or the
+  // last reset_profile_counters call.  There are kNumProfileCounters entries.
+  const tensorflow::uint64* profile_counters() const {
+    return profile_counters_;
+  }
+  void reset_profile_counters() {
+    for (size_t i = 0; i < kNumProfileCounters; ++i) profile_counters_[i] = 0;
+  }
+
+  // Returns the name of the HLO instruction behind each profile counter.
+  static const char* const* ProfileCounterNames() {
+    static const char* const kNames[kNumProfileCounters] = {
+        {{PROFILE_NAMES}}};
+    return kNames;
+  }
+
+  // Returns the estimated flops and bytes accessed by one execution of the
+  // HLO instruction behind each profile counter.
+  static const tensorflow::int64* ProfileCounterFlops() {
+    static constexpr tensorflow::int64 kFlops[kNumProfileCounters] = {
+        {{PROFILE_FLOPS}}};
+    return kFlops;
+  }
+  static const tensorflow::int64* ProfileCounterBytesAccessed() {
+    static constexpr tensorflow::int64 kBytes[kNumProfileCounters] = {
+        {{PROFILE_BYTES}}};
+    return kBytes;
+  }
+)";
+    str_util::ReplaceAllPairs(
+        &profile_methods,
+        {{"{{PROFILE_NUM}}", strings::StrCat(profile_counters.size())},
+         {"{{PROFILE_NAMES}}", str_util::Join(names, ",\n        ")},
+         {"{{PROFILE_FLOPS}}", str_util::Join(flops, ", ")},
+         {"{{PROFILE_BYTES}}", str_util::Join(bytes, ", ")}});
+    profile_member_var =
+        "  tensorflow::uint64 profile_counters_[kNumProfileCounters] = {};\n";
+  }
+
   // Create rewrite strings for namespace start and end.
   string ns_start;
   for (const string& n : opts.namespaces) {
@@ -359,6 +451,7 @@ Status GenerateHeader(const HeaderOpts& opts, const Config& config,
 #ifndef TFCOMPILE_GENERATED_{{ENTRY}}_H_  // NOLINT(build/header_guard)
 #define TFCOMPILE_GENERATED_{{ENTRY}}_H_  // NOLINT(build/header_guard)
 
+{{BATCH_INCLUDE}}
 {{CONTEXT_INCLUDE}}
 #include "tensorflow/compiler/aot/runtime.h"
 #include "tensorflow/compiler/xla/executable_run_options.h"
@@ -370,7 +463,7 @@ namespace Eigen { struct ThreadPoolDevice; }
 // (Implementation detail) Entry point to the function in the object file.
 extern "C" void {{ENTRY}}(
     void* result, xla::ExecutableRunOptions* run_options,
-    void** args, void** temps);
+    void** args, void** temps{{PROFILE_ENTRY_PARAM}});
 
 {{NS_START}}
 // {{CLASS}} represents a computation previously specified in a
@@ -448,9 +541,11 @@ class {{CLASS}} {
   // Runs the computation, with inputs read from arg buffers, and outputs
   // written to result buffers. Returns true on success and false on failure.
   bool Run() {
-    {{ENTRY}}(temps_[kResultIndex], &run_options_, args_, temps_);
+    {{ENTRY}}({{ENTRY_ARGS}});
     return {{RUN_RESULT}};
   }
+{{BATCH_METHODS}}
+{{PROFILE_METHODS}}
 
   // Returns the error message from the previous failed Run call.
   tensorflow::string error_msg() const { return {{ERROR_MSG}}; }
@@ -516,6 +611,8 @@ class {{CLASS}} {
   void* alloc_temps_ = nullptr;
   xla::ExecutableRunOptions run_options_;
 {{CONTEXT_MEMBER_VAR}}
+{{BATCH_MEMBER_VAR}}
+{{PROFILE_MEMBER_VAR}}
 
   TF_DISALLOW_COPY_AND_ASSIGN({{CLASS}});
 };
@@ -531,17 +628,24 @@ class {{CLASS}} {
       {"{{ARG_BYTES_TOTAL}}", strings::StrCat(arg_bytes_total)},
       {"{{ARG_NUM}}", strings::StrCat(arg_sizes.size())},
       {"{{ARG_SIZES}}", str_util::Join(arg_sizes, ", ")},
+      {"{{BATCH_INCLUDE}}\n", batch_include},
+      {"{{BATCH_MEMBER_VAR}}\n", batch_member_var},
+      {"{{BATCH_METHODS}}\n", batch_methods},
       {"{{CLASS}}", opts.class_name},
       {"{{CONTEXT_INCLUDE}}\n", context_include},
       {"{{CONTEXT_MEMBER_VAR}}\n", context_member_var},
       {"{{CONTEXT_SET_ARG}}\n", context_set_arg},
       {"{{CONTEXT_SET_THREAD_POOL}}\n", context_set_thread_pool},
+      {"{{ENTRY_ARGS}}", entry_args},
       {"{{ENTRY}}", compile_result.entry_point},
       {"{{ERROR_MSG}}", error_msg},
       {"{{METHODS_ARG}}\n", methods_arg},
       {"{{METHODS_RESULT}}\n", methods_result},
       {"{{NS_END}}\n", ns_end},
       {"{{NS_START}}\n", ns_start},
+      {"{{PROFILE_ENTRY_PARAM}}", profile_entry_param},
+      {"{{PROFILE_MEMBER_VAR}}\n", profile_member_var},
+      {"{{PROFILE_METHODS}}\n", profile_methods},
       {"{{PROGRAM_SHAPE}}", xla::ShapeUtil::HumanString(ps)},
       {"{{RESULT_INDEX}}", strings::StrCat(result_index)},
       {"{{RUN_RESULT}}", run_result},
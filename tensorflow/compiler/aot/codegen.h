@@ -32,6 +32,10 @@ struct HeaderOpts {
   // Namespaces specifies a list of C++ namespaces to add to the generated
   // header.  If empty, all symbols will be in the global namespace.
   std::vector<string> namespaces;
+
+  // If true, the generated class gets a static RunBatch method, which runs
+  // several instances of the class in parallel on a thread pool.
+  bool gen_batch_api = false;
 };
 
 // GenerateHeader uses the meta-information from compile_result to generate a
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
@@ -132,6 +133,70 @@ TEST(GenerateHeader, Golden) {
   EXPECT_EQ(header, golden_data);
 }
 
+TEST(GenerateHeader, BatchApi) {
+  HeaderOpts opts;
+  opts.class_name = "MyClass";
+  opts.gen_batch_api = true;
+  Config config;
+  config.add_feed()->mutable_id()->set_node_name("feed0");
+  config.add_fetch()->mutable_id()->set_node_name("fetch0");
+  CompileResult compile_result;
+  compile_result.aot.reset(
+      new xla::cpu::CpuAotCompilationResult({}, {1, -1, 4}, 2));
+  compile_result.program_shape = xla::ShapeUtil::MakeProgramShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {1})},
+      xla::ShapeUtil::MakeShape(xla::F32, {1}));
+  compile_result.entry_point = "entry_point";
+  compile_result.pointer_size = 8;
+  string header;
+  TF_EXPECT_OK(GenerateHeader(opts, config, compile_result, &header));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "#include \"tensorflow/compiler/aot/batch_runtime.h\""));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "static bool RunBatch(MyClass* const* computations, size_t n,"));
+  EXPECT_TRUE(StringPiece(header).contains("bool batch_run_ok_ = false;"));
+  EXPECT_FALSE(StringPiece(header).contains("{{"));
+}
+
+TEST(GenerateHeader, ProfileCounters) {
+  HeaderOpts opts;
+  opts.class_name = "MyClass";
+  Config config;
+  config.add_feed()->mutable_id()->set_node_name("feed0");
+  config.add_fetch()->mutable_id()->set_node_name("fetch0");
+  xla::cpu::CpuAotCompilationResult::ProfileCounters counters(2);
+  counters[0].name = "fusion.1";
+  counters[0].flop_count = 10;
+  counters[0].bytes_accessed = 24;
+  counters[1].name = "[total]";
+  counters[1].flop_count = 10;
+  counters[1].bytes_accessed = 24;
+  CompileResult compile_result;
+  compile_result.aot.reset(new xla::cpu::CpuAotCompilationResult(
+      {}, {1, -1, 4}, 2, std::move(counters)));
+  compile_result.program_shape = xla::ShapeUtil::MakeProgramShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {1})},
+      xla::ShapeUtil::MakeShape(xla::F32, {1}));
+  compile_result.entry_point = "entry_point";
+  compile_result.pointer_size = 8;
+  string header;
+  TF_EXPECT_OK(GenerateHeader(opts, config, compile_result, &header));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "void** args, void** temps,\n    tensorflow::uint64* prof_counters);"));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "entry_point(temps_[kResultIndex], &run_options_, args_, temps_, "
+      "profile_counters_);"));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "static constexpr size_t kNumProfileCounters = 2;"));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "\"fusion.1\",\n        \"[total]\""));
+  EXPECT_TRUE(StringPiece(header).contains("10, 10};"));
+  EXPECT_TRUE(StringPiece(header).contains("24, 24};"));
+  EXPECT_TRUE(StringPiece(header).contains(
+      "tensorflow::uint64 profile_counters_[kNumProfileCounters] = {};"));
+  EXPECT_FALSE(StringPiece(header).contains("{{"));
+}
+
 }  // namespace
 }  // namespace tfcompile
 }  // namespace tensorflow
@@ -424,6 +424,8 @@ Status CompileGraph(std::unique_ptr<Graph> graph, const MainFlags& flags,
       flags.target_triple, flags.target_cpu, flags.target_features,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
+  aot_opts.set_intra_op_parallelism_threads(
+      flags.intra_op_parallelism_threads);
   return CompileXla(client, computation, aot_opts, compile_result);
 }
 
@@ -51,6 +51,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"intra_op_parallelism_threads", &flags->intra_op_parallelism_threads,
+       "Number of threads the generated code is expected to run on, via "
+       "set_thread_pool.  Large loops are split into at most this many "
+       "parallel tasks.  If 0, the number of CPUs of the compiling machine is "
+       "used."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
@@ -64,6 +69,9 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "namespaces are given, within the global namespace."},
       {"out_object", &flags->out_object, "Output object file name."},
       {"out_header", &flags->out_header, "Output header file name."},
+      {"gen_batch_api", &flags->gen_batch_api,
+       "If set, the generated class gets a static RunBatch method, which runs "
+       "several instances of the class in parallel on a thread pool."},
   };
   flag_list->insert(flag_list->end(), tmp.begin(), tmp.end());
 }
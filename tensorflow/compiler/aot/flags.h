@@ -33,10 +33,12 @@ struct MainFlags {
   string target_triple;
   string target_cpu;
   string target_features;
+  int32 intra_op_parallelism_threads = 0;
   string entry_point;
   string cpp_class;
   string out_object;
   string out_header;
+  bool gen_batch_api = false;
 };
 
 // Appends to flag_list a tensorflow::Flag for each field in MainFlags.
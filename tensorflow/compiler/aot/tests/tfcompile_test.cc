@@ -18,6 +18,8 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/aot/tests/test_graph_tfadd.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfadd_batch.h"
+#include "tensorflow/compiler/aot/tests/test_graph_tfadd_profile.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfadd_with_ckpt.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tfadd_with_ckpt_saver.h"
 #include "tensorflow/compiler/aot/tests/test_graph_tffunction.h"
@@ -84,6 +86,54 @@ TEST(TFCompileTest, Add_SetArg) {
   EXPECT_EQ(add.result0_data(), add.results()[0]);
 }
 
+TEST(TFCompileTest, AddBatch) {
+  Eigen::ThreadPool tp(2);
+  Eigen::ThreadPoolDevice device(&tp, tp.NumThreads());
+
+  AddBatchComp adds[4];
+  AddBatchComp* batch[4];
+  for (int i = 0; i < 4; ++i) {
+    adds[i].arg0() = i;
+    adds[i].arg1() = 10;
+    batch[i] = &adds[i];
+  }
+  EXPECT_TRUE(AddBatchComp::RunBatch(batch, 4, &device));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(adds[i].result0(), i + 10);
+  }
+
+  adds[0].arg1() = 20;
+  EXPECT_TRUE(AddBatchComp::RunBatch(batch, 1, nullptr));
+  EXPECT_EQ(adds[0].result0(), 20);
+}
+
+TEST(TFCompileTest, AddProfile) {
+  AddProfileComp add;
+  ASSERT_GE(AddProfileComp::kNumProfileCounters, 2);
+  const size_t total = AddProfileComp::kNumProfileCounters - 1;
+  EXPECT_STREQ(AddProfileComp::ProfileCounterNames()[total], "[total]");
+  for (size_t i = 0; i < AddProfileComp::kNumProfileCounters; ++i) {
+    EXPECT_EQ(add.profile_counters()[i], 0);
+  }
+
+  add.arg0() = 1;
+  add.arg1() = 2;
+  EXPECT_TRUE(add.Run());
+  EXPECT_EQ(add.result0(), 3);
+  EXPECT_GT(add.profile_counters()[total], 0);
+  bool found_add = false;
+  for (size_t i = 0; i < total; ++i) {
+    if (AddProfileComp::ProfileCounterFlops()[i] > 0) {
+      found_add = true;
+      EXPECT_GT(AddProfileComp::ProfileCounterBytesAccessed()[i], 0);
+    }
+  }
+  EXPECT_TRUE(found_add);
+
+  add.reset_profile_counters();
+  EXPECT_EQ(add.profile_counters()[total], 0);
+}
+
 TEST(TFCompileTest, AddWithCkpt) {
   AddWithCkptComp add;
   EXPECT_EQ(add.arg0_data(), add.args()[0]);
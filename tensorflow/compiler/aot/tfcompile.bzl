@@ -23,6 +23,7 @@ def tf_library(name, graph, config,
                cpp_class=None, gen_test=True, gen_benchmark=True,
                visibility=None, testonly=None,
                tfcompile_flags=None,
+               enable_xla_hlo_profiling=False,
                tfcompile_tool="//tensorflow/compiler/aot:tfcompile",
                deps=None, tags=None):
   """Runs tfcompile to compile a TensorFlow graph into executable code.
@@ -62,6 +63,9 @@ def tf_library(name, graph, config,
     visibility: Bazel build visibility.
     testonly:   Bazel testonly attribute.
     tfcompile_flags: Extra flags to pass to tfcompile to control compilation.
+    enable_xla_hlo_profiling: If True, compile per-HLO cycle counters into the
+      generated function, and have the benchmark binary report a per-HLO
+      breakdown of cycles, flops and memory bandwidth after its timings.
     tfcompile_tool: The tfcompile binary. A non-default can be passed to
       use a tfcompile built with extra dependencies.
     deps: a list of extra deps to include on the build rules for
@@ -145,6 +149,7 @@ def tf_library(name, graph, config,
            " --target_triple=" + target_llvm_triple() +
            " --out_header=$(@D)/" + header_file +
            " --out_object=$(@D)/" + object_file +
+           (" --xla_hlo_profile" if enable_xla_hlo_profiling else "") +
            " " + (tfcompile_flags or "")),
       tools=[tfcompile_tool],
       visibility=visibility,
@@ -176,9 +181,11 @@ def tf_library(name, graph, config,
           "//tensorflow/compiler/tf2xla/kernels:gather_op_kernel_float_int64",
           "//tensorflow/compiler/tf2xla/kernels:index_ops_kernel_argmax_float_1d",
           "//tensorflow/compiler/tf2xla/kernels:index_ops_kernel_argmax_float_2d",
+          "//tensorflow/compiler/aot:batch_runtime",
           "//tensorflow/compiler/aot:runtime",
           "//tensorflow/compiler/tf2xla:xla_local_runtime_context",
           "//tensorflow/compiler/xla/service/cpu:runtime_conv2d",
+          "//tensorflow/compiler/xla/service/cpu:runtime_fork_join",
           "//tensorflow/compiler/xla/service/cpu:runtime_matmul",
           "//tensorflow/compiler/xla/service/cpu:runtime_single_threaded_conv2d",
           "//tensorflow/compiler/xla/service/cpu:runtime_single_threaded_matmul",
@@ -199,7 +206,9 @@ def tf_library(name, graph, config,
   sed_replace = (
       "-e \"s|{{TFCOMPILE_HEADER}}|$(location " + header_file + ")|g\" " +
       "-e \"s|{{TFCOMPILE_CPP_CLASS}}|" + cpp_class + "|g\" " +
-      "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" ")
+      "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" " +
+      "-e \"s|{{TFCOMPILE_HLO_PROFILE}}|" +
+      ("1" if enable_xla_hlo_profiling else "0") + "|g\" ")
 
   if gen_test:
     test_name = name + "_test"
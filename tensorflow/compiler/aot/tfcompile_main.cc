@@ -111,6 +111,7 @@ Status Main(const MainFlags& flags) {
   }
   TF_RETURN_IF_ERROR(ParseCppClass(flags.cpp_class, &header_opts.class_name,
                                    &header_opts.namespaces));
+  header_opts.gen_batch_api = flags.gen_batch_api;
   string header;
   TF_RETURN_IF_ERROR(
       GenerateHeader(header_opts, config, compile_result, &header));
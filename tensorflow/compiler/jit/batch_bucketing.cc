@@ -0,0 +1,67 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/batch_bucketing.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+
+namespace tensorflow {
+
+Status ParseBatchBuckets(const string& spec, std::vector<int64>* buckets) {
+  buckets->clear();
+  for (const string& bucket :
+       str_util::Split(spec, ',', str_util::SkipEmpty())) {
+    int64 size;
+    if (!strings::safe_strto64(bucket, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid batch bucket size \"", bucket,
+                                     "\" in \"", spec, "\"");
+    }
+    buckets->push_back(size);
+  }
+  std::sort(buckets->begin(), buckets->end());
+  buckets->erase(std::unique(buckets->begin(), buckets->end()),
+                 buckets->end());
+  return Status::OK();
+}
+
+int64 BatchBucketFor(const std::vector<int64>& buckets, int64 batch_size) {
+  if (batch_size <= 0) {
+    return -1;
+  }
+  auto it = std::lower_bound(buckets.begin(), buckets.end(), batch_size);
+  return it == buckets.end() ? -1 : *it;
+}
+
+int64 SharedBatchSize(gtl::ArraySlice<const Tensor*> tensors) {
+  int64 batch_size = -1;
+  for (const Tensor* tensor : tensors) {
+    if (tensor->dims() == 0) continue;
+    if (!DataTypeCanUseMemcpy(tensor->dtype())) {
+      return -1;
+    }
+    if (batch_size >= 0 && tensor->dim_size(0) != batch_size) {
+      return -1;
+    }
+    batch_size = tensor->dim_size(0);
+  }
+  return batch_size;
+}
+
+}  // namespace tensorflow
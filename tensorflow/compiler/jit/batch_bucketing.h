@@ -0,0 +1,53 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Helpers for shape-bucketed compilation: instead of compiling a new XLA
+// executable for every batch size, the inputs of a cluster are padded along
+// their first dimension up to one of a few configured bucket sizes, and its
+// outputs are sliced back to the original batch size.
+//
+// Padding is only correct for computations that are independent across the
+// first dimension of their inputs and outputs, i.e. whose row i of every
+// output only depends on row i of the inputs.
+
+#ifndef TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Parses "spec", a comma-separated list of positive batch sizes, into
+// "buckets", sorted in increasing order without duplicates.  An empty "spec"
+// yields no buckets.
+Status ParseBatchBuckets(const string& spec, std::vector<int64>* buckets);
+
+// Returns the smallest of the sorted "buckets" that is at least "batch_size",
+// or -1 if there is none or "batch_size" is not positive.
+int64 BatchBucketFor(const std::vector<int64>& buckets, int64 batch_size);
+
+// Returns the size of the first dimension shared by the non-scalar "tensors",
+// or -1 if their first dimensions differ, if there is no such tensor, or if one
+// of them has a type that cannot be padded by copying its buffer.
+int64 SharedBatchSize(gtl::ArraySlice<const Tensor*> tensors);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
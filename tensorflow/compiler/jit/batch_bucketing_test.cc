@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/batch_bucketing.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(BatchBucketingTest, ParseBatchBuckets) {
+  std::vector<int64> buckets;
+  TF_EXPECT_OK(ParseBatchBuckets("", &buckets));
+  EXPECT_TRUE(buckets.empty());
+  TF_EXPECT_OK(ParseBatchBuckets("32, 8,128,8", &buckets));
+  EXPECT_EQ(std::vector<int64>({8, 32, 128}), buckets);
+  EXPECT_FALSE(ParseBatchBuckets("8,0", &buckets).ok());
+  EXPECT_FALSE(ParseBatchBuckets("8,big", &buckets).ok());
+}
+
+TEST(BatchBucketingTest, BatchBucketFor) {
+  const std::vector<int64> buckets = {8, 32, 128};
+  EXPECT_EQ(8, BatchBucketFor(buckets, 1));
+  EXPECT_EQ(8, BatchBucketFor(buckets, 8));
+  EXPECT_EQ(32, BatchBucketFor(buckets, 9));
+  EXPECT_EQ(128, BatchBucketFor(buckets, 128));
+  EXPECT_EQ(-1, BatchBucketFor(buckets, 129));
+  EXPECT_EQ(-1, BatchBucketFor(buckets, 0));
+  EXPECT_EQ(-1, BatchBucketFor({}, 4));
+}
+
+TEST(BatchBucketingTest, SharedBatchSize) {
+  Tensor scalar(DT_FLOAT, TensorShape({}));
+  Tensor a(DT_FLOAT, TensorShape({5, 3}));
+  Tensor b(DT_INT32, TensorShape({5}));
+  Tensor c(DT_FLOAT, TensorShape({4, 5}));
+  Tensor strings(DT_STRING, TensorShape({5}));
+  EXPECT_EQ(5, SharedBatchSize({&scalar, &a, &b}));
+  EXPECT_EQ(-1, SharedBatchSize({&a, &c}));
+  EXPECT_EQ(-1, SharedBatchSize({&scalar}));
+  EXPECT_EQ(-1, SharedBatchSize({&a, &strings}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/hlo_profile_step_stats.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+std::vector<NodeExecStats> HloProfileToNodeExecStats(
+    const xla::HloExecutionProfile& profile, const xla::HloModule& module,
+    double clock_rate_ghz, const string& node_name, int64 start_micros) {
+  CHECK_GT(clock_rate_ghz, 0);
+  std::vector<NodeExecStats> stats;
+  double offset_micros = 0;
+  for (const xla::HloInstruction* hlo :
+       module.entry_computation()->MakeInstructionPostOrder()) {
+    const uint64 cycles = profile.GetProfileResult(*hlo);
+    if (cycles == 0) {
+      continue;
+    }
+    const double micros = cycles / clock_rate_ghz / 1000.0;
+    stats.emplace_back();
+    NodeExecStats& nt = stats.back();
+    nt.set_node_name(strings::StrCat(node_name, "/", hlo->name()));
+    nt.set_all_start_micros(start_micros + static_cast<int64>(offset_micros));
+    nt.set_op_start_rel_micros(0);
+    nt.set_op_end_rel_micros(static_cast<int64>(micros));
+    nt.set_all_end_rel_micros(static_cast<int64>(micros));
+    nt.set_timeline_label(strings::StrCat(
+        hlo->name(), " = ", xla::ShapeUtil::HumanString(hlo->shape()), " ",
+        xla::HloOpcodeString(hlo->opcode()), " (", cycles, " cycles)"));
+    offset_micros += micros;
+  }
+  return stats;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,45 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Helpers for showing where time goes inside an XLA cluster: the per-HLO
+// cycle counts of an HloExecutionProfile are turned into NodeExecStats, so
+// that the timeline and tfprof show them as sub-nodes of the launch op.
+
+#ifndef TENSORFLOW_COMPILER_JIT_HLO_PROFILE_STEP_STATS_H_
+#define TENSORFLOW_COMPILER_JIT_HLO_PROFILE_STEP_STATS_H_
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/hlo_execution_profile.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns one NodeExecStats per instruction of the entry computation of
+// "module" for which "profile" has a cycle count, named
+// "<node_name>/<instruction name>".
+//
+// The profile only records durations, so the instructions are laid out back
+// to back in post order, starting at "start_micros"; cycles are converted to
+// time at "clock_rate_ghz".
+std::vector<NodeExecStats> HloProfileToNodeExecStats(
+    const xla::HloExecutionProfile& profile, const xla::HloModule& module,
+    double clock_rate_ghz, const string& node_name, int64 start_micros);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_HLO_PROFILE_STEP_STATS_H_
@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/hlo_profile_step_stats.h"
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(HloProfileStepStatsTest, ProfiledInstructionsBecomeSubNodes) {
+  xla::HloModule module("profiled");
+  const xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {});
+  xla::HloComputation::Builder builder("entry");
+  xla::HloInstruction* constant =
+      builder.AddInstruction(xla::HloInstruction::CreateConstant(
+          xla::Literal::CreateR0<float>(1.0f)));
+  xla::HloInstruction* negate = builder.AddInstruction(
+      xla::HloInstruction::CreateUnary(shape, xla::HloOpcode::kNegate,
+                                       constant));
+  xla::HloInstruction* exp = builder.AddInstruction(
+      xla::HloInstruction::CreateUnary(shape, xla::HloOpcode::kExp, negate));
+  module.AddEntryComputation(builder.Build());
+
+  // The constant takes no time and is not reported.
+  xla::HloExecutionProfile profile;
+  profile.AddProfileResult(negate, 2000);
+  profile.AddProfileResult(exp, 6000);
+
+  std::vector<NodeExecStats> stats = HloProfileToNodeExecStats(
+      profile, module, /*clock_rate_ghz=*/2.0, "cluster_0", 100);
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ("cluster_0/" + negate->name(), stats[0].node_name());
+  EXPECT_EQ(100, stats[0].all_start_micros());
+  EXPECT_EQ(1, stats[0].all_end_rel_micros());
+  EXPECT_EQ("cluster_0/" + exp->name(), stats[1].node_name());
+  EXPECT_EQ(101, stats[1].all_start_micros());
+  EXPECT_EQ(3, stats[1].all_end_rel_micros());
+}
+
+}  // namespace
+}  // namespace tensorflow
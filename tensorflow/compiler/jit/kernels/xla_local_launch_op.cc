@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_local_launch_op.h"
 
+#include "tensorflow/compiler/jit/batch_bucketing.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/hlo_profile_step_stats.h"
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_local_runtime_context.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -24,12 +27,14 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -38,6 +43,19 @@ namespace gpu = perftools::gputools;
 
 namespace tensorflow {
 
+namespace {
+
+auto* xla_padded_launches = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_padded_launches",
+    "The number of XLA launches whose inputs were padded to a batch bucket.");
+
+auto* xla_fallback_launches = monitoring::Counter<0>::New(
+    "/tensorflow/compiler/jit/xla_fallback_launches",
+    "The number of XLA launches that ran the original TensorFlow function "
+    "while their computation was being compiled.");
+
+}  // namespace
+
 // Adapter class that wraps a Tensorflow allocator as an XLA allocator.
 // Assumes that the Tensorflow allocator permits asynchronous deallocation:
 // see comment on `AllowsAsynchronousDeallocation()`.
@@ -56,6 +74,10 @@ class XlaAllocator : public xla::DeviceMemoryAllocator {
   Status MakeTensorFromBuffer(gpu::DeviceMemoryBase buffer, DataType dtype,
                               const TensorShape& shape, Tensor* tensor) const;
 
+  // Makes the buffer of `tensor`, an argument donated to the computation,
+  // known to MakeTensorFromBuffer for the outputs written in its place.
+  void AddDonatedArgument(const Tensor& tensor);
+
   // The Tensorflow BFC allocator used on GPU allows host-side deallocation
   // before GPU execution takes place. Tensorflow uses the ordering of the main
   // compute stream to enforce a happens-before relationship between a memory
@@ -113,6 +135,14 @@ Status XlaAllocator::Deallocate(int device_ordinal,
   return Status::OK();
 }
 
+void XlaAllocator::AddDonatedArgument(const Tensor& tensor) {
+  void* data =
+      reinterpret_cast<void*>(const_cast<char*>(tensor.tensor_data().data()));
+  if (data != nullptr) {
+    tensors_.emplace(data, tensor);
+  }
+}
+
 Status XlaAllocator::MakeTensorFromBuffer(gpu::DeviceMemoryBase buffer,
                                           DataType dtype,
                                           const TensorShape& shape,
@@ -134,8 +164,69 @@ Status XlaAllocator::MakeTensorFromBuffer(gpu::DeviceMemoryBase buffer,
   return Status::OK();
 }
 
+// Copies `input` into `*padded`, a new tensor whose first dimension is
+// `padded_size`, and zeroes its remaining rows. `stream` is null on CPU.
+static Status PadBatch(OpKernelContext* ctx, gpu::Stream* stream,
+                       const Tensor& input, int64 padded_size, Tensor* padded) {
+  TensorShape padded_shape = input.shape();
+  padded_shape.set_dim(0, padded_size);
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), padded_shape, padded));
+  const uint64 input_bytes = input.TotalBytes();
+  const uint64 padding_bytes = padded->TotalBytes() - input_bytes;
+  char* dst = const_cast<char*>(padded->tensor_data().data());
+  const char* src = input.tensor_data().data();
+  if (stream) {
+    gpu::DeviceMemoryBase dst_mem(dst, input_bytes);
+    gpu::DeviceMemoryBase src_mem(const_cast<char*>(src), input_bytes);
+    gpu::DeviceMemoryBase padding_mem(dst + input_bytes, padding_bytes);
+    if (input_bytes > 0) {
+      stream->ThenMemcpyD2D(&dst_mem, src_mem, input_bytes);
+    }
+    stream->ThenMemZero(&padding_mem, padding_bytes);
+  } else {
+    memcpy(dst, src, input_bytes);
+    memset(dst + input_bytes, 0, padding_bytes);
+  }
+  return Status::OK();
+}
+
+// Sets `*donated` to a tensor holding the value of `input`, the argument for
+// input `input_num`, whose buffer the computation may overwrite: `input`
+// itself if it is a temporary of this op or if this op holds the only
+// reference to it, and a copy otherwise. `stream` is null on CPU.
+static Status DonatableInput(OpKernelContext* ctx, gpu::Stream* stream,
+                             int input_num, const Tensor& input,
+                             Tensor* donated) {
+  if (&input != &ctx->input(input_num)) {
+    *donated = input;
+    return Status::OK();
+  }
+  std::unique_ptr<Tensor> forwarded = ctx->forward_input(
+      input_num, input.dtype(), input.shape(),
+      ctx->input_memory_type(input_num), AllocatorAttributes());
+  if (forwarded != nullptr) {
+    *donated = *forwarded;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), input.shape(), donated));
+  const uint64 total_bytes = input.TotalBytes();
+  if (total_bytes == 0) {
+    return Status::OK();
+  }
+  char* dst = const_cast<char*>(donated->tensor_data().data());
+  const char* src = input.tensor_data().data();
+  if (stream) {
+    gpu::DeviceMemoryBase dst_mem(dst, total_bytes);
+    gpu::DeviceMemoryBase src_mem(const_cast<char*>(src), total_bytes);
+    stream->ThenMemcpyD2D(&dst_mem, src_mem, total_bytes);
+  } else {
+    memcpy(dst, src, total_bytes);
+  }
+  return Status::OK();
+}
+
 XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx), device_type_(ctx->device_type()) {
+    : AsyncOpKernel(ctx), device_type_(ctx->device_type()) {
   const NameAttrList* func;
   OP_REQUIRES_OK(ctx, ctx->GetAttr("function", &func));
   function_ = *func;
@@ -148,6 +239,12 @@ XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
   OP_REQUIRES(ctx, num_resource_args == 0,
               errors::Unimplemented(
                   "XlaLocalLaunchOp does not support resource variables"));
+  const string& batch_buckets =
+      legacy_flags::GetXlaLaunchOpFlags()->tf_xla_batch_buckets;
+  OP_REQUIRES_OK(ctx, ParseBatchBuckets(batch_buckets, &batch_buckets_));
+  async_compilation_ =
+      legacy_flags::GetXlaLaunchOpFlags()->tf_xla_async_compilation;
+  donate_inputs_ = legacy_flags::GetXlaLaunchOpFlags()->tf_xla_donate_inputs;
   if (device_type_ == DeviceType(DEVICE_CPU)) {
     platform_id_ = gpu::host::kHostPlatformId;
   } else if (device_type_ == DeviceType(DEVICE_GPU)) {
@@ -186,7 +283,57 @@ Status XlaLocalLaunchOp::BuildCompilationCache(OpKernelContext* ctx,
   return Status::OK();
 }
 
-void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
+void XlaLocalLaunchOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
+  bool use_fallback = false;
+  RunCompiled(ctx, &use_fallback);
+  if (use_fallback) {
+    RunFallback(ctx, std::move(done));
+  } else {
+    done();
+  }
+}
+
+void XlaLocalLaunchOp::RunFallback(OpKernelContext* ctx, DoneCallback done) {
+  VLOG(1) << "Running " << function_.name() << " until it is compiled";
+  xla_fallback_launches->GetCell()->IncrementBy(1);
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  OP_REQUIRES_ASYNC(ctx, lib != nullptr,
+                    errors::Internal("No function library is provided."),
+                    done);
+  FunctionLibraryRuntime::Handle handle;
+  OP_REQUIRES_OK_ASYNC(
+      ctx,
+      lib->Instantiate(function_.name(), AttrSlice(&function_.attr()), &handle),
+      done);
+
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  std::vector<Tensor>* rets = new std::vector<Tensor>;
+  lib->Run(opts, handle, args, rets, [ctx, done, rets](const Status& status) {
+    if (!status.ok()) {
+      ctx->SetStatus(status);
+    } else if (rets->size() != ctx->num_outputs()) {
+      ctx->SetStatus(errors::Internal(
+          "Function of _XlaLaunch returned ", rets->size(),
+          " tensor(s), expected ", ctx->num_outputs()));
+    } else {
+      for (size_t i = 0; i < rets->size(); ++i) {
+        ctx->set_output(i, (*rets)[i]);
+      }
+    }
+    delete rets;
+    done();
+  });
+}
+
+void XlaLocalLaunchOp::RunCompiled(OpKernelContext* ctx, bool* use_fallback) {
   VLOG(1) << "XlaLocalLaunchOp::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
   // We store information about the JIT-compiled XLA computation
@@ -217,11 +364,52 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   options.graph_def_version = ctx->function_library()->graph_def_version();
   options.allow_cpu_custom_calls = (platform_id_ == gpu::host::kHostPlatformId);
   options.local_executable_has_hybrid_result = true;
+  options.local_executable_donates_parameters = donate_inputs_;
+
+  // The arguments of the computation; if batch bucketing applies, the
+  // non-constant inputs padded to the bucket size.
+  std::vector<const Tensor*> inputs(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    inputs[i] = &ctx->input(i);
+  }
+  int64 batch_size = -1;
+  int64 bucket_size = -1;
+  std::vector<Tensor> padded_inputs;
+  if (!batch_buckets_.empty()) {
+    std::vector<const Tensor*> nonconst_inputs(
+        inputs.begin() + num_constant_args_, inputs.end());
+    batch_size = SharedBatchSize(nonconst_inputs);
+    bucket_size = BatchBucketFor(batch_buckets_, batch_size);
+  }
+  if (bucket_size > batch_size) {
+    VLOG(2) << "Padding batch size " << batch_size << " to " << bucket_size;
+    padded_inputs.resize(ctx->num_inputs());
+    for (int i = num_constant_args_; i < ctx->num_inputs(); ++i) {
+      if (inputs[i]->dims() == 0) continue;
+      OP_REQUIRES_OK(ctx, PadBatch(ctx, stream, *inputs[i], bucket_size,
+                                   &padded_inputs[i]));
+      inputs[i] = &padded_inputs[i];
+    }
+    xla_padded_launches->GetCell()->IncrementBy(1);
+  } else {
+    bucket_size = -1;
+  }
 
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
-  OP_REQUIRES_OK(ctx, cache->Compile(options, function_, num_constant_args_, {},
-                                     ctx, &kernel, &executable));
+  if (async_compilation_) {
+    OP_REQUIRES_OK(ctx, cache->CompileAsync(options, function_,
+                                            num_constant_args_, {}, inputs, ctx,
+                                            &kernel, &executable));
+    if (kernel == nullptr) {
+      *use_fallback = true;
+      return;
+    }
+  } else {
+    OP_REQUIRES_OK(ctx,
+                   cache->Compile(options, function_, num_constant_args_, {},
+                                  inputs, ctx, &kernel, &executable));
+  }
 
   VLOG(1) << "Executing XLA Computation...";
 
@@ -237,14 +425,22 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
     arg_buffers.reserve(kernel->xla_input_shapes.size() + 1);
     arg_buffers.resize(kernel->xla_input_shapes.size());
     std::vector<xla::ShapedBuffer*> arg_ptrs(arg_buffers.size());
+    // The arguments whose buffers are donated to the executable.
+    std::vector<Tensor> donated_inputs(donate_inputs_ ? arg_buffers.size() : 0);
 
     // Pass remaining parameters.
     for (int i = 0; i < kernel->xla_input_shapes.size(); ++i) {
       int arg_num = kernel->input_mapping[i];
       const xla::Shape& shape = kernel->xla_input_shapes[i];
-      gpu::DeviceMemoryBase dmem(
-          const_cast<char*>(ctx->input(arg_num).tensor_data().data()),
-          ctx->input(arg_num).tensor_data().size());
+      const Tensor* input = inputs[arg_num];
+      if (donate_inputs_) {
+        OP_REQUIRES_OK(ctx, DonatableInput(ctx, stream, arg_num, *input,
+                                           &donated_inputs[i]));
+        input = &donated_inputs[i];
+        xla_allocator.AddDonatedArgument(*input);
+      }
+      gpu::DeviceMemoryBase dmem(const_cast<char*>(input->tensor_data().data()),
+                                 input->tensor_data().size());
 
       arg_buffers[i] =
           xla::ShapedBuffer::MakeArrayShapedBuffer(
@@ -271,11 +467,33 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
     run_options.set_stream(stream);
     run_options.set_allocator(&xla_allocator);
     run_options.set_intra_op_thread_pool(&ctx->eigen_cpu_device());
+    // When the step collects stats, also collect the per-HLO profile (if the
+    // executable was compiled with HLO profiling) to report it as sub-nodes.
+    StepStatsCollector* stats_collector = ctx->stats_collector();
+    xla::HloExecutionProfile hlo_execution_profile;
+    if (stats_collector != nullptr) {
+      run_options.set_hlo_execution_profile(&hlo_execution_profile);
+    }
     Env* env = Env::Default();
     auto start_time = env->NowMicros();
     auto run_result = executable->Run(arg_ptrs, run_options);
     OP_REQUIRES(ctx, run_result.ok(), run_result.status());
 
+    if (stats_collector != nullptr &&
+        executable->executable()->hlo_profiling_enabled()) {
+      const double clock_rate_ghz = client->backend()
+                                        .default_stream_executor()
+                                        ->GetDeviceDescription()
+                                        .clock_rate_ghz();
+      for (NodeExecStats& nt : HloProfileToNodeExecStats(
+               hlo_execution_profile, executable->executable()->module(),
+               clock_rate_ghz, name(), start_time)) {
+        NodeExecStats* saved = new NodeExecStats;
+        saved->Swap(&nt);
+        stats_collector->Save(ctx->device()->attributes().name(), saved);
+      }
+    }
+
     if (local_runtime_context.error) {
       ctx->CtxFailure(errors::InvalidArgument(
           "Compiled kernel returned error: ", local_runtime_context.error_msg));
@@ -332,6 +550,11 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
       OP_REQUIRES_OK(ctx, xla_allocator.MakeTensorFromBuffer(
                               buffer, ctx->expected_output_dtype(i), shape,
                               &output_tensor));
+      if (bucket_size > 0 && shape.dims() > 0 &&
+          shape.dim_size(0) == bucket_size) {
+        // Slices off the rows computed from the padding.
+        output_tensor = output_tensor.Slice(0, batch_size);
+      }
       ctx->set_output(i, output_tensor);
       ++output_num;
     }
@@ -35,14 +35,27 @@ namespace tensorflow {
 // XlaLocalLaunchOp uses xla::LocalClient::Compile() and
 // xla::LocalExecutable::Run(), and passes arguments into/out of XLA in device
 // memory.
-class XlaLocalLaunchOp : public OpKernel {
+// If batch buckets are configured, the inputs are padded along their first
+// dimension up to the nearest bucket before compilation and execution, and the
+// outputs are sliced back, so that nearby batch sizes share an executable.
+// If asynchronous compilation is enabled, the computation is compiled in the
+// background, and the original TensorFlow function of the cluster is run
+// instead until the executable is ready.
+class XlaLocalLaunchOp : public AsyncOpKernel {
  public:
   explicit XlaLocalLaunchOp(OpKernelConstruction* ctx);
   ~XlaLocalLaunchOp() override;
 
-  void Compute(OpKernelContext* ctx) override;
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override;
 
  private:
+  // Compiles and runs the XLA computation. Sets `*use_fallback` instead if
+  // it is still being compiled in the background.
+  void RunCompiled(OpKernelContext* ctx, bool* use_fallback);
+
+  // Runs `function_` with the function library runtime of `ctx`.
+  void RunFallback(OpKernelContext* ctx, DoneCallback done);
+
   // Builds a XlaCompilationCache class suitable for the current device.
   Status BuildCompilationCache(OpKernelContext* ctx,
                                XlaCompilationCache** compiler);
@@ -51,6 +64,16 @@ class XlaLocalLaunchOp : public OpKernel {
   NameAttrList function_;
   int num_constant_args_;
 
+  // Sorted batch sizes to which the non-constant inputs are padded; see
+  // batch_bucketing.h.
+  std::vector<int64> batch_buckets_;
+
+  // Compile in the background and run `function_` meanwhile?
+  bool async_compilation_;
+
+  // Let the executable write its outputs in place of its inputs?
+  bool donate_inputs_;
+
   perftools::gputools::Platform::Id platform_id_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(XlaLocalLaunchOp);
@@ -38,6 +38,8 @@ static void AllocateFlags() {
   flags->tf_xla_auto_jit = 0;
   flags->tf_xla_min_cluster_size = 2;
   flags->tf_xla_max_cluster_size = std::numeric_limits<int32>::max();
+  flags->tf_xla_min_cluster_cost = 0;
+  flags->tf_xla_cluster_static_shapes_only = false;
   flags->tf_xla_clustering_debug = false;
   flag_list = new std::vector<Flag>({
       Flag("tf_xla_auto_jit", &flags->tf_xla_auto_jit,
@@ -51,6 +53,17 @@ static void AllocateFlags() {
            "for compilation."),
       Flag("tf_xla_max_cluster_size", &flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_min_cluster_cost", &flags->tf_xla_min_cluster_cost,
+           "Minimum estimated benefit of an XLA compilation: the number of "
+           "bytes of the statically shaped tensors flowing between its "
+           "operators, which compilation keeps out of memory. Ignored like "
+           "tf_xla_min_cluster_size."),
+      Flag("tf_xla_cluster_static_shapes_only",
+           &flags->tf_xla_cluster_static_shapes_only,
+           "Only cluster operators whose input and output shapes are known "
+           "when the graph is built, so that the clusters are not recompiled "
+           "for each new shape. Ignored for operators placed on an XLA "
+           "device or operators explicitly marked for compilation."),
       Flag("tf_xla_clustering_debug", &flags->tf_xla_clustering_debug,
            "Dump graphs during XLA compilation."),
   });
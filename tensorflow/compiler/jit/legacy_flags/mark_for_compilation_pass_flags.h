@@ -45,6 +45,13 @@ typedef struct {
                                   // marked for compilation.
   int32 tf_xla_max_cluster_size;  // Maximum number of operators in an XLA
                                   // compilation.
+  int64 tf_xla_min_cluster_cost;  // Minimum estimated benefit, in bytes of
+                                  // intermediate tensors kept within the
+                                  // cluster, of an XLA compilation. Ignored
+                                  // like tf_xla_min_cluster_size.
+  bool tf_xla_cluster_static_shapes_only;  // Only cluster operators whose
+                                           // input and output shapes are
+                                           // statically known.
   bool tf_xla_clustering_debug;   // Dump graphs during XLA compilation.
 } MarkForCompilationPassFlags;
 
@@ -0,0 +1,78 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Legacy flags for the XLA bridge's xla_local_launch_op module.
+
+#include <mutex>
+#include <vector>
+
+#include "tensorflow/compiler/jit/legacy_flags/xla_launch_op_flags.h"
+#include "tensorflow/compiler/xla/legacy_flags/parse_flags_from_env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// Pointers to the parsed value of the flags and flag descriptors, initialized
+// via flags_init.
+static XlaLaunchOpFlags* flags;
+static std::vector<Flag>* flag_list;
+static std::once_flag flags_init;
+
+// Allocate *flags.  Called via call_once(&flags_init,...).
+static void AllocateFlags() {
+  flags = new XlaLaunchOpFlags;
+  flags->tf_xla_batch_buckets = "";
+  flags->tf_xla_async_compilation = false;
+  flags->tf_xla_donate_inputs = false;
+  flag_list = new std::vector<Flag>({
+      Flag("tf_xla_batch_buckets", &flags->tf_xla_batch_buckets,
+           "Comma-separated list of batch sizes, e.g. \"8,32,128\".  If "
+           "non-empty, the inputs of compiled clusters are padded along their "
+           "first dimension up to the smallest listed size that fits, and "
+           "the outputs sliced back, so that one executable serves nearby "
+           "batch sizes.  Only valid for clusters whose computation is "
+           "independent across the first dimension.  Experimental."),
+      Flag("tf_xla_async_compilation", &flags->tf_xla_async_compilation,
+           "Compile clusters in the background instead of blocking their "
+           "first execution, and run their original TensorFlow function "
+           "until the compiled executable is ready.  Experimental."),
+      Flag("tf_xla_donate_inputs", &flags->tf_xla_donate_inputs,
+           "Donate the input buffers of compiled clusters to their "
+           "executables, so that outputs such as in-place updates can be "
+           "written over their inputs.  Inputs that other ops may still read "
+           "are copied first.  Experimental."),
+  });
+  xla::legacy_flags::ParseFlagsFromEnv(*flag_list);
+}
+
+// Append to *append_to flag definitions associated with the XLA bridge's
+// xla_local_launch_op module.
+void AppendXlaLaunchOpFlags(std::vector<Flag>* append_to) {
+  std::call_once(flags_init, &AllocateFlags);
+  append_to->insert(append_to->end(), flag_list->begin(), flag_list->end());
+}
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags() {
+  std::call_once(flags_init, &AllocateFlags);
+  return flags;
+}
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
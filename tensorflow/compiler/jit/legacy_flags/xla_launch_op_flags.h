@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+#define TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
+
+// Legacy flags for the XLA bridge's xla_local_launch_op module.
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace legacy_flags {
+
+// Append to *flag_list flag definitions associated with the XLA bridge's
+// xla_local_launch_op module.
+void AppendXlaLaunchOpFlags(std::vector<tensorflow::Flag>* flag_list);
+
+// The values of flags associated with the XLA bridge's
+// xla_local_launch_op module.
+typedef struct {
+  string tf_xla_batch_buckets;  // Comma-separated list of batch sizes to which
+                                // the inputs of compiled clusters are padded
+                                // along their first dimension, so that one
+                                // executable serves nearby batch sizes. Only
+                                // valid for clusters whose computation is
+                                // independent across the first dimension.
+  bool tf_xla_async_compilation;  // Compile clusters in the background, and
+                                  // run their original TensorFlow function
+                                  // until the compiled executable is ready.
+  bool tf_xla_donate_inputs;  // Let compiled clusters write their outputs in
+                              // place of their inputs, copying the inputs
+                              // that other ops may still read.
+} XlaLaunchOpFlags;
+
+// Return a pointer to the XlaLaunchOpFlags struct;
+// repeated calls return the same pointer.
+// This should be called only after Flags::Parse() has returned.
+XlaLaunchOpFlags* GetXlaLaunchOpFlags();
+
+}  // namespace legacy_flags
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_LEGACY_FLAGS_XLA_LAUNCH_OP_FLAGS_H_
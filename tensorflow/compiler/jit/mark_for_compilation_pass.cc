@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/dump_graph.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -217,6 +218,75 @@ struct Cluster {
   int representative = -1;
 };
 
+// Tests whether 'node' is compiled whatever its cluster: it is explicitly
+// marked for compilation (_XlaCompile=true) or placed on a device that
+// requires compilation.
+Status MustCompile(const Node& node, const FunctionLibraryDefinition& flib_def,
+                   bool* must_compile) {
+  bool compile_attr = false;
+  if (GetNodeAttr(node.attrs(), kXlaCompileAttr, &compile_attr).ok() ||
+      flib_def.GetAttr(node, kXlaCompileAttr, &compile_attr).ok()) {
+    if (compile_attr) {
+      *must_compile = true;
+      return Status::OK();
+    }
+  }
+  DeviceType device_type("");
+  TF_RETURN_IF_ERROR(
+      DeviceTypeOfDevice(node.assigned_device_name(), &device_type));
+  const XlaOpRegistry::DeviceRegistration* registration;
+  XlaOpRegistry::GetCompilationDevice(device_type.type(), &registration);
+  *must_compile = registration->requires_compilation;
+  return Status::OK();
+}
+
+// Infers the shapes of the nodes of 'graph' as far as possible. The nodes
+// whose shapes can't be inferred, such as the Merge nodes of loops whose
+// back edges come later in the order, have no context in 'refiner', and
+// neither do their consumers.
+void InferShapes(const Graph& graph, ShapeRefiner* refiner) {
+  refiner->set_require_shape_inference_fns(false);
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  for (const Node* node : order) {
+    if (!node->IsOp()) continue;
+    Status status = refiner->AddNode(node);
+    if (!status.ok()) {
+      VLOG(2) << "Could not infer the shapes of " << node->name() << ": "
+              << status;
+    }
+  }
+}
+
+// Tests whether the shapes of the inputs and outputs of 'node' are known
+// statically, so that a cluster holding 'node' is not recompiled for new
+// shapes of its tensors.
+bool HasStaticShapes(const Node& node, const ShapeRefiner& refiner) {
+  shape_inference::InferenceContext* context = refiner.GetContext(&node);
+  if (context == nullptr) return false;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->FullyDefined(context->input(i))) return false;
+  }
+  for (int i = 0; i < context->num_outputs(); ++i) {
+    if (!context->FullyDefined(context->output(i))) return false;
+  }
+  return true;
+}
+
+// Returns the number of bytes of the output 'index' of 'node', or 0 if its
+// shape is not known statically.
+int64 OutputBytes(const Node& node, int index, const ShapeRefiner& refiner) {
+  shape_inference::InferenceContext* context = refiner.GetContext(&node);
+  if (context == nullptr) return 0;
+  shape_inference::ShapeHandle shape = context->output(index);
+  if (!context->FullyDefined(shape)) return 0;
+  int64 num_elements = 1;
+  for (int i = 0; i < context->Rank(shape); ++i) {
+    num_elements *= context->Value(context->Dim(shape, i));
+  }
+  return num_elements * DataTypeSize(BaseType(node.output_type(index)));
+}
+
 }  // anonymous namespace
 
 bool IsCompilable(FunctionLibraryRuntime* flr, const NodeDef& ndef) {
@@ -302,6 +372,35 @@ Status MarkForCompilationPass::RunImpl(
                                            : Env::Default(),
       is_compilable_fn, &compilation_candidates));
 
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+
+  // Shape information, for the clustering heuristics that need it.
+  std::unique_ptr<ShapeRefiner> shape_refiner;
+  if (flags->tf_xla_cluster_static_shapes_only ||
+      flags->tf_xla_min_cluster_cost > 0) {
+    shape_refiner.reset(
+        new ShapeRefiner(graph->versions(), graph->op_registry()));
+    InferShapes(*graph, shape_refiner.get());
+  }
+
+  if (flags->tf_xla_cluster_static_shapes_only) {
+    // Leave the shape-dynamic regions of the graph out of the clusters,
+    // unless they are compiled anyway.
+    for (auto it = compilation_candidates.begin();
+         it != compilation_candidates.end();) {
+      bool must_compile = false;
+      TF_RETURN_IF_ERROR(MustCompile(**it, *options.flib_def, &must_compile));
+      if (!must_compile && !HasStaticShapes(**it, *shape_refiner)) {
+        VLOG(2) << "Compilation rejected node: dynamic shapes "
+                << (*it)->name();
+        it = compilation_candidates.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
   GraphCycles cycles;
   for (int i = 0; i < graph->num_node_ids(); ++i) {
     // We rely on the node IDs in the cycle detection graph being consecutive
@@ -387,9 +486,6 @@ Status MarkForCompilationPass::RunImpl(
     worklist.push_back(&clusters[node->id()]);
   }
 
-  legacy_flags::MarkForCompilationPassFlags* flags =
-      legacy_flags::GetMarkForCompilationPassFlags();
-
   // Repeatedly contract edges between clusters that are on the same device,
   // provided the contraction would not create a cycle.
   while (!worklist.empty()) {
@@ -470,40 +566,51 @@ Status MarkForCompilationPass::RunImpl(
     cluster_sizes[cluster]++;
   }
 
+  // Estimate the benefit of each cluster as the number of bytes of the
+  // tensors flowing between its nodes, which compilation can keep out of
+  // memory by fusing their producers and consumers.
+  const int64 min_cluster_cost = flags->tf_xla_min_cluster_cost;
+  std::vector<int64> cluster_costs(graph->num_node_ids());
+  if (min_cluster_cost > 0) {
+    for (const Edge* edge : graph->edges()) {
+      if (edge->IsControlEdge() ||
+          compilation_candidates.count(edge->src()) == 0 ||
+          compilation_candidates.count(edge->dst()) == 0) {
+        continue;
+      }
+      const int cluster = clusters[edge->src()->id()].Get().representative;
+      if (cluster != clusters[edge->dst()->id()].Get().representative) {
+        continue;
+      }
+      cluster_costs[cluster] +=
+          OutputBytes(*edge->src(), edge->src_output(), *shape_refiner);
+    }
+  }
+
   // Names for each cluster.
   std::unordered_map<int, string> cluster_names;
 
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
-  // * have more than flags->tf_xla_min_cluster_size elements (applicable only
-  //   if compilation is enabled, otherwise there will be no such candidates).
+  // * have more than flags->tf_xla_min_cluster_size elements and an
+  //   estimated benefit of at least flags->tf_xla_min_cluster_cost
+  //   (applicable only if compilation is enabled, otherwise there will be
+  //   no such candidates).
   const int min_cluster_size = flags->tf_xla_min_cluster_size;
   for (Node* n : compilation_candidates) {
     int cluster = clusters[n->id()].Get().representative;
 
-    // Compile if the user marked this node _XlaCompile=true
-    bool compile_attr = false;
-    bool marked_for_compilation = false;
-    if (GetNodeAttr(n->attrs(), kXlaCompileAttr, &compile_attr).ok()) {
-      marked_for_compilation = compile_attr;
-    } else if (options.flib_def->GetAttr(*n, kXlaCompileAttr, &compile_attr)
-                   .ok()) {
-      marked_for_compilation = compile_attr;
-    }
-
-    // Compile if this operator is placed on a device that requires
-    // compilation.
-    DeviceType device_type("");
-    TF_RETURN_IF_ERROR(
-        DeviceTypeOfDevice(n->assigned_device_name(), &device_type));
-    const XlaOpRegistry::DeviceRegistration* registration;
-    XlaOpRegistry::GetCompilationDevice(device_type.type(), &registration);
+    // Compile if the user marked this node _XlaCompile=true, or if it is
+    // placed on a device that requires compilation.
+    bool must_compile = false;
+    TF_RETURN_IF_ERROR(MustCompile(*n, *options.flib_def, &must_compile));
 
     // Or compile if this is a cluster of >= min_cluster_size compilable
-    // operators.
-    if (cluster_sizes[cluster] >= min_cluster_size || marked_for_compilation ||
-        registration->requires_compilation) {
+    // operators that is worth compiling.
+    if ((cluster_sizes[cluster] >= min_cluster_size &&
+         cluster_costs[cluster] >= min_cluster_cost) ||
+        must_compile) {
       string& name = cluster_names[cluster];
       if (name.empty()) {
         name = strings::StrCat("cluster_", cluster_sequence_num++);
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/control_flow_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/mark_for_compilation_pass_flags.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -93,6 +94,62 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+// Builds a chain Const "A" -> Relu "B" -> Relu "C" of float tensors with
+// 'num_elements' elements, and an uncompilable source "D" of unknown shape
+// -> Relu "E" -> Relu "F".
+void BuildStaticAndDynamicChains(int64 num_elements, Graph* graph) {
+  GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+  Node* a = ops::SourceOp(
+      "Const", builder.opts()
+                   .WithName("A")
+                   .WithAttr("dtype", DT_FLOAT)
+                   .WithAttr("value", Tensor(DT_FLOAT, {num_elements})));
+  Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+  ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+  Node* d = ops::SourceOp("UncompilableNullary", builder.opts().WithName("D"));
+  Node* e = ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+  ops::UnaryOp("Relu", e, builder.opts().WithName("F"));
+  TF_EXPECT_OK(builder.ToGraph(graph));
+}
+
+TEST(XlaCompilationTest, StaticShapesOnly) {
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  flags->tf_xla_cluster_static_shapes_only = true;
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  BuildStaticAndDynamicChains(4, graph.get());
+  MarkForCompilation(&graph);
+  flags->tf_xla_cluster_static_shapes_only = false;
+
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(3, clusters.size());
+  EXPECT_EQ(clusters["A"], clusters["B"]);
+  EXPECT_EQ(clusters["A"], clusters["C"]);
+}
+
+TEST(XlaCompilationTest, MinClusterCost) {
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  flags->tf_xla_min_cluster_cost = 1024;
+  // A -> B -> C carries 2 * 4 * 16 bytes: not worth compiling. E -> F has an
+  // unknown shape, hence no estimated benefit.
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  BuildStaticAndDynamicChains(16, graph.get());
+  MarkForCompilation(&graph);
+  EXPECT_TRUE(GetClusters(*graph).empty());
+
+  // A -> B -> C carries 2 * 4 * 256 bytes.
+  graph.reset(new Graph(OpRegistry::Global()));
+  BuildStaticAndDynamicChains(256, graph.get());
+  MarkForCompilation(&graph);
+  flags->tf_xla_min_cluster_cost = 0;
+
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(3, clusters.size());
+  EXPECT_EQ(clusters["A"], clusters["B"]);
+  EXPECT_EQ(clusters["A"], clusters["C"]);
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   GraphDef graphdef;
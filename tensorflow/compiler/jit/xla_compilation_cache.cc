@@ -31,12 +31,23 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* xla_compilations = monitoring::Counter<1>::New(
+    "/tensorflow/compiler/jit/xla_compilations",
+    "The number of XLA computations compiled by the JIT compilation cache, "
+    "i.e. the number of cache misses, per function.",
+    "function");
+
+}  // namespace
+
 XlaCompilationCache::XlaCompilationCache(xla::Client* client,
                                          DeviceType device_type)
     : client_(client), device_type_(std::move(device_type)) {}
@@ -93,30 +104,31 @@ uint64 XlaCompilationCache::Signature::Hash::operator()(
 
 Status XlaCompilationCache::BuildSignature(
     const NameAttrList& function, int num_constant_args,
-    const std::vector<OptionalTensor>& variable_args, OpKernelContext* ctx,
-    Signature* signature) {
+    const std::vector<OptionalTensor>& variable_args,
+    const std::vector<const Tensor*>& inputs, Signature* signature) {
+  const int num_inputs = inputs.size();
   signature->name = Canonicalize(function.name(), AttrSlice(&function.attr()));
   signature->arg_values.resize(num_constant_args);
 
-  signature->arg_types.reserve(ctx->num_inputs() - num_constant_args);
+  signature->arg_types.reserve(num_inputs - num_constant_args);
 
   // Inputs are in the order: constants, non-constants, resource variables.
   int input_num = 0;
   // Use the values of compile time constants in the signature->
   while (input_num < num_constant_args) {
-    signature->arg_values[input_num] = ctx->input(input_num);
+    signature->arg_values[input_num] = *inputs[input_num];
     ++input_num;
   }
   // Add the types and shapes of the remaining arguments.
-  while (input_num < ctx->num_inputs() - variable_args.size()) {
-    signature->arg_types.emplace_back(ctx->input_dtype(input_num),
-                                      ctx->input(input_num).shape());
+  while (input_num < num_inputs - variable_args.size()) {
+    signature->arg_types.emplace_back(inputs[input_num]->dtype(),
+                                      inputs[input_num]->shape());
     ++input_num;
   }
   // For variable signatures, use the type and shape of the variable's
   // current value.
   for (const OptionalTensor& variable : variable_args) {
-    TF_RET_CHECK(input_num < ctx->num_inputs());
+    TF_RET_CHECK(input_num < num_inputs);
     if (variable.present) {
       signature->arg_types.emplace_back(variable.value.dtype(),
                                         variable.value.shape());
@@ -130,20 +142,22 @@ Status XlaCompilationCache::BuildSignature(
 
 namespace {
 
-// Builds a XlaCompiler::Argument vector from the arguments to the _XlaLaunch
-// op. The first `num_constant_args` arguments must be host-memory Tensors.
+// Builds a XlaCompiler::Argument vector from the arguments `inputs` to the
+// _XlaLaunch op. The first `num_constant_args` arguments must be host-memory
+// Tensors.
 Status BuildArguments(int num_constant_args,
                       const std::vector<OptionalTensor>& variable_args,
-                      OpKernelContext* ctx,
+                      const std::vector<const Tensor*>& inputs,
                       std::vector<XlaCompiler::Argument>* args) {
-  args->resize(ctx->num_inputs());
+  const int num_inputs = inputs.size();
+  args->resize(num_inputs);
 
   int input_num = 0;
 
   // Handles compile-time constants.
-  TF_RET_CHECK(num_constant_args <= ctx->num_inputs());
+  TF_RET_CHECK(num_constant_args <= num_inputs);
   while (input_num < num_constant_args) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = *inputs[input_num];
     TF_RET_CHECK(input.dtype() != DT_RESOURCE);
     XlaCompiler::Argument& arg = (*args)[input_num];
     arg.kind = XlaCompiler::Argument::kConstant;
@@ -156,11 +170,10 @@ Status BuildArguments(int num_constant_args,
 
   // Handles the non-constant arguments.
   int num_variable_args = variable_args.size();
-  int num_nonconst_args =
-      ctx->num_inputs() - num_variable_args - num_constant_args;
+  int num_nonconst_args = num_inputs - num_variable_args - num_constant_args;
   TF_RET_CHECK(num_nonconst_args >= 0);
   while (input_num < num_constant_args + num_nonconst_args) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = *inputs[input_num];
     TF_RET_CHECK(input.dtype() != DT_RESOURCE);
     XlaCompiler::Argument& arg = (*args)[input_num];
     if (input.NumElements() > 0) {
@@ -176,9 +189,9 @@ Status BuildArguments(int num_constant_args,
   }
 
   // Handles resource variables.
-  TF_RET_CHECK(input_num + num_variable_args == ctx->num_inputs());
+  TF_RET_CHECK(input_num + num_variable_args == num_inputs);
   for (int variable_id = 0; variable_id < num_variable_args; ++variable_id) {
-    const Tensor& input = ctx->input(input_num);
+    const Tensor& input = *inputs[input_num];
     TF_RET_CHECK(input.dtype() == DT_RESOURCE);
 
     XlaCompiler::Argument& arg = (*args)[input_num];
@@ -214,14 +227,29 @@ Status XlaCompilationCache::Compile(
     OpKernelContext* ctx,
     const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable) {
+  std::vector<const Tensor*> inputs(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    inputs[i] = &ctx->input(i);
+  }
+  return Compile(options, function, num_constant_args, variable_args, inputs,
+                 ctx, compilation_result, executable);
+}
+
+Status XlaCompilationCache::Compile(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    const std::vector<const Tensor*>& inputs, OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable) {
   VLOG(1) << "XlaCompilationCache::Compile " << DebugString();
+  TF_RET_CHECK(inputs.size() == ctx->num_inputs());
 
   if (VLOG_IS_ON(2)) {
     VLOG(2) << "num_inputs=" << ctx->num_inputs()
             << " num_constant_args=" << num_constant_args
             << " num_variable_args=" << variable_args.size();
     for (int i = 0; i < ctx->num_inputs(); i++) {
-      TensorShape shape = ctx->input(i).shape();
+      TensorShape shape = inputs[i]->shape();
       VLOG(2) << i << ": dtype=" << DataTypeString(ctx->input_dtype(i))
               << " present=" << ctx->has_input(i)
               << " shape=" << shape.DebugString();
@@ -241,35 +269,28 @@ Status XlaCompilationCache::Compile(
 
   Signature signature;
   TF_RETURN_IF_ERROR(BuildSignature(function, num_constant_args, variable_args,
-                                    ctx, &signature));
+                                    inputs, &signature));
 
   VLOG(2) << "Signature: " << SignatureDebugString(signature);
-  // The outer lock protects the existence of the cache entry. It does not
-  // protect the contents of the cache entry.
-  Entry* entry;
-  {
-    mutex_lock lock(mu_);
-    // Find or create a cache entry.
-    std::unique_ptr<Entry>& e = cache_[signature];
-    if (!e) {
-      e.reset(new Entry);
-    }
-    entry = e.get();
-  }
+  Entry* entry = LookupOrCreateEntry(signature);
 
   // Acquire the cache entry lock and compile, if necessary.
   // TODO(phawkins): this locking will need to be restructured when we implement
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
+  while (entry->compiling) {
+    entry->compiled_cv.wait(entry_lock);
+  }
   if (!entry->compiled) {
     // Do the actual JIT compilation without holding the lock (it can take
     // a long time.)
     std::vector<XlaCompiler::Argument> args;
     TF_RETURN_IF_ERROR(
-        BuildArguments(num_constant_args, variable_args, ctx, &args));
+        BuildArguments(num_constant_args, variable_args, inputs, &args));
 
     XlaCompiler compiler(options);
     entry->compiled = true;
+    xla_compilations->GetCell(function.name())->IncrementBy(1);
     entry->compilation_status =
         compiler.CompileFunction(XlaCompiler::CompileOptions(), function, args,
                                  &entry->compilation_result);
@@ -289,4 +310,84 @@ Status XlaCompilationCache::Compile(
   return status;
 }
 
+XlaCompilationCache::Entry* XlaCompilationCache::LookupOrCreateEntry(
+    const Signature& signature) {
+  // The outer lock protects the existence of the cache entry. It does not
+  // protect the contents of the cache entry.
+  mutex_lock lock(mu_);
+  // Find or create a cache entry.
+  std::unique_ptr<Entry>& e = cache_[signature];
+  if (!e) {
+    e.reset(new Entry);
+  }
+  return e.get();
+}
+
+Status XlaCompilationCache::CompileAsync(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    const std::vector<const Tensor*>& inputs, OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable) {
+  TF_RET_CHECK(inputs.size() == ctx->num_inputs());
+  TF_RET_CHECK(num_constant_args + variable_args.size() <= ctx->num_inputs());
+
+  Signature signature;
+  TF_RETURN_IF_ERROR(BuildSignature(function, num_constant_args, variable_args,
+                                    inputs, &signature));
+  Entry* entry = LookupOrCreateEntry(signature);
+  {
+    mutex_lock entry_lock(entry->mu);
+    if (!entry->compiled) {
+      *compilation_result = nullptr;
+      *executable = nullptr;
+      if (entry->compiling) {
+        return Status::OK();
+      }
+
+      std::vector<XlaCompiler::Argument> args;
+      TF_RETURN_IF_ERROR(
+          BuildArguments(num_constant_args, variable_args, inputs, &args));
+      // The function library of the caller may be destroyed before the
+      // compilation finishes, so compile against a copy.
+      std::shared_ptr<FunctionLibraryDefinition> flib_def(
+          new FunctionLibraryDefinition(*options.flib_def));
+      XlaCompiler::Options async_options = options;
+      async_options.flib_def = flib_def.get();
+
+      VLOG(1) << "Compiling " << SignatureDebugString(signature)
+              << " in the background";
+      entry->compiling = true;
+      xla_compilations->GetCell(function.name())->IncrementBy(1);
+      // Keeps the cache, hence the entry, alive until compilation is done.
+      Ref();
+      Env::Default()->SchedClosure([this, entry, async_options, flib_def,
+                                    function, args]() {
+        XlaCompiler compiler(async_options);
+        XlaCompiler::CompilationResult result;
+        std::unique_ptr<xla::LocalExecutable> local_executable;
+        Status status = compiler.CompileFunction(
+            XlaCompiler::CompileOptions(), function, args, &result);
+        if (status.ok() && !result.computation->IsNull()) {
+          status = compiler.BuildExecutable(result, &local_executable);
+        }
+        {
+          mutex_lock entry_lock(entry->mu);
+          entry->compilation_status = status;
+          entry->compilation_result = std::move(result);
+          entry->executable = std::move(local_executable);
+          entry->compiled = true;
+          entry->compiling = false;
+        }
+        entry->compiled_cv.notify_all();
+        Unref();
+      });
+      return Status::OK();
+    }
+  }
+  // Already compiled: this returns the cached result.
+  return Compile(options, function, num_constant_args, variable_args, inputs,
+                 ctx, compilation_result, executable);
+}
+
 }  // namespace tensorflow
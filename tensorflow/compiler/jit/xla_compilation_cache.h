@@ -68,6 +68,32 @@ class XlaCompilationCache : public ResourceBase {
                  const XlaCompiler::CompilationResult** compilation_result,
                  xla::LocalExecutable** executable);
 
+  // Like Compile() above, but compiles for the argument values `inputs`, one
+  // per input of `ctx`, instead of the inputs of `ctx`; e.g. for inputs that
+  // were padded to a batch bucket (see batch_bucketing.h).
+  Status Compile(const XlaCompiler::Options& options,
+                 const NameAttrList& function, int num_constant_args,
+                 const std::vector<OptionalTensor>& variable_args,
+                 const std::vector<const Tensor*>& inputs,
+                 OpKernelContext* ctx,
+                 const XlaCompiler::CompilationResult** compilation_result,
+                 xla::LocalExecutable** executable);
+
+  // Like the Compile() overload above, but never blocks on compilation: if the
+  // compilation for the signature of `inputs` is neither cached nor already in
+  // progress, starts it in the background. Sets `*compilation_result` and
+  // `*executable` to null until the background compilation is done; the
+  // caller is then expected to run `function` some other way. Once done,
+  // behaves like Compile(), including returning compilation errors.
+  // `executable` must be non-null.
+  Status CompileAsync(const XlaCompiler::Options& options,
+                      const NameAttrList& function, int num_constant_args,
+                      const std::vector<OptionalTensor>& variable_args,
+                      const std::vector<const Tensor*>& inputs,
+                      OpKernelContext* ctx,
+                      const XlaCompiler::CompilationResult** compilation_result,
+                      xla::LocalExecutable** executable);
+
   xla::Client* client() const { return client_; }
   const DeviceType& device_type() const { return device_type_; }
 
@@ -99,7 +125,8 @@ class XlaCompilationCache : public ResourceBase {
   // Builds the signature for a compilation.
   Status BuildSignature(const NameAttrList& function, int num_constant_args,
                         const std::vector<OptionalTensor>& variable_args,
-                        OpKernelContext* ctx, Signature* signature);
+                        const std::vector<const Tensor*>& inputs,
+                        Signature* signature);
 
   // The value associated with a cache entry.
   struct Entry {
@@ -108,6 +135,11 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is this entry being compiled in the background? Notified on
+    // `compiled_cv` when the background compilation is done.
+    bool compiling GUARDED_BY(mu) = false;
+    condition_variable compiled_cv;
+
     // Did compilation succeed?
     Status compilation_status GUARDED_BY(mu);
 
@@ -119,6 +151,9 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable GUARDED_BY(mu);
   };
 
+  // Returns the cache entry for `signature`, creating it if needed.
+  Entry* LookupOrCreateEntry(const Signature& signature);
+
   mutex mu_;
   std::unordered_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       GUARDED_BY(mu_);
@@ -131,7 +131,9 @@ XlaDevice::XlaDevice(const SessionOptions& options,
       device_ordinal_(device_ordinal),
       jit_device_name_(jit_device_name),
       xla_allocator_(xla_allocator),
-      platform_(platform) {
+      platform_(platform),
+      host_to_device_thread_(options.env, "xla_host_to_device_copy", 1),
+      device_to_host_thread_(options.env, "xla_device_to_host_copy", 1) {
   // Store the platform in the resource manager so Ops can retrieve it
   // e.g., to lazily create a XlaCompilationCache object.
   TF_CHECK_OK(resource_manager()->Create<Metadata>(
@@ -164,7 +166,8 @@ Status XlaDevice::FillContextMap(const Graph* graph,
                                  DeviceContextMap* device_context_map) {
   VLOG(1) << "XlaDevice::FillContextMap";
   device_context_map->resize(graph->num_node_ids());
-  XlaDeviceContext* ctx = new XlaDeviceContext(client());
+  XlaDeviceContext* ctx = new XlaDeviceContext(
+      client(), &host_to_device_thread_, &device_to_host_thread_);
   for (Node* n : graph->nodes()) {
     VLOG(2) << n->id() << " : " << n->type_string() << " : " << n->name();
     ctx->Ref();
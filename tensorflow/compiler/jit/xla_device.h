@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
 namespace tensorflow {
@@ -107,6 +108,11 @@ class XlaDevice : public LocalDevice {
   const DeviceType& jit_device_name_;
   Allocator* xla_allocator_;                   // Not owned.
   ::perftools::gputools::Platform* platform_;  // Not owned.
+  // Threads that run the host-to-device and device-to-host copies of the
+  // device contexts, so copies in each direction stay ordered but overlap
+  // with computation and with each other.
+  thread::ThreadPool host_to_device_thread_;
+  thread::ThreadPool device_to_host_thread_;
 };
 
 // Builds dummy OpKernel registrations on 'device' for the JIT operators
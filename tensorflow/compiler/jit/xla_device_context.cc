@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/mem.h"
 
 namespace tensorflow {
@@ -78,36 +79,39 @@ static XlaGlobalData* CastTensorToXlaGlobalData(Tensor* tensor) {
   return const_cast<XlaGlobalData*>(expression);
 }
 
-XlaTransferManager::XlaTransferManager(xla::Client* client) : client_(client) {}
+XlaTransferManager::XlaTransferManager(
+    xla::Client* client, thread::ThreadPool* host_to_device_thread,
+    thread::ThreadPool* device_to_host_thread)
+    : client_(client),
+      host_to_device_thread_(host_to_device_thread),
+      device_to_host_thread_(device_to_host_thread) {}
 
 void XlaTransferManager::CopyCPUTensorToDevice(const Tensor* cpu_tensor,
                                                Device* device,
                                                Tensor* device_tensor,
                                                StatusCallback done) const {
-  if (cpu_tensor->NumElements() > 0) {
-    VLOG(2) << "CopyCPUTensorToDevice "
-            << reinterpret_cast<const void*>(cpu_tensor->tensor_data().data())
-            << " " << reinterpret_cast<const void*>(
-                          device_tensor->tensor_data().data())
-            << cpu_tensor->NumElements();
-    xla::Literal literal;
-    Status status = HostTensorToLiteral(*cpu_tensor, &literal);
-    if (!status.ok()) {
-      done(status);
-      return;
-    }
-    auto gd = client_->TransferToServer(literal);
-    if (!gd.ok()) {
-      done(gd.status());
-      return;
-    }
-    SetTensorGlobalData(
-        std::shared_ptr<xla::GlobalData>(std::move(gd.ValueOrDie())),
-        device_tensor);
-  } else {
+  if (cpu_tensor->NumElements() == 0) {
     VLOG(2) << "CopyCPUTensorToDevice empty tensor";
+    done(Status::OK());
+    return;
   }
-  done(Status::OK());
+  VLOG(2) << "CopyCPUTensorToDevice "
+          << reinterpret_cast<const void*>(cpu_tensor->tensor_data().data())
+          << " "
+          << reinterpret_cast<const void*>(device_tensor->tensor_data().data())
+          << cpu_tensor->NumElements();
+  if (host_to_device_thread_ == nullptr) {
+    done(TransferToDevice(client_, *cpu_tensor, device_tensor));
+    return;
+  }
+  // The copies share the buffers of the caller's tensors and keep them alive
+  // until the transfer is done.
+  xla::Client* client = client_;
+  Tensor src = *cpu_tensor;
+  Tensor dst = *device_tensor;
+  host_to_device_thread_->Schedule([client, src, dst, done]() mutable {
+    done(TransferToDevice(client, src, &dst));
+  });
 }
 
 void XlaTransferManager::CopyDeviceTensorToCPU(const Tensor* device_tensor,
@@ -115,36 +119,59 @@ void XlaTransferManager::CopyDeviceTensorToCPU(const Tensor* device_tensor,
                                                Device* device,
                                                Tensor* cpu_tensor,
                                                StatusCallback done) {
-  if (device_tensor->NumElements() > 0) {
-    VLOG(2) << "CopyDeviceTensorToCPU"
-            << reinterpret_cast<const void*>(
-                   device_tensor->tensor_data().data())
-            << " "
-            << reinterpret_cast<const void*>(cpu_tensor->tensor_data().data())
-            << device_tensor->NumElements();
-    std::shared_ptr<xla::GlobalData> global_data =
-        GetTensorGlobalData(*device_tensor);
-
-    xla::Shape shape;
-    Status status =
-        TensorShapeToXLAShape(cpu_tensor->dtype(), cpu_tensor->shape(), &shape);
-    if (!status.ok()) {
-      done(status);
-      return;
-    }
-    auto result = client_->Transfer(*global_data, &shape);
-    if (!result.ok()) {
-      done(result.status());
-      return;
-    }
-    const void* src_ptr = result.ValueOrDie()->InternalData();
-    void* dst_ptr = DMAHelper::base(cpu_tensor);
-    size_t total_bytes = cpu_tensor->TotalBytes();
-    memcpy(dst_ptr, src_ptr, total_bytes);
-  } else {
+  if (device_tensor->NumElements() == 0) {
     VLOG(2) << "CopyDeviceTensorToCPU empty tensor";
+    done(Status::OK());
+    return;
+  }
+  VLOG(2) << "CopyDeviceTensorToCPU "
+          << reinterpret_cast<const void*>(device_tensor->tensor_data().data())
+          << " "
+          << reinterpret_cast<const void*>(cpu_tensor->tensor_data().data())
+          << device_tensor->NumElements();
+  if (device_to_host_thread_ == nullptr) {
+    done(TransferToHost(client_, *device_tensor, cpu_tensor));
+    return;
+  }
+  xla::Client* client = client_;
+  Tensor src = *device_tensor;
+  Tensor dst = *cpu_tensor;
+  device_to_host_thread_->Schedule([client, src, dst, done]() mutable {
+    done(TransferToHost(client, src, &dst));
+  });
+}
+
+/* static */ Status XlaTransferManager::TransferToDevice(
+    xla::Client* client, const Tensor& cpu_tensor, Tensor* device_tensor) {
+  xla::Literal literal;
+  TF_RETURN_IF_ERROR(HostTensorToLiteral(cpu_tensor, &literal));
+  auto gd = client->TransferToServer(literal);
+  if (!gd.ok()) {
+    return gd.status();
+  }
+  SetTensorGlobalData(
+      std::shared_ptr<xla::GlobalData>(std::move(gd.ValueOrDie())),
+      device_tensor);
+  return Status::OK();
+}
+
+/* static */ Status XlaTransferManager::TransferToHost(
+    xla::Client* client, const Tensor& device_tensor, Tensor* cpu_tensor) {
+  std::shared_ptr<xla::GlobalData> global_data =
+      GetTensorGlobalData(device_tensor);
+
+  xla::Shape shape;
+  TF_RETURN_IF_ERROR(
+      TensorShapeToXLAShape(cpu_tensor->dtype(), cpu_tensor->shape(), &shape));
+  auto result = client->Transfer(*global_data, &shape);
+  if (!result.ok()) {
+    return result.status();
   }
-  done(Status::OK());
+  const void* src_ptr = result.ValueOrDie()->InternalData();
+  void* dst_ptr = DMAHelper::base(cpu_tensor);
+  size_t total_bytes = cpu_tensor->TotalBytes();
+  memcpy(dst_ptr, src_ptr, total_bytes);
+  return Status::OK();
 }
 
 std::shared_ptr<xla::GlobalData> XlaTransferManager::GetTensorGlobalData(
@@ -162,7 +189,10 @@ void XlaTransferManager::SetTensorGlobalData(
   data->data = std::move(global_data);
 }
 
-XlaDeviceContext::XlaDeviceContext(xla::Client* client) : manager_(client) {}
+XlaDeviceContext::XlaDeviceContext(xla::Client* client,
+                                   thread::ThreadPool* host_to_device_thread,
+                                   thread::ThreadPool* device_to_host_thread)
+    : manager_(client, host_to_device_thread, device_to_host_thread) {}
 
 void XlaDeviceContext::CopyCPUTensorToDevice(const Tensor* cpu_tensor,
                                              Device* device,
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 
 namespace tensorflow {
 
@@ -48,9 +49,16 @@ class XlaDeviceAllocator : public Allocator {
 };
 
 // Helper class for managing data transfers between host and XLA devices.
+//
+// If copy threads are given, each direction of copies runs in order on its
+// own thread and `done` is called from that thread, so transfers to the
+// device, execution and transfers back to the host can overlap across
+// steps. Otherwise the copies are synchronous.
 class XlaTransferManager {
  public:
-  explicit XlaTransferManager(xla::Client* client);
+  explicit XlaTransferManager(
+      xla::Client* client, thread::ThreadPool* host_to_device_thread = nullptr,
+      thread::ThreadPool* device_to_host_thread = nullptr);
 
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done) const;
@@ -66,7 +74,14 @@ class XlaTransferManager {
                                   Tensor* tensor);
 
  private:
+  static Status TransferToDevice(xla::Client* client, const Tensor& cpu_tensor,
+                                 Tensor* device_tensor);
+  static Status TransferToHost(xla::Client* client,
+                               const Tensor& device_tensor, Tensor* cpu_tensor);
+
   xla::Client* client_;
+  thread::ThreadPool* host_to_device_thread_;  // Not owned, may be null.
+  thread::ThreadPool* device_to_host_thread_;  // Not owned, may be null.
 };
 
 // DeviceContext for operators assigned to XlaDevice devices. The
@@ -74,7 +89,9 @@ class XlaTransferManager {
 // wraps the methods in XlaTransferManager.
 class XlaDeviceContext : public DeviceContext {
  public:
-  explicit XlaDeviceContext(xla::Client* client);
+  XlaDeviceContext(xla::Client* client,
+                   thread::ThreadPool* host_to_device_thread,
+                   thread::ThreadPool* device_to_host_thread);
 
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor,
@@ -180,6 +180,12 @@ Status XlaCompiler::BuildExecutable(
   build_options.set_result_layout(result.xla_output_shape);
   build_options.set_has_hybrid_result(
       options_.local_executable_has_hybrid_result);
+  if (options_.local_executable_donates_parameters) {
+    // The XlaLocalRuntimeContext* is never donated.
+    std::vector<int64> donated_parameters(result.xla_input_shapes.size());
+    std::iota(donated_parameters.begin(), donated_parameters.end(), 0);
+    build_options.set_donated_parameters(donated_parameters);
+  }
 
   auto compile_result = local_client->Compile(*result.computation,
                                               argument_layouts, build_options);
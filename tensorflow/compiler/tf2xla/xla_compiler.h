@@ -213,6 +213,11 @@ class XlaCompiler {
     // stored in device memory.
     bool local_executable_has_hybrid_result = false;
 
+    // If 'local_executable_donates_parameters', the buffers of the parameters
+    // of compiled programs are donated to them: outputs may be written in
+    // place of the arguments, whose contents are undefined after execution.
+    bool local_executable_donates_parameters = false;
+
     // If not nullptr, populate_resource_manager is called with the
     // compilation device's resource manager when the compilation
     // device is created, and can be used to create metadata objects
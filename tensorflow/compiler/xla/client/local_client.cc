@@ -67,6 +67,17 @@ bool ExecutableBuildOptions::has_hybrid_result() const {
   return has_hybrid_result_;
 }
 
+ExecutableBuildOptions& ExecutableBuildOptions::set_donated_parameters(
+    tensorflow::gtl::ArraySlice<int64> donated_parameters) {
+  donated_parameters_.assign(donated_parameters.begin(),
+                             donated_parameters.end());
+  return *this;
+}
+
+const std::vector<int64>& ExecutableBuildOptions::donated_parameters() const {
+  return donated_parameters_;
+}
+
 namespace {
 StatusOr<Backend::StreamPtr> BorrowStreamForDevice(int device_ordinal,
                                                    Backend* backend) {
@@ -292,7 +303,8 @@ StatusOr<std::unique_ptr<LocalExecutable>> LocalClient::Compile(
       std::unique_ptr<Executable> executable,
       local_service_->CompileExecutable(computation.handle(), argument_layouts,
                                         options.result_layout(), device_ordinal,
-                                        options.has_hybrid_result()));
+                                        options.has_hybrid_result(),
+                                        options.donated_parameters()));
   return WrapUnique(new LocalExecutable(std::move(executable),
                                         local_service_->mutable_backend(),
                                         device_ordinal, options));
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_CLIENT_LOCAL_CLIENT_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/compiler/xla/client/client.h"
 #include "tensorflow/compiler/xla/client/computation.h"
@@ -67,12 +68,21 @@ class ExecutableBuildOptions {
   ExecutableBuildOptions& set_has_hybrid_result(bool has_hybrid_result);
   bool has_hybrid_result() const;
 
+  // The numbers of the parameters whose buffers the caller donates to the
+  // executable. Outputs may be written in place of donated parameters, so
+  // their contents are undefined after execution and the caller must not use
+  // them again.
+  ExecutableBuildOptions& set_donated_parameters(
+      tensorflow::gtl::ArraySlice<int64> donated_parameters);
+  const std::vector<int64>& donated_parameters() const;
+
  private:
   perftools::gputools::Platform* platform_ = nullptr;
   int device_ordinal_ = -1;
   Shape result_layout_;
   bool result_layout_set_ = false;
   bool has_hybrid_result_ = true;
+  std::vector<int64> donated_parameters_;
 };
 
 class LocalExecutable {
@@ -42,6 +42,7 @@ namespace xla {
 class DeviceMemoryAllocator;
 class DeviceAssignment;
 class ExecutionProfile;
+class HloExecutionProfile;
 
 // Class containing options for running a LocalExecutable.
 class ExecutableRunOptions {
@@ -80,6 +81,11 @@ class ExecutableRunOptions {
   ExecutionProfile* execution_profile() const;
   ExecutableRunOptions& set_execution_profile(ExecutionProfile* profile);
 
+  // If set, and the executable was compiled with HLO profiling enabled, the
+  // cycles taken by each HLO instruction are written to 'profile'.
+  HloExecutionProfile* hlo_execution_profile() const;
+  ExecutableRunOptions& set_hlo_execution_profile(HloExecutionProfile* profile);
+
   ExecutableRunOptions& set_device_assignment(
       DeviceAssignment* device_assignment);
   DeviceAssignment* device_assignment() const;
@@ -92,6 +98,7 @@ class ExecutableRunOptions {
   tensorflow::thread::ThreadPool* inter_op_thread_pool_ = nullptr;
   const Eigen::ThreadPoolDevice* intra_op_thread_pool_ = nullptr;
   ExecutionProfile* execution_profile_ = nullptr;
+  HloExecutionProfile* hlo_execution_profile_ = nullptr;
 };
 
 }  // namespace xla
@@ -44,9 +44,13 @@ struct DebugOptionsFlags {
   bool xla_eliminate_hlo_implicit_broadcast;
 
   bool xla_cpu_multi_thread_eigen;
+  string xla_cpu_object_cache_dir;
 
   string xla_gpu_cuda_data_dir;
   bool xla_gpu_ftz;
+  string xla_gpu_autotune_cache_dir;
+
+  int32 xla_infeed_queue_depth;
 
   bool xla_test_all_output_layouts;
   bool xla_test_all_input_layouts;
@@ -82,8 +86,11 @@ void AllocateFlags() {
   flag_values->xla_dump_debug_json_to = "";
   flag_values->xla_eliminate_hlo_implicit_broadcast = false;
   flag_values->xla_cpu_multi_thread_eigen = true;
+  flag_values->xla_cpu_object_cache_dir = "";
   flag_values->xla_gpu_cuda_data_dir = "./cuda_sdk_lib";
   flag_values->xla_gpu_ftz = false;
+  flag_values->xla_gpu_autotune_cache_dir = "";
+  flag_values->xla_infeed_queue_depth = 0;
   flag_values->xla_test_all_output_layouts = false;
   flag_values->xla_backend_extra_options = "";
   flag_values->xla_test_all_input_layouts = false;
@@ -154,6 +161,11 @@ void AllocateFlags() {
                         &flag_values->xla_cpu_multi_thread_eigen,
                         "When generating calls to Eigen in the CPU backend, "
                         "use multi-threaded Eigen mode."),
+       tensorflow::Flag("xla_cpu_object_cache_dir",
+                        &flag_values->xla_cpu_object_cache_dir,
+                        "If non-empty, cache the object code generated by the "
+                        "CPU backend in this directory, and reuse it across "
+                        "processes."),
        tensorflow::Flag("xla_gpu_cuda_data_dir",
                         &flag_values->xla_gpu_cuda_data_dir,
                         "If non-empty, speficies a local directory containing "
@@ -162,6 +174,16 @@ void AllocateFlags() {
        tensorflow::Flag("xla_gpu_ftz", &flag_values->xla_gpu_ftz,
                         "If true, flush-to-zero semantics are enabled in the "
                         "code generated for GPUs."),
+       tensorflow::Flag("xla_gpu_autotune_cache_dir",
+                        &flag_values->xla_gpu_autotune_cache_dir,
+                        "If non-empty, persist the convolution algorithms "
+                        "picked by autotuning in the GPU backend in this "
+                        "directory, and reuse them across processes."),
+       tensorflow::Flag("xla_infeed_queue_depth",
+                        &flag_values->xla_infeed_queue_depth,
+                        "If positive, bound the CPU and GPU infeed queues to "
+                        "this many buffers; enqueueing to a full queue "
+                        "blocks. Zero means unbounded."),
        tensorflow::Flag(
            "xla_dump_debug_json_to", &flag_values->xla_dump_debug_json_to,
            "Dump compilation artifacts as JSON into this directory."),
@@ -225,8 +247,12 @@ xla::DebugOptions GetDebugOptionsFromFlags() {
 
   options.set_xla_cpu_multi_thread_eigen(
       flag_values->xla_cpu_multi_thread_eigen);
+  options.set_xla_cpu_object_cache_dir(flag_values->xla_cpu_object_cache_dir);
   options.set_xla_gpu_cuda_data_dir(flag_values->xla_gpu_cuda_data_dir);
   options.set_xla_gpu_ftz(flag_values->xla_gpu_ftz);
+  options.set_xla_gpu_autotune_cache_dir(
+      flag_values->xla_gpu_autotune_cache_dir);
+  options.set_xla_infeed_queue_depth(flag_values->xla_infeed_queue_depth);
   options.set_xla_llvm_enable_alias_scope_metadata(
       flag_values->xla_llvm_enable_alias_scope_metadata);
   options.set_xla_llvm_enable_noalias_metadata(
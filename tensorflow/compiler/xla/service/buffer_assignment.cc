@@ -115,6 +115,9 @@ string BufferAllocation::ToString() const {
   if (is_entry_computation_parameter()) {
     tensorflow::strings::StrAppend(&output, ", parameter ", parameter_number());
   }
+  if (is_donated_parameter()) {
+    tensorflow::strings::StrAppend(&output, ", donated");
+  }
   if (is_thread_local()) {
     tensorflow::strings::StrAppend(&output, ", thread-local");
   }
@@ -615,8 +618,22 @@ bool BufferAssigner::MaybeAssignBuffer(BufferAllocation* allocation,
   }
 
   if (allocation->is_entry_computation_parameter()) {
-    VLOG(4) << "Can't assign: allocation holds parameter";
-    return false;
+    // A single output of the computation may be written in place of a
+    // parameter donated by the caller. The interference check below ensures
+    // the parameter is no longer read once the output is written.
+    if (!allocation->is_donated_parameter()) {
+      VLOG(4) << "Can't assign: allocation holds parameter";
+      return false;
+    }
+    if (!assignment->liveness().MaybeLiveOut(buffer)) {
+      VLOG(4) << "Can't assign: allocation holds donated parameter and buffer "
+              << buffer << " is not live out";
+      return false;
+    }
+    if (allocation->assigned_buffers().size() > 1) {
+      VLOG(4) << "Can't assign: donated parameter already holds an output";
+      return false;
+    }
   }
 
   if (!allocation->is_reusable()) {
@@ -784,13 +801,21 @@ Status BufferAssigner::AssignBuffersForComputation(
       // If the LogicalBuffer is part of an external parameter, creates a new
       // allocation and sets its parameter number. Parameters of non-entry
       // computations do not need special allocations because they live inside
-      // callers.
+      // callers. The allocation of a donated array parameter may be reused
+      // for an output.
+      const bool is_donated =
+          buffer->IsTopLevel() && !buffer->IsTuple() &&
+          computation->parent()->config().IsDonatedParameter(
+              instruction->parameter_number());
       BufferAllocation* allocation =
           assignment->NewAllocation(*buffer, buffer_size,
                                     /*is_thread_local=*/false,
-                                    /*is_reusable=*/false);
+                                    /*is_reusable=*/is_donated);
       allocation->set_entry_computation_parameter(
           instruction->parameter_number());
+      if (is_donated) {
+        allocation->set_donated_parameter();
+      }
       VLOG(3) << "New allocation #" << allocation->index()
               << " for entry computation parameter: " << *buffer;
       continue;
@@ -91,6 +91,12 @@ class BufferAllocation {
     return parameter_number_;
   }
 
+  // Whether this allocation holds an entry computation parameter whose buffer
+  // the caller donated to the computation (see
+  // HloModuleConfig::donated_parameters). An output of the computation may be
+  // assigned to such an allocation, in which case it is also maybe_live_out.
+  bool is_donated_parameter() const { return is_donated_parameter_; }
+
   // Returns whether this allocation is assigned a LogicalBuffer which may
   // be live out of the entry computation.
   bool maybe_live_out() const { return maybe_live_out_; }
@@ -207,6 +213,7 @@ class BufferAllocation {
     is_entry_computation_parameter_ = true;
     parameter_number_ = parameter_number;
   }
+  void set_donated_parameter() { is_donated_parameter_ = true; }
   void set_maybe_live_out(bool value) { maybe_live_out_ = value; }
   void set_index(Index index) { index_ = index; }
   void set_size(int64 size) { size_ = size; }
@@ -235,6 +242,10 @@ class BufferAllocation {
   // indicates the index (starting from 0) of the parameter.
   int64 parameter_number_ = 0;
 
+  // Whether the caller donated the entry computation parameter this
+  // allocation holds, so that an output may be written in its place.
+  bool is_donated_parameter_ = false;
+
   // Whether the allocation contains a LogicalBuffer which may be live-out of
   // the entry computation. Note that this flag is conservatively computed by
   // TuplePointsToAnalysis.  That is, an allocation marked `maybe_live_out_`
@@ -732,6 +732,61 @@ TEST_F(BufferAssignmentTest, UnaryOpReuseChain) {
   EXPECT_EQ(buffer_for_exp1, GetTopLevelAllocation(*assignment, neg));
 }
 
+TEST_F(BufferAssignmentTest, OutputReusesDonatedParameter) {
+  // param0[100] --->(add)
+  // param1[100] ---/
+  auto builder = HloComputation::Builder(TestName());
+  auto param0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, f32vec100_, "param0"));
+  auto param1 = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, f32vec100_, "param1"));
+  auto add = builder.AddInstruction(HloInstruction::CreateBinary(
+      f32vec100_, HloOpcode::kAdd, param0, param1));
+
+  HloModuleConfig config;
+  config.set_donated_parameters({0});
+  auto module =
+      MakeUnique<HloModule>(TestName(), VersionedComputationHandle(), config);
+  module->AddEntryComputation(builder.Build());
+  auto assignment = RunBufferAssignment(module.get());
+
+  // The sum is written in place of the donated param0, but not of param1.
+  const BufferAllocation& add_buffer = GetTopLevelAllocation(*assignment, add);
+  EXPECT_EQ(GetTopLevelAllocation(*assignment, param0), add_buffer);
+  EXPECT_TRUE(add_buffer.is_donated_parameter());
+  EXPECT_TRUE(add_buffer.maybe_live_out());
+  EXPECT_EQ(0, add_buffer.parameter_number());
+  EXPECT_NE(GetTopLevelAllocation(*assignment, param1), add_buffer);
+}
+
+TEST_F(BufferAssignmentTest, DonatedParameterStillUsedIsNotReused) {
+  // param0[100] --->(add)--->(tuple)
+  //            \--->(negate)--/
+  auto builder = HloComputation::Builder(TestName());
+  auto param0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, f32vec100_, "param0"));
+  auto add = builder.AddInstruction(HloInstruction::CreateBinary(
+      f32vec100_, HloOpcode::kAdd, param0, param0));
+  auto negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kNegate, param0));
+  builder.AddInstruction(HloInstruction::CreateTuple({add, negate}));
+
+  HloModuleConfig config;
+  config.set_donated_parameters({0});
+  auto module =
+      MakeUnique<HloModule>(TestName(), VersionedComputationHandle(), config);
+  module->AddEntryComputation(builder.Build());
+  auto assignment = RunBufferAssignment(module.get());
+
+  // param0 may still be read by one output while the other is written, so
+  // neither can overwrite it.
+  const BufferAllocation& param0_buffer =
+      GetTopLevelAllocation(*assignment, param0);
+  EXPECT_NE(param0_buffer, GetTopLevelAllocation(*assignment, add));
+  EXPECT_NE(param0_buffer, GetTopLevelAllocation(*assignment, negate));
+  EXPECT_FALSE(param0_buffer.maybe_live_out());
+}
+
 TEST_F(BufferAssignmentTest, ReuseNonOperandBuffer) {
   // This computation is a chain of operations which decreases in buffer size
   // (via slice) then increases in size (via broadcast):
@@ -30,6 +30,7 @@ limitations under the License.
 #include "external/llvm/include/llvm/IR/Verifier.h"
 #include "external/llvm/include/llvm/MC/MCContext.h"
 #include "external/llvm/include/llvm/Object/ObjectFile.h"
+#include "external/llvm/include/llvm/Support/MemoryBuffer.h"
 #include "external/llvm/include/llvm/Support/raw_ostream.h"
 #include "external/llvm/include/llvm/Target/TargetMachine.h"
 #include "external/llvm/include/llvm/Transforms/IPO.h"
@@ -43,6 +44,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -68,6 +70,21 @@ operator()(llvm::Module& module) const {
     TF_CHECK_OK(pre_optimization_hook_(module));
   }
 
+  string cache_key;
+  if (object_cache_ != nullptr) {
+    cache_key = PersistentObjectCache::Key(
+        llvm_ir::DumpModuleToString(module), TargetDescription());
+    string object_code;
+    if (object_cache_->Lookup(cache_key, &object_code)) {
+      llvm::object::OwningBinary<llvm::object::ObjectFile> object_file =
+          MakeObjectFile(llvm::MemoryBuffer::getMemBufferCopy(object_code));
+      if (object_file.getBinary() != nullptr) {
+        return object_file;
+      }
+      LOG(WARNING) << "Ignoring invalid object cache entry " << cache_key;
+    }
+  }
+
   // Build up optimization pipeline.
   AddOptimizationPasses(&module_passes, &function_passes);
 
@@ -104,10 +121,29 @@ operator()(llvm::Module& module) const {
   // Construct ObjectFile from machine code buffer.
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
       new llvm::ObjectMemoryBuffer(std::move(stream_buffer)));
+  if (object_cache_ != nullptr) {
+    Status status =
+        object_cache_->Insert(cache_key, memory_buffer->getBuffer().str());
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to store object code in cache: " << status;
+    }
+  }
+  llvm::object::OwningBinary<llvm::object::ObjectFile> object_file =
+      MakeObjectFile(std::move(memory_buffer));
+  CHECK(object_file.getBinary() != nullptr);
+  return object_file;
+}
+
+llvm::object::OwningBinary<llvm::object::ObjectFile>
+CompilerFunctor::MakeObjectFile(
+    std::unique_ptr<llvm::MemoryBuffer> memory_buffer) const {
   llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>>
       object_file_or_error = llvm::object::ObjectFile::createObjectFile(
           memory_buffer->getMemBufferRef());
-  CHECK(object_file_or_error);
+  if (!object_file_or_error) {
+    llvm::consumeError(object_file_or_error.takeError());
+    return llvm::object::OwningBinary<llvm::object::ObjectFile>();
+  }
 
   std::unique_ptr<llvm::object::ObjectFile> object_file =
       std::move(object_file_or_error.get());
@@ -123,6 +159,19 @@ operator()(llvm::Module& module) const {
       std::move(object_file), std::move(memory_buffer));
 }
 
+string CompilerFunctor::TargetDescription() const {
+  const llvm::TargetOptions& options = target_machine_->Options;
+  return tensorflow::strings::StrCat(
+      target_machine_->getTargetTriple().str(), " ",
+      target_machine_->getTargetCPU().str(), " ",
+      target_machine_->getTargetFeatureString().str(), " O", opt_level_,
+      " sse:", available_intrinsics_.sse_intrinsics,
+      " avx:", available_intrinsics_.avx_intrinsics,
+      " unsafe_fp:", options.UnsafeFPMath, " no_infs:", options.NoInfsFPMath,
+      " no_nans:", options.NoNaNsFPMath,
+      " no_signed_zeros:", options.NoSignedZerosFPMath);
+}
+
 namespace {
 // Returns the set of vectorized library functions supported for the target.
 std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl(
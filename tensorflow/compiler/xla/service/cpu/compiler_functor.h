@@ -21,6 +21,7 @@ limitations under the License.
 #include "external/llvm/include/llvm/Object/ObjectFile.h"
 #include "external/llvm/include/llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/disassembler.h"
+#include "tensorflow/compiler/xla/service/cpu/persistent_object_cache.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -44,23 +45,36 @@ class CompilerFunctor {
   // statistics.
   using ModuleHook = std::function<Status(const llvm::Module&)>;
 
+  // If "object_cache" is not null, the object code of the modules is looked up
+  // in and stored into it.  On a hit, the module is neither optimized nor
+  // compiled, so the post-optimization hook is not run.
   explicit CompilerFunctor(llvm::TargetMachine* target_machine,
                            const Disassembler* disassembler, int opt_level,
                            const VectorIntrinsics& available_intrinsics,
                            ModuleHook pre_optimization_hook = nullptr,
-                           ModuleHook post_optimization_hook = nullptr)
+                           ModuleHook post_optimization_hook = nullptr,
+                           const PersistentObjectCache* object_cache = nullptr)
       : target_machine_(target_machine),
         disassembler_(CHECK_NOTNULL(disassembler)),
         opt_level_(opt_level),
         available_intrinsics_(available_intrinsics),
         pre_optimization_hook_(pre_optimization_hook),
-        post_optimization_hook_(post_optimization_hook) {}
+        post_optimization_hook_(post_optimization_hook),
+        object_cache_(object_cache) {}
 
   // Compile a Module to an ObjectFile.
   llvm::object::OwningBinary<llvm::object::ObjectFile> operator()(
       llvm::Module& module) const;  // NOLINT
 
  private:
+  // Returns a description of everything besides the IR that the generated
+  // code depends on, for keying the object cache.
+  string TargetDescription() const;
+
+  // Wraps "memory_buffer" holding object code into an ObjectFile.
+  llvm::object::OwningBinary<llvm::object::ObjectFile> MakeObjectFile(
+      std::unique_ptr<llvm::MemoryBuffer> memory_buffer) const;
+
   // Populates the given pass managers based on the optimization level.
   void AddOptimizationPasses(
       llvm::legacy::PassManagerBase* module_passes,
@@ -72,6 +86,7 @@ class CompilerFunctor {
   const VectorIntrinsics available_intrinsics_;
   ModuleHook pre_optimization_hook_;
   ModuleHook post_optimization_hook_;
+  const PersistentObjectCache* object_cache_;
 };
 
 }  // namespace cpu
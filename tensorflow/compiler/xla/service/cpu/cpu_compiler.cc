@@ -55,12 +55,14 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/layout_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_cse.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -108,10 +110,11 @@ se::Platform::Id CpuAotCompilationOptions::PlatformId() const {
 
 CpuAotCompilationResult::CpuAotCompilationResult(
     ObjectFileData object_file_data, BufferSizes buffer_sizes,
-    int64 result_buffer_index)
+    int64 result_buffer_index, ProfileCounters profile_counters)
     : object_file_data_(std::move(object_file_data)),
       buffer_sizes_(std::move(buffer_sizes)),
-      result_buffer_index_(result_buffer_index) {}
+      result_buffer_index_(result_buffer_index),
+      profile_counters_(std::move(profile_counters)) {}
 
 CpuAotCompilationResult::~CpuAotCompilationResult() = default;
 
@@ -246,9 +249,49 @@ class CollectProfileCandidates : public DfsHloVisitorWithDefault {
 
   std::unordered_map<const HloInstruction*, size_t>* hlo_to_profile_idx_;
 };
+
+// Names the profile counters of `computation` and estimates the work behind
+// each, so that ahead-of-time clients can report more than raw cycle counts.
+// The counter past the last HLO accumulates the whole computation.
+CpuAotCompilationResult::ProfileCounters DescribeProfileCounters(
+    HloComputation* computation,
+    const std::unordered_map<const HloInstruction*, size_t>&
+        hlo_to_profile_idx) {
+  CpuAotCompilationResult::ProfileCounters counters(
+      hlo_to_profile_idx.size() + 1);
+  // The candidates include the instructions of while bodies and conditions,
+  // so analyze every computation that contains one.
+  std::map<const HloComputation*, std::unique_ptr<HloCostAnalysis>> analyses;
+  for (const auto& hlo_and_idx : hlo_to_profile_idx) {
+    const HloInstruction* hlo = hlo_and_idx.first;
+    CpuAotCompilationResult::ProfileCounter& counter =
+        counters[hlo_and_idx.second];
+    counter.name = hlo->name();
+    std::unique_ptr<HloCostAnalysis>& analysis = analyses[hlo->parent()];
+    if (analysis == nullptr) {
+      analysis = MakeUnique<HloCostAnalysis>(CpuExecutable::ShapeSizeBytes);
+      Status status = hlo->parent()->Accept(analysis.get());
+      if (!status.ok()) {
+        // The estimates are informational only, so leave them zeroed.
+        VLOG(1) << "HLO cost analysis failed for profile counters: " << status;
+      }
+    }
+    counter.flop_count = analysis->flop_count(*hlo);
+    counter.bytes_accessed = analysis->bytes_accessed(*hlo);
+  }
+  CpuAotCompilationResult::ProfileCounter& total = counters.back();
+  total.name = "[total]";
+  for (const auto& hlo_and_idx : hlo_to_profile_idx) {
+    if (hlo_and_idx.first->parent() == computation) {
+      total.flop_count += counters[hlo_and_idx.second].flop_count;
+      total.bytes_accessed += counters[hlo_and_idx.second].bytes_accessed;
+    }
+  }
+  return counters;
+}
 }  // namespace
 
-Status CpuCompiler::RunHloPasses(HloModule* module) {
+Status CpuCompiler::RunHloPasses(HloModule* module, int max_parallelism) {
   // Optimization pipeline.
   HloPassPipeline pipeline("CPU");
   pipeline.AddInvariantChecker<HloVerifier>();
@@ -288,13 +331,14 @@ Status CpuCompiler::RunHloPasses(HloModule* module) {
       /*enable_dot_simplification=*/false);
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
   // Outline ops in the entry computation into calls to subcomputations.
-  const int max_parallelism =
-      module->config().intra_op_parallelism_threads() > 0
-          ? module->config().intra_op_parallelism_threads()
-          : tensorflow::port::NumSchedulableCPUs();
   if (CpuParallelBackendRequested(module->config())) {
     pipeline.AddPass<ParallelizationPreparation>(max_parallelism,
                                                  ShapeSizeBytesFunction());
+  } else {
+    // Outline large elementwise ops and loop fusions into calls which are
+    // emitted as fork-joins over outer dimension partitions.
+    pipeline.AddPass<ParallelTaskAssigner>(max_parallelism,
+                                           ShapeSizeBytesFunction());
   }
   // Copy insertion should be performed immediately before IR emission to avoid
   // inserting unnecessary copies (later pass adds an instruction which
@@ -417,14 +461,18 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::Compile(
   auto llvm_context = MakeUnique<llvm::LLVMContext>();
   auto llvm_module =
       MakeUnique<llvm::Module>("__compute_module", *llvm_context);
-  auto jit = MakeUnique<SimpleOrcJIT>(CompilerTargetOptions(module->config()),
-                                      CodeGenOptLevel(module->config()),
-                                      pre_optimization_ir_dump_hook,
-                                      post_optimization_ir_dump_hook);
+  auto jit = MakeUnique<SimpleOrcJIT>(
+      CompilerTargetOptions(module->config()),
+      CodeGenOptLevel(module->config()), pre_optimization_ir_dump_hook,
+      post_optimization_ir_dump_hook,
+      module->config().debug_options().xla_cpu_object_cache_dir());
   llvm_module->setDataLayout(jit->data_layout());
   llvm_module->setTargetTriple(jit->target_triple().getTriple());
 
-  TF_RETURN_IF_ERROR(RunHloPasses(module.get()));
+  TF_RETURN_IF_ERROR(RunHloPasses(
+      module.get(), module->config().intra_op_parallelism_threads() > 0
+                        ? module->config().intra_op_parallelism_threads()
+                        : tensorflow::port::NumSchedulableCPUs()));
 
   HloComputation* computation = module->entry_computation();
   std::unordered_map<const HloInstruction*, size_t> hlo_to_profile_idx;
@@ -710,7 +758,10 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
     HloModule* module = modules[i].get();
     VLOG(1) << "Compiling ahead-of-time: " << module->name();
 
-    TF_RETURN_IF_ERROR(RunHloPasses(module));
+    TF_RETURN_IF_ERROR(RunHloPasses(
+        module, options.intra_op_parallelism_threads() > 0
+                    ? options.intra_op_parallelism_threads()
+                    : tensorflow::port::NumSchedulableCPUs()));
 
     TF_ASSIGN_OR_RETURN(
         SequentialHloOrdering::HloModuleSequence module_sequence,
@@ -732,9 +783,21 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
           proto, dump_debug_json_to, module->name()));
     }
 
-    IrEmitter ir_emitter(*module, *assignment, &llvm_module,
-                         /*hlo_to_profile_idx=*/nullptr);
     HloComputation* computation = module->entry_computation();
+    std::unordered_map<const HloInstruction*, size_t> hlo_to_profile_idx;
+    CpuAotCompilationResult::ProfileCounters profile_counters;
+    if (module->config().hlo_profiling_enabled()) {
+      TF_ASSIGN_OR_RETURN(
+          hlo_to_profile_idx,
+          CollectProfileCandidates::GetCandidatesForComputation(computation));
+      profile_counters =
+          DescribeProfileCounters(computation, hlo_to_profile_idx);
+    }
+
+    IrEmitter ir_emitter(*module, *assignment, &llvm_module,
+                         module->config().hlo_profiling_enabled()
+                             ? &hlo_to_profile_idx
+                             : nullptr);
     for (auto embedded_computation :
          computation->MakeEmbeddedComputationsList()) {
       TF_RETURN_IF_ERROR(
@@ -792,7 +855,7 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
 
     results.emplace_back(MakeUnique<CpuAotCompilationResult>(
         std::move(object_file_data), std::move(buffer_sizes),
-        result_slice.index()));
+        result_slice.index(), std::move(profile_counters)));
   }
 
   VLOG(1) << "Compilation finished";
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_COMPILER_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/compiler.h"
 #include "tensorflow/compiler/xla/service/executable.h"
@@ -66,23 +67,45 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
 
+  // The number of threads the compiled code is expected to run on, which
+  // bounds the number of tasks its parallel loops are partitioned into. A
+  // value of 0 means the number of CPUs of the compiling machine.
+  int intra_op_parallelism_threads() const {
+    return intra_op_parallelism_threads_;
+  }
+  void set_intra_op_parallelism_threads(int threads) {
+    intra_op_parallelism_threads_ = threads;
+  }
+
  private:
   const string triple_;
   const string cpu_name_;
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  int intra_op_parallelism_threads_ = 0;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
  public:
+  // Describes one of the HLO profile counters the compiled computation
+  // accumulates cycles into, when compiled with HLO profiling enabled.
+  struct ProfileCounter {
+    string name;               // HLO instruction name, or "[total]".
+    int64 flop_count = 0;      // Estimated flops of one execution.
+    int64 bytes_accessed = 0;  // Estimated bytes accessed by one execution.
+  };
+  using ProfileCounters = std::vector<ProfileCounter>;
+
   CpuAotCompilationResult(ObjectFileData object_file_data,
-                          BufferSizes buffer_sizes, int64 result_buffer_index);
+                          BufferSizes buffer_sizes, int64 result_buffer_index,
+                          ProfileCounters profile_counters = {});
   ~CpuAotCompilationResult();
 
   const ObjectFileData& object_file_data() const { return object_file_data_; }
   const BufferSizes& buffer_sizes() const { return buffer_sizes_; }
   int64 result_buffer_index() const { return result_buffer_index_; }
+  const ProfileCounters& profile_counters() const { return profile_counters_; }
 
  private:
   // Contains the compiled computation: an object file.
@@ -97,6 +120,11 @@ class CpuAotCompilationResult : public AotCompilationResult {
   // result of the computation.  This buffer should be passed into the output
   // parameter when calling the compiled computation.
   const int64 result_buffer_index_;
+
+  // The HLO profile counters of the compiled computation, in counter index
+  // order; the last one accumulates the whole computation.  If non-empty, the
+  // entry point takes an extra uint64* argument pointing to as many counters.
+  const ProfileCounters profile_counters_;
 };
 
 // CPU-targeting implementation of the XLA Compiler interface.
@@ -130,8 +158,9 @@ class CpuCompiler : public Compiler {
   static void InitializeLLVMTarget();
 
   // Runs the HLO passes which are necessary for both optimizations and
-  // correctness.
-  Status RunHloPasses(HloModule* module);
+  // correctness. `max_parallelism` bounds the number of tasks parallel loops
+  // are partitioned into.
+  Status RunHloPasses(HloModule* module, int max_parallelism);
 
   TF_DISALLOW_COPY_AND_ASSIGN(CpuCompiler);
 };
@@ -185,9 +185,16 @@ Status CpuExecutable::ExecuteComputeFunction(
   // computation.
   std::vector<uint64> profile_counters(hlo_to_profile_idx_.size() + 1);
 
-  // Call the computation function following the calling convention.
+  // Call the computation function following the calling convention. Outputs
+  // written in place of donated parameters are addressed through the temps
+  // array, so their entries point at the arguments.
   std::vector<void*> buffer_pointers;
-  for (auto& buffer : buffers) {
+  for (BufferAllocation::Index i = 0; i < buffers.size(); ++i) {
+    const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    const se::DeviceMemoryBase& buffer =
+        allocation.is_donated_parameter()
+            ? arguments[allocation.parameter_number()]
+            : buffers[i];
     buffer_pointers.push_back(const_cast<void*>(buffer.opaque()));
   }
   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice result_slice,
@@ -313,8 +320,8 @@ StatusOr<std::unique_ptr<ShapedBuffer>> CpuExecutable::ExecuteOnStream(
   TF_RETURN_IF_ERROR(
       result_buffer->mutable_shape_index_to_buffer_entry()
           ->ForEachMutableElementWithStatus(
-              [&buffers, &buffers_in_result, &result_buffer, this](
-                  const ShapeIndex& index, size_t* buffer_entry) {
+              [&arguments, &buffers, &buffers_in_result, &result_buffer,
+               this](const ShapeIndex& index, size_t* buffer_entry) {
                 if (ShapeUtil::IsLeafIndex(result_buffer->shape(), index)) {
                   const std::vector<const LogicalBuffer*>& sources =
                       this->GetRootPointsToSet().element(index);
@@ -328,14 +335,21 @@ StatusOr<std::unique_ptr<ShapedBuffer>> CpuExecutable::ExecuteOnStream(
                   // such as a tuple element.
 
                   // The source instruction should have a non-parameter buffer
-                  // assigned.
+                  // assigned, unless it was written in place of a donated
+                  // parameter.
                   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
                                       this->assignment_->GetUniqueSlice(
                                           src, buffer_source->index()));
-                  CHECK(!slice.allocation()->is_entry_computation_parameter());
+                  const BufferAllocation* allocation = slice.allocation();
+                  CHECK(!allocation->is_entry_computation_parameter() ||
+                        allocation->is_donated_parameter());
 
                   const BufferAllocation::Index buffer_index = slice.index();
-                  const se::DeviceMemoryBase& buffer = buffers[buffer_index];
+                  const se::DeviceMemoryBase& buffer =
+                      allocation->is_entry_computation_parameter()
+                          ? arguments[allocation->parameter_number()]->buffer(
+                                /*index=*/{})
+                          : buffers[buffer_index];
                   CHECK(!buffer.is_null() || buffer.size() == 0);
                   *buffer_entry = result_buffer->mutable_buffers()->size();
                   result_buffer->mutable_buffers()->push_back(buffer);
@@ -15,11 +15,42 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 
 namespace xla {
 namespace cpu {
 
+namespace {
+
+// Returns true if `fusion` contains a dot.
+bool FusesDot(const HloInstruction& fusion) {
+  for (const auto& fused_instruction : fusion.fused_instructions()) {
+    if (fused_instruction->opcode() == HloOpcode::kDot) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+StatusOr<bool> CpuInstructionFusion::Run(HloModule* module) {
+  TF_ASSIGN_OR_RETURN(bool changed, InstructionFusion::Run(module));
+  for (auto& computation : module->computations()) {
+    for (auto& instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kFusion &&
+          instruction->fusion_kind() == HloInstruction::FusionKind::kLoop &&
+          FusesDot(*instruction)) {
+        instruction->set_fusion_kind(HloInstruction::FusionKind::kOutput);
+      }
+    }
+  }
+  return changed;
+}
+
 bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
                                       int64 operand_index) {
   HloInstruction* producer = consumer->mutable_operand(operand_index);
@@ -30,12 +61,37 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
   }
 
   // Condition for consumer: must be elementwise or a fusion op
-  // (which necessarily only contains elementwise operations)
+  // (which necessarily only contains elementwise operations and at most one
+  // dot)
   if (!(consumer->opcode() == HloOpcode::kFusion ||
         consumer->IsElementwise())) {
     return false;
   }
 
+  // The operands of a fused dot are read by the gemm loops, not through the
+  // elementwise generators, so nothing can be fused into them.
+  if (consumer->opcode() == HloOpcode::kFusion) {
+    for (const HloInstruction* user :
+         consumer->fused_parameter(operand_index)->users()) {
+      if (user->opcode() == HloOpcode::kDot) {
+        return false;
+      }
+    }
+  }
+
+  // A dot emitted as a tiled gemm can compute its elementwise consumers on each
+  // element of the product before storing it. There can only be one dot in a
+  // fusion, and it must not be duplicated.
+  if (producer->opcode() == HloOpcode::kDot) {
+    return ProfitableToImplementDotInTiledLlvmIr(*producer) &&
+           producer->user_count() == 1 &&
+           ShapeUtil::Equal(producer->shape(), consumer->shape()) &&
+           consumer->opcode() != HloOpcode::kMap &&
+           !(consumer->opcode() == HloOpcode::kFusion &&
+             FusesDot(*consumer)) &&
+           InstructionFusion::ShouldFuse(consumer, operand_index);
+  }
+
   // Producer or consumer cannot be Map. Maps are technically elementwise but
   // of a slightly different form (call instead of a computation). These are not
   // yet supported in the CPU backend.
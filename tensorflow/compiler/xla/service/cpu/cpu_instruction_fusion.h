@@ -28,6 +28,11 @@ class CpuInstructionFusion : public InstructionFusion {
       : InstructionFusion(CpuInstructionFusion::IsExpensive) {}
   ~CpuInstructionFusion() override = default;
 
+  // Runs the fusion pass, then marks the loop fusions which a dot has been
+  // fused into as output fusions: the dot is emitted as a tiled gemm with the
+  // rest of the fused computation applied to each element it produces.
+  StatusOr<bool> Run(HloModule* module) override;
+
  protected:
   bool ShouldFuse(HloInstruction* consumer, int64 operand_index) override;
 };
@@ -0,0 +1,99 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using CpuInstructionFusionTest = HloTestBase;
+
+// Adds add(dot(lhs, rhs), bias) for an [m, k] lhs and a [k, n] rhs to
+// `builder`, and returns the add.
+HloInstruction* AddDotWithBias(HloComputation::Builder* builder, int64 m,
+                               int64 k, int64 n, HloInstruction** dot) {
+  auto lhs = builder->AddInstruction(HloInstruction::CreateParameter(
+      0, ShapeUtil::MakeShape(F32, {m, k}), "lhs"));
+  auto rhs = builder->AddInstruction(HloInstruction::CreateParameter(
+      1, ShapeUtil::MakeShape(F32, {k, n}), "rhs"));
+  auto bias = builder->AddInstruction(HloInstruction::CreateParameter(
+      2, ShapeUtil::MakeShape(F32, {m, n}), "bias"));
+  *dot = builder->AddInstruction(HloInstruction::CreateBinary(
+      ShapeUtil::MakeShape(F32, {m, n}), HloOpcode::kDot, lhs, rhs));
+  return builder->AddInstruction(HloInstruction::CreateBinary(
+      ShapeUtil::MakeShape(F32, {m, n}), HloOpcode::kAdd, *dot, bias));
+}
+
+TEST_F(CpuInstructionFusionTest, SmallDotFusedWithEpilogue) {
+  HloComputation::Builder builder(TestName());
+  HloInstruction* dot;
+  HloInstruction* add = AddDotWithBias(&builder, 8, 16, 8, &dot);
+  auto floor = builder.AddInstruction(HloInstruction::CreateParameter(
+      3, ShapeUtil::MakeShape(F32, {8, 8}), "floor"));
+  builder.AddInstruction(HloInstruction::CreateBinary(
+      ShapeUtil::MakeShape(F32, {8, 8}), HloOpcode::kMaximum, add, floor));
+
+  auto module = CreateNewModule();
+  auto computation = module->AddEntryComputation(builder.Build());
+  EXPECT_TRUE(CpuInstructionFusion().Run(module.get()).ValueOrDie());
+
+  HloInstruction* root = computation->root_instruction();
+  ASSERT_EQ(HloOpcode::kFusion, root->opcode());
+  EXPECT_EQ(HloInstruction::FusionKind::kOutput, root->fusion_kind());
+  EXPECT_EQ(HloOpcode::kMaximum, root->fused_expression_root()->opcode());
+  int64 fused_dots = 0;
+  for (const auto& fused_instruction : root->fused_instructions()) {
+    if (fused_instruction->opcode() == HloOpcode::kDot) {
+      ++fused_dots;
+    }
+  }
+  EXPECT_EQ(1, fused_dots);
+  EXPECT_EQ(4, root->operand_count());
+}
+
+TEST_F(CpuInstructionFusionTest, LargeDotNotFused) {
+  HloComputation::Builder builder(TestName());
+  HloInstruction* dot;
+  HloInstruction* add = AddDotWithBias(&builder, 256, 256, 256, &dot);
+
+  auto module = CreateNewModule();
+  auto computation = module->AddEntryComputation(builder.Build());
+  EXPECT_FALSE(CpuInstructionFusion().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(add, computation->root_instruction());
+  EXPECT_EQ(dot, add->operand(0));
+}
+
+TEST_F(CpuInstructionFusionTest, DotWithSeveralUsersNotFused) {
+  HloComputation::Builder builder(TestName());
+  HloInstruction* dot;
+  HloInstruction* add = AddDotWithBias(&builder, 8, 16, 8, &dot);
+  builder.AddInstruction(HloInstruction::CreateTuple({add, dot}));
+
+  auto module = CreateNewModule();
+  module->AddEntryComputation(builder.Build());
+  EXPECT_FALSE(CpuInstructionFusion().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(dot, add->operand(0));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
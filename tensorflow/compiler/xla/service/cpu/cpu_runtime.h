@@ -58,6 +58,8 @@ constexpr char kAcquireOutfeedBufferForPopulationSymbolName[] =
     "__xla_cpu_runtime_AcquireOutfeedBufferForPopulation";
 constexpr char kReleaseOutfeedBufferAfterPopulationSymbolName[] =
     "__xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation";
+constexpr char kParallelForkJoinSymbolName[] =
+    "__xla_cpu_runtime_ParallelForkJoin";
 
 // Returns the infeed manager used by the CPU runtime.
 XfeedManager* GetXfeedManager();
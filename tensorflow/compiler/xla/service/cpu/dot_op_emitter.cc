@@ -19,17 +19,20 @@ limitations under the License.
 #include <vector>
 
 #include "external/llvm/include/llvm/IR/BasicBlock.h"
+#include "external/llvm/include/llvm/IR/DerivedTypes.h"
 #include "external/llvm/include/llvm/IR/Instructions.h"
 #include "external/llvm/include/llvm/IR/Module.h"
 #include "external/llvm/include/llvm/IR/Value.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -38,6 +41,20 @@ using llvm_ir::SetToFirstInsertPoint;
 
 namespace cpu {
 
+namespace {
+
+// The number of target rows computed by one tile of the tiled gemm. Together
+// with one vector register per row for the accumulators, this keeps the whole
+// tile in registers on targets with 16 vector registers.
+const int64 kGemmTileRows = 4;
+
+// The width in bytes of the vector registers the tiled gemm is written for.
+// Narrower targets split the vectors; wider ones still benefit from the
+// register blocking.
+const int64 kGemmVectorRegisterBytes = 32;
+
+}  // namespace
+
 DotOpEmitter::DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
                            bool transpose_rhs,
                            const llvm_ir::IrArray& target_array,
@@ -45,7 +62,8 @@ DotOpEmitter::DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
                            const llvm_ir::IrArray& rhs_array,
                            llvm::Value* executable_run_options_value,
                            llvm::IRBuilder<>* ir_builder,
-                           const HloModuleConfig& hlo_module_config)
+                           const HloModuleConfig& hlo_module_config,
+                           const Epilogue& epilogue)
     : dot_(dot),
       transpose_lhs_(transpose_lhs),
       transpose_rhs_(transpose_rhs),
@@ -54,19 +72,20 @@ DotOpEmitter::DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
       rhs_array_(rhs_array),
       executable_run_options_value_(executable_run_options_value),
       ir_builder_(ir_builder),
-      hlo_module_config_(hlo_module_config) {}
+      hlo_module_config_(hlo_module_config),
+      epilogue_(epilogue) {}
 
 /* static */ tensorflow::Status DotOpEmitter::EmitDotOperation(
     const HloInstruction& dot, bool transpose_lhs, bool transpose_rhs,
     const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
     const llvm_ir::IrArray& rhs_array,
     llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder,
-    const HloModuleConfig& hlo_module_config) {
+    const HloModuleConfig& hlo_module_config, const Epilogue& epilogue) {
   PrimitiveType type = target_array.GetShape().element_type();
   TF_RET_CHECK(F32 == type || F64 == type);
   DotOpEmitter dot_emitter(dot, transpose_lhs, transpose_rhs, target_array,
                            lhs_array, rhs_array, executable_run_options_value,
-                           ir_builder, hlo_module_config);
+                           ir_builder, hlo_module_config, epilogue);
   return dot_emitter.Emit();
 }
 
@@ -105,7 +124,13 @@ tensorflow::Status DotOpEmitter::Emit() {
     return EmitScalarDot();
   }
 
-  if (PotentiallyImplementedAsEigenDot(dot_)) {
+  if (CanEmitTiledGemm()) {
+    return EmitTiledGemm();
+  }
+
+  // The runtime writes the whole product at once, so there is no point at
+  // which an epilogue could be applied to its elements.
+  if (PotentiallyImplementedAsEigenDot(dot_) && epilogue_ == nullptr) {
     return EmitCallToRuntime();
   }
 
@@ -205,7 +230,7 @@ tensorflow::Status DotOpEmitter::Emit() {
     }
   }
 
-  target_array_.EmitWriteArrayElement(target_index, result, ir_builder_);
+  TF_RETURN_IF_ERROR(EmitStoreTargetElement(target_index, result));
 
   // Set the IR builder insert point to the exit basic block of the outer most
   // loop.
@@ -221,8 +246,7 @@ tensorflow::Status DotOpEmitter::EmitScalarDot() {
   llvm::Value* rhs_value =
       rhs_array_.EmitReadArrayElement(/*index=*/{}, ir_builder_);
   llvm::Value* result = ir_builder_->CreateFMul(lhs_value, rhs_value);
-  target_array_.EmitWriteArrayElement(/*index=*/{}, result, ir_builder_);
-  return tensorflow::Status::OK();
+  return EmitStoreTargetElement(/*index=*/{}, result);
 }
 
 tensorflow::Status DotOpEmitter::EmitCallToRuntime() {
@@ -315,6 +339,189 @@ tensorflow::Status DotOpEmitter::EmitCallToRuntime() {
   return tensorflow::Status::OK();
 }
 
+bool DotOpEmitter::CanEmitTiledGemm() const {
+  if (transpose_lhs_ || transpose_rhs_ ||
+      !ProfitableToImplementDotInTiledLlvmIr(dot_)) {
+    return false;
+  }
+  // The tiles are laid out along the rows of the operands and the target, so
+  // all of them must be row-major.
+  for (const llvm_ir::IrArray* array :
+       {&target_array_, &lhs_array_, &rhs_array_}) {
+    if (!LayoutUtil::IsMonotonicWithDim0Major(array->GetShape().layout())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+tensorflow::Status DotOpEmitter::EmitTiledGemm() {
+  // The target is split into four regions, from the largest to the smallest:
+  //
+  //   +---------------------+----+
+  //   |                     |    |
+  //   |  vector tiles of    |  2 |
+  //   |  kGemmTileRows rows |    |
+  //   |          1          |    |
+  //   +---------------------+----+
+  //   |          3          |  4 |
+  //   +---------------------+----+
+  //
+  // Region 1 holds the tiles of kGemmTileRows rows by one vector of columns.
+  // Regions 2 and 3 hold what the tiling leaves over on the right and at the
+  // bottom: tiles of one column and tiles of one row. Region 4 is computed one
+  // element at a time.
+  const Shape& lhs_shape = lhs_array_.GetShape();
+  const Shape& rhs_shape = rhs_array_.GetShape();
+  const int64 m = lhs_shape.dimensions(0);
+  const int64 n = rhs_shape.dimensions(1);
+  TF_RET_CHECK(lhs_shape.dimensions(1) == rhs_shape.dimensions(0));
+
+  const int64 vector_width =
+      kGemmVectorRegisterBytes /
+      ShapeUtil::ByteSizeOfPrimitiveType(
+          target_array_.GetShape().element_type());
+  const int64 tiled_m = m - m % kGemmTileRows;
+  const int64 tiled_n = n - n % vector_width;
+
+  TF_RETURN_IF_ERROR(
+      EmitGemmTiles(0, tiled_m, kGemmTileRows, 0, tiled_n, vector_width));
+  TF_RETURN_IF_ERROR(EmitGemmTiles(0, tiled_m, kGemmTileRows, tiled_n, n, 1));
+  TF_RETURN_IF_ERROR(EmitGemmTiles(tiled_m, m, 1, 0, tiled_n, vector_width));
+  return EmitGemmTiles(tiled_m, m, 1, tiled_n, n, 1);
+}
+
+tensorflow::Status DotOpEmitter::EmitGemmTiles(int64 row_start, int64 row_end,
+                                               int64 tile_rows,
+                                               int64 col_start, int64 col_end,
+                                               int64 tile_cols) {
+  if (row_start == row_end || col_start == col_end) {
+    return tensorflow::Status::OK();
+  }
+  const int64 k = lhs_array_.GetShape().dimensions(1);
+  llvm::Type* element_type = target_array_.GetElementLlvmType();
+  llvm::Type* tile_type =
+      tile_cols == 1 ? element_type
+                     : llvm::VectorType::get(element_type, tile_cols);
+  const int64 alignment = ShapeUtil::ByteSizeOfPrimitiveType(
+      target_array_.GetShape().element_type());
+
+  // Loads `tile_cols` consecutive elements of a row of `array`, starting at
+  // `index`.
+  auto emit_tile_row_load = [&](const llvm_ir::IrArray& array,
+                                const llvm_ir::IrArray::Index& index) {
+    if (tile_cols == 1) {
+      return array.EmitReadArrayElement(index, ir_builder_);
+    }
+    llvm::Value* address = ir_builder_->CreateBitCast(
+        array.EmitArrayElementAddress(index, ir_builder_),
+        tile_type->getPointerTo());
+    return static_cast<llvm::Value*>(
+        ir_builder_->CreateAlignedLoad(address, alignment));
+  };
+
+  // Function entry basic block.
+  // - Emit one alloca per tile row for the accumulators. LLVM promotes them to
+  //   registers.
+  llvm::Function* func = ir_builder_->GetInsertBlock()->getParent();
+  llvm::IRBuilder<>::InsertPoint insert_point = ir_builder_->saveIP();
+  SetToFirstInsertPoint(&func->getEntryBlock(), ir_builder_);
+  std::vector<llvm::Value*> accum_addresses;
+  for (int64 r = 0; r < tile_rows; ++r) {
+    accum_addresses.push_back(ir_builder_->CreateAlloca(
+        tile_type, /*ArraySize=*/nullptr, "gemm_accum_address"));
+  }
+  ir_builder_->restoreIP(insert_point);
+
+  std::unique_ptr<llvm_ir::ForLoop> row_loop = llvm_ir::ForLoop::EmitForLoop(
+      "gemm.row", ir_builder_->getInt64(row_start),
+      ir_builder_->getInt64(row_end), ir_builder_->getInt64(tile_rows),
+      ir_builder_);
+  SetToFirstInsertPoint(row_loop->GetBodyBasicBlock(), ir_builder_);
+  std::unique_ptr<llvm_ir::ForLoop> col_loop = llvm_ir::ForLoop::EmitForLoop(
+      "gemm.col", ir_builder_->getInt64(col_start),
+      ir_builder_->getInt64(col_end), ir_builder_->getInt64(tile_cols),
+      ir_builder_);
+  SetToFirstInsertPoint(col_loop->GetBodyBasicBlock(), ir_builder_);
+
+  std::vector<llvm::Value*> rows;
+  for (int64 r = 0; r < tile_rows; ++r) {
+    rows.push_back(ir_builder_->CreateAdd(row_loop->GetIndVarValue(),
+                                          ir_builder_->getInt64(r)));
+  }
+  llvm::Value* col = col_loop->GetIndVarValue();
+  for (llvm::Value* accum_address : accum_addresses) {
+    ir_builder_->CreateStore(llvm::Constant::getNullValue(tile_type),
+                             accum_address);
+  }
+
+  // Body basic block of reduction loop: each element of the lhs column is
+  // broadcast and multiplied with the same row of the rhs, which is loaded
+  // once per tile.
+  std::unique_ptr<llvm_ir::ForLoop> reduction_loop =
+      llvm_ir::ForLoop::EmitForLoop(
+          "gemm.reduction", ir_builder_->getInt64(0), ir_builder_->getInt64(k),
+          ir_builder_->getInt64(1), ir_builder_);
+  SetToFirstInsertPoint(reduction_loop->GetBodyBasicBlock(), ir_builder_);
+  llvm::Value* reduction_index = reduction_loop->GetIndVarValue();
+  llvm::Value* rhs_tile_row =
+      emit_tile_row_load(
+      rhs_array_, llvm_ir::IrArray::Index({reduction_index, col}));
+  for (int64 r = 0; r < tile_rows; ++r) {
+    llvm::Value* lhs_element =
+        lhs_array_.EmitReadArrayElement(
+            llvm_ir::IrArray::Index({rows[r], reduction_index}), ir_builder_);
+    if (tile_cols > 1) {
+      lhs_element = ir_builder_->CreateVectorSplat(tile_cols, lhs_element);
+    }
+    llvm::Value* product = ir_builder_->CreateFMul(lhs_element, rhs_tile_row);
+    llvm::Value* accum = ir_builder_->CreateLoad(accum_addresses[r]);
+    ir_builder_->CreateStore(ir_builder_->CreateFAdd(accum, product),
+                             accum_addresses[r]);
+  }
+
+  // Exit basic block of reduction loop: store the tile into the target, one
+  // vector per row unless an epilogue has to be applied to each element.
+  SetToFirstInsertPoint(reduction_loop->GetExitBasicBlock(), ir_builder_);
+  for (int64 r = 0; r < tile_rows; ++r) {
+    llvm::Value* result = ir_builder_->CreateLoad(accum_addresses[r]);
+    if (tile_cols == 1) {
+      TF_RETURN_IF_ERROR(EmitStoreTargetElement(
+          llvm_ir::IrArray::Index({rows[r], col}), result));
+    } else if (epilogue_ == nullptr) {
+      llvm::Value* address = ir_builder_->CreateBitCast(
+          target_array_.EmitArrayElementAddress(
+              llvm_ir::IrArray::Index({rows[r], col}), ir_builder_),
+          tile_type->getPointerTo());
+      ir_builder_->CreateAlignedStore(result, address, alignment);
+    } else {
+      for (int64 lane = 0; lane < tile_cols; ++lane) {
+        // A distinct index value per element keeps the fused emitter from
+        // reusing the values it generated for another element.
+        llvm::Value* lane_col =
+            ir_builder_->CreateAdd(col, ir_builder_->getInt64(lane));
+        TF_RETURN_IF_ERROR(EmitStoreTargetElement(
+            llvm_ir::IrArray::Index({rows[r], lane_col}),
+            ir_builder_->CreateExtractElement(result, lane)));
+      }
+    }
+  }
+
+  // Set the IR builder insert point to the exit basic block of the outer most
+  // loop.
+  ir_builder_->SetInsertPoint(row_loop->GetExitBasicBlock());
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status DotOpEmitter::EmitStoreTargetElement(
+    const llvm_ir::IrArray::Index& index, llvm::Value* value) {
+  if (epilogue_ != nullptr) {
+    TF_ASSIGN_OR_RETURN(value, epilogue_(index, value));
+  }
+  target_array_.EmitWriteArrayElement(index, value, ir_builder_);
+  return tensorflow::Status::OK();
+}
+
 llvm_ir::IrArray::Index DotOpEmitter::EmitOperandArrayLoopNest(
     llvm_ir::ForLoopNest* loop_nest, const llvm_ir::IrArray& operand_array,
     int64 reduction_dimension, tensorflow::StringPiece name_suffix) {
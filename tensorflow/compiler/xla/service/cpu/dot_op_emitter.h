@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 
+#include <functional>
+
 #include "external/llvm/include/llvm/IR/IRBuilder.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_loop.h"
+#include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -32,16 +35,27 @@ namespace cpu {
 // Helper class for emitting LLVM IR to perform the dot operation.
 class DotOpEmitter {
  public:
+  // Computes the value stored at `index` of the target array from `dot_value`,
+  // the element of the dot product at that index. Used to apply elementwise
+  // consumers of the dot (e.g. a bias add and an activation) before the result
+  // is stored.
+  using Epilogue = std::function<StatusOr<llvm::Value*>(
+      const llvm_ir::IrArray::Index& index, llvm::Value* dot_value)>;
+
   // Emit LLVM IR to perform the dot operation on lhs_array and rhs_array and
   // place the result in target_array. IR is emitted at current insert point of
   // the builder. Upon completion of the method, the insert point is set to the
   // end of all instructions emitted for this operation.
+  //
+  // If `epilogue` is not null, it is applied to every element of the dot
+  // product right before the element is stored into target_array.
   static tensorflow::Status EmitDotOperation(
       const HloInstruction& dot, bool transpose_lhs, bool transpose_rhs,
       const llvm_ir::IrArray& target_array, const llvm_ir::IrArray& lhs_array,
       const llvm_ir::IrArray& rhs_array,
       llvm::Value* executable_run_options_value, llvm::IRBuilder<>* ir_builder,
-      const HloModuleConfig& hlo_module_config);
+      const HloModuleConfig& hlo_module_config,
+      const Epilogue& epilogue = nullptr);
 
  private:
   DotOpEmitter(const HloInstruction& dot, bool transpose_lhs,
@@ -50,7 +64,8 @@ class DotOpEmitter {
                const llvm_ir::IrArray& rhs_array,
                llvm::Value* executable_run_options_value,
                llvm::IRBuilder<>* ir_builder,
-               const HloModuleConfig& hlo_module_config);
+               const HloModuleConfig& hlo_module_config,
+               const Epilogue& epilogue);
 
   // Emits the IR to perform the dot operation.
   tensorflow::Status Emit();
@@ -62,6 +77,29 @@ class DotOpEmitter {
   // Emits a call to the CPU runtime to perform the matrix multiply.
   tensorflow::Status EmitCallToRuntime();
 
+  // Returns true if the dot can be emitted by EmitTiledGemm: it is a small
+  // enough matrix-matrix product of row-major, non-transposed operands.
+  bool CanEmitTiledGemm() const;
+
+  // Emits a gemm blocked into tiles of kGemmTileRows rows and one vector
+  // register of columns, each accumulated in registers over the whole
+  // reduction dimension. The rows and columns left over by the tiling are
+  // covered by narrower tiles.
+  tensorflow::Status EmitTiledGemm();
+
+  // Emits the loops computing the rows [row_start, row_end) and the columns
+  // [col_start, col_end) of the target with tiles of `tile_rows` rows and
+  // `tile_cols` columns, which must divide the row and column ranges. A tile
+  // with more than one column is computed with vector instructions.
+  tensorflow::Status EmitGemmTiles(int64 row_start, int64 row_end,
+                                   int64 tile_rows, int64 col_start,
+                                   int64 col_end, int64 tile_cols);
+
+  // Stores `value`, the element of the dot product at `index`, into the target
+  // after applying the epilogue to it, if any.
+  tensorflow::Status EmitStoreTargetElement(
+      const llvm_ir::IrArray::Index& index, llvm::Value* value);
+
   // Emits a series of nested loops for iterating over an operand array in the
   // dot operation. Loops are constructed in major to minor dimension layout
   // order. No loop is emitted for the given reduction_dimension. The function
@@ -86,6 +124,7 @@ class DotOpEmitter {
   llvm::Value* executable_run_options_value_;
   llvm::IRBuilder<>* ir_builder_;
   const HloModuleConfig& hlo_module_config_;
+  const Epilogue& epilogue_;
 };
 
 }  // namespace cpu
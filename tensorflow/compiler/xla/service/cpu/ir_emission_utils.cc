@@ -73,11 +73,20 @@ bool AreValidGemmShapes(const Shape& lhs_shape, const Shape& rhs_shape,
          IsRank2WithNoPadding(lhs_shape) && IsRank2WithNoPadding(rhs_shape) &&
          IsRank2WithNoPadding(output_shape);
 }
+
+// The largest number of multiply-adds (m * n * k) for which a dot is emitted as
+// a tiled gemm instead of calling into Eigen. Beyond this size the cache
+// blocking and the thread pool of Eigen make up for the cost of the call.
+const int64 kMaxTiledLlvmIrDotSize = 128 * 128 * 128;
 }  // namespace
 
 bool PotentiallyImplementedAsEigenDot(const HloInstruction& hlo) {
   // For certain types of Dot, we can call Eigen
   if (hlo.opcode() == HloOpcode::kDot) {
+    if (ProfitableToImplementDotInTiledLlvmIr(hlo)) {
+      return false;
+    }
+
     const Shape& lhs_shape = hlo.operand(0)->shape();
     const Shape& rhs_shape = hlo.operand(1)->shape();
 
@@ -112,5 +121,28 @@ bool PotentiallyImplementedAsEigenDot(const HloInstruction& hlo) {
   return false;
 }
 
+bool ProfitableToImplementDotInTiledLlvmIr(const HloInstruction& dot) {
+  if (dot.opcode() != HloOpcode::kDot) {
+    return false;
+  }
+  const Shape& lhs_shape = dot.operand(0)->shape();
+  const Shape& rhs_shape = dot.operand(1)->shape();
+  const Shape& output_shape = dot.shape();
+  if (output_shape.element_type() != F32 &&
+      output_shape.element_type() != F64) {
+    return false;
+  }
+  if (!IsRank2WithNoPadding(lhs_shape) || !IsRank2WithNoPadding(rhs_shape) ||
+      !IsRank2WithNoPadding(output_shape) ||
+      ShapeUtil::HasZeroElements(lhs_shape) ||
+      ShapeUtil::HasZeroElements(rhs_shape)) {
+    return false;
+  }
+  const int64 m = lhs_shape.dimensions(0);
+  const int64 k = lhs_shape.dimensions(1);
+  const int64 n = rhs_shape.dimensions(1);
+  return m * n * k <= kMaxTiledLlvmIrDotSize;
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -26,6 +26,12 @@ bool PotentiallyImplementedAsEigenConvolution(
 
 bool PotentiallyImplementedAsEigenDot(const HloInstruction& dot);
 
+// Returns true if `dot` is a matrix-matrix product small enough that the tiled
+// and vectorized gemm emitted by DotOpEmitter beats calling into Eigen. Such a
+// dot is not implemented as an Eigen dot, and elementwise consumers of it may
+// be fused into its loops.
+bool ProfitableToImplementDotInTiledLlvmIr(const HloInstruction& dot);
+
 }  // namespace cpu
 }  // namespace xla
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
 #include "tensorflow/compiler/xla/service/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
@@ -1642,6 +1643,76 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     TF_RETURN_IF_ERROR(fusion->fused_expression_root()->Accept(&fused_emitter));
 
     return EmitTargetElementLoop(fusion, fused_emitter.GetRootGenerator());
+  } else if (fusion->fusion_kind() == HloInstruction::FusionKind::kOutput) {
+    // A dot with elementwise consumers fused into it. The dot is emitted by
+    // DotOpEmitter, which computes the rest of the fused expression on every
+    // element of the product it stores.
+    const HloInstruction* dot = nullptr;
+    for (const auto& fused_instruction : fusion->fused_instructions()) {
+      if (fused_instruction->opcode() == HloOpcode::kDot) {
+        dot = fused_instruction.get();
+      }
+    }
+    TF_RET_CHECK(dot != nullptr);
+    const HloInstruction* lhs_parameter = dot->operand(0);
+    const HloInstruction* rhs_parameter = dot->operand(1);
+    TF_RET_CHECK(lhs_parameter->opcode() == HloOpcode::kParameter &&
+                 rhs_parameter->opcode() == HloOpcode::kParameter);
+    const HloInstruction* lhs =
+        fusion->operand(lhs_parameter->parameter_number());
+    const HloInstruction* rhs =
+        fusion->operand(rhs_parameter->parameter_number());
+
+    TF_RETURN_IF_ERROR(ElementTypesSameAndSupported(
+        /*instruction=*/*dot, /*operands=*/{lhs, rhs},
+        /*supported_types=*/{F32, F64}));
+
+    std::vector<llvm_ir::IrArray> parameter_arrays;
+    for (HloInstruction* operand : fusion->operands()) {
+      parameter_arrays.push_back(GetIrArrayForOp(operand));
+    }
+    CpuElementalIrEmitter elemental_emitter(hlo_module_config_, &ir_builder_,
+                                            module_);
+    FusedIrEmitter fused_emitter(parameter_arrays, &elemental_emitter);
+    TF_RETURN_IF_ERROR(fusion->fused_expression_root()->Accept(&fused_emitter));
+
+    // The generator of the dot yields the element of the product that
+    // DotOpEmitter is about to store.
+    llvm::Value* dot_value = nullptr;
+    fused_emitter.SetGenerator(
+        dot, [&dot_value](const llvm_ir::IrArray::Index& index)
+                 -> StatusOr<llvm::Value*> { return dot_value; });
+    llvm_ir::ElementGenerator root_generator = fused_emitter.GetRootGenerator();
+    DotOpEmitter::Epilogue epilogue =
+        [&dot_value, &root_generator](const llvm_ir::IrArray::Index& index,
+                                      llvm::Value* value) {
+          dot_value = value;
+          return root_generator(index);
+        };
+
+    llvm_ir::IrArray lhs_array(GetIrArrayForOp(lhs));
+    llvm_ir::IrArray rhs_array(GetIrArrayForOp(rhs));
+
+    TF_ASSIGN_OR_RETURN(llvm::Value * target_address,
+                        EmitTargetAddressForOp(fusion));
+    llvm_ir::IrArray target_array(target_address, fusion->shape());
+    AddAliasingInformationToIrArray(*fusion, &target_array);
+
+    VLOG(2) << "HandleFusion kOutput: ";
+    VLOG(2) << "  lhs operand: "
+            << llvm_ir::DumpToString(*lhs_array.GetBasePointer());
+    VLOG(2) << "  rhs operand: "
+            << llvm_ir::DumpToString(*rhs_array.GetBasePointer());
+    VLOG(2) << "  target: "
+            << llvm_ir::DumpToString(*target_array.GetBasePointer());
+
+    TF_RETURN_IF_ERROR(DotOpEmitter::EmitDotOperation(
+        *dot, /*transpose_lhs=*/false, /*transpose_rhs=*/false, target_array,
+        lhs_array, rhs_array, GetExecutableRunOptionsArgument(), &ir_builder_,
+        hlo_module_config_, epilogue));
+
+    emitted_value_[fusion] = target_address;
+    return Status::OK();
   } else {
     return Unimplemented("Fusion kind not implemented on CPU");
   }
@@ -1659,8 +1730,16 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
   TF_ASSIGN_OR_RETURN(llvm::Value * output_address,
                       EmitTargetAddressForOp(call));
 
-  EmitArrayFunctionCallInto(call_ir_function, parameter_addresses,
-                            output_address, computation->name());
+  if (!computation->root_instruction()->outer_dimension_partitions().empty()) {
+    // ParallelTaskAssigner assigned partitions to the computation: fork one
+    // call per partition.
+    TF_RETURN_IF_ERROR(EmitParallelForkJoin(*computation, call_ir_function,
+                                            parameter_addresses,
+                                            output_address));
+  } else {
+    EmitArrayFunctionCallInto(call_ir_function, parameter_addresses,
+                              output_address, computation->name());
+  }
 
   emitted_value_[call] = output_address;
   return Status::OK();
@@ -2047,10 +2126,9 @@ llvm::Value* IrEmitter::EmitElementFunctionCall(
 //                 parameter_addresses_buffer,
 //                 temps)
 //   return return_value_buffer  -- address of the return value.
-void IrEmitter::EmitArrayFunctionCallInto(
-    llvm::Function* function,
+llvm::Value* IrEmitter::EmitParameterAddressesBuffer(
     tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
-    llvm::Value* return_value_buffer, tensorflow::StringPiece name) {
+    tensorflow::StringPiece name) {
   llvm::Value* parameter_addresses_buffer =
       llvm_ir::EmitAllocaAtFunctionEntryWithCount(
           ir_builder_.getInt8PtrTy(),
@@ -2066,6 +2144,15 @@ void IrEmitter::EmitArrayFunctionCallInto(
         parameter_addresses_buffer, {ir_builder_.getInt64(i)});
     ir_builder_.CreateStore(parameter_as_i8ptr, slot_in_param_adresses);
   }
+  return parameter_addresses_buffer;
+}
+
+void IrEmitter::EmitArrayFunctionCallInto(
+    llvm::Function* function,
+    tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+    llvm::Value* return_value_buffer, tensorflow::StringPiece name) {
+  llvm::Value* parameter_addresses_buffer =
+      EmitParameterAddressesBuffer(parameter_addresses, name);
 
   const auto to_int8_ptr = [this](llvm::Value* ptr) {
     return ir_builder_.CreatePointerCast(ptr, ir_builder_.getInt8PtrTy());
@@ -2080,6 +2167,83 @@ void IrEmitter::EmitArrayFunctionCallInto(
   ir_builder_.CreateCall(function, arguments);
 }
 
+// Emits a fork-join over the outer dimension partitions of the root of
+// 'computation', based on the following pseudo-code.
+//
+//   int64 partitions[num_partitions][num_partitioned_dims][2] =
+//       [start, limit) of each partition in each partitioned dimension
+//   __xla_cpu_runtime_ParallelForkJoin(return_value_buffer, run_options,
+//                                      parameter_addresses_buffer, temps,
+//                                      prof_counters, num_partitions,
+//                                      partitions, num_partitioned_dims,
+//                                      function)
+Status IrEmitter::EmitParallelForkJoin(
+    const HloComputation& computation, llvm::Function* function,
+    tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+    llvm::Value* return_value_buffer) {
+  TF_RET_CHECK(num_dynamic_loop_bounds_ == 0);
+  const HloInstruction* root = computation.root_instruction();
+  ShapePartitionIterator partition_iterator(
+      root->shape(), root->outer_dimension_partitions());
+  const int64 num_partitions = partition_iterator.GetTotalPartitionCount();
+  const int64 num_partitioned_dims = root->outer_dimension_partitions().size();
+
+  // The partitions are known at compile time, so they are emitted as a
+  // constant global array.
+  llvm::Type* int64_type = ir_builder_.getInt64Ty();
+  std::vector<llvm::Constant*> partition_bounds;
+  for (int64 i = 0; i < num_partitions; ++i) {
+    for (const auto& dim_partition : partition_iterator.GetPartition(i)) {
+      partition_bounds.push_back(
+          llvm::ConstantInt::get(int64_type, dim_partition.first));
+      partition_bounds.push_back(llvm::ConstantInt::get(
+          int64_type, dim_partition.first + dim_partition.second));
+    }
+  }
+  llvm::ArrayType* partitions_type =
+      llvm::ArrayType::get(int64_type, partition_bounds.size());
+  llvm::Constant* partitions_initializer =
+      llvm::ConstantArray::get(partitions_type, partition_bounds);
+  llvm::GlobalVariable* partitions = new llvm::GlobalVariable(
+      /*Module=*/*module_, /*Type=*/partitions_type, /*isConstant=*/true,
+      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+      /*Initializer=*/partitions_initializer,
+      /*Name=*/llvm_ir::AsStringRef(tensorflow::strings::StrCat(
+          computation.name(), "_partitions")));
+
+  llvm::Type* i8_ptr_type = ir_builder_.getInt8PtrTy();
+  llvm::Type* int32_type = ir_builder_.getInt32Ty();
+  llvm::Type* int64_ptr_type = int64_type->getPointerTo();
+  llvm::FunctionType* fork_join_type = llvm::FunctionType::get(
+      /*Result=*/ir_builder_.getVoidTy(),
+      /*Params=*/{i8_ptr_type, i8_ptr_type, i8_ptr_type->getPointerTo(),
+                  i8_ptr_type->getPointerTo(), int64_ptr_type, int32_type,
+                  int64_ptr_type, int32_type, i8_ptr_type},
+      /*isVarArg=*/false);
+  llvm::Function* fork_join_func =
+      llvm::cast<llvm::Function>(module_->getOrInsertFunction(
+          runtime::kParallelForkJoinSymbolName, fork_join_type));
+  fork_join_func->setCallingConv(llvm::CallingConv::C);
+  fork_join_func->setDoesNotThrow();
+
+  llvm::Value* profile_counters = GetProfileCountersArgument();
+  if (profile_counters == nullptr) {
+    profile_counters = llvm::Constant::getNullValue(int64_ptr_type);
+  }
+  ir_builder_.CreateCall(
+      fork_join_func,
+      {ir_builder_.CreatePointerCast(return_value_buffer, i8_ptr_type),
+       ir_builder_.CreatePointerCast(GetExecutableRunOptionsArgument(),
+                                     i8_ptr_type),
+       EmitParameterAddressesBuffer(parameter_addresses, computation.name()),
+       GetTempBuffersArgument(), profile_counters,
+       ir_builder_.getInt32(num_partitions),
+       ir_builder_.CreatePointerCast(partitions, int64_ptr_type),
+       ir_builder_.getInt32(num_partitioned_dims),
+       ir_builder_.CreatePointerCast(function, i8_ptr_type)});
+  return Status::OK();
+}
+
 llvm::Value* IrEmitter::EmitArrayFunctionCall(
     llvm::Function* function, const Shape& return_shape, int64 element_count,
     tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
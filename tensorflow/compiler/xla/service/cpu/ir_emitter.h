@@ -244,6 +244,21 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
       llvm::Value* return_value, tensorflow::StringPiece name);
 
+  // Emits a call to the runtime which calls `function`, the IR function of
+  // `computation`, once per outer dimension partition assigned to the root of
+  // `computation`, in parallel on the intra op thread pool. Each call computes
+  // the part of the result in `return_value` within its dynamic loop bounds.
+  Status EmitParallelForkJoin(
+      const HloComputation& computation, llvm::Function* function,
+      tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+      llvm::Value* return_value);
+
+  // Emits an array holding `parameter_addresses`, in the form a computation
+  // function takes its parameters in.
+  llvm::Value* EmitParameterAddressesBuffer(
+      tensorflow::gtl::ArraySlice<llvm::Value*> parameter_addresses,
+      tensorflow::StringPiece name);
+
   // Array function call emitter.  Returns a Value for the function's return
   // value buffer address. The return value buffer is alloca'ed by this
   // function.
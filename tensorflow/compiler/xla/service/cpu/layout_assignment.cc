@@ -56,13 +56,15 @@ Status CpuLayoutAssignment::AddBackendConstraints(
           constraints->SetOperandLayout(filter_shape, convolution, 1));
       TF_RETURN_IF_ERROR(
           constraints->SetInstructionLayout(output_shape, convolution));
-    } else if (PotentiallyImplementedAsEigenDot(*instruction)) {
+    } else if (PotentiallyImplementedAsEigenDot(*instruction) ||
+               ProfitableToImplementDotInTiledLlvmIr(*instruction)) {
       const HloInstruction* dot = instruction.get();
       const HloInstruction* lhs_instruction = dot->operand(0);
       const HloInstruction* rhs_instruction = dot->operand(1);
 
-      // In order to implement `dot` with Eigen dot, the layouts of the lhs,
-      // rhs, and output need to be row-major.
+      // In order to implement `dot` with Eigen dot or with the tiled gemm of
+      // DotOpEmitter, the layouts of the lhs, rhs, and output need to be
+      // row-major.
       //
       // These constraints are not hard constraints. Ideally, we should decide
       // which layouts to choose according to some cost model.
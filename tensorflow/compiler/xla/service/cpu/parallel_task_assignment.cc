@@ -0,0 +1,183 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Cost model based on the size of the output of an instruction and a typical
+// L2 cache size, used when HloCostAnalysis fails on the computation.
+class SimpleCostModel : public ParallelCostModel {
+ public:
+  SimpleCostModel(const int64 max_parallelism,
+                  const HloCostAnalysis::ShapeSizeFunction& shape_size)
+      : max_parallelism_(max_parallelism), shape_size_(shape_size) {}
+  ~SimpleCostModel() override {}
+
+  int64 GetParallelTaskCount(HloInstruction* instruction) override {
+    // Simple cost model based on hlo size and typical L2 cache size.
+    const int64 instruction_cost = shape_size_(instruction->shape());
+    const int64 min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
+    // Return target parallel task count in [1, max_parallelism_].
+    return std::min(max_parallelism_,
+                    std::max(1LL, instruction_cost / min_cost_per_thread));
+  }
+
+ private:
+  const int64 max_parallelism_;
+  const HloCostAnalysis::ShapeSizeFunction shape_size_;
+};
+
+// Cost model based on the flops, transcendentals and bytes accessed by an
+// instruction, as computed by HloCostAnalysis.
+class DefaultCostModel : public ParallelCostModel {
+ public:
+  DefaultCostModel(const int64 max_parallelism,
+                   std::unique_ptr<HloCostAnalysis> cost_analysis)
+      : max_parallelism_(max_parallelism),
+        cost_analysis_(std::move(cost_analysis)) {}
+  ~DefaultCostModel() override {}
+
+  int64 GetParallelTaskCount(HloInstruction* instruction) override {
+    // Calculate the instruction cost in cycles.
+    // TODO(29630486) Improve on this linear cost model.
+    // Consider making 'min_cost_per_thread' be a function of the target
+    // bandwidth limit for instructions with low arithmetic complexity.
+    const int64 instruction_cost =
+        1 * cost_analysis_->flop_count(*instruction) +
+        2 * cost_analysis_->transcendental_count(*instruction) +
+        10 * cost_analysis_->bytes_accessed(*instruction);
+    // Minimum per-thread cost is 100us of work on a 2GHz core.
+    const int64 min_cost_per_thread = 100000;
+    // Return target parallel task count in [1, max_parallelism_].
+    return std::min(max_parallelism_,
+                    std::max(1LL, instruction_cost / min_cost_per_thread));
+  }
+
+ private:
+  const int64 max_parallelism_;
+  const std::unique_ptr<HloCostAnalysis> cost_analysis_;
+};
+
+}  // namespace
+
+ParallelTaskAssignment::ParallelTaskAssignment(
+    const int64 max_parallelism,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module) {
+  VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
+  // Run cost analysis on 'module'.
+  auto cost_analysis = MakeUnique<HloCostAnalysis>(shape_size);
+  HloComputation* computation = module->entry_computation();
+  Status status = computation->root_instruction()->Accept(cost_analysis.get());
+  if (status.ok()) {
+    // Set default cost model based on 'cost_analysis'.
+    cost_model_.reset(
+        new DefaultCostModel(max_parallelism, std::move(cost_analysis)));
+  } else {
+    // Fall back to a simple cost model based on hlo size and L2 cache size.
+    // Note that HloCostAnalysis can returns an error status (likely because
+    // HLOs like CustomCall are not yet implemented in the HloCostAnalysis).
+    cost_model_.reset(new SimpleCostModel(max_parallelism, shape_size));
+  }
+}
+
+int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
+    HloInstruction* instruction) {
+  return cost_model_->GetParallelTaskCount(instruction);
+}
+
+bool ParallelTaskAssigner::IsPartitionable(const HloInstruction& instruction) {
+  // Only instructions emitted by IrEmitter::EmitTargetElementLoop read the
+  // dynamic loop bounds. Scalars have no dimension to partition.
+  if (ShapeUtil::IsTuple(instruction.shape()) ||
+      ShapeUtil::IsScalar(instruction.shape())) {
+    return false;
+  }
+  if (instruction.opcode() == HloOpcode::kFusion) {
+    return instruction.fusion_kind() == HloInstruction::FusionKind::kLoop;
+  }
+  return instruction.IsElementwise() && instruction.operand_count() > 0;
+}
+
+StatusOr<bool> ParallelTaskAssigner::Run(HloModule* module) {
+  XLA_VLOG_LINES(2, "ParallelTaskAssigner ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+
+  ParallelTaskAssignment parallel_task_assignment(
+      max_parallelism_, shape_size_function_, module);
+  HloComputation* computation = module->entry_computation();
+
+  // Collect the instructions first, since outlining modifies the computation.
+  std::vector<HloInstruction*> instructions_to_outline;
+  for (auto& instruction : computation->instructions()) {
+    if (IsPartitionable(*instruction)) {
+      instructions_to_outline.push_back(instruction.get());
+    }
+  }
+
+  bool changed = false;
+  for (HloInstruction* instruction : instructions_to_outline) {
+    const int64 target_parallel_task_count =
+        parallel_task_assignment.GetTargetParallelTaskCount(instruction);
+    if (target_parallel_task_count <= 1) {
+      continue;
+    }
+    // Assign feasible dimension partitions (based on actual dimension sizes).
+    std::vector<int64> dim_partition_counts =
+        ShapePartitionAssigner(instruction->shape())
+            .Run(target_parallel_task_count);
+    const int64 total_partition_count =
+        ShapePartitionAssigner::GetTotalPartitionCount(dim_partition_counts);
+    if (total_partition_count <= 1) {
+      // Feasible partition calculation resulting in no partitioning, so skip.
+      continue;
+    }
+
+    // Outline 'instruction' in its own sub-computation, and map the assigned
+    // 'dim_partition_counts' to its cloned root instruction.
+    auto* call = module->OutlineExpressionFromComputation(
+        {instruction}, tensorflow::strings::StrCat("pt_", instruction->name()),
+        computation);
+    call->to_apply()->root_instruction()->set_outer_dimension_partitions(
+        dim_partition_counts);
+    VLOG(2) << "Assigned parallel task count: " << total_partition_count
+            << " to instruction: "
+            << call->to_apply()->root_instruction()->name()
+            << " called by: " << call->name();
+    changed = true;
+  }
+
+  XLA_VLOG_LINES(2, "ParallelTaskAssigner EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,90 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Simple interface for different parallel cost model implementations.
+class ParallelCostModel {
+ public:
+  virtual ~ParallelCostModel() = default;
+  virtual int64 GetParallelTaskCount(HloInstruction* instruction) = 0;
+};
+
+// ParallelTaskAssignment computes parallel task counts for HLOs in 'module'.
+class ParallelTaskAssignment {
+ public:
+  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'shape_size': shape size function used by HloCostAnalysis during parallel
+  //               task assignment.
+  // 'module': the containing HloModule.
+  ParallelTaskAssignment(const int64 max_parallelism,
+                         const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                         HloModule* module);
+  ~ParallelTaskAssignment() {}
+
+  // Computes and returns the target parallel task count for 'instruction', in
+  // [1, max_parallelism].
+  int64 GetTargetParallelTaskCount(HloInstruction* instruction);
+
+ private:
+  std::unique_ptr<ParallelCostModel> cost_model_;
+};
+
+// ParallelTaskAssigner computes target parallel task counts for the large
+// elementwise and loop fusion instructions of the entry computation, and
+// outlines each of them into its own computation, whose root records the
+// outer dimension partitions of its shape. The sequential CPU backend emits a
+// call to such a computation as a fork-join over the partitions on the intra
+// op thread pool (see __xla_cpu_runtime_ParallelForkJoin), so that a single
+// large fusion can use all cores.
+class ParallelTaskAssigner : public HloPassInterface {
+ public:
+  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'shape_size': shape size function used by HloCostAnalysis during parallel
+  //               task assignment.
+  ParallelTaskAssigner(const int64 max_parallelism,
+                       const HloCostAnalysis::ShapeSizeFunction& shape_size)
+      : max_parallelism_(max_parallelism), shape_size_function_(shape_size) {}
+  ~ParallelTaskAssigner() override {}
+
+  tensorflow::StringPiece name() const override {
+    return "cpu-parallel-task-assigner";
+  }
+
+  // Run parallel task assigner on 'module'.
+  // Returns true if the computation was changed, false otherwise.
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  // Returns true if 'instruction' is emitted as a loop nest over its shape
+  // that honors the dynamic loop bounds of a partition.
+  static bool IsPartitionable(const HloInstruction& instruction);
+
+  const int64 max_parallelism_;
+  const HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PARALLEL_TASK_ASSIGNMENT_H_
@@ -0,0 +1,82 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class ParallelTaskAssignerTest : public HloTestBase {
+ protected:
+  // Builds an entry computation which adds two parameters of 'shape'.
+  std::unique_ptr<HloModule> CreateAddModule(const Shape& shape) {
+    auto builder = HloComputation::Builder(TestName());
+    auto param0 = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, shape, "param0"));
+    auto param1 = builder.AddInstruction(
+        HloInstruction::CreateParameter(1, shape, "param1"));
+    builder.AddInstruction(
+        HloInstruction::CreateBinary(shape, HloOpcode::kAdd, param0, param1));
+    auto module = CreateNewModule();
+    module->AddEntryComputation(builder.Build());
+    return module;
+  }
+
+  StatusOr<bool> RunAssigner(HloModule* module) {
+    return ParallelTaskAssigner(/*max_parallelism=*/8,
+                                [](const Shape& shape) {
+                                  return ShapeUtil::ByteSizeOf(
+                                      shape, /*pointer_size=*/8);
+                                })
+        .Run(module);
+  }
+};
+
+TEST_F(ParallelTaskAssignerTest, LargeElementwiseOpIsPartitioned) {
+  auto module = CreateAddModule(
+      ShapeUtil::MakeShapeWithLayout(F32, {1024, 1024}, {1, 0}));
+  auto changed = RunAssigner(module.get());
+  ASSERT_TRUE(changed.ok());
+  EXPECT_TRUE(changed.ValueOrDie());
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_EQ(HloOpcode::kCall, root->opcode());
+  HloInstruction* callee_root = root->to_apply()->root_instruction();
+  EXPECT_EQ(HloOpcode::kAdd, callee_root->opcode());
+  EXPECT_TRUE(ContainersEqual(std::vector<int64>({8}),
+                              callee_root->outer_dimension_partitions()));
+}
+
+TEST_F(ParallelTaskAssignerTest, SmallElementwiseOpIsNotPartitioned) {
+  auto module =
+      CreateAddModule(ShapeUtil::MakeShapeWithLayout(F32, {4, 4}, {1, 0}));
+  auto changed = RunAssigner(module.get());
+  ASSERT_TRUE(changed.ok());
+  EXPECT_FALSE(changed.ValueOrDie());
+  EXPECT_EQ(HloOpcode::kAdd,
+            module->entry_computation()->root_instruction()->opcode());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,87 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/persistent_object_cache.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+
+PersistentObjectCache::PersistentObjectCache(const string& directory,
+                                             tensorflow::Env* env)
+    : directory_(directory), env_(env) {}
+
+/* static */ string PersistentObjectCache::Key(
+    const string& ir, const string& target_description) {
+  const tensorflow::Fprint128 fingerprint = tensorflow::Fingerprint128(
+      tensorflow::strings::StrCat(target_description, "\n", ir));
+  return tensorflow::strings::Printf(
+      "%016llx%016llx", static_cast<unsigned long long>(fingerprint.high64),
+      static_cast<unsigned long long>(fingerprint.low64));
+}
+
+string PersistentObjectCache::EntryPath(const string& key) const {
+  return tensorflow::io::JoinPath(directory_, tensorflow::strings::StrCat(
+                                                  "xla_cpu_", key, ".o"));
+}
+
+bool PersistentObjectCache::Lookup(const string& key,
+                                   string* object_code) const {
+  const string path = EntryPath(key);
+  if (!env_->FileExists(path).ok()) {
+    VLOG(2) << "Object cache miss: " << path;
+    return false;
+  }
+  Status status = tensorflow::ReadFileToString(env_, path, object_code);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read object cache entry " << path << ": "
+                 << status;
+    return false;
+  }
+  VLOG(1) << "Object cache hit: " << path;
+  return true;
+}
+
+Status PersistentObjectCache::Insert(const string& key,
+                                     const string& object_code) const {
+  if (!env_->IsDirectory(directory_).ok()) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  }
+  // Write to a uniquely named file, then rename it, so that concurrent readers
+  // never see a partially written entry.
+  const string path = EntryPath(key);
+  const string tmp_path = tensorflow::strings::StrCat(
+      path, ".tmp.", tensorflow::random::New64());
+  TF_RETURN_IF_ERROR(
+      tensorflow::WriteStringToFile(env_, tmp_path, object_code));
+  Status status = env_->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Stored " << object_code.size() << " bytes of object code in "
+          << path;
+  return Status::OK();
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,76 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PERSISTENT_OBJECT_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PERSISTENT_OBJECT_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace xla {
+namespace cpu {
+
+// An on-disk cache of the object code generated by the CPU backend, so that
+// processes compiling the same computations (e.g. after a restart) can skip
+// LLVM optimization and code generation.
+//
+// Entries are keyed by a fingerprint of the unoptimized LLVM IR of a module and
+// of a description of the target it is compiled for; see Key().  Each entry is
+// stored in its own file under the cache directory, which may be shared by
+// several processes: entries are written to a temporary file that is then
+// atomically renamed.
+//
+// This class is thread-safe.
+class PersistentObjectCache {
+ public:
+  // Creates a cache of the files under "directory", which is created on the
+  // first insertion if it does not exist.
+  explicit PersistentObjectCache(
+      const string& directory,
+      tensorflow::Env* env = tensorflow::Env::Default());
+
+  // Returns the key of the object code generated from the LLVM IR "ir" for the
+  // target described by "target_description".  The description must identify
+  // everything other than the IR the generated code depends on: the target
+  // triple, CPU and features, the optimization level, etc.
+  static string Key(const string& ir, const string& target_description);
+
+  // Looks up the object code stored under "key" into "object_code".  Returns
+  // false if there is no such entry or if it cannot be read.
+  bool Lookup(const string& key, string* object_code) const;
+
+  // Stores "object_code" under "key", replacing any previous entry.
+  Status Insert(const string& key, const string& object_code) const;
+
+  const string& directory() const { return directory_; }
+
+ private:
+  // Returns the path to the file holding the entry keyed by "key".
+  string EntryPath(const string& key) const;
+
+  const string directory_;
+  tensorflow::Env* const env_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PersistentObjectCache);
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_PERSISTENT_OBJECT_CACHE_H_
@@ -0,0 +1,61 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/persistent_object_cache.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+TEST(PersistentObjectCacheTest, KeyDependsOnIrAndTarget) {
+  const string key = PersistentObjectCache::Key("ir", "x86_64 haswell");
+  EXPECT_EQ(key, PersistentObjectCache::Key("ir", "x86_64 haswell"));
+  EXPECT_NE(key, PersistentObjectCache::Key("other ir", "x86_64 haswell"));
+  EXPECT_NE(key, PersistentObjectCache::Key("ir", "x86_64 skylake"));
+}
+
+TEST(PersistentObjectCacheTest, EntriesPersistAcrossInstances) {
+  const string directory =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "object_cache");
+  const string key = PersistentObjectCache::Key("ir", "target");
+  string object_code;
+  {
+    PersistentObjectCache cache(directory);
+    EXPECT_FALSE(cache.Lookup(key, &object_code));
+    TF_ASSERT_OK(cache.Insert(key, string("\x7f" "ELF\0code", 9)));
+    ASSERT_TRUE(cache.Lookup(key, &object_code));
+    EXPECT_EQ(string("\x7f" "ELF\0code", 9), object_code);
+  }
+
+  // A new cache, e.g. in a restarted process, sees the entry.
+  PersistentObjectCache cache(directory);
+  ASSERT_TRUE(cache.Lookup(key, &object_code));
+  EXPECT_EQ(string("\x7f" "ELF\0code", 9), object_code);
+
+  TF_ASSERT_OK(cache.Insert(key, "new code"));
+  ASSERT_TRUE(cache.Lookup(key, &object_code));
+  EXPECT_EQ("new code", object_code);
+
+  EXPECT_FALSE(
+      cache.Lookup(PersistentObjectCache::Key("ir", "other"), &object_code));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,75 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/logging.h"
+
+using tensorflow::int32;
+using tensorflow::int64;
+using tensorflow::uint64;
+
+using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
+                                     int64*, uint64*);
+
+void __xla_cpu_runtime_ParallelForkJoin(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** temps, uint64* prof_counters, int32 num_partitions,
+    int64* partitions, int32 num_partitioned_dims, void* function_ptr) {
+  VLOG(2) << "ParallelForkJoin ENTRY"
+          << " num_partitions: " << num_partitions
+          << " num_partitioned_dims: " << num_partitioned_dims;
+  CHECK_GT(num_partitions, 1);
+  CHECK_GT(num_partitioned_dims, 0);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  ComputeFunctionType function =
+      reinterpret_cast<ComputeFunctionType>(function_ptr);
+  const int64 stride = 2 * num_partitioned_dims;
+
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32 i = 0; i < num_partitions; ++i) {
+      function(result_ptr, run_options_ptr, params, temps,
+               &partitions[stride * i], prof_counters);
+    }
+    return;
+  }
+
+  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
+  tensorflow::BlockingCounter bc(num_partitions - 1);
+  for (int32 i = 1; i < num_partitions; ++i) {
+    const int64 offset = stride * i;
+    run_options->intra_op_thread_pool()->enqueueNoNotification(
+        [i, function, result_ptr, run_options_ptr, params, temps,
+         prof_counters, partitions, offset, &bc]() {
+          function(result_ptr, run_options_ptr, params, temps,
+                   &partitions[offset], prof_counters);
+          bc.DecrementCount();
+          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+        });
+  }
+
+  // Call first compute function inline.
+  function(result_ptr, run_options_ptr, params, temps, &partitions[0],
+           prof_counters);
+  VLOG(3) << "ParallelForkJoin partition 0 done.";
+  bc.Wait();
+  VLOG(2) << "ParallelForkJoin EXIT";
+}
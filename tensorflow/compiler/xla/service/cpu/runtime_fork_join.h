@@ -0,0 +1,47 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
+
+#include "tensorflow/core/platform/types.h"
+
+extern "C" {
+
+// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
+// Calls 'function_ptr' for first partition inline.
+// Joins on all dispatched computations before returning.
+//
+// 'function_ptr' is a computation emitted with dynamic loop bounds: its
+// signature is
+//
+//   void function(void* result, const void* run_options, const void** params,
+//                 void** temps, int64* dynamic_loop_bounds,
+//                 uint64* prof_counters)
+//
+// 'partitions' holds 'num_partitions' consecutive arrays of
+// 'num_partitioned_dims' [start, limit) pairs, one pair per partitioned outer
+// dimension, and the array of the i-th partition is passed to the i-th call as
+// its dynamic loop bounds. The calls run on the intra op thread pool of
+// 'run_options_ptr', or one after the other if there is none.
+extern void __xla_cpu_runtime_ParallelForkJoin(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** temps, tensorflow::uint64* prof_counters,
+    tensorflow::int32 num_partitions, tensorflow::int64* partitions,
+    tensorflow::int32 num_partitioned_dims, void* function_ptr);
+
+}  // extern "C"
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime_avx.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime_sse4_1.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
@@ -79,6 +80,9 @@ struct SimpleResolver : public llvm::JITSymbolResolver {
                runtime::kReleaseInfeedBufferAfterDequeueSymbolName) {
       func_addr = reinterpret_cast<void *>(
           __xla_cpu_runtime_ReleaseInfeedBufferAfterDequeue);
+    } else if (canonical_name == runtime::kParallelForkJoinSymbolName) {
+      func_addr =
+          reinterpret_cast<void *>(__xla_cpu_runtime_ParallelForkJoin);
     } else if (canonical_name == runtime::kExpV4F32) {
       func_addr = reinterpret_cast<void *>(runtime::ExpV4F32);
     } else if (canonical_name == runtime::kExpV8F32) {
@@ -144,7 +148,8 @@ CompilerFunctor::VectorIntrinsics GetAvailableIntrinsics() {
 SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions &target_options,
                            llvm::CodeGenOpt::Level opt_level,
                            CompilerFunctor::ModuleHook pre_optimization_hook,
-                           CompilerFunctor::ModuleHook post_optimization_hook)
+                           CompilerFunctor::ModuleHook post_optimization_hook,
+                           const string &object_cache_dir)
     : target_machine_(
           CHECK_NOTNULL(llvm::EngineBuilder()
                             .setTargetOptions(target_options)
@@ -155,13 +160,17 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions &target_options,
                                 /*MAttrs=*/DetectMachineAttributes()))),
       disassembler_(*target_machine_),
       data_layout_(target_machine_->createDataLayout()),
+      object_cache_(object_cache_dir.empty()
+                        ? nullptr
+                        : MakeUnique<PersistentObjectCache>(object_cache_dir)),
       object_layer_(
           [] { return std::make_shared<llvm::SectionMemoryManager>(); }),
       compile_layer_(object_layer_,
                      CompilerFunctor(target_machine_.get(), &disassembler_,
                                      opt_level, GetAvailableIntrinsics(),
                                      std::move(pre_optimization_hook),
-                                     std::move(post_optimization_hook))) {
+                                     std::move(post_optimization_hook),
+                                     object_cache_.get())) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
           << " features: " << target_machine_->getTargetFeatureString().str();
 }
@@ -59,10 +59,13 @@ class SimpleOrcJIT {
   // level optimizations are applied.
   // The |post_optimization_hook| is invoked on the module after all IR
   // level optimizations are applied.
+  // If |object_cache_dir| is not empty, the object code of the modules is
+  // cached in and reused from that directory (see PersistentObjectCache).
   SimpleOrcJIT(const llvm::TargetOptions& target_options,
                llvm::CodeGenOpt::Level opt_level,
                CompilerFunctor::ModuleHook pre_optimization_hook,
-               CompilerFunctor::ModuleHook post_optimization_hook);
+               CompilerFunctor::ModuleHook post_optimization_hook,
+               const string& object_cache_dir = "");
 
   // Data layout this JIT was created with.
   const llvm::DataLayout& data_layout() const { return data_layout_; }
@@ -88,6 +91,7 @@ class SimpleOrcJIT {
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const Disassembler disassembler_;
   const llvm::DataLayout data_layout_;
+  std::unique_ptr<PersistentObjectCache> object_cache_;
   ObjLayerT object_layer_;
   CompileLayerT compile_layer_;
 };
@@ -34,11 +34,23 @@ void XfeedQueueManager::Reset() {
     buffer->Done(ShapeUtil::MakeNil());
   }
   enqueued_buffers_.clear();
+  space_cv_.notify_all();
+}
+
+void XfeedQueueManager::set_max_depth(int64 max_depth) {
+  CHECK_GE(max_depth, 0);
+  tensorflow::mutex_lock l(mu_);
+  max_depth_ = max_depth;
+  space_cv_.notify_all();
 }
 
 void XfeedQueueManager::EnqueueBuffers(
     tensorflow::gtl::ArraySlice<XfeedBuffer*> buffers) {
   tensorflow::mutex_lock l(mu_);
+  while (max_depth_ > 0 && !enqueued_buffers_.empty() &&
+         enqueued_buffers_.size() + buffers.size() > max_depth_) {
+    space_cv_.wait(l);
+  }
   bool was_empty = enqueued_buffers_.empty();
   for (XfeedBuffer* b : buffers) {
     enqueued_buffers_.push_back(b);
@@ -60,6 +72,10 @@ XfeedBuffer* XfeedQueueManager::BlockingDequeueBuffer() {
   CHECK(current_buffer_ == nullptr);
   current_buffer_ = enqueued_buffers_.front();
   enqueued_buffers_.pop_front();
+  if (max_depth_ > 0) {
+    // Producers may be waiting for different amounts of space.
+    space_cv_.notify_all();
+  }
   return current_buffer_;
 }
 
@@ -59,10 +59,19 @@ class XfeedQueueManager {
   // condition is to call Reset when no computation is taking place.
   void Reset();
 
+  // Bounds the queue to max_depth buffers; zero (the default) leaves it
+  // unbounded.
+  void set_max_depth(int64 max_depth);
+
   // Adds a sequence of buffers to the queue atomically. buffer->Done will be
   // called when the buffer will no longer be accessed by the XfeedManager,
   // either as a result of a call to Reset or because the runtime has dequeued
   // and used the buffer.
+  //
+  // If the queue is bounded, blocks while adding the buffers would exceed
+  // max_depth. A sequence is always accepted by an empty queue, so sequences
+  // longer than max_depth do not block forever. May be called concurrently by
+  // several producers; each sequence stays contiguous in the queue.
   void EnqueueBuffers(tensorflow::gtl::ArraySlice<XfeedBuffer*> buffers);
 
   // Blocks until the queue is non-empty, then returns the buffer at the head of
@@ -91,6 +100,13 @@ class XfeedQueueManager {
   // enqueued to an empty queue.
   tensorflow::condition_variable cv_;
 
+  // Condition variable that is signaled every time buffers leave a bounded
+  // queue, to wake up producers blocked in EnqueueBuffers.
+  tensorflow::condition_variable space_cv_;
+
+  // Maximum number of enqueued buffers, or 0 if unbounded.
+  int64 max_depth_ = 0;
+
   // XfeedBuffer* queue contents are not owned, but buffer->Done must
   // be called when the buffer is no longer needed by the runtime.
   std::deque<XfeedBuffer*> enqueued_buffers_;
@@ -128,6 +128,33 @@ TEST_F(InfeedManagerTest, MultiThreaded) {
   ProcessNextBuffer(length);
 }
 
+TEST_F(InfeedManagerTest, BoundedMultipleProducers) {
+  const int kNumProducers = 3;
+  const int kBuffersPerProducer = 4;
+  const int32 length = 16;
+
+  cpu::runtime::XfeedManager* xfeed = cpu::runtime::GetXfeedManager();
+  xfeed->infeed()->set_max_depth(2);
+
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(), "test",
+                                        kNumProducers);
+    for (int i = 0; i < kNumProducers; ++i) {
+      pool.Schedule([xfeed]() {
+        for (int j = 0; j < kBuffersPerProducer; ++j) {
+          xfeed->infeed()->EnqueueBuffers({new TestInfeedBuffer(length)});
+        }
+      });
+    }
+    // The producers block on the full queue until these dequeues make room.
+    for (int i = 0; i < kNumProducers * kBuffersPerProducer; ++i) {
+      ProcessNextBuffer(length);
+    }
+  }
+
+  xfeed->infeed()->set_max_depth(0);
+}
+
 TEST_F(InfeedManagerTest, OutfeedWrongShape) {
   TestInfeedBuffer* b = new TestInfeedBuffer(32, /*expect_shape_match=*/false);
   cpu::runtime::XfeedManager* xfeed = cpu::runtime::GetXfeedManager();
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/compiler/xla/legacy_flags/debug_options_flags.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/shape_util.h"
@@ -87,7 +88,10 @@ class CpuOutfeedBuffer : public cpu::runtime::XfeedBuffer {
 }  // namespace
 
 CpuTransferManager::CpuTransferManager()
-    : GenericTransferManager(se::host::kHostPlatformId) {}
+    : GenericTransferManager(se::host::kHostPlatformId) {
+  cpu::runtime::GetXfeedManager()->infeed()->set_max_depth(
+      legacy_flags::GetDebugOptionsFromFlags().xla_infeed_queue_depth());
+}
 
 Status CpuTransferManager::TransferLiteralToInfeed(se::StreamExecutor* executor,
                                                    const Literal& literal) {
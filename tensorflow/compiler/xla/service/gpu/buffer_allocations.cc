@@ -92,8 +92,10 @@ tensorflow::Status BufferAllocations::TearDown(
     const BufferAllocation& allocation = buffer_assignment.GetAllocation(i);
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
-    // and temp buffers.
+    // and temp buffers. Donated parameters may be live out but are owned by
+    // the caller.
     if ((allocation.maybe_live_out() &&
+         !allocation.is_entry_computation_parameter() &&
          !live_addresses.count(buffer_address)) ||
         allocation.IsPreallocatedTempBuffer()) {
       TF_RETURN_IF_ERROR(
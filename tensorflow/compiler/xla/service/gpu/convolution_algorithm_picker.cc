@@ -0,0 +1,310 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/convolution_algorithm_picker.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/device_memory_allocator.h"
+#include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace se = ::perftools::gputools;
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// The kind and operand shapes of a DNN convolution, as ConvolutionThunk sees
+// them.
+struct ConvolutionParams {
+  ConvolutionThunk::ConvolutionKind kind;
+  Shape input_shape;
+  Shape filter_shape;
+  Shape output_shape;
+};
+
+// Mirrors IrEmitterUnnested::BuildConvolutionThunk.
+ConvolutionParams GetConvolutionParams(const HloInstruction& instruction) {
+  const Shape& lhs_shape = instruction.operand(0)->shape();
+  const Shape& rhs_shape = instruction.operand(1)->shape();
+  if (instruction.opcode() == HloOpcode::kConvolution) {
+    return {ConvolutionThunk::ConvolutionKind::kForward, lhs_shape, rhs_shape,
+            instruction.shape()};
+  }
+  CHECK_EQ(HloOpcode::kFusion, instruction.opcode());
+  if (instruction.fusion_kind() ==
+      HloInstruction::FusionKind::kConvBackwardFilter) {
+    return {ConvolutionThunk::ConvolutionKind::kBackwardFilter, lhs_shape,
+            instruction.shape(), rhs_shape};
+  }
+  CHECK(instruction.fusion_kind() ==
+        HloInstruction::FusionKind::kConvBackwardInput);
+  return {ConvolutionThunk::ConvolutionKind::kBackwardInput,
+          instruction.shape(), rhs_shape, lhs_shape};
+}
+
+// Returns a string which identifies the timing of `instruction` on the device
+// of `stream_exec`: two convolutions with the same key run the same algorithms
+// equally fast.
+string AutotuneKey(const HloInstruction& instruction,
+                   const ConvolutionParams& params,
+                   se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& device = stream_exec->GetDeviceDescription();
+  return tensorflow::strings::StrCat(
+      device.name(), "|", device.platform_version(), "|",
+      device.driver_version(), "|", ConvolutionKindToString(params.kind), "|",
+      ShapeUtil::HumanStringWithLayout(params.input_shape), "|",
+      ShapeUtil::HumanStringWithLayout(params.filter_shape), "|",
+      ShapeUtil::HumanStringWithLayout(params.output_shape), "|",
+      instruction.window().ShortDebugString(), "|",
+      instruction.convolution_dimension_numbers().ShortDebugString());
+}
+
+string CacheEntryPath(const string& cache_dir, const string& key) {
+  const tensorflow::Fprint128 fingerprint = tensorflow::Fingerprint128(key);
+  return tensorflow::io::JoinPath(
+      cache_dir, tensorflow::strings::Printf(
+                     "xla_gpu_conv_%016llx%016llx.txt",
+                     static_cast<unsigned long long>(fingerprint.high64),
+                     static_cast<unsigned long long>(fingerprint.low64)));
+}
+
+// Process-wide memo of picked algorithms, keyed by AutotuneKey. Values are
+// backend config strings.
+tensorflow::mutex autotune_cache_mu(tensorflow::LINKER_INITIALIZED);
+std::map<string, string>& AutotuneCache() {
+  static auto* cache = new std::map<string, string>();
+  return *cache;
+}
+
+bool LookupPersistedAlgorithm(const string& cache_dir, const string& key,
+                              string* backend_config) {
+  if (cache_dir.empty()) {
+    return false;
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const string path = CacheEntryPath(cache_dir, key);
+  if (!env->FileExists(path).ok()) {
+    return false;
+  }
+  string contents;
+  Status status = tensorflow::ReadFileToString(env, path, &contents);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read autotuning result " << path << ": "
+                 << status;
+    return false;
+  }
+  // The entry holds the key followed by the backend config, so that a
+  // fingerprint collision is detected rather than silently trusted.
+  const string prefix = tensorflow::strings::StrCat(key, "\n");
+  if (contents.compare(0, prefix.size(), prefix) != 0 ||
+      !BackendConfigToConvolutionAlgorithm(contents.substr(prefix.size()))
+           .ok()) {
+    LOG(WARNING) << "Ignoring mismatched autotuning result " << path;
+    return false;
+  }
+  *backend_config = contents.substr(prefix.size());
+  VLOG(1) << "Loaded autotuning result from " << path;
+  return true;
+}
+
+Status PersistAlgorithm(const string& cache_dir, const string& key,
+                        const string& backend_config) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->IsDirectory(cache_dir).ok()) {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(cache_dir));
+  }
+  // Write to a uniquely named file, then rename it, so that concurrent readers
+  // never see a partially written entry.
+  const string path = CacheEntryPath(cache_dir, key);
+  const string tmp_path = tensorflow::strings::StrCat(
+      path, ".tmp.", tensorflow::random::New64());
+  TF_RETURN_IF_ERROR(tensorflow::WriteStringToFile(
+      env, tmp_path, tensorflow::strings::StrCat(key, "\n", backend_config)));
+  Status status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
+}
+
+// Times every algorithm the DNN library offers for `instruction` on
+// `stream_exec` and returns the fastest one. The convolution runs on
+// zero-filled buffers, which does not affect its running time.
+StatusOr<se::dnn::AlgorithmConfig> PickBestAlgorithm(
+    const HloInstruction& instruction, const ConvolutionParams& params,
+    se::StreamExecutor* stream_exec) {
+  std::vector<se::dnn::AlgorithmType> algorithms;
+  bool succ = false;
+  switch (params.kind) {
+    case ConvolutionThunk::ConvolutionKind::kForward:
+      succ = stream_exec->GetConvolveAlgorithms(
+          /*with_winograd_nonfused=*/false, &algorithms);
+      break;
+    case ConvolutionThunk::ConvolutionKind::kBackwardFilter:
+      succ = stream_exec->GetConvolveBackwardFilterAlgorithms(
+          /*with_winograd_nonfused=*/false, &algorithms);
+      break;
+    case ConvolutionThunk::ConvolutionKind::kBackwardInput:
+      succ = stream_exec->GetConvolveBackwardDataAlgorithms(
+          /*with_winograd_nonfused=*/false, &algorithms);
+      break;
+  }
+  if (!succ || algorithms.empty()) {
+    return se::dnn::AlgorithmConfig();
+  }
+
+  // The allocator never modifies the platform; it only identifies it.
+  StreamExecutorMemoryAllocator allocator(
+      const_cast<se::Platform*>(stream_exec->platform()), {stream_exec});
+  const int device_ordinal = stream_exec->device_ordinal();
+  se::Stream stream(stream_exec);
+  stream.Init();
+
+  // Allocates and zeroes a buffer of `shape`.
+  std::vector<se::DeviceMemoryBase> buffers;
+  auto allocate = [&](const Shape& shape) -> StatusOr<se::DeviceMemoryBase> {
+    const int64 size = ShapeUtil::ByteSizeOf(shape);
+    TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase buffer,
+                        allocator.Allocate(device_ordinal, size));
+    buffers.push_back(buffer);
+    stream.ThenMemZero(&buffer, size);
+    return buffer;
+  };
+  auto deallocate_buffers = [&] {
+    for (se::DeviceMemoryBase& buffer : buffers) {
+      allocator.Deallocate(device_ordinal, &buffer).IgnoreError();
+    }
+  };
+
+  StatusOr<se::DeviceMemoryBase> input = allocate(params.input_shape);
+  StatusOr<se::DeviceMemoryBase> filter = allocate(params.filter_shape);
+  StatusOr<se::DeviceMemoryBase> output = allocate(params.output_shape);
+  if (!input.ok() || !filter.ok() || !output.ok()) {
+    // Not enough memory to measure; let the DNN library decide at run time.
+    deallocate_buffers();
+    return se::dnn::AlgorithmConfig();
+  }
+
+  se::dnn::ProfileResult best_result;
+  se::dnn::ProfileResult best_result_no_scratch;
+  for (se::dnn::AlgorithmType algorithm : algorithms) {
+    ConvolveScratchAllocator scratch_allocator(device_ordinal, &allocator);
+    se::dnn::ProfileResult profile_result;
+    Status status = RunConvolution(
+        params.kind, params.input_shape, params.filter_shape,
+        params.output_shape, se::DeviceMemory<float>(input.ValueOrDie()),
+        se::DeviceMemory<float>(filter.ValueOrDie()),
+        se::DeviceMemory<float>(output.ValueOrDie()), instruction.window(),
+        instruction.convolution_dimension_numbers(),
+        se::dnn::AlgorithmConfig(algorithm), &scratch_allocator, &stream,
+        &profile_result);
+    if (!status.ok() || !profile_result.is_valid()) {
+      VLOG(3) << "Convolution algorithm " << algorithm << " failed for "
+              << instruction.name() << ": " << status;
+      continue;
+    }
+    VLOG(3) << "Convolution algorithm " << algorithm << " took "
+            << profile_result.elapsed_time_in_ms() << "ms for "
+            << instruction.name();
+    if (profile_result.elapsed_time_in_ms() <
+        best_result.elapsed_time_in_ms()) {
+      best_result = profile_result;
+    }
+    if (scratch_allocator.TotalAllocatedBytes() == 0 &&
+        profile_result.elapsed_time_in_ms() <
+            best_result_no_scratch.elapsed_time_in_ms()) {
+      best_result_no_scratch = profile_result;
+    }
+  }
+  if (!stream.BlockHostUntilDone()) {
+    LOG(WARNING) << "Failed to synchronize the autotuning stream for "
+                 << instruction.name();
+  }
+  deallocate_buffers();
+
+  if (!best_result.is_valid()) {
+    return se::dnn::AlgorithmConfig();
+  }
+  return se::dnn::AlgorithmConfig(best_result.algorithm(),
+                                  best_result_no_scratch.algorithm());
+}
+
+}  // namespace
+
+StatusOr<bool> ConvolutionAlgorithmPicker::Run(HloModule* module) {
+  bool changed = false;
+  for (const auto& instruction : module->entry_computation()->instructions()) {
+    if (!ImplementedAsDnnConvolution(*instruction)) {
+      continue;
+    }
+    const ConvolutionParams params = GetConvolutionParams(*instruction);
+    const string key = AutotuneKey(*instruction, params, stream_exec_);
+
+    string backend_config;
+    bool memoized = false;
+    {
+      tensorflow::mutex_lock lock(autotune_cache_mu);
+      auto it = AutotuneCache().find(key);
+      if (it != AutotuneCache().end()) {
+        backend_config = it->second;
+        memoized = true;
+      }
+    }
+    if (!memoized) {
+      if (!LookupPersistedAlgorithm(cache_dir_, key, &backend_config)) {
+        TF_ASSIGN_OR_RETURN(
+            se::dnn::AlgorithmConfig algorithm_config,
+            PickBestAlgorithm(*instruction, params, stream_exec_));
+        backend_config = ConvolutionAlgorithmToBackendConfig(algorithm_config);
+        if (!cache_dir_.empty()) {
+          Status status = PersistAlgorithm(cache_dir_, key, backend_config);
+          if (!status.ok()) {
+            LOG(WARNING) << "Failed to persist autotuning result for "
+                         << instruction->name() << ": " << status;
+          }
+        }
+      }
+      tensorflow::mutex_lock lock(autotune_cache_mu);
+      AutotuneCache().emplace(key, backend_config);
+    }
+
+    VLOG(2) << "Picked " << backend_config << " for " << instruction->name();
+    if (instruction->backend_config() != backend_config) {
+      instruction->set_backend_config(backend_config);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
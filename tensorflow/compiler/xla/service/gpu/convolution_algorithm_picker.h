@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CONVOLUTION_ALGORITHM_PICKER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CONVOLUTION_ALGORITHM_PICKER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace xla {
+namespace gpu {
+
+// Picks the fastest DNN algorithm for every convolution in the module by
+// timing each candidate on `stream_exec`, and records the choice in the
+// convolution's backend config, where IrEmitterUnnested picks it up when it
+// builds the ConvolutionThunk.
+//
+// Timings are keyed by the device and the convolution's shapes, window and
+// dimension numbers. They are memoized for the lifetime of the process and,
+// if `cache_dir` is not empty, persisted there so that later processes can
+// skip the measurements.
+class ConvolutionAlgorithmPicker : public HloPassInterface {
+ public:
+  ConvolutionAlgorithmPicker(perftools::gputools::StreamExecutor* stream_exec,
+                             const string& cache_dir)
+      : stream_exec_(stream_exec), cache_dir_(cache_dir) {}
+
+  tensorflow::StringPiece name() const override {
+    return "convolution-algorithm-picker";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  perftools::gputools::StreamExecutor* stream_exec_;  // never null
+  const string cache_dir_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CONVOLUTION_ALGORITHM_PICKER_H_
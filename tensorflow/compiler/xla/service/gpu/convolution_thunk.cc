@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -99,7 +102,8 @@ ConvolutionThunk::ConvolutionThunk(
     const BufferAllocation::Slice& filter_buffer,
     const BufferAllocation::Slice& output_buffer, const Shape& input_shape,
     const Shape& filter_shape, const Shape& output_shape, const Window& window,
-    const ConvolutionDimensionNumbers& dim_nums, const HloInstruction* hlo)
+    const ConvolutionDimensionNumbers& dim_nums,
+    const se::dnn::AlgorithmConfig& algorithm_config, const HloInstruction* hlo)
     : Thunk(Kind::kConvolution, hlo),
       convolution_kind_(convolution_kind),
       input_buffer_(input_buffer),
@@ -109,18 +113,47 @@ ConvolutionThunk::ConvolutionThunk(
       filter_shape_(filter_shape),
       output_shape_(output_shape),
       window_(window),
-      dim_nums_(dim_nums) {}
+      dim_nums_(dim_nums),
+      algorithm_config_(algorithm_config) {}
 
 tensorflow::Status ConvolutionThunk::ExecuteOnStream(
     const BufferAllocations& buffer_allocations, se::Stream* stream) {
-  VLOG(3) << "Convolution kind: " << ConvolutionKindToString(convolution_kind_);
-  VLOG(3) << "input shape: { " << input_shape_.ShortDebugString() << " }";
-  VLOG(3) << "filter shape: { " << filter_shape_.ShortDebugString() << " }";
-  VLOG(3) << "Output shape: { " << output_shape_.ShortDebugString() << " }";
-  VLOG(3) << "Dim nums: { " << dim_nums_.ShortDebugString() << " }";
-  VLOG(3) << "Window: { " << window_.ShortDebugString() << " }";
+  se::DeviceMemory<float> input_data(
+      buffer_allocations.GetDeviceAddress(input_buffer_));
+  se::DeviceMemory<float> filter_data(
+      buffer_allocations.GetDeviceAddress(filter_buffer_));
+  se::DeviceMemory<float> output_data(
+      buffer_allocations.GetDeviceAddress(output_buffer_));
+  VLOG(2) << "Using convolution algorithm (" << algorithm_config_.algorithm()
+          << ", " << algorithm_config_.algorithm_no_scratch()
+          << ") for ConvolutionThunk: " << this;
+  ConvolveScratchAllocator scratch_allocator(
+      buffer_allocations.device_ordinal(),
+      buffer_allocations.memory_allocator());
+  return RunConvolution(convolution_kind_, input_shape_, filter_shape_,
+                        output_shape_, input_data, filter_data, output_data,
+                        window_, dim_nums_, algorithm_config_,
+                        &scratch_allocator, stream,
+                        /*profile_result=*/nullptr);
+}
+
+tensorflow::Status RunConvolution(
+    ConvolutionThunk::ConvolutionKind convolution_kind,
+    const Shape& input_shape, const Shape& filter_shape,
+    const Shape& output_shape, se::DeviceMemory<float> input_data,
+    se::DeviceMemory<float> filter_data, se::DeviceMemory<float> output_data,
+    const Window& window, const ConvolutionDimensionNumbers& dim_nums,
+    const se::dnn::AlgorithmConfig& algorithm_config,
+    se::ScratchAllocator* scratch_allocator, se::Stream* stream,
+    se::dnn::ProfileResult* profile_result) {
+  VLOG(3) << "Convolution kind: " << ConvolutionKindToString(convolution_kind);
+  VLOG(3) << "input shape: { " << input_shape.ShortDebugString() << " }";
+  VLOG(3) << "filter shape: { " << filter_shape.ShortDebugString() << " }";
+  VLOG(3) << "Output shape: { " << output_shape.ShortDebugString() << " }";
+  VLOG(3) << "Dim nums: { " << dim_nums.ShortDebugString() << " }";
+  VLOG(3) << "Window: { " << window.ShortDebugString() << " }";
 
-  const int num_dimensions = window_.dimensions_size();
+  const int num_dimensions = window.dimensions_size();
   CHECK_LE(num_dimensions, 3);
   // cuDNN does not support 1D convolutions. We therefore express 1D
   // convolutions as 2D convolutions where the first spatial dimension is 1.
@@ -128,10 +161,10 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
   // tensorflow/python/ops/nn_ops.py).
   const int effective_num_dimensions = std::max(2, num_dimensions);
 
-  CHECK_EQ(F32, output_shape_.element_type());
-  CHECK_EQ(num_dimensions, dim_nums_.spatial_dimensions_size());
-  CHECK_EQ(num_dimensions, dim_nums_.kernel_spatial_dimensions_size());
-  for (const WindowDimension& dim : window_.dimensions()) {
+  CHECK_EQ(F32, output_shape.element_type());
+  CHECK_EQ(num_dimensions, dim_nums.spatial_dimensions_size());
+  CHECK_EQ(num_dimensions, dim_nums.kernel_spatial_dimensions_size());
+  for (const WindowDimension& dim : window.dimensions()) {
     CHECK_EQ(dim.padding_low(), dim.padding_high());
   }
 
@@ -140,25 +173,25 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
   BatchDescriptor input_descriptor(effective_num_dimensions);
   input_descriptor.set_layout(DataLayout::kBatchDepthYX)
       .set_feature_map_count(
-          input_shape_.dimensions(dim_nums_.feature_dimension()))
-      .set_count(input_shape_.dimensions(dim_nums_.batch_dimension()));
+          input_shape.dimensions(dim_nums.feature_dimension()))
+      .set_count(input_shape.dimensions(dim_nums.batch_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
     // Note that the dimensions are reversed. The same holds below.
     input_descriptor.set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
-        input_shape_.dimensions(dim_nums_.spatial_dimensions(dim)));
+        input_shape.dimensions(dim_nums.spatial_dimensions(dim)));
   }
 
   FilterDescriptor filter_descriptor(effective_num_dimensions);
   filter_descriptor.set_layout(FilterLayout::kOutputInputYX)
       .set_input_feature_map_count(
-          filter_shape_.dimensions(dim_nums_.kernel_input_feature_dimension()))
-      .set_output_feature_map_count(filter_shape_.dimensions(
-          dim_nums_.kernel_output_feature_dimension()));
+          filter_shape.dimensions(dim_nums.kernel_input_feature_dimension()))
+      .set_output_feature_map_count(
+          filter_shape.dimensions(dim_nums.kernel_output_feature_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
     filter_descriptor.set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
-        filter_shape_.dimensions(dim_nums_.kernel_spatial_dimensions(dim)));
+        filter_shape.dimensions(dim_nums.kernel_spatial_dimensions(dim)));
   }
 
   ConvolutionDescriptor convolution_descriptor(effective_num_dimensions);
@@ -166,21 +199,21 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
     convolution_descriptor
         .set_zero_padding(
             static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
-            window_.dimensions(dim).padding_low())
+            window.dimensions(dim).padding_low())
         .set_filter_stride(
             static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
-            window_.dimensions(dim).stride());
+            window.dimensions(dim).stride());
   }
 
   BatchDescriptor output_descriptor(effective_num_dimensions);
   output_descriptor.set_layout(DataLayout::kBatchDepthYX)
       .set_feature_map_count(
-          output_shape_.dimensions(dim_nums_.feature_dimension()))
-      .set_count(output_shape_.dimensions(dim_nums_.batch_dimension()));
+          output_shape.dimensions(dim_nums.feature_dimension()))
+      .set_count(output_shape.dimensions(dim_nums.batch_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
     output_descriptor.set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
-        output_shape_.dimensions(dim_nums_.spatial_dimensions(dim)));
+        output_shape.dimensions(dim_nums.spatial_dimensions(dim)));
   }
 
   // Add a singleton dimension in the 1D convolution case.
@@ -193,30 +226,9 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
         .set_filter_stride(static_cast<se::dnn::DimIndex>(0), 1);
   }
 
-  se::DeviceMemory<float> input_data(
-      buffer_allocations.GetDeviceAddress(input_buffer_));
-  se::DeviceMemory<float> filter_data(
-      buffer_allocations.GetDeviceAddress(filter_buffer_));
-  se::DeviceMemory<float> output_data(
-      buffer_allocations.GetDeviceAddress(output_buffer_));
-  return ConvolveWithTune(input_descriptor, input_data, filter_descriptor,
-                          filter_data, output_descriptor, output_data,
-                          convolution_descriptor, buffer_allocations, stream);
-}
-
-tensorflow::Status ConvolutionThunk::Convolve(
-    const BatchDescriptor& input_descriptor, se::DeviceMemory<float> input_data,
-    const FilterDescriptor& filter_descriptor,
-    se::DeviceMemory<float> filter_data,
-    const BatchDescriptor& output_descriptor,
-    se::DeviceMemory<float> output_data,
-    const ConvolutionDescriptor& convolution_descriptor,
-    const se::dnn::AlgorithmConfig& algorithm_config, se::Stream* stream,
-    ConvolveScratchAllocator* scratch_allocator,
-    se::dnn::ProfileResult* profile_result) {
   bool launch_ok;
-  switch (convolution_kind_) {
-    case ConvolutionKind::kBackwardFilter:
+  switch (convolution_kind) {
+    case ConvolutionThunk::ConvolutionKind::kBackwardFilter:
       launch_ok =
           stream
               ->ThenConvolveBackwardFilterWithAlgorithm(
@@ -225,7 +237,7 @@ tensorflow::Status ConvolutionThunk::Convolve(
                   scratch_allocator, algorithm_config, profile_result)
               .ok();
       break;
-    case ConvolutionKind::kBackwardInput:
+    case ConvolutionThunk::ConvolutionKind::kBackwardInput:
       launch_ok = stream
                       ->ThenConvolveBackwardDataWithAlgorithm(
                           filter_descriptor, filter_data, output_descriptor,
@@ -234,7 +246,7 @@ tensorflow::Status ConvolutionThunk::Convolve(
                           profile_result)
                       .ok();
       break;
-    case ConvolutionKind::kForward:
+    case ConvolutionThunk::ConvolutionKind::kForward:
       launch_ok =
           stream
               ->ThenConvolveWithAlgorithm(
@@ -248,55 +260,38 @@ tensorflow::Status ConvolutionThunk::Convolve(
     return tensorflow::Status::OK();
   }
   return InternalError(
-      "Unable to launch convolution for thunk %p with type %s and algorithm "
-      "(%lld, %lld)",
-      this, ConvolutionKindToString(convolution_kind_).c_str(),
+      "Unable to launch convolution with type %s and algorithm (%lld, %lld)",
+      ConvolutionKindToString(convolution_kind).c_str(),
       algorithm_config.algorithm(), algorithm_config.algorithm_no_scratch());
 }
 
-std::vector<se::dnn::AlgorithmType> ConvolutionThunk::GetAlgorithms(
-    se::StreamExecutor* stream_exec) const {
-  std::vector<se::dnn::AlgorithmType> algorithms;
-  // TODO(yangzihao): Currently disable the use of winograd nonfused in XLA
-  // by default. Should send in conv parameters and enable it when
-  // ShouldIncludeWinogradNonfusedAlgo() returns true.
-  switch (convolution_kind_) {
-    case ConvolutionKind::kBackwardFilter:
-      CHECK(stream_exec->GetConvolveBackwardFilterAlgorithms(
-          /*with_winograd_nonfused=*/false, &algorithms));
-      break;
-    case ConvolutionKind::kBackwardInput:
-      CHECK(stream_exec->GetConvolveBackwardDataAlgorithms(
-          /*with_winograd_nonfused=*/false, &algorithms));
-      break;
-    case ConvolutionKind::kForward:
-      CHECK(stream_exec->GetConvolveAlgorithms(/*with_winograd_nonfused=*/false,
-                                               &algorithms));
-      break;
-  }
-  return algorithms;
+string ConvolutionAlgorithmToBackendConfig(
+    const se::dnn::AlgorithmConfig& algorithm_config) {
+  return tensorflow::strings::Printf(
+      "conv_algorithm=%lld,%lld", algorithm_config.algorithm(),
+      algorithm_config.algorithm_no_scratch());
 }
 
-tensorflow::Status ConvolutionThunk::ConvolveWithTune(
-    const BatchDescriptor& input_descriptor, se::DeviceMemory<float> input_data,
-    const FilterDescriptor& filter_descriptor,
-    se::DeviceMemory<float> filter_data,
-    const BatchDescriptor& output_descriptor,
-    se::DeviceMemory<float> output_data,
-    const ConvolutionDescriptor& convolution_descriptor,
-    const BufferAllocations& buffer_allocations, se::Stream* stream) {
-
-  // auto-tuning logic is inside MIOpen
-  VLOG(2) << "Using convolution algorithm (" << best_algorithm_.algorithm()
-          << ", " << best_algorithm_.algorithm_no_scratch()
-          << ") for ConvolutionThunk: " << this;
-  ConvolveScratchAllocator scratch_allocator(
-      buffer_allocations.device_ordinal(),
-      buffer_allocations.memory_allocator());
-  return Convolve(input_descriptor, input_data, filter_descriptor,
-                  filter_data, output_descriptor, output_data,
-                  convolution_descriptor, best_algorithm_, stream,
-                  &scratch_allocator, nullptr);
+StatusOr<se::dnn::AlgorithmConfig> BackendConfigToConvolutionAlgorithm(
+    const string& backend_config) {
+  if (backend_config.empty()) {
+    return se::dnn::AlgorithmConfig();
+  }
+  tensorflow::StringPiece config(backend_config);
+  std::vector<string> algorithms;
+  if (tensorflow::str_util::ConsumePrefix(&config, "conv_algorithm=")) {
+    algorithms = tensorflow::str_util::Split(config, ',');
+  }
+  int64 algorithm;
+  int64 algorithm_no_scratch;
+  if (algorithms.size() != 2 ||
+      !tensorflow::strings::safe_strto64(algorithms[0], &algorithm) ||
+      !tensorflow::strings::safe_strto64(algorithms[1],
+                                         &algorithm_no_scratch)) {
+    return InvalidArgument("Invalid convolution backend config: %s",
+                           backend_config.c_str());
+  }
+  return se::dnn::AlgorithmConfig(algorithm, algorithm_no_scratch);
 }
 
 }  // namespace gpu
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -67,63 +68,29 @@ class ConvolutionThunk : public Thunk {
     kForward,         // Forward convolution.
   };
 
-  // Constructs a thunk for launching a DNN convolution.
+  // Constructs a thunk for launching a DNN convolution with the algorithm in
+  // `algorithm_config`, which is usually picked at compile time by
+  // ConvolutionAlgorithmPicker.
   // Semantics of null hlo_instruction argument are as in Thunk.
-  ConvolutionThunk(ConvolutionKind convolution_kind,
-                   const BufferAllocation::Slice& input_buffer,
-                   const BufferAllocation::Slice& filter_buffer,
-                   const BufferAllocation::Slice& output_buffer,
-                   const Shape& input_shape, const Shape& filter_shape,
-                   const Shape& output_shape, const Window& window,
-                   const ConvolutionDimensionNumbers& dnums,
-                   const HloInstruction* hlo);
+  ConvolutionThunk(
+      ConvolutionKind convolution_kind,
+      const BufferAllocation::Slice& input_buffer,
+      const BufferAllocation::Slice& filter_buffer,
+      const BufferAllocation::Slice& output_buffer, const Shape& input_shape,
+      const Shape& filter_shape, const Shape& output_shape,
+      const Window& window, const ConvolutionDimensionNumbers& dnums,
+      const perftools::gputools::dnn::AlgorithmConfig& algorithm_config,
+      const HloInstruction* hlo);
 
   ConvolutionThunk(const ConvolutionThunk&) = delete;
   ConvolutionThunk& operator=(const ConvolutionThunk&) = delete;
 
-  // Does the convolution for the thunk on "stream". Auto-tuning happens on the
-  // first run of this function.
+  // Does the convolution for the thunk on "stream".
   tensorflow::Status ExecuteOnStream(
       const BufferAllocations& buffer_allocations,
       perftools::gputools::Stream* stream) override;
 
  private:
-  tensorflow::Status ConvolveWithTune(
-      const perftools::gputools::dnn::BatchDescriptor& input_descriptor,
-      perftools::gputools::DeviceMemory<float> input_data,
-      const perftools::gputools::dnn::FilterDescriptor& filter_descriptor,
-      perftools::gputools::DeviceMemory<float> filter_data,
-      const perftools::gputools::dnn::BatchDescriptor& output_descriptor,
-      perftools::gputools::DeviceMemory<float> output_data,
-      const perftools::gputools::dnn::ConvolutionDescriptor&
-          convolution_descriptor,
-      const BufferAllocations& buffer_allocations,
-      perftools::gputools::Stream* stream);
-
-  tensorflow::Status Convolve(
-      const perftools::gputools::dnn::BatchDescriptor& input_descriptor,
-      perftools::gputools::DeviceMemory<float> input_data,
-      const perftools::gputools::dnn::FilterDescriptor& filter_descriptor,
-      perftools::gputools::DeviceMemory<float> filter_data,
-      const perftools::gputools::dnn::BatchDescriptor& output_descriptor,
-      perftools::gputools::DeviceMemory<float> output_data,
-      const perftools::gputools::dnn::ConvolutionDescriptor&
-          convolution_descriptor,
-      const perftools::gputools::dnn::AlgorithmConfig& algorithm_config,
-      perftools::gputools::Stream* stream,
-      ConvolveScratchAllocator* scratch_allocator,
-      perftools::gputools::dnn::ProfileResult* profile_result);
-
-  // Returns the convolve algorithms that can be used for this ConvolutionThunk.
-  std::vector<perftools::gputools::dnn::AlgorithmType> GetAlgorithms(
-      perftools::gputools::StreamExecutor* stream_exec) const;
-
-  // Fastest cuDNN convolution algorithm for this thunk learned from
-  // auto-tuning. If auto-tuning is disabled or failed, best_algorithm_ is set
-  // to the default value indicating cuDNN's convolution will choose
-  // the best algorithm from some heuristics based on its parameters.
-  perftools::gputools::dnn::AlgorithmConfig best_algorithm_;
-
   const ConvolutionKind convolution_kind_;
 
   const BufferAllocation::Slice input_buffer_;
@@ -137,11 +104,44 @@ class ConvolutionThunk : public Thunk {
   const Window window_;
 
   const ConvolutionDimensionNumbers dim_nums_;
+
+  // The convolution algorithm to use. If it was not picked by autotuning, it
+  // is the default value, which lets the DNN library choose an algorithm from
+  // heuristics based on the convolution parameters.
+  const perftools::gputools::dnn::AlgorithmConfig algorithm_config_;
 };
 
 string ConvolutionKindToString(
     ConvolutionThunk::ConvolutionKind convolution_kind);
 
+// Runs a convolution of `convolution_kind` on `stream`, reading and writing the
+// given device buffers, with the algorithm in `algorithm_config`. The shapes,
+// window and dimension numbers mean the same as for ConvolutionThunk. If
+// `profile_result` is not null, the convolution is timed and the measurement
+// is stored there.
+tensorflow::Status RunConvolution(
+    ConvolutionThunk::ConvolutionKind convolution_kind,
+    const Shape& input_shape, const Shape& filter_shape,
+    const Shape& output_shape,
+    perftools::gputools::DeviceMemory<float> input_data,
+    perftools::gputools::DeviceMemory<float> filter_data,
+    perftools::gputools::DeviceMemory<float> output_data,
+    const Window& window, const ConvolutionDimensionNumbers& dnums,
+    const perftools::gputools::dnn::AlgorithmConfig& algorithm_config,
+    perftools::gputools::ScratchAllocator* scratch_allocator,
+    perftools::gputools::Stream* stream,
+    perftools::gputools::dnn::ProfileResult* profile_result);
+
+// Returns the backend config string of a convolution instruction which records
+// `algorithm_config`; see HloInstruction::backend_config().
+string ConvolutionAlgorithmToBackendConfig(
+    const perftools::gputools::dnn::AlgorithmConfig& algorithm_config);
+
+// Parses the algorithm recorded by ConvolutionAlgorithmToBackendConfig. An
+// empty `backend_config` yields the default algorithm.
+StatusOr<perftools::gputools::dnn::AlgorithmConfig>
+BackendConfigToConvolutionAlgorithm(const string& backend_config);
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/convolution_thunk.h"
+
+#include "tensorflow/compiler/xla/test.h"
+
+namespace se = ::perftools::gputools;
+
+namespace xla {
+namespace gpu {
+namespace {
+
+TEST(ConvolutionThunkTest, BackendConfigRoundTrip) {
+  const se::dnn::AlgorithmConfig algorithm_config(/*algorithm=*/3,
+                                                  /*algorithm_no_scratch=*/1);
+  StatusOr<se::dnn::AlgorithmConfig> parsed =
+      BackendConfigToConvolutionAlgorithm(
+          ConvolutionAlgorithmToBackendConfig(algorithm_config));
+  ASSERT_TRUE(parsed.ok());
+  EXPECT_EQ(algorithm_config, parsed.ValueOrDie());
+}
+
+TEST(ConvolutionThunkTest, EmptyBackendConfigIsDefaultAlgorithm) {
+  StatusOr<se::dnn::AlgorithmConfig> parsed =
+      BackendConfigToConvolutionAlgorithm("");
+  ASSERT_TRUE(parsed.ok());
+  EXPECT_EQ(se::dnn::AlgorithmConfig(), parsed.ValueOrDie());
+}
+
+TEST(ConvolutionThunkTest, MalformedBackendConfigIsAnError) {
+  EXPECT_FALSE(BackendConfigToConvolutionAlgorithm("conv_algorithm=3").ok());
+  EXPECT_FALSE(BackendConfigToConvolutionAlgorithm("algorithm=3,1").ok());
+  EXPECT_FALSE(BackendConfigToConvolutionAlgorithm("conv_algorithm=a,1").ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
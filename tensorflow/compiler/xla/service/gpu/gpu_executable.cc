@@ -240,7 +240,10 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::ExecuteOnStream(
             TF_ASSIGN_OR_RETURN(
                 const BufferAllocation::Slice slice,
                 this->assignment_->GetUniqueSlice(hlo, buffers[0]->index()));
-            CHECK(!slice.allocation()->is_entry_computation_parameter());
+            // Only outputs written in place of donated parameters may live
+            // in parameter allocations.
+            CHECK(!slice.allocation()->is_entry_computation_parameter() ||
+                  slice.allocation()->is_donated_parameter());
             referred_by_output.insert(
                 buffer_allocations->GetDeviceAddress(slice.index()));
             return Status::OK();
@@ -321,11 +324,13 @@ StatusOr<std::unique_ptr<ShapedBuffer>> GpuExecutable::ExecuteOnStream(
                   VLOG(4) << "Looking at: " << sources[0];
 
                   // The source instruction should have a non-parameter buffer
-                  // assigned.
+                  // assigned, unless it was written in place of a donated
+                  // parameter.
                   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
                                       this->assignment_->GetUniqueSlice(
                                           src_hlo, sources[0]->index()));
-                  CHECK(!slice.allocation()->is_entry_computation_parameter());
+                  CHECK(!slice.allocation()->is_entry_computation_parameter() ||
+                        slice.allocation()->is_donated_parameter());
 
                   perftools::gputools::DeviceMemoryBase src_base =
                       buffer_allocations->GetDeviceAddress(slice.index());
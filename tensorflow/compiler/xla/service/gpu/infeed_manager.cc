@@ -33,10 +33,22 @@ void InfeedManager::Reset() {
     buffer->Done();
   }
   enqueued_buffer_.clear();
+  space_cv_.notify_all();
+}
+
+void InfeedManager::set_max_depth(int64 max_depth) {
+  CHECK_GE(max_depth, 0);
+  tensorflow::mutex_lock l(mu_);
+  max_depth_ = max_depth;
+  space_cv_.notify_all();
 }
 
 void InfeedManager::EnqueueBuffers(const std::vector<InfeedBuffer*>& buffers) {
   tensorflow::mutex_lock l(mu_);
+  while (max_depth_ > 0 && !enqueued_buffer_.empty() &&
+         enqueued_buffer_.size() + buffers.size() > max_depth_) {
+    space_cv_.wait(l);
+  }
   bool was_empty = enqueued_buffer_.empty();
   for (gpu::InfeedBuffer* b : buffers) {
     enqueued_buffer_.push_back(b);
@@ -58,6 +70,10 @@ InfeedBuffer* InfeedManager::BlockingDequeueBuffer() {
   InfeedBuffer* current_buffer = enqueued_buffer_.front();
   enqueued_buffer_.pop_front();
   dequeued_buffer_.insert(current_buffer);
+  if (max_depth_ > 0) {
+    // Producers may be waiting for different amounts of space.
+    space_cv_.notify_all();
+  }
   return current_buffer;
 }
 
@@ -75,6 +91,7 @@ void InfeedManager::ReleaseBuffers(const std::vector<InfeedBuffer*>& buffers) {
 }
 
 se::Stream* InfeedManager::GetStream(se::StreamExecutor* executor) {
+  tensorflow::mutex_lock l(mu_);
   if (host_to_device_executor_ == nullptr) {
     host_to_device_executor_ = executor;
     host_to_device_stream_ = MakeUnique<se::Stream>(executor);
@@ -37,10 +37,9 @@ namespace gpu {
 // Current limitations:
 // * Does not handle multiple devices/replicas.
 //
-// * Buffer space on GPU is allocated on every infeed enqueue request,
-// and it does not handle the case when it runs out of
-// memory. Potential solution is to pre-allocate a fixed amount of
-// memory and block when that memory is full.
+// * Buffer space on GPU is allocated on every infeed enqueue request.
+// Bounding the queue with set_max_depth limits how many buffers are
+// resident, but a failed allocation is still fatal.
 
 // Defines an infeed buffer that is passed to the runtime by
 // the client. The client manages the memory of the buffer.
@@ -82,10 +81,18 @@ class InfeedManager {
   // condition is to call Reset when no computation is taking place.
   void Reset();
 
+  // Bounds the infeed queue to max_depth buffers; zero (the default)
+  // leaves it unbounded.
+  void set_max_depth(int64 max_depth);
+
   // Adds a set of buffers to the infeed queue atomically. buffer->Done
   // will be called when the buffer will no longer be accessed by the
   // InfeedManager, either as a result of a call to Reset or because the
   // runtime has dequeued and used the buffer.
+  //
+  // If the queue is bounded, blocks while adding the buffers would
+  // exceed max_depth; an empty queue always accepts the set. May be
+  // called concurrently by several producers.
   void EnqueueBuffers(const std::vector<InfeedBuffer*>& buffers);
 
   // Blocks until the infeed queue is non-empty, then returns the
@@ -99,7 +106,7 @@ class InfeedManager {
   // Returns a cached stream associated with an executor. Allocates a
   // new stream on the first invocation. On subsequent invocations, if
   // the cached executor is not the same as the requested executor,
-  // returns null.
+  // returns null. Thread-safe.
   perftools::gputools::Stream* GetStream(
       perftools::gputools::StreamExecutor* executor);
 
@@ -112,6 +119,13 @@ class InfeedManager {
   // enqueued to an empty queue.
   tensorflow::condition_variable cv_;
 
+  // Condition variable that is signaled every time buffers leave a
+  // bounded queue, to wake up producers blocked in EnqueueBuffers.
+  tensorflow::condition_variable space_cv_;
+
+  // Maximum number of enqueued buffers, or 0 if unbounded.
+  int64 max_depth_ = 0;
+
   // InfeedBuffer* queue contents are not owned, but buffer->Done must
   // be called when the buffer is no longer needed by the runtime.
   std::deque<InfeedBuffer*> enqueued_buffer_;
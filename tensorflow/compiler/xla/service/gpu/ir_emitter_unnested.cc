@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "external/llvm/include/llvm/ADT/StringRef.h"
 #include "external/llvm/include/llvm/IR/BasicBlock.h"
+#include "external/llvm/include/llvm/IR/DerivedTypes.h"
 #include "external/llvm/include/llvm/IR/Function.h"
 #include "external/llvm/include/llvm/IR/IRBuilder.h"
 #include "external/llvm/include/llvm/IR/Instructions.h"
@@ -289,11 +290,25 @@ Status IrEmitterUnnested::HandleFusion(HloInstruction* fusion) {
   HloInstruction* root = fusion->fused_expression_root();
   // HandleFusion specializes reduction from a multi-dimensional array to a 1D
   // array. The specialized version requires a initializer thunk that
-  // initializes the output array to the initial value of the reduce.
+  // initializes the output array to the initial value of the reduce. A
+  // multi-output input fusion, whose root is a tuple of such reductions over
+  // the same input, computes all of them in a single pass over the input.
   if (HloInstruction::FusionKind::kInput == fusion->fusion_kind()) {
     switch (root->opcode()) {
+      case HloOpcode::kTuple:
       case HloOpcode::kReduce: {
         VLOG(3) << "Emitting fused reduction to vector: " << fusion->ToString();
+        std::vector<HloInstruction*> reduces;
+        if (root->opcode() == HloOpcode::kTuple) {
+          reduces.assign(root->operands().begin(), root->operands().end());
+        } else {
+          reduces.push_back(root);
+        }
+        for (const HloInstruction* reduce : reduces) {
+          TF_RET_CHECK(HloOpcode::kReduce == reduce->opcode())
+              << "Bad output of multi-output input fusion: "
+              << reduce->ToString();
+        }
         std::vector<std::unique_ptr<Thunk>> thunks;
         thunks.emplace_back(BuildKernelThunk(fusion));
         TF_RETURN_IF_ERROR(EmitInitializer(
@@ -312,7 +327,7 @@ Status IrEmitterUnnested::HandleFusion(HloInstruction* fusion) {
         FusedIrEmitter fused_emitter(parameter_arrays, &elemental_emitter);
         TF_RETURN_IF_ERROR(root->Accept(&fused_emitter));
 
-        Shape input_shape = root->operand(0)->shape();
+        Shape input_shape = reduces.front()->operand(0)->shape();
         // EmitReductionToVector requires the input shape to have a layout, but
         // fused instructions don't have one. So we determine its layout from
         // the fusion's operands. The choice of the layout only affects
@@ -346,10 +361,18 @@ Status IrEmitterUnnested::HandleFusion(HloInstruction* fusion) {
         TF_RETURN_IF_ERROR(
             choose_input_layout(fusion->operands(), &input_shape));
 
-        return EmitReductionToVector(
-            root, input_shape, fused_emitter.GetGenerator(root->operand(0)),
-            fused_emitter.GetGenerator(root->operand(1)), root->dimensions(),
-            root->to_apply());
+        std::vector<llvm_ir::ElementGenerator> input_gens;
+        std::vector<llvm_ir::ElementGenerator> init_value_gens;
+        std::vector<HloComputation*> reducers;
+        for (HloInstruction* reduce : reduces) {
+          input_gens.push_back(fused_emitter.GetGenerator(reduce->operand(0)));
+          init_value_gens.push_back(
+              fused_emitter.GetGenerator(reduce->operand(1)));
+          reducers.push_back(reduce->to_apply());
+        }
+        return EmitReductionToVector(reduces.front(), input_shape, input_gens,
+                                     init_value_gens,
+                                     reduces.front()->dimensions(), reducers);
       }
       default:
         LOG(FATAL) << "Bad opcode for input fusion: "
@@ -745,8 +768,9 @@ Status IrEmitterUnnested::HandleCopy(HloInstruction* copy) {
 
 Status IrEmitterUnnested::EmitColumnReduction(
     int64 height, int64 width, HloInstruction* reduce, const Shape& input_shape,
-    const llvm_ir::ElementGenerator& input_gen,
-    const llvm_ir::ElementGenerator& init_value_gen, HloComputation* reducer) {
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> input_gens,
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> init_value_gens,
+    tensorflow::gtl::ArraySlice<HloComputation*> reducers) {
   // Divide the input matrix into tiles of size Kx1. For example, when the
   // input matrix is 4x4 and K=2, the tiled matrix looks like
   //
@@ -758,6 +782,9 @@ Status IrEmitterUnnested::EmitColumnReduction(
   // Each tile is first partially reduced to a scalar by a thread, and then the
   // scalar is accumulated to the output vector using atomic operations. We
   // choose 16 as the tile size, which matches Eigen's ColumnReduceKernel.
+  //
+  // When several reductions are emitted together, each thread keeps one
+  // partial result per reduction, so that the tile is read only once.
   constexpr int64 kTileSize = 16;
   // If the height is not a multiple of the tile size, we pad the bottom of the
   // input matrix.
@@ -791,14 +818,17 @@ Status IrEmitterUnnested::EmitColumnReduction(
     // Emit the loop body that reduces one tile.
     llvm::Type* element_ir_type = llvm_ir::PrimitiveTypeToIrType(
         input_shape.element_type(), &ir_builder_);
-    llvm::Value* partial_reduction_result_address =
-        llvm_ir::EmitAllocaAtFunctionEntry(element_ir_type,
-                                           "partial_reduction_result",
-                                           &ir_builder_);
-    {
+    std::vector<llvm::Value*> partial_reduction_result_addresses;
+    for (int64 i = 0; i < reducers.size(); ++i) {
+      llvm::Value* partial_reduction_result_address =
+          llvm_ir::EmitAllocaAtFunctionEntry(
+              element_ir_type, "partial_reduction_result." + std::to_string(i),
+              &ir_builder_);
       TF_ASSIGN_OR_RETURN(llvm::Value * init_ir_value,
-                          init_value_gen(llvm_ir::IrArray::Index({})));
+                          init_value_gens[i](llvm_ir::IrArray::Index({})));
       ir_builder_.CreateStore(init_ir_value, partial_reduction_result_address);
+      partial_reduction_result_addresses.push_back(
+          partial_reduction_result_address);
     }
 
     // Emit an inner for-loop that partially reduces the elements in the given
@@ -830,38 +860,40 @@ Status IrEmitterUnnested::EmitColumnReduction(
         // the partial reduction result.
         llvm_ir::SetToFirstInsertPoint(if_data.true_block, &ir_builder_);
       }
-      llvm::Value* input_address = ir_builder_.CreateAlloca(element_ir_type);
-      {
-        // {y,x} is an index to input_matrix_shape [height,width]. We need to
-        // convert that to an index to input_shape (the shape of the operand of
-        // "reduce"). This conversion is composed of a transposition from
-        // input_shape to normalized_input_shape and a reshape from
-        // normalized_input_shape to input_matrix_shape.
-        const Shape normalized_input_shape =
-            ShapeUtil::NormalizeShapeToMonotonicDim0MajorLayout(input_shape);
-        const std::vector<int64> transpose_dimension_mapping(
-            input_shape.layout().minor_to_major().rbegin(),
-            input_shape.layout().minor_to_major().rend());
-
-        const Shape input_matrix_shape =
-            ShapeUtil::MakeShapeWithMonotonicDim0MajorLayout(
-                input_shape.element_type(), {height, width});
-        const llvm_ir::IrArray::Index input_matrix_index(
-            {y, x}, input_matrix_shape, &ir_builder_);
-        const llvm_ir::IrArray::Index input_index =
-            input_matrix_index
-                .SourceIndexOfReshape(input_matrix_shape,
-                                      normalized_input_shape, &ir_builder_)
-                .SourceIndexOfTranspose(normalized_input_shape, input_shape,
-                                        transpose_dimension_mapping,
-                                        &ir_builder_);
+      // {y,x} is an index to input_matrix_shape [height,width]. We need to
+      // convert that to an index to input_shape (the shape of the operand of
+      // "reduce"). This conversion is composed of a transposition from
+      // input_shape to normalized_input_shape and a reshape from
+      // normalized_input_shape to input_matrix_shape.
+      const Shape normalized_input_shape =
+          ShapeUtil::NormalizeShapeToMonotonicDim0MajorLayout(input_shape);
+      const std::vector<int64> transpose_dimension_mapping(
+          input_shape.layout().minor_to_major().rbegin(),
+          input_shape.layout().minor_to_major().rend());
+
+      const Shape input_matrix_shape =
+          ShapeUtil::MakeShapeWithMonotonicDim0MajorLayout(
+              input_shape.element_type(), {height, width});
+      const llvm_ir::IrArray::Index input_matrix_index(
+          {y, x}, input_matrix_shape, &ir_builder_);
+      const llvm_ir::IrArray::Index input_index =
+          input_matrix_index
+              .SourceIndexOfReshape(input_matrix_shape, normalized_input_shape,
+                                    &ir_builder_)
+              .SourceIndexOfTranspose(normalized_input_shape, input_shape,
+                                      transpose_dimension_mapping,
+                                      &ir_builder_);
+      for (int64 i = 0; i < reducers.size(); ++i) {
+        llvm::Value* input_address = ir_builder_.CreateAlloca(element_ir_type);
         TF_ASSIGN_OR_RETURN(llvm::Value * input_ir_value,
-                            input_gen(input_index));
+                            input_gens[i](input_index));
         ir_builder_.CreateStore(input_ir_value, input_address);
+        TF_RETURN_IF_ERROR(EmitCallToNestedComputation(
+            *reducers[i],
+            {partial_reduction_result_addresses[i], input_address},
+            partial_reduction_result_addresses[i]));
       }
-      return (EmitCallToNestedComputation(
-          *reducer, {partial_reduction_result_address, input_address},
-          partial_reduction_result_address));
+      return Status::OK();
     };
 
     // y_end = kTileSize + y_in_tiles * kTileSize, i.e., the y location that's
@@ -888,13 +920,15 @@ Status IrEmitterUnnested::EmitColumnReduction(
     // element.
     llvm_ir::SetToFirstInsertPoint(if_tile_in_bounds_data.after_block,
                                    &ir_builder_);
-    const HloInstruction* output =
-        reduce->IsFused() ? reduce->fusion_instruction() : reduce;
-    llvm::Value* output_address = GetIrArray(*output).EmitArrayElementAddress(
-        llvm_ir::IrArray::Index(x, output->shape(), &ir_builder_), &ir_builder_,
-        "output_element_address");
-    return EmitAtomicOperationForNestedComputation(
-        *reducer, output_address, partial_reduction_result_address);
+    for (int64 i = 0; i < reducers.size(); ++i) {
+      const llvm_ir::IrArray output_array = GetReductionOutputArray(*reduce, i);
+      llvm::Value* output_address = output_array.EmitArrayElementAddress(
+          llvm_ir::IrArray::Index(x, output_array.GetShape(), &ir_builder_),
+          &ir_builder_, "output_element_address");
+      TF_RETURN_IF_ERROR(EmitAtomicOperationForNestedComputation(
+          *reducers[i], output_address, partial_reduction_result_addresses[i]));
+    }
+    return Status::OK();
   };
 
   // Emit a parallel loop that iterate through all input tiles.
@@ -914,8 +948,10 @@ Status IrEmitterUnnested::EmitColumnReduction(
 
 Status IrEmitterUnnested::EmitRowReduction(
     int64 depth, int64 height, int64 width, HloInstruction* reduce,
-    const Shape& input_shape, const llvm_ir::ElementGenerator& input_gen,
-    const llvm_ir::ElementGenerator& init_value_gen, HloComputation* reducer) {
+    const Shape& input_shape,
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> input_gens,
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> init_value_gens,
+    tensorflow::gtl::ArraySlice<HloComputation*> reducers) {
   // A naive algorithm is:
   // 1. Divide the input tensor into tiles of size 1x1xK.
   // 2. Partially reduces each tile to a scalar using one thread.
@@ -963,6 +999,9 @@ Status IrEmitterUnnested::EmitRowReduction(
   // element_id_in_tile, which makes the code more friendly to optimizations
   // such as LICM.
   //
+  // When several reductions are emitted together, all of the above is done
+  // for each of them on the same input element, so the input is read once.
+  //
   // for (linear_index = threadIdx.x + blockIdx.x * blockDim.x;
   //      linear_index < depth * height * width_in_tiles;
   //      linear_index += blockDim.x * gridDim.x) {
@@ -1008,12 +1047,16 @@ Status IrEmitterUnnested::EmitRowReduction(
     // Emit the loop body that reduces one tile.
     llvm::Type* element_ir_type = llvm_ir::PrimitiveTypeToIrType(
         input_shape.element_type(), &ir_builder_);
-    llvm::Value* partial_reduction_result_address = ir_builder_.CreateAlloca(
-        element_ir_type, /*ArraySize=*/nullptr, "partial_reduction_result");
-    {
+    std::vector<llvm::Value*> partial_reduction_result_addresses;
+    for (int64 i = 0; i < reducers.size(); ++i) {
+      llvm::Value* partial_reduction_result_address = ir_builder_.CreateAlloca(
+          element_ir_type, /*ArraySize=*/nullptr,
+          "partial_reduction_result." + std::to_string(i));
       TF_ASSIGN_OR_RETURN(llvm::Value * init_ir_value,
-                          init_value_gen(llvm_ir::IrArray::Index({})));
+                          init_value_gens[i](llvm_ir::IrArray::Index({})));
       ir_builder_.CreateStore(init_ir_value, partial_reduction_result_address);
+      partial_reduction_result_addresses.push_back(
+          partial_reduction_result_address);
     }
 
     // Emit an inner for-loop that partially reduces the elements in the given
@@ -1070,38 +1113,41 @@ Status IrEmitterUnnested::EmitRowReduction(
       }
 
       // Emit code that reads the input element and accumulates it to the
-      // partial reduction result.
-      llvm::Value* input_address = ir_builder_.CreateAlloca(element_ir_type);
-      {
-        // {z,y,x} is an index to input_3d_tensor_shape [depth,height,width]. We
-        // need to convert that to an index to input_shape (the shape of the
-        // operand of "reduce"). This conversion is composed of a transposition
-        // from input_shape to normalized_input_shape and a reshape from
-        // normalized_input_shape to input_3d_tensor_shape.
-        const Shape normalized_input_shape =
-            ShapeUtil::NormalizeShapeToMonotonicDim0MajorLayout(input_shape);
-        const std::vector<int64> transpose_dimension_mapping(
-            input_shape.layout().minor_to_major().rbegin(),
-            input_shape.layout().minor_to_major().rend());
-        const Shape input_3d_tensor_shape =
-            ShapeUtil::MakeShapeWithMonotonicDim0MajorLayout(
-                input_shape.element_type(), {depth, height, width});
-        const llvm_ir::IrArray::Index input_3d_tensor_index(
-            {z, y, x}, input_3d_tensor_shape, &ir_builder_);
-        const llvm_ir::IrArray::Index input_index =
-            input_3d_tensor_index
-                .SourceIndexOfReshape(input_3d_tensor_shape,
-                                      normalized_input_shape, &ir_builder_)
-                .SourceIndexOfTranspose(normalized_input_shape, input_shape,
-                                        transpose_dimension_mapping,
-                                        &ir_builder_);
+      // partial reduction results.
+      //
+      // {z,y,x} is an index to input_3d_tensor_shape [depth,height,width]. We
+      // need to convert that to an index to input_shape (the shape of the
+      // operand of "reduce"). This conversion is composed of a transposition
+      // from input_shape to normalized_input_shape and a reshape from
+      // normalized_input_shape to input_3d_tensor_shape.
+      const Shape normalized_input_shape =
+          ShapeUtil::NormalizeShapeToMonotonicDim0MajorLayout(input_shape);
+      const std::vector<int64> transpose_dimension_mapping(
+          input_shape.layout().minor_to_major().rbegin(),
+          input_shape.layout().minor_to_major().rend());
+      const Shape input_3d_tensor_shape =
+          ShapeUtil::MakeShapeWithMonotonicDim0MajorLayout(
+              input_shape.element_type(), {depth, height, width});
+      const llvm_ir::IrArray::Index input_3d_tensor_index(
+          {z, y, x}, input_3d_tensor_shape, &ir_builder_);
+      const llvm_ir::IrArray::Index input_index =
+          input_3d_tensor_index
+              .SourceIndexOfReshape(input_3d_tensor_shape,
+                                    normalized_input_shape, &ir_builder_)
+              .SourceIndexOfTranspose(normalized_input_shape, input_shape,
+                                      transpose_dimension_mapping,
+                                      &ir_builder_);
+      for (int64 i = 0; i < reducers.size(); ++i) {
+        llvm::Value* input_address = ir_builder_.CreateAlloca(element_ir_type);
         TF_ASSIGN_OR_RETURN(llvm::Value * input_ir_value,
-                            input_gen(input_index));
+                            input_gens[i](input_index));
         ir_builder_.CreateStore(input_ir_value, input_address);
+        TF_RETURN_IF_ERROR(EmitCallToNestedComputation(
+            *reducers[i],
+            {partial_reduction_result_addresses[i], input_address},
+            partial_reduction_result_addresses[i]));
       }
-      return EmitCallToNestedComputation(
-          *reducer, {partial_reduction_result_address, input_address},
-          partial_reduction_result_address);
+      return Status::OK();
     };
 
     llvm::Value* tile_in_bounds = ir_builder_.CreateOr(
@@ -1123,35 +1169,40 @@ Status IrEmitterUnnested::EmitRowReduction(
                                    &ir_builder_);
     for (int shuffle_distance = (kWarpSize / 2); shuffle_distance >= 1;
          shuffle_distance /= 2) {
-      llvm::Value* partial_reduction_result = ir_builder_.CreateLoad(
-          partial_reduction_result_address, "partial_reduction_result");
-      llvm::Value* result_from_other_lane = ir_builder_.CreateAlloca(
-          element_ir_type, nullptr, "result_from_other_lane");
-      ir_builder_.CreateStore(
-          EmitShuffleDown(partial_reduction_result,
-                          ir_builder_.getInt32(shuffle_distance), &ir_builder_),
-          result_from_other_lane);
-      TF_RETURN_IF_ERROR(EmitCallToNestedComputation(
-          *reducer, {partial_reduction_result_address, result_from_other_lane},
-          partial_reduction_result_address));
+      for (int64 i = 0; i < reducers.size(); ++i) {
+        llvm::Value* partial_reduction_result = ir_builder_.CreateLoad(
+            partial_reduction_result_addresses[i], "partial_reduction_result");
+        llvm::Value* result_from_other_lane = ir_builder_.CreateAlloca(
+            element_ir_type, nullptr, "result_from_other_lane");
+        ir_builder_.CreateStore(
+            EmitShuffleDown(partial_reduction_result,
+                            ir_builder_.getInt32(shuffle_distance),
+                            &ir_builder_),
+            result_from_other_lane);
+        TF_RETURN_IF_ERROR(EmitCallToNestedComputation(
+            *reducers[i],
+            {partial_reduction_result_addresses[i], result_from_other_lane},
+            partial_reduction_result_addresses[i]));
+      }
     }
 
-    const HloInstruction* output =
-        reduce->IsFused() ? reduce->fusion_instruction() : reduce;
-
-    // Emit an atomic operation that accumulates the partial reduction result of
-    // lane 0 (which holds the partially accumulated result for its warp) to the
-    // output element.
+    // Emit atomic operations that accumulate the partial reduction results of
+    // lane 0 (which holds the partially accumulated results for its warp) to
+    // the output elements.
     llvm_ir::LlvmIfData if_lane_id_is_zero_data = llvm_ir::EmitIfThenElse(
         ir_builder_.CreateICmpEQ(lane_id, ir_builder_.getInt64(0)),
         "lane_id_is_zero", &ir_builder_);
     llvm_ir::SetToFirstInsertPoint(if_lane_id_is_zero_data.true_block,
                                    &ir_builder_);
-    llvm::Value* output_address = GetIrArray(*output).EmitArrayElementAddress(
-        llvm_ir::IrArray::Index(y, output->shape(), &ir_builder_), &ir_builder_,
-        "output_element_address");
-    return EmitAtomicOperationForNestedComputation(
-        *reducer, output_address, partial_reduction_result_address);
+    for (int64 i = 0; i < reducers.size(); ++i) {
+      const llvm_ir::IrArray output_array = GetReductionOutputArray(*reduce, i);
+      llvm::Value* output_address = output_array.EmitArrayElementAddress(
+          llvm_ir::IrArray::Index(y, output_array.GetShape(), &ir_builder_),
+          &ir_builder_, "output_element_address");
+      TF_RETURN_IF_ERROR(EmitAtomicOperationForNestedComputation(
+          *reducers[i], output_address, partial_reduction_result_addresses[i]));
+    }
+    return Status::OK();
   };
 
   // Emit a parallel loop that iterates through every input tiles.
@@ -1178,10 +1229,10 @@ Status IrEmitterUnnested::EmitRowReduction(
 //               elementwise.
 Status IrEmitterUnnested::EmitReductionToVector(
     HloInstruction* reduce, const Shape& input_shape,
-    const llvm_ir::ElementGenerator& input_gen,
-    const llvm_ir::ElementGenerator& init_value_gen,
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> input_gens,
+    tensorflow::gtl::ArraySlice<llvm_ir::ElementGenerator> init_value_gens,
     tensorflow::gtl::ArraySlice<int64> dimensions_to_reduce,
-    HloComputation* reducer) {
+    tensorflow::gtl::ArraySlice<HloComputation*> reducers) {
   // This emission requires "reduce" to have an input layout. It is either set
   // by LayoutAssignment (for a top-level kReduce) or by InstructionFusion (for
   // a fused kReduce).
@@ -1237,8 +1288,8 @@ Status IrEmitterUnnested::EmitReductionToVector(
         height *= input_shape.dimensions(input_dim);
       }
     }
-    return EmitColumnReduction(height, width, reduce, input_shape, input_gen,
-                               init_value_gen, reducer);
+    return EmitColumnReduction(height, width, reduce, input_shape, input_gens,
+                               init_value_gens, reducers);
   } else {
     // Reduce the row dimension of a matrix or reduce dimension 0 and 2 in a
     // 3D tensor. The size of dimension 1 (the height) is the size of the
@@ -1264,10 +1315,21 @@ Status IrEmitterUnnested::EmitReductionToVector(
     }
     const int64 height = ShapeUtil::ElementsIn(reduce->shape());
     return EmitRowReduction(depth, height, width, reduce, input_shape,
-                            input_gen, init_value_gen, reducer);
+                            input_gens, init_value_gens, reducers);
   }
 }
 
+llvm_ir::IrArray IrEmitterUnnested::GetReductionOutputArray(
+    const HloInstruction& reduce, int64 i) {
+  const HloInstruction* output =
+      reduce.IsFused() ? reduce.fusion_instruction() : &reduce;
+  if (output->IsMultiOutputFusion()) {
+    return GetIrArray(*output, {i});
+  }
+  CHECK_EQ(0, i);
+  return GetIrArray(*output);
+}
+
 Status IrEmitterUnnested::HandleReduce(
     HloInstruction* reduce, HloInstruction* input, HloInstruction* init_value,
     tensorflow::gtl::ArraySlice<int64> dimensions_to_reduce,
@@ -1286,16 +1348,18 @@ Status IrEmitterUnnested::HandleReduce(
     thunks.emplace_back(BuildKernelThunk(reduce));
     thunk_sequence_->emplace_back(
         MakeUnique<SequentialThunk>(std::move(thunks), reduce));
-    return EmitReductionToVector(
-        reduce, input->shape(),
+    llvm_ir::ElementGenerator input_gen =
         [this, input](const llvm_ir::IrArray::Index& index) {
           return GetIrArray(*input).EmitReadArrayElement(index, &ir_builder_);
-        },
+        };
+    llvm_ir::ElementGenerator init_value_gen =
         [this, init_value](const llvm_ir::IrArray::Index& index) {
           return GetIrArray(*init_value)
               .EmitReadArrayElement(index, &ir_builder_);
-        },
-        dimensions_to_reduce, reducer);
+        };
+    return EmitReductionToVector(reduce, input->shape(), {input_gen},
+                                 {init_value_gen}, dimensions_to_reduce,
+                                 {reducer});
   }
 
   thunk_sequence_->emplace_back(BuildKernelThunk(reduce));
@@ -1716,6 +1780,10 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildConvolutionThunk(
     const HloInstruction* inst) {
   const HloInstruction* lhs = inst->operand(0);
   const HloInstruction* rhs = inst->operand(1);
+  // The algorithm is picked by ConvolutionAlgorithmPicker, if it ran.
+  const perftools::gputools::dnn::AlgorithmConfig algorithm_config =
+      BackendConfigToConvolutionAlgorithm(inst->backend_config())
+          .ValueOrDie();
   if (inst->opcode() == HloOpcode::kConvolution) {
     // Forward covolution.
     return MakeUnique<ConvolutionThunk>(
@@ -1726,7 +1794,7 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildConvolutionThunk(
         /*input_shape=*/lhs->shape(),
         /*filter_shape=*/rhs->shape(),
         /*output_shape=*/inst->shape(), inst->window(),
-        inst->convolution_dimension_numbers(), inst);
+        inst->convolution_dimension_numbers(), algorithm_config, inst);
   }
 
   // Backward filter convolution, which takes the input (activations) and the
@@ -1742,7 +1810,7 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildConvolutionThunk(
           /*input_shape=*/lhs->shape(),
           /*filter_shape=*/inst->shape(),
           /*output_shape=*/rhs->shape(), inst->window(),
-          inst->convolution_dimension_numbers(), inst);
+          inst->convolution_dimension_numbers(), algorithm_config, inst);
     case HloInstruction::FusionKind::kConvBackwardInput:
       return MakeUnique<ConvolutionThunk>(
           ConvolutionThunk::ConvolutionKind::kBackwardInput,
@@ -1752,7 +1820,7 @@ std::unique_ptr<Thunk> IrEmitterUnnested::BuildConvolutionThunk(
           /*input_shape=*/inst->shape(),
           /*filter_shape=*/rhs->shape(),
           /*output_shape=*/lhs->shape(), inst->window(),
-          inst->convolution_dimension_numbers(), inst);
+          inst->convolution_dimension_numbers(), algorithm_config, inst);
     default:
       LOG(FATAL) << "Not a convolution-fusion";
   }
@@ -1762,6 +1830,39 @@ Status IrEmitterUnnested::EmitInitializer(const HloInstruction* hlo,
                                           KernelThunk* thunk) {
   bool fused = HloOpcode::kFusion == hlo->opcode();
 
+  if (fused && hlo->IsMultiOutputFusion()) {
+    // Each output of a multi-output fusion of reductions is initialized to
+    // the initial value of its reduction.
+    std::vector<const HloInstruction*> init_values;
+    for (const HloInstruction* reduce :
+         hlo->fused_expression_root()->operands()) {
+      CHECK_EQ(HloOpcode::kReduce, reduce->opcode());
+      const HloInstruction* init_value = reduce->operand(1);
+      if (init_value->opcode() == HloOpcode::kParameter) {
+        init_value = hlo->operand(init_value->parameter_number());
+      }
+      init_values.push_back(init_value);
+    }
+    return EmitTargetElementLoopInThunk(
+        *hlo,
+        [=](const llvm_ir::IrArray::Index& index) -> StatusOr<llvm::Value*> {
+          std::vector<llvm::Value*> values;
+          std::vector<llvm::Type*> types;
+          for (const HloInstruction* init_value : init_values) {
+            values.push_back(GetIrArray(*init_value)
+                                 .EmitReadArrayElement(index, &ir_builder_));
+            types.push_back(values.back()->getType());
+          }
+          llvm::Value* aggregate = llvm::UndefValue::get(
+              llvm::StructType::get(ir_builder_.getContext(), types));
+          for (int64 i = 0; i < values.size(); ++i) {
+            aggregate = ir_builder_.CreateInsertValue(aggregate, values[i], i);
+          }
+          return aggregate;
+        },
+        thunk);
+  }
+
   const HloInstruction* inst = fused ? hlo->fused_expression_root() : hlo;
   CHECK(inst->opcode() == HloOpcode::kSelectAndScatter ||
         inst->opcode() == HloOpcode::kReduce);
@@ -0,0 +1,197 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns the reduction to vector computed by 'instruction' if it is emitted
+// by IrEmitterUnnested as a reduction kernel, i.e. if it is an unfused
+// reduction to vector, or an input fusion whose root is a reduction. Returns
+// nullptr otherwise.
+const HloInstruction* GetReductionToVector(const HloInstruction& instruction) {
+  if (instruction.tracing() || !instruction.control_predecessors().empty() ||
+      !instruction.control_successors().empty()) {
+    return nullptr;
+  }
+  const HloInstruction* reduce = nullptr;
+  if (IsReductionToVector(instruction)) {
+    reduce = &instruction;
+  } else if (instruction.opcode() == HloOpcode::kFusion &&
+             instruction.fusion_kind() == HloInstruction::FusionKind::kInput &&
+             instruction.fused_expression_root()->opcode() ==
+                 HloOpcode::kReduce) {
+    reduce = instruction.fused_expression_root();
+  } else {
+    return nullptr;
+  }
+  // Reductions are accumulated to their output with atomic operations, which
+  // are not available for element types narrower than 32 bits.
+  if (primitive_util::BitWidth(reduce->shape().element_type()) < 32) {
+    return nullptr;
+  }
+  return reduce;
+}
+
+// Returns true if the reductions computed by 'a' and 'b' are emitted with the
+// same loop over their input, so that they can share one kernel.
+bool AreCompatibleReductions(const HloInstruction& a, const HloInstruction& b) {
+  const HloInstruction* reduce_a = GetReductionToVector(a);
+  const HloInstruction* reduce_b = GetReductionToVector(b);
+  CHECK(reduce_a != nullptr && reduce_b != nullptr);
+  return ShapeUtil::Compatible(reduce_a->shape(), reduce_b->shape()) &&
+         ShapeUtil::Compatible(reduce_a->operand(0)->shape(),
+                               reduce_b->operand(0)->shape()) &&
+         reduce_a->dimensions() == reduce_b->dimensions();
+}
+
+// Returns true if there is a path of uses from 'from' to 'to'.
+bool IsReachable(const HloInstruction* from, const HloInstruction* to) {
+  std::vector<const HloInstruction*> worklist = {from};
+  std::unordered_set<const HloInstruction*> visited;
+  while (!worklist.empty()) {
+    const HloInstruction* instruction = worklist.back();
+    worklist.pop_back();
+    if (instruction == to) {
+      return true;
+    }
+    if (!visited.insert(instruction).second) {
+      continue;
+    }
+    for (const HloInstruction* user : instruction->users()) {
+      worklist.push_back(user);
+    }
+  }
+  return false;
+}
+
+// Returns a group of two or more sibling reductions of 'computation' which can
+// be fused into a single multi-output fusion, or an empty group if there is
+// none.
+std::vector<HloInstruction*> FindSiblingReductions(
+    HloComputation* computation) {
+  for (HloInstruction* input : computation->MakeInstructionPostOrder()) {
+    std::vector<HloInstruction*> candidates;
+    for (HloInstruction* user : input->users()) {
+      if (GetReductionToVector(*user) != nullptr) {
+        candidates.push_back(user);
+      }
+    }
+    for (int64 i = 0; i < candidates.size(); ++i) {
+      std::vector<HloInstruction*> group = {candidates[i]};
+      for (int64 j = i + 1; j < candidates.size(); ++j) {
+        HloInstruction* candidate = candidates[j];
+        if (!AreCompatibleReductions(*group.front(), *candidate)) {
+          continue;
+        }
+        // Fusing 'candidate' with a reduction it depends on, or which depends
+        // on it, would create a cycle.
+        if (std::any_of(group.begin(), group.end(),
+                        [candidate](const HloInstruction* member) {
+                          return IsReachable(member, candidate) ||
+                                 IsReachable(candidate, member);
+                        })) {
+          continue;
+        }
+        group.push_back(candidate);
+      }
+      if (group.size() > 1) {
+        return group;
+      }
+    }
+  }
+  return {};
+}
+
+// Replaces the sibling reductions in 'group' with a single multi-output
+// input fusion.
+void FuseSiblingReductions(HloComputation* computation,
+                           const std::vector<HloInstruction*>& group) {
+  std::vector<HloInstruction*> tuple_operands(group.begin(), group.end());
+  HloInstruction* tuple =
+      computation->AddInstruction(HloInstruction::CreateTuple(tuple_operands));
+
+  // Redirect the users of each reduction to the corresponding element of the
+  // tuple, which becomes the root of the fusion.
+  for (int64 i = 0; i < group.size(); ++i) {
+    HloInstruction* reduction = group[i];
+    HloInstruction* gte = computation->AddInstruction(
+        HloInstruction::CreateGetTupleElement(reduction->shape(), tuple, i));
+    std::vector<HloInstruction*> users(reduction->users().begin(),
+                                       reduction->users().end());
+    for (HloInstruction* user : users) {
+      if (user != tuple) {
+        TF_CHECK_OK(reduction->ReplaceUseWith(user, gte));
+      }
+    }
+    if (computation->root_instruction() == reduction) {
+      computation->set_root_instruction(gte);
+    }
+  }
+
+  HloInstruction* fusion = computation->CreateFusionInstruction(
+      {tuple}, HloInstruction::FusionKind::kInput);
+  for (HloInstruction* reduction : group) {
+    if (reduction->opcode() == HloOpcode::kFusion) {
+      fusion->MergeFusionInstruction(reduction);
+    } else {
+      fusion->FuseInstruction(reduction);
+    }
+    CHECK_EQ(0, reduction->user_count());
+    TF_CHECK_OK(computation->RemoveInstruction(reduction));
+  }
+  VLOG(2) << "Fused " << group.size()
+          << " sibling reductions into: " << fusion->ToString();
+}
+
+}  // namespace
+
+StatusOr<bool> GpuMultiOutputFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (auto& computation : module->computations()) {
+    if (computation->IsFusionComputation()) {
+      continue;
+    }
+    while (true) {
+      std::vector<HloInstruction*> group =
+          FindSiblingReductions(computation.get());
+      if (group.empty()) {
+        break;
+      }
+      FuseSiblingReductions(computation.get(), group);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,54 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that fuses sibling reductions to vector, i.e. reductions which
+// read the same input, into a single multi-output input fusion. The root of
+// the fused computation is a tuple of the reductions, and the users of each
+// reduction read its result through a GetTupleElement of the fusion. The GPU
+// backend emits such a fusion as one kernel which reads the input once and
+// updates the partial results of all reductions, e.g. the sum and the sum of
+// squares computed for the mean and variance of a normalization layer.
+//
+// Two reductions are fused if:
+//
+// 1) each is either an unfused reduction to vector or an input fusion whose
+//    root is one,
+// 2) they share an operand,
+// 3) they have the same input dimensions, dimensions to reduce, output shape
+//    and element type, and
+// 4) neither depends on the other.
+//
+class GpuMultiOutputFusion : public HloPassInterface {
+ public:
+  tensorflow::StringPiece name() const override {
+    return "multi-output fusion";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
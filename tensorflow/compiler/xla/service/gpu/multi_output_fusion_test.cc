@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include <algorithm>
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class MultiOutputFusionTest : public HloTestBase {
+ protected:
+  MultiOutputFusionTest() : module_(CreateNewModule()) {}
+
+  // Builds a scalar F32 addition computation used as reducer.
+  HloComputation* BuildAddComputation() {
+    auto builder = HloComputation::Builder(TestName() + ".add");
+    auto lhs = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, scalar_shape_, "lhs"));
+    auto rhs = builder.AddInstruction(
+        HloInstruction::CreateParameter(1, scalar_shape_, "rhs"));
+    builder.AddInstruction(
+        HloInstruction::CreateBinary(scalar_shape_, HloOpcode::kAdd, lhs, rhs));
+    return module_->AddEmbeddedComputation(builder.Build());
+  }
+
+  // Builds the following computation, which computes the sum and the sum of
+  // squares of the rows of 'param' (reduced along 'square_sum_dimension'):
+  //
+  //          Param
+  //         /     \
+  //        |      Mul
+  //        |       |
+  //     Reduce   Reduce
+  //         \     /
+  //          Tuple
+  //
+  HloComputation* BuildComputation(int64 square_sum_dimension) {
+    HloComputation* add = BuildAddComputation();
+    auto builder = HloComputation::Builder(TestName());
+    auto param = builder.AddInstruction(
+        HloInstruction::CreateParameter(0, data_shape_, "param"));
+    auto zero = builder.AddInstruction(
+        HloInstruction::CreateConstant(Literal::CreateR0<float>(0.0f)));
+    auto square = builder.AddInstruction(HloInstruction::CreateBinary(
+        data_shape_, HloOpcode::kMultiply, param, param));
+    auto sum = builder.AddInstruction(HloInstruction::CreateReduce(
+        ShapeUtil::MakeShape(F32, {32}), param, zero, {1}, add));
+    auto square_sum = builder.AddInstruction(HloInstruction::CreateReduce(
+        ShapeUtil::MakeShape(F32, {square_sum_dimension == 1 ? 32 : 64}),
+        square, zero, {square_sum_dimension}, add));
+    builder.AddInstruction(HloInstruction::CreateTuple({sum, square_sum}));
+    return module_->AddEntryComputation(builder.Build());
+  }
+
+  // Runs GPU instruction fusion followed by multi-output fusion.
+  bool RunFusion() {
+    EXPECT_TRUE(
+        GpuInstructionFusion(/*may_duplicate=*/true).Run(module_.get()).ok());
+    auto changed = GpuMultiOutputFusion().Run(module_.get());
+    EXPECT_TRUE(changed.ok());
+    return changed.ValueOrDie();
+  }
+
+  Shape scalar_shape_ = ShapeUtil::MakeShape(F32, {});
+  Shape data_shape_ = ShapeUtil::MakeShape(F32, {32, 64});
+  std::unique_ptr<HloModule> module_;
+};
+
+TEST_F(MultiOutputFusionTest, SiblingReductionsAreFused) {
+  HloComputation* computation = BuildComputation(/*square_sum_dimension=*/1);
+  EXPECT_TRUE(RunFusion());
+
+  HloInstruction* root = computation->root_instruction();
+  ASSERT_EQ(HloOpcode::kTuple, root->opcode());
+  const HloInstruction* sum = root->operand(0);
+  const HloInstruction* square_sum = root->operand(1);
+  ASSERT_EQ(HloOpcode::kGetTupleElement, sum->opcode());
+  ASSERT_EQ(HloOpcode::kGetTupleElement, square_sum->opcode());
+  EXPECT_EQ(0, sum->tuple_index());
+  EXPECT_EQ(1, square_sum->tuple_index());
+
+  const HloInstruction* fusion = sum->operand(0);
+  EXPECT_EQ(fusion, square_sum->operand(0));
+  ASSERT_EQ(HloOpcode::kFusion, fusion->opcode());
+  EXPECT_EQ(HloInstruction::FusionKind::kInput, fusion->fusion_kind());
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  const HloInstruction* fused_root = fusion->fused_expression_root();
+  EXPECT_EQ(HloOpcode::kReduce, fused_root->operand(0)->opcode());
+  EXPECT_EQ(HloOpcode::kReduce, fused_root->operand(1)->opcode());
+  // Both reductions read the parameter through the same fusion operand.
+  EXPECT_EQ(1, std::count(fusion->operands().begin(),
+                          fusion->operands().end(),
+                          computation->parameter_instruction(0)));
+}
+
+TEST_F(MultiOutputFusionTest, ReductionsOverDifferentDimensionsAreNotFused) {
+  HloComputation* computation = BuildComputation(/*square_sum_dimension=*/0);
+  EXPECT_FALSE(RunFusion());
+  HloInstruction* root = computation->root_instruction();
+  EXPECT_NE(HloOpcode::kGetTupleElement, root->operand(0)->opcode());
+  EXPECT_NE(HloOpcode::kGetTupleElement, root->operand(1)->opcode());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
+
+int main(int argc, char** argv) {
+  return xla::ParseDebugOptionsFlagsAndRunTests(argc, argv);
+}
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/buffer_liveness.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
+#include "tensorflow/compiler/xla/service/gpu/convolution_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_folding.h"
 #include "tensorflow/compiler/xla/service/gpu/copy_insertion.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
 #include "tensorflow/compiler/xla/service/gpu/layout_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/llvm_gpu_backend/nvptx_backend_lib.h"
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/pad_insertion.h"
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
@@ -149,7 +151,13 @@ tensorflow::Status OptimizeHloModule(HloModule* hlo_module,
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
     fusion.AddPass<FusionMerger>();
-    return fusion.Run(hlo_module).status();
+    TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
+  }
+  {
+    HloPassPipeline pipeline("multi-output fusion");
+    pipeline.AddInvariantChecker<HloVerifier>();
+    pipeline.AddPass<GpuMultiOutputFusion>();
+    return pipeline.Run(hlo_module).status();
   }
 }
 
@@ -234,6 +242,14 @@ StatusOr<std::unique_ptr<Executable>> NVPTXCompiler::Compile(
   TF_RETURN_IF_ERROR(
       OptimizeHloModule(module.get(), stream_exec->GetDeviceDescription()));
   TF_RETURN_IF_ERROR(PrepareHloModuleForIrEmitting(module.get()));
+  // Convolution algorithms are picked last, once the layouts and shapes that
+  // reach the DNN library are final.
+  TF_RETURN_IF_ERROR(
+      ConvolutionAlgorithmPicker(
+          stream_exec,
+          module->config().debug_options().xla_gpu_autotune_cache_dir())
+          .Run(module.get())
+          .status());
 
   llvm::LLVMContext llvm_context;
   std::string buffer;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/compiler/xla/legacy_flags/debug_options_flags.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
@@ -39,7 +40,10 @@ namespace xla {
 // folding back the cpu and gpu infeed implementations into a generic
 // one if possible.
 GpuTransferManager::GpuTransferManager(se::Platform::Id id)
-    : GenericTransferManager(id) {}
+    : GenericTransferManager(id) {
+  gpu::GetOrCreateInfeedManager()->set_max_depth(
+      legacy_flags::GetDebugOptionsFromFlags().xla_infeed_queue_depth());
+}
 
 Status GpuTransferManager::TransferLiteralToInfeed(se::StreamExecutor* executor,
                                                    const Literal& literal) {
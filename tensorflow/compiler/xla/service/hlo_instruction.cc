@@ -967,6 +967,7 @@ std::unique_ptr<HloInstruction> HloInstruction::Clone(const string& suffix) {
   }
   clone->set_parent(parent());
   clone->set_metadata(metadata_);
+  clone->set_backend_config(backend_config_);
   return clone;
 }
 
@@ -1601,6 +1602,9 @@ string HloInstruction::ToString(bool compact_operands,
   if (opcode() == HloOpcode::kGetTupleElement) {
     StrAppend(&extra, ", index=", tuple_index());
   }
+  if (!backend_config_.empty()) {
+    StrAppend(&extra, ", backend_config=\"", backend_config_, "\"");
+  }
   if (include_metadata &&
       (!metadata_.op_type().empty() || !metadata_.op_name().empty() ||
        !metadata_.source_file().empty())) {
@@ -1637,6 +1641,7 @@ HloInstructionProto HloInstruction::ToProto() const {
     *proto.add_called_computation_names() = computation->name();
   }
   *proto.mutable_metadata() = metadata_;
+  proto.set_backend_config(backend_config_);
   switch (opcode_) {
     case HloOpcode::kConstant:
       *proto.mutable_literal() = literal_->ToProto();
@@ -562,6 +562,12 @@ class HloInstruction {
   string infeed_config() const { return infeed_config_; }
   void set_infeed_config(const string& config) { infeed_config_ = config; }
 
+  // Returns the backend configuration string, an opaque, backend-specific
+  // string set by the backend's HLO passes (e.g. the convolution algorithm
+  // picked by autotuning on GPU) and read by its IR emitter. Empty unless set.
+  const string& backend_config() const { return backend_config_; }
+  void set_backend_config(const string& config) { backend_config_ = config; }
+
   // Returns a tag to be used in tracing.
   //
   // Precondition: opcode() == HloOpcode::kTrace
@@ -627,6 +633,16 @@ class HloInstruction {
     return fusion_kind_;
   }
 
+  // Changes the kind of this fusion instruction. Backends use this when the
+  // fused computation no longer fits the kind it was created with, e.g. once a
+  // dot has been fused into a loop fusion.
+  //
+  // Precondition: opcode() == HloOpcode::kFusion
+  void set_fusion_kind(FusionKind fusion_kind) {
+    CHECK_EQ(HloOpcode::kFusion, opcode_);
+    fusion_kind_ = fusion_kind;
+  }
+
   // Merges the fused instructions from 'instruction_to_merge' into the
   // fused instruction set of 'this', updating operands as necessary.
   //
@@ -1021,6 +1037,9 @@ class HloInstruction {
   // Metadata for debugging.
   OpMetadata metadata_;
 
+  // Backend-specific configuration; see backend_config().
+  string backend_config_;
+
   // The number of partitions per outer dimension (listed in order from
   // outer-most dimension first).
   std::vector<int64> outer_dimension_partitions_;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 
+#include <algorithm>
 #include <atomic>
 #include <vector>
 
@@ -38,6 +39,11 @@ void HloModuleConfig::SetDefaultComputationLayout(
   entry_computation_layout_ = ComputationLayout(program_shape);
 }
 
+bool HloModuleConfig::IsDonatedParameter(int64 parameter_number) const {
+  return std::binary_search(donated_parameters_.begin(),
+                            donated_parameters_.end(), parameter_number);
+}
+
 string HloModuleConfig::compilation_cache_key() const {
   string key = tensorflow::strings::StrCat("profiling=", hlo_profiling_enabled_,
                                            "::hybrid=", has_hybrid_result_);
@@ -57,6 +63,10 @@ string HloModuleConfig::compilation_cache_key() const {
   if (replica_count() != 1) {
     StrAppend(&key, "::replica_count=", replica_count());
   }
+  if (!donated_parameters_.empty()) {
+    StrAppend(&key, "::donated=",
+              tensorflow::str_util::Join(donated_parameters_, ","));
+  }
   StrAppend(&key, debug_options_.DebugString());
   if (intra_op_parallelism_threads() > 0) {
     StrAppend(&key, "::intra_op_parallelism_threads=",
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_MODULE_CONFIG_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/computation_layout.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -72,6 +74,18 @@ class HloModuleConfig {
     has_hybrid_result_ = has_hybrid_result;
   }
 
+  // Sets/returns the numbers of the entry parameters whose buffers the caller
+  // donates to the computation. Buffer assignment may write an output in
+  // place of a donated parameter, so its contents are undefined after
+  // execution.
+  const std::vector<int64>& donated_parameters() const {
+    return donated_parameters_;
+  }
+  void set_donated_parameters(std::vector<int64> donated_parameters) {
+    donated_parameters_ = std::move(donated_parameters);
+  }
+  bool IsDonatedParameter(int64 parameter_number) const;
+
   // Sets/returns the module seed set during execution.
   void set_seed(uint64 seed) { seed_ = seed; }
   uint64 seed() const { return seed_; }
@@ -119,6 +133,9 @@ class HloModuleConfig {
   // memory.
   bool has_hybrid_result_ = false;
 
+  // Sorted numbers of the entry parameters donated by the caller.
+  std::vector<int64> donated_parameters_;
+
   // Module/graph-level seed handle.
   uint64 seed_ = 0;
 
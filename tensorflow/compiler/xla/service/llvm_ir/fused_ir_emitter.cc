@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 
 #include <functional>
+#include <utility>
 
 #include "external/llvm/include/llvm/IR/BasicBlock.h"
 #include "external/llvm/include/llvm/IR/Value.h"
@@ -165,4 +166,11 @@ FusedIrEmitter::Generator FusedIrEmitter::GetGenerator(
   return generators_.at(instruction);
 }
 
+void FusedIrEmitter::SetGenerator(const HloInstruction* instruction,
+                                  Generator generator) {
+  CHECK_GT(generators_.count(instruction), 0)
+      << "SetGenerator should be called after Accept.";
+  generators_[instruction] = std::move(generator);
+}
+
 }  // namespace xla
@@ -67,6 +67,13 @@ class FusedIrEmitter : public DfsHloVisitorWithDefault {
   // Returns the generator function for the given instruction.
   Generator GetGenerator(const HloInstruction* instruction) const;
 
+  // Replaces the generator function for the given instruction, which must have
+  // been visited already. Generators of its users look up their operands'
+  // generators on every call, so they pick up the replacement. This lets a
+  // caller emit an instruction itself and feed the result to the rest of the
+  // fused computation.
+  void SetGenerator(const HloInstruction* instruction, Generator generator);
+
   // Returns the ir value for instruction 'hlo'.
   llvm::Value* GetIrValueForGTE(const HloInstruction* hlo) const {
     auto it = gte_values_.find(hlo);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/local_service.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -111,7 +112,8 @@ StatusOr<GlobalDataHandle> LocalService::AllocateBufferOnDevice(
 StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
     const ComputationHandle& computation,
     const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-    const Shape* result_layout, int device_ordinal, bool has_hybrid_result) {
+    const Shape* result_layout, int device_ordinal, bool has_hybrid_result,
+    tensorflow::gtl::ArraySlice<int64> donated_parameters) {
   TF_ASSIGN_OR_RETURN(UserComputation * user_computation,
                       computation_tracker_.Resolve(computation));
   VersionedComputationHandle versioned_handle =
@@ -141,10 +143,21 @@ StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
     TF_RETURN_IF_ERROR(
         ValidateResultShapeWithLayout(*result_layout, program_shape->result()));
   }
+  std::vector<int64> sorted_donated_parameters(donated_parameters.begin(),
+                                               donated_parameters.end());
+  std::sort(sorted_donated_parameters.begin(), sorted_donated_parameters.end());
+  for (int64 parameter_number : sorted_donated_parameters) {
+    if (parameter_number < 0 ||
+        parameter_number >= program_shape->parameters_size()) {
+      return InvalidArgument("invalid donated parameter %lld",
+                             parameter_number);
+    }
+  }
 
   // Construct computation layout from the argument layouts.
   auto module_config = MakeUnique<HloModuleConfig>(*program_shape);
   module_config->set_has_hybrid_result(has_hybrid_result);
+  module_config->set_donated_parameters(std::move(sorted_donated_parameters));
   module_config->set_replica_count(options_.number_of_replicas());
   module_config->set_debug_options(legacy_flags::GetDebugOptionsFromFlags());
   if (execute_backend_->eigen_intra_op_thread_pool() != nullptr) {
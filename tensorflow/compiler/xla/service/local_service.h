@@ -49,11 +49,13 @@ class LocalService : public Service {
 
   // Builds an Executable with the given argument layouts and options. If
   // result_layout is non-null, then the executable is compiled to produce a
-  // result of the given layout.
+  // result of the given layout. The buffers of the arguments numbered in
+  // donated_parameters may be overwritten with outputs of the computation.
   StatusOr<std::unique_ptr<Executable>> CompileExecutable(
       const ComputationHandle& computation,
       const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-      const Shape* result_layout, int device_ordinal, bool has_hybrid_result);
+      const Shape* result_layout, int device_ordinal, bool has_hybrid_result,
+      tensorflow::gtl::ArraySlice<int64> donated_parameters = {});
 
  private:
   explicit LocalService(const ServiceOptions& options,
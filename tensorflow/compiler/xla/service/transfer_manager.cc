@@ -113,6 +113,38 @@ Status TransferManager::TransferBufferToDevice(
   return Status::OK();
 }
 
+Status TransferManager::TransferBufferFromDeviceAsync(
+    se::Stream* stream, const se::DeviceMemoryBase& source, int64 size,
+    void* destination) {
+  if (source.size() < size) {
+    return FailedPrecondition(
+        "Source allocation on device not large enough for data tranfer: "
+        "%lld < %lld",
+        source.size(), size);
+  }
+  stream->ThenMemcpy(destination, source, size);
+  if (!stream->ok()) {
+    return InternalError("failed to enqueue transfer from device to buffer");
+  }
+  return Status::OK();
+}
+
+Status TransferManager::TransferBufferToDeviceAsync(
+    se::Stream* stream, int64 size, const void* source,
+    se::DeviceMemoryBase* destination) {
+  if (destination->size() < size) {
+    return FailedPrecondition(
+        "Destination allocation on device not large enough for data tranfer: "
+        "%lld < %lld",
+        destination->size(), size);
+  }
+  stream->ThenMemcpy(destination, source, size);
+  if (!stream->ok()) {
+    return InternalError("failed to enqueue transfer of buffer to device");
+  }
+  return Status::OK();
+}
+
 StatusOr<std::set<se::DeviceMemoryBase>>
 TransferManager::GatherBufferPointersFromTuple(
     se::StreamExecutor* executor, const se::DeviceMemoryBase& source,
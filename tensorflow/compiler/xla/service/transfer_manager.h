@@ -128,6 +128,19 @@ class TransferManager {
       perftools::gputools::StreamExecutor* executor, int64 size,
       const void* source, perftools::gputools::DeviceMemoryBase* destination);
 
+  // Asynchronous versions of TransferBufferFromDevice and
+  // TransferBufferToDevice. The copy is enqueued on 'stream' and these return
+  // without waiting for it, so the host buffer must stay alive until the
+  // stream has completed the copy. Enqueueing transfers on a stream other
+  // than the one that runs the computation lets them overlap with execution.
+  virtual Status TransferBufferFromDeviceAsync(
+      perftools::gputools::Stream* stream,
+      const perftools::gputools::DeviceMemoryBase& source, int64 size,
+      void* destination);
+  virtual Status TransferBufferToDeviceAsync(
+      perftools::gputools::Stream* stream, int64 size, const void* source,
+      perftools::gputools::DeviceMemoryBase* destination);
+
   typedef std::unique_ptr<TransferManager> (*TransferManagerCreationFunction)();
 
   /////
@@ -152,6 +152,29 @@ TEST_F(CpuTransferManagerTest, TransferBufferToDevice) {
   ASSERT_EQ(42, (*storage64)[2]);
 }
 
+TEST_F(CpuTransferManagerTest, TransferBufferAsync) {
+  se::Stream stream(stream_exec_);
+  stream.Init();
+  int64 size = 3 * sizeof(uint64);
+  std::vector<uint64> storage(3, 0);
+  se::DeviceMemoryBase memptr(storage.data(), size);
+
+  std::vector<uint64> source{1, 5, 42};
+  std::vector<uint64> dest(3, 0);
+  TF_CHECK_OK(transfer_manager_.TransferBufferToDeviceAsync(
+      &stream, size, source.data(), &memptr));
+  TF_CHECK_OK(transfer_manager_.TransferBufferFromDeviceAsync(
+      &stream, memptr, size, dest.data()));
+  ASSERT_TRUE(stream.BlockHostUntilDone());
+  ASSERT_EQ(source, storage);
+  ASSERT_EQ(source, dest);
+
+  EXPECT_FALSE(transfer_manager_
+                   .TransferBufferFromDeviceAsync(&stream, memptr, 2 * size,
+                                                  dest.data())
+                   .ok());
+}
+
 // TODO(b/24679870): add similar tests for GPUs
 
 }  // namespace
@@ -0,0 +1,32 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""All-reduce collectives built from regular ops across devices and tasks.
+
+@@ring_all_reduce
+@@fused_ring_all_reduce
+@@hierarchical_all_sum
+
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.all_reduce.python.all_reduce import fused_ring_all_reduce
+from tensorflow.contrib.all_reduce.python.all_reduce import hierarchical_all_sum
+from tensorflow.contrib.all_reduce.python.all_reduce import ring_all_reduce
+
+from tensorflow.python.util.all_util import remove_undocumented
+remove_undocumented(__name__)
@@ -0,0 +1,348 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Ring all-reduce across devices, possibly on different tasks.
+
+The all-reduce is built from regular ops placed on each of the devices, so
+the transfers between neighbours of the ring are the Send/Recv pairs that
+partitioning inserts, and use whatever transport the rendezvous of the
+server provides (gRPC, verbs or MPI). This works for CPU and GPU devices
+alike, both within a host and across hosts.
+
+Each of the N devices splits its tensor into N chunks. In N - 1 steps of
+reduce-scatter every device passes one chunk to its successor in the ring,
+which reduces it with its own copy, after which each device holds one
+fully reduced chunk. In N - 1 more steps of all-gather the reduced chunks
+are passed around the ring. Every device sends and receives 2 * (N - 1) / N
+times the size of the tensor, independently of N.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.nccl.python.ops import nccl_ops
+from tensorflow.python.framework import device as pydev
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+
+
+def _flatten_and_pad(tensor, multiple):
+  """Flattens `tensor` and pads it to a multiple of `multiple` elements.
+
+  Returns the padded vector and the number of elements of `tensor`, which is
+  an int if it is known statically and a tensor otherwise.
+  """
+  flat = array_ops.reshape(tensor, [-1])
+  length = flat.shape[0].value
+  if length is not None:
+    pad_len = -length % multiple
+    if pad_len:
+      flat = array_ops.pad(flat, [[0, pad_len]])
+  else:
+    length = array_ops.size(flat)
+    pad_len = math_ops.floormod(-length, multiple)
+    flat = array_ops.pad(flat, array_ops.reshape(
+        array_ops.stack([0, pad_len]), [1, 2]))
+  return flat, length
+
+
+def _flatten_and_split(tensor, num_pieces):
+  """Flattens `tensor`, pads it to a multiple of `num_pieces` and splits it."""
+  flat, length = _flatten_and_pad(tensor, num_pieces)
+  return array_ops.split(flat, num_pieces), length
+
+
+def _unpad_and_reshape(flat, length, shape):
+  """Undoes `_flatten_and_pad`."""
+  if isinstance(length, int):
+    if flat.shape[0].value != length:
+      flat = flat[:length]
+  else:
+    flat = array_ops.slice(flat, [0], array_ops.reshape(length, [1]))
+  return array_ops.reshape(flat, shape)
+
+
+def _concat_and_reshape(pieces, length, shape):
+  """Undoes `_flatten_and_split`."""
+  return _unpad_and_reshape(array_ops.concat(pieces, 0), length, shape)
+
+
+def ring_all_reduce(input_tensors, red_op=math_ops.add, un_op=None,
+                    num_subchunks=1):
+  """Reduces `input_tensors` with a ring all-reduce.
+
+  Args:
+    input_tensors: A list of tensors of the same dtype and shape, each
+      assigned to a different device. The devices form the ring, in this
+      order, so neighbouring devices should be close to each other, e.g.
+      on the same task.
+    red_op: A binary elementwise reduction, e.g. `math_ops.add`.
+    un_op: An optional unary op applied to the result on each device, e.g.
+      to divide the sum by the number of devices.
+    num_subchunks: The number of rings running concurrently, each on a
+      different part of the tensors. More rings keep more transfers in
+      flight, at the cost of more, smaller messages.
+
+  Returns:
+    A list of the reduced tensors, one on each of the devices of
+    `input_tensors`.
+
+  Raises:
+    ValueError: If `input_tensors` is empty, a tensor has no device
+      assigned, the shapes or dtypes differ, or `num_subchunks` < 1.
+  """
+  if not input_tensors:
+    raise ValueError("input_tensors must not be empty")
+  if num_subchunks < 1:
+    raise ValueError("num_subchunks must be at least 1, got %d" %
+                     num_subchunks)
+  devices = [t.device for t in input_tensors]
+  if not all(devices):
+    raise ValueError("Each of input_tensors must be assigned to a device")
+  dtype = input_tensors[0].dtype
+  shape = input_tensors[0].shape
+  for t in input_tensors[1:]:
+    if t.dtype != dtype:
+      raise ValueError("Mismatched dtypes: %s and %s" % (dtype, t.dtype))
+    if not shape.is_compatible_with(t.shape):
+      raise ValueError("Mismatched shapes: %s and %s" % (shape, t.shape))
+
+  num_devices = len(input_tensors)
+  if num_devices == 1:
+    with ops.device(devices[0]):
+      return [un_op(input_tensors[0]) if un_op
+              else array_ops.identity(input_tensors[0])]
+
+  # chunks[d][k * num_devices + c] is the c-th chunk of the k-th ring on
+  # device d.
+  chunks = []
+  lengths = []
+  for d, t in enumerate(input_tensors):
+    with ops.device(devices[d]):
+      pieces, length = _flatten_and_split(t, num_devices * num_subchunks)
+      chunks.append(pieces)
+      lengths.append(length)
+
+  # Reduce-scatter: at step s, device d passes chunk (d - s) mod N to its
+  # successor. Chunk c ends up fully reduced on device (c - 1) mod N.
+  for s in range(num_devices - 1):
+    new_chunks = [list(c) for c in chunks]
+    for d in range(num_devices):
+      succ = (d + 1) % num_devices
+      with ops.device(devices[succ]):
+        for k in range(num_subchunks):
+          c = k * num_devices + (d - s) % num_devices
+          new_chunks[succ][c] = red_op(chunks[d][c], chunks[succ][c])
+    chunks = new_chunks
+
+  # All-gather: at step s, device d passes the reduced chunk
+  # (d + 1 - s) mod N to its successor.
+  for s in range(num_devices - 1):
+    new_chunks = [list(c) for c in chunks]
+    for d in range(num_devices):
+      succ = (d + 1) % num_devices
+      with ops.device(devices[succ]):
+        for k in range(num_subchunks):
+          c = k * num_devices + (d + 1 - s) % num_devices
+          new_chunks[succ][c] = array_ops.identity(chunks[d][c])
+    chunks = new_chunks
+
+  outputs = []
+  for d, t in enumerate(input_tensors):
+    with ops.device(devices[d]):
+      out_shape = shape if shape.is_fully_defined() else array_ops.shape(t)
+      out = _concat_and_reshape(chunks[d], lengths[d], out_shape)
+      outputs.append(un_op(out) if un_op else out)
+  return outputs
+
+
+def _build_buckets(tensors, bucket_bytes):
+  """Groups the indices of `tensors` into buckets to be reduced together.
+
+  Consecutive tensors of the same dtype are fused until the bucket holds
+  `bucket_bytes`. Tensors whose shape is not fully defined, or which hold
+  `bucket_bytes` or more, are reduced on their own, and do not end the
+  bucket being filled.
+  """
+  buckets = []
+  current = []
+  current_bytes = 0
+  current_dtype = None
+  for i, t in enumerate(tensors):
+    if not t.shape.is_fully_defined():
+      buckets.append([i])
+      continue
+    num_bytes = t.shape.num_elements() * t.dtype.size
+    if num_bytes >= bucket_bytes:
+      buckets.append([i])
+      continue
+    if current and (t.dtype != current_dtype or
+                    current_bytes + num_bytes > bucket_bytes):
+      buckets.append(current)
+      current = []
+      current_bytes = 0
+    current.append(i)
+    current_bytes += num_bytes
+    current_dtype = t.dtype
+  if current:
+    buckets.append(current)
+  return buckets
+
+
+def fused_ring_all_reduce(per_device_tensors, red_op=math_ops.add,
+                          un_op=None, num_subchunks=1,
+                          bucket_bytes=4 << 20):
+  """Reduces lists of tensors, fusing the small ones into larger buckets.
+
+  Each all-reduce takes 2 * (N - 1) steps, so reducing many small tensors,
+  such as the gradients of biases, is bound by latency rather than by
+  bandwidth. The tensors are therefore flattened and concatenated into
+  buckets of up to `bucket_bytes`, each of which is reduced with a single
+  `ring_all_reduce`, and split back into the original tensors.
+
+  Args:
+    per_device_tensors: A list, with one entry per device, of lists of
+      tensors, e.g. the gradients computed by each replica. The i-th tensors
+      of all the devices are reduced together, and must have the same dtype
+      and shape.
+    red_op: A binary elementwise reduction, e.g. `math_ops.add`.
+    un_op: An optional unary op applied to each result.
+    num_subchunks: See `ring_all_reduce`.
+    bucket_bytes: The maximum size of a bucket of fused tensors.
+
+  Returns:
+    A list, with one entry per device, of lists of the reduced tensors.
+
+  Raises:
+    ValueError: If the devices have different numbers of tensors, or on
+      the errors of `ring_all_reduce`.
+  """
+  if not per_device_tensors:
+    raise ValueError("per_device_tensors must not be empty")
+  num_tensors = len(per_device_tensors[0])
+  for tensors in per_device_tensors[1:]:
+    if len(tensors) != num_tensors:
+      raise ValueError("All devices must have the same number of tensors")
+
+  outputs = [[None] * num_tensors for _ in per_device_tensors]
+  for bucket in _build_buckets(per_device_tensors[0], bucket_bytes):
+    if len(bucket) == 1:
+      i = bucket[0]
+      reduced = ring_all_reduce([tensors[i] for tensors in per_device_tensors],
+                                red_op, un_op, num_subchunks)
+      for d, r in enumerate(reduced):
+        outputs[d][i] = r
+      continue
+
+    fused = []
+    for tensors in per_device_tensors:
+      with ops.device(tensors[bucket[0]].device):
+        fused.append(array_ops.concat(
+            [array_ops.reshape(tensors[i], [-1]) for i in bucket], 0))
+    reduced = ring_all_reduce(fused, red_op, un_op, num_subchunks)
+    sizes = [per_device_tensors[0][i].shape.num_elements() for i in bucket]
+    for d, r in enumerate(reduced):
+      with ops.device(r.device):
+        for i, piece in zip(bucket, array_ops.split(r, sizes)):
+          outputs[d][i] = array_ops.reshape(piece,
+                                            per_device_tensors[d][i].shape)
+  return outputs
+
+
+def hierarchical_all_sum(per_task_tensors, num_subchunks=1, un_op=None):
+  """Sums tensors on the GPUs of several tasks, using nccl within each task.
+
+  Each task first reduce-scatters its tensors with nccl, so that each of its
+  G GPUs holds the sum over the task of 1/G of the tensor. The G parts are
+  then summed across the tasks with `ring_all_reduce`, one ring per part
+  connecting the GPUs that hold it, and the sums are gathered back with
+  nccl on each task. The network carries 1/G of the data a flat ring over
+  all the GPUs would, and the G rings run concurrently.
+
+  Args:
+    per_task_tensors: A list, with one entry per task, of lists of the
+      tensors to sum, each assigned to a different GPU of the task. All the
+      tasks must have the same number of GPUs, and all the tensors the same
+      dtype and shape.
+    num_subchunks: See `ring_all_reduce`.
+    un_op: An optional unary op applied to each result.
+
+  Returns:
+    A list, with one entry per task, of lists of the sums, where each sum has
+    the same device as the corresponding input tensor.
+
+  Raises:
+    ValueError: If the tasks have different numbers of tensors, or the
+      tensors of a task are not on distinct GPUs.
+  """
+  if not per_task_tensors or not per_task_tensors[0]:
+    raise ValueError("per_task_tensors must not be empty")
+  num_gpus = len(per_task_tensors[0])
+  for tensors in per_task_tensors[1:]:
+    if len(tensors) != num_gpus:
+      raise ValueError("All tasks must have the same number of tensors")
+
+  # The ranks of the GPUs of each task, which determine the parts they
+  # receive from the reduce-scatter.
+  per_task_ranks = []
+  for tensors in per_task_tensors:
+    gpu_ids = [pydev.DeviceSpec.from_string(t.device).device_index
+               for t in tensors]
+    if None in gpu_ids or len(set(gpu_ids)) != num_gpus:
+      raise ValueError("The tensors of a task must be on distinct GPUs: %s" %
+                       [t.device for t in tensors])
+    order = sorted(range(num_gpus), key=lambda i: gpu_ids[i])
+    ranks = [0] * num_gpus
+    for rank, i in enumerate(order):
+      ranks[i] = rank
+    per_task_ranks.append(ranks)
+
+  shape = per_task_tensors[0][0].shape
+  # parts[task][rank] is the part held by the GPU of that rank.
+  parts = []
+  lengths = []
+  for tensors, ranks in zip(per_task_tensors, per_task_ranks):
+    flats = []
+    for t in tensors:
+      with ops.device(t.device):
+        flat, length = _flatten_and_pad(t, num_gpus)
+        flats.append(flat)
+    lengths.append(length)
+    task_parts = [None] * num_gpus
+    for i, part in enumerate(nccl_ops.reduce_scatter_sum(flats)):
+      task_parts[ranks[i]] = part
+    parts.append(task_parts)
+
+  for rank in range(num_gpus):
+    summed = ring_all_reduce([task_parts[rank] for task_parts in parts],
+                             num_subchunks=num_subchunks)
+    for task_parts, part in zip(parts, summed):
+      task_parts[rank] = part
+
+  outputs = []
+  for tensors, ranks, task_parts, length in zip(per_task_tensors,
+                                                per_task_ranks, parts,
+                                                lengths):
+    gathered = nccl_ops.all_gather([task_parts[ranks[i]]
+                                    for i in range(num_gpus)])
+    task_outputs = []
+    for t, flat in zip(tensors, gathered):
+      with ops.device(t.device):
+        out_shape = shape if shape.is_fully_defined() else array_ops.shape(t)
+        out = _unpad_and_reshape(flat, length, out_shape)
+        task_outputs.append(un_op(out) if un_op else out)
+    outputs.append(task_outputs)
+  return outputs
@@ -0,0 +1,171 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for contrib.all_reduce.python.all_reduce."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.all_reduce.python import all_reduce
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+_NUM_DEVICES = 3
+
+
+def _config():
+  return config_pb2.ConfigProto(device_count={"CPU": _NUM_DEVICES})
+
+
+def _devices():
+  return ["/cpu:%d" % d for d in range(_NUM_DEVICES)]
+
+
+class RingAllReduceTest(test.TestCase):
+
+  def _testAllReduce(self, shape, num_subchunks):
+    values = [np.random.rand(*shape).astype(np.float32)
+              for _ in range(_NUM_DEVICES)]
+    with self.test_session(config=_config()) as sess:
+      inputs = []
+      for device, value in zip(_devices(), values):
+        with ops.device(device):
+          inputs.append(constant_op.constant(value))
+      outputs = all_reduce.ring_all_reduce(inputs,
+                                           num_subchunks=num_subchunks)
+      for t, output in zip(inputs, outputs):
+        self.assertEqual(t.device, output.device)
+      results = sess.run(outputs)
+    for result in results:
+      self.assertAllClose(sum(values), result)
+
+  def testDivisibleSize(self):
+    self._testAllReduce([6], 1)
+    self._testAllReduce([2, 3, 4], 2)
+
+  def testPaddedSize(self):
+    self._testAllReduce([7], 1)
+    self._testAllReduce([5, 1], 3)
+    self._testAllReduce([1], 2)
+
+  def testUnknownShape(self):
+    values = [np.arange(5, dtype=np.float32) * (d + 1)
+              for d in range(_NUM_DEVICES)]
+    with self.test_session(config=_config()) as sess:
+      placeholders = []
+      for device in _devices():
+        with ops.device(device):
+          placeholders.append(array_ops.placeholder(dtypes.float32))
+      outputs = all_reduce.ring_all_reduce(placeholders)
+      results = sess.run(outputs, dict(zip(placeholders, values)))
+    for result in results:
+      self.assertAllClose(sum(values), result)
+
+  def testUnaryOp(self):
+    with self.test_session(config=_config()) as sess:
+      inputs = []
+      for d, device in enumerate(_devices()):
+        with ops.device(device):
+          inputs.append(constant_op.constant([float(d)] * 4))
+      outputs = all_reduce.ring_all_reduce(
+          inputs, red_op=math_ops.maximum,
+          un_op=lambda x: x * 0.5)
+      for result in sess.run(outputs):
+        self.assertAllClose([1.0] * 4, result)
+
+  def testSingleDevice(self):
+    with self.test_session() as sess:
+      with ops.device("/cpu:0"):
+        t = constant_op.constant([1.0, 2.0])
+      outputs = all_reduce.ring_all_reduce([t])
+      self.assertEqual(1, len(outputs))
+      self.assertAllClose([1.0, 2.0], sess.run(outputs[0]))
+
+  def testErrors(self):
+    with ops.Graph().as_default():
+      with self.assertRaisesRegexp(ValueError, "must not be empty"):
+        all_reduce.ring_all_reduce([])
+      with self.assertRaisesRegexp(ValueError, "assigned to a device"):
+        all_reduce.ring_all_reduce([constant_op.constant([1.0])])
+      with ops.device("/cpu:0"):
+        a = constant_op.constant([1.0, 2.0])
+      with ops.device("/cpu:1"):
+        b = constant_op.constant([1.0])
+      with self.assertRaisesRegexp(ValueError, "Mismatched shapes"):
+        all_reduce.ring_all_reduce([a, b])
+
+
+class FusedRingAllReduceTest(test.TestCase):
+
+  def testFusesSmallTensors(self):
+    shapes = [[3], [2, 2], [10], [1], [4, 5]]
+    values = [[np.random.rand(*shape).astype(np.float32) for shape in shapes]
+              for _ in range(_NUM_DEVICES)]
+    with self.test_session(config=_config()) as sess:
+      per_device = []
+      for device, device_values in zip(_devices(), values):
+        with ops.device(device):
+          per_device.append([constant_op.constant(v) for v in device_values])
+      # The buckets hold 16 floats, so [10] starts a new bucket and [4, 5]
+      # is reduced on its own.
+      outputs = all_reduce.fused_ring_all_reduce(per_device,
+                                                 bucket_bytes=16 * 4)
+      results = sess.run(outputs)
+    for d in range(_NUM_DEVICES):
+      for i, shape in enumerate(shapes):
+        self.assertEqual(shape, list(results[d][i].shape))
+        self.assertAllClose(sum(v[i] for v in values), results[d][i])
+
+  def testBuckets(self):
+    with ops.Graph().as_default():
+      tensors = [
+          array_ops.zeros([2]),
+          array_ops.zeros([2]),
+          array_ops.zeros([2], dtype=dtypes.int32),
+          array_ops.zeros([100]),
+          array_ops.placeholder(dtypes.float32),
+          array_ops.zeros([3]),
+      ]
+      # The int32 bucket is only closed by the next float32 tensor.
+      self.assertEqual([[0, 1], [3], [4], [2], [5]],
+                       all_reduce._build_buckets(tensors, 64))
+
+
+class HierarchicalAllSumTest(test.TestCase):
+
+  def testErrors(self):
+    with ops.Graph().as_default():
+      with self.assertRaisesRegexp(ValueError, "must not be empty"):
+        all_reduce.hierarchical_all_sum([])
+      tensors = []
+      for device in ["/job:worker/task:0/gpu:0", "/job:worker/task:0/gpu:0",
+                     "/job:worker/task:1/gpu:0", "/job:worker/task:1/gpu:1"]:
+        with ops.device(device):
+          tensors.append(constant_op.constant([1.0]))
+      with self.assertRaisesRegexp(ValueError, "same number of tensors"):
+        all_reduce.hierarchical_all_sum([tensors[:1], tensors[2:]])
+      with self.assertRaisesRegexp(ValueError, "on distinct GPUs"):
+        all_reduce.hierarchical_all_sum([tensors[:2], tensors[2:]])
+
+
+if __name__ == "__main__":
+  test.main()
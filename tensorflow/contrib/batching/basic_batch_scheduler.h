@@ -176,6 +176,11 @@ class BasicBatchScheduler : public BatchScheduler<TaskType> {
     // parameter.
     int max_enqueued_batches = 10;
 
+    // If positive, adapt the batch size and timeout online to keep latency
+    // below this many microseconds. See the option of the same name in
+    // SharedBatchScheduler::QueueOptions.
+    int64 target_latency_micros = 0;
+
     // The following options are typically only overridden by test code.
 
     // The environment to use.
@@ -227,6 +232,8 @@ Status BasicBatchScheduler<TaskType>::Create(
       options.batch_timeout_micros;
   shared_scheduler_queue_options.max_enqueued_batches =
       options.max_enqueued_batches;
+  shared_scheduler_queue_options.target_latency_micros =
+      options.target_latency_micros;
   std::unique_ptr<BatchScheduler<TaskType>> shared_scheduler_queue;
   TF_RETURN_IF_ERROR(shared_scheduler->AddQueue(shared_scheduler_queue_options,
                                                 process_batch_callback,
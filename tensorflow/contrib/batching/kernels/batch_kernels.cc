@@ -42,6 +42,12 @@ typedef Eigen::SyclDevice SYCLDevice;
 template <typename T>
 Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor>& inputs,
               int output_index) {
+  // A batch of a single unpadded task is passed through as is.
+  if (inputs.size() == 1) {
+    context->set_output(output_index, inputs[0]);
+    return Status::OK();
+  }
+
   const int input_dims = inputs[0].dims();
   const TensorShape& input_shape = inputs[0].shape();
 
@@ -136,7 +142,9 @@ Status SplitEasyCases(OpKernelContext* context, const Tensor& input,
   return Status::OK();
 }
 
-// Handles the general case, on CPU.
+// Handles the general case, on CPU. Splits that happen to be aligned, such as
+// the first one, still share the buffer of 'input'; only the others are
+// copied.
 template <typename T>
 Status SplitCPU(OpKernelContext* context, const Tensor& input,
                 const gtl::ArraySlice<int64>& sizes,
@@ -150,6 +158,13 @@ Status SplitCPU(OpKernelContext* context, const Tensor& input,
 
   int64 position = 0;
   for (const int64 size : sizes) {
+    Tensor slice = input.Slice(position, position + size);
+    if (slice.IsAligned()) {
+      outputs->push_back(slice);
+      position += size;
+      continue;
+    }
+
     TensorShape output_shape = input.shape();
     output_shape.set_dim(0, size);
     Tensor output;
@@ -185,6 +185,31 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testUnbatchWithPaddingAndUnalignedRows(self):
+    """Tests unbatching padded batches whose rows are not aligned."""
+    with self.test_session() as sess:
+      inp = array_ops.placeholder(dtype=dtypes.float32, shape=[1, 3])
+      batched, index, id_t = batch_ops.batch(
+          [inp], num_batch_threads=1, max_batch_size=10,
+          batch_timeout_micros=100000,  # 100ms
+          allowed_batch_sizes=[3, 10],
+          grad_timeout_micros=0, batching_queue="")
+      computation = batched[0] * 2
+      result = batch_ops.unbatch(computation, index, id_t,
+                                 timeout_micros=1000000, shared_name="unbatch")
+      thread_results = []
+
+      def worker():
+        thread_results.extend(
+            sess.run([result], feed_dict={inp: [[1, 2, 3]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[4, 5, 6]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 4, 6]])
+      self.assertAllEqual(main_results[0], [[8, 10, 12]])
+
   def testBasicUnbatchDecorated(self):
     """Tests that the batch_function decorator works."""
     with self.test_session() as sess:
@@ -17,6 +17,8 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_SHARED_BATCH_SCHEDULER_H_
 
 #include <stddef.h>
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <functional>
 #include <list>
@@ -157,6 +159,24 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     int max_enqueued_batches = 10;
+
+    // If positive, the queue adapts its batches online to keep the time from
+    // a task's arrival to the end of the processing of its batch below this
+    // many microseconds, while forming batches as large as that allows.
+    //
+    // The queue fits a model of the processing time of a batch as a function
+    // of its size to the batches it has processed, and tracks the rate at
+    // which tasks arrive. From these it picks the largest batch size that it
+    // predicts can be filled and processed within the target, and a timeout
+    // that leaves enough time to process a batch of that size. Until it has
+    // processed a few batches, it uses 'max_batch_size' and
+    // 'batch_timeout_micros'. Afterwards 'max_batch_size' stays an upper bound
+    // on the batch size, and 'batch_timeout_micros' is not used.
+    //
+    // The time tasks spend waiting for a batch thread once their batch is
+    // closed is not part of the model, so 'max_enqueued_batches' should be
+    // kept small for this to be effective.
+    int64 target_latency_micros = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -205,6 +225,53 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// Online estimates used by queues with a latency target (see
+// SharedBatchScheduler::QueueOptions::target_latency_micros). Not thread-safe.
+class BatchLatencyModel {
+ public:
+  // Records that a batch of 'batch_size' took 'micros' to process.
+  void AddBatch(int batch_size, int64 micros);
+
+  // Records that a task of size 'task_size' arrived at 'now_micros'.
+  void AddArrival(int task_size, uint64 now_micros);
+
+  // Whether enough batches have been recorded for Choose() to be used.
+  bool ready() const { return num_batches_ >= kMinBatches; }
+
+  // The predicted processing time of a batch of 'batch_size'.
+  double PredictMicros(int batch_size) const;
+
+  // Picks the largest batch size of at most 'max_batch_size' that is
+  // predicted to fill up and be processed within 'target_micros', and the
+  // timeout that leaves time to process a batch of that size. Requires
+  // ready().
+  void Choose(int64 target_micros, int max_batch_size, int* batch_size,
+              int64* batch_timeout_micros) const;
+
+ private:
+  // The weight of the old estimates when a new sample is recorded.
+  static constexpr double kDecay = 0.9;
+  static constexpr int kMinBatches = 8;
+
+  // Fits processing time = intercept + slope * batch size.
+  void Fit(double* intercept, double* slope) const;
+
+  // Exponentially weighted sums over the processed batches, of 1, x, y, x^2
+  // and x*y, where x is the batch size and y the processing time.
+  double weight_sum_ = 0;
+  double size_sum_ = 0;
+  double time_sum_ = 0;
+  double size_sq_sum_ = 0;
+  double size_time_sum_ = 0;
+  int num_batches_ = 0;
+
+  // Exponentially weighted mean of the time between arrivals, per unit of
+  // task size. Zero until two tasks have arrived.
+  double micros_per_unit_ = 0;
+  bool has_arrival_ = false;
+  uint64 last_arrival_micros_ = 0;
+};
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -281,6 +348,9 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Whether the queue adapts its batches to a latency target.
+  bool adaptive() const { return options_.target_latency_micros > 0; }
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -322,6 +392,14 @@ class Queue {
   // 'empty_notification_' is non-null it calls 'empty_notification_->Notify()'.
   Notification* empty_notification_ GUARDED_BY(mu_) = nullptr;
 
+  // The batch size at which the open batch is closed, and the timeout after
+  // which it is, in effect. These are the configured ones unless adaptive().
+  int max_batch_size_ GUARDED_BY(mu_);
+  int64 batch_timeout_micros_ GUARDED_BY(mu_);
+
+  // The model the above are picked from if adaptive().
+  BatchLatencyModel latency_model_ GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(Queue);
 };
 
@@ -402,6 +480,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -496,6 +579,77 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
 
 namespace internal {
 
+inline void BatchLatencyModel::AddBatch(int batch_size, int64 micros) {
+  const double x = batch_size;
+  const double y = micros;
+  weight_sum_ = kDecay * weight_sum_ + 1;
+  size_sum_ = kDecay * size_sum_ + x;
+  time_sum_ = kDecay * time_sum_ + y;
+  size_sq_sum_ = kDecay * size_sq_sum_ + x * x;
+  size_time_sum_ = kDecay * size_time_sum_ + x * y;
+  ++num_batches_;
+}
+
+inline void BatchLatencyModel::AddArrival(int task_size, uint64 now_micros) {
+  if (has_arrival_ && task_size > 0) {
+    const double sample =
+        static_cast<double>(now_micros - last_arrival_micros_) / task_size;
+    micros_per_unit_ = micros_per_unit_ == 0
+                           ? sample
+                           : kDecay * micros_per_unit_ + (1 - kDecay) * sample;
+  }
+  has_arrival_ = true;
+  last_arrival_micros_ = now_micros;
+}
+
+inline void BatchLatencyModel::Fit(double* intercept, double* slope) const {
+  const double mean_size = size_sum_ / weight_sum_;
+  const double mean_time = time_sum_ / weight_sum_;
+  const double variance = size_sq_sum_ / weight_sum_ - mean_size * mean_size;
+  if (variance > 1e-6 * mean_size * mean_size) {
+    *slope =
+        (size_time_sum_ / weight_sum_ - mean_size * mean_time) / variance;
+    *intercept = mean_time - *slope * mean_size;
+  } else {
+    // All batches had about the same size. Assume that the processing time
+    // is proportional to the batch size, which errs on the side of smaller
+    // batches.
+    *slope = mean_time / mean_size;
+    *intercept = 0;
+  }
+  if (*slope < 0) {
+    *slope = 0;
+    *intercept = mean_time;
+  } else if (*intercept < 0) {
+    *slope = mean_time / mean_size;
+    *intercept = 0;
+  }
+}
+
+inline double BatchLatencyModel::PredictMicros(int batch_size) const {
+  double intercept, slope;
+  Fit(&intercept, &slope);
+  return intercept + slope * batch_size;
+}
+
+inline void BatchLatencyModel::Choose(int64 target_micros, int max_batch_size,
+                                      int* batch_size,
+                                      int64* batch_timeout_micros) const {
+  DCHECK(ready());
+  double intercept, slope;
+  Fit(&intercept, &slope);
+  // A batch of size B takes about B * micros_per_unit_ to fill up and
+  // intercept + slope * B to process.
+  const double micros_per_unit = slope + micros_per_unit_;
+  double size = max_batch_size;
+  if (micros_per_unit > 0) {
+    size = std::min(size, (target_micros - intercept) / micros_per_unit);
+  }
+  *batch_size = std::max(1, static_cast<int>(size));
+  *batch_timeout_micros = std::max<int64>(
+      0, std::llround(target_micros - intercept - slope * *batch_size));
+}
+
 template <typename TaskType>
 Queue<TaskType>::Queue(
     const typename SharedBatchScheduler<TaskType>::QueueOptions& options,
@@ -504,7 +658,9 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      max_batch_size_(options.max_batch_size),
+      batch_timeout_micros_(options.batch_timeout_micros) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -532,7 +688,13 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
+    if (adaptive()) {
+      latency_model_.AddArrival((*task)->size(), env_->NowMicros());
+    }
+    // The adapted batch size may be smaller than a task, in which case the
+    // task gets a batch of its own.
+    if (!batches_.back()->empty() &&
+        batches_.back()->size() + (*task)->size() > max_batch_size_) {
       if (batches_.size() >= options_.max_enqueued_batches) {
         return errors::Unavailable(
             "The batch scheduling queue to which this task was submitted is "
@@ -610,10 +772,21 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
+  const int batch_size = batch->size();
+  const uint64 start_time_micros = adaptive() ? env_->NowMicros() : 0;
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (adaptive()) {
+      latency_model_.AddBatch(batch_size,
+                              env_->NowMicros() - start_time_micros);
+      if (latency_model_.ready()) {
+        latency_model_.Choose(options_.target_latency_micros,
+                              options_.max_batch_size, &max_batch_size_,
+                              &batch_timeout_micros_);
+      }
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -661,9 +834,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
+  return closed_ || open_batch->size() >= max_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros_;
 }
 
 template <typename TaskType>
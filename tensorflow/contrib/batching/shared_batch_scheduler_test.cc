@@ -337,6 +337,140 @@ TEST(SharedBatchSchedulerTest,
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, AdaptsToLatencyTarget) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    // Processing a batch takes 100 microseconds per task.
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    auto callback = [&env, &mu,
+                     &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      env.AdvanceByMicroseconds(100 * batch->size());
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+    };
+    auto wait_for_batches = [&mu, &batch_sizes](size_t num_batches) {
+      for (;;) {
+        {
+          mutex_lock l(mu);
+          if (batch_sizes.size() >= num_batches) break;
+        }
+        Env::Default()->SleepForMicroseconds(1000);
+      }
+      // Give the queue time to update its model.
+      Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 100;
+    queue_options.batch_timeout_micros = 0;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.target_latency_micros = 1100;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // One task arrives every 100 microseconds, and is processed on its own
+    // until the queue has seen enough batches.
+    for (int i = 0; i < 8; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      wait_for_batches(i + 1);
+    }
+
+    // Filling and processing a batch of B tasks now takes 200 * B
+    // microseconds, so batches close at 5 tasks.
+    for (int i = 0; i < 5; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    wait_for_batches(9);
+
+    // A smaller batch still closes once it would otherwise miss the target.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(300);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(9, batch_sizes.size());
+    }
+    env.AdvanceByMicroseconds(300);
+    wait_for_batches(10);
+
+    mutex_lock l(mu);
+    EXPECT_EQ(std::vector<size_t>({1, 1, 1, 1, 1, 1, 1, 1, 5, 2}),
+              batch_sizes);
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, RejectsNegativeLatencyTarget) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.target_latency_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(scheduler
+                   ->AddQueue(queue_options,
+                              [](std::unique_ptr<Batch<FakeTask>> batch) {},
+                              &queue)
+                   .ok());
+}
+
+TEST(BatchLatencyModelTest, FitsProcessingTime) {
+  internal::BatchLatencyModel model;
+  for (int size = 1; size <= 8; ++size) {
+    EXPECT_FALSE(model.ready());
+    model.AddBatch(size, 100 + 10 * size);
+  }
+  ASSERT_TRUE(model.ready());
+  EXPECT_NEAR(300, model.PredictMicros(20), 1e-6);
+
+  // Without arrivals, only the processing time limits the batch size.
+  int batch_size;
+  int64 batch_timeout_micros;
+  model.Choose(505, 1000, &batch_size, &batch_timeout_micros);
+  EXPECT_EQ(40, batch_size);
+  EXPECT_EQ(5, batch_timeout_micros);
+  model.Choose(505, 16, &batch_size, &batch_timeout_micros);
+  EXPECT_EQ(16, batch_size);
+  EXPECT_EQ(245, batch_timeout_micros);
+
+  // One unit of task size every 5 microseconds.
+  for (int i = 0; i < 10; ++i) {
+    model.AddArrival(2, 10 * i);
+  }
+  model.Choose(510, 1000, &batch_size, &batch_timeout_micros);
+  EXPECT_EQ(27, batch_size);
+  EXPECT_EQ(140, batch_timeout_micros);
+
+  // A target that can't be met still yields batches of one task.
+  model.Choose(50, 1000, &batch_size, &batch_timeout_micros);
+  EXPECT_EQ(1, batch_size);
+  EXPECT_EQ(0, batch_timeout_micros);
+}
+
+TEST(BatchLatencyModelTest, ConstantBatchSize) {
+  internal::BatchLatencyModel model;
+  for (int i = 0; i < 8; ++i) {
+    model.AddBatch(10, 200);
+  }
+  // The processing time is assumed to be proportional to the batch size.
+  EXPECT_NEAR(400, model.PredictMicros(20), 1e-6);
+}
+
 TEST(SharedBatchSchedulerTest, Fairness) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
@@ -70,11 +70,11 @@ struct PartitionKey {
 
 template <typename GradientType, typename HessianType>
 class StatsAccumulatorResource : public boosted_trees::StampedResource {
+ public:
   using StatsByPartition =
       std::map<PartitionKey, std::pair<GradientType, HessianType>,
                PartitionKey::Less>;
 
- public:
   StatsAccumulatorResource(const TensorShape& gradient_shape,
                            const TensorShape& hessian_shape)
       : gradient_shape_(gradient_shape),
@@ -212,21 +212,59 @@ void SerializeTensorAccumulatorToOutput(
   }
 }
 
-void AddToScalarAccumulator(
-    StatsAccumulatorScalarResource* accumulator_resource,
+// Splits the rows of a list of updates into fixed-size shards, so that the
+// stats of large updates can be summed by several threads into shard-local
+// maps. The shard size does not depend on the number of threads, which keeps
+// the summation order deterministic.
+class UpdateShards {
+ public:
+  // Number of rows summed by a single shard.
+  static constexpr int64 kRowsPerShard = 8192;
+
+  explicit UpdateShards(const OpInputList& partition_ids_list)
+      : first_shard_(partition_ids_list.size() + 1, 0) {
+    for (int i = 0; i < partition_ids_list.size(); ++i) {
+      const int64 num_rows = partition_ids_list[i].dim_size(0);
+      first_shard_[i + 1] =
+          first_shard_[i] + (num_rows + kRowsPerShard - 1) / kRowsPerShard;
+      num_rows_.push_back(num_rows);
+    }
+  }
+
+  int64 num_shards() const { return first_shard_.back(); }
+
+  // The shards of an update are [first_shard(update), first_shard(update+1)).
+  int64 first_shard(int update) const { return first_shard_[update]; }
+
+  // Returns the update of a shard and the [row_start, row_end) rows it sums.
+  void GetRows(int64 shard, int* update, int64* row_start,
+               int64* row_end) const {
+    *update = std::upper_bound(first_shard_.begin(), first_shard_.end(),
+                               shard) -
+              first_shard_.begin() - 1;
+    *row_start = (shard - first_shard_[*update]) * kRowsPerShard;
+    *row_end = std::min(*row_start + kRowsPerShard, num_rows_[*update]);
+  }
+
+ private:
+  std::vector<int64> first_shard_;
+  std::vector<int64> num_rows_;
+};
+
+constexpr int64 UpdateShards::kRowsPerShard;
+
+// Sums the rows [row_start, row_end) of an update into stats_map.
+void AccumulateScalarRows(
     const Tensor& partition_ids_t, const Tensor& feature_ids_t,
-    const Tensor& gradients_t, const Tensor& hessians_t) {
-  accumulator_resource->set_num_updates(accumulator_resource->num_updates() +
-                                        1);
-  const TensorShape& partition_ids_shape = partition_ids_t.shape();
+    const Tensor& gradients_t, const Tensor& hessians_t, int64 row_start,
+    int64 row_end,
+    StatsAccumulatorScalarResource::StatsByPartition* stats_map) {
   const auto& partition_ids = partition_ids_t.vec<int32>();
   const auto& feature_ids = feature_ids_t.vec<int64>();
   const auto& gradients = gradients_t.vec<float>();
   const auto& hessians = hessians_t.vec<float>();
 
-  int64 num_updates = partition_ids_shape.dim_size(0);
-  auto stats_map = accumulator_resource->mutable_values();
-  for (int64 i = 0; i < num_updates; ++i) {
+  for (int64 i = row_start; i < row_end; ++i) {
     const auto key = PartitionKey(partition_ids(i), feature_ids(i));
     auto itr = stats_map->find(key);
     if (itr != stats_map->end()) {
@@ -238,6 +276,32 @@ void AddToScalarAccumulator(
   }
 }
 
+// Adds the stats summed by a shard to stats_map.
+void MergeScalarStats(
+    const StatsAccumulatorScalarResource::StatsByPartition& shard_stats,
+    StatsAccumulatorScalarResource::StatsByPartition* stats_map) {
+  for (const auto& entry : shard_stats) {
+    auto itr = stats_map->find(entry.first);
+    if (itr != stats_map->end()) {
+      itr->second.first += entry.second.first;
+      itr->second.second += entry.second.second;
+    } else {
+      stats_map->insert(itr, entry);
+    }
+  }
+}
+
+void AddToScalarAccumulator(
+    StatsAccumulatorScalarResource* accumulator_resource,
+    const Tensor& partition_ids_t, const Tensor& feature_ids_t,
+    const Tensor& gradients_t, const Tensor& hessians_t) {
+  accumulator_resource->set_num_updates(accumulator_resource->num_updates() +
+                                        1);
+  AccumulateScalarRows(partition_ids_t, feature_ids_t, gradients_t, hessians_t,
+                       0, partition_ids_t.dim_size(0),
+                       accumulator_resource->mutable_values());
+}
+
 void AddToScalarAccumulator(
     StatsAccumulatorScalarResource* accumulator_resource,
     OpKernelContext* context) {
@@ -253,66 +317,107 @@ void AddToScalarAccumulator(
                          *gradients_t, *hessians_t);
 }
 
-void AddToTensorAccumulator(
-    StatsAccumulatorTensorResource* accumulator_resource,
-    const Tensor& partition_ids_t, const Tensor& feature_ids_t,
-    const Tensor& gradients_t, const Tensor& hessians_t,
-    OpKernelContext* context) {
-  accumulator_resource->set_num_updates(accumulator_resource->num_updates() +
-                                        1);
-
-  const TensorShape& partition_ids_shape = partition_ids_t.shape();
-  const auto& partition_ids = partition_ids_t.vec<int32>();
-  const auto& feature_ids = feature_ids_t.vec<int64>();
+// Checks that the per-row gradient and hessian shapes of an update match the
+// accumulator.
+Status CheckTensorShapes(
+    const StatsAccumulatorTensorResource& accumulator_resource,
+    const Tensor& gradients_t, const Tensor& hessians_t) {
   TensorShape gradients_shape = gradients_t.shape();
-  const auto& gradients = gradients_t.flat_outer_dims<float>();
   TensorShape hessians_shape = hessians_t.shape();
-  const auto& hessians = hessians_t.flat_outer_dims<float>();
-
   gradients_shape.RemoveDim(0);
   hessians_shape.RemoveDim(0);
 
   // TODO(soroush): Move gradient and hessian shape check to ShapeFn.
-  OP_REQUIRES(
-      context, gradients_shape == accumulator_resource->gradient_shape(),
-      errors::InvalidArgument(strings::StrCat(
-          "Gradients dimensions must match: ", gradients_shape.DebugString(),
-          ", ", accumulator_resource->gradient_shape().DebugString())));
-
-  OP_REQUIRES(
-      context, hessians_shape == accumulator_resource->hessian_shape(),
-      errors::InvalidArgument(strings::StrCat(
-          "Hessian dimensions must match: ", hessians_shape.DebugString(), ", ",
-          accumulator_resource->hessian_shape().DebugString())));
-
-  int64 num_updates = partition_ids_shape.dim_size(0);
-  auto stats_map = accumulator_resource->mutable_values();
-  for (int64 i = 0; i < num_updates; ++i) {
+  if (gradients_shape != accumulator_resource.gradient_shape()) {
+    return errors::InvalidArgument(strings::StrCat(
+        "Gradients dimensions must match: ", gradients_shape.DebugString(),
+        ", ", accumulator_resource.gradient_shape().DebugString()));
+  }
+  if (hessians_shape != accumulator_resource.hessian_shape()) {
+    return errors::InvalidArgument(strings::StrCat(
+        "Hessian dimensions must match: ", hessians_shape.DebugString(), ", ",
+        accumulator_resource.hessian_shape().DebugString()));
+  }
+  return Status::OK();
+}
+
+// Sums the rows [row_start, row_end) of an update into stats_map.
+void AccumulateTensorRows(
+    const Tensor& partition_ids_t, const Tensor& feature_ids_t,
+    const Tensor& gradients_t, const Tensor& hessians_t, int64 row_start,
+    int64 row_end,
+    StatsAccumulatorTensorResource::StatsByPartition* stats_map) {
+  const auto& partition_ids = partition_ids_t.vec<int32>();
+  const auto& feature_ids = feature_ids_t.vec<int64>();
+  const auto& gradients = gradients_t.flat_outer_dims<float>();
+  const auto& hessians = hessians_t.flat_outer_dims<float>();
+  const int64 num_gradient_elements = gradients.dimension(1);
+  const int64 num_hessian_elements = hessians.dimension(1);
+
+  for (int64 i = row_start; i < row_end; ++i) {
     const auto key = PartitionKey(partition_ids(i), feature_ids(i));
     auto itr = stats_map->find(key);
     if (itr == stats_map->end()) {
-      std::vector<float> new_gradients(gradients_shape.num_elements());
-      for (int j = 0; j < gradients_shape.num_elements(); ++j) {
+      std::vector<float> new_gradients(num_gradient_elements);
+      for (int j = 0; j < num_gradient_elements; ++j) {
         new_gradients[j] = gradients(i, j);
       }
-      std::vector<float> new_hessians(hessians_shape.num_elements());
-      for (int j = 0; j < hessians_shape.num_elements(); ++j) {
+      std::vector<float> new_hessians(num_hessian_elements);
+      for (int j = 0; j < num_hessian_elements; ++j) {
         new_hessians[j] = hessians(i, j);
       }
       (*stats_map)[key] = {new_gradients, new_hessians};
     } else {
       auto& stored_gradients = itr->second.first;
-      for (int j = 0; j < gradients_shape.num_elements(); ++j) {
+      for (int j = 0; j < num_gradient_elements; ++j) {
         stored_gradients[j] += gradients(i, j);
       }
       auto& stored_hessians = itr->second.second;
-      for (int j = 0; j < hessians_shape.num_elements(); ++j) {
+      for (int j = 0; j < num_hessian_elements; ++j) {
         stored_hessians[j] += hessians(i, j);
       }
     }
   }
 }
 
+// Adds the stats summed by a shard to stats_map.
+void MergeTensorStats(
+    const StatsAccumulatorTensorResource::StatsByPartition& shard_stats,
+    StatsAccumulatorTensorResource::StatsByPartition* stats_map) {
+  for (const auto& entry : shard_stats) {
+    auto itr = stats_map->find(entry.first);
+    if (itr == stats_map->end()) {
+      stats_map->insert(itr, entry);
+      continue;
+    }
+    auto& stored_gradients = itr->second.first;
+    for (size_t j = 0; j < stored_gradients.size(); ++j) {
+      stored_gradients[j] += entry.second.first[j];
+    }
+    auto& stored_hessians = itr->second.second;
+    for (size_t j = 0; j < stored_hessians.size(); ++j) {
+      stored_hessians[j] += entry.second.second[j];
+    }
+  }
+}
+
+void AddToTensorAccumulator(
+    StatsAccumulatorTensorResource* accumulator_resource,
+    const Tensor& partition_ids_t, const Tensor& feature_ids_t,
+    const Tensor& gradients_t, const Tensor& hessians_t,
+    OpKernelContext* context) {
+  accumulator_resource->set_num_updates(accumulator_resource->num_updates() +
+                                        1);
+
+  const TensorShape& partition_ids_shape = partition_ids_t.shape();
+  OP_REQUIRES_OK(context, CheckTensorShapes(*accumulator_resource, gradients_t,
+                                            hessians_t));
+
+  AccumulateTensorRows(partition_ids_t, feature_ids_t, gradients_t, hessians_t,
+                       0, partition_ids_shape.dim_size(0),
+                       accumulator_resource->mutable_values());
+}
+
 void AddToTensorAccumulator(
     StatsAccumulatorTensorResource* accumulator_resource,
     OpKernelContext* context) {
@@ -427,14 +532,35 @@ class StatsAccumulatorScalarAddOp : public OpKernel {
     OP_REQUIRES_OK(context, context->input(kStampTokenName, &stamp_token_t));
     int64 stamp_token = stamp_token_t->scalar<int64>()();
 
+    // Sum every update into shard-local stats without holding any
+    // accumulator lock, so that large updates use all the worker threads.
     thread::ThreadPool* const worker_threads =
         context->device()->tensorflow_cpu_worker_threads()->workers;
+    const UpdateShards shards(partition_ids_list);
+    std::vector<StatsAccumulatorScalarResource::StatsByPartition> shard_stats(
+        shards.num_shards());
+    boosted_trees::utils::ParallelFor(
+        shards.num_shards(), worker_threads->NumThreads(), worker_threads,
+        [&shards, &shard_stats, &partition_ids_list, &feature_ids_list,
+         &gradients_list, &hessians_list](int64 start, int64 end) {
+          for (int64 shard = start; shard < end; ++shard) {
+            int update;
+            int64 row_start;
+            int64 row_end;
+            shards.GetRows(shard, &update, &row_start, &row_end);
+            AccumulateScalarRows(partition_ids_list[update],
+                                 feature_ids_list[update],
+                                 gradients_list[update], hessians_list[update],
+                                 row_start, row_end, &shard_stats[shard]);
+          }
+        });
+
+    // Merge the shards of each update into its accumulator, in shard order.
     boosted_trees::utils::ParallelFor(
         resource_handle_list.size(), worker_threads->NumThreads(),
         worker_threads,
-        [&context, &resource_handle_list, &partition_ids_list,
-         &feature_ids_list, &gradients_list, &hessians_list,
-         stamp_token](int64 start, int64 end) {
+        [&context, &resource_handle_list, &gradients_list, &hessians_list,
+         &shards, &shard_stats, stamp_token](int64 start, int64 end) {
           for (int resource_handle_idx = start; resource_handle_idx < end;
                ++resource_handle_idx) {
             ResourceHandle handle = resource_handle_list[resource_handle_idx]
@@ -453,11 +579,14 @@ class StatsAccumulatorScalarAddOp : public OpKernel {
                       << "Current token: " << accumulator_resource->stamp();
               return;
             }
-            AddToScalarAccumulator(accumulator_resource,
-                                   partition_ids_list[resource_handle_idx],
-                                   feature_ids_list[resource_handle_idx],
-                                   gradients_list[resource_handle_idx],
-                                   hessians_list[resource_handle_idx]);
+            accumulator_resource->set_num_updates(
+                accumulator_resource->num_updates() + 1);
+            for (int64 shard = shards.first_shard(resource_handle_idx);
+                 shard < shards.first_shard(resource_handle_idx + 1);
+                 ++shard) {
+              MergeScalarStats(shard_stats[shard],
+                              accumulator_resource->mutable_values());
+            }
           }
         });
   }
@@ -491,14 +620,35 @@ class StatsAccumulatorTensorAddOp : public OpKernel {
     OP_REQUIRES_OK(context, context->input(kStampTokenName, &stamp_token_t));
     int64 stamp_token = stamp_token_t->scalar<int64>()();
 
+    // Sum every update into shard-local stats without holding any
+    // accumulator lock, so that large updates use all the worker threads.
     thread::ThreadPool* const worker_threads =
         context->device()->tensorflow_cpu_worker_threads()->workers;
+    const UpdateShards shards(partition_ids_list);
+    std::vector<StatsAccumulatorTensorResource::StatsByPartition> shard_stats(
+        shards.num_shards());
+    boosted_trees::utils::ParallelFor(
+        shards.num_shards(), worker_threads->NumThreads(), worker_threads,
+        [&shards, &shard_stats, &partition_ids_list, &feature_ids_list,
+         &gradients_list, &hessians_list](int64 start, int64 end) {
+          for (int64 shard = start; shard < end; ++shard) {
+            int update;
+            int64 row_start;
+            int64 row_end;
+            shards.GetRows(shard, &update, &row_start, &row_end);
+            AccumulateTensorRows(partition_ids_list[update],
+                                 feature_ids_list[update],
+                                 gradients_list[update], hessians_list[update],
+                                 row_start, row_end, &shard_stats[shard]);
+          }
+        });
+
+    // Merge the shards of each update into its accumulator, in shard order.
     boosted_trees::utils::ParallelFor(
         resource_handle_list.size(), worker_threads->NumThreads(),
         worker_threads,
-        [&context, &resource_handle_list, &partition_ids_list,
-         &feature_ids_list, &gradients_list, &hessians_list,
-         stamp_token](int64 start, int64 end) {
+        [&context, &resource_handle_list, &gradients_list, &hessians_list,
+         &shards, &shard_stats, stamp_token](int64 start, int64 end) {
           for (int resource_handle_idx = start; resource_handle_idx < end;
                ++resource_handle_idx) {
             ResourceHandle handle = resource_handle_list[resource_handle_idx]
@@ -517,11 +667,19 @@ class StatsAccumulatorTensorAddOp : public OpKernel {
                       << "Current token: " << accumulator_resource->stamp();
               return;
             }
-            AddToTensorAccumulator(accumulator_resource,
-                                   partition_ids_list[resource_handle_idx],
-                                   feature_ids_list[resource_handle_idx],
-                                   gradients_list[resource_handle_idx],
-                                   hessians_list[resource_handle_idx], context);
+            accumulator_resource->set_num_updates(
+                accumulator_resource->num_updates() + 1);
+            OP_REQUIRES_OK(
+                context,
+                CheckTensorShapes(*accumulator_resource,
+                                  gradients_list[resource_handle_idx],
+                                  hessians_list[resource_handle_idx]));
+            for (int64 shard = shards.first_shard(resource_handle_idx);
+                 shard < shards.first_shard(resource_handle_idx + 1);
+                 ++shard) {
+              MergeTensorStats(shard_stats[shard],
+                              accumulator_resource->mutable_values());
+            }
           }
         });
   }
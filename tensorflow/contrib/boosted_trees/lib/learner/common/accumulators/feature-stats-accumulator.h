@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "tensorflow/contrib/boosted_trees/lib/learner/common/accumulators/class-partition-key.h"
+#include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 namespace boosted_trees {
@@ -51,6 +52,20 @@ class FeatureStatsAccumulator {
                             class_id, partition_id, feature_id)]);
   }
 
+  // Adds all the stats of another accumulator over the same feature columns.
+  // This lets each thread fill its own accumulator over a subset of the
+  // examples without synchronization and merge them once at the end.
+  void Merge(const FeatureStatsAccumulator& other) {
+    QCHECK_EQ(feature_column_stats_.size(), other.feature_column_stats_.size());
+    for (size_t slot_id = 0; slot_id < feature_column_stats_.size();
+         ++slot_id) {
+      auto& stats = feature_column_stats_[slot_id];
+      for (const auto& entry : other.feature_column_stats_[slot_id]) {
+        accumulator_(entry.second, &stats[entry.first]);
+      }
+    }
+  }
+
   // Retrieves stats for the specified class, partition and feature
   // within the desired feature column. Default stats are returned if no match
   // can be found. Note that the feature column index must be valid.
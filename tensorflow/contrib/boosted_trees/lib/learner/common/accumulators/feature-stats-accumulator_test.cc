@@ -84,6 +84,24 @@ TEST_F(FeatureStatsAccumulatorTest, TwoFeaturesOneGrad) {
   EXPECT_STATS_EQ(stats2, accumulator.GetStats(0, 1, 0, 91));
 }
 
+TEST_F(FeatureStatsAccumulatorTest, Merge) {
+  FeatureStatsAccumulator accumulator1(2);
+  FeatureStatsAccumulator accumulator2(2);
+  TestStats stats1 = {-12.023f, 8.2f};
+  accumulator1.AddStats(0, 2, 1, 234, stats1);
+  TestStats stats2 = {4.46f, 1.9f};
+  accumulator2.AddStats(0, 2, 1, 234, stats2);
+  TestStats stats3 = {1.5f, 0.5f};
+  accumulator2.AddStats(1, 2, 1, 234, stats3);
+  accumulator1.Merge(accumulator2);
+
+  TestStats expected = {-7.563f, 10.1f};
+  EXPECT_STATS_EQ(expected, accumulator1.GetStats(0, 2, 1, 234));
+  EXPECT_STATS_EQ(stats3, accumulator1.GetStats(1, 2, 1, 234));
+  // The merged accumulator is unchanged.
+  EXPECT_STATS_EQ(stats2, accumulator2.GetStats(0, 2, 1, 234));
+}
+
 }  // namespace
 }  // namespace learner
 }  // namespace boosted_trees
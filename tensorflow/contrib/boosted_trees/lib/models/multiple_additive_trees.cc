@@ -13,7 +13,10 @@
 // limitations under the License.
 // =============================================================================
 #include "tensorflow/contrib/boosted_trees/lib/models/multiple_additive_trees.h"
-#include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+
+#include <algorithm>
+
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
 
@@ -53,34 +56,66 @@ void UpdatePredictions(
   }
 }
 
-void UpdatePredictionsBasedOnTree(
+// Number of examples evaluated together against each tree.
+constexpr int64 kExampleBlockSize = 32;
+
+// Adds the contributions of all trees to a block of examples. The loop runs
+// tree by tree so that the nodes of a tree stay in cache for the whole block;
+// each example still receives the contributions in tree order. Trees at or
+// after num_kept_trees were dropped out and only count towards
+// no_dropout_predictions. Ensembles of dense splits only are traversed for the
+// whole block at once from a packed copy of the dense features.
+void UpdatePredictionsForBlock(
     const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
-    const int32 tree_idx, const boosted_trees::utils::Example& example,
+    const boosted_trees::trees::FlatTreeEnsemble& flat_ensemble,
+    const std::vector<int32>& tree_ids, const int32 num_kept_trees,
+    const std::vector<boosted_trees::utils::Example>& block,
+    const int64 block_size,
     tensorflow::TTypes<float>::Matrix* output_predictions,
-    tensorflow::TTypes<float>::Matrix* additional_output_predictions) {
-  const boosted_trees::trees::DecisionTreeConfig& tree = config.trees(tree_idx);
-  const float tree_weight = config.tree_weights(tree_idx);
-  const int leaf_idx = trees::DecisionTree::Traverse(tree, 0, example);
-  QCHECK(leaf_idx >= 0) << "Invalid tree: " << tree.DebugString();
-  const auto& leaf_node = tree.nodes(leaf_idx);
-  QCHECK(leaf_node.has_leaf())
-      << "Invalid leaf node: " << leaf_node.DebugString();
-  if (leaf_node.leaf().has_sparse_vector()) {
-    const auto& leaf = leaf_node.leaf().sparse_vector();
-    QCHECK_EQ(leaf.index_size(), leaf.value_size());
-    for (size_t class_idx = 0; class_idx < leaf.index_size(); ++class_idx) {
-      const float value = tree_weight * leaf.value(class_idx);
-
-      UpdatePredictions(example.example_idx, leaf.index(class_idx), value,
-                        output_predictions, additional_output_predictions);
+    tensorflow::TTypes<float>::Matrix* no_dropout_predictions) {
+  const int32 num_dense_features = block[0].dense_float_features.size();
+  const bool traverse_block =
+      flat_ensemble.dense_only() &&
+      num_dense_features >= flat_ensemble.num_dense_features_used();
+  std::vector<float> dense_features;
+  if (traverse_block) {
+    dense_features.reserve(block_size * num_dense_features);
+    for (int64 i = 0; i < block_size; ++i) {
+      dense_features.insert(dense_features.end(),
+                            block[i].dense_float_features.begin(),
+                            block[i].dense_float_features.end());
+    }
+  }
+  std::vector<int32> leaves(block_size);
+  for (int32 tree = 0; tree < flat_ensemble.num_trees(); ++tree) {
+    const bool dropped = tree >= num_kept_trees;
+    if (traverse_block) {
+      flat_ensemble.TraverseDenseBlock(tree, dense_features.data(),
+                                       num_dense_features, block_size,
+                                       leaves.data());
+    } else {
+      for (int64 i = 0; i < block_size; ++i) {
+        leaves[i] = flat_ensemble.Traverse(tree, block[i]);
+      }
     }
-  } else {
-    QCHECK(leaf_node.leaf().has_vector()) << "Unknown leaf type";
-    const auto& leaf = leaf_node.leaf().vector();
-    for (size_t i = 0; i < leaf.value_size(); ++i) {
-      const float value = tree_weight * leaf.value(i);
-      UpdatePredictions(example.example_idx, i, value, output_predictions,
-                        additional_output_predictions);
+    for (int64 i = 0; i < block_size; ++i) {
+      const boosted_trees::utils::Example& example = block[i];
+      const int32 leaf_idx = leaves[i];
+      QCHECK(leaf_idx >= 0) << "Invalid tree: "
+                            << config.trees(tree_ids[tree]).DebugString();
+      for (const auto* leaf_value = flat_ensemble.leaf_values_begin(leaf_idx);
+           leaf_value != flat_ensemble.leaf_values_end(leaf_idx);
+           ++leaf_value) {
+        if (dropped) {
+          UpdatePredictions(example.example_idx, leaf_value->index,
+                            leaf_value->value, no_dropout_predictions,
+                            nullptr);
+        } else {
+          UpdatePredictions(example.example_idx, leaf_value->index,
+                            leaf_value->value, output_predictions,
+                            no_dropout_predictions);
+        }
+      }
     }
   }
 }
@@ -109,24 +144,34 @@ void MultipleAdditiveTrees::Predict(
   CalculateTreesToKeep(config, trees_to_drop, config.trees_size(),
                        only_finalized_trees, &trees_to_keep);
 
+  // Compile the kept trees followed by the dropped ones.
+  std::vector<int32> tree_ids(trees_to_keep);
+  tree_ids.insert(tree_ids.end(), trees_to_drop.begin(), trees_to_drop.end());
+  const boosted_trees::trees::FlatTreeEnsemble flat_ensemble(config, tree_ids);
+  const int32 num_kept_trees = trees_to_keep.size();
+
   // Lambda for doing a block of work.
-  auto update_predictions = [&config, &features, &trees_to_keep, &trees_to_drop,
-                             &output_predictions,
+  auto update_predictions = [&config, &features, &flat_ensemble, &tree_ids,
+                             num_kept_trees, &output_predictions,
                              &no_dropout_predictions](int64 start, int64 end) {
+    std::vector<boosted_trees::utils::Example> block(
+        std::min(kExampleBlockSize, end - start));
+    int64 block_size = 0;
     auto examples_iterable = features.examples_iterable(start, end);
     for (const auto& example : examples_iterable) {
-      for (const int32 tree_idx : trees_to_keep) {
-        UpdatePredictionsBasedOnTree(config, tree_idx, example,
-                                     &output_predictions,
-                                     &no_dropout_predictions);
-      }
-
-      // Now do predictions for dropped trees
-      for (const int32 tree_idx : trees_to_drop) {
-        UpdatePredictionsBasedOnTree(config, tree_idx, example,
-                                     &no_dropout_predictions, nullptr);
+      block[block_size++] = example;
+      if (block_size == static_cast<int64>(block.size())) {
+        UpdatePredictionsForBlock(config, flat_ensemble, tree_ids,
+                                  num_kept_trees, block, block_size,
+                                  &output_predictions, &no_dropout_predictions);
+        block_size = 0;
       }
     }
+    if (block_size > 0) {
+      UpdatePredictionsForBlock(config, flat_ensemble, tree_ids,
+                                num_kept_trees, block, block_size,
+                                &output_predictions, &no_dropout_predictions);
+    }
   };
 
   // TODO(salehay): parallelize this for low latency in serving path where
@@ -0,0 +1,267 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+namespace {
+constexpr int32 kInvalidLeaf = -1;
+}  // namespace
+
+FlatTreeEnsemble::FlatTreeEnsemble(const DecisionTreeEnsembleConfig& config,
+                                   const std::vector<int32>& tree_ids) {
+  tree_roots_.reserve(tree_ids.size());
+  tree_depths_.reserve(tree_ids.size());
+  for (const int32 tree_idx : tree_ids) {
+    const DecisionTreeConfig& tree = config.trees(tree_idx);
+    const float weight = config.tree_weights(tree_idx);
+    if (tree.nodes_size() == 0) {
+      tree_roots_.push_back(kInvalidLeaf);
+      tree_depths_.push_back(0);
+      continue;
+    }
+    const int32 offset = nodes_.size();
+    tree_roots_.push_back(offset);
+    for (const TreeNode& tree_node : tree.nodes()) {
+      AddNode(tree_node, offset, weight);
+    }
+    tree_depths_.push_back(DenseDepth(offset, tree.nodes_size()));
+  }
+}
+
+int32 FlatTreeEnsemble::DenseDepth(const int32 offset, const int32 num_nodes) {
+  int32 depth = 0;
+  std::vector<std::pair<int32, int32>> stack = {{offset, 0}};
+  while (!stack.empty()) {
+    const int32 node_id = stack.back().first;
+    const int32 node_depth = stack.back().second;
+    stack.pop_back();
+    const Node& node = nodes_[node_id];
+    if (node.type == kLeaf) {
+      depth = std::max(depth, node_depth);
+      continue;
+    }
+    // A longer path would have to visit some node twice.
+    if (node.type != kDenseFloatBinarySplit || node_depth >= num_nodes) {
+      dense_only_ = false;
+      return 0;
+    }
+    for (const int32 child : {node.left_id, node.right_id}) {
+      if (child < offset || child >= offset + num_nodes) {
+        dense_only_ = false;
+        return 0;
+      }
+      stack.emplace_back(child, node_depth + 1);
+    }
+  }
+  return depth;
+}
+
+void FlatTreeEnsemble::AddNode(const TreeNode& tree_node, const int32 offset,
+                               const float weight) {
+  Node node{kInvalid, 0, 0.0f, 0, 0, 0, 0};
+  const int32 node_id = nodes_.size();
+  switch (tree_node.node_case()) {
+    case TreeNode::kLeaf: {
+      node.type = kLeaf;
+      node.left_id = leaf_values_.size();
+      const auto& leaf = tree_node.leaf();
+      if (leaf.has_sparse_vector()) {
+        const auto& sparse = leaf.sparse_vector();
+        QCHECK_EQ(sparse.index_size(), sparse.value_size());
+        for (int i = 0; i < sparse.index_size(); ++i) {
+          leaf_values_.push_back({sparse.index(i), weight * sparse.value(i)});
+        }
+      } else {
+        QCHECK(leaf.has_vector()) << "Unknown leaf type";
+        const auto& dense = leaf.vector();
+        for (int i = 0; i < dense.value_size(); ++i) {
+          leaf_values_.push_back({i, weight * dense.value(i)});
+        }
+      }
+      node.right_id = leaf_values_.size();
+      break;
+    }
+    case TreeNode::kDenseFloatBinarySplit: {
+      const auto& split = tree_node.dense_float_binary_split();
+      node.type = kDenseFloatBinarySplit;
+      node.feature_column = split.feature_column();
+      node.threshold = split.threshold();
+      node.left_id = offset + split.left_id();
+      node.right_id = offset + split.right_id();
+      num_dense_features_used_ =
+          std::max(num_dense_features_used_, node.feature_column + 1);
+      break;
+    }
+    case TreeNode::kSparseFloatBinarySplitDefaultLeft: {
+      const auto& split =
+          tree_node.sparse_float_binary_split_default_left().split();
+      node.type = kSparseFloatBinarySplitDefaultLeft;
+      node.feature_column = split.feature_column();
+      node.threshold = split.threshold();
+      node.left_id = offset + split.left_id();
+      node.right_id = offset + split.right_id();
+      break;
+    }
+    case TreeNode::kSparseFloatBinarySplitDefaultRight: {
+      const auto& split =
+          tree_node.sparse_float_binary_split_default_right().split();
+      node.type = kSparseFloatBinarySplitDefaultRight;
+      node.feature_column = split.feature_column();
+      node.threshold = split.threshold();
+      node.left_id = offset + split.left_id();
+      node.right_id = offset + split.right_id();
+      break;
+    }
+    case TreeNode::kCategoricalIdBinarySplit: {
+      const auto& split = tree_node.categorical_id_binary_split();
+      node.type = kCategoricalIdBinarySplit;
+      node.feature_column = split.feature_column();
+      node.left_id = offset + split.left_id();
+      node.right_id = offset + split.right_id();
+      node.feature_ids_begin = feature_ids_.size();
+      feature_ids_.push_back(split.feature_id());
+      node.feature_ids_end = feature_ids_.size();
+      break;
+    }
+    case TreeNode::kCategoricalIdSetMembershipBinarySplit: {
+      const auto& split =
+          tree_node.categorical_id_set_membership_binary_split();
+      node.type = kCategoricalIdSetMembershipBinarySplit;
+      node.feature_column = split.feature_column();
+      node.left_id = offset + split.left_id();
+      node.right_id = offset + split.right_id();
+      node.feature_ids_begin = feature_ids_.size();
+      feature_ids_.insert(feature_ids_.end(), split.feature_ids().begin(),
+                          split.feature_ids().end());
+      node.feature_ids_end = feature_ids_.size();
+      break;
+    }
+    case TreeNode::NODE_NOT_SET: {
+      // Only fails if an example actually reaches the node, as in
+      // DecisionTree::Traverse.
+      break;
+    }
+  }
+  nodes_.push_back(node);
+  if (node.type == kDenseFloatBinarySplit) {
+    dense_children_.push_back(node.left_id);
+    dense_children_.push_back(node.right_id);
+  } else {
+    dense_children_.push_back(node_id);
+    dense_children_.push_back(node_id);
+  }
+}
+
+int32 FlatTreeEnsemble::Traverse(const int32 tree,
+                                 const utils::Example& example) const {
+  int32 node_id = tree_roots_[tree];
+  if (TF_PREDICT_FALSE(node_id == kInvalidLeaf)) {
+    return kInvalidLeaf;
+  }
+  while (true) {
+    const Node& node = nodes_[node_id];
+    switch (node.type) {
+      case kLeaf: {
+        return node_id;
+      }
+      case kDenseFloatBinarySplit: {
+        node_id = example.dense_float_features[node.feature_column] <=
+                          node.threshold
+                      ? node.left_id
+                      : node.right_id;
+        break;
+      }
+      case kSparseFloatBinarySplitDefaultLeft: {
+        const auto& sparse_feature =
+            example.sparse_float_features[node.feature_column];
+        node_id = !sparse_feature.has_value() ||
+                          sparse_feature.get_value() <= node.threshold
+                      ? node.left_id
+                      : node.right_id;
+        break;
+      }
+      case kSparseFloatBinarySplitDefaultRight: {
+        const auto& sparse_feature =
+            example.sparse_float_features[node.feature_column];
+        node_id = sparse_feature.has_value() &&
+                          sparse_feature.get_value() <= node.threshold
+                      ? node.left_id
+                      : node.right_id;
+        break;
+      }
+      case kCategoricalIdBinarySplit: {
+        node_id = example.sparse_int_features[node.feature_column].count(
+                      feature_ids_[node.feature_ids_begin]) > 0
+                      ? node.left_id
+                      : node.right_id;
+        break;
+      }
+      case kCategoricalIdSetMembershipBinarySplit: {
+        const auto ids_begin = feature_ids_.begin() + node.feature_ids_begin;
+        const auto ids_end = feature_ids_.begin() + node.feature_ids_end;
+        node_id = node.right_id;
+        for (const int64 feature_id :
+             example.sparse_int_features[node.feature_column]) {
+          const auto iter = std::lower_bound(ids_begin, ids_end, feature_id);
+          if (iter != ids_end && *iter == feature_id) {
+            node_id = node.left_id;
+            break;
+          }
+        }
+        break;
+      }
+      case kInvalid: {
+        QCHECK(false) << "Invalid node in tree " << tree;
+        break;
+      }
+    }
+  }
+}
+
+void FlatTreeEnsemble::TraverseDenseBlock(const int32 tree,
+                                          const float* features,
+                                          const int32 feature_stride,
+                                          const int32 num_examples,
+                                          int32* leaves) const {
+  DCHECK(dense_only_);
+  const int32 root = tree_roots_[tree];
+  std::fill_n(leaves, num_examples, root);
+  if (TF_PREDICT_FALSE(root == kInvalidLeaf)) {
+    return;
+  }
+  const Node* nodes = nodes_.data();
+  const int32* children = dense_children_.data();
+  for (int32 depth = 0; depth < tree_depths_[tree]; ++depth) {
+    for (int32 i = 0; i < num_examples; ++i) {
+      const Node& node = nodes[leaves[i]];
+      const float value = features[i * feature_stride + node.feature_column];
+      // Same decision as in Traverse, NaN included.
+      leaves[i] = children[2 * leaves[i] + (value <= node.threshold ? 0 : 1)];
+    }
+  }
+}
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
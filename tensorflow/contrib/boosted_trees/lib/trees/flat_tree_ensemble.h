@@ -0,0 +1,123 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/example.h"
+#include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+// A read-only copy of some trees of an ensemble, compiled into flat arrays
+// for fast evaluation. All nodes live in one contiguous array with absolute
+// child offsets, so traversal never touches the protos, and leaf values are
+// stored pre-multiplied by their tree weight.
+class FlatTreeEnsemble {
+ public:
+  // One class (or logit) contribution of a leaf.
+  struct LeafValue {
+    int32 index;
+    float value;
+  };
+
+  // Compiles config.trees(tree_ids[i]) as tree i of the flat ensemble.
+  FlatTreeEnsemble(const DecisionTreeEnsembleConfig& config,
+                   const std::vector<int32>& tree_ids);
+
+  int32 num_trees() const { return tree_roots_.size(); }
+
+  // Traverses the given tree and returns the reached leaf, or -1 if the tree
+  // is empty. Takes the same decisions as DecisionTree::Traverse.
+  int32 Traverse(int32 tree, const utils::Example& example) const;
+
+  // True if only leaves and dense float splits are reachable in the trees,
+  // which is what TraverseDenseBlock requires.
+  bool dense_only() const { return dense_only_; }
+
+  // One more than the largest dense feature column used by a split.
+  int32 num_dense_features_used() const { return num_dense_features_used_; }
+
+  // Same as calling Traverse for num_examples examples whose dense features
+  // are features[i * feature_stride + column], with feature_stride at least
+  // num_dense_features_used(). The examples go down one level at a time in
+  // lockstep, with leaves looping onto themselves, so the inner loop has no
+  // branches and no data-dependent trip count and can be vectorized.
+  void TraverseDenseBlock(int32 tree, const float* features,
+                          int32 feature_stride, int32 num_examples,
+                          int32* leaves) const;
+
+  // The weighted values of a leaf returned by Traverse.
+  const LeafValue* leaf_values_begin(int32 leaf) const {
+    return leaf_values_.data() + nodes_[leaf].left_id;
+  }
+  const LeafValue* leaf_values_end(int32 leaf) const {
+    return leaf_values_.data() + nodes_[leaf].right_id;
+  }
+
+ private:
+  enum NodeType : int32 {
+    kInvalid = 0,
+    kLeaf,
+    kDenseFloatBinarySplit,
+    kSparseFloatBinarySplitDefaultLeft,
+    kSparseFloatBinarySplitDefaultRight,
+    kCategoricalIdBinarySplit,
+    kCategoricalIdSetMembershipBinarySplit,
+  };
+
+  struct Node {
+    NodeType type;
+    int32 feature_column;
+    float threshold;
+    // Absolute child offsets for splits; the [begin, end) range in
+    // leaf_values_ for leaves.
+    int32 left_id;
+    int32 right_id;
+    // The [begin, end) range in feature_ids_ for categorical splits.
+    int32 feature_ids_begin;
+    int32 feature_ids_end;
+  };
+
+  void AddNode(const TreeNode& tree_node, int32 offset, float weight);
+
+  // Returns the length of the longest path from the root at offset to a leaf,
+  // and clears dense_only_ if the path goes through another kind of node or
+  // leaves the num_nodes nodes of the tree.
+  int32 DenseDepth(int32 offset, int32 num_nodes);
+
+  std::vector<int32> tree_roots_;
+  // Used by TraverseDenseBlock only.
+  std::vector<int32> tree_depths_;
+  std::vector<Node> nodes_;
+  // The left and right child of node i at 2 * i and 2 * i + 1, with both
+  // pointing back to i for leaves.
+  std::vector<int32> dense_children_;
+  bool dense_only_ = true;
+  int32 num_dense_features_used_ = 0;
+  std::vector<LeafValue> leaf_values_;
+  // Sorted per split, like in the protos.
+  std::vector<int64> feature_ids_;
+};
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_FLAT_TREE_ENSEMBLE_H_
@@ -0,0 +1,280 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/flat_tree_ensemble.h"
+
+#include <cmath>
+
+#include "tensorflow/contrib/boosted_trees/lib/testutil/batch_features_testutil.h"
+#include "tensorflow/contrib/boosted_trees/lib/testutil/random_tree_gen.h"
+#include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+#include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+namespace {
+
+class FlatTreeEnsembleTest : public ::testing::Test {
+ protected:
+  FlatTreeEnsembleTest() : batch_features_(2) {
+    // Same batch as in decision_tree_test.cc:
+    // Instance | DenseF1 | SparseF1 | SparseF2 | SparseI1 |
+    // 0        |   7     |   -3     |          |    3     |
+    // 1        |  -2     |          |   4      |          |
+    auto dense_float_matrix = test::AsTensor<float>({7.0f, -2.0f}, {2, 1});
+    auto sparse_float_indices1 = test::AsTensor<int64>({0, 0}, {1, 2});
+    auto sparse_float_values1 = test::AsTensor<float>({-3.0f});
+    auto sparse_float_shape1 = test::AsTensor<int64>({2, 1});
+    auto sparse_float_indices2 = test::AsTensor<int64>({1, 0}, {1, 2});
+    auto sparse_float_values2 = test::AsTensor<float>({4.0f});
+    auto sparse_float_shape2 = test::AsTensor<int64>({2, 1});
+    auto sparse_int_indices1 = test::AsTensor<int64>({0, 0}, {1, 2});
+    auto sparse_int_values1 = test::AsTensor<int64>({3});
+    auto sparse_int_shape1 = test::AsTensor<int64>({2, 1});
+    TF_EXPECT_OK(batch_features_.Initialize(
+        {dense_float_matrix}, {sparse_float_indices1, sparse_float_indices2},
+        {sparse_float_values1, sparse_float_values2},
+        {sparse_float_shape1, sparse_float_shape2}, {sparse_int_indices1},
+        {sparse_int_values1}, {sparse_int_shape1}));
+  }
+
+  // Checks that the flat ensemble reaches the same leaves as
+  // DecisionTree::Traverse for the single tree in the config.
+  void ExpectSameLeaves(const DecisionTreeEnsembleConfig& config) {
+    FlatTreeEnsemble flat_ensemble(config, {0});
+    auto example_iterable = batch_features_.examples_iterable(0, 2);
+    for (const auto& example : example_iterable) {
+      EXPECT_EQ(DecisionTree::Traverse(config.trees(0), 0, example),
+                flat_ensemble.Traverse(0, example));
+    }
+  }
+
+  utils::BatchFeatures batch_features_;
+};
+
+TEST_F(FlatTreeEnsembleTest, TraverseEmpty) {
+  DecisionTreeEnsembleConfig config;
+  config.add_trees();
+  config.add_tree_weights(1.0f);
+  FlatTreeEnsemble flat_ensemble(config, {0});
+  EXPECT_EQ(1, flat_ensemble.num_trees());
+  auto example_iterable = batch_features_.examples_iterable(0, 1);
+  EXPECT_EQ(-1, flat_ensemble.Traverse(0, *example_iterable.begin()));
+}
+
+TEST_F(FlatTreeEnsembleTest, TraverseHybridSplits) {
+  DecisionTreeEnsembleConfig config;
+  config.add_tree_weights(1.0f);
+  DecisionTreeConfig* tree_config = config.add_trees();
+  auto* split_node1 =
+      tree_config->add_nodes()->mutable_dense_float_binary_split();
+  split_node1->set_feature_column(0);
+  split_node1->set_threshold(9.0f);
+  split_node1->set_left_id(1);
+  split_node1->set_right_id(2);
+  auto* split_node2 = tree_config->add_nodes()
+                          ->mutable_sparse_float_binary_split_default_left()
+                          ->mutable_split();
+  split_node2->set_feature_column(0);
+  split_node2->set_threshold(-20.0f);
+  split_node2->set_left_id(3);
+  split_node2->set_right_id(4);
+  auto* split_node3 = tree_config->add_nodes()
+                          ->mutable_sparse_float_binary_split_default_right()
+                          ->mutable_split();
+  split_node3->set_feature_column(1);
+  split_node3->set_threshold(5.0f);
+  split_node3->set_left_id(5);
+  split_node3->set_right_id(6);
+  auto* split_node4 =
+      tree_config->add_nodes()->mutable_categorical_id_binary_split();
+  split_node4->set_feature_column(0);
+  split_node4->set_feature_id(3);
+  split_node4->set_left_id(7);
+  split_node4->set_right_id(8);
+  auto* split_node5 =
+      tree_config->add_nodes()
+          ->mutable_categorical_id_set_membership_binary_split();
+  split_node5->set_feature_column(0);
+  split_node5->add_feature_ids(1);
+  split_node5->add_feature_ids(3);
+  split_node5->set_left_id(9);
+  split_node5->set_right_id(10);
+  for (int i = 5; i <= 10; ++i) {
+    tree_config->add_nodes()->mutable_leaf();
+  }
+  auto example_iterable = batch_features_.examples_iterable(0, 2);
+  auto example_it = example_iterable.begin();
+  FlatTreeEnsemble flat_ensemble(config, {0});
+  // Both examples go left at the dense split. The first example then goes
+  // right to the set membership split and matches feature id 3. The second
+  // example is missing SparseF1, defaults left to the categorical split and
+  // goes right as it has no sparse int features.
+  EXPECT_EQ(9, flat_ensemble.Traverse(0, *example_it));
+  EXPECT_EQ(8, flat_ensemble.Traverse(0, *++example_it));
+  EXPECT_FALSE(flat_ensemble.dense_only());
+  ExpectSameLeaves(config);
+
+  // Route through each of the remaining splits from the root.
+  for (int root_child : {2, 3, 4}) {
+    split_node1->set_left_id(root_child);
+    ExpectSameLeaves(config);
+  }
+}
+
+TEST_F(FlatTreeEnsembleTest, LeafValuesAreWeighted) {
+  DecisionTreeEnsembleConfig config;
+  // Tree 0 has a single dense leaf.
+  auto* dense_leaf = config.add_trees()->add_nodes()->mutable_leaf();
+  dense_leaf->mutable_vector()->add_value(1.0f);
+  dense_leaf->mutable_vector()->add_value(2.0f);
+  config.add_tree_weights(0.5f);
+  // Tree 1 has a single sparse leaf.
+  auto* sparse_leaf = config.add_trees()->add_nodes()->mutable_leaf();
+  sparse_leaf->mutable_sparse_vector()->add_index(3);
+  sparse_leaf->mutable_sparse_vector()->add_value(4.0f);
+  config.add_tree_weights(2.0f);
+
+  // Compile the trees in reverse order.
+  FlatTreeEnsemble flat_ensemble(config, {1, 0});
+  EXPECT_EQ(2, flat_ensemble.num_trees());
+  auto example_iterable = batch_features_.examples_iterable(0, 1);
+  const utils::Example example = *example_iterable.begin();
+
+  const int32 sparse_leaf_id = flat_ensemble.Traverse(0, example);
+  auto* value = flat_ensemble.leaf_values_begin(sparse_leaf_id);
+  ASSERT_EQ(1, flat_ensemble.leaf_values_end(sparse_leaf_id) - value);
+  EXPECT_EQ(3, value->index);
+  EXPECT_FLOAT_EQ(8.0f, value->value);
+
+  const int32 dense_leaf_id = flat_ensemble.Traverse(1, example);
+  value = flat_ensemble.leaf_values_begin(dense_leaf_id);
+  ASSERT_EQ(2, flat_ensemble.leaf_values_end(dense_leaf_id) - value);
+  EXPECT_EQ(0, value[0].index);
+  EXPECT_FLOAT_EQ(0.5f, value[0].value);
+  EXPECT_EQ(1, value[1].index);
+  EXPECT_FLOAT_EQ(1.0f, value[1].value);
+}
+
+TEST_F(FlatTreeEnsembleTest, RandomEnsembleMatchesDecisionTree) {
+  const int32 kBatchSize = 100;
+  const int32 kNumSparseFeatures = 20;
+  random::PhiloxRandom philox(1234);
+  random::SimplePhilox rng(&philox);
+  utils::BatchFeatures batch_features(kBatchSize);
+  testutil::RandomlyInitializeBatchFeatures(&rng, 0, kNumSparseFeatures, 0.3,
+                                            0.9, &batch_features);
+  testutil::RandomTreeGen tree_gen(&rng, 0, kNumSparseFeatures);
+  const auto config = tree_gen.GenerateEnsemble(6, 10);
+  std::vector<int32> tree_ids(config.trees_size());
+  for (int32 i = 0; i < config.trees_size(); ++i) {
+    tree_ids[i] = i;
+  }
+  FlatTreeEnsemble flat_ensemble(config, tree_ids);
+
+  auto example_iterable = batch_features.examples_iterable(0, kBatchSize);
+  for (const auto& example : example_iterable) {
+    for (int32 i = 0; i < config.trees_size(); ++i) {
+      // Leaf values are random, so compare them to identify the leaf.
+      const int32 expected_leaf =
+          DecisionTree::Traverse(config.trees(i), 0, example);
+      const auto& expected =
+          config.trees(i).nodes(expected_leaf).leaf().sparse_vector();
+      const int32 leaf = flat_ensemble.Traverse(i, example);
+      auto* value = flat_ensemble.leaf_values_begin(leaf);
+      ASSERT_EQ(expected.value_size(),
+                flat_ensemble.leaf_values_end(leaf) - value);
+      for (int j = 0; j < expected.value_size(); ++j) {
+        EXPECT_EQ(expected.index(j), value[j].index);
+        EXPECT_EQ(config.tree_weights(i) * expected.value(j), value[j].value);
+      }
+    }
+  }
+}
+
+TEST_F(FlatTreeEnsembleTest, TraverseDenseBlockMatchesTraverse) {
+  const int32 kBatchSize = 100;
+  const int32 kNumDenseFeatures = 8;
+  random::PhiloxRandom philox(4321);
+  random::SimplePhilox rng(&philox);
+  utils::BatchFeatures batch_features(kBatchSize);
+  testutil::RandomlyInitializeBatchFeatures(&rng, kNumDenseFeatures, 0, 0.0,
+                                            0.0, &batch_features);
+  testutil::RandomTreeGen tree_gen(&rng, kNumDenseFeatures, 0);
+  const auto config = tree_gen.GenerateEnsemble(6, 10);
+  std::vector<int32> tree_ids(config.trees_size());
+  for (int32 i = 0; i < config.trees_size(); ++i) {
+    tree_ids[i] = i;
+  }
+  FlatTreeEnsemble flat_ensemble(config, tree_ids);
+  ASSERT_TRUE(flat_ensemble.dense_only());
+  ASSERT_LE(flat_ensemble.num_dense_features_used(), kNumDenseFeatures);
+
+  std::vector<utils::Example> examples;
+  std::vector<float> features;
+  auto example_iterable = batch_features.examples_iterable(0, kBatchSize);
+  for (const auto& example : example_iterable) {
+    examples.push_back(example);
+    features.insert(features.end(), example.dense_float_features.begin(),
+                    example.dense_float_features.end());
+  }
+  std::vector<int32> leaves(kBatchSize);
+  for (int32 i = 0; i < config.trees_size(); ++i) {
+    flat_ensemble.TraverseDenseBlock(i, features.data(), kNumDenseFeatures,
+                                     kBatchSize, leaves.data());
+    for (int32 j = 0; j < kBatchSize; ++j) {
+      EXPECT_EQ(flat_ensemble.Traverse(i, examples[j]), leaves[j]);
+    }
+  }
+}
+
+TEST_F(FlatTreeEnsembleTest, TraverseDenseBlockEmptyAndNaN) {
+  DecisionTreeEnsembleConfig config;
+  config.add_tree_weights(1.0f);
+  config.add_trees();
+  config.add_tree_weights(1.0f);
+  DecisionTreeConfig* tree_config = config.add_trees();
+  auto* split = tree_config->add_nodes()->mutable_dense_float_binary_split();
+  split->set_feature_column(1);
+  split->set_threshold(0.0f);
+  split->set_left_id(1);
+  split->set_right_id(2);
+  tree_config->add_nodes()->mutable_leaf();
+  tree_config->add_nodes()->mutable_leaf();
+  FlatTreeEnsemble flat_ensemble(config, {0, 1});
+  ASSERT_TRUE(flat_ensemble.dense_only());
+  EXPECT_EQ(2, flat_ensemble.num_dense_features_used());
+
+  // Like Traverse, NaN goes right.
+  const float features[] = {5.0f, -1.0f, 5.0f, 1.0f, 5.0f, NAN};
+  int32 leaves[3];
+  flat_ensemble.TraverseDenseBlock(0, features, 2, 3, leaves);
+  EXPECT_EQ(-1, leaves[0]);
+  EXPECT_EQ(-1, leaves[2]);
+  flat_ensemble.TraverseDenseBlock(1, features, 2, 3, leaves);
+  EXPECT_EQ(1, leaves[0]);
+  EXPECT_EQ(2, leaves[1]);
+  EXPECT_EQ(2, leaves[2]);
+}
+
+}  // namespace
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
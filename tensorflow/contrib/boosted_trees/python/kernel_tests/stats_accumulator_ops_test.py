@@ -18,6 +18,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import numpy as np
+
 from tensorflow.contrib.boosted_trees.python.ops import stats_accumulator_ops
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import tensor_shape
@@ -182,6 +184,45 @@ class StatsAccumulatorScalarTest(test_util.TensorFlowTestCase):
       self.assertAllClose(result[(1, 2)], [0.2, 0.4])
       self.assertAllClose(result[(2, 3)], [0.3, 0.4])
 
+  def testLargeUpdate(self):
+    # Large enough for the update to be summed over several shards.
+    num_rows = 20000
+    partition_ids = np.arange(num_rows, dtype=np.int32) % 3
+    feature_ids = np.arange(num_rows, dtype=np.int64) % 2
+    gradients = np.full(num_rows, 0.5, dtype=np.float32)
+    hessians = np.full(num_rows, 0.25, dtype=np.float32)
+    with self.test_session() as sess:
+      accumulator = stats_accumulator_ops.StatsAccumulator(
+          stamp_token=0,
+          gradient_shape=tensor_shape.scalar(),
+          hessian_shape=tensor_shape.scalar())
+      with ops.control_dependencies([accumulator._create_op]):
+        op1 = accumulator.add(
+            stamp_token=0,
+            partition_ids=partition_ids,
+            feature_ids=feature_ids,
+            gradients=gradients,
+            hessians=hessians)
+        op2 = accumulator.add(0, [1], [1], [0.1], [0.2])
+
+      with ops.control_dependencies([op1, op2]):
+        num_updates, partition, feature, grads, hessians = accumulator.flush(
+            stamp_token=0, next_stamp_token=1)
+        num_updates, partition, feature, grads, hessians = sess.run(
+            [num_updates, partition, feature, grads, hessians])
+
+      result = _AccumulatorResultToDict(partition, feature, grads, hessians)
+      self.assertEqual(num_updates, 2)
+      self.assertEqual(len(result), 6)
+      for partition_id in range(3):
+        for feature_id in range(2):
+          count = np.sum((np.arange(num_rows) % 3 == partition_id) &
+                         (np.arange(num_rows) % 2 == feature_id))
+          expected = [0.5 * count, 0.25 * count]
+          if (partition_id, feature_id) == (1, 1):
+            expected = [expected[0] + 0.1, expected[1] + 0.2]
+          self.assertAllClose(result[(partition_id, feature_id)], expected)
+
 
 class StatsAccumulatorTensorTest(test_util.TensorFlowTestCase):
   """Tests for tensor gradients and hessians accumulator."""
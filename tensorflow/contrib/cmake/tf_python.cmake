@@ -238,6 +238,8 @@ add_python_module("tensorflow/python/user_ops")
 add_python_module("tensorflow/python/util")
 add_python_module("tensorflow/python/util/protobuf")
 add_python_module("tensorflow/contrib")
+add_python_module("tensorflow/contrib/all_reduce")
+add_python_module("tensorflow/contrib/all_reduce/python")
 add_python_module("tensorflow/contrib/android")
 add_python_module("tensorflow/contrib/android/java")
 add_python_module("tensorflow/contrib/android/java/org")
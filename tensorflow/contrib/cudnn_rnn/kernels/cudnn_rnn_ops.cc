@@ -99,6 +99,7 @@ enum class TFRNNInputMode {
 };
 
 namespace {
+using perftools::gputools::dnn::RnnAlgorithm;
 using perftools::gputools::dnn::RnnMode;
 using perftools::gputools::dnn::RnnInputMode;
 using perftools::gputools::dnn::RnnDirectionMode;
@@ -125,6 +126,20 @@ Status ParseRNNMode(const string& str, RnnMode* rnn_mode) {
   return errors::InvalidArgument("Invalid RNN mode: ", str);
 }
 
+Status ParseRNNAlgorithm(const string& str, RnnAlgorithm* rnn_algorithm) {
+  if (str == "standard") {
+    *rnn_algorithm = RnnAlgorithm::kRnnStandard;
+    return Status::OK();
+  } else if (str == "persist_static") {
+    *rnn_algorithm = RnnAlgorithm::kRnnPersistStatic;
+    return Status::OK();
+  } else if (str == "persist_dynamic") {
+    *rnn_algorithm = RnnAlgorithm::kRnnPersistDynamic;
+    return Status::OK();
+  }
+  return errors::InvalidArgument("Invalid RNN algorithm: ", str);
+}
+
 Status ParseTFRNNInputMode(const string& str, TFRNNInputMode* rnn_input_mode) {
   if (str == "linear_input") {
     *rnn_input_mode = TFRNNInputMode::kRNNLinearInput;
@@ -488,10 +503,20 @@ class CudnnRNNKernelCommon : public OpKernel {
     return model_types_.rnn_direction_mode;
   }
   CudnnModelTypes model_types() const { return model_types_; }
+  RnnAlgorithm rnn_algorithm() const { return rnn_algorithm_; }
   float dropout() const { return dropout_; }
   uint64 seed() { return (static_cast<uint64>(seed_) << 32) | seed2_; }
   bool ResetRndGenState() { return reset_rnd_gen_state_; }
 
+  // Only the kernels that run the model carry the "rnn_algorithm" attribute;
+  // the params kernels always describe the model with the standard one, which
+  // does not change the params layout.
+  void ExtractRnnAlgorithm(OpKernelConstruction* context) {
+    string str;
+    OP_REQUIRES_OK(context, context->GetAttr("rnn_algorithm", &str));
+    OP_REQUIRES_OK(context, ParseRNNAlgorithm(str, &rnn_algorithm_));
+  }
+
   template <typename T>
   Status ExtractCudnnRNNParamsInfo(OpKernelContext* context,
                                    std::unique_ptr<RnnDescriptor>* rnn_desc) {
@@ -537,6 +562,7 @@ class CudnnRNNKernelCommon : public OpKernel {
   int seed2_;
   float dropout_;
   bool reset_rnd_gen_state_;
+  RnnAlgorithm rnn_algorithm_ = RnnAlgorithm::kRnnStandard;
 
   CudnnModelTypes model_types_;
 };
@@ -741,6 +767,7 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
   explicit CudnnRNNForwardOp(OpKernelConstruction* context)
       : CudnnRNNKernelCommon(context) {
     OP_REQUIRES_OK(context, context->GetAttr("is_training", &is_training_));
+    ExtractRnnAlgorithm(context);
   }
 
   void Compute(OpKernelContext* context) override {
@@ -798,7 +825,7 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
             model_shapes_->num_layers, model_shapes_->num_units,
             model_shapes_->input_size, input_mode, rnn_direction_mode(),
             rnn_mode(), data_type, dropout(), seed(),
-            dropout_state_allocator_.get());
+            dropout_state_allocator_.get(), rnn_algorithm());
         OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
         rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
       }
@@ -885,7 +912,9 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
   typedef GPUDevice Device;
 
   explicit CudnnRNNBackwardOp(OpKernelConstruction* context)
-      : CudnnRNNKernelCommon(context) {}
+      : CudnnRNNKernelCommon(context) {
+    ExtractRnnAlgorithm(context);
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor* input = nullptr;
@@ -1006,7 +1035,7 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
             model_shapes.num_layers, model_shapes.num_units,
             model_shapes.input_size, input_mode, rnn_direction_mode(),
             rnn_mode(), data_type, dropout(), seed(),
-            dropout_state_allocator_.get());
+            dropout_state_allocator_.get(), rnn_algorithm());
         OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
         rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
       }
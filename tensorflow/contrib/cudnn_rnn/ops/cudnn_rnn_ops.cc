@@ -40,6 +40,15 @@ seed: the 1st part of a seed to initialize dropout.
 seed2: the 2nd part of a seed to initialize dropout.
 )doc";
 
+constexpr auto kCudnnRNNAlgorithmAttr = R"doc(
+rnn_algorithm: the algorithm used to run the model. 'persist_static' and
+    'persist_dynamic' keep the recurrent weights on chip across time steps and
+    are usually much faster for small batches. They need cuDNN 6.0;
+    'persist_dynamic' builds its kernel for the batch size at run time. The
+    backward op must use the same algorithm as the forward op. MIOpen picks
+    its own kernels and ignores this attribute.
+)doc";
+
 constexpr auto kCudnnRNNParamsBuffer = R"doc(
 Note that the params buffer may not be compatible across different GPUs. So any
 save and restoration should be converted to and from the canonical weights and
@@ -56,6 +65,10 @@ constexpr auto kRNNInputModeAttrs =
 constexpr auto kRNNDirectionAttrs =
     "direction: {'unidirectional', 'bidirectional'} = 'unidirectional'";
 
+constexpr auto kRNNAlgorithmAttrs =
+    "rnn_algorithm: {'standard', 'persist_static', 'persist_dynamic'} = "
+    "'standard'";
+
 constexpr auto kCudnnRNNParamsCanonical = R"doc(
 weights: the canonical form of weights that can be used for saving
     and restoration. They are more likely to be compatible across different
@@ -138,6 +151,7 @@ REGISTER_OP("CudnnRNN")
     .Attr("seed: int = 0")
     .Attr("seed2: int = 0")
     .Attr("is_training: bool = true")
+    .Attr(kRNNAlgorithmAttrs)
     .SetShapeFn([](InferenceContext* c) {
       auto input_shape = c->input(0);
       auto input_h_shape = c->input(1);
@@ -165,8 +179,8 @@ REGISTER_OP("CudnnRNN")
 Computes the RNN from the input and initial states, with respect to the params
 buffer.
 )doc",
-                         kCudnnRNNCommonAttrs, CudnnRNNForwardTensors(),
-                         R"doc(
+                         kCudnnRNNCommonAttrs, kCudnnRNNAlgorithmAttr,
+                         CudnnRNNForwardTensors(), R"doc(
 is_training: Indicates whether this operation is used for inferenece or
     training.
 reserve_space: an opaque tensor that can be used in backprop calculation. It
@@ -197,6 +211,7 @@ REGISTER_OP("CudnnRNNBackprop")
     .Attr("dropout: float = 0.0")
     .Attr("seed: int = 0")
     .Attr("seed2: int = 0")
+    .Attr(kRNNAlgorithmAttrs)
     .SetShapeFn([](InferenceContext* c) {
       auto input_shape = c->input(0);
       auto input_h_shape = c->input(1);
@@ -211,7 +226,8 @@ REGISTER_OP("CudnnRNNBackprop")
     .Doc(strings::StrCat(R"doc(
 Compute the backprop of both data and weights in a RNN.
 )doc",
-                         kCudnnRNNCommonAttrs, CudnnRNNForwardTensors(),
+                         kCudnnRNNCommonAttrs, kCudnnRNNAlgorithmAttr,
+                         CudnnRNNForwardTensors(),
                          R"doc(
 output_backprop: A 3-D tensor with the same shape as output in the forward pass.
 output_h_backprop: A 3-D tensor with the same shape as output_h in the forward
@@ -521,7 +521,8 @@ class _CudnnRNN(object):
                input_mode="linear_input",
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
-               seed=0):
+               seed=0,
+               rnn_algorithm="standard"):
     """Creates a CudnnRNN model from model spec.
 
     Args:
@@ -544,6 +545,9 @@ class _CudnnRNN(object):
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
           for behavior.
+      rnn_algorithm: the cuDNN algorithm used to run the model. Could be
+          'standard', 'persist_static' or 'persist_dynamic'. The persistent
+          algorithms are usually much faster for small batches.
     """
     self._num_layers = num_layers
     self._num_units = num_units
@@ -552,6 +556,7 @@ class _CudnnRNN(object):
     self._input_mode = input_mode
     self._direction = direction
     self._dropout = dropout
+    self._rnn_algorithm = rnn_algorithm
     # get graph and op seed.
     self._seed, self._seed2 = random_seed.get_seed(seed)
     if self._seed is None and self._seed2 is None:
@@ -628,7 +633,8 @@ class _CudnnRNN(object):
         dropout=self._dropout,
         seed=self._seed,
         seed2=self._seed2,
-        is_training=is_training)
+        is_training=is_training,
+        rnn_algorithm=self._rnn_algorithm)
     return (output, output_h, output_c)
 
   def params_to_canonical(self, params):
@@ -692,7 +698,8 @@ class CudnnLSTM(_CudnnRNN):
                input_mode="linear_input",
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
-               seed=0):
+               seed=0,
+               rnn_algorithm="standard"):
     """Creates a Cudnn LSTM model from model spec.
 
     Args:
@@ -710,6 +717,8 @@ class CudnnLSTM(_CudnnRNN):
           'unidirectional' or 'bidirectional'
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the seed used for initializing dropout.
+      rnn_algorithm: the cuDNN algorithm used to run the model. Could be
+          'standard', 'persist_static' or 'persist_dynamic'.
     """
     super(CudnnLSTM, self).__init__(
         CUDNN_LSTM,
@@ -719,7 +728,8 @@ class CudnnLSTM(_CudnnRNN):
         input_mode=input_mode,
         direction=direction,
         dropout=dropout,
-        seed=seed)
+        seed=seed,
+        rnn_algorithm=rnn_algorithm)
 
   def __call__(self, input_data, input_h, input_c, params, is_training=True):
     """Runs the forward step for the Cudnn LSTM model.
@@ -755,7 +765,8 @@ class _CudnnRNNNoInputC(_CudnnRNN):
                input_mode="linear_input",
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
-               seed=0):
+               seed=0,
+               rnn_algorithm="standard"):
     """Creates a Cudnn RNN model from model without hidden-state C.
 
     Args:
@@ -773,6 +784,8 @@ class _CudnnRNNNoInputC(_CudnnRNN):
           'unidirectional' or 'bidirectional'
       dropout: whether to enable dropout. With it is 0, dropout is disabled.
       seed: the seed used for initializing dropout.
+      rnn_algorithm: the cuDNN algorithm used to run the model. Could be
+          'standard', 'persist_static' or 'persist_dynamic'.
 
     Raises:
       ValueError: if direction is not 'unidirectional' or 'bidirectional'.
@@ -789,7 +802,8 @@ class _CudnnRNNNoInputC(_CudnnRNN):
         input_mode=input_mode,
         direction=direction,
         dropout=dropout,
-        seed=seed)
+        seed=seed,
+        rnn_algorithm=rnn_algorithm)
 
   def __call__(self, input_data, input_h, params, is_training=True):
     """Runs the forward step for the Cudnn LSTM model.
@@ -970,7 +984,8 @@ def _cudnn_rnn_backward(op, *grad):
       seed2=op.get_attr("seed2"),
       rnn_mode=op.get_attr("rnn_mode"),
       input_mode=op.get_attr("input_mode"),
-      direction=op.get_attr("direction"))
+      direction=op.get_attr("direction"),
+      rnn_algorithm=op.get_attr("rnn_algorithm"))
 
 
 ops.RegisterShape("CudnnRNNParamsSize")(common_shapes.call_cpp_shape_fn)
@@ -18,10 +18,13 @@
 @@Iterator
 @@TFRecordDataset
 @@FixedLengthRecordDataset
+@@LMDBDataset
 @@TextLineDataset
 
 @@read_batch_features
 @@rejection_resample
+
+@@AUTOTUNE
 """
 
 from __future__ import absolute_import
@@ -29,9 +32,11 @@ from __future__ import division
 from __future__ import print_function
 
 # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops.dataset_ops import AUTOTUNE
 from tensorflow.contrib.data.python.ops.dataset_ops import Dataset
 from tensorflow.contrib.data.python.ops.dataset_ops import FixedLengthRecordDataset
 from tensorflow.contrib.data.python.ops.dataset_ops import Iterator
+from tensorflow.contrib.data.python.ops.dataset_ops import LMDBDataset
 from tensorflow.contrib.data.python.ops.dataset_ops import read_batch_features
 from tensorflow.contrib.data.python.ops.dataset_ops import rejection_resample
 from tensorflow.contrib.data.python.ops.dataset_ops import TextLineDataset
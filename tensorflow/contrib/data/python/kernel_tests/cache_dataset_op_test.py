@@ -295,5 +295,61 @@ class MemoryCacheDatasetTest(test.TestCase):
         sess.run(i2.get_next())
 
 
+
+class TieredCacheDatasetTest(test.TestCase):
+
+  def setUp(self):
+    self.tmp_dir = tempfile.mkdtemp()
+    self.cache_prefix = path.join(self.tmp_dir, "cache")
+
+  def tearDown(self):
+    if self.tmp_dir:
+      shutil.rmtree(self.tmp_dir, ignore_errors=True)
+
+  def _testReplay(self, memory_budget_bytes):
+    repeat_count = variables.Variable(constant_op.constant(1, dtypes.int64))
+    filename = array_ops.placeholder(dtypes.string, shape=[])
+    dataset = (dataset_ops.Dataset.range(10)
+               .flat_map(lambda x: dataset_ops.Dataset.from_tensors(
+                   (x, array_ops.fill([3], x))).repeat(repeat_count))
+               .cache(filename, memory_budget_bytes=memory_budget_bytes)
+               .repeat(3))
+    iterator = dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(repeat_count.initializer)
+      sess.run(iterator.initializer, feed_dict={filename: self.cache_prefix})
+      # The first epoch reads from the input.
+      for i in range(10):
+        x, y = sess.run(get_next)
+        self.assertEqual(i, x)
+        self.assertAllEqual([i] * 3, y)
+
+      # The later epochs are replayed from the cache, although reading the
+      # input again would now produce no elements.
+      sess.run(repeat_count.assign(0))
+      for _ in range(2):
+        for i in range(10):
+          x, y = sess.run(get_next)
+          self.assertEqual(i, x)
+          self.assertAllEqual([i] * 3, y)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testAllInMemory(self):
+    self._testReplay(1 << 20)
+
+  def testPartiallySpilled(self):
+    # Each element is 32 bytes, so the first 4 elements stay in memory.
+    self._testReplay(128)
+
+  def testAllSpilled(self):
+    self._testReplay(0)
+
+  def testRequiresFilename(self):
+    with self.assertRaisesRegexp(ValueError, "filename"):
+      dataset_ops.Dataset.range(10).cache(memory_budget_bytes=128)
+
 if __name__ == "__main__":
   test.main()
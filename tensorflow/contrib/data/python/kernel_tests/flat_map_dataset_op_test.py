@@ -273,5 +273,68 @@ class InterleaveDatasetTest(test.TestCase):
         sess.run(next_element)
 
 
+  def _buildParallelInterleave(self, sloppy):
+    input_values = array_ops.placeholder(dtypes.int64, shape=[None])
+    cycle_length = array_ops.placeholder(dtypes.int64, shape=[])
+    block_length = array_ops.placeholder(dtypes.int64, shape=[])
+
+    dataset = (
+        dataset_ops.Dataset.from_tensor_slices(input_values)
+        .repeat(2)
+        .parallel_interleave(
+            lambda x: dataset_ops.Dataset.from_tensors(x).repeat(x),
+            cycle_length, block_length, sloppy=sloppy))
+    iterator = dataset.make_initializable_iterator()
+    return (input_values, cycle_length, block_length, iterator.initializer,
+            iterator.get_next())
+
+  def testParallelInterleaveDataset(self):
+    input_values, cycle_length, block_length, init_op, next_element = (
+        self._buildParallelInterleave(sloppy=False))
+
+    with self.test_session() as sess:
+      for values, cycle, block in [([4, 5, 6], 1, 3), ([4, 5, 6], 2, 1),
+                                   ([4, 5, 6], 2, 3), ([4, 5, 6], 7, 2),
+                                   ([4, 0, 6], 2, 3), ([0, 0, 0], 2, 3),
+                                   ([], 2, 3)]:
+        sess.run(init_op, feed_dict={input_values: values,
+                                     cycle_length: cycle, block_length: block})
+        # The order is the same as for `Dataset.interleave()`.
+        for expected_element in self._interleave(
+            [[x] * x for x in values] * 2, cycle, block):
+          self.assertEqual(expected_element, sess.run(next_element))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(next_element)
+
+  def testSloppyParallelInterleaveDataset(self):
+    input_values, cycle_length, block_length, init_op, next_element = (
+        self._buildParallelInterleave(sloppy=True))
+
+    with self.test_session() as sess:
+      for values, cycle, block in [([4, 5, 6], 1, 3), ([4, 5, 6], 2, 1),
+                                   ([4, 0, 6], 7, 2)]:
+        sess.run(init_op, feed_dict={input_values: values,
+                                     cycle_length: cycle, block_length: block})
+        # The order may differ, but all of the elements are produced.
+        expected_elements = sorted(x for x in values for _ in range(2 * x))
+        produced = [sess.run(next_element)
+                    for _ in range(len(expected_elements))]
+        self.assertEqual(expected_elements, sorted(produced))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(next_element)
+
+  def testParallelInterleaveDatasetEarlyDestruction(self):
+    # Destroying a partially consumed iterator must stop its workers.
+    iterator = (
+        dataset_ops.Dataset.range(10)
+        .parallel_interleave(
+            lambda x: dataset_ops.Dataset.from_tensors(x).repeat(100),
+            cycle_length=4, buffer_output_elements=1)
+        .make_one_shot_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      self.assertEqual(0, sess.run(get_next))
+
 if __name__ == "__main__":
   test.main()
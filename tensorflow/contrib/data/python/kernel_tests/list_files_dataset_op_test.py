@@ -67,6 +67,34 @@ class ListFilesDatasetOpTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(itr.get_next())
 
+  def testShuffledDirectory(self):
+    filenames = ['file%d' % i for i in range(20)]
+    self._touchTempFiles(filenames)
+
+    dataset = dataset_ops.Dataset.list_files(
+        path.join(self.tmp_dir, '*'), shuffle=True, seed=37)
+    with self.test_session() as sess:
+      itr = dataset.make_one_shot_iterator()
+      next_element = itr.get_next()
+
+      full_filenames = [compat.as_bytes(path.join(self.tmp_dir, filename))
+                        for filename in filenames]
+      produced_filenames = [compat.as_bytes(sess.run(next_element))
+                            for _ in filenames]
+      self.assertItemsEqual(full_filenames, produced_filenames)
+      # The matching files are sorted, so a shuffled order differs.
+      self.assertNotEqual(sorted(full_filenames), produced_filenames)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testShuffledEmptyDirectory(self):
+    dataset = dataset_ops.Dataset.list_files(
+        path.join(self.tmp_dir, '*'), shuffle=True)
+    with self.test_session() as sess:
+      itr = dataset.make_one_shot_iterator()
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(itr.get_next())
+
   def testEmptyDirectoryInitializer(self):
     filename_placeholder = array_ops.placeholder(dtypes.string, shape=[])
     dataset = dataset_ops.Dataset.list_files(filename_placeholder)
@@ -219,6 +219,34 @@ class MapDatasetTest(test.TestCase):
       for _ in range(3):
         sess.run(get_next)
 
+  def testParallelMapAutotune(self):
+    for output_buffer_size in [None, 4]:
+      dataset = (dataset_ops.Dataset.range(1000)
+                 .map(lambda x: x * x, num_threads=dataset_ops.AUTOTUNE,
+                      output_buffer_size=output_buffer_size))
+      iterator = dataset.make_initializable_iterator()
+      init_op = iterator.initializer
+      get_next = iterator.get_next()
+
+      with self.test_session() as sess:
+        sess.run(init_op)
+        # Autotuning changes the parallelism, but not the order of elements.
+        for i in range(1000):
+          self.assertEqual(i * i, sess.run(get_next))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testParallelMapInvalidNumThreads(self):
+    num_threads = array_ops.placeholder(dtypes.int32, shape=[])
+    dataset = (dataset_ops.Dataset.range(10)
+               .map(lambda x: x, num_threads=num_threads))
+    iterator = dataset.make_initializable_iterator()
+
+    with self.test_session() as sess:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "num_threads must be greater than zero"):
+        sess.run(iterator.initializer, feed_dict={num_threads: -2})
+
   def testParallelMapError(self):
     components = np.array([1., 2., 3., np.nan, 5.]).astype(np.float32)
 
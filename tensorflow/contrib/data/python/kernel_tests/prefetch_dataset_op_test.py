@@ -0,0 +1,100 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+class PrefetchDatasetTest(test.TestCase):
+
+  def testPrefetchDataset(self):
+    components = (np.arange(7),
+                  np.array([[1, 2, 3]]) * np.arange(7)[:, np.newaxis],
+                  np.array(37.0) * np.arange(7))
+    buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
+
+    dataset = (dataset_ops.Dataset.from_tensor_slices(components)
+               .map(lambda x, y, z: (x, math_ops.square(y), z))
+               .prefetch(buffer_size))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    self.assertEqual([c.shape[1:] for c in components],
+                     [t.shape for t in get_next])
+
+    with self.test_session() as sess:
+      for size in [1, 3, 100]:
+        sess.run(init_op, feed_dict={buffer_size: size})
+        for i in range(7):
+          result = sess.run(get_next)
+          self.assertAllEqual(components[0][i], result[0])
+          self.assertAllEqual(components[1][i]**2, result[1])
+          self.assertAllEqual(components[2][i], result[2])
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testPrefetchForwardsErrors(self):
+    dataset = (dataset_ops.Dataset.from_tensor_slices([1., 2., 0., 4.])
+               .map(lambda x: array_ops.check_numerics(1. / x, "error"))
+               .prefetch(2))
+    iterator = dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(iterator.initializer)
+      self.assertEqual(1., sess.run(get_next))
+      self.assertEqual(0.5, sess.run(get_next))
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+      self.assertEqual(0.25, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testInvalidBufferSize(self):
+    buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
+    iterator = (dataset_ops.Dataset.range(10).prefetch(buffer_size)
+                .make_initializable_iterator())
+
+    with self.test_session() as sess:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "buffer_size must be greater than zero"):
+        sess.run(iterator.initializer, feed_dict={buffer_size: 0})
+
+  def testEarlyDestruction(self):
+    # Destroying an iterator mid-sequence stops its prefetch thread.
+    iterator = (dataset_ops.Dataset.range(1000).prefetch(10)
+                .make_initializable_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for _ in range(3):
+        sess.run(iterator.initializer)
+        self.assertEqual(0, sess.run(get_next))
+        self.assertEqual(1, sess.run(get_next))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -19,11 +19,15 @@ from __future__ import print_function
 
 import gzip
 import os
+import shutil
+import sys
+import time
 import zlib
 
 from tensorflow.contrib.data.python.ops import dataset_ops
 from tensorflow.core.example import example_pb2
 from tensorflow.core.example import feature_pb2
+from tensorflow.python.client import session
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
@@ -233,6 +237,61 @@ class FixedLengthRecordReaderTest(test.TestCase):
                               sess.run(get_next))
 
 
+  def testFixedLengthRecordDatasetBuffer(self):
+    test_filenames = self._createFiles()
+    # Buffers much smaller than a file, and not a multiple of the records.
+    for buffer_size in [0, 1, 4, 1000]:
+      dataset = dataset_ops.FixedLengthRecordDataset(
+          test_filenames, self._record_bytes, self._header_bytes,
+          self._footer_bytes, buffer_size=buffer_size)
+      iterator = dataset.make_one_shot_iterator()
+      get_next = iterator.get_next()
+      with self.test_session() as sess:
+        for j in range(self._num_files):
+          for i in range(self._num_records):
+            self.assertEqual(self._record(j, i), sess.run(get_next))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+
+class LMDBDatasetTest(test.TestCase):
+
+  def setUp(self):
+    super(LMDBDatasetTest, self).setUp()
+    # Copy database out because we need the path to be writable to use locks.
+    path = os.path.join("tensorflow", "core", "lib", "lmdb", "testdata",
+                        "data.mdb")
+    self.db_path = os.path.join(self.get_temp_dir(), "data.mdb")
+    shutil.copy(path, self.db_path)
+
+  def testReadFromFile(self):
+    filenames = array_ops.placeholder(dtypes.string, shape=[None])
+    num_epochs = array_ops.placeholder(dtypes.int64, shape=[])
+    dataset = dataset_ops.LMDBDataset(filenames).repeat(num_epochs)
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    key, value = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op, feed_dict={filenames: [self.db_path, self.db_path],
+                                   num_epochs: 2})
+      for _ in range(4):
+        for i in range(10):
+          k, v = sess.run([key, value])
+          self.assertEqual(compat.as_bytes(str(i)), k)
+          self.assertEqual(compat.as_bytes(str(chr(ord("a") + i))), v)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(key)
+
+  def testMissingFile(self):
+    dataset = dataset_ops.LMDBDataset(
+        os.path.join(self.get_temp_dir(), "missing.mdb"))
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+
+
 class TFRecordDatasetTest(test.TestCase):
 
   def setUp(self):
@@ -366,6 +425,26 @@ class TFRecordDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(self.get_next)
 
+  def testReadWithBuffer(self):
+    buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
+    dataset = dataset_ops.TFRecordDataset(
+        self.filenames, self.compression_type, buffer_size=buffer_size)
+    iterator = dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # A buffer size of 0 reads each record synchronously, and the other
+      # sizes split records across several read-ahead buffers.
+      for buffer_size_val in [0, 1, 10, 1024]:
+        sess.run(iterator.initializer,
+                 feed_dict={self.filenames: self.test_filenames,
+                            buffer_size: buffer_size_val})
+        for j in range(self._num_files):
+          for i in range(self._num_records):
+            self.assertAllEqual(self._record(j, i), sess.run(get_next))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
 
 class ReadBatchFeaturesTest(test.TestCase):
 
@@ -526,6 +605,33 @@ class ReadBatchFeaturesTest(test.TestCase):
             with self.assertRaises(errors.OutOfRangeError):
               self._next_actual_batch(sess)
 
+  def testParseExampleDataset(self):
+    features = {
+        "file": parsing_ops.FixedLenFeature([], dtypes.int64),
+        "record": parsing_ops.FixedLenFeature([], dtypes.int64),
+        "keywords": parsing_ops.VarLenFeature(dtypes.string),
+    }
+    batch_size = 3
+    dataset = (dataset_ops.TFRecordDataset(self.test_filenames)
+               .batch(batch_size)
+               .parse_example(features))
+    iterator = dataset.make_one_shot_iterator()
+    next_element = iterator.get_next()
+
+    with self.test_session() as sess:
+      for expected_batch in self._next_expected_batch(
+          range(self._num_files), batch_size, 1):
+        (file_batch, keywords_indices, keywords_values, keywords_dense_shape,
+         record_batch) = expected_batch
+        actual = sess.run(next_element)
+        self.assertAllEqual(file_batch, actual["file"])
+        self.assertAllEqual(record_batch, actual["record"])
+        self.assertAllEqual(keywords_indices, actual["keywords"][0])
+        self.assertAllEqual(keywords_values, actual["keywords"][1])
+        self.assertAllEqual(keywords_dense_shape, actual["keywords"][2])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
   def testReadWithEquivalentDataset(self):
     # TODO(mrry): Add support for tf.SparseTensor as a Dataset component.
     features = {
@@ -551,5 +657,90 @@ class ReadBatchFeaturesTest(test.TestCase):
         sess.run(next_element)
 
 
+class TFRecordDatasetBenchmark(test.Benchmark):
+
+  def _createFiles(self, num_files, num_records, record_size,
+                   compression_type):
+    options = python_io.TFRecordOptions(compression_type)
+    record = b"x" * record_size
+    filenames = []
+    for i in range(num_files):
+      fn = os.path.join(test.get_temp_dir(),
+                        "tf_record_benchmark.%d.%d" % (compression_type, i))
+      filenames.append(fn)
+      writer = python_io.TFRecordWriter(fn, options=options)
+      for _ in range(num_records):
+        writer.write(record)
+      writer.close()
+    return filenames
+
+  def _runBenchmark(self, dataset, name, record_size, batch_size=100,
+                    num_iters=200):
+    next_element = (dataset.repeat().batch(batch_size)
+                    .make_one_shot_iterator().get_next())
+    with session.Session() as sess:
+      # Warm up the pipeline, e.g. to open the files and fill the buffers.
+      for _ in range(10):
+        sess.run(next_element.op)
+      start = time.time()
+      for _ in range(num_iters):
+        sess.run(next_element.op)
+      wall_time = time.time() - start
+    records_per_second = num_iters * batch_size / wall_time
+    mb_per_second = records_per_second * record_size / 1e6
+    print("Benchmark: %s \t %0.1f records/s \t %0.1f MB/s" %
+          (name, records_per_second, mb_per_second))
+    sys.stdout.flush()
+    self.report_benchmark(
+        iters=num_iters,
+        wall_time=wall_time / num_iters,
+        name=name,
+        extras={
+            "records_per_second": records_per_second,
+            "mb_per_second": mb_per_second
+        })
+
+  def benchmarkTFRecordDataset(self):
+    for record_size in [100, 10000]:
+      for compression_type, compression_name in [
+          (python_io.TFRecordCompressionType.NONE, ""),
+          (python_io.TFRecordCompressionType.ZLIB, "ZLIB"),
+          (python_io.TFRecordCompressionType.GZIP, "GZIP")]:
+        filenames = self._createFiles(4, (4 << 20) // record_size, record_size,
+                                      compression_type)
+        with ops.Graph().as_default():
+          self._runBenchmark(
+              dataset_ops.TFRecordDataset(filenames, compression_name),
+              "tf_record_dataset_%s_record_size_%d" %
+              (compression_name or "NONE", record_size), record_size)
+
+  def benchmarkInterleaveAndMap(self):
+    record_size = 1000
+    filenames = self._createFiles(8, (4 << 20) // record_size, record_size,
+                                  python_io.TFRecordCompressionType.NONE)
+
+    def decode(record):
+      return parsing_ops.decode_raw(record, dtypes.uint8)
+
+    with ops.Graph().as_default():
+      files = dataset_ops.Dataset.from_tensor_slices(filenames)
+      self._runBenchmark(
+          files.interleave(dataset_ops.TFRecordDataset, cycle_length=4),
+          "tf_record_dataset_interleave", record_size)
+    with ops.Graph().as_default():
+      files = dataset_ops.Dataset.from_tensor_slices(filenames)
+      self._runBenchmark(
+          files.parallel_interleave(dataset_ops.TFRecordDataset,
+                                    cycle_length=4),
+          "tf_record_dataset_parallel_interleave", record_size)
+    for num_threads in [1, 4]:
+      with ops.Graph().as_default():
+        dataset = dataset_ops.TFRecordDataset(filenames).map(
+            decode, num_threads=num_threads, output_buffer_size=1000)
+        self._runBenchmark(
+            dataset, "tf_record_dataset_map_num_threads_%d" % num_threads,
+            record_size)
+
+
 if __name__ == "__main__":
   test.main()
@@ -42,6 +42,11 @@ from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.platform import gfile
 
 
+# The value of `num_threads` or `output_buffer_size` in `Dataset.map()` that
+# requests autotuning.
+AUTOTUNE = -1
+
+
 class Iterator(object):
   """Represents the state of iterating through a `Dataset`."""
 
@@ -688,12 +693,14 @@ class Dataset(object):
     dataset = dataset.repeat(num_epochs)
     if randomize_input:
       dataset = dataset.shuffle(capacity)
-    dataset = dataset.map(lambda x: _parse_example(nest.flatten(x), features))
+    # Parse whole batches, so that `tf.parse_example()` can shard the work
+    # across threads and write dense features directly into batch tensors.
     dataset = dataset.batch(batch_size)
+    dataset = dataset.map(lambda x: _parse_example(x, features))
     return dataset
 
   @staticmethod
-  def list_files(file_pattern):
+  def list_files(file_pattern, shuffle=False, seed=None):
     """A dataset of all files matching a pattern.
 
     Example:
@@ -706,14 +713,29 @@ class Dataset(object):
         - /path/to/dir/b.py
         - /path/to/dir/c.py
 
+    Shuffling the files is a cheap way to decorrelate the elements read from
+    sharded inputs, which lets a later `Dataset.shuffle()` use a much smaller
+    (and less memory-hungry) buffer of elements.
+
     Args:
       file_pattern: A string or scalar string `tf.Tensor`, representing
         the filename pattern that will be matched.
+      shuffle: (Optional.) If `True`, the file names are produced in a random
+        order.
+      seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+        random seed used to shuffle the file names. See
+        @{tf.set_random_seed} for behavior.
 
     Returns:
      A `Dataset` of strings corresponding to file names.
     """
-    return Dataset.from_tensor_slices(gen_io_ops.matching_files(file_pattern))
+    filenames = gen_io_ops.matching_files(file_pattern)
+    dataset = Dataset.from_tensor_slices(filenames)
+    if shuffle:
+      # Buffer all of the file names, so that any of them can come first.
+      num_files = math_ops.cast(array_ops.size(filenames), dtypes.int64)
+      dataset = dataset.shuffle(math_ops.maximum(num_files, 1), seed=seed)
+    return dataset
 
   def repeat(self, count=None):
     """Repeats this dataset `count` times.
@@ -772,17 +794,31 @@ class Dataset(object):
     """
     return ShuffleDataset(self, buffer_size, seed)
 
-  def cache(self, filename=""):
+  def cache(self, filename="", memory_budget_bytes=None):
     """Caches the elements in this dataset.
 
     Args:
       filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
         directory on the filesystem to use for caching tensors in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+      memory_budget_bytes: (Optional.) A `tf.int64` scalar `tf.Tensor`. If
+        provided, the elements are cached in memory until they exceed this
+        many bytes, and the remaining elements are spilled to `filename`,
+        which must also be provided. The spilled files are scratch space that
+        only lasts as long as this dataset.
 
     Returns:
       A `Dataset`.
+
+    Raises:
+      ValueError: If `memory_budget_bytes` is provided without a `filename`.
     """
+    if memory_budget_bytes is not None:
+      if isinstance(filename, str) and not filename:
+        raise ValueError(
+            "A `filename` is required to spill elements that do not fit in "
+            "`memory_budget_bytes`.")
+      return TieredCacheDataset(self, filename, memory_budget_bytes)
     return CacheDataset(self, filename)
 
   def take(self, count):
@@ -814,6 +850,22 @@ class Dataset(object):
     """
     return SkipDataset(self, count)
 
+  def prefetch(self, buffer_size):
+    """Creates a `Dataset` that prefetches elements from this dataset.
+
+    Each iterator over the new dataset reads elements from this dataset on a
+    background thread, ahead of the consumer, so that input preprocessing
+    overlaps with the computation that consumes its elements.
+
+    Args:
+      buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the
+        maximum number of elements that will be buffered when prefetching.
+
+    Returns:
+      A `Dataset`.
+    """
+    return PrefetchDataset(self, buffer_size)
+
   def ignore_errors(self):
     """Creates a `Dataset` from this one and silently ignores any errors.
 
@@ -953,16 +1005,80 @@ class Dataset(object):
       num_threads: (Optional.) A `tf.int32` scalar `tf.Tensor`, representing
         the number of threads to use for processing elements in parallel. If
         not specified, elements will be processed sequentially without
-        buffering.
+        buffering. If `tf.contrib.data.AUTOTUNE`, the number of threads is
+        adjusted at runtime from the time that the consumer spends waiting
+        for elements, within a thread budget shared by all autotuned
+        datasets in the process.
       output_buffer_size: (Optional.) A `tf.int64` scalar `tf.Tensor`,
         representing the maximum number of processed elements that will be
-        buffered when processing in parallel.
+        buffered when processing in parallel. If `tf.contrib.data.AUTOTUNE`
+        (the default when `num_threads` is autotuned), the buffer holds twice
+        as many elements as there are active threads.
 
     Returns:
       A `Dataset`.
     """
     return MapDataset(self, map_func, num_threads, output_buffer_size)
 
+  def map_and_batch(self, map_func, batch_size, num_threads=1):
+    """Maps `map_func` across this dataset and batches the results.
+
+    This is equivalent to `dataset.map(map_func).batch(batch_size)`, but
+    `map_func` is applied to the elements of each batch in parallel, and
+    each result is copied directly into its slice of the batch.
+
+    Args:
+      map_func: A function mapping a nested structure of tensors (having
+        shapes and types defined by `self.output_shapes` and
+       `self.output_types`) to another nested structure of tensors.
+      batch_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
+        consecutive elements of this dataset to combine in a single batch.
+      num_threads: (Optional.) A `tf.int32` scalar `tf.Tensor`, representing
+        the number of threads to use for processing the elements of a batch
+        in parallel. Defaults to 1.
+
+    Returns:
+      A `Dataset`.
+    """
+    return MapAndBatchDataset(self, map_func, batch_size, num_threads)
+
+  def parse_example(self, features):
+    """Parses batches of serialized `Example` protos in this dataset.
+
+    Each element of this dataset must be a `tf.string` vector of serialized
+    `Example` protos, such as the output of `Dataset.batch()`. Parsing a whole
+    batch at once lets the fast example parser shard the batch across threads
+    and write each dense feature directly into its batch tensor, which is much
+    cheaper than calling `tf.parse_single_example()` per element and then
+    batching the results:
+
+    ```python
+    dataset = (tf.contrib.data.TFRecordDataset(filenames)
+               .batch(batch_size)
+               .parse_example(features))
+    ```
+
+    Args:
+      features: A `dict` mapping feature keys to `FixedLenFeature` or
+        `VarLenFeature` values. See `tf.parse_example`.
+
+    Returns:
+      A `Dataset` of `dict`s mapping each key in `features` to a `tf.Tensor`
+      for a `FixedLenFeature`, or to an `(indices, values, dense_shape)` tuple
+      of `tf.Tensor`s for a `VarLenFeature`.
+    """
+    def _parse(serialized):
+      parsed = parsing_ops.parse_example(serialized, features)
+      result = {}
+      for key, val in parsed.items():
+        if isinstance(val, sparse_tensor_lib.SparseTensor):
+          result[key] = (val.indices, val.values, val.dense_shape)
+        else:
+          result[key] = val
+      return result
+
+    return self.map(_parse)
+
   def flat_map(self, map_func):
     """Maps `map_func` across this dataset and flattens the result.
 
@@ -1040,6 +1156,36 @@ class Dataset(object):
     """
     return InterleaveDataset(self, map_func, cycle_length, block_length)
 
+  def parallel_interleave(self, map_func, cycle_length, block_length=1,
+                          sloppy=False, buffer_output_elements=None):
+    """Maps `map_func` across this dataset, and interleaves the results.
+
+    Like `Dataset.interleave()`, but each of the `cycle_length` open input
+    elements is read by its own thread into a buffer, so that slow sources
+    (such as files on remote storage) are read concurrently.
+
+    Args:
+      map_func: A function mapping a nested structure of tensors (having shapes
+        and types defined by `self.output_shapes` and `self.output_types`) to a
+        `Dataset`.
+      cycle_length: The number of elements from this dataset that will be
+        processed concurrently.
+      block_length: The number of consecutive elements to produce from each
+        input element before cycling to another input element.
+      sloppy: (Optional.) If `False`, elements are produced in the same
+        deterministic order as `Dataset.interleave()`. If `True`, elements are
+        produced in the order in which they become ready, which can reduce
+        the time spent waiting for a slow input element.
+      buffer_output_elements: (Optional.) The maximum number of elements to
+        buffer for each open input element. Defaults to `2 * block_length`.
+
+    Returns:
+      A `Dataset`.
+    """
+    return ParallelInterleaveDataset(self, map_func, cycle_length,
+                                     block_length, sloppy,
+                                     buffer_output_elements)
+
   def unbatch(self):
     """Splits elements of this dataset into sequences of consecutive elements.
 
@@ -1338,6 +1484,24 @@ class CacheDataset(Dataset):
     return self._input_dataset.output_types
 
 
+class TieredCacheDataset(CacheDataset):
+  """A `Dataset` that caches elements of its input in memory and on disk."""
+
+  def __init__(self, input_dataset, filename, memory_budget_bytes):
+    """See `Dataset.cache()` for details."""
+    super(TieredCacheDataset, self).__init__(input_dataset, filename)
+    self._memory_budget_bytes = ops.convert_to_tensor(
+        memory_budget_bytes, dtype=dtypes.int64, name="memory_budget_bytes")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.tiered_cache_dataset(
+        self._input_dataset.make_dataset_resource(),
+        filename=self._filename,
+        memory_budget_bytes=self._memory_budget_bytes,
+        output_shapes=nest.flatten(self.output_shapes),
+        output_types=nest.flatten(self.output_types))
+
+
 class ShuffleDataset(Dataset):
   """A `Dataset` that randomly shuffles the elements of its input."""
 
@@ -1426,6 +1590,32 @@ class SkipDataset(Dataset):
     return self._input_dataset.output_types
 
 
+class PrefetchDataset(Dataset):
+  """A `Dataset` that asynchronously prefetches its input."""
+
+  def __init__(self, input_dataset, buffer_size):
+    """See `Dataset.prefetch()` for details."""
+    super(PrefetchDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.prefetch_dataset(
+        self._input_dataset.make_dataset_resource(),
+        buffer_size=self._buffer_size,
+        output_shapes=nest.flatten(self.output_shapes),
+        output_types=nest.flatten(self.output_types))
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
 class IgnoreErrorsDataset(Dataset):
   """A `Dataset` that silently ignores errors when computing its input."""
 
@@ -1774,6 +1964,35 @@ class MapDataset(Dataset):
     return self._output_types
 
 
+class MapAndBatchDataset(MapDataset):
+  """A `Dataset` that maps a function over its input and batches the results."""
+
+  def __init__(self, input_dataset, map_func, batch_size, num_threads=1):
+    """See `Dataset.map_and_batch()` for details."""
+    super(MapAndBatchDataset, self).__init__(input_dataset, map_func)
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    self._num_threads = ops.convert_to_tensor(
+        num_threads, dtype=dtypes.int32, name="num_threads")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.map_and_batch_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._map_func.captured_inputs,
+        f=self._map_func,
+        batch_size=self._batch_size,
+        num_threads=self._num_threads,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_shapes(self):
+    return nest.pack_sequence_as(self._output_shapes, [
+        tensor_shape.vector(None).concatenate(s)
+        for s in nest.flatten(self._output_shapes)
+    ])
+
+
 class FlatMapDataset(Dataset):
   """A `Dataset` that maps a function over its input and flattens the result."""
 
@@ -1883,6 +2102,41 @@ class InterleaveDataset(Dataset):
     return self._output_types
 
 
+class ParallelInterleaveDataset(InterleaveDataset):
+  """A `Dataset` that reads and interleaves its inputs in parallel."""
+
+  def __init__(self,
+               input_dataset,
+               map_func,
+               cycle_length,
+               block_length,
+               sloppy,
+               buffer_output_elements):
+    """See `Dataset.parallel_interleave()` for details."""
+    super(ParallelInterleaveDataset, self).__init__(input_dataset, map_func,
+                                                    cycle_length, block_length)
+    self._sloppy = ops.convert_to_tensor(
+        sloppy, dtype=dtypes.bool, name="sloppy")
+    if buffer_output_elements is None:
+      self._buffer_output_elements = 2 * self._block_length
+    else:
+      self._buffer_output_elements = ops.convert_to_tensor(
+          buffer_output_elements, dtype=dtypes.int64,
+          name="buffer_output_elements")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.parallel_interleave_dataset(
+        self._input_dataset.make_dataset_resource(),
+        self._map_func.captured_inputs,
+        self._cycle_length,
+        self._block_length,
+        self._sloppy,
+        self._buffer_output_elements,
+        f=self._map_func,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+
 class FilterDataset(Dataset):
   """A `Dataset` that filters its input according to a predicate function."""
 
@@ -1965,16 +2219,23 @@ class TextLineDataset(Dataset):
     return dtypes.string
 
 
+_DEFAULT_TF_RECORD_BUFFER_SIZE_BYTES = 256 * 1024
+
+
 class TFRecordDataset(Dataset):
   """A `Dataset` comprising records from one or more TFRecord files."""
 
-  def __init__(self, filenames, compression_type=None):
+  def __init__(self, filenames, compression_type=None, buffer_size=None):
     """Creates a `TFRecordDataset`.
 
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
       compression_type: A `tf.string` scalar evaluating to one of `""` (no
         compression), `"ZLIB"`, or `"GZIP"`.
+      buffer_size: (Optional.) A `tf.int64` scalar representing the number of
+        bytes in each of the buffers that are read ahead of the current
+        record in the background, which hides the latency of remote file
+        systems such as GCS. 0 disables read-ahead. Defaults to 256KB.
     """
     super(TFRecordDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(filenames, name="filenames")
@@ -1983,10 +2244,18 @@ class TFRecordDataset(Dataset):
           compression_type, dtype=dtypes.string, name="compression_type")
     else:
       self._compression_type = constant_op.constant("", name="compression_type")
+    if buffer_size is not None:
+      self._buffer_size = ops.convert_to_tensor(
+          buffer_size, dtype=dtypes.int64, name="buffer_size")
+    else:
+      self._buffer_size = constant_op.constant(
+          _DEFAULT_TF_RECORD_BUFFER_SIZE_BYTES, dtype=dtypes.int64,
+          name="buffer_size")
 
   def make_dataset_resource(self):
     return gen_dataset_ops.tf_record_dataset(self._filenames,
-                                             self._compression_type)
+                                             self._compression_type,
+                                             self._buffer_size)
 
   @property
   def output_shapes(self):
@@ -1997,6 +2266,9 @@ class TFRecordDataset(Dataset):
     return dtypes.string
 
 
+_DEFAULT_FIXED_LENGTH_RECORD_BUFFER_SIZE_BYTES = 256 * 1024
+
+
 class FixedLengthRecordDataset(Dataset):
   """A `Dataset` of fixed-length records from one or more binary files."""
 
@@ -2004,7 +2276,8 @@ class FixedLengthRecordDataset(Dataset):
                filenames,
                record_bytes,
                header_bytes=None,
-               footer_bytes=None):
+               footer_bytes=None,
+               buffer_size=None):
     """Creates a `FixedLengthRecordDataset`.
 
     Args:
@@ -2015,6 +2288,9 @@ class FixedLengthRecordDataset(Dataset):
         bytes to skip at the start of a file.
       footer_bytes: (Optional.) A `tf.int64` scalar representing the number of
         bytes to ignore at the end of a file.
+      buffer_size: (Optional.) A `tf.int64` scalar representing the number of
+        bytes in each of the large sequential reads that are issued ahead of
+        the current record. 0 disables read-ahead. Defaults to 256KB.
     """
     super(FixedLengthRecordDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(
@@ -2033,11 +2309,18 @@ class FixedLengthRecordDataset(Dataset):
     else:
       self._footer_bytes = constant_op.constant(
           0, dtype=dtypes.int64, name="footer_bytes")
+    if buffer_size is not None:
+      self._buffer_size = ops.convert_to_tensor(
+          buffer_size, dtype=dtypes.int64, name="buffer_size")
+    else:
+      self._buffer_size = constant_op.constant(
+          _DEFAULT_FIXED_LENGTH_RECORD_BUFFER_SIZE_BYTES, dtype=dtypes.int64,
+          name="buffer_size")
 
   def make_dataset_resource(self):
     return gen_dataset_ops.fixed_length_record_dataset(
         self._filenames, self._header_bytes, self._record_bytes,
-        self._footer_bytes)
+        self._footer_bytes, self._buffer_size)
 
   @property
   def output_shapes(self):
@@ -2048,6 +2331,35 @@ class FixedLengthRecordDataset(Dataset):
     return dtypes.string
 
 
+class LMDBDataset(Dataset):
+  """A `Dataset` of (key, value) pairs from one or more LMDB databases."""
+
+  def __init__(self, filenames):
+    """Creates an `LMDBDataset`.
+
+    The records of each database are read in key order. To read several
+    databases in parallel, interleave one `LMDBDataset` per file.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames of
+        LMDB environment directories or files.
+    """
+    super(LMDBDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+
+  def make_dataset_resource(self):
+    return gen_dataset_ops.lmdb_dataset(self._filenames)
+
+  @property
+  def output_shapes(self):
+    return (tensor_shape.scalar(), tensor_shape.scalar())
+
+  @property
+  def output_types(self):
+    return (dtypes.string, dtypes.string)
+
+
 def rejection_resample(dataset,
                        class_func,
                        target_dist,
@@ -17,21 +17,20 @@
 // TODO(agarwal,rmlarsen): Add security checks to the code.
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <numeric>
 #include <vector>
 
-// This is only used for std::this_thread::get_id()
-#include <thread>  // NOLINT
-
+#include "third_party/eigen3/Eigen/Cholesky"
+#include "third_party/eigen3/Eigen/LU"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
-#include "tensorflow/core/lib/core/threadpool.h"
-#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 using tensorflow::DEVICE_CPU;
 using tensorflow::DT_BOOL;
@@ -57,6 +56,9 @@ typedef Eigen::Map<
 typedef Eigen::Map<
     const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>>
     ConstEigenMatrixFloatMap;
+typedef Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor>>
+    ConstEigenRowMajorMatrixFloatMap;
 
 class WALSComputePartialLhsAndRhsOp : public OpKernel {
  public:
@@ -141,8 +143,8 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     std::vector<int64> perm(num_nonzero_elements);
     std::iota(perm.begin(), perm.end(), 0);
 
-    typedef std::pair<int64, int64> Shard;
-    std::vector<Shard> shards;
+    typedef std::pair<int64, int64> Segment;
+    std::vector<Segment> segments;
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     int64 shard_total = 0;
     // Compute a permutation such that get_input_index(perm[i]) is sorted, use
@@ -153,7 +155,7 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
                      });
 
     // Compute the start and end of runs with identical input_index.
-    // These are the shards of work that can be processed in parallel
+    // These are the segments of work that can be processed in parallel
     // without locking.
     int64 start = 0;
     int64 end = 0;
@@ -163,56 +165,24 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
              get_input_index(perm[start]) == get_input_index(perm[end])) {
         ++end;
       }
-      shards.emplace_back(start, end);
+      segments.emplace_back(start, end);
       shard_total += end - start;
     }
     CHECK_EQ(shard_total, num_nonzero_elements);
-    CHECK_LE(shards.size(), num_nonzero_elements);
-    CHECK_GT(shards.size(), 0);
+    CHECK_LE(segments.size(), num_nonzero_elements);
+    CHECK_GT(segments.size(), 0);
 
     // Batch the rank-one updates into a rank-k update to lower memory traffic
     const int kMaxBatchSize = 128;
 
-    // Since we do not have an easy way of generating thread id's within the
-    // range [0,num_threads), we can instead call out to an std::unordered_map
-    // of matrices and initialize the matrix on the first call.
-    // However, this might have a performance penalty, as memory allocation can
-    // cause the OS kernel to enter a critical section and temporarily disable
-    // parallelism, and the unordered_map must be protected with a read/write
-    // mutex.
-    //
-    // TODO(jpoulson): Simplify after the thread rank can be queried
-    std::unordered_map<size_t, Eigen::MatrixXf> factor_batch_map;
-    mutex map_mutex;
-
-    BlockingCounter counter(shards.size());
-    // Lambda encapsulating the per-shard computation.
-    auto work = [&](const Shard& shard) {
-      const std::thread::id thread_id = std::this_thread::get_id();
-      const size_t id_hash = std::hash<std::thread::id>()(thread_id);
-      // If this thread's unique factors_mat.rows() x kMaxBatchSize
-      // batching matrix has not yet been created, then emplace it into the
-      // map using the hash of the thread id as the key.
-      //
-      // TODO(jpoulson): Switch to try_emplace once C++17 is supported
-      map_mutex.lock();
-      const auto key_count = factor_batch_map.count(id_hash);
-      map_mutex.unlock();
-      if (!key_count) {
-        map_mutex.lock();
-        factor_batch_map.emplace(
-            std::piecewise_construct, std::forward_as_tuple(id_hash),
-            std::forward_as_tuple(factors_mat.rows(), kMaxBatchSize));
-        map_mutex.unlock();
-      }
-      map_mutex.lock();
-      auto& factor_batch = factor_batch_map[id_hash];
-      map_mutex.unlock();
-
-      CHECK_GE(shard.first, 0);
-      CHECK_LE(shard.second, perm.size());
-      CHECK_LE(shard.first, shard.second);
-      const int64 input_index = get_input_index(perm[shard.first]);
+    // Lambda encapsulating the per-segment computation. factor_batch is a
+    // factors_mat.rows() x kMaxBatchSize scratch matrix owned by the caller.
+    auto work = [&](const Segment& segment, Eigen::MatrixXf* factor_batch_ptr) {
+      Eigen::MatrixXf& factor_batch = *factor_batch_ptr;
+      CHECK_GE(segment.first, 0);
+      CHECK_LE(segment.second, perm.size());
+      CHECK_LE(segment.first, segment.second);
+      const int64 input_index = get_input_index(perm[segment.first]);
       // Accumulate the rhs and lhs terms in the normal equations
       // for the non-zero elements in the row or column of the sparse matrix
       // corresponding to input_index.
@@ -221,9 +191,9 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
                                       input_index * factor_dim * factor_dim,
                                   factor_dim, factor_dim);
       auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
-      for (int64 p = shard.first; p < shard.second; ++p) {
+      for (int64 p = segment.first; p < segment.second; ++p) {
         const int64 i = perm[p];
-        // Check that all entries in the shard have the same input index.
+        // Check that all entries in the segment have the same input index.
         CHECK_EQ(input_index, get_input_index(i));
         const int64 factor_index = get_factor_index(i);
         const float input_value = input_values_vec(i);
@@ -249,18 +219,234 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
       // Copy lower triangular to upper triangular part of normal equation
       // matrix.
       lhs_mat = lhs_symm;
-      counter.DecrementCount();
     };
-    for (size_t i = 1; i < shards.size(); ++i) {
-      worker_threads.workers->Schedule(std::bind(work, shards[i]));
-    }
-    // Inline execute the 1st shard.
-    work(shards[0]);
-    counter.Wait();
+    // Hand contiguous ranges of segments to the workers rather than one
+    // closure per segment, so that the scheduling overhead and the scratch
+    // matrix are amortized over many rows. The work is split over the
+    // non-zero elements, which balances it even when some rows are much
+    // denser than others; a range processes the segments starting in it.
+    auto work_range = [&](int64 begin, int64 end) {
+      auto segment_starts_before = [](const Segment& segment, int64 p) {
+        return segment.first < p;
+      };
+      auto first = std::lower_bound(segments.begin(), segments.end(), begin,
+                                    segment_starts_before);
+      auto last = std::lower_bound(first, segments.end(), end,
+                                   segment_starts_before);
+      Eigen::MatrixXf factor_batch(factors_mat.rows(), kMaxBatchSize);
+      for (auto it = first; it != last; ++it) {
+        work(*it, &factor_batch);
+      }
+    };
+    // Each non-zero element costs one column of a rank-k update.
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_nonzero_elements, factor_dim * factor_dim, work_range);
   }
 };
 
 REGISTER_KERNEL_BUILDER(Name("WALSComputePartialLhsAndRhs").Device(DEVICE_CPU),
                         WALSComputePartialLhsAndRhsOp);
 
+class WALSSolveNormalEquationsOp : public OpKernel {
+ public:
+  explicit WALSSolveNormalEquationsOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context,
+                   context->MatchSignature({DT_FLOAT, DT_FLOAT}, {DT_FLOAT}));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& lhs = context->input(0);
+    const Tensor& rhs = context->input(1);
+    OP_REQUIRES(context, lhs.dims() == 3,
+                InvalidArgument("Input lhs should be a 3-D tensor."));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(rhs.shape()),
+                InvalidArgument("Input rhs should be a matrix."));
+    const int64 num_rows = lhs.dim_size(0);
+    const int64 k = lhs.dim_size(1);
+    OP_REQUIRES(context, lhs.dim_size(2) == k,
+                InvalidArgument("Input lhs should hold square matrices."));
+    OP_REQUIRES(context, rhs.dim_size(0) == num_rows && rhs.dim_size(1) == k,
+                InvalidArgument("Input rhs should have size ", num_rows, " x ",
+                                k, ", got ", rhs.shape().DebugString()));
+
+    Tensor* solution;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, rhs.shape(), &solution));
+    if (num_rows == 0 || k == 0) return;
+
+    const float* lhs_data = lhs.flat<float>().data();
+    const float* rhs_data = rhs.flat<float>().data();
+    float* solution_data = solution->flat<float>().data();
+    std::atomic<bool> not_invertible(false);
+    // Solves row i with a partially pivoted LU factorization, as
+    // tf.matrix_solve does.
+    auto solve_lu = [&](int64 i) {
+      ConstEigenRowMajorMatrixFloatMap matrix(lhs_data + i * k * k, k, k);
+      Eigen::PartialPivLU<Eigen::MatrixXf> lu(matrix);
+      if (!(lu.matrixLU().diagonal().cwiseAbs().minCoeff() > 0)) {
+        not_invertible = true;
+        return;
+      }
+      Eigen::Map<Eigen::VectorXf>(solution_data + i * k, k) =
+          lu.solve(Eigen::Map<const Eigen::VectorXf>(rhs_data + i * k, k));
+    };
+
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    if (k > kMaxInterleavedDim) {
+      // Large systems are solved one at a time, with Eigen's blocked
+      // Cholesky factorization.
+      auto work = [&](int64 begin, int64 end) {
+        for (int64 i = begin; i < end; ++i) {
+          ConstEigenRowMajorMatrixFloatMap matrix(lhs_data + i * k * k, k, k);
+          Eigen::LLT<Eigen::MatrixXf> llt(matrix);
+          if (llt.info() != Eigen::Success) {
+            solve_lu(i);
+            continue;
+          }
+          Eigen::Map<Eigen::VectorXf>(solution_data + i * k, k) =
+              llt.solve(Eigen::Map<const Eigen::VectorXf>(rhs_data + i * k, k));
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            k * k * k, work);
+    } else {
+      // Small systems are solved kLanes at a time. The scratch space holds
+      // the matrices and vectors of a group interleaved element by element,
+      // so that the innermost loops run over the group and vectorize.
+      const int64 num_groups = (num_rows + kLanes - 1) / kLanes;
+      auto work = [&](int64 begin, int64 end) {
+        std::vector<float> a(k * k * kLanes);
+        std::vector<float> x(k * kLanes);
+        std::vector<float> inv_diag(k * kLanes);
+        for (int64 g = begin; g < end; ++g) {
+          const int64 first_row = g * kLanes;
+          const int num_lanes =
+              static_cast<int>(std::min<int64>(kLanes, num_rows - first_row));
+          bool positive_definite[kLanes];
+          InterleaveGroup(lhs_data, rhs_data, k, first_row, num_lanes,
+                          a.data(), x.data());
+          CholeskySolveInterleaved(k, a.data(), x.data(), inv_diag.data(),
+                                   positive_definite);
+          for (int l = 0; l < num_lanes; ++l) {
+            const int64 i = first_row + l;
+            if (!positive_definite[l]) {
+              solve_lu(i);
+              continue;
+            }
+            for (int64 r = 0; r < k; ++r) {
+              solution_data[i * k + r] = x[r * kLanes + l];
+            }
+          }
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_groups,
+            kLanes * k * k * k, work);
+    }
+    OP_REQUIRES(context, !not_invertible,
+                InvalidArgument("Input matrix is not invertible."));
+  }
+
+ private:
+  // The width of the interleaved groups: one AVX register of floats.
+  static constexpr int kLanes = 8;
+  // Larger systems do not fit the interleaved factorization in the L1 cache.
+  static constexpr int64 kMaxInterleavedDim = 32;
+
+  // Copies the lower triangles of the lhs matrices and the rhs vectors of
+  // rows [first_row, first_row + num_lanes) into the interleaved layout of
+  // a and x: element (r, c) of lane l goes to a[(r * k + c) * kLanes + l].
+  // Unused lanes get the identity matrix, which keeps them finite.
+  static void InterleaveGroup(const float* lhs_data, const float* rhs_data,
+                              int64 k, int64 first_row, int num_lanes,
+                              float* a, float* x) {
+    for (int64 r = 0; r < k; ++r) {
+      for (int64 c = 0; c <= r; ++c) {
+        float* dst = a + (r * k + c) * kLanes;
+        for (int l = 0; l < kLanes; ++l) {
+          dst[l] = l < num_lanes
+                       ? lhs_data[((first_row + l) * k + r) * k + c]
+                       : (r == c ? 1.0f : 0.0f);
+        }
+      }
+      for (int l = 0; l < kLanes; ++l) {
+        x[r * kLanes + l] =
+            l < num_lanes ? rhs_data[(first_row + l) * k + r] : 0.0f;
+      }
+    }
+  }
+
+  // Factors the interleaved matrices in a into L * L^T in place, then
+  // overwrites x with the solutions. positive_definite[l] is set to false
+  // for the lanes whose matrix is not positive definite, whose solutions
+  // are then meaningless.
+  static void CholeskySolveInterleaved(int64 k, float* a, float* x,
+                                       float* inv_diag,
+                                       bool* positive_definite) {
+    for (int l = 0; l < kLanes; ++l) positive_definite[l] = true;
+    auto at = [a, k](int64 r, int64 c) { return a + (r * k + c) * kLanes; };
+    float acc[kLanes];
+    for (int64 j = 0; j < k; ++j) {
+      // Diagonal element of column j.
+      const float* a_jj = at(j, j);
+      for (int l = 0; l < kLanes; ++l) acc[l] = a_jj[l];
+      for (int64 p = 0; p < j; ++p) {
+        const float* a_jp = at(j, p);
+        for (int l = 0; l < kLanes; ++l) acc[l] -= a_jp[l] * a_jp[l];
+      }
+      float* l_jj = at(j, j);
+      float* inv_jj = inv_diag + j * kLanes;
+      for (int l = 0; l < kLanes; ++l) {
+        // Negated to also catch NaNs.
+        if (!(acc[l] > 0.0f)) {
+          positive_definite[l] = false;
+          acc[l] = 1.0f;
+        }
+        l_jj[l] = std::sqrt(acc[l]);
+        inv_jj[l] = 1.0f / l_jj[l];
+      }
+      // Below-diagonal elements of column j.
+      for (int64 i = j + 1; i < k; ++i) {
+        const float* a_ij = at(i, j);
+        for (int l = 0; l < kLanes; ++l) acc[l] = a_ij[l];
+        for (int64 p = 0; p < j; ++p) {
+          const float* a_ip = at(i, p);
+          const float* a_jp = at(j, p);
+          for (int l = 0; l < kLanes; ++l) acc[l] -= a_ip[l] * a_jp[l];
+        }
+        float* l_ij = at(i, j);
+        for (int l = 0; l < kLanes; ++l) l_ij[l] = acc[l] * inv_jj[l];
+      }
+    }
+    // Forward substitution, L * y = x.
+    for (int64 i = 0; i < k; ++i) {
+      float* x_i = x + i * kLanes;
+      for (int64 p = 0; p < i; ++p) {
+        const float* l_ip = at(i, p);
+        const float* y_p = x + p * kLanes;
+        for (int l = 0; l < kLanes; ++l) x_i[l] -= l_ip[l] * y_p[l];
+      }
+      const float* inv_ii = inv_diag + i * kLanes;
+      for (int l = 0; l < kLanes; ++l) x_i[l] *= inv_ii[l];
+    }
+    // Back substitution, L^T * x = y.
+    for (int64 i = k - 1; i >= 0; --i) {
+      float* x_i = x + i * kLanes;
+      for (int64 p = i + 1; p < k; ++p) {
+        const float* l_pi = at(p, i);
+        const float* x_p = x + p * kLanes;
+        for (int l = 0; l < kLanes; ++l) x_i[l] -= l_pi[l] * x_p[l];
+      }
+      const float* inv_ii = inv_diag + i * kLanes;
+      for (int l = 0; l < kLanes; ++l) x_i[l] *= inv_ii[l];
+    }
+  }
+};
+
+constexpr int WALSSolveNormalEquationsOp::kLanes;
+constexpr int64 WALSSolveNormalEquationsOp::kMaxInterleavedDim;
+
+REGISTER_KERNEL_BUILDER(Name("WALSSolveNormalEquations").Device(DEVICE_CPU),
+                        WALSSolveNormalEquationsOp);
+
 }  // namespace tensorflow
@@ -45,6 +45,32 @@ partial_lhs: 3-D tensor with size input_block_size x k x k.
 partial_rhs: Matrix with size input_block_size x k.
 )");
 
+REGISTER_OP("WALSSolveNormalEquations")
+    .Input("lhs: float32")
+    .Input("rhs: float32")
+    .Output("solution: float32")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle lhs;
+      shape_inference::ShapeHandle rhs;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &lhs));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &rhs));
+      c->set_output(0, rhs);
+      return Status::OK();
+    })
+    .Doc(R"(
+Solves the normal equations of a WALS update for a batch of rows.
+
+Solves lhs[i] * solution[i] = rhs[i] for each i. The lhs matrices are expected
+to be symmetric positive definite, as the normal equations built from
+WALSComputePartialLhsAndRhs are, and are solved with a Cholesky factorization.
+Matrices that turn out not to be positive definite are solved with a partially
+pivoted LU factorization instead.
+
+lhs: 3-D tensor with size n x k x k. Only the lower triangles are read.
+rhs: Matrix with size n x k.
+solution: Matrix with size n x k.
+)");
+
 REGISTER_OP("MaskedMatmul")
     .Input("a: float32")
     .Input("b: float32")
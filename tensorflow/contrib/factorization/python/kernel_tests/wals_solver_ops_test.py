@@ -78,6 +78,40 @@ class WalsSolverOpsTest(test.TestCase):
                                               [0.160400, 0.220000, 0.279600],
                                               [0.492800, 0.563200, 0.633600]])
 
+  def _verifySolveNormalEquations(self, lhs, rhs):
+    expected = np.linalg.solve(lhs, rhs[:, :, np.newaxis])[:, :, 0]
+    with self.test_session():
+      solution = gen_factorization_ops.wals_solve_normal_equations(lhs, rhs)
+      self.assertAllClose(solution.eval(), expected, rtol=1e-4, atol=1e-4)
+
+  def testWalsSolveNormalEquations(self):
+    np.random.seed(0)
+    # Small systems are solved in interleaved groups of 8, large ones one at
+    # a time; 19 rows leave a partial group.
+    for k in [1, 3, 32, 40]:
+      factors = np.random.randn(19, k, k).astype(np.float32)
+      lhs = (np.matmul(factors, np.transpose(factors, [0, 2, 1])) +
+             np.eye(k, dtype=np.float32))
+      rhs = np.random.randn(19, k).astype(np.float32)
+      self._verifySolveNormalEquations(lhs, rhs)
+
+  def testWalsSolveNormalEquationsNotPositiveDefinite(self):
+    # Invertible matrices that are not positive definite fall back to the LU
+    # factorization.
+    for k in [3, 40]:
+      lhs = np.tile(np.eye(k, dtype=np.float32), [5, 1, 1])
+      lhs[2, 0, 0] = -2.0
+      lhs[3, 0, 1] = lhs[3, 1, 0] = 3.0
+      rhs = np.random.randn(5, k).astype(np.float32)
+      self._verifySolveNormalEquations(lhs, rhs)
+
+  def testWalsSolveNormalEquationsNotInvertible(self):
+    lhs = np.zeros([2, 3, 3], dtype=np.float32)
+    rhs = np.ones([2, 3], dtype=np.float32)
+    with self.test_session():
+      with self.assertRaisesOpError("Input matrix is not invertible."):
+        gen_factorization_ops.wals_solve_normal_equations(lhs, rhs).eval()
+
 
 if __name__ == "__main__":
   test.main()
@@ -922,9 +922,8 @@ class WALSModel(object):
               transpose_input,
               name="wals_compute_partial_lhs_rhs"))
       total_lhs = array_ops.expand_dims(total_lhs, 0) + partial_lhs
-      total_rhs = array_ops.expand_dims(total_rhs, -1)
-      new_left_values = array_ops.squeeze(
-          linalg_ops.matrix_solve(total_lhs, total_rhs), [2])
+      new_left_values = gen_factorization_ops.wals_solve_normal_equations(
+          total_lhs, total_rhs, name="wals_solve_normal_equations")
 
     update_op_name = "row_update" if update_row_factors else "col_update"
     update_op = self.scatter_update(
@@ -300,6 +300,33 @@ class MutableHashTableOpTest(test.TestCase):
       self.assertAllEqual([b"brain", b"salad", b"surgery"], sorted_keys)
       self.assertAllEqual([0, 1, 2], sorted_values)
 
+  def testMutableHashTableLargeBatch(self):
+    # Large enough for the batch to be split over several shards and threads.
+    num_keys = 20000
+    with self.test_session():
+      keys = np.arange(num_keys, dtype=np.int64)
+      table = lookup.MutableHashTable(dtypes.int64, dtypes.int64, -1)
+      table.insert(
+          constant_op.constant(keys), constant_op.constant(keys * 2)).run()
+      # Repeated keys in one batch: the last occurrence wins.
+      table.insert(
+          constant_op.constant([7, 7, 7], dtypes.int64),
+          constant_op.constant([1, 2, 3], dtypes.int64)).run()
+      self.assertAllEqual(num_keys, table.size().eval())
+
+      expected = keys * 2
+      expected[7] = 3
+      query = np.concatenate([keys, [-5, num_keys]])
+      result = table.lookup(constant_op.constant(query)).eval()
+      self.assertAllEqual(np.concatenate([expected, [-1, -1]]), result)
+
+      exported_keys, exported_values = table.export()
+      exported_keys, exported_values = (exported_keys.eval(),
+                                        exported_values.eval())
+      order = np.argsort(exported_keys)
+      self.assertAllEqual(keys, exported_keys[order])
+      self.assertAllEqual(expected, exported_values[order])
+
   def testSaveRestore(self):
     save_dir = os.path.join(self.get_temp_dir(), "save_restore")
     save_path = os.path.join(tempfile.mkdtemp(prefix=save_dir), "hash")
@@ -713,6 +740,23 @@ class MutableDenseHashTableOpTest(test.TestCase):
       result = output.eval()
       self.assertAllEqual([0, 1, -1], result)
 
+  def testLargeBatchLookup(self):
+    num_keys = 20000
+    with self.test_session():
+      keys = np.arange(1, num_keys + 1, dtype=np.int64)
+      table = lookup.MutableDenseHashTable(
+          dtypes.int64, dtypes.int64, default_value=-1, empty_key=0)
+      table.insert(
+          constant_op.constant(keys), constant_op.constant(keys * 3)).run()
+      self.assertAllEqual(num_keys, table.size().eval())
+
+      query = np.concatenate([keys, [num_keys + 1]])
+      result = table.lookup(constant_op.constant(query)).eval()
+      self.assertAllEqual(np.concatenate([keys * 3, [-1]]), result)
+
+      with self.assertRaisesOpError("empty_key"):
+        table.lookup(constant_op.constant(np.concatenate([keys, [0]]))).eval()
+
   def testBasicBool(self):
     with self.test_session():
       keys = constant_op.constant([11, 12, 13], dtypes.int64)
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/contrib/mpi/mpi_rendezvous_mgr.h"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -29,11 +30,35 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Tensors smaller than this are always serialized together with their
+// description.
+const size_t kMinSeparateTransferBytes = 1024;
+
+// Returns the number of progress threads requested by the
+// MPI_PROGRESS_THREADS environment variable.
+int NumProgressThreads() {
+  int32 num_threads = 4;
+  const char* env = getenv("MPI_PROGRESS_THREADS");
+  if (env != nullptr && !strings::safe_strto32(env, &num_threads)) {
+    LOG(WARNING) << "Invalid MPI_PROGRESS_THREADS: " << env;
+    num_threads = 4;
+  }
+  return std::max(1, num_threads);
+}
+
+}  // namespace
+
 MPIRendezvousMgr::MPIRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env), worker_env_2(env), use_optimal_transfer_(false) {
+    : BaseRendezvousMgr(env),
+      worker_env_2(env),
+      shutdown_(false),
+      use_optimal_transfer_(false) {
 
   const char* mpienv = getenv("MPI_OPTIMAL_PATH");
   if (mpienv && mpienv[0] == '1') {
@@ -48,8 +73,22 @@ MPIRendezvousMgr::MPIRendezvousMgr(const WorkerEnv* env)
       strings::StrCat(parsed.job, ":", parsed.replica, ":", parsed.task);
 
   mpiutils_ = new MPIUtils(task_id);
-  background_thread_ =
-      std::thread(&MPIRendezvousMgr::MPIBackgroundThread, this);
+  const int num_procs = mpiutils_->NumProcesses();
+  for (int i = 0; i < num_procs; ++i) {
+    peer_queues_.emplace_back(new PeerQueue);
+  }
+
+  int num_threads = std::min(NumProgressThreads(), num_procs);
+  if (num_threads > 1 && !mpiutils_->IsThreadMultiple()) {
+    LOG(WARNING) << "The MPI library does not support MPI_THREAD_MULTIPLE, "
+                    "using a single MPI progress thread";
+    num_threads = 1;
+  }
+  VLOG(1) << "Starting " << num_threads << " MPI progress threads";
+  for (int i = 0; i < num_threads; ++i) {
+    background_threads_.emplace_back(&MPIRendezvousMgr::MPIBackgroundThread,
+                                     this, i, num_threads);
+  }
 }
 
 BaseRemoteRendezvous* MPIRendezvousMgr::Create(int64 step_id,
@@ -102,7 +141,7 @@ void MPIRemoteRendezvous::RecvFromRemoteAsync(
   const int64 temp1 = step_id_;
   rendezvous_call->recv_call_ =
       [this, parsed, recv_args, done, dst, temp1, rendezvous_call](
-          MPIRecvTensorResponse mpi_response) {
+          const MPIRecvTensorResponse& mpi_response) {
     Status s;
     Device* dst_device;
     if (s.ok()) {
@@ -114,28 +153,36 @@ void MPIRemoteRendezvous::RecvFromRemoteAsync(
             << " @ step: " << temp1
             << " single-send: " << mpi_response.singlesend();
 
+    const bool is_dead = mpi_response.response().is_dead();
     Tensor val;
     if (mpi_response.singlesend()) {
       dst_device->MakeTensorFromProto(mpi_response.response().tensor(),
                                       recv_args.alloc_attrs, &val);
-    } else {
-      TensorResponse tr;
-      tr.InitAlloc(dst_device, recv_args.alloc_attrs);
-      tr.InitPartial(mpi_response.response());
-      const size_t nBytes = tr.tensor().TotalBytes();
-      void* data = const_cast<void*>(DMAHelper::base(&tr.tensor()));
-      MPI_Status status;
-      MPI_CHECK(MPI_Recv(data, static_cast<int>(nBytes), MPI_BYTE, dst,
-                         TAG_SENDTENSOR2, MPI_COMM_WORLD, &status));
-      val = std::move(tr.tensor());
+      done(s, Args(), recv_args, val, is_dead);
+      return false;
     }
 
-    done(s, Args(), recv_args, val, mpi_response.response().is_dead());
+    // The data follows from the same process. Since all messages from a
+    // process are handled by one thread, and receives posted by a thread
+    // match in order, it is the data of this tensor.
+    TensorResponse tr;
+    tr.InitAlloc(dst_device, recv_args.alloc_attrs);
+    tr.InitPartial(mpi_response.response());
+    val = std::move(tr.tensor());
+    const size_t nBytes = val.TotalBytes();
+    void* data = const_cast<void*>(DMAHelper::base(&val));
+    MPI_CHECK(MPI_Irecv(data, static_cast<int>(nBytes), MPI_BYTE, dst,
+                        TAG_SENDTENSOR2, MPI_COMM_WORLD,
+                        &rendezvous_call->data_request_));
+    rendezvous_call->recv_done_ = [done, recv_args, val, is_dead]() {
+      done(Status::OK(), Args(), recv_args, val, is_dead);
+    };
+    return true;
   };
 
   MPIRendezvousMgr* mgr =
       reinterpret_cast<MPIRendezvousMgr*>(this->rendezvous_mgr_);
-  mgr->QueueRequest(parsed.FullKey().ToString(), step_id_,
+  mgr->QueueRequest(parsed.FullKey().ToString(), step_id_, dst,
                     std::move(request_call), rendezvous_call);
 }
 
@@ -190,7 +237,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
   };
 
   // Wrapper around the read callback to place the callback on our queue
-  Rendezvous::DoneCallback done_cb = [this, parsed, step_id, send_cb](
+  Rendezvous::DoneCallback done_cb = [this, parsed, step_id, mpi_dst, send_cb](
       const Status& status, const Rendezvous::Args& send_args,
       const Rendezvous::Args& recv_args, const Tensor& val, bool is_dead) {
     if (!status.ok()) {
@@ -215,7 +262,9 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
     // it in two different transfers, thereby reducing memory copies
     bool doOptimalTransfer = true;
     if (!DataTypeCanUseMemcpy(val.dtype())) doOptimalTransfer = false;
-    if (val.TotalBytes() < 1024) doOptimalTransfer = false;
+    if (val.TotalBytes() < kMinSeparateTransferBytes) {
+      doOptimalTransfer = false;
+    }
 
     doOptimalTransfer = doOptimalTransfer && use_optimal_transfer_;
 
@@ -227,6 +276,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
                               ->mutable_tensor()
                               ->mutable_tensor_shape());
       mpi_send_call->mRes_.set_singlesend(false);
+      mpi_send_call->val_ = val;
     } else {
       // Send the Tensor description and data in a single transfer
       if (src_dev->tensorflow_gpu_device_info() &&
@@ -251,12 +301,7 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
 
     SendQueueEntry req(parsed.FullKey().ToString().c_str(), std::move(res));
 
-    this->QueueSendRequest(req);
-
-    // Wait for the notification that indicates the tensor has been
-    // successfully transmitted to the remote process. Only needed if we
-    // have not parsed the tensor to proto
-    if (doOptimalTransfer) mpi_send_call->n_.WaitForNotification();
+    this->QueueSendRequest(mpi_dst, std::move(req));
   };  // done_cb
 
   worker_env_2->compute_pool->Schedule([this, step_id, parsed, done_cb]() {
@@ -264,44 +309,72 @@ void MPIRendezvousMgr::AddRequest(RecvTensorRequest request,
   });
 }
 
-void MPIRendezvousMgr::MPIBackgroundThread() {
+void MPIRendezvousMgr::MPIBackgroundThread(const int thread_id,
+                                           const int num_threads) {
   std::list<std::unique_ptr<MPISendTensorCall>> active_sends;
+  std::list<std::shared_ptr<MPIRequestTensorCall>> active_recvs;
+
+  // The processes served by this thread. A single thread serves all of
+  // them, so it can probe any source at once.
+  std::vector<int> sources;
+  std::vector<int> peers;
+  if (num_threads == 1) {
+    sources.push_back(MPI_ANY_SOURCE);
+  }
+  for (int i = thread_id; i < static_cast<int>(peer_queues_.size());
+       i += num_threads) {
+    if (num_threads > 1) sources.push_back(i);
+    peers.push_back(i);
+  }
 
-  while (1) {
+  while (!shutdown_) {
     MPI_Status status;
 
-    // Check for incoming Tensor requests
-    RecvTensorRequest request;
-    if (ProbeForData(TAG_REQTENSOR, &status, &request)) {
-      this->AddRequest(request, status.MPI_SOURCE);
-    }
-
-    // Check for incoming Tensor reply
-    MPIRecvTensorResponse mRes;
-    if (ProbeForData(TAG_SENDTENSOR, &status, &mRes)) {
-      const int64 step_id = mRes.step_id();
-      std::string key = mRes.key();
+    for (const int source : sources) {
+      // Check for incoming Tensor requests
+      RecvTensorRequest request;
+      if (ProbeForData(source, TAG_REQTENSOR, &status, &request)) {
+        this->AddRequest(request, status.MPI_SOURCE);
+      }
 
-      std::shared_ptr<MPIRequestTensorCall> call;
-      GetRecvCall(step_id, key, &call);
-      call->recv_call_(mRes);
-      RemoveRecvCall(step_id, key);
+      // Check for incoming Tensor reply
+      MPIRecvTensorResponse mRes;
+      if (ProbeForData(source, TAG_SENDTENSOR, &status, &mRes)) {
+        const int64 step_id = mRes.step_id();
+        std::string key = mRes.key();
+
+        std::shared_ptr<MPIRequestTensorCall> call;
+        GetRecvCall(step_id, key, &call);
+        if (call->recv_call_(mRes)) {
+          active_recvs.push_back(std::move(call));
+        }
+        RemoveRecvCall(step_id, key);
+      }
     }
 
+    // Complete the receives of tensor data that have finished
+    active_recvs.remove_if([](std::shared_ptr<MPIRequestTensorCall>& i) {
+      if (!i->IsFinished()) return false;
+      i->recv_done_();
+      return true;
+    });
+
     // Remove sends that have been completed
     active_sends.remove_if([](std::unique_ptr<MPISendTensorCall>& i) {
       return i->IsFinished();
     });
 
-    // send a Tensor request
-    RequestQueueEntry req;
-    if (GetRequest(&req)) req.second();
+    for (const int peer : peers) {
+      // send a Tensor request
+      RequestQueueEntry req;
+      if (GetRequest(peer, &req)) req.second();
 
-    // Send a Tensor response
-    SendQueueEntry send;
-    if (GetResponse(&send)) {
-      std::unique_ptr<MPISendTensorCall> p(send.second());
-      active_sends.push_back(std::move(p));
+      // Send a Tensor response
+      SendQueueEntry send;
+      if (GetResponse(peer, &send)) {
+        std::unique_ptr<MPISendTensorCall> p(send.second());
+        active_sends.push_back(std::move(p));
+      }
     }
 
     //    std::this_thread::sleep_for(std::chrono::microseconds(1));
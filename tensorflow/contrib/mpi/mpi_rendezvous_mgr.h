@@ -18,6 +18,7 @@ limitations under the License.
 
 #ifdef TENSORFLOW_USE_MPI
 
+#include <atomic>
 #include <queue>
 #include <thread>
 #include <list>
@@ -52,14 +53,15 @@ class MPISendTensorCall {
   int done1_;  // Int instead of bool for simpler IsFinished logic
   int done2_;
   MPIRecvTensorResponse mRes_;
-  Notification n_;
+  // Keeps the buffer of a tensor sent without serialization alive until
+  // the transfer has finished.
+  Tensor val_;
 
   MPISendTensorCall()
       : send_buffer_(nullptr), send_buffer2_(nullptr), done1_(1), done2_(1) {}
 
   ~MPISendTensorCall() {
     MPI_CHECK(MPI_Wait(&msg1_, MPI_STATUS_IGNORE));
-    n_.Notify();
     MPI_CHECK(MPI_Free_mem(send_buffer_));
     //    delete[] send_buffer_;
     delete[] send_buffer2_;
@@ -92,7 +94,12 @@ class MPIRequestTensorCall {
   MPI_Request mpi_request_;
   char* request_buffer_;
   size_t request_buffer_size_;
-  std::function<void(MPIRecvTensorResponse)> recv_call_;
+  // Called with the response of the remote process. Returns true if the
+  // tensor data follows in a separate transfer, in which case recv_done_
+  // must be called once IsFinished() returns true.
+  std::function<bool(const MPIRecvTensorResponse&)> recv_call_;
+  std::function<void()> recv_done_;
+  MPI_Request data_request_;
 
   MPIRequestTensorCall() : request_buffer_(nullptr) {}
   ~MPIRequestTensorCall() {
@@ -108,6 +115,12 @@ class MPIRequestTensorCall {
     //   request_buffer_ = new char[request_buffer_size_];
     //  req_.SerializeToArray(request_buffer_, request_buffer_size_);
   }
+
+  bool IsFinished() {
+    int done = 0;
+    MPI_CHECK(MPI_Test(&data_request_, &done, MPI_STATUS_IGNORE));
+    return done;
+  }
 };
 
 class MPIRemoteRendezvous : public BaseRemoteRendezvous {
@@ -132,23 +145,39 @@ class MPIRemoteRendezvous : public BaseRemoteRendezvous {
   TF_DISALLOW_COPY_AND_ASSIGN(MPIRemoteRendezvous);
 };
 
+// MPIRendezvousMgr runs "MPI_PROGRESS_THREADS" background threads that
+// drive all the MPI operations. Each remote process is served by a single
+// thread, which keeps the messages exchanged with it in order; this
+// requires an MPI library providing MPI_THREAD_MULTIPLE when there is more
+// than one thread.
+//
+// Small tensors are serialized with their description and received in a
+// single message. The data of large tensors is transferred separately,
+// directly from and into the tensor buffers, without blocking the thread.
 class MPIRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit MPIRendezvousMgr(const WorkerEnv* env);
   ~MPIRendezvousMgr() {
+    shutdown_ = true;
+    for (auto& thread : background_threads_) {
+      thread.join();
+    }
     delete mpiutils_;
     fprintf(stderr, "Delete MPIRendezvousMgr \n");
-    // TODO(jbedorf) stop background_thread_
     MPI_CHECK(MPI_Finalize());
   }
 
-  void QueueRequest(std::string key, int64 step_id,
+  void QueueRequest(std::string key, int64 step_id, const int dst,
                     std::function<void()> request_call,
                     MPIRequestTensorCall* rCall) {
-    mutex_lock l(mrq_);
-    request_queue_.push(RequestQueueEntry(key, std::move(request_call)));
-    const std::string key_id = strings::StrCat(key, "_", step_id);
-    recv_tensor_map_[key_id] = std::shared_ptr<MPIRequestTensorCall>(rCall);
+    {
+      mutex_lock l(mrq_);
+      const std::string key_id = strings::StrCat(key, "_", step_id);
+      recv_tensor_map_[key_id] = std::shared_ptr<MPIRequestTensorCall>(rCall);
+    }
+    PeerQueue* peer = peer_queues_[dst].get();
+    mutex_lock l(peer->mu);
+    peer->requests.push(RequestQueueEntry(key, std::move(request_call)));
   }
 
  protected:
@@ -164,25 +193,33 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
   typedef std::pair<std::string, std::function<MPISendTensorCall*()>>
       SendQueueEntry;
 
+  // The requests and responses waiting to be sent to one remote process.
+  struct PeerQueue {
+    mutex mu;
+    std::queue<RequestQueueEntry> requests GUARDED_BY(mu);
+    std::queue<SendQueueEntry> sends GUARDED_BY(mu);
+  };
+
   const WorkerEnv* worker_env_2;
-  std::thread background_thread_;
+  std::vector<std::thread> background_threads_;
+  std::atomic<bool> shutdown_;
   MPIUtils* mpiutils_;
   bool use_optimal_transfer_;
 
-  mutex msq_;
-  mutex mrq_;
+  // Indexed by MPI process ID, immutable after construction.
+  std::vector<std::unique_ptr<PeerQueue>> peer_queues_;
 
-  std::queue<SendQueueEntry> send_queue_ GUARDED_BY(msq_);
-  std::queue<RequestQueueEntry> request_queue_ GUARDED_BY(mrq_);
+  mutex mrq_;
   std::map<std::string, std::shared_ptr<MPIRequestTensorCall>> recv_tensor_map_
       GUARDED_BY(mrq_);
 
   void AddRequest(RecvTensorRequest, const int);
-  void MPIBackgroundThread();
+  void MPIBackgroundThread(const int thread_id, const int num_threads);
 
-  void QueueSendRequest(SendQueueEntry req) {
-    mutex_lock l(msq_);
-    send_queue_.push(req);
+  void QueueSendRequest(const int dst, SendQueueEntry req) {
+    PeerQueue* peer = peer_queues_[dst].get();
+    mutex_lock l(peer->mu);
+    peer->sends.push(std::move(req));
   }
 
   void GetRecvCall(const int64 step_id, const std::string& key,
@@ -203,33 +240,37 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
     recv_tensor_map_.erase(key_id);
   }
 
-  bool GetRequest(RequestQueueEntry* req) {
-    mutex_lock l(mrq_);
-    if (!request_queue_.empty()) {
-      *req = request_queue_.front();
-      request_queue_.pop();
+  bool GetRequest(const int dst, RequestQueueEntry* req) {
+    PeerQueue* peer = peer_queues_[dst].get();
+    mutex_lock l(peer->mu);
+    if (!peer->requests.empty()) {
+      *req = std::move(peer->requests.front());
+      peer->requests.pop();
       return true;
     }
     return false;
   }
 
-  bool GetResponse(SendQueueEntry* send) {
-    mutex_lock l(msq_);
-    if (!send_queue_.empty()) {
-      *send = send_queue_.front();
-      send_queue_.pop();
+  bool GetResponse(const int dst, SendQueueEntry* send) {
+    PeerQueue* peer = peer_queues_[dst].get();
+    mutex_lock l(peer->mu);
+    if (!peer->sends.empty()) {
+      *send = std::move(peer->sends.front());
+      peer->sends.pop();
       return true;
     }
     return false;
   }
 
+  // Receives a message with "tag" from "source", which may be
+  // MPI_ANY_SOURCE, if one is pending.
   template <typename T>
-  int ProbeForData(const int tag, MPI_Status* status, T* obj) {
+  int ProbeForData(const int source, const int tag, MPI_Status* status,
+                   T* obj) {
     int flag = 0, msg_size = 0;
     MPI_Message msg;
     // Receive the message, probe as size is variable
-    MPI_CHECK(
-        MPI_Improbe(MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, &flag, &msg, status));
+    MPI_CHECK(MPI_Improbe(source, tag, MPI_COMM_WORLD, &flag, &msg, status));
     if (flag) {
       MPI_CHECK(MPI_Get_count(status, MPI_CHAR, &msg_size));
       MPI_Status stat2;
@@ -20,7 +20,8 @@ namespace tensorflow {
 
 #define max_worker_name_length 128
 
-MPIUtils::MPIUtils(const std::string& worker_name) {
+MPIUtils::MPIUtils(const std::string& worker_name)
+    : number_of_procs_(1), thread_multiple_(false) {
   InitMPI();
   // Connect the MPI process IDs to the worker names that are used by TF.
   // Gather the names of all the active processes (name can't be longer than
@@ -29,6 +30,7 @@ MPIUtils::MPIUtils(const std::string& worker_name) {
   char my_name[max_worker_name_length];
   MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &proc_id));
   MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &number_of_procs));
+  number_of_procs_ = number_of_procs;
 
   CHECK(worker_name.size() < max_worker_name_length)
       << "Specified worker name is too long.";
@@ -55,8 +57,8 @@ void MPIUtils::InitMPI() {
   if (!flag) {
     int proc_id = 0, number_of_procs = 1, len = -1;
     char my_host_name[max_worker_name_length];
-    // MPI_CHECK(MPI_Init_thread(0, 0, MPI_THREAD_MULTIPLE, &flag));
-    MPI_CHECK(MPI_Init(0, 0));
+    int provided = MPI_THREAD_SINGLE;
+    MPI_CHECK(MPI_Init_thread(0, 0, MPI_THREAD_MULTIPLE, &provided));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &proc_id));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &number_of_procs));
     MPI_CHECK(MPI_Get_processor_name(my_host_name, &len));
@@ -65,6 +67,9 @@ void MPIUtils::InitMPI() {
             "|| Hostname: %s \n",
             proc_id, number_of_procs, my_host_name);
   }
+  int provided = MPI_THREAD_SINGLE;
+  MPI_CHECK(MPI_Query_thread(&provided));
+  thread_multiple_ = provided == MPI_THREAD_MULTIPLE;
 }
 
 }  // namespace tensorflow
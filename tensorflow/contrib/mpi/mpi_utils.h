@@ -49,10 +49,18 @@ class MPIUtils {
     return it->second;
   }
 
+  int NumProcesses() const { return number_of_procs_; }
+
+  // Returns true if MPI functions may be called concurrently from several
+  // threads.
+  bool IsThreadMultiple() const { return thread_multiple_; }
+
  private:
   void InitMPI();
 
   std::map<std::string, int> name_to_id_;
+  int number_of_procs_;
+  bool thread_multiple_;
 };
 }  // namespace tensorflow
 
@@ -178,10 +178,15 @@ NcclManager* NcclManager::instance() {
 
 NcclManager::Communicator* NcclManager::GetCommunicator(
     NcclManager::Collective* collective) {
-  // Sort by executor to make ordering of executors deterministic.
+  // Sort by GPU id to make ordering of executors deterministic. The ranks
+  // then follow the GPU ids, so that the parts of a reduce-scatter or
+  // all-gather are in the same order on every host.
   std::sort(collective->participants.begin(), collective->participants.end(),
             [](const std::unique_ptr<Participant>& a,
                const std::unique_ptr<Participant>& b) {
+              if (a->gpu_device_id != b->gpu_device_id) {
+                return a->gpu_device_id < b->gpu_device_id;
+              }
               return a->executor < b->executor;
             });
   const int num_devices = collective->participants.size();
@@ -282,6 +287,33 @@ void NcclManager::AddToAllReduce(int num_devices, const string& key,
                  kAllReduce, reduction_op);
 }
 
+void NcclManager::AddToReduceScatter(
+    int num_devices, const string& key, ncclRedOp_t reduction_op,
+    perftools::gputools::StreamExecutor* executor, int gpu_device_id,
+    EventMgr* event_mgr, perftools::gputools::Stream* tensor_stream,
+    const Tensor* in_t, Tensor* out_t, const DoneCallback& done_callback) {
+  DCHECK_EQ(in_t->NumElements(), out_t->NumElements() * num_devices);
+  std::unique_ptr<Participant> participant(
+      new Participant(in_t, out_t, event_mgr, tensor_stream, executor,
+                      gpu_device_id, done_callback));
+  AddParticipant(num_devices, key, std::move(participant), in_t->dtype(),
+                 kReduceScatter, reduction_op);
+}
+
+void NcclManager::AddToAllGather(int num_devices, const string& key,
+                                 perftools::gputools::StreamExecutor* executor,
+                                 int gpu_device_id, EventMgr* event_mgr,
+                                 perftools::gputools::Stream* tensor_stream,
+                                 const Tensor* in_t, Tensor* out_t,
+                                 const DoneCallback& done_callback) {
+  DCHECK_EQ(in_t->NumElements() * num_devices, out_t->NumElements());
+  std::unique_ptr<Participant> participant(
+      new Participant(in_t, out_t, event_mgr, tensor_stream, executor,
+                      gpu_device_id, done_callback));
+  AddParticipant(num_devices, key, std::move(participant), in_t->dtype(),
+                 kAllGather, ncclSum /* unused */);
+}
+
 void NcclManager::AddBroadcastSend(
     int num_devices, const string& key,
     perftools::gputools::StreamExecutor* executor, int gpu_device_id,
@@ -431,6 +463,23 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
                                 collective->root_rank, nccl_comm, *cu_stream);
         break;
       }
+      case kReduceScatter: {
+        const void* sendbuff = p->in_t->tensor_data().data();
+        void* recvbuff = const_cast<char*>(p->out_t->tensor_data().data());
+
+        nccl_result = ncclReduceScatter(
+            sendbuff, recvbuff, p->out_t->NumElements(), data_type,
+            collective->reduction_op, nccl_comm, *cu_stream);
+        break;
+      }
+      case kAllGather: {
+        const void* sendbuff = p->in_t->tensor_data().data();
+        void* recvbuff = const_cast<char*>(p->out_t->tensor_data().data());
+
+        nccl_result = ncclAllGather(sendbuff, p->in_t->NumElements(),
+                                    data_type, recvbuff, nccl_comm, *cu_stream);
+        break;
+      }
     }
 
     // Run the done_callback when the nccl kernel finishes running.
@@ -441,7 +490,8 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         // Propagate the error, but note that if other members of the collective
         // did launch their kernels, then they are hanging.
         collective->participants[rank]->done_callback(errors::Unknown(
-            "Error invoking AllReduce: ", ncclGetErrorString(nccl_result)));
+            "Error invoking nccl collective: ",
+            ncclGetErrorString(nccl_result)));
       }
 
       // TODO(cwhipkey): use RefCounted after figuring out how to use in a
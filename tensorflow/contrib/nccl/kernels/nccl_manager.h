@@ -62,6 +62,31 @@ class NcclManager {
                       const Tensor* in_t, Tensor* out_t,
                       const DoneCallback& done_callback);
 
+  // Add one participant to a reduce-scatter, sending in data from <in_t> and
+  // receiving in <out_t> the <rank>-th of the equal parts of the reduction of
+  // all the <in_t>, where <rank> is the position of <gpu_device_id> among the
+  // sorted GPU ids of the participants. <in_t> has <num_devices> times as
+  // many elements as <out_t>.
+  //
+  // See AddToAllReduce for the other arguments.
+  void AddToReduceScatter(int num_devices, const string& key,
+                          ncclRedOp_t reduction_op,
+                          perftools::gputools::StreamExecutor* executor,
+                          int gpu_device_id, EventMgr* event_mgr,
+                          perftools::gputools::Stream* tensor_stream,
+                          const Tensor* in_t, Tensor* out_t,
+                          const DoneCallback& done_callback);
+
+  // Add one participant to an all-gather, sending in data from <in_t> and
+  // receiving in <out_t> the concatenation of all the <in_t>, ordered by the
+  // rank of the participants as in AddToReduceScatter.
+  void AddToAllGather(int num_devices, const string& key,
+                      perftools::gputools::StreamExecutor* executor,
+                      int gpu_device_id, EventMgr* event_mgr,
+                      perftools::gputools::Stream* tensor_stream,
+                      const Tensor* in_t, Tensor* out_t,
+                      const DoneCallback& done_callback);
+
   // AddBroadcastSend and AddBroadcastRecv combine to sent data from one sender
   // to all receivers.
   void AddBroadcastSend(int num_devices, const string& key,
@@ -79,6 +104,8 @@ class NcclManager {
   enum CollectiveType {
     kAllReduce = 1,
     kBroadcast = 2,
+    kReduceScatter = 3,
+    kAllGather = 4,
   };
   struct Collective;
   struct Communicator;
@@ -153,17 +153,22 @@ class NcclManagerTest : public ::testing::Test {
     };
   }
 
-  void VerifyResults(const string& case_label, TestCase* test_case) {
-    // Wait for the done callback to be called.
-    {
-      test_case->mu.lock();
-      while (test_case->num_completed != test_case->outs.size()) {
-        test_case->mu.unlock();
-        Env::Default()->SleepForMicroseconds(10);
-        test_case->mu.lock();
-      }
+  // Waits for the done callbacks of one collective to be called, and resets
+  // the count.
+  void VerifyCompleted(TestCase* test_case) {
+    test_case->mu.lock();
+    while (test_case->num_completed != test_case->outs.size()) {
       test_case->mu.unlock();
+      Env::Default()->SleepForMicroseconds(10);
+      test_case->mu.lock();
     }
+    test_case->num_completed = 0;
+    TF_EXPECT_OK(test_case->final_status);
+    test_case->mu.unlock();
+  }
+
+  void VerifyResults(const string& case_label, TestCase* test_case) {
+    VerifyCompleted(test_case);
     // Copy memory to host and verify.
     for (int i = 0; i < test_case->outs.size(); ++i) {
       auto* device = devices->at(i % devices->size());
@@ -203,6 +208,43 @@ TEST_F(NcclManagerTest, BasicSumReduction) {
   }
 }
 
+// Test that a reduce-scatter followed by an all-gather is an all-reduce.
+TEST_F(NcclManagerTest, ReduceScatterThenAllGather) {
+  // The parts are assigned by GPU id, so use each device once.
+  const int num_ranks = devices->size();
+  const int part_size = 5;
+
+  std::unique_ptr<TestCase> test_case(MakeTestCase(
+      num_ranks, ncclSum, TensorShape({num_ranks * part_size}), 0));
+  std::vector<Tensor> parts;
+  for (int device_num = 0; device_num < num_ranks; ++device_num) {
+    parts.emplace_back(gpu_allocator(devices->at(device_num)), DT_FLOAT,
+                       TensorShape({part_size}));
+  }
+
+  for (int device_num = 0; device_num < num_ranks; ++device_num) {
+    auto* device = devices->at(device_num);
+    auto* event_mgr = device->tensorflow_gpu_device_info()->event_mgr;
+    auto* stream = device->tensorflow_gpu_device_info()->stream;
+    NcclManager::instance()->AddToReduceScatter(
+        num_ranks, "reducescatter", ncclSum, device->executor(),
+        device->gpu_id(), event_mgr, stream, &test_case->ins[device_num],
+        &parts[device_num], CreateDoneCallback(test_case.get()));
+  }
+  VerifyCompleted(test_case.get());
+
+  for (int device_num = 0; device_num < num_ranks; ++device_num) {
+    auto* device = devices->at(device_num);
+    auto* event_mgr = device->tensorflow_gpu_device_info()->event_mgr;
+    auto* stream = device->tensorflow_gpu_device_info()->stream;
+    NcclManager::instance()->AddToAllGather(
+        num_ranks, "allgather", device->executor(), device->gpu_id(),
+        event_mgr, stream, &parts[device_num], &test_case->outs[device_num],
+        CreateDoneCallback(test_case.get()));
+  }
+  VerifyResults("test_case", test_case.get());
+}
+
 // Same as the Basic test, but with multiple threads launching parts of many
 // reductions.
 //
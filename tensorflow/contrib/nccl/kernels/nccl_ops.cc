@@ -58,11 +58,10 @@ class NcclAsyncOpBase : public AsyncOpKernel {
   TF_DISALLOW_COPY_AND_ASSIGN(NcclAsyncOpBase);
 };
 
-// To execute a single all-reduce, this kernel is called once for each of the
-// <k> devices in the communicator.
-class NcclAllReduceOpKernel : public NcclAsyncOpBase {
+// Base class for the communicator ops that reduce their inputs.
+class NcclReduceOpBase : public NcclAsyncOpBase {
  public:
-  explicit NcclAllReduceOpKernel(OpKernelConstruction* c) : NcclAsyncOpBase(c) {
+  explicit NcclReduceOpBase(OpKernelConstruction* c) : NcclAsyncOpBase(c) {
     string reduction;
     OP_REQUIRES_OK(c, c->GetAttr("reduction", &reduction));
     if (reduction == "min") {
@@ -79,6 +78,19 @@ class NcclAllReduceOpKernel : public NcclAsyncOpBase {
     }
   }
 
+  ncclRedOp_t reduction_op() const { return reduction_op_; }
+
+ private:
+  ncclRedOp_t reduction_op_;
+};
+
+// To execute a single all-reduce, this kernel is called once for each of the
+// <k> devices in the communicator.
+class NcclAllReduceOpKernel : public NcclReduceOpBase {
+ public:
+  explicit NcclAllReduceOpKernel(OpKernelConstruction* c)
+      : NcclReduceOpBase(c) {}
+
   void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
     const Tensor* in_t = &c->input(0);
     Tensor* out_t;
@@ -92,18 +104,95 @@ class NcclAllReduceOpKernel : public NcclAsyncOpBase {
     auto* compute_stream = c->op_device_context()->stream();
     auto* gpu_info = c->device()->tensorflow_gpu_device_info();
     NcclManager::instance()->AddToAllReduce(
-        num_devices(), GetCollectiveKey(c), reduction_op_,
+        num_devices(), GetCollectiveKey(c), reduction_op(),
         compute_stream->parent(), gpu_info->gpu_id, gpu_info->event_mgr,
         compute_stream, in_t, out_t, actual_done);
   }
-
- private:
-  ncclRedOp_t reduction_op_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("NcclAllReduce").Device(DEVICE_GPU),
                         NcclAllReduceOpKernel);
 
+// To execute a single reduce-scatter, this kernel is called once for each of
+// the <k> devices in the communicator, each receiving 1/k of the reduction.
+class NcclReduceScatterOpKernel : public NcclReduceOpBase {
+ public:
+  explicit NcclReduceScatterOpKernel(OpKernelConstruction* c)
+      : NcclReduceOpBase(c) {}
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    const Tensor* in_t = &c->input(0);
+    OP_REQUIRES_ASYNC(c, TensorShapeUtils::IsVector(in_t->shape()),
+                      errors::InvalidArgument("input must be a vector: ",
+                                              in_t->shape().DebugString()),
+                      done);
+    OP_REQUIRES_ASYNC(
+        c, in_t->NumElements() % num_devices() == 0,
+        errors::InvalidArgument("input size ", in_t->NumElements(),
+                                " is not a multiple of num_devices ",
+                                num_devices()),
+        done);
+    Tensor* out_t;
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        c->allocate_output(
+            0, TensorShape({in_t->NumElements() / num_devices()}), &out_t),
+        done);
+
+    auto actual_done = [c, done](Status s) {
+      OP_REQUIRES_OK_ASYNC(c, s, done);
+      done();
+    };
+
+    auto* compute_stream = c->op_device_context()->stream();
+    auto* gpu_info = c->device()->tensorflow_gpu_device_info();
+    NcclManager::instance()->AddToReduceScatter(
+        num_devices(), GetCollectiveKey(c), reduction_op(),
+        compute_stream->parent(), gpu_info->gpu_id, gpu_info->event_mgr,
+        compute_stream, in_t, out_t, actual_done);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NcclReduceScatter").Device(DEVICE_GPU),
+                        NcclReduceScatterOpKernel);
+
+// To execute a single all-gather, this kernel is called once for each of the
+// <k> devices in the communicator.
+class NcclAllGatherOpKernel : public NcclAsyncOpBase {
+ public:
+  explicit NcclAllGatherOpKernel(OpKernelConstruction* c)
+      : NcclAsyncOpBase(c) {}
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    const Tensor* in_t = &c->input(0);
+    OP_REQUIRES_ASYNC(c, TensorShapeUtils::IsVector(in_t->shape()),
+                      errors::InvalidArgument("input must be a vector: ",
+                                              in_t->shape().DebugString()),
+                      done);
+    Tensor* out_t;
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        c->allocate_output(
+            0, TensorShape({in_t->NumElements() * num_devices()}), &out_t),
+        done);
+
+    auto actual_done = [c, done](Status s) {
+      OP_REQUIRES_OK_ASYNC(c, s, done);
+      done();
+    };
+
+    auto* compute_stream = c->op_device_context()->stream();
+    auto* gpu_info = c->device()->tensorflow_gpu_device_info();
+    NcclManager::instance()->AddToAllGather(
+        num_devices(), GetCollectiveKey(c), compute_stream->parent(),
+        gpu_info->gpu_id, gpu_info->event_mgr, compute_stream, in_t, out_t,
+        actual_done);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NcclAllGather").Device(DEVICE_GPU),
+                        NcclAllGatherOpKernel);
+
 class NcclBroadcastSendKernel : public NcclAsyncOpBase {
  public:
   explicit NcclBroadcastSendKernel(OpKernelConstruction* c)
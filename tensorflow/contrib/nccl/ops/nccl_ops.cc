@@ -18,6 +18,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+using shape_inference::DimensionHandle;
 using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
@@ -45,6 +46,75 @@ num_devices: The number of devices participating in this reduction.
 shared_name: Identifier that shared between ops of the same reduction.
 )doc");
 
+REGISTER_OP("NcclReduceScatter")
+    .Input("input: T")
+    .Output("data: T")
+    .Attr("reduction: {'min', 'max', 'prod', 'sum'}")
+    .Attr("T: {float, float64, int32, int64}")
+    .Attr("num_devices: int")
+    .Attr("shared_name: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &input));
+      int num_devices;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_devices", &num_devices));
+      DimensionHandle dim;
+      TF_RETURN_IF_ERROR(c->Divide(c->Dim(input, 0), num_devices,
+                                   true /* evenly_divisible */, &dim));
+      c->set_output(0, c->Vector(dim));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Outputs one of `num_devices` equal parts of the reduction across all input
+tensors passed to ops within the same `shared_name`.
+
+The part received by an op is given by the rank of its device among the sorted
+ids of the GPUs of all the ops, e.g. the op on the GPU with the lowest id
+receives the first part.
+
+The graph should be constructed so if one op runs with shared_name value `c`,
+then `num_devices` ops will run with shared_name value `c`.  Failure to do so
+will cause the graph execution to fail to complete.
+
+input: the vector to reduce, whose size must be a multiple of `num_devices`.
+data: the part of the reduction across all `num_devices` devices.
+reduction: the reduction operation to perform.
+num_devices: The number of devices participating in this reduction.
+shared_name: Identifier that shared between ops of the same reduction.
+)doc");
+
+REGISTER_OP("NcclAllGather")
+    .Input("input: T")
+    .Output("data: T")
+    .Attr("T: {float, float64, int32, int64}")
+    .Attr("num_devices: int")
+    .Attr("shared_name: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &input));
+      int num_devices;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_devices", &num_devices));
+      DimensionHandle dim;
+      TF_RETURN_IF_ERROR(c->Multiply(c->Dim(input, 0), num_devices, &dim));
+      c->set_output(0, c->Vector(dim));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Outputs the concatenation of the input tensors passed to ops within the same
+`shared_name`, ordered by the rank of their devices as in NcclReduceScatter.
+
+The graph should be constructed so if one op runs with shared_name value `c`,
+then `num_devices` ops will run with shared_name value `c`.  Failure to do so
+will cause the graph execution to fail to complete.
+
+input: the vector to gather, of the same size on all devices.
+data: the concatenation of the inputs of all `num_devices` devices.
+num_devices: The number of devices participating in this all-gather.
+shared_name: Identifier that shared between ops of the same all-gather.
+)doc");
+
 REGISTER_OP("NcclBroadcastSend")
     .Input("input: T")
     .Attr("T: {float, float64, int32, int64}")
@@ -99,6 +99,58 @@ def all_max(tensors):
   return _apply_all_reduce('max', tensors)
 
 
+def reduce_scatter_sum(tensors):
+  """Returns a list of tensors, each with one part of the sum of `tensors`.
+
+  The sum is split into `len(tensors)` equal parts. The device of each tensor
+  receives the part given by its rank among the sorted GPU ids of the devices
+  of `tensors`, e.g. the tensor on the GPU with the lowest id receives the
+  first part.
+
+  The computation is done with a reduce-scatter operation, so if only some of
+  the returned tensors are evaluated then the computation will hang.
+
+  Args:
+    tensors: The vectors across which to sum, whose size must be a multiple
+      of `len(tensors)`; must be assigned to GPU devices.
+
+  Returns:
+    List of vectors, where tensor i has the same device as `tensors[i]`.
+  """
+  return _apply_reduce_scatter('sum', tensors)
+
+
+def all_gather(tensors):
+  """Returns a list of tensors, each with the concatenation of `tensors`.
+
+  The vectors are concatenated in the order of the GPU ids of their devices,
+  as for `reduce_scatter_sum`, so `all_gather(reduce_scatter_sum(tensors))`
+  has the value of `all_sum(tensors)`.
+
+  The computation is done with an all-gather operation, so if only some of the
+  returned tensors are evaluated then the computation will hang.
+
+  Args:
+    tensors: The vectors to concatenate, all of the same size; must be
+      assigned to GPU devices.
+
+  Returns:
+    List of vectors, where tensor i has the same device as `tensors[i]`.
+  """
+  if not tensors:
+    raise ValueError('Must pass >0 tensors to all gather operations')
+  shared_name = _get_shared_name()
+  res = []
+  for t in tensors:
+    if not device.canonical_name(t.device):
+      raise ValueError('Device assignment required for nccl collective ops')
+    with ops.device(t.device):
+      res.append(
+          gen_nccl_ops.nccl_all_gather(
+              t, num_devices=len(tensors), shared_name=shared_name))
+  return res
+
+
 def broadcast(src_tensor, dst_devices):
   """Returns a list of tensors on `dst_devices`, each with value `tensor`.
 
@@ -155,6 +207,24 @@ def _apply_all_reduce(reduction_op, tensors):
   return res
 
 
+def _apply_reduce_scatter(reduction_op, tensors):
+  if not tensors:
+    raise ValueError('Must pass >0 tensors to reduce scatter operations')
+  shared_name = _get_shared_name()
+  res = []
+  for t in tensors:
+    if not device.canonical_name(t.device):
+      raise ValueError('Device assignment required for nccl collective ops')
+    with ops.device(t.device):
+      res.append(
+          gen_nccl_ops.nccl_reduce_scatter(
+              t,
+              reduction=reduction_op,
+              num_devices=len(tensors),
+              shared_name=shared_name))
+  return res
+
+
 _lock = threading.Lock()
 _shared_name_counter = 0
 
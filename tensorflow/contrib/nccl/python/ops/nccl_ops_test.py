@@ -104,6 +104,48 @@ class BroadcastTest(test.TestCase):
             self.assertAllClose(r, np_ans)
 
 
+class ReduceScatterAllGatherTest(test.TestCase):
+
+  def testReduceScatterAllGather(self):
+    if not test.is_gpu_available():
+      return  # Test requires access to a GPU
+
+    for devices in [['/gpu:0', '/gpu:0', '/gpu:0'], ['/gpu:0', '/gpu:0']]:
+      with self.test_session(use_gpu=True) as sess:
+        num_devices = len(devices)
+        values = [np.random.random_sample(num_devices * 4).astype(np.float32)
+                  for _ in devices]
+        tensors = []
+        for d, v in zip(devices, values):
+          with ops.device(d):
+            tensors.append(array_ops.identity(v))
+        parts = nccl.reduce_scatter_sum(tensors)
+        gathered = nccl.all_gather(parts)
+
+        # Verify shape inference.
+        for p in parts:
+          self.assertEqual((4,), p.get_shape())
+        for g in gathered:
+          self.assertEqual((num_devices * 4,), g.get_shape())
+
+        parts_results, gathered_results = sess.run([parts, gathered])
+        # The devices are the same, so the order of the parts is not known.
+        expected = np.split(sum(values), num_devices)
+        self.assertAllClose(sorted(expected, key=lambda x: x[0]),
+                            sorted(parts_results, key=lambda x: x[0]))
+        for g in gathered_results:
+          self.assertAllClose(gathered_results[0], g)
+          self.assertAllClose(
+              sorted(expected, key=lambda x: x[0]),
+              sorted(np.split(g, num_devices), key=lambda x: x[0]))
+
+  def testErrors(self):
+    with self.assertRaisesRegexp(ValueError, 'Must pass >0 tensors'):
+      nccl.reduce_scatter_sum([])
+    with self.assertRaisesRegexp(ValueError, 'Must pass >0 tensors'):
+      nccl.all_gather([])
+
+
 class CombinedTest(test.TestCase):
   """Tests using a mix of all-reduce ops in one session.run call."""
 
@@ -146,18 +146,21 @@ class LSTMBlockCellOp : public OpKernel {
         ctx, ctx->allocate_output("h", TensorShape({batch_size, cell_size}),
                                   &h_tensor));
 
-    // Allocate our temp tensors.
+    // Allocate our temp tensors. They die with this call, so they can come
+    // from the step arena.
+    AllocatorAttributes temp_attr;
+    temp_attr.set_step_scoped(true);
     Tensor xh_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(
                             DataTypeToEnum<T>::v(),
                             TensorShape({batch_size, input_size + cell_size}),
-                            &xh_tensor));
+                            &xh_tensor, temp_attr));
 
     Tensor icfo_tensor;
     OP_REQUIRES_OK(ctx,
                    ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                       TensorShape({batch_size, cell_size * 4}),
-                                      &icfo_tensor));
+                                      &icfo_tensor, temp_attr));
 
     const Device& device = ctx->eigen_device<Device>();
 
@@ -412,31 +415,34 @@ class LSTMBlockCellGradOp : public OpKernel {
         ctx, ctx->forward_input_or_allocate_output(
                  {"wco"}, "wco_grad", wco_tensor->shape(), &wco_grad_tensor));
 
-    // Allocate our temp tensors.
+    // Allocate our temp tensors. They die with this call, so they can come
+    // from the step arena.
+    AllocatorAttributes temp_attr;
+    temp_attr.set_step_scoped(true);
     Tensor do_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                            TensorShape({batch_size, cell_size}),
-                                           &do_tensor));
+                                           &do_tensor, temp_attr));
 
     Tensor dcs_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                            TensorShape({batch_size, cell_size}),
-                                           &dcs_tensor));
+                                           &dcs_tensor, temp_attr));
 
     Tensor dci_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                            TensorShape({batch_size, cell_size}),
-                                           &dci_tensor));
+                                           &dci_tensor, temp_attr));
 
     Tensor df_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                            TensorShape({batch_size, cell_size}),
-                                           &df_tensor));
+                                           &df_tensor, temp_attr));
 
     Tensor di_tensor;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::v(),
                                            TensorShape({batch_size, cell_size}),
-                                           &di_tensor));
+                                           &di_tensor, temp_attr));
 
     const Device& device = ctx->eigen_device<Device>();
 
@@ -745,12 +751,6 @@ class BlockLSTMOp : public OpKernel {
     Tensor* h_out;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("h", batch_cell_shape, &h_out));
 
-    Tensor xh_tensor;
-    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
-                            DataTypeToEnum<T>::v(),
-                            TensorShape({batch_size, input_size + cell_size}),
-                            &xh_tensor));
-
     Tensor icfo_tensor;
     OP_REQUIRES_OK(ctx,
                    ctx->allocate_temp(DataTypeToEnum<T>::v(),
@@ -760,9 +760,38 @@ class BlockLSTMOp : public OpKernel {
     const Device& device = ctx->eigen_device<Device>();
 
     const int64 seq_len_max = seq_len_max_tensor->scalar<int64>()();
+    OP_REQUIRES(ctx, seq_len_max <= timelen,
+                errors::InvalidArgument("seq_len_max > timelen: ", seq_len_max,
+                                        " vs. ", timelen));
+
+    // Project the inputs of all time steps with one GEMM up front; the
+    // recurrence then only needs h_prev * w_h per step.
+    Tensor x_proj_tensor;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_temp(
+                 DataTypeToEnum<T>::v(),
+                 TensorShape({seq_len_max, batch_size, cell_size * 4}),
+                 &x_proj_tensor));
+    Tensor w_h_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<T>::v(),
+                            TensorShape({cell_size, cell_size * 4}),
+                            &w_h_tensor));
+    if (seq_len_max > 0) {
+      typename TTypes<T>::ConstMatrix x_all(
+          x->flat<T>().data(), seq_len_max * batch_size, input_size);
+      auto x_proj_all = x_proj_tensor.shaped<T, 2>(
+          {seq_len_max * batch_size, cell_size * 4});
+      functor::BlockLSTMInputProjection<Device, T, USE_CUBLAS>(
+          batch_size, input_size, cell_size)(
+          ctx, device, x_all, w_tensor->matrix<T>(), b_tensor->vec<T>(),
+          w_h_tensor.matrix<T>(), x_proj_all);
+    }
+    const Tensor& const_w_h_tensor = w_h_tensor;
+
     SliceHelper<Device, T> slicer(ctx);
     for (int64 t = 0; t < seq_len_max; ++t) {
-      const Tensor x_tensor = slicer.InputSlice(*x, t, "x");
+      const Tensor x_proj_t = slicer.InputSlice(x_proj_tensor, t, "x_proj");
       const Tensor& cs_prev_tensor2 =
           t == 0 ? *cs_prev_tensor
                  : slicer.OutputSlice(cs_out, t - 1, "cs_prev");
@@ -777,16 +806,15 @@ class BlockLSTMOp : public OpKernel {
       Tensor co_tensor = slicer.OutputSlice(co_out, t, "co_out");
       Tensor h_tensor = slicer.OutputSlice(h_out, t, "h_out");
 
-      functor::LSTMBlockCellFprop<Device, T, USE_CUBLAS>(batch_size, input_size,
-                                                         cell_size)(
+      functor::LSTMBlockCellFpropWithInputProjection<Device, T, USE_CUBLAS>(
+          batch_size, input_size, cell_size)(
           ctx, device, forget_bias_, cell_clip_, use_peephole_,
-          x_tensor.matrix<T>(), cs_prev_tensor2.matrix<T>(),
-          h_prev_tensor2.matrix<T>(), w_tensor->matrix<T>(),
+          x_proj_t.matrix<T>(), cs_prev_tensor2.matrix<T>(),
+          h_prev_tensor2.matrix<T>(), const_w_h_tensor.matrix<T>(),
           wci_tensor->vec<T>(), wcf_tensor->vec<T>(), wco_tensor->vec<T>(),
-          b_tensor->vec<T>(), xh_tensor.matrix<T>(), i_tensor.matrix<T>(),
-          cs_tensor.matrix<T>(), f_tensor.matrix<T>(), o_tensor.matrix<T>(),
-          ci_tensor.matrix<T>(), co_tensor.matrix<T>(), icfo_tensor.matrix<T>(),
-          h_tensor.matrix<T>());
+          i_tensor.matrix<T>(), cs_tensor.matrix<T>(), f_tensor.matrix<T>(),
+          o_tensor.matrix<T>(), ci_tensor.matrix<T>(), co_tensor.matrix<T>(),
+          icfo_tensor.matrix<T>(), h_tensor.matrix<T>());
       slicer.FinishTimeStep();
     }
 
@@ -817,18 +845,44 @@ REGISTER_KERNEL(float);
 
 #if GOOGLE_CUDA
 namespace functor {
-#define DECLARE_GPU_SPEC(T)                                              \
-  template <>                                                            \
-  void TensorZero<GPUDevice, T>::operator()(const GPUDevice& d,          \
-                                            typename TTypes<T>::Flat t); \
-                                                                         \
-  extern template struct TensorZero<GPUDevice, T>;                       \
-                                                                         \
-  template <>                                                            \
-  void TensorUnalignedZero<GPUDevice, T>::operator()(                    \
-      const GPUDevice& d, typename TTypes<T>::UnalignedFlat t);          \
-                                                                         \
-  extern template struct TensorUnalignedZero<GPUDevice, T>;
+#define DECLARE_GPU_SPEC(T)                                                   \
+  template <>                                                                 \
+  void TensorZero<GPUDevice, T>::operator()(const GPUDevice& d,               \
+                                            typename TTypes<T>::Flat t);      \
+                                                                              \
+  extern template struct TensorZero<GPUDevice, T>;                            \
+                                                                              \
+  template <>                                                                 \
+  void TensorUnalignedZero<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, typename TTypes<T>::UnalignedFlat t);               \
+                                                                              \
+  extern template struct TensorUnalignedZero<GPUDevice, T>;                   \
+                                                                              \
+  template <>                                                                 \
+  void BlockLSTMInputProjection<GPUDevice, T, true>::operator()(              \
+      OpKernelContext* ctx, const GPUDevice& d,                               \
+      typename TTypes<T>::ConstMatrix x, typename TTypes<T>::ConstMatrix w,   \
+      typename TTypes<T>::ConstVec b, typename TTypes<T>::Matrix w_h,         \
+      typename TTypes<T>::Matrix x_proj);                                     \
+                                                                              \
+  extern template struct BlockLSTMInputProjection<GPUDevice, T, true>;        \
+                                                                              \
+  template <>                                                                 \
+  void LSTMBlockCellFpropWithInputProjection<GPUDevice, T, true>::operator()( \
+      OpKernelContext* ctx, const GPUDevice& d, const T forget_bias,          \
+      const T cell_clip, bool use_peephole,                                   \
+      typename TTypes<T>::ConstMatrix x_proj,                                 \
+      typename TTypes<T>::ConstMatrix cs_prev,                                \
+      typename TTypes<T>::ConstMatrix h_prev,                                 \
+      typename TTypes<T>::ConstMatrix w_h, typename TTypes<T>::ConstVec wci,  \
+      typename TTypes<T>::ConstVec wcf, typename TTypes<T>::ConstVec wco,     \
+      typename TTypes<T>::Matrix i, typename TTypes<T>::Matrix cs,            \
+      typename TTypes<T>::Matrix f, typename TTypes<T>::Matrix o,             \
+      typename TTypes<T>::Matrix ci, typename TTypes<T>::Matrix co,           \
+      typename TTypes<T>::Matrix icfo, typename TTypes<T>::Matrix h);         \
+                                                                              \
+  extern template struct LSTMBlockCellFpropWithInputProjection<GPUDevice, T,  \
+                                                               true>;
 
 DECLARE_GPU_SPEC(float);
 // DECLARE_GPU_SPEC(double);
@@ -171,6 +171,22 @@ struct LSTMBlockCellFprop : public LSTMBlockCell {
     Eigen::array<Eigen::DenseIndex, 2> broadcast_shape({batch_size_, 1});
     icfo.device(d) += b.reshape(b_shape).broadcast(broadcast_shape);
 
+    ApplyGates(d, forget_bias, cell_clip, use_peephole, cs_prev, wci, wcf, wco,
+               i, cs, f, o, ci, co, icfo, h);
+  }
+
+ protected:
+  // Computes the gates and the new cell state and output from the
+  // pre-activations icfo = [x, h_prev] * w + b.
+  void ApplyGates(
+      const Device& d, const T forget_bias, const T cell_clip,
+      bool use_peephole, typename TTypes<T>::ConstMatrix cs_prev,
+      typename TTypes<T>::ConstVec wci, typename TTypes<T>::ConstVec wcf,
+      typename TTypes<T>::ConstVec wco, typename TTypes<T>::Matrix i,
+      typename TTypes<T>::Matrix cs, typename TTypes<T>::Matrix f,
+      typename TTypes<T>::Matrix o, typename TTypes<T>::Matrix ci,
+      typename TTypes<T>::Matrix co, typename TTypes<T>::Matrix icfo,
+      typename TTypes<T>::Matrix h) {
     Eigen::array<Eigen::DenseIndex, 2> p_shape({1, cell_size_});
     Eigen::array<Eigen::DenseIndex, 2> p_broadcast_shape({batch_size_, 1});
 
@@ -223,6 +239,72 @@ struct LSTMBlockCellFprop : public LSTMBlockCell {
   }
 };
 
+// BlockLSTM splits w = [w_x; w_h] and computes the input projection
+// x * w_x + b of all time steps with a single GEMM before the recurrence, so
+// each step only multiplies h_prev by the smaller recurrent weights w_h.
+template <typename Device, typename T, bool USE_CUBLAS>
+struct BlockLSTMInputProjection : public LSTMBlockCell {
+  BlockLSTMInputProjection(const int batch_size, const int input_size,
+                           const int cell_size)
+      : LSTMBlockCell(batch_size, input_size, cell_size) {}
+
+  // x holds the inputs of all time steps stacked along the batch dimension,
+  // and x_proj receives their projections in the same layout. w_h receives a
+  // dense copy of the recurrent weights.
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  typename TTypes<T>::ConstMatrix x,
+                  typename TTypes<T>::ConstMatrix w,
+                  typename TTypes<T>::ConstVec b,
+                  typename TTypes<T>::Matrix w_h,
+                  typename TTypes<T>::Matrix x_proj) {
+    Eigen::array<Eigen::DenseIndex, 2> w_h_offsets({input_size_, 0});
+    Eigen::array<Eigen::DenseIndex, 2> w_h_extents(
+        {cell_size_, cell_size_ * 4});
+    w_h.device(d) = w.slice(w_h_offsets, w_h_extents);
+
+    // w_x is the leading rows of w, which keeps the alignment of w.
+    typename TTypes<T>::ConstMatrix w_x(w.data(), input_size_, cell_size_ * 4);
+    TensorBlasGemm<Device, T, USE_CUBLAS>::compute(ctx, d, false, false, T(1),
+                                                   x, w_x, T(0), x_proj);
+    Eigen::array<Eigen::DenseIndex, 2> b_shape({1, b.dimensions()[0]});
+    Eigen::array<Eigen::DenseIndex, 2> broadcast_shape(
+        {static_cast<Eigen::DenseIndex>(x_proj.dimensions()[0]), 1});
+    x_proj.device(d) += b.reshape(b_shape).broadcast(broadcast_shape);
+  }
+};
+
+// Same as LSTMBlockCellFprop, with the input projection x * w_x + b already
+// computed by BlockLSTMInputProjection.
+template <typename Device, typename T, bool USE_CUBLAS>
+struct LSTMBlockCellFpropWithInputProjection
+    : public LSTMBlockCellFprop<Device, T, USE_CUBLAS> {
+  LSTMBlockCellFpropWithInputProjection(const int batch_size,
+                                        const int input_size,
+                                        const int cell_size)
+      : LSTMBlockCellFprop<Device, T, USE_CUBLAS>(batch_size, input_size,
+                                                  cell_size) {}
+
+  void operator()(
+      OpKernelContext* ctx, const Device& d, const T forget_bias,
+      const T cell_clip, bool use_peephole,
+      typename TTypes<T>::ConstMatrix x_proj,
+      typename TTypes<T>::ConstMatrix cs_prev,
+      typename TTypes<T>::ConstMatrix h_prev,
+      typename TTypes<T>::ConstMatrix w_h, typename TTypes<T>::ConstVec wci,
+      typename TTypes<T>::ConstVec wcf, typename TTypes<T>::ConstVec wco,
+      typename TTypes<T>::Matrix i, typename TTypes<T>::Matrix cs,
+      typename TTypes<T>::Matrix f, typename TTypes<T>::Matrix o,
+      typename TTypes<T>::Matrix ci, typename TTypes<T>::Matrix co,
+      typename TTypes<T>::Matrix icfo, typename TTypes<T>::Matrix h) {
+    // icfo = x_proj + h_prev * w_h
+    icfo.device(d) = x_proj;
+    TensorBlasGemm<Device, T, USE_CUBLAS>::compute(ctx, d, false, false, T(1),
+                                                   h_prev, w_h, T(1), icfo);
+    this->ApplyGates(d, forget_bias, cell_clip, use_peephole, cs_prev, wci, wcf,
+                     wco, i, cs, f, o, ci, co, icfo, h);
+  }
+};
+
 template <typename Device, typename T, bool USE_CUBLAS>
 struct LSTMBlockCellBprop : public LSTMBlockCell {
   LSTMBlockCellBprop(const int batch_size, const int input_size,
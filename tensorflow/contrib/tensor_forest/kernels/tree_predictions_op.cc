@@ -14,6 +14,10 @@
 // =============================================================================
 // TreePredictions returns the per-class probabilities for each input by
 // evaluating the given tree.
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/contrib/tensor_forest/kernels/tree_predictions_op.h"
+
 #include <algorithm>
 
 #include "tensorflow/contrib/tensor_forest/kernels/data_spec.h"
@@ -25,8 +29,15 @@
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/util/work_sharder.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
 using tensorforest::CHILDREN_INDEX;
 using tensorforest::FEATURE_INDEX;
 using tensorforest::LEAF_NODE;
@@ -70,12 +81,19 @@ void Evaluate(OpKernelContext* context,
       const int32 left_child = tree(node_index, CHILDREN_INDEX);
       if (left_child == LEAF_NODE) {
         const int32 flat_leaf_index = node_index * num_classes + 1;
-        const int32 flat_parent_index = parent * num_classes + 1;
         std::vector<float> means(num_classes - 1);
-        tensorforest::GetParentWeightedMean(
-            node_pcw(node_index, 0), node_pcw.data() + flat_leaf_index,
-            node_pcw(parent, 0), node_pcw.data() + flat_parent_index,
-            valid_leaf_threshold, num_classes - 1, &means);
+        // A leaf at the root has no parent to back off to.
+        if (parent >= 0) {
+          const int32 flat_parent_index = parent * num_classes + 1;
+          tensorforest::GetParentWeightedMean(
+              node_pcw(node_index, 0), node_pcw.data() + flat_leaf_index,
+              node_pcw(parent, 0), node_pcw.data() + flat_parent_index,
+              valid_leaf_threshold, num_classes - 1, &means);
+        } else {
+          tensorforest::GetParentWeightedMean(
+              node_pcw(node_index, 0), node_pcw.data() + flat_leaf_index,
+              -1, nullptr, valid_leaf_threshold, num_classes - 1, &means);
+        }
         const int32 start_index = i * (num_classes - 1);
         std::copy(means.begin(), means.end(), out.data() + start_index);
         break;
@@ -91,6 +109,7 @@ void Evaluate(OpKernelContext* context,
 }
 }  // namespace
 
+template <typename Device>
 class TreePredictions : public OpKernel {
  public:
   explicit TreePredictions(OpKernelConstruction* context)
@@ -163,6 +182,8 @@ class TreePredictions : public OpKernel {
                 errors::InvalidArgument(
                     "node_pcw should be two-dimensional"));
 
+    OP_REQUIRES(context, tree_tensor.shape().dim_size(0) > 0,
+                errors::InvalidArgument("tree should have at least one node"));
     OP_REQUIRES(
         context,
         tree_tensor.shape().dim_size(0) ==
@@ -193,6 +214,32 @@ class TreePredictions : public OpKernel {
                    context->allocate_output(0, output_shape,
                                             &output_predictions));
 
+    ComputePredictions(context, input_data, sparse_input_indices,
+                       sparse_input_values, tree_tensor, tree_thresholds,
+                       node_per_class_weights, output_predictions);
+  }
+
+ private:
+  // Evaluates the tree on the device of the kernel.
+  void ComputePredictions(OpKernelContext* context, const Tensor& input_data,
+                          const Tensor& sparse_input_indices,
+                          const Tensor& sparse_input_values,
+                          const Tensor& tree_tensor,
+                          const Tensor& tree_thresholds,
+                          const Tensor& node_per_class_weights,
+                          Tensor* output_predictions);
+
+  // Evaluates the tree on host memory with the CPU worker threads.
+  void ComputePredictionsOnHost(OpKernelContext* context,
+                                const Tensor& input_data,
+                                const Tensor& sparse_input_indices,
+                                const Tensor& sparse_input_values,
+                                const Tensor& tree_tensor,
+                                const Tensor& tree_thresholds,
+                                const Tensor& node_per_class_weights,
+                                Tensor* output_predictions) {
+    const int32 num_data = output_predictions->dim_size(0);
+
     // Lambdas to capture the eigen-tensors so we don't the conversion overhead
     // on each call to DecideNode.
     const auto get_dense = tensorforest::GetDenseFunctor(input_data);
@@ -221,12 +268,156 @@ class TreePredictions : public OpKernel {
     Shard(num_threads, worker_threads->workers, num_data, costPerUnit, work);
   }
 
- private:
   float valid_leaf_threshold_;
   tensorforest::TensorForestDataSpec input_spec_;
 };
 
+template <>
+void TreePredictions<CPUDevice>::ComputePredictions(
+    OpKernelContext* context, const Tensor& input_data,
+    const Tensor& sparse_input_indices, const Tensor& sparse_input_values,
+    const Tensor& tree_tensor, const Tensor& tree_thresholds,
+    const Tensor& node_per_class_weights, Tensor* output_predictions) {
+  ComputePredictionsOnHost(context, input_data, sparse_input_indices,
+                           sparse_input_values, tree_tensor, tree_thresholds,
+                           node_per_class_weights, output_predictions);
+}
+
 REGISTER_KERNEL_BUILDER(Name("TreePredictions").Device(DEVICE_CPU),
-                        TreePredictions);
+                        TreePredictions<CPUDevice>);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+namespace {
+
+perftools::gputools::DeviceMemoryBase AsDeviceMemory(const Tensor& tensor) {
+  return perftools::gputools::DeviceMemoryBase(
+      const_cast<char*>(tensor.tensor_data().data()), tensor.TotalBytes());
+}
+
+}  // namespace
+
+template <>
+void TreePredictions<GPUDevice>::ComputePredictions(
+    OpKernelContext* context, const Tensor& input_data,
+    const Tensor& sparse_input_indices, const Tensor& sparse_input_values,
+    const Tensor& tree_tensor, const Tensor& tree_thresholds,
+    const Tensor& node_per_class_weights, Tensor* output_predictions) {
+  auto* stream = context->op_device_context()->stream();
+  OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
+  AllocatorAttributes host_attr;
+  host_attr.set_on_host(true);
+  host_attr.set_gpu_compatible(true);
+
+  if (sparse_input_indices.shape().dims() == 2) {
+    // The GPU kernel only reads dense features. Sparse input is rare enough
+    // that it goes through the CPU traversal on copies of the device inputs.
+    const Tensor* device_inputs[] = {&input_data, &tree_tensor,
+                                     &tree_thresholds, &node_per_class_weights};
+    Tensor host_inputs[4];
+    for (int i = 0; i < 4; ++i) {
+      OP_REQUIRES_OK(context, context->allocate_temp(
+                                  device_inputs[i]->dtype(),
+                                  device_inputs[i]->shape(), &host_inputs[i],
+                                  host_attr));
+      if (device_inputs[i]->NumElements() > 0) {
+        stream->ThenMemcpy(
+            const_cast<char*>(host_inputs[i].tensor_data().data()),
+            AsDeviceMemory(*device_inputs[i]),
+            device_inputs[i]->TotalBytes());
+      }
+    }
+    stream->BlockHostUntilDone();
+    OP_REQUIRES(context, stream->ok(),
+                errors::Internal("Failed to copy the inputs of "
+                                 "TreePredictions to the host"));
+    Tensor host_predictions;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT,
+                                          output_predictions->shape(),
+                                          &host_predictions, host_attr));
+    ComputePredictionsOnHost(context, host_inputs[0], sparse_input_indices,
+                             sparse_input_values, host_inputs[1],
+                             host_inputs[2], host_inputs[3],
+                             &host_predictions);
+    if (!context->status().ok() || host_predictions.NumElements() == 0) {
+      return;
+    }
+    perftools::gputools::DeviceMemoryBase output =
+        AsDeviceMemory(*output_predictions);
+    stream->ThenMemcpy(&output, host_predictions.tensor_data().data(),
+                       host_predictions.TotalBytes());
+    // host_predictions has to outlive the copy.
+    stream->BlockHostUntilDone();
+    OP_REQUIRES(context, stream->ok(),
+                errors::Internal("Failed to copy the predictions of "
+                                 "TreePredictions to the GPU"));
+    return;
+  }
+
+  if (output_predictions->NumElements() == 0) {
+    return;
+  }
+  const int32 num_feature_types = input_spec_.dense_features_size();
+  Tensor feature_types;
+  OP_REQUIRES_OK(context,
+                 context->allocate_temp(DT_INT32,
+                                        TensorShape({num_feature_types + 1}),
+                                        &feature_types));
+  Tensor host_feature_types;
+  OP_REQUIRES_OK(context,
+                 context->allocate_temp(DT_INT32, feature_types.shape(),
+                                        &host_feature_types, host_attr));
+  // The last element receives the error code of the kernel.
+  auto host_types = host_feature_types.vec<int32>();
+  for (int32 i = 0; i < num_feature_types; ++i) {
+    host_types(i) = input_spec_.GetDenseFeatureType(i);
+  }
+  host_types(num_feature_types) = tensorforest::kTreePredictionsOk;
+  perftools::gputools::DeviceMemoryBase device_types =
+      AsDeviceMemory(feature_types);
+  stream->ThenMemcpy(&device_types, host_feature_types.tensor_data().data(),
+                     host_feature_types.TotalBytes());
+
+  int32* device_error = feature_types.flat<int32>().data() + num_feature_types;
+  functor::TreePredictionsDense<GPUDevice>()(
+      context->eigen_device<GPUDevice>(), input_data.matrix<float>(),
+      tree_tensor.matrix<int32>(), tree_thresholds.vec<float>(),
+      node_per_class_weights.matrix<float>(),
+      feature_types.flat<int32>().data(), num_feature_types,
+      valid_leaf_threshold_, output_predictions->matrix<float>(),
+      device_error);
+
+  perftools::gputools::DeviceMemoryBase error_memory(device_error,
+                                                     sizeof(int32));
+  stream->ThenMemcpy(&host_types(num_feature_types), error_memory,
+                     sizeof(int32));
+  stream->BlockHostUntilDone();
+  OP_REQUIRES(context, stream->ok(),
+              errors::Internal("TreePredictions failed on the GPU"));
+  switch (host_types(num_feature_types)) {
+    case tensorforest::kTreePredictionsInvalidNode:
+      context->CtxFailure(
+          errors::InvalidArgument("node_index not in valid range."));
+      break;
+    case tensorforest::kTreePredictionsInvalidFeature:
+      context->CtxFailure(
+          errors::InvalidArgument("feature not in valid range."));
+      break;
+    case tensorforest::kTreePredictionsFreeNode:
+      LOG(ERROR) << "Reached a free node, not good.";
+      break;
+    default:
+      break;
+  }
+}
+
+// The tree is read in device memory, the sparse features on the host.
+REGISTER_KERNEL_BUILDER(Name("TreePredictions")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("sparse_input_indices")
+                            .HostMemory("sparse_input_values")
+                            .HostMemory("sparse_input_shape"),
+                        TreePredictions<GPUDevice>);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 }  // namespace tensorflow
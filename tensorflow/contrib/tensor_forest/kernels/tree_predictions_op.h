@@ -0,0 +1,56 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_TREE_PREDICTIONS_OP_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_TREE_PREDICTIONS_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tensorforest {
+
+// What went wrong while traversing the tree for some example, if anything.
+enum TreePredictionsError {
+  kTreePredictionsOk = 0,
+  kTreePredictionsInvalidNode = 1,
+  kTreePredictionsFreeNode = 2,
+  kTreePredictionsInvalidFeature = 3,
+};
+
+}  // namespace tensorforest
+
+namespace functor {
+
+// Evaluates the tree for every row of dense input_data, like the CPU kernel
+// of TreePredictions. feature_types holds the DataColumnTypes of the first
+// num_feature_types features; the others are floats. On failure some examples
+// are left unset and *error is set to one of the TreePredictionsError codes.
+template <typename Device>
+struct TreePredictionsDense {
+  void operator()(const Device& d,
+                  typename TTypes<float>::ConstMatrix input_data,
+                  typename TTypes<int32>::ConstMatrix tree,
+                  typename TTypes<float>::ConstVec thresholds,
+                  typename TTypes<float>::ConstMatrix node_pcw,
+                  const int32* feature_types, int32 num_feature_types,
+                  float valid_leaf_threshold,
+                  typename TTypes<float>::Matrix predictions, int32* error);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_TREE_PREDICTIONS_OP_H_
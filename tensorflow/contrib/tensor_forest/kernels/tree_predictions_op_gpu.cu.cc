@@ -0,0 +1,138 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/contrib/tensor_forest/kernels/tree_predictions_op.h"
+
+#include "tensorflow/contrib/tensor_forest/kernels/tree_utils.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+using tensorforest::CHILDREN_INDEX;
+using tensorforest::FEATURE_INDEX;
+using tensorforest::FREE_NODE;
+using tensorforest::LEAF_NODE;
+
+// One thread per example. The node arrays are small and shared by all the
+// threads, so they are read through the cache without any staging. The
+// arithmetic follows Evaluate and GetParentWeightedMean on the CPU; the
+// products are explicitly rounded so that they are not fused into the sums.
+__global__ void TreePredictionsDenseKernel(
+    const int32 num_data, const float* input_data, const int32 num_features,
+    const int32* tree, const float* thresholds, const float* node_pcw,
+    const int32 num_nodes, const int32 num_classes,
+    const int32* feature_types, const int32 num_feature_types,
+    const float valid_leaf_threshold, float* predictions, int32* error) {
+  const int32 num_outputs = num_classes - 1;
+  GPU_1D_KERNEL_LOOP(i, num_data) {
+    float* out = predictions + static_cast<int64>(i) * num_outputs;
+    // Tree has not been grown or initialized.
+    if (tree[CHILDREN_INDEX] == FREE_NODE) {
+      for (int c = 0; c < num_outputs; ++c) {
+        out[c] = 1.0 / num_classes;
+      }
+      continue;
+    }
+
+    const float* example = input_data + static_cast<int64>(i) * num_features;
+    int32 node_index = 0;
+    int32 parent = -1;
+    // A well-formed tree reaches a leaf in fewer than num_nodes steps.
+    for (int32 depth = 0;; ++depth) {
+      if (node_index < 0 || node_index >= num_nodes || depth >= num_nodes) {
+        *error = tensorforest::kTreePredictionsInvalidNode;
+        break;
+      }
+      const int32 left_child = tree[node_index * 2 + CHILDREN_INDEX];
+      if (left_child == LEAF_NODE) {
+        const float* leaf = node_pcw + node_index * num_classes;
+        float leaf_sum = leaf[0];
+        float parent_weight = 0.0f;
+        const float* parent_data = nullptr;
+        if (parent >= 0) {
+          parent_data = node_pcw + parent * num_classes;
+          const float parent_sum = parent_data[0];
+          if (leaf_sum < valid_leaf_threshold && parent_sum >= 0) {
+            parent_weight =
+                fminf(1.0f, (valid_leaf_threshold - leaf_sum) / parent_sum);
+            leaf_sum += __fmul_rn(parent_weight, parent_sum);
+          }
+        }
+        for (int c = 0; c < num_outputs; ++c) {
+          float w = leaf[c + 1];
+          if (parent_weight > 0.0f) {
+            w += __fmul_rn(parent_weight, parent_data[c + 1]);
+          }
+          out[c] = w / leaf_sum;
+        }
+        break;
+      } else if (left_child == FREE_NODE) {
+        *error = tensorforest::kTreePredictionsFreeNode;
+        break;
+      }
+      parent = node_index;
+      const int32 feature = tree[node_index * 2 + FEATURE_INDEX];
+      if (feature < 0 || feature >= num_features) {
+        *error = tensorforest::kTreePredictionsInvalidFeature;
+        break;
+      }
+      const float value = example[feature];
+      const float bias = thresholds[node_index];
+      const bool categorical =
+          feature < num_feature_types &&
+          feature_types[feature] == tensorforest::kDataCategorical;
+      // Same decision as tensorforest::Decide.
+      node_index = left_child + (categorical ? value != bias : value >= bias);
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <>
+void TreePredictionsDense<GPUDevice>::operator()(
+    const GPUDevice& d, typename TTypes<float>::ConstMatrix input_data,
+    typename TTypes<int32>::ConstMatrix tree,
+    typename TTypes<float>::ConstVec thresholds,
+    typename TTypes<float>::ConstMatrix node_pcw, const int32* feature_types,
+    int32 num_feature_types, float valid_leaf_threshold,
+    typename TTypes<float>::Matrix predictions, int32* error) {
+  const int32 num_data = input_data.dimension(0);
+  if (num_data == 0) return;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_data, d);
+  GPU_LAUNCH_KERNEL(TreePredictionsDenseKernel,
+      dim3(config.block_count), dim3(config.thread_per_block), 0, d.stream(),
+      num_data, input_data.data(), static_cast<int32>(input_data.dimension(1)),
+      tree.data(), thresholds.data(), node_pcw.data(),
+      static_cast<int32>(tree.dimension(0)),
+      static_cast<int32>(node_pcw.dimension(1)), feature_types,
+      num_feature_types, valid_leaf_threshold, predictions.data(), error);
+}
+
+template struct TreePredictionsDense<GPUDevice>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -17,11 +17,14 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import numpy as np
+
 from tensorflow.contrib.tensor_forest.python.ops import data_ops
 from tensorflow.contrib.tensor_forest.python.ops import tensor_forest_ops
 
 from tensorflow.python.framework import test_util
 from tensorflow.python.platform import googletest
+from tensorflow.python.platform import test
 
 
 class TreePredictionsDenseTest(test_util.TensorFlowTestCase):
@@ -295,5 +298,84 @@ class TreePredictionsMixedTest(test_util.TensorFlowTestCase):
                            [0., 0., 0., 1.]], predictions.eval())
 
 
+class TreePredictionsGPUTest(test_util.TensorFlowTestCase):
+
+  def setUp(self):
+    np.random.seed(3)
+    spec_proto = data_ops.TensorForestDataSpec()
+    for name, original_type in [('f1', data_ops.DATA_FLOAT),
+                                ('f2', data_ops.DATA_FLOAT),
+                                ('f3', data_ops.DATA_CATEGORICAL)]:
+      column = spec_proto.dense.add()
+      column.name = name
+      column.original_type = original_type
+      column.size = 1
+    sparse = spec_proto.sparse.add()
+    sparse.name = 's1'
+    sparse.original_type = data_ops.DATA_FLOAT
+    sparse.size = 4
+    spec_proto.dense_features_size = 3
+    self.data_spec = spec_proto.SerializeToString()
+
+    # A complete tree of depth 6 whose node i has children 2i+1 and 2i+2.
+    num_splits = 2**6 - 1
+    num_nodes = 2 * num_splits + 1
+    self.tree = [[2 * i + 1, np.random.randint(3)] for i in range(num_splits)]
+    self.tree += [[-1, 0]] * (num_nodes - num_splits)
+    self.thresholds = np.random.randint(-2, 3, num_nodes).astype(np.float32)
+    # Few enough samples at some leaves to back off to their parents.
+    class_counts = np.random.randint(0, 4, (num_nodes, 3)).astype(np.float32)
+    self.node_pcw = np.concatenate(
+        [class_counts.sum(axis=1, keepdims=True) + 0.5, class_counts], axis=1)
+    # Small integers, so that the categorical feature often equals the
+    # threshold.
+    self.input_data = np.random.randint(-3, 4, (500, 3)).astype(np.float32)
+
+  def _Predict(self, use_gpu, sparse_indices, sparse_values, sparse_shape,
+               tree=None):
+    with self.test_session(use_gpu=use_gpu, force_gpu=use_gpu):
+      return tensor_forest_ops.tree_predictions(
+          self.input_data,
+          sparse_indices,
+          sparse_values,
+          sparse_shape,
+          self.tree if tree is None else tree,
+          self.thresholds,
+          self.node_pcw,
+          valid_leaf_threshold=5,
+          input_spec=self.data_spec).eval()
+
+  def testDenseInput(self):
+    if not test.is_gpu_available():
+      return
+    cpu_predictions = self._Predict(False, [], [], [])
+    gpu_predictions = self._Predict(True, [], [], [])
+    self.assertEqual((500, 3), gpu_predictions.shape)
+    self.assertAllClose(cpu_predictions, gpu_predictions)
+
+  def testSparseInputFallsBackToHost(self):
+    if not test.is_gpu_available():
+      return
+    sparse_indices = [[i, np.random.randint(4)] for i in range(0, 500, 7)]
+    sparse_values = np.random.randn(len(sparse_indices)).astype(np.float32)
+    sparse_shape = [500, 4]
+    # Route some splits to the sparse feature.
+    tree = [[left, feature + 3 if i % 5 == 0 and left > 0 else feature]
+            for i, (left, feature) in enumerate(self.tree)]
+    cpu_predictions = self._Predict(False, sparse_indices, sparse_values,
+                                    sparse_shape, tree=tree)
+    gpu_predictions = self._Predict(True, sparse_indices, sparse_values,
+                                    sparse_shape, tree=tree)
+    self.assertAllClose(cpu_predictions, gpu_predictions)
+
+  def testBadNode(self):
+    if not test.is_gpu_available():
+      return
+    tree = list(self.tree)
+    tree[0] = [len(tree), 0]
+    with self.assertRaisesOpError('node_index not in valid range.'):
+      self._Predict(True, [], [], [], tree=tree)
+
+
 if __name__ == '__main__':
   googletest.main()
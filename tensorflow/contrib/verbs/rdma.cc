@@ -66,6 +66,43 @@ string MessageTypeToString(RdmaMessageType rmt) {
 }
 }  // namespace
 
+RdmaMemoryMgr* RdmaMemoryMgr::Singleton() {
+  static RdmaMemoryMgr* mgr = new RdmaMemoryMgr;
+  return mgr;
+}
+
+void RdmaMemoryMgr::SetProtectionDomain(ibv_pd* pd) {
+  mutex_lock l(mu_);
+  CHECK(pd_ == nullptr) << "The protection domain is already set";
+  pd_ = pd;
+}
+
+void RdmaMemoryMgr::InsertMemoryRegion(void* addr, size_t length) {
+  if (length == 0) return;
+  mutex_lock l(mu_);
+  CHECK(pd_ != nullptr);
+  ibv_mr* mr = ibv_reg_mr(pd_, addr, length, IBV_ACCESS_LOCAL_WRITE);
+  if (mr == nullptr) {
+    // The tensors in this region are copied before being written.
+    LOG(WARNING) << "Cannot register " << length << " bytes at " << addr
+                 << " with the RDMA adapter";
+    return;
+  }
+  VLOG(1) << "Registered " << length << " bytes at " << addr;
+  mrs_[static_cast<const char*>(addr)] = mr;
+}
+
+ibv_mr* RdmaMemoryMgr::FindMemoryRegion(const void* addr, size_t length) {
+  const char* p = static_cast<const char*>(addr);
+  mutex_lock l(mu_);
+  auto it = mrs_.upper_bound(p);
+  if (it == mrs_.begin()) return nullptr;
+  --it;
+  ibv_mr* mr = it->second;
+  if (p + length > it->first + mr->length) return nullptr;
+  return mr;
+}
+
 ibv_context* open_default_device() {
   ibv_device** dev_list;
   ibv_device* ib_dev;
@@ -219,6 +256,7 @@ void RdmaAdapter::Process_CQ() {
         }
       } else if (wc_[i].opcode == IBV_WC_RDMA_WRITE) {
         RdmaBuffer* rb = reinterpret_cast<RdmaBuffer*>(wc_[i].wr_id);
+        rb->WriteCompleted();
         rb->SetBufferStatus(local, idle);
         RdmaMessage rm;
         RdmaMessage::ParseMessage(rm, rb->buffer_);
@@ -242,7 +280,8 @@ RdmaChannel::RdmaChannel(const RdmaAdapter* adapter, const string local_name,
     attr.recv_cq = adapter_->cq_;
     attr.cap.max_send_wr = RdmaAdapter::MAX_CONCURRENT_WRITES;
     attr.cap.max_recv_wr = RdmaAdapter::MAX_CONCURRENT_WRITES;
-    attr.cap.max_send_sge = 1;
+    // A tensor in registered memory is written with a second entry.
+    attr.cap.max_send_sge = 2;
     attr.cap.max_recv_sge = 1;
     attr.qp_type = IBV_QPT_RC;
 
@@ -615,6 +654,41 @@ void RdmaBuffer::Write(uint32_t imm_data, size_t buffer_size) {
   CHECK(!ibv_post_send(channel_->qp_, &wr, &bad_wr)) << "Failed to post send";
 }
 
+void RdmaBuffer::Write(uint32_t imm_data, size_t header_size, const void* data,
+                       size_t data_size, ibv_mr* data_mr,
+                       const Tensor& tensor) {
+  {
+    mutex_lock lock{mu_};
+    written_tensor_ = tensor;
+  }
+  struct ibv_sge list[2];
+  list[0].addr = (uint64_t)buffer_;
+  list[0].length = header_size;
+  list[0].lkey = self_->lkey;
+  list[1].addr = (uint64_t)data;
+  list[1].length = data_size;
+  list[1].lkey = data_mr->lkey;
+
+  struct ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = (uint64_t)this;
+  wr.sg_list = list;
+  wr.num_sge = 2;
+  wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  wr.send_flags = IBV_SEND_SIGNALED;
+  wr.imm_data = imm_data;
+  wr.wr.rdma.remote_addr = (uint64_t)remote_.remote_addr;
+  wr.wr.rdma.rkey = remote_.rkey;
+
+  struct ibv_send_wr* bad_wr;
+  CHECK(!ibv_post_send(channel_->qp_, &wr, &bad_wr)) << "Failed to post send";
+}
+
+void RdmaBuffer::WriteCompleted() {
+  mutex_lock lock{mu_};
+  written_tensor_ = Tensor();
+}
+
 RdmaAckBuffer::RdmaAckBuffer(RdmaChannel* channel, string name)
     : RdmaBuffer(channel, name) {}
 
@@ -709,17 +783,30 @@ void RdmaTensorBuffer::SendNextItem() {
       Tensor copy;
       StringPiece copy_buf;
       TensorProto proto;
+      // The registered region holding copy_buf, if any.
+      ibv_mr* data_mr = nullptr;
       if (src_dev->tensorflow_gpu_device_info() &&
           (!send_args.alloc_attrs.on_host())) {
         CHECK(send_args.device_context)
           << "send dev name: " << src_dev->name()
           << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
 
-        if (can_memcpy) {
+        if (can_memcpy && !is_dead) {
+          // With GPUDirect RDMA, GPU memory is registered as well, and the
+          // adapter reads the tensor once the kernels producing it are done.
+          data_mr = RdmaMemoryMgr::Singleton()->FindMemoryRegion(
+              DMAHelper::base(&in), in.TotalBytes());
+        }
+        if (data_mr != nullptr) {
+          CHECK(send_args.device_context->stream()->BlockHostUntilDone())
+              << "sync gpu stream";
+          copy = in;
+          copy_buf = copy.tensor_data();
+        } else if (can_memcpy) {
           AllocatorAttributes host_alloc_attrs;
           host_alloc_attrs.set_gpu_compatible(true);
           host_alloc_attrs.set_on_host(true);
-          Allocator* alloc = ProcessState::singleton()->GetCUDAHostAllocator(0);
+          Allocator* alloc = ProcessState::singleton()->GetROCMHostAllocator(0);
           copy = Tensor(alloc, in.dtype(), in.shape());
           s = VerbsUtil::CopyGPUTensorToCPUSync(
               src_dev, send_args.device_context, &in, &copy);
@@ -734,11 +821,19 @@ void RdmaTensorBuffer::SendNextItem() {
       } else {
         // tensor is in CPU memory.
         if (can_memcpy) {
-          copy_buf = in.tensor_data();
+          copy = in;
+          copy_buf = copy.tensor_data();
         } else {
           in.AsProtoTensorContent(&proto);
         }
       }
+      if (data_mr == nullptr && can_memcpy && !is_dead &&
+          !copy_buf.empty()) {
+        // The staging copy, or the tensor itself, may be in registered
+        // host memory.
+        data_mr = RdmaMemoryMgr::Singleton()->FindMemoryRegion(
+            copy_buf.data(), copy_buf.size());
+      }
       if (can_memcpy) {
         tensor_bytes = in.TotalBytes();
       } else {
@@ -793,6 +888,16 @@ void RdmaTensorBuffer::SendNextItem() {
         rm.type_ = RDMA_MESSAGE_TENSOR_WRITE;
         string message = RdmaMessage::CreateMessage(rm);
         memcpy(buffer_, message.data(), message.size());
+        if (!is_dead && data_mr != nullptr) {
+          // write the tensor buffer content from where it is
+          CHECK(copy_buf.size() == tensor_bytes)
+              << "unexpected tensor size: " << copy_buf.size()
+              << " != " << tensor_bytes;
+          CHECK(tensor_bytes + RdmaMessage::kTensorBufferStartIndex <= size_);
+          Write(imm_data, RdmaMessage::kTensorBufferStartIndex, copy_buf.data(),
+                tensor_bytes, data_mr, copy);
+          return;
+        }
         if (!is_dead) {
           // copy the tensor buffer content
           void* output =
@@ -21,6 +21,7 @@ limitations under the License.
 #include <infiniband/verbs.h>
 #include <cstring>  // for memset
 #include <functional>
+#include <map>
 #include <memory>  // for shared_ptr
 #include <queue>
 #include <string>
@@ -28,9 +29,11 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
@@ -60,6 +63,36 @@ enum RdmaMessageType {
   RDMA_MESSAGE_TENSOR_WRITE
 };
 class RdmaBuffer;
+
+// Class that keeps track of the memory regions registered with the
+// protection domain of the adapter, as they are allocated by the
+// allocators of ProcessState. A tensor in one of these regions is written
+// to the remote buffer directly, without being copied first.
+class RdmaMemoryMgr {
+ public:
+  static RdmaMemoryMgr* Singleton();
+
+  // Must be called once, before any region is inserted.
+  void SetProtectionDomain(ibv_pd* pd);
+
+  // Registers the "length" bytes at "addr" with the protection domain.
+  void InsertMemoryRegion(void* addr, size_t length);
+
+  // Returns the registered region holding the "length" bytes at "addr",
+  // or nullptr if there is none.
+  ibv_mr* FindMemoryRegion(const void* addr, size_t length);
+
+ private:
+  RdmaMemoryMgr() {}
+
+  mutex mu_;
+  ibv_pd* pd_ GUARDED_BY(mu_) = nullptr;
+  // The registered regions, keyed by their start address.
+  std::map<const char*, ibv_mr*> mrs_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaMemoryMgr);
+};
+
 // Class that represents the Rdma Adapter.
 // Responsible for creation of the completion queue, and handling
 // of work completions.
@@ -188,6 +221,13 @@ class RdmaBuffer {
     return const_cast<RdmaChannel*>(channel_)->LookupBufferIndex(buffer_name);
   }
   void Write(uint32_t imm_data, size_t buffer_size);
+  // Writes the first "header_size" bytes of the buffer, followed by the
+  // "data_size" bytes at "data", which are in the registered region
+  // "data_mr". "tensor" holds "data" until the write has completed.
+  void Write(uint32_t imm_data, size_t header_size, const void* data,
+             size_t data_size, ibv_mr* data_mr, const Tensor& tensor);
+  // Called once a write of the buffer has completed.
+  void WriteCompleted();
 
  protected:
   const RdmaChannel* channel_;
@@ -199,6 +239,8 @@ class RdmaBuffer {
   mutex mu_;
   RemoteMR remote_;
   std::queue<string> queue_ GUARDED_BY(mu_);
+  // The tensor whose buffer is being written without a copy, if any.
+  Tensor written_tensor_ GUARDED_BY(mu_);
   BufferStatus local_status_ GUARDED_BY(mu_) = none;
   BufferStatus remote_status_ GUARDED_BY(mu_) = none;
 };
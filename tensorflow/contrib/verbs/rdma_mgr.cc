@@ -19,16 +19,56 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/contrib/verbs/grpc_verbs_client.h"
 #include "tensorflow/contrib/verbs/verbs_service.pb.h"
+#include "tensorflow/core/common_runtime/gpu/process_state.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Returns true if the kernel module letting the adapter access GPU memory
+// (GPUDirect RDMA) is loaded.
+bool IsGDRAvailable() {
+  string modules;
+  if (!ReadFileToString(Env::Default(), "/proc/modules", &modules).ok()) {
+    return false;
+  }
+  for (StringPiece line : str_util::Split(modules, '\n')) {
+    if (line.starts_with("amdp2p ")) return true;
+  }
+  return false;
+}
+
+// Returns the NUMA node the adapter is attached to, or -1 if unknown.
+int TryToReadNumaNode(ibv_device* device) {
+  string content;
+  if (!ReadFileToString(Env::Default(),
+                        strings::StrCat(device->ibdev_path, "/device/numa_node"),
+                        &content)
+           .ok()) {
+    return -1;
+  }
+  str_util::StripTrailingWhitespace(&content);
+  int32 node;
+  if (!strings::safe_strto32(content, &node)) {
+    return -1;
+  }
+  return node;
+}
+
+}  // namespace
+
 RdmaMgr::RdmaMgr(const WorkerEnv* const worker_env,
                  GrpcChannelCache* const channel_cache)
     : worker_env_(worker_env), channel_cache_(channel_cache) {
   rdma_adapter_ = new RdmaAdapter(worker_env_);
+  InitAllocators();
   // hardcoded to default session (legacy_session_)
   // TODO: use WorkerSessionForSession
   // need to pass in session handle
@@ -121,6 +161,23 @@ RdmaMgr::~RdmaMgr() {
   delete rdma_adapter_;
 }
 
+void RdmaMgr::InitAllocators() {
+  RdmaMemoryMgr* mgr = RdmaMemoryMgr::Singleton();
+  mgr->SetProtectionDomain(rdma_adapter_->pd_);
+  ProcessState::AllocVisitor visitor = [mgr](void* ptr, size_t num_bytes) {
+    mgr->InsertMemoryRegion(ptr, num_bytes);
+  };
+  // The pinned host memory holds the tensors of the CPU devices on machines
+  // with GPUs, and the staging copies of GPU tensors.
+  ProcessState::singleton()->AddROCMHostAllocVisitor(visitor);
+  if (IsGDRAvailable()) {
+    // AddGPUAllocVisitor() expects the NUMA node plus one.
+    const int bus_id = TryToReadNumaNode(rdma_adapter_->context_->device) + 1;
+    ProcessState::singleton()->AddGPUAllocVisitor(bus_id, visitor);
+    LOG(INFO) << "GPUDirect RDMA is enabled for the GPUs of bus " << bus_id;
+  }
+}
+
 // Find a channel via the given name.
 // Args:
 //   name: peer name, e.g. worker1
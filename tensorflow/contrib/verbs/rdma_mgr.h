@@ -37,6 +37,10 @@ class RdmaMgr {
   const string& local_worker() { return local_worker_; }
 
  private:
+  // Registers the memory of the ProcessState allocators with the adapter,
+  // so that tensors allocated in it are sent without being copied.
+  void InitAllocators();
+
   string local_worker_;
   size_t num_remote_workers_;
   const WorkerEnv* const worker_env_;
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
+#include <functional>
+#include <thread>
+
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
@@ -24,15 +27,86 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* bfc_bin_free_chunks = monitoring::Gauge<2>::New(
+    "/tensorflow/core/bfc_allocator/bin_free_chunks",
+    "The number of free chunks in a bin of a BFC allocator.", "allocator",
+    "bin_size");
+
+auto* bfc_bin_free_bytes = monitoring::Gauge<2>::New(
+    "/tensorflow/core/bfc_allocator/bin_free_bytes",
+    "The total size of the free chunks in a bin of a BFC allocator.",
+    "allocator", "bin_size");
+
+auto* bfc_bytes_in_use = monitoring::Gauge<1>::New(
+    "/tensorflow/core/bfc_allocator/bytes_in_use",
+    "The number of bytes in use in a BFC allocator, including the chunks held "
+    "by its size-class caches.",
+    "allocator");
+
+auto* bfc_largest_free_chunk = monitoring::Gauge<1>::New(
+    "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+    "The size of the largest free chunk of a BFC allocator.", "allocator");
+
+auto* bfc_fragmentation = monitoring::Gauge<1>::New(
+    "/tensorflow/core/bfc_allocator/fragmentation",
+    "The fraction of the free memory of a BFC allocator that is not in its "
+    "largest free chunk, in thousandths.",
+    "allocator");
+
+// Buckets of [256B, 512B, ..., 64GiB].
+std::vector<double> AllocationBytesBuckets() {
+  std::vector<double> buckets;
+  for (double limit = 256; limit <= (int64{1} << 36); limit *= 2) {
+    buckets.push_back(limit);
+  }
+  return buckets;
+}
+
+auto* bfc_allocation_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/allocation_bytes",
+     "The requested sizes of the allocations served by the bins of a BFC "
+     "allocator. Allocations served by the size-class caches are not "
+     "sampled.",
+     "allocator"},
+    AllocationBytesBuckets());
+
+int NumSizeClassCachesFromEnv() {
+  int64 num_caches = 0;
+  Status s = ReadInt64FromEnvVar("TF_BFC_ALLOCATOR_NUM_CACHES", 0, &num_caches);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return 0;
+  }
+  return static_cast<int>(num_caches);
+}
+
+}  // namespace
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name)
+    : BFCAllocator(sub_allocator, total_memory, allow_growth, name,
+                   NumSizeClassCachesFromEnv()) {}
+
+BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
+                           bool allow_growth, const string& name,
+                           int num_size_class_caches)
     : suballocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      client_bytes_in_use_(0),
+      client_max_bytes_in_use_(0),
+      num_cache_hits_(0),
+      bytes_in_use_cell_(bfc_bytes_in_use->GetCell(name)),
+      largest_free_chunk_cell_(bfc_largest_free_chunk->GetCell(name)),
+      fragmentation_cell_(bfc_fragmentation->GetCell(name)),
+      allocation_bytes_cell_(bfc_allocation_bytes->GetCell(name)) {
   if (allow_growth) {
     // 1MiB smallest initial allocation, unless total memory available
     // is less.
@@ -55,7 +129,10 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
     size_t bin_size = BinNumToSize(b);
     VLOG(1) << "Creating bin of max chunk size "
             << strings::HumanReadableNumBytes(bin_size);
-    new (BinFromIndex(b)) Bin(this, bin_size);
+    Bin* bin = new (BinFromIndex(b)) Bin(this, bin_size);
+    const string bin_label = strings::StrCat(bin_size);
+    bin->free_chunks_cell = bfc_bin_free_chunks->GetCell(name, bin_label);
+    bin->free_bytes_cell = bfc_bin_free_bytes->GetCell(name, bin_label);
     CHECK_EQ(BinForSize(bin_size), BinFromIndex(b));
     CHECK_EQ(BinForSize(bin_size + 255), BinFromIndex(b));
     CHECK_EQ(BinForSize(bin_size * 2 - 1), BinFromIndex(b));
@@ -63,6 +140,10 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  for (int i = 0; i < num_size_class_caches; ++i) {
+    size_class_caches_.emplace_back(new SizeClassCache);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -249,21 +330,38 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  const bool use_cache = !size_class_caches_.empty() &&
+                         rounded_bytes <= kMaxCachedAllocationSize;
+  if (use_cache) {
+    void* ptr = AllocateFromSizeClassCache(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
   mutex_lock l(lock_);
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
-  if (ptr != nullptr) {
-    return ptr;
+  if (ptr == nullptr) {
+    // Try to extend
+    if (Extend(rounded_bytes)) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+    }
   }
-
-  // Try to extend
-  if (Extend(rounded_bytes)) {
+  if (ptr == nullptr && !size_class_caches_.empty()) {
+    // The memory may be sitting free in the caches.
+    FlushSizeClassCachesLocked();
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
-    if (ptr != nullptr) {
-      return ptr;
+  }
+  UpdateMemoryMetrics();
+  if (ptr != nullptr) {
+    allocation_bytes_cell_->Add(num_bytes);
+    if (use_cache) {
+      AddCachedChunk(ptr, *ChunkFromHandle(region_manager_.get_handle(ptr)));
     }
+    return ptr;
   }
 
   // We searched all bins for an existing free chunk to use and
@@ -320,6 +418,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
         stats_.max_alloc_size =
             std::max<std::size_t>(stats_.max_alloc_size, chunk->size);
+        if (!size_class_caches_.empty()) {
+          RecordClientAlloc(chunk->size);
+        }
 
         VLOG(4) << "Returning: " << chunk->ptr;
         if (VLOG_IS_ON(4)) {
@@ -378,14 +479,21 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     LOG(ERROR) << "tried to deallocate nullptr";
     return;
   }
+  if (!size_class_caches_.empty() && DeallocateToSizeClassCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
 
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
+  if (!size_class_caches_.empty()) {
+    RecordClientDealloc(ChunkFromHandle(h)->size);
+  }
 
   // Consider coalescing it.
   FreeAndMaybeCoalesce(h);
+  UpdateMemoryMetrics();
 
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
@@ -438,6 +546,10 @@ void BFCAllocator::InsertFreeChunkIntoBin(BFCAllocator::ChunkHandle h) {
   Bin* new_bin = BinFromIndex(bin_num);
   c->bin_num = bin_num;
   new_bin->free_chunks.insert(h);
+  new_bin->free_bytes += c->size;
+  free_bytes_ += c->size;
+  new_bin->free_chunks_cell->Set(new_bin->free_chunks.size());
+  new_bin->free_bytes_cell->Set(new_bin->free_bytes);
 }
 
 void BFCAllocator::RemoveFreeChunkIterFromBin(
@@ -447,14 +559,23 @@ void BFCAllocator::RemoveFreeChunkIterFromBin(
   Chunk* c = ChunkFromHandle(h);
   CHECK(!c->in_use() && (c->bin_num != kInvalidBinNum));
   free_chunks->erase(citer);
+  Bin* bin = BinFromIndex(c->bin_num);
+  bin->free_bytes -= c->size;
+  free_bytes_ -= c->size;
+  bin->free_chunks_cell->Set(bin->free_chunks.size());
+  bin->free_bytes_cell->Set(bin->free_bytes);
   c->bin_num = kInvalidBinNum;
 }
 
 void BFCAllocator::RemoveFreeChunkFromBin(BFCAllocator::ChunkHandle h) {
   Chunk* c = ChunkFromHandle(h);
   CHECK(!c->in_use() && (c->bin_num != kInvalidBinNum));
-  CHECK_GT(BinFromIndex(c->bin_num)->free_chunks.erase(h), 0)
-      << "Could not find chunk in bin";
+  Bin* bin = BinFromIndex(c->bin_num);
+  CHECK_GT(bin->free_chunks.erase(h), 0) << "Could not find chunk in bin";
+  bin->free_bytes -= c->size;
+  free_bytes_ -= c->size;
+  bin->free_chunks_cell->Set(bin->free_chunks.size());
+  bin->free_bytes_cell->Set(bin->free_bytes);
   c->bin_num = kInvalidBinNum;
 }
 
@@ -507,6 +628,23 @@ void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
   InsertFreeChunkIntoBin(chunk_to_reassign);
 }
 
+void BFCAllocator::UpdateMemoryMetrics() {
+  // The free chunks of a bin are sorted by size, so the largest one is the
+  // last chunk of the largest non-empty bin.
+  size_t largest_free_chunk = 0;
+  for (BinNum b = kNumBins - 1; b >= 0; --b) {
+    const Bin* bin = BinFromIndex(b);
+    if (!bin->free_chunks.empty()) {
+      largest_free_chunk = ChunkFromHandle(*bin->free_chunks.rbegin())->size;
+      break;
+    }
+  }
+  bytes_in_use_cell_->Set(stats_.bytes_in_use);
+  largest_free_chunk_cell_->Set(largest_free_chunk);
+  fragmentation_cell_->Set(
+      free_bytes_ == 0 ? 0 : 1000 - largest_free_chunk * 1000 / free_bytes_);
+}
+
 void BFCAllocator::AddAllocVisitor(Visitor visitor) {
   VLOG(1) << "AddVisitor";
   mutex_lock l(lock_);
@@ -519,6 +657,10 @@ void BFCAllocator::AddAllocVisitor(Visitor visitor) {
 bool BFCAllocator::TracksAllocationSizes() { return true; }
 
 size_t BFCAllocator::RequestedSize(void* ptr) {
+  CachedChunk cached;
+  if (FindCachedChunk(ptr, &cached)) {
+    return cached.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -537,6 +679,10 @@ size_t BFCAllocator::AllocatedSize(void* ptr) {
 }
 
 int64 BFCAllocator::AllocationId(void* ptr) {
+  CachedChunk cached;
+  if (FindCachedChunk(ptr, &cached)) {
+    return cached.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -705,6 +851,161 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
 void BFCAllocator::GetStats(AllocatorStats* stats) {
   mutex_lock l(lock_);
   *stats = stats_;
+  if (!size_class_caches_.empty()) {
+    stats->num_allocs += num_cache_hits_.load(std::memory_order_relaxed);
+    stats->bytes_in_use = client_bytes_in_use_.load(std::memory_order_relaxed);
+    stats->max_bytes_in_use =
+        client_max_bytes_in_use_.load(std::memory_order_relaxed);
+  }
+}
+
+BFCAllocator::SizeClassCache* BFCAllocator::ThreadCache() {
+  const size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return size_class_caches_[h % size_class_caches_.size()].get();
+}
+
+BFCAllocator::SizeClassCache* BFCAllocator::HomeCache(const void* ptr) {
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return size_class_caches_[(p >> kMinAllocationBits) %
+                            size_class_caches_.size()]
+      .get();
+}
+
+void* BFCAllocator::AllocateFromSizeClassCache(size_t rounded_bytes,
+                                               size_t num_bytes) {
+  void* ptr = nullptr;
+  {
+    SizeClassCache* cache = ThreadCache();
+    mutex_lock l(cache->mu);
+    std::vector<void*>* free_chunks =
+        &cache->free_chunks[SizeClassForBytes(rounded_bytes)];
+    if (free_chunks->empty()) {
+      return nullptr;
+    }
+    ptr = free_chunks->back();
+    free_chunks->pop_back();
+    cache->free_bytes -= rounded_bytes;
+  }
+  size_t size = 0;
+  {
+    SizeClassCache* home = HomeCache(ptr);
+    mutex_lock l(home->mu);
+    auto it = home->chunks.find(ptr);
+    CHECK(it != home->chunks.end());
+    CachedChunk* c = &it->second;
+    c->requested_size = num_bytes;
+    c->allocation_id = next_allocation_id_++;
+    size = c->size;
+  }
+  num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  RecordClientAlloc(size);
+  return ptr;
+}
+
+void BFCAllocator::AddCachedChunk(void* ptr, const Chunk& chunk) {
+  CachedChunk c;
+  c.size = chunk.size;
+  c.requested_size = chunk.requested_size;
+  c.allocation_id = chunk.allocation_id;
+  c.size_class = SizeClassForBytes(RoundedBytes(chunk.requested_size));
+  SizeClassCache* home = HomeCache(ptr);
+  mutex_lock l(home->mu);
+  home->chunks[ptr] = c;
+}
+
+bool BFCAllocator::DeallocateToSizeClassCache(void* ptr) {
+  CachedChunk c;
+  {
+    SizeClassCache* home = HomeCache(ptr);
+    mutex_lock l(home->mu);
+    auto it = home->chunks.find(ptr);
+    if (it == home->chunks.end()) {
+      return false;
+    }
+    it->second.allocation_id = -1;
+    c = it->second;
+  }
+  RecordClientDealloc(c.size);
+  std::vector<void*> to_release;
+  {
+    SizeClassCache* cache = ThreadCache();
+    mutex_lock l(cache->mu);
+    cache->free_chunks[c.size_class].push_back(ptr);
+    cache->free_bytes += (c.size_class + 1) * kMinAllocationSize;
+    if (cache->free_bytes > kMaxCachedBytesPerCache) {
+      for (auto& free_chunks : cache->free_chunks) {
+        to_release.insert(to_release.end(), free_chunks.begin(),
+                          free_chunks.end());
+        free_chunks.clear();
+      }
+      cache->free_bytes = 0;
+    }
+  }
+  if (!to_release.empty()) {
+    mutex_lock l(lock_);
+    ReleaseCachedChunks(to_release);
+    UpdateMemoryMetrics();
+  }
+  return true;
+}
+
+void BFCAllocator::ReleaseCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    {
+      SizeClassCache* home = HomeCache(ptr);
+      mutex_lock l(home->mu);
+      home->chunks.erase(ptr);
+    }
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    FreeAndMaybeCoalesce(h);
+  }
+}
+
+void BFCAllocator::FlushSizeClassCaches() {
+  if (size_class_caches_.empty()) return;
+  mutex_lock l(lock_);
+  FlushSizeClassCachesLocked();
+  UpdateMemoryMetrics();
+}
+
+void BFCAllocator::FlushSizeClassCachesLocked() {
+  std::vector<void*> to_release;
+  for (const auto& cache : size_class_caches_) {
+    mutex_lock l(cache->mu);
+    for (auto& free_chunks : cache->free_chunks) {
+      to_release.insert(to_release.end(), free_chunks.begin(),
+                        free_chunks.end());
+      free_chunks.clear();
+    }
+    cache->free_bytes = 0;
+  }
+  VLOG(2) << "Flushing " << to_release.size() << " cached chunks";
+  ReleaseCachedChunks(to_release);
+}
+
+bool BFCAllocator::FindCachedChunk(const void* ptr, CachedChunk* chunk) {
+  if (size_class_caches_.empty()) return false;
+  SizeClassCache* home = HomeCache(ptr);
+  mutex_lock l(home->mu);
+  auto it = home->chunks.find(ptr);
+  if (it == home->chunks.end()) return false;
+  *chunk = it->second;
+  return true;
+}
+
+void BFCAllocator::RecordClientAlloc(size_t bytes) {
+  const int64 in_use =
+      client_bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  int64 max_in_use = client_max_bytes_in_use_.load(std::memory_order_relaxed);
+  while (in_use > max_in_use &&
+         !client_max_bytes_in_use_.compare_exchange_weak(
+             max_in_use, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void BFCAllocator::RecordClientDealloc(size_t bytes) {
+  client_bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
 }
 
 }  // namespace tensorflow
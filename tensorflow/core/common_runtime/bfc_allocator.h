@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 #define TENSORFLOW_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -41,11 +44,34 @@ namespace tensorflow {
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// Optionally, small allocations are served from a number of size-class
+// caches sitting in front of the bins, so that threads allocating and
+// freeing small temporaries mostly do not contend on the global lock.
+// A chunk freed into a cache stays allocated from the point of view of the
+// bins until the cache is flushed, which happens when the cache holds too
+// many free bytes, when an allocation cannot be satisfied otherwise, or on
+// FlushSizeClassCaches(). GetStats() only counts the chunks handed out to
+// clients as in use.
+//
+// The occupancy of the bins, the largest free chunk and the fragmentation
+// of the free memory are exported as gauges under
+// /tensorflow/core/bfc_allocator/, labeled by the name of the allocator,
+// along with a histogram of the sizes of the allocations served by the
+// bins.
 class BFCAllocator : public VisitableAllocator {
  public:
-  // Takes ownership of sub_allocator.
+  // Takes ownership of sub_allocator. The number of size-class caches is
+  // read from the environment variable TF_BFC_ALLOCATOR_NUM_CACHES, and
+  // defaults to 0 (no caching).
   BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                bool allow_growth, const string& name);
+  // Same as above, with "num_size_class_caches" caches. Threads are mapped
+  // to the caches by their id, so this is typically the number of threads
+  // that allocate from this allocator.
+  BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
+               bool allow_growth, const string& name,
+               int num_size_class_caches);
   ~BFCAllocator() override;
 
   string Name() override { return name_; }
@@ -69,6 +95,9 @@ class BFCAllocator : public VisitableAllocator {
 
   void GetStats(AllocatorStats* stats) override;
 
+  // Returns the free chunks held by the size-class caches to the bins.
+  void FlushSizeClassCaches();
+
  private:
   struct Bin;
 
@@ -167,6 +196,11 @@ class BFCAllocator : public VisitableAllocator {
     // List of free chunks within the bin, sorted by chunk size.
     // Chunk * not owned.
     FreeChunkSet free_chunks;
+    // The total size of free_chunks.
+    size_t free_bytes = 0;
+    // Export the number of chunks in free_chunks, and free_bytes.
+    monitoring::GaugeCell* free_chunks_cell = nullptr;
+    monitoring::GaugeCell* free_bytes_cell = nullptr;
     Bin(BFCAllocator* allocator, size_t bs)
         : bin_size(bs), free_chunks(ChunkComparator(allocator)) {}
   };
@@ -174,6 +208,71 @@ class BFCAllocator : public VisitableAllocator {
   static const size_t kMinAllocationBits = 8;
   static const size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // Allocations of up to kMaxCachedAllocationSize bytes go through the
+  // size-class caches, with one size class per multiple of
+  // kMinAllocationSize. A cache holding more than kMaxCachedBytesPerCache
+  // free bytes is flushed back to the bins.
+  static const size_t kMaxCachedAllocationSize = 64 << 10;
+  static const int kNumSizeClasses =
+      kMaxCachedAllocationSize / kMinAllocationSize;
+  static const size_t kMaxCachedBytesPerCache = 16 << 20;
+
+  // The metadata of a chunk that went through the size-class caches. Such a
+  // chunk is in use from the point of view of the bins, so the client
+  // visible fields are tracked here instead of in its Chunk.
+  struct CachedChunk {
+    size_t size = 0;
+    size_t requested_size = 0;
+    int64 allocation_id = -1;
+    int size_class = 0;
+  };
+
+  // One size-class cache. "free_bytes" counts the size class bytes of the
+  // chunks in "free_chunks". A free chunk sits in the free list of the cache
+  // of the thread that freed it, while its CachedChunk lives in the cache
+  // its address maps to, so that a chunk freed by a different thread than
+  // the one that allocated it can still be found without the global lock.
+  //
+  // The mutex of a cache is never held while acquiring lock_ or the mutex
+  // of another cache.
+  struct SizeClassCache {
+    mutex mu;
+    std::vector<void*> free_chunks[kNumSizeClasses] GUARDED_BY(mu);
+    size_t free_bytes GUARDED_BY(mu) = 0;
+    std::unordered_map<const void*, CachedChunk> chunks GUARDED_BY(mu);
+  };
+
+  static int SizeClassForBytes(size_t rounded_bytes) {
+    return static_cast<int>(rounded_bytes / kMinAllocationSize) - 1;
+  }
+  // The cache holding the free lists of the calling thread.
+  SizeClassCache* ThreadCache();
+  // The cache holding the CachedChunk of "ptr".
+  SizeClassCache* HomeCache(const void* ptr);
+
+  // Returns a chunk of "rounded_bytes" from the cache of the calling thread,
+  // or nullptr if that cache has none.
+  void* AllocateFromSizeClassCache(size_t rounded_bytes, size_t num_bytes);
+  // Records the chunk at "ptr", just allocated from the bins, as going
+  // through the size-class caches.
+  void AddCachedChunk(void* ptr, const Chunk& chunk)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Frees "ptr" into the cache of the calling thread if it went through the
+  // size-class caches. Returns false otherwise.
+  bool DeallocateToSizeClassCache(void* ptr);
+  // Returns the free chunks "ptrs", taken out of the caches, to the bins.
+  void ReleaseCachedChunks(const std::vector<void*>& ptrs)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void FlushSizeClassCachesLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Looks up the CachedChunk of "ptr" into "*chunk". Returns false if "ptr"
+  // did not go through the size-class caches.
+  bool FindCachedChunk(const void* ptr, CachedChunk* chunk);
+
+  // Updates the client visible stats, used when the size-class caches are
+  // enabled.
+  void RecordClientAlloc(size_t bytes);
+  void RecordClientDealloc(size_t bytes);
+
   // AllocationRegion maps pointers to ChunkHandles for a single
   // contiguous memory region.
   //
@@ -336,6 +435,9 @@ class BFCAllocator : public VisitableAllocator {
   // Removes the chunk metadata represented by 'h'.
   void DeleteChunk(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Sets the gauges exporting the state of the free memory.
+  void UpdateMemoryMetrics() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   string RenderOccupancy() EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void DumpMemoryLog(size_t num_bytes) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -405,12 +507,32 @@ class BFCAllocator : public VisitableAllocator {
   std::vector<Visitor> region_visitors_;
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64 next_allocation_id_ GUARDED_BY(lock_);
+  // newly-created chunk. Atomic, since the size-class caches assign ids
+  // without holding lock_.
+  std::atomic<int64> next_allocation_id_;
 
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
 
+  // The total size of the chunks in the bins.
+  size_t free_bytes_ GUARDED_BY(lock_) = 0;
+
+  // Cells of the metrics labeled by name_. Not owned.
+  monitoring::GaugeCell* const bytes_in_use_cell_;
+  monitoring::GaugeCell* const largest_free_chunk_cell_;
+  monitoring::GaugeCell* const fragmentation_cell_;
+  monitoring::SamplerCell* const allocation_bytes_cell_;
+
+  // Empty if the size-class caches are disabled. Immutable after
+  // construction.
+  std::vector<std::unique_ptr<SizeClassCache>> size_class_caches_;
+
+  // When the size-class caches are enabled, stats_ counts the chunks held
+  // by the caches as in use, so the client visible stats are kept here.
+  std::atomic<int64> client_bytes_in_use_;
+  std::atomic<int64> client_max_bytes_in_use_;
+  std::atomic<int64> num_cache_hits_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
 
@@ -0,0 +1,239 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TestSubAllocator : public SubAllocator {
+ public:
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    return port::AlignedMalloc(num_bytes, alignment);
+  }
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+};
+
+void CheckStats(Allocator* a, int64 num_allocs, int64 bytes_in_use,
+                int64 max_bytes_in_use) {
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, num_allocs);
+  EXPECT_EQ(stats.bytes_in_use, bytes_in_use);
+  EXPECT_EQ(stats.max_bytes_in_use, max_bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, NoCaches) {
+  BFCAllocator a(new TestSubAllocator, 1 << 20, false, "test", 0);
+  void* p1 = a.AllocateRaw(32, 1000);
+  void* p2 = a.AllocateRaw(32, 1000);
+  EXPECT_NE(p1, p2);
+  CheckStats(&a, 2, 2048, 2048);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  CheckStats(&a, 2, 0, 2048);
+}
+
+TEST(BFCAllocatorTest, CachedChunkIsReused) {
+  BFCAllocator a(new TestSubAllocator, 1 << 20, false, "test", 1);
+  void* p1 = a.AllocateRaw(32, 1000);
+  EXPECT_EQ(1000, a.RequestedSize(p1));
+  EXPECT_EQ(1024, a.AllocatedSize(p1));
+  const int64 id1 = a.AllocationId(p1);
+  CheckStats(&a, 1, 1024, 1024);
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 1024);
+
+  // A request of the same size class gets the cached chunk back, with a
+  // new allocation id and requested size.
+  void* p2 = a.AllocateRaw(32, 900);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(900, a.RequestedSize(p2));
+  EXPECT_EQ(1024, a.AllocatedSize(p2));
+  EXPECT_GT(a.AllocationId(p2), id1);
+  CheckStats(&a, 2, 1024, 1024);
+
+  // Another size class does not.
+  void* p3 = a.AllocateRaw(32, 2000);
+  EXPECT_NE(p2, p3);
+  CheckStats(&a, 3, 3072, 3072);
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  CheckStats(&a, 3, 0, 3072);
+}
+
+TEST(BFCAllocatorTest, LargeAllocationsBypassCaches) {
+  BFCAllocator a(new TestSubAllocator, 1 << 24, false, "test", 1);
+  void* p1 = a.AllocateRaw(32, 1 << 20);
+  CheckStats(&a, 1, 1 << 20, 1 << 20);
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 1 << 20);
+}
+
+TEST(BFCAllocatorTest, FlushOnOutOfMemory) {
+  BFCAllocator a(new TestSubAllocator, 1 << 20, false, "test", 2);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 1024; ++i) {
+    void* p = a.AllocateRaw(32, 1 << 10);
+    ASSERT_NE(nullptr, p);
+    ptrs.push_back(p);
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  CheckStats(&a, 1024, 0, 1 << 20);
+
+  // All the memory sits in the caches, and has to be flushed back to the
+  // bins to serve this request.
+  AllocationAttributes attr;
+  attr.no_retry_on_failure = true;
+  void* big = a.AllocateRaw(32, 1 << 19, attr);
+  EXPECT_NE(nullptr, big);
+  a.DeallocateRaw(big);
+}
+
+TEST(BFCAllocatorTest, ExplicitFlushCoalesces) {
+  BFCAllocator a(new TestSubAllocator, 1 << 20, false, "test", 4);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(32, 256 * (1 + i % 8)));
+  }
+  void* first = *std::min_element(ptrs.begin(), ptrs.end());
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  a.FlushSizeClassCaches();
+  // After the flush the region is coalesced again, so a large request
+  // starts at the beginning of it.
+  void* p = a.AllocateRaw(32, 1 << 19);
+  EXPECT_EQ(first, p);
+  a.DeallocateRaw(p);
+  CheckStats(&a, 65, 0, 1 << 19);
+}
+
+// Returns the value of the gauge "metric" for "labels", or -1.
+int64 GaugeValue(const string& metric, const std::vector<string>& labels) {
+  auto collected = monitoring::CollectionRegistry::Default()->CollectMetrics(
+      monitoring::CollectionRegistry::CollectMetricsOptions());
+  for (const auto& point : collected->point_set_map.at(metric)->points) {
+    bool match = point->labels.size() == labels.size();
+    for (size_t i = 0; match && i < labels.size(); ++i) {
+      match = point->labels[i].value == labels[i];
+    }
+    if (match) return point->int64_value;
+  }
+  return -1;
+}
+
+TEST(BFCAllocatorTest, ExportsMemoryMetrics) {
+  const string kName = "bfc_metrics_test";
+  BFCAllocator a(new TestSubAllocator, 1 << 20, false, kName, 0);
+  void* p1 = a.AllocateRaw(32, 1 << 18);
+  void* p2 = a.AllocateRaw(32, 1 << 18);
+  void* p3 = a.AllocateRaw(32, 1 << 18);
+  a.DeallocateRaw(p2);
+  // The region now holds two free chunks of 256KiB, split by p3.
+  EXPECT_EQ(1 << 19,
+            GaugeValue("/tensorflow/core/bfc_allocator/bytes_in_use", {kName}));
+  EXPECT_EQ(1 << 18,
+            GaugeValue("/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+                       {kName}));
+  EXPECT_EQ(500,
+            GaugeValue("/tensorflow/core/bfc_allocator/fragmentation", {kName}));
+  EXPECT_EQ(2, GaugeValue("/tensorflow/core/bfc_allocator/bin_free_chunks",
+                          {kName, "262144"}));
+  EXPECT_EQ(1 << 19, GaugeValue("/tensorflow/core/bfc_allocator/bin_free_bytes",
+                                {kName, "262144"}));
+
+  // Once coalesced, all the free memory is in one chunk.
+  a.DeallocateRaw(p3);
+  EXPECT_EQ((1 << 20) - (1 << 18),
+            GaugeValue("/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+                       {kName}));
+  EXPECT_EQ(0,
+            GaugeValue("/tensorflow/core/bfc_allocator/fragmentation", {kName}));
+  a.DeallocateRaw(p1);
+  EXPECT_EQ(0,
+            GaugeValue("/tensorflow/core/bfc_allocator/bytes_in_use", {kName}));
+}
+
+TEST(BFCAllocatorTest, Concurrent) {
+  const int kThreads = 8;
+  BFCAllocator a(new TestSubAllocator, 1 << 28, false, "test", kThreads);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 2000; ++i) {
+          const size_t size = 1 + (i * 7919 + t * 104729) % (128 << 10);
+          char* p = static_cast<char*>(a.AllocateRaw(32, size));
+          ASSERT_NE(nullptr, p);
+          p[0] = p[size - 1] = static_cast<char>(t);
+          ptrs.push_back(p);
+          if (ptrs.size() > 16) {
+            // Free out of allocation order.
+            a.DeallocateRaw(ptrs[i % ptrs.size()]);
+            ptrs.erase(ptrs.begin() + i % ptrs.size());
+          }
+        }
+        for (void* p : ptrs) {
+          a.DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(kThreads * 2000, stats.num_allocs);
+}
+
+void BM_AllocDeallocSmall(int iters, int num_caches) {
+  testing::StopTiming();
+  const int kThreads = 16;
+  BFCAllocator a(new TestSubAllocator, 1 << 28, false, "test", num_caches);
+  thread::ThreadPool pool(Env::Default(), "test", kThreads);
+  BlockingCounter counter(kThreads);
+  testing::StartTiming();
+  for (int t = 0; t < kThreads; ++t) {
+    pool.Schedule([&a, &counter, iters]() {
+      for (int i = 0; i < iters; ++i) {
+        void* p1 = a.AllocateRaw(32, 1 << 10);
+        void* p2 = a.AllocateRaw(32, 4 << 10);
+        a.DeallocateRaw(p1);
+        a.DeallocateRaw(p2);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  testing::StopTiming();
+}
+BENCHMARK(BM_AllocDeallocSmall)->Arg(0)->Arg(16);
+
+}  // namespace
+}  // namespace tensorflow
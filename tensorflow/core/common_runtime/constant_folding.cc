@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -37,12 +38,71 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Tensors larger than this are not turned into constants.
+constexpr int64 kMaxConstantBytes = 10 * 1024 * 1024;
+
+// The folded tensors of the process, keyed by the fingerprint of the
+// subgraph computing them (see FingerprintConstantFoldableNodes) and the
+// output index. Lets a graph that is optimized again, e.g. after
+// Session::Extend, or another graph with the same constant subgraphs skip
+// their evaluation.
+class ConstantFoldingCache {
+ public:
+  static ConstantFoldingCache* Global() {
+    static ConstantFoldingCache* cache = new ConstantFoldingCache;
+    return cache;
+  }
+
+  bool Lookup(const string& key, Tensor* value) {
+    mutex_lock l(mu_);
+    auto it = tensors_.find(key);
+    if (it == tensors_.end()) return false;
+    *value = it->second;
+    return true;
+  }
+
+  void Insert(const string& key, const Tensor& value) {
+    const int64 bytes = value.TotalBytes();
+    mutex_lock l(mu_);
+    if (!tensors_.emplace(key, value).second) return;
+    insertion_order_.push_back(key);
+    total_bytes_ += bytes;
+    // Evicts the oldest entries first.
+    while (total_bytes_ > kMaxBytes) {
+      auto it = tensors_.find(insertion_order_.front());
+      total_bytes_ -= it->second.TotalBytes();
+      tensors_.erase(it);
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr int64 kMaxBytes = 256 * 1024 * 1024;
+
+  mutex mu_;
+  std::unordered_map<string, Tensor> tensors_ GUARDED_BY(mu_);
+  std::deque<string> insertion_order_ GUARDED_BY(mu_);
+  int64 total_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+// Runs the nodes of the constant graphs, so that independent components are
+// evaluated in parallel. Separate from the intra-op pool of the device the
+// kernels run on, which they may block on.
+thread::ThreadPool* ConstantFoldingPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "constant_folding", port::NumSchedulableCPUs());
+  return pool;
+}
+
 bool IsConstantFoldable(const Node* n,
                         const std::function<bool(const Node*)>& consider) {
   if (n->IsConstant()) {
@@ -139,6 +199,50 @@ void FindConstantFoldableNodes(
   }
 }
 
+// Fills `fingerprints` with a fingerprint of the computation of each node in
+// `nodes`, which must be in topological order: its op, attributes and the
+// fingerprints of its data inputs, but not its name or device, so that a
+// subgraph has the same fingerprint in every graph. Nodes that read data
+// from outside the graph (ImmutableConst) have none, nor do their consumers.
+void FingerprintConstantFoldableNodes(
+    int graph_def_version, const std::vector<Node*>& nodes,
+    std::unordered_map<const Node*, string>* fingerprints) {
+  string value;
+  for (const Node* n : nodes) {
+    if (n->type_string() == "ImmutableConst") continue;
+    string computation = strings::StrCat(n->type_string(), ";",
+                                         graph_def_version);
+    std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+    for (const auto& attr : n->def().attr()) {
+      attrs.emplace_back(attr.first, &attr.second);
+    }
+    std::sort(attrs.begin(), attrs.end());
+    for (const auto& attr : attrs) {
+      attr.second->SerializeToString(&value);
+      strings::StrAppend(&computation, ";", attr.first, "=", value.size(), ":",
+                         value);
+    }
+    std::vector<const Edge*> inputs(n->num_inputs(), nullptr);
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge()) inputs[e->dst_input()] = e;
+    }
+    bool has_fingerprint = true;
+    for (const Edge* e : inputs) {
+      auto it = e == nullptr ? fingerprints->end()
+                             : fingerprints->find(e->src());
+      if (it == fingerprints->end()) {
+        has_fingerprint = false;
+        break;
+      }
+      strings::StrAppend(&computation, ";", it->second, ":", e->src_output());
+    }
+    if (has_fingerprint) {
+      const Fprint128 fp = Fingerprint128(computation);
+      (*fingerprints)[n] = strings::StrCat(fp.low64, "_", fp.high64);
+    }
+  }
+}
+
 typedef std::pair<Node*, int> NodeAndOutput;
 
 // Given the constant foldable nodes in 'nodes', returns a new graph 'g'. 'g'
@@ -229,7 +333,7 @@ bool ReplaceTensorWithConstant(Graph* graph, Device* partition_device,
       return false;
     }
   }
-  if (constant.TotalBytes() > 10 * 1024 * 1024) {
+  if (constant.TotalBytes() > kMaxConstantBytes) {
     return false;
   }
 
@@ -314,42 +418,75 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
   VLOG(1) << "Constant foldable " << constant_graph->num_node_ids() << " : "
           << graph->num_node_ids();
 
+  std::unordered_map<const Node*, string> fingerprints;
+  FingerprintConstantFoldableNodes(graph->versions().producer(),
+                                   constant_foldable_nodes, &fingerprints);
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+
+  // The tensors to replace, with their values when they are in the cache.
+  // Outputs of constants are never replaced, so they are not fetched.
+  std::vector<std::pair<NodeAndOutput, Tensor>> replacements;
   std::vector<string> tensors_to_fetch_names;
   std::vector<NodeAndOutput> tensors_to_replace;
+  std::vector<string> cache_keys;
   for (auto n : tensors_to_fetch) {
+    const NodeAndOutput tensor(n.second, n.first.second);
+    if (tensor.first->IsConstant()) continue;
+    string cache_key;
+    auto it = fingerprints.find(tensor.first);
+    if (it != fingerprints.end()) {
+      cache_key = strings::StrCat(it->second, ":", tensor.second);
+      Tensor value;
+      if (cache->Lookup(cache_key, &value)) {
+        replacements.emplace_back(tensor, value);
+        continue;
+      }
+    }
     tensors_to_fetch_names.push_back(
         strings::StrCat(n.first.first->name(), ":", n.first.second));
-    tensors_to_replace.push_back({n.second, n.first.second});
+    tensors_to_replace.push_back(tensor);
+    cache_keys.push_back(cache_key);
   }
-
-  auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
-  // Evaluate the constant foldable nodes.
-  std::vector<Tensor> outputs;
-  auto delete_tensors = gtl::MakeCleanup([&graph_runner, &outputs] {
-    // Output tensors need to be cleared before the GraphRunner is deleted.
-    outputs.clear();
-    graph_runner.reset(nullptr);
-  });
-
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    // This is not an error, so return the status as OK.
-    return s;
+  VLOG(1) << "Found " << replacements.size()
+          << " folded tensors in the cache, evaluating "
+          << tensors_to_fetch_names.size();
+
+  if (!tensors_to_fetch_names.empty()) {
+    auto graph_runner = std::unique_ptr<GraphRunner>(
+        new GraphRunner(env, ConstantFoldingPool()));
+    // Evaluate the constant foldable nodes.
+    std::vector<Tensor> outputs;
+    auto delete_tensors = gtl::MakeCleanup([&graph_runner, &outputs] {
+      // Output tensors need to be cleared before the GraphRunner is deleted.
+      outputs.clear();
+      graph_runner.reset(nullptr);
+    });
+
+    Status s =
+        graph_runner->Run(constant_graph.get(), function_library,
+                          {} /* inputs*/, tensors_to_fetch_names, &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      // This is not an error, so return the status as OK.
+      return s;
+    }
+    for (size_t c = 0; c < outputs.size(); ++c) {
+      if (!cache_keys[c].empty() &&
+          outputs[c].TotalBytes() <= kMaxConstantBytes) {
+        cache->Insert(cache_keys[c], outputs[c]);
+      }
+      replacements.emplace_back(tensors_to_replace[c], outputs[c]);
+    }
   }
 
-  // Fetch the constant tensors and replace the corresponding tensors in the
-  // original graph with those constants.
+  // Replace the tensors in the original graph with the constants.
   int32 num_nodes_replaced = 0;
-  for (size_t c = 0; c < outputs.size(); ++c) {
+  for (const auto& replacement : replacements) {
     const gtl::FlatSet<Node*>& control_deps =
-        constant_control_deps[tensors_to_replace[c].first];
-    if (ReplaceTensorWithConstant(graph, partition_device,
-                                  tensors_to_replace[c], outputs[c],
-                                  control_deps)) {
+        constant_control_deps[replacement.first.first];
+    if (ReplaceTensorWithConstant(graph, partition_device, replacement.first,
+                                  replacement.second, control_deps)) {
       ++num_nodes_replaced;
     }
   }
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -363,6 +365,66 @@ TEST_F(ConstantFoldingTest, ControlDependencies) {
   }
 }
 
+REGISTER_OP("ConstantFoldingCountedOp").Input("a: int64").Output("b: int64");
+
+// Forwards its input and counts its runs.
+class ConstantFoldingCountedOp : public OpKernel {
+ public:
+  explicit ConstantFoldingCountedOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    ++num_runs;
+    context->set_output(0, context->input(0));
+  }
+
+  static std::atomic<int> num_runs;
+};
+
+std::atomic<int> ConstantFoldingCountedOp::num_runs{0};
+
+REGISTER_KERNEL_BUILDER(Name("ConstantFoldingCountedOp").Device(DEVICE_CPU),
+                        ConstantFoldingCountedOp);
+
+TEST_F(ConstantFoldingTest, FoldedTensorsAreCached) {
+  auto fold = [this](const string& prefix, int64 value) {
+    Graph g(OpRegistry::Global());
+    {
+      Scope s = Scope::NewRootScope().NewSubScope(prefix);
+      auto c = ops::Const<int64>(s, value, {});
+      NodeDef def;
+      TF_ASSERT_OK(NodeDefBuilder(strings::StrCat(prefix, "/counted"),
+                                  "ConstantFoldingCountedOp")
+                       .Input(c.name(), 0, DT_INT64)
+                       .Finalize(&def));
+      Status status;
+      Node* counted = s.graph()->AddNode(def, &status);
+      TF_ASSERT_OK(status);
+      s.graph()->AddEdge(c.node(), 0, counted, 0);
+      auto add = ops::Add(s, Output(counted), c);
+      ops::_Send(s.WithOpName("send"), add, "send", "sender", 0, "receiver");
+      TF_ASSERT_OK(s.ToGraph(&g));
+    }
+    bool was_mutated;
+    TF_ASSERT_OK(ConstantFold(ConstantFoldingOptions{}, nullptr,
+                              Env::Default(), nullptr, &g, &was_mutated));
+    EXPECT_TRUE(was_mutated);
+    Node* send = NodeNameIndex(g).at(strings::StrCat(prefix, "/send"));
+    ASSERT_EQ(1, send->num_inputs());
+    ExpectNodeEqual<int64>(*(send->in_nodes().begin()), {2 * value}, {});
+  };
+
+  const int num_runs = ConstantFoldingCountedOp::num_runs;
+  fold("first", 21);
+  EXPECT_EQ(num_runs + 1, ConstantFoldingCountedOp::num_runs);
+  // The same subgraph under other names is not evaluated again.
+  fold("second", 21);
+  EXPECT_EQ(num_runs + 1, ConstantFoldingCountedOp::num_runs);
+  // Another constant is.
+  fold("third", 5);
+  EXPECT_EQ(num_runs + 2, ConstantFoldingCountedOp::num_runs);
+}
+
 namespace {
 
 const char kTestMemRegionName[] = "test://test";
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
 #include "tensorflow/core/common_runtime/simple_placer.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
@@ -133,6 +134,14 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   return thread_pool;
 }
 
+// The scheduler sharing GlobalThreadPool() between the sessions with an
+// inter_op_scheduling_weight.
+FairShareScheduler* GlobalFairShareScheduler(const SessionOptions& options) {
+  static FairShareScheduler* const scheduler =
+      new FairShareScheduler(options.env, GlobalThreadPool(options));
+  return scheduler;
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -250,6 +259,46 @@ void DirectSession::SchedClosure(thread::ThreadPool* pool,
 #endif  // __ANDROID__
 }
 
+void DirectSession::SchedClosure(thread::ThreadPool* pool,
+                                 std::function<void()> c, int64 priority) {
+#ifdef __ANDROID__
+  c();
+#else
+  pool->ScheduleWithPriority(std::move(c), priority);
+#endif  // __ANDROID__
+}
+
+void DirectSession::SetRunners(thread::ThreadPool* pool,
+                               Executor::Args* args) {
+  const bool use_priorities =
+      options_.config.graph_options().use_priority_scheduling();
+  if (fair_share_queue_ != nullptr) {
+    // The session only has the global pool.
+    DCHECK_EQ(pool, thread_pools_[0].first);
+    FairShareScheduler* scheduler = GlobalFairShareScheduler(options_);
+    std::shared_ptr<FairShareScheduler::Queue> queue = fair_share_queue_;
+    args->runner = [scheduler, queue](Executor::Args::Closure c) {
+      scheduler->Schedule(queue, std::move(c));
+    };
+    if (use_priorities) {
+      args->priority_runner = [scheduler, queue](Executor::Args::Closure c,
+                                                 int64 priority) {
+        scheduler->Schedule(queue, std::move(c), priority);
+      };
+    }
+    return;
+  }
+  args->runner = [this, pool](Executor::Args::Closure c) {
+    SchedClosure(pool, std::move(c));
+  };
+  if (use_priorities) {
+    args->priority_runner = [this, pool](Executor::Args::Closure c,
+                                         int64 priority) {
+      SchedClosure(pool, std::move(c), priority);
+    };
+  }
+}
+
 DirectSession::DirectSession(const SessionOptions& options,
                              const DeviceMgr* device_mgr,
                              DirectSessionFactory* const factory)
@@ -273,6 +322,10 @@ DirectSession::DirectSession(const SessionOptions& options,
                                true /* owned */);
   } else {
     thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
+    if (options_.config.inter_op_scheduling_weight() > 0) {
+      fair_share_queue_ = GlobalFairShareScheduler(options_)->NewQueue(
+          options_.config.inter_op_scheduling_weight());
+    }
   }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
@@ -463,20 +516,11 @@ Status DirectSession::Run(const RunOptions& run_options,
   ExecutorsAndKeys* executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
 
-  Executor::Args args;
-  args.step_id = step_id_counter_.fetch_add(1);
+  const int64 step_id = step_id_counter_.fetch_add(1);
 
   TF_RETURN_IF_ERROR(
       GetOrCreateExecutors(pool, input_tensor_names, output_names, target_nodes,
                            &executors_and_keys, &run_state_args));
-  const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
-
-  std::unique_ptr<DebuggerStateInterface> debugger_state;
-  if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
-    TF_RETURN_IF_ERROR(CreateDebuggerState(
-        run_options.debug_options(), args.step_id, executor_step_count,
-        input_tensor_names, output_names, target_nodes, &debugger_state));
-  }
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
@@ -501,11 +545,78 @@ Status DirectSession::Run(const RunOptions& run_options,
     return s;
   }
 
+  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, pool, &call_frame,
+                                 executors_and_keys, run_state_args.handle,
+                                 input_tensor_names, output_names,
+                                 target_nodes, run_metadata));
+
+  // Receive outputs.
+  if (outputs) {
+    std::vector<Tensor> sorted_outputs;
+    Status s = call_frame.ConsumeRetvals(&sorted_outputs);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    const bool unique_outputs =
+        output_names.size() == executors_and_keys->output_name_to_index.size();
+    // first_indices[i] = j implies that j is the smallest value for which
+    // output_names[i] == output_names[j].
+    std::vector<int> first_indices;
+    if (!unique_outputs) {
+      first_indices.resize(output_names.size());
+      for (int i = 0; i < output_names.size(); ++i) {
+        for (int j = 0; j <= i; ++j) {
+          if (output_names[i] == output_names[j]) {
+            first_indices[i] = j;
+            break;
+          }
+        }
+      }
+    }
+    outputs->clear();
+    outputs->reserve(sorted_outputs.size());
+    for (int i = 0; i < output_names.size(); ++i) {
+      const string& output_name = output_names[i];
+      if (first_indices.empty() || first_indices[i] == i) {
+        outputs->emplace_back(
+            std::move(sorted_outputs[executors_and_keys
+                                         ->output_name_to_index[output_name]]));
+      } else {
+        outputs->push_back((*outputs)[first_indices[i]]);
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
+                                  thread::ThreadPool* pool,
+                                  FunctionCallFrame* call_frame,
+                                  ExecutorsAndKeys* executors_and_keys,
+                                  const string& handle,
+                                  const std::vector<string>& input_names,
+                                  const std::vector<string>& output_names,
+                                  const std::vector<string>& target_nodes,
+                                  RunMetadata* run_metadata) {
+  Executor::Args args;
+  args.step_id = step_id;
+  const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
+
+  std::unique_ptr<DebuggerStateInterface> debugger_state;
+  if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
+    TF_RETURN_IF_ERROR(CreateDebuggerState(
+        run_options.debug_options(), args.step_id, executor_step_count,
+        input_names, output_names, target_nodes, &debugger_state));
+  }
+
   // Create a run state and start execution.
   RunState run_state(args.step_id, &devices_);
   run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
   CancellationManager step_cancellation_manager;
-  args.call_frame = &call_frame;
+  args.call_frame = call_frame;
 
   // Start parallel Executors.
   const size_t num_executors = executors_and_keys->items.size();
@@ -520,14 +631,12 @@ Status DirectSession::Run(const RunOptions& run_options,
 
   args.rendezvous = run_state.rendez;
   args.cancellation_manager = &step_cancellation_manager;
-  args.runner = [this, pool](Executor::Args::Closure c) {
-    SchedClosure(pool, std::move(c));
-  };
+  SetRunners(pool, &args);
   args.session_state = &session_state_;
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
   if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(args.step_id, run_state_args.handle);
+    LogMemory::RecordStep(args.step_id, handle);
   }
   args.sync_on_finish = sync_on_finish_;
 
@@ -545,6 +654,13 @@ Status DirectSession::Run(const RunOptions& run_options,
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
+  const GraphOptions& graph_options = options_.config.graph_options();
+  if (graph_options.op_latency_sampling_steps() > 0 &&
+      executor_step_count % graph_options.op_latency_sampling_steps() == 0) {
+    args.op_latency_sampling_period =
+        std::max(graph_options.op_latency_sampling_nodes(), 1);
+  }
+
   if (do_trace || update_cost_model) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
@@ -607,45 +723,6 @@ Status DirectSession::Run(const RunOptions& run_options,
     TF_RETURN_IF_ERROR(run_state.status);
   }
 
-  // Receive outputs.
-  if (outputs) {
-    std::vector<Tensor> sorted_outputs;
-    Status s = call_frame.ConsumeRetvals(&sorted_outputs);
-    if (errors::IsInternal(s)) {
-      return errors::InvalidArgument(s.error_message());
-    } else if (!s.ok()) {
-      return s;
-    }
-    const bool unique_outputs =
-        output_names.size() == executors_and_keys->output_name_to_index.size();
-    // first_indices[i] = j implies that j is the smallest value for which
-    // output_names[i] == output_names[j].
-    std::vector<int> first_indices;
-    if (!unique_outputs) {
-      first_indices.resize(output_names.size());
-      for (int i = 0; i < output_names.size(); ++i) {
-        for (int j = 0; j <= i; ++j) {
-          if (output_names[i] == output_names[j]) {
-            first_indices[i] = j;
-            break;
-          }
-        }
-      }
-    }
-    outputs->clear();
-    outputs->reserve(sorted_outputs.size());
-    for (int i = 0; i < output_names.size(); ++i) {
-      const string& output_name = output_names[i];
-      if (first_indices.empty() || first_indices[i] == i) {
-        outputs->emplace_back(
-            std::move(sorted_outputs[executors_and_keys
-                                         ->output_name_to_index[output_name]]));
-      } else {
-        outputs->push_back((*outputs)[first_indices[i]]);
-      }
-    }
-  }
-
   // Save the output tensors of this run we choose to keep.
   TF_RETURN_IF_ERROR(
       run_state.tensor_store.SaveTensors(output_names, &session_state_));
@@ -685,6 +762,135 @@ Status DirectSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+Status DirectSession::MakeCallable(const CallableOptions& callable_options,
+                                  CallableHandle* out_handle) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  {
+    mutex_lock l(graph_def_lock_);
+    if (!graph_created_) {
+      return errors::InvalidArgument(
+          "Session was not created with a graph before MakeCallable()!");
+    }
+  }
+  const RunOptions& run_options = callable_options.run_options();
+  if (run_options.inter_op_thread_pool() < 0 ||
+      run_options.inter_op_thread_pool() >= thread_pools_.size()) {
+    return errors::InvalidArgument("Invalid inter_op_thread_pool: ",
+                                   run_options.inter_op_thread_pool());
+  }
+  thread::ThreadPool* pool =
+      thread_pools_[run_options.inter_op_thread_pool()].first;
+
+  std::shared_ptr<Callable> callable(new Callable);
+  callable->options = callable_options;
+  callable->feed_names.assign(callable_options.feed().begin(),
+                              callable_options.feed().end());
+  callable->fetch_names.assign(callable_options.fetch().begin(),
+                               callable_options.fetch().end());
+  callable->target_names.assign(callable_options.target().begin(),
+                                callable_options.target().end());
+  std::unordered_set<string> unique_feeds;
+  for (const string& feed : callable->feed_names) {
+    if (!unique_feeds.insert(feed).second) {
+      return errors::InvalidArgument("Tensor ", feed,
+                                     " is fed more than once by the callable");
+    }
+  }
+
+  RunStateArgs run_state_args(run_options.debug_options());
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(
+      pool, callable->feed_names, callable->fetch_names,
+      callable->target_names, &callable->executors_and_keys, &run_state_args));
+  callable->pool = pool;
+  callable->handle = run_state_args.handle;
+  for (const string& feed : callable->feed_names) {
+    callable->feed_arg_index.push_back(
+        callable->executors_and_keys->input_name_to_index[feed]);
+  }
+  for (const string& fetch : callable->fetch_names) {
+    callable->fetch_retval_index.push_back(
+        callable->executors_and_keys->output_name_to_index[fetch]);
+  }
+
+  mutex_lock l(callables_lock_);
+  *out_handle = callables_.size();
+  callables_.push_back(std::move(callable));
+  return Status::OK();
+}
+
+Status DirectSession::RunCallable(CallableHandle handle,
+                                  const std::vector<Tensor>& feed_tensors,
+                                  std::vector<Tensor>* fetch_tensors,
+                                  RunMetadata* run_metadata) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  direct_session_runs->GetCell()->IncrementBy(1);
+  std::shared_ptr<Callable> callable;
+  {
+    mutex_lock l(callables_lock_);
+    if (handle < 0 || handle >= callables_.size() || !callables_[handle]) {
+      return errors::InvalidArgument("No such callable handle: ", handle);
+    }
+    callable = callables_[handle];
+  }
+  if (feed_tensors.size() != callable->feed_names.size()) {
+    return errors::InvalidArgument(
+        "Expected ", callable->feed_names.size(),
+        " feed tensors, but got ", feed_tensors.size());
+  }
+  ExecutorsAndKeys* executors_and_keys = callable->executors_and_keys;
+  const int64 step_id = step_id_counter_.fetch_add(1);
+
+  FunctionCallFrame call_frame(executors_and_keys->input_types,
+                               executors_and_keys->output_types);
+  gtl::InlinedVector<Tensor, 4> feed_args(feed_tensors.size());
+  for (size_t i = 0; i < feed_tensors.size(); ++i) {
+    if (feed_tensors[i].dtype() == DT_RESOURCE) {
+      TF_RETURN_IF_ERROR(ResourceHandleToInputTensor(
+          feed_tensors[i], &feed_args[callable->feed_arg_index[i]]));
+    } else {
+      feed_args[callable->feed_arg_index[i]] = feed_tensors[i];
+    }
+  }
+  Status s = call_frame.SetArgs(feed_args);
+  if (errors::IsInternal(s)) {
+    return errors::InvalidArgument(s.error_message());
+  } else if (!s.ok()) {
+    return s;
+  }
+
+  RunMetadata unused_run_metadata;
+  TF_RETURN_IF_ERROR(RunInternal(
+      step_id, callable->options.run_options(), callable->pool, &call_frame,
+      executors_and_keys, callable->handle, callable->feed_names,
+      callable->fetch_names, callable->target_names,
+      run_metadata != nullptr ? run_metadata : &unused_run_metadata));
+
+  if (fetch_tensors) {
+    std::vector<Tensor> retvals;
+    s = call_frame.ConsumeRetvals(&retvals);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    fetch_tensors->clear();
+    fetch_tensors->reserve(callable->fetch_retval_index.size());
+    for (size_t index : callable->fetch_retval_index) {
+      fetch_tensors->push_back(retvals[index]);
+    }
+  }
+  return Status::OK();
+}
+
+Status DirectSession::ReleaseCallable(CallableHandle handle) {
+  mutex_lock l(callables_lock_);
+  if (handle < 0 || handle >= callables_.size() || !callables_[handle]) {
+    return errors::InvalidArgument("No such callable handle: ", handle);
+  }
+  callables_[handle].reset();
+  return Status::OK();
+}
+
 Status DirectSession::PRunSetup(const std::vector<string>& input_names,
                                 const std::vector<string>& output_names,
                                 const std::vector<string>& target_nodes,
@@ -741,9 +947,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
 
   args.rendezvous = run_state->rendez;
   args.cancellation_manager = cancellation_manager_;
-  args.runner = [this, pool](Executor::Args::Closure c) {
-    SchedClosure(pool, std::move(c));
-  };
+  SetRunners(pool, &args);
   args.session_state = &session_state_;
   args.tensor_store = &run_state->tensor_store;
   args.step_container = &run_state->step_container;
@@ -1143,6 +1347,13 @@ Status DirectSession::GetOrCreateExecutors(
   const auto& optimizer_opts =
       options_.config.graph_options().optimizer_options();
   GraphOptimizer optimizer(optimizer_opts);
+  // The function libraries and executor params of all partitions are set up
+  // here, and the partitions are then optimized and turned into executors
+  // below, concurrently when there is more than one.
+  std::vector<std::unique_ptr<Graph>*> partition_graphs;
+  std::vector<LocalExecutorParams> partition_params;
+  partition_graphs.reserve(graphs.size());
+  partition_params.reserve(graphs.size());
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
     std::unique_ptr<Graph>& partition_graph = iter->second;
@@ -1162,10 +1373,21 @@ Status DirectSession::GetOrCreateExecutors(
     params.function_library = item->flib.get();
     auto lib = item->flib.get();
     auto opseg = device->op_segment();
-    params.create_kernel = [this, lib, opseg](const NodeDef& ndef,
-                                              OpKernel** kernel) {
-      // Caches the kernel only if the node is stateful.
+    const bool share_kernels = options_.config.graph_options()
+                                   .share_stateless_kernels_across_sessions();
+    params.create_kernel = [this, lib, opseg, device, graph_def_version,
+                            share_kernels](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+      // Caches the kernel only if the node is stateful, or if it may be
+      // shared with other sessions.
       if (!lib->IsStateful(ndef.op())) {
+        if (share_kernels && SharedKernelCache::CanShare(device, ndef)) {
+          return SharedKernelCache::Global()->FindOrCreate(
+              device, graph_def_version, ndef, kernel,
+              [lib, &ndef](OpKernel** kernel) {
+                return lib->CreateKernel(ndef, kernel);
+              });
+        }
         return lib->CreateKernel(ndef, kernel);
       }
       auto create_fn = [lib, &ndef](OpKernel** kernel) {
@@ -1178,17 +1400,54 @@ Status DirectSession::GetOrCreateExecutors(
                                  create_fn);
     };
     params.delete_kernel = [lib](OpKernel* kernel) {
-      // If the node is stateful, opseg owns it. Otherwise, delete it.
-      if (kernel && !lib->IsStateful(kernel->type_string())) {
+      // If the node is stateful, opseg owns it. Otherwise, delete it
+      // unless it is shared with other sessions.
+      if (kernel && !lib->IsStateful(kernel->type_string()) &&
+          !SharedKernelCache::Global()->Release(kernel)) {
         delete kernel;
       }
     };
     params.node_outputs_cb = node_outputs_callback_;
+    if (options_.config.graph_options().use_work_stealing_executor() &&
+        pool != nullptr) {
+      params.num_work_stealing_workers = pool->NumThreads();
+    }
+    params.inline_kernel_cost_threshold_usecs =
+        options_.config.graph_options().inline_kernel_cost_threshold_usecs();
+    if (options_.config.graph_options().kernel_cost_warmup_steps() > 0) {
+      params.kernel_cost_warmup_steps =
+          options_.config.graph_options().kernel_cost_warmup_steps();
+    }
+    params.inline_synchronous_cpu_graphs =
+        options_.config.graph_options().inline_synchronous_cpu_graphs();
+    if (!run_state_args->is_partial_run) {
+      params.static_memory_plan_warmup_steps =
+          options_.config.graph_options().static_memory_plan_warmup_steps();
+    }
+    // The kernels of a partition are created on the inter-op pool. The
+    // partitions themselves run on a separate pool below, so that waiting
+    // for the kernels never blocks a thread that would create them.
+    params.kernel_creation_pool = pool;
 
-    optimizer.Optimize(lib, options_.env, device, &iter->second);
+    partition_graphs.push_back(&partition_graph);
+    partition_params.push_back(params);
+  }
+
+  const bool debug_graphs =
+      !options.debug_options.debug_tensor_watch_opts().empty();
+  auto create_executor = [this, &ek, &optimizer, &options, debug_graphs,
+                          &partition_graphs,
+                          &partition_params](int i) -> Status {
+    std::unique_ptr<Graph>& partition_graph = *partition_graphs[i];
+    const LocalExecutorParams& params = partition_params[i];
+    Device* device = params.device;
+    auto* item = &ek->items[i];
+
+    optimizer.Optimize(item->flib.get(), options_.env, device,
+                       &partition_graph);
 
     // EXPERIMENTAL: tfdbg inserts debug nodes in the graph.
-    if (!options.debug_options.debug_tensor_watch_opts().empty()) {
+    if (debug_graphs) {
       TF_RETURN_IF_ERROR(DecorateAndPublishGraphForDebug(
           options.debug_options, partition_graph.get(), params.device));
     }
@@ -1203,6 +1462,31 @@ Status DirectSession::GetOrCreateExecutors(
     TF_RETURN_IF_ERROR(
         NewLocalExecutor(params, partition_graph.release(), &executor));
     item->executor.reset(executor);
+    return Status::OK();
+  };
+  const int num_partitions = partition_graphs.size();
+  // Publishing debug graphs is not known to be thread-safe, so those
+  // partitions are still created one at a time.
+  if (num_partitions == 1 || debug_graphs) {
+    for (int i = 0; i < num_partitions; ++i) {
+      TF_RETURN_IF_ERROR(create_executor(i));
+    }
+  } else {
+    std::vector<Status> partition_status(num_partitions);
+    {
+      thread::ThreadPool partition_pool(
+          options_.env, "partition_executors",
+          std::min(num_partitions, port::NumSchedulableCPUs()));
+      for (int i = 0; i < num_partitions; ++i) {
+        partition_pool.Schedule([&create_executor, &partition_status, i]() {
+          partition_status[i] = create_executor(i);
+        });
+      }
+      // The destructor of partition_pool waits for all partitions.
+    }
+    for (const Status& s : partition_status) {
+      TF_RETURN_IF_ERROR(s);
+    }
   }
 
   // Cache the mapping from input/output names to graph elements to
@@ -1363,15 +1647,15 @@ Status DirectSession::CreateGraphs(
     }
   }
 
-  for (const auto& partition : partitions) {
+  for (auto& partition : partitions) {
     std::unique_ptr<Graph> device_graph(
         new Graph(client_graph->flib_def.get()));
     GraphConstructorOptions device_opts;
     // There are internal operations (e.g., send/recv) that we now allow.
     device_opts.allow_internal_ops = true;
     device_opts.expect_device_spec = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
-                                              device_graph.get()));
+    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+        device_opts, std::move(partition.second), device_graph.get()));
     outputs->emplace(partition.first, std::move(device_graph));
   }
 
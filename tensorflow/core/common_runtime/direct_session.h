@@ -28,10 +28,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/common_runtime/simple_graph_execution_state.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/session_state.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -91,6 +93,16 @@ class DirectSession : public Session {
                             const std::vector<string>& output_names,
                             std::vector<Tensor>* outputs) override;
 
+  // NOTE: MakeCallable, RunCallable and ReleaseCallable are experimental and
+  // subject to change.
+  ::tensorflow::Status MakeCallable(const CallableOptions& callable_options,
+                                    CallableHandle* out_handle) override;
+  ::tensorflow::Status RunCallable(CallableHandle handle,
+                                   const std::vector<Tensor>& feed_tensors,
+                                   std::vector<Tensor>* fetch_tensors,
+                                   RunMetadata* run_metadata) override;
+  ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
+
   // Reset clears 'containers' from the device_mgr of the DirectSession.
   // If 'containers' is empty, then Reset clears the default container.
   ::tensorflow::Status Reset(const std::vector<string>& containers);
@@ -170,6 +182,23 @@ class DirectSession : public Session {
     ~RunState();
   };
 
+  // A callable runs the executors of its feeds, fetches and targets, which
+  // are looked up once when it is made.  'feed_arg_index[i]' is the index of
+  // the i-th feed among the arguments of the call frame, and
+  // 'fetch_retval_index[i]' that of the i-th fetch among its return values.
+  // 'handle' identifies the executors in memory logs.
+  struct Callable {
+    CallableOptions options;
+    std::vector<string> feed_names;
+    std::vector<string> fetch_names;
+    std::vector<string> target_names;
+    ExecutorsAndKeys* executors_and_keys = nullptr;  // not owned
+    thread::ThreadPool* pool = nullptr;              // not owned
+    string handle;
+    std::vector<size_t> feed_arg_index;
+    std::vector<size_t> fetch_retval_index;
+  };
+
   struct RunStateArgs {
     RunStateArgs(const DebugOptions& options) : debug_options(options) {}
 
@@ -179,6 +208,20 @@ class DirectSession : public Session {
     const DebugOptions& debug_options;
   };
 
+  // Runs the executors in 'executors_and_keys' for one step, with the feeds
+  // in 'call_frame', and leaves the fetches in 'call_frame'.  The names of
+  // the feeds, fetches and targets are used by the debugger and to keep the
+  // tensors of the step in the session state.
+  ::tensorflow::Status RunInternal(int64 step_id, const RunOptions& run_options,
+                                   thread::ThreadPool* pool,
+                                   FunctionCallFrame* call_frame,
+                                   ExecutorsAndKeys* executors_and_keys,
+                                   const string& handle,
+                                   const std::vector<string>& input_names,
+                                   const std::vector<string>& output_names,
+                                   const std::vector<string>& target_nodes,
+                                   RunMetadata* run_metadata);
+
   // Initializes the base execution state given the 'graph',
   // if not already initialized.
   Status MaybeInitializeExecutionState(const GraphDef& graph,
@@ -276,6 +319,15 @@ class DirectSession : public Session {
   bool sync_on_finish_ = true;
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
+  // Like SchedClosure(), through ThreadPool::ScheduleWithPriority().
+  void SchedClosure(thread::ThreadPool* pool, std::function<void()> c,
+                    int64 priority);
+  // Sets the runners of "args" to schedule the closures of a step on "pool".
+  void SetRunners(thread::ThreadPool* pool, Executor::Args* args);
+
+  // If set, the closures of the steps are scheduled on the global inter-op
+  // thread pool through this queue of the global FairShareScheduler.
+  std::shared_ptr<FairShareScheduler::Queue> fair_share_queue_;
 
   mutex executor_lock_;  // protects executors_
   // Holds mappings from signature to the executors that process
@@ -286,6 +338,12 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       GUARDED_BY(executor_lock_);
 
+  // The callables made by MakeCallable(), indexed by their handles.  Released
+  // callables are null.  Entries in 'executors_' are never removed, so the
+  // executors of a callable outlive it.
+  mutex callables_lock_;
+  std::vector<std::shared_ptr<Callable>> callables_ GUARDED_BY(callables_lock_);
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
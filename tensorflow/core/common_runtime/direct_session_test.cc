@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -137,6 +138,60 @@ TEST_F(DirectSessionMinusAXTest, TestFeed) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunCallable) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options;
+  callable_options.add_feed(x_);
+  callable_options.add_fetch(y_ + ":0");
+  callable_options.add_fetch(y_neg_ + ":0");
+  callable_options.add_fetch(y_ + ":0");
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  for (float x : {5, 7}) {
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&t, {x, 6});
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {t}, &outputs, nullptr));
+    ASSERT_EQ(3, outputs.size());
+    // Expect outputs to be; 1*x + 2*6, 3*x + 4*6
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({x + 12, 3 * x + 24}, {2, 1}), outputs[0]);
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({-x - 12, -3 * x - 24}, {2, 1}), outputs[1]);
+    test::ExpectTensorEqual<float>(outputs[0], outputs[2]);
+  }
+
+  // A callable must be given exactly one tensor per feed.
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->RunCallable(handle, {}, &outputs, nullptr)));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->RunCallable(handle, {}, &outputs, nullptr)));
+  EXPECT_TRUE(errors::IsInvalidArgument(session->ReleaseCallable(handle)));
+}
+
+TEST_F(DirectSessionMinusAXTest, MakeCallableWithRepeatedFeed) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options;
+  callable_options.add_feed(x_);
+  callable_options.add_feed(x_);
+  callable_options.add_fetch(y_ + ":0");
+  Session::CallableHandle handle;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->MakeCallable(callable_options, &handle)));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -206,6 +261,64 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestPriorityScheduling) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.mutable_graph_options()->set_use_priority_scheduling(true);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<string> output_names = {y_ + ":0", y_neg_ + ":0"};
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-3.0, outputs[1].matrix<float>()(0, 0));
+  }
+}
+
+// Returns the number of samples of the op latency histogram for "op" on
+// "device_type".
+int64 NumOpLatencySamples(const string& op, const string& device_type) {
+  auto collected = monitoring::CollectionRegistry::Default()->CollectMetrics(
+      monitoring::CollectionRegistry::CollectMetricsOptions());
+  auto it = collected->point_set_map.find("/tensorflow/core/op_latency_usecs");
+  if (it == collected->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    if (point->labels[0].value == op && point->labels[1].value == device_type) {
+      return point->histogram_value.num();
+    }
+  }
+  return 0;
+}
+
+TEST_F(DirectSessionMinusAXTest, TestOpLatencySampling) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  // Keep the MatMul from being constant folded.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  options.config.mutable_graph_options()->set_op_latency_sampling_steps(2);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  const int64 num_samples = NumOpLatencySamples("MatMul", "CPU");
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  }
+  // Every other step is sampled.
+  EXPECT_EQ(num_samples + 5, NumOpLatencySamples("MatMul", "CPU"));
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -24,7 +25,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queues.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -35,11 +38,13 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_segment.h"
+#include "tensorflow/core/framework/step_arena_allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -50,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
@@ -59,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -66,6 +73,22 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// Buckets of [1, 2, 4, ..., 2^30].
+std::vector<double> PowersOfTwoBuckets() {
+  std::vector<double> buckets;
+  for (double limit = 1; limit <= (int64{1} << 30); limit *= 2) {
+    buckets.push_back(limit);
+  }
+  return buckets;
+}
+
+auto* op_latency_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/op_latency_usecs",
+     "The compute time of the synchronous kernels, sampled in the steps "
+     "run with Executor::Args::op_latency_sampling_period > 0.",
+     "op", "device_type"},
+    PowersOfTwoBuckets());
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -149,13 +172,16 @@ void SetOutput(NodeExecStats* nt, int slot, const Tensor* v) {
   v->FillDescription(no->mutable_tensor_description());
 }
 
-void SetMemory(NodeExecStats* nt, OpKernelContext* ctx) {
+void SetMemory(NodeExecStats* nt, OpKernelContext* ctx,
+               StepStatsCollector* stats_collector) {
+  std::vector<TrackingAllocator*> tracking_allocators;
   for (const auto& allocator_pair : ctx->wrapped_allocators()) {
     AllocatorMemoryUsed* memory = nt->add_memory();
-    // retrieving the sizes from the wrapped allocator removes the
-    // executor's reference to it, so allocator_pair.second must not
-    // be dereferenced again after this statement
-    auto sizes = allocator_pair.second->GetSizesAndUnRef();
+    // the executor's reference to the wrapped allocator is handed to the
+    // stats collector, which reads out the allocation records and releases
+    // it once the deallocations of this step are known
+    auto sizes = allocator_pair.second->GetSizes();
+    tracking_allocators.push_back(allocator_pair.second);
     memory->set_allocator_name(allocator_pair.first->Name());
     memory->set_total_bytes(std::get<0>(sizes));
     if (allocator_pair.first->TracksAllocationSizes()) {
@@ -166,6 +192,7 @@ void SetMemory(NodeExecStats* nt, OpKernelContext* ctx) {
     allocator_pair.first->GetStats(&stats);
     memory->set_allocator_bytes_in_use(stats.bytes_in_use);
   }
+  stats_collector->SaveAllocations(nt, std::move(tracking_allocators));
   auto* ms = nt->mutable_memory_stats();
   ms->set_host_temp_memory_size(ctx->host_temp_memory_size());
   ms->set_device_temp_memory_size(ctx->device_temp_memory_size());
@@ -193,8 +220,13 @@ void SetReferencedTensors(NodeExecStats* nt,
 }  // namespace nodestats
 
 class ExecutorImpl;
+class FrameStatePool;
 class GraphView;
 
+// Defined after ExecutorState, whose frames the pool holds.
+FrameStatePool* NewFrameStatePool();
+void DeleteFrameStatePool(FrameStatePool* pool);
+
 struct EdgeInfo {
   int dst_id;
   int output_slot : 31;
@@ -236,6 +268,16 @@ struct NodeItem {
 
   PendingCounts::Handle pending_id;
 
+  // Rank of the node in a precomputed schedule, from its "_schedule_priority"
+  // attribute: among the nodes that become ready together, the ones with
+  // lower values are scheduled first. 0 if the node isn't annotated.
+  int32 schedule_priority = 0;
+
+  // The number of nodes on the longest path from this node to the end of
+  // the graph, ignoring the back edges of loops. Passed to
+  // Executor::Args::priority_runner.
+  int32 critical_path_length = 0;
+
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
 
   // ith output edge.
@@ -332,7 +374,7 @@ class GraphView {
 class ExecutorImpl : public Executor {
  public:
   ExecutorImpl(const LocalExecutorParams& p, const Graph* g)
-      : params_(p), graph_(g), gview_() {
+      : params_(p), graph_(g), gview_(), num_steps_started_(0) {
     CHECK(p.create_kernel != nullptr);
     CHECK(p.delete_kernel != nullptr);
   }
@@ -362,6 +404,43 @@ class ExecutorImpl : public Executor {
  private:
   friend class ExecutorState;
 
+  // Cost class of a node, as measured during the warmup steps.
+  enum KernelCostClass : uint8 {
+    kCostUnknown = 0,  // Use NodeItem::kernel_is_expensive.
+    kCostCheap = 1,
+    kCostExpensive = 2,
+  };
+
+  // Returns true if the node of "item" should be dispatched to another
+  // thread rather than run inline once it is ready.
+  bool IsExpensive(const NodeItem& item) const {
+    if (kernel_cost_class_ != nullptr) {
+      const uint8 cost_class =
+          kernel_cost_class_[item.node->id()].load(std::memory_order_relaxed);
+      if (cost_class != kCostUnknown) return cost_class == kCostExpensive;
+    }
+    return item.kernel_is_expensive;
+  }
+
+  // Called at the start of every step. Returns true if the step should
+  // measure kernel costs.
+  bool StartStep();
+
+  // Records that the kernel of node "id" computed for "usecs".
+  void RecordKernelCost(int id, int64 usecs) const {
+    measured_usecs_[id].fetch_add(usecs, std::memory_order_relaxed);
+    measured_count_[id].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Classifies every measured node against the cost threshold.
+  void ClassifyKernelCosts();
+
+  // Called at the start of every step that samples op latencies. Returns
+  // the op latency histogram cells, indexed by node id and null for the
+  // nodes that are not ops, and sets "*sample" to the number of sampled
+  // steps started before this one.
+  monitoring::SamplerCell* const* StartOpLatencySample(int64* sample);
+
   struct ControlFlowInfo {
     gtl::FlatSet<string> unique_frame_names;
     std::vector<string> frame_names;
@@ -372,7 +451,8 @@ class ExecutorImpl : public Executor {
         : input_count(0),
           total_inputs(0),
           pending_counts(nullptr),
-          nodes(nullptr) {}
+          nodes(nullptr),
+          frame_state_pool(NewFrameStatePool()) {}
 
     // The total number of inputs to a frame.
     int input_count;
@@ -391,9 +471,14 @@ class ExecutorImpl : public Executor {
     // The nodes in a frame. Used only for debugging.
     std::vector<const Node*>* nodes;  // Owned
 
+    // The finished instances of this frame, reused by later instances in
+    // this and later steps.
+    FrameStatePool* frame_state_pool;  // Owned
+
     ~FrameInfo() {
       delete pending_counts;
       delete nodes;
+      DeleteFrameStatePool(frame_state_pool);
     }
   };
 
@@ -420,11 +505,39 @@ class ExecutorImpl : public Executor {
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
+  // True iff some node has a "_schedule_priority" attribute, in which case
+  // the ready nodes are scheduled in priority order.
+  bool has_schedule_priorities_ = false;
+
+  // True iff some loop may run several iterations in parallel, in which case
+  // the ready nodes of the earliest iterations are scheduled first.
+  bool has_parallel_iterations_ = false;
+
   // Mapping from frame name to static information about the frame.
   // TODO(yuanbyu): We could cache it along with the graph so to avoid
   // the overhead of constructing it for each executor instance.
   gtl::FlatMap<string, FrameInfo*> frame_info_;
 
+  // Kernel cost measurements, indexed by node id. Only allocated if
+  // params_.inline_kernel_cost_threshold_usecs > 0.
+  std::atomic<int64> num_steps_started_;
+  std::unique_ptr<std::atomic<int64>[]> measured_usecs_;
+  std::unique_ptr<std::atomic<int64>[]> measured_count_;
+  std::unique_ptr<std::atomic<uint8>[]> kernel_cost_class_;
+
+  // Only created if params_.static_memory_plan_warmup_steps > 0.
+  std::unique_ptr<StaticMemoryPlanner> memory_planner_;
+
+  // The nodes in topological order, without the sink, if the steps can run
+  // inline. See LocalExecutorParams::inline_synchronous_cpu_graphs.
+  std::vector<const NodeItem*> inline_order_;
+
+  // Created by the first step that samples op latencies.
+  mutex op_latency_mu_;
+  std::unique_ptr<monitoring::SamplerCell*[]> op_latency_cells_
+      GUARDED_BY(op_latency_mu_);
+  int64 num_op_latency_samples_ GUARDED_BY(op_latency_mu_) = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -619,6 +732,30 @@ Status ExecutorImpl::Initialize() {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
+  // Create the kernels of all nodes up front if a pool was given for it.
+  // Failures are reported below in node id order, as in the serial case.
+  std::vector<Status> kernel_status;
+  if (params_.kernel_creation_pool != nullptr) {
+    std::vector<const Node*> nodes;
+    nodes.reserve(graph_->num_nodes());
+    for (const Node* n : graph_->nodes()) nodes.push_back(n);
+    kernel_status.resize(graph_->num_node_ids());
+    auto create_kernels = [this, &nodes, &kernel_status](int64 begin,
+                                                         int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const Node* n = nodes[i];
+        kernel_status[n->id()] =
+            params_.create_kernel(n->def(), &gview_.node(n->id())->kernel);
+      }
+    };
+    // Kernel construction is typically a few microseconds, dominated by
+    // attr parsing and registry lookups.
+    const int64 kKernelCreationCost = 10000;
+    Shard(params_.kernel_creation_pool->NumThreads(),
+          params_.kernel_creation_pool, nodes.size(), kKernelCreationCost,
+          create_kernels);
+  }
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   for (const Node* n : graph_->nodes()) {
@@ -637,7 +774,9 @@ Status ExecutorImpl::Initialize() {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->def(), &item->kernel);
+    Status s = kernel_status.empty()
+                   ? params_.create_kernel(n->def(), &item->kernel)
+                   : kernel_status[id];
     if (!s.ok()) {
       item->kernel = nullptr;
       s = AttachDef(s, *n);
@@ -654,6 +793,18 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    if (GetNodeAttr(n->attrs(), "_schedule_priority",
+                    &item->schedule_priority)
+            .ok()) {
+      has_schedule_priorities_ = true;
+    }
+    int32 parallel_iterations;
+    if (item->is_enter &&
+        GetNodeAttr(n->attrs(), "parallel_iterations", &parallel_iterations)
+            .ok() &&
+        parallel_iterations > 1) {
+      has_parallel_iterations_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -677,9 +828,112 @@ Status ExecutorImpl::Initialize() {
   // all nodes.
   InitializePending(graph_, cf_info);
 
+  // In post order, the outputs of a node come before it, except along the
+  // back edges from NextIteration nodes, which are skipped.
+  std::vector<Node*> post_order;
+  GetPostOrder(*graph_, &post_order);
+  for (const Node* n : post_order) {
+    int32 length = 0;
+    if (!IsNextIteration(n)) {
+      for (const Edge* e : n->out_edges()) {
+        length = std::max(
+            length, gview_.node(e->dst()->id())->critical_path_length);
+      }
+    }
+    gview_.node(n->id())->critical_path_length = length + 1;
+  }
+
+  if (params_.inline_kernel_cost_threshold_usecs > 0) {
+    const int num_nodes = graph_->num_node_ids();
+    measured_usecs_.reset(new std::atomic<int64>[num_nodes]);
+    measured_count_.reset(new std::atomic<int64>[num_nodes]);
+    kernel_cost_class_.reset(new std::atomic<uint8>[num_nodes]);
+    for (int i = 0; i < num_nodes; ++i) {
+      measured_usecs_[i] = 0;
+      measured_count_[i] = 0;
+      kernel_cost_class_[i] = kCostUnknown;
+    }
+  }
+
+  if (params_.static_memory_plan_warmup_steps > 0) {
+    memory_planner_.reset(
+        new StaticMemoryPlanner(params_.static_memory_plan_warmup_steps));
+  }
+
+  if (params_.inline_synchronous_cpu_graphs &&
+      params_.device->device_type() == DEVICE_CPU &&
+      params_.node_outputs_cb == nullptr && !device_record_tensor_accesses_) {
+    bool can_run_inline = true;
+    for (const Node* n : graph_->nodes()) {
+      if (gview_.node(n->id())->kernel_is_async || IsControlFlow(n) ||
+          IsControlTrigger(n) || IsRecv(n)) {
+        can_run_inline = false;
+        break;
+      }
+    }
+    if (can_run_inline) {
+      std::vector<Node*> order;
+      GetReversePostOrder(*graph_, &order);
+      for (const Node* n : order) {
+        if (!n->IsSink()) inline_order_.push_back(gview_.node(n->id()));
+      }
+    }
+  }
+
   return gview_.SetAllocAttrs(graph_, params_.device);
 }
 
+bool ExecutorImpl::StartStep() {
+  if (kernel_cost_class_ == nullptr) return false;
+  const int64 step = num_steps_started_.fetch_add(1, std::memory_order_relaxed);
+  const int64 warmup_steps = std::max(params_.kernel_cost_warmup_steps, 1);
+  if (step == warmup_steps) {
+    // Steps still running from the warmup may keep adding measurements,
+    // which only makes the averages slightly more precise.
+    ClassifyKernelCosts();
+  }
+  return step < warmup_steps;
+}
+
+monitoring::SamplerCell* const* ExecutorImpl::StartOpLatencySample(
+    int64* sample) {
+  mutex_lock l(op_latency_mu_);
+  if (op_latency_cells_ == nullptr) {
+    const int num_nodes = graph_->num_node_ids();
+    op_latency_cells_.reset(new monitoring::SamplerCell*[num_nodes]);
+    for (int i = 0; i < num_nodes; ++i) op_latency_cells_[i] = nullptr;
+    const string device_type = params_.device->device_type();
+    for (const Node* n : graph_->nodes()) {
+      if (!n->IsOp()) continue;
+      op_latency_cells_[n->id()] =
+          op_latency_usecs->GetCell(n->type_string(), device_type);
+    }
+  }
+  *sample = num_op_latency_samples_++;
+  return op_latency_cells_.get();
+}
+
+void ExecutorImpl::ClassifyKernelCosts() {
+  const int64 threshold = params_.inline_kernel_cost_threshold_usecs;
+  int num_cheap = 0;
+  int num_expensive = 0;
+  for (int i = 0; i < graph_->num_node_ids(); ++i) {
+    const int64 count = measured_count_[i].load(std::memory_order_relaxed);
+    if (count == 0) continue;
+    const int64 usecs = measured_usecs_[i].load(std::memory_order_relaxed);
+    if (usecs < threshold * count) {
+      kernel_cost_class_[i].store(kCostCheap, std::memory_order_relaxed);
+      ++num_cheap;
+    } else {
+      kernel_cost_class_[i].store(kCostExpensive, std::memory_order_relaxed);
+      ++num_expensive;
+    }
+  }
+  VLOG(1) << "Executor on " << params_.device->name() << ": " << num_cheap
+          << " kernels measured below " << threshold << "us will run inline, "
+          << num_expensive << " will be dispatched";
+}
+
 Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
   Status s;
   DeviceNameUtils::ParsedName local_dev_name = device->parsed_name();
@@ -786,6 +1040,10 @@ class ExecutorState {
 
   void RunAsync(Executor::DoneCallback done);
 
+  // Runs the nodes in impl_->inline_order_ one after the other on the
+  // calling thread, then calls "done".
+  void RunInline(Executor::DoneCallback done);
+
  private:
   // Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
   // TODO(yuanbyu): A better way to do "has_value"?
@@ -925,6 +1183,14 @@ class ExecutorState {
                                     dead_result);
     }
 
+    // Prepares a recycled iteration state for a new iteration.
+    // REQUIRES: input_tensors are cleared.
+    void Reset(const PendingCounts* pending_counts) {
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts_.CopyFrom(*pending_counts);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -1017,7 +1283,12 @@ class ExecutorState {
     // will only "execute" the dead exits of the final iteration.
     std::vector<const Node*> dead_exits GUARDED_BY(mu);
 
+    // The finished iteration states of this frame, reused by the following
+    // iterations. There are at most max_parallel_iterations + 1 of them.
+    std::vector<IterationState*> free_iterations GUARDED_BY(mu);
+
     // Static information specific to this frame.
+    ExecutorImpl::FrameInfo* frame_info = nullptr;
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
     std::vector<const Node*>* nodes = nullptr;
@@ -1025,16 +1296,47 @@ class ExecutorState {
     // Lock ordering: ExecutorState.mu_ < mu.
     mutex mu;
 
-    void InitializeFrameInfo(const string& enter_name) {
-      auto it_frame_info = executor->frame_info_.find(enter_name);
-      DCHECK(it_frame_info != executor->frame_info_.end());
-      ExecutorImpl::FrameInfo* finfo = it_frame_info->second;
+    void InitializeFrameInfo(ExecutorImpl::FrameInfo* finfo) {
+      frame_info = finfo;
       pending_counts = finfo->pending_counts;
       total_input_tensors = finfo->total_inputs;
       num_pending_inputs = finfo->input_count;
       nodes = finfo->nodes;
     }
 
+    // Returns the state for a new iteration, recycled if possible.
+    IterationState* NewIteration() EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      if (free_iterations.empty()) {
+        return new IterationState(pending_counts, total_input_tensors);
+      }
+      IterationState* state = free_iterations.back();
+      free_iterations.pop_back();
+      state->Reset(pending_counts);
+      return state;
+    }
+
+    // Releases the tensors of a finished iteration and keeps its state for
+    // reuse by NewIteration.
+    void ReleaseIteration(IterationState* state) EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      for (int i = 0; i < total_input_tensors; ++i) {
+        state->input_tensors[i] = Entry();
+      }
+      free_iterations.push_back(state);
+    }
+
+    // Prepares the finished frame for reuse by a new instance of the frame.
+    void Reset() EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      DCHECK_EQ(num_outstanding_iterations, 0);
+      frame_name.clear();
+      parent_iter = -1;
+      parent_frame = nullptr;
+      iteration_count = 0;
+      num_outstanding_iterations = 1;
+      next_iter_roots.clear();
+      inv_values.clear();
+      dead_exits.clear();
+    }
+
     inline IterationState* GetIteration(int64 iter)
         EXCLUSIVE_LOCKS_REQUIRED(mu) {
       size_t index = iter % iterations.size();
@@ -1109,6 +1411,9 @@ class ExecutorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* state : free_iterations) {
+        delete state;
+      }
     }
   };
 
@@ -1119,6 +1424,7 @@ class ExecutorState {
     int64 input_iter = -1;
     bool is_dead = false;
 
+    TaggedNode() {}
     TaggedNode(const Node* t_node, FrameState* in_frame, int64 in_iter,
                bool dead) {
       node = t_node;
@@ -1154,6 +1460,29 @@ class ExecutorState {
         front_index_ = 0;
       }
     }
+    // Pops the node of the earliest iteration in the frame of the front
+    // node, the earliest queued first among equals, so that a thread running
+    // several iterations of a loop does not let the later ones starve the
+    // earliest one.
+    TaggedNode pop_earliest_iteration() {
+      DCHECK_LT(front_index_, ready_.size());
+      const TaggedNode& front = ready_[front_index_];
+      int earliest = front_index_;
+      for (int i = front_index_ + 1; i < ready_.size(); ++i) {
+        if (ready_[i].input_frame == front.input_frame &&
+            ready_[i].input_iter < ready_[earliest].input_iter) {
+          earliest = i;
+        }
+      }
+      if (earliest == front_index_) {
+        TaggedNode node = front;
+        pop_front();
+        return node;
+      }
+      TaggedNode node = ready_[earliest];
+      ready_.erase(ready_.begin() + earliest);
+      return node;
+    }
     bool empty() const { return ready_.empty(); }
     const TaggedNode* begin() const { return ready_.begin() + front_index_; }
     const TaggedNode* end() const { return ready_.end(); }
@@ -1163,10 +1492,27 @@ class ExecutorState {
     int front_index_;
   };
 
+  // A ready node waiting in one of the work-stealing queues, together with
+  // the time it became ready (for step stats).
+  struct QueuedNode {
+    TaggedNode tagged_node;
+    int64 scheduled_usec = 0;
+  };
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
 
+  // true if this step measures the compute time of synchronous kernels.
+  const bool measure_kernel_costs_;
+
+  // If op_latency_cells_ is set, this step records the compute time of the
+  // synchronous kernels of the nodes whose id is op_latency_sample_offset_
+  // modulo op_latency_sampling_period_.
+  const int op_latency_sampling_period_;
+  int64 op_latency_sample_offset_ = 0;
+  monitoring::SamplerCell* const* op_latency_cells_ = nullptr;
+
   // true if LogMemory::IsEnabled(). Used to check memory enabled cheaply.
   const bool log_memory_;
 
@@ -1177,6 +1523,13 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  // Arenas serving the step-scoped temporary allocations of this step.
+  // They are released when the ExecutorState is deleted.
+  StepArenas step_arenas_;
+  // The allocations of this step in the static memory plan, or nullptr.
+  // Finished when the ExecutorState is deleted.
+  StaticMemoryPlanner::Step* const memory_plan_step_;
+  std::function<Allocator*(Allocator*)> wrap_allocator_;
   StepStatsCollector* stats_collector_;
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
@@ -1185,6 +1538,7 @@ class ExecutorState {
   const ExecutorImpl* impl_;
   CancellationManager* cancellation_manager_;
   Executor::Args::Runner runner_;
+  Executor::Args::PriorityRunner priority_runner_;
   bool sync_on_finish_;
 
   // Owned.
@@ -1201,6 +1555,15 @@ class ExecutorState {
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // Work-stealing scheduling state, only allocated if
+  // impl_->params_.num_work_stealing_workers > 0. Worker i owns queue i of
+  // *ws_queues_, and ws_worker_active_[i] is true while a closure playing
+  // the role of worker i is running on runner_. Each running worker counts
+  // as one outstanding op, so that this ExecutorState outlives it.
+  std::unique_ptr<WorkStealingQueues<QueuedNode>> ws_queues_;
+  std::unique_ptr<std::atomic<bool>[]> ws_worker_active_;
+  std::atomic<int> ws_num_active_workers_;
+
   mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
@@ -1222,7 +1585,11 @@ class ExecutorState {
   void FindOrCreateChildFrame(FrameState* frame, int64 iter, const Node* node,
                               FrameState** child);
 
-  // Delete a frame. Called when the frame is done.
+  // Returns a new instance of the frame "enter_name", reusing a finished
+  // instance from the frame's pool if possible.
+  FrameState* NewFrame(const string& enter_name, int parallel_iters);
+
+  // Delete a frame, or return it to its pool. Called when the frame is done.
   void DeleteFrame(FrameState* frame, TaggedNodeSeq* ready);
 
   // Cleanup frames and iterations starting from frame/iter. Called when
@@ -1230,8 +1597,16 @@ class ExecutorState {
   void CleanupFramesIterations(FrameState* frame, int64 iter,
                                TaggedNodeSeq* ready);
 
-  // Process a ready node in current thread.
-  void Process(TaggedNode node, int64 scheduled_usec);
+  // Process a ready node in current thread. "worker_id" is the index of the
+  // work-stealing worker running on the current thread, or -1.
+  void Process(TaggedNode node, int64 scheduled_usec, int worker_id);
+
+  // Sets the fields of the kernel parameters that are the same for all the
+  // nodes of the step.
+  void InitComputeParams(OpKernelContext::Params* params,
+                         TensorValueVec* inputs,
+                         DeviceContextVec* input_device_contexts,
+                         AllocatorAttributeVec* input_alloc_attrs);
 
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -1253,12 +1628,41 @@ class ExecutorState {
   // "node" just finishes. Takes ownership of "stats". Returns true if
   // execution has completed.
   bool NodeDone(const Status& s, const Node* node, const TaggedNodeSeq& ready,
-                NodeExecStats* stats, TaggedNodeReadyQueue* inline_ready);
+                NodeExecStats* stats, TaggedNodeReadyQueue* inline_ready,
+                int worker_id);
 
   // Schedule all the expensive nodes in 'ready', and put all the inexpensive
   // nodes in 'ready' into 'inline_ready'.
   void ScheduleReady(const TaggedNodeSeq& ready,
-                     TaggedNodeReadyQueue* inline_ready);
+                     TaggedNodeReadyQueue* inline_ready, int worker_id);
+
+  // Returns true if "ready" holds nodes of several iterations of one frame.
+  // Nodes of different frames are left in their order, as the iterations of
+  // different frames are not comparable.
+  static bool SpansSeveralIterations(const TaggedNodeSeq& ready);
+
+  // Runs "tagged_node" on another thread: as a separate closure on runner_,
+  // or through the queue of worker "worker_id" (any queue if -1) in
+  // work-stealing mode.
+  void Dispatch(const TaggedNode& tagged_node, int64 scheduled_usec,
+                int worker_id);
+
+  // Runs "tagged_node" as a separate closure, on priority_runner_ if it is
+  // set and on runner_ otherwise.
+  void RunClosure(const TaggedNode& tagged_node, int64 scheduled_usec);
+
+  // Work-stealing mode: starts up to "num_ready" idle workers so that newly
+  // queued nodes are picked up, possibly by stealing them.
+  void MaybeStartWorkers(size_t num_ready);
+
+  // Work-stealing mode: claims worker "worker_id" and starts it on runner_.
+  // Returns false if that worker is already running.
+  bool TryStartWorker(int worker_id);
+
+  // Work-stealing mode: the body of worker "worker_id". Processes the nodes
+  // of its own queue, newest first, then steals from the other queues, and
+  // returns once all the queues are empty.
+  void RunWorker(int worker_id);
 
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
@@ -1287,35 +1691,122 @@ class ExecutorState {
                          int64 input_iter) const NO_THREAD_SAFETY_ANALYSIS {
     return input_frame->GetIteration(input_iter)->input_tensors;
   }
+
+  friend class FrameStatePool;
+};
+
+// The finished instances of a frame of an executor. They keep their
+// iterations buffer and free iteration states, so a later instance of the
+// frame, in the same step or a later one, allocates neither.
+class FrameStatePool {
+ public:
+  FrameStatePool() {}
+
+  ~FrameStatePool() {
+    for (ExecutorState::FrameState* frame : frames_) {
+      delete frame;
+    }
+  }
+
+  // Returns a finished frame with "max_parallel_iterations", or nullptr.
+  ExecutorState::FrameState* Get(int max_parallel_iterations) {
+    mutex_lock l(mu_);
+    for (auto it = frames_.rbegin(); it != frames_.rend(); ++it) {
+      ExecutorState::FrameState* frame = *it;
+      if (frame->max_parallel_iterations == max_parallel_iterations) {
+        frames_.erase(std::next(it).base());
+        return frame;
+      }
+    }
+    return nullptr;
+  }
+
+  // Takes ownership of "frame", which is done.
+  void Release(ExecutorState::FrameState* frame) {
+    {
+      mutex_lock frame_lock(frame->mu);
+      frame->Reset();
+    }
+    {
+      mutex_lock l(mu_);
+      if (frames_.size() < kMaxFrames) {
+        frames_.push_back(frame);
+        return;
+      }
+    }
+    delete frame;
+  }
+
+ private:
+  // Bounds the memory kept by frames of nested loops and concurrent steps.
+  static constexpr size_t kMaxFrames = 32;
+
+  mutex mu_;
+  std::vector<ExecutorState::FrameState*> frames_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FrameStatePool);
 };
 
+constexpr size_t FrameStatePool::kMaxFrames;
+
+FrameStatePool* NewFrameStatePool() { return new FrameStatePool; }
+
+void DeleteFrameStatePool(FrameStatePool* pool) { delete pool; }
+
 ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
     : vlog_(VLOG_IS_ON(1)),
+      measure_kernel_costs_(impl->StartStep()),
+      op_latency_sampling_period_(args.op_latency_sampling_period),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
       rendezvous_(args.rendezvous),
       session_state_(args.session_state),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      memory_plan_step_(impl->memory_planner_ == nullptr
+                            ? nullptr
+                            : impl->memory_planner_->StartStep()),
       stats_collector_(args.stats_collector),
       slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
+      priority_runner_(args.priority_runner),
       sync_on_finish_(args.sync_on_finish),
-      num_outstanding_ops_(0) {
+      num_outstanding_ops_(0),
+      ws_num_active_workers_(0) {
+  if (op_latency_sampling_period_ > 0) {
+    int64 sample;
+    op_latency_cells_ = impl->StartOpLatencySample(&sample);
+    // Rotate through the nodes from one sampled step to the next.
+    op_latency_sample_offset_ = sample % op_latency_sampling_period_;
+  }
+  if (memory_plan_step_ != nullptr) {
+    StaticMemoryPlanner::Step* step = memory_plan_step_;
+    wrap_allocator_ = [step](Allocator* a) { return step->Wrap(a); };
+  }
+  const int num_workers = impl_->params_.num_work_stealing_workers;
+  if (num_workers > 0) {
+    ws_queues_.reset(new WorkStealingQueues<QueuedNode>(num_workers));
+    ws_worker_active_.reset(new std::atomic<bool>[num_workers]);
+    for (int i = 0; i < num_workers; ++i) {
+      ws_worker_active_[i] = false;
+    }
+  }
+
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
-  root_frame_ = new FrameState(impl_, 1);
+  root_frame_ = NewFrame("", 1);
   root_frame_->frame_id = 0;  // must be 0
-  root_frame_->InitializeFrameInfo(root_frame_->frame_name);
 
   // Initialize iteration 0.
   root_frame_->iterations.resize(root_frame_->max_parallel_iterations);
-  root_frame_->iterations[0] = new IterationState(
-      root_frame_->pending_counts, root_frame_->total_input_tensors);
+  {
+    mutex_lock frame_lock(root_frame_->mu);
+    root_frame_->iterations[0] = root_frame_->NewIteration();
+  }
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
 }
@@ -1328,6 +1819,9 @@ ExecutorState::~ExecutorState() {
     it->Unref();
   }
   delete slice_reader_cache_;
+  if (memory_plan_step_ != nullptr) {
+    impl_->memory_planner_->FinishStep(memory_plan_step_);
+  }
 }
 
 Status ExecutorImpl::BuildControlFlowInfo(const Graph* g,
@@ -1436,7 +1930,7 @@ void ExecutorState::RunAsync(Executor::DoneCallback done) {
     root_frame_->iterations[0]->outstanding_ops = ready.size();
     done_cb_ = std::move(done);
     // Schedule to run all the ready ops in thread pool.
-    ScheduleReady(ready, nullptr);
+    ScheduleReady(ready, nullptr, -1);
   }
 }
 
@@ -1485,7 +1979,8 @@ struct ExecutorState::AsyncState {
   }
 };
 
-void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
+void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec,
+                            int worker_id) {
   const GraphView& gview = impl_->gview_;
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
@@ -1496,25 +1991,9 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   AllocatorAttributeVec input_alloc_attrs;
 
   OpKernelContext::Params params;
-  params.step_id = step_id_;
+  InitComputeParams(&params, &inputs, &input_device_contexts,
+                    &input_alloc_attrs);
   Device* device = impl_->params_.device;
-  params.device = device;
-  params.log_memory = log_memory_;
-  params.record_tensor_accesses = impl_->device_record_tensor_accesses_;
-  params.rendezvous = rendezvous_;
-  params.session_state = session_state_;
-  params.tensor_store = tensor_store_;
-  params.cancellation_manager = cancellation_manager_;
-  params.call_frame = call_frame_;
-  params.function_library = impl_->params_.function_library;
-  params.resource_manager = device->resource_manager();
-  params.step_container = step_container_;
-  params.slice_reader_cache = slice_reader_cache_;
-  params.inputs = &inputs;
-  params.input_device_contexts = &input_device_contexts;
-  params.input_alloc_attrs = &input_alloc_attrs;
-  params.runner = &runner_;
-  params.stats_collector = stats_collector_;
 
   Status s;
   NodeExecStats* stats = nullptr;
@@ -1522,8 +2001,12 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   bool completed = false;
   inline_ready.push_back(tagged_node);
   while (!inline_ready.empty()) {
-    tagged_node = inline_ready.front();
-    inline_ready.pop_front();
+    if (impl_->has_parallel_iterations_) {
+      tagged_node = inline_ready.pop_earliest_iteration();
+    } else {
+      tagged_node = inline_ready.front();
+      inline_ready.pop_front();
+    }
     const Node* node = tagged_node.node;
     FrameState* input_frame = tagged_node.input_frame;
     int64 input_iter = tagged_node.input_iter;
@@ -1583,7 +2066,8 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         }
         MaybeMarkCompleted(input_frame, input_iter, id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+        completed =
+            NodeDone(s, item.node, ready, stats, &inline_ready, worker_id);
         continue;
       }
 
@@ -1614,7 +2098,9 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           if (stats) nodestats::SetOpEnd(stats);
           EntryVector outputs;
           Status s = ProcessOutputs(*state->item, &state->ctx, &outputs, stats);
-          if (stats) nodestats::SetMemory(stats, &state->ctx);
+          if (stats) {
+            nodestats::SetMemory(stats, &state->ctx, stats_collector_);
+          }
           // Clears inputs.
           const int num_inputs = state->item->num_inputs;
           for (int i = 0; i < num_inputs; ++i) {
@@ -1639,7 +2125,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
                                                  accessed);
           }
           bool completed =
-              NodeDone(s, state->item->node, ready, stats, nullptr);
+              NodeDone(s, state->item->node, ready, stats, nullptr, -1);
           delete state;
           if (completed) Finish();
         };
@@ -1649,7 +2135,18 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         // Synchronous computes.
         OpKernelContext ctx(&params, item.num_outputs);
         if (stats) nodestats::SetOpStart(stats);
-        device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        const bool sample_latency =
+            op_latency_cells_ != nullptr && op_latency_cells_[id] != nullptr &&
+            id % op_latency_sampling_period_ == op_latency_sample_offset_;
+        if (measure_kernel_costs_ || sample_latency) {
+          const int64 start_usecs = Env::Default()->NowMicros();
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+          const int64 usecs = Env::Default()->NowMicros() - start_usecs;
+          if (measure_kernel_costs_) impl_->RecordKernelCost(id, usecs);
+          if (sample_latency) op_latency_cells_[id]->Add(usecs);
+        } else {
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        }
         if (stats) nodestats::SetOpEnd(stats);
 
         s = ProcessOutputs(item, &ctx, &outputs, stats);
@@ -1658,7 +2155,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           ctx.retrieve_accessed_tensors(&accessed_tensors);
           device_context = ctx.op_device_context();
         }
-        if (stats) nodestats::SetMemory(stats, &ctx);
+        if (stats) nodestats::SetMemory(stats, &ctx, stats_collector_);
       }
     }
 
@@ -1683,7 +2180,8 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         scheduled_usec = nodestats::NowInUsec();
       }
       // Postprocess.
-      completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+      completed =
+          NodeDone(s, item.node, ready, stats, &inline_ready, worker_id);
     }
   }  // while !inline_ready.empty()
 
@@ -1691,6 +2189,110 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   if (completed) Finish();
 }
 
+void ExecutorState::InitComputeParams(OpKernelContext::Params* params,
+                                      TensorValueVec* inputs,
+                                      DeviceContextVec* input_device_contexts,
+                                      AllocatorAttributeVec* input_alloc_attrs) {
+  params->step_id = step_id_;
+  Device* device = impl_->params_.device;
+  params->device = device;
+  params->log_memory = log_memory_;
+  params->record_tensor_accesses = impl_->device_record_tensor_accesses_;
+  params->rendezvous = rendezvous_;
+  params->session_state = session_state_;
+  params->tensor_store = tensor_store_;
+  params->cancellation_manager = cancellation_manager_;
+  params->call_frame = call_frame_;
+  params->function_library = impl_->params_.function_library;
+  params->resource_manager = device->resource_manager();
+  params->step_container = step_container_;
+  params->step_arenas = &step_arenas_;
+  if (memory_plan_step_ != nullptr) {
+    params->wrap_allocator = &wrap_allocator_;
+  }
+  params->slice_reader_cache = slice_reader_cache_;
+  params->inputs = inputs;
+  params->input_device_contexts = input_device_contexts;
+  params->input_alloc_attrs = input_alloc_attrs;
+  params->runner = &runner_;
+  params->stats_collector = stats_collector_;
+}
+
+void ExecutorState::RunInline(Executor::DoneCallback done) {
+  done_cb_ = std::move(done);
+  Device* device = impl_->params_.device;
+  Status s = device->FillContextMap(impl_->graph_, &device_context_map_);
+
+  TensorValueVec inputs;
+  DeviceContextVec input_device_contexts;
+  AllocatorAttributeVec input_alloc_attrs;
+  OpKernelContext::Params params;
+  InitComputeParams(&params, &inputs, &input_device_contexts,
+                    &input_alloc_attrs);
+  params.frame_iter = FrameAndIter(root_frame_->frame_id, 0);
+
+  const GraphView& gview = impl_->gview_;
+  Entry* input_tensors = GetInputTensors(root_frame_, 0);
+  EntryVector outputs;
+  for (const NodeItem* item : impl_->inline_order_) {
+    if (!s.ok()) break;
+    const int id = item->node->id();
+    if (vlog_) {
+      VLOG(1) << "Process node inline: " << id << " step " << params.step_id
+              << " " << SummarizeNode(*item->node);
+    }
+    if (id < device_context_map_.size()) {
+      params.op_device_context = device_context_map_[id];
+    }
+    Entry* first_input = input_tensors + item->input_start;
+    bool is_input_dead = false;
+    s = PrepareInputs(*item, first_input, &inputs, &input_device_contexts,
+                      &input_alloc_attrs, &is_input_dead);
+    if (s.ok()) {
+      params.op_kernel = item->kernel;
+      params.is_input_dead = is_input_dead;
+      params.output_attr_array = item->output_attrs();
+      OpKernelContext ctx(&params, item->num_outputs);
+      device->Compute(item->kernel, &ctx);
+      s = ProcessOutputs(*item, &ctx, &outputs, nullptr);
+    }
+    for (int i = 0; i < item->num_inputs; ++i) {
+      (first_input + i)->ClearVal();
+    }
+    if (s.ok()) {
+      // The consumers come later in the order, so their inputs are set
+      // directly, without pending counts.
+      const EdgeInfo* edges = item->output_edge_list();
+      for (size_t out_index = 0; out_index < item->num_output_edges;
+           out_index++) {
+        const EdgeInfo& e = edges[out_index];
+        if (e.output_slot == Graph::kControlSlot) continue;
+        const int dst_loc = gview.node(e.dst_id)->input_start + e.input_slot;
+        if (e.is_last) {
+          input_tensors[dst_loc] = std::move(outputs[e.output_slot]);
+        } else {
+          input_tensors[dst_loc] = outputs[e.output_slot];
+        }
+      }
+    }
+    outputs.clear();
+  }
+
+  if (!s.ok()) {
+    if (rendezvous_) {
+      rendezvous_->StartAbort(s);
+    }
+    if (cancellation_manager_) {
+      cancellation_manager_->StartCancel();
+    }
+  }
+  {
+    mutex_lock l(mu_);
+    status_ = s;
+  }
+  Finish();
+}
+
 Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
                                     TensorValueVec* inputs,
                                     DeviceContextVec* input_device_contexts,
@@ -1996,14 +2598,15 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
 
 bool ExecutorState::NodeDone(const Status& s, const Node* node,
                              const TaggedNodeSeq& ready, NodeExecStats* stats,
-                             TaggedNodeReadyQueue* inline_ready) {
+                             TaggedNodeReadyQueue* inline_ready,
+                             int worker_id) {
   if (stats) {
     nodestats::SetAllEnd(stats);
     if (!SetTimelineLabel(node, stats)) {
       // Only record non-transfer nodes.
       stats_collector_->Save(impl_->params_.device->name(), stats);
     } else {
-      delete stats;
+      stats_collector_->Discard(stats);
     }
   }
 
@@ -2036,39 +2639,87 @@ bool ExecutorState::NodeDone(const Status& s, const Node* node,
 
   // Schedule the ready nodes in 'ready'.
   if (s.ok()) {
-    ScheduleReady(ready, inline_ready);
+    ScheduleReady(ready, inline_ready, worker_id);
   }
   return completed;
 }
 
+bool ExecutorState::SpansSeveralIterations(const TaggedNodeSeq& ready) {
+  bool several_iterations = false;
+  for (const auto& tagged_node : ready) {
+    if (tagged_node.input_frame != ready[0].input_frame) return false;
+    if (tagged_node.input_iter != ready[0].input_iter) {
+      several_iterations = true;
+    }
+  }
+  return several_iterations;
+}
+
 void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
-                                  TaggedNodeReadyQueue* inline_ready) {
+                                  TaggedNodeReadyQueue* inline_ready,
+                                  int worker_id) {
   if (ready.empty()) return;
 
+  const GraphView& gview = impl_->gview_;
+  TaggedNodeSeq ordered_ready;
+  if (impl_->has_schedule_priorities_ && ready.size() > 1) {
+    // Start the nodes in the order of the precomputed schedule.
+    ordered_ready = ready;
+    std::stable_sort(ordered_ready.begin(), ordered_ready.end(),
+                     [&gview](const TaggedNode& a, const TaggedNode& b) {
+                       return gview.node(a.node->id())->schedule_priority <
+                              gview.node(b.node->id())->schedule_priority;
+                     });
+  }
+  if (impl_->has_parallel_iterations_ && ready.size() > 1 &&
+      SpansSeveralIterations(ready)) {
+    // Start the nodes of the earliest iterations first, so that they reach
+    // the thread pool queue, which is FIFO, ahead of the later ones.
+    if (ordered_ready.empty()) ordered_ready = ready;
+    std::stable_sort(ordered_ready.begin(), ordered_ready.end(),
+                     [](const TaggedNode& a, const TaggedNode& b) {
+                       return a.input_iter < b.input_iter;
+                     });
+  }
+  const TaggedNodeSeq& nodes = ordered_ready.empty() ? ready : ordered_ready;
+
   int64 scheduled_usec = 0;
   if (stats_collector_) {
     scheduled_usec = nodestats::NowInUsec();
   }
   if (inline_ready == nullptr) {
+    if (ws_queues_ != nullptr) {
+      // The current thread does not own a worker, so hold an extra
+      // outstanding op while queuing: the workers may otherwise drain the
+      // queued nodes and finish the step before we are done here.
+      num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+      for (auto& tagged_node : nodes) {
+        QueuedNode queued;
+        queued.tagged_node = tagged_node;
+        queued.scheduled_usec = scheduled_usec;
+        ws_queues_->Push(queued);
+      }
+      MaybeStartWorkers(nodes.size());
+      if (num_outstanding_ops_.fetch_sub(1) == 1) Finish();
+      return;
+    }
     // Schedule to run all the ready ops in thread pool.
-    for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_usec); });
+    for (auto& tagged_node : nodes) {
+      RunClosure(tagged_node, scheduled_usec);
     }
     return;
   }
-  const GraphView& gview = impl_->gview_;
   const TaggedNode* curr_expensive_node = nullptr;
-  for (auto& tagged_node : ready) {
+  for (auto& tagged_node : nodes) {
     const NodeItem& item = *gview.node(tagged_node.node->id());
-    if (tagged_node.is_dead || !item.kernel_is_expensive) {
+    if (tagged_node.is_dead || !impl_->IsExpensive(item)) {
       // Inline this inexpensive node.
       inline_ready->push_back(tagged_node);
     } else {
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_usec));
+        Dispatch(*curr_expensive_node, scheduled_usec, worker_id);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2080,12 +2731,88 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_usec));
+      Dispatch(*curr_expensive_node, scheduled_usec, worker_id);
     }
   }
 }
 
+void ExecutorState::Dispatch(const TaggedNode& tagged_node,
+                             int64 scheduled_usec, int worker_id) {
+  if (ws_queues_ == nullptr) {
+    RunClosure(tagged_node, scheduled_usec);
+    return;
+  }
+  QueuedNode queued;
+  queued.tagged_node = tagged_node;
+  queued.scheduled_usec = scheduled_usec;
+  if (worker_id >= 0) {
+    // Keep the successors of a node on the worker that produced their
+    // inputs; idle workers can still steal them.
+    ws_queues_->PushLocal(worker_id, queued);
+  } else {
+    ws_queues_->Push(queued);
+  }
+  MaybeStartWorkers(1);
+}
+
+void ExecutorState::RunClosure(const TaggedNode& tagged_node,
+                               int64 scheduled_usec) {
+  auto closure = std::bind(&ExecutorState::Process, this, tagged_node,
+                           scheduled_usec, -1);
+  if (priority_runner_ == nullptr) {
+    runner_(closure);
+    return;
+  }
+  const NodeItem& item = *impl_->gview_.node(tagged_node.node->id());
+  priority_runner_(closure, item.critical_path_length);
+}
+
+void ExecutorState::MaybeStartWorkers(size_t num_ready) {
+  const int num_workers = ws_queues_->NumQueues();
+  size_t num_started = 0;
+  for (int i = 0; i < num_workers && num_started < num_ready; ++i) {
+    if (ws_num_active_workers_.load() >= num_workers) return;
+    if (TryStartWorker(i)) ++num_started;
+  }
+}
+
+bool ExecutorState::TryStartWorker(int worker_id) {
+  bool expected = false;
+  if (!ws_worker_active_[worker_id].compare_exchange_strong(expected, true)) {
+    return false;
+  }
+  ws_num_active_workers_.fetch_add(1);
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+  runner_([this, worker_id]() { RunWorker(worker_id); });
+  return true;
+}
+
+void ExecutorState::RunWorker(int worker_id) {
+  QueuedNode queued;
+  while (true) {
+    while (ws_queues_->PopLocal(worker_id, &queued) ||
+           ws_queues_->Steal(worker_id, &queued)) {
+      // Process() never finishes the step here since this worker still
+      // counts as an outstanding op.
+      Process(queued.tagged_node, queued.scheduled_usec, worker_id);
+    }
+    // Go idle. The worker is marked inactive before the queues are checked
+    // again, so a node queued concurrently is either seen below or seen
+    // by its producer, which then starts a worker for it.
+    ws_worker_active_[worker_id].store(false);
+    ws_num_active_workers_.fetch_sub(1);
+    if (ws_queues_->Empty()) break;
+    bool expected = false;
+    if (!ws_worker_active_[worker_id].compare_exchange_strong(expected,
+                                                              true)) {
+      // Another thread restarted this worker already.
+      break;
+    }
+    ws_num_active_workers_.fetch_add(1);
+  }
+  if (num_outstanding_ops_.fetch_sub(1) == 1) Finish();
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               int64 node_id) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
@@ -2235,6 +2962,19 @@ void ExecutorState::Finish() {
   runner([=]() { done_cb(status); });
 }
 
+ExecutorState::FrameState* ExecutorState::NewFrame(const string& enter_name,
+                                                  int parallel_iters) {
+  auto it_frame_info = impl_->frame_info_.find(enter_name);
+  DCHECK(it_frame_info != impl_->frame_info_.end());
+  ExecutorImpl::FrameInfo* finfo = it_frame_info->second;
+  FrameState* frame = finfo->frame_state_pool->Get(parallel_iters);
+  if (frame == nullptr) {
+    frame = new FrameState(impl_, parallel_iters);
+  }
+  frame->InitializeFrameInfo(finfo);
+  return frame;
+}
+
 void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
                                            const Node* node,
                                            FrameState** child) {
@@ -2260,18 +3000,19 @@ void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
   int parallel_iters;
   s = GetNodeAttr(node->attrs(), "parallel_iterations", &parallel_iters);
   DCHECK(s.ok()) << s;
-  FrameState* temp = new FrameState(impl_, parallel_iters);
+  FrameState* temp = NewFrame(enter_name, parallel_iters);
   temp->frame_name = child_name;
   temp->frame_id = Hash64(child_name);
   temp->parent_frame = frame;
   temp->parent_iter = iter;
-  temp->InitializeFrameInfo(enter_name);
 
   // 'iterations' is a fixed-length circular buffer.
   temp->iterations.resize(temp->max_parallel_iterations + 1);
   // Initialize iteration 0.
-  temp->iterations[0] =
-      new IterationState(temp->pending_counts, temp->total_input_tensors);
+  {
+    mutex_lock frame_lock(temp->mu);
+    temp->iterations[0] = temp->NewIteration();
+  }
 
   {
     mutex_lock executor_lock(mu_);
@@ -2296,31 +3037,35 @@ void ExecutorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
   if (parent_frame != nullptr) {
     mutex_lock paranet_frame_lock(parent_frame->mu);
     // Propagate all the dead exits to the parent frame.
+    const GraphView& gview = impl_->gview_;
     for (const Node* node : frame->dead_exits) {
       auto parent_iter_state = parent_frame->GetIteration(parent_iter);
-      for (const Edge* e : node->out_edges()) {
-        const Node* dst_node = e->dst();
-
-        auto dst_pending_id = impl_->gview_.node(dst_node->id())->pending_id;
+      const NodeItem* item = gview.node(node->id());
+      const EdgeInfo* edges = item->output_edge_list();
+      for (size_t out_index = 0; out_index < item->num_output_edges;
+           out_index++) {
+        const EdgeInfo& e = edges[out_index];
+        const NodeItem* dst_item = gview.node(e.dst_id);
+        const auto dst_pending_id = dst_item->pending_id;
 
         // TODO(yuanbyu): We don't need this if we require the subgraph
         // given to an executor not to contain a sink node.
-        if (dst_node->IsSink()) continue;
+        if (dst_item->is_sink) continue;
 
         bool dst_dead = true;
         bool dst_ready = false;
         // We know this is a dead input to dst.
-        if (IsMerge(dst_node)) {
-          if (e->IsControlEdge()) {
+        if (dst_item->is_merge) {
+          if (e.output_slot == Graph::kControlSlot) {
             parent_iter_state->decrement_pending(dst_pending_id, 2);
             int count = parent_iter_state->pending(dst_pending_id);
             int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-            dst_dead = (dead_cnt == dst_node->num_inputs());
+            dst_dead = (dead_cnt == dst_item->num_inputs);
             dst_ready = (count == 0) || ((count == 1) && dst_dead);
           } else {
             parent_iter_state->increment_dead_count(dst_pending_id);
             const int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-            dst_dead = (dead_cnt == dst_node->num_inputs());
+            dst_dead = (dead_cnt == dst_item->num_inputs);
             dst_ready =
                 (parent_iter_state->pending(dst_pending_id) == 1) && dst_dead;
           }
@@ -2330,9 +3075,9 @@ void ExecutorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
               (parent_iter_state->decrement_pending(dst_pending_id, 1) == 0);
         }
         if (dst_ready) {
-          if (IsControlTrigger(dst_node)) dst_dead = false;
+          if (dst_item->is_control_trigger) dst_dead = false;
           ready->push_back(
-              TaggedNode(dst_node, parent_frame, parent_iter, dst_dead));
+              TaggedNode(dst_item->node, parent_frame, parent_iter, dst_dead));
           parent_iter_state->outstanding_ops++;
         }
       }
@@ -2346,7 +3091,7 @@ void ExecutorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
     mutex_lock executor_lock(mu_);
     outstanding_frames_.erase(frame_name);
   }
-  delete frame;
+  frame->frame_info->frame_state_pool->Release(frame);
 }
 
 void ExecutorState::CleanupFramesIterations(FrameState* frame, int64 iter,
@@ -2526,8 +3271,7 @@ void ExecutorState::FrameState::IncrementIteration(const GraphView* gview,
   int64 next_iter = iteration_count;
 
   // Initialize the next iteration.
-  IterationState* iter_state =
-      new IterationState(pending_counts, total_input_tensors);
+  IterationState* iter_state = NewIteration();
   SetIteration(next_iter, iter_state);
   num_outstanding_iterations++;
   dead_exits.clear();
@@ -2545,7 +3289,7 @@ bool ExecutorState::FrameState::CleanupIterations(const GraphView* gview,
   int64 curr_iter = iter;
   while (curr_iter <= iteration_count && IsIterationDone(curr_iter)) {
     // Delete the iteration curr_iter.
-    delete GetIteration(curr_iter);
+    ReleaseIteration(GetIteration(curr_iter));
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -2560,7 +3304,13 @@ bool ExecutorState::FrameState::CleanupIterations(const GraphView* gview,
 }
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
-  (new ExecutorState(args, this))->RunAsync(std::move(done));
+  ExecutorState* state = new ExecutorState(args, this);
+  if (!inline_order_.empty() && args.stats_collector == nullptr &&
+      args.op_latency_sampling_period == 0) {
+    state->RunInline(std::move(done));
+  } else {
+    state->RunAsync(std::move(done));
+  }
 }
 
 }  // end namespace
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 
@@ -97,6 +98,20 @@ class Executor {
     typedef std::function<void(Closure)> Runner;
     Runner runner = nullptr;
 
+    // If set, the closures running individual nodes are dispatched to
+    // "priority_runner" instead of "runner", along with a priority that is
+    // higher for the nodes on longer paths to the end of the graph, so that
+    // a runner ordering its pending closures by priority favors the
+    // critical path.
+    typedef std::function<void(Closure, int64 priority)> PriorityRunner;
+    PriorityRunner priority_runner = nullptr;
+
+    // If > 0, the compute time of the synchronous kernels of one node in
+    // "op_latency_sampling_period" is recorded in the op latency histogram
+    // exported through the monitoring library. The sampled nodes rotate
+    // from one such step to the next.
+    int op_latency_sampling_period = 0;
+
     // A callback that is invoked each time a node has finished executing.
     typedef std::function<Status(const string& node_name, const int output_slot,
                                  const Tensor* tensor, const bool is_ref,
@@ -141,6 +156,38 @@ struct LocalExecutorParams {
   std::function<void(OpKernel*)> delete_kernel;
 
   Executor::Args::NodeOutputsCallback node_outputs_cb;
+
+  // If > 0, ready nodes are scheduled on this many per-worker
+  // work-stealing queues, drained by at most this many closures running on
+  // Args::runner, instead of dispatching every ready node to the runner
+  // as a separate closure. Typically set to the number of threads backing
+  // the runner.
+  int num_work_stealing_workers = 0;
+
+  // If > 0, the executor measures the compute time of each synchronous
+  // kernel during its first "kernel_cost_warmup_steps" steps. Afterwards a
+  // ready node whose measured average is below this many microseconds is
+  // run inline by the thread that made it ready, and the other nodes are
+  // dispatched, regardless of OpKernel::IsExpensive().
+  int64 inline_kernel_cost_threshold_usecs = 0;
+  int kernel_cost_warmup_steps = 10;
+
+  // If > 0, the allocations made through OpKernelContext during the
+  // "static_memory_plan_warmup_steps"-th step are recorded, and every
+  // later step is served from a static memory plan computed from them.
+  // See StaticMemoryPlanner.
+  int static_memory_plan_warmup_steps = 0;
+
+  // If true and the graph is on a CPU device, has only synchronous kernels
+  // and no control flow or Recv nodes, each step runs the nodes in a
+  // topological order computed by NewLocalExecutor, on the thread calling
+  // RunAsync. Steps with a stats_collector or op latency sampling don't.
+  bool inline_synchronous_cpu_graphs = false;
+
+  // If not null, the kernels of the graph's nodes are created concurrently on
+  // this pool while the executor is initialized, so "create_kernel" must be
+  // safe to call from several threads at once. Not owned.
+  thread::ThreadPool* kernel_creation_pool = nullptr;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph* graph, Executor** executor);
@@ -0,0 +1,187 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the runtime overhead of running a step, as opposed to the
+// time spent in kernels. Every graph here is made of ops that do next to no
+// work on scalars, so the times are dominated by the executor, the
+// rendezvous, the allocator and, for BM_SessionRun, DirectSession::Run.
+//
+// Like every benchmark, the results are written through TestReporter when
+// TEST_REPORT_FILE_PREFIX is set.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// The executor overhead is clearest with a single thread for running ops.
+SessionOptions InitOptions() {
+  SessionOptions opts;
+  opts.config.set_intra_op_parallelism_threads(1);
+  opts.config.set_inter_op_parallelism_threads(1);
+  return opts;
+}
+
+SessionOptions* GetOptions() {
+  static SessionOptions opts = InitOptions();
+  return &opts;
+}
+
+Node* Scalar(Graph* g, float val) {
+  Tensor t(DT_FLOAT, TensorShape({}));
+  t.scalar<float>()() = val;
+  return test::graph::Constant(g, t);
+}
+
+Node* ScalarInt(Graph* g, int32 val) {
+  Tensor t(DT_INT32, TensorShape({}));
+  t.scalar<int32>()() = val;
+  return test::graph::Constant(g, t);
+}
+
+// A chain of "length" Identity nodes.
+void BM_Chain(int iters, int length) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* cur = Scalar(g, 1.0);
+  for (int i = 0; i < length; ++i) {
+    cur = test::graph::Identity(g, cur);
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * length);
+  test::Benchmark("cpu", g, GetOptions()).Run(iters);
+}
+BENCHMARK(BM_Chain)->Arg(16)->Arg(256)->Arg(4096);
+
+// One node fanning out to "width" Identity nodes, which all feed a NoOp.
+void BM_FanOut(int iters, int width) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* src = Scalar(g, 1.0);
+  std::vector<Node*> outs;
+  for (int i = 0; i < width; ++i) {
+    outs.push_back(test::graph::Identity(g, src));
+  }
+  test::graph::NoOp(g, outs);
+  testing::ItemsProcessed(static_cast<int64>(iters) * width);
+  test::Benchmark("cpu", g, GetOptions()).Run(iters);
+}
+BENCHMARK(BM_FanOut)->Arg(16)->Arg(256)->Arg(4096);
+
+Node* ConstantEnter(Graph* g, Node* input, const string& frame_name) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Enter")
+                  .Input(input)
+                  .Attr("frame_name", frame_name)
+                  .Attr("is_constant", true)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+// A while loop counting from 0 to "loop_iters", i.e. running the condition
+// and the body "loop_iters" times per step.
+void BM_WhileLoop(int iters, int loop_iters) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const string frame = "while";
+  const string next_name = "while/next";
+  Node* enter = test::graph::Enter(g, ScalarInt(g, 0), frame);
+  Node* merge = test::graph::Merge(g, enter, {next_name});
+  Node* limit = ConstantEnter(g, ScalarInt(g, loop_iters), frame);
+  Node* one = ConstantEnter(g, ScalarInt(g, 1), frame);
+  Node* cond = test::graph::LoopCond(g, test::graph::Less(g, merge, limit));
+  Node* sw = test::graph::Switch(g, merge, cond);
+  Node* body = test::graph::Identity(g, sw, 1);
+  Node* next = test::graph::Next(g, next_name, test::graph::Add(g, body, one));
+  // The back edge is only named in the Merge's NodeDef, so add it to the
+  // graph as well.
+  g->AddEdge(next, 0, merge, 1);
+  test::graph::Exit(g, sw);
+  testing::ItemsProcessed(static_cast<int64>(iters) * loop_iters);
+  test::Benchmark("cpu", g, GetOptions()).Run(iters);
+}
+BENCHMARK(BM_WhileLoop)->Arg(1)->Arg(16)->Arg(256);
+
+// "num_pairs" Send/Recv pairs going through the local rendezvous.
+void BM_SendRecv(int iters, int num_pairs) {
+  const string device = "/job:localhost/replica:0/task:0/cpu:0";
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* src = Scalar(g, 1.0);
+  for (int i = 0; i < num_pairs; ++i) {
+    const string tensor = strings::StrCat("t", i);
+    test::graph::Send(g, src, tensor, device, 1, device);
+    test::graph::Recv(g, tensor, "float", device, 1, device);
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_pairs);
+  test::Benchmark("cpu", g, GetOptions()).Run(iters);
+}
+BENCHMARK(BM_SendRecv)->Arg(1)->Arg(16)->Arg(256);
+
+// DirectSession::Run on a graph that adds up "num_feeds" fed scalars, so
+// the time is dominated by the handling of the feeds and the fetch.
+void BM_SessionRun(int iters, int num_feeds) {
+  testing::StopTiming();
+  Graph g(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 1.0;
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<NodeBuilder::NodeOut> placeholders;
+  for (int i = 0; i < num_feeds; ++i) {
+    Node* placeholder;
+    TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                    .Attr("shape", TensorShape())
+                    .Attr("dtype", DT_FLOAT)
+                    .Finalize(&g, &placeholder));
+    inputs.push_back({placeholder->name() + ":0", value});
+    placeholders.emplace_back(placeholder);
+  }
+  Node* sum;
+  TF_CHECK_OK(NodeBuilder(g.NewName("AddN"), "AddN")
+                  .Input(placeholders)
+                  .Finalize(&g, &sum));
+  const std::vector<string> outputs = {sum->name() + ":0"};
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  std::unique_ptr<Session> session(NewSession(*GetOptions()));
+  TF_CHECK_OK(session->Create(gd));
+  {
+    // The first run creates the executors, which is not measured here.
+    std::vector<Tensor> output_values;
+    TF_CHECK_OK(session->Run(inputs, outputs, {}, &output_values));
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_feeds);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    std::vector<Tensor> output_values;
+    TF_CHECK_OK(session->Run(inputs, outputs, {}, &output_values));
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_SessionRun)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+struct FairShareScheduler::Queue {
+  struct Closure {
+    int64 priority;
+    uint64 seq;
+    std::function<void()> fn;
+  };
+  struct Compare {
+    bool operator()(const Closure& a, const Closure& b) const {
+      if (a.priority != b.priority) return a.priority < b.priority;
+      return a.seq > b.seq;
+    }
+  };
+
+  explicit Queue(int32 weight) : weight(weight) {}
+
+  const int32 weight;
+  // The fields below are guarded by FairShareScheduler::mu_.
+  double virtual_time = 0;
+  uint64 next_seq = 0;
+  // A heap of the pending closures.
+  std::vector<Closure> closures;
+};
+
+FairShareScheduler::FairShareScheduler(Env* env, thread::ThreadPool* pool)
+    : env_(env), pool_(pool) {}
+
+std::shared_ptr<FairShareScheduler::Queue> FairShareScheduler::NewQueue(
+    int32 weight) {
+  CHECK_GT(weight, 0);
+  return std::make_shared<Queue>(weight);
+}
+
+void FairShareScheduler::Schedule(const std::shared_ptr<Queue>& queue,
+                                  std::function<void()> fn, int64 priority) {
+  CHECK(fn != nullptr);
+  {
+    mutex_lock l(mu_);
+    if (queue->closures.empty()) {
+      queue->virtual_time = std::max(queue->virtual_time, virtual_time_);
+      pending_.push_back(queue);
+    }
+    queue->closures.push_back(
+        Queue::Closure{priority, queue->next_seq++, std::move(fn)});
+    std::push_heap(queue->closures.begin(), queue->closures.end(),
+                   Queue::Compare());
+  }
+  pool_->Schedule([this]() { RunNext(); });
+}
+
+void FairShareScheduler::RunNext() {
+  std::shared_ptr<Queue> queue;
+  std::function<void()> fn;
+  {
+    mutex_lock l(mu_);
+    // Each scheduled closure is matched by one call, so there is one.
+    DCHECK(!pending_.empty());
+    size_t next = 0;
+    for (size_t i = 1; i < pending_.size(); ++i) {
+      if (pending_[i]->virtual_time < pending_[next]->virtual_time) next = i;
+    }
+    queue = pending_[next];
+    std::pop_heap(queue->closures.begin(), queue->closures.end(),
+                  Queue::Compare());
+    fn = std::move(queue->closures.back().fn);
+    queue->closures.pop_back();
+    if (queue->closures.empty()) {
+      pending_[next] = std::move(pending_.back());
+      pending_.pop_back();
+    }
+    virtual_time_ = queue->virtual_time;
+  }
+  const uint64 start_usecs = env_->NowMicros();
+  fn();
+  const uint64 elapsed_usecs = env_->NowMicros() - start_usecs;
+  mutex_lock l(mu_);
+  queue->virtual_time += static_cast<double>(elapsed_usecs) / queue->weight;
+}
+
+}  // namespace tensorflow
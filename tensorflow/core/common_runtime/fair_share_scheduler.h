@@ -0,0 +1,89 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
+#define TENSORFLOW_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// FairShareScheduler multiplexes the closures of several clients, e.g. the
+// sessions of a serving process, onto one thread pool, so that each client
+// with pending closures gets a share of the pool's threads proportional to
+// its weight.
+//
+// Each client schedules its closures on its own queue. The scheduler keeps
+// a virtual time per queue, advanced by the time each of its closures ran
+// divided by its weight, and every thread of the pool that becomes free
+// runs a closure of the pending queue with the least virtual time. A queue
+// that was idle starts from the virtual time of the last closure run, so
+// that it gets no credit for the time it was idle. Within a queue, the
+// closures run in decreasing order of priority, and in FIFO order among
+// equal priorities.
+//
+//    FairShareScheduler scheduler(Env::Default(), pool);
+//    auto a = scheduler.NewQueue(1);
+//    auto b = scheduler.NewQueue(3);
+//    scheduler.Schedule(a, fn);  // Under load, b runs 3 times as long as a.
+//
+// This class is thread-safe.
+class FairShareScheduler {
+ public:
+  struct Queue;
+
+  // Schedules closures on "pool", which is not owned and must outlive this
+  // scheduler. All the scheduled closures must have run before this
+  // scheduler is destroyed.
+  FairShareScheduler(Env* env, thread::ThreadPool* pool);
+
+  // Returns a new queue with weight "weight". The queue stays valid as long
+  // as the caller, or a pending closure of the queue, holds a reference.
+  //
+  // REQUIRES: weight > 0
+  std::shared_ptr<Queue> NewQueue(int32 weight);
+
+  // Schedules fn() to run on the pool as a closure of "queue".
+  void Schedule(const std::shared_ptr<Queue>& queue, std::function<void()> fn,
+                int64 priority = 0);
+
+ private:
+  // Runs the next closure of the pending queue with the least virtual time.
+  void RunNext();
+
+  Env* const env_;
+  thread::ThreadPool* const pool_;
+
+  mutex mu_;
+  // The queues with pending closures, in no particular order.
+  std::vector<std::shared_ptr<Queue>> pending_ GUARDED_BY(mu_);
+  // The virtual time of the queue whose closure was run last.
+  double virtual_time_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FairShareScheduler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
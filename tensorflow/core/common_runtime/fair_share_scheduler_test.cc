@@ -0,0 +1,112 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(FairShareSchedulerTest, RunsByPriorityWithinAQueue) {
+  std::vector<int> order;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    FairShareScheduler scheduler(Env::Default(), &pool);
+    auto queue = scheduler.NewQueue(1);
+    // Keep the only thread busy until all the closures are pending.
+    Notification start;
+    pool.Schedule([&start]() { start.WaitForNotification(); });
+    const std::vector<std::pair<int, int64>> work = {
+        {0, 1}, {1, 3}, {2, 2}, {3, 3}};
+    for (const auto& w : work) {
+      const int id = w.first;
+      scheduler.Schedule(queue, [&order, id]() { order.push_back(id); },
+                         w.second);
+    }
+    start.Notify();
+  }
+  EXPECT_EQ(std::vector<int>({1, 3, 2, 0}), order);
+}
+
+TEST(FairShareSchedulerTest, SharesThePoolByWeight) {
+  const int kClosuresPerQueue = 16;
+  std::vector<int> order;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    FairShareScheduler scheduler(Env::Default(), &pool);
+    auto light = scheduler.NewQueue(1);
+    auto heavy = scheduler.NewQueue(3);
+    Notification start;
+    pool.Schedule([&start]() { start.WaitForNotification(); });
+    for (int i = 0; i < kClosuresPerQueue; ++i) {
+      for (int queue = 0; queue < 2; ++queue) {
+        scheduler.Schedule(queue == 0 ? light : heavy, [&order, queue]() {
+          Env::Default()->SleepForMicroseconds(1000);
+          order.push_back(queue);
+        });
+      }
+    }
+    start.Notify();
+  }
+  ASSERT_EQ(2 * kClosuresPerQueue, order.size());
+  // While both queues have pending closures, the heavy one gets about 3 of
+  // every 4 runs.
+  int num_heavy = 0;
+  for (int i = 0; i < kClosuresPerQueue; ++i) num_heavy += order[i];
+  EXPECT_GE(num_heavy, kClosuresPerQueue / 2 + 2);
+}
+
+TEST(FairShareSchedulerTest, IdleQueueGetsNoCredit) {
+  std::vector<int> order;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    FairShareScheduler scheduler(Env::Default(), &pool);
+    auto busy = scheduler.NewQueue(1);
+    auto idle = scheduler.NewQueue(1);
+    // Let "busy" run alone for a while.
+    for (int i = 0; i < 4; ++i) {
+      Notification done;
+      scheduler.Schedule(busy, [&done]() {
+        Env::Default()->SleepForMicroseconds(1000);
+        done.Notify();
+      });
+      done.WaitForNotification();
+    }
+    Notification start;
+    pool.Schedule([&start]() { start.WaitForNotification(); });
+    for (int i = 0; i < 4; ++i) {
+      for (int queue = 0; queue < 2; ++queue) {
+        scheduler.Schedule(queue == 0 ? busy : idle, [&order, queue]() {
+          Env::Default()->SleepForMicroseconds(1000);
+          order.push_back(queue);
+        });
+      }
+    }
+    start.Notify();
+  }
+  // Both queues share the pool rather than "idle" running first until it
+  // has caught up with the time "busy" ran alone.
+  ASSERT_EQ(8, order.size());
+  int num_busy = 0;
+  for (int i = 0; i < 4; ++i) num_busy += 1 - order[i];
+  EXPECT_GE(num_busy, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -204,7 +204,30 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     const Graph* graph = nullptr;  // Owned by exec.
     Executor* exec = nullptr;
 
-    ~Item() override { delete this->exec; }
+    // True if the graph has Send or Recv nodes, which need a rendezvous.
+    bool needs_rendezvous = false;
+
+    // True if all the kernels are synchronous and inexpensive, in which case
+    // calls run inline on the caller's thread instead of on opts.runner.
+    bool run_inline = true;
+
+    // Returns a call frame for a new call, reused from a finished one if
+    // possible.
+    FunctionCallFrame* NewCallFrame(const FunctionBody* fbody);
+
+    // Clears "frame" and keeps it for a later call.
+    void ReleaseCallFrame(FunctionCallFrame* frame);
+
+    ~Item() override {
+      delete this->exec;
+      for (FunctionCallFrame* frame : free_frames) {
+        delete frame;
+      }
+    }
+
+   private:
+    mutex mu;
+    std::vector<FunctionCallFrame*> free_frames GUARDED_BY(mu);
   };
   std::vector<Item*> items_;
 
@@ -481,16 +504,64 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Handle handle, Item** item) {
   params.delete_kernel = [](OpKernel* kernel) {
     DeleteNonCachedKernel(kernel);
   };
+  Item* new_item = new Item;
+  params.create_kernel = [this, new_item](const NodeDef& ndef,
+                                          OpKernel** kernel) {
+    Status s = create_kernel_(ndef, kernel);
+    if (s.ok() &&
+        ((*kernel)->AsAsync() != nullptr || (*kernel)->IsExpensive())) {
+      new_item->run_inline = false;
+    }
+    return s;
+  };
   Graph* graph = g.get();
+  for (const Node* n : graph->nodes()) {
+    if (n->IsSend() || n->IsRecv()) {
+      new_item->needs_rendezvous = true;
+      new_item->run_inline = false;
+    }
+  }
   Executor* exec;
-  TF_RETURN_IF_ERROR(NewLocalExecutor(params, g.release(), &exec));
-
-  *item = new Item;
-  (*item)->graph = graph;
-  (*item)->exec = exec;
+  Status s = NewLocalExecutor(params, g.release(), &exec);
+  if (!s.ok()) {
+    new_item->Unref();
+    return s;
+  }
+  new_item->graph = graph;
+  new_item->exec = exec;
+  *item = new_item;
   return Status::OK();
 }
 
+FunctionCallFrame* FunctionLibraryRuntimeImpl::Item::NewCallFrame(
+    const FunctionBody* fbody) {
+  {
+    mutex_lock l(mu);
+    if (!free_frames.empty()) {
+      FunctionCallFrame* frame = free_frames.back();
+      free_frames.pop_back();
+      return frame;
+    }
+  }
+  return new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
+}
+
+void FunctionLibraryRuntimeImpl::Item::ReleaseCallFrame(
+    FunctionCallFrame* frame) {
+  // Bounds the frames kept by many concurrent calls, e.g. from a parallel
+  // map.
+  static constexpr size_t kMaxFreeFrames = 16;
+  frame->Reset();
+  {
+    mutex_lock l(mu);
+    if (free_frames.size() < kMaxFreeFrames) {
+      free_frames.push_back(frame);
+      return;
+    }
+  }
+  delete frame;
+}
+
 Status FunctionLibraryRuntimeImpl::GetOrCreateItem(Handle handle, Item** item) {
   {
     mutex_lock l(mu_);
@@ -526,18 +597,16 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   if (opts.cancellation_manager && opts.cancellation_manager->IsCancelled()) {
     return done(errors::Cancelled(""));
   }
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  Status s = frame->SetArgs(args);
+  Item* item = nullptr;
+  Status s = GetOrCreateItem(handle, &item);
   if (!s.ok()) {
-    delete frame;
     return done(s);
   }
-  Item* item = nullptr;
-  s = GetOrCreateItem(handle, &item);
+  FunctionCallFrame* frame = item->NewCallFrame(GetFunctionBody(handle));
+  s = frame->SetArgs(args);
   if (!s.ok()) {
-    delete frame;
+    item->ReleaseCallFrame(frame);
+    item->Unref();
     return done(s);
   }
   DCHECK(opts.runner != nullptr);
@@ -550,23 +619,30 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   exec_args.stats_collector = opts.stats_collector;
   exec_args.call_frame = frame;
   exec_args.cancellation_manager = opts.cancellation_manager;
-  exec_args.runner = *opts.runner;
-  // TODO(zhifengc): we can avoid creating rendez here if we know
-  // there is no send/recv nodes in the graph.
-  auto* rendez = new IntraProcessRendezvous(device_mgr_);
+  if (item->run_inline) {
+    exec_args.runner = [](std::function<void()> fn) { fn(); };
+  } else {
+    exec_args.runner = *opts.runner;
+  }
+  IntraProcessRendezvous* rendez = nullptr;
+  if (item->needs_rendezvous) {
+    rendez = new IntraProcessRendezvous(device_mgr_);
+  }
   exec_args.rendezvous = rendez;
   item->exec->RunAsync(
       // Executor args
       exec_args,
       // Done callback.
       [item, frame, rets, rendez, done](const Status& status) {
-        item->Unref();
-        rendez->Unref();
+        if (rendez != nullptr) {
+          rendez->Unref();
+        }
         Status s = status;
         if (s.ok()) {
-          s = frame->GetRetvals(rets);
+          s = frame->ConsumeRetvals(rets);
         }
-        delete frame;
+        item->ReleaseCallFrame(frame);
+        item->Unref();
         done(s);
       });
 }
@@ -270,6 +270,37 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesN) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({16, 32, 48, 64}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, CheapFunctionRunsInline) {
+  Init({test::function::Swap()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_ASSERT_OK(lib_->Instantiate("Swap", {{"T", DT_FLOAT}}, &handle));
+  int call_count = 0;
+  std::function<void(std::function<void()>)> runner =
+      [&call_count](std::function<void()> fn) {
+        ++call_count;
+        FunctionTestSchedClosure(fn);
+      };
+  FunctionLibraryRuntime::Options opts;
+  opts.runner = &runner;
+  // Later calls reuse the call frames of the earlier ones.
+  for (int i = 0; i < 3; ++i) {
+    auto x = test::AsTensor<float>({1.0f * i});
+    auto y = test::AsTensor<float>({2.0f * i});
+    std::vector<Tensor> out;
+    bool called = false;
+    lib_->Run(opts, handle, {x, y}, &out, [&called](const Status& s) {
+      TF_EXPECT_OK(s);
+      called = true;
+    });
+    // The call is done on return.
+    ASSERT_TRUE(called);
+    ASSERT_EQ(2, out.size());
+    test::ExpectTensorEqual<float>(y, out[0]);
+    test::ExpectTensorEqual<float>(x, out[1]);
+  }
+  EXPECT_EQ(0, call_count);
+}
+
 // Adds a function call to 'scope.
 // TODO(phawkins): replace with C++ API for calling functions, when that exists.
 Output Call(Scope* scope, const string& op_name, const string& fn_name,
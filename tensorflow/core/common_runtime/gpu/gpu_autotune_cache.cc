@@ -0,0 +1,145 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_autotune_cache.h"
+
+#include <stdlib.h>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Each line of the file holds one entry, as "<key>\t<result>". Keys are
+// "<fingerprint>|<group>|<params>".
+const char kFieldSeparator = '\t';
+const char kKeySeparator = '|';
+
+}  // namespace
+
+constexpr const char* GpuAutotuneCache::kPathEnvVar;
+
+GpuAutotuneCache* GpuAutotuneCache::Global() {
+  static GpuAutotuneCache* cache = [] {
+    const char* path = getenv(kPathEnvVar);
+    return new GpuAutotuneCache(Env::Default(), path == nullptr ? "" : path);
+  }();
+  return cache;
+}
+
+GpuAutotuneCache::GpuAutotuneCache(Env* env, const string& path)
+    : env_(env), path_(path) {
+  if (path_.empty()) return;
+  std::map<string, string> entries;
+  Status s = ReadFile(&entries);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring the autotune cache at " << path_ << ": " << s;
+    return;
+  }
+  VLOG(1) << "Loaded " << entries.size() << " autotune results from "
+          << path_;
+  mutex_lock l(mu_);
+  entries_.swap(entries);
+}
+
+void GpuAutotuneCache::SetDeviceFingerprint(int device_id,
+                                            const string& fingerprint) {
+  // The separators would make keys ambiguous.
+  string clean = fingerprint;
+  for (char& c : clean) {
+    if (c == kFieldSeparator || c == kKeySeparator || c == '\n') c = ' ';
+  }
+  mutex_lock l(mu_);
+  fingerprints_[device_id] = clean;
+}
+
+bool GpuAutotuneCache::MakeKey(int device_id, StringPiece group,
+                               StringPiece params, string* key) {
+  auto it = fingerprints_.find(device_id);
+  if (it == fingerprints_.end()) return false;
+  *key = strings::StrCat(it->second, string(1, kKeySeparator), group,
+                         string(1, kKeySeparator), params);
+  return true;
+}
+
+bool GpuAutotuneCache::Lookup(int device_id, StringPiece group,
+                              StringPiece params, string* result) {
+  mutex_lock l(mu_);
+  string key;
+  if (!MakeKey(device_id, group, params, &key)) return false;
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *result = it->second;
+  return true;
+}
+
+void GpuAutotuneCache::Insert(int device_id, StringPiece group,
+                              StringPiece params, const string& result) {
+  mutex_lock l(mu_);
+  string key;
+  if (!MakeKey(device_id, group, params, &key)) return;
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second == result) return;
+  entries_[key] = result;
+  if (path_.empty()) return;
+  Status s = WriteFile();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write the autotune cache to " << path_ << ": "
+                 << s;
+  }
+}
+
+Status GpuAutotuneCache::ReadFile(std::map<string, string>* entries) {
+  if (!env_->FileExists(path_).ok()) return Status::OK();
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, path_, &contents));
+  for (StringPiece line : str_util::Split(contents, '\n')) {
+    if (line.empty()) continue;
+    const size_t pos = line.rfind(kFieldSeparator);
+    if (pos == StringPiece::npos) {
+      return errors::DataLoss("Malformed autotune cache entry: ", line);
+    }
+    entries->emplace(line.substr(0, pos).ToString(),
+                     line.substr(pos + 1).ToString());
+  }
+  return Status::OK();
+}
+
+Status GpuAutotuneCache::WriteFile() {
+  // Keep the results that other processes wrote since this one read the
+  // file. The results of this process win for the keys in both.
+  std::map<string, string> entries = entries_;
+  Status s = ReadFile(&entries);
+  if (!s.ok()) {
+    LOG(WARNING) << "Overwriting the autotune cache at " << path_ << ": "
+                 << s;
+  }
+  string contents;
+  for (const auto& entry : entries) {
+    strings::StrAppend(&contents, entry.first, string(1, kFieldSeparator),
+                       entry.second, "\n");
+  }
+  const string tmp_path = strings::StrCat(path_, ".tmp.", random::New64());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, tmp_path, contents));
+  return env_->RenameFile(tmp_path, path_);
+}
+
+}  // namespace tensorflow
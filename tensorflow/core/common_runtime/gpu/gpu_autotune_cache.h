@@ -0,0 +1,96 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_AUTOTUNE_CACHE_H_
+#define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_AUTOTUNE_CACHE_H_
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A store of autotuning results (e.g. the convolution algorithms picked by
+// cuDNN or MIOpen autotuning) that outlives the process.
+//
+// Results are keyed by the fingerprint of the device they were measured on,
+// which names the device model and its driver and runtime versions, so
+// that a result is only reused on an identical device and software stack.
+// The kernels store and look up results by device ordinal; the GPU device
+// registers the fingerprint of each ordinal when it is initialized.
+//
+// If a path is given, the results are read from it on construction and
+// the whole file is rewritten, through a temporary file and a rename, each
+// time a new result is inserted. Results are only inserted once autotuning
+// for a configuration has settled, so this is rare.
+//
+// This class is thread-safe.
+class GpuAutotuneCache {
+ public:
+  // The environment variable naming the file used by Global(). If it is
+  // not set, Global() keeps results in memory only.
+  static constexpr const char* kPathEnvVar = "TF_AUTOTUNE_CACHE_PATH";
+
+  // Returns the process-wide cache.
+  static GpuAutotuneCache* Global();
+
+  // Creates a cache persisted at "path", or in memory only if "path" is
+  // empty. An unreadable file is logged and treated as empty.
+  GpuAutotuneCache(Env* env, const string& path);
+
+  // Registers the fingerprint of the device with ordinal "device_id".
+  // Lookups and insertions for a device without a fingerprint do nothing.
+  void SetDeviceFingerprint(int device_id, const string& fingerprint);
+
+  // Looks up the result of autotuning group "group" (e.g. "Conv") for the
+  // configuration "params" on device "device_id". Returns true and sets
+  // "*result" if there is one.
+  bool Lookup(int device_id, StringPiece group, StringPiece params,
+              string* result);
+
+  // Records "result" as the result of autotuning group "group" for
+  // "params" on device "device_id", and persists it.
+  void Insert(int device_id, StringPiece group, StringPiece params,
+              const string& result);
+
+ private:
+  bool MakeKey(int device_id, StringPiece group, StringPiece params,
+               string* key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Merges the entries of the file into "entries", keeping the existing
+  // values for keys present in both.
+  Status ReadFile(std::map<string, string>* entries);
+  Status WriteFile() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const string path_;
+
+  mutex mu_;
+  std::unordered_map<int, string> fingerprints_ GUARDED_BY(mu_);
+  std::map<string, string> entries_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuAutotuneCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_GPU_GPU_AUTOTUNE_CACHE_H_
@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_autotune_cache.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string CachePath(const string& name) {
+  string path = io::JoinPath(testing::TmpDir(), name);
+  Env::Default()->DeleteFile(path).IgnoreError();
+  return path;
+}
+
+TEST(GpuAutotuneCacheTest, InMemory) {
+  GpuAutotuneCache cache(Env::Default(), "");
+  string result;
+  // Nothing is stored for devices without a fingerprint.
+  cache.Insert(0, "Conv", "1, 2", "3,4,0");
+  EXPECT_FALSE(cache.Lookup(0, "Conv", "1, 2", &result));
+
+  cache.SetDeviceFingerprint(0, "gpu_a/1.0");
+  cache.SetDeviceFingerprint(1, "gpu_a/1.0");
+  cache.SetDeviceFingerprint(2, "gpu_b/1.0");
+  cache.Insert(0, "Conv", "1, 2", "3,4,0");
+  ASSERT_TRUE(cache.Lookup(0, "Conv", "1, 2", &result));
+  EXPECT_EQ("3,4,0", result);
+  // Devices with the same fingerprint share results.
+  ASSERT_TRUE(cache.Lookup(1, "Conv", "1, 2", &result));
+  EXPECT_EQ("3,4,0", result);
+  EXPECT_FALSE(cache.Lookup(2, "Conv", "1, 2", &result));
+  EXPECT_FALSE(cache.Lookup(0, "ConvBwdData", "1, 2", &result));
+  EXPECT_FALSE(cache.Lookup(0, "Conv", "1, 3", &result));
+}
+
+TEST(GpuAutotuneCacheTest, PersistsAcrossInstances) {
+  const string path = CachePath("persists");
+  {
+    GpuAutotuneCache cache(Env::Default(), path);
+    cache.SetDeviceFingerprint(0, "gpu_a/1.0");
+    cache.Insert(0, "Conv", "1, 2", "3,4,0");
+    cache.Insert(0, "ConvBwdFilter", "1, 2", "5,6,1024");
+  }
+  GpuAutotuneCache cache(Env::Default(), path);
+  // The device ordinal may differ in the new process.
+  cache.SetDeviceFingerprint(3, "gpu_a/1.0");
+  string result;
+  ASSERT_TRUE(cache.Lookup(3, "Conv", "1, 2", &result));
+  EXPECT_EQ("3,4,0", result);
+  ASSERT_TRUE(cache.Lookup(3, "ConvBwdFilter", "1, 2", &result));
+  EXPECT_EQ("5,6,1024", result);
+}
+
+TEST(GpuAutotuneCacheTest, MergesResultsOfOtherInstances) {
+  const string path = CachePath("merges");
+  GpuAutotuneCache first(Env::Default(), path);
+  GpuAutotuneCache second(Env::Default(), path);
+  first.SetDeviceFingerprint(0, "gpu_a/1.0");
+  second.SetDeviceFingerprint(0, "gpu_a/1.0");
+  first.Insert(0, "Conv", "1, 2", "3,4,0");
+  second.Insert(0, "Conv", "5, 6", "7,8,0");
+
+  GpuAutotuneCache cache(Env::Default(), path);
+  cache.SetDeviceFingerprint(0, "gpu_a/1.0");
+  string result;
+  ASSERT_TRUE(cache.Lookup(0, "Conv", "1, 2", &result));
+  EXPECT_EQ("3,4,0", result);
+  ASSERT_TRUE(cache.Lookup(0, "Conv", "5, 6", &result));
+  EXPECT_EQ("7,8,0", result);
+}
+
+TEST(GpuAutotuneCacheTest, IgnoresMalformedFile) {
+  const string path = CachePath("malformed");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "no separator\n"));
+  GpuAutotuneCache cache(Env::Default(), path);
+  cache.SetDeviceFingerprint(0, "gpu_a/1.0");
+  string result;
+  EXPECT_FALSE(cache.Lookup(0, "Conv", "1, 2", &result));
+  cache.Insert(0, "Conv", "1, 2", "3,4,0");
+  ASSERT_TRUE(cache.Lookup(0, "Conv", "1, 2", &result));
+  EXPECT_EQ("3,4,0", result);
+}
+
+}  // namespace
+}  // namespace tensorflow
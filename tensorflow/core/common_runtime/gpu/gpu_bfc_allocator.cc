@@ -20,6 +20,27 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+bool Oversubscribes(const GPUOptions& gpu_options) {
+  return gpu_options.managed_memory_oversubscription() > 0;
+}
+
+size_t OversubscribedMemory(size_t total_memory,
+                            const GPUOptions& gpu_options) {
+  if (!Oversubscribes(gpu_options)) return total_memory;
+  return total_memory +
+         static_cast<size_t>(total_memory *
+                             gpu_options.managed_memory_oversubscription());
+}
+
+mutex* managed_regions_mu = new mutex;
+// Maps the end of each managed memory region to its start.
+std::map<const void*, const void*>* managed_regions GUARDED_BY(
+    managed_regions_mu) = new std::map<const void*, const void*>;
+
+}  // namespace
+
 GPUBFCAllocator::GPUBFCAllocator(int device_id, size_t total_memory)
     : GPUBFCAllocator(device_id, total_memory, GPUOptions()) {}
 
@@ -27,8 +48,55 @@ GPUBFCAllocator::GPUBFCAllocator(int device_id, size_t total_memory,
                                  const GPUOptions& gpu_options)
     : BFCAllocator(
           new GPUMemAllocator(
-              GPUMachineManager()->ExecutorForDevice(device_id).ValueOrDie()),
-          total_memory, gpu_options.allow_growth(),
+              GPUMachineManager()->ExecutorForDevice(device_id).ValueOrDie(),
+              Oversubscribes(gpu_options) ? total_memory : 0),
+          OversubscribedMemory(total_memory, gpu_options),
+          // Without growth, the first region would span the whole limit and
+          // so be all managed memory.
+          gpu_options.allow_growth() || Oversubscribes(gpu_options),
           strings::StrCat("GPU_", device_id, "_bfc")) {}
 
+void* GPUMemAllocator::Alloc(size_t alignment, size_t num_bytes) {
+  void* ptr = nullptr;
+  if (num_bytes == 0) return ptr;
+  if (device_memory_limit_ == 0 ||
+      device_bytes_ + num_bytes <= device_memory_limit_) {
+    ptr = stream_exec_->AllocateArray<char>(num_bytes).opaque();
+    if (ptr != nullptr) {
+      device_bytes_ += num_bytes;
+      return ptr;
+    }
+  }
+  if (device_memory_limit_ > 0) {
+    ptr = stream_exec_->UnifiedMemoryAllocate(num_bytes);
+    if (ptr != nullptr) {
+      VLOG(1) << "Oversubscribing GPU memory with "
+              << strings::HumanReadableNumBytes(num_bytes)
+              << " of managed memory at " << ptr;
+      mutex_lock l(*managed_regions_mu);
+      (*managed_regions)[static_cast<char*>(ptr) + num_bytes] = ptr;
+    }
+  }
+  return ptr;
+}
+
+void GPUMemAllocator::Free(void* ptr, size_t num_bytes) {
+  if (ptr == nullptr) return;
+  bool managed = false;
+  if (device_memory_limit_ > 0) {
+    mutex_lock l(*managed_regions_mu);
+    managed = managed_regions->erase(static_cast<char*>(ptr) + num_bytes) > 0;
+  }
+  if (!managed) device_bytes_ -= num_bytes;
+  gpu::DeviceMemoryBase gpu_ptr(ptr);
+  stream_exec_->Deallocate(&gpu_ptr);
+}
+
+// static
+bool GPUMemAllocator::InManagedMemory(const void* ptr) {
+  mutex_lock l(*managed_regions_mu);
+  auto it = managed_regions->upper_bound(ptr);
+  return it != managed_regions->end() && it->second <= ptr;
+}
+
 }  // namespace tensorflow
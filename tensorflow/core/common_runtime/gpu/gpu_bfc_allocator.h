@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_BFC_ALLOCATOR_H_
 
 #include <memory>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -34,6 +36,10 @@ namespace tensorflow {
 
 // A GPU memory allocator that implements a 'best-fit with coalescing'
 // algorithm.
+//
+// If gpu_options.managed_memory_oversubscription() is positive, the
+// allocator's limit is raised by that fraction of 'total_memory', and the
+// regions beyond 'total_memory' are backed by managed memory.
 class GPUBFCAllocator : public BFCAllocator {
  public:
   // 'device_id' refers to the StreamExecutor ID of the device within
@@ -51,28 +57,31 @@ class GPUMemAllocator : public SubAllocator {
  public:
   // Note: stream_exec cannot be null.
   explicit GPUMemAllocator(perftools::gputools::StreamExecutor* stream_exec)
-      : stream_exec_(stream_exec) {
+      : GPUMemAllocator(stream_exec, 0) {}
+
+  // Once 'device_memory_limit' bytes of device memory are allocated, or
+  // device memory runs out, further allocations are served from managed
+  // memory. A limit of 0 disables managed memory.
+  GPUMemAllocator(perftools::gputools::StreamExecutor* stream_exec,
+                  size_t device_memory_limit)
+      : stream_exec_(stream_exec), device_memory_limit_(device_memory_limit) {
     CHECK(stream_exec_ != nullptr);
   }
   ~GPUMemAllocator() override {}
 
-  void* Alloc(size_t alignment, size_t num_bytes) override {
-    void* ptr = nullptr;
-    if (num_bytes > 0) {
-      ptr = stream_exec_->AllocateArray<char>(num_bytes).opaque();
-    }
-    return ptr;
-  }
+  void* Alloc(size_t alignment, size_t num_bytes) override;
+  void Free(void* ptr, size_t num_bytes) override;
 
-  void Free(void* ptr, size_t num_bytes) override {
-    if (ptr != nullptr) {
-      gpu::DeviceMemoryBase gpu_ptr(ptr);
-      stream_exec_->Deallocate(&gpu_ptr);
-    }
-  }
+  // Returns true if 'ptr' points into managed memory allocated by any
+  // GPUMemAllocator of the process. Pointers of all devices are distinct
+  // under unified addressing, so the regions are tracked process-wide.
+  static bool InManagedMemory(const void* ptr);
 
  private:
   perftools::gputools::StreamExecutor* stream_exec_;  // not owned, non-null
+  const size_t device_memory_limit_;
+  // Alloc and Free are serialized by the BFCAllocator.
+  size_t device_bytes_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(GPUMemAllocator);
 };
@@ -29,6 +29,8 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_autotune_cache.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
@@ -260,7 +262,26 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   }
 
   executor_ = executor_status.ValueOrDie();
-  em_.reset(new EventMgr(executor_, options.config.gpu_options()));
+  // The bus id of a GPU is its NUMA node plus one.
+  int numa_node = port::kNUMANoAffinity;
+  if (options.config.use_numa_affinity() &&
+      attributes().locality().bus_id() > 0) {
+    numa_node = attributes().locality().bus_id() - 1;
+  }
+  em_.reset(
+      new EventMgr(executor_, options.config.gpu_options(), numa_node));
+
+  // Autotuning results persisted by earlier processes are only reused on a
+  // device of the same model with the same driver and runtime versions.
+  const auto& description = executor_->GetDeviceDescription();
+  GpuAutotuneCache::Global()->SetDeviceFingerprint(
+      gpu_id_, strings::StrCat(description.name(), "/",
+                               description.platform_version(), "/",
+                               description.driver_version(), "/",
+                               description.runtime_version()));
+
+  prefetch_managed_inputs_ =
+      options.config.gpu_options().managed_memory_oversubscription() > 0;
 
   if (max_streams_ < 1) {
     return errors::InvalidArgument("Invalid value for max_streams.");
@@ -324,6 +345,7 @@ Status BaseGPUDevice::FillContextMap(const Graph* graph,
   const int64 before = Env::Default()->NowMicros();
   gpu_stream_util::AssignStreamsOpts opts;
   opts.max_streams = static_cast<int32>(num_streams);
+  opts.dependency_aware = true;
   std::unordered_map<int, int> node_to_stream_id;
   TF_RETURN_IF_ERROR(
       gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
@@ -428,6 +450,7 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
     }
   }
   gpu::rocm::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (prefetch_managed_inputs_) PrefetchManagedInputs(context, stream);
   op_kernel->Compute(context);
   if (context->status().ok()) {
     if (sync_every_op_) {
@@ -440,6 +463,27 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
   }
 }
 
+void BaseGPUDevice::PrefetchManagedInputs(OpKernelContext* context,
+                                          gpu::Stream* stream) {
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i)) continue;
+    const void* base;
+    size_t len;
+    if (IsRefType(context->input_dtype(i))) {
+      Tensor tensor = context->mutable_input(i, false);
+      base = DMAHelper::base(&tensor);
+      len = tensor.TotalBytes();
+    } else {
+      const Tensor& tensor = context->input(i);
+      base = DMAHelper::base(&tensor);
+      len = tensor.TotalBytes();
+    }
+    if (len == 0 || !GPUMemAllocator::InManagedMemory(base)) continue;
+    stream->ThenMemPrefetch(
+        gpu::DeviceMemoryBase(const_cast<void*>(base), len), len);
+  }
+}
+
 void BaseGPUDevice::ConsumeListOfAccessedTensors(
     DeviceContext* device_context, const TensorReferenceVector& tensor_refs) {
   GPUDeviceContext* gpu_device_context = device_contexts_[0];
@@ -473,6 +517,18 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   // following TraceMe constructor is simply a conditional test of
   // false value. Measurements show that its overhead is negligible.
   port::Tracing::TraceMe activity(op_kernel->name(), op_kernel->type_string());
+  if (streams_.size() > 1) {
+    // As in ComputeHelper(), wait for the inputs produced on other streams.
+    for (int i = 0; i < context->num_inputs(); ++i) {
+      const GPUDeviceContext* idc =
+          static_cast<GPUDeviceContext*>(context->input_device_context(i));
+      OP_REQUIRES_ASYNC(context, idc != nullptr,
+                        errors::Internal("Input device context ", i,
+                                         " was not set properly."),
+                        done);
+      if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
+    }
+  }
   gpu::rocm::ScopedActivateExecutorContext scoped_activation{stream->parent()};
   op_kernel->ComputeAsync(context, done);
 }
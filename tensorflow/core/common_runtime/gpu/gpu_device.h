@@ -112,11 +112,17 @@ class BaseGPUDevice : public LocalDevice {
   const bool sync_every_op_ = false;
   const int32 max_streams_;
   std::unique_ptr<EventMgr> em_;
+  // Set if the allocator may back tensors with managed memory.
+  bool prefetch_managed_inputs_ = false;
 
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
   void ComputeHelper(OpKernel* op_kernel, OpKernelContext* context);
+
+  // Prefetches the inputs of "context" that are in managed memory to this
+  // device on "stream", ahead of the kernel that reads them.
+  void PrefetchManagedInputs(OpKernelContext* context, gpu::Stream* stream);
 };
 
 class BaseGPUDeviceFactory : public DeviceFactory {
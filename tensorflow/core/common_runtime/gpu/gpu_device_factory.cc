@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <algorithm>
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/process_state.h"
@@ -30,7 +31,11 @@ class GPUDevice : public BaseGPUDevice {
             Allocator* cpu_allocator)
       : BaseGPUDevice(options, name, memory_limit, locality, gpu_id,
                       physical_device_desc, gpu_allocator, cpu_allocator,
-                      false /* sync every op */, 1 /* max_streams */) {
+                      false /* sync every op */,
+                      std::max(1, options.config.gpu_options()
+                                      .num_compute_streams()) /* max_streams */),
+        // The bus of a GPU is its NUMA node plus one.
+        numa_node_(std::max(0, locality.bus_id() - 1)) {
     if (options.config.has_gpu_options()) {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
@@ -41,7 +46,7 @@ class GPUDevice : public BaseGPUDevice {
     if (attr.on_host()) {
       if (attr.gpu_compatible() || force_gpu_compatible_) {
         ProcessState* ps = ProcessState::singleton();
-        return ps->GetROCMHostAllocator(0);
+        return ps->GetROCMHostAllocator(numa_node_);
       } else {
         return cpu_allocator_;
       }
@@ -52,6 +57,7 @@ class GPUDevice : public BaseGPUDevice {
 
  private:
   bool force_gpu_compatible_ = false;
+  const int numa_node_;
 };
 
 class GPUDeviceFactory : public BaseGPUDeviceFactory {
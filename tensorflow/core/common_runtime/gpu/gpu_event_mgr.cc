@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
@@ -22,7 +25,18 @@ namespace gpu = ::perftools::gputools;
 
 namespace tensorflow {
 
-EventMgr::EventMgr(gpu::StreamExecutor* se, const GPUOptions& gpu_options)
+namespace {
+
+ThreadOptions EventMgrThreadOptions(int numa_node) {
+  ThreadOptions thread_options;
+  thread_options.numa_node = numa_node;
+  return thread_options;
+}
+
+}  // namespace
+
+EventMgr::EventMgr(gpu::StreamExecutor* se, const GPUOptions& gpu_options,
+                   int numa_node)
     : exec_(se),
       deferred_bytes_threshold_(gpu_options.deferred_deletion_bytes()
                                     ? gpu_options.deferred_deletion_bytes()
@@ -34,16 +48,27 @@ EventMgr::EventMgr(gpu::StreamExecutor* se, const GPUOptions& gpu_options)
           gpu_options.polling_inactive_delay_msecs()
               ? gpu_options.polling_inactive_delay_msecs()
               : 1),
+      use_host_callbacks_(gpu_options.use_host_callbacks_for_events()),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
+      num_pending_callbacks_(0),
       // threadpool_ has 1 thread for the polling loop, and one to execute
       // event callback functions. Maybe we should have more?
-      threadpool_(Env::Default(), "GPU_Event_Manager", 2) {
+      threadpool_(Env::Default(), EventMgrThreadOptions(numa_node),
+                  "GPU_Event_Manager", 2) {
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
+  if (use_host_callbacks_) {
+    // The callbacks refer to this object, so wait until they have all run.
+    EnqueueHostCallbacks();
+    mutex_lock l(mu_);
+    while (num_pending_callbacks_ > 0) {
+      events_pending_.wait(l);
+    }
+  }
   StopPollingLoop();
 
   // Events are owned by this object.
@@ -74,18 +99,29 @@ EventMgr::~EventMgr() {
     if (ue->func != nullptr) threadpool_.Schedule(ue->func);
     used_events_.pop_front();
   }
+  // Normally drained by CallbackLoop() before it stops.
+  FreeMemory(completed_callbacks_);
 }
 
 void EventMgr::StartPollingLoop() {
   CHECK(polling_stopped_ == nullptr);
   stop_polling_.reset(new Notification);
   polling_stopped_.reset(new Notification);
-  threadpool_.Schedule([this]() { PollLoop(); });
+  if (use_host_callbacks_) {
+    threadpool_.Schedule([this]() { CallbackLoop(); });
+  } else {
+    threadpool_.Schedule([this]() { PollLoop(); });
+  }
 }
 
 void EventMgr::StopPollingLoop() {
   if (stop_polling_) {
     stop_polling_->Notify();
+    {
+      // Wakes up a loop waiting for events.
+      mutex_lock l(mu_);
+      events_pending_.notify_all();
+    }
     polling_stopped_->WaitForNotification();
     stop_polling_.reset(nullptr);
     polling_stopped_.reset(nullptr);
@@ -94,22 +130,25 @@ void EventMgr::StopPollingLoop() {
 
 void EventMgr::ThenDeleteTensors(perftools::gputools::Stream* stream,
                                  const TensorReferenceVector& tensors) {
-  mutex_lock l(mu_);
-  // TODO(jeff): We currently keep one accumulated_tensors_ object.
-  // If we start to use multiple streams heavily, we might want to keep
-  // separate vectors/byte counters per stream
-  if (!accumulated_tensors_->empty() && stream != accumulated_stream_) {
-    FlushAccumulatedTensors();
-  }
-  accumulated_stream_ = stream;
-  for (const auto& t : tensors) {
-    // accumulated_tensors_ takes over ownership of the reference to "t"
-    accumulated_tensors_->push_back(t);
-    accumulated_tensor_bytes_ += t.TotalBytes();
-  }
-  if (accumulated_tensor_bytes_ >= deferred_bytes_threshold_) {
-    FlushAccumulatedTensors();
+  {
+    mutex_lock l(mu_);
+    // TODO(jeff): We currently keep one accumulated_tensors_ object.
+    // If we start to use multiple streams heavily, we might want to keep
+    // separate vectors/byte counters per stream
+    if (!accumulated_tensors_->empty() && stream != accumulated_stream_) {
+      FlushAccumulatedTensors();
+    }
+    accumulated_stream_ = stream;
+    for (const auto& t : tensors) {
+      // accumulated_tensors_ takes over ownership of the reference to "t"
+      accumulated_tensors_->push_back(t);
+      accumulated_tensor_bytes_ += t.TotalBytes();
+    }
+    if (accumulated_tensor_bytes_ >= deferred_bytes_threshold_) {
+      FlushAccumulatedTensors();
+    }
   }
+  EnqueueHostCallbacks();
 }
 
 void EventMgr::FlushAccumulatedTensors() {
@@ -147,9 +186,66 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::EnqueueHostCallbacks() {
+  std::vector<std::pair<gpu::Stream*, InUse>> to_enqueue;
+  {
+    mutex_lock l(mu_);
+    if (callbacks_to_enqueue_.empty()) return;
+    to_enqueue.swap(callbacks_to_enqueue_);
+  }
+  for (const auto& entry : to_enqueue) {
+    gpu::Stream* stream = entry.first;
+    const InUse& iu = entry.second;
+    // ThenDoHostCallback() enqueues nothing on a stream in an error state,
+    // and does not report whether the enqueue succeeded.  If the stream is
+    // not ok() afterwards, the record is handed over here instead, and
+    // "claimed" makes sure that only one of the two hands it over.
+    auto claimed = std::make_shared<std::atomic<bool>>(false);
+    stream->ThenDoHostCallback([this, iu, claimed]() {
+      if (!claimed->exchange(true)) OnHostCallback(iu);
+    });
+    if (!stream->ok() && !claimed->exchange(true)) {
+      LOG(WARNING) << "Stream is in an error state; releasing the resources "
+                      "waiting on it without a host callback.";
+      OnHostCallback(iu);
+    }
+  }
+}
+
+void EventMgr::OnHostCallback(const InUse& iu) {
+  // This runs on a thread of the GPU driver, which must not be blocked for
+  // long, so the record is freed by CallbackLoop().
+  mutex_lock l(mu_);
+  completed_callbacks_.push_back(iu);
+  --num_pending_callbacks_;
+  events_pending_.notify_all();
+}
+
+void EventMgr::CallbackLoop() {
+  while (true) {
+    ToFreeVector to_free;
+    {
+      mutex_lock l(mu_);
+      while (completed_callbacks_.empty() &&
+             !stop_polling_->HasBeenNotified()) {
+        events_pending_.wait(l);
+      }
+      if (completed_callbacks_.empty()) break;
+      to_free.swap(completed_callbacks_);
+    }
+    FreeMemory(to_free);
+  }
+  polling_stopped_->Notify();
+}
+
 void EventMgr::QueueInUse(gpu::Stream* stream, InUse iu) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
+  if (use_host_callbacks_) {
+    ++num_pending_callbacks_;
+    callbacks_to_enqueue_.emplace_back(stream, iu);
+    return;
+  }
   // Events are created on demand, and repeatedly reused.  There is no
   // limit placed here on the number of allocated Events.
   if (free_events_.empty()) {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_EVENT_MGR_H_
 
 #include <deque>
+#include <utility>
 #include <vector>
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -44,10 +46,21 @@ class GPUOptions;
 // An object to keep track of pending Events in the StreamExecutor streams
 // and associated Tensors that cannot safely be deleted until the associated
 // Events are recorded.
+//
+// If GPUOptions.use_host_callbacks_for_events is set, no Events are
+// polled: a host callback is enqueued on the stream instead, and the
+// callback hands the InUse record to a thread that frees it, which
+// removes the polling delay and the polling thread's CPU use.  The
+// callbacks are enqueued after mu_ is released, and a record whose
+// callback cannot be enqueued because the stream is in an error state
+// is freed right away.
 class EventMgr {
  public:
+  // The threads of the EventMgr are pinned to NUMA node "numa_node" unless
+  // it is port::kNUMANoAffinity.
   EventMgr(perftools::gputools::StreamExecutor* se,
-           const GPUOptions& gpu_options);
+           const GPUOptions& gpu_options,
+           int numa_node = port::kNUMANoAffinity);
 
   ~EventMgr();
 
@@ -75,6 +88,7 @@ class EventMgr {
       QueueBuffer(stream, bufrec);
       PollEvents(false, &to_free);
     }
+    EnqueueHostCallbacks();
     FreeMemory(to_free);
   }
 
@@ -86,6 +100,7 @@ class EventMgr {
       QueueFunc(stream, std::move(func));
       PollEvents(false, &to_free);
     }
+    EnqueueHostCallbacks();
     FreeMemory(to_free);
   }
 
@@ -95,6 +110,7 @@ class EventMgr {
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
   const int32 polling_inactive_delay_msecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
@@ -132,7 +148,9 @@ class EventMgr {
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
-  // records.
+  // records.  If use_host_callbacks_, the record is only set aside for
+  // EnqueueHostCallbacks(), which the caller must call once it has
+  // released mu_.
   void QueueInUse(perftools::gputools::Stream* stream, InUse in_use)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -164,6 +182,19 @@ class EventMgr {
   // straggler Events.
   void PollLoop();
 
+  // Enqueues the host callbacks of the records set aside by QueueInUse().
+  // ThenDoHostCallback() is not called under mu_, since the driver may run
+  // the callback, which takes mu_, before returning.
+  void EnqueueHostCallbacks() LOCKS_EXCLUDED(mu_);
+
+  // Called by the host callback enqueued for "iu" once the preceding work
+  // on its stream has completed, or directly if it could not be enqueued.
+  void OnHostCallback(const InUse& iu) LOCKS_EXCLUDED(mu_);
+
+  // Replaces PollLoop() if use_host_callbacks_: frees the InUse records
+  // whose host callbacks ran.
+  void CallbackLoop();
+
   // Setup/Teardown functions for the polling loop.
   void StartPollingLoop();
   void StopPollingLoop();
@@ -180,6 +211,15 @@ class EventMgr {
   // A FIFO queue of InUse events and associated tensors.
   std::deque<InUse> used_events_ GUARDED_BY(mu_);
 
+  // If use_host_callbacks_, the records waiting for EnqueueHostCallbacks(),
+  // the number of those records and of the enqueued host callbacks that
+  // did not run yet, and the InUse records of the callbacks that did,
+  // waiting to be freed by CallbackLoop().
+  std::vector<std::pair<perftools::gputools::Stream*, InUse>>
+      callbacks_to_enqueue_ GUARDED_BY(mu_);
+  int64 num_pending_callbacks_ GUARDED_BY(mu_);
+  ToFreeVector completed_callbacks_ GUARDED_BY(mu_);
+
   std::unique_ptr<Notification> stop_polling_;
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -47,8 +47,11 @@ class TEST_EventMgrHelper {
 
   void QueueTensors(perftools::gputools::Stream* stream,
                     TensorReferenceVector* tensors) {
-    mutex_lock l(em_->mu_);
-    em_->QueueTensors(stream, tensors);
+    {
+      mutex_lock l(em_->mu_);
+      em_->QueueTensors(stream, tensors);
+    }
+    em_->EnqueueHostCallbacks();
   }
 
   void PollEvents(bool is_dedicated_poller) {
@@ -244,5 +247,66 @@ TEST(EventMgr, NonEmptyShutdown) {
   }
 }
 
+// With host callbacks, tensors are freed and functions run once the
+// preceding work on the stream completes, without polling.
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.set_use_host_callbacks_for_events(true);
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream.get());
+  stream->Init();
+  {
+    EventMgr em(stream_exec, gpu_options);
+    TEST_EventMgrHelper th(&em);
+    th.StartPollingLoop();
+    EXPECT_EQ(0, live_tensor_bytes);
+    TensorReferenceVector v;
+    AddTensorReference(&v, 100 * 1048576);
+    em.ThenDeleteTensors(stream.get(), v);
+    Notification done;
+    em.ThenExecute(stream.get(), [&done]() { done.Notify(); });
+    done.WaitForNotification();
+    // The tensors were queued before the function, on the same stream.
+    EXPECT_EQ(0, live_tensor_bytes);
+    EXPECT_EQ(0, th.queue_size());
+    EXPECT_EQ(0, th.free_size());
+
+    // Pending callbacks are waited for at shutdown.
+    for (int i = 0; i < 5; ++i) {
+      TensorReferenceVector* v = new TensorReferenceVector;
+      AddTensorReference(v, 100 * 1048576);
+      th.QueueTensors(stream.get(), v);
+    }
+  }
+  EXPECT_EQ(0, live_tensor_bytes);
+}
+
+// A host callback cannot be enqueued on a stream in an error state, so
+// what waits on it is released right away instead of never.
+TEST(EventMgr, HostCallbacksOnErrorStream) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.set_use_host_callbacks_for_events(true);
+  // A stream that was never Init()ed is not ok().
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream.get());
+  EXPECT_FALSE(stream->ok());
+  {
+    EventMgr em(stream_exec, gpu_options);
+    TEST_EventMgrHelper th(&em);
+    th.StartPollingLoop();
+    TensorReferenceVector v;
+    AddTensorReference(&v, 100 * 1048576);
+    em.ThenDeleteTensors(stream.get(), v);
+    Notification done;
+    em.ThenExecute(stream.get(), [&done]() { done.Notify(); });
+    done.WaitForNotification();
+    EXPECT_EQ(0, live_tensor_bytes);
+    // Nothing is left pending, so this does not wait forever.
+  }
+  EXPECT_EQ(0, live_tensor_bytes);
+}
+
 }  // namespace
 }  // namespace tensorflow
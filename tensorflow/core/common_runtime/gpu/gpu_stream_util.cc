@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -27,6 +28,105 @@ limitations under the License.
 namespace tensorflow {
 namespace gpu_stream_util {
 
+namespace {
+
+bool AccessesRefs(const Node* n) {
+  for (DataType dt : n->input_types()) {
+    if (IsRefType(dt)) return true;
+  }
+  for (DataType dt : n->output_types()) {
+    if (IsRefType(dt)) return true;
+  }
+  return false;
+}
+
+// Returns the stream of op "n" requested by "opts", or -1.
+int StreamForOpType(const Node* n, const AssignStreamsOpts& opts) {
+  const string& op = n->type_string();
+  if (op == "_Send") return opts.send_stream;
+  if (op == "_Recv") return opts.recv_stream;
+  if (op == "Const") return opts.const_stream;
+  return opts.compute_stream;
+}
+
+void AssignStreamsDependencyAware(
+    const Graph* graph, const std::vector<Node*>& order,
+    const AssignStreamsOpts& opts,
+    std::unordered_map<int, int>* node_to_stream_id) {
+  const int num_streams = opts.max_streams;
+  // The position of each node in "order", or -1 if not visited yet.
+  std::vector<int> position(graph->num_node_ids(), -1);
+  // latest[id * num_streams + s] is the position of the last node on stream
+  // s that node "id" depends on, itself included, or -1. Stream s only
+  // holds work that the node depends on iff this is the position of the
+  // last node assigned to s.
+  std::vector<int> latest(graph->num_node_ids() * num_streams, -1);
+  std::vector<int> last_on_stream(num_streams, -1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    Node* n = order[i];
+    position[n->id()] = i;
+    int* n_latest = &latest[n->id() * num_streams];
+    int control_stream = -1;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      // Skips the back edges of loops.
+      if (position[src->id()] < 0) continue;
+      const int* src_latest = &latest[src->id() * num_streams];
+      for (int s = 0; s < num_streams; ++s) {
+        n_latest[s] = std::max(n_latest[s], src_latest[s]);
+      }
+      if (e->IsControlEdge() && !src->IsSource() && control_stream < 0) {
+        control_stream = (*node_to_stream_id)[src->id()];
+      }
+    }
+    if (!n->IsOp()) {
+      (*node_to_stream_id)[n->id()] = 0;
+      continue;
+    }
+
+    int stream_id = StreamForOpType(n, opts);
+    if (stream_id < 0 && control_stream >= 0) {
+      stream_id = control_stream;
+    }
+    if (stream_id < 0 && AccessesRefs(n)) {
+      stream_id = 0;
+    }
+    // Prefers the stream of a data input, then any other stream holding
+    // only work the node depends on, then an unused stream.
+    for (const Edge* e : n->in_edges()) {
+      if (stream_id >= 0) break;
+      if (e->IsControlEdge() || position[e->src()->id()] < 0) continue;
+      const int s = (*node_to_stream_id)[e->src()->id()];
+      if (n_latest[s] == last_on_stream[s]) stream_id = s;
+    }
+    for (int s = 0; stream_id < 0 && s < num_streams; ++s) {
+      if (last_on_stream[s] >= 0 && n_latest[s] == last_on_stream[s]) {
+        stream_id = s;
+      }
+    }
+    for (int s = 0; stream_id < 0 && s < num_streams; ++s) {
+      if (last_on_stream[s] < 0) stream_id = s;
+    }
+    if (stream_id < 0) {
+      // Every stream holds independent work, so the node cannot avoid
+      // waiting for some of it.
+      stream_id = i % num_streams;
+      for (const Edge* e : n->in_edges()) {
+        if (!e->IsControlEdge() && position[e->src()->id()] >= 0) {
+          stream_id = (*node_to_stream_id)[e->src()->id()];
+          break;
+        }
+      }
+    }
+
+    (*node_to_stream_id)[n->id()] = stream_id;
+    n_latest[stream_id] = i;
+    last_on_stream[stream_id] = i;
+  }
+}
+
+}  // namespace
+
 Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
                      std::unordered_map<int, int>* node_to_stream_id) {
   VLOG(1) << "AssignStreams";
@@ -61,6 +161,11 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
       }
     }
   }
+  if (opts.dependency_aware) {
+    AssignStreamsDependencyAware(graph, order, opts, node_to_stream_id);
+    return Status::OK();
+  }
+
   // We perform stream assignment assuming a large number of
   // stream IDs and then map these down to the required number of streams
   // using simple round-robin.
@@ -32,6 +32,15 @@ struct AssignStreamsOpts {
   int32 recv_stream = -1;
   int32 const_stream = -1;
   int32 compute_stream = -1;
+  // If true, a node is put on a stream only if it depends on all the work
+  // already assigned to that stream, so independent branches of the graph
+  // end up on different streams, as in XLA's GPU stream assignment. Once
+  // every stream has work the node does not depend on, the node reuses
+  // the stream of one of its inputs. Nodes with incoming control edges
+  // share the stream of a control input, since control edges are not
+  // synchronized across streams, and nodes accessing reference-typed
+  // tensors, e.g. variables, are all put on stream 0.
+  bool dependency_aware = false;
 };
 
 // Given the input graph, assigns every node in the graph with a
@@ -143,5 +143,42 @@ TEST_F(GpuStreamUtilTest, StreamOverrides) {
   }
 }
 
+TEST_F(GpuStreamUtilTest, DependencyAware) {
+  auto root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Const(root.WithOpName("a"), 1.0f);
+  Output a1 = ops::Square(root.WithOpName("a1"), a);
+  Output a2 = ops::Square(root.WithOpName("a2"), a1);
+  Output b = ops::Const(root.WithOpName("b"), 2.0f);
+  Output b1 = ops::Square(root.WithOpName("b1"), b);
+  Output b2 = ops::Square(root.WithOpName("b2"), b1);
+  ops::Add(root.WithOpName("c"), a2, b2);
+  ops::Square(root.WithOpName("d").WithControlDependencies({b2.op()}), a);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  std::unordered_map<int, int> node_to_stream_id;
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  opts.dependency_aware = true;
+  TF_ASSERT_OK(gpu_stream_util::AssignStreams(&g, opts, &node_to_stream_id));
+  std::unordered_map<string, int> stream;
+  for (const auto& it : node_to_stream_id) {
+    EXPECT_GE(it.second, 0);
+    EXPECT_LT(it.second, opts.max_streams);
+    stream[g.FindNodeId(it.first)->name()] = it.second;
+  }
+
+  // Each chain stays on one stream, and the two chains are independent.
+  EXPECT_EQ(stream["a"], stream["a1"]);
+  EXPECT_EQ(stream["a"], stream["a2"]);
+  EXPECT_EQ(stream["b"], stream["b1"]);
+  EXPECT_EQ(stream["b"], stream["b2"]);
+  EXPECT_NE(stream["a"], stream["b"]);
+  // The join reuses the stream of one of its inputs.
+  EXPECT_TRUE(stream["c"] == stream["a"] || stream["c"] == stream["b"]);
+  // Control edges are not synchronized across streams.
+  EXPECT_EQ(stream["b2"], stream["d"]);
+}
+
 }  // namespace
 }  // namespace tensorflow
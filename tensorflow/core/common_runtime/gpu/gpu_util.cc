@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -33,9 +37,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -152,7 +158,9 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
   const int64 total_bytes = is_dead ? 0 : tensor.TotalBytes();
   if (total_bytes > 0) {
     port::Tracing::ScopedAnnotation annotation("SetProtoFromGPU");
-    alloc = ProcessState::singleton()->GetROCMHostAllocator(0);
+    // Stages the data in pinned memory local to the GPU.
+    alloc = ProcessState::singleton()->GetROCMHostAllocator(
+        std::max(0, dev->attributes().locality().bus_id() - 1));
     buf = alloc->Allocate<char>(total_bytes);
     if (LogMemory::IsEnabled()) {
       LogMemory::RecordRawAllocation("SetProtoFromGPU",
@@ -186,6 +194,46 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
       });
 }
 
+namespace {
+
+// Returns true if "from" can address the memory of "to" directly, i.e. a
+// copy between them is a peer-to-peer DMA rather than one staged through
+// the host by the driver. The answers are cached since the topology does
+// not change while the process runs.
+bool CanAccessPeer(gpu::StreamExecutor* from, gpu::StreamExecutor* to) {
+  if (from == to) return true;
+  static mutex* mu = new mutex;
+  static auto* peer_access =
+      new std::map<std::pair<gpu::StreamExecutor*, gpu::StreamExecutor*>,
+                   bool>;
+  mutex_lock l(*mu);
+  auto it = peer_access->find({from, to});
+  if (it == peer_access->end()) {
+    it = peer_access->emplace(std::make_pair(from, to),
+                              from->CanEnablePeerAccessTo(to))
+             .first;
+  }
+  return it->second;
+}
+
+// Peer-to-peer copies of at least this many bytes are split in two halves,
+// one pushed by the copy engine of the sender and one pulled by the copy
+// engine of the receiver, so that both engines drive the link. The
+// threshold can be set with TF_GPU_SPLIT_PEER_COPY_BYTES; 0 disables the
+// split.
+int64 MinSplitPeerCopyBytes() {
+  static int64 min_bytes = [] {
+    int64 bytes;
+    Status s = ReadInt64FromEnvVar("TF_GPU_SPLIT_PEER_COPY_BYTES", 8 << 20,
+                                   &bytes);
+    if (!s.ok()) LOG(ERROR) << s;
+    return bytes;
+  }();
+  return min_bytes;
+}
+
+}  // namespace
+
 // static
 void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
                                  DeviceContext* recv_dev_context, Device* src,
@@ -232,9 +280,46 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
     // to make sure the memory is free.
     send_device_to_device_stream->ThenWaitFor(recv_stream);
 
-    VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr;
-    send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
-                                             total_bytes);
+    auto recv_device_to_device_stream =
+        static_cast<const GPUDeviceContext*>(recv_dev_context)
+            ->device_to_device_stream();
+    const int64 min_split_bytes = MinSplitPeerCopyBytes();
+    const bool split = min_split_bytes > 0 &&
+                       total_bytes >= min_split_bytes &&
+                       recv_device_to_device_stream != nullptr &&
+                       recv_device_to_device_stream->parent() !=
+                           send_device_to_device_stream->parent() &&
+                       CanAccessPeer(send_stream->parent(),
+                                     recv_stream->parent()) &&
+                       CanAccessPeer(recv_stream->parent(),
+                                     send_stream->parent());
+
+    VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr
+            << (split ? " split" : "");
+    if (split) {
+      // Keep the halves aligned so that both copies run at full width.
+      const int64 first_bytes = (total_bytes / 2) & ~int64{255};
+      const int64 second_bytes = total_bytes - first_bytes;
+      DeviceMemoryBase first_src(src_ptr, first_bytes);
+      DeviceMemoryBase first_dst(dst_ptr, first_bytes);
+      DeviceMemoryBase second_src(static_cast<char*>(src_ptr) + first_bytes,
+                                  second_bytes);
+      DeviceMemoryBase second_dst(static_cast<char*>(dst_ptr) + first_bytes,
+                                  second_bytes);
+      // The receiver's half needs the same dependencies as the sender's.
+      recv_device_to_device_stream->ThenWaitFor(send_stream);
+      recv_device_to_device_stream->ThenWaitFor(recv_stream);
+      send_device_to_device_stream->ThenMemcpy(&first_dst, first_src,
+                                               first_bytes);
+      recv_device_to_device_stream->ThenMemcpy(&second_dst, second_src,
+                                               second_bytes);
+      // The copy is done, and the input can be released, once the sender's
+      // stream has also seen the receiver's half finish.
+      send_device_to_device_stream->ThenWaitFor(recv_device_to_device_stream);
+    } else {
+      send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
+                                               total_bytes);
+    }
   }
 
   // Use of input may outlive stack scope, so keep a ref.
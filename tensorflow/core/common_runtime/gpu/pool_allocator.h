@@ -23,6 +23,7 @@ limitations under the License.
 #include <atomic>
 #include <map>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
 #include "tensorflow/core/lib/core/bits.h"
@@ -180,9 +181,12 @@ class BasicCPUAllocator : public SubAllocator {
 // purpose of efficient DMA with a GPU.
 class ROCMHostAllocator : public SubAllocator {
  public:
-  // Note: stream_exec cannot be null.
-  explicit ROCMHostAllocator(perftools::gputools::StreamExecutor* stream_exec)
-      : stream_exec_(stream_exec) {
+  // Note: stream_exec cannot be null. Unless numa_node is
+  // port::kNUMANoAffinity, the memory is placed on that NUMA node and then
+  // pinned, falling back to the default placement if it cannot be pinned.
+  explicit ROCMHostAllocator(perftools::gputools::StreamExecutor* stream_exec,
+                             int numa_node = port::kNUMANoAffinity)
+      : stream_exec_(stream_exec), numa_node_(numa_node) {
     CHECK(stream_exec_ != nullptr);
   }
   ~ROCMHostAllocator() override {}
@@ -190,6 +194,17 @@ class ROCMHostAllocator : public SubAllocator {
   void* Alloc(size_t alignment, size_t num_bytes) override {
     void* ptr = nullptr;
     if (num_bytes > 0) {
+      if (numa_node_ != port::kNUMANoAffinity) {
+        ptr = port::NUMAMalloc(numa_node_, num_bytes, alignment);
+        if (ptr != nullptr) {
+          if (stream_exec_->HostMemoryRegister(ptr, num_bytes)) {
+            mutex_lock lock(mu_);
+            numa_allocated_.insert(ptr);
+            return ptr;
+          }
+          port::NUMAFree(ptr, num_bytes);
+        }
+      }
       ptr = stream_exec_->HostMemoryAllocate(num_bytes);
       if (ptr == nullptr) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
@@ -201,12 +216,30 @@ class ROCMHostAllocator : public SubAllocator {
 
   void Free(void* ptr, size_t num_bytes) override {
     if (ptr != nullptr) {
-      stream_exec_->HostMemoryDeallocate(ptr);
+      bool numa_allocated = false;
+      if (numa_node_ != port::kNUMANoAffinity) {
+        mutex_lock lock(mu_);
+        numa_allocated = numa_allocated_.erase(ptr) > 0;
+      }
+      if (numa_allocated) {
+        if (!stream_exec_->HostMemoryUnregister(ptr)) {
+          LOG(WARNING) << "could not unpin host memory at " << ptr;
+        }
+        port::NUMAFree(ptr, num_bytes);
+      } else {
+        stream_exec_->HostMemoryDeallocate(ptr);
+      }
     }
   }
 
  private:
   perftools::gputools::StreamExecutor* stream_exec_;  // not owned, non-null
+  const int numa_node_;
+
+  mutex mu_;
+  // The regions allocated on numa_node_, as opposed to the ones allocated
+  // by stream_exec_.
+  std::unordered_set<void*> numa_allocated_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(ROCMHostAllocator);
 };
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/types.h"
@@ -198,11 +199,14 @@ Allocator* ProcessState::GetROCMHostAllocator(int numa_node) {
   if (!HasGPUDevice() || !FLAGS_brain_mem_reg_rocm_dma) {
     return cpu_allocator();
   }
-  // Although we're temporarily ignoring numa_node, check for legality.
   CHECK_GE(numa_node, 0);
-  // TODO(tucker): actually maintain separate CPUAllocators for
-  // different numa_nodes.  For now, just one.
-  numa_node = 0;
+  // There is one pool of pinned memory per NUMA node, so that transfers to
+  // a GPU can use memory local to the socket the GPU is attached to. On
+  // single-node machines, or if the node is unknown, there is one pool.
+  const int num_numa_nodes = port::NUMANumNodes();
+  if (numa_node >= num_numa_nodes) {
+    numa_node = 0;
+  }
   mutex_lock lock(mu_);
 
   // Find the first valid StreamExecutor to request ROCM host memory
@@ -232,9 +236,22 @@ Allocator* ProcessState::GetROCMHostAllocator(int numa_node) {
       LOG(ERROR) << "GetROCMHostAllocator: " << status.error_message();
     }
     int64 rocm_host_mem_limit = rocm_host_mem_limit_in_mb * (1LL << 20);
-    Allocator* allocator =
-        new BFCAllocator(new ROCMHostAllocator(se), rocm_host_mem_limit,
-                         true /*allow_growth*/, "rocm_host_bfc" /*name*/);
+    const int node = rocm_host_allocators_.size();
+    VisitableAllocator* visitable_allocator;
+    if (num_numa_nodes > 1) {
+      visitable_allocator = new BFCAllocator(
+          new ROCMHostAllocator(se, node), rocm_host_mem_limit,
+          true /*allow_growth*/, strings::StrCat("rocm_host_bfc_numa", node));
+    } else {
+      visitable_allocator =
+          new BFCAllocator(new ROCMHostAllocator(se), rocm_host_mem_limit,
+                           true /*allow_growth*/, "rocm_host_bfc" /*name*/);
+    }
+    for (const auto& v : rocm_host_visitors_) {
+      visitable_allocator->AddAllocVisitor(v);
+    }
+    rocm_host_visitable_allocators_.push_back(visitable_allocator);
+    Allocator* allocator = visitable_allocator;
 
     if (LogMemory::IsEnabled()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -252,8 +269,8 @@ Allocator* ProcessState::GetROCMHostAllocator(int numa_node) {
           &mem_desc_map_, rocm_host_allocators_.back(), md, &mu_));
     }
   }
-  if (FLAGS_brain_gpu_record_mem_types) return rocm_al_[0];
-  return rocm_host_allocators_[0];
+  if (FLAGS_brain_gpu_record_mem_types) return rocm_al_[numa_node];
+  return rocm_host_allocators_[numa_node];
 }
 
 void ProcessState::AddGPUAllocVisitor(int bus_id, AllocVisitor visitor) {
@@ -274,4 +291,12 @@ void ProcessState::AddGPUAllocVisitor(int bus_id, AllocVisitor visitor) {
   gpu_visitors_[bus_id].push_back(visitor);
 }
 
+void ProcessState::AddROCMHostAllocVisitor(AllocVisitor visitor) {
+  mutex_lock lock(mu_);
+  for (VisitableAllocator* allocator : rocm_host_visitable_allocators_) {
+    allocator->AddAllocVisitor(visitor);
+  }
+  rocm_host_visitors_.push_back(visitor);
+}
+
 }  // namespace tensorflow
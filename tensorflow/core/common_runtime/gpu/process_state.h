@@ -92,6 +92,10 @@ class ProcessState {
   virtual Allocator* GetGPUAllocator(const GPUOptions& options, int gpu_id,
                                      size_t total_bytes);
 
+  // Returns the allocator of pinned host memory for transfers to and from
+  // the GPUs attached to the given numa_node. Each NUMA node has its own
+  // pool, placed on that node. Nodes beyond those of the machine share the
+  // pool of node 0.
   virtual Allocator* GetROCMHostAllocator(int numa_node);
 
   // Registers a function to be called once on every new Region
@@ -107,6 +111,13 @@ class ProcessState {
   typedef std::function<void(void*, size_t)> AllocVisitor;
   virtual void AddGPUAllocVisitor(int bus_id, AllocVisitor visitor);
 
+  // Registers a function to be called once on every Region of pinned
+  // host memory allocated by the allocators returned by
+  // GetROCMHostAllocator(), for every NUMA node, including the Regions
+  // allocated before the call. Regions are never freed, so there is no
+  // matching free visitor.
+  virtual void AddROCMHostAllocVisitor(AllocVisitor visitor);
+
   typedef std::unordered_map<const void*, MemDesc> MDMap;
 
  protected:
@@ -121,6 +132,10 @@ class ProcessState {
   std::vector<VisitableAllocator*> gpu_allocators_ GUARDED_BY(mu_);
   std::vector<std::vector<AllocVisitor>> gpu_visitors_ GUARDED_BY(mu_);
   std::vector<Allocator*> rocm_host_allocators_ GUARDED_BY(mu_);
+  // The allocators of rocm_host_allocators_, before any wrapping.
+  std::vector<VisitableAllocator*> rocm_host_visitable_allocators_
+      GUARDED_BY(mu_);
+  std::vector<AllocVisitor> rocm_host_visitors_ GUARDED_BY(mu_);
 
   virtual ~ProcessState();
 
@@ -97,7 +97,10 @@ class SimpleRendezvous : public Rendezvous {
 
 }  // namespace
 
-GraphRunner::GraphRunner(Env* env) : cpu_device_(GetCPUDevice(env)) {}
+GraphRunner::GraphRunner(Env* env) : GraphRunner(env, nullptr) {}
+
+GraphRunner::GraphRunner(Env* env, thread::ThreadPool* pool)
+    : cpu_device_(GetCPUDevice(env)), pool_(pool) {}
 
 GraphRunner::~GraphRunner() {}
 
@@ -141,9 +144,15 @@ Status GraphRunner::Run(Graph* graph, FunctionLibraryRuntime* function_library,
   // Create the local executor and the Rendezvous for fetching back the
   // constants.
 
-  // Run operators on the local thread. We should not need concurrency here; we
-  // should not be running expensive operators.
-  auto runner = [](Executor::Args::Closure c) { c(); };
+  // Run operators on the local thread unless there is a pool. We should not
+  // need concurrency here, except for graphs with many independent nodes.
+  Executor::Args::Runner runner = [](Executor::Args::Closure c) { c(); };
+  if (pool_ != nullptr) {
+    thread::ThreadPool* pool = pool_;
+    runner = [pool](Executor::Args::Closure c) {
+      pool->Schedule(std::move(c));
+    };
+  }
 
   // Take ownership and pass to NewLocalExecutor
   Graph* g = graph_to_run.release();
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -42,6 +43,10 @@ class GraphRunner {
  public:
   // REQUIRES: `env` is not nullptr.
   GraphRunner(Env* env);
+
+  // Same as above, but independent nodes run in parallel on `pool`, which
+  // must outlive the calls to Run.
+  GraphRunner(Env* env, thread::ThreadPool* pool);
   ~GraphRunner();
 
   // Function semantics for `inputs`, `output_names` and `outputs`
@@ -60,6 +65,7 @@ class GraphRunner {
 
  private:
   std::unique_ptr<Device> cpu_device_;
+  thread::ThreadPool* const pool_;  // Not owned, may be nullptr.
 };
 
 }  // namespace tensorflow
@@ -16,12 +16,18 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/common_runtime/local_device.h"
+
+#include <algorithm>
+#include <map>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_feature_guard.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -31,17 +37,27 @@ namespace tensorflow {
 bool LocalDevice::use_global_threadpool_ = true;
 
 struct LocalDevice::EigenThreadPoolInfo {
-  explicit EigenThreadPoolInfo(const SessionOptions& options) {
+  // The threads are pinned to NUMA node "numa_node" unless it is
+  // port::kNUMANoAffinity.
+  EigenThreadPoolInfo(const SessionOptions& options, int numa_node) {
     int32 intra_op_parallelism_threads =
         options.config.intra_op_parallelism_threads();
     if (intra_op_parallelism_threads == 0) {
       intra_op_parallelism_threads = port::NumSchedulableCPUs();
+      if (numa_node != port::kNUMANoAffinity) {
+        // Each node's pool only gets the node's share of the CPUs.
+        intra_op_parallelism_threads = std::max(
+            1, intra_op_parallelism_threads / port::NUMANumNodes());
+      }
     }
     VLOG(1) << "Local device intra op parallelism threads: "
-            << intra_op_parallelism_threads;
+            << intra_op_parallelism_threads << " numa node: " << numa_node;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
     eigen_worker_threads_.num_threads = intra_op_parallelism_threads;
-    eigen_worker_threads_.workers = new thread::ThreadPool(
-        options.env, "Eigen", intra_op_parallelism_threads);
+    eigen_worker_threads_.workers =
+        new thread::ThreadPool(options.env, thread_options, "Eigen",
+                               intra_op_parallelism_threads);
     eigen_threadpool_wrapper_.reset(
         new EigenThreadPoolWrapper(eigen_worker_threads_.workers));
     eigen_device_.reset(new Eigen::ThreadPoolDevice(
@@ -59,25 +75,65 @@ struct LocalDevice::EigenThreadPoolInfo {
   std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
 };
 
+// The global pool of EigenThreadPoolInfo seen by a device that parallelizes
+// each op over at most "num_threads" of its threads.
+struct LocalDevice::CappedThreadPoolInfo {
+  CappedThreadPoolInfo(const EigenThreadPoolInfo& info, int num_threads) {
+    worker_threads_.num_threads = num_threads;
+    worker_threads_.workers = info.eigen_worker_threads_.workers;
+    eigen_device_.reset(new Eigen::ThreadPoolDevice(
+        info.eigen_threadpool_wrapper_.get(), num_threads));
+  }
+
+  DeviceBase::CpuWorkerThreads worker_threads_;
+  std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
+};
+
 LocalDevice::LocalDevice(const SessionOptions& options,
                          const DeviceAttributes& attributes)
     : Device(options.env, attributes), owned_tp_info_(nullptr) {
   // If we're running on the CPU, log warnings if we're not compiled using the
   // best flags for performance.
   port::WarnAboutUnusedCPUFeatures();
+  // With NUMA affinity, the device computes on the node given by its
+  // locality, whose bus id is the node plus one.
+  int numa_node = port::kNUMANoAffinity;
+  if (options.config.use_numa_affinity() &&
+      attributes.locality().bus_id() > 0) {
+    numa_node = attributes.locality().bus_id() - 1;
+  }
   LocalDevice::EigenThreadPoolInfo* tp_info;
   if (use_global_threadpool_) {
-    // All ThreadPoolDevices in the process will use this single fixed
-    // sized threadpool for numerical computations.
-    static LocalDevice::EigenThreadPoolInfo* global_tp_info =
-        new LocalDevice::EigenThreadPoolInfo(options);
-    tp_info = global_tp_info;
+    // All ThreadPoolDevices in the process on the same NUMA node will use
+    // this single fixed sized threadpool for numerical computations.
+    static mutex mu(LINKER_INITIALIZED);
+    static std::map<int, LocalDevice::EigenThreadPoolInfo*>* global_tp_info =
+        new std::map<int, LocalDevice::EigenThreadPoolInfo*>;
+    mutex_lock l(mu);
+    LocalDevice::EigenThreadPoolInfo*& info = (*global_tp_info)[numa_node];
+    if (info == nullptr) {
+      info = new LocalDevice::EigenThreadPoolInfo(options, numa_node);
+    }
+    tp_info = info;
+    // The pool was sized by the first session; a session asking for fewer
+    // threads only shards its ops over that many of them.
+    const int32 num_threads = options.config.intra_op_parallelism_threads();
+    if (num_threads > 0 &&
+        num_threads < tp_info->eigen_worker_threads_.num_threads) {
+      capped_tp_info_.reset(new CappedThreadPoolInfo(*tp_info, num_threads));
+    }
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(options));
+    owned_tp_info_.reset(
+        new LocalDevice::EigenThreadPoolInfo(options, numa_node));
     tp_info = owned_tp_info_.get();
   }
+  if (capped_tp_info_ != nullptr) {
+    set_tensorflow_cpu_worker_threads(&capped_tp_info_->worker_threads_);
+    set_eigen_cpu_device(capped_tp_info_->eigen_device_.get());
+    return;
+  }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
   set_eigen_cpu_device(tp_info->eigen_device_.get());
 }
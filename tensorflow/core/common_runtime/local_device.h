@@ -47,6 +47,10 @@ class LocalDevice : public Device {
   struct EigenThreadPoolInfo;
   std::unique_ptr<EigenThreadPoolInfo> owned_tp_info_;
 
+  // Set if this device uses fewer threads of the global pool than it has.
+  struct CappedThreadPoolInfo;
+  std::unique_ptr<CappedThreadPoolInfo> capped_tp_info_;
+
   friend class test::Benchmark;
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalDevice);
@@ -91,6 +91,12 @@ class PendingCounts {
 
   ~PendingCounts() { delete[] bytes_; }
 
+  // Resets all counts to those of "other", which must have the same layout.
+  void CopyFrom(const PendingCounts& other) {
+    DCHECK_EQ(num_bytes_, other.num_bytes_);
+    memcpy(bytes_, other.bytes_, num_bytes_);
+  }
+
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
       LargeCounts* c = Large(h);
@@ -590,11 +590,16 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   std::vector<bool> attempted_tensor_as_shape_conversion(node->num_inputs());
   std::vector<ShapeHandle> input_tensors_as_shapes;
 
-  // Run the shape inference function, and return if there was an error.
+  // Run the shape inference function, and return if there was an error. The
+  // outputs may come from an earlier run on the same op and input shapes, in
+  // this or another graph.
   c->set_input_tensors(input_tensors);
   c->set_input_tensors_as_shapes(input_tensors_as_shapes);
   if (op_reg_data->shape_inference_fn) {
-    TF_RETURN_IF_ERROR(c->Run(op_reg_data->shape_inference_fn));
+    bool cached;
+    TF_RETURN_IF_ERROR(
+        c->RunWithCache(op_reg_data->shape_inference_fn, &cached));
+    if (cached) return Status::OK();
   } else {
     TF_RETURN_IF_ERROR(c->Run(shape_inference::UnknownShape));
   }
@@ -0,0 +1,151 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns the cache key of "ndef" on "device". The attrs are fingerprinted
+// in name order, as the serialization order of a map is unspecified.
+string KernelKey(const Device* device, int graph_def_version,
+                 const NodeDef& ndef) {
+  string buf = strings::StrCat(graph_def_version, ";", ndef.name(), ";",
+                               ndef.op(), ";", ndef.device());
+  for (const string& input : ndef.input()) {
+    strings::StrAppend(&buf, ";", input);
+  }
+  std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+  attrs.reserve(ndef.attr_size());
+  for (const auto& attr : ndef.attr()) {
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end(),
+            [](const std::pair<StringPiece, const AttrValue*>& a,
+               const std::pair<StringPiece, const AttrValue*>& b) {
+              return a.first < b.first;
+            });
+  string attr_buf;
+  for (const auto& attr : attrs) {
+    attr.second->SerializeToString(&attr_buf);
+    strings::StrAppend(&buf, ";", attr.first, "=", attr_buf.size(), ":",
+                       attr_buf);
+  }
+  const Fprint128 fp = Fingerprint128(buf);
+  return strings::StrCat(device->name(), ";", fp.low64, ";", fp.high64);
+}
+
+}  // namespace
+
+SharedKernelCache::~SharedKernelCache() {
+  for (auto& entry : kernels_) {
+    delete entry.second.kernel;
+  }
+}
+
+/* static */
+SharedKernelCache* SharedKernelCache::Global() {
+  static SharedKernelCache* cache = new SharedKernelCache;
+  return cache;
+}
+
+/* static */
+bool SharedKernelCache::CanShare(const Device* device, const NodeDef& ndef) {
+  if (device->device_type() != DEVICE_CPU) {
+    return false;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(ndef.op(), &op_def).ok() ||
+      op_def->is_stateful()) {
+    return false;
+  }
+  for (const auto& attr : ndef.attr()) {
+    if (attr.second.value_case() == AttrValue::kFunc ||
+        attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status SharedKernelCache::FindOrCreate(const Device* device,
+                                       int graph_def_version,
+                                       const NodeDef& ndef, OpKernel** kernel,
+                                       CreateKernelFn create_fn) {
+  const string key = KernelKey(device, graph_def_version, ndef);
+  {
+    mutex_lock l(mu_);
+    auto it = kernels_.find(key);
+    if (it != kernels_.end()) {
+      ++it->second.num_refs;
+      *kernel = it->second.kernel;
+      return Status::OK();
+    }
+  }
+  // Creates the kernel outside the lock, as constructing a kernel may be
+  // expensive (e.g. a large Const).
+  OpKernel* new_kernel = nullptr;
+  Status s = create_fn(&new_kernel);
+  if (!s.ok()) {
+    return s;
+  }
+  mutex_lock l(mu_);
+  Entry& entry = kernels_[key];
+  if (entry.kernel == nullptr) {
+    entry.kernel = new_kernel;
+    keys_[new_kernel] = key;
+  } else {
+    // Another session created the same kernel meanwhile.
+    delete new_kernel;
+  }
+  ++entry.num_refs;
+  *kernel = entry.kernel;
+  return Status::OK();
+}
+
+bool SharedKernelCache::Release(OpKernel* kernel) {
+  mutex_lock l(mu_);
+  auto key = keys_.find(kernel);
+  if (key == keys_.end()) {
+    return false;
+  }
+  auto it = kernels_.find(key->second);
+  DCHECK(it != kernels_.end());
+  if (--it->second.num_refs == 0) {
+    delete it->second.kernel;
+    kernels_.erase(it);
+    keys_.erase(key);
+  }
+  return true;
+}
+
+int64 SharedKernelCache::size() const {
+  mutex_lock l(mu_);
+  return kernels_.size();
+}
+
+}  // end namespace tensorflow
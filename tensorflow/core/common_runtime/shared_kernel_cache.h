@@ -0,0 +1,92 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
+#define TENSORFLOW_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
+
+#include <functional>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Device;
+
+// SharedKernelCache lets the executors of different sessions share the
+// kernels of identical stateless nodes, e.g. the Const nodes of a model
+// loaded in several sessions, instead of each session holding its own copy
+// of the kernel and of the tensors it owns.
+//
+// Kernels are keyed by device name and by a fingerprint of the graph def
+// version and the whole NodeDef, including the node name, so a shared
+// kernel is indistinguishable from the one the session would have created.
+// Each kernel is reference-counted by the executors using it and deleted
+// with the last of them.
+class SharedKernelCache {
+ public:
+  SharedKernelCache() {}
+  ~SharedKernelCache();
+
+  // The cache shared by all the sessions of the process.
+  static SharedKernelCache* Global();
+
+  // Returns true if the kernel of "ndef" on "device" may be shared. Only
+  // CPU kernels are shared, as kernels of other devices may refer to the
+  // device of the session that created them. The op must be registered in
+  // the global op registry (not a function) and be stateless, and "ndef"
+  // must not have function valued attrs, whose kernels are bound to the
+  // function library of the session.
+  static bool CanShare(const Device* device, const NodeDef& ndef);
+
+  // If a kernel for "ndef" on "device" is in the cache, returns it in
+  // "*kernel". Otherwise, creates it by calling create_fn() and caches it.
+  // Each successful call takes a reference on "*kernel", which must be
+  // returned with Release(). CanShare(device, ndef) must be true.
+  typedef std::function<Status(OpKernel**)> CreateKernelFn;
+  Status FindOrCreate(const Device* device, int graph_def_version,
+                      const NodeDef& ndef, OpKernel** kernel,
+                      CreateKernelFn create_fn);
+
+  // Drops a reference on a kernel returned by FindOrCreate(), deleting it
+  // with the last reference. Returns false, and does nothing, if "kernel"
+  // is not owned by the cache.
+  bool Release(OpKernel* kernel);
+
+  // The number of kernels in the cache.
+  int64 size() const;
+
+ private:
+  struct Entry {
+    OpKernel* kernel = nullptr;
+    int num_refs = 0;
+  };
+
+  mutable mutex mu_;
+  std::unordered_map<string, Entry> kernels_ GUARDED_BY(mu_);
+  // The key of each cached kernel, to find it in Release().
+  std::unordered_map<const OpKernel*, string> keys_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedKernelCache);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
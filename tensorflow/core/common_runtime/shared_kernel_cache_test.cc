@@ -0,0 +1,154 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+REGISTER_OP("SharedKernelCacheTestOp").Attr("value: int").Output("y: int32");
+REGISTER_OP("SharedKernelCacheStatefulTestOp")
+    .Output("y: int32")
+    .SetIsStateful();
+REGISTER_OP("SharedKernelCacheFuncTestOp").Attr("f: func").Output("y: int32");
+
+class TestOp : public OpKernel {
+ public:
+  explicit TestOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {}
+};
+
+REGISTER_KERNEL_BUILDER(Name("SharedKernelCacheTestOp").Device(DEVICE_CPU),
+                        TestOp);
+
+class SharedKernelCacheTest : public ::testing::Test {
+ protected:
+  SharedKernelCacheTest() {
+    device_.reset(
+        DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0"));
+  }
+
+  NodeDef MakeNode(const string& name, int value) {
+    NodeDef def;
+    TF_CHECK_OK(NodeDefBuilder(name, "SharedKernelCacheTestOp")
+                    .Attr("value", value)
+                    .Finalize(&def));
+    return def;
+  }
+
+  // Finds or creates the kernel of "ndef", counting the kernels created.
+  OpKernel* FindOrCreate(SharedKernelCache* cache, const NodeDef& ndef) {
+    OpKernel* kernel = nullptr;
+    TF_CHECK_OK(cache->FindOrCreate(
+        device_.get(), TF_GRAPH_DEF_VERSION, ndef, &kernel,
+        [this, &ndef](OpKernel** kernel) {
+          ++num_created_;
+          Status s;
+          *kernel = CreateOpKernel(DEVICE_CPU, device_.get(),
+                                   device_->GetAllocator(AllocatorAttributes()),
+                                   ndef, TF_GRAPH_DEF_VERSION, &s)
+                        .release();
+          return s;
+        }));
+    return kernel;
+  }
+
+  std::unique_ptr<Device> device_;
+  int num_created_ = 0;
+};
+
+TEST_F(SharedKernelCacheTest, CanShare) {
+  EXPECT_TRUE(SharedKernelCache::CanShare(device_.get(), MakeNode("a", 1)));
+
+  NodeDef def;
+  TF_CHECK_OK(NodeDefBuilder("b", "SharedKernelCacheStatefulTestOp")
+                  .Finalize(&def));
+  EXPECT_FALSE(SharedKernelCache::CanShare(device_.get(), def));
+
+  NameAttrList f;
+  f.set_name("SomeFunction");
+  TF_CHECK_OK(
+      NodeDefBuilder("c", "SharedKernelCacheFuncTestOp").Attr("f", f).Finalize(
+          &def));
+  EXPECT_FALSE(SharedKernelCache::CanShare(device_.get(), def));
+
+  // Ops that are not in the registry are functions.
+  def.set_op("SomeFunction");
+  def.clear_attr();
+  EXPECT_FALSE(SharedKernelCache::CanShare(device_.get(), def));
+}
+
+TEST_F(SharedKernelCacheTest, SharesIdenticalNodes) {
+  SharedKernelCache cache;
+  OpKernel* a1 = FindOrCreate(&cache, MakeNode("a", 1));
+  OpKernel* a2 = FindOrCreate(&cache, MakeNode("a", 1));
+  EXPECT_EQ(a1, a2);
+  EXPECT_EQ(1, num_created_);
+  EXPECT_EQ(1, cache.size());
+
+  // Nodes differing by their name or their attrs get their own kernel.
+  OpKernel* b = FindOrCreate(&cache, MakeNode("b", 1));
+  OpKernel* a3 = FindOrCreate(&cache, MakeNode("a", 3));
+  EXPECT_NE(a1, b);
+  EXPECT_NE(a1, a3);
+  EXPECT_EQ("b", b->name());
+  EXPECT_EQ(3, num_created_);
+  EXPECT_EQ(3, cache.size());
+
+  EXPECT_TRUE(cache.Release(b));
+  EXPECT_TRUE(cache.Release(a3));
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST_F(SharedKernelCacheTest, DeletesWithLastRelease) {
+  SharedKernelCache cache;
+  const NodeDef ndef = MakeNode("a", 1);
+  OpKernel* a1 = FindOrCreate(&cache, ndef);
+  OpKernel* a2 = FindOrCreate(&cache, ndef);
+  EXPECT_TRUE(cache.Release(a1));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_TRUE(cache.Release(a2));
+  EXPECT_EQ(0, cache.size());
+
+  // The kernel is created again once released.
+  OpKernel* a3 = FindOrCreate(&cache, ndef);
+  EXPECT_EQ(2, num_created_);
+  EXPECT_TRUE(cache.Release(a3));
+
+  // Kernels that do not come from the cache are left to their owner.
+  Status s;
+  std::unique_ptr<OpKernel> other =
+      CreateOpKernel(DEVICE_CPU, device_.get(),
+                     device_->GetAllocator(AllocatorAttributes()), ndef,
+                     TF_GRAPH_DEF_VERSION, &s);
+  TF_ASSERT_OK(s);
+  EXPECT_FALSE(cache.Release(other.get()));
+}
+
+}  // namespace
+}  // namespace tensorflow
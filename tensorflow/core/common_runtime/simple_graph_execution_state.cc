@@ -356,7 +356,8 @@ Status SimpleGraphExecutionState::OptimizeGraph(
     opts.allow_internal_ops = true;
     optimized_graph->reset(new Graph(OpRegistry::Global()));
     TF_RETURN_IF_ERROR(
-        ConvertGraphDefToGraph(opts, new_graph, optimized_graph->get()));
+        ConvertGraphDefToGraph(opts, std::move(new_graph),
+                               optimized_graph->get()));
     // The graph conversion sets the requested device names but not the assigned
     // device names. However, since at this point the graph is placed TF expects
     // an assigned device name for every node. Therefore we copy the requested
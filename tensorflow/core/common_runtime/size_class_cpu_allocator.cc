@@ -0,0 +1,255 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/size_class_cpu_allocator.h"
+
+#include <algorithm>
+// This is only used for std::this_thread::get_id()
+#include <thread>  // NOLINT
+
+#include "tensorflow/core/framework/allocator_registry.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Every block starts with a header, in the kHeaderBytes preceding the
+// pointer returned by AllocateRaw.
+struct BlockHeader {
+  // The pointer to pass to port::AlignedFree.
+  void* base;
+  // Bytes usable after the returned pointer.
+  size_t usable_bytes;
+  // The size class, or kUnpooled.
+  int size_class;
+};
+
+constexpr size_t kHeaderBytes = 64;
+static_assert(sizeof(BlockHeader) <= kHeaderBytes, "BlockHeader too large");
+static_assert(kHeaderBytes % Allocator::kAllocatorAlignment == 0,
+              "Pooled blocks must satisfy the default alignment");
+
+constexpr int kUnpooled = -1;
+constexpr int64 kDefaultMaxCachedBytes = 1LL << 30;
+constexpr size_t kHugePageBytes = 2 << 20;
+// Thread caches hold up to twice this many bytes per size class.
+constexpr size_t kTransferBytes = 1 << 20;
+
+BlockHeader* HeaderOf(void* ptr) {
+  return reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) -
+                                        kHeaderBytes);
+}
+
+void AtomicMax(std::atomic<int64>* max, int64 value) {
+  int64 current = max->load(std::memory_order_relaxed);
+  while (current < value &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+constexpr int SizeClassCPUAllocator::kMinClassShift;
+constexpr int SizeClassCPUAllocator::kMaxClassShift;
+constexpr int SizeClassCPUAllocator::kNumClasses;
+
+SizeClassCPUAllocator::SizeClassCPUAllocator()
+    : SizeClassCPUAllocator(kDefaultMaxCachedBytes,
+                            std::max(port::NumSchedulableCPUs(), 1),
+                            true /* use_huge_pages */) {}
+
+SizeClassCPUAllocator::SizeClassCPUAllocator(int64 max_cached_bytes,
+                                             int num_thread_caches,
+                                             bool use_huge_pages)
+    : max_cached_bytes_(max_cached_bytes),
+      use_huge_pages_(use_huge_pages),
+      cached_bytes_(0),
+      num_allocs_(0),
+      bytes_in_use_(0),
+      max_bytes_in_use_(0),
+      max_alloc_size_(0) {
+  CHECK_GT(num_thread_caches, 0);
+  for (int i = 0; i < num_thread_caches; ++i) {
+    thread_caches_.emplace_back(new FreeLists);
+  }
+}
+
+SizeClassCPUAllocator::~SizeClassCPUAllocator() {
+  auto free_all = [](FreeLists* lists) {
+    mutex_lock l(lists->mu);
+    for (auto& blocks : lists->blocks) {
+      for (void* ptr : blocks) FreeBlock(ptr);
+      blocks.clear();
+    }
+  };
+  for (auto& cache : thread_caches_) free_all(cache.get());
+  free_all(&central_);
+}
+
+// static
+int SizeClassCPUAllocator::SizeClass(size_t num_bytes) {
+  if (num_bytes > ClassBytes(kNumClasses - 1)) return kUnpooled;
+  return std::max(Log2Ceiling64(num_bytes), kMinClassShift) - kMinClassShift;
+}
+
+// static
+size_t SizeClassCPUAllocator::TransferBlocks(int size_class) {
+  return std::max<size_t>(kTransferBytes / ClassBytes(size_class), 1);
+}
+
+void* SizeClassCPUAllocator::NewBlock(size_t alignment, size_t usable_bytes,
+                                      int size_class) {
+  const size_t offset = std::max(alignment, kHeaderBytes);
+  const size_t total_bytes = offset + usable_bytes;
+  const bool huge = use_huge_pages_ && total_bytes >= kHugePageBytes;
+  // Huge pages are only used for the fully covered, aligned ranges.
+  void* base = port::AlignedMalloc(
+      total_bytes, static_cast<int>(huge ? std::max(offset, kHugePageBytes)
+                                         : offset));
+  if (base == nullptr) return nullptr;
+  if (huge) port::AdviseHugePages(base, total_bytes);
+  void* ptr = static_cast<char*>(base) + offset;
+  BlockHeader* header = HeaderOf(ptr);
+  header->base = base;
+  header->usable_bytes = usable_bytes;
+  header->size_class = size_class;
+  return ptr;
+}
+
+// static
+void SizeClassCPUAllocator::FreeBlock(void* ptr) {
+  port::AlignedFree(HeaderOf(ptr)->base);
+}
+
+SizeClassCPUAllocator::FreeLists* SizeClassCPUAllocator::ThreadCache() {
+  const size_t id_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return thread_caches_[id_hash % thread_caches_.size()].get();
+}
+
+void* SizeClassCPUAllocator::PopCached(int size_class) {
+  FreeLists* cache = ThreadCache();
+  mutex_lock l(cache->mu);
+  std::vector<void*>& blocks = cache->blocks[size_class];
+  if (blocks.empty()) {
+    // Refill the thread cache from the central list.
+    mutex_lock central_lock(central_.mu);
+    std::vector<void*>& central = central_.blocks[size_class];
+    const size_t n = std::min(central.size(), TransferBlocks(size_class));
+    blocks.insert(blocks.end(), central.end() - n, central.end());
+    central.resize(central.size() - n);
+  }
+  if (blocks.empty()) return nullptr;
+  void* ptr = blocks.back();
+  blocks.pop_back();
+  cached_bytes_ -= ClassBytes(size_class);
+  return ptr;
+}
+
+void SizeClassCPUAllocator::PushCached(void* ptr, int size_class) {
+  const int64 bytes = ClassBytes(size_class);
+  if (cached_bytes_.fetch_add(bytes) + bytes > max_cached_bytes_) {
+    cached_bytes_ -= bytes;
+    FreeBlock(ptr);
+    return;
+  }
+  FreeLists* cache = ThreadCache();
+  mutex_lock l(cache->mu);
+  std::vector<void*>& blocks = cache->blocks[size_class];
+  blocks.push_back(ptr);
+  const size_t n = TransferBlocks(size_class);
+  if (blocks.size() > 2 * n) {
+    // Make the oldest blocks available to the other threads.
+    mutex_lock central_lock(central_.mu);
+    std::vector<void*>& central = central_.blocks[size_class];
+    central.insert(central.end(), blocks.begin(), blocks.begin() + n);
+    blocks.erase(blocks.begin(), blocks.begin() + n);
+  }
+}
+
+void* SizeClassCPUAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const int size_class =
+      alignment <= kHeaderBytes ? SizeClass(num_bytes) : kUnpooled;
+  void* ptr;
+  size_t usable_bytes;
+  if (size_class == kUnpooled) {
+    usable_bytes = num_bytes;
+    ptr = NewBlock(alignment, usable_bytes, kUnpooled);
+  } else {
+    usable_bytes = ClassBytes(size_class);
+    ptr = PopCached(size_class);
+    if (ptr == nullptr) {
+      ptr = NewBlock(kHeaderBytes, usable_bytes, size_class);
+    }
+  }
+  if (ptr == nullptr) return nullptr;
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  const int64 in_use =
+      bytes_in_use_.fetch_add(usable_bytes, std::memory_order_relaxed) +
+      usable_bytes;
+  AtomicMax(&max_bytes_in_use_, in_use);
+  AtomicMax(&max_alloc_size_, usable_bytes);
+  return ptr;
+}
+
+void SizeClassCPUAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const BlockHeader* header = HeaderOf(ptr);
+  bytes_in_use_.fetch_sub(header->usable_bytes, std::memory_order_relaxed);
+  if (header->size_class == kUnpooled) {
+    FreeBlock(ptr);
+  } else {
+    PushCached(ptr, header->size_class);
+  }
+}
+
+void SizeClassCPUAllocator::GetStats(AllocatorStats* stats) {
+  stats->Clear();
+  stats->num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats->bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  stats->max_bytes_in_use = max_bytes_in_use_.load(std::memory_order_relaxed);
+  stats->max_alloc_size = max_alloc_size_.load(std::memory_order_relaxed);
+}
+
+size_t SizeClassCPUAllocator::AllocatedSizeSlow(void* ptr) {
+  return HeaderOf(ptr)->usable_bytes;
+}
+
+namespace {
+
+// Takes over from the default CPU allocator (priority 100) only when asked
+// to, and stays below the MKL allocator (priority 200).
+int SizeClassCPUAllocatorPriority() {
+  bool use_size_classes = false;
+  Status status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_SIZE_CLASSES",
+                                     false, &use_size_classes);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  return use_size_classes ? 150 : 50;
+}
+
+}  // namespace
+
+REGISTER_MEM_ALLOCATOR("SizeClassCPUAllocator",
+                       SizeClassCPUAllocatorPriority(), SizeClassCPUAllocator);
+
+}  // namespace tensorflow
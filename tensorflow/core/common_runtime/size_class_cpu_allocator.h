@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_CPU_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_CPU_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A CPU allocator that keeps freed blocks for reuse instead of returning them
+// to malloc, which saves both the malloc calls and the page faults on the
+// fresh memory of the many mid-sized tensors of a training step.
+//
+// Requests are rounded up to power-of-2 size classes, from 256 bytes to
+// 16 MiB; larger or over-aligned requests are allocated directly. Freed
+// blocks go to one of several caches chosen by thread, so that concurrent
+// threads rarely contend on the same lock, and caches exchange batches of
+// blocks with a central free list so that blocks freed on one thread can
+// be reused on another. Blocks of at least 2 MiB are backed by transparent
+// huge pages where the platform supports them. The statistics are kept with
+// atomic counters.
+//
+// Registered through AllocatorRegistry, it replaces the default CPU
+// allocator when the TF_CPU_ALLOCATOR_USE_SIZE_CLASSES environment variable
+// is set to true.
+class SizeClassCPUAllocator : public Allocator {
+ public:
+  // The default configuration: caches up to 1 GiB of free blocks, one thread
+  // cache per schedulable CPU, with huge pages.
+  SizeClassCPUAllocator();
+
+  // "max_cached_bytes" bounds the total size of the cached free blocks;
+  // blocks freed beyond it are returned to the system. "num_thread_caches"
+  // must be positive.
+  SizeClassCPUAllocator(int64 max_cached_bytes, int num_thread_caches,
+                        bool use_huge_pages);
+
+  ~SizeClassCPUAllocator() override;
+
+  string Name() override { return "size_class_cpu"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  void GetStats(AllocatorStats* stats) override;
+
+  // Returns the usable size of the block, i.e. its size class.
+  size_t AllocatedSizeSlow(void* ptr) override;
+
+  // Total size of the free blocks currently cached.
+  int64 cached_bytes() const { return cached_bytes_; }
+
+ private:
+  static constexpr int kMinClassShift = 8;
+  static constexpr int kMaxClassShift = 24;
+  static constexpr int kNumClasses = kMaxClassShift - kMinClassShift + 1;
+
+  // Free blocks, one list per size class.
+  struct FreeLists {
+    mutex mu;
+    std::vector<void*> blocks[kNumClasses] GUARDED_BY(mu);
+  };
+
+  // Returns the size class of a request, or -1 if it is not pooled.
+  static int SizeClass(size_t num_bytes);
+  static size_t ClassBytes(int size_class) {
+    return size_t{1} << (size_class + kMinClassShift);
+  }
+  // The number of blocks moved at once between a thread cache and the
+  // central lists.
+  static size_t TransferBlocks(int size_class);
+
+  // Allocates a new block with "usable_bytes" after the pointer returned.
+  void* NewBlock(size_t alignment, size_t usable_bytes, int size_class);
+  static void FreeBlock(void* ptr);
+
+  // Returns a cached block of the class or nullptr.
+  void* PopCached(int size_class);
+  // Caches the block, or frees it if the cache is full.
+  void PushCached(void* ptr, int size_class);
+
+  FreeLists* ThreadCache();
+
+  const int64 max_cached_bytes_;
+  const bool use_huge_pages_;
+
+  std::vector<std::unique_ptr<FreeLists>> thread_caches_;
+  // Locked after a thread cache, never before.
+  FreeLists central_;
+  std::atomic<int64> cached_bytes_;
+
+  std::atomic<int64> num_allocs_;
+  std::atomic<int64> bytes_in_use_;
+  std::atomic<int64> max_bytes_in_use_;
+  std::atomic<int64> max_alloc_size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SizeClassCPUAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_CPU_ALLOCATOR_H_
@@ -0,0 +1,143 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/size_class_cpu_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+void CheckStats(Allocator* a, int64 num_allocs, int64 bytes_in_use,
+                int64 max_bytes_in_use) {
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(num_allocs, stats.num_allocs);
+  EXPECT_EQ(bytes_in_use, stats.bytes_in_use);
+  EXPECT_EQ(max_bytes_in_use, stats.max_bytes_in_use);
+}
+
+TEST(SizeClassCPUAllocatorTest, RoundsUpToSizeClasses) {
+  SizeClassCPUAllocator a(1 << 20, 1, false);
+  void* p1 = a.AllocateRaw(32, 1);
+  void* p2 = a.AllocateRaw(32, 1000);
+  EXPECT_EQ(256, a.AllocatedSizeSlow(p1));
+  EXPECT_EQ(1024, a.AllocatedSizeSlow(p2));
+  CheckStats(&a, 2, 1280, 1280);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  CheckStats(&a, 2, 0, 1280);
+  EXPECT_EQ(1280, a.cached_bytes());
+}
+
+TEST(SizeClassCPUAllocatorTest, FreedBlockIsReused) {
+  SizeClassCPUAllocator a(1 << 20, 4, false);
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 3000);
+  a.DeallocateRaw(p1);
+  // Same size class, same thread.
+  void* p2 = a.AllocateRaw(Allocator::kAllocatorAlignment, 4000);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(0, a.cached_bytes());
+  a.DeallocateRaw(p2);
+}
+
+TEST(SizeClassCPUAllocatorTest, CacheIsBounded) {
+  SizeClassCPUAllocator a(4096, 1, false);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(a.AllocateRaw(32, 2048));
+  }
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  EXPECT_EQ(4096, a.cached_bytes());
+}
+
+TEST(SizeClassCPUAllocatorTest, LargeAndOverAlignedRequests) {
+  SizeClassCPUAllocator a(1 << 20, 1, true);
+  void* large = a.AllocateRaw(32, (16 << 20) + 1);
+  ASSERT_NE(nullptr, large);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large) % 32);
+  EXPECT_EQ((16 << 20) + 1, a.AllocatedSizeSlow(large));
+  void* aligned = a.AllocateRaw(4096, 100);
+  ASSERT_NE(nullptr, aligned);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % 4096);
+  // Touch the whole range.
+  memset(large, 1, (16 << 20) + 1);
+  memset(aligned, 1, 100);
+  a.DeallocateRaw(large);
+  a.DeallocateRaw(aligned);
+  // Unpooled blocks are not cached.
+  EXPECT_EQ(0, a.cached_bytes());
+  CheckStats(&a, 2, 0, (16 << 20) + 101);
+}
+
+TEST(SizeClassCPUAllocatorTest, BlocksMoveBetweenThreads) {
+  SizeClassCPUAllocator a(64 << 20, 16, false);
+  const int kNumSteps = 200;
+  mutex mu;
+  std::vector<void*> handoff;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    // Each closure frees the blocks of the previous one, mostly on a
+    // different thread than the one that allocated them.
+    for (int step = 0; step < kNumSteps; ++step) {
+      pool.Schedule([&a, &mu, &handoff, step]() {
+        random::PhiloxRandom philox(step, 17);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> mine;
+        for (int i = 0; i < 50; ++i) {
+          const size_t bytes = 1 + rand.Uniform(1 << 18);
+          char* p = static_cast<char*>(a.AllocateRaw(32, bytes));
+          ASSERT_NE(nullptr, p);
+          p[0] = p[bytes - 1] = 1;
+          mine.push_back(p);
+        }
+        std::vector<void*> theirs;
+        {
+          mutex_lock l(mu);
+          theirs.swap(handoff);
+          handoff.swap(mine);
+        }
+        for (void* p : theirs) a.DeallocateRaw(p);
+      });
+    }
+    // The pool waits for the closures when it goes out of scope.
+  }
+  for (void* p : handoff) a.DeallocateRaw(p);
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(kNumSteps * 50, stats.num_allocs);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+static void BM_Allocation(int iters) {
+  SizeClassCPUAllocator a;
+  std::vector<int> sizes = {256, 4096, 16384, 524288, 512, 1048576};
+  int size_index = 0;
+  while (--iters > 0) {
+    int bytes = sizes[size_index++ % sizes.size()];
+    void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, bytes);
+    a.DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_Allocation);
+
+}  // namespace
+}  // namespace tensorflow
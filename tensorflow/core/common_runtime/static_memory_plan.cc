@@ -0,0 +1,333 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  const size_t a = Allocator::kAllocatorAlignment;
+  return (num_bytes + a - 1) / a * a;
+}
+
+}  // namespace
+
+size_t ComputeStaticMemoryPlan(const std::vector<BufferLifetime>& buffers,
+                               std::vector<size_t>* offsets) {
+  const int n = buffers.size();
+  std::vector<int> order(n);
+  for (int i = 0; i < n; ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&buffers](int a, int b) {
+    if (buffers[a].size != buffers[b].size) {
+      return buffers[a].size > buffers[b].size;
+    }
+    return buffers[a].start < buffers[b].start;
+  });
+
+  offsets->assign(n, 0);
+  size_t slab_size = 0;
+  std::vector<int> placed;
+  std::vector<std::pair<size_t, size_t>> busy;  // (offset, end) in memory.
+  for (int b : order) {
+    const BufferLifetime& buffer = buffers[b];
+    busy.clear();
+    for (int p : placed) {
+      if (buffers[p].start < buffer.end && buffer.start < buffers[p].end) {
+        busy.emplace_back((*offsets)[p], (*offsets)[p] + buffers[p].size);
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t cursor = 0;
+    for (const auto& range : busy) {
+      if (range.first > cursor) {
+        const size_t gap = range.first - cursor;
+        if (gap >= buffer.size && gap < best_gap) {
+          best_offset = cursor;
+          best_gap = gap;
+        }
+      }
+      cursor = std::max(cursor, range.second);
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      // No gap fits, so place the buffer after everything it overlaps with.
+      best_offset = cursor;
+    }
+    (*offsets)[b] = best_offset;
+    slab_size = std::max(slab_size, best_offset + buffer.size);
+    placed.push_back(b);
+  }
+  return slab_size;
+}
+
+PlannedAllocator::PlannedAllocator(Allocator* allocator, void* slab,
+                                   size_t slab_size,
+                                   const std::vector<BufferLifetime>& buffers,
+                                   const std::vector<size_t>& offsets)
+    : allocator_(allocator),
+      slab_(static_cast<char*>(slab)),
+      slab_size_(slab_size),
+      num_planned_allocations_(0) {
+  CHECK_EQ(buffers.size(), offsets.size());
+  const int n = buffers.size();
+  slots_.resize(n);
+  state_.reset(new std::atomic<int>[n]);
+  for (int i = 0; i < n; ++i) {
+    slots_[i].offset = offsets[i];
+    slots_[i].size = buffers[i].size;
+    state_[i] = kFree;
+    slots_by_size_[buffers[i].size].push_back(i);
+    slots_by_offset_[offsets[i]].push_back(i);
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int j = i + 1; j < n; ++j) {
+      if (slots_[i].offset < slots_[j].offset + slots_[j].size &&
+          slots_[j].offset < slots_[i].offset + slots_[i].size) {
+        slots_[i].conflicts.push_back(j);
+        slots_[j].conflicts.push_back(i);
+      }
+    }
+  }
+}
+
+PlannedAllocator::~PlannedAllocator() { allocator_->DeallocateRaw(slab_); }
+
+bool PlannedAllocator::TryClaim(int slot) {
+  int expected = kFree;
+  if (!state_[slot].compare_exchange_strong(expected, kClaiming)) {
+    return false;
+  }
+  // Two threads claiming conflicting slots concurrently both see each
+  // other's kClaiming state, and at least one of them backs off.
+  for (int other : slots_[slot].conflicts) {
+    if (state_[other].load() != kFree) {
+      state_[slot].store(kFree);
+      return false;
+    }
+  }
+  state_[slot].store(kInUse);
+  return true;
+}
+
+void* PlannedAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (alignment <= Allocator::kAllocatorAlignment) {
+    auto it = slots_by_size_.find(RoundUpToAlignment(num_bytes));
+    if (it != slots_by_size_.end()) {
+      for (int slot : it->second) {
+        if (TryClaim(slot)) {
+          Ref();
+          num_planned_allocations_.fetch_add(1, std::memory_order_relaxed);
+          return slab_ + slots_[slot].offset;
+        }
+      }
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    Ref();
+  }
+  return ptr;
+}
+
+void PlannedAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  char* p = static_cast<char*>(ptr);
+  if (p >= slab_ && p < slab_ + slab_size_) {
+    // Only one of the slots starting at this offset can be in use, since
+    // they all conflict with each other.
+    auto it = slots_by_offset_.find(p - slab_);
+    CHECK(it != slots_by_offset_.end());
+    bool found = false;
+    for (int slot : it->second) {
+      if (state_[slot].load() == kInUse) {
+        state_[slot].store(kFree);
+        found = true;
+        break;
+      }
+    }
+    CHECK(found) << "Deallocating a free planned buffer " << ptr;
+  } else {
+    allocator_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+// RecordingAllocator is a wrapper for an Allocator that records the
+// lifetime of every buffer allocated through it, in terms of an event
+// counter incremented by each allocation and deallocation.
+class StaticMemoryPlanner::RecordingAllocator : public Allocator,
+                                                public core::RefCounted {
+ public:
+  explicit RecordingAllocator(Allocator* allocator) : allocator_(allocator) {}
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr == nullptr) return nullptr;
+    Ref();
+    mutex_lock l(mu_);
+    if (!finished_ && num_bytes > 0) {
+      BufferLifetime buffer;
+      buffer.size = RoundUpToAlignment(num_bytes);
+      buffer.start = next_event_++;
+      buffer.end = -1;
+      live_[ptr] = buffers_.size();
+      buffers_.push_back(buffer);
+    }
+    return ptr;
+  }
+  void DeallocateRaw(void* ptr) override {
+    if (ptr == nullptr) return;
+    {
+      mutex_lock l(mu_);
+      auto it = live_.find(ptr);
+      if (it != live_.end()) {
+        buffers_[it->second].end = next_event_++;
+        live_.erase(it);
+      }
+    }
+    allocator_->DeallocateRaw(ptr);
+    Unref();
+  }
+
+  // Returns the buffers allocated and deallocated so far, and stops
+  // recording.
+  std::vector<BufferLifetime> Finish() {
+    mutex_lock l(mu_);
+    finished_ = true;
+    live_.clear();
+    std::vector<BufferLifetime> buffers;
+    for (const BufferLifetime& buffer : buffers_) {
+      // Buffers still alive at the end of the step, such as fetched
+      // tensors, are not planned.
+      if (buffer.end >= 0) buffers.push_back(buffer);
+    }
+    return buffers;
+  }
+
+ private:
+  Allocator* const allocator_;  // not owned.
+
+  mutex mu_;
+  bool finished_ GUARDED_BY(mu_) = false;
+  int64 next_event_ GUARDED_BY(mu_) = 0;
+  std::vector<BufferLifetime> buffers_ GUARDED_BY(mu_);
+  std::unordered_map<void*, size_t> live_ GUARDED_BY(mu_);
+};
+
+StaticMemoryPlanner::Step::~Step() {
+  for (const auto& recorder : recorders_) {
+    recorder.second->Unref();
+  }
+}
+
+Allocator* StaticMemoryPlanner::Step::Wrap(Allocator* allocator) {
+  if (!record_) {
+    return planner_->Planned(allocator);
+  }
+  mutex_lock l(mu_);
+  for (const auto& recorder : recorders_) {
+    if (recorder.first == allocator) {
+      return recorder.second;
+    }
+  }
+  RecordingAllocator* recorder = new RecordingAllocator(allocator);
+  recorders_.push_back(std::make_pair(allocator, recorder));
+  return recorder;
+}
+
+StaticMemoryPlanner::StaticMemoryPlanner(int warmup_steps)
+    : warmup_steps_(warmup_steps), num_steps_started_(0), plan_ready_(false) {
+  CHECK_GT(warmup_steps, 0);
+}
+
+StaticMemoryPlanner::~StaticMemoryPlanner() {
+  for (const auto& planned : planned_) {
+    planned.second->Unref();
+  }
+}
+
+StaticMemoryPlanner::Step* StaticMemoryPlanner::StartStep() {
+  const int64 step = num_steps_started_.fetch_add(1, std::memory_order_relaxed);
+  if (step + 1 < warmup_steps_) {
+    return nullptr;
+  }
+  if (step + 1 == warmup_steps_) {
+    return new Step(this, true /* record */);
+  }
+  if (plan_ready_.load(std::memory_order_acquire) && !planned_.empty()) {
+    return new Step(this, false /* record */);
+  }
+  return nullptr;
+}
+
+void StaticMemoryPlanner::FinishStep(Step* step) {
+  if (step->record_) {
+    mutex_lock l(step->mu_);
+    for (const auto& recorder : step->recorders_) {
+      Allocator* allocator = recorder.first;
+      const std::vector<BufferLifetime> buffers = recorder.second->Finish();
+      if (buffers.empty()) continue;
+      std::vector<size_t> offsets;
+      const size_t slab_size = ComputeStaticMemoryPlan(buffers, &offsets);
+      void* slab =
+          allocator->AllocateRaw(Allocator::kAllocatorAlignment, slab_size);
+      if (slab == nullptr) {
+        LOG(WARNING) << "Could not allocate a slab of "
+                     << strings::HumanReadableNumBytes(slab_size)
+                     << " from " << allocator->Name()
+                     << " for the static memory plan";
+        continue;
+      }
+      size_t total_bytes = 0;
+      for (const BufferLifetime& buffer : buffers) total_bytes += buffer.size;
+      VLOG(1) << "Static memory plan for " << allocator->Name() << ": "
+              << buffers.size() << " buffers totalling "
+              << strings::HumanReadableNumBytes(total_bytes) << " in a slab of "
+              << strings::HumanReadableNumBytes(slab_size);
+      planned_.push_back(std::make_pair(
+          allocator, new PlannedAllocator(allocator, slab, slab_size, buffers,
+                                          offsets)));
+    }
+    plan_ready_.store(true, std::memory_order_release);
+  }
+  delete step;
+}
+
+Allocator* StaticMemoryPlanner::Planned(Allocator* allocator) {
+  for (const auto& planned : planned_) {
+    if (planned.first == allocator) {
+      return planned.second;
+    }
+  }
+  return allocator;
+}
+
+}  // end namespace tensorflow
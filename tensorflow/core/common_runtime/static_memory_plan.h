@@ -0,0 +1,181 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A buffer of "size" bytes live from event "start" until event "end".
+struct BufferLifetime {
+  size_t size = 0;
+  int64 start = 0;
+  int64 end = 0;
+};
+
+// Assigns an offset into a single slab to each of "buffers", such that two
+// buffers whose lifetimes overlap never overlap in memory. Buffers are
+// placed by decreasing size, each into the smallest gap that fits it.
+// Returns the size of the slab.
+size_t ComputeStaticMemoryPlan(const std::vector<BufferLifetime>& buffers,
+                               std::vector<size_t>* offsets);
+
+// PlannedAllocator is a wrapper for an Allocator that serves allocations
+// from a preallocated slab, following a plan computed by
+// ComputeStaticMemoryPlan() from the allocations of a previous step.
+//
+// An allocation takes a free slot of its exact size, provided that none of
+// the slots sharing memory with it is in use; the slots are claimed with
+// atomic operations only. Allocations that do not match a free slot, e.g.
+// because steps run concurrently or the allocation pattern changed, are
+// passed through to the underlying allocator.
+//
+// The wrapper deletes itself once it has been released by its owner and
+// all of its allocations have been deallocated.
+class PlannedAllocator : public Allocator, public core::RefCounted {
+ public:
+  // "allocator" is not owned and must outlive this wrapper. "slab" of
+  // "slab_size" bytes was allocated from "allocator", and is owned.
+  PlannedAllocator(Allocator* allocator, void* slab, size_t slab_size,
+                   const std::vector<BufferLifetime>& buffers,
+                   const std::vector<size_t>& offsets);
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Returns the number of allocations served from the slab so far.
+  int64 NumPlannedAllocations() const {
+    return num_planned_allocations_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  ~PlannedAllocator() override;
+
+ private:
+  // The states of a slot.
+  enum : int { kFree = 0, kClaiming = 1, kInUse = 2 };
+
+  bool TryClaim(int slot);
+
+  Allocator* const allocator_;  // not owned.
+  char* const slab_;
+  const size_t slab_size_;
+
+  struct Slot {
+    size_t offset;
+    size_t size;
+    // The other slots whose memory overlaps with this one.
+    std::vector<int> conflicts;
+  };
+  std::vector<Slot> slots_;
+  std::unique_ptr<std::atomic<int>[]> state_;
+  // Immutable after construction.
+  std::unordered_map<size_t, std::vector<int>> slots_by_size_;
+  std::unordered_map<size_t, std::vector<int>> slots_by_offset_;
+
+  std::atomic<int64> num_planned_allocations_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlannedAllocator);
+};
+
+// StaticMemoryPlanner records the allocations made by the kernels of one
+// executor during its "warmup_steps"-th step, and from then on serves the
+// allocations of every step from a PlannedAllocator per underlying
+// allocator. The earlier steps are skipped, since they typically make
+// one-time allocations, e.g. of variables.
+//
+//   StaticMemoryPlanner::Step* step = planner.StartStep();
+//   ... route each allocation of the step through step->Wrap(allocator) ...
+//   planner.FinishStep(step);
+class StaticMemoryPlanner {
+ public:
+  // REQUIRES: warmup_steps > 0.
+  explicit StaticMemoryPlanner(int warmup_steps);
+  ~StaticMemoryPlanner();
+
+  class Step;
+
+  // Returns the state of a new step, or nullptr if the allocations of the
+  // step are neither recorded nor planned.
+  Step* StartStep();
+
+  // Called once all the kernels of "step" have completed. Takes ownership
+  // of "step".
+  void FinishStep(Step* step);
+
+ private:
+  class RecordingAllocator;
+
+  // Returns the planned wrapper of "allocator", or "allocator" itself if it
+  // has no plan.
+  Allocator* Planned(Allocator* allocator);
+
+  const int warmup_steps_;
+  std::atomic<int64> num_steps_started_;
+
+  // Set once the recorded step has finished, after which planned_ is
+  // immutable and read without holding a lock.
+  std::atomic<bool> plan_ready_;
+  gtl::InlinedVector<std::pair<Allocator*, PlannedAllocator*>, 2> planned_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlanner);
+};
+
+// The allocations of one step.
+class StaticMemoryPlanner::Step {
+ public:
+  // Returns the allocator to use instead of "allocator" during this step.
+  Allocator* Wrap(Allocator* allocator);
+
+ private:
+  friend class StaticMemoryPlanner;
+
+  Step(StaticMemoryPlanner* planner, bool record)
+      : planner_(planner), record_(record) {}
+  ~Step();
+
+  StaticMemoryPlanner* const planner_;
+  // If true, the allocations are recorded, otherwise they are planned.
+  const bool record_;
+
+  mutex mu_;
+  gtl::InlinedVector<std::pair<Allocator*, RecordingAllocator*>, 2>
+      recorders_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Step);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,190 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the calls made to cpu_allocator().
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs_;
+    ++num_outstanding_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_outstanding_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocs_ = 0;
+  int num_outstanding_ = 0;
+};
+
+BufferLifetime Buffer(size_t size, int64 start, int64 end) {
+  BufferLifetime buffer;
+  buffer.size = size;
+  buffer.start = start;
+  buffer.end = end;
+  return buffer;
+}
+
+TEST(StaticMemoryPlanTest, ReusesMemoryOfDisjointLifetimes) {
+  std::vector<BufferLifetime> buffers = {Buffer(256, 0, 2), Buffer(256, 1, 4),
+                                         Buffer(256, 3, 5)};
+  std::vector<size_t> offsets;
+  EXPECT_EQ(512, ComputeStaticMemoryPlan(buffers, &offsets));
+  EXPECT_EQ(offsets[0], offsets[2]);
+  EXPECT_NE(offsets[0], offsets[1]);
+}
+
+TEST(StaticMemoryPlanTest, NoOverlaps) {
+  random::PhiloxRandom philox(123, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<BufferLifetime> buffers;
+  size_t total_bytes = 0;
+  for (int i = 0; i < 200; ++i) {
+    const int64 start = rnd.Uniform(1000);
+    const size_t size = (1 + rnd.Uniform(64)) * Allocator::kAllocatorAlignment;
+    buffers.push_back(Buffer(size, start, start + 1 + rnd.Uniform(100)));
+    total_bytes += size;
+  }
+  std::vector<size_t> offsets;
+  const size_t slab_size = ComputeStaticMemoryPlan(buffers, &offsets);
+  EXPECT_LT(slab_size, total_bytes);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    EXPECT_LE(offsets[i] + buffers[i].size, slab_size);
+    for (size_t j = i + 1; j < buffers.size(); ++j) {
+      const bool live_together = buffers[i].start < buffers[j].end &&
+                                 buffers[j].start < buffers[i].end;
+      const bool share_memory =
+          offsets[i] < offsets[j] + buffers[j].size &&
+          offsets[j] < offsets[i] + buffers[i].size;
+      EXPECT_FALSE(live_together && share_memory) << i << " " << j;
+    }
+  }
+}
+
+TEST(PlannedAllocatorTest, ServesPlannedSizesFromSlab) {
+  CountingAllocator base;
+  std::vector<BufferLifetime> buffers = {Buffer(256, 0, 2), Buffer(512, 1, 3)};
+  std::vector<size_t> offsets;
+  const size_t slab_size = ComputeStaticMemoryPlan(buffers, &offsets);
+  void* slab = base.AllocateRaw(Allocator::kAllocatorAlignment, slab_size);
+  PlannedAllocator* planned =
+      new PlannedAllocator(&base, slab, slab_size, buffers, offsets);
+
+  for (int step = 0; step < 3; ++step) {
+    // 250 bytes round up to the 256-byte slot.
+    void* a = planned->AllocateRaw(Allocator::kAllocatorAlignment, 250);
+    void* b = planned->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+    EXPECT_EQ(static_cast<char*>(slab) + offsets[0], a);
+    EXPECT_EQ(static_cast<char*>(slab) + offsets[1], b);
+    // The slot is in use, so a second allocation of the same size falls
+    // back to the underlying allocator.
+    void* c = planned->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+    EXPECT_EQ(2, base.num_outstanding_);
+    planned->DeallocateRaw(a);
+    planned->DeallocateRaw(b);
+    planned->DeallocateRaw(c);
+    EXPECT_EQ(1, base.num_outstanding_);
+  }
+  EXPECT_EQ(6, planned->NumPlannedAllocations());
+
+  planned->Unref();
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+TEST(PlannedAllocatorTest, ConflictingSlotsAreNotClaimedTogether) {
+  CountingAllocator base;
+  // Both buffers share the same memory, since their lifetimes are disjoint.
+  std::vector<BufferLifetime> buffers = {Buffer(256, 0, 1), Buffer(256, 2, 3)};
+  std::vector<size_t> offsets;
+  const size_t slab_size = ComputeStaticMemoryPlan(buffers, &offsets);
+  EXPECT_EQ(256, slab_size);
+  void* slab = base.AllocateRaw(Allocator::kAllocatorAlignment, slab_size);
+  PlannedAllocator* planned =
+      new PlannedAllocator(&base, slab, slab_size, buffers, offsets);
+
+  void* a = planned->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* b = planned->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(slab, a);
+  EXPECT_NE(slab, b);
+  planned->DeallocateRaw(a);
+  planned->DeallocateRaw(b);
+  EXPECT_EQ(1, planned->NumPlannedAllocations());
+
+  planned->Unref();
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+TEST(PlannedAllocatorTest, OutlivesOwner) {
+  CountingAllocator base;
+  std::vector<BufferLifetime> buffers = {Buffer(256, 0, 1)};
+  std::vector<size_t> offsets;
+  const size_t slab_size = ComputeStaticMemoryPlan(buffers, &offsets);
+  void* slab = base.AllocateRaw(Allocator::kAllocatorAlignment, slab_size);
+  PlannedAllocator* planned =
+      new PlannedAllocator(&base, slab, slab_size, buffers, offsets);
+  void* a = planned->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  planned->Unref();
+  EXPECT_EQ(1, base.num_outstanding_);
+  planned->DeallocateRaw(a);
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+// Runs one step allocating the same buffers, and returns the number of
+// allocations that reached "base".
+int RunStep(StaticMemoryPlanner* planner, CountingAllocator* base) {
+  const int num_allocs = base->num_allocs_;
+  StaticMemoryPlanner::Step* step = planner->StartStep();
+  Allocator* a = step == nullptr ? base : step->Wrap(base);
+  void* p0 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  void* p1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  a->DeallocateRaw(p0);
+  void* p2 = a->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  a->DeallocateRaw(p1);
+  a->DeallocateRaw(p2);
+  if (step != nullptr) planner->FinishStep(step);
+  return base->num_allocs_ - num_allocs;
+}
+
+TEST(StaticMemoryPlannerTest, ServesStepsAfterWarmupFromPlan) {
+  CountingAllocator base;
+  {
+    StaticMemoryPlanner planner(2);
+    EXPECT_EQ(3, RunStep(&planner, &base));
+    // The recorded step, plus the allocation of the slab.
+    EXPECT_EQ(4, RunStep(&planner, &base));
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(0, RunStep(&planner, &base));
+    }
+    // Only the slab is outstanding.
+    EXPECT_EQ(1, base.num_outstanding_);
+  }
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+}  // namespace
+}  // namespace tensorflow
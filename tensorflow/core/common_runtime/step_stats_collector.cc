@@ -14,10 +14,14 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+
+#include <thread>
+
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/scanner.h"
@@ -25,8 +29,23 @@ limitations under the License.
 
 namespace tensorflow {
 
+constexpr int StepStatsCollector::kNumBuffers;
+
 StepStatsCollector::StepStatsCollector(StepStats* ss) : step_stats_(ss) {}
 
+StepStatsCollector::~StepStatsCollector() {
+  Finalize();
+  // Drops the allocators of the nodes that were never saved.
+  for (Buffer& buffer : buffers_) {
+    mutex_lock l(buffer.mu);
+    for (auto& entry : buffer.allocators) {
+      for (TrackingAllocator* allocator : entry.second) {
+        allocator->GetRecordsAndUnRef();
+      }
+    }
+  }
+}
+
 static int ExtractGpuWithStreamAll(string device_name) {
   // Check if the device name matches the ".*gpu:(\\d+)/stream:all$" regexp,
   // and if it does return the stream index (always positive). If it doesn't
@@ -91,6 +110,7 @@ void StepStatsCollector::BuildCostModel(
     CostModelManager* cost_model_manager,
     const std::unordered_map<string, const Graph*>& device_map) {
   mutex_lock lock(mu_);
+  FinalizeLocked();
 
   // Hardware stats for gpu are available under a fake device named
   // "gpu:<id>/stream::all.
@@ -207,40 +227,123 @@ void StepStatsCollector::BuildCostModel(
   }
 }
 
+StepStatsCollector::Buffer* StepStatsCollector::CurrentBuffer() {
+  const size_t thread_hash = std::hash<std::thread::id>()(
+      std::this_thread::get_id());
+  return &buffers_[thread_hash % kNumBuffers];
+}
+
 void StepStatsCollector::Save(const string& device, NodeExecStats* nt) {
   VLOG(1) << "Save dev " << device << " nt " << nt;
-  {
-    mutex_lock l(mu_);
-    if (!step_stats_ || collectedNodes >= kMaxCollectedNodes) {
-      VLOG(1) << "step_stats_ nullptr or already collected too many nodes.";
-      delete nt;
-      return;
+  if (!step_stats_ || collected_nodes_.fetch_add(
+                          1, std::memory_order_relaxed) >= kMaxCollectedNodes) {
+    VLOG(1) << "step_stats_ nullptr or already collected too many nodes.";
+    Discard(nt);
+    return;
+  }
+  Buffer* buffer = CurrentBuffer();
+  mutex_lock l(buffer->mu);
+  buffer->stats.emplace_back(device, nt);
+}
+
+void StepStatsCollector::SaveAllocations(
+    const NodeExecStats* nt, std::vector<TrackingAllocator*> allocators) {
+  if (allocators.empty()) return;
+  // The node is usually saved by the same thread, so its allocators are
+  // found in the same buffer.
+  Buffer* buffer = CurrentBuffer();
+  mutex_lock l(buffer->mu);
+  buffer->allocators[nt] = std::move(allocators);
+}
+
+std::vector<TrackingAllocator*> StepStatsCollector::TakeAllocators(
+    const NodeExecStats* nt) {
+  std::vector<TrackingAllocator*> allocators;
+  for (Buffer& buffer : buffers_) {
+    mutex_lock l(buffer.mu);
+    auto it = buffer.allocators.find(nt);
+    if (it != buffer.allocators.end()) {
+      allocators.swap(it->second);
+      buffer.allocators.erase(it);
+      break;
     }
-    DeviceStepStats* dss = nullptr;
-    // Slow linear scan, but it should only be called
-    // by a Worker in a context with < ~10 devices.
-    // TODO(tucker): consider adding a std::unordered_map.
+  }
+  return allocators;
+}
+
+void StepStatsCollector::Discard(NodeExecStats* nt) {
+  for (TrackingAllocator* allocator : TakeAllocators(nt)) {
+    allocator->GetRecordsAndUnRef();
+  }
+  delete nt;
+}
+
+void StepStatsCollector::Finalize() {
+  mutex_lock l(mu_);
+  FinalizeLocked();
+}
+
+void StepStatsCollector::FinalizeLocked() {
+  if (!step_stats_) return;
+  // Only a few devices run a step, so a map is not worth building here.
+  auto find_device = [this](const string& device) {
     for (auto& ds : *step_stats_->mutable_dev_stats()) {
-      if (ds.device() == device) {
-        dss = &ds;
-        break;
-      }
+      if (ds.device() == device) return &ds;
     }
-    if (dss == nullptr) {
-      dss = step_stats_->add_dev_stats();
-      dss->set_device(device);
+    DeviceStepStats* dss = step_stats_->add_dev_stats();
+    dss->set_device(device);
+    return dss;
+  };
+  std::vector<std::pair<string, NodeExecStats*>> stats;
+  AllocatorsMap allocators;
+  for (Buffer& buffer : buffers_) {
+    mutex_lock l(buffer.mu);
+    stats.insert(stats.end(), buffer.stats.begin(), buffer.stats.end());
+    buffer.stats.clear();
+    for (auto& entry : buffer.allocators) {
+      allocators.insert(std::move(entry));
+    }
+    buffer.allocators.clear();
+  }
+  DeviceStepStats* dss = nullptr;
+  for (auto& entry : stats) {
+    // Consecutive entries usually come from the same device.
+    if (dss == nullptr || dss->device() != entry.first) {
+      dss = find_device(entry.first);
+    }
+    NodeExecStats* nt = entry.second;
+    auto it = allocators.find(nt);
+    if (it != allocators.end()) {
+      for (int i = 0; i < it->second.size(); ++i) {
+        AllocatorMemoryUsed* memory = nt->mutable_memory(i);
+        for (const auto& record : it->second[i]->GetRecordsAndUnRef()) {
+          AllocationRecord* r = memory->add_allocation_records();
+          r->set_alloc_micros(record.alloc_micros);
+          r->set_dealloc_micros(record.dealloc_micros);
+          r->set_alloc_bytes(record.bytes);
+        }
+      }
+      allocators.erase(it);
     }
     nt->Swap(dss->add_node_stats());
-    collectedNodes++;
+    delete nt;
+  }
+  // Keeps the allocators of the nodes that are still running.
+  if (!allocators.empty()) {
+    Buffer* buffer = CurrentBuffer();
+    mutex_lock l(buffer->mu);
+    for (auto& entry : allocators) {
+      buffer->allocators.insert(std::move(entry));
+    }
   }
-  delete nt;
 }
 
 void StepStatsCollector::Swap(StepStats* ss) {
   mutex_lock l(mu_);
   CHECK(step_stats_);
+  FinalizeLocked();
   ss->Swap(step_stats_);
-  collectedNodes = 0;
+  collected_nodes_.store(0, std::memory_order_relaxed);
 }
 
 }  // namespace tensorflow
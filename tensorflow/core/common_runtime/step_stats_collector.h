@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_STATS_COLLECTOR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_STATS_COLLECTOR_H_
 
+#include <atomic>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -26,14 +29,28 @@ class CostModelManager;
 class Graph;
 class NodeExecStats;
 class StepStats;
+class TrackingAllocator;
 
 // StepStatsCollector manages the collection of a StepStats object.
 // The StepStats object holds multiple DeviceStats.
 // Each DeviceStats object holds multiple NodeExecStats.
+//
+// Save() is called by every executor thread for every node it runs, so it
+// only appends to one of several buffers, picked by the calling thread, and
+// the node stats are moved into the StepStats object by Finalize(). The
+// buffers are rarely contended, unlike a single lock around the StepStats.
+//
+// The tensors allocated by a node usually outlive it, so their deallocation
+// times are only known once the step is over. SaveAllocations() keeps the
+// node's tracking allocators until Finalize() copies their allocation records
+// into the node stats.
 class StepStatsCollector {
  public:
   explicit StepStatsCollector(StepStats* ss);
 
+  // Calls Finalize().
+  ~StepStatsCollector();
+
   // BuildCostModel builds or updates a CostModel managed by cost_model_manager,
   // using the currently collected DeviceStats associated with the devices in
   // device_map.
@@ -44,16 +61,53 @@ class StepStatsCollector {
   // Save saves nt to the DeviceStats object associated with device.
   void Save(const string& device, NodeExecStats* nt);
 
+  // SaveAllocations takes the caller's reference to the tracking allocators
+  // of nt, which must be in the same order as nt->memory(), and adds their
+  // allocation records to nt->memory() when nt is finalized. nt must then be
+  // passed to Save() or Discard().
+  void SaveAllocations(const NodeExecStats* nt,
+                       std::vector<TrackingAllocator*> allocators);
+
+  // Discard deletes nt without saving it.
+  void Discard(NodeExecStats* nt);
+
   // Swap replaces the current step stats with ss.
   void Swap(StepStats* ss);
 
+  // Moves the node stats saved so far into the StepStats object. The stats
+  // saved after the last call to Finalize(), Swap() or BuildCostModel() are
+  // not visible in the StepStats object until the collector is destroyed.
+  void Finalize();
+
  private:
+  static constexpr int kNumBuffers = 16;
+
+  typedef std::unordered_map<const NodeExecStats*,
+                             std::vector<TrackingAllocator*>>
+      AllocatorsMap;
+
+  struct Buffer {
+    mutex mu;
+    std::vector<std::pair<string, NodeExecStats*>> stats GUARDED_BY(mu);
+    // The tracking allocators of the nodes not finalized yet.
+    AllocatorsMap allocators GUARDED_BY(mu);
+  };
+
+  Buffer* CurrentBuffer();
+
+  // Removes and returns the tracking allocators of nt, if any.
+  std::vector<TrackingAllocator*> TakeAllocators(const NodeExecStats* nt);
+
+  void FinalizeLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // TODO(suharshs): Make this configurable if its not possible to find a value
   //                 that works for all cases.
   const uint64 kMaxCollectedNodes = 1 << 20;
+  // Guards the contents of *step_stats_.
   mutex mu_;
-  StepStats* step_stats_ GUARDED_BY(mu_);
-  uint64 collectedNodes GUARDED_BY(mu_) = 0;
+  StepStats* const step_stats_;
+  std::atomic<uint64> collected_nodes_{0};
+  Buffer buffers_[kNumBuffers];
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,139 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
+#define TENSORFLOW_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// WorkStealingQueues is an internal helper class holding one double-ended
+// queue per worker, for use in the ExecutorState module.
+//
+// A worker owns the queue with its index and pushes and pops items at the
+// back of it (LIFO), so that the work produced by a worker tends to be
+// consumed by the same worker while its inputs are still in cache. A worker
+// whose own queue is empty steals from the front of the other queues (FIFO),
+// taking the oldest and usually largest piece of outstanding work.
+//
+// Each queue is guarded by its own mutex, so workers operating on their own
+// queues never contend with each other.
+//
+//    WorkStealingQueues<Item> queues(num_workers);
+//    queues.Push(item);                  // from any thread
+//    ...
+//    // in worker "w":
+//    Item item;
+//    while (queues.PopLocal(w, &item) || queues.Steal(w, &item)) {
+//      ... process item, possibly calling queues.PushLocal(w, ...) ...
+//    }
+template <typename T>
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(int num_queues) : next_queue_(0) {
+    CHECK_GT(num_queues, 0);
+    queues_.reserve(num_queues);
+    for (int i = 0; i < num_queues; ++i) {
+      queues_.emplace_back(new Queue);
+    }
+  }
+
+  int NumQueues() const { return static_cast<int>(queues_.size()); }
+
+  // Adds "item" to the back of the queue owned by worker "index".
+  void PushLocal(int index, const T& item) {
+    DCHECK_GE(index, 0);
+    DCHECK_LT(index, NumQueues());
+    Queue* q = queues_[index].get();
+    mutex_lock l(q->mu);
+    q->items.push_back(item);
+  }
+
+  // Adds "item" to one of the queues, chosen round-robin. Used by threads
+  // that do not own a queue.
+  void Push(const T& item) {
+    const uint32 index =
+        next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    PushLocal(index, item);
+  }
+
+  // Removes the most recently pushed item of the queue owned by worker
+  // "index" into "*item". Returns false if that queue is empty.
+  bool PopLocal(int index, T* item) {
+    DCHECK_GE(index, 0);
+    DCHECK_LT(index, NumQueues());
+    Queue* q = queues_[index].get();
+    mutex_lock l(q->mu);
+    if (q->items.empty()) return false;
+    *item = q->items.back();
+    q->items.pop_back();
+    return true;
+  }
+
+  // Removes the oldest item of some queue other than the one owned by
+  // worker "index" into "*item". The victims are visited starting with the
+  // queue following "index". Returns false if all the other queues are
+  // empty.
+  bool Steal(int index, T* item) {
+    const int n = NumQueues();
+    for (int i = 1; i < n; ++i) {
+      Queue* q = queues_[(index + i) % n].get();
+      mutex_lock l(q->mu);
+      if (!q->items.empty()) {
+        *item = q->items.front();
+        q->items.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns true if all the queues are empty. The result may be stale by
+  // the time it is returned if other threads are pushing concurrently.
+  bool Empty() const {
+    for (const auto& q : queues_) {
+      mutex_lock l(q->mu);
+      if (!q->items.empty()) return false;
+    }
+    return true;
+  }
+
+ private:
+  struct Queue {
+    mutable mutex mu;
+    std::deque<T> items GUARDED_BY(mu);
+  };
+
+  // Each Queue is allocated separately so that the mutexes of different
+  // workers do not share a cache line.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::atomic<uint32> next_queue_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingQueues);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_WORK_STEALING_QUEUES_H_
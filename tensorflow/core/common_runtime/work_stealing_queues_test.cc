@@ -0,0 +1,105 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queues.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+TEST(WorkStealingQueues, LocalIsLifo) {
+  WorkStealingQueues<int> q(2);
+  EXPECT_EQ(q.NumQueues(), 2);
+  EXPECT_TRUE(q.Empty());
+  q.PushLocal(0, 1);
+  q.PushLocal(0, 2);
+  q.PushLocal(0, 3);
+  EXPECT_FALSE(q.Empty());
+  int v = 0;
+  EXPECT_TRUE(q.PopLocal(0, &v));
+  EXPECT_EQ(v, 3);
+  EXPECT_TRUE(q.PopLocal(0, &v));
+  EXPECT_EQ(v, 2);
+  EXPECT_FALSE(q.PopLocal(1, &v));
+  EXPECT_TRUE(q.PopLocal(0, &v));
+  EXPECT_EQ(v, 1);
+  EXPECT_FALSE(q.PopLocal(0, &v));
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueues, StealIsFifo) {
+  WorkStealingQueues<int> q(3);
+  q.PushLocal(1, 1);
+  q.PushLocal(1, 2);
+  int v = 0;
+  // A worker never steals from itself.
+  EXPECT_FALSE(q.Steal(1, &v));
+  EXPECT_TRUE(q.Steal(0, &v));
+  EXPECT_EQ(v, 1);
+  EXPECT_TRUE(q.Steal(2, &v));
+  EXPECT_EQ(v, 2);
+  EXPECT_FALSE(q.Steal(0, &v));
+}
+
+TEST(WorkStealingQueues, PushIsRoundRobin) {
+  WorkStealingQueues<int> q(4);
+  for (int i = 0; i < 8; ++i) {
+    q.Push(i);
+  }
+  for (int i = 0; i < 4; ++i) {
+    int v = -1;
+    EXPECT_TRUE(q.PopLocal(i, &v));
+    EXPECT_TRUE(q.PopLocal(i, &v));
+    EXPECT_FALSE(q.PopLocal(i, &v));
+  }
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueues, Concurrent) {
+  const int kWorkers = 4;
+  const int kItems = 10000;
+  WorkStealingQueues<int> q(kWorkers);
+  for (int i = 0; i < kItems; ++i) {
+    q.PushLocal(0, i);
+  }
+  std::vector<std::vector<int>> taken(kWorkers);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kWorkers);
+    for (int w = 0; w < kWorkers; ++w) {
+      pool.Schedule([&q, &taken, w]() {
+        int v;
+        while (q.PopLocal(w, &v) || q.Steal(w, &v)) {
+          taken[w].push_back(v);
+        }
+      });
+    }
+  }
+  std::vector<bool> seen(kItems, false);
+  for (const auto& items : taken) {
+    for (int v : items) {
+      EXPECT_FALSE(seen[v]);
+      seen[v] = true;
+    }
+  }
+  for (int i = 0; i < kItems; ++i) {
+    EXPECT_TRUE(seen[i]);
+  }
+}
+
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/debug/debug_io_utils.h"
 
+#include <deque>
 #include <vector>
 
 #if defined(PLATFORM_GOOGLE)
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/event.pb.h"
 
@@ -270,6 +272,106 @@ Status PublishEncodedGraphDefInChunks(const string& encoded_graph_def,
 }
 #endif
 
+// Publishes debug tensors from a background thread.
+class AsyncDebugTensorPublisher {
+ public:
+  static AsyncDebugTensorPublisher* Global() {
+    static AsyncDebugTensorPublisher* publisher =
+        new AsyncDebugTensorPublisher;
+    return publisher;
+  }
+
+  void Publish(const DebugNodeKey& debug_node_key, const Tensor& tensor,
+               const uint64 wall_time_us,
+               const gtl::ArraySlice<string>& debug_urls,
+               const bool gated_grpc) {
+    const int64 bytes = tensor.TotalBytes();
+    mutex_lock l(mu_);
+    if (pending_bytes_ + bytes > DebugIO::kMaxPendingAsyncBytes) {
+      LOG(WARNING) << "Dropping debug tensor " << debug_node_key.debug_node_name
+                   << " because " << pending_bytes_
+                   << " bytes are still waiting to be published";
+      return;
+    }
+    if (thread_ == nullptr) {
+      thread_.reset(Env::Default()->StartThread(
+          ThreadOptions(), "tfdbg_async_publisher", [this]() { Run(); }));
+    }
+    pending_bytes_ += bytes;
+    pending_.emplace_back(debug_node_key, tensor, wall_time_us,
+                          std::vector<string>(debug_urls.begin(),
+                                              debug_urls.end()),
+                          gated_grpc);
+    cv_.notify_all();
+  }
+
+  void Flush() {
+    mutex_lock l(mu_);
+    while (!pending_.empty() || publishing_) {
+      cv_.wait(l);
+    }
+  }
+
+ private:
+  struct PendingTensor {
+    PendingTensor(const DebugNodeKey& debug_node_key, const Tensor& tensor,
+                  const uint64 wall_time_us, std::vector<string> debug_urls,
+                  const bool gated_grpc)
+        : debug_node_key(debug_node_key),
+          tensor(tensor),
+          wall_time_us(wall_time_us),
+          debug_urls(std::move(debug_urls)),
+          gated_grpc(gated_grpc) {}
+
+    const DebugNodeKey debug_node_key;
+    const Tensor tensor;
+    const uint64 wall_time_us;
+    const std::vector<string> debug_urls;
+    const bool gated_grpc;
+  };
+
+  AsyncDebugTensorPublisher() {}
+
+  // Runs forever: the publisher is never deleted.
+  void Run() {
+    while (true) {
+      std::deque<PendingTensor> batch;
+      {
+        mutex_lock l(mu_);
+        while (pending_.empty()) {
+          cv_.wait(l);
+        }
+        batch.swap(pending_);
+        publishing_ = true;
+      }
+      int64 published_bytes = 0;
+      for (const PendingTensor& item : batch) {
+        Status s = DebugIO::PublishDebugTensor(
+            item.debug_node_key, item.tensor, item.wall_time_us,
+            item.debug_urls, item.gated_grpc);
+        if (!s.ok()) {
+          LOG(ERROR) << "Failed to publish debug tensor "
+                     << item.debug_node_key.debug_node_name << " to "
+                     << str_util::Join(item.debug_urls, ", ") << ": "
+                     << s.error_message();
+        }
+        published_bytes += item.tensor.TotalBytes();
+      }
+      mutex_lock l(mu_);
+      pending_bytes_ -= published_bytes;
+      publishing_ = false;
+      cv_.notify_all();
+    }
+  }
+
+  mutex mu_;
+  condition_variable cv_;
+  std::deque<PendingTensor> pending_ GUARDED_BY(mu_);
+  int64 pending_bytes_ GUARDED_BY(mu_) = 0;
+  bool publishing_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_ GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 // static
@@ -491,6 +593,23 @@ Status DebugIO::PublishDebugTensor(const DebugNodeKey& debug_node_key,
                             false);
 }
 
+const int64 DebugIO::kMaxPendingAsyncBytes = 256 << 20;
+
+// static
+void DebugIO::PublishDebugTensorAsync(const DebugNodeKey& debug_node_key,
+                                      const Tensor& tensor,
+                                      const uint64 wall_time_us,
+                                      const gtl::ArraySlice<string>& debug_urls,
+                                      const bool gated_grpc) {
+  AsyncDebugTensorPublisher::Global()->Publish(
+      debug_node_key, tensor, wall_time_us, debug_urls, gated_grpc);
+}
+
+// static
+void DebugIO::FlushAsyncPublishing() {
+  AsyncDebugTensorPublisher::Global()->Flush();
+}
+
 // static
 Status DebugIO::PublishGraph(const Graph& graph, const string& device_name,
                              const std::unordered_set<string>& debug_urls) {
@@ -98,6 +98,23 @@ class DebugIO {
                                    const uint64 wall_time_us,
                                    const gtl::ArraySlice<string>& debug_urls);
 
+  // Same as PublishDebugTensor, but returns immediately. The tensors are
+  // published in batches by a background thread, in the order in which they
+  // were submitted, and failures are logged. If the pending tensors exceed
+  // kMaxPendingAsyncBytes, the tensor is dropped with a warning instead of
+  // blocking the caller.
+  static void PublishDebugTensorAsync(const DebugNodeKey& debug_node_key,
+                                      const Tensor& tensor,
+                                      const uint64 wall_time_us,
+                                      const gtl::ArraySlice<string>& debug_urls,
+                                      const bool gated_grpc);
+
+  // Waits until all the tensors submitted to PublishDebugTensorAsync() so far
+  // have been published.
+  static void FlushAsyncPublishing();
+
+  static const int64 kMaxPendingAsyncBytes;
+
   // Publishes a graph to a set of debug URLs.
   //
   // Args:
@@ -177,6 +177,17 @@ WorkerSession* BaseRemoteRendezvous::session() {
   return session_;
 }
 
+void BaseRemoteRendezvous::SetRecvTensorCompression(
+    const TensorCompressionOptions& options) {
+  mutex_lock l(mu_);
+  recv_tensor_compression_ = options;
+}
+
+TensorCompressionOptions BaseRemoteRendezvous::recv_tensor_compression() {
+  mutex_lock l(mu_);
+  return recv_tensor_compression_;
+}
+
 bool BaseRemoteRendezvous::is_initialized() {
   mutex_lock l(mu_);
   return is_initialized_locked();
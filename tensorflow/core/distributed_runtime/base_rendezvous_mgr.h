@@ -124,6 +124,9 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Upgrades the BaseRemoteRendezvous to full initialization.
   Status Initialize(WorkerSession* session) override;
 
+  void SetRecvTensorCompression(
+      const TensorCompressionOptions& options) override;
+
   // Forwards to local_, where the Tensor "val" will be buffered and
   // any waiting callback stored.
   Status Send(const ParsedKey& key, const Rendezvous::Args& args,
@@ -170,6 +173,9 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
 
   bool is_initialized();
 
+  // Returns the options set by SetRecvTensorCompression().
+  TensorCompressionOptions recv_tensor_compression();
+
   ~BaseRemoteRendezvous() override;
 
   const WorkerEnv* const env_;  // Not owned.
@@ -183,6 +189,7 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Status given by StartAbort() if any.
   Status status_ GUARDED_BY(mu_);
   WorkerSession* session_ GUARDED_BY(mu_);  // Not owned.
+  TensorCompressionOptions recv_tensor_compression_ GUARDED_BY(mu_);
 
   // Data structures to handle calls when partially initialized.
   struct DeferredCall {
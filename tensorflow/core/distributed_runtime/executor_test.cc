@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -22,13 +23,16 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -61,6 +65,12 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_;
+    params.num_work_stealing_workers = num_work_stealing_workers_;
+    params.inline_kernel_cost_threshold_usecs =
+        inline_kernel_cost_threshold_usecs_;
+    params.kernel_cost_warmup_steps = 2;
+    params.kernel_creation_pool = kernel_creation_pool_;
+    params.inline_synchronous_cpu_graphs = inline_synchronous_cpu_graphs_;
     params.create_kernel = [this, version](const NodeDef& ndef,
                                            OpKernel** kernel) {
       return CreateNonCachedKernel(device_, nullptr, ndef, version, kernel);
@@ -82,7 +92,26 @@ class ExecutorTest : public ::testing::Test {
     return exec_->Run(args);
   }
 
+  // Runs a step with "rendez" and returns in "*num_closures" how many
+  // closures the executor passed to the runner.
+  Status RunCountingClosures(Rendezvous* rendez, int* num_closures) {
+    std::atomic<int> count(0);
+    Executor::Args args;
+    args.rendezvous = rendez;
+    args.runner = [this, &count](std::function<void()> fn) {
+      ++count;
+      thread_pool_->Schedule(fn);
+    };
+    Status s = exec_->Run(args);
+    *num_closures = count;
+    return s;
+  }
+
   thread::ThreadPool* thread_pool_ = nullptr;
+  int num_work_stealing_workers_ = 0;
+  int64 inline_kernel_cost_threshold_usecs_ = 0;
+  thread::ThreadPool* kernel_creation_pool_ = nullptr;
+  bool inline_synchronous_cpu_graphs_ = false;
   Device* device_ = nullptr;
   Executor* exec_ = nullptr;
   StepStatsCollector step_stats_collector_;
@@ -128,6 +157,16 @@ float V(const Tensor& tensor) {
 
 static uint64 kIncarnation = 1;  // Uses in following tests.
 
+// The number of nodes of "g" without inputs, which the executor passes to
+// the runner at the start of every step.
+int NumRootNodes(const Graph* g) {
+  int num_roots = 0;
+  for (const Node* n : g->nodes()) {
+    if (n->in_edges().empty()) ++num_roots;
+  }
+  return num_roots;
+}
+
 Rendezvous::ParsedKey Key(const string& sender, const uint64 incarnation,
                           const string& receiver, const string& name) {
   Rendezvous::ParsedKey result;
@@ -243,6 +282,169 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  num_work_stealing_workers_ = thread_pool_->NumThreads();
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, RandomTreeParallelKernelCreation) {
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  kernel_creation_pool_ = thread_pool_;
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, RandomTreeInlineByMeasuredCost) {
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  const int num_roots = NumRootNodes(g);
+  inline_kernel_cost_threshold_usecs_ = 1000;
+  Create(g);
+  // The first two steps measure kernel costs; the others use them.
+  for (int step = 0; step < 4; ++step) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    int num_closures = 0;
+    TF_ASSERT_OK(RunCountingClosures(rendez, &num_closures));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    rendez->Unref();
+    if (step >= 2) {
+      // The Adds were measured as cheap and all run inline. Only the root
+      // nodes, the Identities made ready by the asynchronous Recv and the
+      // done callback go through the runner.
+      EXPECT_EQ(num_roots + 4096 + 1, num_closures);
+    }
+  }
+}
+
+// Sleeps for "micros" in a synchronous Compute(), while claiming to be
+// inexpensive.
+REGISTER_OP("ExecutorTestSleep")
+    .Input("in: float")
+    .Output("out: float")
+    .Attr("micros: int");
+class ExecutorTestSleepOp : public OpKernel {
+ public:
+  explicit ExecutorTestSleepOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("micros", &micros_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    Env::Default()->SleepForMicroseconds(micros_);
+    ctx->set_output(0, ctx->input(0));
+  }
+
+  bool IsExpensive() override { return false; }
+
+ private:
+  int64 micros_;
+};
+REGISTER_KERNEL_BUILDER(Name("ExecutorTestSleep").Device(DEVICE_CPU),
+                        ExecutorTestSleepOp);
+
+// The measured costs override OpKernel::IsExpensive() in both directions.
+TEST_F(ExecutorTest, InlineByMeasuredCost) {
+  // b = x + x, with x = Identity(a), and kNumSleeps sleeps of x on the side.
+  constexpr int kNumSleeps = 4;
+  Graph* g = new Graph(OpRegistry::Global());
+  auto in = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto x = test::graph::Identity(g, in, 0);
+  for (int i = 0; i < kNumSleeps; ++i) {
+    Node* sleep;
+    TF_ASSERT_OK(NodeBuilder(g->NewName("sleep"), "ExecutorTestSleep")
+                     .Input(x)
+                     .Attr("micros", 5000)
+                     .Finalize(g, &sleep));
+  }
+  auto add = test::graph::Add(g, x, x);
+  test::graph::Send(g, add, "b", BOB, 1, ALICE);
+  const int num_roots = NumRootNodes(g);
+  inline_kernel_cost_threshold_usecs_ = 1000;
+  Create(g);
+  for (int step = 0; step < 4; ++step) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    int num_closures = 0;
+    TF_ASSERT_OK(RunCountingClosures(rendez, &num_closures));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(2.0, V(out));
+    rendez->Unref();
+    // The root nodes, the Identity made ready by the asynchronous Recv and
+    // the done callback always go through the runner.
+    if (step < 2) {
+      // The sleeps claim to be cheap and run inline; the Add, expensive for
+      // OpKernel::IsExpensive(), is dispatched next to them.
+      EXPECT_EQ(num_roots + 2 + 1, num_closures);
+    } else {
+      // The sleeps were measured as expensive and are all dispatched; the
+      // Add was measured as cheap and runs inline.
+      EXPECT_EQ(num_roots + 2 + kNumSleeps, num_closures);
+    }
+  }
+}
+
+TEST_F(ExecutorTest, InlineSynchronousCpuGraph) {
+  // d = (a + b) + (a + b), with a and b constants.
+  Graph* g = new Graph(OpRegistry::Global());
+  auto a = test::graph::Constant(g, V(1.0));
+  auto b = test::graph::Constant(g, V(2.0));
+  auto sum = test::graph::Add(g, a, b);
+  auto twice = test::graph::Add(g, sum, sum);
+  test::graph::Send(g, twice, "d", BOB, 1, ALICE);
+  inline_synchronous_cpu_graphs_ = true;
+  Create(g);
+  int num_closures = 0;
+  for (int step = 0; step < 3; ++step) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Executor::Args args;
+    args.rendezvous = rendez;
+    args.runner = [&num_closures](std::function<void()> fn) {
+      ++num_closures;
+      fn();
+    };
+    TF_ASSERT_OK(exec_->Run(args));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez->Recv(Key(BOB, kIncarnation, ALICE, "d"),
+                              Rendezvous::Args(), &out, &is_dead));
+    EXPECT_EQ(6.0, V(out));
+    rendez->Unref();
+  }
+  // Only the done callback of each step goes through the runner.
+  EXPECT_EQ(3, num_closures);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -278,6 +480,24 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
     rendez->Unref();
   }
 }
+
+TEST_F(ExecutorTest, ConcurrentAddAssignWorkStealing) {
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildConcurrentAddAssign(g);
+  num_work_stealing_workers_ = thread_pool_->NumThreads();
+  Create(g);
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
 #endif
 
 TEST_F(ExecutorTest, SimpleSwitchLive) {
@@ -317,6 +537,99 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+// out = a, incremented by 1 until it reaches 10, in a while loop.
+TEST_F(ExecutorTest, WhileLoopAcrossSteps) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const string frame = "while";
+  const string next_name = "while/next";
+  auto in0 = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto enter = test::graph::Enter(g, in0, frame);
+  auto merge = test::graph::Merge(g, enter, {next_name});
+  Node* limit;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Enter")
+                   .Input(test::graph::Constant(g, V(10.0)))
+                   .Attr("frame_name", frame)
+                   .Attr("is_constant", true)
+                   .Finalize(g, &limit));
+  auto cond = test::graph::LoopCond(g, test::graph::Less(g, merge, limit));
+  auto sw = test::graph::Switch(g, merge, cond);
+  auto body = test::graph::Identity(g, sw, 1);
+  auto one = test::graph::Constant(g, V(1.0));
+  g->AddControlEdge(body, one);
+  auto next = test::graph::Next(g, next_name, test::graph::Add(g, body, one));
+  g->AddEdge(next, 0, merge, 1);
+  test::graph::Send(g, test::graph::Exit(g, sw), "c", BOB, 1, ALICE);
+  Create(g);
+  // Later steps run on the frame and iteration states of the earlier ones.
+  const std::vector<std::pair<float, float>> start_and_out = {
+      {0.0, 10.0}, {4.0, 10.0}, {9.5, 10.5}, {12.0, 12.0}};
+  for (const auto& p : start_and_out) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(p.first), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args,
+                               &out, &is_dead));
+    EXPECT_FALSE(is_dead);
+    EXPECT_EQ(p.second, V(out));
+  }
+}
+
+// (i, x) = (0, 0), incremented by (1, 2) while i < 10, in a loop running up to
+// 10 iterations in parallel, so that the nodes of several iterations are
+// ready at the same time.
+TEST_F(ExecutorTest, WhileLoopParallelIterations) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const string frame = "while";
+  auto enter = [g, &frame](Node* input, bool is_constant) {
+    Node* ret;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Enter")
+                    .Input(input)
+                    .Attr("frame_name", frame)
+                    .Attr("is_constant", is_constant)
+                    .Attr("parallel_iterations", 10)
+                    .Finalize(g, &ret));
+    return ret;
+  };
+  auto merge_i = test::graph::Merge(
+      g, enter(test::graph::Constant(g, V(0.0)), false), {"while/next_i"});
+  auto merge_x = test::graph::Merge(
+      g, enter(test::graph::Constant(g, V(0.0)), false), {"while/next_x"});
+  auto limit = enter(test::graph::Constant(g, V(10.0)), true);
+  auto cond = test::graph::LoopCond(g, test::graph::Less(g, merge_i, limit));
+  auto sw_i = test::graph::Switch(g, merge_i, cond);
+  auto sw_x = test::graph::Switch(g, merge_x, cond);
+  auto one = enter(test::graph::Constant(g, V(1.0)), true);
+  auto two = enter(test::graph::Constant(g, V(2.0)), true);
+  auto next_i = test::graph::Next(
+      g, "while/next_i",
+      test::graph::Add(g, test::graph::Identity(g, sw_i, 1), one));
+  auto next_x = test::graph::Next(
+      g, "while/next_x",
+      test::graph::Add(g, test::graph::Identity(g, sw_x, 1), two));
+  g->AddEdge(next_i, 0, merge_i, 1);
+  g->AddEdge(next_x, 0, merge_x, 1);
+  test::graph::Send(g, test::graph::Exit(g, sw_i), "i", BOB, 1, ALICE);
+  test::graph::Send(g, test::graph::Exit(g, sw_x), "x", BOB, 1, ALICE);
+  Create(g);
+  for (int step = 0; step < 3; ++step) {
+    TF_ASSERT_OK(Run(rendez_));
+    Rendezvous::Args args;
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "i"), args,
+                               &out, &is_dead));
+    EXPECT_FALSE(is_dead);
+    EXPECT_EQ(10.0, V(out));
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "x"), args,
+                               &out, &is_dead));
+    EXPECT_FALSE(is_dead);
+    EXPECT_EQ(20.0, V(out));
+  }
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   Graph* g = new Graph(OpRegistry::Global());
@@ -410,4 +723,38 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
   rendez->Unref();
 }
 
+// Builds a graph of "depth" layers of "width" NoOp nodes, in which every
+// node has control edges from two nodes of the previous layer, and
+// measures the executor overhead per node.
+static void BM_executor(int iters, int width, int depth) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> layer;
+  for (int i = 0; i < width; ++i) {
+    layer.push_back(test::graph::NoOp(g, {}));
+  }
+  for (int d = 1; d < depth; ++d) {
+    std::vector<Node*> next;
+    for (int i = 0; i < width; ++i) {
+      next.push_back(test::graph::NoOp(g, {layer[i], layer[(i + 1) % width]}));
+    }
+    layer.swap(next);
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * width * depth);
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+// Tall skinny graphs
+BENCHMARK(BM_executor)->ArgPair(16, 1024);
+BENCHMARK(BM_executor)->ArgPair(32, 8192);
+
+// Short fat graphs
+BENCHMARK(BM_executor)->ArgPair(1024, 16);
+BENCHMARK(BM_executor)->ArgPair(8192, 32);
+
+// Tall fat graph
+BENCHMARK(BM_executor)->ArgPair(1024, 1024);
+
 }  // namespace tensorflow
@@ -120,6 +120,9 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
                           const GraphOptions& graph_options,
                           const DebugOptions& debug_options, Item* item) {
   item->session = session;
+  item->recv_tensor_compression = graph_options.recv_tensor_compression();
+  // Each of TF_SYNC_ON_FINISH=0 and pipeline_steps turns the wait off.
+  item->sync_on_finish = sync_on_finish_ && !graph_options.pipeline_steps();
   item->lib_def =
       new FunctionLibraryDefinition(OpRegistry::Global(), gdef.library());
 
@@ -181,6 +184,17 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
   LocalExecutorParams params;
+  if (graph_options.use_work_stealing_executor() &&
+      worker_env_->compute_pool != nullptr) {
+    params.num_work_stealing_workers = worker_env_->compute_pool->NumThreads();
+  }
+  params.inline_kernel_cost_threshold_usecs =
+      graph_options.inline_kernel_cost_threshold_usecs();
+  if (graph_options.kernel_cost_warmup_steps() > 0) {
+    params.kernel_cost_warmup_steps = graph_options.kernel_cost_warmup_steps();
+  }
+  params.inline_synchronous_cpu_graphs =
+      graph_options.inline_synchronous_cpu_graphs();
 
   item->units.reserve(partitions.size());
   item->graph_mgr = this;
@@ -465,6 +479,7 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
   }
 
   RemoteRendezvous* rendezvous = worker_env_->rendezvous_mgr->Find(step_id);
+  rendezvous->SetRecvTensorCompression(item->recv_tensor_compression);
   Status s = rendezvous->Initialize(session);
 
   // Sends values specified by the caller.
@@ -517,7 +532,7 @@ void GraphMgr::StartParallelExecutors(const string& handle, int64 step_id,
   args.cancellation_manager = cancellation_manager;
   args.stats_collector = collector;
   args.step_container = step_container;
-  args.sync_on_finish = sync_on_finish_;
+  args.sync_on_finish = item->sync_on_finish;
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(args.step_id, handle);
   }
@@ -96,6 +96,7 @@ class GraphMgr {
   Status DeregisterAll();
 
  private:
+  friend class TEST_GraphMgrHelper;
   typedef GraphMgr ME;
 
   struct ExecutionUnit {
@@ -126,6 +127,13 @@ class GraphMgr {
     // has a root executor which may call into the runtime library.
     std::vector<ExecutionUnit> units;
 
+    // How the tensors received from remote workers may be compressed.
+    TensorCompressionOptions recv_tensor_compression;
+
+    // If true, each step waits for the devices to finish all queued
+    // operations before it completes.
+    bool sync_on_finish = true;
+
     // Used to deresgister a cost model when cost model is required in graph
     // manager.
     GraphMgr* graph_mgr;
@@ -0,0 +1,85 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/graph_mgr.h"
+
+#include <stdlib.h>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/debug.pb.h"
+
+namespace tensorflow {
+
+class TEST_GraphMgrHelper {
+ public:
+  static bool SyncOnFinish(GraphMgr* graph_mgr, const string& handle) {
+    mutex_lock l(graph_mgr->mu_);
+    return graph_mgr->table_.at(handle)->sync_on_finish;
+  }
+};
+
+namespace {
+
+// Registers an empty graph with "pipeline_steps" on a GraphMgr created
+// with TF_SYNC_ON_FINISH set to "env_value", or unset if it is nullptr,
+// and returns whether its steps wait for the devices.
+bool SyncOnFinish(const char* env_value, bool pipeline_steps) {
+  if (env_value == nullptr) {
+    unsetenv("TF_SYNC_ON_FINISH");
+  } else {
+    setenv("TF_SYNC_ON_FINISH", env_value, 1);
+  }
+  WorkerEnv worker_env;
+  worker_env.env = Env::Default();
+  DeviceMgr device_mgr(std::vector<Device*>{});
+  GraphMgr graph_mgr(&worker_env, &device_mgr);
+  unsetenv("TF_SYNC_ON_FINISH");
+
+  GraphOptions graph_options;
+  graph_options.set_pipeline_steps(pipeline_steps);
+  string handle;
+  TF_CHECK_OK(graph_mgr.Register("session", GraphDef(), graph_options,
+                                 DebugOptions(), &handle));
+  const bool sync_on_finish =
+      TEST_GraphMgrHelper::SyncOnFinish(&graph_mgr, handle);
+  TF_CHECK_OK(graph_mgr.Deregister(handle));
+  return sync_on_finish;
+}
+
+TEST(GraphMgrTest, SyncOnFinishByDefault) {
+  EXPECT_TRUE(SyncOnFinish(nullptr, false));
+  EXPECT_TRUE(SyncOnFinish("1", false));
+}
+
+TEST(GraphMgrTest, PipelineStepsTurnsOffSyncOnFinish) {
+  EXPECT_FALSE(SyncOnFinish(nullptr, true));
+  EXPECT_FALSE(SyncOnFinish("1", true));
+}
+
+TEST(GraphMgrTest, EnvVarTurnsOffSyncOnFinish) {
+  // pipeline_steps = false does not turn the wait back on.
+  EXPECT_FALSE(SyncOnFinish("0", false));
+  EXPECT_FALSE(SyncOnFinish("0", true));
+}
+
+}  // namespace
+}  // namespace tensorflow
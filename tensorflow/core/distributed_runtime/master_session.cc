@@ -429,9 +429,18 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
 }
 
 // Helper class to manage "num" parallel RunGraph calls.
+//
+// If a "process" callback is given, it is run on the response of each call
+// as soon as that call succeeds, on the thread that completed the call, so
+// that handling the responses of the partitions that finish first overlaps
+// with waiting for the others. It is not run once any call has failed.
 class RunManyGraphs {
  public:
-  explicit RunManyGraphs(int num) : calls_(num), pending_(num) {}
+  typedef std::function<Status(int index, MutableRunGraphResponseWrapper*)>
+      ProcessCallback;
+
+  explicit RunManyGraphs(int num, ProcessCallback process = nullptr)
+      : calls_(num), pending_(num), process_(std::move(process)) {}
 
   ~RunManyGraphs() {}
 
@@ -446,9 +455,13 @@ class RunManyGraphs {
   // When the index-th call is done, updates the overall status.
   void WhenDone(int index, const Status& s) {
     TRACEPRINTF("Partition %d %s", index, s.ToString().c_str());
-    if (!s.ok()) {
+    Status status = s;
+    if (status.ok() && process_ && this->status().ok()) {
+      status = process_(index, calls_[index].resp.get());
+    }
+    if (!status.ok()) {
       mutex_lock l(mu_);
-      UpdateStatusLocked(s);
+      UpdateStatusLocked(status);
     }
     pending_.DecrementCount();
   }
@@ -469,6 +482,7 @@ class RunManyGraphs {
   gtl::InlinedVector<Call, 4> calls_;
 
   BlockingCounter pending_;
+  const ProcessCallback process_;
   mutable mutex mu_;
   Status status_ GUARDED_BY(mu_);
 
@@ -518,7 +532,36 @@ Status MasterSession::ReffedClientGraph::RunPartitions(
   }
 
   const int num = partitions_.size();
-  RunManyGraphs calls(num);
+  // Collects the fetches and stats of each partition as soon as its call
+  // completes. The calls complete concurrently, so "resp" is guarded.
+  mutex resp_mu;
+  auto collect_fetches = [this, pss, resp, &resp_mu](
+      int i, MutableRunGraphResponseWrapper* run_graph_resp) {
+    const Part& part = partitions_[i];
+    if (pss->collect_timeline) {
+      pss->step_stats[i].Swap(run_graph_resp->mutable_step_stats());
+    }
+    mutex_lock l(resp_mu);
+    for (size_t j = 0; j < run_graph_resp->num_recvs(); ++j) {
+      auto iter = part.key_fetch.find(run_graph_resp->recv_key(j));
+      if (iter == part.key_fetch.end()) {
+        return errors::Internal("Unexpected fetch key: ",
+                                run_graph_resp->recv_key(j));
+      }
+      const string& fetch = iter->second;
+      TF_RETURN_IF_ERROR(
+          resp->AddTensorFromRunGraphResponse(fetch, run_graph_resp, j));
+    }
+    if (pss->collect_costs) {
+      CostGraphDef* cost_graph = run_graph_resp->mutable_cost_graph();
+      for (int j = 0; j < cost_graph->node_size(); ++j) {
+        resp->mutable_metadata()->mutable_cost_graph()->add_node()->Swap(
+            cost_graph->mutable_node(j));
+      }
+    }
+    return Status::OK();
+  };
+  RunManyGraphs calls(num, collect_fetches);
 
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
@@ -610,38 +653,8 @@ Status MasterSession::ReffedClientGraph::RunPartitions(
     return errors::Cancelled("Step was cancelled");
   }
 
-  // Collects fetches.
-  Status status = calls.status();
-  if (status.ok()) {
-    for (int i = 0; i < num; ++i) {
-      const Part& part = partitions_[i];
-      for (size_t j = 0; j < calls.get(i)->resp->num_recvs(); ++j) {
-        auto iter = part.key_fetch.find(calls.get(i)->resp->recv_key(j));
-        if (iter == part.key_fetch.end()) {
-          status.Update(errors::Internal("Unexpected fetch key: ",
-                                         calls.get(i)->resp->recv_key(j)));
-          break;
-        }
-        const string& fetch = iter->second;
-        status.Update(resp->AddTensorFromRunGraphResponse(
-            fetch, calls.get(i)->resp.get(), j));
-        if (!status.ok()) {
-          break;
-        }
-      }
-      if (pss->collect_timeline) {
-        pss->step_stats[i].Swap(calls.get(i)->resp->mutable_step_stats());
-      }
-      if (pss->collect_costs) {
-        CostGraphDef* cost_graph = calls.get(i)->resp->mutable_cost_graph();
-        for (int j = 0; j < cost_graph->node_size(); ++j) {
-          resp->mutable_metadata()->mutable_cost_graph()->add_node()->Swap(
-              cost_graph->mutable_node(j));
-        }
-      }
-    }
-  }
-  return status;
+  // The fetches were collected as the calls completed.
+  return calls.status();
 }
 
 namespace {
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
@@ -40,6 +41,11 @@ class RemoteRendezvous : public Rendezvous {
  public:
   // Fully construct the RemoteRendezvous.
   virtual Status Initialize(WorkerSession* session) = 0;
+
+  // Sets how the tensors received from remote workers may be compressed.
+  // Must be called before Initialize to apply to all the receives.
+  virtual void SetRecvTensorCompression(
+      const TensorCompressionOptions& options) {}
 };
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
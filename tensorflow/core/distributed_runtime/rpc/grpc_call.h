@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/macros.h"
 
@@ -51,6 +53,11 @@ namespace tensorflow {
 //   `Call` type, in order to access its state, and invoke its
 //   `SendResponse()` method.
 //
+// * `ServerStreamingCall<Service, GrpcService, Req, Resp>`: Like `Call`,
+//   but for a method that returns a stream of response messages. Its
+//   `SendResponses()` method writes the messages one at a time, and then
+//   the status.
+//
 // The lifecycle of a call object is as follows.
 //
 // 1. A `Service` creates a `Call` for a particular method and
@@ -94,13 +101,22 @@ class UntypedCall : public core::RefCounted {
   // the `grpc::ServerContext` associated with the request.
   virtual void RequestCancelled(Service* service, bool ok) = 0;
 
+  // This method is called when one of the messages of a streamed response
+  // has been written. Only streaming calls write such messages.
+  virtual void ResponseWritten(bool ok) {}
+
   // Associates a tag in a `::grpc::CompletionQueue` with a callback
   // for an incoming RPC.  An active Tag owns a reference on the corresponding
   // Call object.
   class Tag {
    public:
     // One enum value per supported callback.
-    enum Callback { kRequestReceived, kResponseSent, kCancelled };
+    enum Callback {
+      kRequestReceived,
+      kResponseWritten,
+      kResponseSent,
+      kCancelled
+    };
 
     Tag(UntypedCall* call, Callback cb) : call_(call), callback_(cb) {}
 
@@ -112,6 +128,9 @@ class UntypedCall : public core::RefCounted {
         case kRequestReceived:
           call_->RequestReceived(service, ok);
           break;
+        case kResponseWritten:
+          call_->ResponseWritten(ok);
+          break;
         case kResponseSent:
           // No special handling needed apart from the Unref below.
           break;
@@ -199,6 +218,7 @@ class Call : public UntypedCall<Service> {
                              bool supports_cancel) {
     auto call = new Call<Service, GrpcService, RequestMessage, ResponseMessage>(
         handle_request_function);
+    call->cq_ = cq;
     if (supports_cancel) {
       call->RegisterCancellationHandler();
     }
@@ -220,6 +240,7 @@ class Call : public UntypedCall<Service> {
       bool supports_cancel) {
     auto call = new Call<Service, GrpcService, RequestMessage, ResponseMessage>(
         handle_request_function);
+    call->cq_ = cq;
     if (supports_cancel) {
       call->RegisterCancellationHandler();
     }
@@ -238,6 +259,9 @@ class Call : public UntypedCall<Service> {
     return ctx_.client_metadata();
   }
 
+  // Returns the completion queue on which this call was enqueued.
+  ::grpc::ServerCompletionQueue* cq() const { return cq_; }
+
  private:
   // Creates a completion queue tag for handling cancellation by the client.
   // NOTE: This method must be called before this call is enqueued on a
@@ -248,6 +272,7 @@ class Call : public UntypedCall<Service> {
   }
 
   HandleRequestFunction handle_request_function_;
+  ::grpc::ServerCompletionQueue* cq_ = nullptr;  // Not owned.
   ::grpc::ServerContext ctx_;
   ::grpc::ServerAsyncResponseWriter<ResponseMessage> responder_;
 
@@ -262,6 +287,140 @@ class Call : public UntypedCall<Service> {
   std::function<void()> cancel_callback_ GUARDED_BY(mu_);
 };
 
+// Represents a pending call of a server-streaming method, whose response
+// is any number of messages followed by a status.
+template <class Service, class GrpcService, class RequestMessage,
+          class ResponseMessage>
+class ServerStreamingCall : public UntypedCall<Service> {
+ public:
+  // Represents the generic signature of a `Service::HandleFoo()`
+  // method, where `Foo` is the name of an RPC method.
+  using HandleRequestFunction = void (Service::*)(
+      ServerStreamingCall<Service, GrpcService, RequestMessage,
+                          ResponseMessage>*);
+
+  ServerStreamingCall(HandleRequestFunction handle_request_function)
+      : handle_request_function_(handle_request_function), writer_(&ctx_) {}
+
+  virtual ~ServerStreamingCall() {}
+
+  void RequestReceived(Service* service, bool ok) override {
+    if (ok) {
+      this->Ref();
+      (service->*handle_request_function_)(this);
+    }
+  }
+
+  // Writes each of `responses`, once the previous one has been written,
+  // and then `status`. The responses are dropped if `status` is not OK.
+  void SendResponses(std::vector<ResponseMessage> responses,
+                     ::grpc::Status status) {
+    {
+      mutex_lock l(mu_);
+      responses_ = std::move(responses);
+      status_ = status;
+      if (!status_.ok()) {
+        responses_.clear();
+      }
+    }
+    WriteNext(true);
+    this->Unref();
+  }
+
+  void ResponseWritten(bool ok) override { WriteNext(ok); }
+
+  void RequestCancelled(Service* service, bool ok) override {
+    if (ctx_.IsCancelled()) {
+      mutex_lock l(mu_);
+      if (cancel_callback_) {
+        cancel_callback_();
+      }
+    }
+  }
+
+  // Registers `callback` as the function that should be called if and when this
+  // call is canceled by the client.
+  void SetCancelCallback(std::function<void()> callback) {
+    mutex_lock l(mu_);
+    cancel_callback_ = std::move(callback);
+  }
+
+  // Clears any cancellation callback that has been registered for this call.
+  void ClearCancelCallback() {
+    mutex_lock l(mu_);
+    cancel_callback_ = nullptr;
+  }
+
+  // Enqueues a new request for the given service on the given
+  // completion queue, using the given `method_id`.
+  //
+  // The request will be handled with the given
+  // `handle_request_function`.
+  static void EnqueueRequestForMethod(
+      GrpcService* grpc_service, ::grpc::ServerCompletionQueue* cq,
+      int method_id, HandleRequestFunction handle_request_function,
+      bool supports_cancel) {
+    auto call = new ServerStreamingCall<Service, GrpcService, RequestMessage,
+                                        ResponseMessage>(
+        handle_request_function);
+    call->cq_ = cq;
+    if (supports_cancel) {
+      call->RegisterCancellationHandler();
+    }
+
+    // Initial ref for call handed to grpc; released in Tag callback.
+    grpc_service->RequestAsyncServerStreaming(
+        method_id, &call->ctx_, &call->request, &call->writer_, cq, cq,
+        &call->request_received_tag_);
+  }
+
+  RequestMessage request;
+
+  // Returns the completion queue on which this call was enqueued.
+  ::grpc::ServerCompletionQueue* cq() const { return cq_; }
+
+ private:
+  // Creates a completion queue tag for handling cancellation by the client.
+  // NOTE: This method must be called before this call is enqueued on a
+  // completion queue.
+  void RegisterCancellationHandler() {
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    ctx_.AsyncNotifyWhenDone(&cancelled_tag_);
+  }
+
+  // Writes the next response, or the status once all the responses have
+  // been written or a write has failed.
+  void WriteNext(bool ok) {
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    mutex_lock l(mu_);
+    if (ok && next_response_ < responses_.size()) {
+      writer_.Write(responses_[next_response_++], &response_written_tag_);
+    } else {
+      responses_.clear();
+      writer_.Finish(status_, &response_sent_tag_);
+    }
+  }
+
+  HandleRequestFunction handle_request_function_;
+  ::grpc::ServerCompletionQueue* cq_ = nullptr;  // Not owned.
+  ::grpc::ServerContext ctx_;
+  ::grpc::ServerAsyncWriter<ResponseMessage> writer_;
+
+  // Used as void* completion markers from grpc to indicate different
+  // events of interest for a ServerStreamingCall.
+  typedef typename UntypedCall<Service>::Tag Tag;
+  Tag request_received_tag_{this, Tag::kRequestReceived};
+  Tag response_written_tag_{this, Tag::kResponseWritten};
+  Tag response_sent_tag_{this, Tag::kResponseSent};
+  Tag cancelled_tag_{this, Tag::kCancelled};
+
+  mutex mu_;
+  std::function<void()> cancel_callback_ GUARDED_BY(mu_);
+  std::vector<ResponseMessage> responses_ GUARDED_BY(mu_);
+  size_t next_response_ GUARDED_BY(mu_) = 0;
+  ::grpc::Status status_ GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
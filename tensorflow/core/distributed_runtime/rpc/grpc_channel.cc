@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <unordered_map>
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -53,6 +56,21 @@ Status ValidateHostPortPair(const string& host_port) {
   }
   return Status::OK();
 }
+
+// Returns the number of channels that the GrpcChannelCache keeps for each
+// target, as set by the TF_GRPC_CHANNELS_PER_TARGET environment variable.
+int ChannelsPerTarget() {
+  static const int channels_per_target = [] {
+    int64 n;
+    Status s = ReadInt64FromEnvVar("TF_GRPC_CHANNELS_PER_TARGET", 1, &n);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+      return 1;
+    }
+    return static_cast<int>(std::max<int64>(1, n));
+  }();
+  return channels_per_target;
+}
 }  // namespace
 
 Status NewHostPortGrpcChannel(const string& target,
@@ -66,6 +84,14 @@ Status NewHostPortGrpcChannel(const string& target,
   // NOTE(mrry): Some versions of gRPC use a 20-second minimum backoff
   // on connection failure, which makes our tests time out.
   args.SetInt("grpc.testing.fixed_reconnect_backoff_ms", 1000);
+  if (ChannelsPerTarget() > 1) {
+    // gRPC shares a connection between the channels to a target that have
+    // the same arguments, so make the arguments of each channel unique for
+    // the channels of a pool to use separate connections.
+    static std::atomic<int64> next_channel_id(0);
+    args.SetInt("tensorflow.grpc_channel_id",
+                static_cast<int>(next_channel_id.fetch_add(1)));
+  }
   *channel_pointer = ::grpc::CreateCustomChannel(
       "dns:///" + target, ::grpc::InsecureChannelCredentials(), args);
   return Status::OK();
@@ -109,47 +135,70 @@ Status GrpcChannelSpec::AddHostPortsJob(
 namespace {
 
 // GrpcChannelCache that caches results to FindWorkerChannel() calls.
+//
+// If "channels_per_target" is greater than 1, the cache keeps a pool of
+// that many channels for each target, and FindWorkerChannel() returns them
+// in turn, so that the RPCs to a target are spread over several
+// connections instead of all sharing one.
 class CachingGrpcChannelCache : public GrpcChannelCache {
  public:
-  CachingGrpcChannelCache() {}
+  explicit CachingGrpcChannelCache(int channels_per_target)
+      : channels_per_target_(channels_per_target) {}
 
   ~CachingGrpcChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
-    SharedGrpcChannelPtr ch = nullptr;
     {
       mutex_lock l(mu_);  // could use reader lock
-      ch = gtl::FindPtrOrNull(channels_, target);
-      if (ch) {
-        return ch;
+      ChannelPool* pool = gtl::FindOrNull(channels_, target);
+      if (pool != nullptr) {
+        return pool->channels[pool->next++ % pool->channels.size()];
       }
     }
-    ch = FindChannelOnce(target);
-    if (ch) {
-      mutex_lock l(mu_);
-      channels_.insert({target, ch});
+    ChannelPool pool;
+    for (int i = 0; i < channels_per_target_; ++i) {
+      SharedGrpcChannelPtr ch = FindChannelOnce(target);
+      if (!ch) {
+        return nullptr;
+      }
+      pool.channels.push_back(std::move(ch));
     }
-    return ch;
+    mutex_lock l(mu_);
+    auto it = channels_.insert({target, std::move(pool)}).first;
+    return it->second.channels[it->second.next++ %
+                               it->second.channels.size()];
   }
 
  protected:
   // Find the ClientChannel for "target".  Only called when no channel was
-  // found in the channels_ cache for "target".  A non nullptr result will be
-  // cached in channels_.
+  // found in the channels_ cache for "target", once for each channel of
+  // its pool.  The channels are cached in channels_ if they are all non
+  // nullptr.
   virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
 
  private:
+  struct ChannelPool {
+    std::vector<SharedGrpcChannelPtr> channels;
+    uint64 next = 0;
+  };
+
+  const int channels_per_target_;
+
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
-  std::unordered_map<string, SharedGrpcChannelPtr> channels_ GUARDED_BY(mu_);
+  std::unordered_map<string, ChannelPool> channels_ GUARDED_BY(mu_);
 };
 
 // A ChannelCache that is the union of multiple ChannelCaches.
 // Takes ownership of the caches passed to the constructor.
+//
+// "channels_per_target" must match the caches passed to the constructor,
+// so that this cache takes their whole pools.
 class MultiGrpcChannelCache : public CachingGrpcChannelCache {
  public:
-  explicit MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches)
-      : CachingGrpcChannelCache(), caches_(caches) {}
+  MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches,
+                        int channels_per_target)
+      : CachingGrpcChannelCache(channels_per_target), caches_(caches) {}
 
   ~MultiGrpcChannelCache() override {
     for (GrpcChannelCache* cache : caches_) {
@@ -208,8 +257,10 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
  public:
   SparseGrpcChannelCache(const string& job_id,
                          const std::map<int, string>& host_ports,
-                         ChannelCreationFunction channel_func)
-      : job_id_(job_id),
+                         ChannelCreationFunction channel_func,
+                         int channels_per_target)
+      : CachingGrpcChannelCache(channels_per_target),
+        job_id_(job_id),
         host_ports_(host_ports),
         channel_func_(std::move(channel_func)) {
     LOG(INFO) << "Initialize GrpcChannelCache for job " << ToString();
@@ -278,6 +329,14 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
 
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
                                       ChannelCreationFunction channel_func) {
+  return NewGrpcChannelCache(spec, std::move(channel_func),
+                             ChannelsPerTarget());
+}
+
+GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
+                                      ChannelCreationFunction channel_func,
+                                      int channels_per_target) {
+  CHECK_GE(channels_per_target, 1);
   const int num_jobs = spec.host_ports_jobs().size();
   if (!num_jobs) {
     LOG(ERROR) << "Empty channel spec.";
@@ -286,10 +345,12 @@ GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
   std::vector<GrpcChannelCache*> caches;
   caches.reserve(num_jobs);
   for (auto& job : spec.host_ports_jobs()) {
-    caches.push_back(
-        new SparseGrpcChannelCache(job.job_id, job.host_ports, channel_func));
+    caches.push_back(new SparseGrpcChannelCache(
+        job.job_id, job.host_ports, channel_func, channels_per_target));
   }
-  return caches.size() == 1 ? caches[0] : new MultiGrpcChannelCache(caches);
+  return caches.size() == 1
+             ? caches[0]
+             : new MultiGrpcChannelCache(caches, channels_per_target);
 }
 
 }  // end namespace tensorflow
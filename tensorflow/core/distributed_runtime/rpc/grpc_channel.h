@@ -79,9 +79,19 @@ class GrpcChannelCache {
 
 typedef std::function<SharedGrpcChannelPtr(string)> ChannelCreationFunction;
 
+// Returns a GrpcChannelCache that keeps the number of channels to each
+// target given by the TF_GRPC_CHANNELS_PER_TARGET environment variable
+// (1 by default).
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& channel_spec,
                                       ChannelCreationFunction channel_func);
 
+// Returns a GrpcChannelCache that keeps a pool of "channels_per_target"
+// channels to each target, created by "channel_func", and hands them out in
+// turn. "channels_per_target" must be at least 1.
+GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& channel_spec,
+                                      ChannelCreationFunction channel_func,
+                                      int channels_per_target);
+
 // Below here are internal-only functions.
 
 ChannelCreationFunction ConvertToChannelCreationFunction(
@@ -98,6 +98,34 @@ TEST(GrpcChannelTest, HostPorts) {
             workers);
 }
 
+TEST(GrpcChannelTest, ChannelPools) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {"a:1", "b:2", "c:3"}));
+  TF_EXPECT_OK(spec.AddHostPortsJob("ps", {"d:4"}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, 3));
+
+  EXPECT_EQ(nullptr, cc->FindWorkerChannel("/job:mnist/replica:0/task:3"));
+
+  for (const string& target :
+       {"/job:mnist/replica:0/task:0", "/job:ps/replica:0/task:0"}) {
+    // The channels of the pool are returned in turn.
+    std::vector<SharedGrpcChannelPtr> channels;
+    for (int i = 0; i < 6; ++i) {
+      channels.push_back(cc->FindWorkerChannel(target));
+      ASSERT_NE(nullptr, channels.back());
+    }
+    EXPECT_NE(channels[0].get(), channels[1].get());
+    EXPECT_NE(channels[0].get(), channels[2].get());
+    EXPECT_NE(channels[1].get(), channels[2].get());
+    EXPECT_EQ(channels[0].get(), channels[3].get());
+    EXPECT_EQ(channels[1].get(), channels[4].get());
+    EXPECT_EQ(channels[2].get(), channels[5].get());
+  }
+}
+
 TEST(GrpcChannelTest, SparseHostPorts) {
   GrpcChannelSpec spec;
   TF_EXPECT_OK(
@@ -23,6 +23,7 @@ limitations under the License.
 #include "grpc++/impl/codegen/rpc_service_method.h"
 #include "grpc++/impl/codegen/service_type.h"
 #include "grpc++/impl/codegen/sync_stream.h"
+#include "grpc++/support/byte_buffer.h"
 
 namespace tensorflow {
 
@@ -91,6 +92,13 @@ MasterService::Stub::Stub(
                                    request, response);
 }
 
+::grpc::Status MasterService::Stub::RunStep(::grpc::ClientContext* context,
+                                            const ::grpc::ByteBuffer& request,
+                                            RunStepResponse* response) {
+  return ::grpc::BlockingUnaryCall(channel_.get(), rpcmethod_RunStep_, context,
+                                   request, response);
+}
+
 ::grpc::Status MasterService::Stub::CloseSession(
     ::grpc::ClientContext* context, const CloseSessionRequest& request,
     CloseSessionResponse* response) {
@@ -38,6 +38,7 @@ TF_GRPC_ALLOW_UNLIMITED_MESSAGE_SIZE(tensorflow::RunStepRequest);
 TF_GRPC_ALLOW_UNLIMITED_MESSAGE_SIZE(tensorflow::RunStepResponse);
 
 namespace grpc {
+class ByteBuffer;
 class CompletionQueue;
 class Channel;
 class RpcService;
@@ -95,6 +96,11 @@ class MasterService GRPC_FINAL {
     ::grpc::Status RunStep(::grpc::ClientContext* context,
                            const RunStepRequest& request,
                            RunStepResponse* response) GRPC_OVERRIDE;
+    // As above, with the request already encoded, e.g. by
+    // EncodeRunStepRequestToByteBuffer().
+    ::grpc::Status RunStep(::grpc::ClientContext* context,
+                           const ::grpc::ByteBuffer& request,
+                           RunStepResponse* response);
     ::grpc::Status CloseSession(::grpc::ClientContext* context,
                                 const CloseSessionRequest& request,
                                 CloseSessionResponse* response) GRPC_OVERRIDE;
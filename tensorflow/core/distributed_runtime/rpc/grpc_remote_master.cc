@@ -17,9 +17,12 @@ limitations under the License.
 
 #include <utility>
 
+#include "grpc++/support/byte_buffer.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/master_interface.h"
+#include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_master_service_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -65,13 +68,21 @@ class GrpcRemoteMaster : public MasterInterface {
     return FromGrpcStatus(stub_->PartialRunSetup(&ctx, *request, response));
   }
 
+  // Keeps the feeds as Tensors, so that RunStep() can encode their contents
+  // without copying them into a RunStepRequest first.
+  MutableRunStepRequestWrapper* CreateRunStepRequest() override {
+    return new InMemoryRunStepRequest;
+  }
+
   Status RunStep(CallOptions* call_options, RunStepRequestWrapper* request,
                  MutableRunStepResponseWrapper* response) override {
     ::grpc::ClientContext ctx;
     auto trace = TraceRpc("RunStep/Client", &ctx);
     ctx.set_fail_fast(false);
     SetDeadline(&ctx, call_options->GetTimeout());
-    return FromGrpcStatus(stub_->RunStep(&ctx, request->ToProto(),
+    ::grpc::ByteBuffer request_buffer;
+    grpc::EncodeRunStepRequestToByteBuffer(*request, &request_buffer);
+    return FromGrpcStatus(stub_->RunStep(&ctx, request_buffer,
                                          get_proto_from_wrapper(response)));
   }
 
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "grpc++/grpc++.h"
 
@@ -30,11 +32,98 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/grpc_response_reader.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// A ZeroCopyInputStream over the slices of a received ::grpc::ByteBuffer.
+class SliceInputStream : public protobuf::io::ZeroCopyInputStream {
+ public:
+  explicit SliceInputStream(const std::vector<::grpc::Slice>* slices)
+      : slices_(slices) {}
+
+  bool Next(const void** data, int* size) override {
+    while (index_ < slices_->size() && offset_ == (*slices_)[index_].size()) {
+      ++index_;
+      offset_ = 0;
+    }
+    if (index_ == slices_->size()) return false;
+    const ::grpc::Slice& slice = (*slices_)[index_];
+    *data = slice.begin() + offset_;
+    *size = slice.size() - offset_;
+    byte_count_ += *size;
+    offset_ = slice.size();
+    return true;
+  }
+
+  void BackUp(int count) override {
+    offset_ -= count;
+    byte_count_ -= count;
+  }
+
+  bool Skip(int count) override {
+    while (count > 0) {
+      if (index_ == slices_->size()) return false;
+      const size_t n = std::min((*slices_)[index_].size() - offset_,
+                                static_cast<size_t>(count));
+      if (n == 0) {
+        ++index_;
+        offset_ = 0;
+        continue;
+      }
+      offset_ += n;
+      byte_count_ += n;
+      count -= n;
+    }
+    return true;
+  }
+
+  protobuf_int64 ByteCount() const override { return byte_count_; }
+
+ private:
+  const std::vector<::grpc::Slice>* const slices_;  // not owned.
+  size_t index_ = 0;
+  size_t offset_ = 0;
+  protobuf_int64 byte_count_ = 0;
+};
+
+// A Source reading the slices of a received ::grpc::ByteBuffer.
+class SliceSource : public TensorResponse::Source {
+ public:
+  explicit SliceSource(const std::vector<::grpc::Slice>* slices)
+      : slices_(slices) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.reset(new SliceInputStream(slices_));
+    return stream_.get();
+  }
+
+ private:
+  const std::vector<::grpc::Slice>* const slices_;  // not owned.
+  std::unique_ptr<SliceInputStream> stream_;
+};
+
+// Returns true if RecvTensor calls whose tensor is received in host memory
+// should use the RecvTensorStream method, which lets the content of a large
+// tensor be copied chunk by chunk as it arrives.
+bool UseRecvTensorStream() {
+  static bool use_stream = []() {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GRPC_RECV_TENSOR_STREAM", false, &value));
+    return value;
+  }();
+  return use_stream;
+}
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -52,6 +141,12 @@ class GrpcRemoteWorker : public WorkerInterface {
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
+        recvtensorstream_(GrpcWorkerMethodName(
+                              GrpcWorkerMethod::kRecvTensorStream),
+                          ::grpc::RpcMethod::SERVER_STREAMING, channel_),
+        recvtensorbatch_(GrpcWorkerMethodName(
+                             GrpcWorkerMethod::kRecvTensorBatch),
+                         ::grpc::RpcMethod::SERVER_STREAMING, channel_),
         logger_(logger) {}
 
   ~GrpcRemoteWorker() override {}
@@ -130,40 +225,7 @@ class GrpcRemoteWorker : public WorkerInterface {
       wrapper_done = [this, request, req_copy, response, done,
                       start_usec](Status s) {
         if (logger_->LoggingActive()) {
-          int64 end_usec = Env::Default()->NowMicros();
-          int64 step_id = request->step_id();
-          int64 bytes = response->tensor().TotalBytes();
-          int64 send_start_usec = start_usec;
-          // If a send start time was reported by the other side, use
-          // that instead.  Maybe we should mark the display if we're using
-          // our local time instead of the remote start time?
-          if (response->metadata().send_start_micros()) {
-            // send_start_micros is the timestamp taken when the
-            // remote machine began to send the RecvTensor response.
-            // Due to clock skew between source and dest machines, it
-            // is possible that send_start_micros can be larger than
-            // end_usec or less than start_usec.
-            //
-            // To respect causality, we enforce the invariants that
-            // the RecvTensor response can not have been sent before
-            // the RecvTensor request, and must have been sent before
-            // it was received.
-            send_start_usec = std::max(
-                start_usec,
-                static_cast<int64>(response->metadata().send_start_micros()));
-            send_start_usec = std::min(send_start_usec, end_usec - 1);
-          }
-          const string& key = request->rendezvous_key();
-          std::vector<string> key_parts = str_util::Split(key, ';');
-          if (key_parts.size() != 5) {
-            LOG(WARNING) << "Bad key: " << key;
-          } else {
-            logger_->RecordRecvTensor(step_id, send_start_usec, end_usec,
-                                      key_parts[3],  // tensor name
-                                      key_parts[0],  // src_device
-                                      key_parts[2],  // dst_device
-                                      bytes);
-          }
+          LogRecvTensor(*request, *response, start_usec);
         }
         VLOG(2) << "done callback, req: " << request->DebugString()
                 << " response " << response->metadata().DebugString();
@@ -173,10 +235,45 @@ class GrpcRemoteWorker : public WorkerInterface {
       cb_to_use = &wrapper_done;
     }
 
+    if (response->on_host() && UseRecvTensorStream()) {
+      new RecvTensorStreamState(channel_.get(), cq_, recvtensorstream_,
+                                req_copy ? *req_copy : *request, response,
+                                *cb_to_use, call_opts);
+      return;
+    }
     IssueRequest(req_copy ? req_copy : request, response, recvtensor_,
                  *cb_to_use, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            const std::vector<TensorResponse*>& responses,
+                            StatusCallback done) override {
+    CHECK_EQ(request->request_size(), responses.size());
+    int64 start_usec = Env::Default()->NowMicros();
+    // Don't propagate dma_ok over gRPC.
+    RecvTensorBatchRequest req_copy(*request);
+    for (RecvTensorRequest& r : *req_copy.mutable_request()) {
+      r.set_dma_ok(false);
+    }
+    StatusCallback wrapper_done;
+    if (!logger_->LoggingActive()) {
+      wrapper_done = std::move(done);
+    } else {
+      wrapper_done = [this, request, responses, start_usec,
+                      done](const Status& s) {
+        if (s.ok() && logger_->LoggingActive()) {
+          for (size_t i = 0; i < responses.size(); ++i) {
+            LogRecvTensor(request->request(i), *responses[i], start_usec);
+          }
+        }
+        done(s);
+      };
+    }
+    new RecvTensorBatchState(channel_.get(), cq_, recvtensorbatch_, req_copy,
+                             responses, std::move(wrapper_done), call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -188,6 +285,45 @@ class GrpcRemoteWorker : public WorkerInterface {
   }
 
  private:
+  // Records the transfer of "response", requested at "start_usec".
+  void LogRecvTensor(const RecvTensorRequest& request,
+                     const TensorResponse& response, int64 start_usec) {
+    int64 end_usec = Env::Default()->NowMicros();
+    int64 step_id = request.step_id();
+    int64 bytes = response.tensor().TotalBytes();
+    int64 send_start_usec = start_usec;
+    // If a send start time was reported by the other side, use
+    // that instead.  Maybe we should mark the display if we're using
+    // our local time instead of the remote start time?
+    if (response.metadata().send_start_micros()) {
+      // send_start_micros is the timestamp taken when the
+      // remote machine began to send the RecvTensor response.
+      // Due to clock skew between source and dest machines, it
+      // is possible that send_start_micros can be larger than
+      // end_usec or less than start_usec.
+      //
+      // To respect causality, we enforce the invariants that
+      // the RecvTensor response can not have been sent before
+      // the RecvTensor request, and must have been sent before
+      // it was received.
+      send_start_usec = std::max(
+          start_usec,
+          static_cast<int64>(response.metadata().send_start_micros()));
+      send_start_usec = std::min(send_start_usec, end_usec - 1);
+    }
+    const string& key = request.rendezvous_key();
+    std::vector<string> key_parts = str_util::Split(key, ';');
+    if (key_parts.size() != 5) {
+      LOG(WARNING) << "Bad key: " << key;
+    } else {
+      logger_->RecordRecvTensor(step_id, send_start_usec, end_usec,
+                                key_parts[3],  // tensor name
+                                key_parts[0],  // src_device
+                                key_parts[2],  // dst_device
+                                bytes);
+    }
+  }
+
   // Object allocated per active RPC.
   template <class RequestMessage, class ResponseMessage>
   class RPCState final : public GrpcClientCQTag {
@@ -236,6 +372,209 @@ class GrpcRemoteWorker : public WorkerInterface {
     }
   };
 
+  // Object allocated per active RecvTensorStream RPC. The first message of
+  // the stream is parsed into the TensorResponse, and the chunks of tensor
+  // content that may follow are copied into its tensor as they arrive.
+  class RecvTensorStreamState final : public GrpcClientCQTag {
+   public:
+    RecvTensorStreamState(::grpc::ChannelInterface* channel,
+                          ::grpc::CompletionQueue* cq,
+                          const ::grpc::RpcMethod& method,
+                          const RecvTensorRequest& request,
+                          TensorResponse* response, StatusCallback done,
+                          CallOptions* call_opts)
+        : call_opts_(call_opts), response_(response), done_(std::move(done)) {
+      // The call may complete its start on another thread before reader_
+      // is set.
+      mutex_lock l(mu_);
+      reader_.reset(CreateClientAsyncReader<::grpc::ByteBuffer>(
+          channel, cq, method, InitContext(call_opts), request, this));
+    }
+
+    ~RecvTensorStreamState() override {}
+
+    void OnCompleted(bool ok) override {
+      {
+        mutex_lock l(mu_);
+        if (state_ != kFinishing) {
+          if (ok && state_ == kReading) {
+            ReceivedMessage();
+          }
+          if (ok) {
+            state_ = kReading;
+            reader_->Read(&buffer_, this);
+          } else {
+            // The stream has ended, or the call has failed.
+            state_ = kFinishing;
+            reader_->Finish(&status_, this);
+          }
+          return;
+        }
+      }
+      if (call_opts_) {
+        call_opts_->ClearCancelCallback();
+      }
+      Status s = parse_status_;
+      if (s.ok()) {
+        s = FromGrpcStatus(status_);
+      }
+      if (s.ok() && (num_messages_ == 0 ||
+                     (response_->metadata().tensor_content_streamed() &&
+                      !response_->StreamedContentComplete()))) {
+        s = errors::Internal("Incomplete RecvTensorStream response");
+      }
+      done_(s);
+      delete this;
+    }
+
+   private:
+    enum State { kStarting, kReading, kFinishing };
+
+    void ReceivedMessage() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<::grpc::Slice> slices;
+      if (parse_status_.ok() && !buffer_.Dump(&slices).ok()) {
+        parse_status_ =
+            errors::Internal("Cannot read RecvTensorStream message");
+      }
+      if (!parse_status_.ok()) {
+        // Drain the rest of the stream.
+      } else if (num_messages_ == 0) {
+        SliceSource source(&slices);
+        parse_status_ = response_->ParseFrom(&source);
+      } else {
+        for (const ::grpc::Slice& slice : slices) {
+          parse_status_ = response_->AppendStreamedContent(StringPiece(
+              reinterpret_cast<const char*>(slice.begin()), slice.size()));
+          if (!parse_status_.ok()) break;
+        }
+      }
+      ++num_messages_;
+      buffer_.Clear();
+      if (!parse_status_.ok()) {
+        context_.TryCancel();
+      }
+    }
+
+    ::grpc::ClientContext* InitContext(CallOptions* call_opts) {
+      context_.set_fail_fast(false);
+      if (call_opts) {
+        call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+      }
+      return &context_;
+    }
+
+    CallOptions* call_opts_;
+    TensorResponse* const response_;  // not owned.
+    StatusCallback done_;
+    ::grpc::ClientContext context_;
+
+    mutex mu_;
+    std::unique_ptr<::grpc::ClientAsyncReader<::grpc::ByteBuffer>> reader_
+        GUARDED_BY(mu_);
+    State state_ GUARDED_BY(mu_) = kStarting;
+    ::grpc::ByteBuffer buffer_ GUARDED_BY(mu_);
+    int num_messages_ = 0;
+    Status parse_status_;
+    ::grpc::Status status_;
+  };
+
+  // Object allocated per active RecvTensorBatch RPC. The i-th message of
+  // the stream is parsed into the i-th TensorResponse.
+  class RecvTensorBatchState final : public GrpcClientCQTag {
+   public:
+    RecvTensorBatchState(::grpc::ChannelInterface* channel,
+                         ::grpc::CompletionQueue* cq,
+                         const ::grpc::RpcMethod& method,
+                         const RecvTensorBatchRequest& request,
+                         const std::vector<TensorResponse*>& responses,
+                         StatusCallback done, CallOptions* call_opts)
+        : call_opts_(call_opts), responses_(responses), done_(std::move(done)) {
+      // The call may complete its start on another thread before reader_
+      // is set.
+      mutex_lock l(mu_);
+      reader_.reset(CreateClientAsyncReader<::grpc::ByteBuffer>(
+          channel, cq, method, InitContext(call_opts), request, this));
+    }
+
+    ~RecvTensorBatchState() override {}
+
+    void OnCompleted(bool ok) override {
+      {
+        mutex_lock l(mu_);
+        if (state_ != kFinishing) {
+          if (ok && state_ == kReading) {
+            ReceivedMessage();
+          }
+          if (ok) {
+            state_ = kReading;
+            reader_->Read(&buffer_, this);
+          } else {
+            state_ = kFinishing;
+            reader_->Finish(&status_, this);
+          }
+          return;
+        }
+      }
+      if (call_opts_) {
+        call_opts_->ClearCancelCallback();
+      }
+      Status s = parse_status_;
+      if (s.ok()) {
+        s = FromGrpcStatus(status_);
+      }
+      if (s.ok() && num_messages_ != responses_.size()) {
+        s = errors::Internal("Received ", num_messages_, " responses to ",
+                             responses_.size(), " RecvTensorBatch requests");
+      }
+      done_(s);
+      delete this;
+    }
+
+   private:
+    enum State { kStarting, kReading, kFinishing };
+
+    void ReceivedMessage() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<::grpc::Slice> slices;
+      if (parse_status_.ok() && num_messages_ >= responses_.size()) {
+        parse_status_ = errors::Internal("Too many RecvTensorBatch responses");
+      }
+      if (parse_status_.ok() && !buffer_.Dump(&slices).ok()) {
+        parse_status_ = errors::Internal("Cannot read RecvTensorBatch message");
+      }
+      if (parse_status_.ok()) {
+        SliceSource source(&slices);
+        parse_status_ = responses_[num_messages_]->ParseFrom(&source);
+      }
+      ++num_messages_;
+      buffer_.Clear();
+      if (!parse_status_.ok()) {
+        context_.TryCancel();
+      }
+    }
+
+    ::grpc::ClientContext* InitContext(CallOptions* call_opts) {
+      context_.set_fail_fast(false);
+      if (call_opts) {
+        call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+      }
+      return &context_;
+    }
+
+    CallOptions* call_opts_;
+    const std::vector<TensorResponse*> responses_;  // not owned.
+    StatusCallback done_;
+    ::grpc::ClientContext context_;
+
+    mutex mu_;
+    std::unique_ptr<::grpc::ClientAsyncReader<::grpc::ByteBuffer>> reader_
+        GUARDED_BY(mu_);
+    State state_ GUARDED_BY(mu_) = kStarting;
+    ::grpc::ByteBuffer buffer_ GUARDED_BY(mu_);
+    size_t num_messages_ = 0;
+    Status parse_status_;
+    ::grpc::Status status_;
+  };
+
   // Utility method for issuing a generic asynchronous request. The
   // given callback, `done`, will be called when the RPC completes.
   template <class RequestMessage, class ResponseMessage>
@@ -266,6 +605,8 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::RpcMethod recvtensor_;
   const ::grpc::RpcMethod logging_;
   const ::grpc::RpcMethod tracing_;
+  const ::grpc::RpcMethod recvtensorstream_;
+  const ::grpc::RpcMethod recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -150,6 +150,10 @@ class GrpcBufferReader GRPC_FINAL
     return byte_count_ - backup_count_;
   }
 
+  // Returns the slice holding the data last returned by Next(). The slice
+  // is not referenced by the reader.
+  const gpr_slice& current_slice() const { return slice_; }
+
  private:
   int64_t byte_count_;
   int64_t backup_count_;
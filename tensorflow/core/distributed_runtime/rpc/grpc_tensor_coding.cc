@@ -14,9 +14,14 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+
+#include <algorithm>
+
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -24,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/master.pb.h"
+#include "tensorflow/core/protobuf/named_tensor.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -265,5 +272,162 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+bool EncodeCompressedTensorToByteBuffer(bool is_dead, const Tensor& val,
+                                        const TensorCompressionOptions& options,
+                                        const string& residual_key,
+                                        ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  if (is_dead ||
+      !CompressTensorToResponse(options, val, residual_key, &response)) {
+    return false;
+  }
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+  return true;
+}
+
+void EncodeTensorToByteBuffers(bool is_dead, const Tensor& val,
+                               int64 chunk_bytes,
+                               std::vector<::grpc::ByteBuffer>* result) {
+  StringPiece tdata = val.tensor_data();
+  if (is_dead || !DataTypeCanUseMemcpy(val.dtype()) ||
+      tdata.size() <= static_cast<size_t>(chunk_bytes)) {
+    result->emplace_back();
+    EncodeTensorToByteBuffer(is_dead, val, &result->back());
+    return;
+  }
+
+  RecvTensorResponse response;
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.set_tensor_content_streamed(true);
+  response.mutable_tensor()->set_dtype(val.dtype());
+  val.shape().AsProto(response.mutable_tensor()->mutable_tensor_shape());
+  result->emplace_back();
+  EncodeRecvTensorResponseToByteBuffer(response, &result->back());
+
+  // As in EncodeTensorToByteBuffer(), each chunk points to the backing
+  // store, followed by a zero-length slice that holds a reference to the
+  // TensorBuffer.
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  for (size_t offset = 0; offset < tdata.size(); offset += chunk_bytes) {
+    const size_t n =
+        std::min(tdata.size() - offset, static_cast<size_t>(chunk_bytes));
+    buf->Ref();
+    ::grpc::Slice slices[2];
+    gpr_slice s0 = gpr_slice_new(
+        const_cast<void*>(static_cast<const void*>(tdata.data() + offset)), n,
+        do_nothing);
+    slices[0] = ::grpc::Slice(s0, ::grpc::Slice::STEAL_REF);
+    gpr_slice s1 =
+        gpr_slice_new(const_cast<TensorBuffer*>(buf), 0, unref_tensorbuffer);
+    slices[1] = ::grpc::Slice(s1, ::grpc::Slice::STEAL_REF);
+    result->emplace_back(&slices[0], 2);
+  }
+}
+
+// The RunStepRequest is encoded as its fields other than the feeds, followed
+// by one feed submessage per feed. For a large feed, the submessage is
+// encoded up to and including the tag and length of its tensor_content,
+// as in EncodeTensorToByteBuffer() (A) through (D2), and the content (E)
+// is a slice that points to the backing store of the feed tensor.
+void EncodeRunStepRequestToByteBuffer(const RunStepRequestWrapper& request,
+                                      ::grpc::ByteBuffer* result) {
+  const size_t kLargeTensorBytes = 1024;
+
+  // All of RunStepRequest except the feed field.
+  RunStepRequest header;
+  header.set_session_handle(request.session_handle());
+  for (size_t i = 0; i < request.num_fetches(); ++i) {
+    header.add_fetch(request.fetch_name(i));
+  }
+  for (size_t i = 0; i < request.num_targets(); ++i) {
+    header.add_target(request.target_name(i));
+  }
+  *header.mutable_options() = request.options();
+  header.set_partial_run_handle(request.partial_run_handle());
+
+  // Encoded bytes that are copied into the next slice.
+  string pending;
+  header.AppendToString(&pending);
+
+  std::vector<::grpc::Slice> slices;
+  auto flush_pending = [&pending, &slices]() {
+    if (pending.empty()) return;
+    gpr_slice s = gpr_slice_malloc(pending.size());
+    memcpy(GPR_SLICE_START_PTR(s), pending.data(), pending.size());
+    slices.emplace_back(s, ::grpc::Slice::STEAL_REF);
+    pending.clear();
+  };
+
+  for (size_t i = 0; i < request.num_feeds(); ++i) {
+    const string& name = request.feed_name(i);
+    Tensor val;
+    const bool is_tensor = request.FeedValue(i, &val).ok();
+    if (!is_tensor || !DataTypeCanUseMemcpy(val.dtype()) ||
+        val.tensor_data().size() <= kLargeTensorBytes) {
+      // Small or complicated feed: let the protocol buffer library encode
+      // the feed submessage, with its tag.
+      RunStepRequest feed_only;
+      NamedTensorProto* feed = feed_only.add_feed();
+      feed->set_name(name);
+      if (is_tensor) {
+        val.AsProtoTensorContent(feed->mutable_tensor());
+      } else {
+        request.FeedValue(i, feed->mutable_tensor()).IgnoreError();
+      }
+      feed_only.AppendToString(&pending);
+      continue;
+    }
+
+    gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+    io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+    EncodeSkeleton(val, &e_skeleton);
+
+    StringPiece tdata = val.tensor_data();
+    const uint32 tensor_proto_bytes =
+        e_skeleton.size() +
+        VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
+                              tdata.size());
+    const uint32 named_tensor_bytes =
+        VarLengthEncodingSize(NamedTensorProto::kNameFieldNumber,
+                              name.size()) +
+        VarLengthEncodingSize(NamedTensorProto::kTensorFieldNumber,
+                              tensor_proto_bytes);
+    const size_t encoder_size =
+        VarLengthEncodingSize(RunStepRequest::kFeedFieldNumber,
+                              named_tensor_bytes) -
+        tdata.size();
+
+    gtl::InlinedVector<char, 256> space(encoder_size);
+    io::ProtoEncodeHelper e(space.data(), space.size());
+    e.WriteVarlengthBeginning(RunStepRequest::kFeedFieldNumber,
+                              named_tensor_bytes);
+    e.WriteString(NamedTensorProto::kNameFieldNumber, name);
+    e.WriteVarlengthBeginning(NamedTensorProto::kTensorFieldNumber,
+                              tensor_proto_bytes);
+    e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
+    e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                              tdata.size());
+    CHECK_EQ(e.size(), encoder_size);
+    pending.append(e.data(), e.size());
+    flush_pending();
+
+    // Share the backing store of the feed, and unref it with a zero-length
+    // slice as in EncodeTensorToByteBuffer().
+    const TensorBuffer* buf = DMAHelper::buffer(&val);
+    buf->Ref();
+    gpr_slice s1 = gpr_slice_new(
+        const_cast<void*>(static_cast<const void*>(tdata.data())),
+        tdata.size(), do_nothing);
+    slices.emplace_back(s1, ::grpc::Slice::STEAL_REF);
+    gpr_slice s2 =
+        gpr_slice_new(const_cast<TensorBuffer*>(buf), 0, unref_tensorbuffer);
+    slices.emplace_back(s2, ::grpc::Slice::STEAL_REF);
+  }
+  flush_pending();
+
+  *result = ::grpc::ByteBuffer(slices.data(), slices.size());
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
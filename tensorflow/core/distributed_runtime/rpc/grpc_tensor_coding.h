@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -23,6 +27,8 @@ class ByteBuffer;
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+class RunStepRequestWrapper;
+class TensorCompressionOptions;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -51,6 +57,48 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Encode a Tensor, compressed as specified by "options", into a byte buffer
+// in a format that is parseable as a RecvTensorResponse protocol buffer.
+// "residual_key" is as for CompressTensorToResponse().
+//
+// Returns false, leaving *result unchanged, if "val" is not to be
+// compressed.
+bool EncodeCompressedTensorToByteBuffer(bool is_dead, const Tensor& val,
+                                        const TensorCompressionOptions& options,
+                                        const string& residual_key,
+                                        ::grpc::ByteBuffer* result);
+
+// The size of the chunks in which EncodeTensorToByteBuffers() splits the
+// content of a tensor for the RecvTensorStream method.
+static const int64 kRecvTensorChunkBytes = 4 << 20;
+
+// Encode a Tensor into a sequence of byte buffers, for the messages of a
+// RecvTensorStream call.
+//
+// If the content of "val" can be copied with memcpy and is larger than
+// "chunk_bytes", the first byte buffer is a RecvTensorResponse holding the
+// metadata of "val", with "tensor_content_streamed" set, and each of the
+// next ones holds up to "chunk_bytes" of the raw content of "val". These
+// share the backing store of "val" rather than copying it. Otherwise,
+// the only byte buffer is as encoded by EncodeTensorToByteBuffer().
+//
+// Appends the byte buffers to *result.
+void EncodeTensorToByteBuffers(bool is_dead, const Tensor& val,
+                               int64 chunk_bytes,
+                               std::vector<::grpc::ByteBuffer>* result);
+
+// Encode the request held by "request" into a byte buffer in a format that
+// is parseable as a RunStepRequest protocol buffer.
+//
+// As in EncodeTensorToByteBuffer(), the contents of large feeds that can be
+// copied with memcpy share the backing store of the feed tensors rather
+// than being copied, so the request should hold its feeds as Tensors (e.g.
+// an InMemoryRunStepRequest).
+//
+// Discards original contents of *result.
+void EncodeRunStepRequestToByteBuffer(const RunStepRequestWrapper& request,
+                                      ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
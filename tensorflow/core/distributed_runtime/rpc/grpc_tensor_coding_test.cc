@@ -17,11 +17,13 @@ limitations under the License.
 
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
+#include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -100,4 +102,36 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, RunStepRequest) {
+  InMemoryRunStepRequest request;
+  request.set_session_handle("session");
+  request.set_partial_run_handle("partial_run");
+  request.add_fetch("fetch:0");
+  request.add_target("target");
+  request.mutable_options()->set_timeout_in_ms(17);
+  // A small, a large and a string feed.
+  Tensor small(DT_FLOAT, TensorShape({2}));
+  test::FillIota<float>(&small, 1.0f);
+  request.add_feed("small:0", small);
+  Tensor large(DT_INT32, TensorShape({10, 100}));
+  test::FillIota<int32>(&large, 0);
+  request.add_feed("large:0", large);
+  Tensor str(DT_STRING, TensorShape({2}));
+  test::FillValues<string>(&str, {"a", "bc"});
+  request.add_feed("str:0", str);
+
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRunStepRequestToByteBuffer(request, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RunStepRequest parsed;
+  ASSERT_TRUE(parsed.ParseFromString(tmp));
+  EXPECT_EQ(request.ToProto().DebugString(), parsed.DebugString());
+}
+
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
+#include <vector>
 
 #include "grpc++/alarm.h"
 #include "grpc++/server_builder.h"
@@ -42,23 +44,38 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// The environment variable setting the number of completion queues of the
+// worker service, which is 1 by default.
+const char* const kNumCompletionQueuesEnvVar =
+    "TF_GRPC_WORKER_NUM_COMPLETION_QUEUES";
+
 class GrpcWorkerService : public AsyncServiceInterface {
  public:
-  GrpcWorkerService(GrpcWorker* worker, ::grpc::ServerBuilder* builder)
+  GrpcWorkerService(GrpcWorker* worker, ::grpc::ServerBuilder* builder,
+                    int num_completion_queues)
       : worker_(worker), is_shutdown_(false) {
     builder->RegisterService(&worker_service_);
-    cq_ = builder->AddCompletionQueue();
+    for (int i = 0; i < num_completion_queues; ++i) {
+      cqs_.push_back(builder->AddCompletionQueue());
+    }
   }
 
-  ~GrpcWorkerService() override { delete shutdown_alarm_; }
+  ~GrpcWorkerService() override {
+    for (::grpc::Alarm* alarm : shutdown_alarms_) {
+      delete alarm;
+    }
+  }
 
   void Shutdown() override {
     bool did_shutdown = false;
@@ -74,14 +91,16 @@ class GrpcWorkerService : public AsyncServiceInterface {
       // NOTE(mrry): This enqueues a special event (with a null tag)
       // that causes the completion queue to be shut down on the
       // polling thread.
-      shutdown_alarm_ =
-          new ::grpc::Alarm(cq_.get(), gpr_now(GPR_CLOCK_MONOTONIC), nullptr);
+      for (const auto& cq : cqs_) {
+        shutdown_alarms_.push_back(
+            new ::grpc::Alarm(cq.get(), gpr_now(GPR_CLOCK_MONOTONIC), nullptr));
+      }
     }
   }
 
 // This macro creates a new request for the given RPC method name
-// (e.g., `ENQUEUE_REQUEST(GetStatus, false);`), and enqueues it on
-// `this->cq_`.
+// (e.g., `ENQUEUE_REQUEST(cq, GetStatus, false);`), and enqueues it on
+// the completion queue `cq`.
 //
 // This macro is invoked one or more times for each RPC method to
 // ensure that there are sufficient completion queue entries to
@@ -89,54 +108,85 @@ class GrpcWorkerService : public AsyncServiceInterface {
 //
 // The implementation of the request handler for each RPC method
 // must ensure that it calls ENQUEUE_REQUEST() for that RPC method,
-// to keep accepting new requests.
-#define ENQUEUE_REQUEST(method, supports_cancel)                       \
+// on the completion queue of the call it handles, to keep accepting
+// new requests on every completion queue.
+#define ENQUEUE_REQUEST(cq, method, supports_cancel)                   \
   do {                                                                 \
     mutex_lock l(shutdown_mu_);                                        \
     if (!is_shutdown_) {                                               \
       Call<GrpcWorkerService, grpc::WorkerService::AsyncService,       \
            method##Request, method##Response>::                        \
           EnqueueRequestForMethod(                                     \
-              &worker_service_, cq_.get(),                             \
+              &worker_service_, (cq),                                  \
               static_cast<int>(GrpcWorkerMethod::k##method),           \
               &GrpcWorkerService::method##Handler, (supports_cancel)); \
     }                                                                  \
   } while (0)
 
-  // This method blocks forever handling requests from the completion queue.
+  // This method blocks forever handling requests from the completion
+  // queues. The first completion queue is polled by the calling thread,
+  // and each of the others by a thread of its own.
   void HandleRPCsLoop() override {
     // TODO(mrry): This may require performance engineering. We can
-    // add more threads to service the completion queue, and add more
-    // of various request types if they are short and frequent.
+    // add more of various request types if they are short and frequent.
     // Currently we allow unbounded numbers of pending calls for each
     // method, by re-enqueuing a request before the previous one
     // completes, and we may decide to bound some of the request
     // types.
-    ENQUEUE_REQUEST(GetStatus, false);
-    ENQUEUE_REQUEST(CreateWorkerSession, false);
-    ENQUEUE_REQUEST(CleanupAll, false);
-    ENQUEUE_REQUEST(RegisterGraph, false);
-    ENQUEUE_REQUEST(DeregisterGraph, false);
-
-    // TODO(mrry): Determine a better policy for enqueuing the appropriate
-    // number of each request type.
-    for (int i = 0; i < 1000; ++i) {
-      EnqueueRecvTensorRequestRaw();
-    }
-    for (int i = 0; i < 100; ++i) {
-      ENQUEUE_REQUEST(RunGraph, true);
-    }
-    for (int i = 0; i < 100; ++i) {
-      ENQUEUE_REQUEST(CleanupGraph, false);
+    //
+    // The requests for the frequent methods are split between the
+    // completion queues, and each handler re-enqueues its request on the
+    // completion queue of its call, so the split is kept.
+    const int num_cqs = cqs_.size();
+    for (int i = 0; i < num_cqs; ++i) {
+      ::grpc::ServerCompletionQueue* cq = cqs_[i].get();
+      if (i == 0) {
+        ENQUEUE_REQUEST(cq, GetStatus, false);
+        ENQUEUE_REQUEST(cq, CreateWorkerSession, false);
+        ENQUEUE_REQUEST(cq, CleanupAll, false);
+        ENQUEUE_REQUEST(cq, RegisterGraph, false);
+        ENQUEUE_REQUEST(cq, DeregisterGraph, false);
+        ENQUEUE_REQUEST(cq, Logging, false);
+        ENQUEUE_REQUEST(cq, Tracing, false);
+      }
+
+      // TODO(mrry): Determine a better policy for enqueuing the appropriate
+      // number of each request type.
+      for (int j = 0; j < std::max(1, 1000 / num_cqs); ++j) {
+        EnqueueRecvTensorRequestRaw(cq);
+      }
+      for (int j = 0; j < std::max(1, 1000 / num_cqs); ++j) {
+        EnqueueRecvTensorStreamRequestRaw(cq);
+      }
+      for (int j = 0; j < std::max(1, 100 / num_cqs); ++j) {
+        EnqueueRecvTensorBatchRequestRaw(cq);
+      }
+      for (int j = 0; j < std::max(1, 100 / num_cqs); ++j) {
+        ENQUEUE_REQUEST(cq, RunGraph, true);
+      }
+      for (int j = 0; j < std::max(1, 100 / num_cqs); ++j) {
+        ENQUEUE_REQUEST(cq, CleanupGraph, false);
+      }
     }
 
-    ENQUEUE_REQUEST(Logging, false);
-    ENQUEUE_REQUEST(Tracing, false);
+    std::vector<std::unique_ptr<Thread>> polling_threads;
+    for (int i = 1; i < num_cqs; ++i) {
+      ::grpc::ServerCompletionQueue* cq = cqs_[i].get();
+      polling_threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), strings::StrCat("TF_worker_service_cq_", i),
+          [this, cq]() { PollCompletionQueue(cq); }));
+    }
+    PollCompletionQueue(cqs_[0].get());
+    // Destroying the threads blocks until they have drained their
+    // completion queues.
+  }
 
+ private:
+  void PollCompletionQueue(::grpc::ServerCompletionQueue* cq) {
     void* tag;
     bool ok;
 
-    while (cq_->Next(&tag, &ok)) {
+    while (cq->Next(&tag, &ok)) {
       UntypedCall<GrpcWorkerService>::Tag* callback_tag =
           static_cast<UntypedCall<GrpcWorkerService>::Tag*>(tag);
       if (callback_tag) {
@@ -144,20 +194,19 @@ class GrpcWorkerService : public AsyncServiceInterface {
       } else {
         // NOTE(mrry): A null `callback_tag` indicates that this is
         // the shutdown alarm.
-        cq_->Shutdown();
+        cq->Shutdown();
       }
     }
   }
 
- private:
   GrpcWorker* worker_ = nullptr;  // Not owned.
-  std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>> cqs_;
 
   grpc::WorkerService::AsyncService worker_service_;
 
   mutex shutdown_mu_;
   bool is_shutdown_ GUARDED_BY(shutdown_mu_);
-  ::grpc::Alarm* shutdown_alarm_ = nullptr;
+  std::vector<::grpc::Alarm*> shutdown_alarms_;
 
   void Schedule(std::function<void()> f) {
     worker_->env()->compute_pool->Schedule(std::move(f));
@@ -168,18 +217,24 @@ class GrpcWorkerService : public AsyncServiceInterface {
   // `HandleRPCsLoop()` when the next Foo RPC is received. Each
   // `FooHandler` call schedules a closure on `worker_->env()->compute_pool`,
   // and is responsible for requesting the next Foo call by calling
-  // `ENQUEUE_REQUEST(Foo)`.
+  // `ENQUEUE_REQUEST(call->cq(), Foo)`.
 
   template <class RequestMessage, class ResponseMessage>
   using WorkerCall = Call<GrpcWorkerService, grpc::WorkerService::AsyncService,
                           RequestMessage, ResponseMessage>;
 
+  template <class RequestMessage, class ResponseMessage>
+  using StreamingWorkerCall =
+      ServerStreamingCall<GrpcWorkerService,
+                          grpc::WorkerService::AsyncService, RequestMessage,
+                          ResponseMessage>;
+
   void GetStatusHandler(WorkerCall<GetStatusRequest, GetStatusResponse>* call) {
     Schedule([this, call]() {
       Status s = worker_->GetStatus(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(GetStatus, false);
+    ENQUEUE_REQUEST(call->cq(), GetStatus, false);
   }
 
   void CreateWorkerSessionHandler(
@@ -189,7 +244,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->CreateWorkerSession(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(CreateWorkerSession, false);
+    ENQUEUE_REQUEST(call->cq(), CreateWorkerSession, false);
   }
 
   void CleanupAllHandler(
@@ -198,7 +253,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->CleanupAll(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(CleanupAll, false);
+    ENQUEUE_REQUEST(call->cq(), CleanupAll, false);
   }
 
   void RegisterGraphHandler(
@@ -207,7 +262,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->RegisterGraph(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(RegisterGraph, false);
+    ENQUEUE_REQUEST(call->cq(), RegisterGraph, false);
   }
 
   void DeregisterGraphHandler(
@@ -216,7 +271,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->DeregisterGraph(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(DeregisterGraph, false);
+    ENQUEUE_REQUEST(call->cq(), DeregisterGraph, false);
   }
 
   void RunGraphHandler(WorkerCall<RunGraphRequest, RunGraphResponse>* call) {
@@ -237,7 +292,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
                                call->SendResponse(ToGrpcStatus(s));
                              });
     });
-    ENQUEUE_REQUEST(RunGraph, true);
+    ENQUEUE_REQUEST(call->cq(), RunGraph, true);
   }
 
   void RecvTensorHandlerRaw(
@@ -252,7 +307,45 @@ class GrpcWorkerService : public AsyncServiceInterface {
                                  call->SendResponse(ToGrpcStatus(s));
                                });
     });
-    EnqueueRecvTensorRequestRaw();
+    EnqueueRecvTensorRequestRaw(call->cq());
+  }
+
+  void RecvTensorStreamHandlerRaw(
+      StreamingWorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      std::vector<::grpc::ByteBuffer>* responses =
+          new std::vector<::grpc::ByteBuffer>;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorStreamAsync(
+          call_opts, &call->request, responses,
+          [call, call_opts, responses](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            call->SendResponses(std::move(*responses), ToGrpcStatus(s));
+            delete responses;
+          });
+    });
+    EnqueueRecvTensorStreamRequestRaw(call->cq());
+  }
+
+  void RecvTensorBatchHandlerRaw(
+      StreamingWorkerCall<RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      std::vector<::grpc::ByteBuffer>* responses =
+          new std::vector<::grpc::ByteBuffer>;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, responses,
+          [call, call_opts, responses](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            call->SendResponses(std::move(*responses), ToGrpcStatus(s));
+            delete responses;
+          });
+    });
+    EnqueueRecvTensorBatchRequestRaw(call->cq());
   }
 
   void CleanupGraphHandler(
@@ -261,7 +354,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->CleanupGraph(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(CleanupGraph, false);
+    ENQUEUE_REQUEST(call->cq(), CleanupGraph, false);
   }
 
   void LoggingHandler(WorkerCall<LoggingRequest, LoggingResponse>* call) {
@@ -269,7 +362,7 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->Logging(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(Logging, false);
+    ENQUEUE_REQUEST(call->cq(), Logging, false);
   }
 
   void TracingHandler(WorkerCall<TracingRequest, TracingResponse>* call) {
@@ -277,23 +370,49 @@ class GrpcWorkerService : public AsyncServiceInterface {
       Status s = worker_->Tracing(&call->request, &call->response);
       call->SendResponse(ToGrpcStatus(s));
     });
-    ENQUEUE_REQUEST(Tracing, false);
+    ENQUEUE_REQUEST(call->cq(), Tracing, false);
   }
 #undef ENQUEUE_REQUEST
 
-  void EnqueueRecvTensorRequestRaw() {
+  void EnqueueRecvTensorRequestRaw(::grpc::ServerCompletionQueue* cq) {
     mutex_lock l(shutdown_mu_);
     if (!is_shutdown_) {
       Call<GrpcWorkerService, grpc::WorkerService::AsyncService,
            RecvTensorRequest, ::grpc::ByteBuffer>::
           EnqueueRequestForMethod(
-              &worker_service_, cq_.get(),
+              &worker_service_, cq,
               static_cast<int>(GrpcWorkerMethod::kRecvTensor),
               &GrpcWorkerService::RecvTensorHandlerRaw,
               true /* supports cancel*/);
     }
   }
 
+  void EnqueueRecvTensorStreamRequestRaw(::grpc::ServerCompletionQueue* cq) {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      ServerStreamingCall<GrpcWorkerService, grpc::WorkerService::AsyncService,
+                          RecvTensorRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              &worker_service_, cq,
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorStream),
+              &GrpcWorkerService::RecvTensorStreamHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
+  void EnqueueRecvTensorBatchRequestRaw(::grpc::ServerCompletionQueue* cq) {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      ServerStreamingCall<GrpcWorkerService, grpc::WorkerService::AsyncService,
+                          RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              &worker_service_, cq,
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+              &GrpcWorkerService::RecvTensorBatchHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerService);
 };
 
@@ -308,6 +427,63 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
                                  const RecvTensorRequest* request,
                                  ::grpc::ByteBuffer* response,
                                  StatusCallback done) {
+  RecvTensorImpl(opts, request, response, nullptr, std::move(done));
+}
+
+void GrpcWorker::RecvTensorStreamAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    std::vector<::grpc::ByteBuffer>* responses, StatusCallback done) {
+  RecvTensorImpl(opts, request, nullptr, responses, std::move(done));
+}
+
+void GrpcWorker::RecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorBatchRequest* request,
+    std::vector<::grpc::ByteBuffer>* responses, StatusCallback done) {
+  const int num_requests = request->request_size();
+  if (num_requests == 0) {
+    done(Status::OK());
+    return;
+  }
+  responses->resize(num_requests);
+
+  // Each request is served with its own CallOptions, since RecvTensorImpl()
+  // sets and clears a cancellation callback on them. Cancelling the batch
+  // cancels all of them.
+  struct BatchState {
+    explicit BatchState(int n) : opts(new CallOptions[n]), pending(n) {}
+    std::unique_ptr<CallOptions[]> opts;
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+  };
+  BatchState* state = new BatchState(num_requests);
+  opts->SetCancelCallback([state, num_requests]() {
+    for (int i = 0; i < num_requests; ++i) {
+      state->opts[i].StartCancel();
+    }
+  });
+  for (int i = 0; i < num_requests; ++i) {
+    RecvTensorImpl(&state->opts[i], &request->request(i), &(*responses)[i],
+                   nullptr, [opts, state, done](const Status& s) {
+                     Status status;
+                     {
+                       mutex_lock l(state->mu);
+                       state->status.Update(s);
+                       if (--state->pending > 0) return;
+                       status = state->status;
+                     }
+                     opts->ClearCancelCallback();
+                     delete state;
+                     done(status);
+                   });
+  }
+}
+
+void GrpcWorker::RecvTensorImpl(CallOptions* opts,
+                                const RecvTensorRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                std::vector<::grpc::ByteBuffer>* responses,
+                                StatusCallback done) {
   const int64 step_id = request->step_id();
   const string& key = request->rendezvous_key();
   TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
@@ -329,10 +505,10 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev](const Status& status,
-                                      const Rendezvous::Args& send_args,
-                                      const Rendezvous::Args& recv_args,
-                                      const Tensor& val, const bool is_dead) {
+      [opts, request, response, responses, done, src_dev](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& val,
+          const bool is_dead) {
         opts->ClearCancelCallback();
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
@@ -349,16 +525,21 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
               const DeviceContext* send_dev_context = send_args.device_context;
               RecvTensorResponse* tmp = new RecvTensorResponse;
               tmp->set_is_dead(is_dead);
+              ::grpc::ByteBuffer* out = response;
+              if (out == nullptr) {
+                responses->emplace_back();
+                out = &responses->back();
+              }
               CHECK(send_dev_context)
                   << "send dev name: " << src_dev->name()
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on a GPU. Uses GPUUtil to fill the response proto.
-              StatusCallback response_ready = [response, done,
+              StatusCallback response_ready = [out, done,
                                                tmp](const Status& s) {
                 // The value is now ready to be returned on the wire.
                 tmp->set_send_start_micros(Env::Default()->NowMicros());
 
-                grpc::EncodeRecvTensorResponseToByteBuffer(*tmp, response);
+                grpc::EncodeRecvTensorResponseToByteBuffer(*tmp, out);
                 done(s);
                 delete tmp;
               };
@@ -377,7 +558,25 @@ void GrpcWorker::RecvTensorAsync(CallOptions* opts,
               done(errors::Internal("No GPU device in process"));
 #endif  // GOOGLE_CUDA
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              ::grpc::ByteBuffer compressed;
+              if (request->has_compression() &&
+                  grpc::EncodeCompressedTensorToByteBuffer(
+                      is_dead, val, request->compression(),
+                      request->rendezvous_key(), &compressed)) {
+                if (response != nullptr) {
+                  *response = compressed;
+                } else {
+                  responses->push_back(compressed);
+                }
+              } else if (responses != nullptr) {
+                // The tensor is in host memory, so its content may be
+                // streamed directly from its buffer.
+                grpc::EncodeTensorToByteBuffers(is_dead, val,
+                                                grpc::kRecvTensorChunkBytes,
+                                                responses);
+              } else {
+                grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              }
               done(Status::OK());
             }
           }
@@ -396,8 +595,23 @@ std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env) {
 
 std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
     GrpcWorker* worker, ::grpc::ServerBuilder* builder) {
+  int64 num_completion_queues;
+  Status s = ReadInt64FromEnvVar(kNumCompletionQueuesEnvVar, 1,
+                                 &num_completion_queues);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    num_completion_queues = 1;
+  }
+  return NewGrpcWorkerService(worker, builder,
+                              std::max<int64>(1, num_completion_queues));
+}
+
+std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
+    GrpcWorker* worker, ::grpc::ServerBuilder* builder,
+    int num_completion_queues) {
+  CHECK_GE(num_completion_queues, 1);
   return std::unique_ptr<AsyncServiceInterface>(
-      new GrpcWorkerService(worker, builder));
+      new GrpcWorkerService(worker, builder, num_completion_queues));
 }
 
 }  // namespace tensorflow
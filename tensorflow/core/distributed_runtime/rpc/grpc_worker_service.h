@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/worker.h"
 
 namespace grpc {
@@ -37,15 +39,48 @@ class GrpcWorker : public Worker {
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        ::grpc::ByteBuffer* response, StatusCallback done);
 
+  // Version of RecvTensor for the server-streaming RecvTensorStream method.
+  // A large tensor in host memory is returned as its metadata, followed by
+  // chunks of its content that share its buffer. Any other tensor is
+  // returned as a single RecvTensorResponse message.
+  void RecvTensorStreamAsync(CallOptions* opts,
+                             const RecvTensorRequest* request,
+                             std::vector<::grpc::ByteBuffer>* responses,
+                             StatusCallback done);
+
+  // Version of RecvTensor for the server-streaming RecvTensorBatch method.
+  // Fills in one RecvTensorResponse message per request, in the order of
+  // the requests.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            std::vector<::grpc::ByteBuffer>* responses,
+                            StatusCallback done);
+
   WorkerEnv* env();
+
+ private:
+  // Fills in "*response" if it is non-null, and "*responses" otherwise.
+  void RecvTensorImpl(CallOptions* opts, const RecvTensorRequest* request,
+                      ::grpc::ByteBuffer* response,
+                      std::vector<::grpc::ByteBuffer>* responses,
+                      StatusCallback done);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env);
 
-// Returns an implementation of WorkerService rpc service.
+// Returns an implementation of WorkerService rpc service, which handles
+// its RPCs on the number of completion queues given by the
+// TF_GRPC_WORKER_NUM_COMPLETION_QUEUES environment variable (1 by default).
 std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
     GrpcWorker* worker, ::grpc::ServerBuilder* builder);
 
+// Returns an implementation of WorkerService rpc service, which handles
+// its RPCs on "num_completion_queues" completion queues, each polled by a
+// thread of its own. "num_completion_queues" must be at least 1.
+std::unique_ptr<AsyncServiceInterface> NewGrpcWorkerService(
+    GrpcWorker* worker, ::grpc::ServerBuilder* builder,
+    int num_completion_queues);
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
@@ -23,9 +23,53 @@ limitations under the License.
 #include "grpc++/impl/codegen/rpc_service_method.h"
 #include "grpc++/impl/codegen/service_type.h"
 #include "grpc++/impl/codegen/sync_stream.h"
+#include "grpc++/support/slice.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
 
+namespace {
+
+// A TensorBuffer backed by part of a gRPC slice, which it holds a reference
+// to.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(const gpr_slice& slice, const char* data, size_t size)
+      : slice_(gpr_slice_ref(slice)),
+        data_(const_cast<char*>(data)),
+        size_(size) {}
+  ~GrpcSliceTensorBuffer() override { gpr_slice_unref(slice_); }
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+
+ private:
+  gpr_slice slice_;
+  char* const data_;
+  const size_t size_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::ShareBuffer(const char* data, size_t num_bytes) {
+  if (stream_ == nullptr) return nullptr;
+  const gpr_slice& slice = stream_->current_slice();
+  // The data of an inlined slice lives in the slice itself, i.e. in the
+  // reader.
+  if (slice.refcount == nullptr) return nullptr;
+  const char* begin = reinterpret_cast<const char*>(GPR_SLICE_START_PTR(slice));
+  if (data < begin || data + num_bytes > begin + GPR_SLICE_LENGTH(slice)) {
+    return nullptr;
+  }
+  return new GrpcSliceTensorBuffer(slice, data, num_bytes);
+}
+
 const char* GrpcWorkerMethodName(GrpcWorkerMethod id) {
   switch (id) {
     case GrpcWorkerMethod::kGetStatus:
@@ -48,6 +92,10 @@ const char* GrpcWorkerMethodName(GrpcWorkerMethod id) {
       return "/tensorflow.WorkerService/Logging";
     case GrpcWorkerMethod::kTracing:
       return "/tensorflow.WorkerService/Tracing";
+    case GrpcWorkerMethod::kRecvTensorStream:
+      return "/tensorflow.WorkerService/RecvTensorStream";
+    case GrpcWorkerMethod::kRecvTensorBatch:
+      return "/tensorflow.WorkerService/RecvTensorBatch";
   }
   // Shouldn't be reached.
   LOG(FATAL) << "Invalid id: this line shouldn't be reached.";
@@ -58,9 +106,14 @@ namespace grpc {
 
 WorkerService::AsyncService::AsyncService() {
   for (int i = 0; i < kGrpcNumWorkerMethods; ++i) {
+    const GrpcWorkerMethod id = static_cast<GrpcWorkerMethod>(i);
     AddMethod(new ::grpc::RpcServiceMethod(
-        GrpcWorkerMethodName(static_cast<GrpcWorkerMethod>(i)),
-        ::grpc::RpcMethod::NORMAL_RPC, nullptr));
+        GrpcWorkerMethodName(id),
+        (id == GrpcWorkerMethod::kRecvTensorStream ||
+         id == GrpcWorkerMethod::kRecvTensorBatch)
+            ? ::grpc::RpcMethod::SERVER_STREAMING
+            : ::grpc::RpcMethod::NORMAL_RPC,
+        nullptr));
     ::grpc::Service::MarkMethodAsync(i);
   }
 }
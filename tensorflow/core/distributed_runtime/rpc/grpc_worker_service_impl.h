@@ -51,6 +51,9 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares "data" if it lies within a single refcounted slice.
+  TensorBuffer* ShareBuffer(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -118,9 +121,11 @@ enum class GrpcWorkerMethod {
   kRecvTensor,
   kLogging,
   kTracing,
+  kRecvTensorStream,
+  kRecvTensorBatch,
 };
 static const int kGrpcNumWorkerMethods =
-    static_cast<int>(GrpcWorkerMethod::kTracing) + 1;
+    static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch) + 1;
 
 const char* GrpcWorkerMethodName(GrpcWorkerMethod id);
 
@@ -137,8 +142,10 @@ class WorkerService GRPC_FINAL {
     AsyncService();
     virtual ~AsyncService();
 
-    // Make RequestAsyncUnary public for grpc_call.h
+    // Make RequestAsyncUnary and RequestAsyncServerStreaming public for
+    // grpc_call.h
     using ::grpc::Service::RequestAsyncUnary;
+    using ::grpc::Service::RequestAsyncServerStreaming;
   };
 };
 
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -31,11 +34,33 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Returns the time during which the RecvTensor calls to the same worker are
+// coalesced into a single RecvTensorBatch call, or 0 if they are not.
+int64 RecvTensorBatchMicros() {
+  static int64 micros = []() {
+    int64 value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_BATCH_MICROS", 0, &value));
+    return value;
+  }();
+  return micros;
+}
+
+// The maximum number of RecvTensor calls coalesced into one batch.
+const size_t kMaxRecvTensorBatchSize = 128;
+
+class RpcRecvTensorCall;
+
+// A call waiting to be started as part of a RecvTensorBatch call, and the
+// callback to run once it completes.
+typedef std::pair<RpcRecvTensorCall*, std::function<void()>> BatchedCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -49,6 +74,18 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds "call" to the calls pending for its source worker, which are
+  // started together once the batching window has elapsed.
+  void EnqueueBatchedCall(RpcRecvTensorCall* call,
+                          std::function<void()> recv_done);
+
+  // Starts the calls pending for "src_worker", if any.
+  void FlushBatchedCalls(const string& src_worker);
+
+  mutex batch_mu_;
+  std::unordered_map<string, std::vector<BatchedCall>> batched_calls_
+      GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -59,7 +96,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args,
+            const TensorCompressionOptions& compression,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -67,6 +106,11 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     done_ = std::move(done);
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
+    if (compression.algorithm() != TensorCompressionOptions::NONE ||
+        compression.float_transfer_type() != DT_INVALID ||
+        compression.lossy_encoding() != TensorCompressionOptions::EXACT) {
+      *req_.mutable_compression() = compression;
+    }
   }
 
   void Reset(WorkerCacheInterface* wc) {
@@ -98,6 +142,36 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     StartRTCall(std::move(recv_done));
   }
 
+  // Starts all of "calls", which must have the same source worker, in a
+  // single RecvTensorBatch call.
+  static void StartBatch(std::vector<BatchedCall> calls) {
+    RecvTensorBatchRequest* req = new RecvTensorBatchRequest;
+    std::vector<TensorResponse*> responses;
+    for (const BatchedCall& batched : calls) {
+      RpcRecvTensorCall* call = batched.first;
+      call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+      *req->add_request() = call->req_;
+      responses.push_back(&call->resp_);
+    }
+    // Aborting the rendezvous aborts all of its calls, so the batch is
+    // cancelled with the options of its first call.
+    RpcRecvTensorCall* first = calls[0].first;
+    std::vector<BatchedCall>* batch =
+        new std::vector<BatchedCall>(std::move(calls));
+    first->wi_->RecvTensorBatchAsync(
+        &first->opts_, req, responses, [req, batch](const Status& s) {
+          for (const BatchedCall& batched : *batch) {
+            if (!s.ok()) {
+              mutex_lock l(batched.first->mu_);
+              batched.first->status_.Update(s);
+            }
+            batched.second();
+          }
+          delete req;
+          delete batch;
+        });
+  }
+
   void StartAbort(const Status& s) override {
     {
       mutex_lock l(mu_);
@@ -237,14 +311,14 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, recv_tensor_compression(), std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
 
   // Start "call".
   Ref();
-  call->Start([this, call]() {
+  std::function<void()> recv_done = [this, call]() {
     // Removes "call" from active_. Prevent StartAbort().
     DeregisterCall(call);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -255,7 +329,52 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->wi_ = nullptr;
     get_call_freelist()->Release(call, session()->worker_cache.get());
     Unref();
-  });
+  };
+  if (RecvTensorBatchMicros() > 0) {
+    EnqueueBatchedCall(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::EnqueueBatchedCall(RpcRecvTensorCall* call,
+                                             std::function<void()> recv_done) {
+  const string src_worker = call->src_worker_;
+  bool start_window;
+  bool full;
+  {
+    mutex_lock l(batch_mu_);
+    std::vector<BatchedCall>& pending = batched_calls_[src_worker];
+    pending.emplace_back(call, std::move(recv_done));
+    start_window = pending.size() == 1;
+    full = pending.size() >= kMaxRecvTensorBatchSize;
+  }
+  if (full) {
+    FlushBatchedCalls(src_worker);
+  } else if (start_window) {
+    Ref();
+    SchedNonBlockingClosureAfter(RecvTensorBatchMicros(),
+                                 [this, src_worker]() {
+                                   FlushBatchedCalls(src_worker);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatchedCalls(const string& src_worker) {
+  std::vector<BatchedCall> calls;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = batched_calls_.find(src_worker);
+    if (it == batched_calls_.end()) return;
+    calls.swap(it->second);
+    batched_calls_.erase(it);
+  }
+  if (calls.size() == 1) {
+    calls[0].first->Start(std::move(calls[0].second));
+  } else {
+    RpcRecvTensorCall::StartBatch(std::move(calls));
+  }
 }
 
 }  // namespace
@@ -15,15 +15,379 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "google/protobuf/any.pb.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/raw_coding.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "zlib.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Returns true if the content of meta.tensor() was compressed by
+// CompressTensorToResponse().
+bool IsCompressed(const RecvTensorResponse& meta) {
+  return meta.content_compression() != TensorCompressionOptions::NONE ||
+         meta.original_dtype() != DT_INVALID ||
+         meta.lossy_encoding() != TensorCompressionOptions::EXACT;
+}
+
+// Returns true if a float tensor can be converted to "dtype" for a transfer.
+bool IsFloatTransferType(DataType dtype) {
+  return dtype == DT_HALF || dtype == DT_BFLOAT16;
+}
+
+// Returns the size of an element of "dtype" in a response. DataTypeSize()
+// does not cover DT_BFLOAT16.
+int ElementSize(DataType dtype) {
+  return dtype == DT_BFLOAT16 ? sizeof(bfloat16) : DataTypeSize(dtype);
+}
+
+// Converts the "n" floats at "src" to "dtype", into "dst".
+void ConvertFromFloat(DataType dtype, const float* src, int64 n, char* dst) {
+  if (dtype == DT_HALF) {
+    Eigen::half* out = reinterpret_cast<Eigen::half*>(dst);
+    for (int64 i = 0; i < n; ++i) {
+      out[i] = Eigen::half(src[i]);
+    }
+  } else {
+    FloatToBFloat16(src, reinterpret_cast<bfloat16*>(dst), n);
+  }
+}
+
+// Converts the "n" values of type "dtype" at "src" to floats, into "dst".
+void ConvertToFloat(DataType dtype, const char* src, int64 n, float* dst) {
+  if (dtype == DT_HALF) {
+    const Eigen::half* in = reinterpret_cast<const Eigen::half*>(src);
+    for (int64 i = 0; i < n; ++i) {
+      dst[i] = static_cast<float>(in[i]);
+    }
+  } else {
+    BFloat16ToFloat(reinterpret_cast<const bfloat16*>(src), dst, n);
+  }
+}
+
+bool ZlibCompress(StringPiece input, string* output) {
+  uLongf length = compressBound(input.size());
+  output->resize(length);
+  if (compress2(reinterpret_cast<Bytef*>(&(*output)[0]), &length,
+                reinterpret_cast<const Bytef*>(input.data()), input.size(),
+                Z_BEST_SPEED) != Z_OK) {
+    return false;
+  }
+  output->resize(length);
+  return true;
+}
+
+const float kDefaultTopKFraction = 0.01;
+
+void AppendFloat(float value, string* out) {
+  char buf[sizeof(float)];
+  memcpy(buf, &value, sizeof(float));
+  out->append(buf, sizeof(float));
+}
+
+float ReadFloat(const char* p) {
+  float value;
+  memcpy(&value, p, sizeof(float));
+  return value;
+}
+
+// Returns the largest number of bytes that "encoding" takes for "n" values.
+int64 MaxLossyEncodedBytes(TensorCompressionOptions::LossyEncoding encoding,
+                           int64 n) {
+  switch (encoding) {
+    case TensorCompressionOptions::QUANTIZE_8BIT:
+      return 2 * sizeof(float) + n;
+    case TensorCompressionOptions::TOP_K:
+      return sizeof(uint32) + n * (sizeof(uint32) + sizeof(float));
+    case TensorCompressionOptions::ONE_BIT:
+      return 2 * sizeof(float) + (n + 7) / 8;
+    default:
+      return 0;
+  }
+}
+
+// Encodes the "n" values at "values" with options.lossy_encoding(), into
+// "*out". Returns false if the values cannot be encoded, i.e. if they are
+// not all finite.
+bool LossyEncode(const TensorCompressionOptions& options, const float* values,
+                 int64 n, string* out) {
+  for (int64 i = 0; i < n; ++i) {
+    if (!std::isfinite(values[i])) return false;
+  }
+  out->clear();
+  switch (options.lossy_encoding()) {
+    case TensorCompressionOptions::QUANTIZE_8BIT: {
+      // As "<min><scale><one level per value>".
+      const auto minmax = std::minmax_element(values, values + n);
+      const float min = *minmax.first;
+      const float scale = (*minmax.second - min) / 255.0f;
+      AppendFloat(min, out);
+      AppendFloat(scale, out);
+      out->resize(2 * sizeof(float) + n);
+      uint8* levels = reinterpret_cast<uint8*>(&(*out)[2 * sizeof(float)]);
+      random::PhiloxRandom philox(random::New64(), random::New64());
+      random::SimplePhilox gen(&philox);
+      for (int64 i = 0; i < n; ++i) {
+        const float level = scale > 0 ? (values[i] - min) / scale : 0;
+        levels[i] = static_cast<uint8>(
+            std::min(255.0f, std::floor(level + gen.RandFloat())));
+      }
+      return true;
+    }
+    case TensorCompressionOptions::TOP_K: {
+      // As "<k><k indices><k values>", in increasing order of index.
+      if (n > std::numeric_limits<uint32>::max()) return false;
+      float fraction = options.top_k_fraction();
+      if (!(fraction > 0 && fraction <= 1)) fraction = kDefaultTopKFraction;
+      const int64 k = std::min<int64>(
+          n, std::max<int64>(1, static_cast<int64>(std::ceil(fraction * n))));
+      std::vector<uint32> indices(n);
+      for (int64 i = 0; i < n; ++i) {
+        indices[i] = i;
+      }
+      std::nth_element(indices.begin(), indices.begin() + (k - 1),
+                       indices.end(), [values](uint32 a, uint32 b) {
+                         return std::abs(values[a]) > std::abs(values[b]);
+                       });
+      indices.resize(k);
+      std::sort(indices.begin(), indices.end());
+      out->reserve(MaxLossyEncodedBytes(TensorCompressionOptions::TOP_K, k));
+      core::PutFixed32(out, k);
+      for (uint32 index : indices) {
+        core::PutFixed32(out, index);
+      }
+      for (uint32 index : indices) {
+        AppendFloat(values[index], out);
+      }
+      return true;
+    }
+    case TensorCompressionOptions::ONE_BIT: {
+      // As "<non-negative mean><negative mean><one bit per value>".
+      double sums[2] = {0, 0};
+      int64 counts[2] = {0, 0};
+      string bits((n + 7) / 8, 0);
+      for (int64 i = 0; i < n; ++i) {
+        const int negative = values[i] < 0;
+        sums[negative] += values[i];
+        ++counts[negative];
+        if (!negative) bits[i / 8] |= 1 << (i % 8);
+      }
+      for (int j = 0; j < 2; ++j) {
+        AppendFloat(counts[j] > 0 ? sums[j] / counts[j] : 0, out);
+      }
+      out->append(bits);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Decodes the "n" values encoded by LossyEncode() in "input", into "out".
+// Returns false if "input" is not a valid encoding of "n" values.
+bool LossyDecode(TensorCompressionOptions::LossyEncoding encoding,
+                 StringPiece input, int64 n, float* out) {
+  const char* p = input.data();
+  switch (encoding) {
+    case TensorCompressionOptions::QUANTIZE_8BIT: {
+      if (input.size() != static_cast<size_t>(2 * sizeof(float) + n)) {
+        return false;
+      }
+      const float min = ReadFloat(p);
+      const float scale = ReadFloat(p + sizeof(float));
+      const uint8* levels =
+          reinterpret_cast<const uint8*>(p + 2 * sizeof(float));
+      for (int64 i = 0; i < n; ++i) {
+        out[i] = min + scale * levels[i];
+      }
+      return true;
+    }
+    case TensorCompressionOptions::TOP_K: {
+      if (input.size() < sizeof(uint32)) return false;
+      const int64 k = core::DecodeFixed32(p);
+      if (k > n || input.size() != static_cast<size_t>(MaxLossyEncodedBytes(
+                                        TensorCompressionOptions::TOP_K, k))) {
+        return false;
+      }
+      std::fill(out, out + n, 0.0f);
+      const char* indices = p + sizeof(uint32);
+      const char* values = indices + k * sizeof(uint32);
+      for (int64 j = 0; j < k; ++j) {
+        const uint32 index = core::DecodeFixed32(indices + j * sizeof(uint32));
+        if (index >= n) return false;
+        out[index] = ReadFloat(values + j * sizeof(float));
+      }
+      return true;
+    }
+    case TensorCompressionOptions::ONE_BIT: {
+      if (input.size() !=
+          static_cast<size_t>(MaxLossyEncodedBytes(encoding, n))) {
+        return false;
+      }
+      const float means[2] = {ReadFloat(p), ReadFloat(p + sizeof(float))};
+      const char* bits = p + 2 * sizeof(float);
+      for (int64 i = 0; i < n; ++i) {
+        const bool non_negative = (bits[i / 8] >> (i % 8)) & 1;
+        out[i] = means[non_negative ? 0 : 1];
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// The error made by the last lossy encoding of the tensor sent for a
+// rendezvous key, for error feedback.
+struct Residual {
+  mutex mu;
+  std::vector<float> values GUARDED_BY(mu);
+};
+
+Residual* GetResidual(const string& key) {
+  static mutex* mu = new mutex;
+  static auto* residuals =
+      new std::unordered_map<string, std::unique_ptr<Residual>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<Residual>& residual = (*residuals)[key];
+  if (residual == nullptr) residual.reset(new Residual);
+  return residual.get();
+}
+
+// Encodes "values" as LossyEncode() does, after adding the residual of
+// "residual_key" to them if options.error_feedback() is set, and updates
+// the residual.
+bool LossyEncodeWithFeedback(const TensorCompressionOptions& options,
+                             const string& residual_key, const float* values,
+                             int64 n, string* out) {
+  if (!options.error_feedback() || residual_key.empty()) {
+    return LossyEncode(options, values, n, out);
+  }
+  Residual* residual = GetResidual(residual_key);
+  mutex_lock l(residual->mu);
+  if (residual->values.size() != static_cast<size_t>(n)) {
+    // The shape of the tensor sent for the key changed.
+    residual->values.assign(n, 0.0f);
+  }
+  std::vector<float> corrected(n);
+  for (int64 i = 0; i < n; ++i) {
+    corrected[i] = values[i] + residual->values[i];
+  }
+  if (!LossyEncode(options, corrected.data(), n, out)) return false;
+  std::vector<float> decoded(n);
+  CHECK(LossyDecode(options.lossy_encoding(), *out, n, decoded.data()));
+  for (int64 i = 0; i < n; ++i) {
+    residual->values[i] = corrected[i] - decoded[i];
+  }
+  return true;
+}
+
+}  // namespace
+
+bool CompressTensorToResponse(const TensorCompressionOptions& options,
+                              const Tensor& val, RecvTensorResponse* response) {
+  return CompressTensorToResponse(options, val, "", response);
+}
+
+bool CompressTensorToResponse(const TensorCompressionOptions& options,
+                              const Tensor& val, const string& residual_key,
+                              RecvTensorResponse* response) {
+  const StringPiece content = val.tensor_data();
+  if (!DataTypeCanUseMemcpy(val.dtype()) || content.empty() ||
+      content.size() < static_cast<uint64>(options.min_bytes())) {
+    return false;
+  }
+  string converted;
+  bool lossy = val.dtype() == DT_FLOAT &&
+               options.lossy_encoding() != TensorCompressionOptions::EXACT;
+  if (lossy) {
+    // Tensors that cannot be encoded are sent as if there were no lossy
+    // encoding.
+    lossy = LossyEncodeWithFeedback(
+        options, residual_key, reinterpret_cast<const float*>(content.data()),
+        val.NumElements(), &converted);
+  }
+  const bool convert = !lossy && val.dtype() == DT_FLOAT &&
+                       IsFloatTransferType(options.float_transfer_type());
+  if (!lossy && !convert &&
+      options.algorithm() == TensorCompressionOptions::NONE) {
+    return false;
+  }
+
+  DataType dtype = val.dtype();
+  StringPiece data = content;
+  if (lossy) {
+    data = converted;
+  } else if (convert) {
+    dtype = options.float_transfer_type();
+    converted.resize(val.NumElements() * ElementSize(dtype));
+    ConvertFromFloat(dtype, reinterpret_cast<const float*>(content.data()),
+                     val.NumElements(), &converted[0]);
+    data = converted;
+  }
+
+  TensorProto* proto = response->mutable_tensor();
+  proto->set_dtype(dtype);
+  val.shape().AsProto(proto->mutable_tensor_shape());
+  string* out = proto->mutable_tensor_content();
+  bool compressed = false;
+  switch (options.algorithm()) {
+    case TensorCompressionOptions::SNAPPY:
+      compressed = port::Snappy_Compress(data.data(), data.size(), out);
+      break;
+    case TensorCompressionOptions::ZLIB:
+      compressed = ZlibCompress(data, out);
+      break;
+    default:
+      break;
+  }
+  if (!compressed || out->size() >= data.size()) {
+    // Content that does not compress is sent as it is.
+    if (!convert && !lossy) return false;
+    out->swap(converted);
+    compressed = false;
+  }
+  if (compressed) {
+    response->set_content_compression(options.algorithm());
+  }
+  if (convert) {
+    response->set_original_dtype(val.dtype());
+  }
+  if (lossy) {
+    response->set_lossy_encoding(options.lossy_encoding());
+  }
+  return true;
+}
+
+const size_t TensorResponse::kMinSharedTensorBytes;
+
 TensorResponse::Source::~Source() {}
 
+TensorBuffer* TensorResponse::Source::ShareBuffer(const char* data,
+                                                  size_t num_bytes) {
+  return nullptr;
+}
+
 void TensorResponse::Clear() {
   on_host_ = false;
   device_ = nullptr;
@@ -36,6 +400,7 @@ void TensorResponse::Clear() {
 void TensorResponse::ClearTensor() {
   meta_.Clear();
   tensor_ = Tensor();
+  streamed_bytes_ = 0;
 }
 
 void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
@@ -77,6 +442,98 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response) {
   tensor_ = std::move(t);
 }
 
+Status TensorResponse::AppendStreamedContent(StringPiece data) {
+  if (!meta_.tensor_content_streamed()) {
+    return errors::InvalidArgument("Unexpected tensor content in response");
+  }
+  StringPiece content = tensor_.tensor_data();
+  if (data.size() > content.size() - streamed_bytes_) {
+    return errors::InvalidArgument("Received ", streamed_bytes_ + data.size(),
+                                   " bytes of tensor content, expected ",
+                                   content.size());
+  }
+  memcpy(const_cast<char*>(content.data()) + streamed_bytes_, data.data(),
+         data.size());
+  streamed_bytes_ += data.size();
+  return Status::OK();
+}
+
+Status TensorResponse::UncompressTensor(Allocator* allocator, Tensor* out) {
+  const TensorProto& proto = meta_.tensor();
+  const DataType dtype = meta_.original_dtype() != DT_INVALID
+                             ? meta_.original_dtype()
+                             : proto.dtype();
+  const auto lossy_encoding = meta_.lossy_encoding();
+  const bool lossy = lossy_encoding != TensorCompressionOptions::EXACT;
+  if (!TensorShape::IsValid(proto.tensor_shape()) ||
+      !DataTypeCanUseMemcpy(proto.dtype()) ||
+      (dtype != proto.dtype() &&
+       !(dtype == DT_FLOAT && IsFloatTransferType(proto.dtype()))) ||
+      (lossy && (dtype != DT_FLOAT || proto.dtype() != DT_FLOAT))) {
+    return errors::InvalidArgument("Invalid compressed tensor in response");
+  }
+  TensorShape shape(proto.tensor_shape());
+  Tensor t(allocator, dtype, shape);
+  // The size of the uncompressed content, or its largest size if it is
+  // lossily encoded.
+  const size_t num_bytes =
+      lossy ? MaxLossyEncodedBytes(lossy_encoding, shape.num_elements())
+            : shape.num_elements() * ElementSize(proto.dtype());
+  const string& content = proto.tensor_content();
+
+  // Uncompresses directly into "t", unless the content must be converted.
+  string uncompressed;
+  char* dst = const_cast<char*>(t.tensor_data().data());
+  if (dtype != proto.dtype() || lossy) {
+    uncompressed.resize(num_bytes);
+    dst = &uncompressed[0];
+  }
+  const char* src = dst;
+  size_t length = 0;
+  bool ok = false;
+  switch (meta_.content_compression()) {
+    case TensorCompressionOptions::NONE:
+      length = content.size();
+      ok = lossy ? length <= num_bytes : length == num_bytes;
+      src = content.data();
+      break;
+    case TensorCompressionOptions::SNAPPY: {
+      ok = port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                              &length) &&
+           (lossy ? length <= num_bytes : length == num_bytes) &&
+           port::Snappy_Uncompress(content.data(), content.size(), dst);
+      break;
+    }
+    case TensorCompressionOptions::ZLIB: {
+      uLongf zlib_length = num_bytes;
+      ok = uncompress(reinterpret_cast<Bytef*>(dst), &zlib_length,
+                      reinterpret_cast<const Bytef*>(content.data()),
+                      content.size()) == Z_OK &&
+           (lossy || zlib_length == num_bytes);
+      length = zlib_length;
+      break;
+    }
+    default:
+      break;
+  }
+  if (!ok) {
+    return errors::InvalidArgument("Cannot uncompress tensor from response");
+  }
+  if (lossy) {
+    if (!LossyDecode(lossy_encoding, StringPiece(src, length),
+                     shape.num_elements(), t.flat<float>().data())) {
+      return errors::InvalidArgument("Cannot decode tensor from response");
+    }
+  } else if (dtype != proto.dtype()) {
+    ConvertToFloat(proto.dtype(), src, shape.num_elements(),
+                   t.flat<float>().data());
+  } else if (src != dst) {
+    memcpy(dst, src, num_bytes);
+  }
+  *out = std::move(t);
+  return Status::OK();
+}
+
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
@@ -86,6 +543,11 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (IsCompressed(meta_)) {
+      Tensor host;
+      TF_RETURN_IF_ERROR(UncompressTensor(cpu_allocator(), &host));
+      host.AsProtoTensorContent(meta_.mutable_tensor());
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -143,7 +605,8 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Source* source) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -194,12 +657,30 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (static_cast<size_t>(num_bytes) !=
+            shape.num_elements() * DataTypeSize(tensor_meta->dtype())) {
+          return false;
+        }
+        // Memory that is not from allocator_ may not be usable for DMA, so
+        // the data is only shared if the tensor need not be gpu compatible.
+        const void* data;
+        int size;
+        TensorBuffer* shared = nullptr;
+        if (static_cast<size_t>(num_bytes) >= kMinSharedTensorBytes &&
+            !alloc_attrs_.gpu_compatible() &&
+            input->GetDirectBufferPointer(&data, &size) && size >= num_bytes &&
+            reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+          shared = source->ShareBuffer(static_cast<const char*>(data),
+                                       num_bytes);
+        }
+        if (shared != nullptr) {
+          tensor_ = Tensor(tensor_meta->dtype(), shape, shared);
+          shared->Unref();
+          if (!input->Skip(num_bytes)) return false;
+          break;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +714,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(&input, meta_.mutable_tensor(), source)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -259,6 +740,12 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kTensorContentStreamedFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        meta_.set_tensor_content_streamed((v != 0) ? true : false);
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -275,7 +762,11 @@ bool TensorResponse::ParseSlow(Source* source) {
   }
 
   Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
+  if (IsCompressed(meta_)) {
+    if (!UncompressTensor(allocator_, &parsed).ok()) {
+      return false;
+    }
+  } else if (!parsed.FromProto(allocator_, meta_.tensor())) {
     return false;
   }
   tensor_ = std::move(parsed);
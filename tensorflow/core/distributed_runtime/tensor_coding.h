@@ -64,8 +64,20 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer holding a reference to the "num_bytes" bytes at
+    // "data", which lie within the block last returned by the stream of
+    // contents(), so that a Tensor can be backed by the received data
+    // without copying it. The buffer must keep the data alive after the
+    // Source is destroyed. Returns nullptr, the default, if the data
+    // cannot be shared, in which case ParseFrom copies it.
+    virtual TensorBuffer* ShareBuffer(const char* data, size_t num_bytes);
   };
 
+  // The size of the smallest tensor content ParseFrom tries to share with
+  // its Source rather than copy.
+  static const size_t kMinSharedTensorBytes = 64 << 10;
+
   // Parse the RecvTensorResponse encoded in the data yielded by
   // source->contents() into *this.
   Status ParseFrom(Source* source);
@@ -78,6 +90,19 @@ class TensorResponse {
   // uninitialized backing storage for actual contents.
   void InitPartial(const RecvTensorResponse& response);
 
+  // For a response whose metadata has "tensor_content_streamed" set, copies
+  // "data" into the content of the tensor, after the bytes copied so far.
+  Status AppendStreamedContent(StringPiece data);
+
+  // Returns true if the whole content of the tensor has been copied by
+  // AppendStreamedContent().
+  bool StreamedContentComplete() const {
+    return streamed_bytes_ == tensor_.TotalBytes();
+  }
+
+  // Returns true if the tensor is allocated in host memory.
+  bool on_host() const { return on_host_; }
+
   // Return a reference to the parsed tensor.  The tensor will remain
   // live only until *this is destroyed or modified.
   const Tensor& tensor() const { return tensor_; }
@@ -88,8 +113,12 @@ class TensorResponse {
   const RecvTensorResponse& metadata() const { return meta_; }
 
  private:
+  // Initializes "*out" from the content of meta_.tensor(), which is
+  // compressed as described by meta_.
+  Status UncompressTensor(Allocator* allocator, Tensor* out);
+
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
+                             TensorProto* tensor_meta, Source* source);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -100,8 +129,25 @@ class TensorResponse {
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
+  // The number of bytes copied by AppendStreamedContent().
+  size_t streamed_bytes_ = 0;
 };
 
+// Fills in the "tensor", "content_compression", "original_dtype" and
+// "lossy_encoding" fields of "*response" with "val", compressed as
+// specified by "options". Returns false, leaving "*response" with
+// unspecified contents, if "val" is not to be compressed, e.g. because it
+// is smaller than options.min_bytes() or its content does not compress.
+bool CompressTensorToResponse(const TensorCompressionOptions& options,
+                              const Tensor& val, RecvTensorResponse* response);
+
+// As above. If options.error_feedback() is set, the error of the lossy
+// encoding of "val" is kept under "residual_key", e.g. the rendezvous key
+// of "val", and added to the next tensor compressed with the same key.
+bool CompressTensorToResponse(const TensorCompressionOptions& options,
+                              const Tensor& val, const string& residual_key,
+                              RecvTensorResponse* response);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
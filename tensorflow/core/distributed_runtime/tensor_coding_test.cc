@@ -15,10 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -72,6 +78,58 @@ class StringSource : public TensorResponse::Source {
   int block_size_;
 };
 
+// A TensorBuffer for part of the data of a Tensor, to which it holds a
+// reference.
+class SubTensorBuffer : public TensorBuffer {
+ public:
+  SubTensorBuffer(const Tensor& storage, const char* data, size_t size)
+      : storage_(storage), data_(const_cast<char*>(data)), size_(size) {}
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+  }
+
+ private:
+  const Tensor storage_;
+  char* const data_;
+  const size_t size_;
+};
+
+// A Source sharing the parts of its data that lie within a single block.
+class SharingSource : public TensorResponse::Source {
+ public:
+  SharingSource(const Tensor& storage, const char* data, int size,
+                int block_size)
+      : storage_(storage),
+        data_(data),
+        size_(size),
+        block_size_(block_size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.reset(
+        new protobuf::io::ArrayInputStream(data_, size_, block_size_));
+    return stream_.get();
+  }
+
+  TensorBuffer* ShareBuffer(const char* data, size_t num_bytes) override {
+    const int64 offset = data - data_;
+    if (offset / block_size_ != (offset + num_bytes - 1) / block_size_) {
+      return nullptr;
+    }
+    return new SubTensorBuffer(storage_, data, num_bytes);
+  }
+
+ private:
+  const Tensor storage_;
+  const char* const data_;
+  const int size_;
+  const int block_size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+};
+
 class TensorResponseTest : public ::testing::Test {
  public:
   void Validate(const Tensor& src, bool is_dead, bool use_tensor_content) {
@@ -156,6 +214,205 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, SharesTensorContentOfSource) {
+  const int kNumElems = 64 << 10;
+  Tensor src(DT_FLOAT, TensorShape({kNumElems}));
+  for (int i = 0; i < kNumElems; ++i) {
+    src.flat<float>()(i) = i;
+  }
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t content_offset = encoded.find(src.tensor_data().ToString());
+  ASSERT_NE(string::npos, content_offset);
+
+  DummyDevice cpu_device(Env::Default());
+  for (int block_size : {static_cast<int>(encoded.size()), 1024}) {
+    Tensor result;
+    const char* data;
+    {
+      // Places the encoded response so that the content is aligned.
+      Tensor storage(DT_INT8, TensorShape({static_cast<int64>(
+                                  encoded.size() + EIGEN_MAX_ALIGN_BYTES)}));
+      data = storage.tensor_data().data() + EIGEN_MAX_ALIGN_BYTES -
+             content_offset % EIGEN_MAX_ALIGN_BYTES;
+      memcpy(const_cast<char*>(data), encoded.data(), encoded.size());
+      SharingSource source(storage, data, encoded.size(), block_size);
+      TensorResponse response;
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      result = response.tensor();
+    }
+    // The content is only shared if it lies within one block.
+    const bool shared = block_size > 1024;
+    EXPECT_EQ(shared, result.tensor_data().data() == data + content_offset);
+    test::ExpectTensorEqual<float>(src, result);
+  }
+}
+
+TEST_F(TensorResponseTest, StreamedTensorContent) {
+  Tensor src(DT_INT32, TensorShape({3, 100}));
+  for (int i = 0; i < 300; ++i) {
+    src.flat<int32>()(i) = i;
+  }
+  RecvTensorResponse proto;
+  proto.set_tensor_content_streamed(true);
+  proto.mutable_tensor()->set_dtype(src.dtype());
+  src.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_TRUE(response.metadata().tensor_content_streamed());
+  EXPECT_FALSE(response.StreamedContentComplete());
+
+  StringPiece content = src.tensor_data();
+  TF_ASSERT_OK(response.AppendStreamedContent(content.substr(0, 1000)));
+  EXPECT_FALSE(response.StreamedContentComplete());
+  TF_ASSERT_OK(response.AppendStreamedContent(content.substr(1000)));
+  EXPECT_TRUE(response.StreamedContentComplete());
+  test::ExpectTensorEqual<int32>(src, response.tensor());
+
+  // The content does not fit in the tensor.
+  EXPECT_FALSE(response.AppendStreamedContent(content.substr(0, 4)).ok());
+}
+
+TEST_F(TensorResponseTest, CompressedTensor) {
+  Tensor src(DT_FLOAT, TensorShape({1000}));
+  for (int i = 0; i < 1000; ++i) {
+    src.flat<float>()(i) = (i % 10) * 0.5f;
+  }
+  DummyDevice cpu_device(Env::Default());
+  for (DataType transfer_type : {DT_INVALID, DT_HALF, DT_BFLOAT16}) {
+    for (auto algorithm :
+         {TensorCompressionOptions::NONE, TensorCompressionOptions::ZLIB}) {
+      TensorCompressionOptions options;
+      options.set_algorithm(algorithm);
+      options.set_float_transfer_type(transfer_type);
+      RecvTensorResponse proto;
+      const bool compressed = CompressTensorToResponse(options, src, &proto);
+      EXPECT_EQ(compressed, algorithm != TensorCompressionOptions::NONE ||
+                                transfer_type != DT_INVALID);
+      if (!compressed) continue;
+      string encoded;
+      proto.AppendToString(&encoded);
+      EXPECT_LT(encoded.size(), src.TotalBytes());
+
+      TensorResponse response;
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      StringSource source(&encoded, 1024);
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      // The values are exactly representable in both transfer types.
+      test::ExpectTensorEqual<float>(src, response.tensor());
+    }
+  }
+
+  // Tensors smaller than min_bytes are not compressed.
+  TensorCompressionOptions options;
+  options.set_algorithm(TensorCompressionOptions::ZLIB);
+  options.set_min_bytes(src.TotalBytes() + 1);
+  RecvTensorResponse proto;
+  EXPECT_FALSE(CompressTensorToResponse(options, src, &proto));
+}
+
+// Returns the tensor received for "src", compressed as specified by
+// "options".
+Tensor CompressAndParse(const TensorCompressionOptions& options,
+                        const Tensor& src, const string& residual_key) {
+  RecvTensorResponse proto;
+  EXPECT_TRUE(CompressTensorToResponse(options, src, residual_key, &proto));
+  string encoded;
+  proto.AppendToString(&encoded);
+  DummyDevice cpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  return response.tensor();
+}
+
+TEST_F(TensorResponseTest, LossyEncodedTensor) {
+  const int n = 1000;
+  Tensor src(DT_FLOAT, TensorShape({10, n / 10}));
+  auto src_flat = src.flat<float>();
+  for (int i = 0; i < n; ++i) {
+    src_flat(i) = (i % 2 ? -1 : 1) * (i % 97) * 0.25f;
+  }
+  for (auto algorithm :
+       {TensorCompressionOptions::NONE, TensorCompressionOptions::ZLIB}) {
+    TensorCompressionOptions options;
+    options.set_algorithm(algorithm);
+
+    options.set_lossy_encoding(TensorCompressionOptions::QUANTIZE_8BIT);
+    Tensor quantized = CompressAndParse(options, src, "");
+    ASSERT_EQ(src.shape(), quantized.shape());
+    // The values are within one level of the sent values.
+    const float level = (96 * 0.25f * 2) / 255;
+    for (int i = 0; i < n; ++i) {
+      EXPECT_NEAR(src_flat(i), quantized.flat<float>()(i), level * 1.001);
+    }
+
+    options.set_lossy_encoding(TensorCompressionOptions::TOP_K);
+    options.set_top_k_fraction(0.02);
+    Tensor top_k = CompressAndParse(options, src, "");
+    ASSERT_EQ(src.shape(), top_k.shape());
+    int num_sent = 0;
+    for (int i = 0; i < n; ++i) {
+      const float value = top_k.flat<float>()(i);
+      if (value == 0) continue;
+      ++num_sent;
+      EXPECT_EQ(src_flat(i), value);
+      EXPECT_GE(std::abs(value), 95 * 0.25f);
+    }
+    EXPECT_EQ(20, num_sent);
+
+    options.set_lossy_encoding(TensorCompressionOptions::ONE_BIT);
+    Tensor one_bit = CompressAndParse(options, src, "");
+    ASSERT_EQ(src.shape(), one_bit.shape());
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ(src_flat(i) < 0, one_bit.flat<float>()(i) < 0);
+    }
+  }
+
+  // Tensors with non-finite values are sent exactly.
+  TensorCompressionOptions options;
+  options.set_lossy_encoding(TensorCompressionOptions::ONE_BIT);
+  Tensor inf(DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&inf, {1, std::numeric_limits<float>::infinity()});
+  RecvTensorResponse proto;
+  EXPECT_FALSE(CompressTensorToResponse(options, inf, &proto));
+}
+
+TEST_F(TensorResponseTest, LossyEncodingErrorFeedback) {
+  TensorCompressionOptions options;
+  options.set_lossy_encoding(TensorCompressionOptions::TOP_K);
+  options.set_top_k_fraction(0.25);
+  options.set_error_feedback(true);
+  Tensor src(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&src, {4, 3, 2, 1});
+  const string key = "LossyEncodingErrorFeedback";
+
+  // The values that are not sent are added to the next tensor sent for
+  // the key, so each of them is eventually sent.
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({4, 0, 0, 0}),
+                                 CompressAndParse(options, src, key));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0, 6, 0, 0}),
+                                 CompressAndParse(options, src, key));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({8, 0, 0, 0}),
+                                 CompressAndParse(options, src, key));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0, 0, 8, 0}),
+                                 CompressAndParse(options, src, key));
+
+  // Other keys have residuals of their own.
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({4, 0, 0, 0}),
+                                 CompressAndParse(options, src, "other"));
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_INTERFACE_H_
 
 #include <functional>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -102,6 +104,15 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives the tensors of all the requests in "request", in one call.
+  // The response to the i-th request is parsed into "*responses[i]", each
+  // of which must have been initialized with InitAlloc().
+  virtual void RecvTensorBatchAsync(
+      CallOptions* opts, const RecvTensorBatchRequest* request,
+      const std::vector<TensorResponse*>& responses, StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorBatchAsync()"));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -15,12 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/framework/allocator.h"
 
+#include <atomic>
+
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/mem.h"
-#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -68,9 +69,24 @@ void EnableCPUAllocatorFullStats(bool enable) {
   cpu_allocator_collect_full_stats = enable;
 }
 
+namespace {
+// Raises *max to value if it is lower, without locking.
+void AtomicMax(std::atomic<int64>* max, int64 value) {
+  int64 current = max->load(std::memory_order_relaxed);
+  while (current < value &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+}  // namespace
+
 class CPUAllocator : public Allocator {
  public:
-  CPUAllocator() {}
+  CPUAllocator()
+      : num_allocs_(0),
+        bytes_in_use_(0),
+        max_bytes_in_use_(0),
+        max_alloc_size_(0) {}
 
   ~CPUAllocator() override {}
 
@@ -79,31 +95,32 @@ class CPUAllocator : public Allocator {
   void* AllocateRaw(size_t alignment, size_t num_bytes) override {
     void* p = port::AlignedMalloc(num_bytes, alignment);
     if (cpu_allocator_collect_stats) {
-      const std::size_t alloc_size = port::MallocExtension_GetAllocatedSize(p);
-      mutex_lock l(mu_);
-      ++stats_.num_allocs;
-      stats_.bytes_in_use += alloc_size;
-      stats_.max_bytes_in_use =
-          std::max<int64>(stats_.max_bytes_in_use, stats_.bytes_in_use);
-      stats_.max_alloc_size =
-          std::max<int64>(stats_.max_alloc_size, alloc_size);
+      const int64 alloc_size = port::MallocExtension_GetAllocatedSize(p);
+      num_allocs_.fetch_add(1, std::memory_order_relaxed);
+      AtomicMax(&max_bytes_in_use_,
+                bytes_in_use_.fetch_add(alloc_size,
+                                        std::memory_order_relaxed) +
+                    alloc_size);
+      AtomicMax(&max_alloc_size_, alloc_size);
     }
     return p;
   }
 
   void DeallocateRaw(void* ptr) override {
     if (cpu_allocator_collect_stats) {
-      const std::size_t alloc_size =
-          port::MallocExtension_GetAllocatedSize(ptr);
-      mutex_lock l(mu_);
-      stats_.bytes_in_use -= alloc_size;
+      const int64 alloc_size = port::MallocExtension_GetAllocatedSize(ptr);
+      bytes_in_use_.fetch_sub(alloc_size, std::memory_order_relaxed);
     }
     port::AlignedFree(ptr);
   }
 
   void GetStats(AllocatorStats* stats) override {
-    mutex_lock l(mu_);
-    *stats = stats_;
+    stats->Clear();
+    stats->num_allocs = num_allocs_.load(std::memory_order_relaxed);
+    stats->bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+    stats->max_bytes_in_use =
+        max_bytes_in_use_.load(std::memory_order_relaxed);
+    stats->max_alloc_size = max_alloc_size_.load(std::memory_order_relaxed);
   }
 
   size_t AllocatedSizeSlow(void* ptr) override {
@@ -111,8 +128,12 @@ class CPUAllocator : public Allocator {
   }
 
  private:
-  mutex mu_;
-  AllocatorStats stats_ GUARDED_BY(mu_);
+  // Updated with atomics so that collecting stats does not serialize the
+  // allocations.
+  std::atomic<int64> num_allocs_;
+  std::atomic<int64> bytes_in_use_;
+  std::atomic<int64> max_bytes_in_use_;
+  std::atomic<int64> max_alloc_size_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(CPUAllocator);
 };
@@ -337,6 +337,10 @@ struct AllocatorAttributes {
   bool gpu_compatible() const { return value & (0x1 << 2); }
   void set_track_sizes(bool v) { value |= (static_cast<int>(v) << 3); }
   bool track_sizes() const { return value & (0x1 << 3); }
+  // If set, the memory does not outlive the step that allocates it, and
+  // the executor may serve it from a per-step arena.
+  void set_step_scoped(bool v) { value |= (static_cast<int>(v) << 4); }
+  bool step_scoped() const { return value & (0x1 << 4); }
   void Merge(AllocatorAttributes other) { value |= other.value; }
   // Returns true if the fields set in *this is a subset of or equal to
   // those set in other.
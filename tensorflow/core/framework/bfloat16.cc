@@ -15,8 +15,29 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace tensorflow {
 
+namespace {
+
+// Returns the upper 16 bits of the float with bit pattern "bits", rounded to
+// nearest even, as the bfloat16 bit pattern.
+inline uint16_t RoundFloatBitsToBFloat16(uint32_t bits) {
+  if ((bits & 0x7fffffffu) > 0x7f800000u) {
+    // NaN: keep the sign and the top of the payload, and make it quiet.
+    return static_cast<uint16_t>((bits >> 16) | 0x0040u);
+  }
+  const uint32_t lsb = (bits >> 16) & 1;
+  return static_cast<uint16_t>((bits + 0x7fffu + lsb) >> 16);
+}
+
+}  // namespace
+
 void FloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
   const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
   uint16_t* q = reinterpret_cast<uint16_t*>(dst);
@@ -25,12 +46,55 @@ void FloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
       *q = p[0];  
     }  
 #else
+#ifdef __SSE2__
+  // Shifting right arithmetically keeps each upper half within int16 range,
+  // so the saturating pack below is exact.
+  for (; size >= 8; p += 16, q += 8, size -= 8) {
+    const __m128i lo = _mm_srai_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), 16);
+    const __m128i hi = _mm_srai_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(q), _mm_packs_epi32(lo, hi));
+  }
+#endif  // __SSE2__
     for (; size != 0; p += 2, q++, size--) {  
      *q = p[1];  
     }  
 #endif
 }
 
+void RoundFloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
+  uint16_t* q = reinterpret_cast<uint16_t*>(dst);
+#ifdef __SSE2__
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i bias = _mm_set1_epi32(0x7fff);
+  const __m128i abs_mask = _mm_set1_epi32(0x7fffffff);
+  const __m128i inf = _mm_set1_epi32(0x7f800000);
+  const __m128i quiet = _mm_set1_epi32(0x00400000);
+  const auto round_upper_halves = [&](const float* in) {
+    const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i lsb = _mm_and_si128(_mm_srli_epi32(bits, 16), one);
+    const __m128i rounded = _mm_add_epi32(bits, _mm_add_epi32(bias, lsb));
+    const __m128i is_nan =
+        _mm_cmpgt_epi32(_mm_and_si128(bits, abs_mask), inf);
+    const __m128i result =
+        _mm_or_si128(_mm_and_si128(is_nan, _mm_or_si128(bits, quiet)),
+                     _mm_andnot_si128(is_nan, rounded));
+    return _mm_srai_epi32(result, 16);
+  };
+  for (; size >= 8; src += 8, q += 8, size -= 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(q),
+                     _mm_packs_epi32(round_upper_halves(src),
+                                     round_upper_halves(src + 4)));
+  }
+#endif  // __SSE2__
+  for (; size != 0; src++, q++, size--) {
+    uint32_t bits;
+    memcpy(&bits, src, sizeof(bits));
+    *q = RoundFloatBitsToBFloat16(bits);
+  }
+}
+
 void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
   const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
   uint16_t* q = reinterpret_cast<uint16_t*>(dst);
@@ -40,6 +104,16 @@ void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
       q[1] = 0;  
     }
 #else  
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  for (; size >= 8; p += 8, q += 16, size -= 8) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(q),
+                     _mm_unpacklo_epi16(zero, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(q + 8),
+                     _mm_unpackhi_epi16(zero, v));
+  }
+#endif  // __SSE2__
     for (; size != 0; p++, q += 2, size--) {  
       q[0] = 0;  
       q[1] = *p;  
@@ -53,10 +53,15 @@ limitations under the License.
 namespace tensorflow {
 
 // Conversion routines between an array of float and bfloat16 of
-// "size".
+// "size".  FloatToBFloat16 truncates the mantissa.
 void FloatToBFloat16(const float* src, bfloat16* dst, int64 size);
 void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size);
 
+// Like FloatToBFloat16, but rounds each value to the nearest bfloat16, with
+// ties going to the value with an even mantissa.  NaNs stay (quiet) NaNs
+// rather than being rounded up to infinity.
+void RoundFloatToBFloat16(const float* src, bfloat16* dst, int64 size);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_FRAMEWORK_BFLOAT16_H_
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <string.h>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -42,6 +46,74 @@ TEST(Bfloat16Test, Conversion) {
   }
 }
 
+float BitsToFloat(uint32 bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+TEST(Bfloat16Test, Truncation) {
+  // Long enough to exercise both the vectorized loop and the scalar tail.
+  float a[37];
+  for (int i = 0; i < 37; ++i) {
+    a[i] = BitsToFloat(0x3f800000 + (i << 16) + 0xffff);
+  }
+  bfloat16 b[37];
+  FloatToBFloat16(a, b, 37);
+  for (int i = 0; i < 37; ++i) {
+    EXPECT_EQ(0x3f80 + i, b[i].value) << i;
+  }
+}
+
+TEST(Bfloat16Test, RoundToNearestEven) {
+  const std::vector<std::pair<uint32, uint16>> cases = {
+      {0x3f800000, 0x3f80},  // Exact.
+      {0x3f807fff, 0x3f80},  // Below the halfway point.
+      {0x3f808000, 0x3f80},  // Tie, rounds to the even mantissa.
+      {0x3f818000, 0x3f82},  // Tie, rounds to the even mantissa.
+      {0x3f808001, 0x3f81},  // Above the halfway point.
+      {0xbf808001, 0xbf81},  // Negative values round away from zero too.
+      {0x7f7fffff, 0x7f80},  // The largest float rounds up to infinity.
+      {0x7f800000, 0x7f80},  // Infinity.
+      {0xff800000, 0xff80},  // -Infinity.
+      {0x7f800001, 0x7fc0},  // Signaling NaN becomes a quiet NaN.
+      {0xffc00000, 0xffc0},  // -NaN.
+  };
+  // Repeat the cases so that most of them go through the vectorized loop.
+  std::vector<float> a;
+  std::vector<uint16> expected;
+  for (int r = 0; r < 3; ++r) {
+    for (const auto& c : cases) {
+      a.push_back(BitsToFloat(c.first));
+      expected.push_back(c.second);
+    }
+  }
+  std::vector<bfloat16> b(a.size());
+  RoundFloatToBFloat16(a.data(), b.data(), a.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(expected[i], b[i].value) << i;
+  }
+}
+
+TEST(Bfloat16Test, RoundTrip) {
+  bfloat16 a[45];
+  for (int i = 0; i < 45; ++i) {
+    a[i].value = static_cast<uint16>(0x3f80 + i * 0x1234);
+  }
+  float b[45];
+  bfloat16 c[45];
+  bfloat16 d[45];
+  BFloat16ToFloat(a, b, 45);
+  FloatToBFloat16(b, c, 45);
+  RoundFloatToBFloat16(b, d, 45);
+  for (int i = 0; i < 45; ++i) {
+    EXPECT_EQ(a[i].value, c[i].value) << i;
+    // NaN payloads are quieted; everything else is exactly representable.
+    const bool is_nan = (a[i].value & 0x7fff) > 0x7f80;
+    EXPECT_EQ(is_nan ? (a[i].value | 0x40) : a[i].value, d[i].value) << i;
+  }
+}
+
 static void BM_FloatToBFloat16(int iters) {
   testing::StopTiming();
   static const int N = 32 << 20;
@@ -61,6 +133,25 @@ static void BM_FloatToBFloat16(int iters) {
 }
 BENCHMARK(BM_FloatToBFloat16);
 
+static void BM_RoundFloatToBFloat16(int iters) {
+  testing::StopTiming();
+  static const int N = 32 << 20;
+  const int64 tot = static_cast<int64>(iters) * N;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * (sizeof(float) + sizeof(bfloat16)));
+
+  float* inp = new float[N];
+  bfloat16* out = new bfloat16[N];
+
+  testing::StartTiming();
+  while (iters--) {
+    RoundFloatToBFloat16(inp, out, N);
+  }
+  delete[] inp;
+  delete[] out;
+}
+BENCHMARK(BM_RoundFloatToBFloat16);
+
 static void BM_BFloat16ToFloat(int iters) {
   testing::StopTiming();
   static const int N = 32 << 20;
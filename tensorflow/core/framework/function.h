@@ -254,6 +254,10 @@ class FunctionCallFrame {
   Status GetRetvals(std::vector<Tensor>* rets) const;
   Status ConsumeRetvals(std::vector<Tensor>* rets);
 
+  // Clears the arguments and return values, so that the frame can be used
+  // for another call.
+  void Reset();
+
   // Callee methods.
   Status GetArg(int index, Tensor* val) const;
   Status SetRetval(int index, const Tensor& val);
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <algorithm>
+#include <array>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_def_util.h"
+#include "tensorflow/core/framework/step_arena_allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -274,6 +277,11 @@ OpKernelContext::~OpKernelContext() {
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   Allocator* allocator =
       params_->device->GetStepAllocator(attr, resource_manager());
+  if (attr.step_scoped() && params_->step_arenas != nullptr) {
+    allocator = params_->step_arenas->Get(allocator);
+  } else if (params_->wrap_allocator != nullptr) {
+    allocator = (*params_->wrap_allocator)(allocator);
+  }
   if (track_allocations()) {
     mutex_lock lock(mu_);
     for (const auto& wrapped : wrapped_allocators_) {
@@ -281,8 +289,10 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
         return wrapped.second;
       }
     }
+    // Allocations are only tracked when the step stats are collected, which
+    // also record the lifetime of each allocation.
     TrackingAllocator* wrapped_allocator =
-        new TrackingAllocator(allocator, attr.track_sizes());
+        new TrackingAllocator(allocator, attr.track_sizes(), true);
     wrapped_allocators_.push_back(std::make_pair(allocator, wrapped_allocator));
     return wrapped_allocator;
   } else {
@@ -842,6 +852,36 @@ static string Key(StringPiece op_type, const DeviceType& device_type,
                          label);
 }
 
+#ifdef SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+// With a static kernel table, the kernels of the ops in NECESSARY_OPS are
+// also indexed by the position of their op, so that looking them up doesn't
+// build and hash a string key. Kernels of other ops, e.g. system kernels, are
+// only in the KernelRegistry.
+static constexpr int kNumNecessaryOps =
+    sizeof(NECESSARY_OPS) / sizeof(*NECESSARY_OPS);
+
+// Entry i holds the kernels of NECESSARY_OPS[i]. The registrations are owned
+// by the KernelRegistry, whose elements never move.
+typedef std::array<std::vector<const KernelRegistration*>, kNumNecessaryOps>
+    StaticKernelTable;
+
+static StaticKernelTable* GlobalStaticKernelTable() {
+  static StaticKernelTable* static_kernel_table = new StaticKernelTable;
+  return static_kernel_table;
+}
+
+// Returns the index of op_type in the sorted NECESSARY_OPS, or -1.
+static int NecessaryOpIndex(StringPiece op_type) {
+  const char* const* begin = NECESSARY_OPS;
+  const char* const* end = begin + kNumNecessaryOps;
+  const char* const* iter = std::lower_bound(
+      begin, end, op_type,
+      [](const char* op, StringPiece x) { return StringPiece(op) < x; });
+  if (iter == end || op_type != *iter) return -1;
+  return iter - begin;
+}
+#endif  // SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+
 namespace kernel_factory {
 
 void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
@@ -852,8 +892,16 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
     const string key =
         Key(kernel_def->op(), DeviceType(kernel_def->device_type()),
             kernel_def->label());
-    GlobalKernelRegistryTyped()->insert(std::make_pair(
+    auto iter = GlobalKernelRegistryTyped()->insert(std::make_pair(
         key, KernelRegistration(*kernel_def, kernel_class_name, factory)));
+#ifdef SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+    const int op_index = NecessaryOpIndex(kernel_def->op());
+    if (op_index >= 0) {
+      (*GlobalStaticKernelTable())[op_index].push_back(&iter->second);
+    }
+#else
+    (void)iter;
+#endif
   }
   delete kernel_def;
 }
@@ -930,25 +978,46 @@ Status FindKernelRegistration(const DeviceType& device_type,
   // Label defaults to empty if not found in NodeDef.
   const string& label = GetNodeAttrString(node_def, kKernelAttr);
 
-  const string key = Key(node_def.op(), device_type, label);
-  auto regs = GlobalKernelRegistryTyped()->equal_range(key);
-  for (auto iter = regs.first; iter != regs.second; ++iter) {
-    // If there is a kernel registered for the op and device_type,
-    // check that the attrs match.
+  // If there is a kernel registered for the op and device_type,
+  // check that the attrs match.
+  auto check_registration =
+      [&node_def, reg, was_attr_mismatch](
+          const KernelRegistration& registration) -> Status {
     bool match;
-    TF_RETURN_IF_ERROR(AttrsMatch(node_def, iter->second.def, &match));
+    TF_RETURN_IF_ERROR(AttrsMatch(node_def, registration.def, &match));
     if (match) {
       if (*reg != nullptr) {
         return errors::InvalidArgument(
             "Multiple OpKernel registrations match NodeDef '",
             SummarizeNodeDef(node_def), "': '",
             ProtoShortDebugString((*reg)->def), "' and '",
-            ProtoShortDebugString(iter->second.def), "'");
+            ProtoShortDebugString(registration.def), "'");
       }
-      *reg = &iter->second;
+      *reg = &registration;
     } else {
       *was_attr_mismatch = true;
     }
+    return Status::OK();
+  };
+
+#ifdef SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+  const int op_index = NecessaryOpIndex(node_def.op());
+  if (op_index >= 0) {
+    for (const KernelRegistration* registration :
+         (*GlobalStaticKernelTable())[op_index]) {
+      if (registration->def.device_type() == device_type.type_string() &&
+          registration->def.label() == label) {
+        TF_RETURN_IF_ERROR(check_registration(*registration));
+      }
+    }
+    return Status::OK();
+  }
+#endif  // SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+
+  const string key = Key(node_def.op(), device_type, label);
+  auto regs = GlobalKernelRegistryTyped()->equal_range(key);
+  for (auto iter = regs.first; iter != regs.second; ++iter) {
+    TF_RETURN_IF_ERROR(check_registration(iter->second));
   }
   return Status::OK();
 }
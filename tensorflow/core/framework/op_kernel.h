@@ -72,6 +72,7 @@ class OpKernelContext;       // declared below
 class OpRegistryInterface;
 class ResourceMgr;
 class ScopedStepContainer;
+class StepArenas;
 class StepStatsCollector;
 
 class OpKernel {
@@ -519,6 +520,15 @@ class OpKernelContext {
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
 
+    // If not null, allocations with AllocatorAttributes::step_scoped() are
+    // served from these per-step arenas.
+    StepArenas* step_arenas = nullptr;
+
+    // If not null, every other allocator returned by get_allocator() is
+    // replaced by the result of this function, e.g. to serve the step from
+    // a static memory plan.
+    std::function<Allocator*(Allocator*)>* wrap_allocator = nullptr;
+
     // Mechanism used by this op kernel invocation to communicate with
     // computations running on other devices.
     Rendezvous* rendezvous = nullptr;
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -24,11 +26,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -44,6 +48,7 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name.set(buf_.data() + (b.edge_name.data() - b_base),
                 b.edge_name.size());
+  hash_ = b.hash_;
   return *this;
 }
 
@@ -106,11 +111,37 @@ Status Rendezvous::ParseKey(StringPiece key, ParsedKey* out) {
     out->src_device.set(parts[0].data(), parts[0].size());
     out->dst_device.set(parts[2].data(), parts[2].size());
     out->edge_name.set(parts[3].data(), parts[3].size());
+    out->hash_ = Hash64(out->buf_.data(), out->buf_.size());
     return Status::OK();
   }
   return errors::InvalidArgument("Invalid  rendezvous key: ", key);
 }
 
+/* static */
+void Rendezvous::ParsedKeyForFrameIter(const ParsedKey& key,
+                                       const FrameAndIter& frame_iter,
+                                       ParsedKey* out) {
+  // The frame and iteration follow the edge name, which is the last part
+  // of the key that ParseKey() points into.
+  const char* base = key.buf_.data();
+  const size_t prefix_size =
+      (key.edge_name.data() - base) + key.edge_name.size();
+  out->buf_.assign(base, prefix_size);
+  strings::StrAppend(&out->buf_, ";", frame_iter.frame_id, ":",
+                     frame_iter.iter_id);
+  const char* out_base = out->buf_.data();
+  out->src_device.set(out_base + (key.src_device.data() - base),
+                      key.src_device.size());
+  out->src = key.src;
+  out->src_incarnation = key.src_incarnation;
+  out->dst_device.set(out_base + (key.dst_device.data() - base),
+                      key.dst_device.size());
+  out->dst = key.dst;
+  out->edge_name.set(out_base + (key.edge_name.data() - base),
+                     key.edge_name.size());
+  out->hash_ = Hash64(out->buf_.data(), out->buf_.size());
+}
+
 Rendezvous::~Rendezvous() {}
 
 Status Rendezvous::Recv(const ParsedKey& key, const Args& recv_args,
@@ -147,23 +178,27 @@ Status Rendezvous::Recv(const ParsedKey& key, const Args& args, Tensor* val,
 
 class LocalRendezvousImpl : public Rendezvous {
  public:
-  explicit LocalRendezvousImpl(bool tolerate_dup_recv)
-      : tolerate_dup_recv_(tolerate_dup_recv) {}
+  explicit LocalRendezvousImpl(bool tolerate_dup_recv, int num_shards)
+      : tolerate_dup_recv_(tolerate_dup_recv),
+        num_shards_(std::max(num_shards, 1)),
+        shards_(new Shard[num_shards_]) {}
 
   Status Send(const ParsedKey& key, const Args& send_args, const Tensor& val,
               const bool is_dead) override {
     DoneCallback waiter = nullptr;
     Args recv_args;
-    uint64 key_hash = KeyHash(key.FullKey());
+    uint64 key_hash = key.FullKeyHash();
     VLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
+    Shard* shard = GetShard(key_hash);
     {
-      mutex_lock l(mu_);
-      if (!status_.ok()) {
-        return status_;
+      mutex_lock l(shard->mu);
+      if (!shard->status.ok()) {
+        return shard->status;
       }
+      Table& table = shard->table;
       Item* item = nullptr;
-      Table::iterator iter = table_.find(key_hash);
-      if (iter == table_.end()) {
+      Table::iterator iter = table.find(key_hash);
+      if (iter == table.end()) {
         // There is no waiter for this message. Insert the message
         // into the waiters table. The waiter will pick it up when
         // arrives.
@@ -180,7 +215,7 @@ class LocalRendezvousImpl : public Rendezvous {
         // The allocator attributes of item->value.
         item->send_alloc_attrs = send_args.alloc_attrs;
 
-        CHECK(table_.insert({key_hash, item}).second);
+        CHECK(table.insert({key_hash, item}).second);
         return Status::OK();
       } else {
         item = iter->second;
@@ -222,21 +257,23 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void RecvAsync(const ParsedKey& key, const Args& recv_args,
                  DoneCallback done) override {
-    uint64 key_hash = KeyHash(key.FullKey());
+    uint64 key_hash = key.FullKeyHash();
     VLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = GetShard(key_hash);
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       done(s, Args(), recv_args, Tensor(), false);
       return;
     }
-    Table::iterator iter = table_.find(key_hash);
-    if (iter != table_.end()) {
+    Table& table = shard->table;
+    Table::iterator iter = table.find(key_hash);
+    if (iter != table.end()) {
       Item* item = iter->second;
       if (item->has_been_recvd && !tolerate_dup_recv_) {
-        mu_.unlock();
+        shard->mu.unlock();
         done(errors::Aborted("Duplicated recv: ", key.FullKey()), Args(),
              recv_args, Tensor(), false);
       } else if (item->waiter == nullptr || tolerate_dup_recv_) {
@@ -259,13 +296,13 @@ class LocalRendezvousImpl : public Rendezvous {
         Args send_args;
         send_args.device_context = item->send_dev_context;
         send_args.alloc_attrs = item->send_alloc_attrs;
-        mu_.unlock();
+        shard->mu.unlock();
         done(Status::OK(), send_args, recv_args, v, is_dead);
         if (send_dev_context) send_dev_context->Unref();
       } else {
         // Already have a waiter in the waiters table under this key,
         // which should not happen.
-        mu_.unlock();
+        shard->mu.unlock();
         done(errors::Aborted("Duplicated recv: ", key.FullKey()), Args(),
              recv_args, Tensor(), false);
       }
@@ -281,20 +318,24 @@ class LocalRendezvousImpl : public Rendezvous {
       item->recv_dev_context = recv_args.device_context;
       item->recv_dev_context->Ref();
     }
-    CHECK(table_.insert({key_hash, item}).second);
-    mu_.unlock();
+    CHECK(table.insert({key_hash, item}).second);
+    shard->mu.unlock();
   }
 
   void StartAbort(const Status& status) override {
     CHECK(!status.ok());
-    std::vector<Item*> items;
     {
-      mutex_lock l(mu_);
-      if (!status_.ok()) return;
-      status_ = status;
-      items.reserve(table_.size());
-      for (const auto& p : table_) items.push_back(p.second);
-      table_.clear();
+      mutex_lock l(abort_mu_);
+      if (aborted_) return;
+      aborted_ = true;
+    }
+    std::vector<Item*> items;
+    for (int i = 0; i < num_shards_; ++i) {
+      Shard* shard = &shards_[i];
+      mutex_lock l(shard->mu);
+      shard->status = status;
+      for (const auto& p : shard->table) items.push_back(p.second);
+      shard->table.clear();
     }
     for (Item* item : items) {
       if (item->waiter != nullptr) {
@@ -327,29 +368,60 @@ class LocalRendezvousImpl : public Rendezvous {
       }
     }
   };
-  // We key the hash table by KeyHash of the Rendezvous::CreateKey string
-  static uint64 KeyHash(const StringPiece& k) {
-    return Hash64(k.data(), k.size());
+  // We key the hash table by the hash of the Rendezvous::CreateKey string,
+  // which ParseKey() caches in the ParsedKey.
+  typedef gtl::FlatMap<uint64, Item*> Table;
+
+  // The keys are partitioned by hash over independently locked shards,
+  // so that Send/Recv pairs on keys of different shards never contend.
+  // Each shard carries a copy of the abort status, set under its lock by
+  // StartAbort(), so that no item can be added to a shard once it has
+  // been drained.
+  struct Shard {
+    mutex mu;
+    Table table GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+  };
+
+  Shard* GetShard(uint64 key_hash) {
+    // The low bits of the hash pick the slot within a shard's FlatMap, so
+    // use the high bits to pick the shard.
+    return &shards_[(key_hash >> 32) % num_shards_];
   }
 
-  typedef gtl::FlatMap<uint64, Item*> Table;
+  const int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ GUARDED_BY(mu_);
-  Status status_;
+  // Ensures that only the first call to StartAbort() takes effect.
+  mutex abort_mu_;
+  bool aborted_ GUARDED_BY(abort_mu_) = false;
 
   ~LocalRendezvousImpl() override {
-    for (auto i : table_) {
-      delete i.second;
+    for (int i = 0; i < num_shards_; ++i) {
+      for (auto p : shards_[i].table) {
+        delete p.second;
+      }
     }
   }
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvousImpl);
 };
 
-Rendezvous* NewLocalRendezvous(bool tolerate_dup_recv) {
-  return new LocalRendezvousImpl(tolerate_dup_recv);
+Rendezvous* NewLocalRendezvous(bool tolerate_dup_recv, int num_shards) {
+  if (num_shards <= 0) {
+    static const int default_num_shards = [] {
+      int64 value;
+      Status status =
+          ReadInt64FromEnvVar("TF_RENDEZVOUS_NUM_SHARDS", 1, &value);
+      if (!status.ok()) {
+        LOG(ERROR) << status.error_message();
+        return 1;
+      }
+      return static_cast<int>(std::max<int64>(value, 1));
+    }();
+    num_shards = default_num_shards;
+  }
+  return new LocalRendezvousImpl(tolerate_dup_recv, num_shards);
 }
 
 }  // end namespace tensorflow
@@ -67,14 +67,26 @@ class Rendezvous : public core::RefCounted {
     ParsedKey& operator=(const ParsedKey& b);
     StringPiece FullKey() const { return buf_; }
 
+    // Hash64() of FullKey(), computed once when the key is parsed.
+    uint64 FullKeyHash() const { return hash_; }
+
    private:
     friend class Rendezvous;
     friend class SendOp;
     friend class RecvOp;
     string buf_;
+    uint64 hash_ = 0;
   };
   static Status ParseKey(StringPiece key, ParsedKey* out);
 
+  // Fills "*out" with the key that only differs from "key" in its frame and
+  // iteration. The device names, incarnation and edge name already parsed
+  // into "key" are reused, so that only the frame/iteration suffix of the
+  // key string is rebuilt.
+  static void ParsedKeyForFrameIter(const ParsedKey& key,
+                                    const FrameAndIter& frame_iter,
+                                    ParsedKey* out);
+
   // The caller is a tensor producer and it sends a message (a tensor
   // "val" and a bool "is_dead") under the given "key".
   //
@@ -126,7 +138,13 @@ class Rendezvous : public core::RefCounted {
 // already Recv'd values and make them available to duplicate Recv
 // calls.  This may be useful if the RPC layer is not reliable, but
 // comes at the cost of higher memory consumption.
-Rendezvous* NewLocalRendezvous(bool tolerate_dup_recv = false);
+//
+// The pending keys are partitioned over "num_shards" independently locked
+// tables, so that Send/Recv calls on different keys rarely contend. If
+// "num_shards" is 0, the value of the TF_RENDEZVOUS_NUM_SHARDS environment
+// variable is used, or 1 if it is unset.
+Rendezvous* NewLocalRendezvous(bool tolerate_dup_recv = false,
+                               int num_shards = 0);
 
 }  // end namespace tensorflow
 
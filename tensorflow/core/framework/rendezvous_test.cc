@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -62,6 +63,38 @@ TEST(RendezvousTest, Key) {
       Rendezvous::ParseKey(strings::StrCat(key, ";", key), &parsed).ok());
 }
 
+TEST(RendezvousTest, ParsedKeyForFrameIter) {
+  Rendezvous::ParsedKey top;
+  TF_EXPECT_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey("/job:mnist/replica:1/task:2/CPU:0", 7890,
+                            "/job:mnist/replica:1/task:2/GPU:0", "var0",
+                            FrameAndIter(0, 0)),
+      &top));
+  Rendezvous::ParsedKey expected;
+  TF_EXPECT_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey("/job:mnist/replica:1/task:2/CPU:0", 7890,
+                            "/job:mnist/replica:1/task:2/GPU:0", "var0",
+                            FrameAndIter(12, 345)),
+      &expected));
+  Rendezvous::ParsedKey in_loop;
+  Rendezvous::ParsedKeyForFrameIter(top, FrameAndIter(12, 345), &in_loop);
+  EXPECT_EQ(in_loop.FullKey(), expected.FullKey());
+  EXPECT_EQ(in_loop.FullKeyHash(), expected.FullKeyHash());
+  EXPECT_NE(in_loop.FullKeyHash(), top.FullKeyHash());
+  EXPECT_EQ(in_loop.src_device, expected.src_device);
+  EXPECT_EQ(in_loop.src_incarnation, expected.src_incarnation);
+  EXPECT_EQ(in_loop.src.type, "CPU");
+  EXPECT_EQ(in_loop.dst_device, expected.dst_device);
+  EXPECT_EQ(in_loop.dst.type, "GPU");
+  EXPECT_EQ(in_loop.edge_name, "var0");
+
+  // The derived key does not alias the buffer of the key it came from.
+  Rendezvous::ParsedKey copy = in_loop;
+  in_loop = top;
+  EXPECT_EQ(copy.FullKey(), expected.FullKey());
+  EXPECT_EQ(copy.edge_name, "var0");
+}
+
 class LocalRendezvousTest : public ::testing::Test {
  public:
   LocalRendezvousTest()
@@ -261,6 +294,90 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+class ShardedLocalRendezvousTest : public LocalRendezvousTest {
+ public:
+  ShardedLocalRendezvousTest() {
+    rendez_->Unref();
+    rendez_ = NewLocalRendezvous(false, 8);
+  }
+};
+
+TEST_F(ShardedLocalRendezvousTest, SendRecv) {
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V("hello"), false));
+  TF_ASSERT_OK(rendez_->Send(KeyBar(), args, V("world"), false));
+  EXPECT_TRUE(
+      errors::IsAborted(rendez_->Send(KeyFoo(), args, V("hello"), false)));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyBar(), args, &val, &is_dead));
+  EXPECT_EQ("world", V(val));
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(ShardedLocalRendezvousTest, ManyKeys) {
+  static const int N = 1000;
+  BlockingState state;
+  state.counter = N;
+  for (int i = 0; i < N; ++i) {
+    SchedClosure([this, &state, i]() {
+      Tensor val(DT_STRING);
+      bool val_dead = false;
+      Rendezvous::Args args;
+      TF_ASSERT_OK(
+          rendez_->Recv(MakeKey(strings::StrCat(i)), args, &val, &val_dead));
+      EXPECT_EQ(strings::StrCat(i), V(val));
+      bool done = false;
+      {
+        mutex_lock l(state.lock);
+        state.counter--;
+        done = (state.counter == 0);
+      }
+      if (done) {
+        state.done.Notify();
+      }
+    });
+  }
+  for (int i = 0; i < N; ++i) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(MakeKey(strings::StrCat(i)), args,
+                               V(strings::StrCat(i)), false));
+  }
+  state.done.WaitForNotification();
+}
+
+TEST_F(ShardedLocalRendezvousTest, AbortAllShards) {
+  static const int N = 16;
+  BlockingState state;
+  state.counter = N;
+  for (int i = 0; i < N; ++i) {
+    Rendezvous::Args args;
+    rendez_->RecvAsync(MakeKey(strings::StrCat(i)), args,
+                       [&state](const Status& s, const Rendezvous::Args&,
+                                const Rendezvous::Args&, const Tensor&, bool) {
+                         EXPECT_TRUE(errors::IsAborted(s));
+                         bool done = false;
+                         {
+                           mutex_lock l(state.lock);
+                           state.counter--;
+                           done = (state.counter == 0);
+                         }
+                         if (done) {
+                           state.done.Notify();
+                         }
+                       });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  state.done.WaitForNotification();
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  Rendezvous::Args args;
+  EXPECT_TRUE(errors::IsAborted(rendez_->Send(KeyFoo(), args, val, val_dead)));
+  EXPECT_TRUE(
+      errors::IsAborted(rendez_->Recv(KeyBar(), args, &val, &val_dead)));
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -346,4 +463,37 @@ static void BM_RecvSend(int iters) {
 }
 BENCHMARK(BM_RecvSend);
 
+// Each of 'num_threads' threads repeatedly sends and receives its own key.
+static void BM_SendRecvParallel(int iters, int num_shards) {
+  testing::StopTiming();
+  const int num_threads = 8;
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  Rendezvous* rendez = NewLocalRendezvous(false, num_shards);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int t = 0; t < num_threads; ++t) {
+    keys.push_back(MakeKey(strings::StrCat("key", t)));
+  }
+  BlockingCounter counter(num_threads);
+  testing::StartTiming();
+  for (int t = 0; t < num_threads; ++t) {
+    pool->Schedule([rendez, iters, &keys, &counter, t]() {
+      Tensor orig = V("val");
+      Tensor val(DT_STRING, TensorShape({}));
+      bool is_dead = false;
+      Rendezvous::Args args;
+      for (int i = 0; i < iters; ++i) {
+        TF_CHECK_OK(rendez->Send(keys[t], args, orig, is_dead));
+        TF_CHECK_OK(rendez->Recv(keys[t], args, &val, &is_dead));
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  testing::StopTiming();
+  rendez->Unref();
+  delete pool;
+}
+BENCHMARK(BM_SendRecvParallel)->Arg(1)->Arg(16);
+
 }  // namespace tensorflow
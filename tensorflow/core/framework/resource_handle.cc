@@ -41,6 +41,7 @@ void ResourceHandle::FromProto(const ResourceHandleProto& proto) {
   set_name(proto.name());
   set_hash_code(proto.hash_code());
   set_maybe_type_name(proto.maybe_type_name());
+  set_slot(0, -1, 0);
 }
 
 string ResourceHandle::SerializeAsString() const {
@@ -56,6 +56,19 @@ class ResourceHandle {
   const string& maybe_type_name() const { return maybe_type_name_; }
   void set_maybe_type_name(const string& value) { maybe_type_name_ = value; }
 
+  // The slot of the resource in the ResourceMgr that made this handle, which
+  // lets the ResourceMgr find the resource without its container and name.
+  // The slot is not serialized: handles parsed from protos are looked up by
+  // container and name.
+  uint64 resource_mgr_id() const { return resource_mgr_id_; }
+  int64 slot() const { return slot_; }
+  uint64 slot_generation() const { return slot_generation_; }
+  void set_slot(uint64 resource_mgr_id, int64 slot, uint64 slot_generation) {
+    resource_mgr_id_ = resource_mgr_id;
+    slot_ = slot;
+    slot_generation_ = slot_generation;
+  }
+
   // Conversion to and from ResourceHandleProto
   void AsProto(ResourceHandleProto* proto) const;
   void FromProto(const ResourceHandleProto& proto);
@@ -72,6 +85,9 @@ class ResourceHandle {
   string name_;
   uint64 hash_code_ = 0;
   string maybe_type_name_;
+  uint64 resource_mgr_id_ = 0;
+  int64 slot_ = -1;
+  uint64 slot_generation_ = 0;
 };
 
 // For backwards compatibility for when this was a proto
@@ -41,6 +41,9 @@ ResourceHandle MakeResourceHandle(OpKernelContext* ctx, const string& container,
   result.set_name(name);
   result.set_hash_code(type_index.hash_code());
   result.set_maybe_type_name(type_index.name());
+  if (ctx->resource_manager() != nullptr) {
+    ctx->resource_manager()->BindHandle(&result);
+  }
   return result;
 }
 
@@ -87,15 +90,40 @@ const char* ResourceMgr::DebugTypeName(uint64 hash_code) const {
   }
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+namespace {
+
+uint64 NextResourceMgrId() {
+  static std::atomic<uint64> next_id(1);
+  return next_id.fetch_add(1);
+}
+
+}  // namespace
+
+constexpr int64 ResourceMgr::kSlotsPerChunk;
+constexpr int64 ResourceMgr::kMaxSlotChunks;
+
+ResourceMgr::ResourceMgr() : ResourceMgr("localhost") {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container), id_(NextResourceMgrId()) {
+  for (auto& chunk : slot_chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
 
-ResourceMgr::~ResourceMgr() { Clear(); }
+ResourceMgr::~ResourceMgr() {
+  Clear();
+  for (auto& chunk : slot_chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
 
 void ResourceMgr::Clear() {
   mutex_lock l(mu_);
+  for (const auto& p : slot_indices_) {
+    FreeSlots(p.first);
+  }
+  slot_indices_.clear();
   for (const auto& p : containers_) {
     for (const auto& q : *p.second) {
       q.second->Unref();
@@ -144,8 +172,14 @@ Status ResourceMgr::DoCreate(const string& container, TypeIndex type,
     if (*b == nullptr) {
       *b = new Container;
     }
-    if ((*b)->insert({{type.hash_code(), name}, resource}).second) {
+    const Key key(type.hash_code(), name);
+    if ((*b)->insert({key, resource}).second) {
       TF_RETURN_IF_ERROR(InsertDebugTypeName(type.hash_code(), type.name()));
+      Slot* slot = FindBoundSlot(container, key);
+      if (slot != nullptr) {
+        mutex_lock sl(slot->mu);
+        slot->resource = resource;
+      }
       return Status::OK();
     }
   }
@@ -189,6 +223,11 @@ Status ResourceMgr::DoDelete(const string& container, uint64 type_hash_code,
     }
     base = iter->second;
     b->erase(iter);
+    Slot* slot = FindBoundSlot(container, {type_hash_code, resource_name});
+    if (slot != nullptr) {
+      mutex_lock sl(slot->mu);
+      slot->resource = nullptr;
+    }
   }
   CHECK(base != nullptr);
   base->Unref();
@@ -209,6 +248,10 @@ Status ResourceMgr::Cleanup(const string& container) {
   Container* b = nullptr;
   {
     mutex_lock l(mu_);
+    if (slot_indices_.count(container) > 0) {
+      FreeSlots(container);
+      slot_indices_.erase(container);
+    }
     auto iter = containers_.find(container);
     if (iter == containers_.end()) {
       // Nothing to cleanup, it's OK.
@@ -225,6 +268,88 @@ Status ResourceMgr::Cleanup(const string& container) {
   return Status::OK();
 }
 
+ResourceMgr::Slot* ResourceMgr::FindSlot(int64 index) const {
+  if (index < 0 || index >= kSlotsPerChunk * kMaxSlotChunks) {
+    return nullptr;
+  }
+  Slot* chunk =
+      slot_chunks_[index / kSlotsPerChunk].load(std::memory_order_acquire);
+  return chunk == nullptr ? nullptr : &chunk[index % kSlotsPerChunk];
+}
+
+ResourceMgr::Slot* ResourceMgr::FindBoundSlot(const string& container,
+                                              const Key& key) const {
+  auto indices = slot_indices_.find(container);
+  if (indices == slot_indices_.end()) {
+    return nullptr;
+  }
+  auto index = indices->second.find(key);
+  return index == indices->second.end() ? nullptr : FindSlot(index->second);
+}
+
+void ResourceMgr::FreeSlots(const string& container) {
+  for (const auto& p : slot_indices_[container]) {
+    Slot* slot = FindSlot(p.second);
+    {
+      mutex_lock sl(slot->mu);
+      ++slot->generation;
+      slot->resource = nullptr;
+    }
+    free_slots_.push_back(p.second);
+  }
+}
+
+void ResourceMgr::BindHandle(ResourceHandle* handle) {
+  mutex_lock l(mu_);
+  SlotIndices& indices = slot_indices_[handle->container()];
+  const Key key(handle->hash_code(), handle->name());
+  auto iter = indices.find(key);
+  int64 index;
+  if (iter != indices.end()) {
+    index = iter->second;
+  } else if (!free_slots_.empty()) {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  } else if (num_slots_ < kSlotsPerChunk * kMaxSlotChunks) {
+    if (num_slots_ % kSlotsPerChunk == 0) {
+      slot_chunks_[num_slots_ / kSlotsPerChunk].store(
+          new Slot[kSlotsPerChunk], std::memory_order_release);
+    }
+    index = num_slots_++;
+  } else {
+    // Out of slots, the handle is looked up by container and name.
+    return;
+  }
+  Slot* slot = FindSlot(index);
+  mutex_lock sl(slot->mu);
+  if (iter == indices.end()) {
+    indices.emplace(key, index);
+    // The resource may have been created before the handle.
+    const Container* b = gtl::FindPtrOrNull(containers_, handle->container());
+    slot->resource = b == nullptr ? nullptr : gtl::FindPtrOrNull(*b, key);
+  }
+  handle->set_slot(id_, index, slot->generation);
+}
+
+bool ResourceMgr::LookupSlot(const ResourceHandle& handle,
+                             ResourceBase** resource) const {
+  if (handle.resource_mgr_id() != id_) {
+    return false;
+  }
+  Slot* slot = FindSlot(handle.slot());
+  if (slot == nullptr) {
+    return false;
+  }
+  mutex_lock l(slot->mu);
+  if (slot->generation != handle.slot_generation() ||
+      slot->resource == nullptr) {
+    return false;
+  }
+  *resource = slot->resource;
+  (*resource)->Ref();
+  return true;
+}
+
 static bool IsValidContainerName(StringPiece s) {
   using ::tensorflow::strings::Scanner;
   return Scanner(s)
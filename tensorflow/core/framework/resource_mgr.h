@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <string>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/graph.pb.h"  // TODO(b/62899350): Remove
@@ -128,6 +130,21 @@ class ResourceMgr {
   Status Lookup(const string& container, const string& name,
                 T** resource) const TF_MUST_USE_RESULT;
 
+  // Binds "handle" to the slot of its container, type and name in *this,
+  // so that Lookup(handle) finds the resource without the container map and
+  // the global lock. MakeResourceHandle() binds the handles it makes.
+  void BindHandle(ResourceHandle* handle);
+
+  // Returns the resource pointed by "handle" in "*resource", through its
+  // slot if "handle" was bound by *this, and otherwise by container and
+  // name. The caller takes the ownership of one ref on "*resource".
+  //
+  // REQUIRES: std::is_base_of<ResourceBase, T>
+  // REQUIRES: resource != nullptr
+  template <typename T>
+  Status Lookup(const ResourceHandle& handle,
+                T** resource) const TF_MUST_USE_RESULT;
+
   // If "container" has a resource "name", returns it in
   // "*resource". Otherwise, invokes creator() to create the resource.
   // The caller takes the ownership of one ref on "*resource".
@@ -171,10 +188,46 @@ class ResourceMgr {
   };
   typedef std::unordered_map<Key, ResourceBase*, KeyHash, KeyEqual> Container;
 
+  // A slot holds the resource of one (container, type, name) key, if it
+  // exists, for the handles bound to the key. Its lock is only contended by
+  // the users of that resource. The slots of a container are reused once
+  // it is cleaned up, which bumps their generation so that stale handles
+  // fall back to the container map.
+  struct Slot {
+    mutex mu;
+    uint64 generation GUARDED_BY(mu) = 0;
+    ResourceBase* resource GUARDED_BY(mu) = nullptr;
+  };
+  // Slots are allocated by chunks that stay at the same address until *this
+  // is destroyed, so that they can be found without locking mu_.
+  static constexpr int64 kSlotsPerChunk = 1024;
+  static constexpr int64 kMaxSlotChunks = 1024;
+  // key -> slot index.
+  typedef std::unordered_map<Key, int64, KeyHash, KeyEqual> SlotIndices;
+
   const string default_container_;
+  // Unique in the process, unlike the address of *this.
+  const uint64 id_;
   mutable mutex mu_;
   std::unordered_map<string, Container*> containers_ GUARDED_BY(mu_);
 
+  std::atomic<Slot*> slot_chunks_[kMaxSlotChunks];
+  int64 num_slots_ GUARDED_BY(mu_) = 0;
+  std::vector<int64> free_slots_ GUARDED_BY(mu_);
+  // container -> bound keys.
+  std::unordered_map<string, SlotIndices> slot_indices_ GUARDED_BY(mu_);
+
+  // Returns the slot "index", or nullptr if it was never allocated.
+  Slot* FindSlot(int64 index) const;
+  // Returns the slot bound to "key" of "container", or nullptr.
+  Slot* FindBoundSlot(const string& container, const Key& key) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Unbinds the slots of "container" and makes them available for reuse.
+  void FreeSlots(const string& container) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true, and the resource with a ref in "*resource", if "handle"
+  // is bound to a slot of *this holding a resource.
+  bool LookupSlot(const ResourceHandle& handle, ResourceBase** resource) const;
+
   Status DoCreate(const string& container, TypeIndex type, const string& name,
                   ResourceBase* resource) TF_MUST_USE_RESULT;
   Status DoLookup(const string& container, TypeIndex type, const string& name,
@@ -340,6 +393,11 @@ class ResourceHandleOp : public OpKernel {
  private:
   string container_;
   string name_;
+  // The handle is made once, as binding it to its slot takes the lock of
+  // the ResourceMgr.
+  mutex mu_;
+  Tensor resource_;
+  std::atomic<bool> initialized_{false};
 };
 
 // Registers a kernel for an op which produces a handle to a resource of the
@@ -378,6 +436,20 @@ Status ResourceMgr::Lookup(const string& container, const string& name,
   return s;
 }
 
+template <typename T>
+Status ResourceMgr::Lookup(const ResourceHandle& handle, T** resource) const {
+  CheckDeriveFromResourceBase<T>();
+  ResourceBase* found = nullptr;
+  if (handle.hash_code() != MakeTypeIndex<T>().hash_code() ||
+      !LookupSlot(handle, &found)) {
+    return Lookup(handle.container(), handle.name(), resource);
+  }
+  // It's safe to down cast 'found' to T* since the type hash code is part
+  // of the key bound to the slot.
+  *resource = static_cast<T*>(found);
+  return Status::OK();
+}
+
 template <typename T>
 Status ResourceMgr::LookupOrCreate(const string& container, const string& name,
                                    T** resource,
@@ -469,7 +541,7 @@ template <typename T>
 Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
                       T** value) {
   TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
-  return ctx->resource_manager()->Lookup(p.container(), p.name(), value);
+  return ctx->resource_manager()->Lookup(p, value);
 }
 
 template <typename T>
@@ -506,10 +578,19 @@ ResourceHandleOp<T>::ResourceHandleOp(OpKernelConstruction* context)
 
 template <typename T>
 void ResourceHandleOp<T>::Compute(OpKernelContext* ctx) {
-  Tensor* output = nullptr;
-  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
-  output->scalar<ResourceHandle>()() =
-      MakeResourceHandle<T>(ctx, container_, name_);
+  if (!initialized_.load(std::memory_order_acquire)) {
+    mutex_lock ml(mu_);
+    if (!initialized_.load(std::memory_order_relaxed)) {
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_RESOURCE, TensorShape({}),
+                                             &resource_, attr));
+      resource_.scalar<ResourceHandle>()() =
+          MakeResourceHandle<T>(ctx, container_, name_);
+      initialized_.store(true, std::memory_order_release);
+    }
+  }
+  ctx->set_output(0, resource_);
 }
 
 }  //  end namespace tensorflow
@@ -321,4 +321,64 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   r->Unref();
 }
 
+TEST(ResourceHandleTest, LookupThroughSlot) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  // The resource is created before the second handle, after the first one.
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  EXPECT_GE(p.slot(), 0);
+  StubResource* r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+  ResourceHandle q =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  EXPECT_EQ(p.slot(), q.slot());
+  for (const ResourceHandle& handle : {p, q}) {
+    StubResource* lookup_r = nullptr;
+    TF_EXPECT_OK(LookupResource(&ctx, handle, &lookup_r));
+    EXPECT_EQ(r, lookup_r);
+    lookup_r->Unref();
+  }
+
+  // Handles that went through a proto are looked up by container and name.
+  ResourceHandle parsed;
+  ASSERT_TRUE(parsed.ParseFromString(p.SerializeAsString()));
+  EXPECT_EQ(-1, parsed.slot());
+  StubResource* lookup_r = nullptr;
+  TF_EXPECT_OK(LookupResource(&ctx, parsed, &lookup_r));
+  EXPECT_EQ(r, lookup_r);
+  lookup_r->Unref();
+
+  TF_EXPECT_OK(DeleteResource<StubResource>(&ctx, p));
+  EXPECT_FALSE(LookupResource(&ctx, p, &lookup_r).ok());
+  r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+  TF_EXPECT_OK(LookupResource(&ctx, p, &lookup_r));
+  EXPECT_EQ(r, lookup_r);
+  lookup_r->Unref();
+
+  // The slot is reused for another resource once its container is cleaned
+  // up, which the stale handle must not see.
+  TF_EXPECT_OK(resource_mgr.Cleanup("container"));
+  ResourceHandle other =
+      MakeResourceHandle<StubResource>(&ctx, "container", "other");
+  EXPECT_EQ(p.slot(), other.slot());
+  TF_EXPECT_OK(CreateResource(&ctx, other, new StubResource));
+  EXPECT_FALSE(LookupResource(&ctx, p, &lookup_r).ok());
+  TF_EXPECT_OK(LookupResource(&ctx, other, &lookup_r));
+  lookup_r->Unref();
+
+  // Handles bound by another ResourceMgr are looked up by name.
+  ResourceMgr other_resource_mgr("");
+  TF_EXPECT_OK(other_resource_mgr.Create("container", "other",
+                                         new StubResource));
+  TF_EXPECT_OK(other_resource_mgr.Lookup(other, &lookup_r));
+  lookup_r->Unref();
+}
+
 }  // end namespace tensorflow
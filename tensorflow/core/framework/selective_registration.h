@@ -42,6 +42,12 @@ limitations under the License.
 //   // Op kernel classes where this is false won't be registered.
 //   SHOULD_REGISTER_OP_KERNEL(clz)
 // The macros should be defined using constexprs.
+//
+// 3. Optionally, also define SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE to look
+//    up the kernels of the registered ops by their index in a static table
+//    instead of by a string key. ops_to_register.h must then also define:
+//   // A constexpr array of the names of the registered ops, sorted.
+//   NECESSARY_OPS
 
 #include "ops_to_register.h"
 
@@ -49,7 +55,18 @@ limitations under the License.
      !defined(SHOULD_REGISTER_OP_KERNEL))
 static_assert(false, "ops_to_register.h must define SHOULD_REGISTER macros");
 #endif
+#if defined(SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE) && \
+    !defined(NECESSARY_OPS)
+static_assert(false,
+              "SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE needs NECESSARY_OPS "
+              "from ops_to_register.h");
+#endif
 #else
+#ifdef SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE
+static_assert(false,
+              "SELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE needs "
+              "SELECTIVE_REGISTRATION");
+#endif
 #define SHOULD_REGISTER_OP(op) true
 #define SHOULD_REGISTER_OP_GRADIENT true
 #define SHOULD_REGISTER_OP_KERNEL(clz) true
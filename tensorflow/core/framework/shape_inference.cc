@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/framework/shape_inference.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "tensorflow/core/framework/node_def.pb_text.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -22,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace shape_inference {
@@ -29,6 +34,44 @@ namespace shape_inference {
 constexpr int32 InferenceContext::kUnknownRank;
 constexpr int64 InferenceContext::kUnknownDim;
 
+namespace {
+
+// The output dimensions stored by InferenceContext::RunWithCache, keyed by
+// InferenceContext::ShapeFnCacheKey. Shared by all the ShapeRefiners and
+// Grappler passes of the process.
+class ShapeFnCache {
+ public:
+  static ShapeFnCache* Global() {
+    static ShapeFnCache* cache = new ShapeFnCache;
+    return cache;
+  }
+
+  bool Lookup(const string& key, std::vector<std::vector<int64>>* dims) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *dims = it->second;
+    return true;
+  }
+
+  void Insert(const string& key, std::vector<std::vector<int64>> dims) {
+    mutex_lock l(mu_);
+    // Entries are small, so a full cache is simply dropped instead of
+    // tracking their use.
+    if (entries_.size() >= kMaxEntries) entries_.clear();
+    entries_[key] = std::move(dims);
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 1 << 16;
+
+  mutex mu_;
+  std::unordered_map<string, std::vector<std::vector<int64>>> entries_
+      GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 InferenceContext::InferenceContext(
     int graph_def_version, const NodeDef* node_def, const OpDef& op_def,
     const std::vector<TensorShapeProto>& input_shapes,
@@ -165,6 +208,77 @@ Status InferenceContext::Run(
   return s;
 }
 
+Status InferenceContext::RunWithCache(
+    const std::function<Status(shape_inference::InferenceContext* c)>& fn,
+    bool* cached) {
+  *cached = false;
+  string key;
+  if (!ShapeFnCacheKey(&key)) {
+    return Run(fn);
+  }
+  std::vector<std::vector<int64>> output_dims;
+  if (ShapeFnCache::Global()->Lookup(key, &output_dims) &&
+      output_dims.size() == outputs_.size()) {
+    for (int i = 0; i < outputs_.size(); ++i) {
+      std::vector<DimensionHandle> dims;
+      dims.reserve(output_dims[i].size());
+      for (int64 d : output_dims[i]) {
+        dims.push_back(MakeDim(d));
+      }
+      outputs_[i] = MakeShape(dims);
+    }
+    *cached = true;
+    return Status::OK();
+  }
+
+  TF_RETURN_IF_ERROR(Run(fn));
+  for (int i = 0; i < inputs_.size(); ++i) {
+    if (requested_input_tensor_[i] ||
+        requested_input_tensor_as_partial_shape_[i]) {
+      return Status::OK();
+    }
+  }
+  output_dims.resize(outputs_.size());
+  for (int i = 0; i < outputs_.size(); ++i) {
+    if (output_handle_shapes_and_types_[i] != nullptr ||
+        !FullyDefined(outputs_[i])) {
+      return Status::OK();
+    }
+    for (int j = 0; j < Rank(outputs_[i]); ++j) {
+      output_dims[i].push_back(Value(Dim(outputs_[i], j)));
+    }
+  }
+  ShapeFnCache::Global()->Insert(key, std::move(output_dims));
+  return Status::OK();
+}
+
+bool InferenceContext::ShapeFnCacheKey(string* key) {
+  strings::StrAppend(key, node_def_.op(), ";", graph_def_version_);
+  for (int i = 0; i < inputs_.size(); ++i) {
+    if (input_handle_shapes_and_types_[i] != nullptr ||
+        !FullyDefined(inputs_[i])) {
+      return false;
+    }
+    strings::StrAppend(key, ";");
+    for (int j = 0; j < Rank(inputs_[i]); ++j) {
+      strings::StrAppend(key, Value(Dim(inputs_[i], j)), ",");
+    }
+  }
+  // The attr map has no defined order.
+  std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+  attrs.reserve(node_def_.attr_size());
+  for (const auto& attr : node_def_.attr()) {
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  string value;
+  for (const auto& attr : attrs) {
+    attr.second->SerializeToString(&value);
+    strings::StrAppend(key, ";", attr.first, "=", value.size(), ":", value);
+  }
+  return true;
+}
+
 Status InferenceContext::set_output(StringPiece output_name,
                                     const std::vector<ShapeHandle>& shapes) {
   const auto result = output_name_map_.find(output_name.ToString());
@@ -218,6 +218,19 @@ class InferenceContext {
   Status Run(
       const std::function<Status(shape_inference::InferenceContext* c)>& fn);
 
+  // Same as Run(fn), but reuses the output shapes computed by an earlier call
+  // in the process for the same op, attributes and graph-def version if the
+  // input shapes are fully defined and equal, and no input carries resource
+  // handle data. Results are only kept if 'fn' did not ask for input tensors,
+  // set no output handle data and produced fully defined output shapes, so a
+  // reused result is the one 'fn' would compute. Sets <*cached> to true then.
+  //
+  // 'fn' must only depend on the context it is passed, like the shape
+  // functions registered on ops.
+  Status RunWithCache(
+      const std::function<Status(shape_inference::InferenceContext* c)>& fn,
+      bool* cached);
+
   // Merge the stored shape of the input in position idx with <shape> according
   // to the following rules:
   //
@@ -637,6 +650,11 @@ class InferenceContext {
 
   DimensionHandle GetDimension(const DimensionOrConstant& d);
 
+  // Returns false if the outputs can't be cached by RunWithCache, else fills
+  // <*key> with a string that identifies the op, its attributes and the input
+  // shapes.
+  bool ShapeFnCacheKey(string* key);
+
   Status ReturnUnknownShape(ShapeHandle* out) {
     *out = UnknownShape();
     return Status::OK();
@@ -1735,5 +1735,63 @@ TEST_F(ShapeInferenceTest, RelaxOutputHandleShapesAndTypes) {
   TestRelaxHandles(false /* input_not_output */);
 }
 
+TEST_F(ShapeInferenceTest, RunWithCache) {
+  OpDef op_def = MakeOpDef(1, 1);
+  NodeDef def;
+  TF_ASSERT_OK(NodeDefBuilder("dummy", &op_def)
+                   .Attr("foo", "run_with_cache")
+                   .Input(FakeInput())
+                   .Finalize(&def));
+  NodeDef other_def = def;
+  (*other_def.mutable_attr())["foo"].set_s("other");
+  int num_calls = 0;
+  auto fn = [&num_calls](InferenceContext* c) {
+    ++num_calls;
+    c->set_output(0, c->Matrix(c->Dim(c->input(0), 0), 3));
+    return Status::OK();
+  };
+  auto run = [&fn](const NodeDef& def, const OpDef& op_def,
+                   PartialTensorShape input_shape, bool expect_cached) {
+    InferenceContext c(kVersion, &def, op_def, {input_shape}, {}, {}, {});
+    bool cached = !expect_cached;
+    TF_EXPECT_OK(c.RunWithCache(fn, &cached));
+    EXPECT_EQ(expect_cached, cached);
+    return c.DebugString(c.output(0));
+  };
+
+  EXPECT_EQ("[2,3]", run(def, op_def, S({2}), false));
+  EXPECT_EQ(1, num_calls);
+  EXPECT_EQ("[2,3]", run(def, op_def, S({2}), true));
+  EXPECT_EQ(1, num_calls);
+
+  // Other input shapes or attributes miss.
+  EXPECT_EQ("[4,3]", run(def, op_def, S({4}), false));
+  EXPECT_EQ("[2,3]", run(other_def, op_def, S({2}), false));
+  EXPECT_EQ(3, num_calls);
+
+  // Partially defined inputs are never cached.
+  EXPECT_EQ("[?,3]", run(def, op_def, S({-1}), false));
+  EXPECT_EQ("[?,3]", run(def, op_def, S({-1}), false));
+  EXPECT_EQ(5, num_calls);
+
+  // Neither are outputs of shape functions that ask for input tensors.
+  NodeDef tensor_def = def;
+  (*tensor_def.mutable_attr())["foo"].set_s("input_tensor");
+  for (int i = 0; i < 2; ++i) {
+    InferenceContext c(kVersion, &tensor_def, op_def, {S({2})}, {}, {}, {});
+    bool cached = true;
+    TF_EXPECT_OK(c.RunWithCache(
+        [&num_calls](InferenceContext* c) {
+          ++num_calls;
+          c->set_output(0, c->input_tensor(0) == nullptr ? c->UnknownShape()
+                                                         : c->input(0));
+          return Status::OK();
+        },
+        &cached));
+    EXPECT_FALSE(cached);
+  }
+  EXPECT_EQ(7, num_calls);
+}
+
 }  // namespace shape_inference
 }  // namespace tensorflow
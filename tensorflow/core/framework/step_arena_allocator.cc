@@ -0,0 +1,136 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+const size_t StepArenaAllocator::kBlockSize;
+const size_t StepArenaAllocator::kMaxArenaAllocationSize;
+
+StepArenaAllocator::StepArenaAllocator(Allocator* allocator)
+    : allocator_(allocator) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (const auto& block : blocks_) {
+    allocator_->DeallocateRaw(block.first);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  alignment = std::max(alignment, Allocator::kAllocatorAlignment);
+  if (num_bytes <= kMaxArenaAllocationSize) {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    while (true) {
+      if (current_block_ < blocks_.size()) {
+        const auto& block = blocks_[current_block_];
+        const size_t offset =
+            (current_offset_ + alignment - 1) / alignment * alignment;
+        if (offset + num_bytes <= block.second) {
+          current_offset_ = offset + num_bytes;
+          ++num_outstanding_;
+          return block.first + offset;
+        }
+        if (current_block_ + 1 < blocks_.size()) {
+          ++current_block_;
+          current_offset_ = 0;
+          continue;
+        }
+      }
+      void* block = allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                            kBlockSize, allocation_attr);
+      if (block == nullptr) break;
+      blocks_.emplace_back(static_cast<char*>(block), kBlockSize);
+      current_block_ = blocks_.size() - 1;
+      current_offset_ = 0;
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    passed_through_.insert(ptr);
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool should_delete;
+  bool pass_through;
+  {
+    mutex_lock l(mu_);
+    pass_through = passed_through_.erase(ptr) > 0;
+    if (!pass_through) {
+      CHECK_GT(num_outstanding_, 0);
+      if (--num_outstanding_ == 0) {
+        // Nothing served from the blocks is alive, so they can be reused.
+        current_block_ = 0;
+        current_offset_ = 0;
+      }
+    }
+    should_delete = ShouldDelete();
+  }
+  if (pass_through) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void StepArenaAllocator::Release() {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    should_delete = ShouldDelete();
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+int StepArenaAllocator::NumBlocks() {
+  mutex_lock l(mu_);
+  return static_cast<int>(blocks_.size());
+}
+
+StepArenas::~StepArenas() {
+  for (const auto& arena : arenas_) {
+    arena.second->Release();
+  }
+}
+
+Allocator* StepArenas::Get(Allocator* allocator) {
+  mutex_lock l(mu_);
+  for (const auto& arena : arenas_) {
+    if (arena.first == allocator) {
+      return arena.second;
+    }
+  }
+  StepArenaAllocator* arena = new StepArenaAllocator(allocator);
+  arenas_.push_back(std::make_pair(allocator, arena));
+  return arena;
+}
+
+}  // end namespace tensorflow
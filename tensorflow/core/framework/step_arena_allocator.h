@@ -0,0 +1,114 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepArenaAllocator is a wrapper for an Allocator that serves the
+// temporary buffers of one step by bumping a pointer through large blocks
+// obtained from the underlying allocator. Deallocating a buffer only
+// decrements a count; once no buffer is outstanding the blocks are reused
+// from the start, and they are returned to the underlying allocator all at
+// once when the arena is released at the end of the step.
+//
+// Requests larger than kMaxArenaAllocationSize, or that cannot get a new
+// block, are passed through to the underlying allocator.
+//
+// A buffer may outlive the step, e.g. if a kernel unexpectedly forwards
+// it to an output, so like TrackingAllocator the arena deletes itself once
+// it has been released and the last of its buffers has been deallocated.
+class StepArenaAllocator : public Allocator {
+ public:
+  static const size_t kBlockSize = 1 << 20;
+  static const size_t kMaxArenaAllocationSize = kBlockSize / 4;
+
+  // "allocator" is not owned and must outlive this arena.
+  explicit StepArenaAllocator(Allocator* allocator);
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Called by the owner at the end of the step. After this, the only
+  // further calls allowed are DeallocateRaw calls for outstanding buffers.
+  void Release();
+
+  // Returns the number of blocks obtained from the underlying allocator.
+  int NumBlocks();
+
+ protected:
+  ~StepArenaAllocator() override;
+
+ private:
+  bool ShouldDelete() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return released_ && num_outstanding_ == 0 && passed_through_.empty();
+  }
+
+  Allocator* const allocator_;  // not owned.
+
+  mutex mu_;
+  std::vector<std::pair<char*, size_t>> blocks_ GUARDED_BY(mu_);
+  // The block being bumped through, and the offset of its first free byte.
+  size_t current_block_ GUARDED_BY(mu_) = 0;
+  size_t current_offset_ GUARDED_BY(mu_) = 0;
+  // Number of buffers served from the blocks that are not yet deallocated.
+  int64 num_outstanding_ GUARDED_BY(mu_) = 0;
+  // Buffers that were allocated directly from the underlying allocator.
+  std::unordered_set<void*> passed_through_ GUARDED_BY(mu_);
+  bool released_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+// StepArenas holds the StepArenaAllocators of one step, one per underlying
+// allocator, and releases them when it is destroyed. It is used by the
+// Executor to serve the temporary allocations requested with
+// AllocatorAttributes::step_scoped().
+class StepArenas {
+ public:
+  StepArenas() {}
+  ~StepArenas();
+
+  // Returns the arena wrapping "allocator", creating it on first use.
+  Allocator* Get(Allocator* allocator);
+
+ private:
+  mutex mu_;
+  gtl::InlinedVector<std::pair<Allocator*, StepArenaAllocator*>, 2> arenas_
+      GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenas);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
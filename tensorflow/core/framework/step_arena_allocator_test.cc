@@ -0,0 +1,124 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the calls made to cpu_allocator().
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs_;
+    ++num_outstanding_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_outstanding_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocs_ = 0;
+  int num_outstanding_ = 0;
+};
+
+TEST(StepArenaAllocatorTest, BumpsThroughOneBlock) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) %
+                     Allocator::kAllocatorAlignment);
+    ptrs.push_back(p);
+  }
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    EXPECT_GE(static_cast<char*>(ptrs[i]) - static_cast<char*>(ptrs[i - 1]),
+              1000);
+  }
+  EXPECT_EQ(1, base.num_allocs_);
+  EXPECT_EQ(1, arena->NumBlocks());
+  for (void* p : ptrs) {
+    arena->DeallocateRaw(p);
+  }
+  // The block is kept until the arena is released.
+  EXPECT_EQ(1, base.num_outstanding_);
+  arena->Release();
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+TEST(StepArenaAllocatorTest, ReusesBlocksOnceEmpty) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base);
+  const size_t kSize = StepArenaAllocator::kMaxArenaAllocationSize;
+  for (int iter = 0; iter < 10; ++iter) {
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 10; ++i) {
+      ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, kSize));
+    }
+    for (void* p : ptrs) {
+      arena->DeallocateRaw(p);
+    }
+  }
+  // Each block holds 4 of the allocations, and the 3 blocks needed by the
+  // first iteration are reused by the others.
+  EXPECT_EQ(3, arena->NumBlocks());
+  EXPECT_EQ(3, base.num_allocs_);
+  arena->Release();
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsPassThrough) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base);
+  void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment,
+                               StepArenaAllocator::kBlockSize * 2);
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, arena->NumBlocks());
+  EXPECT_EQ(1, base.num_outstanding_);
+  arena->DeallocateRaw(p);
+  EXPECT_EQ(0, base.num_outstanding_);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, OutlivesRelease) {
+  CountingAllocator base;
+  {
+    Tensor t;
+    {
+      StepArenas arenas;
+      Allocator* a = arenas.Get(&base);
+      EXPECT_EQ(a, arenas.Get(&base));
+      t = Tensor(a, DT_FLOAT, TensorShape({16}));
+      t.flat<float>().setZero();
+    }
+    // The arena is released, but keeps its block for "t".
+    EXPECT_EQ(1, base.num_outstanding_);
+    EXPECT_EQ(0.0f, t.flat<float>()(15));
+  }
+  EXPECT_EQ(0, base.num_outstanding_);
+}
+
+}  // namespace
+}  // namespace tensorflow
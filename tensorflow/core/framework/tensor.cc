@@ -23,6 +23,10 @@ limitations under the License.
 //   default constructors and destructors when T is not a simple type
 //   (e.g., string.), and skips them otherwise.
 //
+// * InlinedBuffer<T>: a Buffer for small tensors of simple types from the
+//   cpu allocator, whose array lives in the same allocation as the buffer
+//   object. NewBuffer<T> picks between the two.
+//
 // * Helper<T>: provides various routines given type T.  The routines
 //   includes running the constructor and destructor of T[], encoding
 //   an decoding T[] into/from a Cord, etc.
@@ -104,6 +108,76 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors from the cpu allocator of at most this many bytes are inlined.
+constexpr size_t kMaxInlinedBytes = 64;
+
+// Typed ref-counted buffer T[n] allocated in one block with the buffer
+// object, so a scalar costs one allocation instead of two. The block also
+// holds the allocator in front of the object to free it after ~InlinedBuffer.
+// Only for simple types and allocators that don't track allocation sizes.
+template <typename T>
+class InlinedBuffer : public BufferBase {
+ public:
+  // Returns nullptr if the allocation fails.
+  static InlinedBuffer* New(Allocator* a, int64 n) {
+    char* block = static_cast<char*>(a->AllocateRaw(
+        Allocator::kAllocatorAlignment, data_offset() + sizeof(T) * n));
+    if (block == nullptr) {
+      return nullptr;
+    }
+    *reinterpret_cast<Allocator**>(block) = a;
+    return new (block + object_offset())
+        InlinedBuffer(a, reinterpret_cast<T*>(block + data_offset()), n);
+  }
+
+  void* data() const override { return data_; }
+  size_t size() const override { return sizeof(T) * elem_; }
+
+  static void operator delete(void* ptr) {
+    char* block = static_cast<char*>(ptr) - object_offset();
+    (*reinterpret_cast<Allocator**>(block))->DeallocateRaw(block);
+  }
+
+ private:
+  InlinedBuffer(Allocator* a, T* data, int64 n)
+      : BufferBase(a), data_(data), elem_(n) {}
+
+  ~InlinedBuffer() override {
+    if (LogMemory::IsEnabled()) {
+      RecordDeallocation();
+    }
+  }
+
+  static size_t RoundUp(size_t n, size_t alignment) {
+    return (n + alignment - 1) / alignment * alignment;
+  }
+  static size_t object_offset() {
+    return RoundUp(sizeof(Allocator*), alignof(InlinedBuffer));
+  }
+  static size_t data_offset() {
+    return RoundUp(object_offset() + sizeof(InlinedBuffer),
+                   Allocator::kAllocatorAlignment);
+  }
+
+  T* const data_;
+  const int64 elem_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlinedBuffer);
+};
+
+// Allocates a buffer for T[n] from "a", inlining small host tensors.
+template <typename T>
+BufferBase* NewBuffer(Allocator* a, int64 n) {
+  if (is_simple_type<T>::value && n > 0 && sizeof(T) * n <= kMaxInlinedBytes &&
+      a == cpu_allocator() && !a->TracksAllocationSizes()) {
+    BufferBase* buf = InlinedBuffer<T>::New(a, n);
+    if (buf != nullptr) {
+      return buf;
+    }
+  }
+  return new Buffer<T>(a, n);
+}
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -131,7 +205,7 @@ struct Helper {
       LogUnexpectedSize(in.size(), sizeof(T) * n);
       return nullptr;
     }
-    Buffer<T>* buf = new Buffer<T>(a, n);
+    TensorBuffer* buf = NewBuffer<T>(a, n);
     char* data = buf->template base<char>();
     if (data == nullptr) {
       buf->Unref();
@@ -397,7 +471,7 @@ Buffer<T>::~Buffer() {
 template <typename T>
 TensorBuffer* FromProtoField(Allocator* a, const TensorProto& in, int64 n) {
   CHECK_GT(n, 0);
-  Buffer<T>* buf = new Buffer<T>(a, n);
+  TensorBuffer* buf = NewBuffer<T>(a, n);
   T* data = buf->template base<T>();
   if (data == nullptr) {
     buf->Unref();
@@ -428,7 +502,7 @@ template <>
 TensorBuffer* FromProtoField<Eigen::half>(Allocator* a, const TensorProto& in,
                                           int64 n) {
   CHECK_GT(n, 0);
-  Buffer<Eigen::half>* buf = new Buffer<Eigen::half>(a, n);
+  TensorBuffer* buf = NewBuffer<Eigen::half>(a, n);
   uint16* data = buf->template base<uint16>();
   if (data == nullptr) {
     buf->Unref();
@@ -588,7 +662,7 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements()));
   }
   if (buf_ != nullptr && buf_->data() != nullptr && LogMemory::IsEnabled()) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -829,6 +829,35 @@ class DummyCPUAllocator : public Allocator {
   void DeallocateRaw(void* ptr) override {}
 };
 
+TEST(Tensor, SmallTensors) {
+  // Small tensors keep their data in the buffer allocation. Check that it is
+  // aligned and that copies and slices still share it.
+  for (int n : {1, 3, 16, 17}) {
+    Tensor t(DT_FLOAT, TensorShape({n}));
+    EXPECT_TRUE(t.IsAligned());
+    EXPECT_EQ(n * sizeof(float), t.TotalBytes());
+    auto flat = t.flat<float>();
+    for (int i = 0; i < n; ++i) flat(i) = i;
+    Tensor copy = t;
+    EXPECT_TRUE(copy.SharesBufferWith(t));
+    Tensor slice = t.Slice(0, 1);
+    EXPECT_TRUE(slice.SharesBufferWith(t));
+    EXPECT_EQ(0.0f, slice.flat<float>()(0));
+
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    Tensor from_proto;
+    ASSERT_TRUE(from_proto.FromProto(proto));
+    test::ExpectTensorEqual<float>(t, from_proto);
+  }
+  Tensor scalar(DT_COMPLEX128, TensorShape({}));
+  EXPECT_TRUE(scalar.IsAligned());
+  scalar.scalar<complex128>()() = complex128(1, 2);
+  EXPECT_EQ(complex128(1, 2), scalar.scalar<complex128>()());
+  Tensor strings(DT_STRING, TensorShape({2}));
+  EXPECT_EQ("", strings.vec<string>()(1));
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
@@ -15,18 +15,24 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tracking_allocator.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 
 TrackingAllocator::TrackingAllocator(Allocator* allocator, bool track_sizes)
+    : TrackingAllocator(allocator, track_sizes, false) {}
+
+TrackingAllocator::TrackingAllocator(Allocator* allocator, bool track_sizes,
+                                     bool record_allocations)
     : allocator_(allocator),
       ref_(1),
       allocated_(0),
       high_watermark_(0),
       total_bytes_(0),
       track_sizes_locally_(track_sizes && !allocator_->TracksAllocationSizes()),
-      next_allocation_id_(0) {}
+      next_allocation_id_(0),
+      record_allocations_(record_allocations) {}
 
 void* TrackingAllocator::AllocateRaw(
     size_t alignment, size_t num_bytes,
@@ -37,8 +43,10 @@ void* TrackingAllocator::AllocateRaw(
   if (nullptr == ptr) {
     return ptr;
   }
+  size_t recorded_bytes = num_bytes;
   if (allocator_->TracksAllocationSizes()) {
     size_t allocated_bytes = allocator_->AllocatedSize(ptr);
+    recorded_bytes = allocated_bytes;
     {
       mutex_lock lock(mu_);
       allocated_ += allocated_bytes;
@@ -52,6 +60,7 @@ void* TrackingAllocator::AllocateRaw(
     // use the requested size as an approximation.
     size_t allocated_bytes = allocator_->AllocatedSizeSlow(ptr);
     allocated_bytes = std::max(num_bytes, allocated_bytes);
+    recorded_bytes = allocated_bytes;
     mutex_lock lock(mu_);
     next_allocation_id_ += 1;
     Chunk chunk = {num_bytes, allocated_bytes, next_allocation_id_};
@@ -65,6 +74,11 @@ void* TrackingAllocator::AllocateRaw(
     total_bytes_ += num_bytes;
     ++ref_;
   }
+  mutex_lock lock(mu_);
+  if (record_allocations_) {
+    live_records_[ptr] = records_.size();
+    records_.push_back({Env::Default()->NowMicros(), 0, recorded_bytes});
+  }
   return ptr;
 }
 
@@ -96,6 +110,13 @@ void TrackingAllocator::DeallocateRaw(void* ptr) {
       CHECK_GE(allocated_, allocated_bytes);
       allocated_ -= allocated_bytes;
     }
+    if (record_allocations_) {
+      auto itr = live_records_.find(ptr);
+      if (itr != live_records_.end()) {
+        records_[itr->second].dealloc_micros = Env::Default()->NowMicros();
+        live_records_.erase(itr);
+      }
+    }
     should_delete = UnRef();
   }
   allocator->DeallocateRaw(ptr);
@@ -169,6 +190,27 @@ std::tuple<size_t, size_t, size_t> TrackingAllocator::GetSizesAndUnRef() {
   return std::make_tuple(total_bytes, high_watermark, still_live_bytes);
 }
 
+std::tuple<size_t, size_t, size_t> TrackingAllocator::GetSizes() {
+  mutex_lock lock(mu_);
+  return std::make_tuple(total_bytes_, high_watermark_, allocated_);
+}
+
+std::vector<TrackingAllocator::Record> TrackingAllocator::GetRecordsAndUnRef() {
+  std::vector<Record> records;
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    records.swap(records_);
+    live_records_.clear();
+    record_allocations_ = false;
+    should_delete = UnRef();
+  }
+  if (should_delete) {
+    delete this;
+  }
+  return records;
+}
+
 bool TrackingAllocator::UnRef() {
   CHECK_GE(ref_, 1);
   --ref_;
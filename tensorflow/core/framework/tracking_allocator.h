@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_FRAMEWORK_TRACKING_ALLOCATOR_H_
 
 #include <unordered_map>
+#include <vector>
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -44,7 +45,19 @@ namespace tensorflow {
 // received and the high watermark has been retrieved.
 class TrackingAllocator : public Allocator {
  public:
+  // The time and size of an allocation made through the wrapper.
+  struct Record {
+    int64 alloc_micros;
+    // 0 if the memory has not been deallocated yet.
+    int64 dealloc_micros;
+    size_t bytes;
+  };
+
   explicit TrackingAllocator(Allocator* allocator, bool track_ids);
+  // If record_allocations is true, the wrapper also records the lifetime of
+  // each allocation, see GetRecordsAndUnRef().
+  TrackingAllocator(Allocator* allocator, bool track_ids,
+                    bool record_allocations);
   string Name() override { return allocator_->Name(); }
   void* AllocateRaw(size_t alignment, size_t num_bytes) override {
     return AllocateRaw(alignment, num_bytes, AllocationAttributes());
@@ -74,6 +87,16 @@ class TrackingAllocator : public Allocator {
   // have been deallocated the wrapper will delete itself.
   std::tuple<size_t, size_t, size_t> GetSizesAndUnRef();
 
+  // Like GetSizesAndUnRef(), but keeps the reference, which must later be
+  // released with GetRecordsAndUnRef().
+  std::tuple<size_t, size_t, size_t> GetSizes();
+
+  // Returns the records of the allocations made through this wrapper so far,
+  // in allocation order, and stops recording. The allocations that are still
+  // live have dealloc_micros == 0. Releases the reference like
+  // GetSizesAndUnRef().
+  std::vector<Record> GetRecordsAndUnRef();
+
  protected:
   ~TrackingAllocator() override {}
 
@@ -84,7 +107,7 @@ class TrackingAllocator : public Allocator {
   mutex mu_;
   // the number of calls to AllocateRaw that have not yet been matched
   // by a corresponding call to DeAllocateRaw, plus 1 if the Executor
-  // has not yet read out the high watermark.
+  // has not yet read out the high watermark or the allocation records.
   int ref_ GUARDED_BY(mu_);
   // the current number of outstanding bytes that have been allocated
   // by this wrapper, or 0 if the underlying allocator does not track
@@ -110,6 +133,11 @@ class TrackingAllocator : public Allocator {
   };
   std::unordered_map<void*, Chunk> in_use_ GUARDED_BY(mu_);
   int64 next_allocation_id_ GUARDED_BY(mu_);
+
+  bool record_allocations_ GUARDED_BY(mu_);
+  std::vector<Record> records_ GUARDED_BY(mu_);
+  // ptr -> index in records_ of the live allocations.
+  std::unordered_map<void*, size_t> live_records_ GUARDED_BY(mu_);
 };
 
 }  // end namespace tensorflow
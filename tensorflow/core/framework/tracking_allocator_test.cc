@@ -125,6 +125,33 @@ TEST(TrackingAllocatorTest, SimpleTracking) {
   ta->DeallocateRaw(p2);
 }
 
+TEST(TrackingAllocatorTest, RecordAllocations) {
+  TestableSizeTrackingAllocator a;
+
+  TrackingAllocator* ta = new TrackingAllocator(&a, false, true);
+  void* p1 = ta->AllocateRaw(4, 12);
+  void* p2 = ta->AllocateRaw(4, 4);
+  ta->DeallocateRaw(p1);
+
+  std::tuple<size_t, size_t, size_t> sizes = ta->GetSizes();
+  EXPECT_EQ(16, std::get<0>(sizes));
+  EXPECT_EQ(16, std::get<1>(sizes));
+  EXPECT_EQ(4, std::get<2>(sizes));
+
+  std::vector<TrackingAllocator::Record> records = ta->GetRecordsAndUnRef();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(12, records[0].bytes);
+  EXPECT_GT(records[0].alloc_micros, 0);
+  EXPECT_GE(records[0].dealloc_micros, records[0].alloc_micros);
+  EXPECT_EQ(4, records[1].bytes);
+  EXPECT_GE(records[1].alloc_micros, records[0].alloc_micros);
+  // p2 is still live.
+  EXPECT_EQ(0, records[1].dealloc_micros);
+
+  // Deallocating the last pointer deletes the wrapper.
+  ta->DeallocateRaw(p2);
+}
+
 TEST(TrackingAllocatorTest, OutOfMemory) {
   NoMemoryAllocator a;
 
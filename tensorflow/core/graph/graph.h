@@ -384,6 +384,11 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(const NodeDef& node_def, Status* status);
 
+  // Like AddNode above, but takes the contents of *node_def instead of
+  // copying them.  *node_def is left in an unspecified state on success, and
+  // unchanged on error.
+  Node* AddNode(NodeDef&& node_def, Status* status);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -101,19 +101,22 @@ class GraphConstructor {
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
 
-  // versions and library may be nullptr
+  // versions and library may be nullptr.  If owned_node_defs is not empty,
+  // it holds the same NodeDefs as node_defs, which are moved into the nodes
+  // of g instead of being copied.
   static Status Construct(const Options& opts, NodeDefSlice node_defs,
                           const VersionDef* versions,
                           const FunctionDefLibrary* library, Graph* g,
                           ShapeRefiner* refiner,
-                          std::vector<std::pair<Node*, int>>* return_tensors) {
+                          std::vector<std::pair<Node*, int>>* return_tensors,
+                          gtl::ArraySlice<NodeDef*> owned_node_defs = {}) {
     if (versions) {
       TF_RETURN_IF_ERROR(CheckVersions(*versions, TF_GRAPH_DEF_VERSION,
                                        TF_GRAPH_DEF_VERSION_MIN_PRODUCER,
                                        "GraphDef", "graph"));
     }
     GraphConstructor c(opts, node_defs, versions, library, g, refiner,
-                       return_tensors);
+                       return_tensors, owned_node_defs);
     const Status s = c.TryImport();
     if (!s.ok()) c.Undo();
     return s;
@@ -124,15 +127,20 @@ class GraphConstructor {
                    const VersionDef* versions,
                    const FunctionDefLibrary* library, Graph* g,
                    ShapeRefiner* refiner,
-                   std::vector<std::pair<Node*, int>>* return_tensors)
+                   std::vector<std::pair<Node*, int>>* return_tensors,
+                   gtl::ArraySlice<NodeDef*> owned_node_defs)
       : opts_(opts),
         node_defs_(node_defs),
+        owned_node_defs_(owned_node_defs),
         versions_(versions),
         library_(library),
         g_(g),
         original_versions_(g->versions()),
         refiner_(refiner),
-        return_tensors_(return_tensors) {}
+        return_tensors_(return_tensors) {
+    DCHECK(owned_node_defs_.empty() ||
+           owned_node_defs_.size() == node_defs_.size());
+  }
 
   Status TryImport() {
     TF_RETURN_IF_ERROR(EnsureNoNameCollisions());
@@ -159,7 +167,7 @@ class GraphConstructor {
   void Undo();
 
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(const NodeDef& node_def, Node** node);
+  Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -180,6 +188,7 @@ class GraphConstructor {
   // From constructor
   const Options opts_;
   const NodeDefSlice node_defs_;
+  const gtl::ArraySlice<NodeDef*> owned_node_defs_;
   const VersionDef* versions_;
   const FunctionDefLibrary* library_;
   Graph* g_;
@@ -191,16 +200,28 @@ class GraphConstructor {
   std::vector<std::pair<Node*, int>>* return_tensors_;
 
   // Mapping from node name to the index within node_defs_
-  struct NodeInfo {
-    explicit NodeInfo(int i) : gdef_index(i), node(nullptr) {}
-    // std::unordered_map<> requires that we have a default constructor.
-    NodeInfo() : NodeInfo(-1) {}
-    int gdef_index;
-    Node* node;  // nullptr until the NodeDef is converted to a Node.
-  };
   // TODO(vrv): Profile this data structure to see if we should use an
   // alternative implementation of std::unordered_map.
-  std::unordered_map<StringPiece, NodeInfo, StringPiece::Hasher> gdef_nodes_;
+  std::unordered_map<StringPiece, int, StringPiece::Hasher> gdef_nodes_;
+
+  // The names of the nodes in node_defs_, which are the keys of gdef_nodes_
+  // when the NodeDefs are moved into the graph.
+  std::vector<string> owned_node_names_;
+
+  // Mapping between index within node_defs_ and the node it is converted to,
+  // which is nullptr until the NodeDef is converted.
+  std::vector<Node*> nodes_;
+
+  // An input of a NodeDef, as the index within node_defs_ of the source node
+  // and the index of the output of the source node (or Graph::kControlSlot).
+  struct ParsedInput {
+    int gdef_index;
+    int index;
+  };
+  // Mapping between index within node_defs_ and its inputs, which are parsed
+  // once in InitFromEdges() and used by Convert() unless the inputs are
+  // rewritten for the import.
+  std::vector<gtl::InlinedVector<ParsedInput, 4>> parsed_inputs_;
 
   // Mapping from node name to the existing node in g_
   std::unordered_map<StringPiece, Node*, StringPiece::Hasher> existing_nodes_;
@@ -217,23 +238,25 @@ class GraphConstructor {
   std::vector<gtl::InlinedVector<int, 4>> outputs_;
 
   // Used in the conversion from node_defs_ to g_ to represent the ith input
-  // of a node.
+  // of a node.  'gdef_index' is the index within node_defs_ of the input
+  // node, or -1 if it is a preexisting node of g_.
   struct InputInfo {
-    explicit InputInfo(const string& node_name, Node* n, int i)
-        : name(node_name), node(n), index(i) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string name;
+    explicit InputInfo(int gdef_index, Node* n, int i)
+        : gdef_index(gdef_index), node(n), index(i) {}
+    int gdef_index;
     Node* node;
     int index;
   };
 
   // Used in the conversion from node_defs_ to g_ to represent an edge from
-  // the node named 'name' to node 'n'.
+  // the node with index 'gdef_index' within node_defs_ to node 'n'.
   struct EdgeInfo {
-    explicit EdgeInfo(const string& name, int i1, Node* n, int i2)
-        : src_name(name), src_index(i1), dst_node(n), dst_index(i2) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string src_name;
+    explicit EdgeInfo(int gdef_index, int i1, Node* n, int i2)
+        : src_gdef_index(gdef_index),
+          src_index(i1),
+          dst_node(n),
+          dst_index(i2) {}
+    int src_gdef_index;
     int src_index;
     Node* dst_node;
     int dst_index;
@@ -333,6 +356,13 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 }
 
 Status GraphConstructor::BuildNodeIndex() {
+  nodes_.resize(node_defs_.size(), nullptr);
+  gdef_nodes_.reserve(node_defs_.size());
+  // The names of NodeDefs that are moved into the graph do not outlive
+  // Convert(), so the keys refer to copies of them.
+  if (!owned_node_defs_.empty()) {
+    owned_node_names_.reserve(node_defs_.size());
+  }
   // Validate the node names and add them to gdef_nodes_.
   for (int n = 0; n < node_defs_.size(); ++n) {
     const NodeDef& node_def = *node_defs_[n];
@@ -341,9 +371,12 @@ Status GraphConstructor::BuildNodeIndex() {
           "Node '", node_def.name(),
           "': Node name contains invalid characters");
     }
-    if (!gdef_nodes_
-             .insert(std::make_pair(StringPiece(node_def.name()), NodeInfo(n)))
-             .second) {
+    StringPiece name = node_def.name();
+    if (!owned_node_defs_.empty()) {
+      owned_node_names_.push_back(node_def.name());
+      name = owned_node_names_.back();
+    }
+    if (!gdef_nodes_.insert(std::make_pair(name, n)).second) {
       return errors::InvalidArgument("Node '", node_def.name(),
                                      "' is not unique");
     }
@@ -390,6 +423,7 @@ Status GraphConstructor::InitFromEdges() {
   const int num_nodes = node_defs_.size();
   pending_count_.reserve(num_nodes);
   outputs_.resize(num_nodes);
+  parsed_inputs_.resize(num_nodes);
   std::unordered_set<string> next_iteration_nodes_ =
       GetNextIterationNodes(node_defs_);
 
@@ -427,6 +461,7 @@ Status GraphConstructor::InitFromEdges() {
       ready_.push_back(n);
       continue;
     }
+    parsed_inputs_[n].reserve(node_def.input_size());
     for (int i = 0; i < node_def.input_size(); ++i) {
       StringPiece input_name = node_def.input(i);
       TensorId id(ParseTensorName(input_name));
@@ -436,7 +471,8 @@ Status GraphConstructor::InitFromEdges() {
                                        "': Unknown input node '",
                                        node_def.input(i), "'");
       }
-      outputs_[iter->second.gdef_index].push_back(n);
+      outputs_[iter->second].push_back(n);
+      parsed_inputs_[n].push_back({iter->second, id.second});
     }
   }
   return Status::OK();
@@ -459,13 +495,13 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(const NodeDef& node_def, Node** node) {
+Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   // Add the node to the graph.
   Status status;
-  *node = g_->AddNode(node_def, &status);
+  *node = g_->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
   if (opts_.expect_device_spec) {
-    (*node)->set_assigned_device_name(node_def.device());
+    (*node)->set_assigned_device_name((*node)->def().device());
   }
   return Status::OK();
 }
@@ -616,7 +652,7 @@ void GraphConstructor::AddControlDependencies(
     TensorId id(ParseTensorName(node_def->input(i)));
     auto iter = gdef_nodes_.find(id.first);
     DCHECK(iter != gdef_nodes_.end()) << id.first;
-    if (iter->second.node == nullptr) {
+    if (nodes_[iter->second] == nullptr) {
       // Input hasn't been created yet, indicating it's a backedge.
       continue;
     }
@@ -680,6 +716,12 @@ Status GraphConstructor::Convert() {
 
   std::vector<bool> input_already_exists;
 
+  // The inputs parsed by InitFromEdges() are only valid if the import does not
+  // rewrite them.
+  const bool use_parsed_inputs =
+      !opts_.importing ||
+      (opts_.input_map.empty() && opts_.control_dependencies.empty());
+
   // Process the NodeDefs in topological order.
   // (InitFromEdges() sets this up by filling in ready_ with nodes that have no
   // inputs, pending_counts_ with the number of inputs for each node and
@@ -724,33 +766,41 @@ Status GraphConstructor::Convert() {
     DCHECK_EQ(node_def->input_size(), input_already_exists.size());
     TF_RETURN_IF_ERROR(ValidateColocationConstraints(*node_def));
     for (int i = 0; i < node_def->input_size(); ++i) {
-      TensorId id(ParseTensorName(node_def->input(i)));
       Node* src_node;
+      int src_gdef_index = -1;
       int src_index;
 
-      if (!input_already_exists[i]) {
-        // Locate input in newly-imported nodes
-        auto iter = gdef_nodes_.find(id.first);
-        DCHECK(iter != gdef_nodes_.end()) << id.first;
-        src_node = iter->second.node;
-        src_index = id.second;
-        if (src_node == nullptr) has_data_back_edge = true;
+      if (use_parsed_inputs) {
+        src_gdef_index = parsed_inputs_[o][i].gdef_index;
+        src_index = parsed_inputs_[o][i].index;
+        src_node = nodes_[src_gdef_index];
       } else {
-        // Input refers to preexistng node in graph
-        auto iter = existing_nodes_.find(id.first);
-        DCHECK(iter != existing_nodes_.end()) << id.first;
-        src_node = iter->second;
+        TensorId id(ParseTensorName(node_def->input(i)));
         src_index = id.second;
+        if (!input_already_exists[i]) {
+          // Locate input in newly-imported nodes
+          auto iter = gdef_nodes_.find(id.first);
+          DCHECK(iter != gdef_nodes_.end()) << id.first;
+          src_gdef_index = iter->second;
+          src_node = nodes_[src_gdef_index];
+        } else {
+          // Input refers to preexistng node in graph
+          auto iter = existing_nodes_.find(id.first);
+          DCHECK(iter != existing_nodes_.end()) << id.first;
+          src_node = iter->second;
+        }
       }
+      if (src_node == nullptr) has_data_back_edge = true;
 
       if (src_node != nullptr && src_index >= src_node->num_outputs()) {
         return errors::InvalidArgument(
             "Node '", node_def->name(), "': Connecting to invalid output ",
-            id.second, " of source node ", id.first, " which has ",
+            src_index, " of source node ",
+            ParseTensorName(node_def->input(i)).first, " which has ",
             src_node->num_outputs(), " outputs");
       }
 
-      inputs.push_back(InputInfo(id.first.ToString(), src_node, src_index));
+      inputs.push_back(InputInfo(src_gdef_index, src_node, src_index));
     }
 
     if (has_data_back_edge && !IsMerge(*node_def)) {
@@ -763,10 +813,15 @@ Status GraphConstructor::Convert() {
     if (opts_.importing) {
       AddPrefixToNodeDef(input_already_exists, &imported_node_def);
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&imported_node_def));
+      TF_RETURN_IF_ERROR(MakeNode(std::move(imported_node_def), &node));
+    } else if (!owned_node_defs_.empty()) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(*owned_node_defs_[o]), &node));
+    } else {
+      NodeDef copy = original_node_def;
+      TF_RETURN_IF_ERROR(MakeNode(std::move(copy), &node));
     }
-    TF_RETURN_IF_ERROR(MakeNode(*node_def, &node));
-    // Use original_node_def so name StringPiece remains valid
-    gdef_nodes_[original_node_def.name()].node = node;
+    // node_def may have been moved into node from here on.
+    nodes_[o] = node;
 
     // Add edges from inputs to *node to the graph.
     for (size_t i = 0; i < inputs.size(); ++i) {
@@ -774,7 +829,7 @@ Status GraphConstructor::Convert() {
         // Record this back edge, which will be added after all nodes
         // are created.
         back_edges_.push_back(
-            EdgeInfo(inputs[i].name, inputs[i].index, node, i));
+            EdgeInfo(inputs[i].gdef_index, inputs[i].index, node, i));
       } else if (inputs[i].index == Graph::kControlSlot) {
         g_->AddControlEdge(inputs[i].node, node);
       } else {
@@ -784,7 +839,7 @@ Status GraphConstructor::Convert() {
 
     // TODO(skyewm): remove conditional when b/35715995 ("Functions lack shape
     // inference") is resolved.
-    if (g_->flib_def().Find(node_def->name()) == nullptr) {
+    if (g_->flib_def().Find(node->name()) == nullptr) {
       TF_RETURN_IF_ERROR(ValidateShape(node));
     }
 
@@ -808,7 +863,7 @@ Status GraphConstructor::Convert() {
 Status GraphConstructor::AddBackEdges() {
   // Add the back edges after all nodes are created.
   for (auto e : back_edges_) {
-    Node* src_node = gdef_nodes_[e.src_name].node;
+    Node* src_node = nodes_[e.src_gdef_index];
     if (e.src_index == Graph::kControlSlot) {
       g_->AddControlEdge(src_node, e.dst_node);
     } else {
@@ -858,14 +913,15 @@ Status GraphConstructor::PopulateReturnTensors() {
         return errors::InvalidArgument("Requested return node '", id.first,
                                        "' not found in graph def");
       }
-      int num_outputs = iter->second.node->num_outputs();
+      Node* node = nodes_[iter->second];
+      int num_outputs = node->num_outputs();
       if ((id.second < 0 || id.second >= num_outputs) &&
           id.second != Graph::kControlSlot) {
         return errors::InvalidArgument("Invalid return output ", id.second,
                                        " of node '", id.first, "', which has ",
                                        num_outputs, " outputs");
       }
-      return_tensors_->push_back({iter->second.node, id.second});
+      return_tensors_->push_back({node, id.second});
     } else {
       // id was remapped to existing node
       TensorId remapped_id = iter->second;
@@ -878,9 +934,9 @@ Status GraphConstructor::PopulateReturnTensors() {
 }
 
 void GraphConstructor::Undo() {
-  for (const auto& iter : gdef_nodes_) {
-    if (iter.second.node != nullptr) {
-      g_->RemoveNode(iter.second.node);
+  for (Node* node : nodes_) {
+    if (node != nullptr) {
+      g_->RemoveNode(node);
     }
   }
   g_->set_versions(original_versions_);
@@ -909,6 +965,19 @@ Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      &gdef.library(), g, &refiner, nullptr);
 }
 
+Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
+                              GraphDef&& gdef, Graph* g) {
+  ShapeRefiner refiner(gdef.versions().producer(), g->op_registry());
+  std::vector<NodeDef*> owned_node_defs;
+  owned_node_defs.reserve(gdef.node_size());
+  for (NodeDef& node_def : *gdef.mutable_node()) {
+    owned_node_defs.push_back(&node_def);
+  }
+  return GraphConstructor::Construct(opts, gdef.node(), &gdef.versions(),
+                                     &gdef.library(), g, &refiner, nullptr,
+                                     owned_node_defs);
+}
+
 Status ConvertNodeDefsToGraph(const GraphConstructorOptions& opts,
                               gtl::ArraySlice<NodeDef> nodes, Graph* g) {
   ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, g->op_registry());
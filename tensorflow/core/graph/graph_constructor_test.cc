@@ -95,6 +95,14 @@ class GraphConstructorTest : public ::testing::Test {
     TF_CHECK_OK(ConvertGraphDefToGraph(opts, gdef_, &graph_));
   }
 
+  // Converts gdef_ascii with the ConvertGraphDefToGraph overload that moves
+  // the NodeDefs into the graph.
+  Status ConvertOwned(const string& gdef_ascii) {
+    Convert(gdef_ascii);
+    GraphConstructorOptions opts;
+    return ConvertGraphDefToGraph(opts, std::move(gdef_), &graph_);
+  }
+
   void ExpectOK(const string& gdef_ascii, const ImportGraphDefOptions& opts,
                 ShapeRefiner* refiner = nullptr,
                 std::vector<std::pair<Node*, int>>* return_tensors = nullptr) {
@@ -884,6 +892,39 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+TEST_F(GraphConstructorTest, SimpleModelFromOwnedGraphDef) {
+  TF_EXPECT_OK(ConvertOwned(
+      "node { name: 'W1' op: 'TestParams' device: '/cpu:0' }"
+      "node { name: 'input' op: 'TestInput' input: [ '^W1' ] }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ] }"
+      "node { name: 't2' op: 'TestMul' input: [ 'W1', 'input:1', '^t1' ] }"));
+  EXPECT_TRUE(HasNode("W1"));
+  EXPECT_TRUE(HasNode("input"));
+  EXPECT_TRUE(HasNode("t1"));
+  EXPECT_TRUE(HasNode("t2"));
+  EXPECT_EQ("/cpu:0", FindNode("W1")->requested_device());
+  EXPECT_TRUE(HasEdge("W1", 0, "t1", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
+  EXPECT_TRUE(HasEdge("W1", 0, "t2", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "t2", 1));
+  EXPECT_TRUE(HasControlEdge("W1", "input"));
+  EXPECT_TRUE(HasControlEdge("t1", "t2"));
+}
+
+TEST_F(GraphConstructorTest, InvalidSourceNodeIndexFromOwnedGraphDef) {
+  const string original_graph_description = GraphDebugString();
+  Status status = ConvertOwned(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1:1', 'input:1' ] }");
+  EXPECT_FALSE(status.ok());
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Connecting to invalid output 1 of source node "
+                            "W1 which has 1 outputs"))
+      << status;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
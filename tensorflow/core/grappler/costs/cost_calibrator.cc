@@ -0,0 +1,114 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/cost_calibrator.h"
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status CostCalibrator::AddMeasurements(const GraphDef& graph,
+                                       const RunMetadata& run_metadata) {
+  const CostGraphDef& cost_graph = run_metadata.cost_graph();
+  if (cost_graph.node_size() == 0) {
+    return errors::InvalidArgument(
+        "The run metadata doesn't contain a cost graph");
+  }
+  std::unordered_map<string, string> node_to_device;
+  for (const auto& node : cost_graph.node()) {
+    node_to_device[node.name()] = node.device();
+  }
+  // Execution times in microseconds, from the step stats.
+  std::unordered_map<string, int64> node_to_time;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      int64 time =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      if (time <= 0) {
+        time = node_stats.all_end_rel_micros();
+      }
+      node_to_time[node_stats.node_name()] += time;
+    }
+  }
+
+  OpPerformanceList perf_list =
+      CostGraphToOpPerformanceData(cost_graph, graph);
+  for (const auto& perf : perf_list.op_performance()) {
+    double execution_time;
+    if (node_to_time.empty()) {
+      execution_time = perf.compute_cost();
+    } else {
+      auto it = node_to_time.find(perf.node());
+      if (it == node_to_time.end()) {
+        continue;
+      }
+      execution_time = it->second * 1000.0;
+    }
+    // Ops which ran faster than the granularity of the timer tell nothing
+    // about their efficiency.
+    if (execution_time <= 0) {
+      continue;
+    }
+    Measurement measurement;
+    measurement.op_info = perf.op();
+    measurement.execution_time = execution_time;
+    measurements_[node_to_device[perf.node()]].push_back(measurement);
+    num_measurements_++;
+  }
+  return Status::OK();
+}
+
+void CostCalibrator::Calibrate(
+    std::unordered_map<string, DeviceProperties>* devices) const {
+  for (auto& device : *devices) {
+    auto it = measurements_.find(device.first);
+    if (it == measurements_.end()) {
+      continue;
+    }
+    // The predictions are made from the peak numbers of the device.
+    DeviceProperties peak_device = device.second;
+    peak_device.clear_op_efficiency();
+
+    std::unordered_map<string, std::vector<double>> efficiencies;
+    for (const Measurement& measurement : it->second) {
+      OpInfo op_info = measurement.op_info;
+      *op_info.mutable_device() = peak_device;
+      const Costs costs = estimator_.PredictCosts(op_info);
+      if (costs.execution_time.count() <= 0) {
+        continue;
+      }
+      efficiencies[op_info.op()].push_back(costs.execution_time.count() /
+                                           measurement.execution_time);
+    }
+
+    auto* op_efficiency = device.second.mutable_op_efficiency();
+    for (auto& op : efficiencies) {
+      RobustStats stats(std::move(op.second));
+      VLOG(1) << "Efficiency of " << op.first << " on " << device.first << ": "
+              << stats.mean();
+      if (stats.mean() > 0) {
+        (*op_efficiency)[op.first] = stats.mean();
+      }
+    }
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,74 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_COSTS_COST_CALIBRATOR_H_
+#define TENSORFLOW_GRAPPLER_COSTS_COST_CALIBRATOR_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fits the efficiency of each op type on each device, i.e. the fraction of the
+// performance predicted by the OpLevelCostEstimator from the peak numbers of
+// the device that the op actually achieves, from the costs measured in real
+// runs. The fitted factors are stored in DeviceProperties::op_efficiency, so
+// they are persisted along with the device properties and picked up by the
+// OpLevelCostEstimator, and thus by the VirtualCluster and all the cost model
+// driven optimizers.
+class CostCalibrator {
+ public:
+  CostCalibrator() {}
+
+  // Records the costs measured while running "graph". The tensor shapes and
+  // the devices of the nodes come from the cost graph of "run_metadata", and
+  // the execution times from its step stats, or from the cost graph if the
+  // step stats are empty.
+  Status AddMeasurements(const GraphDef& graph,
+                         const RunMetadata& run_metadata);
+
+  // Sets the op_efficiency of the devices in "devices", keyed by device name,
+  // to the factors fitted from the measurements recorded on them. The op types
+  // which weren't measured on a device keep their current factor.
+  void Calibrate(std::unordered_map<string, DeviceProperties>* devices) const;
+
+  int num_measurements() const { return num_measurements_; }
+
+ private:
+  struct Measurement {
+    OpInfo op_info;
+    // Measured execution time in nanoseconds.
+    double execution_time;
+  };
+
+  OpLevelCostEstimator estimator_;
+  // The measurements, keyed by device name.
+  std::unordered_map<string, std::vector<Measurement>> measurements_;
+  int num_measurements_ = 0;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_COSTS_COST_CALIBRATOR_H_
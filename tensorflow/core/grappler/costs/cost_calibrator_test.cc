@@ -0,0 +1,143 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/cost_calibrator.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kCpu[] = "/job:localhost/replica:0/task:0/cpu:0";
+
+class CostCalibratorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    NodeDef* a = graph_.add_node();
+    a->set_name("a");
+    a->set_op("Placeholder");
+    NodeDef* b = graph_.add_node();
+    b->set_name("b");
+    b->set_op("Placeholder");
+    NodeDef* matmul = graph_.add_node();
+    matmul->set_name("matmul");
+    matmul->set_op("MatMul");
+    matmul->add_input("a");
+    matmul->add_input("b");
+
+    CostGraphDef* cost_graph = run_metadata_.mutable_cost_graph();
+    for (int i = 0; i < graph_.node_size(); i++) {
+      CostGraphDef::Node* node = cost_graph->add_node();
+      node->set_name(graph_.node(i).name());
+      node->set_id(i);
+      node->set_device(kCpu);
+      CostGraphDef::Node::OutputInfo* output = node->add_output_info();
+      output->set_dtype(DT_FLOAT);
+      output->mutable_shape()->add_dim()->set_size(512);
+      output->mutable_shape()->add_dim()->set_size(512);
+    }
+
+    device_.set_type("CPU");
+    device_.set_num_cores(10);
+    device_.set_bandwidth(10000000);
+    device_.set_frequency(1000);
+  }
+
+  // Returns the predicted execution time of the MatMul node on "device".
+  int64 PredictMatMul(const DeviceProperties& device) {
+    OpPerformanceList perf_list =
+        CostGraphToOpPerformanceData(run_metadata_.cost_graph(), graph_);
+    for (const auto& perf : perf_list.op_performance()) {
+      if (perf.node() == "matmul") {
+        OpInfo op_info = perf.op();
+        *op_info.mutable_device() = device;
+        return estimator_.PredictCosts(op_info).execution_time.count();
+      }
+    }
+    return -1;
+  }
+
+  void AddStepStats(int64 matmul_micros) {
+    DeviceStepStats* dev_stats =
+        run_metadata_.mutable_step_stats()->add_dev_stats();
+    dev_stats->set_device(kCpu);
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name("matmul");
+    node_stats->set_op_start_rel_micros(10);
+    node_stats->set_op_end_rel_micros(10 + matmul_micros);
+  }
+
+  GraphDef graph_;
+  RunMetadata run_metadata_;
+  DeviceProperties device_;
+  OpLevelCostEstimator estimator_;
+};
+
+TEST_F(CostCalibratorTest, FitsEfficiencyFromStepStats) {
+  const int64 peak_time = PredictMatMul(device_);
+  ASSERT_GT(peak_time, 0);
+  // The MatMul runs 4 times slower than predicted.
+  AddStepStats(4 * peak_time / 1000);
+
+  CostCalibrator calibrator;
+  TF_ASSERT_OK(calibrator.AddMeasurements(graph_, run_metadata_));
+  EXPECT_EQ(1, calibrator.num_measurements());
+
+  std::unordered_map<string, DeviceProperties> devices;
+  devices[kCpu] = device_;
+  devices["/job:localhost/replica:0/task:0/gpu:0"] = DeviceProperties();
+  calibrator.Calibrate(&devices);
+
+  const auto& op_efficiency = devices[kCpu].op_efficiency();
+  ASSERT_EQ(1, op_efficiency.count("MatMul"));
+  EXPECT_NEAR(0.25, op_efficiency.at("MatMul"), 0.01);
+  EXPECT_TRUE(
+      devices["/job:localhost/replica:0/task:0/gpu:0"].op_efficiency().empty());
+
+  // The calibrated device predicts the measured time.
+  EXPECT_NEAR(4 * peak_time, PredictMatMul(devices[kCpu]), 0.01 * peak_time);
+
+  // Calibrating again starts from the peak numbers of the device.
+  calibrator.Calibrate(&devices);
+  EXPECT_NEAR(0.25, devices[kCpu].op_efficiency().at("MatMul"), 0.01);
+}
+
+TEST_F(CostCalibratorTest, FallsBackToCostGraph) {
+  const int64 peak_time = PredictMatMul(device_);
+  run_metadata_.mutable_cost_graph()->mutable_node(2)->set_compute_cost(
+      2 * peak_time / 1000);
+
+  CostCalibrator calibrator;
+  TF_ASSERT_OK(calibrator.AddMeasurements(graph_, run_metadata_));
+  std::unordered_map<string, DeviceProperties> devices;
+  devices[kCpu] = device_;
+  calibrator.Calibrate(&devices);
+  EXPECT_NEAR(0.5, devices[kCpu].op_efficiency().at("MatMul"), 0.01);
+  // The placeholders didn't take any time.
+  EXPECT_EQ(0, devices[kCpu].op_efficiency().count("Placeholder"));
+}
+
+TEST_F(CostCalibratorTest, MissingCostGraph) {
+  CostCalibrator calibrator;
+  EXPECT_FALSE(calibrator.AddMeasurements(graph_, RunMetadata()).ok());
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
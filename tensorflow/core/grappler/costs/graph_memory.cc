@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_scheduler.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -55,6 +57,78 @@ Status GraphMemory::InferFromGraphProperties(GraphProperties* properties) {
   return Status::OK();
 }
 
+Status GraphMemory::InferFromSchedule(Cluster* cluster) {
+  VirtualScheduler scheduler(&item_, true /* use_static_shapes */, cluster);
+  TF_RETURN_IF_ERROR(scheduler.Init());
+  OpLevelCostEstimator node_estimator;
+  Costs node_costs;
+  do {
+    NodeInfo node_info = scheduler.GetCurrNodeInfo();
+    node_costs = node_estimator.PredictCosts(node_info.op_info);
+  } while (scheduler.MarkCurrNodeExecuted(node_costs));
+
+  const auto& node_states = scheduler.GetNodeStates();
+  completion_times_.clear();
+  for (const auto& node_state : node_states) {
+    completion_times_[node_state.first->name()] =
+        node_state.second.time_finished;
+  }
+
+  auto output_size = [this](const NodeState& state, int port) -> int64 {
+    if (port < 0 ||
+        port >= static_cast<int>(state.output_properties.size())) {
+      return 0;
+    }
+    return InferMemUsageForNeighbors({state.output_properties[port]});
+  };
+  peak_usage_.clear();
+  for (const auto& device : scheduler.GetDeviceStates()) {
+    const DeviceState& device_state = device.second;
+    MemoryUsage& usage = peak_usage_[device.first];
+    usage.used_memory = device_state.max_memory_usage;
+    for (const auto& node_port : device_state.persistent_nodes) {
+      usage.used_memory +=
+          output_size(node_states.at(node_port.first), node_port.second);
+    }
+    for (const auto& node_port : device_state.mem_usage_snapshot_at_peak) {
+      const NodeState& state = node_states.at(node_port.first);
+      // The peak is reached right after the last of these tensors is
+      // allocated.
+      usage.peak_time = std::max(usage.peak_time, state.time_finished);
+      if (node_port.second < 0) {
+        continue;
+      }
+      LiveTensor live_tensor;
+      live_tensor.node = node_port.first->name();
+      live_tensor.output_id = node_port.second;
+      live_tensor.memory_used = output_size(state, node_port.second);
+      live_tensor.allocation_time = state.time_finished;
+      live_tensor.deallocation_time =
+          state.time_no_references.at(node_port.second);
+      usage.live_tensors.push_back(live_tensor);
+    }
+  }
+  return Status::OK();
+}
+
+const GraphMemory::MemoryUsage& GraphMemory::GetPeakMemoryUsage(
+    const string& device) const {
+  static const MemoryUsage* empty_usage = new MemoryUsage();
+  auto it = peak_usage_.find(device);
+  if (it == peak_usage_.end()) {
+    return *empty_usage;
+  }
+  return it->second;
+}
+
+Costs::Duration GraphMemory::GetCompletionTime(const string& node) const {
+  auto it = completion_times_.find(node);
+  if (it == completion_times_.end()) {
+    return Costs::Duration::max();
+  }
+  return it->second;
+}
+
 void GraphMemory::InferMemUsageForNodes(
     const std::vector<const NodeDef*>& nodes, GraphProperties* properties,
     int64* worst_case_memory_usage, int64* best_case_memory_usage) const {
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_GRAPPLER_COSTS_GRAPH_MEMORY_H_
 #define TENSORFLOW_GRAPPLER_COSTS_GRAPH_MEMORY_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 
@@ -27,6 +31,22 @@ namespace grappler {
 // Infer the worst case memory usage for a given grappler item.
 class GraphMemory {
  public:
+  struct LiveTensor {
+    string node;
+    int output_id;
+    int64 memory_used;
+    Costs::Duration allocation_time;
+    Costs::Duration deallocation_time;
+  };
+  struct MemoryUsage {
+    MemoryUsage() : used_memory(0), peak_time(0) {}
+    int64 used_memory;
+    // Time at which the usage peaks.
+    Costs::Duration peak_time;
+    // Non persistent tensors alive at peak time.
+    std::vector<LiveTensor> live_tensors;
+  };
+
   explicit GraphMemory(const GrapplerItem& item)
       : item_(item), worst_case_memory_usage_(-1) {}
 
@@ -34,6 +54,19 @@ class GraphMemory {
   Status InferDynamically(Cluster* cluster);
   Status InferFromGraphProperties(GraphProperties* properties);
 
+  // Simulates the execution of the graph on the devices of the cluster with
+  // the VirtualScheduler and the analytical cost model, and records the peak
+  // memory usage of each device.
+  Status InferFromSchedule(Cluster* cluster);
+
+  // Peak memory usage of the device as computed by InferFromSchedule(),
+  // including the persistent tensors. Empty for unknown devices.
+  const MemoryUsage& GetPeakMemoryUsage(const string& device) const;
+
+  // Time at which the node completes its execution in the schedule computed
+  // by InferFromSchedule(), or Costs::Duration::max() if unknown.
+  Costs::Duration GetCompletionTime(const string& node) const;
+
   // Worst case memory usage in bytes, or -1 if the usage is unknown.
   int64 GetWorstCaseMemoryUsage() const { return worst_case_memory_usage_; }
 
@@ -53,6 +86,8 @@ class GraphMemory {
   GrapplerItem item_;
   int64 worst_case_memory_usage_;
   int64 best_case_memory_usage_;
+  std::unordered_map<string, MemoryUsage> peak_usage_;
+  std::unordered_map<string, Costs::Duration> completion_times_;
 };
 
 }  // end namespace grappler
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/grappler/costs/graph_memory.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/platform/test.h"
@@ -54,6 +55,41 @@ TEST_F(GraphMemoryTest, UnknownBatchSize) {
   EXPECT_EQ(12, memory.GetBestCaseMemoryUsage());
 }
 
+TEST_F(GraphMemoryTest, PeakMemoryUsage) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {{"CPU:0"}});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  const string kCPU0 = "/job:localhost/replica:0/task:0/cpu:0";
+  std::unordered_map<string, DeviceProperties> devices;
+  devices[kCPU0] = cpu_device;
+  VirtualCluster cluster(devices);
+
+  GraphMemory memory(item);
+  TF_CHECK_OK(memory.InferFromSchedule(&cluster));
+
+  const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(kCPU0);
+  EXPECT_LT(0, mem_usage.used_memory);
+  EXPECT_FALSE(mem_usage.live_tensors.empty());
+  int64 live_memory = 0;
+  for (const auto& live_tensor : mem_usage.live_tensors) {
+    EXPECT_LE(live_tensor.allocation_time, mem_usage.peak_time);
+    EXPECT_GE(live_tensor.deallocation_time, mem_usage.peak_time);
+    EXPECT_EQ(live_tensor.allocation_time,
+              memory.GetCompletionTime(live_tensor.node));
+    live_memory += live_tensor.memory_used;
+  }
+  EXPECT_LE(live_memory, mem_usage.used_memory);
+
+  EXPECT_EQ(0, memory.GetPeakMemoryUsage("/job:foo/cpu:0").used_memory);
+  EXPECT_EQ(Costs::Duration::max(), memory.GetCompletionTime("foo"));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/public/session.h"
 
@@ -131,5 +132,40 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
 
   return Status::OK();
 }
+
+Status MeasuringCostEstimator::PredictCostsOfCandidates(
+    const std::vector<const GraphDef*>& candidates, std::vector<Costs>* costs,
+    int* best_candidate) const {
+  costs->clear();
+  costs->resize(candidates.size());
+  *best_candidate = -1;
+  Status last_error;
+  for (int i = 0; i < candidates.size(); ++i) {
+    // The cluster starts a new session whenever the graph changes, and
+    // PredictCosts discards the warmup step of that session.
+    Costs* candidate_costs = &(*costs)[i];
+    const Status status =
+        PredictCosts(*candidates[i], nullptr, candidate_costs);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to measure candidate " << i << ": "
+              << status.error_message();
+      candidate_costs->execution_time = Costs::Duration::max();
+      last_error = status;
+      continue;
+    }
+    if (*best_candidate < 0 ||
+        candidate_costs->execution_time <
+            (*costs)[*best_candidate].execution_time) {
+      *best_candidate = i;
+    }
+  }
+  if (*best_candidate < 0 && !candidates.empty()) {
+    return errors::Internal("None of the ", candidates.size(),
+                            " candidates could be measured: ",
+                            last_error.error_message());
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
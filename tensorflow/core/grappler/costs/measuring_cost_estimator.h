@@ -61,6 +61,17 @@ class MeasuringCostEstimator : public CostEstimator {
   Status PredictCosts(const GraphDef& optimized_graph, CostGraphDef* cost_graph,
                       Costs* overall_cost) const override;
 
+  // Measures alternative rewrites of the item passed to Initialize(), e.g.
+  // the variants an optimizer is choosing between. The candidates are
+  // measured one after the other, each in a fresh session of the cluster and
+  // after its own warmup step, so that one candidate does not perturb the
+  // measurements of another. Sets costs[i] to the costs of candidates[i], or
+  // to an infinite execution time if it failed to run, and best_candidate to
+  // the index of the fastest one. Fails only if no candidate could be run.
+  Status PredictCostsOfCandidates(
+      const std::vector<const GraphDef*>& candidates, std::vector<Costs>* costs,
+      int* best_candidate) const;
+
  private:
   Cluster* cluster_;  // Not owned.
   int measurement_steps_;
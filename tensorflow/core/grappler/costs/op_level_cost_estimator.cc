@@ -265,22 +265,41 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpInfo& op_features) const {
+  Costs costs;
   auto it = device_cost_impl_.find(op_features.op());
   if (it == device_cost_impl_.end()) {
     if (elementwise_ops_.find(op_features.op()) != elementwise_ops_.end()) {
-      return PredictCwiseOp(op_features);
+      costs = PredictCwiseOp(op_features);
+    } else {
+      VLOG(1) << "Missing implementation for op: " << op_features.op();
+      costs = DummyExecutionTime(op_features);
     }
-    VLOG(1) << "Missing implementation for op: " << op_features.op();
-    return DummyExecutionTime(op_features);
+  } else {
+    std::function<Costs(const OpInfo&)> estimator = it->second;
+    costs = estimator(op_features);
   }
-
-  std::function<Costs(const OpInfo&)> estimator = it->second;
-  Costs costs = estimator(op_features);
+  ApplyOpEfficiency(op_features, &costs);
   VLOG(1) << "Operation " << op_features.op() << " takes "
           << costs.execution_time.count() << " ns.";
   return costs;
 }
 
+void OpLevelCostEstimator::ApplyOpEfficiency(const OpInfo& op_features,
+                                             Costs* costs) const {
+  const auto& op_efficiency = op_features.device().op_efficiency();
+  auto it = op_efficiency.find(op_features.op());
+  if (it == op_efficiency.end() || it->second <= 0) {
+    return;
+  }
+  const double efficiency = it->second;
+  costs->compute_time =
+      Costs::NanoSeconds(std::ceil(costs->compute_time.count() / efficiency));
+  costs->memory_time =
+      Costs::NanoSeconds(std::ceil(costs->memory_time.count() / efficiency));
+  costs->execution_time = Costs::NanoSeconds(
+      std::ceil(costs->execution_time.count() / efficiency));
+}
+
 std::pair<double, double> OpLevelCostEstimator::GetDeviceInfo(
     const DeviceProperties& device) const {
   double gflops = -1;
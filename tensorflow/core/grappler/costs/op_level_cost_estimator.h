@@ -41,6 +41,10 @@ class OpLevelCostEstimator {
   virtual std::pair<double, double> GetDeviceInfo(
       const DeviceProperties& device) const;
 
+  // Scales "costs" by the efficiency of the op type on the device of
+  // "op_features", if it has been calibrated.
+  void ApplyOpEfficiency(const OpInfo& op_features, Costs* costs) const;
+
   // For operations for which we haven't yet built estimates, returns a dummy
   // value based on input size.
   Costs DummyExecutionTime(const OpInfo& op_features) const;
@@ -192,6 +192,16 @@ TEST_F(OpLevelCostEstimatorTest, ModExecutionTime) {
   EXPECT_FALSE(cost.inaccurate);
 }
 
+TEST_F(OpLevelCostEstimatorTest, CalibratedOpEfficiency) {
+  OpInfo op_features = DescribeOp("Mul", 1000, 1);
+  (*op_features.mutable_device()->mutable_op_efficiency())["Mul"] = 0.5;
+  (*op_features.mutable_device()->mutable_op_efficiency())["Mod"] = 0.1;
+  auto cost = PredictCosts(op_features);
+  EXPECT_EQ(Costs::Duration(4000), cost.memory_time);
+  EXPECT_EQ(Costs::Duration(400), cost.compute_time);
+  EXPECT_EQ(Costs::Duration(4400), cost.execution_time);
+}
+
 TEST_F(OpLevelCostEstimatorTest, UnknownOrPartialShape) {
   EXPECT_FALSE(PredictCosts(DescribeMatMul(2, 4, 7, 7)).inaccurate);
   EXPECT_TRUE(PredictCosts(DescribeMatMul(-1, 4, 7, 7)).inaccurate);
@@ -210,8 +210,6 @@ class VirtualScheduler {
   // If metadata is nullptr, then just calls and return Summary().
   Costs Summary(RunMetadata* metadata);
 
- protected:
-  // GetDeviceStates and GetNodeStates are currently for testing purpuse only.
   // Retrieves detailed scheduling results.
   const std::unordered_map<string, DeviceState>& GetDeviceStates() const {
     return device_;
@@ -220,6 +218,7 @@ class VirtualScheduler {
     return node_map_;
   }
 
+ protected:
   // Returns the size of output at port_num (unit: bytes). A special case is
   // port_num -1, which is for control dependency and assumed to be 4 bytes.
   int64 CalculateOutputSize(
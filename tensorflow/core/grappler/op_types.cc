@@ -35,6 +35,16 @@ bool IsDequeueOp(const NodeDef& node) {
          op == "QueueDequeueUpToV2" || op == "QueueDequeueUpTo";
 }
 
+bool IsEnter(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "Enter" || op == "RefEnter";
+}
+
+bool IsExit(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "Exit" || op == "RefExit";
+}
+
 bool IsIdentity(const NodeDef& node) {
   const auto& op = node.op();
   return op == "Identity";
@@ -45,6 +55,12 @@ bool IsMerge(const NodeDef& node) {
   return op == "Merge";
 }
 
+bool IsMixedPrecisionAllowed(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "MatMul" || op == "BatchMatMul" || op == "Conv2D" ||
+         op == "Conv2DBackpropInput" || op == "Conv2DBackpropFilter";
+}
+
 bool IsNoOp(const NodeDef& node) {
   const auto op = node.op();
   return op == "NoOp";
@@ -24,8 +24,13 @@ namespace grappler {
 bool IsConcat(const NodeDef& node);
 bool IsConstant(const NodeDef& node);
 bool IsDequeueOp(const NodeDef& node);
+bool IsEnter(const NodeDef& node);
+bool IsExit(const NodeDef& node);
 bool IsIdentity(const NodeDef& node);
 bool IsMerge(const NodeDef& node);
+// True for the ops that are both compute bound and accurate enough in fp16
+// (with fp32 accumulation) to be run in fp16 by the auto mixed precision pass.
+bool IsMixedPrecisionAllowed(const NodeDef& node);
 bool IsNextIteration(const NodeDef& node);
 bool IsNoOp(const NodeDef& node);
 bool IsPlaceholder(const NodeDef& node);
@@ -0,0 +1,683 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Turns "node" into an Identity of type "type" reading "input". The control
+// dependencies of the node are preserved.
+void ReplaceWithIdentity(string input, DataType type, NodeDef* node) {
+  std::vector<string> control_inputs;
+  for (const auto& node_input : node->input()) {
+    if (IsControlInput(node_input)) {
+      control_inputs.push_back(node_input);
+    }
+  }
+  node->set_op("Identity");
+  node->clear_attr();
+  (*node->mutable_attr())["T"].set_type(type);
+  node->clear_input();
+  *node->add_input() = input;
+  for (const auto& control_input : control_inputs) {
+    *node->add_input() = control_input;
+  }
+}
+
+bool HasControlInputs(const NodeDef& node) {
+  for (const auto& input : node.input()) {
+    if (IsControlInput(input)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GetConstTensor(const NodeDef& node, Tensor* tensor) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) {
+    return false;
+  }
+  return tensor->FromProto(node.attr().at("value").tensor());
+}
+
+// Reads the values of an int32 or int64 constant.
+bool GetConstIntValues(const NodeDef& node, std::vector<int64>* values) {
+  Tensor tensor;
+  if (!GetConstTensor(node, &tensor)) {
+    return false;
+  }
+  values->clear();
+  if (tensor.dtype() == DT_INT32) {
+    for (int i = 0; i < tensor.NumElements(); ++i) {
+      values->push_back(tensor.flat<int32>()(i));
+    }
+  } else if (tensor.dtype() == DT_INT64) {
+    for (int i = 0; i < tensor.NumElements(); ++i) {
+      values->push_back(tensor.flat<int64>()(i));
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool AllValuesAreOne(const Tensor& tensor) {
+  const auto values = tensor.flat<T>();
+  for (int i = 0; i < tensor.NumElements(); ++i) {
+    if (values(i) != T(1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// True iff "node" is a constant whose elements are all equal to one.
+bool IsOnes(const NodeDef& node, Tensor* tensor) {
+  if (!GetConstTensor(node, tensor)) {
+    return false;
+  }
+  switch (tensor->dtype()) {
+    case DT_HALF:
+      return AllValuesAreOne<Eigen::half>(*tensor);
+    case DT_FLOAT:
+      return AllValuesAreOne<float>(*tensor);
+    case DT_DOUBLE:
+      return AllValuesAreOne<double>(*tensor);
+    case DT_INT32:
+      return AllValuesAreOne<int32>(*tensor);
+    case DT_INT64:
+      return AllValuesAreOne<int64>(*tensor);
+    default:
+      return false;
+  }
+}
+
+// True iff every value of type "from" is exactly representable in type "to".
+bool IsLosslessCast(DataType from, DataType to) {
+  switch (from) {
+    case DT_HALF:
+      return to == DT_FLOAT || to == DT_DOUBLE;
+    case DT_FLOAT:
+      return to == DT_DOUBLE;
+    case DT_INT8:
+      return to == DT_INT16 || to == DT_INT32 || to == DT_INT64;
+    case DT_UINT8:
+      return to == DT_INT16 || to == DT_UINT16 || to == DT_INT32 ||
+             to == DT_INT64;
+    case DT_INT16:
+    case DT_UINT16:
+      return to == DT_INT32 || to == DT_INT64;
+    case DT_INT32:
+      return to == DT_INT64;
+    default:
+      return false;
+  }
+}
+
+bool IsAdd(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "Add" || op == "AddN";
+}
+
+bool IsMul(const NodeDef& node) { return node.op() == "Mul"; }
+
+bool IsCast(const NodeDef& node) { return node.op() == "Cast"; }
+
+bool IsCommutative(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "Add" || op == "AddN" || op == "Mul" || op == "Maximum" ||
+         op == "Minimum" || op == "Equal" || op == "NotEqual" ||
+         op == "LogicalAnd" || op == "LogicalOr";
+}
+
+// The data inputs of "node", sorted if their order doesn't matter, and its
+// control inputs.
+void GetCanonicalInputs(const NodeDef& node, std::vector<string>* data_inputs,
+                        std::set<string>* control_inputs) {
+  for (const auto& input : node.input()) {
+    if (IsControlInput(input)) {
+      control_inputs->insert(input);
+    } else if (NodePosition(input) == 0) {
+      data_inputs->push_back(NodeName(input));
+    } else {
+      data_inputs->push_back(input);
+    }
+  }
+  if (IsCommutative(node)) {
+    std::sort(data_inputs->begin(), data_inputs->end());
+  }
+}
+
+uint64 ComputeSignature(const NodeDef& node) {
+  uint64 signature = Hash64Combine(Hash64(node.op()), Hash64(node.device()));
+  std::vector<string> data_inputs;
+  std::set<string> control_inputs;
+  GetCanonicalInputs(node, &data_inputs, &control_inputs);
+  for (const auto& input : data_inputs) {
+    signature = Hash64Combine(signature, Hash64(input));
+  }
+  for (const auto& input : control_inputs) {
+    signature = Hash64Combine(signature, Hash64(input));
+  }
+  // The attributes of a NodeDef are not ordered.
+  std::map<string, const AttrValue*> attrs;
+  for (const auto& attr : node.attr()) {
+    attrs[attr.first] = &attr.second;
+  }
+  for (const auto& attr : attrs) {
+    signature = Hash64Combine(signature, Hash64(attr.first));
+    signature =
+        Hash64Combine(signature, Hash64(attr.second->SerializeAsString()));
+  }
+  return signature;
+}
+
+bool SameComputation(const NodeDef& node1, const NodeDef& node2) {
+  if (node1.op() != node2.op() || node1.device() != node2.device() ||
+      node1.attr_size() != node2.attr_size()) {
+    return false;
+  }
+  std::vector<string> data_inputs1, data_inputs2;
+  std::set<string> control_inputs1, control_inputs2;
+  GetCanonicalInputs(node1, &data_inputs1, &control_inputs1);
+  GetCanonicalInputs(node2, &data_inputs2, &control_inputs2);
+  if (data_inputs1 != data_inputs2 || control_inputs1 != control_inputs2) {
+    return false;
+  }
+  for (const auto& attr : node1.attr()) {
+    auto it = node2.attr().find(attr.first);
+    if (it == node2.attr().end() ||
+        !AreAttrValuesEqual(attr.second, it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const OpInfo::TensorProperties* ArithmeticOptimizer::InputProperties(
+    const string& input) const {
+  if (!has_properties_ || IsControlInput(input)) {
+    return nullptr;
+  }
+  int position;
+  const string node_name = ParseNodeName(input, &position);
+  if (!properties_->HasOutputProperties(node_name)) {
+    return nullptr;
+  }
+  const auto& props = properties_->GetOutputProperties(node_name);
+  if (position < 0 || position >= static_cast<int>(props.size())) {
+    return nullptr;
+  }
+  return &props[position];
+}
+
+bool ArithmeticOptimizer::HaveSameShape(const string& input1,
+                                        const string& input2) const {
+  const OpInfo::TensorProperties* prop1 = InputProperties(input1);
+  const OpInfo::TensorProperties* prop2 = InputProperties(input2);
+  if (prop1 == nullptr || prop2 == nullptr ||
+      prop1->dtype() != prop2->dtype() || prop1->dtype() == DT_INVALID) {
+    return false;
+  }
+  const PartialTensorShape shape1(prop1->shape());
+  const PartialTensorShape shape2(prop2->shape());
+  return shape1.IsFullyDefined() && shape1.IsIdenticalTo(shape2);
+}
+
+const NodeDef* ArithmeticOptimizer::GetBypassableInput(
+    const string& input) const {
+  if (IsControlInput(input)) {
+    return nullptr;
+  }
+  const NodeDef* node = node_map_->GetNode(input);
+  if (node == nullptr ||
+      nodes_to_preserve_.find(node->name()) != nodes_to_preserve_.end() ||
+      HasControlInputs(*node)) {
+    return nullptr;
+  }
+  return node;
+}
+
+bool ArithmeticOptimizer::CanDedup(const NodeDef& node) const {
+  if (nodes_to_preserve_.find(node.name()) != nodes_to_preserve_.end()) {
+    return false;
+  }
+  // Frames must keep their own entry and exit points, and the inputs of the
+  // nodes on back edges are not known until the whole loop is canonical.
+  // Placeholders are distinct inputs even when they look the same.
+  if (IsEnter(node) || IsExit(node) || IsMerge(node) ||
+      IsNextIteration(node) || IsPlaceholder(node)) {
+    return false;
+  }
+  // Function calls are not in the op registry, and may be stateful.
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+      op_def->is_stateful()) {
+    return false;
+  }
+  for (const auto& arg : op_def->input_arg()) {
+    if (arg.is_ref()) {
+      return false;
+    }
+  }
+  for (const auto& arg : op_def->output_arg()) {
+    if (arg.is_ref()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ArithmeticOptimizer::DedupComputations(GraphDef* optimized_graph) {
+  std::set<string> duplicates;
+  bool done = false;
+  while (!done) {
+    done = true;
+    NodeMap node_map(optimized_graph);
+    std::unordered_map<uint64, std::vector<const NodeDef*>> representatives;
+    for (int i = 0; i < optimized_graph->node_size(); ++i) {
+      const NodeDef& node = optimized_graph->node(i);
+      if (duplicates.find(node.name()) != duplicates.end() ||
+          !CanDedup(node)) {
+        continue;
+      }
+      std::vector<const NodeDef*>& candidates =
+          representatives[ComputeSignature(node)];
+      const NodeDef* representative = nullptr;
+      for (const NodeDef* candidate : candidates) {
+        if (SameComputation(*candidate, node)) {
+          representative = candidate;
+          break;
+        }
+      }
+      if (representative == nullptr) {
+        candidates.push_back(&node);
+        continue;
+      }
+
+      // Nodes later in the graph see their updated inputs in this pass, the
+      // others in the next one.
+      const string& name = representative->name();
+      for (NodeDef* consumer : node_map.GetOutputs(node.name())) {
+        for (int j = 0; j < consumer->input_size(); ++j) {
+          const string& input = consumer->input(j);
+          if (NodeName(input) != node.name()) {
+            continue;
+          }
+          int position;
+          ParseNodeName(input, &position);
+          if (IsControlInput(input)) {
+            consumer->set_input(j, strings::StrCat("^", name));
+          } else if (position == 0) {
+            consumer->set_input(j, name);
+          } else {
+            consumer->set_input(j, strings::StrCat(name, ":", position));
+          }
+        }
+        node_map.AddOutput(name, consumer->name());
+      }
+      duplicates.insert(node.name());
+      done = false;
+    }
+  }
+  if (duplicates.empty()) {
+    return;
+  }
+
+  int num_kept = 0;
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    if (duplicates.find(optimized_graph->node(i).name()) != duplicates.end()) {
+      continue;
+    }
+    if (i != num_kept) {
+      optimized_graph->mutable_node()->SwapElements(i, num_kept);
+    }
+    ++num_kept;
+  }
+  optimized_graph->mutable_node()->DeleteSubrange(
+      num_kept, optimized_graph->node_size() - num_kept);
+  VLOG(1) << "Removed " << duplicates.size() << " duplicate nodes.";
+}
+
+bool ArithmeticOptimizer::SimplifyTranspose(NodeDef* node) {
+  if (!IsTranspose(*node) || node->input_size() < 2) {
+    return false;
+  }
+  const NodeDef* perm_node = node_map_->GetNode(node->input(1));
+  std::vector<int64> perm;
+  if (perm_node == nullptr || !GetConstIntValues(*perm_node, &perm)) {
+    return false;
+  }
+  const DataType type = node->attr().at("T").type();
+
+  bool is_identity = true;
+  for (int i = 0; i < perm.size(); ++i) {
+    is_identity &= perm[i] == i;
+  }
+  if (is_identity) {
+    ReplaceWithIdentity(node->input(0), type, node);
+    return true;
+  }
+
+  // Transpose(Transpose(x, p1), p2) reads x[p1[p2[i]]], which is x itself iff
+  // p1[p2[i]] == i for all i.
+  const NodeDef* inner = GetBypassableInput(node->input(0));
+  if (inner == nullptr || !IsTranspose(*inner) || inner->input_size() < 2) {
+    return false;
+  }
+  const NodeDef* inner_perm_node = node_map_->GetNode(inner->input(1));
+  std::vector<int64> inner_perm;
+  if (inner_perm_node == nullptr ||
+      !GetConstIntValues(*inner_perm_node, &inner_perm) ||
+      inner_perm.size() != perm.size()) {
+    return false;
+  }
+  for (int i = 0; i < perm.size(); ++i) {
+    if (perm[i] < 0 || perm[i] >= inner_perm.size() ||
+        inner_perm[perm[i]] != i) {
+      return false;
+    }
+  }
+  const string input = inner->input(0);
+  ReplaceWithIdentity(input, type, node);
+  node_map_->AddOutput(NodeName(input), node->name());
+  return true;
+}
+
+bool ArithmeticOptimizer::SimplifyMul(NodeDef* node) {
+  if (!IsMul(*node) || node->input_size() < 2) {
+    return false;
+  }
+  for (int i = 0; i < 2; ++i) {
+    const NodeDef* factor = node_map_->GetNode(node->input(i));
+    Tensor ones;
+    if (factor == nullptr || !IsOnes(*factor, &ones)) {
+      continue;
+    }
+    const string other = node->input(1 - i);
+    // A scalar one never changes the shape of the other factor. Any other
+    // constant may broadcast it, which requires shape information to rule
+    // out.
+    if (ones.dims() > 0 && !HaveSameShape(other, node->name())) {
+      continue;
+    }
+    ReplaceWithIdentity(other, node->attr().at("T").type(), node);
+    return true;
+  }
+  return false;
+}
+
+bool ArithmeticOptimizer::SimplifyCast(NodeDef* node) {
+  if (!IsCast(*node) || node->input_size() < 1) {
+    return false;
+  }
+  const DataType src_type = node->attr().at("SrcT").type();
+  const DataType dst_type = node->attr().at("DstT").type();
+  if (src_type == dst_type) {
+    ReplaceWithIdentity(node->input(0), dst_type, node);
+    return true;
+  }
+  // Cast(Cast(x, A -> B), B -> A) is x when B can represent all the values of
+  // A.
+  const NodeDef* inner = GetBypassableInput(node->input(0));
+  if (inner == nullptr || !IsCast(*inner) ||
+      inner->attr().at("SrcT").type() != dst_type ||
+      !IsLosslessCast(dst_type, src_type)) {
+    return false;
+  }
+  const string input = inner->input(0);
+  ReplaceWithIdentity(input, dst_type, node);
+  node_map_->AddOutput(NodeName(input), node->name());
+  return true;
+}
+
+bool ArithmeticOptimizer::SimplifyReshape(NodeDef* node) {
+  if (!IsReshape(*node) || node->input_size() < 2) {
+    return false;
+  }
+  if (HaveSameShape(node->input(0), node->name())) {
+    ReplaceWithIdentity(node->input(0), node->attr().at("T").type(), node);
+    return true;
+  }
+  // Reshape(Reshape(x, s1), s2) is Reshape(x, s2).
+  const NodeDef* inner = GetBypassableInput(node->input(0));
+  if (inner == nullptr || !IsReshape(*inner) || inner->input_size() < 2) {
+    return false;
+  }
+  node->set_input(0, inner->input(0));
+  node_map_->AddOutput(NodeName(node->input(0)), node->name());
+  return true;
+}
+
+bool ArithmeticOptimizer::CollapseAdds(NodeDef* node) {
+  if (!IsAdd(*node)) {
+    return false;
+  }
+  const DataType type = node->attr().at("T").type();
+  // Add also supports strings, which AddN doesn't.
+  if (type == DT_STRING) {
+    return false;
+  }
+
+  // AddN doesn't broadcast, so all the terms must have the shape of the sum.
+  std::vector<string> terms;
+  std::vector<string> control_inputs;
+  std::vector<string> pending;
+  for (int i = node->input_size() - 1; i >= 0; --i) {
+    if (IsControlInput(node->input(i))) {
+      control_inputs.insert(control_inputs.begin(), node->input(i));
+    } else {
+      pending.push_back(node->input(i));
+    }
+  }
+  bool collapsed = false;
+  while (!pending.empty()) {
+    const string input = pending.back();
+    pending.pop_back();
+    const NodeDef* inner = GetBypassableInput(input);
+    if (inner != nullptr && IsAdd(*inner) &&
+        inner->attr().at("T").type() == type &&
+        inner->device() == node->device() && NodePosition(input) == 0 &&
+        node_map_->GetOutputs(inner->name()).size() == 1) {
+      for (int i = inner->input_size() - 1; i >= 0; --i) {
+        pending.push_back(inner->input(i));
+      }
+      collapsed = true;
+      continue;
+    }
+    if (!HaveSameShape(input, node->name())) {
+      return false;
+    }
+    terms.push_back(input);
+  }
+  if (!collapsed) {
+    return false;
+  }
+
+  node->set_op("AddN");
+  node->clear_attr();
+  (*node->mutable_attr())["T"].set_type(type);
+  (*node->mutable_attr())["N"].set_i(terms.size());
+  node->clear_input();
+  for (const auto& term : terms) {
+    *node->add_input() = term;
+    node_map_->AddOutput(NodeName(term), node->name());
+  }
+  for (const auto& control_input : control_inputs) {
+    *node->add_input() = control_input;
+  }
+  return true;
+}
+
+bool ArithmeticOptimizer::HoistCommonFactor(NodeDef* node,
+                                            GraphDef* optimized_graph) {
+  if (!IsAdd(*node)) {
+    return false;
+  }
+  std::vector<const NodeDef*> products;
+  std::vector<string> control_inputs;
+  for (const auto& input : node->input()) {
+    if (IsControlInput(input)) {
+      control_inputs.push_back(input);
+      continue;
+    }
+    const NodeDef* product = GetBypassableInput(input);
+    // The factors must not be broadcast for the sum of the remaining factors
+    // to be an AddN.
+    if (product == nullptr || !IsMul(*product) ||
+        product->device() != node->device() ||
+        node_map_->GetOutputs(product->name()).size() != 1 ||
+        !HaveSameShape(product->input(0), node->name()) ||
+        !HaveSameShape(product->input(1), node->name())) {
+      return false;
+    }
+    products.push_back(product);
+  }
+  if (products.size() < 2) {
+    return false;
+  }
+
+  // Look for a factor of the first product that all the others share.
+  for (int i = 0; i < 2; ++i) {
+    const string common_factor = products[0]->input(i);
+    std::vector<string> other_factors;
+    for (const NodeDef* product : products) {
+      if (IsSameInput(product->input(0), common_factor)) {
+        other_factors.push_back(product->input(1));
+      } else if (IsSameInput(product->input(1), common_factor)) {
+        other_factors.push_back(product->input(0));
+      } else {
+        break;
+      }
+    }
+    if (other_factors.size() != products.size()) {
+      continue;
+    }
+
+    const string sum_name =
+        AddPrefixToNodeName(node->name(), "ArithmeticOptimizer/HoistAdd");
+    if (node_map_->GetNode(sum_name) != nullptr) {
+      return false;
+    }
+    const DataType type = node->attr().at("T").type();
+    NodeDef* sum = optimized_graph->add_node();
+    sum->set_name(sum_name);
+    sum->set_op("AddN");
+    sum->set_device(node->device());
+    (*sum->mutable_attr())["T"].set_type(type);
+    (*sum->mutable_attr())["N"].set_i(other_factors.size());
+    node_map_->AddNode(sum_name, sum);
+    for (const auto& factor : other_factors) {
+      *sum->add_input() = factor;
+      node_map_->AddOutput(NodeName(factor), sum_name);
+    }
+
+    node->set_op("Mul");
+    node->clear_attr();
+    (*node->mutable_attr())["T"].set_type(type);
+    node->clear_input();
+    *node->add_input() = common_factor;
+    *node->add_input() = sum_name;
+    for (const auto& control_input : control_inputs) {
+      *node->add_input() = control_input;
+    }
+    node_map_->AddOutput(NodeName(common_factor), node->name());
+    node_map_->AddOutput(sum_name, node->name());
+    return true;
+  }
+  return false;
+}
+
+Status ArithmeticOptimizer::Optimize(Cluster* cluster,
+                                     const GrapplerItem& item,
+                                     GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  nodes_to_preserve_.clear();
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve_.insert(NodeName(feed.first));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve_.insert(NodeName(node));
+  }
+
+  DedupComputations(optimized_graph);
+  node_map_.reset(new NodeMap(optimized_graph));
+
+  // The shapes are those of the original graph. Since merging and rewriting
+  // nodes preserves the values of the remaining ones, they remain valid as the
+  // graph is rewritten.
+  properties_.reset(new GraphProperties(item));
+  Status s = properties_->InferStatically();
+  has_properties_ = s.ok();
+  if (!has_properties_) {
+    VLOG(1) << "Failed to infer graph shapes: " << s;
+  }
+
+  int num_simplified = 0;
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = optimized_graph->mutable_node(i);
+    if (SimplifyTranspose(node) || SimplifyMul(node) || SimplifyCast(node) ||
+        SimplifyReshape(node)) {
+      ++num_simplified;
+      continue;
+    }
+    // Collapse the sum first, so that a common factor is hoisted out of all
+    // its terms.
+    bool simplified = CollapseAdds(node);
+    simplified |= HoistCommonFactor(node, optimized_graph);
+    if (simplified) {
+      ++num_simplified;
+    }
+  }
+  VLOG(1) << "Simplified " << num_simplified << " arithmetic nodes.";
+
+  return Status::OK();
+}
+
+void ArithmeticOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                   const GraphDef& optimized_graph,
+                                   double result) {
+  // Nothing to do for ArithmeticOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
+
+#include <memory>
+#include <set>
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Common subexpression elimination and algebraic simplifications of the
+// arithmetic ops of a graph.
+//
+// Nodes that compute the same value are merged first: two stateless nodes are
+// duplicates if they have the same op, device, attributes, data inputs (in any
+// order for commutative ops) and set of control inputs. Their consumers are
+// forwarded to one of them, and the others are removed from the graph. Since
+// consumers of merged nodes may in turn become duplicates, this is repeated
+// until no more nodes can be merged.
+//
+// The arithmetic ops are then simplified:
+// * Collapse chains of Add and AddN ops into a single AddN.
+// * Hoist a factor shared by all the terms of a sum:
+//   AddN(Mul(x, y1), Mul(x, y2)) => Mul(x, AddN(y1, y2)).
+// * Remove transposes that cancel each other, or whose permutation is the
+//   identity.
+// * Remove multiplications by one.
+// * Remove casts to the same type, and round trips through a wider type.
+// * Collapse chains of reshapes, and remove reshapes that don't change the
+//   shape of their input.
+// Simplified nodes keep their name and are turned into Identity or AddN ops
+// in place, so their consumers don't need to be rewritten. The nodes that are
+// bypassed are left in the graph, and are not run if nothing else consumes
+// them.
+class ArithmeticOptimizer : public GraphOptimizer {
+ public:
+  ArithmeticOptimizer() {}
+  ~ArithmeticOptimizer() override {}
+
+  string name() const override { return "arithmetic_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+
+ private:
+  // Returns the properties of the tensor named "input", or nullptr if they
+  // are unknown.
+  const OpInfo::TensorProperties* InputProperties(const string& input) const;
+  // True iff the tensors named "input1" and "input2" have the same dtype and
+  // the same fully defined shape.
+  bool HaveSameShape(const string& input1, const string& input2) const;
+  // Returns the node producing "input" if it can be looked through: it must
+  // not be fed or fetched, and must not have any control input.
+  const NodeDef* GetBypassableInput(const string& input) const;
+
+  // True iff "node" may be merged with a node computing the same value.
+  bool CanDedup(const NodeDef& node) const;
+  void DedupComputations(GraphDef* optimized_graph);
+
+  bool SimplifyTranspose(NodeDef* node);
+  bool SimplifyMul(NodeDef* node);
+  bool SimplifyCast(NodeDef* node);
+  bool SimplifyReshape(NodeDef* node);
+  bool CollapseAdds(NodeDef* node);
+  bool HoistCommonFactor(NodeDef* node, GraphDef* optimized_graph);
+
+  std::unique_ptr<NodeMap> node_map_;
+  std::unique_ptr<GraphProperties> properties_;
+  bool has_properties_ = false;
+  std::set<string> nodes_to_preserve_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_ARITHMETIC_OPTIMIZER_H_
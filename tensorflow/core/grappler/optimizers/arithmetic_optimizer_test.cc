@@ -0,0 +1,314 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ArithmeticOptimizerTest : public ::testing::Test {
+ protected:
+  Output Input(const Scope& s, const string& name) {
+    return ops::Placeholder(s.WithOpName(name), DT_FLOAT,
+                            ops::Placeholder::Shape({2, 3}));
+  }
+
+  const NodeDef* GetNode(const GraphDef& graph, const string& name) {
+    for (const auto& node : graph.node()) {
+      if (node.name() == name) {
+        return &node;
+      }
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(ArithmeticOptimizerTest, NoOp) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output y = Input(s, "y");
+  Output a = ops::Add(s.WithOpName("a"), x, y);
+  Output b = ops::Mul(s.WithOpName("b"), a, y);
+
+  GrapplerItem item;
+  item.fetch.push_back("b");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    EXPECT_EQ(item.graph.node(i).op(), output.node(i).op());
+  }
+}
+
+TEST_F(ArithmeticOptimizerTest, DedupComputations) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output y = Input(s, "y");
+  Output a1 = ops::Add(s.WithOpName("a1"), x, y);
+  Output a2 = ops::Add(s.WithOpName("a2"), y, x);
+  Output n1 = ops::Neg(s.WithOpName("n1"), a1);
+  Output n2 = ops::Neg(s.WithOpName("n2"), a2);
+  Output z = ops::Mul(s.WithOpName("z"), n1, n2);
+
+  GrapplerItem item;
+  item.fetch.push_back("z");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The duplicate of a1, and then the duplicate of n1, are removed.
+  EXPECT_EQ(item.graph.node_size() - 2, output.node_size());
+  EXPECT_EQ(nullptr, GetNode(output, "a2"));
+  EXPECT_EQ(nullptr, GetNode(output, "n2"));
+  const NodeDef* product = GetNode(output, "z");
+  ASSERT_NE(nullptr, product);
+  ASSERT_EQ(2, product->input_size());
+  EXPECT_EQ("n1", product->input(0));
+  EXPECT_EQ("n1", product->input(1));
+}
+
+TEST_F(ArithmeticOptimizerTest, DontDedupStatefulOrFetchedNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output r1 = ops::RandomUniform(s.WithOpName("r1"), {2, 3}, DT_FLOAT);
+  Output r2 = ops::RandomUniform(s.WithOpName("r2"), {2, 3}, DT_FLOAT);
+  Output x = Input(s, "x");
+  Output n1 = ops::Neg(s.WithOpName("n1"), x);
+  Output n2 = ops::Neg(s.WithOpName("n2"), x);
+
+  GrapplerItem item;
+  item.fetch = {"r1", "r2", "n1", "n2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const string& name : item.fetch) {
+    EXPECT_NE(nullptr, GetNode(output, name));
+  }
+}
+
+TEST_F(ArithmeticOptimizerTest, CollapseAdds) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output y = Input(s, "y");
+  Output z = Input(s, "z");
+  Output a = ops::Add(s.WithOpName("a"), x, y);
+  Output b = ops::Add(s.WithOpName("b"), a, z);
+
+  GrapplerItem item;
+  item.fetch.push_back("b");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* sum = GetNode(output, "b");
+  ASSERT_NE(nullptr, sum);
+  EXPECT_EQ("AddN", sum->op());
+  EXPECT_EQ(3, sum->attr().at("N").i());
+  ASSERT_EQ(3, sum->input_size());
+  EXPECT_EQ("x", sum->input(0));
+  EXPECT_EQ("y", sum->input(1));
+  EXPECT_EQ("z", sum->input(2));
+}
+
+TEST_F(ArithmeticOptimizerTest, DontCollapseBroadcastingAdds) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output y = Input(s, "y");
+  Output z = ops::Const(s.WithOpName("z"), 1.0f, {3});
+  Output a = ops::Add(s.WithOpName("a"), x, y);
+  Output b = ops::Add(s.WithOpName("b"), a, z);
+
+  GrapplerItem item;
+  item.fetch.push_back("b");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* sum = GetNode(output, "b");
+  ASSERT_NE(nullptr, sum);
+  EXPECT_EQ("Add", sum->op());
+}
+
+TEST_F(ArithmeticOptimizerTest, HoistCommonFactor) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output y1 = Input(s, "y1");
+  Output y2 = Input(s, "y2");
+  Output m1 = ops::Mul(s.WithOpName("m1"), x, y1);
+  Output m2 = ops::Mul(s.WithOpName("m2"), y2, x);
+  Output sum = ops::Add(s.WithOpName("sum"), m1, m2);
+
+  GrapplerItem item;
+  item.fetch.push_back("sum");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() + 1, output.node_size());
+  const NodeDef* product = GetNode(output, "sum");
+  ASSERT_NE(nullptr, product);
+  EXPECT_EQ("Mul", product->op());
+  ASSERT_EQ(2, product->input_size());
+  EXPECT_EQ("x", product->input(0));
+  EXPECT_EQ("ArithmeticOptimizer/HoistAdd/sum", product->input(1));
+  const NodeDef* hoisted = GetNode(output, product->input(1));
+  ASSERT_NE(nullptr, hoisted);
+  EXPECT_EQ("AddN", hoisted->op());
+  ASSERT_EQ(2, hoisted->input_size());
+  EXPECT_EQ("y1", hoisted->input(0));
+  EXPECT_EQ("y2", hoisted->input(1));
+}
+
+TEST_F(ArithmeticOptimizerTest, TransposeCancellation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output t1 = ops::Transpose(s.WithOpName("t1"), x, {1, 0});
+  Output t2 = ops::Transpose(s.WithOpName("t2"), t1, {1, 0});
+  Output t3 = ops::Transpose(s.WithOpName("t3"), x, {0, 1});
+
+  GrapplerItem item;
+  item.fetch = {"t2", "t3"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const string& name : {"t2", "t3"}) {
+    const NodeDef* node = GetNode(output, name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ("Identity", node->op());
+    ASSERT_EQ(1, node->input_size());
+    EXPECT_EQ("x", node->input(0));
+  }
+  EXPECT_EQ("Transpose", GetNode(output, "t1")->op());
+}
+
+TEST_F(ArithmeticOptimizerTest, KeepFedNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output t1 = ops::Transpose(s.WithOpName("t1"), x, {1, 0});
+  Output t2 = ops::Transpose(s.WithOpName("t2"), t1, {1, 0});
+
+  GrapplerItem item;
+  item.fetch.push_back("t2");
+  item.feed.emplace_back("t1", Tensor(DT_FLOAT, TensorShape({3, 2})));
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ("Transpose", GetNode(output, "t2")->op());
+}
+
+TEST_F(ArithmeticOptimizerTest, MulByOne) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output one = ops::Const(s.WithOpName("one"), 1.0f);
+  Output ones = ops::Const(s.WithOpName("ones"), 1.0f, {2, 3});
+  Output wide_ones = ops::Const(s.WithOpName("wide_ones"), 1.0f, {4, 2, 3});
+  Output m1 = ops::Mul(s.WithOpName("m1"), x, one);
+  Output m2 = ops::Mul(s.WithOpName("m2"), ones, x);
+  Output m3 = ops::Mul(s.WithOpName("m3"), x, wide_ones);
+
+  GrapplerItem item;
+  item.fetch = {"m1", "m2", "m3"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const string& name : {"m1", "m2"}) {
+    const NodeDef* node = GetNode(output, name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ("Identity", node->op());
+    EXPECT_EQ("x", node->input(0));
+  }
+  // Broadcasting to a larger shape is not a no-op.
+  EXPECT_EQ("Mul", GetNode(output, "m3")->op());
+}
+
+TEST_F(ArithmeticOptimizerTest, CastRoundTrip) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output wide = ops::Cast(s.WithOpName("wide"), x, DT_DOUBLE);
+  Output back = ops::Cast(s.WithOpName("back"), wide, DT_FLOAT);
+  Output narrow = ops::Cast(s.WithOpName("narrow"), x, DT_INT32);
+  Output lossy = ops::Cast(s.WithOpName("lossy"), narrow, DT_FLOAT);
+
+  GrapplerItem item;
+  item.fetch = {"back", "lossy"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* node = GetNode(output, "back");
+  ASSERT_NE(nullptr, node);
+  EXPECT_EQ("Identity", node->op());
+  EXPECT_EQ("x", node->input(0));
+  EXPECT_EQ(DT_FLOAT, node->attr().at("T").type());
+  EXPECT_EQ("Cast", GetNode(output, "lossy")->op());
+}
+
+TEST_F(ArithmeticOptimizerTest, ReshapeChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = Input(s, "x");
+  Output r1 = ops::Reshape(s.WithOpName("r1"), x, {6});
+  Output r2 = ops::Reshape(s.WithOpName("r2"), r1, {3, 2});
+  Output r3 = ops::Reshape(s.WithOpName("r3"), x, {2, 3});
+
+  GrapplerItem item;
+  item.fetch = {"r2", "r3"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* reshape = GetNode(output, "r2");
+  ASSERT_NE(nullptr, reshape);
+  EXPECT_EQ("Reshape", reshape->op());
+  EXPECT_EQ("x", reshape->input(0));
+  EXPECT_EQ("Identity", GetNode(output, "r3")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,143 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kSuffix[] = "-AutoMixedPrecision";
+
+// Device names may spell the type as "GPU" or, in the legacy form, "gpu".
+bool IsOnGPU(const NodeDef& node) {
+  return StringPiece(str_util::Lowercase(node.device())).contains("gpu");
+}
+
+// True if "node" can run in fp16 on GPU: there is an fp16 GPU kernel for it,
+// or no kernel for its op is linked in at all (e.g. in tests).
+bool HasFp16GpuKernel(const NodeDef& node) {
+  NodeDef fp16_node = node;
+  (*fp16_node.mutable_attr())["T"].set_type(DT_HALF);
+  if (FindKernelDef(DeviceType(DEVICE_GPU), fp16_node, nullptr, nullptr)
+          .ok()) {
+    return true;
+  }
+  return !FindKernelDef(DeviceType(DEVICE_GPU), node, nullptr, nullptr).ok() &&
+         !FindKernelDef(DeviceType(DEVICE_CPU), node, nullptr, nullptr).ok();
+}
+
+bool CanConvert(const NodeDef& node) {
+  if (!IsMixedPrecisionAllowed(node) || !IsOnGPU(node)) {
+    return false;
+  }
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() || it->second.type() != DT_FLOAT) {
+    return false;
+  }
+  return HasFp16GpuKernel(node);
+}
+
+NodeDef MakeCast(const string& name, const string& device, const string& input,
+                 DataType src_type, DataType dst_type) {
+  NodeDef cast;
+  cast.set_name(name);
+  cast.set_op("Cast");
+  cast.set_device(device);
+  *cast.add_input() = input;
+  (*cast.mutable_attr())["SrcT"].set_type(src_type);
+  (*cast.mutable_attr())["DstT"].set_type(dst_type);
+  return cast;
+}
+
+}  // namespace
+
+Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+
+  std::set<string> converted;
+  for (const auto& node : item.graph.node()) {
+    if (CanConvert(node)) {
+      converted.insert(node.name());
+    }
+  }
+  if (converted.empty()) {
+    return Status::OK();
+  }
+
+  std::vector<NodeDef> new_nodes;
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    NodeDef* node = optimized_graph->mutable_node(i);
+    if (converted.find(node->name()) == converted.end()) {
+      continue;
+    }
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node->op(), &op_def));
+    const string fp16_name = strings::StrCat(node->name(), kSuffix);
+    for (int j = 0; j < node->input_size(); ++j) {
+      const string& input = node->input(j);
+      if (IsControlInput(input) || j >= op_def->input_arg_size() ||
+          op_def->input_arg(j).type_attr() != "T") {
+        continue;
+      }
+      // The producer is converted too, so take its fp16 output directly.
+      if (NodePosition(input) == 0 &&
+          converted.find(NodeName(input)) != converted.end()) {
+        node->set_input(j, strings::StrCat(NodeName(input), kSuffix));
+        continue;
+      }
+      const string cast_name = strings::StrCat(fp16_name, "/CastToFp16_", j);
+      new_nodes.push_back(
+          MakeCast(cast_name, node->device(), input, DT_FLOAT, DT_HALF));
+      node->set_input(j, cast_name);
+    }
+    new_nodes.push_back(MakeCast(node->name(), node->device(), fp16_name,
+                                 DT_HALF, DT_FLOAT));
+    node->set_name(fp16_name);
+    (*node->mutable_attr())["T"].set_type(DT_HALF);
+  }
+  for (auto& node : new_nodes) {
+    optimized_graph->add_node()->Swap(&node);
+  }
+  VLOG(1) << "Converted " << converted.size() << " nodes to fp16.";
+  return Status::OK();
+}
+
+void AutoMixedPrecision::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimized_graph,
+                                  double result) {
+  // Nothing to do for AutoMixedPrecision.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Runs the fp32 nodes on GPU whose ops are allowed by
+// IsMixedPrecisionAllowed (matrix multiplications and convolutions) in fp16:
+// * Each such node "n" is replaced by an fp16 copy named
+//   "n-AutoMixedPrecision", whose fp32 inputs are cast to fp16.
+// * A Cast of the copy back to fp32 takes the name "n", so that the consumers,
+//   feeds and fetches of "n" are unchanged.
+// * An fp16 node feeding another one does so directly, without a pair of
+//   casts in between.
+// All the other nodes, including the numerically sensitive ones such as
+// reductions, softmax and the variable updates, stay in fp32. A node is only
+// converted if there is a GPU kernel for its op in fp16.
+class AutoMixedPrecision : public GraphOptimizer {
+ public:
+  AutoMixedPrecision() {}
+  ~AutoMixedPrecision() override {}
+
+  string name() const override { return "auto_mixed_precision"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
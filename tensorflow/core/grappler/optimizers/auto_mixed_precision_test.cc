@@ -0,0 +1,106 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoMixedPrecisionTest : public ::testing::Test {
+ protected:
+  const NodeDef* GetNode(const GraphDef& graph, const string& name) {
+    for (const auto& node : graph.node()) {
+      if (node.name() == name) {
+        return &node;
+      }
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(AutoMixedPrecisionTest, ConvertsMatMulChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {4, 4});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {4, 4});
+  Output mm1 = ops::MatMul(s.WithOpName("mm1"), a, b);
+  Output mm2 = ops::MatMul(s.WithOpName("mm2"), mm1, b);
+  Output sum = ops::Sum(s.WithOpName("sum"), mm2, {0, 1});
+
+  GrapplerItem item;
+  item.fetch = {"mm1", "sum"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The two MatMuls, the three casts of their Const inputs, and the two
+  // casts of their outputs.
+  EXPECT_EQ(item.graph.node_size() + 5, output.node_size());
+  const NodeDef* fp16_mm1 = GetNode(output, "mm1-AutoMixedPrecision");
+  ASSERT_NE(nullptr, fp16_mm1);
+  EXPECT_EQ(DT_HALF, fp16_mm1->attr().at("T").type());
+  EXPECT_EQ("mm1-AutoMixedPrecision/CastToFp16_0", fp16_mm1->input(0));
+  EXPECT_EQ("mm1-AutoMixedPrecision/CastToFp16_1", fp16_mm1->input(1));
+  const NodeDef* cast_a = GetNode(output, fp16_mm1->input(0));
+  ASSERT_NE(nullptr, cast_a);
+  EXPECT_EQ("Cast", cast_a->op());
+  EXPECT_EQ("a", cast_a->input(0));
+  EXPECT_EQ(DT_HALF, cast_a->attr().at("DstT").type());
+
+  // mm2 takes the fp16 output of mm1 directly.
+  const NodeDef* fp16_mm2 = GetNode(output, "mm2-AutoMixedPrecision");
+  ASSERT_NE(nullptr, fp16_mm2);
+  EXPECT_EQ("mm1-AutoMixedPrecision", fp16_mm2->input(0));
+
+  // The fetched mm1 and the fp32 Sum see fp32 casts of the fp16 nodes.
+  for (const string name : {"mm1", "mm2"}) {
+    const NodeDef* cast = GetNode(output, name);
+    ASSERT_NE(nullptr, cast);
+    EXPECT_EQ("Cast", cast->op());
+    EXPECT_EQ(name + "-AutoMixedPrecision", cast->input(0));
+    EXPECT_EQ(DT_FLOAT, cast->attr().at("DstT").type());
+  }
+  EXPECT_EQ("mm2", GetNode(output, "sum")->input(0));
+  EXPECT_EQ(DT_FLOAT, GetNode(output, "sum")->attr().at("T").type());
+}
+
+TEST_F(AutoMixedPrecisionTest, IgnoresCpuNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {4, 4});
+  Output mm = ops::MatMul(s.WithOpName("mm"), a, a);
+
+  GrapplerItem item;
+  item.fetch = {"mm"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("MatMul", GetNode(output, "mm")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
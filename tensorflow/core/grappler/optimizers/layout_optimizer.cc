@@ -35,6 +35,8 @@ namespace grappler {
 const char kConcatConst[] = "LayoutOptimizerConcatConst";
 const char kPermNHWCToNCHW[] = "LayoutOptimizerPermConstNHWCToNCHW";
 const char kPermNCHWToNHWC[] = "LayoutOptimizerPermConstNCHWToNHWC";
+const char kPermNDHWCToNCDHW[] = "LayoutOptimizerPermConstNDHWCToNCDHW";
+const char kPermNCDHWToNDHWC[] = "LayoutOptimizerPermConstNCDHWToNDHWC";
 const char kGatherAxisConst[] = "LayoutOptimizerGatherAxisConst";
 const char kTransposeNHWCToNCHW[] = "LayoutOptimizerTransposeNHWCToNCHW";
 const char kTransposeNCHWToNHWC[] = "LayoutOptimizerTransposeNCHWToNHWC";
@@ -58,6 +60,29 @@ std::set<string> GetOpsFormatSupported() {
   return ops_format_supported;
 }
 
+// The ops in NDHWC which support NCDHW, for which the layout of 5D tensors is
+// converted.
+std::set<string> GetOps3DFormatSupported() {
+  std::set<string> ops_format_supported = {"AvgPool3D",
+                                           "AvgPool3DGrad",
+                                           "Conv3D",
+                                           "Conv3DBackpropFilterV2",
+                                           "Conv3DBackpropInputV2",
+                                           "MaxPool3D",
+                                           "MaxPool3DGrad"};
+  return ops_format_supported;
+}
+
+// The subset of GetOpsFormatSupported() which the MKL layout pass rewrites into
+// MKL ops supporting NCHW on CPU. BiasAdd and BiasAddGrad are excluded, as
+// their CPU kernels only support NHWC.
+std::set<string> GetOpsFormatSupportedByMkl() {
+  std::set<string> ops_format_supported = GetOpsFormatSupported();
+  ops_format_supported.erase("BiasAdd");
+  ops_format_supported.erase("BiasAddGrad");
+  return ops_format_supported;
+}
+
 std::set<string> GetOpsFormatAgnostic() {
   std::set<string> ops_format_agnostic = {"Add",
                                           "AddN",
@@ -126,15 +151,23 @@ class NodeProcessor {
 
   bool IsDimsFour(const NodeDef& node) const { return IsDimsN(node, 4); }
 
-  bool IsNHWC() const {
+  bool IsDataFormat(const string& data_format) const {
     if (node_->attr().find("data_format") != node_->attr().end()) {
-      if (node_->attr().at("data_format").s().compare("NHWC") == 0) {
+      if (node_->attr().at("data_format").s().compare(data_format) == 0) {
         return true;
       }
     }
     return false;
   }
 
+  bool IsNHWC() const { return IsDataFormat("NHWC"); }
+
+  bool IsNDHWC() const { return IsDataFormat("NDHWC"); }
+
+  // The rank of the tensors whose layout is converted: 5 for NDHWC to NCDHW,
+  // and 4 for NHWC to NCHW.
+  virtual int GetRank() const { return IsNDHWC() ? 5 : 4; }
+
   bool HasOutputs() const {
     auto outputs = node_map_->GetOutputs(node_->name());
     return !outputs.empty();
@@ -149,16 +182,16 @@ class NodeProcessor {
   }
 
   virtual bool ShouldProcess() const {
-    return IsNHWC() && IsDimsFour(*node_) && HasOutputs();
+    return ((IsNHWC() && IsDimsFour(*node_)) ||
+            (IsNDHWC() && IsDimsN(*node_, 5))) &&
+           HasOutputs();
   }
 
   void UpdateAttrDataFormat() {
-    if (node_->attr().find("data_format") != node_->attr().end()) {
-      if (node_->attr().at("data_format").s().compare("NHWC") == 0) {
-        string* data_format =
-            node_->mutable_attr()->at("data_format").mutable_s();
-        *data_format = "NCHW";
-      }
+    if (IsNHWC()) {
+      *node_->mutable_attr()->at("data_format").mutable_s() = "NCHW";
+    } else if (IsNDHWC()) {
+      *node_->mutable_attr()->at("data_format").mutable_s() = "NCDHW";
     }
   }
 
@@ -168,13 +201,14 @@ class NodeProcessor {
                        ->at("_output_shapes")
                        .mutable_list()
                        ->mutable_shape(0);
-      if (shape->dim_size() == 4) {
-        int64 h = shape->dim(1).size();
-        int64 w = shape->dim(2).size();
-        int64 c = shape->dim(3).size();
+      const int rank = shape->dim_size();
+      if (rank == GetRank()) {
+        // Move the channel dimension right after the batch dimension.
+        int64 c = shape->dim(rank - 1).size();
+        for (int i = rank - 1; i > 1; i--) {
+          shape->mutable_dim(i)->set_size(shape->dim(i - 1).size());
+        }
         shape->mutable_dim(1)->set_size(c);
-        shape->mutable_dim(2)->set_size(h);
-        shape->mutable_dim(3)->set_size(w);
       }
     }
   }
@@ -201,10 +235,13 @@ class NodeProcessor {
     if (!success) {
       LOG(ERROR) << "Failed to parse TensorProto.";
     }
-    int c = tensor.flat<int>()(3);
-    tensor.flat<int>()(3) = tensor.flat<int>()(2);
-    tensor.flat<int>()(2) = tensor.flat<int>()(1);
-    tensor.flat<int>()(1) = c;
+    auto flat = tensor.flat<int>();
+    const int rank = flat.size();
+    int c = flat(rank - 1);
+    for (int i = rank - 1; i > 1; i--) {
+      flat(i) = flat(i - 1);
+    }
+    flat(1) = c;
     tensor.AsProtoTensorContent(
         node->mutable_attr()->at({"value"}).mutable_tensor());
     return Status::OK();
@@ -236,7 +273,11 @@ class NodeProcessor {
     node_map_->AddNode(node_name, node);
     node->set_name(node_name);
     *node->add_input() = input_name;
-    *node->add_input() = NHWCToNCHW ? kPermNHWCToNCHW : kPermNCHWToNHWC;
+    if (GetRank() == 5) {
+      *node->add_input() = NHWCToNCHW ? kPermNDHWCToNCDHW : kPermNCDHWToNDHWC;
+    } else {
+      *node->add_input() = NHWCToNCHW ? kPermNHWCToNCHW : kPermNCHWToNHWC;
+    }
     node->set_op("Transpose");
     AttrValue attr_data_type;
     attr_data_type.set_type(data_type);
@@ -247,15 +288,17 @@ class NodeProcessor {
     if (!input_shape.unknown_rank()) {
       AttrValue attr_output_shape;
       auto output_shape = attr_output_shape.mutable_list()->add_shape();
+      const int rank = input_shape.dim_size();
+      output_shape->add_dim()->set_size(input_shape.dim(0).size());
       if (NHWCToNCHW) {
-        output_shape->add_dim()->set_size(input_shape.dim(0).size());
-        output_shape->add_dim()->set_size(input_shape.dim(3).size());
-        output_shape->add_dim()->set_size(input_shape.dim(1).size());
-        output_shape->add_dim()->set_size(input_shape.dim(2).size());
+        output_shape->add_dim()->set_size(input_shape.dim(rank - 1).size());
+        for (int i = 1; i < rank - 1; i++) {
+          output_shape->add_dim()->set_size(input_shape.dim(i).size());
+        }
       } else {
-        output_shape->add_dim()->set_size(input_shape.dim(0).size());
-        output_shape->add_dim()->set_size(input_shape.dim(2).size());
-        output_shape->add_dim()->set_size(input_shape.dim(3).size());
+        for (int i = 2; i < rank; i++) {
+          output_shape->add_dim()->set_size(input_shape.dim(i).size());
+        }
         output_shape->add_dim()->set_size(input_shape.dim(1).size());
       }
       node->mutable_attr()->insert({"_output_shapes", attr_output_shape});
@@ -307,7 +350,7 @@ class NodeProcessor {
       int output_pos = NodePosition(*it);
       // No need to process control nodes or nodes that use an output
       // other than the first output: only the first output is of 4D NCHW/NHWC
-      // format and thus relevant here.
+      // (or 5D NCDHW/NDHWC) format and thus relevant here.
       if (output_pos != 0) {
         continue;
       }
@@ -332,12 +375,12 @@ class NodeProcessor {
 
  private:
   void UpdateTuple(AttrValue_ListValue* list) {
-    int64 h = list->i(1);
-    int64 w = list->i(2);
-    int64 c = list->i(3);
+    const int rank = list->i_size();
+    int64 c = list->i(rank - 1);
+    for (int i = rank - 1; i > 1; i--) {
+      list->set_i(i, list->i(i - 1));
+    }
     list->set_i(1, c);
-    list->set_i(2, h);
-    list->set_i(3, w);
   }
 };
 
@@ -489,6 +532,39 @@ class Conv2DBackpropInputProcessor : public Conv2DProcessor {
   Status CustomizedProcessing() override { return UpdateAttrValueOfInput(0); }
 };
 
+class Conv3DBackpropFilterProcessor : public NodeProcessor {
+ public:
+  Conv3DBackpropFilterProcessor(GraphDef* graph, NodeDef* node,
+                                NodeMap* node_map)
+      : NodeProcessor(graph, node, node_map) {}
+
+ protected:
+  std::vector<int> GetInputPos() const override {
+    std::vector<int> input_pos = {0, 2};
+    return input_pos;
+  }
+
+  Status AddLayoutTransposeToOutputs() override { return Status::OK(); }
+  // The output is always of shape [filter_depth, filter_height, filter_width,
+  // in_channels, out_channels], regardless of whether NCDHW or NDHWC is used.
+  void UpdateAttrShape() override {}
+};
+
+class Conv3DBackpropInputProcessor : public NodeProcessor {
+ public:
+  Conv3DBackpropInputProcessor(GraphDef* graph, NodeDef* node,
+                               NodeMap* node_map)
+      : NodeProcessor(graph, node, node_map) {}
+
+ protected:
+  std::vector<int> GetInputPos() const override {
+    std::vector<int> input_pos = {2};
+    return input_pos;
+  }
+
+  Status CustomizedProcessing() override { return UpdateAttrValueOfInput(0); }
+};
+
 class FusedBatchNormGradProcessor : public NodeProcessor {
  public:
   FusedBatchNormGradProcessor(GraphDef* graph, NodeDef* node, NodeMap* node_map)
@@ -520,9 +596,19 @@ class AgnosticNodeProcessor : public NodeProcessor {
 
  protected:
   bool ShouldProcess() const override {
-    return IsDimsFour(*node_) && HasOutputs() && IsNodeAfterNCHWToNHWC();
+    return (IsDimsFour(*node_) || (IsDimsN(*node_, 5) && SupportsNDHWC())) &&
+           HasOutputs() && IsNodeAfterNCHWToNHWC();
   }
 
+  int GetRank() const override { return IsDimsN(*node_, 5) ? 5 : 4; }
+
+  // Whether the node can also be converted when its output is a 5D NDHWC
+  // tensor, which is the case for the element-wise ops.
+  virtual bool SupportsNDHWC() const { return true; }
+
+  // Walks up the data inputs through layout agnostic nodes, so that the nodes
+  // of a chain are converted regardless of their order in the graph, and the
+  // layout conversions at both ends of the chain cancel out in Collapse().
   bool IsNodeAfterNCHWToNHWC() const {
     std::set<string> ops_format_agnostic = GetOpsFormatAgnostic();
     auto node = node_map_->GetNode(node_->name());
@@ -531,12 +617,15 @@ class AgnosticNodeProcessor : public NodeProcessor {
       if (node->op().compare("Concat") == 0) {
         data_input_pos = 1;
       }
-      node = node_map_->GetNode(node->input(data_input_pos));
+      node = node_map_->GetNode(NodeName(node->input(data_input_pos)));
+      if (!node) {
+        return false;
+      }
       if (IsNodeNCHWToNHWC(node->name())) {
         return true;
       }
       bool connected =
-          ops_format_agnostic.find(node->name()) != ops_format_agnostic.end();
+          ops_format_agnostic.find(node->op()) != ops_format_agnostic.end();
       if (!connected) {
         return false;
       }
@@ -732,6 +821,8 @@ class SliceProcessor : public AgnosticNodeProcessor {
       : AgnosticNodeProcessor(graph, node, node_map) {}
 
  protected:
+  bool SupportsNDHWC() const override { return false; }
+
   Status CustomizedProcessing() override {
     // Skip the first input, which is the data to be sliced.
     for (int i = 1; i < node_->input_size(); i++) {
@@ -786,6 +877,8 @@ class SliceProcessorConst : public AgnosticNodeProcessor {
       : AgnosticNodeProcessor(graph, node, node_map) {}
 
  protected:
+  bool SupportsNDHWC() const override { return false; }
+
   Status CustomizedProcessing() override {
     // Skip the first input, which is the data to be sliced.
     for (int i = 1; i < node_->input_size(); i++) {
@@ -803,6 +896,8 @@ class SliceProcessorConcatOffset : public AgnosticNodeProcessor {
       : AgnosticNodeProcessor(graph, node, node_map) {}
 
  protected:
+  bool SupportsNDHWC() const override { return false; }
+
   Status CustomizedProcessing() override {
     auto maybe_concatoffset_node =
         node_map_->GetNode(NodeName(node_->input(1)));
@@ -949,6 +1044,10 @@ struct TuningConfig {
   // might result in more non-cancellable layout conversion nodes (implemented
   // by the Transpose op).
   bool no_gemm;
+  // If true, the graph runs on CPU with the MKL kernels. Only the ops that the
+  // MKL layout pass rewrites into MKL ops supporting NCHW are converted, and
+  // the 3D ops are left in NDHWC.
+  bool mkl_cpu;
 };
 
 class DataLayoutOptimizer {
@@ -976,7 +1075,8 @@ class DataLayoutOptimizer {
     attr_data_type.set_type(DT_INT32);
     node->mutable_attr()->insert({"dtype", attr_data_type});
     AttrValue attr_tensor;
-    Tensor tensor(DT_INT32, TensorShape({4}));
+    Tensor tensor(DT_INT32,
+                  TensorShape({static_cast<int64>(permutation.size())}));
     for (int i = 0; static_cast<size_t>(i) < permutation.size(); i++) {
       tensor.flat<int>()(i) = permutation[i];
     }
@@ -1032,14 +1132,25 @@ class DataLayoutOptimizer {
   // Expand all nodes which is in NHWC, but supports NCHW or is layout agnostic.
   Status Expand() {
     int node_size_original = graph_->node_size();
-    // This is the first pass where we expand the nodes which support NCHW.
-    std::set<string> ops_format_supported = GetOpsFormatSupported();
+    // This is the first pass where we expand the nodes which support NCHW or
+    // NCDHW.
+    std::set<string> ops_format_supported = config_.mkl_cpu
+                                                ? GetOpsFormatSupportedByMkl()
+                                                : GetOpsFormatSupported();
+    std::set<string> ops_3d_format_supported;
+    if (!config_.mkl_cpu) {
+      ops_3d_format_supported = GetOps3DFormatSupported();
+    }
+    bool expanded_3d = false;
     for (int i = 0; i < graph_->node_size(); i++) {
-      if (ops_format_supported.find(graph_->node(i).op()) !=
-          ops_format_supported.end()) {
+      bool is_3d = ops_3d_format_supported.find(graph_->node(i).op()) !=
+                   ops_3d_format_supported.end();
+      if (is_3d || ops_format_supported.find(graph_->node(i).op()) !=
+                       ops_format_supported.end()) {
         auto node = graph_->mutable_node(i);
         std::unique_ptr<NodeProcessor> node_processor;
-        if (node->op().compare("AvgPoolGrad") == 0) {
+        if (node->op().compare("AvgPoolGrad") == 0 ||
+            node->op().compare("AvgPool3DGrad") == 0) {
           node_processor.reset(
               new AvgPoolGradProcessor(graph_, node, &node_map_));
         } else if (node->op().compare("BiasAddGrad") == 0) {
@@ -1054,16 +1165,27 @@ class DataLayoutOptimizer {
         } else if (node->op().compare("Conv2DBackpropInput") == 0) {
           node_processor.reset(new Conv2DBackpropInputProcessor(
               graph_, node, &node_map_, config_.no_gemm));
+        } else if (node->op().compare("Conv3DBackpropFilterV2") == 0) {
+          node_processor.reset(
+              new Conv3DBackpropFilterProcessor(graph_, node, &node_map_));
+        } else if (node->op().compare("Conv3DBackpropInputV2") == 0) {
+          node_processor.reset(
+              new Conv3DBackpropInputProcessor(graph_, node, &node_map_));
         } else if (node->op().compare("FusedBatchNormGrad") == 0) {
           node_processor.reset(
               new FusedBatchNormGradProcessor(graph_, node, &node_map_));
-        } else if (node->op().compare("MaxPoolGrad") == 0) {
+        } else if (node->op().compare("MaxPoolGrad") == 0 ||
+                   node->op().compare("MaxPool3DGrad") == 0) {
           node_processor.reset(
               new MaxPoolGradProcessor(graph_, node, &node_map_));
         } else {
           node_processor.reset(new NodeProcessor(graph_, node, &node_map_));
         }
+        int node_size = graph_->node_size();
         TF_RETURN_IF_ERROR(node_processor->ConvertNode());
+        if (is_3d && graph_->node_size() > node_size) {
+          expanded_3d = true;
+        }
       }
     }
 
@@ -1075,6 +1197,12 @@ class DataLayoutOptimizer {
       n->set_device("/job:localhost/replica:0/task:0/cpu:0");
       n = AddNodePermConst(kPermNCHWToNHWC, {0, 2, 3, 1});
       n->set_device("/job:localhost/replica:0/task:0/cpu:0");
+      if (expanded_3d) {
+        n = AddNodePermConst(kPermNDHWCToNCDHW, {0, 4, 1, 2, 3});
+        n->set_device("/job:localhost/replica:0/task:0/cpu:0");
+        n = AddNodePermConst(kPermNCDHWToNDHWC, {0, 2, 3, 4, 1});
+        n->set_device("/job:localhost/replica:0/task:0/cpu:0");
+      }
       n = AddNodeConcatConst();
       n->set_device("/job:localhost/replica:0/task:0/cpu:0");
       n = AddGatherAxisConst();
@@ -1205,10 +1333,17 @@ Status LayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   if (num_gpus_ == 0) {
     num_gpus_ = GetNumAvailableGPUs();
   }
+  bool mkl_cpu = false;
   if (num_gpus_ < 1) {
+#ifdef INTEL_MKL
+    // The MKL kernels, which replace the Conv-related ops on CPU, support
+    // NCHW natively.
+    mkl_cpu = true;
+#else
     // LayoutOptimizer is currently only tuned for GPU.
     *output = item.graph;
     return Status::OK();
+#endif  // INTEL_MKL
   }
 
   GrapplerItem new_item = item;
@@ -1221,6 +1356,7 @@ Status LayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   *output = new_item.graph;
   TuningConfig config;
   config.no_gemm = false;
+  config.mkl_cpu = mkl_cpu;
   DataLayoutOptimizer layout_optimizer(output, config);
   status = layout_optimizer.Optimize();
   // This is based on an empirical observation that if the introduced Transpose
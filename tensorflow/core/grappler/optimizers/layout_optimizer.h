@@ -21,7 +21,9 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-// Convert the NHWC layout to NCHW for Conv-related ops on GPUs.
+// Convert the NHWC layout to NCHW, and the NDHWC layout to NCDHW, for
+// Conv-related ops on GPUs. In MKL builds, the NHWC layout is also converted on
+// CPU.
 class LayoutOptimizer : public GraphOptimizer {
  public:
   LayoutOptimizer() {}
@@ -94,6 +94,19 @@ class LayoutOptimizerTest : public ::testing::Test {
     return conv_backprop_input;
   }
 
+  Output SimpleConv3D(tensorflow::Scope* s) {
+    Tensor input_data(DT_FLOAT, TensorShape({8, 4, 6, 6, 3}));
+    test::FillIota<float>(&input_data, 1.0f);
+    Output input =
+        ops::Const(s->WithOpName("Input"), Input::Initializer(input_data));
+    Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 2, 3, 2}));
+    test::FillIota<float>(&filter_data, 1.0f);
+    Output filter =
+        ops::Const(s->WithOpName("Filter"), Input::Initializer(filter_data));
+    return ops::Conv3D(s->WithOpName("Conv3D"), input, filter,
+                       {1, 1, 1, 1, 1}, "SAME");
+  }
+
   Tensor GetAttrValue(const NodeDef& node) {
     Tensor tensor;
     CHECK(tensor.FromProto(node.attr().at({"value"}).tensor()));
@@ -200,6 +213,73 @@ TEST_F(LayoutOptimizerTest, NotEqualSizeWithValidPadding) {
       node_map.GetNode("LayoutOptimizerTransposeNHWCToNCHW-Conv2D-Input"));
 }
 
+TEST_F(LayoutOptimizerTest, Conv3D) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv3D(&s);
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {conv});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  LayoutOptimizer optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  NodeMap node_map(&output);
+  auto conv_node = node_map.GetNode("Conv3D");
+  ASSERT_TRUE(conv_node);
+  EXPECT_EQ("NCDHW", conv_node->attr().at("data_format").s());
+  auto transpose =
+      node_map.GetNode("LayoutOptimizerTransposeNHWCToNCHW-Conv3D-Input");
+  ASSERT_TRUE(transpose);
+  EXPECT_EQ("LayoutOptimizerPermConstNDHWCToNCDHW", transpose->input(1));
+  auto perm = node_map.GetNode("LayoutOptimizerPermConstNDHWCToNCDHW");
+  ASSERT_TRUE(perm);
+  Tensor perm_expected(DT_INT32, {5});
+  test::FillValues<int>(&perm_expected, {0, 4, 1, 2, 3});
+  test::ExpectTensorEqual<int>(perm_expected, GetAttrValue(*perm));
+  auto shape = conv_node->attr().at("_output_shapes").list().shape(0);
+  ASSERT_EQ(5, shape.dim_size());
+  EXPECT_EQ(2, shape.dim(1).size());
+  EXPECT_EQ(4, shape.dim(2).size());
+}
+
+TEST_F(LayoutOptimizerTest, TransposesCancelAcrossAgnosticChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv3D(&s);
+  auto relu = ops::Relu(s.WithOpName("Relu"), conv);
+  auto neg = ops::Neg(s.WithOpName("Neg"), relu);
+  auto pool = ops::MaxPool3D(s.WithOpName("MaxPool3D"), neg, {1, 2, 2, 2, 1},
+                             {1, 2, 2, 2, 1}, "VALID");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {pool});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  // Visit the element-wise ops in reverse topological order.
+  int relu_index = -1;
+  int neg_index = -1;
+  for (int i = 0; i < item.graph.node_size(); i++) {
+    if (item.graph.node(i).name() == "Relu") {
+      relu_index = i;
+    } else if (item.graph.node(i).name() == "Neg") {
+      neg_index = i;
+    }
+  }
+  item.graph.mutable_node()->SwapElements(relu_index, neg_index);
+  LayoutOptimizer optimizer;
+  optimizer.set_num_gpus(1);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  NodeMap node_map(&output);
+  auto pool_node = node_map.GetNode("MaxPool3D");
+  ASSERT_TRUE(pool_node);
+  EXPECT_EQ("NCDHW", pool_node->attr().at("data_format").s());
+  EXPECT_EQ("Neg", pool_node->input(0));
+  auto neg_node = node_map.GetNode("Neg");
+  ASSERT_TRUE(neg_node);
+  EXPECT_EQ("Relu", neg_node->input(0));
+  auto relu_node = node_map.GetNode("Relu");
+  ASSERT_TRUE(relu_node);
+  EXPECT_EQ("Conv3D", relu_node->input(0));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,292 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Prefix of the Enter nodes through which hoisted nodes are read in the loop.
+const char kInvariantEnterPrefix[] = "LoopOptimizer/Enter/";
+
+bool IsConstantEnter(const NodeDef& node) {
+  // References entering the loop with RefEnter may be updated in the loop.
+  if (node.op() != "Enter") {
+    return false;
+  }
+  auto it = node.attr().find("is_constant");
+  return it != node.attr().end() && it->second.b();
+}
+
+class LoopInvariantNodeMotion {
+ public:
+  LoopInvariantNodeMotion(const std::unordered_set<string>& nodes_to_preserve,
+                          GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve),
+        graph_(graph),
+        node_map_(graph) {}
+
+  void Run() {
+    ComputeFrames();
+
+    // Invariance propagates from the constant Enter nodes: iterate until no
+    // more invariant nodes are found.
+    std::vector<NodeDef*> invariant_nodes;
+    bool found = true;
+    while (found) {
+      found = false;
+      for (NodeDef& node : *graph_->mutable_node()) {
+        if (invariants_.count(&node) == 0 && CanHoist(node) &&
+            IsInvariant(node)) {
+          invariants_.insert(&node);
+          invariant_nodes.push_back(&node);
+          found = true;
+        }
+      }
+    }
+
+    for (NodeDef* node : invariant_nodes) {
+      Hoist(node);
+    }
+  }
+
+ private:
+  // Computes the stack of frames each node belongs to.
+  void ComputeFrames() {
+    std::deque<const NodeDef*> queue;
+    for (const NodeDef& node : graph_->node()) {
+      if (node.input_size() == 0) {
+        frames_[&node];
+        queue.push_back(&node);
+      }
+    }
+    while (!queue.empty()) {
+      const NodeDef* node = queue.front();
+      queue.pop_front();
+      std::vector<string> frames = frames_[node];
+      if (IsExit(*node) && !frames.empty()) {
+        frames.pop_back();
+      }
+      for (const NodeDef* output : node_map_.GetOutputs(node->name())) {
+        if (frames_.find(output) != frames_.end()) {
+          continue;
+        }
+        std::vector<string>& output_frames = frames_[output];
+        output_frames = frames;
+        if (IsEnter(*output)) {
+          const string& frame_name = GetNodeAttrString(*output, "frame_name");
+          output_frames.push_back(frame_name);
+          frame_enters_.emplace(frame_name, output);
+        }
+        queue.push_back(output);
+      }
+    }
+  }
+
+  bool CanHoist(const NodeDef& node) const {
+    auto it = frames_.find(&node);
+    if (it == frames_.end() || it->second.empty()) {
+      return false;
+    }
+    if (nodes_to_preserve_.find(node.name()) != nodes_to_preserve_.end()) {
+      return false;
+    }
+    if (IsEnter(node) || IsExit(node) || IsMerge(node) || IsSwitch(node) ||
+        IsNextIteration(node) || node.op() == "LoopCond") {
+      return false;
+    }
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+        op_def->is_stateful()) {
+      return false;
+    }
+    DataTypeVector inputs;
+    DataTypeVector outputs;
+    if (!InOutTypesForNode(node, *op_def, &inputs, &outputs).ok() ||
+        outputs.empty()) {
+      return false;
+    }
+    for (DataType type : inputs) {
+      if (IsRefType(type)) {
+        return false;
+      }
+    }
+    for (DataType type : outputs) {
+      if (IsRefType(type)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool IsInvariant(const NodeDef& node) const {
+    if (IsConstant(node)) {
+      // Constants in loops only have control dependencies, which don't
+      // matter once they are hoisted.
+      return true;
+    }
+    if (node.input_size() == 0) {
+      return false;
+    }
+    for (const string& input : node.input()) {
+      const NodeDef* input_node = node_map_.GetNode(input);
+      if (!input_node) {
+        return false;
+      }
+      if (invariants_.count(input_node) > 0) {
+        continue;
+      }
+      if (!IsConstantEnter(*input_node) ||
+          frames_.at(input_node) != frames_.at(&node)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the name of the constant Enter node that feeds the output "port"
+  // of the hoisted "node" back into its original frame.
+  string InvariantEnter(const NodeDef& node, int port) {
+    const string name =
+        port == 0 ? strings::StrCat(kInvariantEnterPrefix, node.name())
+                  : strings::StrCat(kInvariantEnterPrefix, node.name(), "_",
+                                    port);
+    if (node_map_.GetNode(name)) {
+      return name;
+    }
+    const OpDef* op_def = nullptr;
+    TF_CHECK_OK(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+    DataTypeVector inputs;
+    DataTypeVector outputs;
+    TF_CHECK_OK(InOutTypesForNode(node, *op_def, &inputs, &outputs));
+
+    const string& frame_name = frames_.at(&node).back();
+    const NodeDef* frame_enter = frame_enters_.at(frame_name);
+    NodeDef* enter = graph_->add_node();
+    enter->set_name(name);
+    enter->set_op("Enter");
+    enter->set_device(node.device());
+    *enter->add_input() =
+        port == 0 ? node.name() : strings::StrCat(node.name(), ":", port);
+    (*enter->mutable_attr())["T"].set_type(outputs[port]);
+    (*enter->mutable_attr())["frame_name"].set_s(frame_name);
+    (*enter->mutable_attr())["is_constant"].set_b(true);
+    auto it = frame_enter->attr().find("parallel_iterations");
+    if (it != frame_enter->attr().end()) {
+      (*enter->mutable_attr())["parallel_iterations"] = it->second;
+    }
+    node_map_.AddNode(name, enter);
+    return name;
+  }
+
+  // Moves "node" to the enclosing frame.
+  void Hoist(NodeDef* node) {
+    // The consumers that remain in the frame read the node through constant
+    // Enter nodes.
+    std::vector<NodeDef*> consumers(node_map_.GetOutputs(node->name()).begin(),
+                                    node_map_.GetOutputs(node->name()).end());
+    for (NodeDef* consumer : consumers) {
+      if (invariants_.count(consumer) > 0) {
+        continue;
+      }
+      for (int i = 0; i < consumer->input_size(); ++i) {
+        int port;
+        const string input = ParseNodeName(consumer->input(i), &port);
+        if (input != node->name()) {
+          continue;
+        }
+        if (port < 0) {
+          *consumer->mutable_input(i) =
+              strings::StrCat("^", InvariantEnter(*node, 0));
+        } else {
+          *consumer->mutable_input(i) = InvariantEnter(*node, port);
+        }
+      }
+    }
+
+    if (IsConstant(*node)) {
+      node->clear_input();
+      return;
+    }
+    for (int i = 0; i < node->input_size(); ++i) {
+      const NodeDef* input_node = node_map_.GetNode(node->input(i));
+      if (invariants_.count(input_node) > 0) {
+        continue;
+      }
+      // Read the value entering the frame directly.
+      const string& outer_input = input_node->input(0);
+      if (IsControlInput(node->input(i))) {
+        *node->mutable_input(i) =
+            strings::StrCat("^", NodeName(outer_input));
+      } else {
+        *node->mutable_input(i) = outer_input;
+      }
+    }
+  }
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* graph_;
+  NodeMap node_map_;
+  // Frames each node belongs to, from the outermost to the innermost.
+  std::unordered_map<const NodeDef*, std::vector<string>> frames_;
+  // One of the Enter nodes of each frame.
+  std::unordered_map<string, const NodeDef*> frame_enters_;
+  std::unordered_set<const NodeDef*> invariants_;
+};
+
+}  // namespace
+
+Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                               GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  std::unordered_set<string> nodes_to_preserve;
+  for (const auto& node : item.fetch) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+  for (const auto& feed : item.feed) {
+    nodes_to_preserve.insert(NodeName(feed.first));
+  }
+  for (const auto& node : item.init_ops) {
+    nodes_to_preserve.insert(NodeName(node));
+  }
+
+  LoopInvariantNodeMotion motion(nodes_to_preserve, optimized_graph);
+  motion.Run();
+  return Status::OK();
+}
+
+void LoopOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                             const GraphDef& optimized_graph, double result) {
+  // Nothing to do for LoopOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
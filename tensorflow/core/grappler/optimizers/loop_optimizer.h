@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Hoists the loop invariant nodes out of while loops.
+//
+// A node of a frame is loop invariant if all its inputs are constant Enter
+// nodes of the frame or other loop invariant nodes, or if it is a constant
+// that only has control inputs. Invariant nodes must be stateless and must
+// not take or produce references. They are moved to the enclosing frame by
+// rewiring their inputs to the inputs of the constant Enter nodes, and their
+// consumers in the frame read them through new constant Enter nodes, so they
+// run once instead of once per iteration. Nodes are moved out of a single
+// level of nested loops per run.
+class LoopOptimizer : public GraphOptimizer {
+ public:
+  LoopOptimizer() {}
+  ~LoopOptimizer() override {}
+
+  string name() const override { return "loop_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_LOOP_OPTIMIZER_H_
@@ -0,0 +1,160 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class LoopOptimizerTest : public ::testing::Test {
+ protected:
+  static NodeDef* AddNode(const string& name, const string& op,
+                          const std::vector<string>& inputs, DataType type,
+                          GraphDef* graph) {
+    NodeDef* node = graph->add_node();
+    node->set_name(name);
+    node->set_op(op);
+    for (const string& input : inputs) {
+      *node->add_input() = input;
+    }
+    if (type == DT_INVALID) {
+      return node;
+    }
+    if (op == "Placeholder" || op == "Const" || op == "RandomUniform") {
+      AddNodeAttr("dtype", type, node);
+    } else {
+      AddNodeAttr("T", type, node);
+    }
+    return node;
+  }
+
+  static NodeDef* AddEnter(const string& name, const string& input,
+                           DataType type, bool is_constant, GraphDef* graph) {
+    NodeDef* node = AddNode(name, "Enter", {input}, type, graph);
+    AddNodeAttr("frame_name", "while/while_context", node);
+    AddNodeAttr("is_constant", is_constant, node);
+    AddNodeAttr("parallel_iterations", 10, node);
+    return node;
+  }
+
+  // Builds a loop computing x = MatMul(x, Transpose(w)) at each iteration.
+  static GrapplerItem CreateLoopItem() {
+    GrapplerItem item;
+    GraphDef* graph = &item.graph;
+    AddNode("w", "Placeholder", {}, DT_FLOAT, graph);
+    AddNode("x", "Placeholder", {}, DT_FLOAT, graph);
+    AddNode("cond", "Placeholder", {}, DT_BOOL, graph);
+    AddEnter("while/Enter_w", "w", DT_FLOAT, true, graph);
+    AddEnter("while/Enter_x", "x", DT_FLOAT, false, graph);
+    AddEnter("while/Enter_cond", "cond", DT_BOOL, true, graph);
+    NodeDef* merge = AddNode("while/Merge", "Merge",
+                             {"while/Enter_x", "while/NextIteration"},
+                             DT_FLOAT, graph);
+    AddNodeAttr("N", 2, merge);
+    AddNode("while/LoopCond", "LoopCond", {"while/Enter_cond"}, DT_INVALID,
+            graph);
+    AddNode("while/Switch", "Switch", {"while/Merge", "while/LoopCond"},
+            DT_FLOAT, graph);
+    AddNode("while/Identity", "Identity", {"while/Switch:1"}, DT_FLOAT, graph);
+    NodeDef* perm =
+        AddNode("while/perm", "Const", {"^while/Identity"}, DT_INT32, graph);
+    AddNodeAttr("value", test::AsTensor<int32>({1, 0}), perm);
+    NodeDef* transpose =
+        AddNode("while/Transpose", "Transpose",
+                {"while/Enter_w", "while/perm"}, DT_FLOAT, graph);
+    AddNodeAttr("Tperm", DT_INT32, transpose);
+    AddNode("while/MatMul", "MatMul", {"while/Identity", "while/Transpose"},
+            DT_FLOAT, graph);
+    AddNode("while/NextIteration", "NextIteration", {"while/MatMul"},
+            DT_FLOAT, graph);
+    AddNode("while/Exit", "Exit", {"while/Switch"}, DT_FLOAT, graph);
+    item.fetch.push_back("while/Exit");
+    return item;
+  }
+};
+
+TEST_F(LoopOptimizerTest, HoistInvariantNodes) {
+  GrapplerItem item = CreateLoopItem();
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() + 1, output.node_size());
+  NodeMap node_map(&output);
+  const NodeDef* perm = node_map.GetNode("while/perm");
+  EXPECT_EQ(0, perm->input_size());
+  const NodeDef* transpose = node_map.GetNode("while/Transpose");
+  ASSERT_EQ(2, transpose->input_size());
+  EXPECT_EQ("w", transpose->input(0));
+  EXPECT_EQ("while/perm", transpose->input(1));
+
+  const NodeDef* matmul = node_map.GetNode("while/MatMul");
+  ASSERT_EQ(2, matmul->input_size());
+  EXPECT_EQ("while/Identity", matmul->input(0));
+  EXPECT_EQ("LoopOptimizer/Enter/while/Transpose", matmul->input(1));
+
+  const NodeDef* enter =
+      node_map.GetNode("LoopOptimizer/Enter/while/Transpose");
+  ASSERT_NE(nullptr, enter);
+  EXPECT_EQ("Enter", enter->op());
+  ASSERT_EQ(1, enter->input_size());
+  EXPECT_EQ("while/Transpose", enter->input(0));
+  EXPECT_EQ(DT_FLOAT, enter->attr().at("T").type());
+  EXPECT_EQ("while/while_context", enter->attr().at("frame_name").s());
+  EXPECT_TRUE(enter->attr().at("is_constant").b());
+  EXPECT_EQ(10, enter->attr().at("parallel_iterations").i());
+
+  // The loop variable isn't invariant.
+  EXPECT_EQ("while/Merge", node_map.GetNode("while/Switch")->input(0));
+  EXPECT_EQ("while/Enter_cond", node_map.GetNode("while/LoopCond")->input(0));
+}
+
+TEST_F(LoopOptimizerTest, DontHoistStatefulOrFetchedNodes) {
+  GrapplerItem item = CreateLoopItem();
+  AddNode("shape", "Placeholder", {}, DT_INT32, &item.graph);
+  AddEnter("while/Enter_shape", "shape", DT_INT32, true, &item.graph);
+  NodeDef* random = AddNode("while/Random", "RandomUniform",
+                            {"while/Enter_shape"}, DT_FLOAT, &item.graph);
+  AddNodeAttr("T", DT_INT32, random);
+  item.fetch.push_back("while/Transpose");
+
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  EXPECT_EQ("while/Enter_shape", node_map.GetNode("while/Random")->input(0));
+  EXPECT_EQ("while/Enter_w", node_map.GetNode("while/Transpose")->input(0));
+  EXPECT_EQ("while/Transpose", node_map.GetNode("while/MatMul")->input(1));
+  // The constant is invariant but fed to a node that remains in the loop.
+  EXPECT_EQ("LoopOptimizer/Enter/while/perm",
+            node_map.GetNode("while/Transpose")->input(1));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
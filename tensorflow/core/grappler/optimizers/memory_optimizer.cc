@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <functional>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -23,8 +24,12 @@ limitations under the License.
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/graph_rewriter.h"
@@ -416,8 +421,139 @@ void RecomputeSubgraph(
   }
 }
 
+static int64 EstimateSize(const OpInfo::TensorProperties& t) {
+  DataType dtype = t.dtype();
+  int64 size = DataTypeSize(dtype);
+  TensorShapeProto shape = t.shape();
+  if (shape.unknown_rank()) {
+    // Can't infer the size if the rank is unknown. It has to be at least a
+    // scalar though.
+    return size;
+  }
+  // If one of the dimensions is unknown statically, assume it's at least one.
+  for (int i = 0; i < shape.dim_size(); ++i) {
+    if (shape.dim(i).size() < 0) {
+      shape.mutable_dim(i)->set_size(1);
+    }
+  }
+  int64 num_elems = TensorShape(shape).num_elements();
+  return num_elems * size;
+}
+
+// Predicts the costs of running the node on the device it is placed on.
+static Costs PredictNodeCosts(const GraphProperties& properties,
+                              const OpLevelCostEstimator& estimator,
+                              const VirtualPlacer& placer,
+                              const NodeDef& node) {
+  OpInfo op_features;
+  op_features.set_op(node.op());
+  *op_features.mutable_attr() = node.attr();
+  std::vector<OpInfo::TensorProperties> inputs =
+      properties.GetInputProperties(node.name());
+  for (auto& input : inputs) {
+    op_features.add_inputs()->Swap(&input);
+  }
+  DeviceProperties device = placer.get_device(node);
+  op_features.mutable_device()->Swap(&device);
+  return estimator.PredictCosts(op_features);
+}
+
+// Find groups of ops to recompute in order to bring the peak memory usage of
+// the GPUs of the cluster, as estimated by the cost model, under their memory
+// size. Besides the ops known to be cheap to recompute, forward ops that the
+// cost model predicts to be bound by memory bandwidth rather than by compute
+// are recomputed. The groups that free the most memory per nanosecond of
+// recomputation are picked first.
+std::vector<RecomputedSubGraph> GetOpGroupsToRecomputeUnderBudget(
+    Cluster* cluster, const GrapplerItem& item, const GraphDef* graph,
+    const NodeMap& node_map, const std::unordered_set<string>& feeds) {
+  std::vector<RecomputedSubGraph> selected_subgraphs;
+  if (!cluster) {
+    return selected_subgraphs;
+  }
+  GraphMemory memory(item);
+  Status status = memory.InferFromSchedule(cluster);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to estimate the peak memory usage: " << status;
+    return selected_subgraphs;
+  }
+  int64 required_savings = 0;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    required_savings = std::max(
+        required_savings,
+        memory.GetPeakMemoryUsage(device.first).used_memory -
+            prop.memory_size());
+  }
+  if (required_savings <= 0) {
+    // The graph fits in memory: don't waste any compute.
+    return selected_subgraphs;
+  }
+
+  GraphProperties properties(item);
+  status = properties.InferStatically();
+  if (!status.ok()) {
+    VLOG(1) << "Failed to infer the shapes of the graph: " << status;
+    return selected_subgraphs;
+  }
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster);
+  std::unordered_map<const NodeDef*, Costs> node_costs;
+  for (const auto& node : graph->node()) {
+    node_costs[&node] = PredictNodeCosts(properties, estimator, placer, node);
+  }
+
+  std::unordered_set<string> cheap_to_recompute_ops = GetCheapToRecomputeOps();
+  std::vector<RecomputedSubGraph> subgraphs = GetOpGroupsToRecompute(
+      graph, node_map,
+      [&cheap_to_recompute_ops, &feeds, &node_costs](const NodeDef& node) {
+        if (IsTargetOp(node) || feeds.count(node.name()) != 0) {
+          return false;
+        }
+        if (cheap_to_recompute_ops.count(node.op()) > 0 ||
+            node.attr().count(kRecomputeHint) > 0) {
+          return true;
+        }
+        const OpDef* op_def = nullptr;
+        if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+            op_def->is_stateful()) {
+          return false;
+        }
+        const Costs& costs = node_costs.at(&node);
+        return !costs.inaccurate && costs.compute_time <= costs.memory_time;
+      });
+
+  std::vector<int64> memory_freed(subgraphs.size(), 0);
+  std::vector<std::pair<double, int>> ranked_subgraphs;
+  for (int i = 0; i < subgraphs.size(); ++i) {
+    int64 recomputation_time = 1;
+    for (const NodeDef* node : subgraphs[i].recomputed_source_nodes) {
+      for (const auto& output : properties.GetOutputProperties(node->name())) {
+        memory_freed[i] += EstimateSize(output);
+      }
+      recomputation_time += node_costs.at(node).execution_time.count();
+    }
+    ranked_subgraphs.emplace_back(
+        static_cast<double>(memory_freed[i]) / recomputation_time, i);
+  }
+  std::sort(ranked_subgraphs.begin(), ranked_subgraphs.end(),
+            std::greater<std::pair<double, int>>());
+  for (const auto& ranked_subgraph : ranked_subgraphs) {
+    if (required_savings <= 0) {
+      break;
+    }
+    selected_subgraphs.push_back(subgraphs[ranked_subgraph.second]);
+    required_savings -= memory_freed[ranked_subgraph.second];
+  }
+  return selected_subgraphs;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                Cluster* cluster, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -448,7 +584,11 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                  (cheap_to_recompute_ops.count(node.op()) > 0 ||
                   node.attr().count(kRecomputeHint) > 0);
         });
-  } else {  // optimization_level == RewriterConfig::MANUAL
+  } else if (optimization_level ==
+             RewriterConfig::RECOMPUTATION_HEURISTICS) {
+    recomputed_subgraphs = GetOpGroupsToRecomputeUnderBudget(
+        cluster, item, graph, node_map, feeds);
+  } else {  // Only the manually annotated nodes.
     recomputed_subgraphs =
         GetOpGroupsToRecompute(graph, node_map, [&feeds](const NodeDef& node) {
           return !IsTargetOp(node) && feeds.count(node.name()) == 0 &&
@@ -494,25 +634,6 @@ std::pair<NodeDef*, NodeDef*> BuildSwapPair(NodeDef* node, int input_to_swap,
   return std::make_pair(swap_out_node, swap_in_node);
 }
 
-static int64 EstimateSize(const OpInfo::TensorProperties& t) {
-  DataType dtype = t.dtype();
-  int64 size = DataTypeSize(dtype);
-  TensorShapeProto shape = t.shape();
-  if (shape.unknown_rank()) {
-    // Can't infer the size if the rank is unknown. It has to be at least a
-    // scalar though.
-    return size;
-  }
-  // If one of the dimensions is unknown statically, assume it's at least one.
-  for (int i = 0; i < shape.dim_size(); ++i) {
-    if (shape.dim(i).size() < 0) {
-      shape.mutable_dim(i)->set_size(1);
-    }
-  }
-  int64 num_elems = TensorShape(shape).num_elements();
-  return num_elems * size;
-}
-
 struct SwapInfo {
   std::vector<int> inputs_to_swap;
   Costs::NanoSeconds time_to_swap = 0;
@@ -592,11 +713,123 @@ static const NodeDef* FindSwapTrigger(
   return nullptr;
 }
 
+// Tensors smaller than this aren't worth the overhead of swapping them.
+const int64 kMinSwapSize = 1024;
+
+struct SwapCandidate {
+  int64 memory_used;
+  // The consumers that run after the memory peak, and the ids of the inputs
+  // through which they read the tensor.
+  std::vector<std::pair<NodeDef*, int>> uses_left;
+  double fitness;
+};
+
+// Annotates with "_swap_to_host" the inputs of the nodes of "optimized_graph"
+// to swap in order to bring the peak memory usage of the GPUs of the cluster,
+// as estimated by the cost model, under their memory size.
+static Status IdentifySwappingCandidates(Cluster* cluster,
+                                         const GrapplerItem& item,
+                                         GraphDef* optimized_graph) {
+  GraphMemory memory(item);
+  TF_RETURN_IF_ERROR(memory.InferFromSchedule(cluster));
+
+  NodeMap node_map(optimized_graph);
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+    if (required_savings <= 0) {
+      continue;
+    }
+    const Costs::Duration peak_time = mem_usage.peak_time;
+
+    std::vector<SwapCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used < kMinSwapSize) {
+        continue;
+      }
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const Costs::Duration time_to_swap(live_tensor.memory_used / 16);
+      // The tensor must be swapped out before the peak, and can only be
+      // swapped back in after the peak without recreating the bottleneck.
+      if (peak_time - live_tensor.allocation_time < time_to_swap) {
+        continue;
+      }
+      SwapCandidate candidate;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::Duration earliest_use = Costs::Duration::max();
+      bool valid = true;
+      for (NodeDef* output : node_map.GetOutputs(live_tensor.node)) {
+        if (output->attr().count("_swap_to_host") != 0) {
+          // Leave the manually annotated nodes alone.
+          valid = false;
+          break;
+        }
+        const Costs::Duration use_time =
+            memory.GetCompletionTime(output->name());
+        for (int i = 0; i < output->input_size(); ++i) {
+          int position;
+          const string input = ParseNodeName(output->input(i), &position);
+          if (input != live_tensor.node || position != live_tensor.output_id) {
+            continue;
+          }
+          if (use_time == Costs::Duration::max()) {
+            valid = false;
+          } else if (use_time > peak_time) {
+            candidate.uses_left.emplace_back(output, i);
+            earliest_use = std::min(earliest_use, use_time);
+          }
+        }
+      }
+      if (!valid || candidate.uses_left.empty() ||
+          earliest_use - peak_time < time_to_swap) {
+        continue;
+      }
+      // Prefer the tensors that remain unused the longest around the peak, and
+      // that have as few uses left as possible since each of them triggers a
+      // swap.
+      candidate.fitness = static_cast<double>(
+                              (earliest_use - live_tensor.allocation_time)
+                                  .count()) /
+                          candidate.uses_left.size();
+      candidates.push_back(candidate);
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const SwapCandidate& a, const SwapCandidate& b) {
+                return a.fitness > b.fitness;
+              });
+    for (const SwapCandidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      for (const auto& use : candidate.uses_left) {
+        AttrValue& val = (*use.first->mutable_attr())["_swap_to_host"];
+        val.mutable_list()->add_i(use.second);
+      }
+      required_savings -= candidate.memory_used;
+    }
+  }
+  return Status::OK();
+}
+
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                  GraphDef* optimized_graph) {
   *optimized_graph = item.graph;
 
-  RecomputationRewritingPass(optimization_level_, optimized_graph, item);
+  RecomputationRewritingPass(optimization_level_, cluster, optimized_graph,
+                             item);
+
+  if (optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS && cluster) {
+    Status s = IdentifySwappingCandidates(cluster, item, optimized_graph);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to estimate the tensors to swap: " << s;
+    }
+  }
 
   // Figure out what needs to be swapped;
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
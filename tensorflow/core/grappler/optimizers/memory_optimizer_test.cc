@@ -191,6 +191,53 @@ TEST_F(RecomputeSubgraphTest, MultiNode) {
   EXPECT_EQ("^gradients/BN1Grad", recompute_trigger_c->input(0));
 }
 
+TEST_F(RecomputeSubgraphTest, RecomputationHeuristics) {
+  // The output of the Tanh is held from the forward pass until the very end of
+  // the backward pass, and is cheap to recompute.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Variable(s.WithOpName("a"), {1024, 1024}, DT_FLOAT);
+  Output b = ops::Tanh(s.WithOpName("b"), a);
+  Output c = ops::MatMul(s.WithOpName("c"), b, b);
+  Output d = ops::MatMul(s.WithOpName("d"), c, c);
+  Output e = ops::AddN(s.WithOpName("gradients/e"), {d});
+  Output f = ops::AddN(s.WithOpName("gradients/f"), {e, b});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch.push_back("gradients/f");
+
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.set_frequency(1000);
+  gpu_device.set_num_cores(24);
+  (*gpu_device.mutable_environment())["architecture"] = "6";
+  std::unordered_map<string, DeviceProperties> devices;
+  const string kGPU0 = "/job:localhost/replica:0/task:0/gpu:0";
+
+  // The peak memory usage of 12MB fits in memory, nothing is recomputed.
+  gpu_device.set_memory_size(1 << 30);
+  devices[kGPU0] = gpu_device;
+  VirtualCluster large_cluster(devices);
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&large_cluster, item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  // The output of the MatMuls would be expensive to recompute: only the Tanh
+  // is recomputed.
+  gpu_device.set_memory_size(10 << 20);
+  devices[kGPU0] = gpu_device;
+  VirtualCluster small_cluster(devices);
+  TF_EXPECT_OK(optimizer.Optimize(&small_cluster, item, &output));
+  NodeMap node_map(&output);
+  EXPECT_NE(nullptr, node_map.GetNode("Recomputed/b"));
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/d"));
+  const NodeDef* transformed_f = node_map.GetNode(f.name());
+  ASSERT_NE(nullptr, transformed_f);
+  EXPECT_EQ("gradients/e", transformed_f->input(0));
+  EXPECT_EQ("Recomputed/b", transformed_f->input(1));
+}
+
 class MemoryOptimizerTest : public ::testing::Test {
  public:
   static std::unique_ptr<VirtualCluster> CreateVirtualCluster() {
@@ -203,6 +250,36 @@ class MemoryOptimizerTest : public ::testing::Test {
     devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
     return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
   }
+
+  static std::unique_ptr<VirtualCluster> CreateGpuCluster(int64 memory_size) {
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(24);
+    gpu_device.set_memory_size(memory_size);
+    (*gpu_device.mutable_environment())["architecture"] = "6";
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/gpu:0"] = gpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+
+  // Builds a graph where the 4MB output of "b" stays alive while a chain of
+  // large matrix multiplications executes. The peak memory usage is 12MB: the
+  // variable "a", "b" and one of the products.
+  static GrapplerItem CreateLongLivedActivationItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output a = ops::Variable(s.WithOpName("a"), {1024, 1024}, DT_FLOAT);
+    Output b = ops::AddN(s.WithOpName("b"), {a});
+    Output c = ops::MatMul(s.WithOpName("c"), a, a);
+    Output d = ops::MatMul(s.WithOpName("d"), c, c);
+    Output e = ops::MatMul(s.WithOpName("e"), d, d);
+    Output f = ops::AddN(s.WithOpName("f"), {b, e});
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch.push_back("f");
+    return item;
+  }
 };
 
 TEST_F(MemoryOptimizerTest, SimpleSwapping) {
@@ -250,6 +327,43 @@ TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   EXPECT_EQ("^c", swap_in.input(1));
 }
 
+TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
+  GrapplerItem item = CreateLongLivedActivationItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateGpuCluster(10 << 20));
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* f = node_map.GetNode("f");
+  ASSERT_NE(nullptr, f);
+  EXPECT_EQ("swap_in_f_0", f->input(0));
+  EXPECT_EQ("e", f->input(1));
+  const NodeDef* swap_out = node_map.GetNode("swap_out_f_0");
+  ASSERT_NE(nullptr, swap_out);
+  EXPECT_EQ("b", swap_out->input(0));
+  const NodeDef* swap_in = node_map.GetNode("swap_in_f_0");
+  ASSERT_NE(nullptr, swap_in);
+  EXPECT_EQ("swap_out_f_0", swap_in->input(0));
+  // The tensor is swapped back in while "e" executes.
+  EXPECT_EQ("^d", swap_in->input(1));
+}
+
+TEST_F(MemoryOptimizerTest, NoSwappingWhenGraphFits) {
+  GrapplerItem item = CreateLongLivedActivationItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateGpuCluster(1 << 30));
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(0, node.attr().count("_swap_to_host"));
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
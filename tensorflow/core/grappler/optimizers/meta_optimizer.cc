@@ -16,12 +16,18 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/placement_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/core/grappler/optimizers/scheduling_optimizer.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -38,9 +44,24 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::NewOptimizer(
   if (optimizer == "constfold") {
     graph_optimizer.reset(new ConstantFolding());
   }
+  if (optimizer == "arithmetic") {
+    graph_optimizer.reset(new ArithmeticOptimizer());
+  }
+  if (optimizer == "loop") {
+    graph_optimizer.reset(new LoopOptimizer());
+  }
+  if (optimizer == "placement") {
+    graph_optimizer.reset(new PlacementOptimizer());
+  }
+  if (optimizer == "mixed_precision") {
+    graph_optimizer.reset(new AutoMixedPrecision());
+  }
   if (optimizer == "layout") {
     graph_optimizer.reset(new LayoutOptimizer());
   }
+  if (optimizer == "remap") {
+    graph_optimizer.reset(new Remapper());
+  }
   if (optimizer == "memory") {
     graph_optimizer.reset(new MemoryOptimizer(RewriterConfig::MANUAL));
   }
@@ -48,6 +69,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::NewOptimizer(
     graph_optimizer.reset(
         new AutoParallel(cfg_.auto_parallel().num_replicas()));
   }
+  if (optimizer == "scheduling") {
+    graph_optimizer.reset(new SchedulingOptimizer());
+  }
   return graph_optimizer;
 }
 
@@ -62,10 +86,29 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       optimizers.push_back(
           std::unique_ptr<GraphOptimizer>(new ConstantFolding()));
     }
+    if (cfg_.arithmetic_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new ArithmeticOptimizer()));
+    }
+    if (cfg_.loop_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new LoopOptimizer()));
+    }
+    if (cfg_.placement_optimization()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new PlacementOptimizer()));
+    }
+    if (cfg_.auto_mixed_precision()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new AutoMixedPrecision()));
+    }
     if (cfg_.optimize_tensor_layout()) {
       optimizers.push_back(
           std::unique_ptr<GraphOptimizer>(new LayoutOptimizer()));
     }
+    if (cfg_.remapping()) {
+      optimizers.push_back(std::unique_ptr<GraphOptimizer>(new Remapper()));
+    }
     if (cfg_.memory_optimization() > 0) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
           new MemoryOptimizer(cfg_.memory_optimization())));
@@ -74,9 +117,15 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
           new AutoParallel(cfg_.auto_parallel().num_replicas())));
     }
+    if (cfg_.schedule_priorities()) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new SchedulingOptimizer()));
+    }
   } else {
-    std::set<string> available_optimizers = {"pruning", "constfold", "layout",
-                                             "memory", "autoparallel"};
+    std::set<string> available_optimizers = {
+        "pruning",   "constfold",       "arithmetic", "loop",
+        "placement", "mixed_precision", "layout",     "remap",
+        "memory",    "autoparallel",    "scheduling"};
     for (const auto& optimizer : cfg_.optimizers()) {
       if (available_optimizers.find(optimizer) != available_optimizers.end()) {
         optimizers.push_back(NewOptimizer(optimizer));
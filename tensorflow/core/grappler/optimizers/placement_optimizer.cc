@@ -0,0 +1,293 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/placement_optimizer.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/analytical_cost_estimator.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Maximum number of placements simulated with the cost model.
+const int kMaxEvaluations = 200;
+
+struct PlacementCost {
+  Costs::Duration step_time;
+  int cross_device_edges;
+
+  bool operator<(const PlacementCost& other) const {
+    if (step_time != other.step_time) {
+      return step_time < other.step_time;
+    }
+    return cross_device_edges < other.cross_device_edges;
+  }
+};
+
+// Only move the nodes that have a GPU kernel, or that have no kernel linked
+// in at all.
+bool CanPlaceOnGpu(const NodeDef& node) {
+  if (FindKernelDef(DeviceType(DEVICE_GPU), node, nullptr, nullptr).ok()) {
+    return true;
+  }
+  return !FindKernelDef(DeviceType(DEVICE_CPU), node, nullptr, nullptr).ok();
+}
+
+class PlacementSearch {
+ public:
+  PlacementSearch(Cluster* cluster, const GrapplerItem& item, GraphDef* graph)
+      : item_(item),
+        graph_(graph),
+        estimator_(cluster, true /* use_static_shapes */),
+        evaluations_(0) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") {
+        devices_.push_back(device.first);
+      }
+    }
+    std::sort(devices_.begin(), devices_.end());
+  }
+
+  Status Run() {
+    if (devices_.size() < 2) {
+      return Status::OK();
+    }
+    TopologicalSort(graph_);
+    BuildGroups();
+    if (groups_.empty()) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(estimator_.Initialize(item_));
+
+    // Start from the placement of all the nodes on the first GPU, and use it
+    // to estimate the compute cost of each group.
+    std::vector<int> best(groups_.size(), 0);
+    CostGraphDef cost_graph;
+    PlacementCost best_cost;
+    TF_RETURN_IF_ERROR(Evaluate(best, &cost_graph, &best_cost));
+    std::unordered_map<string, int64> compute_costs;
+    for (const auto& node : cost_graph.node()) {
+      compute_costs[node.name()] = node.compute_cost();
+    }
+    std::vector<int64> group_costs(groups_.size(), 0);
+    int64 total_cost = 0;
+    for (int i = 0; i < groups_.size(); ++i) {
+      for (const NodeDef* node : groups_[i]) {
+        // Count every node, since the cost of small ops rounds down to 0.
+        group_costs[i] += compute_costs[node->name()] + 1;
+      }
+      total_cost += group_costs[i];
+    }
+
+    // Model parallel splits into contiguous stages of similar cost.
+    for (int num_stages = 2; num_stages <= devices_.size(); ++num_stages) {
+      std::vector<int> placement(groups_.size());
+      int64 cost_so_far = 0;
+      for (int i = 0; i < groups_.size(); ++i) {
+        const int64 midpoint = cost_so_far + group_costs[i] / 2;
+        placement[i] = std::min<int64>(num_stages - 1,
+                                       midpoint * num_stages / total_cost);
+        cost_so_far += group_costs[i];
+      }
+      PlacementCost cost;
+      TF_RETURN_IF_ERROR(Evaluate(placement, nullptr, &cost));
+      if (cost < best_cost) {
+        best = placement;
+        best_cost = cost;
+      }
+    }
+
+    // Greedy refinement.
+    bool improved = true;
+    while (improved && evaluations_ < kMaxEvaluations) {
+      improved = false;
+      for (int i = 0; i < groups_.size(); ++i) {
+        for (int device = 0; device < devices_.size(); ++device) {
+          if (device == best[i] || evaluations_ >= kMaxEvaluations) {
+            continue;
+          }
+          std::vector<int> placement = best;
+          placement[i] = device;
+          PlacementCost cost;
+          TF_RETURN_IF_ERROR(Evaluate(placement, nullptr, &cost));
+          if (cost < best_cost) {
+            best = placement;
+            best_cost = cost;
+            improved = true;
+          }
+        }
+      }
+    }
+
+    VLOG(1) << "Simulated step time of the best placement: "
+            << best_cost.step_time.count() << " ns, with "
+            << best_cost.cross_device_edges << " cross device edges, after "
+            << evaluations_ << " evaluations";
+    Assign(best);
+    return Status::OK();
+  }
+
+ private:
+  // Groups the nodes that the placer will colocate, and keeps the groups of
+  // unplaced nodes in topological order.
+  void BuildGroups() {
+    std::unordered_map<string, string> parent;
+    std::function<string(const string&)> find =
+        [&parent, &find](const string& name) -> string {
+      auto it = parent.find(name);
+      if (it == parent.end() || it->second == name) {
+        return name;
+      }
+      it->second = find(it->second);
+      return it->second;
+    };
+    auto join = [&parent, &find](const string& a, const string& b) {
+      const string root_a = find(a);
+      const string root_b = find(b);
+      if (root_a != root_b) {
+        parent[root_b] = root_a;
+      }
+    };
+
+    NodeMap node_map(graph_);
+    for (const NodeDef& node : graph_->node()) {
+      auto it = node.attr().find("_class");
+      if (it != node.attr().end()) {
+        for (const string& value : it->second.list().s()) {
+          if (StringPiece(value).starts_with("loc@")) {
+            join(value.substr(4), node.name());
+          }
+        }
+      }
+      for (const string& input : node.input()) {
+        if (IsControlInput(input)) {
+          continue;
+        }
+        const NodeDef* input_node = node_map.GetNode(input);
+        if (input_node && IsVariable(*input_node)) {
+          join(input_node->name(), node.name());
+        }
+      }
+    }
+
+    std::unordered_map<string, std::vector<NodeDef*>> members;
+    std::vector<string> roots;
+    for (NodeDef& node : *graph_->mutable_node()) {
+      const string root = find(node.name());
+      if (members.find(root) == members.end()) {
+        roots.push_back(root);
+      }
+      members[root].push_back(&node);
+    }
+    for (const string& root : roots) {
+      bool movable = true;
+      for (const NodeDef* node : members[root]) {
+        if (!node->device().empty() || !CanPlaceOnGpu(*node)) {
+          movable = false;
+          break;
+        }
+      }
+      if (movable) {
+        groups_.push_back(members[root]);
+      }
+    }
+  }
+
+  void Assign(const std::vector<int>& placement) {
+    for (int i = 0; i < groups_.size(); ++i) {
+      for (NodeDef* node : groups_[i]) {
+        node->set_device(devices_[placement[i]]);
+      }
+    }
+  }
+
+  Status Evaluate(const std::vector<int>& placement, CostGraphDef* cost_graph,
+                  PlacementCost* cost) {
+    ++evaluations_;
+    Assign(placement);
+    Costs costs;
+    TF_RETURN_IF_ERROR(estimator_.PredictCosts(*graph_, cost_graph, &costs));
+    cost->step_time = costs.execution_time;
+
+    std::unordered_map<string, const string*> devices;
+    for (const NodeDef& node : graph_->node()) {
+      devices[node.name()] = &node.device();
+    }
+    cost->cross_device_edges = 0;
+    for (const NodeDef& node : graph_->node()) {
+      for (const string& input : node.input()) {
+        if (IsControlInput(input)) {
+          continue;
+        }
+        auto it = devices.find(NodeName(input));
+        if (it != devices.end() && !it->second->empty() &&
+            !node.device().empty() && *it->second != node.device()) {
+          ++cost->cross_device_edges;
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  const GrapplerItem& item_;
+  GraphDef* graph_;
+  AnalyticalCostEstimator estimator_;
+  int evaluations_;
+  std::vector<string> devices_;
+  // The groups of nodes to place together, in topological order.
+  std::vector<std::vector<NodeDef*>> groups_;
+};
+
+}  // namespace
+
+Status PlacementOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (!cluster) {
+    return Status::OK();
+  }
+  PlacementSearch search(cluster, item, optimized_graph);
+  Status status = search.Run();
+  if (!status.ok()) {
+    // The placement is only an optimization: leave the graph as it was.
+    VLOG(1) << "Failed to search for a placement: " << status;
+    *optimized_graph = item.graph;
+  }
+  return Status::OK();
+}
+
+void PlacementOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimized_graph,
+                                  double result) {
+  // Nothing to do for PlacementOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_PLACEMENT_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_PLACEMENT_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Assigns the nodes that aren't placed yet to the GPUs of the cluster in order
+// to minimize the step time simulated with the analytical cost model.
+// The search starts from the placements that split the graph, in topological
+// order, into contiguous stages of similar compute cost (model parallelism).
+// It then greedily moves nodes to other GPUs as long as this reduces the
+// simulated step time, or the number of cross-device edges at equal step time.
+// Colocated nodes, and variables and their consumers, are moved together.
+class PlacementOptimizer : public GraphOptimizer {
+ public:
+  PlacementOptimizer() {}
+  ~PlacementOptimizer() override {}
+
+  string name() const override { return "placement_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_PLACEMENT_OPTIMIZER_H_
@@ -0,0 +1,119 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/placement_optimizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class PlacementOptimizerTest : public ::testing::Test {
+ protected:
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(int num_gpus) {
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(24);
+    (*gpu_device.mutable_environment())["architecture"] = "6";
+    std::unordered_map<string, DeviceProperties> devices;
+    for (int i = 0; i < num_gpus; ++i) {
+      devices[strings::StrCat("/job:localhost/replica:0/task:0/gpu:", i)] =
+          gpu_device;
+    }
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+
+  // Two independent branches of large matrix multiplications.
+  static GrapplerItem CreateTwoBranchItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Variable(s.WithOpName("x"), {1024, 1024}, DT_FLOAT);
+    Output a1 = ops::MatMul(s.WithOpName("a1"), x, x);
+    Output a2 = ops::MatMul(s.WithOpName("a2"), a1, a1);
+    Output y = ops::Variable(s.WithOpName("y"), {1024, 1024}, DT_FLOAT);
+    Output b1 = ops::MatMul(s.WithOpName("b1"), y, y);
+    Output b2 = ops::MatMul(s.WithOpName("b2"), b1, b1);
+    Output out = ops::AddN(s.WithOpName("out"), {a2, b2});
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch.push_back("out");
+    return item;
+  }
+};
+
+TEST_F(PlacementOptimizerTest, SplitsIndependentBranches) {
+  GrapplerItem item = CreateTwoBranchItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster(2));
+
+  PlacementOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const string& a_device = node_map.GetNode("a1")->device();
+  const string& b_device = node_map.GetNode("b1")->device();
+  EXPECT_FALSE(a_device.empty());
+  EXPECT_FALSE(b_device.empty());
+  EXPECT_NE(a_device, b_device);
+  // The variables are placed with their consumers, and the chains of
+  // multiplications aren't split across devices.
+  EXPECT_EQ(a_device, node_map.GetNode("x")->device());
+  EXPECT_EQ(a_device, node_map.GetNode("a2")->device());
+  EXPECT_EQ(b_device, node_map.GetNode("y")->device());
+  EXPECT_EQ(b_device, node_map.GetNode("b2")->device());
+}
+
+TEST_F(PlacementOptimizerTest, KeepsExistingPlacement) {
+  GrapplerItem item = CreateTwoBranchItem();
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    node.set_device("/job:localhost/replica:0/task:0/gpu:1");
+  }
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster(2));
+
+  PlacementOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ("/job:localhost/replica:0/task:0/gpu:1", node.device());
+  }
+}
+
+TEST_F(PlacementOptimizerTest, SingleGpu) {
+  GrapplerItem item = CreateTwoBranchItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster(1));
+
+  PlacementOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_TRUE(node.device().empty());
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
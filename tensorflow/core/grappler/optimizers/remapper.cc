@@ -0,0 +1,320 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include <set>
+#include <vector>
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+string GetDataFormat(const NodeDef& node) {
+  auto it = node.attr().find("data_format");
+  if (it == node.attr().end()) {
+    return "NHWC";
+  }
+  return it->second.s();
+}
+
+// Device names may spell the type as "GPU" or, in the legacy form, "gpu".
+bool IsOnGPU(const NodeDef& node) {
+  return StringPiece(str_util::Lowercase(node.device())).contains("gpu");
+}
+
+void AddControlInputs(const NodeDef& node, std::vector<string>* inputs) {
+  for (const auto& input : node.input()) {
+    if (IsControlInput(input)) {
+      inputs->push_back(input);
+    }
+  }
+}
+
+// The unary element-wise ops that _FusedUnaryCwise can chain.
+bool IsFusableUnary(const NodeDef& node) {
+  static const std::set<string>* ops = new std::set<string>(
+      {"Abs", "Exp", "Log", "Neg", "Reciprocal", "Relu", "Rsqrt", "Sigmoid",
+       "Sqrt", "Square", "Tanh"});
+  if (ops->find(node.op()) == ops->end() || node.attr().count("T") == 0) {
+    return false;
+  }
+  const DataType type = node.attr().at("T").type();
+  return type == DT_HALF || type == DT_FLOAT || type == DT_DOUBLE;
+}
+
+// Must match kMaxFusedUnaryOps in kernels/cwise_op_fused_unary.h.
+constexpr int kMaxFusedUnaryOps = 8;
+
+class PatternFuser {
+ public:
+  PatternFuser(const GrapplerItem& item, GraphDef* graph)
+      : graph_(graph), node_map_(graph) {
+    for (const auto& node : item.fetch) {
+      nodes_to_preserve_.insert(NodeName(node));
+    }
+    for (const auto& feed : item.feed) {
+      nodes_to_preserve_.insert(NodeName(feed.first));
+    }
+  }
+
+  // Fuses the patterns ending with a Relu if "relu" is set, and those ending
+  // with a BiasAdd otherwise. Returns the number of fused patterns.
+  int FuseConvBias(bool relu) {
+    int num_fused = 0;
+    const int num_nodes = graph_->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      NodeDef* node = graph_->mutable_node(i);
+      if (removed_.find(node->name()) != removed_.end()) {
+        continue;
+      }
+      const NodeDef* bias_add = node;
+      if (relu) {
+        if (node->op() != "Relu") {
+          continue;
+        }
+        bias_add = GetFusableInput(*node, "BiasAdd");
+      } else if (node->op() != "BiasAdd") {
+        continue;
+      }
+      if (bias_add == nullptr || bias_add->input_size() < 2) {
+        continue;
+      }
+      const NodeDef* conv = GetFusableInput(*bias_add, "Conv2D");
+      if (conv == nullptr || conv->input_size() < 2 ||
+          !CanFuse(*conv, *bias_add)) {
+        continue;
+      }
+      FuseNodes(conv, bias_add, relu, node);
+      ++num_fused;
+    }
+    return num_fused;
+  }
+
+  // Fuses the chains of at least two unary element-wise ops on GPU, where
+  // each op is otherwise a kernel launch of its own. Returns the number of
+  // fused chains.
+  int FuseUnaryChains() {
+    int num_fused = 0;
+    const int num_nodes = graph_->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      NodeDef* node = graph_->mutable_node(i);
+      if (removed_.find(node->name()) != removed_.end() ||
+          !IsFusableUnary(*node) ||
+          !IsOnGPU(*node) || !IsChainEnd(*node)) {
+        continue;
+      }
+      // The chain, from its last node to its first.
+      std::vector<const NodeDef*> chain = {node};
+      while (chain.size() < kMaxFusedUnaryOps) {
+        const NodeDef* input = GetFusableUnaryInput(*chain.back());
+        if (input == nullptr) {
+          break;
+        }
+        chain.push_back(input);
+      }
+      if (chain.size() < 2) {
+        continue;
+      }
+      FuseUnaryChain(chain, node);
+      ++num_fused;
+    }
+    return num_fused;
+  }
+
+  // Removes the nodes that were fused into another one.
+  void RemoveFusedNodes() {
+    int num_kept = 0;
+    for (int i = 0; i < graph_->node_size(); ++i) {
+      if (removed_.find(graph_->node(i).name()) != removed_.end()) {
+        continue;
+      }
+      if (i != num_kept) {
+        graph_->mutable_node()->SwapElements(i, num_kept);
+      }
+      ++num_kept;
+    }
+    graph_->mutable_node()->DeleteSubrange(num_kept,
+                                           graph_->node_size() - num_kept);
+  }
+
+ private:
+  // Returns the node feeding the first input of "node" if it is an "op" node
+  // that can be fused into "node": it must not be fed or fetched, must be on
+  // the same device, and must have no other consumer.
+  const NodeDef* GetFusableInput(const NodeDef& node, const string& op) const {
+    const NodeDef* input = GetSingleConsumerInput(node);
+    if (input == nullptr || input->op() != op) {
+      return nullptr;
+    }
+    return input;
+  }
+
+  // Like GetFusableInput, for any op that _FusedUnaryCwise can chain.
+  const NodeDef* GetFusableUnaryInput(const NodeDef& node) const {
+    const NodeDef* input = GetSingleConsumerInput(node);
+    if (input == nullptr || !IsFusableUnary(*input) ||
+        removed_.find(input->name()) != removed_.end()) {
+      return nullptr;
+    }
+    return input;
+  }
+
+  // True iff "node" is not itself fusable into its only consumer, i.e. it
+  // is the last node of the chain it belongs to.
+  bool IsChainEnd(const NodeDef& node) const {
+    const auto& outputs = node_map_.GetOutputs(node.name());
+    if (outputs.size() != 1) {
+      return true;
+    }
+    const NodeDef* consumer = *outputs.begin();
+    return !IsFusableUnary(*consumer) ||
+           GetFusableUnaryInput(*consumer) != &node;
+  }
+
+  // Returns the node feeding the first input of "node" if it is not fed or
+  // fetched, is on the same device and has the same type, and has no other
+  // consumer.
+  const NodeDef* GetSingleConsumerInput(const NodeDef& node) const {
+    if (node.input_size() < 1 || IsControlInput(node.input(0)) ||
+        NodePosition(node.input(0)) != 0) {
+      return nullptr;
+    }
+    const NodeDef* input = node_map_.GetNode(node.input(0));
+    if (input == nullptr || input->device() != node.device() ||
+        nodes_to_preserve_.find(input->name()) != nodes_to_preserve_.end() ||
+        node_map_.GetOutputs(input->name()).size() != 1 ||
+        input->attr().count("T") == 0 || node.attr().count("T") == 0 ||
+        input->attr().at("T").type() != node.attr().at("T").type()) {
+      return nullptr;
+    }
+    return input;
+  }
+
+  // True iff there is a _FusedConv2D kernel for "conv" and "bias_add".
+  bool CanFuse(const NodeDef& conv, const NodeDef& bias_add) const {
+    const DataType type = conv.attr().at("T").type();
+    if (type != DT_FLOAT && type != DT_HALF) {
+      return false;
+    }
+    const string data_format = GetDataFormat(conv);
+    if (data_format != GetDataFormat(bias_add)) {
+      return false;
+    }
+    // The CPU convolutions only support NHWC.
+    return data_format == "NHWC" || IsOnGPU(conv);
+  }
+
+  void FuseNodes(const NodeDef* conv, const NodeDef* bias_add, bool relu,
+                 NodeDef* node) {
+    NodeDef fused;
+    fused.set_name(node->name());
+    fused.set_op("_FusedConv2D");
+    fused.set_device(node->device());
+    *fused.add_input() = conv->input(0);
+    *fused.add_input() = conv->input(1);
+    *fused.add_input() = bias_add->input(1);
+    std::vector<string> control_inputs;
+    AddControlInputs(*conv, &control_inputs);
+    AddControlInputs(*bias_add, &control_inputs);
+    if (relu) {
+      AddControlInputs(*node, &control_inputs);
+    }
+    for (const auto& control_input : control_inputs) {
+      *fused.add_input() = control_input;
+    }
+    for (const char* attr :
+         {"T", "strides", "use_cudnn_on_gpu", "padding", "data_format"}) {
+      auto it = conv->attr().find(attr);
+      if (it != conv->attr().end()) {
+        (*fused.mutable_attr())[attr] = it->second;
+      }
+    }
+    (*fused.mutable_attr())["activation"].set_s(relu ? "Relu" : "Identity");
+
+    removed_.insert(conv->name());
+    if (bias_add != node) {
+      removed_.insert(bias_add->name());
+    }
+    node->Swap(&fused);
+  }
+
+  // Replaces "node", the last node of "chain", by a _FusedUnaryCwise of
+  // "chain", which is ordered from its last node to its first.
+  void FuseUnaryChain(const std::vector<const NodeDef*>& chain,
+                      NodeDef* node) {
+    NodeDef fused;
+    fused.set_name(node->name());
+    fused.set_op("_FusedUnaryCwise");
+    fused.set_device(node->device());
+    *fused.add_input() = chain.back()->input(0);
+    std::vector<string> control_inputs;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      AddControlInputs(**it, &control_inputs);
+    }
+    for (const auto& control_input : control_inputs) {
+      *fused.add_input() = control_input;
+    }
+    (*fused.mutable_attr())["T"] = node->attr().at("T");
+    auto* ops = (*fused.mutable_attr())["ops"].mutable_list();
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      ops->add_s((*it)->op());
+      if (*it != node) {
+        removed_.insert((*it)->name());
+      }
+    }
+    node->Swap(&fused);
+  }
+
+  GraphDef* graph_;
+  NodeMap node_map_;
+  std::set<string> nodes_to_preserve_;
+  std::set<string> removed_;
+};
+
+}  // namespace
+
+Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
+                          GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  PatternFuser fuser(item, optimized_graph);
+  // Fuse the longest patterns first, so that a BiasAdd feeding a Relu isn't
+  // fused on its own.
+  int num_fused = fuser.FuseConvBias(true);
+  num_fused += fuser.FuseConvBias(false);
+  VLOG(1) << "Fused " << num_fused << " convolutions with their biases.";
+  // A Relu fused into a convolution is no longer part of a unary chain.
+  const int num_chains = fuser.FuseUnaryChains();
+  VLOG(1) << "Fused " << num_chains << " chains of unary ops.";
+  if (num_fused + num_chains > 0) {
+    fuser.RemoveFusedNodes();
+  }
+  return Status::OK();
+}
+
+void Remapper::Feedback(Cluster* cluster, const GrapplerItem& item,
+                        const GraphDef& optimized_graph, double result) {
+  // Nothing to do for Remapper.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replaces patterns of ops by fused ops that compute the same values with fewer
+// passes over memory:
+// * Relu(BiasAdd(Conv2D(x, filter), bias)) => _FusedConv2D(x, filter, bias)
+//   with a Relu activation.
+// * BiasAdd(Conv2D(x, filter), bias) => _FusedConv2D(x, filter, bias).
+// * Chains of up to 8 unary element-wise ops on GPU, e.g. Tanh(Neg(Exp(x))),
+//   => _FusedUnaryCwise(x) with ops [Exp, Neg, Tanh], launching one kernel
+//   instead of one per op.
+// The fused node takes the name of the last node of the pattern, and the other
+// nodes of the pattern are removed.
+class Remapper : public GraphOptimizer {
+ public:
+  Remapper() {}
+  ~Remapper() override {}
+
+  string name() const override { return "remapper"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_REMAPPER_H_
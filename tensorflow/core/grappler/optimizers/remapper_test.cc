@@ -0,0 +1,173 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class RemapperTest : public ::testing::Test {
+ protected:
+  const NodeDef* GetNode(const GraphDef& graph, const string& name) {
+    for (const auto& node : graph.node()) {
+      if (node.name() == name) {
+        return &node;
+      }
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(RemapperTest, FuseConvBiasAddRelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {1, 4, 4, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {2, 2, 3, 8});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {8});
+  Output conv =
+      ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+
+  GrapplerItem item;
+  item.fetch.push_back("relu");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() - 2, output.node_size());
+  EXPECT_EQ(nullptr, GetNode(output, "conv"));
+  EXPECT_EQ(nullptr, GetNode(output, "bias_add"));
+  const NodeDef* fused = GetNode(output, "relu");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  ASSERT_EQ(3, fused->input_size());
+  EXPECT_EQ("input", fused->input(0));
+  EXPECT_EQ("filter", fused->input(1));
+  EXPECT_EQ("bias", fused->input(2));
+  EXPECT_EQ("Relu", fused->attr().at("activation").s());
+  EXPECT_EQ("SAME", fused->attr().at("padding").s());
+}
+
+TEST_F(RemapperTest, FuseConvBiasAdd) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {1, 4, 4, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {2, 2, 3, 8});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {8});
+  Output conv =
+      ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), bias_add);
+
+  GrapplerItem item;
+  item.fetch.push_back("tanh");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  const NodeDef* fused = GetNode(output, "bias_add");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  EXPECT_EQ("Identity", fused->attr().at("activation").s());
+  EXPECT_EQ("Tanh", GetNode(output, "tanh")->op());
+}
+
+TEST_F(RemapperTest, DontFuseFetchedNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {1, 4, 4, 3});
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {2, 2, 3, 8});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {8});
+  Output conv =
+      ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+
+  GrapplerItem item;
+  item.fetch = {"conv", "relu"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("Relu", GetNode(output, "relu")->op());
+}
+
+TEST_F(RemapperTest, FuseUnaryChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {2, 3});
+  Output exp = ops::Exp(s.WithOpName("exp"), input);
+  Output neg = ops::Neg(s.WithOpName("neg"), exp);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), neg);
+  Output sum = ops::Add(s.WithOpName("sum"), tanh, input);
+
+  GrapplerItem item;
+  item.fetch.push_back("sum");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size() - 2, output.node_size());
+  EXPECT_EQ(nullptr, GetNode(output, "exp"));
+  EXPECT_EQ(nullptr, GetNode(output, "neg"));
+  const NodeDef* fused = GetNode(output, "tanh");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedUnaryCwise", fused->op());
+  ASSERT_EQ(1, fused->input_size());
+  EXPECT_EQ("input", fused->input(0));
+  const auto& fused_ops = fused->attr().at("ops").list();
+  ASSERT_EQ(3, fused_ops.s_size());
+  EXPECT_EQ("Exp", fused_ops.s(0));
+  EXPECT_EQ("Neg", fused_ops.s(1));
+  EXPECT_EQ("Tanh", fused_ops.s(2));
+  EXPECT_EQ("tanh", GetNode(output, "sum")->input(0));
+}
+
+TEST_F(RemapperTest, DontFuseUnaryChainWithOtherConsumers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.0f, {2, 3});
+  Output exp = ops::Exp(s.WithOpName("exp"), input);
+  Output neg = ops::Neg(s.WithOpName("neg"), exp);
+  Output sum = ops::Add(s.WithOpName("sum"), neg, exp);
+
+  GrapplerItem item;
+  item.fetch.push_back("sum");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper remapper;
+  GraphDef output;
+  TF_EXPECT_OK(remapper.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("Exp", GetNode(output, "exp")->op());
+  EXPECT_EQ("Neg", GetNode(output, "neg")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
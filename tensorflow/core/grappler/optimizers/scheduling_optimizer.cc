@@ -0,0 +1,101 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scheduling_optimizer.h"
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns the total size in bytes of the outputs of "node", counting the
+// unknown dimensions as 1.
+int64 OutputSize(const GraphProperties& properties, const NodeDef& node) {
+  int64 size = 0;
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    if (output.shape().unknown_rank()) {
+      continue;
+    }
+    int64 num_elements = 1;
+    for (const auto& dim : output.shape().dim()) {
+      num_elements *= std::max<int64>(1, dim.size());
+    }
+    size += num_elements * DataTypeSize(output.dtype());
+  }
+  return size;
+}
+
+}  // namespace
+
+Status SchedulingOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                     GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (!cluster) {
+    return Status::OK();
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(item, cluster, &completion_times));
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_RETURN_IF_ERROR(
+      EstimateRequiredTimes(item, cluster, completion_times, &required_times));
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically());
+
+  // (slack, required time, output size, node index)
+  std::vector<std::tuple<int64, int64, int64, int>> schedule;
+  schedule.reserve(item.graph.node_size());
+  for (int i = 0; i < item.graph.node_size(); i++) {
+    const NodeDef* node = &item.graph.node(i);
+    const int64 required_time = required_times[node].count();
+    // The nodes that are never reached, e.g. because they are in a loop, are
+    // scheduled last.
+    auto it = completion_times.find(node);
+    const int64 slack = it == completion_times.end()
+                            ? kint64max
+                            : required_time - it->second.count();
+    schedule.emplace_back(slack, required_time, OutputSize(properties, *node),
+                          i);
+  }
+  std::sort(schedule.begin(), schedule.end());
+
+  for (int rank = 0; rank < static_cast<int>(schedule.size()); rank++) {
+    NodeDef* node = optimized_graph->mutable_node(std::get<3>(schedule[rank]));
+    (*node->mutable_attr())["_schedule_priority"].set_i(rank);
+  }
+  return Status::OK();
+}
+
+void SchedulingOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                   const GraphDef& optimized_graph,
+                                   double result) {
+  // Nothing to do for SchedulingOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
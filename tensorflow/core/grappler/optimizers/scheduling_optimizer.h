@@ -0,0 +1,49 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_OPTIMIZER_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Annotates each node with a "_schedule_priority" attribute, its rank in a
+// static schedule estimated with the cost model. The executor starts the
+// ready nodes with the lowest priorities first.
+//
+// Nodes are ranked by slack, the time by which they can be delayed without
+// delaying the whole step, so that the critical path starts first. Ties are
+// broken by required completion time, then by the size of the outputs, so as
+// to defer allocating large tensors and keep the peak memory down.
+class SchedulingOptimizer : public GraphOptimizer {
+ public:
+  SchedulingOptimizer() {}
+  ~SchedulingOptimizer() override {}
+
+  string name() const override { return "scheduling"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_SCHEDULING_OPTIMIZER_H_
@@ -0,0 +1,99 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/scheduling_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class SchedulingOptimizerTest : public ::testing::Test {
+ public:
+  std::unique_ptr<VirtualCluster> CreateVirtualCluster() const {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+
+  int64 Priority(const GraphDef& graph, const string& node_name) const {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == node_name) {
+        return node.attr().at("_schedule_priority").i();
+      }
+    }
+    return -1;
+  }
+};
+
+TEST_F(SchedulingOptimizerTest, CriticalPathFirst) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/cpu:0");
+  Output x = ops::RandomNormal(s.WithOpName("x"), {256, 256}, DT_FLOAT);
+  // A short branch, added first, and a long branch of matrix products.
+  Output short_branch = ops::Neg(s.WithOpName("short"), x);
+  Output long_branch = ops::MatMul(s.WithOpName("long_0"), x, x);
+  long_branch = ops::MatMul(s.WithOpName("long_1"), long_branch, x);
+  long_branch = ops::MatMul(s.WithOpName("long_2"), long_branch, x);
+  Output y = ops::AddN(s.WithOpName("y"), {short_branch, long_branch});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch.push_back("y");
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  SchedulingOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(1, node.attr().count("_schedule_priority")) << node.name();
+  }
+  // "x" and the long branch are on the critical path.
+  EXPECT_LT(Priority(output, "x"), Priority(output, "short"));
+  EXPECT_LT(Priority(output, "long_0"), Priority(output, "short"));
+  EXPECT_LT(Priority(output, "long_2"), Priority(output, "short"));
+}
+
+TEST_F(SchedulingOptimizerTest, NoCluster) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {10});
+  Output b = ops::Neg(s.WithOpName("b"), a);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  SchedulingOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(0, node.attr().count("_schedule_priority"));
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -119,5 +119,81 @@ Status EstimateEarliestExecutionTimes(
   return Status::OK();
 }
 
+Status EstimateRequiredTimes(
+    const GrapplerItem& item, const Cluster* cluster,
+    const std::unordered_map<const NodeDef*, Costs::NanoSeconds>&
+        execution_times,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times) {
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const NodeDef& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+    (*required_times)[&node] = Costs::NanoSeconds::max();
+  }
+  std::unordered_map<const NodeDef*, int> pending_fanouts;
+  for (const NodeDef& node : item.graph.node()) {
+    // Ignore the back edges of the loops.
+    if (IsNextIteration(node)) {
+      continue;
+    }
+    for (const string& input : node.input()) {
+      auto it = name_map.find(NodeName(input));
+      if (it == name_map.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      pending_fanouts[it->second]++;
+    }
+  }
+
+  // The whole graph completes at the latest completion time of its nodes.
+  Costs::NanoSeconds makespan(0);
+  for (const auto& execution_time : execution_times) {
+    makespan = std::max(makespan, execution_time.second);
+  }
+  std::deque<const NodeDef*> ready_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    if (pending_fanouts[&node] == 0) {
+      ready_nodes.push_back(&node);
+      (*required_times)[&node] = makespan;
+    }
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically());
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster);
+
+  while (!ready_nodes.empty()) {
+    const NodeDef* node = ready_nodes.front();
+    ready_nodes.pop_front();
+    if (IsNextIteration(*node)) {
+      continue;
+    }
+
+    Costs::NanoSeconds execution_time =
+        PredictExecutionTime(properties, estimator, placer, *node);
+    Costs::NanoSeconds required_start_time =
+        (*required_times)[node] - execution_time;
+
+    for (const string& input : node->input()) {
+      const NodeDef* fanin = name_map[NodeName(input)];
+      (*required_times)[fanin] =
+          std::min((*required_times)[fanin], required_start_time);
+      if (--pending_fanouts[fanin] == 0) {
+        ready_nodes.push_back(fanin);
+      }
+    }
+  }
+
+  // The nodes that were never reached, e.g. because of a loop, aren't
+  // constrained.
+  for (auto& required_time : *required_times) {
+    if (required_time.second == Costs::NanoSeconds::max()) {
+      required_time.second = makespan;
+    }
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -35,6 +35,17 @@ Status EstimateEarliestExecutionTimes(
     const GrapplerItem& item, const Cluster* cluster,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* execution_times);
 
+// Compute the time by which the execution of each node in the graph must
+// complete so as not to delay the completion of the whole graph, given the
+// earliest completion times computed by EstimateEarliestExecutionTimes. The
+// difference between the two is the slack of the node: the nodes on the
+// critical path have none.
+Status EstimateRequiredTimes(
+    const GrapplerItem& item, const Cluster* cluster,
+    const std::unordered_map<const NodeDef*, Costs::NanoSeconds>&
+        execution_times,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
@@ -121,6 +121,42 @@ TEST_F(StaticScheduleTest, BasicGraphWithCtrlDependencies) {
   }
 }
 
+TEST_F(StaticScheduleTest, RequiredTimes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a = ops::Const(s.WithOpName("a"), 0.0f, {10, 10});
+  Output b = ops::AddN(s.WithOpName("b"), {a});
+  Output c = ops::AddN(s.WithOpName("c"), {b});
+  // A short branch, which can be delayed until c completes.
+  Output d = ops::Identity(s.WithOpName("d"), a);
+  Output e = ops::AddN(s.WithOpName("e"), {c, d});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_EXPECT_OK(
+      EstimateEarliestExecutionTimes(item, cluster.get(), &completion_times));
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_EXPECT_OK(EstimateRequiredTimes(item, cluster.get(), completion_times,
+                                     &required_times));
+
+  EXPECT_EQ(item.graph.node_size(), required_times.size());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.name() == "d") {
+      // d may complete as late as c.
+      EXPECT_LT(completion_times[&node], required_times[&node]);
+      EXPECT_EQ(completion_times[&item.graph.node(2)], required_times[&node]);
+    } else {
+      // The other nodes are on the critical path.
+      EXPECT_EQ(completion_times[&node], required_times[&node]) << node.name();
+    }
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
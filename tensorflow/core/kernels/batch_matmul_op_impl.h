@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
@@ -191,6 +193,72 @@ struct SequentialMatMulKernel {
   }
 };
 
+// Batch matmul kernel for tiny real matrices, e.g. the per-head products of
+// attention layers.  For those the blocking and packing done by the general
+// Eigen matmul cost more than the multiply itself.  Instead, the operands of
+// each product are packed once into row-major [m, k] and [n, k] buffers on
+// the stack, so that every output element is a contiguous dot product.
+template <typename Scalar>
+struct SmallMatMulKernel {
+  // Matrices with all dimensions up to this size use this kernel.
+  static constexpr int64 kMaxDim = 32;
+
+  // Eigen::half products accumulate in float, other types in their own type.
+  typedef typename std::conditional<std::is_same<Scalar, Eigen::half>::value,
+                                    float, Scalar>::type Accumulator;
+
+  static bool CanUse(const Tensor& in_x, const Tensor& out) {
+    return std::max(std::max(in_x.dim_size(1), in_x.dim_size(2)),
+                    out.dim_size(2)) <= kMaxDim;
+  }
+
+  static void Run(const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                  bool adj_y, Tensor* out, int start, int limit) {
+    const int64 m = out->dim_size(1);
+    const int64 n = out->dim_size(2);
+    const int64 k = in_x.dim_size(adj_x ? 1 : 2);
+    Scalar x_packed[kMaxDim * kMaxDim];
+    Scalar y_packed[kMaxDim * kMaxDim];
+    for (int i = start; i < limit; ++i) {
+      const Scalar* x = in_x.flat<Scalar>().data() + i * m * k;
+      const Scalar* y = in_y.flat<Scalar>().data() + i * k * n;
+      Scalar* z = out->flat<Scalar>().data() + i * m * n;
+      // x is [k, m] when adjointed and y is [k, n] when not.
+      if (adj_x) {
+        Transpose(x, k, m, x_packed);
+        x = x_packed;
+      }
+      if (!adj_y) {
+        Transpose(y, k, n, y_packed);
+        y = y_packed;
+      }
+      for (int64 r = 0; r < m; ++r) {
+        const Scalar* x_row = x + r * k;
+        for (int64 c = 0; c < n; ++c) {
+          const Scalar* y_row = y + c * k;
+          Accumulator sum(0);
+          for (int64 p = 0; p < k; ++p) {
+            sum += static_cast<Accumulator>(x_row[p]) *
+                   static_cast<Accumulator>(y_row[p]);
+          }
+          z[r * n + c] = static_cast<Scalar>(sum);
+        }
+      }
+    }
+  }
+
+ private:
+  // Writes the transpose of the row-major [rows, cols] matrix in to out.
+  static void Transpose(const Scalar* in, int64 rows, int64 cols,
+                        Scalar* out) {
+    for (int64 r = 0; r < rows; ++r) {
+      for (int64 c = 0; c < cols; ++c) {
+        out[c * rows + r] = in[r * cols + c];
+      }
+    }
+  }
+};
+
 }  // namespace
 
 template <typename Device, typename Scalar>
@@ -235,11 +303,19 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
     } else {
       // Parallelize over outer dims. For small matrices and large batches, it
       // is counter-productive to parallelize the inner matrix multiplies.
+      const bool use_small_kernel =
+          !Eigen::NumTraits<Scalar>::IsComplex &&
+          SmallMatMulKernel<Scalar>::CanUse(in_x, *out);
       Shard(worker_threads.num_threads, worker_threads.workers, num_units,
-            cost_per_unit,
-            [&in_x, &in_y, adj_x, adj_y, out](int start, int limit) {
-              SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, out,
-                                                  start, limit);
+            cost_per_unit, [&in_x, &in_y, adj_x, adj_y, out, use_small_kernel](
+                               int start, int limit) {
+              if (use_small_kernel) {
+                SmallMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, out,
+                                               start, limit);
+              } else {
+                SequentialMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y,
+                                                    out, start, limit);
+              }
             });
     }
     if (conjugate_result) {
@@ -262,39 +338,6 @@ perftools::gputools::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory) {
   perftools::gputools::DeviceMemory<T> typed(wrapped);
   return typed;
 }
-
-class CublasScratchAllocator : public perftools::gputools::ScratchAllocator {
- public:
-  using Stream = ::perftools::gputools::Stream;
-  using DeviceMemoryBytes = ::perftools::gputools::DeviceMemory<uint8>;
-
-  CublasScratchAllocator(OpKernelContext* context) : context_(context) {}
-
-  int64 GetMemoryLimitInBytes(Stream* stream) override { return -1; }
-
-  perftools::gputools::port::StatusOr<DeviceMemoryBytes> AllocateBytes(
-      Stream* stream, int64 byte_size) override {
-    Tensor temporary_memory;
-
-    Status allocation_status(context_->allocate_temp(
-        DT_UINT8, TensorShape({byte_size}), &temporary_memory));
-    if (!allocation_status.ok()) {
-      return perftools::gputools::port::StatusOr<DeviceMemoryBytes>(
-          DeviceMemoryBytes::MakeFromByteSize(nullptr, 0));
-    }
-    // Hold the reference of the allocated tensors until the end of the
-    // allocator.
-    allocated_tensors_.push_back(temporary_memory);
-    return perftools::gputools::port::StatusOr<DeviceMemoryBytes>(
-        DeviceMemoryBytes::MakeFromByteSize(
-            temporary_memory.flat<uint8>().data(),
-            temporary_memory.flat<uint8>().size()));
-  }
-
- private:
-  OpKernelContext* context_;
-  std::vector<Tensor> allocated_tensors_;
-};
 }  // namespace
 
 template <typename Scalar>
@@ -317,30 +360,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
     auto* stream = context->op_device_context()->stream();
     OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
 
-    typedef perftools::gputools::DeviceMemory<Scalar> DeviceMemoryType;
-    std::vector<DeviceMemoryType> a_device_memory;
-    std::vector<DeviceMemoryType> b_device_memory;
-    std::vector<DeviceMemoryType> c_device_memory;
-    std::vector<DeviceMemoryType*> a_ptrs;
-    std::vector<DeviceMemoryType*> b_ptrs;
-    std::vector<DeviceMemoryType*> c_ptrs;
-    a_device_memory.reserve(batch_size);
-    b_device_memory.reserve(batch_size);
-    c_device_memory.reserve(batch_size);
-    a_ptrs.reserve(batch_size);
-    b_ptrs.reserve(batch_size);
-    c_ptrs.reserve(batch_size);
-    auto* a_base_ptr = in_x.template flat<Scalar>().data();
-    auto* b_base_ptr = in_y.template flat<Scalar>().data();
-    auto* c_base_ptr = out->template flat<Scalar>().data();
-    for (int64 i = 0; i < batch_size; ++i) {
-      a_device_memory.push_back(AsDeviceMemory(a_base_ptr + i * m * k));
-      b_device_memory.push_back(AsDeviceMemory(b_base_ptr + i * k * n));
-      c_device_memory.push_back(AsDeviceMemory(c_base_ptr + i * m * n));
-      a_ptrs.push_back(&a_device_memory.back());
-      b_ptrs.push_back(&b_device_memory.back());
-      c_ptrs.push_back(&c_device_memory.back());
-    }
+    auto a_device_memory = AsDeviceMemory(in_x.template flat<Scalar>().data());
+    auto b_device_memory = AsDeviceMemory(in_y.template flat<Scalar>().data());
+    auto c_device_memory = AsDeviceMemory(out->template flat<Scalar>().data());
 
     // Cublas does
     // C = A x B
@@ -350,7 +372,7 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
     // TODO(yangzihao): Choose the best of the three strategies using autotune.
     if (batch_size == 1) {
       // This is a regular matrix*matrix or matrix*vector multiply. Avoid the
-      // overhead of the scratch allocator and the batch interface.
+      // overhead of the batch interface.
       if (n == 1 &&
           blas_transpose_b !=
               perftools::gputools::blas::Transpose::kConjugateTranspose &&
@@ -368,9 +390,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         bool blas_launch_status =
             stream
                 ->ThenBlasGemv(gemv_trans_a, adj_x ? m : k, adj_x ? k : m,
-                               static_cast<Scalar>(1.0), *(a_ptrs[0]),
-                               adj_x ? m : k, *(b_ptrs[0]), 1,
-                               static_cast<Scalar>(0.0), c_ptrs[0], 1)
+                               static_cast<Scalar>(1.0), a_device_memory,
+                               adj_x ? m : k, b_device_memory, 1,
+                               static_cast<Scalar>(0.0), &c_device_memory, 1)
                 .ok();
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
@@ -382,9 +404,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         bool blas_launch_status =
             stream
                 ->ThenBlasGemm(blas_transpose_b, blas_transpose_a, n, m, k,
-                               static_cast<Scalar>(1.0), *(b_ptrs[0]),
-                               adj_y ? k : n, *(a_ptrs[0]), adj_x ? m : k,
-                               static_cast<Scalar>(0.0), c_ptrs[0], n)
+                               static_cast<Scalar>(1.0), b_device_memory,
+                               adj_y ? k : n, a_device_memory, adj_x ? m : k,
+                               static_cast<Scalar>(0.0), &c_device_memory, n)
                 .ok();
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
@@ -394,18 +416,20 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         }
       }
     } else {
-      CublasScratchAllocator scratch_allocator(context);
+      // The matrices of each batch are contiguous, so use the strided batched
+      // GEMM rather than building and copying arrays of matrix pointers.
       bool blas_launch_status =
           stream
-              ->ThenBlasGemmBatchedWithScratch(
+              ->ThenBlasGemmStridedBatched(
                   blas_transpose_b, blas_transpose_a, n, m, k,
-                  static_cast<Scalar>(1.0), b_ptrs, adj_y ? k : n, a_ptrs,
-                  adj_x ? m : k, static_cast<Scalar>(0.0), c_ptrs, n,
-                  batch_size, &scratch_allocator)
+                  static_cast<Scalar>(1.0), b_device_memory, adj_y ? k : n,
+                  k * n, a_device_memory, adj_x ? m : k, m * k,
+                  static_cast<Scalar>(0.0), &c_device_memory, n, m * n,
+                  batch_size)
               .ok();
       if (!blas_launch_status) {
         context->SetStatus(errors::Internal(
-            "Blas xGEMMBatched launch failed : a.shape=",
+            "Blas xGEMMStridedBatched launch failed : a.shape=",
             in_x.shape().DebugString(),
             ", b.shape=", in_y.shape().DebugString(), ", m=", m, ", n=", n,
             ", k=", k, ", batch_size=", batch_size));
@@ -103,6 +103,13 @@ BM_BatchMatmul(32, 256, 256, 256, false, false);
 BM_BatchMatmul(32, 1024, 1024, 1024, false, false);
 BM_BatchMatmul(32, 2048, 2048, 2048, false, false);
 
+// Many small matrices, as in multi-head attention.
+BM_BatchMatmul(1024, 8, 8, 8, false, false);
+BM_BatchMatmul(1024, 16, 16, 16, false, false);
+BM_BatchMatmul(1024, 16, 64, 16, false, true);
+BM_BatchMatmul(1024, 32, 32, 32, true, false);
+BM_BatchMatmul(1024, 64, 64, 64, false, false);
+
 // Matrix-vector multiplies.
 BM_BatchMatmul(1, 10000, 200, 1, false, false);
 BM_BatchMatmul(8, 10000, 200, 1, false, false);
@@ -17,17 +17,176 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include "tensorflow/core/kernels/bincount_op.h"
+
+#include <algorithm>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
 using thread::ThreadPool;
 
-template <typename T>
+namespace functor {
+
+// Blocks of elements are counted in parallel, each into its own partial bins,
+// so the threads never update the same bin. Every block has at least as many
+// elements as there are bins (and at least kMinBlockElements), so clearing
+// and summing the partial bins costs less than the counting itself, and the
+// temporary memory stays within the size of the input.
+template <typename T, typename BinFn>
+struct BincountFunctor<CPUDevice, T, BinFn> {
+  static constexpr int64 kMinBlockElements = 1024;
+
+  static Status Compute(OpKernelContext* ctx, const BinFn& bin_fn,
+                        int64 num_elements, const T* weights,
+                        typename TTypes<T>::Flat output) {
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    const int64 num_bins = output.size();
+    output.device(d) = output.constant(T(0));
+    if (num_bins == 0 || num_elements == 0) {
+      return Status::OK();
+    }
+
+    auto count = [&bin_fn, weights, num_bins](int64 start, int64 limit,
+                                              T* bins) {
+      for (int64 i = start; i < limit; ++i) {
+        const int32 bin = bin_fn(i);
+        if (bin >= 0 && bin < num_bins) {
+          // Complex numbers don't support "++".
+          bins[bin] += weights == nullptr ? T(1) : weights[i];
+        }
+      }
+    };
+
+    ThreadPool* thread_pool =
+        ctx->device()->tensorflow_cpu_worker_threads()->workers;
+    const int64 num_blocks = std::min<int64>(
+        thread_pool->NumThreads() + 1,
+        std::max<int64>(
+            1, num_elements / std::max(num_bins, kMinBlockElements)));
+    if (num_blocks == 1) {
+      count(0, num_elements, output.data());
+      return Status::OK();
+    }
+
+    const int64 block_size = (num_elements + num_blocks - 1) / num_blocks;
+    Tensor partial_bins_t;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({num_blocks, num_bins}),
+                                          &partial_bins_t));
+    auto partial_bins = partial_bins_t.matrix<T>();
+    partial_bins.device(d) = partial_bins.constant(T(0));
+    thread_pool->ParallelFor(
+        num_blocks, block_size * 8 /* cost */,
+        [&](int64 first_block, int64 last_block) {
+          for (int64 b = first_block; b < last_block; ++b) {
+            count(b * block_size, std::min(num_elements, (b + 1) * block_size),
+                  &partial_bins(b, 0));
+          }
+        });
+    // Sum the partial bins along the 0th axis.
+    Eigen::array<int, 1> reduce_dims({0});
+    output.device(d) = partial_bins.sum(reduce_dims);
+    return Status::OK();
+  }
+};
+
+template <typename T, typename BinFn>
+constexpr int64 BincountFunctor<CPUDevice, T, BinFn>::kMinBlockElements;
+
+template <>
+void AllNonNegative<CPUDevice>::operator()(
+    const CPUDevice& d, typename TTypes<int32>::ConstFlat arr,
+    typename TTypes<bool>::Scalar all_nonneg) {
+  all_nonneg.device(d) = (arr >= 0).all();
+}
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+template <>
+void AllNonNegative<GPUDevice>::operator()(
+    const GPUDevice& d, typename TTypes<int32>::ConstFlat arr,
+    typename TTypes<bool>::Scalar all_nonneg);
+extern template struct AllNonNegative<GPUDevice>;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace functor
+
+namespace {
+
+// Returns an error if any of the bins in 'arr' is negative.
+template <typename Device>
+Status CheckNonNegative(OpKernelContext* ctx,
+                        typename TTypes<int32>::ConstFlat arr);
+
+template <>
+Status CheckNonNegative<CPUDevice>(OpKernelContext* ctx,
+                                   typename TTypes<int32>::ConstFlat arr) {
+  Tensor all_nonneg_t;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_BOOL, TensorShape({}),
+                                        &all_nonneg_t, AllocatorAttributes()));
+  functor::AllNonNegative<CPUDevice>()(ctx->eigen_cpu_device(), arr,
+                                       all_nonneg_t.scalar<bool>());
+  if (!all_nonneg_t.scalar<bool>()()) {
+    return errors::InvalidArgument("Input arr must be non-negative!");
+  }
+  return Status::OK();
+}
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// The bins are checked on the device, and only the result is copied back.
+template <>
+Status CheckNonNegative<GPUDevice>(OpKernelContext* ctx,
+                                   typename TTypes<int32>::ConstFlat arr) {
+  if (arr.size() == 0) {
+    return Status::OK();
+  }
+  Tensor all_nonneg_t;
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_temp(DT_BOOL, TensorShape({}), &all_nonneg_t));
+  functor::AllNonNegative<GPUDevice>()(ctx->eigen_device<GPUDevice>(), arr,
+                                       all_nonneg_t.scalar<bool>());
+
+  AllocatorAttributes host_attr;
+  host_attr.set_on_host(true);
+  host_attr.set_gpu_compatible(true);
+  Tensor host_all_nonneg_t;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DT_BOOL, TensorShape({}),
+                                        &host_all_nonneg_t, host_attr));
+  auto* stream = ctx->op_device_context()->stream();
+  if (stream == nullptr) {
+    return errors::Internal("No GPU stream available.");
+  }
+  perftools::gputools::DeviceMemoryBase all_nonneg_gpu(
+      all_nonneg_t.scalar<bool>().data(), sizeof(bool));
+  stream->ThenMemcpy(host_all_nonneg_t.scalar<bool>().data(), all_nonneg_gpu,
+                     sizeof(bool));
+  stream->BlockHostUntilDone();
+  if (!stream->ok()) {
+    return errors::Internal("Failed to check the input of Bincount on the GPU");
+  }
+  if (!host_all_nonneg_t.scalar<bool>()()) {
+    return errors::InvalidArgument("Input arr must be non-negative!");
+  }
+  return Status::OK();
+}
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+
+template <typename Device, typename T>
 class BincountOp : public OpKernel {
  public:
   explicit BincountOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -49,60 +208,118 @@ class BincountOp : public OpKernel {
     const auto arr = arr_t.flat<int32>();
     const auto weights = weights_t.flat<T>();
 
-    Tensor all_nonneg_t;
-    OP_REQUIRES_OK(ctx,
-                   ctx->allocate_temp(DT_BOOL, TensorShape({}), &all_nonneg_t,
-                                      AllocatorAttributes()));
-    all_nonneg_t.scalar<bool>().device(ctx->eigen_cpu_device()) =
-        (arr >= 0).all();
-    OP_REQUIRES(ctx, all_nonneg_t.scalar<bool>()(),
-                errors::InvalidArgument("Input arr must be non-negative!"));
-
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        ctx->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64 num_threads = thread_pool->NumThreads() + 1;
-    Tensor partial_bins_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_temp(weights_t.dtype(),
-                                           TensorShape({num_threads, size}),
-                                           &partial_bins_t));
-    auto partial_bins = partial_bins_t.matrix<T>();
-    partial_bins.setZero();
-    thread_pool->ParallelForWithWorkerId(
-        arr.size(), 8 /* cost */,
-        [&](int64 start_ind, int64 limit_ind, int64 worker_id) {
-          for (int64 i = start_ind; i < limit_ind; i++) {
-            int32 value = arr(i);
-            if (value < size) {
-              if (has_weights) {
-                partial_bins(worker_id, value) += weights(i);
-              } else {
-                // Complex numbers don't support "++".
-                partial_bins(worker_id, value) += T(1);
-              }
-            }
-          }
-        });
+    OP_REQUIRES_OK(ctx, CheckNonNegative<Device>(ctx, arr));
+
     TensorShape output_shape({size});
     Tensor* output_t;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output_t));
-    // Sum the partial bins along the 0th axis.
-    Eigen::array<int, 1> reduce_dims({0});
-    output_t->flat<T>().device(ctx->eigen_cpu_device()) =
-        partial_bins.sum(reduce_dims);
+    typedef functor::BincountFunctor<Device, T, functor::GivenBins> Functor;
+    OP_REQUIRES_OK(ctx, Functor::Compute(ctx, functor::GivenBins{arr.data()},
+                                         arr.size(),
+                                         has_weights ? weights.data() : nullptr,
+                                         output_t->flat<T>()));
+  }
+};
+
+template <typename Device, typename T, typename Tout>
+class HistogramFixedWidthOp : public OpKernel {
+ public:
+  explicit HistogramFixedWidthOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& values_t = ctx->input(0);
+    const Tensor& value_range_t = ctx->input(1);
+    const Tensor& nbins_t = ctx->input(2);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(value_range_t.shape()) &&
+                    value_range_t.NumElements() == 2,
+                errors::InvalidArgument(
+                    "value_range should be a vector of 2 elements, got ",
+                    value_range_t.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(nbins_t.shape()),
+                errors::InvalidArgument("nbins should be a scalar, got ",
+                                        nbins_t.shape().DebugString()));
+    const int32 nbins = nbins_t.scalar<int32>()();
+    OP_REQUIRES(ctx, nbins > 0, errors::InvalidArgument(
+                                    "nbins should be positive, got ", nbins));
+    const auto value_range = value_range_t.vec<T>();
+    const double lower = static_cast<double>(value_range(0));
+    const double upper = static_cast<double>(value_range(1));
+    OP_REQUIRES(ctx, lower < upper,
+                errors::InvalidArgument(
+                    "value_range should satisfy value_range[0] < "
+                    "value_range[1], got ",
+                    lower, " and ", upper));
+
+    Tensor* output_t;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({nbins}), &output_t));
+    typedef functor::FixedWidthBins<T> BinFn;
+    typedef functor::BincountFunctor<Device, Tout, BinFn> Functor;
+    OP_REQUIRES_OK(
+        ctx, Functor::Compute(ctx,
+                              BinFn(values_t.flat<T>().data(), lower, upper,
+                                    nbins),
+                              values_t.NumElements(), nullptr,
+                              output_t->flat<Tout>()));
   }
 };
 
 #define REGISTER(TYPE)                                               \
   REGISTER_KERNEL_BUILDER(                                           \
       Name("Bincount").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"), \
-      BincountOp<TYPE>)
+      BincountOp<CPUDevice, TYPE>)
 
 TF_CALL_NUMBER_TYPES(REGISTER);
+#undef REGISTER
+
+#define REGISTER_HISTOGRAM(DEV, TYPE, OUT_TYPE)                 \
+  REGISTER_KERNEL_BUILDER(Name("HistogramFixedWidth")           \
+                              .Device(DEVICE_##DEV)             \
+                              .TypeConstraint<TYPE>("T")        \
+                              .TypeConstraint<OUT_TYPE>("dtype") \
+                              .HostMemory("value_range")        \
+                              .HostMemory("nbins"),             \
+                          HistogramFixedWidthOp<DEV##Device, TYPE, OUT_TYPE>)
+
+#define REGISTER_HISTOGRAMS(DEV, TYPE)    \
+  REGISTER_HISTOGRAM(DEV, TYPE, int32); \
+  REGISTER_HISTOGRAM(DEV, TYPE, int64)
+
+#define REGISTER_CPU_HISTOGRAMS(TYPE) REGISTER_HISTOGRAMS(CPU, TYPE)
+
+TF_CALL_int32(REGISTER_CPU_HISTOGRAMS);
+TF_CALL_int64(REGISTER_CPU_HISTOGRAMS);
+TF_CALL_float(REGISTER_CPU_HISTOGRAMS);
+TF_CALL_double(REGISTER_CPU_HISTOGRAMS);
+#undef REGISTER_CPU_HISTOGRAMS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define REGISTER_GPU(TYPE)                             \
+  REGISTER_KERNEL_BUILDER(Name("Bincount")             \
+                              .Device(DEVICE_GPU)      \
+                              .TypeConstraint<TYPE>("T") \
+                              .HostMemory("size"),     \
+                          BincountOp<GPUDevice, TYPE>)
+
+TF_CALL_int32(REGISTER_GPU);
+TF_CALL_int64(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
+#define REGISTER_GPU_HISTOGRAMS(TYPE) REGISTER_HISTOGRAMS(GPU, TYPE)
+
+TF_CALL_int32(REGISTER_GPU_HISTOGRAMS);
+TF_CALL_int64(REGISTER_GPU_HISTOGRAMS);
+TF_CALL_float(REGISTER_GPU_HISTOGRAMS);
+TF_CALL_double(REGISTER_GPU_HISTOGRAMS);
+#undef REGISTER_GPU_HISTOGRAMS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-// TODO(ringwalt): Add a GPU implementation. We probably want to take a
-// different approach, e.g. threads in a warp each taking a pass over the same
-// data, and each thread summing a single bin.
+#undef REGISTER_HISTOGRAMS
+#undef REGISTER_HISTOGRAM
 
 }  // end namespace tensorflow
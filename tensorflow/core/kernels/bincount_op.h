@@ -0,0 +1,87 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_BINCOUNT_OP_H_
+#define TENSORFLOW_KERNELS_BINCOUNT_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace functor {
+
+// Bin functions map an element index to its bin. Elements with a bin outside
+// [0, num_bins) are not counted.
+
+// The bin of each element is given, as for Bincount.
+struct GivenBins {
+  EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE int32 operator()(int64 i) const {
+    return bins[i];
+  }
+
+  const int32* bins;
+};
+
+// Fixed-width bins over [lower, upper), as for HistogramFixedWidth. Values
+// below the range, and NaNs, go to the first bin; values above it go to the
+// last bin.
+template <typename T>
+struct FixedWidthBins {
+  FixedWidthBins(const T* values, double lower, double upper, int32 num_bins)
+      : values(values),
+        lower(lower),
+        scale(num_bins / (upper - lower)),
+        num_bins(num_bins) {}
+
+  EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE int32 operator()(int64 i) const {
+    const double bin = (static_cast<double>(values[i]) - lower) * scale;
+    if (bin >= num_bins) return num_bins - 1;
+    return bin > 0 ? static_cast<int32>(bin) : 0;
+  }
+
+  const T* values;
+  double lower;
+  double scale;
+  int32 num_bins;
+};
+
+// Sets 'all_nonneg' to whether all of the bins in 'arr' are non-negative.
+template <typename Device>
+struct AllNonNegative {
+  void operator()(const Device& d, typename TTypes<int32>::ConstFlat arr,
+                  typename TTypes<bool>::Scalar all_nonneg);
+};
+
+// Functor for BincountOp and HistogramFixedWidthOp.
+// 'bin_fn': the bin of each of the 'num_elements' elements.
+// 'weights': the weight of each element, or nullptr to count each element as
+//   T(1).
+// 'output': the bins, overwritten with the counts or summed weights.
+template <typename Device, typename T, typename BinFn>
+struct BincountFunctor {
+  static Status Compute(OpKernelContext* ctx, const BinFn& bin_fn,
+                        int64 num_elements, const T* weights,
+                        typename TTypes<T>::Flat output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_BINCOUNT_OP_H_
@@ -0,0 +1,154 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/bincount_op.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// As GPU_1D_KERNEL_LOOP, for more than 2^31 elements.
+#define GPU_1D_KERNEL_LOOP_INT64(i, n)                                   \
+  for (int64 i = blockIdx.x * static_cast<int64>(blockDim.x) + threadIdx.x; \
+       i < (n); i += static_cast<int64>(blockDim.x) * gridDim.x)
+
+template <typename T>
+__device__ EIGEN_STRONG_INLINE void AddToBin(T* bin, T value) {
+  GpuAtomicAdd(bin, value);
+}
+
+// There is no atomicAdd for signed 64-bit integers, but two's complement
+// addition is the same as the unsigned one.
+template <>
+__device__ EIGEN_STRONG_INLINE void AddToBin(int64* bin, int64 value) {
+  GpuAtomicAdd(reinterpret_cast<uint64*>(bin), static_cast<uint64>(value));
+}
+
+// Each block counts its elements into a private copy of the bins in shared
+// memory, where the atomics of its threads are cheap and do not contend with
+// the other blocks, then adds the non-zero bins to the output.
+template <typename T, typename BinFn>
+__global__ void BincountSharedKernel(BinFn bin_fn, int64 num_elements,
+                                     const T* weights, int32 num_bins,
+                                     T* output) {
+  extern __shared__ __align__(sizeof(T)) unsigned char smem[];
+  T* bins = reinterpret_cast<T*>(smem);
+  for (int32 b = threadIdx.x; b < num_bins; b += blockDim.x) {
+    bins[b] = T(0);
+  }
+  __syncthreads();
+  GPU_1D_KERNEL_LOOP_INT64(i, num_elements) {
+    const int32 bin = bin_fn(i);
+    if (bin >= 0 && bin < num_bins) {
+      AddToBin(bins + bin, weights == nullptr ? T(1) : ldg(weights + i));
+    }
+  }
+  __syncthreads();
+  for (int32 b = threadIdx.x; b < num_bins; b += blockDim.x) {
+    if (bins[b] != T(0)) {
+      AddToBin(output + b, bins[b]);
+    }
+  }
+}
+
+// Used when the bins do not fit in shared memory.
+template <typename T, typename BinFn>
+__global__ void BincountGlobalKernel(BinFn bin_fn, int64 num_elements,
+                                     const T* weights, int32 num_bins,
+                                     T* output) {
+  GPU_1D_KERNEL_LOOP_INT64(i, num_elements) {
+    const int32 bin = bin_fn(i);
+    if (bin >= 0 && bin < num_bins) {
+      AddToBin(output + bin, weights == nullptr ? T(1) : ldg(weights + i));
+    }
+  }
+}
+
+#undef GPU_1D_KERNEL_LOOP_INT64
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename BinFn>
+struct BincountFunctor<GPUDevice, T, BinFn> {
+  static Status Compute(OpKernelContext* ctx, const BinFn& bin_fn,
+                        int64 num_elements, const T* weights,
+                        typename TTypes<T>::Flat output) {
+    const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+    const int32 num_bins = output.size();
+    if (num_bins == 0) {
+      return Status::OK();
+    }
+    d.memset(output.data(), 0, num_bins * sizeof(T));
+    if (num_elements == 0) {
+      return Status::OK();
+    }
+    // The kernels loop over the elements, so the launch size only needs to
+    // saturate the device.
+    GpuLaunchConfig config = GetGpuLaunchConfig(
+        static_cast<int>(std::min<int64>(num_elements, kint32max)), d);
+    const size_t shared_memory_size = num_bins * sizeof(T);
+    if (shared_memory_size <= d.sharedMemPerBlock()) {
+      GPU_LAUNCH_KERNEL((BincountSharedKernel<T, BinFn>),
+          dim3(config.block_count), dim3(config.thread_per_block),
+          shared_memory_size, d.stream(), bin_fn, num_elements, weights,
+          num_bins, output.data());
+    } else {
+      GPU_LAUNCH_KERNEL((BincountGlobalKernel<T, BinFn>),
+          dim3(config.block_count), dim3(config.thread_per_block), 0,
+          d.stream(), bin_fn, num_elements, weights, num_bins, output.data());
+    }
+    return Status::OK();
+  }
+};
+
+template <>
+void AllNonNegative<GPUDevice>::operator()(
+    const GPUDevice& d, typename TTypes<int32>::ConstFlat arr,
+    typename TTypes<bool>::Scalar all_nonneg) {
+  all_nonneg.device(d) = (arr >= 0).all();
+}
+
+template struct AllNonNegative<GPUDevice>;
+
+#define DEFINE_GPU_SPECS(T)                                             \
+  template struct BincountFunctor<GPUDevice, T, GivenBins>;             \
+  template struct BincountFunctor<GPUDevice, int32, FixedWidthBins<T>>; \
+  template struct BincountFunctor<GPUDevice, int64, FixedWidthBins<T>>
+
+TF_CALL_int32(DEFINE_GPU_SPECS);
+TF_CALL_int64(DEFINE_GPU_SPECS);
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,239 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/block_sparse_matmul_op.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// The rows of `a` are processed in tiles of this many rows, so that a tile of
+// `a` stays in cache while it is multiplied with all the blocks of a block
+// row.
+static constexpr int64 kBlockSparseRowTile = 64;
+
+template <typename T>
+struct BlockSparseMatMul<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d,
+                  typename TTypes<T>::ConstMatrix a,
+                  typename TTypes<T, 3>::ConstTensor b_values,
+                  typename TTypes<int32>::ConstVec b_col_indices,
+                  typename TTypes<int32>::ConstVec b_row_ptr,
+                  typename TTypes<T>::Matrix product) {
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        Matrix;
+    typedef Eigen::Map<const Matrix, Eigen::Unaligned, Eigen::OuterStride<>>
+        ConstStridedMap;
+    typedef Eigen::Map<Matrix, Eigen::Unaligned, Eigen::OuterStride<>>
+        StridedMap;
+    typedef Eigen::Map<const Matrix> ConstMap;
+
+    const int64 m = a.dimension(0);
+    const int64 k = a.dimension(1);
+    const int64 n = product.dimension(1);
+    const int64 block_rows = b_values.dimension(1);
+    const int64 block_cols = b_values.dimension(2);
+    const int64 block_size = block_rows * block_cols;
+    const int64 num_block_rows = b_row_ptr.size() - 1;
+    const int64 num_row_tiles =
+        (m + kBlockSparseRowTile - 1) / kBlockSparseRowTile;
+    if (m == 0 || n == 0) return;
+
+    // Each unit of work computes one tile of rows of one block column of the
+    // product, so units never write to the same output.
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 unit = begin; unit < end; ++unit) {
+        const int64 r = unit % num_block_rows;
+        const int64 row_begin = (unit / num_block_rows) * kBlockSparseRowTile;
+        const int64 rows = std::min(kBlockSparseRowTile, m - row_begin);
+        StridedMap out(product.data() + row_begin * n + r * block_rows, rows,
+                       block_rows, Eigen::OuterStride<>(n));
+        out.setZero();
+        for (int32 p = b_row_ptr(r); p < b_row_ptr(r + 1); ++p) {
+          ConstStridedMap a_block(
+              a.data() + row_begin * k + b_col_indices(p) * block_cols, rows,
+              block_cols, Eigen::OuterStride<>(k));
+          ConstMap b_block(b_values.data() + p * block_size, block_rows,
+                           block_cols);
+          out.noalias() += a_block * b_block.transpose();
+        }
+      }
+    };
+    const int64 num_blocks = b_values.dimension(0);
+    const int64 cost_per_unit =
+        2 * std::min(kBlockSparseRowTile, m) * block_size *
+        std::max<int64>(1, num_blocks / std::max<int64>(1, num_block_rows));
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_row_tiles * num_block_rows, cost_per_unit, work);
+  }
+};
+
+}  // namespace functor
+
+template <typename Device, typename T>
+class BlockSparseMatMulOp : public OpKernel {
+ public:
+  explicit BlockSparseMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b_values = context->input(1);
+    const Tensor& b_col_indices = context->input(2);
+    const Tensor& b_row_ptr = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a is not a matrix: ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(context, b_values.dims() == 3,
+                errors::InvalidArgument("b_values must be 3-dimensional: ",
+                                        b_values.shape().DebugString()));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVector(b_col_indices.shape()),
+        errors::InvalidArgument("b_col_indices is not a vector: ",
+                                b_col_indices.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(b_row_ptr.shape()) &&
+                    b_row_ptr.NumElements() >= 1,
+                errors::InvalidArgument(
+                    "b_row_ptr must be a non-empty vector: ",
+                    b_row_ptr.shape().DebugString()));
+    const int64 num_blocks = b_values.dim_size(0);
+    const int64 block_rows = b_values.dim_size(1);
+    const int64 block_cols = b_values.dim_size(2);
+    OP_REQUIRES(context, b_col_indices.NumElements() == num_blocks,
+                errors::InvalidArgument(
+                    "b_col_indices has ", b_col_indices.NumElements(),
+                    " elements, but b_values has ", num_blocks, " blocks"));
+    OP_REQUIRES(context, block_rows > 0 && block_cols > 0,
+                errors::InvalidArgument("Blocks must not be empty: ",
+                                        b_values.shape().DebugString()));
+    const int64 k = a.dim_size(1);
+    OP_REQUIRES(context, k % block_cols == 0,
+                errors::InvalidArgument(
+                    "The inner dimension of a (", k,
+                    ") must be a multiple of the block columns (", block_cols,
+                    ")"));
+    const int64 num_block_rows = b_row_ptr.NumElements() - 1;
+
+    // On the CPU the indices are checked before the product is computed.  On
+    // GPUs they are in device memory, and the kernel skips blocks with invalid
+    // indices instead.
+    if (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(context, ValidateIndices(b_col_indices, b_row_ptr,
+                                              num_blocks, k / block_cols));
+    }
+
+    Tensor* product = nullptr;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0, TensorShape({a.dim_size(0), num_block_rows * block_rows}),
+            &product));
+    if (product->NumElements() == 0) return;
+
+    functor::BlockSparseMatMul<Device, T>()(
+        context, context->eigen_device<Device>(), a.matrix<T>(),
+        b_values.tensor<T, 3>(), b_col_indices.vec<int32>(),
+        b_row_ptr.vec<int32>(), product->matrix<T>());
+  }
+
+ private:
+  static Status ValidateIndices(const Tensor& b_col_indices,
+                                const Tensor& b_row_ptr, int64 num_blocks,
+                                int64 num_block_cols) {
+    const auto col_indices = b_col_indices.vec<int32>();
+    const auto row_ptr = b_row_ptr.vec<int32>();
+    const int64 num_block_rows = row_ptr.size() - 1;
+    if (row_ptr(0) != 0 || row_ptr(num_block_rows) != num_blocks) {
+      return errors::InvalidArgument(
+          "b_row_ptr must start at 0 and end at the number of blocks (",
+          num_blocks, ")");
+    }
+    for (int64 r = 0; r < num_block_rows; ++r) {
+      if (row_ptr(r) > row_ptr(r + 1)) {
+        return errors::InvalidArgument("b_row_ptr must be non-decreasing");
+      }
+    }
+    for (int64 p = 0; p < num_blocks; ++p) {
+      if (!FastBoundsCheck(col_indices(p), num_block_cols)) {
+        return errors::InvalidArgument("b_col_indices[", p, "] = ",
+                                       col_indices(p), " is not in [0, ",
+                                       num_block_cols, ")");
+      }
+    }
+    return Status::OK();
+  }
+};
+
+#define REGISTER_CPU(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("BlockSparseMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      BlockSparseMatMulOp<CPUDevice, T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                     \
+  template <>                                                   \
+  void BlockSparseMatMul<GPUDevice, T>::operator()(             \
+      OpKernelContext* ctx, const GPUDevice& d,                 \
+      typename TTypes<T>::ConstMatrix a,                        \
+      typename TTypes<T, 3>::ConstTensor b_values,              \
+      typename TTypes<int32>::ConstVec b_col_indices,           \
+      typename TTypes<int32>::ConstVec b_row_ptr,               \
+      typename TTypes<T>::Matrix product);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("BlockSparseMatMul").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      BlockSparseMatMulOp<GPUDevice, T>);
+
+REGISTER_GPU(float);
+REGISTER_GPU(double);
+#undef REGISTER_GPU
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
+#define TENSORFLOW_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
+// Functor definition for BlockSparseMatMulOp, must be compilable by nvcc.
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace functor {
+
+// Computes product = a * transpose(b), where the [n, k] matrix b is stored in
+// block compressed sparse row (BSR) format with blocks of
+// block_rows x block_cols values: the blocks of block row r are
+// b_values[b_row_ptr[r]:b_row_ptr[r + 1]], and b_col_indices holds the block
+// column of each of them.
+template <typename Device, typename T>
+struct BlockSparseMatMul {
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  typename TTypes<T>::ConstMatrix a,
+                  typename TTypes<T, 3>::ConstTensor b_values,
+                  typename TTypes<int32>::ConstVec b_col_indices,
+                  typename TTypes<int32>::ConstVec b_row_ptr,
+                  typename TTypes<T>::Matrix product);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_BLOCK_SPARSE_MATMUL_OP_H_
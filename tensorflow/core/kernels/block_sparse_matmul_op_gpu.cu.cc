@@ -0,0 +1,111 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/block_sparse_matmul_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Each thread computes one element of the product.  Neighbouring threads of a
+// warp compute neighbouring columns of the same row, so their reads of `a`
+// hit the same addresses.  Blocks with an out of range column are skipped,
+// since the indices are not validated on the host for GPUs.
+template <typename T>
+__global__ void BlockSparseMatMulKernel(int nthreads, const T* a,
+                                        const T* b_values,
+                                        const int32* b_col_indices,
+                                        const int32* b_row_ptr, int k, int n,
+                                        int num_blocks, int block_rows,
+                                        int block_cols, T* product) {
+  const int num_block_cols = k / block_cols;
+  GPU_1D_KERNEL_LOOP(index, nthreads) {
+    const int row = index / n;
+    const int col = index % n;
+    const int block_row = col / block_rows;
+    const int row_in_block = col % block_rows;
+    const T* a_row = a + static_cast<int64>(row) * k;
+    int begin = ldg(b_row_ptr + block_row);
+    if (begin < 0) begin = 0;
+    int end = ldg(b_row_ptr + block_row + 1);
+    if (end > num_blocks) end = num_blocks;
+    T sum = T(0);
+    for (int p = begin; p < end; ++p) {
+      const int block_col = ldg(b_col_indices + p);
+      if (block_col < 0 || block_col >= num_block_cols) continue;
+      const T* a_block = a_row + block_col * block_cols;
+      const T* b_block =
+          b_values + (static_cast<int64>(p) * block_rows + row_in_block) *
+                         block_cols;
+      for (int j = 0; j < block_cols; ++j) {
+        sum += ldg(a_block + j) * ldg(b_block + j);
+      }
+    }
+    product[index] = sum;
+  }
+}
+
+template <typename T>
+void LaunchBlockSparseMatMul(const GPUDevice& d,
+                             typename TTypes<T>::ConstMatrix a,
+                             typename TTypes<T, 3>::ConstTensor b_values,
+                             typename TTypes<int32>::ConstVec b_col_indices,
+                             typename TTypes<int32>::ConstVec b_row_ptr,
+                             typename TTypes<T>::Matrix product) {
+  const int num_elements = product.size();
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_elements, d);
+  GPU_LAUNCH_KERNEL(BlockSparseMatMulKernel<T>, dim3(config.block_count),
+                    dim3(config.thread_per_block), 0, d.stream(),
+                    config.virtual_thread_count, a.data(), b_values.data(),
+                    b_col_indices.data(), b_row_ptr.data(),
+                    static_cast<int>(a.dimension(1)),
+                    static_cast<int>(product.dimension(1)),
+                    static_cast<int>(b_values.dimension(0)),
+                    static_cast<int>(b_values.dimension(1)),
+                    static_cast<int>(b_values.dimension(2)), product.data());
+}
+
+}  // namespace
+
+namespace functor {
+
+#define DEFINE_GPU_SPEC(T)                                                  \
+  template <>                                                               \
+  void BlockSparseMatMul<GPUDevice, T>::operator()(                         \
+      OpKernelContext* ctx, const GPUDevice& d,                             \
+      typename TTypes<T>::ConstMatrix a,                                    \
+      typename TTypes<T, 3>::ConstTensor b_values,                          \
+      typename TTypes<int32>::ConstVec b_col_indices,                       \
+      typename TTypes<int32>::ConstVec b_row_ptr,                           \
+      typename TTypes<T>::Matrix product) {                                 \
+    LaunchBlockSparseMatMul<T>(d, a, b_values, b_col_indices, b_row_ptr,    \
+                               product);                                    \
+  }
+
+DEFINE_GPU_SPEC(float);
+DEFINE_GPU_SPEC(double);
+#undef DEFINE_GPU_SPEC
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
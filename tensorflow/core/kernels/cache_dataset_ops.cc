@@ -110,8 +110,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             lockfile_created_(false),
             iteration_completed_(false) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsureLockFileExists());
         TF_RETURN_IF_ERROR(writer_.status());
@@ -211,8 +212,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             cur_index_(0),
             reader_(dataset->env_, dataset->filename_) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         *end_of_sequence = false;
         TF_RETURN_IF_ERROR(reader_.status());
@@ -301,8 +303,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             input_impl_(dataset->input_->MakeIterator()),
             cache_(new std::vector<std::vector<Tensor>>) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(
             input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
@@ -336,8 +339,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
         CHECK(cache);
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
           const std::vector<Tensor>& cache_tensors = (*cache_)[index_];
@@ -363,8 +367,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       explicit DuplicateWriterIterator(const MemoryDataset* dataset)
           : DatasetIterator<MemoryDataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         return errors::AlreadyExists(
             "There appears to be a concurrent caching iterator running.");
       }
@@ -381,6 +386,289 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
 REGISTER_KERNEL_BUILDER(Name("CacheDataset").Device(DEVICE_CPU),
                         CacheDatasetOp);
 
+// See documentation in ../ops/dataset_ops.cc for a high-level description of
+// the following op.
+
+class TieredCacheDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit TieredCacheDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    string filename;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<string>(ctx, "filename", &filename));
+    OP_REQUIRES(ctx, !filename.empty(),
+                errors::InvalidArgument(
+                    "A tiered cache requires a filename to spill to."));
+    int64 memory_budget_bytes;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "memory_budget_bytes",
+                                                   &memory_budget_bytes));
+    OP_REQUIRES(ctx, memory_budget_bytes >= 0,
+                errors::InvalidArgument(
+                    "memory_budget_bytes must be non-negative."));
+
+    *output =
+        new TieredDataset(input, filename, memory_budget_bytes, ctx->env());
+  }
+
+ private:
+  // A TieredDataset keeps the elements of its input in memory until they
+  // exceed `memory_budget_bytes`, and writes all later elements to a
+  // tensor bundle at `filename`. Once the first pass completes, iterators
+  // replay the in-memory prefix followed by the spilled suffix.
+  //
+  // Unlike CacheDatasetOp::FileDataset, the spilled elements are not a
+  // complete cache on their own, so the bundle is scratch space that is
+  // rewritten by each TieredDataset and deleted when it is destroyed.
+  class TieredDataset : public DatasetBase {
+   public:
+    TieredDataset(const DatasetBase* input, string filename,
+                  int64 memory_budget_bytes, Env* env)
+        : input_(input),
+          filename_(std::move(filename)),
+          memory_budget_bytes_(memory_budget_bytes),
+          env_(env),
+          num_tensors_(input->output_dtypes().size()),
+          tensor_format_string_(strings::Printf(
+              "%%%zuzu_%%%zuzu",
+              strings::Printf("%zu", kMaxItems - 1).size(),
+              strings::Printf("%zu", num_tensors_ - 1).size())) {
+      input_->Ref();
+    }
+
+    ~TieredDataset() override {
+      if (cache_ && cache_->num_spilled > 0) {
+        env_->DeleteFile(MetaFilename(filename_)).IgnoreError();
+        env_->DeleteFile(DataFilename(filename_, 0, 1)).IgnoreError();
+      }
+      input_->Unref();
+    }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      mutex_lock l(mu_);
+      if (cache_) {
+        return std::unique_ptr<IteratorBase>(
+            new TieredReaderIterator(this, cache_.get()));
+      }
+      if (!writer_iterator_created_) {
+        writer_iterator_created_ = true;
+        return std::unique_ptr<IteratorBase>(new TieredWriterIterator(this));
+      }
+      return std::unique_ptr<IteratorBase>(new DuplicateWriterIterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() override {
+      return strings::StrCat("TieredCacheDatasetOp(", memory_budget_bytes_,
+                             ")::TieredDataset");
+    }
+
+   private:
+    // The elements of the input, split between the two tiers.
+    struct TieredCache {
+      // The first elements of the input, that fit in the memory budget.
+      std::vector<std::vector<Tensor>> in_memory;
+      int64 memory_bytes = 0;
+      // The number of later elements, that were written to the bundle.
+      size_t num_spilled = 0;
+    };
+
+    string FormatName(size_t item_index, size_t tensor_index) const {
+      return strings::Printf(tensor_format_string_.c_str(), item_index,
+                             tensor_index);
+    }
+
+    // TieredWriterIterator passes through the elements of its input, and
+    // adds each of them to the memory tier while it fits in the budget, or
+    // to the bundle otherwise. Once an element has been spilled, all later
+    // elements are spilled too, which preserves their order on replay.
+    class TieredWriterIterator : public DatasetIterator<TieredDataset> {
+     public:
+      explicit TieredWriterIterator(const TieredDataset* dataset)
+          : DatasetIterator<TieredDataset>(dataset),
+            input_impl_(dataset->input_->MakeIterator()),
+            cache_(new TieredCache) {}
+
+      ~TieredWriterIterator() override {
+        mutex_lock l(mu_);
+        if (cache_) {
+          // The input was not exhausted, so let a later iterator retry.
+          mutex_lock l2(dataset()->mu_);
+          dataset()->writer_iterator_created_ = false;
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          // Guard on cache_ to not crash if GetNext is called a second time
+          // after *end_of_sequence == true
+          if (cache_) {
+            TF_RETURN_IF_ERROR(Finish());
+          }
+          return Status::OK();
+        }
+        if (!cache_) {
+          return errors::Internal(
+              "Upstream iterator produced an element after the end of its "
+              "sequence.");
+        }
+        if (out_tensors->size() != dataset()->num_tensors_) {
+          return errors::Internal(
+              "Upstream iterator returned invalid number of tensors. Expected ",
+              dataset()->num_tensors_, " got: ", out_tensors->size());
+        }
+
+        int64 element_bytes = 0;
+        for (const Tensor& t : *out_tensors) {
+          element_bytes += t.TotalBytes();
+        }
+        if (!writer_ && cache_->memory_bytes + element_bytes <=
+                            dataset()->memory_budget_bytes_) {
+          cache_->in_memory.emplace_back(*out_tensors);
+          cache_->memory_bytes += element_bytes;
+          return Status::OK();
+        }
+
+        if (!writer_) {
+          writer_.reset(new BundleWriter(dataset()->env_, dataset()->filename_));
+        }
+        TF_RETURN_IF_ERROR(writer_->status());
+        if (cache_->num_spilled >= kMaxItems) {
+          return errors::InvalidArgument(
+              "Upstream iterator is spilling more than ", kMaxItems,
+              " items, which is more than the cache limit.");
+        }
+        size_t tensor_index = 0;
+        for (const Tensor& t : *out_tensors) {
+          TF_RETURN_IF_ERROR(writer_->Add(
+              dataset()->FormatName(cache_->num_spilled, tensor_index++), t));
+        }
+        cache_->num_spilled++;
+        return Status::OK();
+      }
+
+     private:
+      Status Finish() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (writer_) {
+          TF_RETURN_IF_ERROR(writer_->Finish());
+          writer_.reset();
+        }
+        VLOG(1) << "Tiered cache holds " << cache_->in_memory.size()
+                << " elements (" << cache_->memory_bytes
+                << " bytes) in memory and " << cache_->num_spilled
+                << " elements in " << dataset()->filename_;
+        mutex_lock l(dataset()->mu_);
+        DCHECK(dataset()->writer_iterator_created_);
+        DCHECK(!dataset()->cache_);
+        cache_.swap(dataset()->cache_);
+        return Status::OK();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::unique_ptr<TieredCache> cache_ GUARDED_BY(mu_);
+      std::unique_ptr<BundleWriter> writer_ GUARDED_BY(mu_);
+    };  // TieredWriterIterator
+
+    class TieredReaderIterator : public DatasetIterator<TieredDataset> {
+     public:
+      explicit TieredReaderIterator(const TieredDataset* dataset,
+                                    const TieredCache* cache)
+          : DatasetIterator<TieredDataset>(dataset), cache_(cache), index_(0) {
+        CHECK(cache);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        *end_of_sequence = false;
+        if (index_ < cache_->in_memory.size()) {
+          const std::vector<Tensor>& cache_tensors =
+              cache_->in_memory[index_];
+          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                              cache_tensors.end());
+          index_++;
+          return Status::OK();
+        }
+
+        const size_t spilled_index = index_ - cache_->in_memory.size();
+        if (spilled_index >= cache_->num_spilled) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (!reader_) {
+          reader_.reset(
+              new BundleReader(dataset()->env_, dataset()->filename_));
+        }
+        TF_RETURN_IF_ERROR(reader_->status());
+        out_tensors->clear();
+        out_tensors->resize(dataset()->num_tensors_);
+        for (size_t i = 0; i < dataset()->num_tensors_; ++i) {
+          reader_->Next();  // The first entry in the table is a header entry.
+          if (!reader_->Valid()) {
+            out_tensors->clear();
+            return errors::DataLoss("The spilled cache file ",
+                                    dataset()->filename_, " is truncated.");
+          }
+          DCHECK_EQ(reader_->key(), dataset()->FormatName(spilled_index, i));
+          TF_RETURN_IF_ERROR(reader_->ReadCurrent(&(*out_tensors)[i]));
+          TF_RETURN_IF_ERROR(reader_->status());
+        }
+        index_++;
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      const TieredCache* const cache_;
+      size_t index_ GUARDED_BY(mu_);
+      std::unique_ptr<BundleReader> reader_ GUARDED_BY(mu_);
+    };  // TieredReaderIterator
+
+    class DuplicateWriterIterator : public DatasetIterator<TieredDataset> {
+     public:
+      explicit DuplicateWriterIterator(const TieredDataset* dataset)
+          : DatasetIterator<TieredDataset>(dataset) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        return errors::AlreadyExists(
+            "There appears to be a concurrent caching iterator running.");
+      }
+    };  // DuplicateWriterIterator
+
+    const DatasetBase* const input_;
+    const string filename_;
+    const int64 memory_budget_bytes_;
+    Env* const env_;
+    const size_t num_tensors_;
+    static const size_t kMaxItems = 10000000;  // 10 million
+    const string tensor_format_string_;
+    mutable mutex mu_;
+    mutable std::unique_ptr<TieredCache> cache_ GUARDED_BY(mu_);
+    mutable bool writer_iterator_created_ GUARDED_BY(mu_) = false;
+  };  // TieredDataset
+};    // TieredCacheDatasetOp
+
+REGISTER_KERNEL_BUILDER(Name("TieredCacheDataset").Device(DEVICE_CPU),
+                        TieredCacheDatasetOp);
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -70,6 +70,13 @@ struct CastFunctor<Eigen::SyclDevice, O, I> {
     };                                                                     \
   }
 
+// Conversion routines between an array of float and Eigen::half of
+// "size", rounding to nearest even like Eigen's scalar conversion.  They use
+// F16C instructions when the build enables them.  Implemented in
+// cast_op_impl_half.cc.
+void FloatToHalf(const float* src, Eigen::half* dst, int64 size);
+void HalfToFloat(const Eigen::half* src, float* dst, int64 size);
+
 // The functions below are implemented in the cast_op_impl_*.cc files.
 std::function<void(OpKernelContext*, const Tensor&, Tensor*)>
 GetCpuCastFromBool(DataType dst_dtype);
@@ -24,6 +24,17 @@ typedef Eigen::GpuDevice GPUDevice;
 
 std::function<void(OpKernelContext*, const Tensor&, Tensor*)>
 GetCpuCastFromFloat(DataType dst_dtype) {
+  if (dst_dtype == DT_HALF) {
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
+      int64 N = out->NumElements();
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      auto work = [&inp, &out](int64 start, int64 end) {
+        FloatToHalf(inp.flat<float>().data() + start,
+                    out->flat<Eigen::half>().data() + start, end - start);
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, N, 2, work);
+    };
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
   if (dst_dtype == DT_BFLOAT16) {
     return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
@@ -15,13 +15,55 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op_impl.h"
 
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#include "tensorflow/core/util/work_sharder.h"
+
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+void FloatToHalf(const float* src, Eigen::half* dst, int64 size) {
+#ifdef __F16C__
+  for (; size >= 8; src += 8, dst += 8, size -= 8) {
+    const __m128i h =
+        _mm256_cvtps_ph(_mm256_loadu_ps(src), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), h);
+  }
+#endif  // __F16C__
+  for (; size != 0; src++, dst++, size--) {
+    *dst = static_cast<Eigen::half>(*src);
+  }
+}
+
+void HalfToFloat(const Eigen::half* src, float* dst, int64 size) {
+#ifdef __F16C__
+  for (; size >= 8; src += 8, dst += 8, size -= 8) {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    _mm256_storeu_ps(dst, _mm256_cvtph_ps(h));
+  }
+#endif  // __F16C__
+  for (; size != 0; src++, dst++, size--) {
+    *dst = static_cast<float>(*src);
+  }
+}
+
 std::function<void(OpKernelContext*, const Tensor&, Tensor*)>
 GetCpuCastFromHalf(DataType dst_dtype) {
+  if (dst_dtype == DT_FLOAT) {
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out) {
+      int64 N = out->NumElements();
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      auto work = [&inp, &out](int64 start, int64 end) {
+        HalfToFloat(inp.flat<Eigen::half>().data() + start,
+                    out->flat<float>().data() + start, end - start);
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, N, 2, work);
+    };
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, Eigen::half);
   return nullptr;
 }
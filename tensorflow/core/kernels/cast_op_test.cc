@@ -91,6 +91,38 @@ TEST_ALL_CASTS_FROM(double)
 
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
+// Uses enough elements to go through the vectorized conversion loops as well
+// as their scalar tails.
+TEST_F(CastOpTest, TestCastFloatHalfVectorized) {
+  std::vector<float> values;
+  std::vector<half> halves;
+  for (int i = 0; i < 37; ++i) {
+    values.push_back(0.25f * i - 4.0f);
+    halves.push_back(half(0.25f * i - 4.0f));
+  }
+  MakeOp(DT_FLOAT, DT_HALF);
+  AddInputFromArray<float>(TensorShape({37}), values);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_HALF, TensorShape({37}));
+  test::FillValues<half>(&expected, halves);
+  test::ExpectTensorEqual<half>(expected, *GetOutput(0));
+}
+
+TEST_F(CastOpTest, TestCastHalfFloatVectorized) {
+  std::vector<float> values;
+  std::vector<half> halves;
+  for (int i = 0; i < 37; ++i) {
+    values.push_back(0.25f * i - 4.0f);
+    halves.push_back(half(0.25f * i - 4.0f));
+  }
+  MakeOp(DT_HALF, DT_FLOAT);
+  AddInputFromArray<half>(TensorShape({37}), halves);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({37}));
+  test::FillValues<float>(&expected, values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 static void BM_cpu_float_int64(int iters, int num) {
   testing::ItemsProcessed(static_cast<int64>(iters) * num);
   testing::BytesProcessed(static_cast<int64>(iters) * num *
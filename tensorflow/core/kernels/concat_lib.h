@@ -29,6 +29,18 @@ void ConcatCPU(DeviceBase* d,
                const std::vector<
                    std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>& inputs,
                typename TTypes<T, 2>::Matrix* output);
+
+// The inverse of ConcatCPU: copies consecutive column blocks of "input" into
+// "outputs", whose widths must sum to the width of "input".  Work is split
+// evenly by elements across threads regardless of the row structure, so a
+// few very wide rows parallelize as well as many narrow ones.
+// Assumes all outputs are nonempty.
+template <typename T>
+void SplitCPU(
+    DeviceBase* d, typename TTypes<T, 2>::ConstMatrix input,
+    const std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>>&
+        outputs);
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 template <typename T>
 void ConcatGPU(
@@ -16,27 +16,82 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/kernels/concat_lib_cpu.h"
+#include <string.h>
 #include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 
 namespace tensorflow {
 
 namespace {
+
+// Outputs at least this large are written with non-temporal stores.  Such
+// outputs do not fit in the last level cache on typical hosts anyway, so
+// streaming them out avoids evicting the inputs and the rest of the working
+// set.
+const int64 kStreamingCopyMinBytes = 16 << 20;
+
+// Like memcpy, but bypasses the cache for the bulk of the destination where
+// the target supports non-temporal stores.
+void StreamingMemcpy(void* dst, const void* src, size_t n) {
+#ifdef __SSE2__
+  char* d = static_cast<char*>(dst);
+  const char* s = static_cast<const char*>(src);
+  const size_t head = (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15;
+  if (n < head + 64) {
+    memcpy(d, s, n);
+    return;
+  }
+  memcpy(d, s, head);
+  d += head;
+  s += head;
+  n -= head;
+  for (; n >= 64; d += 64, s += 64, n -= 64) {
+    const __m128i* in = reinterpret_cast<const __m128i*>(s);
+    __m128i* out = reinterpret_cast<__m128i*>(d);
+    _mm_stream_si128(out, _mm_loadu_si128(in));
+    _mm_stream_si128(out + 1, _mm_loadu_si128(in + 1));
+    _mm_stream_si128(out + 2, _mm_loadu_si128(in + 2));
+    _mm_stream_si128(out + 3, _mm_loadu_si128(in + 3));
+  }
+  memcpy(d, s, n);
+  // Order the streaming stores before anything this thread does next.
+  _mm_sfence();
+#else
+  memcpy(dst, src, n);
+#endif  // __SSE2__
+}
+
 template <typename T>
 struct MemCpyCopier {
+  explicit MemCpyCopier(int64 total_elements)
+      : streaming_(total_elements * static_cast<int64>(sizeof(T)) >=
+                   kStreamingCopyMinBytes) {}
+
   inline void Copy(T* dst, const T* src, int input_index, size_t n) {
     if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
-      memcpy(dst, src, n * sizeof(T));
+      if (streaming_) {
+        StreamingMemcpy(dst, src, n * sizeof(T));
+      } else {
+        memcpy(dst, src, n * sizeof(T));
+      }
     } else {
       for (size_t k = 0; k < n; ++k) {
         *dst++ = *src++;
       }
     }
   }
+
+ private:
+  const bool streaming_;
 };
 template <>
 struct MemCpyCopier<ResourceHandle> {
+  explicit MemCpyCopier(int64 total_elements) {}
+
   inline void Copy(ResourceHandle* dst, const ResourceHandle* src,
                    int input_index, size_t n) {
     for (size_t k = 0; k < n; ++k) {
@@ -54,10 +109,25 @@ void ConcatCPU(DeviceBase* d,
                typename TTypes<T, 2>::Matrix* output) {
   if (std::is_same<T, string>::value) {
     // use a large cost here to force strings to be handled by separate threads
-    ConcatCPUImpl<T>(d, inputs, 100000, MemCpyCopier<T>(), output);
+    ConcatCPUImpl<T>(d, inputs, 100000, MemCpyCopier<T>(output->size()),
+                     output);
   } else {
     ConcatCPUImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */,
-                     MemCpyCopier<T>(), output);
+                     MemCpyCopier<T>(output->size()), output);
+  }
+}
+
+template <typename T>
+void SplitCPU(
+    DeviceBase* d, typename TTypes<T, 2>::ConstMatrix input,
+    const std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>>&
+        outputs) {
+  if (std::is_same<T, string>::value) {
+    // use a large cost here to force strings to be handled by separate threads
+    SplitCPUImpl<T>(d, input, 100000, MemCpyCopier<T>(input.size()), outputs);
+  } else {
+    SplitCPUImpl<T>(d, input, sizeof(T) /* cost_per_unit */,
+                    MemCpyCopier<T>(input.size()), outputs);
   }
 }
 
@@ -65,7 +135,10 @@ void ConcatCPU(DeviceBase* d,
   template void ConcatCPU<T>(                                                  \
       DeviceBase*,                                                             \
       const std::vector<std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>&, \
-      typename TTypes<T, 2>::Matrix* output);
+      typename TTypes<T, 2>::Matrix* output);                                  \
+  template void SplitCPU<T>(                                                   \
+      DeviceBase*, typename TTypes<T, 2>::ConstMatrix,                         \
+      const std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>>&);
 TF_CALL_ALL_TYPES(REGISTER)
 REGISTER(quint8)
 REGISTER(qint8)
@@ -86,8 +159,8 @@ void ConcatSYCL(const Eigen::SyclDevice& d,
                const std::vector<
                    std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>& inputs,
                typename TTypes<T, 2>::Matrix* output) {
-  ConcatSYCLImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */, MemCpyCopier<T>(),
-                   output);
+  ConcatSYCLImpl<T>(d, inputs, sizeof(T) /* cost_per_unit */,
+                    MemCpyCopier<T>(output->size()), output);
 }
 #define REGISTER_SYCL(T)                                                      \
  template void ConcatSYCL<T>(                                                 \
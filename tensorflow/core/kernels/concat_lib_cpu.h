@@ -16,6 +16,7 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/kernels/concat_lib.h"
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -126,6 +127,55 @@ void ConcatCPUImpl(
         cost_per_unit, work);
 }
 
+// ElementCopier is as for ConcatCPUImpl, except that it is passed the output
+// index rather than the input index.
+template <typename T, typename ElementCopier>
+void SplitCPUImpl(
+    DeviceBase* d, typename TTypes<T, 2>::ConstMatrix input,
+    int64 cost_per_unit, ElementCopier copier,
+    const std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>>&
+        outputs) {
+  const size_t num_outputs = outputs.size();
+
+  // offsets[j] is the column of input at which output j starts.
+  std::vector<int64> offsets;
+  offsets.reserve(num_outputs + 1);
+  offsets.push_back(0);
+  for (const auto& output : outputs) {
+    offsets.push_back(offsets.back() + output->dimension(1));
+  }
+  const int64 row_size = offsets.back();
+
+  // Copies the input elements [start, end), in row-major order, to wherever
+  // they belong in the outputs.
+  auto work = [&input, &outputs, &offsets, &copier, num_outputs, row_size](
+      int64 start, int64 end) {
+    if (start >= end) return;
+    int64 row = start / row_size;
+    int64 col = start % row_size;
+    size_t j = std::upper_bound(offsets.begin(), offsets.end(), col) -
+               offsets.begin() - 1;
+    const T* inp = input.data() + start;
+    for (int64 remaining = end - start; remaining > 0;) {
+      const int64 width = offsets[j + 1] - offsets[j];
+      const int64 size = std::min(offsets[j + 1] - col, remaining);
+      T* out = outputs[j]->data() + row * width + (col - offsets[j]);
+      copier.Copy(out, inp, j, size);
+      inp += size;
+      col += size;
+      remaining -= size;
+      if (col == offsets[j + 1] && ++j == num_outputs) {
+        j = 0;
+        col = 0;
+        ++row;
+      }
+    }
+  };
+  auto worker_threads = d->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+        cost_per_unit, work);
+}
+
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T, typename ElementCopier>
 void ConcatSYCLImpl(
@@ -81,8 +81,9 @@ class ConcatenateDatasetOp : public BinaryDatasetOpKernel {
             i_(0),
             input_impl_(dataset->input_->MakeIterator()) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         while (i_ < 2) {
           TF_RETURN_IF_ERROR(
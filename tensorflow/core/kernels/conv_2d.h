@@ -131,6 +131,36 @@ struct MatMulConvFunctor {
   }
 };
 
+// Adds "bias" to each channel of "output" and, if "relu" is set, applies a Relu
+// to the result. The output is updated in place, in a single pass.
+template <typename Device, typename T>
+struct BiasActivation {
+  void operator()(const Device& d, typename TTypes<T>::ConstVec bias,
+                  bool relu, TensorFormat data_format,
+                  typename TTypes<T, 4>::Tensor output) {
+    // View the output as [outer, channels, inner], so that the bias is
+    // broadcast on the outer and inner dimensions in both formats.
+    const Eigen::DenseIndex channels = bias.dimension(0);
+    Eigen::DenseIndex outer = output.size() / channels;
+    Eigen::DenseIndex inner = 1;
+    if (data_format == FORMAT_NCHW) {
+      outer = output.dimension(0);
+      inner = output.size() / (outer * channels);
+    }
+    Eigen::DSizes<Eigen::DenseIndex, 3> output_dims(outer, channels, inner);
+    Eigen::DSizes<Eigen::DenseIndex, 3> bias_dims(1, channels, 1);
+    Eigen::DSizes<Eigen::DenseIndex, 3> bcast(outer, 1, inner);
+    auto biased = output.reshape(output_dims) +
+                  bias.reshape(bias_dims).broadcast(bcast);
+    if (relu) {
+      output.reshape(output_dims).device(d) =
+          biased.cwiseMax(static_cast<T>(0));
+    } else {
+      output.reshape(output_dims).device(d) = biased;
+    }
+  }
+};
+
 // Shuffles a filter tensor from:
 //   [<spatial_dims>, in, out]
 // to:
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/conv_ops.h"
 #include <string.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -39,8 +40,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -137,11 +142,54 @@ class LaunchDeepConvOp {
                   int input_cols, int in_depth, int filter_rows,
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  const Eigen::PaddingType& padding, Tensor* output,
+                  TensorFormat data_format) {
     return false;
   }
 };
 
+// Remembers, for each convolution shape, whether DeepConv2D or the generic
+// CPU convolution was faster when both were timed on it.
+class CpuConvAutotuneMap {
+ public:
+  static CpuConvAutotuneMap* Global() {
+    static CpuConvAutotuneMap* map = new CpuConvAutotuneMap;
+    return map;
+  }
+
+  bool Find(const string& key, bool* use_deep_conv) {
+    mutex_lock l(mu_);
+    auto it = use_deep_conv_.find(key);
+    if (it == use_deep_conv_.end()) {
+      return false;
+    }
+    *use_deep_conv = it->second;
+    return true;
+  }
+
+  void Insert(const string& key, bool use_deep_conv) {
+    mutex_lock l(mu_);
+    use_deep_conv_[key] = use_deep_conv;
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<string, bool> use_deep_conv_ GUARDED_BY(mu_);
+};
+
+// Returns true if the choice between DeepConv2D and the generic CPU
+// convolution is made by timing both, instead of by the static cost model.
+// NOTE: IF this environment variable name changes, update conv_ops_test.py.
+static bool CpuConvUseAutotune() {
+  bool value;
+  Status status =
+      ReadBoolFromEnvVar("TF_CPU_CONV_USE_AUTOTUNE", false, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  return value;
+}
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -151,10 +199,17 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int input_cols, int in_depth, int filter_rows,
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
-    if (data_format != FORMAT_NHWC ||
-        !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
-                          in_depth, out_depth, out_rows, out_cols)) {
+                  const Eigen::PaddingType& padding, Tensor* output,
+                  TensorFormat data_format) {
+    if (data_format != FORMAT_NHWC) {
+      return false;
+    }
+    const bool autotune = CpuConvUseAutotune();
+    if (autotune ? !DeepConv2DSupportsShape(stride_rows, stride_cols,
+                                            filter_rows, filter_cols)
+                 : !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows,
+                                     filter_cols, in_depth, out_depth,
+                                     out_rows, out_cols)) {
       return false;
     }
 
@@ -175,8 +230,43 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
+    if (!autotune) {
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    const string key = strings::StrCat(
+        batch, ",", input_rows, ",", input_cols, ",", in_depth, ",",
+        filter_rows, ",", filter_cols, ",", out_depth, ",", pad_rows, ",",
+        pad_cols);
+    bool use_deep_conv;
+    if (CpuConvAutotuneMap::Global()->Find(key, &use_deep_conv)) {
+      if (!use_deep_conv) {
+        return false;
+      }
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    // First time this shape is seen: both implementations compute the full
+    // output, so time them in turn and keep the result of the second one.
+    Env* env = Env::Default();
+    const uint64 deep_start = env->NowMicros();
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
+    const uint64 generic_start = env->NowMicros();
+    LaunchGeneric<CPUDevice, float>::launch(ctx, input, filter, stride_rows,
+                                            stride_cols, padding, output,
+                                            data_format);
+    const uint64 generic_end = env->NowMicros();
+    use_deep_conv = generic_start - deep_start < generic_end - generic_start;
+    VLOG(1) << "Conv2D autotune " << key << ": deep_conv "
+            << generic_start - deep_start << "us, generic "
+            << generic_end - generic_start
+            << "us, use_deep_conv: " << use_deep_conv;
+    CpuConvAutotuneMap::Global()->Insert(key, use_deep_conv);
     return true;
   }
 };
@@ -251,9 +341,9 @@ class LaunchXsmmConvOp<CPUDevice, float> {
 #endif
 
 template <typename Device, typename T>
-class Conv2DOp : public BinaryOp<T> {
+class Conv2DOp : public OpKernel {
  public:
-  explicit Conv2DOp(OpKernelConstruction* context) : BinaryOp<T>(context) {
+  explicit Conv2DOp(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
     string data_format;
     OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
@@ -275,6 +365,13 @@ class Conv2DOp : public BinaryOp<T> {
   }
 
   void Compute(OpKernelContext* context) override {
+    Tensor* output = nullptr;
+    Convolve(context, &output);
+  }
+
+ protected:
+  // Allocates output 0 as "*output" and convolves inputs 0 and 1 into it.
+  void Convolve(OpKernelContext* context, Tensor** output) {
     // Input tensor is of the following dimensions:
     // [ batch, in_rows, in_cols, in_depth ]
 
@@ -354,8 +451,7 @@ class Conv2DOp : public BinaryOp<T> {
 
     // Output tensor is of the following dimensions:
     // [ in_batch, out_rows, out_cols, out_depth ]
-    Tensor* output = nullptr;
-    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, output));
 
     VLOG(2) << "Conv2D: in_depth = " << in_depth
             << ", input_cols = " << input_cols
@@ -375,7 +471,7 @@ class Conv2DOp : public BinaryOp<T> {
     if (LaunchXsmmConvOp<Device, T>::Run(
             context, input, filter, batch, input_rows, input_cols, in_depth,
             filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
-            out_depth, stride_rows, stride_cols, output, data_format_)) {
+            out_depth, stride_rows, stride_cols, *output, data_format_)) {
       return;
     }
 #endif
@@ -383,16 +479,17 @@ class Conv2DOp : public BinaryOp<T> {
     if (LaunchDeepConvOp<Device, T>::Run(
             context, input, filter, batch, input_rows, input_cols, in_depth,
             filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
-            out_depth, stride_rows, stride_cols, output, data_format_)) {
+            out_depth, stride_rows, stride_cols,
+            BrainPadding2EigenPadding(padding_), *output, data_format_)) {
       return;
     }
 
     launcher_.launch(context, use_cudnn_, cudnn_use_autotune_, input, filter,
                      stride_rows, stride_cols,
-                     BrainPadding2EigenPadding(padding_), output, data_format_);
+                     BrainPadding2EigenPadding(padding_), *output,
+                     data_format_);
   }
 
- private:
   std::vector<int32> strides_;
   bool use_cudnn_;
   Padding padding_;
@@ -403,6 +500,49 @@ class Conv2DOp : public BinaryOp<T> {
   TF_DISALLOW_COPY_AND_ASSIGN(Conv2DOp);
 };
 
+// Conv2D followed by BiasAdd and an optional Relu, created by the grappler
+// remapper. The bias and the activation are applied in place, in a single pass
+// over the output of the convolution.
+template <typename Device, typename T>
+class FusedConv2DOp : public Conv2DOp<Device, T> {
+ public:
+  explicit FusedConv2DOp(OpKernelConstruction* context)
+      : Conv2DOp<Device, T>(context) {
+    string activation;
+    OP_REQUIRES_OK(context, context->GetAttr("activation", &activation));
+    relu_ = activation == "Relu";
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& filter = context->input(1);
+    const Tensor& bias = context->input(2);
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    OP_REQUIRES(context,
+                bias.dims() == 1 && bias.dim_size(0) == filter.dim_size(3),
+                errors::InvalidArgument(
+                    "bias must be 1-dimensional with one element per output "
+                    "channel: ",
+                    bias.shape().DebugString(), " vs filter ",
+                    filter.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    this->Convolve(context, &output);
+    if (!context->status().ok() || output->NumElements() == 0) {
+      return;
+    }
+    functor::BiasActivation<Device, T>()(
+        context->eigen_device<Device>(), bias.vec<T>(), relu_,
+        this->data_format_, output->tensor<T, 4>());
+  }
+
+ private:
+  bool relu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DOp);
+};
+
 #define REGISTER_CPU(T)                                         \
   REGISTER_KERNEL_BUILDER(                                      \
       Name("Conv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
@@ -415,6 +555,15 @@ TF_CALL_half(REGISTER_CPU);
 TF_CALL_float(REGISTER_CPU);
 #endif  // USE_GEMM_FOR_CONV
 
+#define REGISTER_FUSED_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedConv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedConv2DOp<CPUDevice, T>);
+
+TF_CALL_half(REGISTER_FUSED_CPU);
+TF_CALL_float(REGISTER_FUSED_CPU);
+#undef REGISTER_FUSED_CPU
+
 // To be used inside depthwise_conv_op.cc.
 template class LaunchConv2DOp<CPUDevice, float>;
 
@@ -793,6 +942,17 @@ namespace functor {
       typename TTypes<T, 4, int>::Tensor out, TensorFormat data_format);     \
   extern template struct PadInput<GPUDevice, T, int, 4>
 
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(Eigen::half);
+#undef DECLARE_GPU_SPEC
+
+#define DECLARE_GPU_SPEC(T)                                              \
+  template <>                                                            \
+  void BiasActivation<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, typename TTypes<T>::ConstVec bias, bool relu,  \
+      TensorFormat data_format, typename TTypes<T, 4>::Tensor output);   \
+  extern template struct BiasActivation<GPUDevice, T>
+
 DECLARE_GPU_SPEC(float);
 DECLARE_GPU_SPEC(Eigen::half);
 #undef DECLARE_GPU_SPEC
@@ -805,6 +965,12 @@ REGISTER_KERNEL_BUILDER(
 REGISTER_KERNEL_BUILDER(
     Name("Conv2D").Device(DEVICE_GPU).TypeConstraint<float>("T"),
     Conv2DOp<GPUDevice, float>);
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedConv2D").Device(DEVICE_GPU).TypeConstraint<Eigen::half>("T"),
+    FusedConv2DOp<GPUDevice, Eigen::half>);
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedConv2D").Device(DEVICE_GPU).TypeConstraint<float>("T"),
+    FusedConv2DOp<GPUDevice, float>);
 
 // To be used inside depthwise_conv_op.cc.
 template class LaunchConv2DOp<GPUDevice, float>;
@@ -20,9 +20,11 @@ limitations under the License.
 
 #include <tuple>
 #include <unordered_map>
+#include "tensorflow/core/common_runtime/gpu/gpu_autotune_cache.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -68,6 +70,22 @@ class ConvParameters {
     return !(*this == other);
   }
   uint64 hash() const { return hash_code_; }
+  int device_id() const { return device_id_; }
+
+  // Like ToString(), but without the device id, which is not stable
+  // across processes. Used as the key in GpuAutotuneCache.
+  string ToCacheKey() const {
+    // clang-format off
+    return strings::StrCat(
+        batch_, ", ", in_depths_, ", ",
+        "(", str_util::Join(in_, ", "), "), ",
+        out_depths_, ", ",
+        "(", str_util::Join(filter_, ", "), "), ",
+        "(", str_util::Join(stride_, ", "), "), ",
+        "(", str_util::Join(padding_, ", "), "), ",
+        dtype_);
+    // clang-format on
+  }
 
   string ToString() const {
     // clang-format off
@@ -122,6 +140,31 @@ class ConvParameters {
 
 typedef Eigen::GpuDevice GPUDevice;
 
+// Conversions of autotuned algorithms to and from the strings stored in
+// GpuAutotuneCache. The scratch size is kept for MIOpen, which returns it
+// together with the algorithm it found.
+inline string AutoTuneConfigToString(
+    const perftools::gputools::dnn::AlgorithmConfig& config) {
+  return strings::StrCat(config.algorithm(), ",",
+                         config.algorithm_no_scratch(), ",",
+                         config.algorithm_scratch_size());
+}
+
+inline bool AutoTuneConfigFromString(
+    StringPiece str, perftools::gputools::dnn::AlgorithmConfig* config) {
+  std::vector<string> fields = str_util::Split(str, ',');
+  int64 algorithm, algorithm_no_scratch;
+  uint64 scratch_size;
+  if (fields.size() != 3 || !strings::safe_strto64(fields[0], &algorithm) ||
+      !strings::safe_strto64(fields[1], &algorithm_no_scratch) ||
+      !strings::safe_strtou64(fields[2], &scratch_size)) {
+    return false;
+  }
+  *config = perftools::gputools::dnn::AlgorithmConfig(
+      algorithm, algorithm_no_scratch, scratch_size);
+  return true;
+}
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -132,14 +175,29 @@ typedef Eigen::GpuDevice GPUDevice;
 // back and forth randomly, the expected number of experiments before autotune
 // settles is O(threshold ^ 2). So we recommend that number of warmup runs
 // for any benchmarks.
+//
+// Accepted configs are also stored in GpuAutotuneCache::Global(), and a
+// params not seen yet in this process is looked up there, so that configs
+// autotuned by an earlier process on the same kind of device are reused.
 template <typename Parameters, typename Config>
 class AutoTuneMap {
  public:
-  bool Find(const Parameters& params, Config* config) const {
+  bool Find(const Parameters& params, Config* config) {
     mutex_lock lock(mu_);
     auto iter = params_config_map_.find(params);
-    if (iter == params_config_map_.end() ||
-        iter->second.score < min_score_threshold_) {
+    if (iter == params_config_map_.end()) {
+      string cached;
+      if (GpuAutotuneCache::Global()->Lookup(
+              params.device_id(), name_, params.ToCacheKey(), &cached) &&
+          AutoTuneConfigFromString(cached, config)) {
+        VLOG(1) << GetActionSummary("loads", params, *config);
+        params_config_map_.insert(
+            std::make_pair(params, ValueType{*config, min_score_threshold_}));
+        return true;
+      }
+      return false;
+    }
+    if (iter->second.score < min_score_threshold_) {
       return false;
     }
     *config = iter->second.config;
@@ -172,6 +230,9 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      GpuAutotuneCache::Global()->Insert(params.device_id(), name_,
+                                         params.ToCacheKey(),
+                                         AutoTuneConfigToString(config));
     }
   }
 
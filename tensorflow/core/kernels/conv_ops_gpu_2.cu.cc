@@ -32,6 +32,8 @@ template struct functor::InflatePadAndShuffle<GPUDevice, float, 4,
 template struct functor::InflatePadAndShuffle<GPUDevice, Eigen::half, 4, int>;
 template struct functor::InflatePadAndShuffle<GPUDevice, Eigen::half, 4,
                                               Eigen::DenseIndex>;
+template struct functor::BiasActivation<GPUDevice, float>;
+template struct functor::BiasActivation<GPUDevice, Eigen::half>;
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
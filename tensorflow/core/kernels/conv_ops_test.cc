@@ -346,4 +346,54 @@ TEST_F(FusedResizePadConvOpTest, ResizeAndPadSymmetricComparativeLarge) {
                           "SYMMETRIC", 1, "SAME");
 }
 
+class FusedConv2DOpTest : public OpsTestBase {
+ protected:
+  void RunFusedConv(const string& activation,
+                    const std::vector<float>& expected_values) {
+    TF_EXPECT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", "SAME")
+                     .Attr("activation", activation)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+    // A 1x1 filter with two output channels, negating the second one.
+    AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, -2, 3, -4});
+    AddInputFromArray<float>(TensorShape({1, 1, 1, 2}), {1, -1});
+    AddInputFromArray<float>(TensorShape({2}), {0.5, -1});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({1, 2, 2, 2}));
+    test::FillValues<float>(&expected, expected_values);
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedConv2DOpTest, BiasAdd) {
+  RunFusedConv("Identity", {1.5, -2, -1.5, 1, 3.5, -4, -3.5, 3});
+}
+
+TEST_F(FusedConv2DOpTest, BiasAddRelu) {
+  RunFusedConv("Relu", {1.5, 0, 0, 1, 3.5, 0, 0, 3});
+}
+
+TEST_F(FusedConv2DOpTest, InvalidBias) {
+  TF_EXPECT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "SAME")
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 2}), {1, -1});
+  AddInputFromArray<float>(TensorShape({3}), {0.5, -1, 2});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
 }  // namespace tensorflow
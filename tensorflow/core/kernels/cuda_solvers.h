@@ -156,6 +156,18 @@ class CudaSolver {
                       const Scalar* host_a_inverse_dev_ptrs[], int ldainv,
                       DeviceLapackInfo* dev_lapack_info, int batch_size) const;
 
+  // Solves A * X = B (or op(A) * X = B, as given by trans) for a batch of
+  // matrices, using the LU factorizations from GetrfBatched. B is overwritten
+  // with X. host_lapack_info only reports invalid arguments, and is set before
+  // the call returns. Returns Status::OK() if the kernel was launched
+  // successfully. See:
+  // http://docs.nvidia.com/cuda/cublas/index.html#cublas-lt-t-gt-getrsbatched
+  template <typename Scalar>
+  Status GetrsBatched(cublasOperation_t trans, int n, int nrhs,
+                      const Scalar* host_a_dev_ptrs[], int lda,
+                      const int* dev_pivots, Scalar* host_b_dev_ptrs[],
+                      int ldb, int* host_lapack_info, int batch_size) const;
+
   /*
   TODO(rmlarsen, volunteers): Implement the kernels below.
   // Uses Cholesky factorization to solve A * X = B.
@@ -209,15 +221,6 @@ class CudaSolver {
   Status Gesvd(signed char jobu, signed char jobvt, int m, int n, Scalar* dev_A,
              int lda, Scalar* dev_S, Scalar* dev_U, int ldu, Scalar* dev_VT,
              int ldvt, int* dev_lapack_info);
-
-  // Batched linear solver using LU factorization from getrfBatched.
-  // See:
-  http://docs.nvidia.com/cuda/cublas/index.html#cublas-lt-t-gt-getrsbatched
-  template <typename Scalar>
-  Status GetrsBatched(cublasOperation_t trans, int n, int nrhs,
-                    const Scalar* dev_Aarray[], int lda, const int* devIpiv,
-                    Scalar* dev_Barray[], int ldb, int* info, int batch_size)
-  const;
   */
 
  private:
@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/cwise_op_fused_unary.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+Status FusedUnaryOpFromName(const string& name, functor::FusedUnaryOp* op) {
+  static const auto* ops =
+      new std::unordered_map<string, functor::FusedUnaryOp>({
+          {"Abs", functor::FusedUnaryOp::kAbs},
+          {"Exp", functor::FusedUnaryOp::kExp},
+          {"Log", functor::FusedUnaryOp::kLog},
+          {"Neg", functor::FusedUnaryOp::kNeg},
+          {"Reciprocal", functor::FusedUnaryOp::kReciprocal},
+          {"Relu", functor::FusedUnaryOp::kRelu},
+          {"Rsqrt", functor::FusedUnaryOp::kRsqrt},
+          {"Sigmoid", functor::FusedUnaryOp::kSigmoid},
+          {"Sqrt", functor::FusedUnaryOp::kSqrt},
+          {"Square", functor::FusedUnaryOp::kSquare},
+          {"Tanh", functor::FusedUnaryOp::kTanh},
+      });
+  auto it = ops->find(name);
+  if (it == ops->end()) {
+    return errors::InvalidArgument("Unsupported fused unary op: ", name);
+  }
+  *op = it->second;
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedUnaryCwiseOp : public OpKernel {
+ public:
+  explicit FusedUnaryCwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> names;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &names));
+    OP_REQUIRES(context,
+                !names.empty() && names.size() <= functor::kMaxFusedUnaryOps,
+                errors::InvalidArgument("Between 1 and ",
+                                        functor::kMaxFusedUnaryOps,
+                                        " ops can be fused, got ",
+                                        names.size()));
+    for (const string& name : names) {
+      OP_REQUIRES_OK(context,
+                     FusedUnaryOpFromName(name, &ops_.ops[ops_.size++]));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    if (input.NumElements() == 0) {
+      return;
+    }
+    functor::FusedUnaryCwise<Device, T>()(context->eigen_device<Device>(),
+                                          ops_, input.flat<T>(),
+                                          output->flat<T>());
+  }
+
+ private:
+  functor::FusedUnaryOps ops_;
+};
+
+#define REGISTER_CPU_KERNELS(type)                                          \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedUnaryCwise").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      FusedUnaryCwiseOp<CPUDevice, type>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                          \
+  template <>                                                        \
+  void FusedUnaryCwise<GPUDevice, T>::operator()(                    \
+      const GPUDevice& d, const FusedUnaryOps& ops,                  \
+      typename TTypes<T>::ConstFlat input,                           \
+      typename TTypes<T>::Flat output);                              \
+  extern template struct FusedUnaryCwise<GPUDevice, T>;
+
+TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU_KERNELS(type)                                          \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedUnaryCwise").Device(DEVICE_GPU).TypeConstraint<type>("T"), \
+      FusedUnaryCwiseOp<GPUDevice, type>);
+
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_CWISE_OP_FUSED_UNARY_H_
+#define TENSORFLOW_KERNELS_CWISE_OP_FUSED_UNARY_H_
+// Functor definition for FusedUnaryCwiseOp, must be compilable by nvcc.
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The ops that a _FusedUnaryCwise node can chain.
+enum class FusedUnaryOp {
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+// The longest chain of ops a single _FusedUnaryCwise node applies.
+constexpr int kMaxFusedUnaryOps = 8;
+
+// The chain of ops applied by a _FusedUnaryCwise node, first to last. It is
+// small and trivially copyable, so that it can be passed to device code.
+struct FusedUnaryOps {
+  int size = 0;
+  FusedUnaryOp ops[kMaxFusedUnaryOps];
+};
+
+// Applies the chain "ops" to a single element.
+template <typename T>
+struct fused_unary_op {
+  explicit fused_unary_op(const FusedUnaryOps& ops) : ops(ops) {}
+
+  EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE T operator()(const T& x) const {
+    T y = x;
+    for (int i = 0; i < ops.size; ++i) {
+      switch (ops.ops[i]) {
+        case FusedUnaryOp::kAbs:
+          y = Eigen::internal::scalar_abs_op<T>()(y);
+          break;
+        case FusedUnaryOp::kExp:
+          y = Eigen::internal::scalar_exp_op<T>()(y);
+          break;
+        case FusedUnaryOp::kLog:
+          y = Eigen::internal::scalar_log_op<T>()(y);
+          break;
+        case FusedUnaryOp::kNeg:
+          y = Eigen::internal::scalar_opposite_op<T>()(y);
+          break;
+        case FusedUnaryOp::kReciprocal:
+          y = Eigen::internal::scalar_inverse_op<T>()(y);
+          break;
+        case FusedUnaryOp::kRelu:
+          y = y > T(0) ? y : T(0);
+          break;
+        case FusedUnaryOp::kRsqrt:
+          y = Eigen::internal::scalar_rsqrt_op<T>()(y);
+          break;
+        case FusedUnaryOp::kSigmoid:
+          y = Eigen::internal::scalar_sigmoid_op<T>()(y);
+          break;
+        case FusedUnaryOp::kSqrt:
+          y = Eigen::internal::scalar_sqrt_op<T>()(y);
+          break;
+        case FusedUnaryOp::kSquare:
+          y = Eigen::internal::scalar_square_op<T>()(y);
+          break;
+        case FusedUnaryOp::kTanh:
+          y = Eigen::internal::scalar_tanh_op<T>()(y);
+          break;
+      }
+    }
+    return y;
+  }
+
+  const FusedUnaryOps ops;
+};
+
+// Functor used by FusedUnaryCwiseOp to do the computations. The whole chain
+// is a single Eigen expression, i.e. one pass over memory and, on GPU, one
+// kernel launch.
+template <typename Device, typename T>
+struct FusedUnaryCwise {
+  void operator()(const Device& d, const FusedUnaryOps& ops,
+                  typename TTypes<T>::ConstFlat input,
+                  typename TTypes<T>::Flat output) {
+    output.device(d) = input.unaryExpr(fused_unary_op<T>(ops));
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_CWISE_OP_FUSED_UNARY_H_
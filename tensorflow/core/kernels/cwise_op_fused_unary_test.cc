@@ -0,0 +1,71 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedUnaryCwiseOpTest : public OpsTestBase {
+ protected:
+  Status Init(const std::vector<string>& ops) {
+    TF_CHECK_OK(NodeDefBuilder("fused_unary_op", "_FusedUnaryCwise")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("ops", ops)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedUnaryCwiseOpTest, AppliesOpsInOrder) {
+  TF_ASSERT_OK(Init({"Neg", "Relu", "Square"}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 4, 0, 16});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedUnaryCwiseOpTest, MatchesUnfusedOps) {
+  TF_ASSERT_OK(Init({"Abs", "Sqrt", "Exp", "Log", "Tanh", "Sigmoid"}));
+  AddInputFromArray<float>(TensorShape({3}), {0.25, -1, 4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3}));
+  std::vector<float> values;
+  for (float x : {0.25f, -1.0f, 4.0f}) {
+    values.push_back(1 / (1 + std::exp(-std::tanh(std::sqrt(std::abs(x))))));
+  }
+  test::FillValues<float>(&expected, values);
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedUnaryCwiseOpTest, UnsupportedOp) {
+  EXPECT_FALSE(Init({"Neg", "Floor"}).ok());
+}
+
+TEST_F(FusedUnaryCwiseOpTest, TooManyOps) {
+  EXPECT_FALSE(Init(std::vector<string>(9, "Neg")).ok());
+}
+
+}  // namespace tensorflow
@@ -15,8 +15,101 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/dataset.h"
 
+#include "tensorflow/core/platform/cpu_info.h"
+
 namespace tensorflow {
 
+namespace {
+
+// Buckets of [1, 2, 4, ..., 2^30].
+std::vector<double> PowersOfTwoBuckets() {
+  std::vector<double> buckets;
+  for (double limit = 1; limit <= (int64{1} << 30); limit *= 2) {
+    buckets.push_back(limit);
+  }
+  return buckets;
+}
+
+auto* getnext_latency_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/data/getnext_latency_usecs",
+     "The latency of the GetNext() calls of the iterators of a dataset "
+     "stage, including the time spent in its input stages.",
+     "stage"},
+    PowersOfTwoBuckets());
+
+auto* elements_produced = monitoring::Counter<1>::New(
+    "/tensorflow/data/elements_produced",
+    "The number of elements produced by the iterators of a dataset stage.",
+    "stage");
+
+auto* bytes_produced = monitoring::Counter<1>::New(
+    "/tensorflow/data/bytes_produced",
+    "The total size of the tensors produced by the iterators of a dataset "
+    "stage.",
+    "stage");
+
+auto* buffer_occupancy = monitoring::Sampler<1>::New(
+    {"/tensorflow/data/buffer_occupancy",
+     "The number of elements buffered by an iterator of a dataset stage, "
+     "sampled on each GetNext() call.",
+     "stage"},
+    PowersOfTwoBuckets());
+
+auto* wait_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/data/wait_usecs",
+    "The time that the consumers of a dataset stage spent waiting for "
+    "elements to be produced by its background threads.",
+    "stage");
+
+string StageName(const string& dataset_debug_string) {
+  const size_t end = dataset_debug_string.find_first_of("(:");
+  return dataset_debug_string.substr(0, end);
+}
+
+}  // namespace
+
+DatasetStageStats::DatasetStageStats(const string& dataset_debug_string)
+    : name_(StageName(dataset_debug_string)),
+      latency_cell_(getnext_latency_usecs->GetCell(name_)),
+      elements_cell_(elements_produced->GetCell(name_)),
+      bytes_cell_(bytes_produced->GetCell(name_)),
+      buffer_occupancy_cell_(buffer_occupancy->GetCell(name_)),
+      wait_usecs_cell_(wait_usecs->GetCell(name_)) {}
+
+void DatasetStageStats::RecordGetNext(uint64 start_micros,
+                                      const std::vector<Tensor>& out_tensors,
+                                      bool end_of_sequence) {
+  latency_cell_->Add(Env::Default()->NowMicros() - start_micros);
+  if (!end_of_sequence) {
+    elements_cell_->IncrementBy(1);
+    int64 num_bytes = 0;
+    for (const Tensor& t : out_tensors) {
+      num_bytes += t.TotalBytes();
+    }
+    bytes_cell_->IncrementBy(num_bytes);
+  }
+}
+
+AutotuneBudget* AutotuneBudget::Global() {
+  static AutotuneBudget* budget =
+      new AutotuneBudget(port::NumSchedulableCPUs());
+  return budget;
+}
+
+bool AutotuneBudget::TryAcquire() {
+  mutex_lock l(mu_);
+  if (available_ == 0) {
+    return false;
+  }
+  --available_;
+  return true;
+}
+
+void AutotuneBudget::Release(int64 num_threads) {
+  mutex_lock l(mu_);
+  available_ += num_threads;
+}
+
 void DatasetOpKernel::Compute(OpKernelContext* ctx) {
   DatasetBase* dataset = nullptr;
   MakeDataset(ctx, &dataset);
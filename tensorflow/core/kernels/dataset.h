@@ -18,6 +18,11 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/tracing.h"
 
 namespace tensorflow {
 
@@ -136,11 +141,80 @@ class DatasetBase : public ResourceBase {
   virtual const std::vector<PartialTensorShape>& output_shapes() const = 0;
 };
 
+// Records the cost of one stage of an input pipeline, i.e. of the
+// iterators of one kind of dataset, in the "/tensorflow/data/..." metrics.
+// The stage name is the op name prefix of the dataset's `DebugString()`,
+// e.g. "ShuffleDatasetOp".
+class DatasetStageStats {
+ public:
+  explicit DatasetStageStats(const string& dataset_debug_string);
+
+  // The name of the stage, which labels its metrics and trace events.
+  const string& name() const { return name_; }
+
+  // Records one call to `GetNext()` that started at `start_micros` and
+  // produced `out_tensors` (unless `end_of_sequence` is true). The
+  // latency includes the time spent in the upstream stages.
+  void RecordGetNext(uint64 start_micros,
+                     const std::vector<Tensor>& out_tensors,
+                     bool end_of_sequence);
+
+  // Records the number of elements buffered by the stage.
+  void RecordBufferOccupancy(int64 num_elements) {
+    buffer_occupancy_cell_->Add(num_elements);
+  }
+
+  // Records time that a consumer of the stage spent blocked waiting for
+  // an element to be produced.
+  void RecordWaitTime(int64 wait_usecs) {
+    wait_usecs_cell_->IncrementBy(wait_usecs);
+  }
+
+ private:
+  const string name_;
+  monitoring::SamplerCell* const latency_cell_;
+  monitoring::CounterCell* const elements_cell_;
+  monitoring::CounterCell* const bytes_cell_;
+  monitoring::SamplerCell* const buffer_occupancy_cell_;
+  monitoring::CounterCell* const wait_usecs_cell_;
+};
+
+// The value of a parallelism or buffer size argument that requests
+// autotuning.
+constexpr int kAutoTune = -1;
+
+// The process-wide budget of threads that autotuned iterators may add to
+// their stages, which allows at most one additional thread per schedulable
+// CPU across all input pipelines. Every autotuned iterator keeps one thread
+// outside of the budget, so that it can always make progress.
+class AutotuneBudget {
+ public:
+  static AutotuneBudget* Global();
+
+  // Takes one thread from the budget. Returns false if the budget is
+  // exhausted.
+  bool TryAcquire();
+
+  // Returns `num_threads` threads to the budget.
+  void Release(int64 num_threads);
+
+ private:
+  explicit AutotuneBudget(int64 num_threads) : available_(num_threads) {}
+
+  mutex mu_;
+  int64 available_ GUARDED_BY(mu_);
+};
+
 // Represents an iterator that is associated with a particular parent dataset.
+//
+// Subclasses implement `GetNextInternal()`, and `GetNext()` records the
+// per-stage statistics for each call.
 template <class DatasetType>
 class DatasetIterator : public IteratorBase {
  public:
-  explicit DatasetIterator(const DatasetType* dataset) : dataset_(dataset) {
+  explicit DatasetIterator(const DatasetType* dataset)
+      : dataset_(dataset),
+        stats_(const_cast<DatasetType*>(dataset)->DebugString()) {
     dataset_->Ref();
   }
 
@@ -157,9 +231,37 @@ class DatasetIterator : public IteratorBase {
     return dataset_->output_shapes();
   }
 
+  Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                 bool* end_of_sequence) final {
+    port::Tracing::TraceMe activity(stats_.name());
+    const uint64 start_micros = Env::Default()->NowMicros();
+    Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    if (s.ok()) {
+      stats_.RecordGetNext(start_micros, *out_tensors, *end_of_sequence);
+    }
+    return s;
+  }
+
+ protected:
+  // Implements `GetNext()`, with the same contract.
+  virtual Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) = 0;
+
+  // Records the number of elements buffered by this iterator, for
+  // iterators that buffer their input.
+  void RecordBufferOccupancy(int64 num_elements) {
+    stats_.RecordBufferOccupancy(num_elements);
+  }
+
+  // Records time that this iterator spent blocked waiting for elements
+  // produced by its background threads.
+  void RecordWaitTime(int64 wait_usecs) { stats_.RecordWaitTime(wait_usecs); }
+
  private:
   const DatasetType* const dataset_;  // Owns one reference on the
                                       // shared dataset resource.
+  DatasetStageStats stats_;
 };
 
 // Encapsulates the work required to plug a DatasetBase into the core TensorFlow
@@ -22,6 +22,8 @@ limitations under the License.
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
 #endif // TENSORFLOW_USE_SYCL
+#include <atomic>
+
 #include "tensorflow/core/debug/debug_io_utils.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -128,6 +130,10 @@ class BaseDebugOp : public OpKernel {
       : OpKernel(context), debug_op_name_(debug_op_name) {
     OP_REQUIRES_OK(context, context->GetAttr("debug_urls", &debug_urls_));
     OP_REQUIRES_OK(context, context->GetAttr("gated_grpc", &gated_grpc_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("sampling_interval", &sampling_interval_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("async_publish", &async_publish_));
 
     string device_name;
     string tensor_name;
@@ -157,23 +163,28 @@ class BaseDebugOp : public OpKernel {
   bool IsExpensive() override { return false; }
 
  protected:
-  // Apply gRPC gating (if gated_grpc_ attribute is true).
+  // Apply sampling (if the sampling_interval_ attribute is greater than 1) and
+  // gRPC gating (if gated_grpc_ attribute is true).
   //
-  // Returns false if and only if all grpc:// debug URLs of the debug op are
-  // disabled currently (i.e., gated off), in which case the debug op will emit
-  // an empty (size {0}) tensor of undefined data type.
+  // Returns false if and only if this execution is skipped by the sampling or
+  // all grpc:// debug URLs of the debug op are disabled currently (i.e., gated
+  // off), in which case the debug op will emit an empty (size {0}) tensor of
+  // undefined data type.
   bool ApplyGrpcGating(OpKernelContext* context) {
+    if (sampling_interval_ > 1 &&
+        execution_count_.fetch_add(1, std::memory_order_relaxed) %
+                sampling_interval_ !=
+            0) {
+      // Not sampled in this execution: Output an empty tensor and avoid
+      // expensive computation.
+      EmitEmptyTensor(context, "skipped by sampling");
+      return false;
+    }
     if (gated_grpc_ && !DebugIO::IsDebugNodeGateOpen(
                            debug_watch_key_->debug_node_name, debug_urls_)) {
       // The entire node is gated off: Output an empty tensor and avoid
       // expensive computation.
-      Tensor* output_tensor;
-      TensorShape shape({0});
-      if (!context->allocate_output(0, shape, &output_tensor).ok()) {
-        LOG(ERROR) << "Debug node of watch key "
-                   << debug_watch_key_->debug_node_name
-                   << " failed to allocate empty tensor under gated-off state.";
-      }
+      EmitEmptyTensor(context, "under gated-off state");
       return false;
     } else {
       return true;
@@ -183,7 +194,11 @@ class BaseDebugOp : public OpKernel {
   // Publish a tensor to all debug URLs of the debug op.
   // Log an error if the publishing failed.
   void PublishTensor(const Tensor& tensor) {
-    if (!debug_urls_.empty()) {
+    if (!debug_urls_.empty() && async_publish_) {
+      DebugIO::PublishDebugTensorAsync(*debug_watch_key_, tensor,
+                                       Env::Default()->NowMicros(),
+                                       debug_urls_, gated_grpc_);
+    } else if (!debug_urls_.empty()) {
       Status status = DebugIO::PublishDebugTensor(*debug_watch_key_, tensor,
                                                   Env::Default()->NowMicros(),
                                                   debug_urls_, gated_grpc_);
@@ -198,10 +213,23 @@ class BaseDebugOp : public OpKernel {
   }
 
  private:
+  void EmitEmptyTensor(OpKernelContext* context, const char* reason) {
+    Tensor* output_tensor;
+    TensorShape shape({0});
+    if (!context->allocate_output(0, shape, &output_tensor).ok()) {
+      LOG(ERROR) << "Debug node of watch key "
+                 << debug_watch_key_->debug_node_name
+                 << " failed to allocate empty tensor " << reason << ".";
+    }
+  }
+
   const string debug_op_name_;
   std::unique_ptr<DebugNodeKey> debug_watch_key_;
   std::vector<string> debug_urls_;
   bool gated_grpc_;
+  int64 sampling_interval_;
+  bool async_publish_;
+  std::atomic<int64> execution_count_{0};
 };
 
 // Identity op for debugging.
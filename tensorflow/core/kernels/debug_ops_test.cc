@@ -38,13 +38,16 @@ namespace tensorflow {
 
 class DebugIdentityOpTest : public OpsTestBase {
  protected:
-  Status Init(DataType input_type, const std::vector<string>& debug_urls) {
+  Status Init(DataType input_type, const std::vector<string>& debug_urls,
+              int64 sampling_interval = 1, bool async_publish = false) {
     env_ = Env::Default();
 
     TF_CHECK_OK(NodeDefBuilder("op", "DebugIdentity")
                     .Input(FakeInput(input_type))
                     .Attr("tensor_name", "FakeTensor:0")
                     .Attr("debug_urls", debug_urls)
+                    .Attr("sampling_interval", sampling_interval)
+                    .Attr("async_publish", async_publish)
                     .Finalize(node_def()));
     return InitOp();
   }
@@ -155,6 +158,60 @@ TEST_F(DebugIdentityOpTest, Int32Success_6_FileURLs) {
   }
 }
 
+TEST_F(DebugIdentityOpTest, SamplingSkipsExecutions) {
+  TF_ASSERT_OK(Init(DT_INT32, {}, 3));
+  AddInputFromArray<int32>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  Tensor expected(allocator(), DT_INT32, TensorShape({6}));
+  test::FillValues<int32>(&expected, {1, 2, 3, 4, 5, 6});
+  for (int i = 0; i < 7; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+    if (i % 3 == 0) {
+      test::ExpectTensorEqual<int32>(expected, *GetOutput(0));
+    } else {
+      // Skipped executions output an empty tensor.
+      ASSERT_EQ(TensorShape({0}), GetOutput(0)->shape());
+    }
+  }
+}
+
+TEST_F(DebugIdentityOpTest, AsyncPublishToFileURL) {
+  const string dump_root = io::JoinPath(testing::TmpDir(), "async_publish");
+  TF_ASSERT_OK(Init(DT_INT32, {strings::StrCat("file://", dump_root)}, 1,
+                    true /* async_publish */));
+  AddInputFromArray<int32>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  const int kNumRuns = 3;
+  for (int i = 0; i < kNumRuns; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+  }
+  DebugIO::FlushAsyncPublishing();
+
+  std::vector<string> device_roots;
+  TF_ASSERT_OK(env_->GetMatchingPaths(
+      io::JoinPath(dump_root, strings::StrCat(DebugIO::kMetadataFilePrefix,
+                                              DebugIO::kDeviceTag, "*")),
+      &device_roots));
+  ASSERT_EQ(1, device_roots.size());
+  std::vector<string> dump_files;
+  TF_ASSERT_OK(env_->GetChildren(device_roots[0], &dump_files));
+  ASSERT_EQ(kNumRuns, dump_files.size());
+  for (const string& dump_file : dump_files) {
+    Event event;
+    TF_ASSERT_OK(ReadBinaryProto(
+        env_, io::JoinPath(device_roots[0], dump_file), &event));
+    ASSERT_EQ(1, event.summary().value().size());
+    Tensor tensor_prime(DT_INT32);
+    ASSERT_TRUE(tensor_prime.FromProto(event.summary().value(0).tensor()));
+    test::ExpectTensorEqual<int32>(*GetOutput(0), tensor_prime);
+  }
+
+  int64 undeleted_files = 0;
+  int64 undeleted_dirs = 0;
+  TF_ASSERT_OK(
+      env_->DeleteRecursively(dump_root, &undeleted_files, &undeleted_dirs));
+  ASSERT_EQ(0, undeleted_files);
+  ASSERT_EQ(0, undeleted_dirs);
+}
+
 TEST_F(DebugIdentityOpTest, Int32Success_2_3) {
   TF_ASSERT_OK(Init(DT_INT32));
   AddInputFromArray<int32>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
@@ -0,0 +1,258 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Source coordinates and weight for one output row or column.
+struct Interpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+// Fills interpolation[i] for the output coordinates 0 <= i < out_size.  The
+// sample positions are those ResizeBilinear uses on the full resolution crop,
+// i.e. crop_start + i * scale, mapped into the decoded window, which starts at
+// window_start and is window_size pixels long in the image downscaled by
+// ratio.
+void ComputeInterpolation(int64 out_size, int64 crop_start, float scale,
+                          int ratio, int64 window_start, int64 window_size,
+                          Interpolation* interpolation) {
+  for (int64 i = 0; i < out_size; ++i) {
+    const float full = crop_start + i * scale;
+    const float in = std::max(0.0f, full / ratio - window_start);
+    const int64 lower = std::min(static_cast<int64>(in), window_size - 1);
+    interpolation[i].lower = lower;
+    interpolation[i].upper = std::min(lower + 1, window_size - 1);
+    interpolation[i].lerp = std::min(in - lower, 1.0f);
+  }
+}
+
+// Decodes only the requested window of a JPEG image, downscaling it in the
+// DCT domain when the window is large compared to the requested size, and
+// resizes the decoded window to the requested size with bilinear
+// interpolation.  This avoids materializing the full size decoded image that
+// a DecodeJpeg + crop + ResizeBilinear pipeline needs.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &flags_.components));
+    OP_REQUIRES(context, flags_.components == 0 || flags_.components == 1 ||
+                             flags_.components == 3,
+                errors::InvalidArgument(
+                    "channels must be 0, 1, or 3 for JPEG, got ",
+                    flags_.components));
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(context, context->GetAttr("dct_downscale", &dct_downscale_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<string>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context, crop_window.shape() == TensorShape({4}),
+                errors::InvalidArgument(
+                    "crop_window must be a vector of 4 elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.shape() == TensorShape({2}),
+                errors::InvalidArgument(
+                    "size must be a vector of 2 elements, got shape ",
+                    size.shape().DebugString()));
+    const auto crop_vec = crop_window.vec<int32>();
+    const int64 crop_y = crop_vec(0);
+    const int64 crop_x = crop_vec(1);
+    const int64 crop_height = crop_vec(2);
+    const int64 crop_width = crop_vec(3);
+    const auto size_vec = size.vec<int32>();
+    const int64 out_height = size_vec(0);
+    const int64 out_width = size_vec(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("output dimensions must be positive"));
+
+    int width, height, components;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   &components),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(context,
+                crop_x >= 0 && crop_y >= 0 && crop_width > 0 &&
+                    crop_height > 0 && crop_x + crop_width <= width &&
+                    crop_y + crop_height <= height,
+                errors::InvalidArgument(
+                    "crop_window [", crop_y, ", ", crop_x, ", ", crop_height,
+                    ", ", crop_width, "] is not inside the image of size ",
+                    height, " x ", width));
+
+    // Decode at the smallest size that does not make the resize an upsample.
+    jpeg::UncompressFlags flags = flags_;
+    if (dct_downscale_) {
+      for (int ratio = 8; ratio > 1; ratio /= 2) {
+        if (crop_width / ratio >= out_width &&
+            crop_height / ratio >= out_height) {
+          flags.ratio = ratio;
+          break;
+        }
+      }
+    }
+    const int ratio = flags.ratio;
+
+    // The window of the downscaled image covering the crop.  libjpeg rounds
+    // the downscaled image size up.
+    const int64 scaled_width = (width + ratio - 1) / ratio;
+    const int64 scaled_height = (height + ratio - 1) / ratio;
+    const int64 window_x = crop_x / ratio;
+    const int64 window_y = crop_y / ratio;
+    const int64 window_width =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width) -
+        window_x;
+    const int64 window_height =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height) -
+        window_y;
+    flags.crop = true;
+    flags.crop_x = window_x;
+    flags.crop_y = window_y;
+    flags.crop_width = window_width;
+    flags.crop_height = window_height;
+
+    Tensor window;
+    Tensor* output = nullptr;
+    int channels = 0;
+    OP_REQUIRES(
+        context,
+        jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [=, &window, &output, &channels](int w, int h, int c) -> uint8* {
+              Status status = context->allocate_temp(
+                  DT_UINT8, TensorShape({h, w, c}), &window);
+              if (status.ok()) {
+                status = context->allocate_output(
+                    0, TensorShape({out_height, out_width, c}), &output);
+              }
+              if (!status.ok()) {
+                VLOG(1) << status;
+                context->SetStatus(status);
+                return nullptr;
+              }
+              channels = c;
+              return window.flat<uint8>().data();
+            }),
+        errors::InvalidArgument("Invalid JPEG data or crop window, data size ",
+                                input.size()));
+    OP_REQUIRES(context, window.dim_size(0) == window_height &&
+                             window.dim_size(1) == window_width,
+                errors::Internal("Decoded window has shape ",
+                                 window.shape().DebugString(), ", expected ",
+                                 window_height, " x ", window_width));
+
+    std::vector<Interpolation> ys(out_height);
+    std::vector<Interpolation> xs(out_width);
+    ComputeInterpolation(
+        out_height, crop_y,
+        CalculateResizeScale(crop_height, out_height, align_corners_), ratio,
+        window_y, window_height, ys.data());
+    ComputeInterpolation(
+        out_width, crop_x,
+        CalculateResizeScale(crop_width, out_width, align_corners_), ratio,
+        window_x, window_width, xs.data());
+    // Scale x interpolation weights to avoid a multiplication during iteration.
+    for (Interpolation& x : xs) {
+      x.lower *= channels;
+      x.upper *= channels;
+    }
+
+    const uint8* in = window.flat<uint8>().data();
+    float* out = output->flat<float>().data();
+    const int64 in_row_size = window_width * channels;
+    const int64 out_row_size = out_width * channels;
+    auto resize_rows = [&](int64 start, int64 limit) {
+      for (int64 y = start; y < limit; ++y) {
+        const uint8* top = in + ys[y].lower * in_row_size;
+        const uint8* bottom = in + ys[y].upper * in_row_size;
+        const float y_lerp = ys[y].lerp;
+        float* out_row = out + y * out_row_size;
+        for (int64 x = 0; x < out_width; ++x) {
+          const int64 xl = xs[x].lower;
+          const int64 xu = xs[x].upper;
+          const float x_lerp = xs[x].lerp;
+          for (int c = 0; c < channels; ++c) {
+            const float t = top[xl + c] + (top[xu + c] - top[xl + c]) * x_lerp;
+            const float b =
+                bottom[xl + c] + (bottom[xu + c] - bottom[xl + c]) * x_lerp;
+            out_row[x * channels + c] = t + (b - t) * y_lerp;
+          }
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, out_height,
+          out_row_size * 10 /* cost_per_unit */, resize_rows);
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+  bool align_corners_;
+  bool dct_downscale_;
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace tensorflow
@@ -14,16 +14,66 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <string.h>
+#include <algorithm>
+#include <deque>
 #include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+namespace {
+
+// The approximate cost of decoding one byte of a record, used to shard the
+// records across the intra-op thread pool.
+const int64 kDecodeCSVCostPerByte = 10;
+
+// safe_strtof needs a NUL-terminated string, so float fields are copied to
+// a buffer on the stack first.  Longer fields fall back to a string.
+const size_t kMaxStackFloatLength = 64;
+
+bool ParseFloat(StringPiece field, float* value) {
+  if (field.size() < kMaxStackFloatLength) {
+    char buffer[kMaxStackFloatLength];
+    memcpy(buffer, field.data(), field.size());
+    buffer[field.size()] = '\0';
+    return strings::safe_strtof(buffer, value);
+  }
+  return strings::safe_strtof(field.ToString().c_str(), value);
+}
+
+// The fields of the record being decoded by one thread.  Most fields point
+// into the record itself.  Quoted fields with escaped quotes are unescaped
+// into `unescaped`, a deque so that existing fields stay valid as it grows.
+// Both are reused from one record to the next.
+struct DecodeCSVFields {
+  std::vector<StringPiece> fields;
+  std::deque<string> unescaped;
+  size_t num_unescaped = 0;
+
+  string* NextUnescaped() {
+    if (num_unescaped == unescaped.size()) {
+      unescaped.emplace_back();
+    }
+    return &unescaped[num_unescaped++];
+  }
+};
+
+}  // namespace
+
+// The records are decoded in parallel.  The fields of a record are found
+// without copying them, and numbers are converted straight from the record.
 class DecodeCSVOp : public OpKernel {
  public:
   explicit DecodeCSVOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -65,176 +115,235 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    int64 total_bytes = 0;
     for (int64 i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
-
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32 value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
+      total_bytes += records_t(i).size();
+    }
+    const int64 cost_per_unit =
+        kDecodeCSVCostPerByte *
+        (1 + total_bytes / std::max<int64>(1, records_size));
+
+    // If several records are invalid, the error of the first one is
+    // reported, so that it does not depend on how the records were sharded.
+    mutex mu;
+    int64 first_error = records_size;
+    Status status;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_unit, [&](int64 begin, int64 end) {
+            DecodeCSVFields fields;
+            for (int64 i = begin; i < end; ++i) {
+              Status s = DecodeRecord(records_t(i), i, record_defaults,
+                                      &fields, &output);
+              if (!s.ok()) {
+                mutex_lock l(mu);
+                if (i < first_error) {
+                  first_error = i;
+                  status = s;
+                }
+                return;
+              }
             }
-            break;
-          }
-          case DT_INT64: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int64>()(i) = record_defaults[f].flat<int64>()(0);
-            } else {
-              int64 value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64>()(i) = value;
+          });
+    OP_REQUIRES_OK(ctx, status);
+  }
+
+ private:
+  std::vector<DataType> out_type_;
+  char delim_;
+  bool use_quote_delim_;
+
+  Status DecodeRecord(StringPiece record, int64 i,
+                      const OpInputList& record_defaults,
+                      DecodeCSVFields* record_fields,
+                      OpOutputList* output) const {
+    TF_RETURN_IF_ERROR(ExtractFields(record, record_fields));
+    const std::vector<StringPiece>& fields = record_fields->fields;
+    if (fields.size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields.size(),
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const DataType& dtype = out_type_[f];
+      // If this field is empty, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      if (fields[f].empty() && record_defaults[f].NumElements() != 1) {
+        return errors::InvalidArgument(
+            "Field ", f, " is required but missing in record ", i, "!");
+      }
+      switch (dtype) {
+        case DT_INT32: {
+          if (fields[f].empty()) {
+            (*output)[f]->flat<int32>()(i) =
+                record_defaults[f].flat<int32>()(0);
+          } else {
+            int32 value;
+            if (!strings::safe_strto32(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ",
+                                             fields[f]);
             }
-            break;
+            (*output)[f]->flat<int32>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f].c_str(), &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (fields[f].empty()) {
+            (*output)[f]->flat<int64>()(i) =
+                record_defaults[f].flat<int64>()(0);
+          } else {
+            int64 value;
+            if (!strings::safe_strto64(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ",
+                                             fields[f]);
             }
-            break;
+            (*output)[f]->flat<int64>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty()) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<string>()(i) =
-                  record_defaults[f].flat<string>()(0);
-            } else {
-              output[f]->flat<string>()(i) = fields[f];
+          break;
+        }
+        case DT_FLOAT: {
+          if (fields[f].empty()) {
+            (*output)[f]->flat<float>()(i) =
+                record_defaults[f].flat<float>()(0);
+          } else {
+            float value;
+            if (!ParseFloat(fields[f], &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ",
+                                             fields[f]);
             }
-            break;
+            (*output)[f]->flat<float>()(i) = value;
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        case DT_STRING: {
+          if (fields[f].empty()) {
+            (*output)[f]->flat<string>()(i) =
+                record_defaults[f].flat<string>()(0);
+          } else {
+            (*output)[f]->flat<string>()(i).assign(fields[f].data(),
+                                                   fields[f].size());
+          }
+          break;
+        }
+        default:
+          return errors::InvalidArgument("csv: data type ", dtype,
+                                         " not supported in field ", f);
       }
     }
+    return Status::OK();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  char delim_;
-  bool use_quote_delim_;
+  // Returns the position of the first character at or after `begin` that
+  // ends an unquoted field or is not allowed in one: the delimiter, CR, LF
+  // and, if use_quote_delim is set, the quote.  Returns `end` if there is
+  // none.  With SSE2, 16 characters are checked at a time.
+  size_t FindUnquotedFieldEnd(const char* data, size_t begin,
+                              size_t end) const {
+    const char quote = use_quote_delim_ ? '"' : delim_;
+#ifdef __SSE2__
+    const __m128i delim_v = _mm_set1_epi8(delim_);
+    const __m128i quote_v = _mm_set1_epi8(quote);
+    const __m128i cr_v = _mm_set1_epi8('\r');
+    const __m128i lf_v = _mm_set1_epi8('\n');
+    for (; begin + 16 <= end; begin += 16) {
+      const __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + begin));
+      const __m128i special =
+          _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, delim_v),
+                                    _mm_cmpeq_epi8(chunk, quote_v)),
+                       _mm_or_si128(_mm_cmpeq_epi8(chunk, cr_v),
+                                    _mm_cmpeq_epi8(chunk, lf_v)));
+      const int mask = _mm_movemask_epi8(special);
+      if (mask != 0) {
+        return begin + __builtin_ctz(mask);
+      }
+    }
+#endif  // __SSE2__
+    for (; begin < end; ++begin) {
+      const char c = data[begin];
+      if (c == delim_ || c == quote || c == '\n' || c == '\r') {
+        return begin;
+      }
+    }
+    return end;
+  }
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64 current_idx = 0;
-    if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
-        if (input[current_idx] == '\n' || input[current_idx] == '\r') {
-          current_idx++;
-          continue;
-        }
+  Status ExtractFields(StringPiece input, DecodeCSVFields* result) const {
+    result->fields.clear();
+    result->num_unescaped = 0;
+    if (input.empty()) {
+      return Status::OK();
+    }
+    const char* const data = input.data();
+    const size_t size = input.size();
+    size_t current_idx = 0;
+    while (current_idx < size) {
+      if (data[current_idx] == '\n' || data[current_idx] == '\r') {
+        current_idx++;
+        continue;
+      }
 
-        bool quoted = false;
-        if (use_quote_delim_ && input[current_idx] == '"') {
-          quoted = true;
-          current_idx++;
+      if (!use_quote_delim_ || data[current_idx] != '"') {
+        const size_t field_end =
+            FindUnquotedFieldEnd(data, current_idx, size);
+        if (field_end < size && data[field_end] != delim_) {
+          return errors::InvalidArgument(
+              "Unquoted fields cannot have quotes/CRLFs inside");
         }
+        result->fields.emplace_back(data + current_idx,
+                                    field_end - current_idx);
+        // Go to next field or the end
+        current_idx = field_end + 1;
+        continue;
+      }
 
-        // This is the body of the field;
-        string field;
-        if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            field += input[current_idx];
-            current_idx++;
-          }
-
-          // Go to next field or the end
-          current_idx++;
-        } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              field += '"';
-              current_idx += 2;
-            }
+      // Quoted field needs to be ended with '"' and delim or end.  Runs of
+      // characters between quotes are found with memchr.
+      current_idx++;
+      const size_t field_begin = current_idx;
+      string* unescaped = nullptr;
+      while (true) {
+        const void* found =
+            memchr(data + current_idx, '"', size - current_idx);
+        if (found == nullptr) {
+          return errors::InvalidArgument(
+              "Quoted field has to end with quote followed by delim or end");
+        }
+        const size_t quote_idx = static_cast<const char*>(found) - data;
+        if (quote_idx == size - 1 || data[quote_idx + 1] == delim_) {
+          if (unescaped == nullptr) {
+            result->fields.emplace_back(data + field_begin,
+                                        quote_idx - field_begin);
+          } else {
+            unescaped->append(data + current_idx, quote_idx - current_idx);
+            result->fields.emplace_back(*unescaped);
           }
-
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
-
-          current_idx += 2;
+          current_idx = quote_idx + 2;
+          break;
         }
-
-        result->push_back(field);
+        if (data[quote_idx + 1] != '"') {
+          return errors::InvalidArgument(
+              "Quote inside a string has to be escaped by another quote");
+        }
+        if (unescaped == nullptr) {
+          unescaped = result->NextUnescaped();
+          unescaped->assign(data + field_begin, quote_idx - field_begin);
+        } else {
+          unescaped->append(data + current_idx, quote_idx - current_idx);
+        }
+        unescaped->push_back('"');
+        current_idx = quote_idx + 2;
       }
-
-      // Check if the last field is missing
-      if (input[input.size() - 1] == delim_) result->push_back(string());
     }
+
+    // Check if the last field is missing
+    if (data[size - 1] == delim_) result->fields.emplace_back();
+    return Status::OK();
   }
 };
 
@@ -130,8 +130,9 @@ class DenseToSparseBatchDatasetOp : public UnaryDatasetOpKernel {
           : DatasetIterator<Dataset<T>>(dataset),
             input_impl_(dataset->input_->MakeIterator()) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         // Each row of the output SparseTensor is an individual tensor
         // from the input iterator.
         std::vector<Tensor> batch_elements;
@@ -335,13 +335,67 @@ class SingleSequenceExampleParserOp : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->output_list("feature_list_dense_values",
                                          &feature_list_dense_values));
 
+    const string& name = (has_debug_name) ? debug_name_t() : "<unknown>";
+
+    // Parse straight into the outputs first.  It is strict about the
+    // encoding and its errors are terse, so if it fails the example is
+    // parsed again below into a SequenceExample message.
+    example::FastParseSingleSequenceExampleConfig config;
+    for (int d = 0; d < attrs_.num_context_dense; ++d) {
+      config.context_dense.push_back(
+          {context_dense_keys_t[d], attrs_.context_dense_types[d],
+           attrs_.context_dense_shapes[d], context_dense_defaults[d]});
+    }
+    for (int d = 0; d < attrs_.num_context_sparse; ++d) {
+      config.context_sparse.push_back(
+          {context_sparse_keys_t[d], attrs_.context_sparse_types[d]});
+    }
+    for (int d = 0; d < attrs_.num_feature_list_dense; ++d) {
+      const string& key = feature_list_dense_keys_t[d];
+      config.feature_list_dense.push_back(
+          {key, attrs_.feature_list_dense_types[d],
+           attrs_.feature_list_dense_shapes[d],
+           feature_list_dense_missing_assumed_empty_set.count(key) > 0});
+    }
+    for (int d = 0; d < attrs_.num_feature_list_sparse; ++d) {
+      config.feature_list_sparse.push_back(
+          {feature_list_sparse_keys_t[d], attrs_.feature_list_sparse_types[d]});
+    }
+    example::Result context_result;
+    example::Result feature_list_result;
+    if (example::FastParseSingleSequenceExample(
+            config, serialized_t(), name,
+            ctx->device()->tensorflow_cpu_worker_threads()->workers,
+            &context_result, &feature_list_result)
+            .ok()) {
+      for (int d = 0; d < attrs_.num_context_dense; ++d) {
+        context_dense_values.set(d, context_result.dense_values[d]);
+      }
+      for (int d = 0; d < attrs_.num_context_sparse; ++d) {
+        context_sparse_indices.set(d, context_result.sparse_indices[d]);
+        context_sparse_values.set(d, context_result.sparse_values[d]);
+        context_sparse_shapes.set(d, context_result.sparse_shapes[d]);
+      }
+      for (int d = 0; d < attrs_.num_feature_list_dense; ++d) {
+        feature_list_dense_values.set(d, feature_list_result.dense_values[d]);
+      }
+      for (int d = 0; d < attrs_.num_feature_list_sparse; ++d) {
+        feature_list_sparse_indices.set(d,
+                                        feature_list_result.sparse_indices[d]);
+        feature_list_sparse_values.set(d,
+                                       feature_list_result.sparse_values[d]);
+        feature_list_sparse_shapes.set(d,
+                                       feature_list_result.sparse_shapes[d]);
+      }
+      return;
+    }
+
     SequenceExample ex;
     OP_REQUIRES(
         ctx, ParseProtoUnlimited(&ex, serialized_t()),
         errors::InvalidArgument("Could not parse example input, value: '",
                                 serialized_t(), "'"));
 
-    const string& name = (has_debug_name) ? debug_name_t() : "<unknown>";
     const Features& context = ex.context();
     const auto& context_dict = context.feature();
 
@@ -29,6 +29,11 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/kernels/fft_plan_cache.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #endif
 
@@ -338,6 +343,62 @@ class CufftScratchAllocator : public gpu::ScratchAllocator {
   std::vector<Tensor> allocated_tensors_;
 };
 
+// Allocates the scratch space of a cached plan directly from the device
+// allocator, so that it lives as long as the plan rather than the step.
+class PersistentCufftScratchAllocator : public gpu::ScratchAllocator {
+ public:
+  PersistentCufftScratchAllocator(int64 memory_limit, Allocator* allocator)
+      : memory_limit_(memory_limit), allocator_(allocator) {}
+  int64 GetMemoryLimitInBytes(gpu::Stream* stream) override {
+    return memory_limit_;
+  }
+  gpu::port::StatusOr<gpu::DeviceMemory<uint8>> AllocateBytes(
+      gpu::Stream* stream, int64 byte_size) override {
+    if (byte_size > memory_limit_) {
+      return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>();
+    }
+    AllocationAttributes allocation_attr;
+    allocation_attr.no_retry_on_failure = true;
+    Tensor memory(allocator_, DT_UINT8, TensorShape({byte_size}),
+                  allocation_attr);
+    if (!memory.IsInitialized()) {
+      return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>();
+    }
+    allocated_tensors_.push_back(memory);
+    return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>(AsDeviceMemory(
+        memory.flat<uint8>().data(), memory.flat<uint8>().size()));
+  }
+
+ private:
+  int64 memory_limit_;
+  Allocator* allocator_;  // Not owned.
+  std::vector<Tensor> allocated_tensors_;
+};
+
+// A plan of FftPlanCache, with the scratch space it owns.
+struct CachedFftPlan {
+  // Serializes the use of the plan, which cuFFT and rocFFT require of
+  // concurrent host threads.
+  mutex mu;
+  std::unique_ptr<PersistentCufftScratchAllocator> scratch_allocator;
+  std::unique_ptr<gpu::fft::Plan> plan;
+};
+
+// The plans of all the GPU FFT ops. TF_FFT_PLAN_CACHE_SIZE sets how many
+// are kept; 0 plans every call as before.
+FftPlanCache<CachedFftPlan>* GlobalFftPlanCache() {
+  static FftPlanCache<CachedFftPlan>* cache = [] {
+    int64 max_plans = 0;
+    Status status =
+        ReadInt64FromEnvVar("TF_FFT_PLAN_CACHE_SIZE", 64, &max_plans);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return new FftPlanCache<CachedFftPlan>(max_plans);
+  }();
+  return cache;
+}
+
 }  // end namespace
 
 int64 GetCufftWorkspaceLimit(const string& envvar_in_mb,
@@ -398,27 +459,62 @@ class FFTGPUBase : public FFTBase {
                  : (IsForward() ? gpu::fft::Type::kC2CForward
                                 : gpu::fft::Type::kC2CInverse);
 
-    CufftScratchAllocator scratch_allocator(CufftScratchSize, ctx);
-    auto plan =
-        stream->parent()->AsFft()->CreateBatchedPlanWithScratchAllocator(
-            stream, fft_rank, fft_shape, input_embed, input_stride,
-            input_distance, output_embed, output_stride, output_distance,
-            kFftType, kInPlaceFft, batch_size, &scratch_allocator);
+    auto create_plan = [&](gpu::ScratchAllocator* scratch_allocator) {
+      return stream->parent()->AsFft()->CreateBatchedPlanWithScratchAllocator(
+          stream, fft_rank, fft_shape, input_embed, input_stride,
+          input_distance, output_embed, output_stride, output_distance,
+          kFftType, kInPlaceFft, batch_size, scratch_allocator);
+    };
+    std::vector<uint64> plan_key = {
+        reinterpret_cast<uintptr_t>(stream), static_cast<uint64>(kFftType),
+        static_cast<uint64>(batch_size), input_distance, output_distance};
+    for (int i = 0; i < fft_rank; ++i) {
+      plan_key.push_back(fft_shape[i]);
+      plan_key.push_back(input_embed[i]);
+      plan_key.push_back(output_embed[i]);
+    }
+    Allocator* allocator = ctx->device()->GetAllocator(AllocatorAttributes());
+    std::shared_ptr<CachedFftPlan> cached =
+        GlobalFftPlanCache()->LookupOrCreate(plan_key, [&]() {
+          std::unique_ptr<CachedFftPlan> cached_plan(new CachedFftPlan);
+          cached_plan->scratch_allocator.reset(
+              new PersistentCufftScratchAllocator(CufftScratchSize, allocator));
+          cached_plan->plan =
+              create_plan(cached_plan->scratch_allocator.get());
+          if (cached_plan->plan == nullptr) cached_plan.reset();
+          return cached_plan;
+        });
+    if (cached != nullptr) {
+      mutex_lock l(cached->mu);
+      RunFFT(ctx, stream, cached->plan.get(), in, out, kFftType,
+             output_distance);
+    } else {
+      CufftScratchAllocator scratch_allocator(CufftScratchSize, ctx);
+      auto plan = create_plan(&scratch_allocator);
+      RunFFT(ctx, stream, plan.get(), in, out, kFftType, output_distance);
+    }
+  }
 
+ private:
+  void RunFFT(OpKernelContext* ctx, gpu::Stream* stream, gpu::fft::Plan* plan,
+              const Tensor& in, Tensor* out, gpu::fft::Type fft_type,
+              uint64 output_distance) {
+    const TensorShape& input_shape = in.shape();
+    const TensorShape& output_shape = out->shape();
     if (IsReal()) {
       if (IsForward()) {
         auto src = AsDeviceMemory<float>(in.flat<float>().data());
         auto dst = AsDeviceMemory<complex64>(out->flat<complex64>().data());
         OP_REQUIRES(
-            ctx, stream->ThenFft(plan.get(), src, &dst).ok(),
-            errors::Internal("fft failed : type=", static_cast<int>(kFftType),
+            ctx, stream->ThenFft(plan, src, &dst).ok(),
+            errors::Internal("fft failed : type=", static_cast<int>(fft_type),
                              " in.shape=", input_shape.DebugString()));
       } else {
         auto src = AsDeviceMemory<complex64>(in.flat<complex64>().data());
         auto dst = AsDeviceMemory<float>(out->flat<float>().data());
         OP_REQUIRES(
-            ctx, stream->ThenFft(plan.get(), src, &dst).ok(),
-            errors::Internal("fft failed : type=", static_cast<int>(kFftType),
+            ctx, stream->ThenFft(plan, src, &dst).ok(),
+            errors::Internal("fft failed : type=", static_cast<int>(fft_type),
                              " in.shape=", input_shape.DebugString()));
         auto alpha = 1.f / output_distance;
         OP_REQUIRES(
@@ -432,8 +528,8 @@ class FFTGPUBase : public FFTBase {
       auto src = AsDeviceMemory<complex64>(in.flat<complex64>().data());
       auto dst = AsDeviceMemory<complex64>(out->flat<complex64>().data());
       OP_REQUIRES(
-          ctx, stream->ThenFft(plan.get(), src, &dst).ok(),
-          errors::Internal("fft failed : type=", static_cast<int>(kFftType),
+          ctx, stream->ThenFft(plan, src, &dst).ok(),
+          errors::Internal("fft failed : type=", static_cast<int>(fft_type),
                            " in.shape=", input_shape.DebugString()));
       if (!IsForward()) {
         auto alpha = complex64(1.f / output_distance);
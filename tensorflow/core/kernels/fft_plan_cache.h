@@ -0,0 +1,107 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_FFT_PLAN_CACHE_H_
+#define TENSORFLOW_KERNELS_FFT_PLAN_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A least-recently-used cache of FFT plans, so that ops transforming many
+// inputs of the same shape, e.g. the frames of a spectrogram, do not pay for
+// planning on every call. "Plan" is whatever the caller needs to run a
+// transform; the key must describe everything the plan depends on, e.g. the
+// stream and the layout and type of the batched transform.
+//
+// Plans are created without holding the lock of the cache, so planning a new
+// shape does not hold up the lookups of other threads. The plans are shared,
+// so an evicted plan stays alive until its last user releases it.
+template <typename Plan>
+class FftPlanCache {
+ public:
+  typedef std::vector<uint64> Key;
+  // Returns nullptr if the plan cannot be created.
+  typedef std::function<std::unique_ptr<Plan>()> PlanFactory;
+
+  // Caches up to "max_plans" plans; none if it is 0.
+  explicit FftPlanCache(int64 max_plans) : max_plans_(max_plans) {}
+
+  // Returns the plan cached for "key", creating it with "factory" on a miss.
+  // Returns nullptr if caching is disabled or the plan could not be created;
+  // "factory" is not called in the former case.
+  std::shared_ptr<Plan> LookupOrCreate(const Key& key,
+                                       const PlanFactory& factory) {
+    if (max_plans_ <= 0) return nullptr;
+    {
+      mutex_lock l(mu_);
+      std::shared_ptr<Plan> plan = LookupLocked(key);
+      if (plan != nullptr) return plan;
+    }
+    std::shared_ptr<Plan> plan(factory());
+    if (plan == nullptr) return nullptr;
+    mutex_lock l(mu_);
+    // Another thread may have created the same plan in the meantime; all the
+    // threads then use the first one that was inserted.
+    std::shared_ptr<Plan> existing = LookupLocked(key);
+    if (existing != nullptr) return existing;
+    if (static_cast<int64>(plans_.size()) >= max_plans_) {
+      plans_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(key);
+    plans_[key] = {plan, lru_.begin()};
+    return plan;
+  }
+
+  // The number of cached plans.
+  int64 size() {
+    mutex_lock l(mu_);
+    return plans_.size();
+  }
+
+ private:
+  // Returns the plan cached for "key" and marks it as the most recently
+  // used, or returns nullptr.
+  std::shared_ptr<Plan> LookupLocked(const Key& key)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = plans_.find(key);
+    if (it == plans_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return it->second.first;
+  }
+
+  typedef std::list<Key> LruList;
+
+  const int64 max_plans_;
+  mutex mu_;
+  // The keys of the cached plans, the most recently used first.
+  LruList lru_ GUARDED_BY(mu_);
+  std::map<Key, std::pair<std::shared_ptr<Plan>, typename LruList::iterator>>
+      plans_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_FFT_PLAN_CACHE_H_
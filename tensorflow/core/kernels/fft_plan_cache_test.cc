@@ -0,0 +1,174 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fft_plan_cache.h"
+
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Stands in for a plan: the key it was created for.
+struct FakePlan {
+  explicit FakePlan(const std::vector<uint64>& key) : key(key) {}
+  std::vector<uint64> key;
+};
+
+class FftPlanCacheTest : public ::testing::Test {
+ protected:
+  FftPlanCacheTest() : num_created_(0) {}
+
+  // Looks up the plan of "key", creating a FakePlan on a miss.
+  std::shared_ptr<FakePlan> Lookup(FftPlanCache<FakePlan>* cache,
+                                   const std::vector<uint64>& key) {
+    return cache->LookupOrCreate(key, [this, &key]() {
+      ++num_created_;
+      return std::unique_ptr<FakePlan>(new FakePlan(key));
+    });
+  }
+
+  // The keys of the plans, in the layout used by the GPU FFT ops: stream,
+  // type, batch size, distances, then the shape.
+  static std::vector<uint64> Key(uint64 stream, uint64 type, uint64 batch,
+                                 uint64 size) {
+    return {stream, type, batch, size, size, size, size, size};
+  }
+
+  std::atomic<int> num_created_;
+};
+
+TEST_F(FftPlanCacheTest, Hit) {
+  FftPlanCache<FakePlan> cache(4);
+  auto plan = Lookup(&cache, Key(1, 0, 8, 256));
+  ASSERT_NE(nullptr, plan);
+  EXPECT_EQ(Key(1, 0, 8, 256), plan->key);
+  EXPECT_EQ(1, num_created_);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(plan, Lookup(&cache, Key(1, 0, 8, 256)));
+  }
+  EXPECT_EQ(1, num_created_);
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST_F(FftPlanCacheTest, KeyedOnStreamTypeBatchAndShape) {
+  FftPlanCache<FakePlan> cache(8);
+  auto plan = Lookup(&cache, Key(1, 0, 8, 256));
+  const std::vector<std::vector<uint64>> other_keys = {
+      Key(2, 0, 8, 256),  // Stream.
+      Key(1, 1, 8, 256),  // Type.
+      Key(1, 0, 4, 256),  // Batch size.
+      Key(1, 0, 8, 128),  // Shape.
+  };
+  for (const auto& key : other_keys) {
+    auto other = Lookup(&cache, key);
+    ASSERT_NE(nullptr, other);
+    EXPECT_NE(plan, other);
+    EXPECT_EQ(key, other->key);
+  }
+  EXPECT_EQ(5, num_created_);
+  EXPECT_EQ(5, cache.size());
+  // All of them are still cached.
+  EXPECT_EQ(plan, Lookup(&cache, Key(1, 0, 8, 256)));
+  for (const auto& key : other_keys) {
+    EXPECT_EQ(key, Lookup(&cache, key)->key);
+  }
+  EXPECT_EQ(5, num_created_);
+}
+
+TEST_F(FftPlanCacheTest, EvictsLeastRecentlyUsed) {
+  FftPlanCache<FakePlan> cache(2);
+  auto a = Lookup(&cache, Key(1, 0, 1, 1));
+  auto b = Lookup(&cache, Key(1, 0, 1, 2));
+  // Makes "b" the least recently used.
+  EXPECT_EQ(a, Lookup(&cache, Key(1, 0, 1, 1)));
+  auto c = Lookup(&cache, Key(1, 0, 1, 3));
+  EXPECT_EQ(3, num_created_);
+  EXPECT_EQ(2, cache.size());
+
+  EXPECT_EQ(a, Lookup(&cache, Key(1, 0, 1, 1)));
+  EXPECT_EQ(c, Lookup(&cache, Key(1, 0, 1, 3)));
+  EXPECT_EQ(3, num_created_);
+  // "b" was evicted, but is still alive for its user.
+  EXPECT_EQ(Key(1, 0, 1, 2), b->key);
+  auto b2 = Lookup(&cache, Key(1, 0, 1, 2));
+  EXPECT_NE(b, b2);
+  EXPECT_EQ(4, num_created_);
+  EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(FftPlanCacheTest, Disabled) {
+  FftPlanCache<FakePlan> cache(0);
+  EXPECT_EQ(nullptr, Lookup(&cache, Key(1, 0, 8, 256)));
+  EXPECT_EQ(0, num_created_);
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(FftPlanCacheTest, FailedPlansAreNotCached) {
+  FftPlanCache<FakePlan> cache(4);
+  EXPECT_EQ(nullptr, cache.LookupOrCreate(Key(1, 0, 8, 256), []() {
+    return std::unique_ptr<FakePlan>();
+  }));
+  EXPECT_EQ(0, cache.size());
+  EXPECT_NE(nullptr, Lookup(&cache, Key(1, 0, 8, 256)));
+  EXPECT_EQ(1, num_created_);
+}
+
+// Plans are created without the lock of the cache: a lookup of another key
+// completes while a plan is being created.
+TEST_F(FftPlanCacheTest, CreatesPlansOutsideTheLock) {
+  FftPlanCache<FakePlan> cache(4);
+  auto cached = Lookup(&cache, Key(1, 0, 8, 256));
+  Notification creating, hit;
+  thread::ThreadPool pool(Env::Default(), "test", 1);
+  pool.Schedule([&]() {
+    cache.LookupOrCreate(Key(1, 0, 8, 512), [&]() {
+      creating.Notify();
+      hit.WaitForNotification();
+      return std::unique_ptr<FakePlan>(new FakePlan(Key(1, 0, 8, 512)));
+    });
+  });
+  creating.WaitForNotification();
+  EXPECT_EQ(cached, Lookup(&cache, Key(1, 0, 8, 256)));
+  hit.Notify();
+}
+
+// Threads that miss on the same key all get the first plan inserted.
+TEST_F(FftPlanCacheTest, ConcurrentMisses) {
+  FftPlanCache<FakePlan> cache(4);
+  constexpr int kNumThreads = 8;
+  std::vector<std::shared_ptr<FakePlan>> plans(kNumThreads);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([this, &cache, &plans, i]() {
+        plans[i] = Lookup(&cache, Key(1, 0, 8, 256));
+      });
+    }
+  }
+  EXPECT_EQ(1, cache.size());
+  auto cached = Lookup(&cache, Key(1, 0, 8, 256));
+  for (const auto& plan : plans) {
+    EXPECT_EQ(cached, plan);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
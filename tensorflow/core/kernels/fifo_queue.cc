@@ -44,6 +44,35 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
     (*tuple).push_back(*queues_[i][0].AccessTensor(ctx));
     queues_[i].pop_front();
   }
+  origins_.pop_front();
+}
+
+bool FIFOQueue::TryDequeueSlicesLocked(int64 num_elements, Tuple* tuple) {
+  if (origins_.size() < static_cast<size_t>(num_elements)) return false;
+  const ElementOrigin first = origins_[0];
+  if (first.batch == nullptr) return false;
+  for (int64 k = 1; k < num_elements; ++k) {
+    if (origins_[k].batch != first.batch ||
+        origins_[k].index != first.index + k) {
+      return false;
+    }
+  }
+  Tuple slices;
+  slices.reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    slices.push_back(
+        (*first.batch)[i].Slice(first.index, first.index + num_elements));
+    // Kernels assume that their inputs are aligned.
+    if (!slices.back().IsAligned()) return false;
+  }
+  for (int64 k = 0; k < num_elements; ++k) {
+    for (int i = 0; i < num_components(); ++i) {
+      queues_[i].pop_front();
+    }
+    origins_.pop_front();
+  }
+  *tuple = std::move(slices);
+  return true;
 }
 
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
@@ -68,6 +97,7 @@ void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
               for (int i = 0; i < num_components(); ++i) {
                 queues_[i].push_back(PersistentTensor(tuple[i]));
               }
+              origins_.emplace_back();
               return kComplete;
             } else {
               return kNoProgress;
@@ -106,6 +136,10 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // The elements of the batch are enqueued as slices of it where that keeps
+  // them aligned, so that neither this nor a DequeueMany of the same elements
+  // copies them.
+  std::shared_ptr<const Tuple> batch = std::make_shared<const Tuple>(tuple);
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -116,7 +150,8 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [batch, this](Attempt* attempt) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+            const Tuple& tuple = *batch;
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
@@ -127,13 +162,32 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
               result = kProgress;
               const int64 index =
                   tuple[0].dim_size(0) - attempt->elements_requested;
+              ElementOrigin origin;
+              origin.batch = batch;
+              origin.index = index;
               for (int i = 0; i < num_components(); ++i) {
-                PersistentTensor element;
+                Tensor slice = tuple[i].Slice(index, index + 1);
+                TensorShape element_shape(slice.shape());
+                element_shape.RemoveDim(0);
+                Tensor element;
+                if (slice.IsAligned() &&
+                    element.CopyFrom(slice, element_shape)) {
+                  queues_[i].push_back(PersistentTensor(element));
+                  continue;
+                }
+                origin.batch = nullptr;
+                PersistentTensor copy;
                 attempt->context->SetStatus(GetElementComponentFromBatch(
-                    tuple, index, i, attempt->context, &element));
-                if (!attempt->context->status().ok()) return kComplete;
-                queues_[i].push_back(element);
+                    tuple, index, i, attempt->context, &copy));
+                if (!attempt->context->status().ok()) {
+                  // Drop the components of this element that were already
+                  // pushed.
+                  for (int j = 0; j < i; ++j) queues_[j].pop_back();
+                  return kComplete;
+                }
+                queues_[i].push_back(copy);
               }
+              origins_.push_back(origin);
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
                 return kComplete;
@@ -280,6 +334,7 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                         }
                         queues_[j].push_front(element);
                       }
+                      origins_.emplace_front();
                     }
                   }
                   if (allow_small_batch && !queues_[0].empty()) {
@@ -305,6 +360,17 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                   }
                 }
 
+                if (attempt->tuple.empty() &&
+                    TryDequeueSlicesLocked(attempt->elements_requested,
+                                           &attempt->tuple)) {
+                  attempt->elements_requested = 0;
+                  const Tuple tuple = attempt->tuple;
+                  attempt->done_callback = [callback, tuple]() {
+                    callback(tuple);
+                  };
+                  return kComplete;
+                }
+
                 RunResult result = kNoProgress;
                 for (; queue_size > 0; --queue_size) {
                   if (attempt->tuple.empty()) {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_KERNELS_FIFO_QUEUE_H_
 
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -65,6 +66,25 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
                                              OpKernelContext* ctx,
                                              PersistentTensor* out_element);
 
+  // If the first num_elements elements of the queue are consecutive elements
+  // of a single batch passed to EnqueueMany, dequeues them as slices of that
+  // batch without copying them, and returns true.  Otherwise leaves the queue
+  // unchanged and returns false.
+  bool TryDequeueSlicesLocked(int64 num_elements, Tuple* tuple)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Where an element of the queue came from.  If batch is set, the element
+  // was enqueued by EnqueueMany and its components share the buffers of the
+  // index^th slice of *batch.
+  struct ElementOrigin {
+    std::shared_ptr<const Tuple> batch;
+    int64 index = 0;
+  };
+
+  // One entry for each element in queues_, in the same order.  Anything that
+  // pushes or pops elements of queues_ must do the same here.
+  std::deque<ElementOrigin> origins_ GUARDED_BY(mu_);
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(FIFOQueue);
 };
@@ -87,8 +87,9 @@ class FilterDatasetOp : public UnaryDatasetOpKernel {
           : DatasetIterator<Dataset>(dataset),
             input_impl_(dataset->input_->MakeIterator()) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         // NOTE(mrry): This method is thread-safe as long as
         // `input_impl_` and `f` are thread-safe. However, if multiple
         // threads enter this method, outputs may be observed in a
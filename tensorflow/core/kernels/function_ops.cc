@@ -52,6 +52,8 @@ class ArgOp : public OpKernel {
     ctx->set_output(0, val);
   }
 
+  bool IsExpensive() override { return false; }
+
  private:
   int index_;
   DataType dtype_;
@@ -77,6 +79,8 @@ class RetvalOp : public OpKernel {
     OP_REQUIRES_OK(ctx, frame->SetRetval(index_, val));
   }
 
+  bool IsExpensive() override { return false; }
+
  private:
   int index_;
   DataType dtype_;
@@ -18,11 +18,14 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
@@ -82,18 +85,19 @@ SliceIndex HandleCopies(typename TTypes<T, 3>::ConstTensor params,
   return -1;
 }
 
+// Copies the slices of "params" selected by "indices" to "out" on the
+// calling thread. Returns the position of the first invalid index, or -1.
 template <typename T, typename Index>
-struct GatherFunctorCPU {
-  int64 operator()(typename TTypes<T, 3>::ConstTensor params,
+int64 GatherCopies(typename TTypes<T, 3>::ConstTensor params,
                    typename TTypes<Index>::ConstFlat indices,
                    typename TTypes<T, 3>::Tensor out) {
-    const int64 N = indices.size();
-    const int64 slice_size = out.dimension(2);
-    int64 bad_i;
+  const int64 N = indices.size();
+  const int64 slice_size = out.dimension(2);
+  int64 bad_i;
 
-    bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
-                      params.size() > std::numeric_limits<int32>::max() ||
-                      N > std::numeric_limits<int32>::max());
+  bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
+                    params.size() > std::numeric_limits<int32>::max() ||
+                    N > std::numeric_limits<int32>::max());
 #define CALL(elems)                                                   \
   do {                                                                \
     if (use_large) {                                                  \
@@ -106,32 +110,74 @@ struct GatherFunctorCPU {
     }                                                                 \
   } while (0)
 
-    if (slice_size == 10)
-      CALL(10);
-    else if (slice_size == 20)
-      CALL(20);
-    else
-      CALL(-1);
+  if (slice_size == 10)
+    CALL(10);
+  else if (slice_size == 20)
+    CALL(20);
+  else
+    CALL(-1);
 #undef CALL
 
+  return bad_i;
+}
+
+template <typename T, typename Index>
+struct GatherFunctorCPU {
+  int64 operator()(OpKernelContext* ctx,
+                   typename TTypes<T, 3>::ConstTensor params,
+                   typename TTypes<Index>::ConstFlat indices,
+                   typename TTypes<T, 3>::Tensor out) {
+    const int64 N = indices.size();
+    const int64 slice_size = out.dimension(2);
+    // The indices are only sharded when their slices are contiguous in
+    // "out", i.e. with a single batch, and copied with memcpy.
+    if (N <= 1 || slice_size == 0 || params.dimension(0) != 1 ||
+        !is_simple_type<T>::value) {
+      return GatherCopies<T, Index>(params, indices, out);
+    }
+    // The cost of a copy per byte is learned across the invocations of all
+    // the Gather kernels of this type.
+    static ShardCostEstimator* cost_per_byte = new ShardCostEstimator(1.0);
+    mutex mu;
+    int64 bad_i = -1;
+    auto work = [params, indices, out, slice_size, &mu, &bad_i](int64 start,
+                                                               int64 limit) {
+      typename TTypes<Index>::ConstFlat shard_indices(&indices(start),
+                                                      limit - start);
+      typename TTypes<T, 3>::Tensor shard_out(&out(0, start, 0), 1,
+                                              limit - start, slice_size);
+      const int64 shard_bad_i =
+          GatherCopies<T, Index>(params, shard_indices, shard_out);
+      if (shard_bad_i >= 0) {
+        mutex_lock l(mu);
+        if (bad_i < 0 || start + shard_bad_i < bad_i) {
+          bad_i = start + shard_bad_i;
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    AdaptiveShard(worker_threads.num_threads, worker_threads.workers, N,
+                  slice_size * sizeof(T), cost_per_byte, work);
     return bad_i;
   }
 };
 
 template <typename Device, typename T, typename Index>
 struct GatherFunctor {
-  int64 operator()(const Device& d, typename TTypes<T, 3>::ConstTensor params,
+  int64 operator()(OpKernelContext* ctx,
+                   typename TTypes<T, 3>::ConstTensor params,
                    typename TTypes<Index>::ConstFlat indices,
                    typename TTypes<T, 3>::Tensor out);
 };
 
 template <typename T, typename Index>
 struct GatherFunctor<CPUDevice, T, Index> {
-  int64 operator()(const CPUDevice& d,
+  int64 operator()(OpKernelContext* ctx,
                    typename TTypes<T, 3>::ConstTensor params,
                    typename TTypes<Index>::ConstFlat indices,
                    typename TTypes<T, 3>::Tensor out) {
-    return GatherFunctorCPU<T, Index>()(params, indices, out);
+    return GatherFunctorCPU<T, Index>()(ctx, params, indices, out);
   }
 };
 
@@ -175,6 +175,50 @@ TEST_F(GatherOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(GatherOpTest, ManyIndices) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // Enough indices for the copies to be sharded.
+  const int kRows = 100;
+  const int kCols = 64;
+  const int kIndices = 20000;
+  std::vector<float> params(kRows * kCols);
+  for (int i = 0; i < params.size(); ++i) params[i] = i;
+  std::vector<int32> indices(kIndices);
+  std::vector<float> expected_values;
+  for (int i = 0; i < kIndices; ++i) {
+    indices[i] = (i * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) {
+      expected_values.push_back(indices[i] * kCols + j);
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kIndices, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(GatherOpTest, ManyIndices_Error_IndexOutOfRange) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  const int kIndices = 20000;
+  std::vector<int32> indices(kIndices, 1);
+  // The first invalid index is reported, whichever shard sees it first.
+  indices[kIndices - 1] = 7;
+  indices[12345] = 5;
+  AddInputFromArray<float>(TensorShape({5, 64}), std::vector<float>(5 * 64));
+  AddInputFromArray<int32>(TensorShape({kIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString())
+                  .contains("indices[12345] = 5 is not in [0, 5)"))
+      << s;
+}
+
 constexpr int kLookups = 2000;
 
 template <typename Index>
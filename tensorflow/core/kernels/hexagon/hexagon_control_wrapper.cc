@@ -324,21 +324,22 @@ bool HexagonControlWrapper::FillInputNode(
   const string tensor_name = AddPort(node_name);
   CHECK(input_port_map_.count(tensor_name) > 0);
   const int port = input_port_map_.at(tensor_name);
-  if (input_tensor_data_.count(port) <= 0) {
-    input_tensor_data_.emplace(port, std::vector<uint8>{});
-  }
-  std::vector<uint8>& input_tensor_data = input_tensor_data_.at(port);
+  InputBuffer& input_buffer = input_tensor_data_[fill_buffer_][port];
 
   // hexagon only supports 32bit dimension
-  const int x = static_cast<int>(shape[0]);
-  const int y = static_cast<int>(shape[1]);
-  const int z = static_cast<int>(shape[2]);
-  const int d = static_cast<int>(shape[3]);
+  for (int i = 0; i < GraphTransferer::SHAPE_ARRAY_SIZE; ++i) {
+    input_buffer.shape[i] = static_cast<int>(shape[i]);
+  }
+  const int x = input_buffer.shape[0];
+  const int y = input_buffer.shape[1];
+  const int z = input_buffer.shape[2];
+  const int d = input_buffer.shape[3];
 
   const uint64 byte_size = x * y * z * d * DataTypeSize(std::get<2>(bytes));
   CHECK_EQ(byte_size, std::get<1>(bytes));
-  input_tensor_data.resize(byte_size + ALIGNMENT_BYTES);
-  uint8* data_ptr = FindAlignedPointer(input_tensor_data.data());
+  input_buffer.byte_size = byte_size;
+  input_buffer.data.resize(byte_size + ALIGNMENT_BYTES);
+  uint8* data_ptr = FindAlignedPointer(input_buffer.data.data());
 
   if (DBG_USE_DUMMY_INPUT) {
     std::memset(data_ptr, 0, byte_size);
@@ -346,8 +347,37 @@ bool HexagonControlWrapper::FillInputNode(
     std::memcpy(data_ptr, std::get<0>(bytes), byte_size);
   }
 
-  return soc_interface_FillInputNodeWithPort(port, x, y, z, d, data_ptr,
-                                             byte_size);
+  if (double_buffer_inputs_) {
+    // Sent by SendInputs.
+    return true;
+  }
+  return SendInputNode(port, &input_buffer);
+}
+
+bool HexagonControlWrapper::SendInputNode(const int port,
+                                          InputBuffer* const buffer) {
+  // The buffer is kept until its port is filled again, in case the hexagon
+  // controller refers to it during the execution.
+  uint8* data_ptr = FindAlignedPointer(buffer->data.data());
+  return soc_interface_FillInputNodeWithPort(
+      port, buffer->shape[0], buffer->shape[1], buffer->shape[2],
+      buffer->shape[3], data_ptr, buffer->byte_size);
+}
+
+bool HexagonControlWrapper::EnableInputDoubleBuffering() {
+  double_buffer_inputs_ = true;
+  return true;
+}
+
+bool HexagonControlWrapper::SendInputs() {
+  CHECK(double_buffer_inputs_);
+  bool success = true;
+  for (auto& port_and_buffer : input_tensor_data_[fill_buffer_]) {
+    success &= SendInputNode(port_and_buffer.first, &port_and_buffer.second);
+  }
+  // The next inputs are filled while these ones are executed.
+  fill_buffer_ = 1 - fill_buffer_;
+  return success;
 }
 
 bool HexagonControlWrapper::ReadOutputNode(
@@ -440,6 +470,8 @@ bool HexagonControlWrapper::ReadOutputNode(const string&,
                                            std::vector<ByteArray>* const) {
   return false;
 }
+bool HexagonControlWrapper::EnableInputDoubleBuffering() { return false; }
+bool HexagonControlWrapper::SendInputs() { return false; }
 #endif
 
 }  // namespace tensorflow
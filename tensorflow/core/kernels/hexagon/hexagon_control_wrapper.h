@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_HEXAGON_CONTROL_WRAPPER_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_HEXAGON_CONTROL_WRAPPER_H_
 
+#include <array>
 #include <unordered_map>
 #include <vector>
 
@@ -46,16 +47,26 @@ class HexagonControlWrapper final : public IRemoteFusedGraphExecutor {
   bool FillInputNode(const string& node_name, const Tensor& tensor) final;
   bool ReadOutputNode(const string& node_name,
                       TensorAllocatorFunc tensor_allocator) final;
+  bool EnableInputDoubleBuffering() final;
+  bool SendInputs() final;
   bool ReadOutputNode(const string& node_name, std::vector<ByteArray>* outputs);
 
  private:
   using ConstByteArray = std::tuple<const uint8* /* data */, uint64 /* size */,
                                     DataType /* type */>;
 
+  // Aligned copy of an input tensor.
+  struct InputBuffer {
+    std::vector<uint8> data;
+    std::array<int, GraphTransferer::SHAPE_ARRAY_SIZE> shape;
+    uint64 byte_size;
+  };
+
   bool FillInputNode(
       const string& node_name,
       const std::array<int64, GraphTransferer::SHAPE_ARRAY_SIZE>& shape,
       const ConstByteArray bytes);
+  bool SendInputNode(int port, InputBuffer* buffer);
 
   // CAVEAT: Need offset as HVX library reserves some ids
   static constexpr int NODE_ID_OFFSET = 0x10000;
@@ -68,7 +79,11 @@ class HexagonControlWrapper final : public IRemoteFusedGraphExecutor {
   // Dummy float array for input node.
   // TODO(satok): Use actual data passed by FillInputNode and remove
   // std::vector<float> dummy_input_float_{};
-  std::unordered_map<int, std::vector<uint8>> input_tensor_data_{};
+  // Input buffers by port. When double buffering, FillInputNode fills
+  // input_tensor_data_[fill_buffer_] while the other one is executed.
+  std::unordered_map<int, InputBuffer> input_tensor_data_[2]{};
+  bool double_buffer_inputs_{false};
+  int fill_buffer_{0};
   // Dummy byte array for cosnt node.
   // TODO(satok): Remove
   std::unordered_map<int, std::vector<uint8>> dummy_const_data_{};
@@ -59,6 +59,16 @@ class IRemoteFusedGraphExecutor {
   virtual bool ReadOutputNode(const string& node_name,
                               TensorAllocatorFunc tensor_allocator) = 0;
 
+  // Double buffering of inputs. If an executor returns true here,
+  // FillInputNode only stores the inputs on the host, so that the inputs of
+  // the next execution can be filled while ExecuteGraph runs.
+  virtual bool EnableInputDoubleBuffering() { return false; }
+
+  // Send the inputs stored by FillInputNode to the remote processor for the
+  // next ExecuteGraph call when double buffering is enabled. Must not
+  // overlap with FillInputNode or ExecuteGraph.
+  virtual bool SendInputs() { return true; }
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(IRemoteFusedGraphExecutor);
 };
@@ -137,8 +137,9 @@ class InterleaveDatasetOp : public OpKernel {
         }
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         while (!end_of_input_ || num_open_ > 0) {
           if (current_elements_[cycle_index_]) {
@@ -0,0 +1,208 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <sys/stat.h>
+
+#include "lmdb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/dataset.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+Status MDBStatus(int mdb_status, const string& filename) {
+  if (mdb_status == MDB_SUCCESS) return Status::OK();
+  return errors::InvalidArgument("LMDB error in ", filename, ": ",
+                                 mdb_strerror(mdb_status));
+}
+
+class LMDBDatasetOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    DatasetBase* dataset = new Dataset(std::move(filenames));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->scalar<ResourceHandle>()() = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    explicit Dataset(std::vector<string> filenames)
+        : filenames_(std::move(filenames)) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes =
+          new DataTypeVector({DT_STRING, DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}, {}});
+      return *shapes;
+    }
+
+    string DebugString() override { return "LMDBDatasetOp::Dataset"; }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset) {}
+
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        CloseFileLocked();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently scanning a database, so try to move the cursor
+          // to the next record.
+          if (mdb_cursor_) {
+            MDB_val key, value;
+            const int mdb_status = mdb_cursor_get(
+                mdb_cursor_, &key, &value, at_start_ ? MDB_FIRST : MDB_NEXT);
+            at_start_ = false;
+            if (mdb_status == MDB_SUCCESS) {
+              // The key and value point into the memory map, and are only
+              // valid until the transaction ends.
+              Tensor key_tensor(cpu_allocator(), DT_STRING, {});
+              key_tensor.scalar<string>()().assign(
+                  static_cast<const char*>(key.mv_data), key.mv_size);
+              out_tensors->emplace_back(std::move(key_tensor));
+              Tensor value_tensor(cpu_allocator(), DT_STRING, {});
+              value_tensor.scalar<string>()().assign(
+                  static_cast<const char*>(value.mv_data), value.mv_size);
+              out_tensors->emplace_back(std::move(value_tensor));
+              *end_of_sequence = false;
+              return Status::OK();
+            } else if (mdb_status != MDB_NOTFOUND) {
+              return MDBStatus(mdb_status,
+                               dataset()->filenames_[current_file_index_]);
+            }
+
+            // We have reached the end of the current database, so maybe
+            // move on to next file.
+            CloseFileLocked();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          // Actually move on to next file.
+          Status s = OpenFileLocked(dataset()->filenames_[current_file_index_]);
+          if (!s.ok()) {
+            CloseFileLocked();
+            return s;
+          }
+        } while (true);
+      }
+
+     private:
+      // Opens a read-only transaction and a cursor on the main database of
+      // `filename`, which may be an LMDB environment directory or a file.
+      Status OpenFileLocked(const string& filename)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        TF_RETURN_IF_ERROR(MDBStatus(mdb_env_create(&mdb_env_), filename));
+        int flags = MDB_RDONLY | MDB_NOTLS;
+        struct stat source_stat;
+        if (stat(filename.c_str(), &source_stat) == 0 &&
+            (source_stat.st_mode & S_IFREG)) {
+          flags |= MDB_NOSUBDIR;
+        }
+        TF_RETURN_IF_ERROR(MDBStatus(
+            mdb_env_open(mdb_env_, filename.c_str(), flags, 0664), filename));
+        TF_RETURN_IF_ERROR(MDBStatus(
+            mdb_txn_begin(mdb_env_, nullptr, MDB_RDONLY, &mdb_txn_),
+            filename));
+        TF_RETURN_IF_ERROR(
+            MDBStatus(mdb_dbi_open(mdb_txn_, nullptr, 0, &mdb_dbi_), filename));
+        TF_RETURN_IF_ERROR(MDBStatus(
+            mdb_cursor_open(mdb_txn_, mdb_dbi_, &mdb_cursor_), filename));
+        at_start_ = true;
+        return Status::OK();
+      }
+
+      void CloseFileLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (mdb_cursor_ != nullptr) {
+          mdb_cursor_close(mdb_cursor_);
+          mdb_cursor_ = nullptr;
+        }
+        if (mdb_txn_ != nullptr) {
+          mdb_txn_abort(mdb_txn_);
+          mdb_txn_ = nullptr;
+        }
+        if (mdb_env_ != nullptr) {
+          mdb_dbi_close(mdb_env_, mdb_dbi_);
+          mdb_env_close(mdb_env_);
+          mdb_env_ = nullptr;
+        }
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      MDB_env* mdb_env_ GUARDED_BY(mu_) = nullptr;
+      MDB_dbi mdb_dbi_ GUARDED_BY(mu_) = 0;
+      MDB_txn* mdb_txn_ GUARDED_BY(mu_) = nullptr;
+      MDB_cursor* mdb_cursor_ GUARDED_BY(mu_) = nullptr;
+      // True until the cursor of the current database has been positioned.
+      bool at_start_ GUARDED_BY(mu_) = false;
+    };
+
+    const std::vector<string> filenames_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("LMDBDataset").Device(DEVICE_CPU),
+                        LMDBDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
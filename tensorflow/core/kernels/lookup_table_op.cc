@@ -19,16 +19,102 @@ limitations under the License.
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
 
+namespace {
+
+template <typename T>
+inline uint64 HashScalar(const T& key) {
+  return static_cast<uint64>(key);
+}
+
+inline uint64 HashScalar(const string& key) { return Hash64(key); }
+
+// The unordered_map backed tables split their entries over this many
+// independently locked shards.  Lookups and inserts only contend when they
+// touch the same shard, and a growing shard only rehashes its own entries, so
+// the pause of a rehash is bounded by the size of a shard rather than of the
+// whole table.
+constexpr int kLogNumTableShards = 4;
+constexpr int kNumTableShards = 1 << kLogNumTableShards;
+
+// Batches with fewer keys than this are processed on the calling thread.
+constexpr int64 kMinParallelTableBatch = 4096;
+
+// Rough cost in cycles of looking up or inserting a single scalar entry.
+constexpr int64 kTableCostPerKey = 100;
+
+// Maps a key to its shard.  The top bits of a multiplicative hash are used so
+// that the shard does not correlate with the bucket chosen by the map inside
+// the shard.
+template <typename K>
+inline int TableShardOf(const K& key) {
+  return static_cast<int>((HashScalar(key) * 0x9E3779B97F4A7C15ull) >>
+                          (64 - kLogNumTableShards));
+}
+
+template <class K, class V>
+struct TableShard {
+  mutex mu;
+  std::unordered_map<K, V> map;  // Guarded by mu.
+};
+
+// Holds the locks of all shards of a table, acquired in shard order.
+template <class K, class V>
+class AllTableShardsLock {
+ public:
+  explicit AllTableShardsLock(TableShard<K, V>* shards) : shards_(shards) {
+    for (int s = 0; s < kNumTableShards; ++s) shards_[s].mu.lock();
+  }
+  ~AllTableShardsLock() {
+    for (int s = kNumTableShards - 1; s >= 0; --s) shards_[s].mu.unlock();
+  }
+
+ private:
+  TableShard<K, V>* const shards_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AllTableShardsLock);
+};
+
+// Groups the positions of a batch of keys by shard and calls
+// fn(shard, positions) once for every shard that is hit, with the positions in
+// increasing order.  Different shards are processed in parallel on the
+// intra-op thread pool for large batches; fn is responsible for locking.
+template <typename K, typename Fn>
+void ForEachTableShard(OpKernelContext* ctx,
+                       typename TTypes<K>::ConstFlat keys, int64 cost_per_key,
+                       const Fn& fn) {
+  const int64 num_keys = keys.size();
+  std::vector<int64> positions[kNumTableShards];
+  for (int64 i = 0; i < num_keys; ++i) {
+    positions[TableShardOf(keys(i))].push_back(i);
+  }
+  auto work = [&positions, &fn](int64 begin, int64 end) {
+    for (int64 s = begin; s < end; ++s) {
+      if (!positions[s].empty()) fn(static_cast<int>(s), positions[s]);
+    }
+  };
+  if (num_keys < kMinParallelTableBatch) {
+    work(0, kNumTableShards);
+    return;
+  }
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, kNumTableShards,
+        cost_per_key * num_keys / kNumTableShards, work);
+}
+
+}  // namespace
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
@@ -49,8 +135,14 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
+    // The shards are counted one at a time, so with concurrent inserts this
+    // is not an atomic snapshot of the table.
+    size_t size = 0;
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -59,45 +151,65 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-          default_val);
-    }
+    ForEachTableShard<K>(
+        ctx, key_values, kTableCostPerKey,
+        [&](int s, const std::vector<int64>& positions) {
+          Shard& shard = shards_[s];
+          mutex_lock l(shard.mu);
+          for (int64 i : positions) {
+            value_values(i) = gtl::FindWithDefault(
+                shard.map, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
+                default_val);
+          }
+        });
 
     return Status::OK();
   }
 
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_,
-                          SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-                          SubtleMustCopyUnlessStringOrFloat(value_values(i)));
-    }
+    // Positions are visited in order within a shard, so the last of several
+    // duplicate keys in the batch wins, as with a serial insert.
+    ForEachTableShard<K>(
+        ctx, key_values, kTableCostPerKey,
+        [&](int s, const std::vector<int64>& positions) {
+          Shard& shard = shards_[s];
+          mutex_lock l(shard.mu);
+          for (int64 i : positions) {
+            gtl::InsertOrUpdate(
+                &shard.map, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
+                SubtleMustCopyUnlessStringOrFloat(value_values(i)));
+          }
+        });
     return Status::OK();
   }
 
-  Status Insert(OpKernelContext* ctx, const Tensor& keys,
-                const Tensor& values) override {
-    return DoInsert(false, keys, values);
-  }
-
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override {
-    return DoInsert(true, keys, values);
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat<V>();
+
+    AllTableShardsLock<K, V> l(shards_);
+    for (Shard& shard : shards_) {
+      shard.map.clear();
+    }
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyUnlessStringOrFloat(key_values(i));
+      gtl::InsertOrUpdate(&shards_[TableShardOf(key)].map, key,
+                          SubtleMustCopyUnlessStringOrFloat(value_values(i)));
+    }
+    return Status::OK();
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
+    AllTableShardsLock<K, V> l(shards_);
+    int64 size = 0;
+    for (const Shard& shard : shards_) {
+      size += shard.map.size();
+    }
 
     Tensor* keys;
     Tensor* values;
@@ -109,9 +221,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Shard& shard : shards_) {
+      for (auto it = shard.map.begin(); it != shard.map.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return Status::OK();
   }
@@ -125,9 +239,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  typedef TableShard<K, V> Shard;
+  mutable Shard shards_[kNumTableShards];
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -145,8 +258,13 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
+    // See MutableHashTableOfScalars::size().
+    size_t size = 0;
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -156,58 +274,73 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto value_values = value->flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec = gtl::FindOrNull(
-          table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64 j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        for (int64 j = 0; j < value_dim; j++) {
-          value_values(i, j) = default_flat(j);
-        }
-      }
-    }
+    ForEachTableShard<K>(
+        ctx, key_values, kTableCostPerKey + value_dim,
+        [&](int s, const std::vector<int64>& positions) {
+          Shard& shard = shards_[s];
+          mutex_lock l(shard.mu);
+          for (int64 i : positions) {
+            ValueArray* value_vec = gtl::FindOrNull(
+                shard.map, SubtleMustCopyUnlessStringOrFloat(key_values(i)));
+            if (value_vec != nullptr) {
+              for (int64 j = 0; j < value_dim; j++) {
+                value_values(i, j) = value_vec->at(j);
+              }
+            } else {
+              for (int64 j = 0; j < value_dim; j++) {
+                value_values(i, j) = default_flat(j);
+              }
+            }
+          }
+        });
 
     return Status::OK();
   }
 
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
-      for (int64 j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
-      }
-      gtl::InsertOrUpdate(
-          &table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)), value_vec);
-    }
+    ForEachTableShard<K>(
+        ctx, key_values, kTableCostPerKey + value_dim,
+        [&](int s, const std::vector<int64>& positions) {
+          Shard& shard = shards_[s];
+          mutex_lock l(shard.mu);
+          for (int64 i : positions) {
+            gtl::InsertOrUpdate(
+                &shard.map, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
+                MakeValueArray(value_values, i, value_dim));
+          }
+        });
     return Status::OK();
   }
 
-  Status Insert(OpKernelContext* ctx, const Tensor& keys,
-                const Tensor& values) override {
-    return DoInsert(false, keys, values);
-  }
-
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override {
-    return DoInsert(true, keys, values);
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat_inner_dims<V, 2>();
+    int64 value_dim = value_shape_.dim_size(0);
+
+    AllTableShardsLock<K, ValueArray> l(shards_);
+    for (Shard& shard : shards_) {
+      shard.map.clear();
+    }
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyUnlessStringOrFloat(key_values(i));
+      gtl::InsertOrUpdate(&shards_[TableShardOf(key)].map, key,
+                          MakeValueArray(value_values, i, value_dim));
+    }
+    return Status::OK();
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
+    AllTableShardsLock<K, ValueArray> l(shards_);
+    int64 size = 0;
+    for (const Shard& shard : shards_) {
+      size += shard.map.size();
+    }
     int64 value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -220,12 +353,13 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64 j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Shard& shard : shards_) {
+      for (auto it = shard.map.begin(); it != shard.map.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        const ValueArray& value = it->second;
+        for (int64 j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
     return Status::OK();
@@ -240,22 +374,25 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
  private:
-  TensorShape value_shape_;
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
+  typedef TableShard<K, ValueArray> Shard;
+
+  static ValueArray MakeValueArray(
+      typename TTypes<V, 2>::ConstTensor value_values, int64 i,
+      int64 value_dim) {
+    ValueArray value_vec;
+    for (int64 j = 0; j < value_dim; j++) {
+      value_vec.push_back(value_values(i, j));
+    }
+    return value_vec;
+  }
+
+  TensorShape value_shape_;
+  mutable Shard shards_[kNumTableShards];
 };
 
 namespace {
 
-template <typename T>
-inline uint64 HashScalar(const T& key) {
-  return static_cast<uint64>(key);
-}
-
-inline uint64 HashScalar(const string& key) { return Hash64(key); }
-
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -336,43 +473,60 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto empty_key_matrix =
         empty_key_.AccessTensor(ctx)->template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
-    // TODO(andreasst): parallelize using work_sharder
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) = SubtleMustCopyUnlessStringOrFloat(
-                value_buckets_matrix(bucket_index, j));
-          }
-          break;
+    // Lookups only read the buckets, so the batch is split over the intra-op
+    // thread pool while mu_ is held.
+    mutex status_mu;
+    Status status;
+    auto work = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const uint64 key_hash = HashKey(key_matrix, i);
+        if (empty_key_hash_ == key_hash &&
+            IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+          mutex_lock l(status_mu);
+          status.Update(errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed"));
+          return;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) =
-                SubtleMustCopyUnlessStringOrFloat(default_flat(j));
+        int64 bucket_index = key_hash & bit_mask;
+        int64 num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyUnlessStringOrFloat(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
+          }
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) =
+                  SubtleMustCopyUnlessStringOrFloat(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets_) {
+            mutex_lock l(status_mu);
+            status.Update(errors::Internal(
+                "Internal error in MutableDenseHashTable lookup"));
+            return;
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
+    };
+    if (num_elements < kMinParallelTableBatch) {
+      work(0, num_elements);
+    } else {
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+            kTableCostPerKey * (key_size + value_size), work);
     }
-    return Status::OK();
+    return status;
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
@@ -0,0 +1,315 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <string.h>
+
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/random.h"
+
+#include "tensorflow/core/kernels/captured_function.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit MapAndBatchDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx),
+        graph_def_version_(ctx->graph_def_version()) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("other_arguments", &inputs));
+    std::vector<Tensor> other_arguments;
+    other_arguments.reserve(inputs.size());
+    for (const Tensor& t : inputs) {
+      other_arguments.push_back(t);
+    }
+
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("batch_size must be greater than zero."));
+
+    int32 num_threads;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int32>(ctx, "num_threads", &num_threads));
+    OP_REQUIRES(
+        ctx, num_threads > 0,
+        errors::InvalidArgument("num_threads must be greater than zero."));
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
+                                                 std::move(other_arguments),
+                                                 &captured_func));
+
+    *output = new Dataset(input, batch_size, num_threads, output_types_,
+                          output_shapes_, std::move(captured_func));
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(const DatasetBase* input, int64 batch_size, int32 num_threads,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes,
+            std::unique_ptr<CapturedFunction> captured_func)
+        : input_(input),
+          batch_size_(batch_size),
+          num_threads_(num_threads),
+          output_types_(output_types),
+          output_shapes_(output_shapes),
+          captured_func_(std::move(captured_func)) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return strings::StrCat("MapAndBatchDatasetOp(", batch_size_,
+                             ")::Dataset");
+    }
+
+   private:
+    // Copies `element` into the `index`^th slice of `batch` (in the 0th
+    // dimension). Different slices of the same batch may be written
+    // concurrently.
+    static Status CopyElementToSlice(const Tensor& element, Tensor* batch,
+                                     int64 index) {
+      if (element.dtype() != batch->dtype()) {
+        return errors::InvalidArgument(
+            "Cannot batch tensors of different types: ",
+            DataTypeString(batch->dtype()), " and ",
+            DataTypeString(element.dtype()));
+      }
+      const int64 slice_elements = element.NumElements();
+      if (DataTypeCanUseMemcpy(element.dtype())) {
+        const size_t slice_bytes = element.TotalBytes();
+        if (slice_bytes > 0) {
+          char* dst = const_cast<char*>(batch->tensor_data().data());
+          memcpy(dst + index * slice_bytes, element.tensor_data().data(),
+                 slice_bytes);
+        }
+        return Status::OK();
+      }
+      if (element.dtype() == DT_STRING) {
+        auto src = element.flat<string>();
+        auto dst = batch->flat<string>();
+        for (int64 i = 0; i < slice_elements; ++i) {
+          dst(index * slice_elements + i) = src(i);
+        }
+        return Status::OK();
+      }
+      return errors::Unimplemented("CopyElementToSlice Unhandled data type: ",
+                                   element.dtype());
+    }
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            input_impl_(dataset->input_->MakeIterator()) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (!thread_pool_) {
+          thread_pool_.reset(new thread::ThreadPool(
+              ctx->env(), "map_and_batch", dataset()->num_threads_));
+        }
+
+        // 1. Read the input elements for this batch. The input iterator
+        // is only advanced by one batch at a time, which preserves the
+        // order of elements.
+        std::vector<std::vector<Tensor>> batch_inputs;
+        batch_inputs.reserve(dataset()->batch_size_);
+        *end_of_sequence = false;
+        for (int64 i = 0; i < dataset()->batch_size_ && !*end_of_sequence;
+             ++i) {
+          std::vector<Tensor> args;
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &args, end_of_sequence));
+          if (!*end_of_sequence) {
+            batch_inputs.emplace_back(std::move(args));
+          }
+        }
+        if (batch_inputs.empty()) {
+          DCHECK(*end_of_sequence);
+          return Status::OK();
+        }
+
+        // 2. Apply the map function to each batch slot in parallel. Each
+        // slot copies its results into the preallocated batch as soon as
+        // the function returns, so the per-element outputs are released
+        // straight away instead of being buffered until the whole batch
+        // has been produced.
+        const int64 num_elements = batch_inputs.size();
+        BatchState state(dataset()->output_types_.size());
+        FunctionLibraryRuntime::Options opts;
+        // Choose a step ID that is guaranteed not to clash with any
+        // Session-generated step ID. DirectSession only generates
+        // non-negative step IDs (contiguous, starting from 0), and
+        // MasterSession generates 56-bit random step IDs whose MSB is
+        // always 0, so a negative random step ID should suffice.
+        opts.step_id = -std::abs(static_cast<int64>(random::New64()));
+        ScopedStepContainer step_container(
+            opts.step_id, [this](const string& name) {
+              dataset()
+                  ->captured_func_->resource_manager()
+                  ->Cleanup(name)
+                  .IgnoreError();
+            });
+        opts.step_container = &step_container;
+        opts.runner = ctx->runner();
+
+        BlockingCounter counter(num_elements);
+        for (int64 i = 0; i < num_elements; ++i) {
+          thread_pool_->Schedule(
+              [this, i, &batch_inputs, &opts, &state, &counter]() {
+                std::vector<Tensor> rets;
+                Status s =
+                    dataset()->captured_func_->Run(opts, batch_inputs[i], &rets);
+                if (s.ok()) {
+                  s = WriteToSlot(i, rets, &state);
+                }
+                if (!s.ok()) {
+                  mutex_lock l(state.mu);
+                  state.status.Update(s);
+                }
+                batch_inputs[i].clear();
+                counter.DecrementCount();
+              });
+        }
+        counter.Wait();
+
+        {
+          mutex_lock l(state.mu);
+          TF_RETURN_IF_ERROR(state.status);
+        }
+
+        // 3. Return the batch. A final, partial batch is a prefix of the
+        // preallocated tensors, which shares their (aligned) buffers.
+        for (Tensor& component : state.batch) {
+          if (num_elements < dataset()->batch_size_) {
+            out_tensors->emplace_back(component.Slice(0, num_elements));
+          } else {
+            out_tensors->emplace_back(std::move(component));
+          }
+        }
+        return Status::OK();
+      }
+
+     private:
+      // The output tensors of one batch, which are allocated by the
+      // first slot to finish.
+      struct BatchState {
+        explicit BatchState(size_t num_components) : batch(num_components) {}
+
+        mutex mu;
+        bool allocated GUARDED_BY(mu) = false;
+        Status status GUARDED_BY(mu);
+        // Each component is written once while `allocated` is false, so
+        // callers may read `batch` without `mu` after observing
+        // `allocated == true`.
+        std::vector<Tensor> batch;
+      };
+
+      Status WriteToSlot(int64 index, const std::vector<Tensor>& rets,
+                         BatchState* state) {
+        if (rets.size() != state->batch.size()) {
+          return errors::InvalidArgument(
+              "Map function returned ", rets.size(),
+              " components, but expected ", state->batch.size(), ".");
+        }
+        {
+          mutex_lock l(state->mu);
+          if (!state->allocated) {
+            for (size_t c = 0; c < rets.size(); ++c) {
+              TensorShape batch_shape({dataset()->batch_size_});
+              batch_shape.AppendShape(rets[c].shape());
+              state->batch[c] =
+                  Tensor(cpu_allocator(), rets[c].dtype(), batch_shape);
+            }
+            state->allocated = true;
+          }
+        }
+        for (size_t c = 0; c < rets.size(); ++c) {
+          Tensor* component = &state->batch[c];
+          if (rets[c].NumElements() !=
+              component->NumElements() / component->dim_size(0)) {
+            TensorShape slice_shape = component->shape();
+            slice_shape.RemoveDim(0);
+            return errors::InvalidArgument(
+                "Cannot batch tensors with different shapes in component ", c,
+                ". First element had shape ", slice_shape.DebugString(),
+                " and element ", index, " had shape ",
+                rets[c].shape().DebugString(), ".");
+          }
+          TF_RETURN_IF_ERROR(CopyElementToSlice(rets[c], component, index));
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::unique_ptr<thread::ThreadPool> thread_pool_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const int64 batch_size_;
+    const int32 num_threads_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+  };
+
+  const int graph_def_version_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const NameAttrList* func_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("MapAndBatchDataset").Device(DEVICE_CPU),
+                        MapAndBatchDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
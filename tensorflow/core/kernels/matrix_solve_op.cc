@@ -15,6 +15,10 @@ limitations under the License.
 
 // See docs in ../ops/linalg_ops.cc.
 
+#if GOOGLE_CUDA
+#define EIGEN_USE_GPU
+#endif
+
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/Eigen/LU"
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -26,6 +30,12 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
+#if GOOGLE_CUDA
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/kernels/cuda_solvers.h"
+#include "tensorflow/core/kernels/transpose_functor.h"
+#endif
+
 namespace tensorflow {
 
 template <class Scalar>
@@ -108,6 +118,208 @@ class MatrixSolveOp : public LinearAlgebraOp<Scalar> {
   TF_DISALLOW_COPY_AND_ASSIGN(MatrixSolveOp);
 };
 
+#if GOOGLE_CUDA
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Solves the whole batch with the batched LU factorization and solver of
+// cuBlas, instead of one matrix at a time.
+template <class Scalar>
+class MatrixSolveOpGpu : public AsyncOpKernel {
+ public:
+  explicit MatrixSolveOpGpu(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("adjoint", &adjoint_));
+  }
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) final {
+    const Tensor& input = context->input(0);
+    const Tensor& rhs = context->input(1);
+    const int ndims = input.dims();
+    // Validate inputs.
+    OP_REQUIRES_ASYNC(
+        context, ndims >= 2,
+        errors::InvalidArgument("Input must have rank >= 2, got ", ndims),
+        done);
+    OP_REQUIRES_ASYNC(context, rhs.dims() == ndims,
+                      errors::InvalidArgument(
+                          "Input and right-hand side must have the same rank, "
+                          "got ",
+                          ndims, " != ", rhs.dims()),
+                      done);
+    const int64 n = input.dim_size(ndims - 1);
+    const int64 nrhs = rhs.dim_size(ndims - 1);
+    OP_REQUIRES_ASYNC(
+        context, input.dim_size(ndims - 2) == n,
+        errors::InvalidArgument("Input matrices must be squares, got",
+                                input.dim_size(ndims - 2), " != ", n),
+        done);
+    OP_REQUIRES_ASYNC(context, rhs.dim_size(ndims - 2) == n,
+                      errors::InvalidArgument(
+                          "Input matrix and right-hand side must have the "
+                          "same number of rows, got ",
+                          n, " != ", rhs.dim_size(ndims - 2)),
+                      done);
+    for (int dim = 0; dim < ndims - 2; ++dim) {
+      OP_REQUIRES_ASYNC(
+          context, input.dim_size(dim) == rhs.dim_size(dim),
+          errors::InvalidArgument(
+              "All input tensors must have the same outer dimensions."),
+          done);
+    }
+
+    // Allocate output.
+    Tensor* out;
+    OP_REQUIRES_OK_ASYNC(context,
+                         context->allocate_output(0, rhs.shape(), &out), done);
+
+    // To be consistent with the MatrixInverse op, we define the solution for
+    // an empty set of equations as the empty matrix.
+    if (input.NumElements() == 0 || rhs.NumElements() == 0) {
+      done();
+      return;
+    }
+
+    // cuBlas expects column-major matrices, so it sees the transposes of our
+    // row-major ones, which the solver undoes with CUBLAS_OP_T. For the
+    // adjoint, factor a copy of the adjoint matrices instead.
+    const GPUDevice& d = context->eigen_device<GPUDevice>();
+    Tensor input_copy;
+    OP_REQUIRES_OK_ASYNC(context,
+                         context->allocate_temp(DataTypeToEnum<Scalar>::value,
+                                                input.shape(), &input_copy),
+                         done);
+    auto input_copy_reshaped = input_copy.template flat_inner_dims<Scalar, 3>();
+    auto input_reshaped = input.template flat_inner_dims<Scalar, 3>();
+    if (!adjoint_) {
+      d.memcpy(input_copy_reshaped.data(), input_reshaped.data(),
+               input.NumElements() * sizeof(Scalar));
+    } else {
+      functor::AdjointBatchFunctor<GPUDevice, Scalar> functor;
+      functor(d, input_reshaped, input_copy_reshaped);
+    }
+    const int64 batch_size = input_copy_reshaped.dimension(0);
+
+    // The solver overwrites the right-hand sides with the solutions, in
+    // column-major order. A single right-hand side is the same in both orders,
+    // and is solved in the output directly; otherwise the right-hand sides are
+    // transposed into a temporary and the solutions transposed back.
+    const TensorShape rhs_shape({batch_size, n, nrhs});
+    const TensorShape transposed_rhs_shape({batch_size, nrhs, n});
+    Tensor transposed_rhs;
+    Scalar* solution_data;
+    if (nrhs == 1) {
+      d.memcpy(out->flat<Scalar>().data(), rhs.flat<Scalar>().data(),
+               rhs.NumElements() * sizeof(Scalar));
+      solution_data = out->flat<Scalar>().data();
+    } else {
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_temp(DataTypeToEnum<Scalar>::value,
+                                 transposed_rhs_shape, &transposed_rhs),
+          done);
+      Tensor rhs_reshaped;
+      OP_REQUIRES_ASYNC(context, rhs_reshaped.CopyFrom(rhs, rhs_shape),
+                        errors::Internal("Failed to reshape rhs"), done);
+      OP_REQUIRES_OK_ASYNC(
+          context, DoTranspose(d, rhs_reshaped, {0, 2, 1}, &transposed_rhs),
+          done);
+      solution_data = transposed_rhs.flat<Scalar>().data();
+    }
+
+    // Allocate pivots on the device.
+    ScratchSpace<int> pivots(context, n * batch_size, /* on_host */ false);
+
+    // Prepare pointer arrays for cuBlas' batch interface.
+    ScratchSpace<uint8> input_copy_ptrs(context, sizeof(Scalar*) * batch_size,
+                                        /* on_host */ true);
+    ScratchSpace<uint8> solution_ptrs(context, sizeof(Scalar*) * batch_size,
+                                      /* on_host */ true);
+    const Scalar** input_copy_ptrs_base =
+        reinterpret_cast<const Scalar**>(input_copy_ptrs.mutable_data());
+    Scalar** solution_ptrs_base =
+        reinterpret_cast<Scalar**>(solution_ptrs.mutable_data());
+    for (int64 i = 0; i < batch_size; ++i) {
+      input_copy_ptrs_base[i] = input_copy_reshaped.data() + i * n * n;
+      solution_ptrs_base[i] = solution_data + i * n * nrhs;
+    }
+
+    // Launch the two solver kernels back to back without waiting.
+    // 1. Compute the partially pivoted LU factorization(s) of the
+    // matrix/matrices.
+    CudaSolver solver(context);
+    std::vector<DeviceLapackInfo> dev_info;
+    dev_info.emplace_back(context, batch_size, "getrf");
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        solver.GetrfBatched(n, input_copy_ptrs_base, n, pivots.mutable_data(),
+                            &dev_info.back(), batch_size),
+        done);
+    // 2. Solve, overwriting the right-hand sides with the solutions.
+    int host_info = 0;
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        solver.GetrsBatched(CUBLAS_OP_T, n, nrhs, input_copy_ptrs_base, n,
+                            pivots.data(), solution_ptrs_base, n, &host_info,
+                            batch_size),
+        done);
+    OP_REQUIRES_ASYNC(
+        context, host_info == 0,
+        errors::Internal("GetrsBatched got invalid argument ", -host_info),
+        done);
+    if (nrhs != 1) {
+      Tensor out_reshaped;
+      OP_REQUIRES_ASYNC(context, out_reshaped.CopyFrom(*out, rhs_shape),
+                        errors::Internal("Failed to reshape output"), done);
+      OP_REQUIRES_OK_ASYNC(
+          context, DoTranspose(d, transposed_rhs, {0, 2, 1}, &out_reshaped),
+          done);
+    }
+
+    // Register callback to check info after kernels finish. Also capture the
+    // temporary Tensors/ScratchSpace so they don't get deallocated before the
+    // kernels run.
+    auto info_checker = [context, dev_info, input_copy, transposed_rhs, pivots,
+                         input_copy_ptrs, solution_ptrs,
+                         done](const Status& status,
+                               const std::vector<HostLapackInfo>& host_infos) {
+      if (!status.ok() && errors::IsInvalidArgument(status) &&
+          !host_infos.empty()) {
+        for (int i = 0; i < host_infos[0].size(); ++i) {
+          // Match the CPU error message for singular matrices. Otherwise
+          // just print the original error message from the call itself
+          // below.
+          OP_REQUIRES_ASYNC(
+              context, host_infos[0].data()[i] <= 0,
+              errors::InvalidArgument("Input matrix is not invertible."),
+              done);
+        }
+      }
+      OP_REQUIRES_OK_ASYNC(context, status, done);
+      done();
+    };
+
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        solver.CopyLapackInfoToHostAsync(dev_info, std::move(info_checker)),
+        done);
+  }
+
+ private:
+  bool adjoint_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MatrixSolveOpGpu);
+};
+
+REGISTER_LINALG_OP_GPU("MatrixSolve", (MatrixSolveOpGpu<float>), float);
+REGISTER_LINALG_OP_GPU("MatrixSolve", (MatrixSolveOpGpu<double>), double);
+REGISTER_LINALG_OP_GPU("MatrixSolve", (MatrixSolveOpGpu<complex64>),
+                       complex64);
+REGISTER_LINALG_OP_GPU("MatrixSolve", (MatrixSolveOpGpu<complex128>),
+                       complex128);
+
+#endif  // GOOGLE_CUDA
+
 REGISTER_LINALG_OP("MatrixSolve", (MatrixSolveOp<float>), float);
 REGISTER_LINALG_OP("MatrixSolve", (MatrixSolveOp<double>), double);
 REGISTER_LINALG_OP("MatrixSolve", (MatrixSolveOp<complex64>), complex64);
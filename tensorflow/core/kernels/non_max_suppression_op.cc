@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/non_max_suppression_op.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,11 +32,17 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 namespace tensorflow {
 namespace {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
 
 static inline void ParseAndCheckBoxSizes(OpKernelContext* context,
                                          const Tensor& boxes,
@@ -92,6 +99,144 @@ static inline bool IOUGreaterThanThreshold(
   return iou > iou_threshold;
 }
 
+// Greedily selects up to output_size of the boxes in sorted_indices, in that
+// order, skipping the boxes that overlap an already selected box by more than
+// iou_threshold.
+static void SelectBoxes(typename TTypes<float, 2>::ConstTensor boxes,
+                        const std::vector<int>& sorted_indices,
+                        int output_size, float iou_threshold,
+                        std::vector<int>* selected) {
+  selected->clear();
+  for (int i = 0; i < sorted_indices.size(); ++i) {
+    if (selected->size() >= output_size) break;
+    bool should_select = true;
+    for (int j = 0; j < selected->size(); ++j) {
+      if (IOUGreaterThanThreshold(boxes, sorted_indices[i], (*selected)[j],
+                                  iou_threshold)) {
+        should_select = false;
+        break;
+      }
+    }
+    if (should_select) {
+      selected->push_back(sorted_indices[i]);
+    }
+  }
+}
+
+// Same greedy selection as SelectBoxes, but the overlaps are read from the
+// rows of a functor::NonMaxSuppressionMask instead of being recomputed.
+static void SelectBoxesWithMask(const int64* mask, int mask_words,
+                                const std::vector<int>& sorted_indices,
+                                int output_size, std::vector<int>* selected) {
+  selected->clear();
+  std::vector<uint64> suppressed(mask_words, 0);
+  for (int i = 0; i < sorted_indices.size(); ++i) {
+    if (selected->size() >= output_size) break;
+    const int box = sorted_indices[i];
+    const int word = box / functor::kNmsBoxesPerMaskWord;
+    const int bit = box % functor::kNmsBoxesPerMaskWord;
+    if ((suppressed[word] >> bit) & 1) continue;
+    selected->push_back(box);
+    const int64* row = mask + static_cast<int64>(box) * mask_words;
+    for (int k = 0; k < mask_words; ++k) {
+      suppressed[k] |= static_cast<uint64>(row[k]);
+    }
+  }
+}
+
+// Selects the boxes of one image of a [batch_size, num_boxes, 4] tensor. Init
+// does the per-batch work shared by all the classes and reports its errors
+// through the context; Select may then be called concurrently.
+template <typename Device>
+class BoxSelector;
+
+template <>
+class BoxSelector<CPUDevice> {
+ public:
+  void Init(OpKernelContext* context, const Tensor& boxes,
+            float iou_threshold) {
+    boxes_ = &boxes;
+    iou_threshold_ = iou_threshold;
+  }
+
+  void Select(int image, const std::vector<int>& sorted_indices,
+              int output_size, std::vector<int>* selected) const {
+    const int num_boxes = boxes_->dim_size(1);
+    typename TTypes<float, 2>::ConstTensor image_boxes(
+        &boxes_->tensor<float, 3>()(image, 0, 0), num_boxes, 4);
+    SelectBoxes(image_boxes, sorted_indices, output_size, iou_threshold_,
+                selected);
+  }
+
+ private:
+  const Tensor* boxes_ = nullptr;
+  float iou_threshold_ = 0;
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// On the GPU, Init computes the overlap bitmask of every pair of boxes of
+// every image in one kernel and copies it back; the greedy pass over the
+// sorted boxes is sequential, so it stays on the host and only ORs 64-bit
+// words.
+template <>
+class BoxSelector<GPUDevice> {
+ public:
+  void Init(OpKernelContext* context, const Tensor& boxes,
+            float iou_threshold) {
+    const int batch_size = boxes.dim_size(0);
+    const int num_boxes = boxes.dim_size(1);
+    mask_words_ = (num_boxes + functor::kNmsBoxesPerMaskWord - 1) /
+                  functor::kNmsBoxesPerMaskWord;
+    num_boxes_ = num_boxes;
+    const TensorShape mask_shape({batch_size, num_boxes, mask_words_});
+    if (mask_shape.num_elements() == 0) return;
+
+    Tensor mask;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_INT64, mask_shape, &mask));
+    functor::NonMaxSuppressionMask<GPUDevice>()(
+        context->eigen_device<GPUDevice>(), boxes.tensor<float, 3>(),
+        iou_threshold, mask.tensor<int64, 3>());
+
+    AllocatorAttributes host_attr;
+    host_attr.set_on_host(true);
+    host_attr.set_gpu_compatible(true);
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_INT64, mask_shape,
+                                                   &host_mask_, host_attr));
+    auto* stream = context->op_device_context()->stream();
+    OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
+    const uint64 mask_bytes = mask.TotalBytes();
+    perftools::gputools::DeviceMemoryBase mask_gpu(
+        const_cast<char*>(mask.tensor_data().data()), mask_bytes);
+    stream->ThenMemcpy(const_cast<char*>(host_mask_.tensor_data().data()),
+                       mask_gpu, mask_bytes);
+    stream->BlockHostUntilDone();
+    OP_REQUIRES(context, stream->ok(),
+                errors::Internal("Failed to copy the suppression mask of ",
+                                 "NonMaxSuppression from the GPU"));
+  }
+
+  void Select(int image, const std::vector<int>& sorted_indices,
+              int output_size, std::vector<int>* selected) const {
+    if (num_boxes_ == 0) {
+      selected->clear();
+      return;
+    }
+    const int64* image_mask = host_mask_.flat<int64>().data() +
+                              static_cast<int64>(image) * num_boxes_ *
+                                  mask_words_;
+    SelectBoxesWithMask(image_mask, mask_words_, sorted_indices, output_size,
+                        selected);
+  }
+
+ private:
+  Tensor host_mask_;
+  int num_boxes_ = 0;
+  int mask_words_ = 0;
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Device>
 void DoNonMaxSuppressionOp(OpKernelContext* context,
                            const Tensor& boxes,
                            const Tensor& scores,
@@ -108,33 +253,22 @@ void DoNonMaxSuppressionOp(OpKernelContext* context,
 
   const int output_size =
       std::min(max_output_size.scalar<int>()(), num_boxes);
-  typename TTypes<float, 2>::ConstTensor boxes_data =
-      boxes.tensor<float, 2>();
 
   std::vector<float> scores_data(num_boxes);
   std::copy_n(scores.flat<float>().data(), num_boxes, scores_data.begin());
   std::vector<int> sorted_indices;
   DecreasingArgSort(scores_data, &sorted_indices);
 
-  std::vector<int> selected;
-  std::vector<int> selected_indices(output_size, 0);
-  int num_selected = 0;
-  for (int i = 0; i < num_boxes; ++i) {
-    if (selected.size() >= output_size) break;
-    bool should_select = true;
-    for (int j = 0; j < num_selected; ++j) {
-      if (IOUGreaterThanThreshold(boxes_data, sorted_indices[i],
-                                  sorted_indices[selected_indices[j]],
-                                  iou_threshold)) {
-        should_select = false;
-        break;
-      }
-    }
-    if (should_select) {
-      selected.push_back(sorted_indices[i]);
-      selected_indices[num_selected++] = i;
-    }
+  // The boxes are viewed as a batch of one image.
+  Tensor batched_boxes;
+  CHECK(batched_boxes.CopyFrom(boxes, TensorShape({1, num_boxes, 4})));
+  BoxSelector<Device> selector;
+  selector.Init(context, batched_boxes, iou_threshold);
+  if (!context->status().ok()) {
+    return;
   }
+  std::vector<int> selected;
+  selector.Select(0, sorted_indices, output_size, &selected);
 
   // Allocate output tensor
   Tensor* output = nullptr;
@@ -167,8 +301,8 @@ class NonMaxSuppressionOp : public OpKernel {
         errors::InvalidArgument("max_output_size must be 0-D, got shape ",
                                 max_output_size.shape().DebugString()));
 
-    DoNonMaxSuppressionOp(context, boxes, scores, max_output_size,
-                          iou_threshold_);
+    DoNonMaxSuppressionOp<Device>(context, boxes, scores, max_output_size,
+                                  iou_threshold_);
   }
 
  private:
@@ -202,8 +336,120 @@ class NonMaxSuppressionV2Op : public OpKernel {
 
     const float iou_threshold_val = iou_threshold.scalar<float>()();
 
-    DoNonMaxSuppressionOp(context, boxes, scores, max_output_size,
-                          iou_threshold_val);
+    DoNonMaxSuppressionOp<Device>(context, boxes, scores, max_output_size,
+                                  iou_threshold_val);
+  }
+};
+
+template <typename Device>
+class BatchedNonMaxSuppressionOp : public OpKernel {
+ public:
+  explicit BatchedNonMaxSuppressionOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_boxes, 4]
+    const Tensor& boxes = context->input(0);
+    OP_REQUIRES(context, boxes.dims() == 3 && boxes.dim_size(2) == 4,
+                errors::InvalidArgument(
+                    "boxes must be 3-D with 4 columns, got shape ",
+                    boxes.shape().DebugString()));
+    const int batch_size = boxes.dim_size(0);
+    const int num_boxes = boxes.dim_size(1);
+    // scores: [batch_size, num_boxes, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, scores.dims() == 3 &&
+                             scores.dim_size(0) == batch_size &&
+                             scores.dim_size(1) == num_boxes,
+                errors::InvalidArgument(
+                    "scores has incompatible shape ",
+                    scores.shape().DebugString(), " for boxes of shape ",
+                    boxes.shape().DebugString()));
+    const int num_classes = scores.dim_size(2);
+    const Tensor& max_output_size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_output_size.shape()),
+        errors::InvalidArgument("max_output_size_per_class must be 0-D, ",
+                                "got shape ",
+                                max_output_size.shape().DebugString()));
+    const int max_output_size_val = max_output_size.scalar<int>()();
+    OP_REQUIRES(context, max_output_size_val >= 0,
+                errors::InvalidArgument(
+                    "max_output_size_per_class must be non-negative"));
+    const Tensor& iou_threshold = context->input(3);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(iou_threshold.shape()),
+        errors::InvalidArgument("iou_threshold must be 0-D, got shape ",
+                                iou_threshold.shape().DebugString()));
+    const float iou_threshold_val = iou_threshold.scalar<float>()();
+    OP_REQUIRES(context, iou_threshold_val >= 0 && iou_threshold_val <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+    const Tensor& score_threshold = context->input(4);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(score_threshold.shape()),
+        errors::InvalidArgument("score_threshold must be 0-D, got shape ",
+                                score_threshold.shape().DebugString()));
+    const float score_threshold_val = score_threshold.scalar<float>()();
+
+    Tensor* selected_indices = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, num_classes,
+                                    max_output_size_val}),
+                       &selected_indices));
+    Tensor* num_valid = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       1, TensorShape({batch_size, num_classes}), &num_valid));
+    auto selected_indices_data = selected_indices->tensor<int, 3>();
+    auto num_valid_data = num_valid->matrix<int>();
+    selected_indices_data.setZero();
+    if (num_boxes == 0) {
+      num_valid_data.setZero();
+      return;
+    }
+
+    BoxSelector<Device> selector;
+    selector.Init(context, boxes, iou_threshold_val);
+    if (!context->status().ok()) {
+      return;
+    }
+    auto scores_data = scores.tensor<float, 3>();
+    // Each (image, class) pair is independent; they are spread over the
+    // worker threads.
+    auto select_range = [&](int64 begin, int64 end) {
+      std::vector<float> class_scores(num_boxes);
+      std::vector<int> sorted_indices;
+      std::vector<int> selected;
+      for (int64 k = begin; k < end; ++k) {
+        const int b = k / num_classes;
+        const int c = k % num_classes;
+        for (int i = 0; i < num_boxes; ++i) {
+          class_scores[i] = scores_data(b, i, c);
+        }
+        DecreasingArgSort(class_scores, &sorted_indices);
+        // Drop the boxes at or below the score threshold before the
+        // quadratic selection.
+        sorted_indices.erase(
+            std::find_if(sorted_indices.begin(), sorted_indices.end(),
+                         [&class_scores, score_threshold_val](int i) {
+                           return !(class_scores[i] > score_threshold_val);
+                         }),
+            sorted_indices.end());
+        selector.Select(b, sorted_indices, max_output_size_val, &selected);
+        std::copy(selected.begin(), selected.end(),
+                  selected_indices_data.data() + k * max_output_size_val);
+        num_valid_data(b, c) = selected.size();
+      }
+    };
+    // Sorting plus the IOU tests against the selected boxes.
+    const int64 cost_per_unit =
+        static_cast<int64>(num_boxes) * (20 + 10 * max_output_size_val);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          static_cast<int64>(batch_size) * num_classes, cost_per_unit,
+          select_range);
   }
 };
 
@@ -213,4 +459,36 @@ REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV2").Device(DEVICE_CPU),
                         NonMaxSuppressionV2Op<CPUDevice>);
 
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression").Device(DEVICE_CPU),
+                        BatchedNonMaxSuppressionOp<CPUDevice>);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Only the boxes live on the GPU: the scores are sorted and the selected
+// indices are produced by the host side of the kernel.
+REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("scores")
+                            .HostMemory("max_output_size")
+                            .HostMemory("selected_indices"),
+                        NonMaxSuppressionOp<GPUDevice>);
+
+REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV2")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("scores")
+                            .HostMemory("max_output_size")
+                            .HostMemory("iou_threshold")
+                            .HostMemory("selected_indices"),
+                        NonMaxSuppressionV2Op<GPUDevice>);
+
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("scores")
+                            .HostMemory("max_output_size_per_class")
+                            .HostMemory("iou_threshold")
+                            .HostMemory("score_threshold")
+                            .HostMemory("selected_indices")
+                            .HostMemory("num_valid"),
+                        BatchedNonMaxSuppressionOp<GPUDevice>);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace tensorflow
@@ -31,6 +31,19 @@ struct NonMaxSuppression {
                   typename TTypes<int, 1>::Tensor selected_indices);
 };
 
+// Number of boxes covered by one int64 word of a suppression mask.
+constexpr int kNmsBoxesPerMaskWord = 64;
+
+// Computes, for every image b and every pair of boxes i, j of that image, the
+// bit j % 64 of mask(b, i, j / 64), which is set iff the intersection over
+// union of boxes(b, i) and boxes(b, j) is greater than iou_threshold. The
+// greedy selection then only has to OR the rows of the boxes it keeps.
+template <typename Device>
+struct NonMaxSuppressionMask {
+  void operator()(const Device& d, typename TTypes<float, 3>::ConstTensor boxes,
+                  float iou_threshold, typename TTypes<int64, 3>::Tensor mask);
+};
+
 }  // namespace functor
 }  // namespace tensorflow
 
@@ -0,0 +1,127 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc.
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/non_max_suppression_op.h"
+
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Same computation, in the same order, as IOUGreaterThanThreshold in
+// non_max_suppression_op.cc, so that both devices select the same boxes. The
+// boxes are given as (ymin, xmin, ymax, xmax) with the corners already sorted.
+__device__ EIGEN_STRONG_INLINE bool IOUGreaterThanThreshold(
+    const float* box_i, const float* box_j, float iou_threshold) {
+  // The explicitly rounded products keep the compiler from contracting the
+  // sums below into fused multiply-adds, which the CPU kernel does not use.
+  const float area_i =
+      __fmul_rn(box_i[2] - box_i[0], box_i[3] - box_i[1]);
+  const float area_j =
+      __fmul_rn(box_j[2] - box_j[0], box_j[3] - box_j[1]);
+  if (area_i <= 0 || area_j <= 0) return false;
+  const float intersection_ymin = fmaxf(box_i[0], box_j[0]);
+  const float intersection_xmin = fmaxf(box_i[1], box_j[1]);
+  const float intersection_ymax = fminf(box_i[2], box_j[2]);
+  const float intersection_xmax = fminf(box_i[3], box_j[3]);
+  const float intersection_area =
+      __fmul_rn(fmaxf(intersection_ymax - intersection_ymin, 0.0f),
+                fmaxf(intersection_xmax - intersection_xmin, 0.0f));
+  const float iou = intersection_area / (area_i + area_j - intersection_area);
+  return iou > iou_threshold;
+}
+
+__device__ EIGEN_STRONG_INLINE void LoadSortedCorners(const float* box,
+                                                      float* corners) {
+  corners[0] = fminf(box[0], box[2]);
+  corners[1] = fminf(box[1], box[3]);
+  corners[2] = fmaxf(box[0], box[2]);
+  corners[3] = fmaxf(box[1], box[3]);
+}
+
+// Each block of kNmsBoxesPerMaskWord threads compares kNmsBoxesPerMaskWord
+// rows of boxes against the kNmsBoxesPerMaskWord column boxes of mask word
+// blockIdx.x, for image blockIdx.z. The column boxes are staged in shared
+// memory and every thread writes one word of its row.
+__global__ void NonMaxSuppressionMaskKernel(const float* boxes, int num_boxes,
+                                            int mask_words,
+                                            float iou_threshold,
+                                            int64* mask) {
+  __shared__ float column_boxes[functor::kNmsBoxesPerMaskWord * 4];
+  const int image = blockIdx.z;
+  const int row = blockIdx.y * functor::kNmsBoxesPerMaskWord + threadIdx.x;
+  const int column_start = blockIdx.x * functor::kNmsBoxesPerMaskWord;
+  const int column_count =
+      min(num_boxes - column_start, functor::kNmsBoxesPerMaskWord);
+  const float* image_boxes =
+      boxes + static_cast<int64>(image) * num_boxes * 4;
+
+  if (threadIdx.x < column_count) {
+    LoadSortedCorners(image_boxes + (column_start + threadIdx.x) * 4,
+                      column_boxes + threadIdx.x * 4);
+  }
+  __syncthreads();
+  if (row >= num_boxes) return;
+
+  float row_box[4];
+  LoadSortedCorners(image_boxes + row * 4, row_box);
+  uint64 bits = 0;
+  for (int j = 0; j < column_count; ++j) {
+    if (IOUGreaterThanThreshold(row_box, column_boxes + j * 4,
+                                iou_threshold)) {
+      bits |= static_cast<uint64>(1) << j;
+    }
+  }
+  mask[(static_cast<int64>(image) * num_boxes + row) * mask_words +
+       blockIdx.x] = static_cast<int64>(bits);
+}
+
+}  // namespace
+
+namespace functor {
+
+template <>
+void NonMaxSuppressionMask<GPUDevice>::operator()(
+    const GPUDevice& d, typename TTypes<float, 3>::ConstTensor boxes,
+    float iou_threshold, typename TTypes<int64, 3>::Tensor mask) {
+  const int batch_size = boxes.dimension(0);
+  const int num_boxes = boxes.dimension(1);
+  const int mask_words = mask.dimension(2);
+  if (batch_size == 0 || num_boxes == 0) return;
+  const int row_blocks =
+      (num_boxes + kNmsBoxesPerMaskWord - 1) / kNmsBoxesPerMaskWord;
+  GPU_LAUNCH_KERNEL(NonMaxSuppressionMaskKernel,
+      dim3(mask_words, row_blocks, batch_size), dim3(kNmsBoxesPerMaskWord), 0,
+      d.stream(),
+      boxes.data(), num_boxes, mask_words, iou_threshold, mask.data());
+}
+
+template struct NonMaxSuppressionMask<GPUDevice>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
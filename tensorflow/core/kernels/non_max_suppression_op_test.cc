@@ -335,4 +335,84 @@ TEST_F(NonMaxSuppressionV2OpTest, TestEmptyInput) {
   test::ExpectTensorEqual<int>(expected, *GetOutput(0));
 }
 
+//
+// BatchedNonMaxSuppressionOp Tests
+//
+
+class BatchedNonMaxSuppressionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_EXPECT_OK(NodeDefBuilder("non_max_suppression_op",
+                                "BatchedNonMaxSuppression")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestSelectPerImageAndClass) {
+  MakeOp();
+  // Both images hold the same three clusters of boxes.
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 4}),
+      {0, 0,  1, 1,  0, 0.1f,  1, 1.1f,  0, -0.1f, 1, 0.9f,
+       0, 10, 1, 11, 0, 10.1f, 1, 11.1f, 0, 100,   1, 101,
+       0, 0,  1, 1,  0, 0.1f,  1, 1.1f,  0, -0.1f, 1, 0.9f,
+       0, 10, 1, 11, 0, 10.1f, 1, 11.1f, 0, 100,   1, 101});
+  // scores[b, i, c]
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 2}),
+      {.9f, .1f, .75f, .2f, .6f, .3f, .95f, .4f, .5f, .5f, .3f, .6f,
+       0,   .9f, 0,    .75f, 0,  .6f, 0,    .95f, 0,  .5f, 0,  .3f});
+  AddInputFromArray<int>(TensorShape({}), {4});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {.25f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_indices(allocator(), DT_INT32, TensorShape({2, 2, 4}));
+  test::FillValues<int>(&expected_indices,
+                        {3, 0, 5, 0, 5, 4, 2, 0, 0, 0, 0, 0, 3, 0, 5, 0});
+  test::ExpectTensorEqual<int>(expected_indices, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&expected_num_valid, {3, 3, 0, 3});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestInconsistentBoxAndScoreShapes) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 2, 4}),
+                           {0, 0, 1, 1, 0, 0.1f, 1, 1.1f});
+  AddInputFromArray<float>(TensorShape({1, 3, 1}), {.9f, .75f, .6f});
+  AddInputFromArray<int>(TensorShape({}), {30});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0});
+  Status s = RunOpKernel();
+
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("scores has incompatible shape"))
+      << s;
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestEmptyInput) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({2, 0, 4}), {});
+  AddInputFromArray<float>(TensorShape({2, 0, 1}), {});
+  AddInputFromArray<int>(TensorShape({}), {2});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_indices(allocator(), DT_INT32, TensorShape({2, 1, 2}));
+  test::FillValues<int>(&expected_indices, {0, 0, 0, 0});
+  test::ExpectTensorEqual<int>(expected_indices, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({2, 1}));
+  test::FillValues<int>(&expected_num_valid, {0, 0});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
 }  // namespace tensorflow
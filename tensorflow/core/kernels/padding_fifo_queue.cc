@@ -118,6 +118,7 @@ void PaddingFIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                     }
                     queues_[j].push_front(element);
                   }
+                  origins_.emplace_front();
                 }
               }
               if (allow_small_batch && !queues_[0].empty()) {
@@ -0,0 +1,517 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/random/random.h"
+
+#include "tensorflow/core/kernels/captured_function.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ParallelInterleaveDatasetOp : public OpKernel {
+ public:
+  explicit ParallelInterleaveDatasetOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx), graph_def_version_(ctx->graph_def_version()) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    OpInputList inputs;
+    OP_REQUIRES_OK(ctx, ctx->input_list("other_arguments", &inputs));
+    std::vector<Tensor> other_arguments;
+    other_arguments.reserve(inputs.size());
+    for (const Tensor& t : inputs) {
+      other_arguments.push_back(t);
+    }
+
+    const Tensor* cycle_length_t;
+    OP_REQUIRES_OK(ctx, ctx->input("cycle_length", &cycle_length_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(cycle_length_t->shape()),
+                errors::InvalidArgument("cycle_length must be a scalar."));
+    const int64 cycle_length = cycle_length_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, cycle_length > 0,
+        errors::InvalidArgument("cycle_length must be greater than zero."));
+
+    const Tensor* block_length_t;
+    OP_REQUIRES_OK(ctx, ctx->input("block_length", &block_length_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(block_length_t->shape()),
+                errors::InvalidArgument("block_length must be a scalar."));
+    const int64 block_length = block_length_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, block_length > 0,
+        errors::InvalidArgument("block_length must be greater than zero."));
+
+    const Tensor* sloppy_t;
+    OP_REQUIRES_OK(ctx, ctx->input("sloppy", &sloppy_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(sloppy_t->shape()),
+                errors::InvalidArgument("sloppy must be a scalar."));
+    const bool sloppy = sloppy_t->flat<bool>()(0);
+
+    const Tensor* buffer_output_elements_t;
+    OP_REQUIRES_OK(ctx, ctx->input("buffer_output_elements",
+                                   &buffer_output_elements_t));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(buffer_output_elements_t->shape()),
+        errors::InvalidArgument("buffer_output_elements must be a scalar."));
+    const int64 buffer_output_elements =
+        buffer_output_elements_t->flat<int64>()(0);
+    OP_REQUIRES(ctx, buffer_output_elements > 0,
+                errors::InvalidArgument(
+                    "buffer_output_elements must be greater than zero."));
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
+                                                 std::move(other_arguments),
+                                                 &captured_func));
+
+    // The worker threads create and advance the per-input iterators
+    // outside of any call to GetNext(), so like ParallelMapDatasetOp we
+    // capture the context information from this kernel.
+    IteratorContext::Params params;
+    params.env = ctx->env();
+    params.resource_manager = ctx->resource_manager();
+    params.runner = *(ctx->runner());
+
+    DatasetBase* dataset = new Dataset(
+        input, std::move(captured_func), cycle_length, block_length, sloppy,
+        buffer_output_elements, std::move(params), output_types_,
+        output_shapes_);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(const DatasetBase* input,
+            std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
+            int64 block_length, bool sloppy, int64 buffer_output_elements,
+            IteratorContext::Params ctx_params,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : input_(input),
+          captured_func_(std::move(captured_func)),
+          cycle_length_(cycle_length),
+          block_length_(block_length),
+          sloppy_(sloppy),
+          buffer_output_elements_(buffer_output_elements),
+          ctx_params_(std::move(ctx_params)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return "ParallelInterleaveDatasetOp::Dataset";
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            iter_ctx_(dataset->ctx_params_),
+            input_impl_(dataset->input_->MakeIterator()),
+            workers_(dataset->cycle_length_) {}
+
+      ~Iterator() override {
+        // Signal the worker threads, if any, so that they terminate. We
+        // will then join those threads when we delete
+        // `this->worker_threads_`.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        for (WorkerState& worker : workers_) {
+          worker.cond_var.notify_all();
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(EnsureWorkerThreadsStarted(ctx));
+        while (!cancelled_) {
+          bool found = false;
+          Status s = dataset()->sloppy_
+                         ? ConsumeAnyReadyElement(ctx, out_tensors, &found)
+                         : ConsumeNextElement(ctx, out_tensors, &found);
+          if (found) {
+            *end_of_sequence = false;
+            return s;
+          }
+          TF_RETURN_IF_ERROR(s);
+          if (end_of_input_ && num_open_ == 0) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          if (waiting_) {
+            cond_var_.wait(l);
+          }
+        }
+        return errors::Cancelled(
+            "ParallelInterleaveDatasetOp::Dataset::Iterator::GetNext");
+      }
+
+     private:
+      // An output element comprises the status from getting it and (if
+      // that status is OK) a vector of tensors.
+      struct OutputElement {
+        Status status;
+        std::vector<Tensor> output;
+      };
+
+      // The state of the worker thread for one position in the cycle.
+      struct WorkerState {
+        // The input element from which the worker should create its next
+        // iterator. Set by the consumer together with `is_producing`.
+        std::vector<Tensor> input;
+        // True while the worker has not reached the end of its current
+        // element.
+        bool is_producing = false;
+        // True from the moment the consumer assigns an input element until
+        // the consumer has observed the end of that element.
+        bool has_element = false;
+        // Elements produced but not yet consumed.
+        std::deque<OutputElement> outputs;
+        // Signalled when the worker may make progress.
+        condition_variable cond_var;
+      };
+
+      void AdvanceToNextInCycle() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        block_index_ = 0;
+        cycle_index_ = (cycle_index_ + 1) % dataset()->cycle_length_;
+      }
+
+      void AdvancePosition() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        ++block_index_;
+        if (block_index_ == dataset()->block_length_) {
+          AdvanceToNextInCycle();
+        }
+      }
+
+      Status EnsureWorkerThreadsStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (worker_threads_.empty()) {
+          for (int64 i = 0; i < dataset()->cycle_length_; ++i) {
+            worker_threads_.emplace_back(
+                std::unique_ptr<Thread>(ctx->env()->StartThread(
+                    {}, "interleave_worker_thread",
+                    [this, i]() { WorkerThread(i); })));
+          }
+          // The sequential interleave opens the first `cycle_length` input
+          // elements in cycle order, so opening them all up front produces
+          // the same order while letting every worker start reading.
+          for (int64 i = 0; i < dataset()->cycle_length_ && !end_of_input_;
+               ++i) {
+            TF_RETURN_IF_ERROR(AssignInputElement(ctx, i));
+          }
+        }
+        return Status::OK();
+      }
+
+      // Hands the next input element, if any, to the worker at `index`.
+      Status AssignInputElement(IteratorContext* ctx, int64 index)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::vector<Tensor> args;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &args, &end_of_input_));
+        if (!end_of_input_) {
+          WorkerState* worker = &workers_[index];
+          worker->input = std::move(args);
+          worker->is_producing = true;
+          worker->has_element = true;
+          ++num_open_;
+          worker->cond_var.notify_one();
+        }
+        return Status::OK();
+      }
+
+      // Removes the first buffered element of the worker at `index`.
+      Status PopOutput(int64 index, std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        WorkerState* worker = &workers_[index];
+        RecordBufferOccupancy(worker->outputs.size());
+        Status s = std::move(worker->outputs.front().status);
+        if (s.ok()) {
+          *out_tensors = std::move(worker->outputs.front().output);
+        }
+        worker->outputs.pop_front();
+        // Wake the worker, in case it has been waiting for space in its
+        // buffer.
+        worker->cond_var.notify_one();
+        return s;
+      }
+
+      // Produces the same elements in the same order as the sequential
+      // InterleaveDataset. Sets `*found` if an element was consumed, and
+      // `waiting_` if the caller must wait for a worker.
+      Status ConsumeNextElement(IteratorContext* ctx,
+                                std::vector<Tensor>* out_tensors, bool* found)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        waiting_ = false;
+        WorkerState* worker = &workers_[cycle_index_];
+        if (worker->has_element) {
+          if (!worker->outputs.empty()) {
+            *found = true;
+            Status s = PopOutput(cycle_index_, out_tensors);
+            if (s.ok()) {
+              // Like InterleaveDataset, an error does not count towards
+              // the current block.
+              AdvancePosition();
+            }
+            return s;
+          }
+          if (worker->is_producing) {
+            waiting_ = true;
+            return Status::OK();
+          }
+          // We have reached the end of the current element, so move on
+          // to the next element in the cycle.
+          worker->has_element = false;
+          --num_open_;
+          AdvanceToNextInCycle();
+        } else if (!end_of_input_) {
+          TF_RETURN_IF_ERROR(AssignInputElement(ctx, cycle_index_));
+        } else {
+          AdvanceToNextInCycle();
+        }
+        return Status::OK();
+      }
+
+      // Produces the first element that is ready, starting from the
+      // current position in the cycle, and reopens finished positions
+      // from the input straight away.
+      Status ConsumeAnyReadyElement(IteratorContext* ctx,
+                                    std::vector<Tensor>* out_tensors,
+                                    bool* found) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        waiting_ = false;
+        const int64 cycle_length = dataset()->cycle_length_;
+        for (int64 i = 0; i < cycle_length; ++i) {
+          const int64 index = (cycle_index_ + i) % cycle_length;
+          WorkerState* worker = &workers_[index];
+          if (!worker->outputs.empty()) {
+            *found = true;
+            if (index != cycle_index_) {
+              cycle_index_ = index;
+              block_index_ = 0;
+            }
+            Status s = PopOutput(index, out_tensors);
+            AdvancePosition();
+            return s;
+          }
+          if (worker->has_element && !worker->is_producing) {
+            worker->has_element = false;
+            --num_open_;
+          }
+          if (!worker->has_element && !end_of_input_) {
+            TF_RETURN_IF_ERROR(AssignInputElement(ctx, index));
+          }
+        }
+        waiting_ = num_open_ > 0;
+        return Status::OK();
+      }
+
+      void WorkerThread(int64 index) {
+        WorkerState* worker = &workers_[index];
+        while (true) {
+          // 1. Wait for an input element.
+          std::vector<Tensor> input;
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && !worker->is_producing) {
+              worker->cond_var.wait(l);
+            }
+            if (cancelled_) {
+              return;
+            }
+            input.swap(worker->input);
+          }
+
+          // 2. Create an iterator from the input element, and read its
+          // elements into the buffer until it is exhausted.
+          std::unique_ptr<IteratorBase> iterator;
+          Status s = MakeIteratorFromInputElement(input, &iterator);
+          bool end_of_element = !s.ok();
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            worker->outputs.push_back(OutputElement{s, {}});
+          }
+          while (!end_of_element) {
+            {
+              mutex_lock l(mu_);
+              while (!cancelled_ && worker->outputs.size() >=
+                                        dataset()->buffer_output_elements_) {
+                worker->cond_var.wait(l);
+              }
+              if (cancelled_) {
+                return;
+              }
+            }
+
+            // Read without holding the lock, so that the consumer and the
+            // other workers can make progress.
+            OutputElement element;
+            element.status =
+                iterator->GetNext(&iter_ctx_, &element.output, &end_of_element);
+            if (element.status.ok() && end_of_element) {
+              break;
+            }
+            end_of_element = false;
+
+            mutex_lock l(mu_);
+            worker->outputs.push_back(std::move(element));
+            cond_var_.notify_all();
+          }
+
+          // 3. Signal that the element has been exhausted.
+          mutex_lock l(mu_);
+          worker->is_producing = false;
+          cond_var_.notify_all();
+        }
+      }
+
+      Status MakeIteratorFromInputElement(
+          const std::vector<Tensor>& input_element,
+          std::unique_ptr<IteratorBase>* out_iterator) {
+        FunctionLibraryRuntime::Options opts;
+        opts.runner = iter_ctx_.runner();
+        // Choose a step ID that is guaranteed not to clash with any
+        // Session-generated step ID. DirectSession only generates
+        // non-negative step IDs (contiguous, starting from 0), and
+        // MasterSession generates 56-bit random step IDs whose MSB
+        // is always 0, so a negative random step ID should suffice.
+        opts.step_id = -std::abs(static_cast<int64>(random::New64()));
+        ScopedStepContainer step_container(
+            opts.step_id, [this](const string& name) {
+              dataset()
+                  ->captured_func_->resource_manager()
+                  ->Cleanup(name)
+                  .IgnoreError();
+            });
+        opts.step_container = &step_container;
+        std::vector<Tensor> return_values;
+        TF_RETURN_IF_ERROR(dataset()->captured_func_->Run(opts, input_element,
+                                                          &return_values));
+
+        if (!(return_values.size() == 1 &&
+              return_values[0].dtype() == DT_RESOURCE &&
+              TensorShapeUtils::IsScalar(return_values[0].shape()))) {
+          return errors::InvalidArgument(
+              "`f` must return a single scalar of dtype DT_RESOURCE.");
+        }
+
+        // Retrieve the dataset that was created in `f`.
+        DatasetBase* returned_dataset;
+        const ResourceHandle& dataset_resource =
+            return_values[0].scalar<ResourceHandle>()();
+
+        // NOTE(mrry): We cannot use the core `LookupResource()` or
+        // `DeleteResource()` functions, because we have an
+        // `IteratorContext*` and not an `OpKernelContext*`, so we
+        // replicate the necessary functionality here.
+        auto type_index = MakeTypeIndex<DatasetBase>();
+        if (type_index.hash_code() != dataset_resource.hash_code()) {
+          return errors::InvalidArgument("`f` must return a Dataset resource.");
+        }
+        TF_RETURN_IF_ERROR(
+            dataset()->captured_func_->resource_manager()->Lookup(
+                dataset_resource.container(), dataset_resource.name(),
+                &returned_dataset));
+        core::ScopedUnref unref_dataset(returned_dataset);
+
+        // Create an iterator for the dataset that was returned by
+        // `f`. This transfers ownership of the dataset to the
+        // iterator, so we can delete it from the resource manager.
+        *out_iterator = returned_dataset->MakeIterator();
+        TF_RETURN_IF_ERROR(
+            dataset()->captured_func_->resource_manager()->Delete<DatasetBase>(
+                dataset_resource.container(), dataset_resource.name()));
+        return Status::OK();
+      }
+
+      IteratorContext iter_ctx_;
+      mutex mu_;
+      // Signalled when a worker produces an element or exhausts its
+      // current input element.
+      condition_variable cond_var_;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::vector<WorkerState> workers_ GUARDED_BY(mu_);
+      int64 cycle_index_ GUARDED_BY(mu_) = 0;
+      int64 block_index_ GUARDED_BY(mu_) = 0;
+      bool end_of_input_ GUARDED_BY(mu_) = false;
+      int64 num_open_ GUARDED_BY(mu_) = 0;
+      bool waiting_ GUARDED_BY(mu_) = false;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      // Declared last, so that the threads are joined before the state
+      // they use is destroyed.
+      std::vector<std::unique_ptr<Thread>> worker_threads_ GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+    const int64 cycle_length_;
+    const int64 block_length_;
+    const bool sloppy_;
+    const int64 buffer_output_elements_;
+    const IteratorContext::Params ctx_params_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  const int graph_def_version_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const NameAttrList* func_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParallelInterleaveDataset").Device(DEVICE_CPU),
+                        ParallelInterleaveDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -12,7 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <deque>
+#include <limits>
 
 #include "tensorflow/core/kernels/dataset.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -56,9 +58,10 @@ class ParallelMapDatasetOp : public OpKernel {
     OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(num_threads_t->shape()),
                 errors::InvalidArgument("num_threads must be a scalar"));
     const int32 num_threads = num_threads_t->flat<int32>()(0);
-    OP_REQUIRES(
-        ctx, num_threads > 0,
-        errors::InvalidArgument("num_threads must be greater than zero."));
+    OP_REQUIRES(ctx, num_threads > 0 || num_threads == kAutoTune,
+                errors::InvalidArgument(
+                    "num_threads must be greater than zero, or ", kAutoTune,
+                    " to autotune it."));
 
     const Tensor* output_buffer_size_t;
     OP_REQUIRES_OK(ctx,
@@ -73,11 +76,19 @@ class ParallelMapDatasetOp : public OpKernel {
     // seems like this constraint would make it easier to (i)
     // constrain the memory usage of the iterator, and (ii) enforce a
     // consistent ordering between input and output.
-    OP_REQUIRES(ctx, output_buffer_size >= num_threads,
-                errors::InvalidArgument(
-                    "output_buffer_size (", output_buffer_size,
-                    ") must be greater than or equal to num_threads (",
-                    num_threads, ")."));
+    if (num_threads == kAutoTune) {
+      OP_REQUIRES(ctx,
+                  output_buffer_size > 0 || output_buffer_size == kAutoTune,
+                  errors::InvalidArgument(
+                      "output_buffer_size must be greater than zero, or ",
+                      kAutoTune, " to autotune it."));
+    } else {
+      OP_REQUIRES(ctx, output_buffer_size >= num_threads,
+                  errors::InvalidArgument(
+                      "output_buffer_size (", output_buffer_size,
+                      ") must be greater than or equal to num_threads (",
+                      num_threads, ")."));
+    }
 
     std::unique_ptr<CapturedFunction> captured_func;
     OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
@@ -120,6 +131,7 @@ class ParallelMapDatasetOp : public OpKernel {
         : input_(input),
           num_threads_(num_threads),
           output_buffer_size_(output_buffer_size),
+          autotune_(num_threads == kAutoTune),
           ctx_params_(std::move(ctx_params)),
           output_types_(output_types),
           output_shapes_(output_shapes),
@@ -148,7 +160,8 @@ class ParallelMapDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset),
             iter_ctx_(dataset->ctx_params_),
-            input_impl_(dataset->input_->MakeIterator()) {}
+            input_impl_(dataset->input_->MakeIterator()),
+            parallelism_(dataset->autotune_ ? 1 : dataset->num_threads_) {}
 
       ~Iterator() override {
         // Signal the mapper threads, if any, so that they terminate.
@@ -164,21 +177,30 @@ class ParallelMapDatasetOp : public OpKernel {
           mutex_lock l(output_mu_);
           cancelled_ = true;
           cond_var_.notify_all();
+          if (dataset()->autotune_) {
+            AutotuneBudget::Global()->Release(parallelism_ - 1);
+          }
         }
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(output_mu_);
         TF_RETURN_IF_ERROR(EnsureMapperThreadsStarted(ctx));
 
         while (true) {
           // 1. Wait until the next element in the output queue has
           // been produced, or we are shutting down.
-          while (
-              !cancelled_ && active_threads_ > 0 &&
-              (output_buffer_.empty() || !output_buffer_.front().is_produced)) {
-            cond_var_.wait(l);
+          if (!ReadyToConsume()) {
+            const uint64 wait_start_micros = ctx->env()->NowMicros();
+            while (!ReadyToConsume()) {
+              cond_var_.wait(l);
+            }
+            const int64 wait_usecs =
+                ctx->env()->NowMicros() - wait_start_micros;
+            consumer_wait_usecs_ += wait_usecs;
+            RecordWaitTime(wait_usecs);
           }
 
           if (cancelled_) {
@@ -187,6 +209,7 @@ class ParallelMapDatasetOp : public OpKernel {
           }
 
           if (!output_buffer_.empty() && output_buffer_.front().is_produced) {
+            RecordBufferOccupancy(output_buffer_.size());
             // A new output element is available. Forward the status
             // from computing it, and (if we successfully got an
             // element) the output values.
@@ -196,6 +219,9 @@ class ParallelMapDatasetOp : public OpKernel {
             }
             output_buffer_.pop_front();
             *end_of_sequence = false;
+            if (dataset()->autotune_) {
+              MaybeTune(ctx);
+            }
 
             // Wake one of the producing threads, in case they have been
             // waiting for space in the queue.
@@ -224,6 +250,78 @@ class ParallelMapDatasetOp : public OpKernel {
         std::vector<Tensor> output_value;
       };
 
+      // The number of consumed elements after which an autotuned iterator
+      // reconsiders its parallelism.
+      static constexpr int64 kTuningPeriod = 32;
+      // The fraction of a tuning period that the consumer may spend
+      // waiting before the parallelism is increased.
+      static constexpr double kMaxConsumerWait = 0.1;
+      // The fraction of their time that the active mapper threads may
+      // spend waiting for space in the output buffer before the
+      // parallelism is decreased.
+      static constexpr double kMaxProducerIdle = 0.5;
+
+      bool ReadyToConsume() EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        return cancelled_ || active_threads_ == 0 ||
+               (!output_buffer_.empty() && output_buffer_.front().is_produced);
+      }
+
+      // The maximum number of elements in the output buffer, including
+      // those that are being produced.
+      int64 BufferLimit() EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        if (dataset()->output_buffer_size_ == kAutoTune) {
+          return 2 * parallelism_;
+        }
+        return dataset()->output_buffer_size_;
+      }
+
+      // Adjusts the parallelism of an autotuned iterator at the end of
+      // each tuning period. If the consumer spent a significant part of
+      // the period waiting, a thread is taken from the shared budget. If
+      // instead the active mapper threads were mostly blocked on a full
+      // output buffer, a thread is returned to the budget. Parked threads
+      // are kept, so that the parallelism can be increased again cheaply.
+      void MaybeTune(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        if (++num_consumed_ % kTuningPeriod != 0) {
+          return;
+        }
+        const uint64 now_micros = ctx->env()->NowMicros();
+        const double period_usecs =
+            std::max<uint64>(now_micros - period_start_micros_, 1);
+        const double consumer_wait = consumer_wait_usecs_ / period_usecs;
+        const double producer_idle =
+            producer_idle_usecs_ / (period_usecs * parallelism_);
+        const int64 max_parallelism =
+            dataset()->output_buffer_size_ == kAutoTune
+                ? std::numeric_limits<int32>::max()
+                : dataset()->output_buffer_size_;
+        if (consumer_wait > kMaxConsumerWait) {
+          if (!end_of_input_ && parallelism_ < max_parallelism &&
+              AutotuneBudget::Global()->TryAcquire()) {
+            ++parallelism_;
+            if (parallelism_ > static_cast<int32>(mapper_threads_.size())) {
+              StartMapperThread(ctx, parallelism_ - 1);
+            }
+            cond_var_.notify_all();
+          }
+        } else if (producer_idle > kMaxProducerIdle && parallelism_ > 1) {
+          --parallelism_;
+          AutotuneBudget::Global()->Release(1);
+        }
+        period_start_micros_ = now_micros;
+        consumer_wait_usecs_ = 0;
+        producer_idle_usecs_ = 0;
+      }
+
+      void StartMapperThread(IteratorContext* ctx, int32 index)
+          EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
+        ++active_threads_;
+        mapper_threads_.emplace_back(
+            std::unique_ptr<Thread>(ctx->env()->StartThread(
+                {}, "mapper_thread", [this, index]() { MapperThread(index); })));
+      }
+
       Status EnsureMapperThreadsStarted(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(output_mu_) {
         if (mapper_threads_.empty()) {
@@ -235,17 +333,17 @@ class ParallelMapDatasetOp : public OpKernel {
           f_opts_.step_id = -std::abs(static_cast<int64>(random::New64()));
           f_opts_.runner = iter_ctx_.runner();
 
-          active_threads_ = dataset()->num_threads_;
-          for (int i = 0; i < dataset()->num_threads_; ++i) {
-            mapper_threads_.emplace_back(
-                std::unique_ptr<Thread>(ctx->env()->StartThread(
-                    {}, "mapper_thread", [this]() { MapperThread(); })));
+          period_start_micros_ = ctx->env()->NowMicros();
+          for (int32 i = 0; i < parallelism_; ++i) {
+            StartMapperThread(ctx, i);
           }
         }
         return Status::OK();
       }
 
-      void MapperThread() {
+      // Produces elements while `index` is less than the current
+      // parallelism. Only autotuned iterators park threads.
+      void MapperThread(int32 index) {
         while (true) {
           OutputQueueElement* output_queue_element_;
 
@@ -254,6 +352,23 @@ class ParallelMapDatasetOp : public OpKernel {
 
           Status s;
 
+          // 0. Wait until this thread is active, without holding the
+          // input lock, so that a parked thread does not block the
+          // active ones.
+          {
+            mutex_lock output_lock(output_mu_);
+            while (!cancelled_ && !end_of_input_ && index >= parallelism_) {
+              cond_var_.wait(output_lock);
+            }
+            if (cancelled_ || index >= parallelism_) {
+              --active_threads_;
+              if (active_threads_ == 0) {
+                cond_var_.notify_all();
+              }
+              return;
+            }
+          }
+
           // 1. Acquire a slot in the output queue and a corresponding input
           // element.
           {
@@ -268,9 +383,14 @@ class ParallelMapDatasetOp : public OpKernel {
               // but we deliberately do not release input_mu_ to
               // prevent another MapperThread from overtaking us.
               mutex_lock output_lock(output_mu_);
-              while (!cancelled_ &&
-                     output_buffer_.size() == dataset()->output_buffer_size_) {
-                cond_var_.wait(output_lock);
+              if (!cancelled_ && output_buffer_.size() >= BufferLimit()) {
+                const uint64 wait_start_micros =
+                    iter_ctx_.env()->NowMicros();
+                while (!cancelled_ && output_buffer_.size() >= BufferLimit()) {
+                  cond_var_.wait(output_lock);
+                }
+                producer_idle_usecs_ +=
+                    iter_ctx_.env()->NowMicros() - wait_start_micros;
               }
 
               if (cancelled_) {
@@ -287,9 +407,10 @@ class ParallelMapDatasetOp : public OpKernel {
             if (s.ok() && end_of_sequence) {
               mutex_lock output_lock(output_mu_);
               --active_threads_;
-              if (active_threads_ == 0) {
-                cond_var_.notify_all();
-              }
+              // Wake the consumer if this was the last thread, and any
+              // parked threads so that they terminate.
+              end_of_input_ = true;
+              cond_var_.notify_all();
               return;
             }
           }
@@ -320,13 +441,25 @@ class ParallelMapDatasetOp : public OpKernel {
       std::vector<std::unique_ptr<Thread>> mapper_threads_
           GUARDED_BY(output_mu_);
       bool cancelled_ GUARDED_BY(output_mu_) = false;
-      int32 active_threads_ GUARDED_BY(output_mu_);
+      bool end_of_input_ GUARDED_BY(output_mu_) = false;
+      // The number of mapper threads that have not terminated.
+      int32 active_threads_ GUARDED_BY(output_mu_) = 0;
+      // The number of mapper threads that are producing elements. The
+      // remaining threads (only in autotuned iterators) are parked.
+      int32 parallelism_ GUARDED_BY(output_mu_);
+
+      // Autotuning statistics for the current tuning period.
+      int64 num_consumed_ GUARDED_BY(output_mu_) = 0;
+      uint64 period_start_micros_ GUARDED_BY(output_mu_) = 0;
+      int64 consumer_wait_usecs_ GUARDED_BY(output_mu_) = 0;
+      int64 producer_idle_usecs_ GUARDED_BY(output_mu_) = 0;
     };
 
     const DatasetBase* const input_;
     const NameAttrList func_;
     const int32 num_threads_;
     const int64 output_buffer_size_;
+    const bool autotune_;
     const IteratorContext::Params ctx_params_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
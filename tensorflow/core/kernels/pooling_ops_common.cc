@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/pooling_ops_common.h"
 
+#include <limits>
 #include <vector>
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/kernels/conv_2d.h"
@@ -30,6 +36,91 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Pools the output rows [start, limit) of all batches, flattened as
+// tensor_in_batch * out_height rows. Padded positions are skipped, so average
+// pooling divides by the number of inputs in the window like SpatialAvgPool.
+template <bool kMaxPool>
+void NeonSpatialPoolRows(const float* input, const PoolParameters& params,
+                         int64 start, int64 limit, float* output) {
+  const int depth = params.depth;
+  const int in_rows = params.tensor_in_rows;
+  const int in_cols = params.tensor_in_cols;
+  const float init = kMaxPool ? std::numeric_limits<float>::lowest() : 0.0f;
+  for (int64 row = start; row < limit; ++row) {
+    const int b = row / params.out_height;
+    const int out_y = row % params.out_height;
+    const int y_origin = out_y * params.row_stride - params.pad_rows;
+    const int y_start = std::max(y_origin, 0);
+    const int y_end = std::min(y_origin + params.window_rows, in_rows);
+    const float* batch_input =
+        input + static_cast<int64>(b) * in_rows * in_cols * depth;
+    float* row_output = output + row * params.out_width * depth;
+    for (int out_x = 0; out_x < params.out_width; ++out_x) {
+      const int x_origin = out_x * params.col_stride - params.pad_cols;
+      const int x_start = std::max(x_origin, 0);
+      const int x_end = std::min(x_origin + params.window_cols, in_cols);
+      const float scale =
+          1.0f / std::max((y_end - y_start) * (x_end - x_start), 1);
+      float* out = row_output + out_x * depth;
+      int c = 0;
+#ifdef USE_NEON
+      // Handle 4 channels at a time.
+      for (; c <= depth - 4; c += 4) {
+        float32x4_t acc = vdupq_n_f32(init);
+        for (int y = y_start; y < y_end; ++y) {
+          const float* in = batch_input + (y * in_cols + x_start) * depth + c;
+          for (int x = x_start; x < x_end; ++x, in += depth) {
+            const float32x4_t value = vld1q_f32(in);
+            acc = kMaxPool ? vmaxq_f32(acc, value) : vaddq_f32(acc, value);
+          }
+        }
+        if (!kMaxPool) {
+          acc = vmulq_f32(acc, vdupq_n_f32(scale));
+        }
+        vst1q_f32(out + c, acc);
+      }
+#endif
+      // Handle leftover channels, one by one.
+      for (; c < depth; ++c) {
+        float acc = init;
+        for (int y = y_start; y < y_end; ++y) {
+          const float* in = batch_input + (y * in_cols + x_start) * depth + c;
+          for (int x = x_start; x < x_end; ++x, in += depth) {
+            acc = kMaxPool ? std::max(acc, *in) : acc + *in;
+          }
+        }
+        out[c] = kMaxPool ? acc : acc * scale;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void NeonSpatialPool(OpKernelContext* context, const bool max_pool,
+                     const Tensor& tensor_in, const PoolParameters& params,
+                     Tensor* output) {
+  const float* input = tensor_in.flat<float>().data();
+  float* out = output->flat<float>().data();
+  auto shard = [max_pool, input, &params, out](int64 start, int64 limit) {
+    if (max_pool) {
+      NeonSpatialPoolRows<true>(input, params, start, limit, out);
+    } else {
+      NeonSpatialPoolRows<false>(input, params, start, limit, out);
+    }
+  };
+  // Unlike the Eigen based implementations, which shard over the batch, shard
+  // over the output rows so that single image inference uses all threads.
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(context->device()->tensorflow_cpu_worker_threads());
+  const int64 shard_cost = params.out_width * params.window_rows *
+                           params.window_cols * params.depth;
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        params.tensor_in_batch * params.out_height, shard_cost, shard);
+}
+
 PoolParameters::PoolParameters(OpKernelContext* context,
                                const std::vector<int32>& ksize,
                                const std::vector<int32>& stride,
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/avgpooling_op.h"
 #include "tensorflow/core/kernels/maxpooling_op.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -68,6 +69,18 @@ struct PoolParameters {
   TensorFormat data_format;
 };
 
+// Max or average pools an NHWC float tensor, sharded over the rows of the
+// output. Each output pixel is reduced from its input window with NEON
+// intrinsics when available. Used on CPU when port::TestCPUFeature(port::NEON).
+void NeonSpatialPool(OpKernelContext* context, bool max_pool,
+                     const Tensor& tensor_in, const PoolParameters& params,
+                     Tensor* output);
+
+template <typename T>
+bool UseNeonSpatialPool() {
+  return std::is_same<T, float>::value && port::TestCPUFeature(port::NEON);
+}
+
 // An implementation of MaxPooling (forward).
 template <typename Device, typename T>
 class MaxPoolingOp : public OpKernel {
@@ -159,6 +172,8 @@ class MaxPoolingOp : public OpKernel {
           context->eigen_device<Device>(), output->tensor<T, 4>(),
           tensor_in.tensor<T, 4>(), params.window_rows, params.window_cols,
           params.row_stride, params.col_stride, pt);
+    } else if (UseNeonSpatialPool<T>()) {
+      NeonSpatialPool(context, true, tensor_in, params, output);
     } else {
       typedef Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>
           ConstEigenMatrixMap;
@@ -258,6 +273,10 @@ template <typename Device, typename T>
 void SpatialAvgPool(OpKernelContext* context, Tensor* output,
                     const Tensor& input, const PoolParameters& params,
                     const Padding& padding) {
+  if (UseNeonSpatialPool<T>()) {
+    NeonSpatialPool(context, false, input, params, output);
+    return;
+  }
   typedef Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>
       ConstEigenMatrixMap;
   typedef Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>
@@ -0,0 +1,238 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class PrefetchDatasetOp : public OpKernel {
+ public:
+  explicit PrefetchDatasetOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &input));
+    core::ScopedUnref unref_input(input);
+
+    const Tensor* buffer_size_t;
+    OP_REQUIRES_OK(ctx, ctx->input("buffer_size", &buffer_size_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(buffer_size_t->shape()),
+                errors::InvalidArgument("buffer_size must be a scalar."));
+    const int64 buffer_size = buffer_size_t->flat<int64>()(0);
+    OP_REQUIRES(
+        ctx, buffer_size > 0,
+        errors::InvalidArgument("buffer_size must be greater than zero."));
+
+    // The background thread calls the input iterator outside of any call
+    // to GetNext(), so like ParallelMapDatasetOp we capture the context
+    // information from this kernel.
+    IteratorContext::Params params;
+    params.env = ctx->env();
+    params.resource_manager = ctx->resource_manager();
+    params.runner = *(ctx->runner());
+
+    DatasetBase* dataset = new Dataset(input, buffer_size, std::move(params),
+                                       output_types_, output_shapes_);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    ResourceHandle handle = MakeResourceHandle<DatasetBase>(
+        ctx, ctx->step_container()->name(), name());
+    OP_REQUIRES_OK(ctx, CreateResource(ctx, handle, dataset));
+    output->flat<ResourceHandle>()(0) = handle;
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(const DatasetBase* input, int64 buffer_size,
+            IteratorContext::Params ctx_params,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : input_(input),
+          buffer_size_(buffer_size),
+          ctx_params_(std::move(ctx_params)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator() const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(this));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "PrefetchDatasetOp::Dataset"; }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Dataset* dataset)
+          : DatasetIterator<Dataset>(dataset),
+            iter_ctx_(dataset->ctx_params_),
+            input_impl_(dataset->input_->MakeIterator()) {}
+
+      ~Iterator() override {
+        // Signal the prefetch thread, if any, so that it terminates. We
+        // will then join that thread when we delete
+        // `this->prefetch_thread_`.
+        {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsurePrefetchThreadStarted(ctx);
+
+        // Wait until the next element in the buffer has been produced,
+        // or we are shutting down.
+        while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_) {
+          cond_var_.wait(l);
+        }
+
+        if (cancelled_) {
+          return errors::Cancelled(
+              "PrefetchDatasetOp::Dataset::Iterator::GetNext");
+        }
+
+        if (!buffer_.empty()) {
+          RecordBufferOccupancy(buffer_.size());
+          // Forward the status from producing the element, and (if we
+          // successfully got an element) the output values.
+          Status s = std::move(buffer_.front().status);
+          if (s.ok()) {
+            *out_tensors = std::move(buffer_.front().value);
+          }
+          buffer_.pop_front();
+          *end_of_sequence = false;
+
+          // Wake the prefetch thread, in case it has been waiting for
+          // space in the buffer.
+          cond_var_.notify_all();
+          return s;
+        }
+
+        DCHECK(prefetch_thread_finished_);
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+     private:
+      // A buffer element comprises a status and (if that status is
+      // OK) a vector of tensors.
+      struct BufferElement {
+        // The producer sets `status` if getting the input element fails.
+        Status status;
+        // The buffered data element.
+        std::vector<Tensor> value;
+      };
+
+      void EnsurePrefetchThreadStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!prefetch_thread_) {
+          prefetch_thread_.reset(ctx->env()->StartThread(
+              {}, "prefetch_thread", [this]() { PrefetchThread(); }));
+        }
+      }
+
+      // Fills the buffer from the input iterator until the input is
+      // exhausted or the iterator is destroyed. The input iterator is
+      // only called from this thread, so it needs no lock.
+      void PrefetchThread() {
+        while (true) {
+          // 1. Wait for a slot in the buffer.
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && buffer_.size() == dataset()->buffer_size_) {
+              cond_var_.wait(l);
+            }
+
+            if (cancelled_) {
+              return;
+            }
+          }
+
+          // 2. Read the next element, without holding the lock, so that
+          // the consumer can take the elements already buffered.
+          BufferElement buffer_element;
+          bool end_of_sequence = false;
+          buffer_element.status = input_impl_->GetNext(
+              &iter_ctx_, &buffer_element.value, &end_of_sequence);
+
+          // 3. Signal that the element has been produced.
+          {
+            mutex_lock l(mu_);
+            if (buffer_element.status.ok() && end_of_sequence) {
+              prefetch_thread_finished_ = true;
+              cond_var_.notify_all();
+              return;
+            }
+            buffer_.push_back(std::move(buffer_element));
+            cond_var_.notify_all();
+          }
+        }
+      }
+
+      IteratorContext iter_ctx_;
+      const std::unique_ptr<IteratorBase> input_impl_;
+      mutex mu_;
+      condition_variable cond_var_;
+      std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+      std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(mu_);
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      bool prefetch_thread_finished_ GUARDED_BY(mu_) = false;
+    };
+
+    const DatasetBase* const input_;
+    const int64 buffer_size_;
+    const IteratorContext::Params ctx_params_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("PrefetchDataset").Device(DEVICE_CPU),
+                        PrefetchDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -17,6 +17,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
 #include "public/gemmlowp.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -63,6 +67,95 @@ void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
   TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
 }
 
+// Describes the output stage of QuantizedMatMulWithBiasAndRequantize, which
+// maps a 32-bit accumulator x of column j to the eight-bit value
+//   clamp(round((x + bias[j]) * multiplier) + offset, clamp_min, 255).
+struct RequantizeOutputStage {
+  std::vector<int32> bias;  // In units of the accumulator, one per column.
+  double multiplier;
+  int32 offset;
+  int32 clamp_min;
+  // The multiplier as a fixed point value in [2^30, 2^31) and a right shift,
+  // as expected by gemmlowp.  Only valid if has_fixedpoint_multiplier.
+  bool has_fixedpoint_multiplier;
+  int32 fixedpoint_multiplier;
+  int right_shift;
+};
+
+// Splits a multiplier in (0, 1) into a fixed point multiplier and a right
+// shift.  Returns false if the multiplier can't be represented that way.
+bool QuantizeOutputMultiplier(double multiplier, int32* fixedpoint_multiplier,
+                              int* right_shift) {
+  if (!(multiplier > 0.0 && multiplier < 1.0)) {
+    return false;
+  }
+  int exponent;
+  const double fraction = std::frexp(multiplier, &exponent);
+  int64 fixedpoint = static_cast<int64>(std::round(fraction * (1ll << 31)));
+  if (fixedpoint == (1ll << 31)) {
+    fixedpoint /= 2;
+    ++exponent;
+  }
+  if (-exponent > 31) {
+    return false;
+  }
+  *fixedpoint_multiplier = static_cast<int32>(fixedpoint);
+  *right_shift = -exponent;
+  return true;
+}
+
+// Like GemmlowpMultiply, but applies the bias, requantization and clamping of
+// `stage` in gemmlowp's output pipeline, so that the 32-bit results are never
+// written to memory.
+template <bool TransposeA, bool TransposeB>
+void GemmlowpMultiplyAndRequantize(OpKernelContext* op_context,
+                                   const quint8* a_data, const quint8* b_data,
+                                   quint8* c_data, int m, int n, int k,
+                                   int offset_a, int offset_b, int lda, int ldb,
+                                   int ldc,
+                                   const RequantizeOutputStage& stage) {
+  const uint8* a_data_as_uint8 = &(a_data->value);
+  const uint8* b_data_as_uint8 = &(b_data->value);
+  uint8* c_data_as_uint8 = &(c_data->value);
+  static const gemmlowp::MapOrder LhsOrder =
+      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  static const gemmlowp::MapOrder RhsOrder =
+      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data_as_uint8, m, k,
+                                                        lda);
+  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data_as_uint8, k, n,
+                                                        ldb);
+  gemmlowp::MatrixMap<std::uint8_t, gemmlowp::MapOrder::RowMajor> result(
+      c_data_as_uint8, m, n, ldc);
+
+  typedef gemmlowp::VectorMap<const std::int32_t, gemmlowp::VectorShape::Row>
+      BiasVector;
+  gemmlowp::OutputStageBiasAddition<BiasVector> bias_addition_stage;
+  bias_addition_stage.bias_vector = BiasVector(stage.bias.data(), n);
+  gemmlowp::OutputStageQuantizeDownInt32ToUint8ScaleByFixedPoint
+      quantize_down_stage;
+  quantize_down_stage.result_fixedpoint_multiplier =
+      stage.fixedpoint_multiplier;
+  quantize_down_stage.result_shift = stage.right_shift;
+  quantize_down_stage.result_offset_after_shift = stage.offset;
+  gemmlowp::OutputStageClamp clamp_stage;
+  clamp_stage.min = stage.clamp_min;
+  clamp_stage.max = 255;
+  gemmlowp::OutputStageSaturatingCastToUint8 saturating_cast_stage;
+  const auto output_pipeline =
+      std::make_tuple(bias_addition_stage, quantize_down_stage, clamp_stage,
+                      saturating_cast_stage);
+
+  auto& worker_threads =
+      *(op_context->device()->tensorflow_cpu_worker_threads());
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, -offset_a, -offset_b, output_pipeline);
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_uint8, m * n * sizeof(uint8));
+}
+
 template <class T1, class T2, class Toutput>
 class QuantizedMatMulOp : public OpKernel {
  public:
@@ -198,4 +291,173 @@ REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .TypeConstraint<qint32>("Toutput"),
                         QuantizedMatMulOp<quint8, quint8, qint32>);
 
+class QuantizedMatMulWithBiasAndRequantizeOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulWithBiasAndRequantizeOp(
+      OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    OP_REQUIRES_OK(context, context->GetAttr("fuse_relu", &fuse_relu_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+    const float min_a = context->input(3).flat<float>()(0);
+    const float max_a = context->input(4).flat<float>()(0);
+    const float min_b = context->input(5).flat<float>()(0);
+    const float max_b = context->input(6).flat<float>()(0);
+    const float min_output = context->input(7).flat<float>()(0);
+    const float max_output = context->input(8).flat<float>()(0);
+
+    OP_REQUIRES(context, (max_a > min_a),
+                errors::InvalidArgument("max_a must be larger than min_a."));
+    OP_REQUIRES(context, (max_b > min_b),
+                errors::InvalidArgument("max_b must be larger than min_b."));
+    OP_REQUIRES(context, min_output <= 0.0f,
+                errors::InvalidArgument(
+                    "requested_output_min must be <= 0, but got ", min_output));
+    OP_REQUIRES(context, max_output > min_output,
+                errors::InvalidArgument(
+                    "requested_output_max must be larger than "
+                    "requested_output_min, but got ",
+                    max_output, " and ", min_output));
+    const int32 offset_a =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_a, max_a);
+    const int32 offset_b =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_b, max_b);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int a_inner_dim = transpose_a_ ? 0 : 1;
+    const int b_inner_dim = transpose_b_ ? 1 : 0;
+    OP_REQUIRES(context, a.dim_size(a_inner_dim) == b.dim_size(b_inner_dim),
+                errors::InvalidArgument("Matrix size-compatible: In[0]: ",
+                                        a.shape().DebugString(), ", In[1]: ",
+                                        b.shape().DebugString()));
+
+    const int m = a.dim_size(1 - a_inner_dim);
+    const int n = b.dim_size(1 - b_inner_dim);
+    const int k = a.dim_size(a_inner_dim);
+    const int lda = a.dim_size(1);
+    const int ldb = b.dim_size(1);
+    const int ldc = n;
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(bias.shape()) &&
+                    (bias.NumElements() == 0 || bias.NumElements() == n),
+                errors::InvalidArgument(
+                    "bias must be empty or a vector of size ", n, ", got ",
+                    bias.shape().DebugString()));
+
+    Tensor* c = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &c));
+    Tensor* c_min = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, {}, &c_min));
+    c_min->flat<float>()(0) = min_output;
+    Tensor* c_max = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, {}, &c_max));
+    c_max->flat<float>()(0) = max_output;
+    if (c->NumElements() == 0) {
+      return;
+    }
+
+    // The accumulator of a product of two eight-bit values represents
+    // accumulator_level in float, see QuantizationRangeForMultiplication.
+    // Output levels follow FloatToQuantized for the requested range.
+    const double accumulator_level =
+        static_cast<double>(FloatForOneQuantizedLevel<quint8>(min_a, max_a)) *
+        FloatForOneQuantizedLevel<quint8>(min_b, max_b);
+    const double output_scale = 255.0 / (max_output - min_output);
+    RequantizeOutputStage stage;
+    stage.multiplier = accumulator_level * output_scale;
+    stage.offset = static_cast<int32>(-std::round(min_output * output_scale));
+    stage.clamp_min =
+        fuse_relu_ ? std::max(0, std::min(255, stage.offset)) : 0;
+    stage.bias.assign(n, 0);
+    const auto bias_flat = bias.flat<float>();
+    for (int64 j = 0; j < bias.NumElements(); ++j) {
+      const double scaled_bias = std::round(bias_flat(j) / accumulator_level);
+      stage.bias[j] = static_cast<int32>(std::max<double>(
+          std::numeric_limits<int32>::min(),
+          std::min<double>(std::numeric_limits<int32>::max(), scaled_bias)));
+    }
+    stage.has_fixedpoint_multiplier = QuantizeOutputMultiplier(
+        stage.multiplier, &stage.fixedpoint_multiplier, &stage.right_shift);
+
+    const quint8* a_data = a.flat<quint8>().data();
+    const quint8* b_data = b.flat<quint8>().data();
+    quint8* c_data = c->flat<quint8>().data();
+
+    if (!meta::IsSupportedAndEnabled() && stage.has_fixedpoint_multiplier) {
+      if (transpose_a_) {
+        if (transpose_b_) {
+          GemmlowpMultiplyAndRequantize<true, true>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, stage);
+        } else {
+          GemmlowpMultiplyAndRequantize<true, false>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, stage);
+        }
+      } else {
+        if (transpose_b_) {
+          GemmlowpMultiplyAndRequantize<false, true>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, stage);
+        } else {
+          GemmlowpMultiplyAndRequantize<false, false>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, stage);
+        }
+      }
+      return;
+    }
+
+    // Otherwise compute the 32-bit results first, with the meta kernels on
+    // ARM, or with the reference GEMM in the unusual case that an output level
+    // is finer than an accumulator level, and requantize them in a second
+    // pass.
+    Tensor accumulators;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_QINT32, {m, n}, &accumulators));
+    qint32* acc_data = accumulators.flat<qint32>().data();
+    if (meta::IsSupportedAndEnabled()) {
+      meta::QuantizedGemm(context, transpose_a_, transpose_b_, a_data, b_data,
+                          acc_data, m, n, k, -offset_a, -offset_b, lda, ldb,
+                          ldc);
+    } else {
+      ReferenceGemm<quint8, quint8, qint32>(
+          transpose_a_, transpose_b_, false, m, n, k, a_data, offset_a, lda,
+          b_data, offset_b, ldb, acc_data, 0, 0, 1, ldc);
+    }
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        const int64 acc =
+            static_cast<int64>(acc_data[i * ldc + j]) + stage.bias[j];
+        int64 value = static_cast<int64>(std::round(acc * stage.multiplier)) +
+                      stage.offset;
+        value = std::max<int64>(value, stage.clamp_min);
+        value = std::min<int64>(value, 255);
+        c_data[i * ldc + j] = static_cast<quint8>(static_cast<int32>(value));
+      }
+    }
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  bool fuse_relu_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedMatMulWithBiasAndRequantize")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<quint8>("T1")
+                            .TypeConstraint<quint8>("T2")
+                            .TypeConstraint<quint8>("Toutput"),
+                        QuantizedMatMulWithBiasAndRequantizeOp);
+
 }  // namespace tensorflow
@@ -37,6 +37,81 @@ namespace tensorflow {
 
 class QuantizedMatMulTest : public OpsTestBase {
  protected:
+  // Compares QuantizedMatMulWithBiasAndRequantize against the same
+  // computation done in float on the dequantized inputs.
+  void TestWithBiasAndRequantize(bool transpose_a, bool transpose_b,
+                                 bool use_bias, bool fuse_relu) {
+    const int m = 3;
+    const int k = 5;
+    const int n = 4;
+    const float min_a = -1.0f;
+    const float max_a = 2.0f;
+    const float min_b = -0.5f;
+    const float max_b = 0.5f;
+    const float min_output = -6.0f;
+    const float max_output = 6.0f;
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op",
+                                "QuantizedMatMulWithBiasAndRequantize")
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_a", transpose_a)
+                     .Attr("transpose_b", transpose_b)
+                     .Attr("fuse_relu", fuse_relu)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    std::vector<quint8> a_data(m * k);
+    for (int i = 0; i < m * k; ++i) a_data[i] = (i * 37 + 11) % 256;
+    std::vector<quint8> b_data(k * n);
+    for (int i = 0; i < k * n; ++i) b_data[i] = (i * 53 + 7) % 256;
+    std::vector<float> bias_data;
+    if (use_bias) bias_data = {0.5f, -1.0f, 0.25f, 0.0f};
+    AddInputFromArray<quint8>(transpose_a ? TensorShape({k, m})
+                                          : TensorShape({m, k}),
+                              a_data);
+    AddInputFromArray<quint8>(transpose_b ? TensorShape({n, k})
+                                          : TensorShape({k, n}),
+                              b_data);
+    AddInputFromArray<float>(
+        TensorShape({static_cast<int64>(bias_data.size())}), bias_data);
+    AddInputFromArray<float>(TensorShape({1}), {min_a});
+    AddInputFromArray<float>(TensorShape({1}), {max_a});
+    AddInputFromArray<float>(TensorShape({1}), {min_b});
+    AddInputFromArray<float>(TensorShape({1}), {max_b});
+    AddInputFromArray<float>(TensorShape({1}), {min_output});
+    AddInputFromArray<float>(TensorShape({1}), {max_output});
+    TF_ASSERT_OK(RunOpKernel());
+
+    const Tensor& output = *GetOutput(0);
+    ASSERT_EQ(TensorShape({m, n}), output.shape());
+    const auto output_matrix = output.matrix<quint8>();
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        float expected = use_bias ? bias_data[j] : 0.0f;
+        for (int l = 0; l < k; ++l) {
+          const quint8 a = transpose_a ? a_data[l * m + i] : a_data[i * k + l];
+          const quint8 b = transpose_b ? b_data[j * k + l] : b_data[l * n + j];
+          expected += QuantizedToFloat(a, min_a, max_a) *
+                      QuantizedToFloat(b, min_b, max_b);
+        }
+        if (fuse_relu) expected = std::max(expected, 0.0f);
+        const int expected_quantized = static_cast<int>(
+            FloatToQuantized<quint8>(expected, min_output, max_output));
+        EXPECT_NEAR(expected_quantized, static_cast<int>(output_matrix(i, j)),
+                    1)
+            << "at (" << i << ", " << j << ")";
+      }
+    }
+    EXPECT_EQ(min_output, GetOutput(1)->flat<float>()(0));
+    EXPECT_EQ(max_output, GetOutput(2)->flat<float>()(0));
+  }
 };
 
 // Runs two small matrices through the operator, and leaves all the parameters
@@ -334,4 +409,20 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+TEST_F(QuantizedMatMulTest, WithBiasAndRequantize) {
+  TestWithBiasAndRequantize(false, false, true, false);
+}
+
+TEST_F(QuantizedMatMulTest, WithBiasAndRequantize_NoBias) {
+  TestWithBiasAndRequantize(false, false, false, false);
+}
+
+TEST_F(QuantizedMatMulTest, WithBiasAndRequantize_Relu) {
+  TestWithBiasAndRequantize(false, false, true, true);
+}
+
+TEST_F(QuantizedMatMulTest, WithBiasAndRequantize_Transposed) {
+  TestWithBiasAndRequantize(true, true, true, true);
+}
+
 }  // namespace tensorflow
@@ -148,6 +148,45 @@ struct FillPhiloxRandomTask<Distribution, true> {
   }
 };
 
+// Specialization for uniform floats, e.g. for dropout. Generates the raw
+// samples in chunks with PhiloxRandom::Fill and converts them in a separate
+// loop, so that both can be vectorized. The values are the same as with the
+// generic version above.
+template <>
+struct FillPhiloxRandomTask<random::UniformDistribution<PhiloxRandom, float>,
+                            false> {
+  typedef random::UniformDistribution<PhiloxRandom, float> Distribution;
+  static void Run(random::PhiloxRandom gen, float* data, int64 size,
+                  int64 start_group, int64 limit_group, Distribution dist) {
+    const int kGroupSize = Distribution::kResultElementCount;
+    const int64 kChunkGroups = 64;
+    uint32 bits[kChunkGroups * kGroupSize];
+
+    gen.Skip(start_group);
+    int64 offset = start_group * kGroupSize;
+
+    // First fill all the full-size groups
+    int64 limit_group_full = std::min(limit_group, size / kGroupSize);
+    for (int64 index = start_group; index < limit_group_full;
+         index += kChunkGroups) {
+      const int64 groups = std::min(kChunkGroups, limit_group_full - index);
+      gen.Fill(bits, groups);
+      const int64 count = groups * kGroupSize;
+      for (int64 i = 0; i < count; ++i) {
+        data[offset + i] = random::Uint32ToFloat(bits[i]);
+      }
+      offset += count;
+    }
+
+    // If there are any remaining elements that need to be filled, process them
+    if (limit_group_full < limit_group) {
+      int64 remaining_size = size - limit_group_full * kGroupSize;
+      auto samples = dist(&gen);
+      std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
+    }
+  }
+};
+
 // Partial specialization for CPU to fill the entire region with randoms
 // It splits the work into several tasks and run them in parallel
 template <class Distribution>
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -114,8 +115,9 @@ class TextLineDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
           // We are currently processing a file, so try to read the next line.
@@ -231,8 +233,18 @@ class FixedLengthRecordDatasetOp : public OpKernel {
                 errors::InvalidArgument("`footer_bytes` must be a scalar."));
     const int64 footer_bytes = footer_bytes_tensor->scalar<int64>()();
 
-    DatasetBase* dataset = new Dataset(std::move(filenames), header_bytes,
-                                       record_bytes, footer_bytes);
+    const Tensor* buffer_size_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("buffer_size", &buffer_size_tensor));
+    OP_REQUIRES(ctx, buffer_size_tensor->dims() == 0,
+                errors::InvalidArgument("`buffer_size` must be a scalar."));
+    const int64 buffer_size = buffer_size_tensor->scalar<int64>()();
+    OP_REQUIRES(ctx, buffer_size >= 0,
+                errors::InvalidArgument(
+                    "`buffer_size` must be greater than or equal to zero."));
+
+    DatasetBase* dataset =
+        new Dataset(std::move(filenames), header_bytes, record_bytes,
+                    footer_bytes, buffer_size);
     Tensor* output = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
     ResourceHandle handle = MakeResourceHandle<DatasetBase>(
@@ -244,12 +256,13 @@ class FixedLengthRecordDatasetOp : public OpKernel {
  private:
   class Dataset : public DatasetBase {
    public:
-    explicit Dataset(std::vector<string> filenames, int64 header_bytes,
-                     int64 record_bytes, int64 footer_bytes)
+    Dataset(std::vector<string> filenames, int64 header_bytes,
+            int64 record_bytes, int64 footer_bytes, int64 buffer_size)
         : filenames_(std::move(filenames)),
           header_bytes_(header_bytes),
           record_bytes_(record_bytes),
-          footer_bytes_(footer_bytes) {}
+          footer_bytes_(footer_bytes),
+          buffer_size_(buffer_size) {}
 
     std::unique_ptr<IteratorBase> MakeIterator() const override {
       return std::unique_ptr<IteratorBase>(new Iterator(this));
@@ -276,21 +289,20 @@ class FixedLengthRecordDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
           // We are currently processing a file, so try to read the next record.
-          if (input_buffer_) {
-            const int64 current_pos = input_buffer_->Tell();
+          if (input_stream_) {
+            const int64 current_pos = input_stream_->Tell();
             DCHECK_GE(file_pos_limit_, 0);
             if (current_pos < file_pos_limit_) {
-              string record;
-              TF_RETURN_IF_ERROR(
-                  input_buffer_->ReadNBytes(dataset()->record_bytes_, &record));
-              // Produce the record as output.
+              // Read the record directly into the output tensor.
               Tensor record_tensor(cpu_allocator(), DT_STRING, {});
-              record_tensor.scalar<string>()() = record;
+              TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(
+                  dataset()->record_bytes_, &record_tensor.scalar<string>()()));
               out_tensors->emplace_back(std::move(record_tensor));
               *end_of_sequence = false;
               return Status::OK();
@@ -298,7 +310,7 @@ class FixedLengthRecordDatasetOp : public OpKernel {
 
             // We have reached the end of the current file, so maybe
             // move on to next file.
-            input_buffer_.reset();
+            input_stream_.reset();
             file_.reset();
             ++current_file_index_;
           }
@@ -316,29 +328,40 @@ class FixedLengthRecordDatasetOp : public OpKernel {
           file_pos_limit_ = file_size - dataset()->footer_bytes_;
           TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
               dataset()->filenames_[current_file_index_], &file_));
-          input_buffer_.reset(new io::InputBuffer(file_.get(), kBufferSize));
+          if (dataset()->buffer_size_ > 0) {
+            // Large sequential reads, issued ahead of the current record so
+            // that they overlap with the consumption of the records.
+            input_stream_.reset(new io::ReadaheadInputStream(
+                file_.get(), dataset()->buffer_size_, kReadaheadNumBuffers));
+          } else {
+            input_stream_.reset(
+                new io::BufferedInputStream(file_.get(), kBufferSize));
+          }
           TF_RETURN_IF_ERROR(
-              input_buffer_->SkipNBytes(dataset()->header_bytes_));
+              input_stream_->SkipNBytes(dataset()->header_bytes_));
         } while (true);
       }
 
      private:
-      // TODO(mrry): Make this configurable via an attr on the dataset op?
-      // Or maybe via a data input?
+      // The buffer used when read-ahead is disabled.
       enum { kBufferSize = 256 << 10 /* 256 kB */ };
 
       mutex mu_;
       size_t current_file_index_ GUARDED_BY(mu_) = 0;
       std::unique_ptr<RandomAccessFile> file_
-          GUARDED_BY(mu_);  // must outlive input_buffer_
-      std::unique_ptr<io::InputBuffer> input_buffer_ GUARDED_BY(mu_);
+          GUARDED_BY(mu_);  // must outlive input_stream_
+      std::unique_ptr<io::InputStreamInterface> input_stream_ GUARDED_BY(mu_);
       int64 file_pos_limit_ GUARDED_BY(mu_) = -1;
     };
 
+    // The number of buffers that are read ahead of the current record.
+    static constexpr int kReadaheadNumBuffers = 4;
+
     const std::vector<string> filenames_;
     const int64 header_bytes_;
     const int64 record_bytes_;
     const int64 footer_bytes_;
+    const int64 buffer_size_;
   };
 };
 
@@ -371,7 +394,17 @@ class TFRecordDatasetOp : public OpKernel {
     const string& compression_type =
         compression_type_tensor->scalar<string>()();
 
-    DatasetBase* dataset = new Dataset(std::move(filenames), compression_type);
+    const Tensor* buffer_size_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("buffer_size", &buffer_size_tensor));
+    OP_REQUIRES(ctx, buffer_size_tensor->dims() == 0,
+                errors::InvalidArgument("`buffer_size` must be a scalar."));
+    const int64 buffer_size = buffer_size_tensor->scalar<int64>()();
+    OP_REQUIRES(ctx, buffer_size >= 0,
+                errors::InvalidArgument(
+                    "`buffer_size` must be greater than or equal to zero."));
+
+    DatasetBase* dataset =
+        new Dataset(std::move(filenames), compression_type, buffer_size);
     Tensor* output = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
     ResourceHandle handle = MakeResourceHandle<DatasetBase>(
@@ -383,11 +416,14 @@ class TFRecordDatasetOp : public OpKernel {
  private:
   class Dataset : public DatasetBase {
    public:
-    explicit Dataset(std::vector<string> filenames,
-                     const string& compression_type)
+    Dataset(std::vector<string> filenames, const string& compression_type,
+            int64 buffer_size)
         : filenames_(std::move(filenames)),
           options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-              compression_type)) {}
+              compression_type)) {
+      options_.readahead_buffer_size = buffer_size;
+      options_.readahead_num_buffers = kReadaheadNumBuffers;
+    }
 
     std::unique_ptr<IteratorBase> MakeIterator() const override {
       return std::unique_ptr<IteratorBase>(new Iterator(this));
@@ -412,8 +448,9 @@ class TFRecordDatasetOp : public OpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
           // We are currently processing a file, so try to read the next record.
@@ -463,6 +500,10 @@ class TFRecordDatasetOp : public OpKernel {
       std::unique_ptr<io::RecordReader> reader_ GUARDED_BY(mu_);
     };
 
+    // The number of buffers that are read ahead of the current record,
+    // which hides the latency of remote file systems.
+    static constexpr int kReadaheadNumBuffers = 4;
+
     const std::vector<string> filenames_;
     io::RecordReaderOptions options_;
   };
@@ -20,14 +20,16 @@ limitations under the License.
 #include "tensorflow/core/kernels/i_remote_fused_graph_executor.h"
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
-class RemoteFusedGraphExecuteOp : public OpKernel {
+class RemoteFusedGraphExecuteOp : public AsyncOpKernel {
  public:
   explicit RemoteFusedGraphExecuteOp(OpKernelConstruction* const ctx)
-      : OpKernel(ctx), execute_info_() {
+      : AsyncOpKernel(ctx), execute_info_() {
     string serialized_proto;
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(RemoteFusedGraphExecuteUtils::
@@ -57,10 +59,20 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
 
       // 2. Setup graph in remote processor
       remote_fused_graph_executor_->SetupGraph();
+
+      // Executions run one at a time on their own thread when the executor
+      // double buffers its inputs, so that the inputs of the next call are
+      // filled while the current call executes.
+      if (remote_fused_graph_executor_->EnableInputDoubleBuffering()) {
+        execute_thread_.reset(new thread::ThreadPool(
+            ctx->env(), "remote_fused_graph_execute", 1));
+      }
     }
   }
 
   ~RemoteFusedGraphExecuteOp() final {
+    // Wait for the pending executions.
+    execute_thread_.reset();
     if (remote_fused_graph_executor_) {
       // 6. Teardown graph in remote processor
       remote_fused_graph_executor_->TeardownGraph();
@@ -70,7 +82,7 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
   }
 
-  void Compute(OpKernelContext* const ctx) final {
+  void ComputeAsync(OpKernelContext* const ctx, DoneCallback done) final {
     CHECK(ctx != nullptr);
     const int input_count = ctx->num_inputs();
     const int graph_input_count = execute_info_.graph_input_node_name_size();
@@ -80,6 +92,45 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
         << ", gt input count = " << execute_info_.graph_input_node_name_size()
         << ", type count = " << input_types_.size();
 
+    if (!execute_thread_) {
+      FillInputs(ctx);
+      // 4. Execute graph in remote processor
+      if (remote_fused_graph_executor_) {
+        remote_fused_graph_executor_->ExecuteGraph();
+      }
+      ReadOutputs(ctx);
+      done();
+      return;
+    }
+
+    {
+      mutex_lock l(mu_);
+      // Only the inputs of one call can wait behind the running execution.
+      while (inputs_pending_) {
+        inputs_sent_.wait(l);
+      }
+      inputs_pending_ = true;
+    }
+    FillInputs(ctx);
+    execute_thread_->Schedule([this, ctx, done]() {
+      remote_fused_graph_executor_->SendInputs();
+      {
+        mutex_lock l(mu_);
+        inputs_pending_ = false;
+      }
+      inputs_sent_.notify_one();
+      // 4. Execute graph in remote processor
+      remote_fused_graph_executor_->ExecuteGraph();
+      ReadOutputs(ctx);
+      done();
+    });
+  }
+
+  bool IsExpensive() final { return true; }
+
+ private:
+  void FillInputs(OpKernelContext* const ctx) {
+    const int graph_input_count = execute_info_.graph_input_node_name_size();
     // 3. Send first data type inputs into remote processor
     for (int i = 0; i < graph_input_count; ++i) {
       const Tensor& input_tensor = ctx->input(i);
@@ -89,12 +140,9 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
                                                     input_tensor);
       }
     }
+  }
 
-    // 4. Execute graph in remote processor
-    if (remote_fused_graph_executor_) {
-      remote_fused_graph_executor_->ExecuteGraph();
-    }
-
+  void ReadOutputs(OpKernelContext* const ctx) {
     // 5. Load outputs from remote processor
     const int output_count = ctx->num_outputs();
     CHECK(output_count == execute_info_.graph_output_node_name_size() &&
@@ -119,13 +167,16 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
   }
 
-  bool IsExpensive() final { return true; }
-
- private:
   RemoteFusedGraphExecuteInfo execute_info_;
   std::unique_ptr<IRemoteFusedGraphExecutor> remote_fused_graph_executor_;
   DataTypeVector input_types_;
   DataTypeVector output_types_;
+  std::unique_ptr<thread::ThreadPool> execute_thread_;
+
+  mutex mu_;
+  condition_variable inputs_sent_;
+  // Whether inputs were filled for an execution which hasn't sent them yet.
+  bool inputs_pending_ GUARDED_BY(mu_) = false;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RemoteFusedGraphExecuteOp);
 };
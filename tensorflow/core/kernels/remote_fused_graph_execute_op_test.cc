@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/remote_fused_graph_execute_op_test_utils.h"
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -78,6 +79,8 @@ constexpr const char* const REMOTE_FUSED_EXECUTE_OP_NODE_NAME =
     "remote_fused_execute_op";
 constexpr const char* const REMOTE_FUSED_EXECUTOR_NAME =
     "build_test_remote_fused_graph_executor";
+constexpr const char* const DOUBLE_BUFFERED_REMOTE_FUSED_EXECUTOR_NAME =
+    "build_test_double_buffered_remote_fused_graph_executor";
 
 constexpr float NODE_A_VAL = 2.0f;
 constexpr float NODE_A_VAL2 = 10.0f;
@@ -126,9 +129,9 @@ static Output BuildRemoteFusedGraphExecuteOp(
 }
 
 static RemoteFusedGraphExecuteInfo BuildRemoteFusedGraphExecuteInfo(
-    const GraphDef& original_graph) {
+    const GraphDef& original_graph, const string& executor_name) {
   RemoteFusedGraphExecuteInfo execute_info;
-  execute_info.set_executor_name(REMOTE_FUSED_EXECUTOR_NAME);
+  execute_info.set_executor_name(executor_name);
 
   // In this example, simply copy all nodes. Basically, you don't need to add
   // unused node for inference.
@@ -162,6 +165,8 @@ static RemoteFusedGraphExecuteInfo BuildRemoteFusedGraphExecuteInfo(
 // 1. Create TestRemoteFusedGraphExecutor to execute your fused graph
 class TestRemoteFusedGraphExecutor final : public IRemoteFusedGraphExecutor {
  public:
+  explicit TestRemoteFusedGraphExecutor(const bool double_buffer_inputs)
+      : double_buffer_inputs_(double_buffer_inputs) {}
   int GetVersion() final { return 1; }
   bool Init(const RemoteFusedGraphExecuteInfo& info) final {
     info_ = &info;
@@ -191,15 +196,26 @@ class TestRemoteFusedGraphExecutor final : public IRemoteFusedGraphExecutor {
     const float b_val = *const_tensor.scalar<float>().data();
     Tensor output_a_plus_b(DT_FLOAT, {});
     output_a_plus_b.flat<float>().data()[0] = input_val + b_val;
-    output_tensor_buf_.emplace(info_->graph_output_node_name(0),
-                               output_a_plus_b);
+    output_tensor_buf_[info_->graph_output_node_name(0)] = output_a_plus_b;
     return true;
   }
 
   bool TeardownGraph() final { return true; }
 
   bool FillInputNode(const string& node_name, const Tensor& tensor) final {
-    input_tensor_cache_[node_name] = tensor;
+    if (double_buffer_inputs_) {
+      next_input_tensor_cache_[node_name] = tensor;
+    } else {
+      input_tensor_cache_[node_name] = tensor;
+    }
+    return true;
+  }
+
+  bool EnableInputDoubleBuffering() final { return double_buffer_inputs_; }
+
+  bool SendInputs() final {
+    CHECK(double_buffer_inputs_);
+    input_tensor_cache_.swap(next_input_tensor_cache_);
     return true;
   }
 
@@ -215,8 +231,10 @@ class TestRemoteFusedGraphExecutor final : public IRemoteFusedGraphExecutor {
   }
 
  private:
+  const bool double_buffer_inputs_;
   const RemoteFusedGraphExecuteInfo* info_;
   std::unordered_map<string, Tensor> input_tensor_cache_;
+  std::unordered_map<string, Tensor> next_input_tensor_cache_;
   std::unordered_map<string, const NodeDef*> node_def_map_;
   std::unordered_map<string, Tensor> output_tensor_buf_;
 };
@@ -225,7 +243,13 @@ class TestRemoteFusedGraphExecutor final : public IRemoteFusedGraphExecutor {
 namespace remote_fused_graph_execute_op {
 Status BuildRemoteFusedGraphExecutor(
     std::unique_ptr<IRemoteFusedGraphExecutor>* executor) {
-  executor->reset(new TestRemoteFusedGraphExecutor());
+  executor->reset(new TestRemoteFusedGraphExecutor(false));
+  return Status::OK();
+}
+
+Status BuildDoubleBufferedRemoteFusedGraphExecutor(
+    std::unique_ptr<IRemoteFusedGraphExecutor>* executor) {
+  executor->reset(new TestRemoteFusedGraphExecutor(true));
   return Status::OK();
 }
 
@@ -235,17 +259,22 @@ Status BuildRemoteFusedGraphExecutor(
 static RemoteFusedGraphExecuteUtils::ExecutorBuildRegistrar
     k_test_remote_fused_graph_executor_build(REMOTE_FUSED_EXECUTOR_NAME,
                                              BuildRemoteFusedGraphExecutor);
+static RemoteFusedGraphExecuteUtils::ExecutorBuildRegistrar
+    k_test_double_buffered_remote_fused_graph_executor_build(
+        DOUBLE_BUFFERED_REMOTE_FUSED_EXECUTOR_NAME,
+        BuildDoubleBufferedRemoteFusedGraphExecutor);
 }  // namespace remote_fused_graph_execute_op
 
 // 3. Create Graph transform function to fuse your graph
 static Status RewriteGraphToFusedGraph(const GraphDef& original_graph,
+                                       const string& executor_name,
                                        GraphDef* fused_graph) {
   Scope root = Scope::NewRootScope();
   std::vector<Output> output_list;
   const Output op_a = BuildPlaceHolderOp(NAME_A, DT_FLOAT, {}, &root);
   output_list.emplace_back(op_a);
   const RemoteFusedGraphExecuteInfo execute_info =
-      BuildRemoteFusedGraphExecuteInfo(original_graph);
+      BuildRemoteFusedGraphExecuteInfo(original_graph, executor_name);
   BuildRemoteFusedGraphExecuteOp(REMOTE_FUSED_EXECUTE_OP_NODE_NAME, output_list,
                                  1, execute_info, &root);
   GraphDef fused_graph_def;
@@ -275,7 +304,8 @@ TEST(RemoteFusedExecuteGraphOp, EndToEndTest) {
 
   // 5.2 Fuse graph
   GraphDef fused_graph;
-  TF_ASSERT_OK(RewriteGraphToFusedGraph(original_graph, &fused_graph));
+  TF_ASSERT_OK(RewriteGraphToFusedGraph(
+      original_graph, REMOTE_FUSED_EXECUTOR_NAME, &fused_graph));
 
   // 5.3 Setup session
   std::vector<Tensor> output_tensors;
@@ -310,6 +340,43 @@ TEST(RemoteFusedExecuteGraphOp, EndToEndTest) {
               FLOAT_VALUE_TOLERANCE);
 }
 
+TEST(RemoteFusedExecuteGraphOp, DoubleBufferedInputs) {
+  GraphDef original_graph;
+  TF_ASSERT_OK(RemoteFusedGraphExecuteOpTestUtils::BuildAddGraph(
+      NAME_A, NODE_A_VAL, NAME_B, NODE_B_VAL, NAME_A_PLUS_B, &original_graph));
+  GraphDef fused_graph;
+  TF_ASSERT_OK(RewriteGraphToFusedGraph(
+      original_graph, DOUBLE_BUFFERED_REMOTE_FUSED_EXECUTOR_NAME,
+      &fused_graph));
+  SessionOptions session_options;
+  session_options.env = Env::Default();
+  std::unique_ptr<Session> session(NewSession(session_options));
+  TF_ASSERT_OK(session->Create(fused_graph));
+
+  // Run concurrently so that the inputs of a run are filled while another
+  // run executes, and check that every run gets its own result.
+  constexpr int kNumRuns = 32;
+  std::vector<float> results(kNumRuns);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (int i = 0; i < kNumRuns; ++i) {
+      pool.Schedule([i, &session, &results]() {
+        Tensor input_a(DT_FLOAT, {});
+        input_a.flat<float>().data()[0] = i;
+        std::vector<Tensor> output_tensors;
+        TF_CHECK_OK(session->Run({{NAME_A, input_a}},
+                                 {REMOTE_FUSED_EXECUTE_OP_NODE_NAME}, {},
+                                 &output_tensors));
+        CHECK_EQ(1, output_tensors.size());
+        results[i] = output_tensors.at(0).flat<float>().data()[0];
+      });
+    }
+  }
+  for (int i = 0; i < kNumRuns; ++i) {
+    EXPECT_NEAR(i + NODE_B_VAL, results[i], FLOAT_VALUE_TOLERANCE);
+  }
+}
+
 ////////////////////////////
 // End-to-end test: End   //
 ////////////////////////////
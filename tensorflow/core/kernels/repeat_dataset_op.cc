@@ -74,8 +74,9 @@ class RepeatDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit EmptyIterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         *end_of_sequence = true;
         return Status::OK();
       }
@@ -88,8 +89,9 @@ class RepeatDatasetOp : public UnaryDatasetOpKernel {
             i_(0),
             input_impl_(dataset->input_->MakeIterator()) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);  // TODO(mrry): Make locking less conservative.
         while (i_ < dataset()->count_) {
           TF_RETURN_IF_ERROR(
@@ -116,8 +118,9 @@ class RepeatDatasetOp : public UnaryDatasetOpKernel {
       explicit ForeverIterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset), input_impl_(nullptr) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);  // TODO(mrry): Make locking less conservative.
         do {
           if (!input_impl_) {
@@ -342,8 +342,7 @@ class ResourceGatherOp : public OpKernel {
       auto out_flat = out->shaped<T, 3>({1, N, out->NumElements() / N});
 
       functor::GatherFunctor<Device, T, Index> functor;
-      int64 bad_i = functor(c->eigen_device<Device>(), params_flat,
-                            indices_flat, out_flat);
+      int64 bad_i = functor(c, params_flat, indices_flat, out_flat);
 
       OP_REQUIRES(
           c, bad_i < 0,
@@ -379,14 +378,33 @@ TF_CALL_QUANTIZED_TYPES(REGISTER_GATHER_CPU);
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
-  explicit ResourceScatterUpdateOp(OpKernelConstruction* c) : OpKernel(c) {}
+  explicit ResourceScatterUpdateOp(OpKernelConstruction* c) : OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("use_locking", &use_exclusive_lock_));
+  }
 
   void Compute(OpKernelContext* c) override {
     Var* v = nullptr;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     core::ScopedUnref unref_v(v);
-    mutex_lock ml(*v->mu());
-    Tensor* params = v->tensor();
+    if (use_exclusive_lock_) {
+      mutex_lock ml(*v->mu());
+      DoCompute(c, v->tensor());
+    } else {
+      // Only hold the lock while taking a reference to the current buffer, so
+      // that concurrent scatters into the variable run in parallel.
+      Tensor params;
+      {
+        mutex_lock ml(*v->mu());
+        params = *v->tensor();
+      }
+      DoCompute(c, &params);
+    }
+  }
+
+ private:
+  bool use_exclusive_lock_;
+
+  void DoCompute(OpKernelContext* c, Tensor* params) {
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
 
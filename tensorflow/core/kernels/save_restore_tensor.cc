@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <unordered_map>
 
 #include <utility>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -167,15 +169,12 @@ void RestoreTensor(OpKernelContext* context,
   }
 
   // If we cannot find a cached reader we will allocate our own.
-  std::unique_ptr<checkpoint::TensorSliceReader> allocated_reader;
-
-  const checkpoint::TensorSliceReader* reader =
+  std::shared_ptr<const checkpoint::TensorSliceReader> reader =
       context->slice_reader_cache()->GetReader(file_pattern, open_func,
                                                preferred_shard);
   if (!reader) {
-    allocated_reader.reset(new checkpoint::TensorSliceReader(
-        file_pattern, open_func, preferred_shard));
-    reader = allocated_reader.get();
+    reader.reset(new checkpoint::TensorSliceReader(file_pattern, open_func,
+                                                   preferred_shard));
   }
   OP_REQUIRES_OK(context, CHECK_NOTNULL(reader)->status());
 
@@ -231,6 +230,11 @@ void RestoreTensor(OpKernelContext* context,
 #undef READER_COPY
 }
 
+// The maximum number of threads reading the tensors restored by
+// RestoreTensorsV2().  The reads are I/O bound, so they run on a dedicated
+// pool rather than on the compute threads.
+constexpr int kMaxRestoreThreads = 16;
+
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
@@ -243,8 +247,11 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   TF_RETURN_IF_ERROR(reader.status());
 
   // TODO(zongheng): potential optimization: one Seek() in first lookup.
-  // TODO(zongheng): consider measuring speed and issuing concurrent lookups
-  // within a fixed memory budget.
+  // The full tensors are read concurrently by a single LookupMany() once the
+  // outputs are allocated.  Their contents are read directly into the
+  // outputs, so this needs no memory beyond them.
+  std::vector<string> full_tensor_names;
+  std::vector<Tensor*> full_tensors;
   TensorShape restored_full_shape;
   Tensor* restored_tensor = nullptr;
   for (size_t i = 0; i < tensor_names_flat.size(); ++i) {
@@ -257,7 +264,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(i, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      full_tensor_names.push_back(tensor_name);
+      full_tensors.push_back(restored_tensor);
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
@@ -287,6 +295,17 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
           DataTypeString(restored_tensor->dtype()));
     }
   }
+  const int num_threads =
+      std::min<int>(kMaxRestoreThreads, full_tensors.size());
+  if (num_threads > 1) {
+    thread::ThreadPool thread_pool(Env::Default(), "restore_tensors",
+                                   num_threads);
+    TF_RETURN_IF_ERROR(
+        reader.LookupMany(full_tensor_names, full_tensors, &thread_pool));
+  } else {
+    TF_RETURN_IF_ERROR(
+        reader.LookupMany(full_tensor_names, full_tensors, nullptr));
+  }
   return Status::OK();
 }
 
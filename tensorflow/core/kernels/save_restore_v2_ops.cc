@@ -15,11 +15,15 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <deque>
+#include <functional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -28,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -85,12 +91,120 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Writes checkpoints on behalf of the ops run with "async_write", on a single
+// background thread of the process.  Writes run in the order in which they
+// are scheduled, so that a merge runs after the saves of its shards.
+class CheckpointWriteQueue {
+ public:
+  static CheckpointWriteQueue* Global() {
+    static CheckpointWriteQueue* queue = new CheckpointWriteQueue;
+    return queue;
+  }
+
+  // Schedules "write", which writes the checkpoints named by "prefixes".
+  void Schedule(const std::vector<string>& prefixes,
+                std::function<Status()> write) {
+    mutex_lock l(mu_);
+    for (const string& prefix : prefixes) {
+      ++pending_[prefix];
+    }
+    writes_.push_back({prefixes, std::move(write)});
+    cond_var_.notify_all();
+  }
+
+  // Waits until the scheduled writes of "prefix" are done.
+  void WaitFor(const string& prefix) {
+    mutex_lock l(mu_);
+    while (pending_.count(prefix) > 0) {
+      cond_var_.wait(l);
+    }
+  }
+
+  // Returns the first error of a write since the last call, and clears it.
+  Status ConsumeError() {
+    mutex_lock l(mu_);
+    Status s = error_;
+    error_ = Status::OK();
+    return s;
+  }
+
+ private:
+  struct Write {
+    std::vector<string> prefixes;
+    std::function<Status()> write;
+  };
+
+  CheckpointWriteQueue()
+      : thread_(Env::Default()->StartThread(ThreadOptions(),
+                                            "checkpoint_writer",
+                                            [this]() { WriterLoop(); })) {}
+
+  void WriterLoop() {
+    mutex_lock l(mu_);
+    while (true) {
+      while (writes_.empty()) {
+        cond_var_.wait(l);
+      }
+      Write w = std::move(writes_.front());
+      writes_.pop_front();
+      l.unlock();
+      const Status s = w.write();
+      if (!s.ok()) {
+        LOG(ERROR) << "Asynchronous checkpoint write failed: " << s;
+      }
+      l.lock();
+      error_.Update(s);
+      for (const string& prefix : w.prefixes) {
+        if (--pending_[prefix] == 0) {
+          pending_.erase(prefix);
+        }
+      }
+      cond_var_.notify_all();
+    }
+  }
+
+  mutex mu_;
+  condition_variable cond_var_;
+  std::deque<Write> writes_ GUARDED_BY(mu_);
+  // The number of scheduled writes of each prefix that are not done.
+  std::unordered_map<string, int> pending_ GUARDED_BY(mu_);
+  Status error_ GUARDED_BY(mu_);
+  // Never joined, as the queue lives as long as the process.
+  std::unique_ptr<Thread> thread_;
+};
+
+// Writes the tensors to the V2 checkpoint "prefix".  "shape_and_slices" are
+// already validated.
+Status WriteBundle(const string& prefix, const std::vector<string>& names,
+                   const std::vector<string>& shape_and_slices,
+                   const std::vector<Tensor>& tensors) {
+  BundleWriter writer(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (!shape_and_slices[i].empty()) {
+      TensorShape shape;
+      TensorSlice slice(tensors[i].dims());
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(
+          shape_and_slices[i], &shape, &slice, &slice_shape));
+      TF_RETURN_IF_ERROR(writer.AddSlice(names[i], shape, slice, tensors[i]));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(names[i], tensors[i]));
+    }
+  }
+  return writer.Finish();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -98,6 +212,7 @@ class SaveV2 : public OpKernel {
     const Tensor& shape_and_slices = context->input(2);
     ValidateInputs(true /* is save op */, context, prefix, tensor_names,
                    shape_and_slices);
+    if (!context->status().ok()) return;
 
     const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
     const int num_tensors = static_cast<int>(tensor_names.NumElements());
@@ -105,16 +220,16 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<string>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<string> names(num_tensors);
+    std::vector<string> specs(num_tensors);
+    std::vector<Tensor> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      names[i] = tensor_names_flat(i);
+      specs[i] = shape_and_slices_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
 
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
+      if (!specs[i].empty()) {
+        const string& shape_spec = specs[i];
         TensorShape shape;
         TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
@@ -127,15 +242,26 @@ class SaveV2 : public OpKernel {
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
       }
+      // The inputs may alias variables that are updated once this op
+      // returns, so an asynchronous write works on a snapshot.
+      tensors[i] = async_write_ ? tensor::DeepCopy(tensor) : tensor;
+    }
+
+    if (!async_write_) {
+      OP_REQUIRES_OK(context,
+                     WriteBundle(prefix_string, names, specs, tensors));
+      return;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
+    CheckpointWriteQueue* queue = CheckpointWriteQueue::Global();
+    OP_REQUIRES_OK(context, queue->ConsumeError());
+    queue->Schedule({prefix_string}, [prefix_string, names, specs, tensors]() {
+      return WriteBundle(prefix_string, names, specs, tensors);
+    });
   }
+
+ private:
+  bool async_write_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -158,6 +284,7 @@ class RestoreV2 : public OpKernel {
                    shape_and_slices);
 
     const string& prefix_string = prefix.scalar<string>()();
+    CheckpointWriteQueue::Global()->WaitFor(prefix_string);
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -191,6 +318,7 @@ class MergeV2Checkpoints : public OpKernel {
       : OpKernel(context) {
     OP_REQUIRES_OK(context,
                    context->GetAttr("delete_old_dirs", &delete_old_dirs_));
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -206,14 +334,39 @@ class MergeV2Checkpoints : public OpKernel {
                     "Input destination_prefix should be a scalar tensor, got ",
                     destination_prefix.shape().DebugString(), " instead."));
 
-    const gtl::ArraySlice<string> input_prefixes =
-        gtl::ArraySlice<string>(checkpoint_prefixes.flat<string>());
-    Env* env = Env::Default();
+    const auto& input_prefixes_flat = checkpoint_prefixes.flat<string>();
+    const std::vector<string> input_prefixes(
+        input_prefixes_flat.data(),
+        input_prefixes_flat.data() + input_prefixes_flat.size());
     const string& merged_prefix = destination_prefix.scalar<string>()();
-    OP_REQUIRES_OK(
-        context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
+    CheckpointWriteQueue* queue = CheckpointWriteQueue::Global();
 
-    if (delete_old_dirs_) {
+    if (!async_write_) {
+      for (const string& input_prefix : input_prefixes) {
+        queue->WaitFor(input_prefix);
+      }
+      OP_REQUIRES_OK(context,
+                     Merge(input_prefixes, merged_prefix, delete_old_dirs_));
+      return;
+    }
+    OP_REQUIRES_OK(context, queue->ConsumeError());
+    // The writes of the input prefixes were scheduled before this one.
+    const bool delete_old_dirs = delete_old_dirs_;
+    queue->Schedule({merged_prefix},
+                    [input_prefixes, merged_prefix, delete_old_dirs]() {
+                      return Merge(input_prefixes, merged_prefix,
+                                   delete_old_dirs);
+                    });
+  }
+
+ private:
+  static Status Merge(const std::vector<string>& input_prefixes,
+                      const string& merged_prefix, bool delete_old_dirs) {
+    Env* env = Env::Default();
+    TF_RETURN_IF_ERROR(
+        tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
+
+    if (delete_old_dirs) {
       const string& merged_dir = io::Dirname(merged_prefix).ToString();
       for (const string& input_prefix : input_prefixes) {
         const string& dirname = io::Dirname(input_prefix).ToString();
@@ -224,11 +377,13 @@ class MergeV2Checkpoints : public OpKernel {
         if (!status.ok()) VLOG(1) << status;
       }
     }
+    return Status::OK();
   }
 
- private:
   // On merge, whether or not to delete the input (temporary) directories.
   bool delete_old_dirs_;
+  // Whether the merge is done by the background checkpoint writer.
+  bool async_write_;
 };
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -215,9 +217,73 @@ struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
   }
 };
 
+// Scatters that touch fewer elements than this are applied by a single thread.
+static constexpr int64 kMinParallelScatterElements = 32 << 10;
+
+// Applies a scatter on the threads of `d`, split by destination row: every
+// shard owns a contiguous range of rows of params and applies, in order, the
+// updates whose index falls in that range.  No two threads write the same row
+// and the updates of a row keep their relative order, so the result is the
+// same as the serial loop's without locks or atomics.  Unlike the serial loop,
+// nothing is written if an index is out of range.
+template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
+Index ParallelScatterByRow(OpKernelContext* c, const Device& d,
+                           typename TTypes<T>::Matrix params,
+                           typename TTypes<T>::ConstMatrix updates,
+                           typename TTypes<Index>::ConstFlat indices) {
+  const Index N = static_cast<Index>(indices.size());
+  const Index limit = static_cast<Index>(params.dimension(0));
+  const int64 num_shards = std::min<int64>(d.numThreads(), limit);
+  if (num_shards < 2) {
+    return ScatterFunctorBase<Device, T, Index, op>()(c, d, params, updates,
+                                                      indices);
+  }
+  // Every shard reads every index, so copy and check them once up front.
+  std::vector<Index> rows(N);
+  for (Index i = 0; i < N; i++) {
+    rows[i] = ::tensorflow::internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(rows[i], limit)) return i;
+  }
+  auto work = [&](int64 first_shard, int64 last_shard) {
+    const Index row_begin = static_cast<Index>(
+        static_cast<int64>(limit) * first_shard / num_shards);
+    const Index row_end = static_cast<Index>(
+        static_cast<int64>(limit) * last_shard / num_shards);
+    for (Index i = 0; i < N; i++) {
+      const Index index = rows[i];
+      if (index < row_begin || index >= row_end) continue;
+      // Copy last Ndim-1 dimensions of updates[i] to params[index]
+      scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
+                                            updates.template chip<0>(i));
+    }
+  };
+  // A shard scans all the indices, but only applies its share of the updates.
+  const double shard_bytes =
+      static_cast<double>(N) * params.dimension(1) * sizeof(T) / num_shards;
+  d.parallelFor(num_shards,
+                Eigen::TensorOpCost(N * sizeof(Index) + shard_bytes,
+                                    shard_bytes, N + shard_bytes / sizeof(T)),
+                work);
+  return -1;
+}
+
 template <typename T, typename Index, scatter_op::UpdateOp op>
-struct ScatterFunctor<CPUDevice, T, Index, op>
-        : ScatterFunctorBase<CPUDevice, T, Index, op>{};
+struct ScatterFunctor<CPUDevice, T, Index, op> {
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const int64 num_elements =
+        static_cast<int64>(indices.size()) * params.dimension(1);
+    if (std::is_same<T, string>::value ||
+        num_elements < kMinParallelScatterElements) {
+      return ScatterFunctorBase<CPUDevice, T, Index, op>()(c, d, params,
+                                                           updates, indices);
+    }
+    return ParallelScatterByRow<CPUDevice, T, Index, op>(c, d, params, updates,
+                                                         indices);
+  }
+};
 
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T, typename Index, scatter_op::UpdateOp op>
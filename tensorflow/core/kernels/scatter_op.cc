@@ -15,6 +15,8 @@ limitations under the License.
 
 // See docs in ../ops/state_ops.cc.
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -37,8 +37,9 @@ namespace {
 
 class ScatterUpdateOpTest : public OpsTestBase {
  protected:
-  void MakeOp(DataType variable_ref_type, DataType index_type) {
-    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterUpdate")
+  void MakeOp(DataType variable_ref_type, DataType index_type,
+              const char* op = "ScatterUpdate") {
+    TF_ASSERT_OK(NodeDefBuilder("myop", op)
                      .Input(FakeInput(variable_ref_type))
                      .Input(FakeInput(index_type))
                      .Input(FakeInput(RemoveRefType(variable_ref_type)))
@@ -223,6 +224,82 @@ TEST_F(ScatterUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+// Large enough to be split across threads by destination row.  Many
+// duplicate indices check that the updates of a row keep their order.
+void RunLargeScatter(ScatterUpdateOpTest* test, const char* op,
+                     Tensor* expected) {
+  const int kRows = 100;
+  const int kCols = 256;
+  const int kNumUpdates = 1000;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<float> params(kRows * kCols);
+  for (int i = 0; i < params.size(); ++i) params[i] = i % 7;
+  std::vector<int32> indices;
+  std::vector<float> updates;
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices.push_back(rnd.Uniform(kRows));
+    for (int j = 0; j < kCols; ++j) updates.push_back(i * 10 + j);
+  }
+  *expected = Tensor(DT_FLOAT, TensorShape({kRows, kCols}));
+  auto expected_matrix = expected->matrix<float>();
+  for (int r = 0; r < kRows; ++r) {
+    for (int j = 0; j < kCols; ++j) {
+      expected_matrix(r, j) = params[r * kCols + j];
+    }
+  }
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      if (StringPiece(op) == "ScatterAdd") {
+        expected_matrix(indices[i], j) += updates[i * kCols + j];
+      } else {
+        expected_matrix(indices[i], j) = updates[i * kCols + j];
+      }
+    }
+  }
+  test->AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  test->AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  test->AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+}
+
+TEST_F(ScatterUpdateOpTest, Large_Update) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  Tensor expected;
+  RunLargeScatter(this, "ScatterUpdate", &expected);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterUpdateOpTest, Large_Add) {
+  MakeOp(DT_FLOAT_REF, DT_INT32, "ScatterAdd");
+  Tensor expected;
+  RunLargeScatter(this, "ScatterAdd", &expected);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterUpdateOpTest, Large_IndexOutOfRangeLeavesParams) {
+  MakeOp(DT_FLOAT_REF, DT_INT32, "ScatterAdd");
+  const int kCols = 1 << 10;
+  std::vector<float> zeros(4 * kCols, 0);
+  std::vector<int32> indices(64, 1);
+  indices.back() = 4;
+  AddInputFromArray<float>(TensorShape({4, kCols}), zeros);
+  AddInputFromArray<int32>(TensorShape({64}), indices);
+  AddInputFromArray<float>(TensorShape({64, kCols}),
+                           std::vector<float>(64 * kCols, 1));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("indices[63] = 4 is not in [0, 4)"))
+      << s;
+  Tensor expected(DT_FLOAT, TensorShape({4, kCols}));
+  expected.flat<float>().setZero();
+  // On a single thread the updates before the bad index may be applied.
+  if (device_->tensorflow_cpu_worker_threads()->num_threads > 1) {
+    test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+  }
+}
+
 class ScatterUpdateBM : public ScatterUpdateOpTest {
  public:
   void TestBody() override {}
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sdca_internal.h"
 
+#include <atomic>
 #include <limits>
 #include <random>
 
@@ -30,6 +31,27 @@ namespace sdca {
 using UnalignedFloatVector = TTypes<const float>::UnalignedConstVec;
 using UnalignedInt64Vector = TTypes<const int64>::UnalignedConstVec;
 
+namespace {
+
+static_assert(sizeof(std::atomic<float>) == sizeof(float),
+              "std::atomic<float> must be layout compatible with float");
+
+// Adds "delta" to "*value", computing the sum in double precision as a plain
+// "+=" of a double would. The examples of a mini-batch are trained in
+// parallel without locks (Hogwild style), so this avoids losing the updates
+// that concurrent threads make to the same weight.
+inline void AtomicAddToFloat(float* value, double delta) {
+  std::atomic<float>* atomic_value =
+      reinterpret_cast<std::atomic<float>*>(value);
+  float current = atomic_value->load(std::memory_order_relaxed);
+  while (!atomic_value->compare_exchange_weak(
+      current, static_cast<float>(current + delta),
+      std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
 void FeatureWeightsDenseStorage::UpdateDenseDeltaWeights(
     const Eigen::ThreadPoolDevice& device,
     const Example::DenseVector& dense_vector,
@@ -66,8 +88,8 @@ void FeatureWeightsSparseStorage::UpdateSparseDeltaWeights(
                                      : (*sparse_features.values)(k);
     auto it = indices_to_id_.find((*sparse_features.indices)(k));
     for (size_t l = 0; l < normalized_bounded_dual_delta.size(); ++l) {
-      deltas_(l, it->second) +=
-          feature_value * normalized_bounded_dual_delta[l];
+      AtomicAddToFloat(&deltas_(l, it->second),
+                       feature_value * normalized_bounded_dual_delta[l]);
     }
   }
 }
@@ -32,6 +32,21 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/util.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#if GOOGLE_CUDA
+#include "tensorflow/core/platform/cuda.h"
+
+using ::perftools::gputools::cuda::ScopedActivateExecutorContext;
+#elif TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/rocm.h"
+
+using ::perftools::gputools::rocm::ScopedActivateExecutorContext;
+#endif  // GOOGLE_CUDA
+
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
@@ -411,6 +426,164 @@ TF_CALL_complex64(REGISTER_GPU_UNSORTED_KERNELS_ALL);
 TF_CALL_complex128(REGISTER_GPU_UNSORTED_KERNELS_ALL);
 #undef REGISTER_GPU_UNSORTED_KERNELS
 #undef REGISTER_GPU_UNSORTED_KERNELS_ALL
+
+// GPU kernel for the sorted segment reductions: SegmentSum, SegmentMean and
+// SegmentMax, or with kIsSparse, SparseSegmentSum, SparseSegmentMean and
+// SparseSegmentSqrtN.
+//
+// The number of output rows is the last segment id plus one, so it is copied
+// to the host before the output is allocated and the rows are reduced by
+// SortedSegmentReductionFunctor.  Unlike the CPU kernels, this does not check
+// that the segment ids are sorted and that the indices are in range; rows with
+// out of range indices are skipped.
+template <class T, class Index, functor::SegmentReductionType kType,
+          bool kIsSparse>
+class SortedSegmentReductionGPUOp : public AsyncOpKernel {
+ public:
+  explicit SortedSegmentReductionGPUOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {}
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& input = context->input(0);
+    const Tensor& segment_ids = context->input(kIsSparse ? 2 : 1);
+    if (kIsSparse) {
+      const Tensor& indices = context->input(1);
+      OP_REQUIRES_ASYNC(
+          context, TensorShapeUtils::IsVector(indices.shape()),
+          errors::InvalidArgument("indices should be a vector."), done);
+      OP_REQUIRES_ASYNC(
+          context, TensorShapeUtils::IsVector(segment_ids.shape()),
+          errors::InvalidArgument("segment_ids should be a vector."), done);
+      OP_REQUIRES_ASYNC(context,
+                        indices.NumElements() == segment_ids.NumElements(),
+                        errors::InvalidArgument(
+                            "segment_ids and indices should have same size."),
+                        done);
+    } else if (!SegmentReductionDoValidation(context, input, segment_ids)) {
+      done();
+      return;
+    }
+
+    const int64 num_indices = segment_ids.NumElements();
+    if (num_indices == 0) {
+      TensorShape output_shape = input.shape();
+      output_shape.set_dim(0, 0);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, output_shape, &output), done);
+      done();
+      return;
+    }
+
+    // Copy the last segment id to the host.
+    Tensor last_segment_id;
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    attr.set_gpu_compatible(true);
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_temp(DataTypeToEnum<Index>::v(), TensorShape({}),
+                               &last_segment_id, attr),
+        done);
+    perftools::gputools::DeviceMemoryBase last_segment_id_ptr(
+        const_cast<Index*>(segment_ids.flat<Index>().data()) +
+            num_indices - 1,
+        sizeof(Index));
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(last_segment_id.scalar<Index>().data(),
+                         last_segment_id_ptr, sizeof(Index))
+            .ok(),
+        errors::Internal(type_string(),
+                         ": failed to copy the last segment id from device"),
+        done);
+
+    auto create_and_reduce = [context, input, segment_ids, last_segment_id,
+                              done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      auto stream = context->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+      const Index output_rows = last_segment_id.scalar<Index>()() + 1;
+      OP_REQUIRES_ASYNC(context, output_rows > 0,
+                        errors::InvalidArgument("segment ids must be >= 0"),
+                        done);
+      TensorShape output_shape = input.shape();
+      output_shape.set_dim(0, output_rows);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, output_shape, &output), done);
+
+      const Index* indices =
+          kIsSparse ? context->input(1).flat<Index>().data() : nullptr;
+      functor::SortedSegmentReductionFunctor<GPUDevice, T, Index>()(
+          context, context->eigen_device<GPUDevice>(), kType, output_rows,
+          segment_ids.flat<Index>(), indices, input.flat_outer_dims<T>(),
+          output->flat_outer_dims<T>());
+      done();
+    };
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, create_and_reduce);
+  }
+
+ private:
+  TF_DISALLOW_COPY_AND_ASSIGN(SortedSegmentReductionGPUOp);
+};
+
+namespace functor {
+
+#define DECLARE_GPU_SPEC_INDEX(T, Index)                                      \
+  template <>                                                                 \
+  void SortedSegmentReductionFunctor<GPUDevice, T, Index>::operator()(        \
+      OpKernelContext* ctx, const GPUDevice& d, SegmentReductionType type,    \
+      const Index output_rows, TTypes<Index>::ConstFlat segment_ids,          \
+      const Index* indices, TTypes<T>::ConstMatrix data,                      \
+      TTypes<T>::Matrix output);                                              \
+  extern template struct SortedSegmentReductionFunctor<GPUDevice, T, Index>;
+
+#define DECLARE_GPU_SPEC(T)         \
+  DECLARE_GPU_SPEC_INDEX(T, int32); \
+  DECLARE_GPU_SPEC_INDEX(T, int64)
+
+TF_CALL_float(DECLARE_GPU_SPEC);
+TF_CALL_double(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+#undef DECLARE_GPU_SPEC_INDEX
+
+}  // namespace functor
+
+#define REGISTER_GPU_SORTED_KERNEL(name, reduction, type, index_type,        \
+                                   is_sparse)                                \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name(name)                                                             \
+          .Device(DEVICE_GPU)                                                \
+          .TypeConstraint<type>("T")                                         \
+          .TypeConstraint<index_type>(is_sparse ? "Tidx" : "Tindices"),      \
+      SortedSegmentReductionGPUOp<type, index_type,                          \
+                                  functor::SegmentReductionType::reduction,  \
+                                  is_sparse>)
+
+#define REGISTER_GPU_SORTED_KERNELS_INDEX(type, index_type)             \
+  REGISTER_GPU_SORTED_KERNEL("SegmentSum", kSum, type, index_type, false); \
+  REGISTER_GPU_SORTED_KERNEL("SegmentMean", kMean, type, index_type,       \
+                             false);                                       \
+  REGISTER_GPU_SORTED_KERNEL("SegmentMax", kMax, type, index_type, false)
+
+#define REGISTER_GPU_SORTED_KERNELS(type)                                    \
+  REGISTER_GPU_SORTED_KERNELS_INDEX(type, int32);                            \
+  REGISTER_GPU_SORTED_KERNELS_INDEX(type, int64);                            \
+  REGISTER_GPU_SORTED_KERNEL("SparseSegmentSum", kSum, type, int32, true);   \
+  REGISTER_GPU_SORTED_KERNEL("SparseSegmentMean", kMean, type, int32, true); \
+  REGISTER_GPU_SORTED_KERNEL("SparseSegmentSqrtN", kSqrtN, type, int32, true)
+
+TF_CALL_float(REGISTER_GPU_SORTED_KERNELS);
+TF_CALL_double(REGISTER_GPU_SORTED_KERNELS);
+#undef REGISTER_GPU_SORTED_KERNELS
+#undef REGISTER_GPU_SORTED_KERNELS_INDEX
+#undef REGISTER_GPU_SORTED_KERNEL
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 // Same as SegmentReductionOp but takes as input a "sparse" tensor, represented
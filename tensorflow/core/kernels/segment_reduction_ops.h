@@ -73,6 +73,28 @@ struct UnsortedSegmentMaxFunctor: public UnsortedSegmentBaseFunctor<Device, T, I
                   const Index data_size, const T* data,
                   typename TTypes<T, 2>::Tensor output);
 };
+
+// Reductions computed by SortedSegmentReductionFunctor.  Segments without
+// any rows are set to 0 for all of them.
+enum class SegmentReductionType { kSum, kMean, kSqrtN, kMax };
+
+// Functor for the sorted segment reductions, i.e. SegmentSum, SegmentMean,
+// SegmentMax and their SparseSegment* counterparts.
+// 'type': the reduction to compute.
+// 'output_rows': the number of output segments.
+// 'segment_ids': sorted map from the reduced rows to output segment ids.
+// 'indices': if not null, reduced row i is row indices[i] of 'data', as in
+//            the SparseSegment* ops; otherwise it is row i.
+// 'data': input data tensor, reshaped to {data rows, output columns}.
+// 'output': output reshaped to {output_rows, output.size/output_rows}
+template <typename Device, typename T, typename Index>
+struct SortedSegmentReductionFunctor {
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  SegmentReductionType type, const Index output_rows,
+                  typename TTypes<Index>::ConstFlat segment_ids,
+                  const Index* indices, typename TTypes<T>::ConstMatrix data,
+                  typename TTypes<T>::Matrix output);
+};
 }  // namespace functor
 }  // namespace tensorflow
 
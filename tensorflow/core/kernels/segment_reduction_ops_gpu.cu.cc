@@ -20,7 +20,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+#include "external/cub_archive/cub/device/device_radix_sort.cuh"
+#endif  // GOOGLE_CUDA
+
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
@@ -79,8 +85,216 @@ __global__ void UnsortedSegmentSumCustomKernel(
   }
 }
 
+// Number of consecutive rows of one column reduced by a single thread of
+// SortedSegmentReductionKernel.
+constexpr int kSortedSegmentTileRows = 8;
+
+struct SumReducerGpu {
+  template <typename T>
+  static __device__ __forceinline__ T Identity() {
+    return T(0);
+  }
+  template <typename T>
+  static __device__ __forceinline__ T Reduce(const T& a, const T& b) {
+    return a + b;
+  }
+  template <typename T>
+  static __device__ __forceinline__ void Atomic(T* dest, const T& value) {
+    AccumulateInto<T>(dest, value);
+  }
+};
+
+struct MaxReducerGpu {
+  template <typename T>
+  static __device__ __forceinline__ T Identity() {
+    return Eigen::NumTraits<T>::lowest();
+  }
+  template <typename T>
+  static __device__ __forceinline__ T Reduce(const T& a, const T& b) {
+    return a > b ? a : b;
+  }
+  template <typename T>
+  static __device__ __forceinline__ void Atomic(T* dest, const T& value) {
+    GpuAtomicMax(dest, value);
+  }
+};
+
+// Reduces 'num_rows' rows, mapped to output rows by the sorted 'segment_ids',
+// into 'output', which must be initialized to the identity of Reducer.  Row i
+// is row indices[i], or row i if indices is null, of 'data'.
+//
+// Each thread reduces a column of kSortedSegmentTileRows consecutive rows,
+// keeping the partial result of the current segment in a register.  Only the
+// first and last segment of a tile may be shared with the neighbouring tiles
+// of the column, and they are written with atomics if they actually are;
+// segments inside a tile are stored directly.  So heavily repeated segment
+// ids, such as popular embedding rows, cost one atomic per tile rather than
+// one per row.  Rows out of range of 'data' and segment ids out of range of
+// the output are ignored.
+template <typename T, typename Index, typename Reducer>
+__global__ void SortedSegmentReductionKernel(
+    const Index num_rows, const Index inner_dim, const Index output_rows,
+    const Index* segment_ids, const Index* indices, const Index data_rows,
+    const T* data, T* output, const Index total_stripe_count) {
+  GPU_1D_KERNEL_LOOP(stripe_index, total_stripe_count) {
+    const Index column = stripe_index % inner_dim;
+    const Index row_begin =
+        stripe_index / inner_dim * kSortedSegmentTileRows;
+    const Index row_end =
+        min(row_begin + kSortedSegmentTileRows, num_rows);
+
+    Index segment = ldg(segment_ids + row_begin);
+    bool shared = row_begin > 0 && ldg(segment_ids + row_begin - 1) == segment;
+    T value = Reducer::template Identity<T>();
+    for (Index i = row_begin; i < row_end; ++i) {
+      const Index next_segment = ldg(segment_ids + i);
+      if (next_segment != segment) {
+        if (FastBoundsCheck(segment, output_rows)) {
+          T* dest = output + segment * inner_dim + column;
+          if (shared) {
+            Reducer::Atomic(dest, value);
+          } else {
+            *dest = value;
+          }
+        }
+        segment = next_segment;
+        shared = false;
+        value = Reducer::template Identity<T>();
+      }
+      const Index row = indices == nullptr ? i : ldg(indices + i);
+      if (FastBoundsCheck(row, data_rows)) {
+        value = Reducer::Reduce(value, ldg(data + row * inner_dim + column));
+      }
+    }
+    shared = shared ||
+             (row_end < num_rows && ldg(segment_ids + row_end) == segment);
+    if (FastBoundsCheck(segment, output_rows)) {
+      T* dest = output + segment * inner_dim + column;
+      if (shared) {
+        Reducer::Atomic(dest, value);
+      } else {
+        *dest = value;
+      }
+    }
+  }
+}
+
+// Returns the index of the first of the 'size' sorted segment ids that is not
+// less than 'segment'.
+template <typename Index>
+__device__ Index SegmentLowerBound(const Index* segment_ids, Index size,
+                                   Index segment) {
+  Index begin = 0;
+  while (size > 0) {
+    const Index half = size / 2;
+    if (ldg(segment_ids + begin + half) < segment) {
+      begin += half + 1;
+      size -= half + 1;
+    } else {
+      size = half;
+    }
+  }
+  return begin;
+}
+
+// Finishes the mean, the sqrt(N) normalized sum and the max of each output
+// segment, given the number of rows in it; empty segments are set to 0.
+template <typename T, typename Index>
+__global__ void SegmentFinalizeKernel(const SegmentReductionType type,
+                                      const Index output_size,
+                                      const Index inner_dim,
+                                      const Index num_rows,
+                                      const Index* segment_ids, T* output) {
+  GPU_1D_KERNEL_LOOP(i, output_size) {
+    const Index segment = i / inner_dim;
+    const Index count =
+        SegmentLowerBound(segment_ids, num_rows, segment + 1) -
+        SegmentLowerBound(segment_ids, num_rows, segment);
+    if (count == 0) {
+      output[i] = T(0);
+    } else if (type == SegmentReductionType::kMean) {
+      output[i] /= static_cast<T>(count);
+    } else if (type == SegmentReductionType::kSqrtN) {
+      output[i] /= Eigen::numext::sqrt(static_cast<T>(count));
+    }
+  }
+}
+
+template <typename T>
+__global__ void SetToLowest(const int nthreads, T* output) {
+  GPU_1D_KERNEL_LOOP(i, nthreads) {
+    output[i] = Eigen::NumTraits<T>::lowest();
+  }
+}
+
+template <typename Index>
+__global__ void RangeInit(const Index size, Index* output) {
+  GPU_1D_KERNEL_LOOP(i, size) { output[i] = i; }
+}
+
+template <typename T, typename Index, typename Reducer>
+void LaunchSortedSegmentReduction(const GPUDevice& d, const Index num_rows,
+                                  const Index inner_dim,
+                                  const Index output_rows,
+                                  const Index* segment_ids,
+                                  const Index* indices, const Index data_rows,
+                                  const T* data, T* output) {
+  const Index total_stripe_count =
+      inner_dim * ((num_rows + kSortedSegmentTileRows - 1) /
+                   kSortedSegmentTileRows);
+  GpuLaunchConfig config = GetGpuLaunchConfig(total_stripe_count, d);
+  GPU_LAUNCH_KERNEL(SortedSegmentReductionKernel<T, Index, Reducer>,
+      dim3(config.block_count), dim3(config.thread_per_block), 0, d.stream(),
+      num_rows, inner_dim, output_rows, segment_ids, indices, data_rows, data,
+      output, total_stripe_count);
+}
+
 namespace functor {
 
+// SortedSegmentReductionFunctor implementation for GPUDevice.
+template <typename T, typename Index>
+struct SortedSegmentReductionFunctor<GPUDevice, T, Index> {
+  void operator()(OpKernelContext* ctx, const GPUDevice& d,
+                  SegmentReductionType type, const Index output_rows,
+                  typename TTypes<Index>::ConstFlat segment_ids,
+                  const Index* indices, typename TTypes<T>::ConstMatrix data,
+                  typename TTypes<T>::Matrix output) {
+    if (output.size() == 0) {
+      return;
+    }
+    const bool is_max = type == SegmentReductionType::kMax;
+    GpuLaunchConfig config = GetGpuLaunchConfig(output.size(), d);
+    if (is_max) {
+      GPU_LAUNCH_KERNEL(SetToLowest<T>,
+          dim3(config.block_count), dim3(config.thread_per_block), 0,
+          d.stream(), output.size(), output.data());
+    } else {
+      GPU_LAUNCH_KERNEL(SetZero<T>,
+          dim3(config.block_count), dim3(config.thread_per_block), 0,
+          d.stream(), output.size(), output.data());
+    }
+    const Index num_rows = segment_ids.size();
+    const Index inner_dim = output.dimension(1);
+    if (num_rows > 0) {
+      if (is_max) {
+        LaunchSortedSegmentReduction<T, Index, MaxReducerGpu>(
+            d, num_rows, inner_dim, output_rows, segment_ids.data(), indices,
+            data.dimension(0), data.data(), output.data());
+      } else {
+        LaunchSortedSegmentReduction<T, Index, SumReducerGpu>(
+            d, num_rows, inner_dim, output_rows, segment_ids.data(), indices,
+            data.dimension(0), data.data(), output.data());
+      }
+    }
+    if (type != SegmentReductionType::kSum) {
+      GPU_LAUNCH_KERNEL(SegmentFinalizeKernel<T, Index>,
+          dim3(config.block_count), dim3(config.thread_per_block), 0,
+          d.stream(), type, static_cast<Index>(output.size()), inner_dim,
+          num_rows, segment_ids.data(), output.data());
+    }
+  }
+};
+
 // UnsortedSegmentSumFunctor implementation for GPUDevice.
 template <typename T, typename Index>
 struct UnsortedSegmentSumFunctor<GPUDevice, T, Index>: UnsortedSegmentBaseFunctor<GPUDevice, T, Index> {
@@ -111,14 +325,100 @@ struct UnsortedSegmentSumFunctor<GPUDevice, T, Index>: UnsortedSegmentBaseFuncto
     const Index input_outer_dim_size = segment_ids.dimension(0);
     const Index input_inner_dim_size = input_total_size / input_outer_dim_size;
 
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+    // Sort the rows by segment id so that repeated ids are summed in
+    // registers by SortedSegmentReductionKernel, rather than with one atomic
+    // per row on the same output elements.
+    if (input_outer_dim_size >= kSortedSegmentTileRows) {
+      OP_REQUIRES_OK(ctx, SortAndReduce(ctx, d, output_rows,
+                                        input_outer_dim_size,
+                                        input_inner_dim_size,
+                                        segment_ids.data(), data, output));
+      return;
+    }
+#endif  // GOOGLE_CUDA
+
     config = GetGpuLaunchConfig(input_total_size, d);
     GPU_LAUNCH_KERNEL(UnsortedSegmentSumCustomKernel<T, Index>,
         dim3(config.block_count), dim3(config.thread_per_block), 0, d.stream(),
         input_outer_dim_size, input_inner_dim_size, output_rows,
         segment_ids.data(), data, output.data());
   }
+
+ private:
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+  static Status SortAndReduce(OpKernelContext* ctx, const GPUDevice& d,
+                              const Index output_rows, const Index num_rows,
+                              const Index inner_dim, const Index* segment_ids,
+                              const T* data,
+                              typename TTypes<T, 2>::Tensor output) {
+    const DataType index_type = DataTypeToEnum<Index>::v();
+    Tensor rows, sorted_segment_ids, sorted_rows;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(index_type, TensorShape({num_rows}), &rows));
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(index_type, TensorShape({num_rows}),
+                                          &sorted_segment_ids));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(index_type, TensorShape({num_rows}), &sorted_rows));
+    Index* rows_data = rows.flat<Index>().data();
+    GpuLaunchConfig config = GetGpuLaunchConfig(num_rows, d);
+    GPU_LAUNCH_KERNEL(RangeInit<Index>,
+        dim3(config.block_count), dim3(config.thread_per_block), 0, d.stream(),
+        num_rows, rows_data);
+
+    const cudaStream_t& cu_stream = GetGpuStream(ctx);
+    std::size_t temp_storage_bytes = 0;
+    cudaError_t err = cub::DeviceRadixSort::SortPairs(
+        /*d_temp_storage*/ nullptr, temp_storage_bytes, segment_ids,
+        sorted_segment_ids.flat<Index>().data(), rows_data,
+        sorted_rows.flat<Index>().data(), num_rows, /*begin_bit*/ 0,
+        /*end_bit*/ sizeof(Index) * 8, cu_stream);
+    if (err != cudaSuccess) {
+      return errors::Internal(
+          "UnsortedSegmentSum: Could not launch cub::DeviceRadixSort::"
+          "SortPairs to calculate temp_storage_bytes, status: ",
+          cudaGetErrorString(err));
+    }
+    Tensor temp_storage;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT8, TensorShape({static_cast<int64>(temp_storage_bytes)}),
+        &temp_storage));
+    err = cub::DeviceRadixSort::SortPairs(
+        temp_storage.flat<int8>().data(), temp_storage_bytes, segment_ids,
+        sorted_segment_ids.flat<Index>().data(), rows_data,
+        sorted_rows.flat<Index>().data(), num_rows, /*begin_bit*/ 0,
+        /*end_bit*/ sizeof(Index) * 8, cu_stream);
+    if (err != cudaSuccess) {
+      return errors::Internal(
+          "UnsortedSegmentSum: Could not launch cub::DeviceRadixSort::"
+          "SortPairs, temp_storage_bytes: ",
+          temp_storage_bytes, ", status: ", cudaGetErrorString(err));
+    }
+
+    LaunchSortedSegmentReduction<T, Index, SumReducerGpu>(
+        d, num_rows, inner_dim, output_rows,
+        sorted_segment_ids.flat<Index>().data(),
+        sorted_rows.flat<Index>().data(), num_rows, data, output.data());
+    return Status::OK();
+  }
+#endif  // GOOGLE_CUDA
 };
 
+#define DEFINE_SORTED_GPU_SPECS_INDEX(T, Index) \
+  template struct SortedSegmentReductionFunctor<GPUDevice, T, Index>
+
+#define DEFINE_SORTED_GPU_SPECS(T)         \
+  DEFINE_SORTED_GPU_SPECS_INDEX(T, int32); \
+  DEFINE_SORTED_GPU_SPECS_INDEX(T, int64);
+
+TF_CALL_float(DEFINE_SORTED_GPU_SPECS);
+TF_CALL_double(DEFINE_SORTED_GPU_SPECS);
+
+#undef DEFINE_SORTED_GPU_SPECS
+#undef DEFINE_SORTED_GPU_SPECS_INDEX
+
 #define DEFINE_GPU_SPECS_INDEX(T, Index) \
   template struct UnsortedSegmentSumFunctor<GPUDevice, T, Index>
 
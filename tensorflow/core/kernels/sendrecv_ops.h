@@ -27,7 +27,6 @@ class SendOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override;
 
  private:
-  string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(SendOp);
@@ -39,7 +38,6 @@ class RecvOp : public AsyncOpKernel {
   void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override;
 
  private:
-  string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecvOp);
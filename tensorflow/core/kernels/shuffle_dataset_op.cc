@@ -80,13 +80,18 @@ class ShuffleDatasetOp : public UnaryDatasetOpKernel {
     }
 
    private:
+    // The iterator keeps its buffer in a pool of slots that is reused for
+    // the whole iteration. Producing an element leaves a hole in its slot,
+    // which the next call fills in place with the next input element, so
+    // steady-state operation moves no other element and allocates no new
+    // slots. The pool grows on demand up to `buffer_size` slots, so a large
+    // `buffer_size` over a small input does not reserve unused memory.
     class Iterator : public DatasetIterator<Dataset> {
      public:
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset),
             input_impl_(dataset->input_->MakeIterator()),
             generator_(&parent_generator_) {
-        buffer_.reserve(dataset->buffer_size_);
         int64 seed = dataset->seed_;
         int64 seed2 = dataset->seed2_;
         if (seed == 0 && seed2 == 0) {
@@ -97,27 +102,47 @@ class ShuffleDatasetOp : public UnaryDatasetOpKernel {
         parent_generator_ = random::PhiloxRandom(seed, seed2);
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
+        // Refill the slot of the previously produced element. If the
+        // input is exhausted, move the last element into it instead, so
+        // that the filled slots stay contiguous.
+        if (hole_ >= 0) {
+          if (!end_of_input_sequence_) {
+            slots_[hole_].clear();
+            TF_RETURN_IF_ERROR(input_impl_->GetNext(
+                ctx, &slots_[hole_], &end_of_input_sequence_));
+          }
+          if (end_of_input_sequence_) {
+            --num_elements_;
+            slots_[hole_].swap(slots_[num_elements_]);
+          }
+          hole_ = -1;
+        }
+
         while (!end_of_input_sequence_ &&
-               buffer_.size() < dataset()->buffer_size_) {
-          std::vector<Tensor> input_element;
-          TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &input_element,
-                                                  &end_of_input_sequence_));
+               num_elements_ < dataset()->buffer_size_) {
+          if (num_elements_ == slots_.size()) {
+            slots_.emplace_back();
+          }
+          std::vector<Tensor>* slot = &slots_[num_elements_];
+          slot->clear();
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, slot, &end_of_input_sequence_));
           if (!end_of_input_sequence_) {
-            buffer_.emplace_back(std::move(input_element));
+            ++num_elements_;
           }
         }
 
-        if (!buffer_.empty()) {
+        RecordBufferOccupancy(num_elements_);
+        if (num_elements_ > 0) {
           *end_of_sequence = false;
-          // Choose an element to produce uniformly at random, and
-          // swap the last element into its place in the buffer.
-          int64 index = generator_() % buffer_.size();
-          *out_tensors = std::move(buffer_[index]);
-          std::swap(buffer_[index], buffer_.back());
-          buffer_.pop_back();
+          // Choose an element to produce uniformly at random, and leave
+          // its slot to be refilled by the next call.
+          hole_ = generator_() % num_elements_;
+          out_tensors->swap(slots_[hole_]);
         } else {
           DCHECK(end_of_input_sequence_);
           *end_of_sequence = true;
@@ -127,7 +152,12 @@ class ShuffleDatasetOp : public UnaryDatasetOpKernel {
 
      private:
       mutex mu_;
-      std::vector<std::vector<Tensor>> buffer_ GUARDED_BY(mu_);
+      std::vector<std::vector<Tensor>> slots_ GUARDED_BY(mu_);
+      // The number of filled slots, including the hole (if any).
+      size_t num_elements_ GUARDED_BY(mu_) = 0;
+      // The index of the slot whose element was produced by the last call,
+      // or -1.
+      int64 hole_ GUARDED_BY(mu_) = -1;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
       bool end_of_input_sequence_ GUARDED_BY(mu_) = false;
       random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
@@ -73,8 +73,9 @@ class SkipDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit EmptyIterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset) {}
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         *end_of_sequence = true;
         return Status::OK();
       }
@@ -87,8 +88,9 @@ class SkipDatasetOp : public UnaryDatasetOpKernel {
             i_(0),
             input_impl_(dataset->input_->MakeIterator()) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);  // TODO(mrry): Make locking less conservative.
 
         // Keep calling GetNext().  TODO(vrv): Figure out a way to
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 #define TENSORFLOW_KERNELS_SPARSE_CONDITIONAL_ACCUMULATOR_H_
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/kernels/typed_conditional_accumulator_base.h"
 
 namespace tensorflow {
@@ -42,6 +46,13 @@ namespace tensorflow {
  * SparseConditionalAccumulator is the datatype-dependent templated sub-class of
  * ConditionalAccumulatorBase. It implements the virtual arithmetic methods that
  * are used by for aggregating, averaging, allocating, returning indexed slices.
+ *
+ * The gradients are combined by row as they are applied: the accumulator holds
+ * one row of values per distinct index, in a buffer that grows geometrically
+ * and is reused across steps, so applying a gradient with n indices costs O(n)
+ * regardless of how many rows have been accumulated. The indices of a gradient
+ * may be in any order and may repeat. The indices of the average gradient are
+ * sorted and unique, so that it can be applied with a single scatter.
  */
 template <typename Device, typename T>
 class SparseConditionalAccumulator
@@ -53,26 +64,26 @@ class SparseConditionalAccumulator
                                const string& name)
       : TypedConditionalAccumulatorBase<
             std::tuple<const Tensor*, const Tensor*, const Tensor*>>(
-            dtype, shape, name) {
-    accum_idx_vec_ = nullptr;
-    count_element_ = nullptr;
-    accum_val_ = nullptr;
-    accum_val_persistent_ = new PersistentTensor();
-  }
+            dtype, shape, name) {}
 
-  ~SparseConditionalAccumulator() override {
-    if (accum_idx_vec_ != nullptr) delete accum_idx_vec_;
-    if (count_element_ != nullptr) delete count_element_;
-    if (accum_val_persistent_ != nullptr) delete accum_val_persistent_;
-    // Do not delete accum_val_! Will be automatically garbage collected
-  };
+  ~SparseConditionalAccumulator() override {}
 
  protected:
-  std::vector<int64>* accum_idx_vec_ = nullptr;
-  std::vector<int>* count_element_ = nullptr;
-
+  // The index of each accumulated row, in the order of the rows in
+  // accum_val_.
+  std::vector<int64> accum_idx_vec_;
+  // The number of gradients that contributed to each accumulated row.
+  std::vector<int> count_element_;
+  // The value of counter_ when each accumulated row was last counted, so
+  // that an index repeated within a gradient is only counted once.
+  std::vector<int64> last_counted_;
+  // Maps an index to its row in accum_val_.
+  std::unordered_map<int64, int64> accum_row_;
+
+  // The accumulated rows. Only the first accum_idx_vec_.size() rows are used;
+  // the others are spare capacity.
   Tensor* accum_val_ = nullptr;
-  PersistentTensor* accum_val_persistent_ = nullptr;
+  PersistentTensor accum_val_persistent_;
 
   typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
                            Eigen::Unaligned>
@@ -158,32 +169,12 @@ class SparseConditionalAccumulator
   void AllocateAndAssignToAccumGradFunction(
       OpKernelContext* ctx,
       std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad) override {
-    const Tensor* grad_idx = std::get<0>(*grad);
-    const Tensor* grad_val = std::get<1>(*grad);
-
-    const int64 nnz = grad_idx->dim_size(0);
-
-    // Assign indices
-    if (accum_idx_vec_ != nullptr) delete accum_idx_vec_;
-    accum_idx_vec_ = new std::vector<int64>();
-    accum_idx_vec_->reserve(nnz);
-    for (int i = 0; i < nnz; i++) {
-      accum_idx_vec_->push_back(grad_idx->vec<int64>()(i));
-    }
-
-    // Assign values to accum_val_tensor
-    // TODO(b/32704451): Don't just ignore the ::tensorflow::Status object!
-    ctx->allocate_persistent(dtype_, grad_val->shape(), accum_val_persistent_,
-                             &accum_val_)
-        .IgnoreError();
-    accum_val_->flat<T>().device(ctx->template eigen_device<Device>()) =
-        grad_val->flat<T>();
-
-    // Assign count_element_
-    if (count_element_ != nullptr) {
-      delete count_element_;
-    }
-    count_element_ = new std::vector<int>(nnz, 1);
+    // Start a new accumulation, keeping the buffer of the previous one.
+    accum_idx_vec_.clear();
+    count_element_.clear();
+    last_counted_.clear();
+    accum_row_.clear();
+    AddToAccumGradFunction(ctx, grad);
 
     // Do not need shape; Assume that the op has checked that the shapes match,
     // so grad's shape == shape_
@@ -192,163 +183,76 @@ class SparseConditionalAccumulator
   void AddToAccumGradFunction(
       OpKernelContext* ctx,
       std::tuple<const Tensor*, const Tensor*, const Tensor*>* grad) override {
-    // Modeled after third_party/tensorflow/core/kernels/sparse_add_op
-
     const Tensor* grad_idx = std::get<0>(*grad);
     const Tensor* grad_val = std::get<1>(*grad);
 
-    const int64 accum_nnz = accum_idx_vec_->size();
     const int64 grad_nnz = grad_idx->dim_size(0);
-
-    // Source enumerates the origin of a non-zero element: whether it is from
-    // the new gradient, the accumulated gradient, or the sum of both.
-    enum Source { from_accum, from_grad, from_accum_and_grad };
-
-    // (1) do a pass over inputs, and append values and indices to vectors
-    std::vector<std::tuple<Source, int64, int64>> entries_to_copy;
-    entries_to_copy.reserve(accum_nnz + grad_nnz);
-
-    // Pass over all non-zero elements of both the gradient and the accumulated
-    // value, to identify where each non-zero element of the sum comes from.
-    // The input and output indexed slices are assumed to be ordered along
-    // increasing dimension number.
-    int64 i = 0, j = 0;
-    int64 sum_nnz = 0;
-    while (i < accum_nnz && j < grad_nnz) {
-      sum_nnz++;
-      switch (cmp(accum_idx_vec_, grad_idx, i, j)) {
-        case -1:
-          entries_to_copy.emplace_back(from_accum, i, -1);
-          ++i;
-          break;
-        case 0:
-          entries_to_copy.emplace_back(from_accum_and_grad, i, j);
-          ++i;
-          ++j;
-          break;
-        case 1:
-          entries_to_copy.emplace_back(from_grad, -1, j);
-          ++j;
-          break;
-      }
+    if (!ReserveRows(ctx, grad_val->shape(),
+                     accum_idx_vec_.size() + grad_nnz)) {
+      return;
     }
 
-    // Handle leftovers
-    while (i < accum_nnz) {
-      sum_nnz++;
-      entries_to_copy.emplace_back(from_accum, i, -1);
-      ++i;
-    }
-    while (j < grad_nnz) {
-      sum_nnz++;
-      entries_to_copy.emplace_back(from_grad, -1, j);
-      ++j;
-    }
-
-    // (2) Copy or sum the non-zero elements into sum_indices and sum_tensor
-    std::vector<int64>* sum_indices_vec = new std::vector<int64>();
-    sum_indices_vec->reserve(sum_nnz);
-
-    std::vector<int>* sum_counts = new std::vector<int>();
-    sum_counts->reserve(sum_nnz);
-
-    Tensor* sum_tensor = nullptr;
-    PersistentTensor* tensor_sum_persistent = new PersistentTensor();
-
-    TensorShape sum_shape = grad_val->shape();
-    sum_shape.set_dim(0, sum_nnz);
-
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_persistent(dtype_, sum_shape, tensor_sum_persistent,
-                                      &sum_tensor));
-    auto sum_flat = sum_tensor->flat_outer_dims<T>();
+    auto grad_idx_vec = grad_idx->vec<int64>();
     auto accum_flat = accum_val_->flat_outer_dims<T>();
     auto grad_flat = grad_val->flat_outer_dims<T>();
-
     const int64 num_col = grad_flat.dimension(1);
-
     Eigen::DSizes<Eigen::DenseIndex, 1> slice_shape(num_col);
 
-    for (i = 0; i < sum_nnz; ++i) {
-      const Source src = std::get<0>(entries_to_copy[i]);
-      const int64 idx_a = std::get<1>(entries_to_copy[i]);
-      const int64 idx_b = std::get<2>(entries_to_copy[i]);
-      T* sum_slice_ptr = &sum_flat(i, 0);
-      SliceT sum_slice(sum_slice_ptr, slice_shape);
-      if (src == from_accum) {
-        // Element comes from accumulator; directly copy data structures over
-        sum_indices_vec->push_back(accum_idx_vec_->at(idx_a));
-        T* accum_slice_ptr = &accum_flat(idx_a, 0);
-        SliceT accum_slice(accum_slice_ptr, slice_shape);
-        sum_slice = accum_slice;
-        sum_counts->push_back(count_element_->at(idx_a));
-      } else if (src == from_accum_and_grad) {
-        // Element is a sum of accumulated value and new gradient;
-        // compute sum here
-        sum_indices_vec->push_back(accum_idx_vec_->at(idx_a));
-        const T* grad_slice_ptr = &grad_flat(idx_b, 0);
-        SliceConstT grad_slice(grad_slice_ptr, slice_shape);
-        T* accum_slice_ptr = &accum_flat(idx_a, 0);
-        SliceT accum_slice(accum_slice_ptr, slice_shape);
-        sum_slice = grad_slice + accum_slice;
-        sum_counts->push_back(count_element_->at(idx_a) + 1);
-      } else if (src == from_grad) {
-        // Element comes from new gradient; make a copy of indices and values
-        sum_indices_vec->push_back(grad_idx->vec<int64>()(idx_b));
-        const T* grad_slice_ptr = &grad_flat(idx_b, 0);
-        SliceConstT grad_slice(grad_slice_ptr, slice_shape);
-        sum_slice = grad_slice;
-        sum_counts->push_back(1);
+    for (int64 j = 0; j < grad_nnz; ++j) {
+      const int64 index = grad_idx_vec(j);
+      auto insert = accum_row_.emplace(index, accum_idx_vec_.size());
+      const int64 row = insert.first->second;
+      if (insert.second) {
+        accum_idx_vec_.push_back(index);
+        count_element_.push_back(1);
+        last_counted_.push_back(counter_);
+      } else if (last_counted_[row] != counter_) {
+        ++count_element_[row];
+        last_counted_[row] = counter_;
+      }
+      if (num_col == 0) continue;
+      SliceConstT grad_slice(&grad_flat(j, 0), slice_shape);
+      SliceT accum_slice(&accum_flat(row, 0), slice_shape);
+      if (insert.second) {
+        accum_slice = grad_slice;
+      } else {
+        accum_slice += grad_slice;
       }
     }
 
-    // (3) Keep output, i.e., switch pointers to point to new data structures
-    // representing the sum
-    // Indices
-    if (accum_idx_vec_ != nullptr) delete accum_idx_vec_;
-    accum_idx_vec_ = sum_indices_vec;
-    // Values
-    accum_val_ = sum_tensor;
-    delete accum_val_persistent_;
-    accum_val_persistent_ = tensor_sum_persistent;
-    // Counts
-    if (count_element_ != nullptr) delete count_element_;
-    count_element_ = sum_counts;
-
     // No need to copy shape, since shape remains the same after sum.
   }
 
   void DivideAccumGradByCounter(OpKernelContext* ctx) override
       EXCLUSIVE_LOCKS_REQUIRED(this->mu_) {
-    const int64 nnz = count_element_->size();
+    const int64 nnz = count_element_.size();
     auto accum_flat = accum_val_->flat_outer_dims<T>();
-    std::vector<T> count_typet;
-    std::transform(count_element_->begin(), count_element_->end(),
-                   std::back_inserter(count_typet),
-                   TypeConverter<T, int>::ConvertUToT);
-
-    // Option 1: divide all by counter
-    /*
-    std::transform(
-        &accum_flat(0,0), &accum_flat(nnz,0), &accum_flat(0,0),
-        std::bind2nd(std::divides<T>(),
-                     TypeConverter<T, int>::ConvertUToT(this->counter_)));
-    */
-
-    // Option 2: average element-wise
+    if (accum_flat.dimension(1) == 0) return;
+
+    // Average element-wise
     Eigen::DSizes<Eigen::DenseIndex, 1> slice_shape(accum_flat.dimension(1));
     for (int64 i = 0; i < nnz; i++) {
       T* accum_slice_ptr = &accum_flat(i, 0);
       SliceT accum_slice(accum_slice_ptr, slice_shape);
       accum_slice.device(ctx->template eigen_device<Device>()) =
-          accum_slice / count_typet[i];
+          accum_slice /
+          TypeConverter<T, int>::ConvertUToT(count_element_[i]);
     }
   }
 
   bool SetOutput(OpKernelContext* ctx) override {
+    // Output the rows in the order of their indices.
+    std::vector<int64> order(accum_idx_vec_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](int64 a, int64 b) {
+      return accum_idx_vec_[a] < accum_idx_vec_[b];
+    });
+
     bool is_successful = true;
-    if (is_successful) is_successful = ReturnIdxTensor(ctx);
-    if (is_successful) is_successful = ReturnValTensor(ctx);
+    if (is_successful) is_successful = ReturnIdxTensor(ctx, order);
+    if (is_successful) is_successful = ReturnValTensor(ctx, order);
     if (is_successful) is_successful = ReturnShapeTensor(ctx);
     return is_successful;
   }
@@ -407,33 +311,74 @@ class SparseConditionalAccumulator
   }
 
  private:
-  inline int cmp(std::vector<int64>* a_idx, const Tensor* b_idx,
-                 const int64 a_row, const int64 b_row) {
-    const int64 a = a_idx->at(a_row);
-    const int64 b = b_idx->vec<int64>()(b_row);
-    if (a < b) {
-      return -1;
-    } else if (a > b) {
-      return 1;
+  // Makes room in accum_val_ for "num_rows" rows of the shape of the rows of
+  // "grad_shape", keeping the rows accumulated so far.
+  bool ReserveRows(OpKernelContext* ctx, const TensorShape& grad_shape,
+                   int64 num_rows) {
+    TensorShape row_shape = grad_shape;
+    row_shape.RemoveDim(0);
+    int64 capacity = 0;
+    if (accum_val_ != nullptr) {
+      TensorShape accum_row_shape = accum_val_->shape();
+      accum_row_shape.RemoveDim(0);
+      if (accum_row_shape == row_shape) {
+        capacity = accum_val_->dim_size(0);
+        if (capacity >= num_rows) return true;
+      } else {
+        // A new accumulation of rows of another shape.
+        DCHECK(accum_idx_vec_.empty());
+      }
     }
-    return 0;
+
+    TensorShape new_shape = row_shape;
+    new_shape.InsertDim(0, std::max(num_rows, 2 * capacity));
+    PersistentTensor new_persistent;
+    Tensor* new_val = nullptr;
+    OP_REQUIRES_OK_BOOLEAN(ctx, ctx->allocate_persistent(dtype_, new_shape,
+                                                         &new_persistent,
+                                                         &new_val));
+    const int64 num_used = accum_idx_vec_.size();
+    if (num_used > 0) {
+      new_val->Slice(0, num_used).flat<T>() =
+          accum_val_->Slice(0, num_used).flat<T>();
+    }
+    accum_val_persistent_ = new_persistent;
+    accum_val_ = new_val;
+    return true;
   }
 
-  inline bool ReturnIdxTensor(OpKernelContext* ctx) {
+  inline bool ReturnIdxTensor(OpKernelContext* ctx,
+                              const std::vector<int64>& order) {
     Tensor* idx_tensor;
-    const int64 nnz = accum_idx_vec_->size();
+    const int64 nnz = order.size();
     OP_REQUIRES_OK_BOOLEAN(ctx, ctx->allocate_output(0, {nnz}, &idx_tensor));
     // If allocate_output fails, OP_REQUIRES_OK_BOOLEAN will short-circuit
     // the remaining code and just return false
     auto idx_tensor_vec = idx_tensor->vec<int64>();
-    for (int i = 0; i < nnz; ++i) {
-      idx_tensor_vec(i) = accum_idx_vec_->at(i);
+    for (int64 i = 0; i < nnz; ++i) {
+      idx_tensor_vec(i) = accum_idx_vec_[order[i]];
     }
     return true;
   }
 
-  inline bool ReturnValTensor(OpKernelContext* ctx) {
-    ctx->set_output(1, *accum_val_);
+  inline bool ReturnValTensor(OpKernelContext* ctx,
+                              const std::vector<int64>& order) {
+    const int64 nnz = order.size();
+    TensorShape val_shape = accum_val_->shape();
+    val_shape.set_dim(0, nnz);
+    Tensor* val_tensor;
+    OP_REQUIRES_OK_BOOLEAN(ctx,
+                           ctx->allocate_output(1, val_shape, &val_tensor));
+    auto val_flat = val_tensor->flat_outer_dims<T>();
+    auto accum_flat = accum_val_->flat_outer_dims<T>();
+    const int64 num_col = accum_flat.dimension(1);
+    if (num_col == 0) return true;
+    Eigen::DSizes<Eigen::DenseIndex, 1> slice_shape(num_col);
+    for (int64 i = 0; i < nnz; ++i) {
+      SliceT val_slice(&val_flat(i, 0), slice_shape);
+      SliceConstT accum_slice(&accum_flat(order[i], 0), slice_shape);
+      val_slice = accum_slice;
+    }
     return true;
   }
 
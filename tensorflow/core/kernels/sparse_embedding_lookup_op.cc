@@ -0,0 +1,216 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/sparse_embedding_lookup_op.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// Each output row is owned by a single shard, which gathers the rows of its
+// segment straight into it; no [num_ids, dim] intermediate is materialized.
+template <typename T, typename Index>
+struct SparseEmbeddingLookupFunctor<CPUDevice, T, Index> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d,
+                  SparseEmbeddingCombiner combiner,
+                  typename TTypes<T>::ConstMatrix params,
+                  typename TTypes<Index>::ConstVec ids,
+                  typename TTypes<int32>::ConstVec segment_ids,
+                  typename TTypes<T>::Matrix output) {
+    const int64 num_ids = ids.dimension(0);
+    const int64 num_rows = params.dimension(0);
+    const int64 dim = params.dimension(1);
+    const int64 num_segments = output.dimension(0);
+
+    // The ids of segment s are [segment_starts[s], segment_starts[s + 1]).
+    std::vector<int64> segment_starts(num_segments + 1, num_ids);
+    int64 last_segment = -1;
+    for (int64 i = 0; i < num_ids; ++i) {
+      const int32 segment = internal::SubtleMustCopy(segment_ids(i));
+      OP_REQUIRES(ctx, FastBoundsCheck(segment, num_segments),
+                  errors::InvalidArgument("segment_ids[", i, "] = ", segment,
+                                          " is not in [0, ", num_segments,
+                                          ")"));
+      OP_REQUIRES(ctx, segment >= last_segment,
+                  errors::InvalidArgument("segment_ids are not sorted"));
+      std::fill(segment_starts.begin() + last_segment + 1,
+                segment_starts.begin() + segment + 1, i);
+      last_segment = segment;
+    }
+
+    mutex mu;
+    int64 bad_i = -1;  // GUARDED_BY(mu)
+    const T* params_base = params.data();
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 s = start; s < limit; ++s) {
+        T* out = &output(s, 0);
+        std::fill(out, out + dim, T(0));
+        const int64 begin = segment_starts[s];
+        const int64 end = segment_starts[s + 1];
+        for (int64 i = begin; i < end; ++i) {
+          const Index id = internal::SubtleMustCopy(ids(i));
+          if (!FastBoundsCheck(id, num_rows)) {
+            mutex_lock l(mu);
+            if (bad_i < 0 || i < bad_i) bad_i = i;
+            return;
+          }
+          if (i + 1 < end) {
+            const Index next = ids(i + 1);
+            if (FastBoundsCheck(next, num_rows)) {
+              port::prefetch<port::PREFETCH_HINT_T0>(params_base + next * dim);
+            }
+          }
+          const T* row = params_base + id * dim;
+          for (int64 j = 0; j < dim; ++j) {
+            out[j] += row[j];
+          }
+        }
+        const int64 n = end - begin;
+        if (n > 1 && combiner != SparseEmbeddingCombiner::kSum) {
+          const T scale = combiner == SparseEmbeddingCombiner::kMean
+                              ? T(1) / T(n)
+                              : T(1) / Eigen::numext::sqrt(T(n));
+          for (int64 j = 0; j < dim; ++j) {
+            out[j] *= scale;
+          }
+        }
+      }
+    };
+    const int64 cost_per_segment =
+        std::max<int64>(1, num_ids / std::max<int64>(1, num_segments)) * dim;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, work);
+    OP_REQUIRES(ctx, bad_i < 0,
+                errors::InvalidArgument("ids[", bad_i, "] = ", ids(bad_i),
+                                        " is not in [0, ", num_rows, ")"));
+  }
+};
+
+}  // namespace functor
+
+// Gathers rows of an embedding table and combines the rows of each segment,
+// i.e. Gather followed by SparseSegmentSum, SparseSegmentMean or
+// SparseSegmentSqrtN, in a single pass.
+template <typename Device, typename T, typename Index>
+class SparseEmbeddingLookupOp : public OpKernel {
+ public:
+  explicit SparseEmbeddingLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    if (combiner == "sum") {
+      combiner_ = SparseEmbeddingCombiner::kSum;
+    } else if (combiner == "mean") {
+      combiner_ = SparseEmbeddingCombiner::kMean;
+    } else if (combiner == "sqrtn") {
+      combiner_ = SparseEmbeddingCombiner::kSqrtN;
+    } else {
+      context->CtxFailure(
+          errors::InvalidArgument("Unknown combiner: ", combiner));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& num_segments = context->input(3);
+
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    OP_REQUIRES(context, ids.NumElements() == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and ids should have same size."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_segments.shape()),
+                errors::InvalidArgument("num_segments should be a scalar."));
+    const int32 output_rows = num_segments.scalar<int32>()();
+    OP_REQUIRES(context, output_rows >= 0,
+                errors::InvalidArgument("num_segments must be >= 0"));
+
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, output_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    functor::SparseEmbeddingLookupFunctor<Device, T, Index> functor;
+    functor(context, context->eigen_device<Device>(), combiner_,
+            params.flat_outer_dims<T>(), ids.vec<Index>(),
+            segment_ids.vec<int32>(), output->flat_outer_dims<T>());
+  }
+
+ private:
+  SparseEmbeddingCombiner combiner_;
+};
+
+#define REGISTER_KERNEL(dev, type, index_type)                       \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("SparseEmbeddingLookup")                                  \
+          .Device(DEVICE_##dev)                                      \
+          .TypeConstraint<type>("T")                                 \
+          .TypeConstraint<index_type>("Tidx")                        \
+          .HostMemory("num_segments"),                               \
+      SparseEmbeddingLookupOp<dev##Device, type, index_type>)
+
+#define REGISTER_CPU_KERNELS(type)   \
+  REGISTER_KERNEL(CPU, type, int32); \
+  REGISTER_KERNEL(CPU, type, int64)
+
+REGISTER_CPU_KERNELS(float);
+REGISTER_CPU_KERNELS(double);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define REGISTER_GPU_KERNELS(type)   \
+  REGISTER_KERNEL(GPU, type, int32); \
+  REGISTER_KERNEL(GPU, type, int64)
+
+REGISTER_GPU_KERNELS(float);
+REGISTER_GPU_KERNELS(double);
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_SPARSE_EMBEDDING_LOOKUP_OP_H_
+#define TENSORFLOW_KERNELS_SPARSE_EMBEDDING_LOOKUP_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// How SparseEmbeddingLookup combines the rows gathered for one segment.
+enum class SparseEmbeddingCombiner { kSum, kMean, kSqrtN };
+
+namespace functor {
+
+// Functor for SparseEmbeddingLookupOp.
+// 'params': the embedding table, flattened to {rows, dim}.
+// 'ids': rows of 'params' to gather.
+// 'segment_ids': sorted output row of each entry of 'ids'.
+// 'output': {num_segments, dim} output; rows with no ids are set to zero.
+// Errors in the inputs are reported through 'ctx'.
+template <typename Device, typename T, typename Index>
+struct SparseEmbeddingLookupFunctor {
+  void operator()(OpKernelContext* ctx, const Device& d,
+                  SparseEmbeddingCombiner combiner,
+                  typename TTypes<T>::ConstMatrix params,
+                  typename TTypes<Index>::ConstVec ids,
+                  typename TTypes<int32>::ConstVec segment_ids,
+                  typename TTypes<T>::Matrix output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_SPARSE_EMBEDDING_LOOKUP_OP_H_
@@ -0,0 +1,108 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/sparse_embedding_lookup_op.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Computes one element of the [num_segments, dim] output per thread.  Since
+// segment_ids are sorted, each thread finds the ids of its segment with a
+// binary search, so no per-segment offsets need to be computed beforehand.
+//
+// Ids out of [0, num_rows) contribute zeros, as in GatherOpKernel; unlike the
+// CPU kernel, neither they nor unsorted segment_ids are reported as errors.
+template <typename T, typename Index>
+__global__ void SparseEmbeddingLookupKernel(
+    const T* params, const Index* ids, const int32* segment_ids,
+    int64 num_rows, int64 num_ids, int64 dim, SparseEmbeddingCombiner combiner,
+    int64 output_size, T* output) {
+  GPU_1D_KERNEL_LOOP(i, output_size) {
+    const int32 segment = i / dim;
+    const int64 j = i - segment * dim;
+    int64 begin = 0;
+    int64 end = num_ids;
+    while (begin < end) {
+      const int64 mid = begin + (end - begin) / 2;
+      if (ldg(segment_ids + mid) < segment) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    T sum(0);
+    int64 n = 0;
+    for (int64 k = begin; k < num_ids && ldg(segment_ids + k) == segment;
+         ++k, ++n) {
+      const Index id = ldg(ids + k);
+      if (FastBoundsCheck(id, num_rows)) {
+        sum += ldg(params + id * dim + j);
+      }
+    }
+    if (n > 1 && combiner == SparseEmbeddingCombiner::kMean) {
+      sum /= T(n);
+    } else if (n > 1 && combiner == SparseEmbeddingCombiner::kSqrtN) {
+      sum /= Eigen::numext::sqrt(T(n));
+    }
+    output[i] = sum;
+  }
+}
+
+namespace functor {
+
+template <typename T, typename Index>
+struct SparseEmbeddingLookupFunctor<GPUDevice, T, Index> {
+  void operator()(OpKernelContext* ctx, const GPUDevice& d,
+                  SparseEmbeddingCombiner combiner,
+                  typename TTypes<T>::ConstMatrix params,
+                  typename TTypes<Index>::ConstVec ids,
+                  typename TTypes<int32>::ConstVec segment_ids,
+                  typename TTypes<T>::Matrix output) {
+    const int64 output_size = output.size();
+    GpuLaunchConfig config = GetGpuLaunchConfig(output_size, d);
+    GPU_LAUNCH_KERNEL(SparseEmbeddingLookupKernel<T, Index>,
+        dim3(config.block_count), dim3(config.thread_per_block), 0, d.stream(),
+        params.data(), ids.data(), segment_ids.data(), params.dimension(0),
+        ids.dimension(0), params.dimension(1), combiner, output_size,
+        output.data());
+  }
+};
+
+#define DEFINE_GPU_SPECS_INDEX(T, Index) \
+  template struct SparseEmbeddingLookupFunctor<GPUDevice, T, Index>
+
+#define DEFINE_GPU_SPECS(T)         \
+  DEFINE_GPU_SPECS_INDEX(T, int32); \
+  DEFINE_GPU_SPECS_INDEX(T, int64);
+
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+#undef DEFINE_GPU_SPECS_INDEX
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,193 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class SparseEmbeddingLookupOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType index_type, const string& combiner) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SparseEmbeddingLookup")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(index_type))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("combiner", combiner)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Looks up ids {0, 2, 1, 0} with segment ids {0, 0, 2, 2}, leaving segments
+  // 1 and 3 empty.
+  void AddInputs() {
+    AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 2, 1, 0});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+    AddInputFromArray<int32>(TensorShape({}), {4});
+  }
+};
+
+TEST_F(SparseEmbeddingLookupOpTest, Sum) {
+  MakeOp(DT_INT32, "sum");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4, 2}));
+  test::FillValues<float>(&expected, {6, 8, 0, 0, 4, 6, 0, 0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, Mean) {
+  MakeOp(DT_INT32, "mean");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4, 2}));
+  test::FillValues<float>(&expected, {3, 4, 0, 0, 2, 3, 0, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, SqrtN) {
+  MakeOp(DT_INT32, "sqrtn");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  const float s = std::sqrt(2.0f);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4, 2}));
+  test::FillValues<float>(&expected,
+                          {6 / s, 8 / s, 0, 0, 4 / s, 6 / s, 0, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, Int64IdsAndHigherRankParams) {
+  MakeOp(DT_INT64, "sum");
+  AddInputFromArray<float>(TensorShape({2, 1, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int64>(TensorShape({3}), {1, 1, 0});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 1, 2}));
+  test::FillValues<float>(&expected, {3, 4, 4, 6});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, BadIds) {
+  MakeOp(DT_INT32, "mean");
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 3});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("ids[1] = 3 is not in [0, 3)"))
+      << s;
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, UnsortedSegmentIds) {
+  MakeOp(DT_INT32, "mean");
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("segment_ids are not sorted"))
+      << s;
+}
+
+TEST_F(SparseEmbeddingLookupOpTest, SegmentIdOutOfRange) {
+  MakeOp(DT_INT32, "mean");
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({}), {2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("segment_ids[1] = 2 is not in [0, 2)"))
+      << s;
+}
+
+// Builds a lookup of `ids_per_example` random ids for each of `batch` examples
+// into a [vocab, dim] table, either with the fused op or with the Gather and
+// SparseSegmentMean ops embedding_lookup_sparse used to expand to.
+static Graph* EmbeddingLookup(bool fused, int batch, int ids_per_example,
+                              int vocab, int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int num_ids = batch * ids_per_example;
+  Tensor params(DT_FLOAT, TensorShape({vocab, dim}));
+  params.flat<float>().setRandom();
+  Tensor ids(DT_INT32, TensorShape({num_ids}));
+  Tensor positions(DT_INT32, TensorShape({num_ids}));
+  Tensor segment_ids(DT_INT32, TensorShape({num_ids}));
+  for (int i = 0; i < num_ids; ++i) {
+    ids.flat<int32>()(i) = (i * 7919) % vocab;
+    positions.flat<int32>()(i) = i;
+    segment_ids.flat<int32>()(i) = i / ids_per_example;
+  }
+  Tensor num_segments(DT_INT32, TensorShape({}));
+  num_segments.scalar<int32>()() = batch;
+
+  Node* node;
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseEmbeddingLookup")
+                    .Input(test::graph::Constant(g, params))
+                    .Input(test::graph::Constant(g, ids))
+                    .Input(test::graph::Constant(g, segment_ids))
+                    .Input(test::graph::Constant(g, num_segments))
+                    .Attr("combiner", "mean")
+                    .Finalize(g, &node));
+  } else {
+    Node* gather;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Gather")
+                    .Input(test::graph::Constant(g, params))
+                    .Input(test::graph::Constant(g, ids))
+                    .Finalize(g, &gather));
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentMean")
+                    .Input(gather)
+                    .Input(test::graph::Constant(g, positions))
+                    .Input(test::graph::Constant(g, segment_ids))
+                    .Finalize(g, &node));
+  }
+  return g;
+}
+
+#define BM_EmbeddingLookup(FUSED, B, K, V, D)                                 \
+  static void BM_EmbeddingLookup_##FUSED##_##B##_##K##_##V##_##D(int iters) { \
+    testing::UseRealTime();                                                   \
+    testing::BytesProcessed(static_cast<int64>(iters) * B * K * D *           \
+                            sizeof(float));                                   \
+    test::Benchmark("cpu", EmbeddingLookup(FUSED, B, K, V, D)).Run(iters);    \
+  }                                                                           \
+  BENCHMARK(BM_EmbeddingLookup_##FUSED##_##B##_##K##_##V##_##D);
+
+BM_EmbeddingLookup(true, 128, 20, 100000, 64);
+BM_EmbeddingLookup(false, 128, 20, 100000, 64);
+BM_EmbeddingLookup(true, 1024, 50, 1000000, 32);
+BM_EmbeddingLookup(false, 1024, 50, 1000000, 32);
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -152,37 +153,28 @@ class SplitOpCPU : public SplitOpBase<CPUDevice, T> {
 
     std::tie(prefix_dim_size, split_dim_size, suffix_dim_size) =
         Base::template SetDims<Eigen::DenseIndex>(input_shape, split_dim);
-    auto input_reshaped =
-        input.shaped<T, 3>({prefix_dim_size, split_dim_size, suffix_dim_size});
-
     const int64 split_dim_output_size = split_dim_size / num_split;
     TensorShape output_shape(input_shape);
     output_shape.set_dim(split_dim, split_dim_output_size);
 
-    Eigen::DSizes<Eigen::DenseIndex, 3> indices{0, 0, 0};
-    Eigen::DSizes<Eigen::DenseIndex, 3> sizes{
-        prefix_dim_size, split_dim_output_size, suffix_dim_size};
-
+    // Each output takes a contiguous block of split_dim_output_size *
+    // suffix_dim_size elements from each of the prefix_dim_size rows of the
+    // input, which is exactly the inverse of a concat.
+    const int64 output_row_size = split_dim_output_size * suffix_dim_size;
+    std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>> outputs_flat;
+    outputs_flat.reserve(num_split);
     for (int i = 0; i < num_split; ++i) {
       Tensor* result = nullptr;
       OP_REQUIRES_OK(context,
                      context->allocate_output(i, output_shape, &result));
-      if (prefix_dim_size * split_dim_output_size * suffix_dim_size > 0) {
-        Eigen::DSizes<Eigen::DenseIndex, 3> slice_indices;
-        Eigen::DSizes<Eigen::DenseIndex, 3> slice_sizes;
-        for (int j = 0; j < 3; ++j) {
-          slice_indices[j] = indices[j];
-          slice_sizes[j] = sizes[j];
-        }
-
-        auto result_shaped = result->shaped<T, 3>(
-            {prefix_dim_size, split_dim_output_size, suffix_dim_size});
-
-        functor::Split<CPUDevice, T>()(context->eigen_device<CPUDevice>(),
-                                       result_shaped, input_reshaped,
-                                       slice_indices, slice_sizes);
-      }
-      indices[1] += split_dim_output_size;
+      outputs_flat.emplace_back(new typename TTypes<T, 2>::Matrix(
+          result->shaped<T, 2>({prefix_dim_size, output_row_size})));
+    }
+    if (prefix_dim_size * output_row_size > 0) {
+      SplitCPU<T>(context->device(),
+                  input.shaped<T, 2>(
+                      {prefix_dim_size, split_dim_size * suffix_dim_size}),
+                  outputs_flat);
     }
   }
 };
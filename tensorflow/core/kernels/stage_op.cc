@@ -15,10 +15,13 @@ limitations under the License.
 
 #include <cstddef>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -35,6 +38,15 @@ class Buffer : public ResourceBase {
   // public types
   using Tuple = std::vector<Tensor>;
 
+  // An element of the staging area.  Elements put with PutPending() only
+  // become visible to Get() and Peek() once all their copies are done.
+  struct Element {
+    Tuple tuple;
+    std::size_t bytes = 0;
+    int pending_copies = 0;
+    Status status;
+  };
+
  private:
   // private variables
   std::size_t capacity_;
@@ -43,7 +55,7 @@ class Buffer : public ResourceBase {
   std::mutex mu_;
   std::condition_variable non_empty_cond_var_;
   std::condition_variable full_cond_var_;
-  std::deque<Tuple> buf_;
+  std::deque<std::shared_ptr<Element>> buf_;
 
  private:
   // private methods
@@ -67,6 +79,10 @@ class Buffer : public ResourceBase {
     return bytes + current_bytes_ > memory_limit_;
   }
 
+  static bool IsReady(const Element& element) {
+    return element.pending_copies == 0;
+  }
+
   std::size_t GetTupleBytes(const Tuple & tuple)
   {
     return std::accumulate(tuple.begin(), tuple.end(), 0,
@@ -75,16 +91,11 @@ class Buffer : public ResourceBase {
     });
   }
 
- public:
-  // public methods
-  explicit Buffer(std::size_t capacity, std::size_t memory_limit)
-      : capacity_(capacity), memory_limit_(memory_limit), current_bytes_(0) {}
-
-  // the Buffer takes ownership of the Tuple
-  Status Put(Tuple* tuple) {
-    std::unique_lock<std::mutex> lock(mu_);
-
-    std::size_t tuple_bytes = GetTupleBytes(*tuple);
+  // Blocks until there is space for an element of tuple_bytes bytes, then
+  // appends it to the buffer.
+  Status PutLocked(std::unique_lock<std::mutex>* lock,
+                   std::shared_ptr<Element> element) {
+    std::size_t tuple_bytes = element->bytes;
 
     // Sanity check so that we don't block for ever below
     if(memory_limit_ > 0 && tuple_bytes > memory_limit_) {
@@ -96,7 +107,7 @@ class Buffer : public ResourceBase {
 
     // If buffer capacity is bounded wait until elements have been removed
     if(IsBounded()) {
-      full_cond_var_.wait(lock, [tuple_bytes, this]() {
+      full_cond_var_.wait(*lock, [tuple_bytes, this]() {
         // If there's a memory limit, check if there's space for insertion
         bool memory_limit_valid = memory_limit_ > 0 ?
             !WouldExceedMemoryLimit(tuple_bytes) : true;
@@ -112,7 +123,23 @@ class Buffer : public ResourceBase {
     current_bytes_ += tuple_bytes;
 
     // Store tuple
-    buf_.push_back(std::move(*tuple));
+    buf_.push_back(std::move(element));
+    return Status::OK();
+  }
+
+ public:
+  // public methods
+  explicit Buffer(std::size_t capacity, std::size_t memory_limit)
+      : capacity_(capacity), memory_limit_(memory_limit), current_bytes_(0) {}
+
+  // the Buffer takes ownership of the Tuple
+  Status Put(Tuple* tuple) {
+    std::unique_lock<std::mutex> lock(mu_);
+
+    auto element = std::make_shared<Element>();
+    element->bytes = GetTupleBytes(*tuple);
+    element->tuple = std::move(*tuple);
+    TF_RETURN_IF_ERROR(PutLocked(&lock, std::move(element)));
 
     lock.unlock();
     // maybe possible to optimize by reducing
@@ -122,21 +149,55 @@ class Buffer : public ResourceBase {
     return Status::OK();
   }
 
+  // Like Put(), but the tensors of the tuple are still being filled in by
+  // num_copies asynchronous copies.  The element takes up its space in the
+  // buffer right away, but is only handed out once CopyDone() has been
+  // called for each copy.  *element is the element that the copies write
+  // to; it stays valid even if the buffer is cleared in the meantime.
+  Status PutPending(Tuple* tuple, int num_copies,
+                    std::shared_ptr<Element>* element) {
+    std::unique_lock<std::mutex> lock(mu_);
+
+    *element = std::make_shared<Element>();
+    (*element)->bytes = GetTupleBytes(*tuple);
+    (*element)->tuple = std::move(*tuple);
+    (*element)->pending_copies = num_copies;
+    return PutLocked(&lock, *element);
+  }
+
+  // Called when one of the copies of an element put with PutPending() is
+  // done.
+  void CopyDone(Element* element, const Status& status) {
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      element->status.Update(status);
+      if (--element->pending_copies > 0) return;
+    }
+    // Any of the waiters may be waiting for this element.
+    non_empty_cond_var_.notify_all();
+  }
+
   // Get tuple at front of the buffer
-  void Get(Tuple* tuple) {  // TODO(zhifengc): Support cancellation.
+  Status Get(Tuple* tuple) {  // TODO(zhifengc): Support cancellation.
     std::unique_lock<std::mutex> lock(mu_);
 
     // Wait for data if the buffer is empty
-    non_empty_cond_var_.wait(lock, [this]() { return !buf_.empty(); });
+    non_empty_cond_var_.wait(lock, [this]() {
+      return !buf_.empty() && IsReady(*buf_.front());
+    });
 
     // Move data into the output tuple
-    *tuple = std::move(buf_.front());
+    std::shared_ptr<Element> element = std::move(buf_.front());
     buf_.pop_front();
 
     // Update bytes in the Staging Area
-    current_bytes_ -= GetTupleBytes(*tuple);
+    current_bytes_ -= element->bytes;
 
     notify_inserters_if_bounded(&lock);
+
+    TF_RETURN_IF_ERROR(element->status);
+    *tuple = std::move(element->tuple);
+    return Status::OK();
   }
 
   // Return tuple at index
@@ -144,11 +205,13 @@ class Buffer : public ResourceBase {
     std::unique_lock<std::mutex> lock(mu_);
 
     // Wait if the requested index is not available
-    non_empty_cond_var_.wait(
-        lock, [index, this]() { return index < this->buf_.size(); });
+    non_empty_cond_var_.wait(lock, [index, this]() {
+      return index < this->buf_.size() && IsReady(*this->buf_[index]);
+    });
 
+    TF_RETURN_IF_ERROR(buf_[index]->status);
     // Place tensors in the output tuple
-    for (const auto& tensor : buf_[index]) {
+    for (const auto& tensor : buf_[index]->tuple) {
       tuple->push_back(tensor);
     }
 
@@ -224,6 +287,68 @@ REGISTER_KERNEL_BUILDER(Name("Stage").Device(DEVICE_GPU), StageOp);
 REGISTER_KERNEL_BUILDER(Name("Stage").Device(DEVICE_SYCL), StageOp);
 #endif // TENSORFLOW_USE_SYCL
 
+// Stages host tensors on the device the op is placed on.  The copies are
+// issued on the device's host-to-device stream and the op returns without
+// waiting for them, so that they overlap with the rest of the step.  The
+// staged element is only handed out by Unstage and StagePeek once all its
+// copies are done.  On the CPU this is the same as Stage.
+class StageToDeviceOp : public OpKernel {
+ public:
+  explicit StageToDeviceOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    Buffer* buf = nullptr;
+    OP_REQUIRES_OK(ctx, GetBuffer(ctx, def(), &buf));
+    core::ScopedUnref scope(buf);
+    Buffer::Tuple tuple;
+    tuple.reserve(ctx->num_inputs());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      tuple.push_back(ctx->input(i));
+    }
+
+    DeviceContext* device_ctxt = ctx->op_device_context();
+    if (device_ctxt == nullptr) {
+      OP_REQUIRES_OK(ctx, buf->Put(&tuple));
+      return;
+    }
+
+    // The host tensors must outlive the copies, which may complete after
+    // this op does.
+    auto host_tuple = std::make_shared<Buffer::Tuple>(tuple);
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      const Tensor& input = ctx->input(i);
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(input.dtype()),
+                  errors::InvalidArgument("StageToDevice can't copy ",
+                                          DataTypeString(input.dtype()),
+                                          " tensors to the device"));
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(input.dtype(), input.shape(),
+                                             &tuple[i]));
+    }
+
+    // Space for the element is taken before the copies are issued, so the
+    // memory limit bounds the device memory of the copies in flight too.
+    std::shared_ptr<Buffer::Element> element;
+    OP_REQUIRES_OK(ctx, buf->PutPending(&tuple, ctx->num_inputs(), &element));
+    Device* device = static_cast<Device*>(ctx->device());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      buf->Ref();
+      device_ctxt->CopyCPUTensorToDevice(
+          &(*host_tuple)[i], device, &element->tuple[i],
+          [buf, element, host_tuple](const Status& s) {
+            buf->CopyDone(element.get(), s);
+            buf->Unref();
+          });
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("StageToDevice").Device(DEVICE_CPU),
+                        StageToDeviceOp);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNEL_BUILDER(Name("StageToDevice").HostMemory("values")
+                        .Device(DEVICE_GPU), StageToDeviceOp);
+#endif
+
 class UnstageOp : public OpKernel {
  public:
   explicit UnstageOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -236,7 +361,7 @@ class UnstageOp : public OpKernel {
     core::ScopedUnref scope(buf);
     Buffer::Tuple tuple;
 
-    buf->Get(&tuple);
+    OP_REQUIRES_OK(ctx, buf->Get(&tuple));
 
     OP_REQUIRES(ctx, tuple.size() == (size_t)ctx->num_outputs(),
         errors::InvalidArgument("Mismatch stage/unstage: ", tuple.size(),
@@ -15,32 +15,82 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <string.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 namespace {
 
-std::vector<string> Split(const string& str, const string& delimiter) {
-  if (!delimiter.empty()) {
-    return str_util::Split(str, delimiter, str_util::SkipEmpty());
+// The set of characters that separate tokens.  A single delimiter, which is
+// the common case, is searched for with memchr, which the C library
+// implements with vector instructions.  Larger sets use a lookup table.
+class Delimiters {
+ public:
+  explicit Delimiters(const string& delimiter) : delimiter_(delimiter) {
+    memset(is_delimiter_, 0, sizeof(is_delimiter_));
+    for (const char c : delimiter) {
+      is_delimiter_[static_cast<uint8>(c)] = true;
+    }
   }
-  std::vector<string> char_vector(str.size());
-  for (size_t i = 0; i < str.size(); ++i) {
-    char_vector[i] = str[i];
+
+  bool empty() const { return delimiter_.empty(); }
+
+  // Returns the first delimiter in [begin, end), or end if there is none.
+  const char* Find(const char* begin, const char* end) const {
+    if (delimiter_.size() == 1) {
+      const void* found = memchr(begin, delimiter_[0], end - begin);
+      return found == nullptr ? end : static_cast<const char*>(found);
+    }
+    while (begin < end && !is_delimiter_[static_cast<uint8>(*begin)]) {
+      ++begin;
+    }
+    return begin;
+  }
+
+ private:
+  const string delimiter_;
+  bool is_delimiter_[256];
+};
+
+// Calls fn on each non-empty token of str.  An empty delimiter splits str
+// into its characters.
+template <typename Fn>
+void ForEachToken(StringPiece str, const Delimiters& delimiters, Fn fn) {
+  const char* begin = str.data();
+  const char* const end = begin + str.size();
+  if (delimiters.empty()) {
+    for (; begin < end; ++begin) {
+      fn(StringPiece(begin, 1));
+    }
+    return;
+  }
+  while (begin < end) {
+    const char* const next = delimiters.Find(begin, end);
+    if (next != begin) {
+      fn(StringPiece(begin, next - begin));
+    }
+    if (next == end) break;
+    begin = next + 1;
   }
-  return char_vector;
 }
 
 }  // namespace
 
+// The inputs are split in two passes, both sharded across the intra-op thread
+// pool: the first counts the tokens of each input, and once the outputs are
+// allocated the second writes the tokens straight into them.  Scanning a
+// string twice is cheaper than collecting its tokens in temporary strings.
 class StringSplitOp : public OpKernel {
  public:
   using OpKernel::OpKernel;
@@ -62,24 +112,34 @@ class StringSplitOp : public OpKernel {
         errors::InvalidArgument("delimiter must scalar, got shape: ",
                                 delimiter_tensor->shape().DebugString()));
     const auto delimiter_vec = delimiter_tensor->flat<string>();
-    const string& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<string> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
+    const Delimiters delimiters(delimiter_vec(0));
 
-    int64 output_size = 0;
+    int64 total_bytes = 0;
+    for (int64 i = 0; i < batch_size; ++i) {
+      total_bytes += input_vec(i).size();
+    }
+    const int64 cost_per_unit =
+        kCostPerByte * (1 + total_bytes / std::max<int64>(1, batch_size));
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+
+    // offsets[i] is the index of the first token of input i in the output.
+    std::vector<int64> offsets(batch_size + 1, 0);
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_unit, [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              int64 n_entries = 0;
+              ForEachToken(input_vec(i), delimiters,
+                           [&n_entries](StringPiece) { ++n_entries; });
+              offsets[i + 1] = n_entries;
+            }
+          });
     int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<string> parts = Split(input_vec(i), delimiter);
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
+      max_num_entries = std::max(max_num_entries, offsets[i + 1]);
+      offsets[i + 1] += offsets[i];
     }
+    const int64 output_size = offsets[batch_size];
 
     Tensor* sp_indices_t;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
@@ -95,16 +155,23 @@ class StringSplitOp : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c) = tokens[c];
-        ++c;
-      }
-    }
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_unit, [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              int64 c = offsets[i];
+              ForEachToken(input_vec(i), delimiters, [&](StringPiece token) {
+                sp_indices(c, 0) = i;
+                sp_indices(c, 1) = c - offsets[i];
+                sp_tokens(c).assign(token.data(), token.size());
+                ++c;
+              });
+            }
+          });
   }
+
+ private:
+  // The approximate cost of scanning and copying one byte of the input.
+  static constexpr int64 kCostPerByte = 2;
 };
 
 REGISTER_KERNEL_BUILDER(Name("StringSplit").Device(DEVICE_CPU), StringSplitOp);
@@ -41,15 +41,20 @@ class LegacyStringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = Hash64(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const int64 num_buckets = num_buckets_;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kStringToHashBucketCost,
+          [&input_flat, &output_flat, num_buckets](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              const uint64 input_hash = Hash64(input_flat(i));
+              const uint64 bucket_id = input_hash % num_buckets;
+              // The number of buckets is always in the positive range of int64
+              // so is the resulting bucket_id. Casting the bucket_id from
+              // uint64 to int64 is safe.
+              output_flat(i) = static_cast<int64>(bucket_id);
+            }
+          });
   }
 
  private:
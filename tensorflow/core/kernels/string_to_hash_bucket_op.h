@@ -23,9 +23,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// The approximate cost of hashing one string into its bucket, used to shard
+// the inputs across the intra-op thread pool.
+static constexpr int64 kStringToHashBucketCost = 100;
+
 template <uint64 hash(const string&)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -44,15 +49,20 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const int64 num_buckets = num_buckets_;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kStringToHashBucketCost,
+          [&input_flat, &output_flat, num_buckets](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              const uint64 input_hash = hash(input_flat(i));
+              const uint64 bucket_id = input_hash % num_buckets;
+              // The number of buckets is always in the positive range of int64
+              // so is the resulting bucket_id. Casting the bucket_id from
+              // uint64 to int64 is safe.
+              output_flat(i) = static_cast<int64>(bucket_id);
+            }
+          });
   }
 
  private:
@@ -86,15 +96,22 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const int64 num_buckets = num_buckets_;
+    const uint64(&key)[2] = key_;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kStringToHashBucketCost,
+          [&input_flat, &output_flat, &key, num_buckets](int64 begin,
+                                                         int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              const uint64 input_hash = hash(key, input_flat(i));
+              const uint64 bucket_id = input_hash % num_buckets;
+              // The number of buckets is always in the positive range of int64
+              // so is the resulting bucket_id. Casting the bucket_id from
+              // uint64 to int64 is safe.
+              output_flat(i) = static_cast<int64>(bucket_id);
+            }
+          });
   }
 
  private:
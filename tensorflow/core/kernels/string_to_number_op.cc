@@ -16,6 +16,7 @@ limitations under the License.
 // See docs in ../ops/parse_ops.cc.
 
 #include <errno.h>
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -24,12 +25,18 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 static constexpr char kErrorMessage[] =
     "StringToNumberOp could not correctly convert string: ";
 
+// The approximate cost of converting one string, used to shard the inputs
+// across the intra-op thread pool.
+static constexpr int64 kStringToNumberCost = 100;
+
 template <typename OutputType>
 class StringToNumberOp : public OpKernel {
  public:
@@ -48,42 +55,49 @@ class StringToNumberOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<OutputType>();
 
-    for (int i = 0; i < input_flat.size(); ++i) {
-      Convert(input_flat(i), &output_flat(i), context);
-    }
+    // If several strings can't be converted, the first one is reported, so
+    // that the error does not depend on how the inputs were sharded.
+    mutex mu;
+    int64 first_error = input_flat.size();
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kStringToNumberCost,
+          [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              if (!Convert(input_flat(i), &output_flat(i))) {
+                mutex_lock l(mu);
+                first_error = std::min(first_error, i);
+                return;
+              }
+            }
+          });
+    OP_REQUIRES(context, first_error == input_flat.size(),
+                errors::InvalidArgument(kErrorMessage,
+                                        input_flat(first_error)));
   }
 
  private:
-  void Convert(const string& s, OutputType* output_data,
-               OpKernelContext* context);
+  static bool Convert(const string& s, OutputType* output_data);
 };
 
 template <>
-void StringToNumberOp<float>::Convert(const string& s, float* output_data,
-                                      OpKernelContext* context) {
-  OP_REQUIRES(context, strings::safe_strtof(s.c_str(), output_data),
-              errors::InvalidArgument(kErrorMessage, s));
+bool StringToNumberOp<float>::Convert(const string& s, float* output_data) {
+  return strings::safe_strtof(s.c_str(), output_data);
 }
 
 template <>
-void StringToNumberOp<double>::Convert(const string& s, double* output_data,
-                                       OpKernelContext* context) {
-  OP_REQUIRES(context, strings::safe_strtod(s.c_str(), output_data),
-              errors::InvalidArgument(kErrorMessage, s));
+bool StringToNumberOp<double>::Convert(const string& s, double* output_data) {
+  return strings::safe_strtod(s.c_str(), output_data);
 }
 
 template <>
-void StringToNumberOp<int32>::Convert(const string& s, int32* output_data,
-                                      OpKernelContext* context) {
-  OP_REQUIRES(context, strings::safe_strto32(s, output_data),
-              errors::InvalidArgument(kErrorMessage, s));
+bool StringToNumberOp<int32>::Convert(const string& s, int32* output_data) {
+  return strings::safe_strto32(s, output_data);
 }
 
 template <>
-void StringToNumberOp<int64>::Convert(const string& s, int64* output_data,
-                                      OpKernelContext* context) {
-  OP_REQUIRES(context, strings::safe_strto64(s, output_data),
-              errors::InvalidArgument(kErrorMessage, s));
+bool StringToNumberOp<int64>::Convert(const string& s, int64* output_data) {
+  return strings::safe_strto64(s, output_data);
 }
 
 // Registers the currently supported output types.
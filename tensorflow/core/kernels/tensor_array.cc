@@ -16,7 +16,10 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/core/kernels/tensor_array.h"
 
+#include <string.h>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/aggregate_ops_cpu.h"
 
@@ -108,4 +111,64 @@ Status TensorArray::CopyShapesFrom(TensorArray* rhs) {
   return Status::OK();
 }
 
+Status TensorArray::LockedCopyToContiguousStorage(OpKernelContext* ctx,
+                                                  const int32 index) {
+  if (!contiguous_storage_) return Status::OK();
+  TensorAndState& t = tensors_[index];
+  if (t.in_storage || t.local_copy || !t.tensor.IsInitialized()) {
+    return Status::OK();
+  }
+  const Tensor* value_t = t.tensor.AccessTensor(ctx);
+  const size_t bytes = value_t->TotalBytes();
+  if (bytes == 0 || bytes % Allocator::kAllocatorAlignment != 0) {
+    return Status::OK();
+  }
+  if (!storage_.IsInitialized()) {
+    TensorShape storage_shape = t.shape;
+    storage_shape.InsertDim(0, tensors_.size());
+    Tensor* unused;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_persistent(dtype_, storage_shape, &storage_, &unused));
+  }
+  Tensor* storage_t = storage_.AccessTensor(ctx);
+  TensorShape element_shape = storage_t->shape();
+  element_shape.RemoveDim(0);
+  if (element_shape != t.shape) return Status::OK();
+
+  Tensor element;
+  CHECK(element.CopyFrom(storage_t->Slice(index, index + 1), t.shape));
+  memcpy(const_cast<char*>(element.tensor_data().data()),
+         value_t->tensor_data().data(), bytes);
+  t.tensor = PersistentTensor(element);
+  t.in_storage = true;
+  ++num_in_storage_;
+  return Status::OK();
+}
+
+bool TensorArray::ReadAllContiguous(OpKernelContext* ctx,
+                                    const std::vector<int32>& indices,
+                                    Tensor* value) {
+  mutex_lock l(mu_);
+  if (closed_ || !storage_.IsInitialized() ||
+      num_in_storage_ != tensors_.size() || indices.size() != tensors_.size()) {
+    return false;
+  }
+  for (int32 i = 0; i < indices.size(); ++i) {
+    if (indices[i] != i || tensors_[i].cleared) return false;
+  }
+  *value = *storage_.AccessTensor(ctx);
+  for (TensorAndState& t : tensors_) {
+    if (clear_after_read_) {
+      t.tensor = PersistentTensor();
+      t.cleared = true;
+    }
+    t.read = true;
+  }
+  if (clear_after_read_) {
+    // The caller now holds the only reference.
+    storage_ = PersistentTensor();
+  }
+  return true;
+}
+
 }  // namespace tensorflow
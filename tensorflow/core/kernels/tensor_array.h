@@ -151,6 +151,8 @@ class TensorArray : public ResourceBase {
         is_grad_(is_grad),
         marked_size_(marked_size),
         element_shape_(element_shape),
+        contiguous_storage_(false),
+        num_in_storage_(0),
         tensors_(N) {}
 
   // Write PersistentTensor 'value' to index 'index'.
@@ -182,11 +184,16 @@ class TensorArray : public ResourceBase {
   //
   // Note, value is passed as a pointer because we its underlying
   // Tensor's shape is accessed.  Otherwise it is not modified.
+  //
+  // With contiguous storage (see UseContiguousStorage), the first write to
+  // 'index' copies the value into the storage instead.
   template <typename Device, typename T>
   Status WriteOrAggregate(OpKernelContext* ctx, const int32 index,
                           PersistentTensor* value) {
     mutex_lock l(mu_);
-    return LockedWriteOrAggregate<Device, T>(ctx, index, value);
+    Status s = LockedWriteOrAggregate<Device, T>(ctx, index, value);
+    TF_RETURN_IF_ERROR(s);
+    return LockedCopyToContiguousStorage(ctx, index);
   }
 
   template <typename Device, typename T>
@@ -240,6 +247,31 @@ class TensorArray : public ResourceBase {
     return Status::OK();
   }
 
+  // Makes WriteOrAggregate copy the values into consecutive slices of one
+  // [N] + element shape tensor, allocated on the first write with the shape
+  // of that value, instead of keeping a reference to them. Reading all the
+  // elements in order with ReadAllContiguous then returns that tensor
+  // without a copy, and the written values are released as soon as they are
+  // copied.
+  //
+  // Only has an effect on fixed-size arrays that don't aggregate writes and
+  // whose dtype can be memcpy-ed; the caller must ensure the array lives in
+  // host memory. Values of another shape than the first one, and values
+  // whose size is not a multiple of Allocator::kAllocatorAlignment (so that
+  // a slice would not be aligned), keep the reference.
+  void UseContiguousStorage() {
+    mutex_lock l(mu_);
+    contiguous_storage_ = !dynamic_size_ && !multiple_writes_aggregate_ &&
+                          DataTypeCanUseMemcpy(dtype_);
+  }
+
+  // If 'indices' is [0, N) and all the elements are in the contiguous
+  // storage, behaves like ReadMany but returns the [N] + element shape
+  // storage in <*value> and returns true. Otherwise returns false and
+  // changes nothing, and the caller should use ReadMany.
+  bool ReadAllContiguous(OpKernelContext* ctx,
+                         const std::vector<int32>& indices, Tensor* value);
+
   DataType ElemType() const { return dtype_; }
 
   PartialTensorShape ElemShape() {
@@ -333,6 +365,7 @@ class TensorArray : public ResourceBase {
   void ClearAndMarkClosed() {
     mutex_lock l(mu_);
     tensors_.clear();
+    storage_ = PersistentTensor();
     closed_ = true;
   }
 
@@ -356,6 +389,11 @@ class TensorArray : public ResourceBase {
   Status LockedRead(OpKernelContext* ctx, const int32 index,
                     PersistentTensor* value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves the value written to 'index' into the contiguous storage, if the
+  // array has one and the value fits.
+  Status LockedCopyToContiguousStorage(OpKernelContext* ctx, const int32 index)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status LockedReturnIfClosed() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (closed_) {
       return errors::InvalidArgument("TensorArray ", handle_.vec<string>()(1),
@@ -400,12 +438,27 @@ class TensorArray : public ResourceBase {
   // known at all.
   PartialTensorShape element_shape_ GUARDED_BY(mu_);
 
+  // True if writes copy their values into storage_. See
+  // UseContiguousStorage.
+  bool contiguous_storage_ GUARDED_BY(mu_);
+
+  // The [N] + element shape tensor the written values are copied to, if
+  // contiguous_storage_ and there has been a write.
+  PersistentTensor storage_ GUARDED_BY(mu_);
+
+  // The number of elements whose tensor is a slice of storage_.
+  int32 num_in_storage_ GUARDED_BY(mu_);
+
   // TensorAndState is used to keep track of the PersistentTensors
   // stored in the TensorArray, along with their shapes, and a boolean
   // that determines whether they have already been read or not.
   struct TensorAndState {
     TensorAndState()
-        : written(false), read(false), cleared(false), local_copy(false) {}
+        : written(false),
+          read(false),
+          cleared(false),
+          local_copy(false),
+          in_storage(false) {}
     PersistentTensor tensor;
     TensorShape shape;
     bool written;  // True if a Tensor has been written to the index.
@@ -420,6 +473,9 @@ class TensorArray : public ResourceBase {
     // aggregated value.  This flag marks that such a Tensor is being
     // used.  All future writes will aggregate to the existing local Tensor.
     bool local_copy;
+
+    // True if the tensor is a slice of the contiguous storage.
+    bool in_storage;
   };
   // The list of underlying PersistentTensors and states.
   std::vector<TensorAndState> tensors_ GUARDED_BY(mu_);
@@ -167,6 +167,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
     OP_REQUIRES_OK(context,
                    context->GetAttr("tensor_array_name", &tensor_array_name_));
     if (tensor_array_name_.empty()) tensor_array_name_ = name();
+    use_contiguous_storage_ = context->device_type() == DEVICE_CPU;
   }
 
   Status CreateTensorArray(OpKernelContext* ctx, ResourceMgr* rm,
@@ -198,6 +199,9 @@ class TensorArrayOp : public TensorArrayCreationOp {
         key, dtype_, *tensor_array_output_handle, size, element_shape_,
         dynamic_size_, false /* multiple_writes_aggregate */,
         false /* is_grad */, -1 /* marked_size */, clear_after_read_);
+    if (use_contiguous_storage_) {
+      tensor_array->UseContiguousStorage();
+    }
 
     TF_RETURN_IF_ERROR(
         rm->Create(ctx->step_container()->name(), key, tensor_array));
@@ -213,6 +217,8 @@ class TensorArrayOp : public TensorArrayCreationOp {
   bool dynamic_size_;
   bool clear_after_read_;
   string tensor_array_name_;  // The name used to create the TensorArray.
+  // Only host memory TensorArrays can copy their elements with memcpy.
+  bool use_contiguous_storage_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(TensorArrayOp);
 };
@@ -612,6 +618,22 @@ class TensorArrayPackOrGatherOp : public OpKernel {
       return;
     }
 
+    // If the elements were written to contiguous storage, stacking them all
+    // in order returns the storage itself.
+    Tensor stacked;
+    if (tensor_array->ReadAllContiguous(ctx, indices, &stacked)) {
+      TensorShape value_0_shape = stacked.shape();
+      value_0_shape.RemoveDim(0);
+      OP_REQUIRES(ctx, element_shape_.IsCompatibleWith(value_0_shape),
+                  errors::InvalidArgument(
+                      "TensorArray was passed element_shape ",
+                      element_shape_.DebugString(),
+                      " which does not match the Tensor at index 0: ",
+                      value_0_shape.DebugString()));
+      ctx->set_output(0, stacked);
+      return;
+    }
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
@@ -818,11 +840,44 @@ class TensorArrayConcatOp : public OpKernel {
       return;
     }
 
+    std::vector<int32> indices(array_size);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    // If the elements were written to contiguous storage, concatenating
+    // them is a reshape of the storage.
+    Tensor stacked;
+    if (tensor_array->ReadAllContiguous(ctx, indices, &stacked)) {
+      TensorShape output_shape = stacked.shape();
+      OP_REQUIRES(
+          ctx, output_shape.dims() >= 2,
+          errors::InvalidArgument(
+              "Concat saw a scalar shape at index 0"
+              " but requires at least vectors.  Did you mean to call pack?"));
+      const int64 length = output_shape.dim_size(1);
+      output_shape.RemoveDim(0);
+      TensorShape output_shape_except0 = output_shape;
+      output_shape_except0.RemoveDim(0);
+      OP_REQUIRES(
+          ctx, element_shape_except0_.IsCompatibleWith(output_shape_except0),
+          errors::InvalidArgument(
+              "TensorArray was passed element_shape_except0 ",
+              element_shape_except0_.DebugString(),
+              " but index 0 has (excepting dimension 0) shape: ",
+              output_shape_except0.DebugString(), " which does not match."));
+      output_shape.set_dim(0, array_size * length);
+      Tensor output;
+      CHECK(output.CopyFrom(stacked, output_shape));
+      ctx->set_output(0, output);
+      Tensor* lengths_tensor = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({array_size}),
+                                               &lengths_tensor));
+      lengths_tensor->vec<int64>().setConstant(length);
+      return;
+    }
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     std::vector<PersistentTensor> values;
-    std::vector<int32> indices(array_size);
-    std::iota(indices.begin(), indices.end(), 0);
     Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
     OP_REQUIRES_OK(ctx, s);
 
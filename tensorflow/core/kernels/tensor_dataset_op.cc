@@ -71,8 +71,9 @@ class TensorDatasetOp : public DatasetOpKernel {
       explicit Iterator(const Dataset* dataset)
           : DatasetIterator<Dataset>(dataset), produced_(false) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (!produced_) {
           *out_tensors = dataset()->tensors_;
@@ -139,8 +139,9 @@ class TensorSliceDatasetOp : public DatasetOpKernel {
             i_(0),
             n_(dataset->tensors_[0].dim_size(0)) {}
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (i_ < n_) {
           out_tensors->clear();
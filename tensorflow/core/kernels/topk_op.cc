@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <cstring>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -97,6 +99,162 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace internal {
+
+// Rows at least this long with at least kRadixSelectMinK requested elements
+// are selected with RadixSelectTopK rather than the TopN heap, whose
+// per-element cost grows with log(k).
+const int64 kRadixSelectMinCols = 1024;
+const int kRadixSelectMinK = 64;
+
+// Maps values of T to unsigned keys whose natural order matches the order of
+// the values, so that the k largest keys are the k largest values.
+template <typename T, typename Enable = void>
+struct RadixKey;
+
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+  typedef typename std::make_unsigned<T>::type Key;
+  static Key Get(const T v) {
+    Key key = static_cast<Key>(v);
+    if (std::is_signed<T>::value) {
+      key ^= Key(1) << (sizeof(Key) * 8 - 1);
+    }
+    return key;
+  }
+};
+
+// Floating point keys flip all bits of negative values and only the sign bit
+// of positive values.  Zeros are canonicalized so that -0.0 and 0.0 compare
+// equal, as they do for the heap-based path.
+template <typename Key>
+Key FloatBitsToRadixKey(const Key bits) {
+  const Key sign = Key(1) << (sizeof(Key) * 8 - 1);
+  return (bits & sign) ? static_cast<Key>(~bits) : (bits | sign);
+}
+
+template <>
+struct RadixKey<float> {
+  typedef uint32 Key;
+  static Key Get(const float v) {
+    Key bits = 0;
+    if (v != 0.0f) std::memcpy(&bits, &v, sizeof(bits));
+    return FloatBitsToRadixKey(bits);
+  }
+};
+
+template <>
+struct RadixKey<double> {
+  typedef uint64 Key;
+  static Key Get(const double v) {
+    Key bits = 0;
+    if (v != 0.0) std::memcpy(&bits, &v, sizeof(bits));
+    return FloatBitsToRadixKey(bits);
+  }
+};
+
+template <>
+struct RadixKey<Eigen::half> {
+  typedef uint16 Key;
+  static Key Get(const Eigen::half v) {
+    const Key bits = static_cast<float>(v) != 0.0f ? v.x : 0;
+    return FloatBitsToRadixKey(bits);
+  }
+};
+
+// Writes the column indices of the k largest of the num_cols values in input
+// to indices, breaking ties in favor of the lower index, in increasing index
+// order (or in decreasing value order if sorted is true).  Selection is an
+// MSD radix select over 8-bit digits of the radix keys: each pass histograms
+// the surviving candidates, keeps only the bucket holding the k-th largest
+// key, and stops once that bucket is taken whole.  keys and candidates are
+// scratch buffers reused across rows.
+template <typename T>
+void RadixSelectTopK(const T* input, const int32 num_cols, const int k,
+                     const bool sorted,
+                     std::vector<typename RadixKey<T>::Key>* keys,
+                     std::vector<int32>* candidates, int32* indices) {
+  typedef typename RadixKey<T>::Key Key;
+  constexpr int kRadixBits = 8;
+  constexpr int kRadix = 1 << kRadixBits;
+
+  keys->resize(num_cols);
+  Key* key_data = keys->data();
+  for (int32 c = 0; c < num_cols; ++c) {
+    key_data[c] = RadixKey<T>::Get(input[c]);
+  }
+
+  // The selected elements are those whose key, restricted to mask, is above
+  // prefix, plus the first remaining elements (by index) equal to it.
+  Key prefix = 0;
+  Key mask = 0;
+  int32 remaining = k;
+  int32 num_candidates = num_cols;
+  bool all_candidates = true;
+  candidates->resize(num_cols);
+  int32* candidate_data = candidates->data();
+  int32 histogram[kRadix];
+  for (int shift = sizeof(Key) * 8 - kRadixBits; shift >= 0;
+       shift -= kRadixBits) {
+    std::fill(histogram, histogram + kRadix, 0);
+    if (all_candidates) {
+      for (int32 c = 0; c < num_cols; ++c) {
+        ++histogram[(key_data[c] >> shift) & (kRadix - 1)];
+      }
+    } else {
+      for (int32 i = 0; i < num_candidates; ++i) {
+        ++histogram[(key_data[candidate_data[i]] >> shift) & (kRadix - 1)];
+      }
+    }
+    int digit = kRadix - 1;
+    while (histogram[digit] < remaining) {
+      remaining -= histogram[digit];
+      --digit;
+    }
+    prefix |= static_cast<Key>(Key(digit) << shift);
+    mask |= static_cast<Key>(Key(kRadix - 1) << shift);
+    if (histogram[digit] == remaining || shift == 0) break;
+
+    int32 num_next = 0;
+    if (all_candidates) {
+      for (int32 c = 0; c < num_cols; ++c) {
+        if (((key_data[c] >> shift) & (kRadix - 1)) == digit) {
+          candidate_data[num_next++] = c;
+        }
+      }
+      all_candidates = false;
+    } else {
+      for (int32 i = 0; i < num_candidates; ++i) {
+        const int32 c = candidate_data[i];
+        if (((key_data[c] >> shift) & (kRadix - 1)) == digit) {
+          candidate_data[num_next++] = c;
+        }
+      }
+    }
+    num_candidates = num_next;
+  }
+
+  int32 num_selected = 0;
+  for (int32 c = 0; num_selected < k; ++c) {
+    const Key masked = key_data[c] & mask;
+    if (masked > prefix) {
+      indices[num_selected++] = c;
+    } else if (masked == prefix && remaining > 0) {
+      indices[num_selected++] = c;
+      --remaining;
+    }
+  }
+
+  if (sorted) {
+    std::sort(indices, indices + k, [key_data](const int32 a, const int32 b) {
+      return key_data[a] > key_data[b] ||
+             (key_data[a] == key_data[b] && a < b);
+    });
+  }
+}
+
+}  // namespace internal
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -132,7 +290,13 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    const bool use_radix_select = k < num_cols &&
+                                  k >= internal::kRadixSelectMinK &&
+                                  num_cols >= internal::kRadixSelectMinCols;
+
     auto SortIndices = [&, context](int start_batch, int limit_batch) {
+      std::vector<typename internal::RadixKey<T>::Key> keys;
+      std::vector<int32> candidates;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32 a, const int32 b) {
@@ -147,12 +311,10 @@ struct TopKFunctor<CPUDevice, T> {
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
-        if (k == num_cols) {
+        if (use_radix_select) {
+          internal::RadixSelectTopK(input_data, num_cols, k, sorted, &keys,
+                                    &candidates, &indices(b, 0));
+        } else if (k == num_cols) {
           // Set the initial array of indices 0 ... k - 1.
           std::iota(&indices(b, 0), &indices(b, k), 0);
           // Use an in-place sort.
@@ -194,7 +356,15 @@ struct TopKFunctor<CPUDevice, T> {
         cmp_cost *
         static_cast<double>(num_cols *
                             Eigen::numext::log2(static_cast<float>(k + 1)));
-    const double sort_cost = (k == num_cols) ? base_cost : 4 * base_cost;
+    // The radix select makes a few linear passes over the row and sorts only
+    // the k selected elements.
+    const double radix_cost =
+        cmp_cost *
+        (4.0 * num_cols +
+         (sorted ? k * Eigen::numext::log2(static_cast<float>(k + 1)) : 0.0));
+    const double sort_cost = use_radix_select
+                                 ? radix_cost
+                                 : (k == num_cols) ? base_cost : 4 * base_cost;
     const double copy_cost = 2 * k * Eigen::TensorOpCost::AddCost<T>();
     const double total_cost = sort_cost + copy_cost;
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
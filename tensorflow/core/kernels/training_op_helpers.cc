@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
+#include <algorithm>
 #include "tensorflow/core/kernels/variable_ops.h"
 
 namespace tensorflow {
@@ -45,24 +46,23 @@ std::vector<mutex_lock> MaybeLockVariableInputMutexesInOrder(
     return locks;
   }
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
+  mutexes.reserve(input_ids.size());
   for (auto input : input_ids) {
-    mutex* mutex = GetTrainingVariableMutex(ctx, input);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
-    }
-  }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
-
-  for (auto input : acquire_order) {
     mutex* mu = GetTrainingVariableMutex(ctx, input);
     if (mu != nullptr) {
-      locks.emplace_back(*mu);
+      mutexes.push_back(mu);
     }
   }
+  // Only lock each mutex once if duplicates exist.  Sorting rather than a
+  // linear search keeps this cheap for the multi-tensor ops, which lock a few
+  // mutexes per variable for thousands of variables.
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
+
+  locks.reserve(mutexes.size());
+  for (mutex* mu : mutexes) {
+    locks.emplace_back(*mu);
+  }
   return locks;
 }
 
@@ -17,12 +17,17 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_ops.h"
 #include <algorithm>
+#include <numeric>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/gpu_device_array.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
 #endif  // TENSORFLOW_USE_SYCL
@@ -40,6 +45,43 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// Calls fn(tensor, begin, end) with the range of elements of every variable of
+// a multi-tensor update that falls in chunks [first_chunk, last_chunk).
+// `tensors` is ordered by first_chunk and has no empty variables.
+template <typename Args, typename Fn>
+void ForEachMultiTensorRange(const std::vector<Args>& tensors,
+                             int64 first_chunk, int64 last_chunk, Fn fn) {
+  auto it = std::upper_bound(
+      tensors.begin(), tensors.end(), first_chunk,
+      [](int64 chunk, const Args& t) { return chunk < t.first_chunk; });
+  for (--it; it != tensors.end() && it->first_chunk < last_chunk; ++it) {
+    const int64 begin = std::max<int64>(first_chunk - it->first_chunk, 0) *
+                        functor::kMultiTensorChunkSize;
+    const int64 end = std::min<int64>(
+        (last_chunk - it->first_chunk) * functor::kMultiTensorChunkSize,
+        it->size);
+    fn(*it, begin, end);
+  }
+}
+
+// Returns the number of chunks of a variable of `size` elements.
+inline int64 NumMultiTensorChunks(int64 size) {
+  return (size + functor::kMultiTensorChunkSize - 1) /
+         functor::kMultiTensorChunkSize;
+}
+
+// Returns an error if two of `buffers` are the same.  The multi-tensor ops
+// update their variables concurrently, so a repeated variable would race with
+// itself.
+Status CheckDistinctVariables(std::vector<const void*> buffers) {
+  std::sort(buffers.begin(), buffers.end());
+  if (std::adjacent_find(buffers.begin(), buffers.end()) != buffers.end()) {
+    return errors::InvalidArgument(
+        "The same variable is passed more than once to a multi-tensor update");
+  }
+  return Status::OK();
+}
 }  // namespace
 
 namespace functor {
@@ -2423,6 +2465,170 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+struct LaunchApplyMomentumN;
+
+template <typename T>
+struct LaunchApplyMomentumN<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx,
+                  const std::vector<functor::MomentumNTensor<T>>& tensors,
+                  int64 num_chunks, const Tensor& lr, const Tensor& momentum,
+                  bool use_nesterov) {
+    const T lr_scalar = lr.scalar<T>()();
+    const T momentum_scalar = momentum.scalar<T>()();
+    auto update = [&](const functor::MomentumNTensor<T>& t, int64 begin,
+                      int64 end) {
+      typename TTypes<T>::Flat var(t.var + begin, end - begin);
+      typename TTypes<T>::Flat accum(t.accum + begin, end - begin);
+      typename TTypes<T>::ConstFlat grad(t.grad + begin, end - begin);
+      accum = accum * momentum_scalar + grad;
+      if (use_nesterov) {
+        var -= grad * lr_scalar + accum * momentum_scalar * lr_scalar;
+      } else {
+        var -= accum * lr_scalar;
+      }
+    };
+    const double chunk_bytes = functor::kMultiTensorChunkSize * sizeof(T);
+    ctx->eigen_device<CPUDevice>().parallelFor(
+        num_chunks,
+        Eigen::TensorOpCost(3 * chunk_bytes, 2 * chunk_bytes,
+                            4 * functor::kMultiTensorChunkSize),
+        [&](int64 first, int64 last) {
+          ForEachMultiTensorRange(tensors, first, last, update);
+        });
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+template <typename T>
+void ApplyMomentumNGPU(
+    const GPUDevice& d,
+    const GpuDeviceArrayStruct<functor::MomentumNTensor<T>>& tensors,
+    int64 num_chunks, const T* lr, const T* momentum, bool use_nesterov);
+
+// Updates all the variables with a single kernel launch over an array of
+// per-variable pointers.
+template <typename T>
+struct LaunchApplyMomentumN<GPUDevice, T> {
+  void operator()(OpKernelContext* ctx,
+                  const std::vector<functor::MomentumNTensor<T>>& tensors,
+                  int64 num_chunks, const Tensor& lr, const Tensor& momentum,
+                  bool use_nesterov) {
+    GpuDeviceArrayOnHost<functor::MomentumNTensor<T>> tensor_array(
+        ctx, tensors.size());
+    OP_REQUIRES_OK(ctx, tensor_array.Init());
+    for (int i = 0; i < tensors.size(); ++i) {
+      tensor_array.Set(i, tensors[i]);
+    }
+    OP_REQUIRES_OK(ctx, tensor_array.Finalize());
+    ApplyMomentumNGPU<T>(ctx->eigen_device<GPUDevice>(), tensor_array.data(),
+                         num_chunks, lr.flat<T>().data(),
+                         momentum.flat<T>().data(), use_nesterov);
+  }
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Device, typename T>
+class ApplyMomentumNOp : public OpKernel {
+ public:
+  explicit ApplyMomentumNOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> var_inputs(2 * n);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      var_inputs);
+
+    std::vector<Tensor> vars(2 * n);
+    for (int i = 0; i < 2 * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable(
+                              ctx, i, use_exclusive_lock_, &vars[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+    const Tensor& lr = ctx->input(2 * n);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& momentum = ctx->input(3 * n + 1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(momentum.shape()),
+                errors::InvalidArgument("momentum is not a scalar: ",
+                                        momentum.shape().DebugString()));
+
+    std::vector<functor::MomentumNTensor<T>> tensors;
+    std::vector<const void*> buffers;
+    tensors.reserve(n);
+    buffers.reserve(n);
+    int64 num_chunks = 0;
+    for (int i = 0; i < n; ++i) {
+      Tensor& var = vars[i];
+      Tensor& accum = vars[n + i];
+      const Tensor& grad = ctx->input(2 * n + 1 + i);
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(accum.shape()),
+          errors::InvalidArgument("var and accum do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  accum.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      const int64 size = var.NumElements();
+      if (size == 0) continue;
+      tensors.push_back({var.flat<T>().data(), accum.flat<T>().data(),
+                         grad.flat<T>().data(), size, num_chunks});
+      buffers.push_back(var.tensor_data().data());
+      num_chunks += NumMultiTensorChunks(size);
+    }
+    OP_REQUIRES_OK(ctx, CheckDistinctVariables(std::move(buffers)));
+
+    if (num_chunks > 0) {
+      LaunchApplyMomentumN<Device, T>()(ctx, tensors, num_chunks, lr, momentum,
+                                        use_nesterov_);
+    }
+    for (int i = 0; i < n; ++i) {
+      MaybeForwardRefInputToRefOutput(ctx, i, i);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                          \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("ApplyMomentumN").Device(DEVICE_##D).TypeConstraint<T>("T"), \
+      ApplyMomentumNOp<D##Device, T>);                                  \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyMomentumN")                \
+                              .Device(DEVICE_##D)                       \
+                              .HostMemory("var")                        \
+                              .HostMemory("accum")                      \
+                              .TypeConstraint<T>("T"),                  \
+                          ApplyMomentumNOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 // Note, this op works on cpu only.
 template <typename T, typename Tindex>
 class SparseApplyMomentumOp : public OpKernel {
@@ -2804,6 +3010,186 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+struct LaunchApplyAdamN;
+
+template <typename T>
+struct LaunchApplyAdamN<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx,
+                  const std::vector<functor::AdamNTensor<T>>& tensors,
+                  int64 num_chunks, const Tensor& beta1_power,
+                  const Tensor& beta2_power, const Tensor& lr,
+                  const Tensor& beta1, const Tensor& beta2,
+                  const Tensor& epsilon, bool use_nesterov) {
+    Eigen::DefaultDevice d;
+    auto update = [&](const functor::AdamNTensor<T>& t, int64 begin,
+                      int64 end) {
+      functor::ApplyAdamNonCuda<Eigen::DefaultDevice, T>()(
+          d, typename TTypes<T>::Flat(t.var + begin, end - begin),
+          typename TTypes<T>::Flat(t.m + begin, end - begin),
+          typename TTypes<T>::Flat(t.v + begin, end - begin),
+          beta1_power.scalar<T>(), beta2_power.scalar<T>(), lr.scalar<T>(),
+          beta1.scalar<T>(), beta2.scalar<T>(), epsilon.scalar<T>(),
+          typename TTypes<T>::ConstFlat(t.grad + begin, end - begin),
+          use_nesterov);
+    };
+    const double chunk_bytes = functor::kMultiTensorChunkSize * sizeof(T);
+    ctx->eigen_device<CPUDevice>().parallelFor(
+        num_chunks,
+        Eigen::TensorOpCost(4 * chunk_bytes, 3 * chunk_bytes,
+                            10 * functor::kMultiTensorChunkSize),
+        [&](int64 first, int64 last) {
+          ForEachMultiTensorRange(tensors, first, last, update);
+        });
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+template <typename T>
+void ApplyAdamNGPU(const GPUDevice& d,
+                   const GpuDeviceArrayStruct<functor::AdamNTensor<T>>& tensors,
+                   int64 num_chunks, const T* beta1_power,
+                   const T* beta2_power, const T* lr, const T* beta1,
+                   const T* beta2, const T* epsilon, bool use_nesterov);
+
+// Updates all the variables with a single kernel launch over an array of
+// per-variable pointers.
+template <typename T>
+struct LaunchApplyAdamN<GPUDevice, T> {
+  void operator()(OpKernelContext* ctx,
+                  const std::vector<functor::AdamNTensor<T>>& tensors,
+                  int64 num_chunks, const Tensor& beta1_power,
+                  const Tensor& beta2_power, const Tensor& lr,
+                  const Tensor& beta1, const Tensor& beta2,
+                  const Tensor& epsilon, bool use_nesterov) {
+    GpuDeviceArrayOnHost<functor::AdamNTensor<T>> tensor_array(ctx,
+                                                              tensors.size());
+    OP_REQUIRES_OK(ctx, tensor_array.Init());
+    for (int i = 0; i < tensors.size(); ++i) {
+      tensor_array.Set(i, tensors[i]);
+    }
+    OP_REQUIRES_OK(ctx, tensor_array.Finalize());
+    ApplyAdamNGPU<T>(ctx->eigen_device<GPUDevice>(), tensor_array.data(),
+                     num_chunks, beta1_power.flat<T>().data(),
+                     beta2_power.flat<T>().data(), lr.flat<T>().data(),
+                     beta1.flat<T>().data(), beta2.flat<T>().data(),
+                     epsilon.flat<T>().data(), use_nesterov);
+  }
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+template <typename Device, typename T>
+class ApplyAdamNOp : public OpKernel {
+ public:
+  explicit ApplyAdamNOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> var_inputs(3 * n);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      var_inputs);
+
+    std::vector<Tensor> vars(3 * n);
+    for (int i = 0; i < 3 * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable(
+                              ctx, i, use_exclusive_lock_, &vars[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+
+    static const char* const kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    for (int i = 0; i < 6; ++i) {
+      const Tensor& scalar = ctx->input(3 * n + i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar.shape().DebugString()));
+    }
+
+    std::vector<functor::AdamNTensor<T>> tensors;
+    std::vector<const void*> buffers;
+    tensors.reserve(n);
+    buffers.reserve(n);
+    int64 num_chunks = 0;
+    for (int i = 0; i < n; ++i) {
+      Tensor& var = vars[i];
+      Tensor& m = vars[n + i];
+      Tensor& v = vars[2 * n + i];
+      const Tensor& grad = ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(m.shape()),
+          errors::InvalidArgument("var and m do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  m.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(v.shape()),
+          errors::InvalidArgument("var and v do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  v.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      const int64 size = var.NumElements();
+      if (size == 0) continue;
+      tensors.push_back({var.flat<T>().data(), m.flat<T>().data(),
+                         v.flat<T>().data(), grad.flat<T>().data(), size,
+                         num_chunks});
+      buffers.push_back(var.tensor_data().data());
+      num_chunks += NumMultiTensorChunks(size);
+    }
+    OP_REQUIRES_OK(ctx, CheckDistinctVariables(std::move(buffers)));
+
+    if (num_chunks > 0) {
+      LaunchApplyAdamN<Device, T>()(
+          ctx, tensors, num_chunks, ctx->input(3 * n), ctx->input(3 * n + 1),
+          ctx->input(3 * n + 2), ctx->input(3 * n + 3), ctx->input(3 * n + 4),
+          ctx->input(3 * n + 5), use_nesterov_);
+    }
+    for (int i = 0; i < n; ++i) {
+      MaybeForwardRefInputToRefOutput(ctx, i, i);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                      \
+  REGISTER_KERNEL_BUILDER(                                          \
+      Name("ApplyAdamN").Device(DEVICE_##D).TypeConstraint<T>("T"), \
+      ApplyAdamNOp<D##Device, T>);                                  \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamN")                \
+                              .HostMemory("var")                    \
+                              .HostMemory("m")                      \
+                              .HostMemory("v")                      \
+                              .Device(DEVICE_##D)                   \
+                              .TypeConstraint<T>("T"),              \
+                          ApplyAdamNOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyRMSPropOp : public OpKernel {
  public:
@@ -170,6 +170,35 @@ struct ApplyCenteredRMSProp {
                   typename TTypes<T>::ConstScalar epsilon,
                   typename TTypes<T>::ConstFlat grad);
 };
+
+// The multi-tensor ("ApplyXYZN") variants update a list of variables in a
+// single kernel.  Every variable is split into chunks of
+// kMultiTensorChunkSize elements, which are the units of work handed out to
+// threads on CPU and to thread blocks on GPU.
+static constexpr int64 kMultiTensorChunkSize = 16 << 10;
+
+// One variable of an ApplyMomentumN update.  first_chunk is the index of the
+// first chunk of this variable among the chunks of all variables.
+template <typename T>
+struct MomentumNTensor {
+  T* var;
+  T* accum;
+  const T* grad;
+  int64 size;
+  int64 first_chunk;
+};
+
+// One variable of an ApplyAdamN update.  See MomentumNTensor.
+template <typename T>
+struct AdamNTensor {
+  T* var;
+  T* m;
+  T* v;
+  const T* grad;
+  int64 size;
+  int64 first_chunk;
+};
+
 }  // end namespace functor
 }  // end namespace tensorflow
 
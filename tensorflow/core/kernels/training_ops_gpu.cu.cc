@@ -20,11 +20,102 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_ops.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/gpu_device_array_gpu.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
 
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Each block of the multi-tensor kernels updates one chunk.
+constexpr int kMultiTensorThreadsPerBlock = 256;
+
+// Finds the variable owning `chunk`: the last one starting at or before it.
+template <typename Args>
+__device__ const Args& FindChunkTensor(const Args* tensors, int size,
+                                       int64 chunk) {
+  int lo = 0;
+  int hi = size - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (tensors[mid].first_chunk <= chunk) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return tensors[lo];
+}
+
+template <typename T>
+__global__ void ApplyMomentumNKernel(
+    GpuDeviceArrayStruct<functor::MomentumNTensor<T>> tensor_data,
+    const T* lr_ptr, const T* momentum_ptr, bool use_nesterov) {
+  typedef typename std::conditional<std::is_same<T, Eigen::half>::value,
+                                    float, T>::type Acc;
+  const functor::MomentumNTensor<T>& t = FindChunkTensor(
+      GetGpuDeviceArrayOnDevice(&tensor_data), tensor_data.size, blockIdx.x);
+  const Acc lr = static_cast<Acc>(*lr_ptr);
+  const Acc momentum = static_cast<Acc>(*momentum_ptr);
+  const int64 start =
+      (blockIdx.x - t.first_chunk) * functor::kMultiTensorChunkSize;
+  const int64 limit = start + functor::kMultiTensorChunkSize < t.size
+                          ? start + functor::kMultiTensorChunkSize
+                          : t.size;
+  for (int64 i = start + threadIdx.x; i < limit;
+       i += kMultiTensorThreadsPerBlock) {
+    const Acc grad = static_cast<Acc>(t.grad[i]);
+    const Acc accum = static_cast<Acc>(t.accum[i]) * momentum + grad;
+    const Acc update =
+        use_nesterov ? grad * lr + accum * momentum * lr : accum * lr;
+    t.accum[i] = static_cast<T>(accum);
+    t.var[i] = static_cast<T>(static_cast<Acc>(t.var[i]) - update);
+  }
+}
+
+template <typename T>
+__global__ void ApplyAdamNKernel(
+    GpuDeviceArrayStruct<functor::AdamNTensor<T>> tensor_data,
+    const T* beta1_power_ptr, const T* beta2_power_ptr, const T* lr_ptr,
+    const T* beta1_ptr, const T* beta2_ptr, const T* epsilon_ptr,
+    bool use_nesterov) {
+  typedef typename std::conditional<std::is_same<T, Eigen::half>::value,
+                                    float, T>::type Acc;
+  const functor::AdamNTensor<T>& t = FindChunkTensor(
+      GetGpuDeviceArrayOnDevice(&tensor_data), tensor_data.size, blockIdx.x);
+  const Acc one(1);
+  const Acc beta1 = static_cast<Acc>(*beta1_ptr);
+  const Acc beta2 = static_cast<Acc>(*beta2_ptr);
+  const Acc epsilon = static_cast<Acc>(*epsilon_ptr);
+  const Acc alpha =
+      static_cast<Acc>(*lr_ptr) *
+      Eigen::numext::sqrt(one - static_cast<Acc>(*beta2_power_ptr)) /
+      (one - static_cast<Acc>(*beta1_power_ptr));
+  const int64 start =
+      (blockIdx.x - t.first_chunk) * functor::kMultiTensorChunkSize;
+  const int64 limit = start + functor::kMultiTensorChunkSize < t.size
+                          ? start + functor::kMultiTensorChunkSize
+                          : t.size;
+  for (int64 i = start + threadIdx.x; i < limit;
+       i += kMultiTensorThreadsPerBlock) {
+    const Acc grad = static_cast<Acc>(t.grad[i]);
+    Acc m = static_cast<Acc>(t.m[i]);
+    Acc v = static_cast<Acc>(t.v[i]);
+    m += (grad - m) * (one - beta1);
+    v += (grad * grad - v) * (one - beta2);
+    const Acc update = use_nesterov ? grad * (one - beta1) + beta1 * m : m;
+    t.m[i] = static_cast<T>(m);
+    t.v[i] = static_cast<T>(v);
+    t.var[i] = static_cast<T>(static_cast<Acc>(t.var[i]) -
+                              update * alpha /
+                                  (Eigen::numext::sqrt(v) + epsilon));
+  }
+}
+
+}  // namespace
+
 namespace functor {
 template <typename T>
 struct ApplyGradientDescent<GPUDevice, T> {
@@ -196,6 +287,28 @@ struct ApplyCenteredRMSProp<GPUDevice, T> {
 
 }  // namespace functor
 
+template <typename T>
+void ApplyMomentumNGPU(
+    const GPUDevice& d,
+    const GpuDeviceArrayStruct<functor::MomentumNTensor<T>>& tensors,
+    int64 num_chunks, const T* lr, const T* momentum, bool use_nesterov) {
+  GPU_LAUNCH_KERNEL(ApplyMomentumNKernel<T>, dim3(num_chunks),
+                    dim3(kMultiTensorThreadsPerBlock), 0, d.stream(), tensors,
+                    lr, momentum, use_nesterov);
+}
+
+template <typename T>
+void ApplyAdamNGPU(const GPUDevice& d,
+                   const GpuDeviceArrayStruct<functor::AdamNTensor<T>>& tensors,
+                   int64 num_chunks, const T* beta1_power,
+                   const T* beta2_power, const T* lr, const T* beta1,
+                   const T* beta2, const T* epsilon, bool use_nesterov) {
+  GPU_LAUNCH_KERNEL(ApplyAdamNKernel<T>, dim3(num_chunks),
+                    dim3(kMultiTensorThreadsPerBlock), 0, d.stream(), tensors,
+                    beta1_power, beta2_power, lr, beta1, beta2, epsilon,
+                    use_nesterov);
+}
+
 template struct functor::ApplyGradientDescent<GPUDevice, Eigen::half>;
 template struct functor::ApplyGradientDescent<GPUDevice, float>;
 template struct functor::ApplyGradientDescent<GPUDevice, double>;
@@ -223,6 +336,22 @@ template struct functor::ApplyRMSProp<GPUDevice, double>;
 template struct functor::ApplyCenteredRMSProp<GPUDevice, Eigen::half>;
 template struct functor::ApplyCenteredRMSProp<GPUDevice, float>;
 template struct functor::ApplyCenteredRMSProp<GPUDevice, double>;
+
+#define DEFINE_MULTI_TENSOR_GPU(T)                                          \
+  template void ApplyMomentumNGPU<T>(                                       \
+      const GPUDevice& d,                                                   \
+      const GpuDeviceArrayStruct<functor::MomentumNTensor<T>>& tensors,     \
+      int64 num_chunks, const T* lr, const T* momentum, bool use_nesterov); \
+  template void ApplyAdamNGPU<T>(                                           \
+      const GPUDevice& d,                                                   \
+      const GpuDeviceArrayStruct<functor::AdamNTensor<T>>& tensors,         \
+      int64 num_chunks, const T* beta1_power, const T* beta2_power,         \
+      const T* lr, const T* beta1, const T* beta2, const T* epsilon,        \
+      bool use_nesterov);
+DEFINE_MULTI_TENSOR_GPU(Eigen::half);
+DEFINE_MULTI_TENSOR_GPU(float);
+DEFINE_MULTI_TENSOR_GPU(double);
+#undef DEFINE_MULTI_TENSOR_GPU
 }  // end namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
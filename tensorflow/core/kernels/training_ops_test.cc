@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -193,6 +194,85 @@ static void BM_Adam(int iters, int params) {
 }
 BENCHMARK(BM_Adam)->Arg(128 << 10)->Arg(256 << 10);
 
+// Updates num_vars variables of n elements each, with either one ApplyAdam per
+// variable or a single ApplyAdamN.
+static void AdamMany(int32 num_vars, int32 n, bool fused, Graph** init_g,
+                     Graph** train_g) {
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    std::vector<Node*> vars;
+    for (int i = 0; i < 3 * num_vars; ++i) {
+      vars.push_back(Var(g, n));
+    }
+    auto zero = Zeros(g, n);
+    for (Node* var : vars) {
+      test::graph::Assign(g, var, zero);
+    }
+    *init_g = g;
+  }
+  {
+    Graph* g = new Graph(OpRegistry::Global());
+    std::vector<NodeBuilder::NodeOut> var, m, v, grad;
+    for (int i = 0; i < num_vars; ++i) {
+      var.emplace_back(Var(g, n));
+      m.emplace_back(Var(g, n));
+      v.emplace_back(Var(g, n));
+    }
+    auto beta1_power = Scalar(g, 0.9);
+    auto beta2_power = Scalar(g, 0.99);
+    auto lr = Scalar(g, 0.01);
+    auto beta1 = Scalar(g, 0.9);
+    auto beta2 = Scalar(g, 0.99);
+    auto epsilon = Scalar(g, 1e-8);
+    auto random = Random(g, n);
+    for (int i = 0; i < num_vars; ++i) {
+      grad.emplace_back(random);
+    }
+    if (fused) {
+      TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ApplyAdamN")
+                      .Input(var)
+                      .Input(m)
+                      .Input(v)
+                      .Input(beta1_power)
+                      .Input(beta2_power)
+                      .Input(lr)
+                      .Input(beta1)
+                      .Input(beta2)
+                      .Input(epsilon)
+                      .Input(grad)
+                      .Finalize(g, nullptr));
+    } else {
+      for (int i = 0; i < num_vars; ++i) {
+        test::graph::Multi(g, "ApplyAdam",
+                           {var[i].node, m[i].node, v[i].node, beta1_power,
+                            beta2_power, lr, beta1, beta2, epsilon, random});
+      }
+    }
+    *train_g = g;
+  }
+}
+
+static void BM_AdamMany(int iters, int num_vars, bool fused) {
+  const int n = 1 << 10;
+  const int64 tot = static_cast<int64>(iters) * num_vars * n;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * sizeof(float));
+  Graph* init;
+  Graph* train;
+  AdamMany(num_vars, n, fused, &init, &train);
+  test::Benchmark("cpu", train, GetOptions(), init).Run(iters);
+}
+
+static void BM_AdamPerVariable(int iters, int num_vars) {
+  BM_AdamMany(iters, num_vars, false);
+}
+BENCHMARK(BM_AdamPerVariable)->Arg(100)->Arg(1500);
+
+static void BM_AdamN(int iters, int num_vars) {
+  BM_AdamMany(iters, num_vars, true);
+}
+BENCHMARK(BM_AdamN)->Arg(100)->Arg(1500);
+
 static void RMSProp(int32 n, Graph** init_g, Graph** train_g) {
   TensorShape shape({n});
   {
@@ -0,0 +1,181 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TransposeOpTest : public OpsTestBase {
+ protected:
+  // Transposes a tensor of `dims` filled with 0, 1, 2, ... by `perm` and
+  // compares the result against a naive element-by-element transpose.
+  template <typename T>
+  void RunAndCheck(const std::vector<int64>& dims,
+                   const std::vector<int32>& perm) {
+    TF_ASSERT_OK(NodeDefBuilder("transpose", "Transpose")
+                     .Input(FakeInput(DataTypeToEnum<T>::v()))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    const TensorShape in_shape(dims);
+    AddInput<T>(in_shape, [](int i) -> T { return static_cast<T>(i); });
+    AddInputFromArray<int32>(TensorShape({static_cast<int64>(perm.size())}),
+                             perm);
+    TF_ASSERT_OK(RunOpKernel());
+
+    TensorShape out_shape;
+    for (int32 p : perm) out_shape.AddDim(dims[p]);
+    Tensor expected(allocator(), DataTypeToEnum<T>::v(), out_shape);
+    const auto in_strides = ComputeStride<int64>(in_shape);
+    const auto out_strides = ComputeStride<int64>(out_shape);
+    auto expected_flat = expected.flat<T>();
+    for (int64 o = 0; o < out_shape.num_elements(); ++o) {
+      int64 i = 0;
+      int64 t = o;
+      for (int d = 0; d < out_shape.dims(); ++d) {
+        i += (t / out_strides[d]) * in_strides[perm[d]];
+        t %= out_strides[d];
+      }
+      expected_flat(o) = static_cast<T>(i);
+    }
+    test::ExpectTensorEqual<T>(expected, *GetOutput(0));
+  }
+};
+
+TEST_F(TransposeOpTest, Matrix) { RunAndCheck<float>({64, 32}, {1, 0}); }
+
+TEST_F(TransposeOpTest, MatrixOddSizes) {
+  RunAndCheck<float>({37, 53}, {1, 0});
+}
+
+TEST_F(TransposeOpTest, MatrixSmallerThanTile) {
+  RunAndCheck<float>({3, 5}, {1, 0});
+}
+
+TEST_F(TransposeOpTest, MatrixUint8) {
+  RunAndCheck<uint8>({13, 130}, {1, 0});
+}
+
+TEST_F(TransposeOpTest, MatrixInt64) { RunAndCheck<int64>({19, 21}, {1, 0}); }
+
+TEST_F(TransposeOpTest, MatrixDouble) {
+  RunAndCheck<double>({100, 3}, {1, 0});
+}
+
+TEST_F(TransposeOpTest, NHWCToNCHW) {
+  RunAndCheck<float>({2, 7, 9, 5}, {0, 3, 1, 2});
+}
+
+TEST_F(TransposeOpTest, NCHWToNHWC) {
+  RunAndCheck<float>({3, 17, 4, 6}, {0, 2, 3, 1});
+}
+
+TEST_F(TransposeOpTest, MergedInnerDimensions) {
+  RunAndCheck<float>({4, 3, 5, 6}, {2, 3, 0, 1});
+}
+
+TEST_F(TransposeOpTest, GeneralPermutation) {
+  RunAndCheck<float>({2, 3, 4, 5}, {3, 1, 0, 2});
+}
+
+TEST_F(TransposeOpTest, GeneralPermutationHighRank) {
+  RunAndCheck<int32>({2, 3, 2, 2, 3, 2}, {5, 0, 4, 1, 3, 2});
+}
+
+static Graph* Transpose(const TensorShape& in_shape,
+                        const std::vector<int32>& perm) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor in(DT_FLOAT, in_shape);
+  in.flat<float>().setRandom();
+  Tensor perm_t(DT_INT32, TensorShape({static_cast<int64>(perm.size())}));
+  for (int i = 0; i < perm.size(); ++i) perm_t.flat<int32>()(i) = perm[i];
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Transpose")
+                  .Input(test::graph::Constant(g, in))
+                  .Input(test::graph::Constant(g, perm_t))
+                  .Finalize(g, &node));
+  return g;
+}
+
+static void BM_Transpose2D(int iters, int rows, int cols) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * rows * cols);
+  testing::BytesProcessed(static_cast<int64>(iters) * rows * cols *
+                          sizeof(float) * 2);
+  test::Benchmark("cpu", Transpose(TensorShape({rows, cols}), {1, 0}))
+      .Run(iters);
+}
+
+BENCHMARK(BM_Transpose2D)
+    ->ArgPair(128, 128)
+    ->ArgPair(512, 512)
+    ->ArgPair(1024, 1024)
+    ->ArgPair(4096, 4096)
+    ->ArgPair(1000, 333);
+
+static void BM_TransposeNHWCToNCHW(int iters, int batch, int spatial,
+                                   int channels) {
+  const int64 elems = static_cast<int64>(batch) * spatial * spatial * channels;
+  testing::ItemsProcessed(iters * elems);
+  testing::BytesProcessed(iters * elems * sizeof(float) * 2);
+  test::Benchmark(
+      "cpu", Transpose(TensorShape({batch, spatial, spatial, channels}),
+                       {0, 3, 1, 2}))
+      .Run(iters);
+}
+
+static void BM_TransposeNCHWToNHWC(int iters, int batch, int spatial,
+                                   int channels) {
+  const int64 elems = static_cast<int64>(batch) * spatial * spatial * channels;
+  testing::ItemsProcessed(iters * elems);
+  testing::BytesProcessed(iters * elems * sizeof(float) * 2);
+  test::Benchmark(
+      "cpu", Transpose(TensorShape({batch, channels, spatial, spatial}),
+                       {0, 2, 3, 1}))
+      .Run(iters);
+}
+
+#define BM_TransposeConv(N, S, C)                                     \
+  static void BM_TransposeNHWCToNCHW_##N##_##S##_##C(int iters) {     \
+    BM_TransposeNHWCToNCHW(iters, N, S, C);                           \
+  }                                                                   \
+  BENCHMARK(BM_TransposeNHWCToNCHW_##N##_##S##_##C);                  \
+  static void BM_TransposeNCHWToNHWC_##N##_##S##_##C(int iters) {     \
+    BM_TransposeNCHWToNHWC(iters, N, S, C);                           \
+  }                                                                   \
+  BENCHMARK(BM_TransposeNCHWToNHWC_##N##_##S##_##C);
+
+BM_TransposeConv(32, 56, 64);
+BM_TransposeConv(32, 28, 128);
+BM_TransposeConv(32, 14, 256);
+BM_TransposeConv(32, 7, 512);
+
+}  // namespace
+}  // namespace tensorflow
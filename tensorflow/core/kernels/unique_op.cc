@@ -13,18 +13,54 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/unique_op.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/kernels/cuda_solvers.h"
+#include "tensorflow/core/platform/cuda.h"
+
+using ::perftools::gputools::cuda::ScopedActivateExecutorContext;
+#endif  // GOOGLE_CUDA
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Inputs with fewer elements than this are uniquified on a single thread,
+// since partitioning them costs more than the parallel speedup saves.
+const int64 kParallelUniqueMinElements = 64 * 1024;
+
+// Minimum number of input elements handled by one block of ParallelUnique.
+const int64 kParallelUniqueMinBlockSize = 8 * 1024;
+
+// Maximum number of hash partitions used by ParallelUnique, so that the
+// partition of an element fits in a uint8.
+const int kParallelUniqueMaxPartitionBits = 8;
+
+}  // namespace
 
 template <typename T>
 class UniqueOp : public OpKernel {
@@ -50,6 +86,21 @@ class UniqueOp : public OpKernel {
                                 {0}, 1, input.shape(), &idx));
     auto idx_vec = idx->template vec<int32>();
 
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    if (N >= kParallelUniqueMinElements && worker_threads->num_threads > 1) {
+      ParallelUnique(context, Tin, idx_vec);
+    } else {
+      SerialUnique(context, Tin, idx_vec);
+    }
+  }
+
+ private:
+  // idx_vec may alias Tin, so Tin(i) must only be read before idx_vec(i) is
+  // written.
+  void SerialUnique(OpKernelContext* context,
+                    typename TTypes<T>::ConstVec Tin,
+                    TTypes<int32>::Vec idx_vec) {
+    const int64 N = static_cast<int64>(Tin.size());
     std::unordered_map<T, int32> uniq;
     uniq.reserve(2 * N);
     for (int64 i = 0, j = 0; i < N; ++i) {
@@ -79,6 +130,151 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+  // Computes the same outputs as SerialUnique on the intra-op thread pool.
+  //
+  // The input is split into contiguous blocks and its values are hash
+  // partitioned, so that all occurrences of a value fall into the same
+  // partition.  Each partition is then uniquified independently with its own
+  // hash table, visiting its elements in input order, and finally the
+  // partition-local ids are renumbered into global ids in order of first
+  // occurrence by a pass over the blocks.
+  void ParallelUnique(OpKernelContext* context,
+                      typename TTypes<T>::ConstVec Tin,
+                      TTypes<int32>::Vec idx_vec) {
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 N = static_cast<int64>(Tin.size());
+    const bool with_counts = num_outputs() > 2;
+
+    int partition_bits = 1;
+    while ((1 << partition_bits) < worker_threads->num_threads &&
+           partition_bits < kParallelUniqueMaxPartitionBits) {
+      ++partition_bits;
+    }
+    const int num_partitions = 1 << partition_bits;
+    auto partition_of = [partition_bits](const T& value) {
+      // Fibonacci hashing spreads the identity hashes of integers.
+      return static_cast<uint8>(static_cast<uint64>(std::hash<T>()(value)) *
+                                    0x9E3779B97F4A7C15ULL >>
+                                (64 - partition_bits));
+    };
+    const int64 num_blocks =
+        std::min<int64>(4 * num_partitions, N / kParallelUniqueMinBlockSize);
+    const int64 block_size = (N + num_blocks - 1) / num_blocks;
+    auto shard_blocks = [&](int64 cost_per_element,
+                            const std::function<void(int64, int64, int64)>&
+                                fn) {
+      Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+            block_size * cost_per_element, [&](int64 start, int64 limit) {
+              for (int64 b = start; b < limit; ++b) {
+                fn(b, b * block_size, std::min(N, (b + 1) * block_size));
+              }
+            });
+    };
+
+    // Partition every element and lay out the elements of each partition
+    // contiguously in `order`, sorted by position in the input.
+    std::vector<uint8> partition(N);
+    std::vector<int64> offsets(num_blocks * num_partitions, 0);
+    shard_blocks(10, [&](int64 b, int64 begin, int64 end) {
+      int64* block_counts = &offsets[b * num_partitions];
+      for (int64 i = begin; i < end; ++i) {
+        partition[i] = partition_of(Tin(i));
+        ++block_counts[partition[i]];
+      }
+    });
+    std::vector<int64> partition_start(num_partitions + 1);
+    int64 offset = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_start[p] = offset;
+      for (int64 b = 0; b < num_blocks; ++b) {
+        const int64 block_count = offsets[b * num_partitions + p];
+        offsets[b * num_partitions + p] = offset;
+        offset += block_count;
+      }
+    }
+    partition_start[num_partitions] = N;
+    std::vector<int32> order(N);
+    shard_blocks(5, [&](int64 b, int64 begin, int64 end) {
+      int64* block_offsets = &offsets[b * num_partitions];
+      for (int64 i = begin; i < end; ++i) {
+        order[block_offsets[partition[i]]++] = i;
+      }
+    });
+
+    // Uniquify each partition.  idx_vec temporarily holds partition-local
+    // ids, and since idx_vec may alias Tin, the unique values are copied out.
+    std::vector<std::vector<T>> partition_values(num_partitions);
+    std::vector<std::vector<int32>> partition_counts(num_partitions);
+    std::vector<uint8> is_first(N, 0);
+    Shard(worker_threads->num_threads, worker_threads->workers, num_partitions,
+          N / num_partitions * 100, [&](int64 start, int64 limit) {
+            for (int64 p = start; p < limit; ++p) {
+              std::vector<T>& values = partition_values[p];
+              std::vector<int32>& counts = partition_counts[p];
+              std::unordered_map<T, int32> uniq;
+              uniq.reserve(2 * (partition_start[p + 1] - partition_start[p]));
+              for (int64 k = partition_start[p]; k < partition_start[p + 1];
+                   ++k) {
+                const int32 i = order[k];
+                auto it = uniq.insert(
+                    std::make_pair(Tin(i), static_cast<int32>(values.size())));
+                if (it.second) {
+                  values.push_back(it.first->first);
+                  if (with_counts) counts.push_back(0);
+                  is_first[i] = 1;
+                }
+                idx_vec(i) = it.first->second;
+                if (with_counts) ++counts[it.first->second];
+              }
+            }
+          });
+
+    // Number the first occurrences in input order to get the global ids.
+    std::vector<int64> block_first_start(num_blocks + 1, 0);
+    shard_blocks(1, [&](int64 b, int64 begin, int64 end) {
+      block_first_start[b + 1] =
+          std::count(is_first.begin() + begin, is_first.begin() + end, 1);
+    });
+    for (int64 b = 0; b < num_blocks; ++b) {
+      block_first_start[b + 1] += block_first_start[b];
+    }
+    const int64 uniq_size = block_first_start[num_blocks];
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({uniq_size}), &output));
+    auto output_vec = output->template vec<T>();
+    Tensor* count_output = nullptr;
+    if (with_counts) {
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_output));
+    }
+    std::vector<std::vector<int32>> global_ids(num_partitions);
+    for (int p = 0; p < num_partitions; ++p) {
+      global_ids[p].resize(partition_values[p].size());
+    }
+    shard_blocks(5, [&](int64 b, int64 begin, int64 end) {
+      int32 global_id = block_first_start[b];
+      for (int64 i = begin; i < end; ++i) {
+        if (!is_first[i]) continue;
+        const int p = partition[i];
+        const int32 local_id = idx_vec(i);
+        global_ids[p][local_id] = global_id;
+        output_vec(global_id) = partition_values[p][local_id];
+        if (with_counts) {
+          count_output->template vec<int32>()(global_id) =
+              partition_counts[p][local_id];
+        }
+        ++global_id;
+      }
+    });
+    shard_blocks(5, [&](int64 b, int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        idx_vec(i) = global_ids[partition[i]][idx_vec(i)];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -96,6 +292,168 @@ TF_CALL_REAL_NUMBER_TYPES(REGISTER_UNIQUE);
 REGISTER_UNIQUE(string)
 #undef REGISTER_UNIQUE
 
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+
+// Sort-based Unique for the GPU.  The input is radix sorted so that equal
+// values form runs, and the runs are then ordered by the first occurrence of
+// their value.  The number of unique values is only known after the sort, so
+// the first half runs before, and the second half after, a copy of that
+// number to the host.
+template <typename T>
+class UniqueGPUOp : public AsyncOpKernel {
+ public:
+  explicit UniqueGPUOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {}
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES_ASYNC(context, TensorShapeUtils::IsVector(input.shape()),
+                      errors::InvalidArgument("unique expects a 1D vector."),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, input.NumElements() <= std::numeric_limits<int32>::max(),
+        errors::InvalidArgument(
+            "unique does not support input tensors larger than ",
+            std::numeric_limits<int32>::max(), " elements"),
+        done);
+    const int64 N = input.NumElements();
+
+    Tensor* idx = nullptr;
+    OP_REQUIRES_OK_ASYNC(
+        context, context->allocate_output(1, input.shape(), &idx), done);
+    if (N == 0) {
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, TensorShape({0}), &output),
+          done);
+      if (num_outputs() > 2) {
+        OP_REQUIRES_OK_ASYNC(
+            context, context->allocate_output(2, TensorShape({0}), &output),
+            done);
+      }
+      done();
+      return;
+    }
+
+    Tensor sorted_input, sorted_idx, run_id, num_unique;
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_temp(DataTypeToEnum<T>::v(), TensorShape({N}),
+                               &sorted_input),
+        done);
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        context->allocate_temp(DT_INT32, TensorShape({N}), &sorted_idx), done);
+    OP_REQUIRES_OK_ASYNC(
+        context, context->allocate_temp(DT_INT32, TensorShape({N}), &run_id),
+        done);
+    OP_REQUIRES_OK_ASYNC(
+        context, context->allocate_temp(DT_INT32, TensorShape({}), &num_unique),
+        done);
+
+    const GPUDevice& d = context->eigen_device<GPUDevice>();
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        functor::UniqueSortedRuns<GPUDevice, T>::Compute(
+            context, d, input.vec<T>(), sorted_input.vec<T>(),
+            sorted_idx.vec<int32>(), run_id.vec<int32>(),
+            num_unique.scalar<int32>()),
+        done);
+
+    // Copy num_unique to host.
+    ScratchSpace<int32> num_unique_host(context, 1, /* on_host */ true);
+    perftools::gputools::DeviceMemoryBase num_unique_ptr(
+        static_cast<void*>(num_unique.scalar<int32>().data()));
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(num_unique_host.mutable_data(), num_unique_ptr,
+                         sizeof(int32))
+            .ok(),
+        errors::Internal("UniqueOp: failed to copy num_unique from device"),
+        done);
+
+    const bool with_counts = num_outputs() > 2;
+    auto create_outputs = [context, &d, idx, sorted_input, sorted_idx, run_id,
+                           num_unique_host, with_counts, done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      auto stream = context->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+      const int32 num_unique = *num_unique_host.data();
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_output(0, TensorShape({num_unique}), &output),
+          done);
+      Tensor* count = nullptr;
+      if (with_counts) {
+        OP_REQUIRES_OK_ASYNC(
+            context,
+            context->allocate_output(2, TensorShape({num_unique}), &count),
+            done);
+      }
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          functor::UniqueFromSortedRuns<GPUDevice, T>::Compute(
+              context, d, sorted_input.vec<T>(), sorted_idx.vec<int32>(),
+              run_id.vec<int32>(), num_unique, output->vec<T>(),
+              idx->vec<int32>(),
+              with_counts ? count->vec<int32>().data() : nullptr),
+          done);
+      done();
+    };
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, create_outputs);
+  }
+
+ private:
+  TF_DISALLOW_COPY_AND_ASSIGN(UniqueGPUOp);
+};
+
+namespace functor {
+
+#define DECLARE_GPU_SPEC(T)                                                   \
+  template <>                                                                 \
+  Status UniqueSortedRuns<GPUDevice, T>::Compute(                             \
+      OpKernelContext* ctx, const GPUDevice& d, TTypes<T>::ConstVec input,    \
+      TTypes<T>::Vec sorted_input, TTypes<int32>::Vec sorted_idx,             \
+      TTypes<int32>::Vec run_id, TTypes<int32>::Scalar num_unique);           \
+  extern template struct UniqueSortedRuns<GPUDevice, T>;                      \
+  template <>                                                                 \
+  Status UniqueFromSortedRuns<GPUDevice, T>::Compute(                         \
+      OpKernelContext* ctx, const GPUDevice& d,                               \
+      TTypes<T>::ConstVec sorted_input, TTypes<int32>::ConstVec sorted_idx,   \
+      TTypes<int32>::ConstVec run_id, int32 num_unique,                       \
+      TTypes<T>::Vec output, TTypes<int32>::Vec idx, int32* count);           \
+  extern template struct UniqueFromSortedRuns<GPUDevice, T>
+
+DECLARE_GPU_SPEC(int32);
+DECLARE_GPU_SPEC(int64);
+#undef DECLARE_GPU_SPEC
+
+}  // namespace functor
+
+#define REGISTER_UNIQUE_GPU(type)                                \
+  REGISTER_KERNEL_BUILDER(Name("Unique")                         \
+                              .Device(DEVICE_GPU)                \
+                              .TypeConstraint<type>("T")         \
+                              .TypeConstraint<int32>("out_idx"), \
+                          UniqueGPUOp<type>);                    \
+  REGISTER_KERNEL_BUILDER(Name("UniqueWithCounts")               \
+                              .Device(DEVICE_GPU)                \
+                              .TypeConstraint<type>("T")         \
+                              .TypeConstraint<int32>("out_idx"), \
+                          UniqueGPUOp<type>)
+REGISTER_UNIQUE_GPU(int32);
+REGISTER_UNIQUE_GPU(int64);
+#undef REGISTER_UNIQUE_GPU
+
+#else  // !GOOGLE_CUDA
+
 // Fake integer GPU kernels so that the use of Unique in optimizers (to
 // de-duplicate sparse gradient indices) does not conflict with gradients being
 // located on a GPU. These kernels run on the CPU, their inputs and outputs
@@ -117,6 +475,8 @@ REGISTER_KERNEL_BUILDER(Name("Unique")
                             .HostMemory("idx"),
                         UniqueOp<int64>);
 
+#endif  // GOOGLE_CUDA
+
 #ifdef TENSORFLOW_USE_SYCL
 REGISTER_KERNEL_BUILDER(Name("Unique")
                             .Device(DEVICE_SYCL)
@@ -0,0 +1,61 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_UNIQUE_OP_H_
+#define TENSORFLOW_KERNELS_UNIQUE_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+// First half of the sort-based Unique: stably sorts the non-empty `input`,
+// storing the sorted values in sorted_input and their positions in input in
+// sorted_idx.  run_id[k] is set to the index of the run of equal values that
+// sorted element k belongs to, and num_unique to the number of runs.
+template <typename Device, typename T>
+struct UniqueSortedRuns {
+  EIGEN_ALWAYS_INLINE static Status Compute(
+      OpKernelContext* ctx, const Device& d,
+      typename TTypes<T>::ConstVec input, typename TTypes<T>::Vec sorted_input,
+      TTypes<int32>::Vec sorted_idx, TTypes<int32>::Vec run_id,
+      TTypes<int32>::Scalar num_unique);
+};
+
+// Second half of the sort-based Unique: given the results of
+// UniqueSortedRuns and the number of runs, orders the unique values by their
+// first occurrence in the input, as the CPU kernel does, writes them to output
+// and the position of every input element's value in output to idx.  If
+// count is not null, the number of occurrences of each unique value is also
+// written to count.
+template <typename Device, typename T>
+struct UniqueFromSortedRuns {
+  EIGEN_ALWAYS_INLINE static Status Compute(
+      OpKernelContext* ctx, const Device& d,
+      typename TTypes<T>::ConstVec sorted_input,
+      TTypes<int32>::ConstVec sorted_idx, TTypes<int32>::ConstVec run_id,
+      int32 num_unique, typename TTypes<T>::Vec output,
+      TTypes<int32>::Vec idx, int32* count);
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_UNIQUE_OP_H_
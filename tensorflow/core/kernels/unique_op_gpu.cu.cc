@@ -0,0 +1,259 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+#include "external/cub_archive/cub/device/device_radix_sort.cuh"
+#include "external/cub_archive/cub/device/device_scan.cuh"
+#endif  // GOOGLE_CUDA
+
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/unique_op.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+namespace {
+
+// Runs a cub device-wide algorithm: `fn(temp_storage, temp_storage_bytes)` is
+// first called with null temp storage to query its size, and then again with
+// temp storage of that size allocated from ctx.
+template <typename Fn>
+Status RunCub(OpKernelContext* ctx, const char* name, Fn fn) {
+  std::size_t temp_storage_bytes = 0;
+  cudaError_t err = fn(nullptr, temp_storage_bytes);
+  if (err != cudaSuccess) {
+    return errors::Internal("UniqueOp: Could not launch ", name,
+                            " to calculate temp_storage_bytes, status: ",
+                            cudaGetErrorString(err));
+  }
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT8, TensorShape({static_cast<int64>(temp_storage_bytes)}),
+      &temp_storage));
+  err = fn(temp_storage.flat<int8>().data(), temp_storage_bytes);
+  if (err != cudaSuccess) {
+    return errors::Internal("UniqueOp: Could not launch ", name,
+                            ", temp_storage_bytes: ", temp_storage_bytes,
+                            ", status: ", cudaGetErrorString(err));
+  }
+  return Status::OK();
+}
+
+__global__ void RangeInitKernel(const int32 size, int32* out) {
+  GPU_1D_KERNEL_LOOP(i, size) { out[i] = i; }
+}
+
+// Sets run_start[k] to 1 if sorted element k starts a new run of equal values
+// and to 0 otherwise; the first element is counted as run 0.
+template <typename T>
+__global__ void MarkRunStartsKernel(const int32 size, const T* sorted_input,
+                                    int32* run_start) {
+  GPU_1D_KERNEL_LOOP(k, size) {
+    run_start[k] = k > 0 && ldg(sorted_input + k) != ldg(sorted_input + k - 1);
+  }
+}
+
+__global__ void NumRunsKernel(const int32 size, const int32* run_id,
+                              int32* num_unique) {
+  *num_unique = ldg(run_id + size - 1) + 1;
+}
+
+// For the first element of every run, records where the run starts in the
+// sorted input and where its value first occurs in the original input, which
+// is the position of that first element since the sort is stable.
+__global__ void RunFirstsKernel(const int32 size, const int32* sorted_idx,
+                                const int32* run_id, int32* run_start,
+                                int32* run_first_idx) {
+  GPU_1D_KERNEL_LOOP(k, size) {
+    const int32 run = ldg(run_id + k);
+    if (k == 0 || ldg(run_id + k - 1) != run) {
+      run_start[run] = k;
+      run_first_idx[run] = ldg(sorted_idx + k);
+    }
+  }
+}
+
+// Writes output element p from run ordered_runs[p] and remembers that run's
+// position in output.
+template <typename T>
+__global__ void GatherUniqueKernel(const int32 num_unique, const int32 size,
+                                   const T* sorted_input,
+                                   const int32* run_start,
+                                   const int32* ordered_runs, int32* run_pos,
+                                   T* output, int32* count) {
+  GPU_1D_KERNEL_LOOP(p, num_unique) {
+    const int32 run = ldg(ordered_runs + p);
+    const int32 start = ldg(run_start + run);
+    run_pos[run] = p;
+    output[p] = ldg(sorted_input + start);
+    if (count != nullptr) {
+      const int32 end =
+          run + 1 < num_unique ? ldg(run_start + run + 1) : size;
+      count[p] = end - start;
+    }
+  }
+}
+
+__global__ void ScatterIdxKernel(const int32 size, const int32* sorted_idx,
+                                 const int32* run_id, const int32* run_pos,
+                                 int32* idx) {
+  GPU_1D_KERNEL_LOOP(k, size) {
+    idx[ldg(sorted_idx + k)] = ldg(run_pos + ldg(run_id + k));
+  }
+}
+
+Status AllocateInt32Temp(OpKernelContext* ctx, int32 size, Tensor* t) {
+  return ctx->allocate_temp(DT_INT32, TensorShape({size}), t);
+}
+
+}  // namespace
+#endif  // GOOGLE_CUDA
+
+template <typename T>
+struct UniqueSortedRuns<GPUDevice, T> {
+  EIGEN_ALWAYS_INLINE static Status Compute(
+      OpKernelContext* ctx, const GPUDevice& d,
+      typename TTypes<T>::ConstVec input, typename TTypes<T>::Vec sorted_input,
+      TTypes<int32>::Vec sorted_idx, TTypes<int32>::Vec run_id,
+      TTypes<int32>::Scalar num_unique) {
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+    const cudaStream_t& cu_stream = GetGpuStream(ctx);
+    const int32 size = input.size();
+    GpuLaunchConfig config = GetGpuLaunchConfig(size, d);
+
+    Tensor range;
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, size, &range));
+    int32* range_data = range.flat<int32>().data();
+    GPU_LAUNCH_KERNEL(RangeInitKernel, dim3(config.block_count),
+                      dim3(config.thread_per_block), 0, d.stream(), size,
+                      range_data);
+
+    TF_RETURN_IF_ERROR(RunCub(
+        ctx, "cub::DeviceRadixSort::SortPairs",
+        [&](void* temp_storage, std::size_t& temp_storage_bytes) {
+          return cub::DeviceRadixSort::SortPairs(
+              temp_storage, temp_storage_bytes, input.data(),
+              sorted_input.data(), range_data, sorted_idx.data(), size,
+              /*begin_bit*/ 0, /*end_bit*/ sizeof(T) * 8, cu_stream);
+        }));
+
+    // The ids of the runs are the inclusive prefix sums of their starts.
+    Tensor run_start;
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, size, &run_start));
+    int32* run_start_data = run_start.flat<int32>().data();
+    GPU_LAUNCH_KERNEL(MarkRunStartsKernel<T>, dim3(config.block_count),
+                      dim3(config.thread_per_block), 0, d.stream(), size,
+                      sorted_input.data(), run_start_data);
+    TF_RETURN_IF_ERROR(RunCub(
+        ctx, "cub::DeviceScan::InclusiveSum",
+        [&](void* temp_storage, std::size_t& temp_storage_bytes) {
+          return cub::DeviceScan::InclusiveSum(temp_storage, temp_storage_bytes,
+                                               run_start_data, run_id.data(),
+                                               size, cu_stream);
+        }));
+
+    GPU_LAUNCH_KERNEL(NumRunsKernel, dim3(1), dim3(1), 0, d.stream(), size,
+                      run_id.data(), num_unique.data());
+#endif  // GOOGLE_CUDA
+    return Status::OK();
+  }
+};
+
+template <typename T>
+struct UniqueFromSortedRuns<GPUDevice, T> {
+  EIGEN_ALWAYS_INLINE static Status Compute(
+      OpKernelContext* ctx, const GPUDevice& d,
+      typename TTypes<T>::ConstVec sorted_input,
+      TTypes<int32>::ConstVec sorted_idx, TTypes<int32>::ConstVec run_id,
+      int32 num_unique, typename TTypes<T>::Vec output,
+      TTypes<int32>::Vec idx, int32* count) {
+// FIXME implement ROCm functional equivalent
+#if GOOGLE_CUDA
+    const cudaStream_t& cu_stream = GetGpuStream(ctx);
+    const int32 size = sorted_input.size();
+    GpuLaunchConfig config = GetGpuLaunchConfig(size, d);
+    GpuLaunchConfig unique_config = GetGpuLaunchConfig(num_unique, d);
+
+    Tensor run_start, run_first_idx;
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, num_unique, &run_start));
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, num_unique, &run_first_idx));
+    int32* run_start_data = run_start.flat<int32>().data();
+    int32* run_first_idx_data = run_first_idx.flat<int32>().data();
+    GPU_LAUNCH_KERNEL(RunFirstsKernel, dim3(config.block_count),
+                      dim3(config.thread_per_block), 0, d.stream(), size,
+                      sorted_idx.data(), run_id.data(), run_start_data,
+                      run_first_idx_data);
+
+    // Order the runs by the first occurrence of their value in the input.
+    Tensor runs, first_idx_sorted, ordered_runs;
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, num_unique, &runs));
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, num_unique, &first_idx_sorted));
+    TF_RETURN_IF_ERROR(AllocateInt32Temp(ctx, num_unique, &ordered_runs));
+    int32* runs_data = runs.flat<int32>().data();
+    int32* ordered_runs_data = ordered_runs.flat<int32>().data();
+    GPU_LAUNCH_KERNEL(RangeInitKernel, dim3(unique_config.block_count),
+                      dim3(unique_config.thread_per_block), 0, d.stream(),
+                      num_unique, runs_data);
+    TF_RETURN_IF_ERROR(RunCub(
+        ctx, "cub::DeviceRadixSort::SortPairs",
+        [&](void* temp_storage, std::size_t& temp_storage_bytes) {
+          return cub::DeviceRadixSort::SortPairs(
+              temp_storage, temp_storage_bytes, run_first_idx_data,
+              first_idx_sorted.flat<int32>().data(), runs_data,
+              ordered_runs_data, num_unique, /*begin_bit*/ 0,
+              /*end_bit*/ sizeof(int32) * 8, cu_stream);
+        }));
+
+    // run_first_idx is no longer needed, so it holds each run's position in
+    // output from here on.
+    int32* run_pos_data = run_first_idx_data;
+    GPU_LAUNCH_KERNEL(GatherUniqueKernel<T>, dim3(unique_config.block_count),
+                      dim3(unique_config.thread_per_block), 0, d.stream(),
+                      num_unique, size, sorted_input.data(), run_start_data,
+                      ordered_runs_data, run_pos_data, output.data(), count);
+    GPU_LAUNCH_KERNEL(ScatterIdxKernel, dim3(config.block_count),
+                      dim3(config.thread_per_block), 0, d.stream(), size,
+                      sorted_idx.data(), run_id.data(), run_pos_data,
+                      idx.data());
+#endif  // GOOGLE_CUDA
+    return Status::OK();
+  }
+};
+
+template struct UniqueSortedRuns<GPUDevice, int32>;
+template struct UniqueSortedRuns<GPUDevice, int64>;
+template struct UniqueFromSortedRuns<GPUDevice, int32>;
+template struct UniqueFromSortedRuns<GPUDevice, int64>;
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -99,6 +100,24 @@ class UnpackOp : public OpKernel {
 
     // Except for shape, unpack is a special case of split, so we reuse the
     // same computational kernels.
+    if (std::is_same<Device, CPUDevice>::value) {
+      std::vector<std::unique_ptr<typename TTypes<T, 2>::Matrix>> outputs_flat;
+      outputs_flat.reserve(num);
+      for (int i = 0; i < num; ++i) {
+        Tensor* output;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(i, output_shape, &output));
+        outputs_flat.emplace_back(new typename TTypes<T, 2>::Matrix(
+            output->shaped<T, 2>({before_dim, after_dim})));
+      }
+      if (output_size > 0) {
+        SplitCPU<T>(context->device(),
+                    input.shaped<T, 2>({before_dim, axis_dim * after_dim}),
+                    outputs_flat);
+      }
+      return;
+    }
+
     auto input_reshaped =
         input.shaped<T, 3>({1, before_dim, axis_dim * after_dim});
 
@@ -40,6 +40,66 @@ struct XentFunctor {
                   typename TTypes<T>::Matrix backprop);
 };
 
+// Softmax cross entropy statistics of a contiguous segment of one row of
+// logits and labels.  XentFunctor implementations that stream over tiles of
+// the class dimension accumulate one of these per tile and merge them, so
+// that neither the probabilities nor exp(logits - max(logits)) have to be
+// materialized.  Acc is the type to accumulate in, e.g. float for Eigen::half.
+template <typename Acc>
+struct XentStats {
+  Acc max_logit;  // max(logits)
+  Acc sum_exp;    // sum(exp(logits - max_logit)), 0 for an empty segment.
+  Acc label_sum;  // sum(labels)
+  Acc label_dot;  // sum(labels * (logits - max_logit))
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE void Clear() {
+    max_logit = Acc(0);
+    sum_exp = Acc(0);
+    label_sum = Acc(0);
+    label_dot = Acc(0);
+  }
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE void Add(Acc logit, Acc label) {
+    if (sum_exp == Acc(0)) {
+      max_logit = logit;
+      sum_exp = Acc(1);
+    } else if (logit > max_logit) {
+      // Rescale what was accumulated so far to the new maximum.
+      const Acc shift = max_logit - logit;
+      sum_exp = sum_exp * Eigen::numext::exp(shift) + Acc(1);
+      label_dot += label_sum * shift;
+      max_logit = logit;
+    } else {
+      sum_exp += Eigen::numext::exp(logit - max_logit);
+    }
+    label_sum += label;
+    label_dot += label * (logit - max_logit);
+  }
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE void Merge(const XentStats& other) {
+    if (other.sum_exp == Acc(0)) return;
+    if (sum_exp == Acc(0)) {
+      *this = other;
+      return;
+    }
+    const Acc new_max =
+        max_logit > other.max_logit ? max_logit : other.max_logit;
+    const Acc shift = max_logit - new_max;
+    const Acc other_shift = other.max_logit - new_max;
+    sum_exp = sum_exp * Eigen::numext::exp(shift) +
+              other.sum_exp * Eigen::numext::exp(other_shift);
+    label_dot = label_dot + label_sum * shift + other.label_dot +
+                other.label_sum * other_shift;
+    label_sum += other.label_sum;
+    max_logit = new_max;
+  }
+
+  // sum(-labels * log(softmax(logits))) for the full row.
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE Acc Loss() const {
+    return label_sum * Eigen::numext::log(sum_exp) - label_dot;
+  }
+};
+
 // Eigen code implementing XentFunctor::operator().
 // This code works for both CPU and GPU and is used by the functor
 // specializations for both device types.
@@ -22,13 +22,109 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
 
 typedef Eigen::GpuDevice GPUDevice;
 
-// Partial specialization for a GPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
+namespace {
+
+using functor::XentStats;
+
+// Products for Eigen::half are accumulated in float.
+template <typename T>
+struct XentAccumulatorType {
+  typedef T type;
+};
+
+template <>
+struct XentAccumulatorType<Eigen::half> {
+  typedef float type;
+};
+
+// Every block handles one tile of kTileSize classes of one row.
+constexpr int kThreadsPerBlock = 256;
+constexpr int kTileSize = 16 * kThreadsPerBlock;
+
+// Merges the stats of all the threads of the block into shared[0].
+template <typename Acc>
+__device__ void BlockMergeXentStats(const XentStats<Acc>& stats,
+                                    XentStats<Acc>* shared) {
+  shared[threadIdx.x] = stats;
+  __syncthreads();
+  for (int offset = kThreadsPerBlock / 2; offset > 0; offset /= 2) {
+    if (threadIdx.x < offset) {
+      shared[threadIdx.x].Merge(shared[threadIdx.x + offset]);
+    }
+    __syncthreads();
+  }
+}
+
+// Computes the XentStats of every tile.
+template <typename T, typename Acc>
+__global__ void XentTileStatsKernel(const T* logits, const T* labels,
+                                    int64 num_classes, int64 tiles_per_row,
+                                    XentStats<Acc>* tile_stats) {
+  __shared__ XentStats<Acc> shared[kThreadsPerBlock];
+  const int64 tile = blockIdx.x;
+  const int64 row = tile / tiles_per_row;
+  const int64 start = (tile % tiles_per_row) * kTileSize;
+  const int64 limit =
+      start + kTileSize < num_classes ? start + kTileSize : num_classes;
+  const T* logits_row = logits + row * num_classes;
+  const T* labels_row = labels + row * num_classes;
+  XentStats<Acc> stats;
+  stats.Clear();
+  for (int64 c = start + threadIdx.x; c < limit; c += kThreadsPerBlock) {
+    stats.Add(static_cast<Acc>(logits_row[c]), static_cast<Acc>(labels_row[c]));
+  }
+  BlockMergeXentStats(stats, shared);
+  if (threadIdx.x == 0) {
+    tile_stats[tile] = shared[0];
+  }
+}
+
+// Merges the XentStats of the tiles of the row of every tile, and writes the
+// backprop of the tile.  The first tile of every row also writes its loss.
+// Each tile is read before it is written, so backprop may alias logits.
+template <typename T, typename Acc>
+__global__ void XentBackpropKernel(const T* logits, const T* labels,
+                                   int64 num_classes, int64 tiles_per_row,
+                                   const XentStats<Acc>* tile_stats, T* loss,
+                                   T* backprop) {
+  __shared__ XentStats<Acc> shared[kThreadsPerBlock];
+  const int64 tile = blockIdx.x;
+  const int64 row = tile / tiles_per_row;
+  const int64 tile_in_row = tile % tiles_per_row;
+  XentStats<Acc> stats;
+  stats.Clear();
+  for (int64 t = threadIdx.x; t < tiles_per_row; t += kThreadsPerBlock) {
+    stats.Merge(tile_stats[row * tiles_per_row + t]);
+  }
+  BlockMergeXentStats(stats, shared);
+  const Acc max_logit = shared[0].max_logit;
+  const Acc inv_sum_exp = Acc(1) / shared[0].sum_exp;
+  if (tile_in_row == 0 && threadIdx.x == 0) {
+    loss[row] = static_cast<T>(shared[0].Loss());
+  }
+  const int64 start = tile_in_row * kTileSize;
+  const int64 limit =
+      start + kTileSize < num_classes ? start + kTileSize : num_classes;
+  const int64 offset = row * num_classes;
+  for (int64 c = start + threadIdx.x; c < limit; c += kThreadsPerBlock) {
+    const Acc logit = static_cast<Acc>(logits[offset + c]);
+    const Acc label = static_cast<Acc>(labels[offset + c]);
+    backprop[offset + c] = static_cast<T>(
+        Eigen::numext::exp(logit - max_logit) * inv_sum_exp - label);
+  }
+}
+
+}  // namespace
+
+// Partial specialization for a GPUDevice.  Like the CPU implementation, this
+// streams over tiles of the class dimension in two passes instead of
+// materializing exp(logits - max(logits)).
 namespace functor {
 template <typename T>
 struct XentFunctor<GPUDevice, T> {
@@ -37,8 +133,28 @@ struct XentFunctor<GPUDevice, T> {
                   typename TTypes<T>::Matrix scratch,
                   typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop) {
-    XentEigenImpl<GPUDevice, T>::Compute(d, logits, labels, scratch, loss,
-                                         backprop);
+    typedef typename XentAccumulatorType<T>::type Acc;
+    const int64 batch_size = logits.dimension(0);
+    const int64 num_classes = logits.dimension(1);
+    if (batch_size == 0) return;
+    if (num_classes == 0) {
+      loss.device(d) = loss.constant(T(0));
+      return;
+    }
+    const int64 tiles_per_row = (num_classes + kTileSize - 1) / kTileSize;
+    const int64 num_tiles = batch_size * tiles_per_row;
+    const size_t num_bytes = num_tiles * sizeof(XentStats<Acc>);
+    auto* tile_stats = static_cast<XentStats<Acc>*>(d.allocate(num_bytes));
+    if (tile_stats == nullptr) return;  // The allocator set the error status.
+    GPU_LAUNCH_KERNEL(XentTileStatsKernel<T, Acc>, dim3(num_tiles),
+                      dim3(kThreadsPerBlock), 0, d.stream(), logits.data(),
+                      labels.data(), num_classes, tiles_per_row, tile_stats);
+    GPU_LAUNCH_KERNEL(XentBackpropKernel<T, Acc>, dim3(num_tiles),
+                      dim3(kThreadsPerBlock), 0, d.stream(), logits.data(),
+                      labels.data(), num_classes, tiles_per_row, tile_stats,
+                      loss.data(), backprop.data());
+    // Safe to deallocate immediately after the kernel launches.
+    d.deallocate(tile_stats);
   }
 };
 }  // end namespace functor
@@ -58,4 +58,8 @@ BM_XentDev(16, 10000, cpu);
 BM_XentDev(32, 10000, cpu);
 BM_XentDev(64, 10000, cpu);
 
+/// Large vocabularies
+BM_XentDev(4, 800000, gpu);
+BM_XentDev(4, 800000, cpu);
+
 }  // end namespace tensorflow
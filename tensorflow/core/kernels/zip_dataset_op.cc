@@ -101,8 +101,9 @@ class ZipDatasetOp : public DatasetOpKernel {
         }
       }
 
-      Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                     bool* end_of_sequence) override {
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
         mutex_lock l(mu_);
         out_tensors->clear();
         out_tensors->reserve(dataset()->output_dtypes().size());
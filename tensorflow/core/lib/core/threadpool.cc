@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 
+#include <algorithm>
+#include <vector>
+
 #define EIGEN_USE_THREADS
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/context.h"
@@ -83,13 +86,57 @@ struct EigenEnvironment {
   }
 };
 
-struct ThreadPool::Impl : Eigen::ThreadPoolTempl<EigenEnvironment> {
+// The closures scheduled with a priority, highest first. Each of them is
+// matched by one closure in the Eigen pool that pops and runs the highest
+// priority one pending when it gets to run.
+struct PriorityQueue {
+  struct Entry {
+    int64 priority;
+    uint64 seq;
+    std::function<void()> fn;
+  };
+  struct Compare {
+    bool operator()(const Entry& a, const Entry& b) const {
+      if (a.priority != b.priority) return a.priority < b.priority;
+      return a.seq > b.seq;
+    }
+  };
+
+  void Push(std::function<void()> fn, int64 priority) {
+    mutex_lock l(mu);
+    heap.push_back(Entry{priority, next_seq++, std::move(fn)});
+    std::push_heap(heap.begin(), heap.end(), Compare());
+  }
+
+  std::function<void()> Pop() {
+    mutex_lock l(mu);
+    DCHECK(!heap.empty());
+    std::pop_heap(heap.begin(), heap.end(), Compare());
+    std::function<void()> fn = std::move(heap.back().fn);
+    heap.pop_back();
+    return fn;
+  }
+
+  mutex mu;
+  std::vector<Entry> heap GUARDED_BY(mu);
+  uint64 next_seq GUARDED_BY(mu) = 0;
+};
+
+// PriorityQueue is the first base so that it outlives the Eigen pool, whose
+// destructor waits for the closures popping from it.
+struct ThreadPool::Impl : PriorityQueue,
+                          Eigen::ThreadPoolTempl<EigenEnvironment> {
   Impl(Env* env, const ThreadOptions& thread_options, const string& name,
        int num_threads, bool low_latency_hint)
       : Eigen::ThreadPoolTempl<EigenEnvironment>(
             num_threads, low_latency_hint,
             EigenEnvironment(env, thread_options, name)) {}
 
+  void ScheduleWithPriority(std::function<void()> fn, int64 priority) {
+    Push(std::move(fn), priority);
+    Schedule([this]() { Pop()(); });
+  }
+
   void ParallelFor(int64 total, int64 cost_per_unit,
                    std::function<void(int64, int64)> fn) {
     CHECK_GE(total, 0);
@@ -123,6 +170,12 @@ void ThreadPool::Schedule(std::function<void()> fn) {
   impl_->Schedule(std::move(fn));
 }
 
+void ThreadPool::ScheduleWithPriority(std::function<void()> fn,
+                                      int64 priority) {
+  CHECK(fn != nullptr);
+  impl_->ScheduleWithPriority(std::move(fn), priority);
+}
+
 void ThreadPool::ParallelFor(int64 total, int64 cost_per_unit,
                              std::function<void(int64, int64)> fn) {
   impl_->ParallelFor(total, cost_per_unit, std::move(fn));
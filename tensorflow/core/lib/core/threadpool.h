@@ -59,6 +59,12 @@ class ThreadPool {
   // Schedules fn() for execution in the pool of threads.
   void Schedule(std::function<void()> fn);
 
+  // Like Schedule(), but when the pool is busy, the pending closures
+  // scheduled through this method run in decreasing order of "priority",
+  // and in FIFO order among equal priorities. Closures passed to Schedule()
+  // are not ordered with respect to them.
+  void ScheduleWithPriority(std::function<void()> fn, int64 priority);
+
   // ParallelFor shards the "total" units of work assuming each unit of work
   // having roughly "cost_per_unit" cost, in cycles. Each unit of work is
   // indexed 0, 1, ..., total - 1. Each shard contains 1 or more units of work
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 
 #include <atomic>
+#include <vector>
 
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -57,6 +59,25 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+TEST(ThreadPool, ScheduleWithPriority) {
+  std::vector<int> order;
+  {
+    ThreadPool pool(Env::Default(), "test", 1);
+    // Keep the only thread busy until all the closures are pending.
+    Notification start;
+    pool.Schedule([&start]() { start.WaitForNotification(); });
+    const std::vector<std::pair<int, int64>> work = {
+        {0, 1}, {1, 3}, {2, 2}, {3, 3}, {4, -1}};
+    for (const auto& w : work) {
+      const int id = w.first;
+      pool.ScheduleWithPriority([&order, id]() { order.push_back(id); },
+                                w.second);
+    }
+    start.Notify();
+  }
+  EXPECT_EQ(std::vector<int>({1, 3, 2, 0, 4}), order);
+}
+
 TEST(ThreadPool, ParallelFor) {
   // Make ParallelFor use as many threads as possible.
   int64 kHugeCost = 1 << 30;
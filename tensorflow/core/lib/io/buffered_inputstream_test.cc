@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace io {
@@ -362,6 +363,43 @@ TEST(BufferedInputStream, ReadAll_Text) {
   }
 }
 
+// Reads 64MB of lines of 100 bytes, through a buffer of "buffer_size" bytes.
+void BM_BufferedInputStreamReadLine(int iters, int buffer_size) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/bm_buffered_inputstream";
+  const int kNumLines = (64 << 20) / 100;
+  {
+    const string line = string(99, 'x') + "\n";
+    string contents;
+    contents.reserve(kNumLines * line.size());
+    for (int i = 0; i < kNumLines; ++i) {
+      contents += line;
+    }
+    TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+
+  testing::StartTiming();
+  string line;
+  for (int i = 0; i < iters; ++i) {
+    RandomAccessInputStream input_stream(file.get());
+    BufferedInputStream in(&input_stream, buffer_size);
+    for (int j = 0; j < kNumLines; ++j) {
+      TF_CHECK_OK(in.ReadLine(&line));
+    }
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * kNumLines);
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumLines * 100);
+  TF_CHECK_OK(env->DeleteFile(fname));
+}
+BENCHMARK(BM_BufferedInputStreamReadLine)
+    ->Arg(4 << 10)
+    ->Arg(256 << 10)
+    ->Arg(4 << 20);
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tensorflow
@@ -0,0 +1,270 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/cache.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace table {
+
+Cache::~Cache() {}
+
+namespace {
+
+// LRU cache implementation
+//
+// Cache entries have an "in_cache" boolean indicating whether the cache has a
+// reference on the entry.  The only ways that this can become false without the
+// entry being passed to its "deleter" are via Erase(), via Insert() when
+// an element with a duplicate key is inserted, or on destruction of the cache.
+//
+// The cache keeps two lists of items in the cache.  All items in the
+// cache are in one list or the other, and never both.  Items still referenced
+// by clients but erased from the cache are in neither list.  The lists are:
+// - in-use:  contains the items currently referenced by clients, in no
+//   particular order.
+// - LRU:  contains the items not currently referenced by clients, in LRU order
+// Elements are moved between these lists by the Ref() and Unref() methods,
+// when they detect an element in the cache acquiring or losing its only
+// external reference.
+
+// An entry is a variable length heap-allocated structure.  Entries
+// are kept in two lists, ordered by access time.
+struct LRUHandle {
+  void* value;
+  void (*deleter)(const StringPiece&, void* value);
+  size_t charge;
+  string key;
+  uint32 refs;   // References, including the cache reference, if present.
+  bool in_cache;  // Whether entry is in the cache.
+  // The position of the entry in the list it belongs to, if in_cache.
+  std::list<LRUHandle*>::iterator position;
+};
+
+// A single shard of sharded cache.
+class LRUCache {
+ public:
+  LRUCache() : capacity_(0), usage_(0) {}
+  ~LRUCache();
+
+  // Separate from constructor so caller can easily make an array of LRUCache
+  void SetCapacity(size_t capacity) { capacity_ = capacity; }
+
+  // Like Cache methods.
+  Cache::Handle* Insert(const StringPiece& key, void* value, size_t charge,
+                        void (*deleter)(const StringPiece& key, void* value));
+  Cache::Handle* Lookup(const StringPiece& key);
+  void Release(Cache::Handle* handle);
+  void Erase(const StringPiece& key);
+  size_t TotalCharge() const {
+    mutex_lock l(mu_);
+    return usage_;
+  }
+
+ private:
+  void Ref(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Unref(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes "e" from the cache, which must hold a reference on it.
+  void FinishErase(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Initialized before use.
+  size_t capacity_;
+
+  mutable mutex mu_;
+  size_t usage_ GUARDED_BY(mu_);
+
+  // Entries with refs == 1 and in_cache == true, most recently used first.
+  std::list<LRUHandle*> lru_ GUARDED_BY(mu_);
+  // Entries with refs >= 2 and in_cache == true.
+  std::list<LRUHandle*> in_use_ GUARDED_BY(mu_);
+
+  // The keys point to the key of their entry.
+  std::unordered_map<StringPiece, LRUHandle*, StringPiece::Hasher> table_
+      GUARDED_BY(mu_);
+};
+
+LRUCache::~LRUCache() {
+  mutex_lock l(mu_);
+  CHECK(in_use_.empty()) << "Cache destroyed with unreleased handles";
+  for (LRUHandle* e : lru_) {
+    CHECK(e->in_cache);
+    e->in_cache = false;
+    CHECK_EQ(e->refs, 1);  // Invariant of lru_ list.
+    Unref(e);
+  }
+}
+
+void LRUCache::Ref(LRUHandle* e) {
+  if (e->refs == 1 && e->in_cache) {  // If on lru_ list, move to in_use_ list.
+    in_use_.splice(in_use_.end(), lru_, e->position);
+  }
+  e->refs++;
+}
+
+void LRUCache::Unref(LRUHandle* e) {
+  CHECK_GT(e->refs, 0);
+  e->refs--;
+  if (e->refs == 0) {  // Deallocate.
+    CHECK(!e->in_cache);
+    (*e->deleter)(e->key, e->value);
+    delete e;
+  } else if (e->in_cache && e->refs == 1) {
+    // No longer in use; move to lru_ list.
+    lru_.splice(lru_.begin(), in_use_, e->position);
+  }
+}
+
+Cache::Handle* LRUCache::Insert(const StringPiece& key, void* value,
+                                size_t charge,
+                                void (*deleter)(const StringPiece& key,
+                                                void* value)) {
+  mutex_lock l(mu_);
+
+  LRUHandle* e = new LRUHandle;
+  e->value = value;
+  e->deleter = deleter;
+  e->charge = charge;
+  e->key = key.ToString();
+  e->refs = 1;  // for the returned handle.
+  e->in_cache = false;
+
+  if (capacity_ > 0) {
+    e->refs++;  // for the cache's reference.
+    e->in_cache = true;
+    e->position = in_use_.insert(in_use_.end(), e);
+    usage_ += charge;
+    auto it = table_.find(StringPiece(e->key));
+    if (it != table_.end()) {
+      LRUHandle* old = it->second;
+      table_.erase(it);
+      FinishErase(old);
+    }
+    table_[StringPiece(e->key)] = e;
+  }  // else don't cache.  (capacity_==0 is supported and turns off caching.)
+
+  while (usage_ > capacity_ && !lru_.empty()) {
+    LRUHandle* old = lru_.back();
+    CHECK_EQ(old->refs, 1);
+    table_.erase(StringPiece(old->key));
+    FinishErase(old);
+  }
+
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+Cache::Handle* LRUCache::Lookup(const StringPiece& key) {
+  mutex_lock l(mu_);
+  auto it = table_.find(key);
+  if (it == table_.end()) {
+    return nullptr;
+  }
+  Ref(it->second);
+  return reinterpret_cast<Cache::Handle*>(it->second);
+}
+
+void LRUCache::Release(Cache::Handle* handle) {
+  mutex_lock l(mu_);
+  Unref(reinterpret_cast<LRUHandle*>(handle));
+}
+
+void LRUCache::FinishErase(LRUHandle* e) {
+  CHECK(e->in_cache);
+  if (e->refs == 1) {
+    lru_.erase(e->position);
+  } else {
+    in_use_.erase(e->position);
+  }
+  e->in_cache = false;
+  usage_ -= e->charge;
+  Unref(e);
+}
+
+void LRUCache::Erase(const StringPiece& key) {
+  mutex_lock l(mu_);
+  auto it = table_.find(key);
+  if (it != table_.end()) {
+    LRUHandle* e = it->second;
+    table_.erase(it);
+    FinishErase(e);
+  }
+}
+
+static const int kNumShardBits = 4;
+static const int kNumShards = 1 << kNumShardBits;
+
+class ShardedLRUCache : public Cache {
+ public:
+  explicit ShardedLRUCache(size_t capacity) : last_id_(0) {
+    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
+    for (int s = 0; s < kNumShards; s++) {
+      shard_[s].SetCapacity(per_shard);
+    }
+  }
+  ~ShardedLRUCache() override {}
+
+  Handle* Insert(const StringPiece& key, void* value, size_t charge,
+                 void (*deleter)(const StringPiece& key,
+                                 void* value)) override {
+    return shard_[Shard(key)].Insert(key, value, charge, deleter);
+  }
+  Handle* Lookup(const StringPiece& key) override {
+    return shard_[Shard(key)].Lookup(key);
+  }
+  void Release(Handle* handle) override {
+    LRUHandle* h = reinterpret_cast<LRUHandle*>(handle);
+    shard_[Shard(h->key)].Release(handle);
+  }
+  void Erase(const StringPiece& key) override {
+    shard_[Shard(key)].Erase(key);
+  }
+  void* Value(Handle* handle) override {
+    return reinterpret_cast<LRUHandle*>(handle)->value;
+  }
+  uint64 NewId() override {
+    mutex_lock l(id_mutex_);
+    return ++(last_id_);
+  }
+  size_t TotalCharge() const override {
+    size_t total = 0;
+    for (int s = 0; s < kNumShards; s++) {
+      total += shard_[s].TotalCharge();
+    }
+    return total;
+  }
+
+ private:
+  static uint32 Shard(const StringPiece& key) {
+    return Hash32(key.data(), key.size(), 0) >> (32 - kNumShardBits);
+  }
+
+  LRUCache shard_[kNumShards];
+  mutex id_mutex_;
+  uint64 last_id_ GUARDED_BY(id_mutex_);
+};
+
+}  // namespace
+
+Cache* NewLRUCache(size_t capacity) { return new ShardedLRUCache(capacity); }
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,154 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           size_t buffer_bytes,
+                                           int num_buffers)
+    : file_(file), buffer_bytes_(buffer_bytes), num_buffers_(num_buffers) {
+  CHECK_GT(buffer_bytes_, 0);
+  CHECK_GT(num_buffers_, 0);
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  mutex_lock l(mu_);
+  DiscardBuffers(&l);
+}
+
+void ReadaheadInputStream::IssueReads(mutex_lock* l) {
+  while (!end_of_file_ && buffers_.size() < static_cast<size_t>(num_buffers_)) {
+    buffers_.emplace_back(new Buffer);
+    Buffer* buffer = buffers_.back().get();
+    buffer->offset = next_read_offset_;
+    buffer->data.resize(buffer_bytes_);
+    next_read_offset_ += buffer_bytes_;
+    ++num_outstanding_;
+    // The buffer is not accessed by this thread until the read is done.
+    l->unlock();
+    file_->ReadAsync(
+        buffer->offset, buffer_bytes_, &buffer->data[0],
+        [this, buffer](const Status& read_status, StringPiece result) {
+          // A short read at the end of the file is not an error.
+          Status s = read_status;
+          if (errors::IsOutOfRange(s)) {
+            s = Status::OK();
+          }
+
+          mutex_lock l(mu_);
+          if (result.data() != buffer->data.data()) {
+            memmove(&buffer->data[0], result.data(), result.size());
+          }
+          buffer->data.resize(result.size());
+          buffer->status = s;
+          buffer->done = true;
+          if (s.ok() && buffer->data.size() < buffer_bytes_) {
+            end_of_file_ = true;
+          }
+          --num_outstanding_;
+          cond_var_.notify_all();
+        });
+    l->lock();
+  }
+}
+
+Status ReadaheadInputStream::WaitForFront(mutex_lock* l) {
+  IssueReads(l);
+  DCHECK(!buffers_.empty());
+  while (!buffers_.front()->done) {
+    cond_var_.wait(*l);
+  }
+  return buffers_.front()->status;
+}
+
+void ReadaheadInputStream::DiscardBuffers(mutex_lock* l) {
+  while (num_outstanding_ > 0) {
+    cond_var_.wait(*l);
+  }
+  buffers_.clear();
+}
+
+Status ReadaheadInputStream::Consume(int64 bytes_to_consume, string* result) {
+  mutex_lock l(mu_);
+  while (bytes_to_consume > 0) {
+    TF_RETURN_IF_ERROR(WaitForFront(&l));
+    const Buffer* front = buffers_.front().get();
+    const int64 offset_in_buffer = pos_ - front->offset;
+    const int64 n = std::min<int64>(front->data.size() - offset_in_buffer,
+                                    bytes_to_consume);
+    if (result != nullptr) {
+      result->append(front->data, offset_in_buffer, n);
+    }
+    pos_ += n;
+    bytes_to_consume -= n;
+    if (pos_ == front->offset + static_cast<int64>(front->data.size())) {
+      if (front->data.size() < buffer_bytes_) {
+        // The last buffer of the file is kept, so that later reads also
+        // reach the end of the file.
+        if (bytes_to_consume > 0) {
+          return errors::OutOfRange("reached end of file");
+        }
+      } else {
+        buffers_.pop_front();
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  return Consume(bytes_to_skip, nullptr);
+}
+
+int64 ReadaheadInputStream::Tell() const { return pos_; }
+
+Status ReadaheadInputStream::Seek(int64 position) {
+  if (position < 0) {
+    return errors::InvalidArgument("Can't seek to a negative position");
+  }
+  if (position == pos_) {
+    return Status::OK();
+  }
+  mutex_lock l(mu_);
+  DiscardBuffers(&l);
+  pos_ = position;
+  next_read_offset_ = position;
+  end_of_file_ = false;
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that reads ahead of
+// the current position. Up to `num_buffers` reads of `buffer_bytes` each are
+// kept in flight with RandomAccessFile::ReadAsync(), so that the latency of
+// each read (e.g. a round-trip to a remote file system) overlaps with the
+// consumption of the previous buffers.
+//
+// A given instance of ReadaheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                       int num_buffers);
+
+  // Waits for the outstanding reads to finish.
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  // Moves the stream to `position`, discarding the buffers read ahead.
+  Status Seek(int64 position);
+
+  Status Reset() override { return Seek(0); }
+
+ private:
+  // The result of reading one buffer from `file_`.
+  struct Buffer {
+    int64 offset = 0;
+    string data;
+    Status status;
+    bool done = false;
+  };
+
+  // Issues reads until `num_buffers_` are in flight or buffered, unless the
+  // end of the file has been reached. Releases the lock while issuing each
+  // read, whose callback may run on this thread.
+  void IssueReads(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits until the first buffer has been read, and returns its status.
+  Status WaitForFront(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits for all outstanding reads, and discards the buffers.
+  void DiscardBuffers(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Consumes up to `bytes_to_consume` bytes of the buffered data, appending
+  // them to `result` if it is not null. Returns OUT_OF_RANGE if the end of
+  // the file is reached first.
+  Status Consume(int64 bytes_to_consume, string* result);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t buffer_bytes_;
+  const int num_buffers_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // The buffers in file order. The first one contains `pos_`.
+  std::deque<std::unique_ptr<Buffer>> buffers_ GUARDED_BY(mu_);
+  // Only accessed by the thread using the stream.
+  int64 pos_ = 0;
+  // The offset in the file of the next buffer to read.
+  int64 next_read_offset_ GUARDED_BY(mu_) = 0;
+  // The number of reads that have been scheduled but not finished.
+  int num_outstanding_ GUARDED_BY(mu_) = 0;
+  // True once a read has returned fewer bytes than requested.
+  bool end_of_file_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadaheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
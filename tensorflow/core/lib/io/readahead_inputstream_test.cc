@@ -0,0 +1,114 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() { return {1, 2, 3, 4, 5, 10, 11, 65536}; }
+
+TEST(ReadaheadInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/readahead_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  for (auto buf_size : BufferSizes()) {
+    for (int num_buffers : {1, 3}) {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+      string read;
+      ReadaheadInputStream in(file.get(), buf_size, num_buffers);
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(5, &read));
+      EXPECT_EQ(read, "34567");
+      EXPECT_EQ(8, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+      EXPECT_EQ(read, "89");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+    }
+  }
+}
+
+TEST(ReadaheadInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/readahead_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+    string read;
+    ReadaheadInputStream in(file.get(), buf_size, 2);
+    TF_ASSERT_OK(in.SkipNBytes(3));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    EXPECT_EQ(7, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(20)));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "");
+  }
+}
+
+TEST(ReadaheadInputStream, Seek) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/readahead_inputstream_seek_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+    string read;
+    ReadaheadInputStream in(file.get(), buf_size, 2);
+
+    // Seek forward
+    TF_ASSERT_OK(in.Seek(3));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    EXPECT_EQ(7, in.Tell());
+
+    // Seek backwards
+    TF_ASSERT_OK(in.Seek(1));
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "1234");
+    EXPECT_EQ(5, in.Tell());
+
+    // Seeking back from the end of the file reads the data again.
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+  }
+}
+
+}  // anonymous namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -22,11 +22,17 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace io {
 
+namespace {
+const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
+const size_t kFooterSize = sizeof(uint32);
+}  // namespace
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -61,20 +67,40 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #if defined(IS_SLIM_BUILD)
     LOG(FATAL) << "Zlib compression is unsupported on mobile platforms.";
 #else   // IS_SLIM_BUILD
-    random_input_stream_.reset(new RandomAccessInputStream(file));
+    InputStreamInterface* compressed_stream;
+    if (options.readahead_buffer_size > 0) {
+      readahead_input_stream_.reset(new ReadaheadInputStream(
+          file, options.readahead_buffer_size, options.readahead_num_buffers));
+      compressed_stream = readahead_input_stream_.get();
+    } else {
+      random_input_stream_.reset(new RandomAccessInputStream(file));
+      compressed_stream = random_input_stream_.get();
+    }
     zlib_input_stream_.reset(new ZlibInputStream(
-        random_input_stream_.get(), options.zlib_options.input_buffer_size,
+        compressed_stream, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
-    // Nothing to do.
+    if (options.readahead_buffer_size > 0) {
+#if defined(IS_SLIM_BUILD)
+      LOG(ERROR) << "Read-ahead is not supported but readahead_buffer_size is "
+                 << "set. No read-ahead will be used.";
+#else
+      readahead_input_stream_.reset(new ReadaheadInputStream(
+          file, options.readahead_buffer_size, options.readahead_num_buffers));
+#endif  // IS_SLIM_BUILD
+    }
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 }
 
+RecordReader::RecordReader(ReadOnlyMemoryRegion* region)
+    : src_(nullptr), region_(region) {}
+
 RecordReader::~RecordReader() {
   zlib_input_stream_.reset(nullptr);
+  readahead_input_stream_.reset(nullptr);
   random_input_stream_.reset(nullptr);
 }
 
@@ -109,6 +135,29 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
       }
     }
 
+    uint32 masked_crc = core::DecodeFixed32(storage->data() + n);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
+      return errors::DataLoss("corrupted record at ", offset);
+    }
+    *result = StringPiece(storage->data(), n);
+  } else if (readahead_input_stream_) {
+    // The read-ahead buffers are only useful if the file is read
+    // sequentially, but any other offset is handled by seeking, which
+    // discards them.
+    TF_RETURN_IF_ERROR(readahead_input_stream_->Seek(offset));
+    Status s = readahead_input_stream_->ReadNBytes(expected, storage);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+
+    if (storage->size() != expected) {
+      if (storage->empty()) {
+        return errors::OutOfRange("eof");
+      } else {
+        return errors::DataLoss("truncated record at ", offset);
+      }
+    }
+
     uint32 masked_crc = core::DecodeFixed32(storage->data() + n);
     if (crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
       return errors::DataLoss("corrupted record at ", offset);
@@ -139,9 +188,57 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
   return Status::OK();
 }
 
+// Like ReadChecksummed(), but stores in *result a view of the n bytes in the
+// memory region.
+Status RecordReader::ReadChecksummedFromRegion(uint64 offset, size_t n,
+                                               StringPiece* result) {
+  if (n >= SIZE_MAX - sizeof(uint32)) {
+    return errors::DataLoss("record size too large");
+  }
+  const uint64 length = region_->length();
+  if (offset >= length) {
+    return errors::OutOfRange("eof");
+  }
+  const size_t expected = n + sizeof(uint32);
+  if (length - offset < expected) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  const char* data = static_cast<const char*>(region_->data()) + offset;
+  uint32 masked_crc = core::DecodeFixed32(data + n);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data, n)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *result = StringPiece(data, n);
+  return Status::OK();
+}
+
+Status RecordReader::ReadRecord(uint64* offset, StringPiece* record) {
+  if (region_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Records can only be read without copying from a memory region");
+  }
+  StringPiece lbuf;
+  TF_RETURN_IF_ERROR(ReadChecksummedFromRegion(*offset, sizeof(uint64), &lbuf));
+  const uint64 length = core::DecodeFixed64(lbuf.data());
+
+  Status s = ReadChecksummedFromRegion(*offset + kHeaderSize, length, record);
+  if (!s.ok()) {
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", *offset);
+    }
+    return s;
+  }
+  *offset += kHeaderSize + length + kFooterSize;
+  return Status::OK();
+}
+
 Status RecordReader::ReadRecord(uint64* offset, string* record) {
-  static const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
-  static const size_t kFooterSize = sizeof(uint32);
+  if (region_ != nullptr) {
+    StringPiece view;
+    TF_RETURN_IF_ERROR(ReadRecord(offset, &view));
+    record->assign(view.data(), view.size());
+    return Status::OK();
+  }
 
   // Read header data.
   StringPiece lbuf;
@@ -172,5 +269,59 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
   return Status::OK();
 }
 
+Status RecordReader::ReadIndex(RandomAccessFile* index_file) {
+  // Read the index in chunks of whole entries.
+  static const size_t kChunkSize = RecordWriter::kIndexEntrySize * 4096;
+  std::vector<uint64> record_offsets;
+  string scratch;
+  scratch.resize(kChunkSize);
+  uint64 index_offset = 0;
+  while (true) {
+    StringPiece data;
+    Status s = index_file->Read(index_offset, kChunkSize, &data, &scratch[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      return s;
+    }
+    if (data.size() % RecordWriter::kIndexEntrySize != 0) {
+      return errors::DataLoss("truncated record index at ",
+                              index_offset + data.size());
+    }
+    for (size_t i = 0; i < data.size(); i += RecordWriter::kIndexEntrySize) {
+      const char* entry = data.data() + i;
+      uint32 masked_crc = core::DecodeFixed32(entry + sizeof(uint64));
+      if (crc32c::Unmask(masked_crc) != crc32c::Value(entry, sizeof(uint64))) {
+        return errors::DataLoss("corrupted record index entry at ",
+                                index_offset + i);
+      }
+      record_offsets.push_back(core::DecodeFixed64(entry));
+    }
+    index_offset += data.size();
+    if (data.size() < kChunkSize) {
+      break;
+    }
+  }
+  record_offsets_ = std::move(record_offsets);
+  has_index_ = true;
+  return Status::OK();
+}
+
+Status RecordReader::GetRecordOffset(int64 record_number,
+                                     uint64* offset) const {
+  if (!has_index_) {
+    return errors::FailedPrecondition("no record index has been loaded");
+  }
+  if (record_number < 0) {
+    return errors::InvalidArgument("record number must be non-negative, got ",
+                                   record_number);
+  }
+  if (record_number >= static_cast<int64>(record_offsets_.size())) {
+    return errors::OutOfRange("record ", record_number,
+                              " is past the end of the file, which has ",
+                              record_offsets_.size(), " records");
+  }
+  *offset = record_offsets_[record_number];
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
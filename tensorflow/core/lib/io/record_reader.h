@@ -16,10 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
@@ -29,6 +32,7 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -40,6 +44,14 @@ class RecordReaderOptions {
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
+  // If greater than zero, the file is read ahead of the current record in
+  // `readahead_num_buffers` buffers of this many bytes each, on a shared
+  // background thread pool. This hides the latency of remote file systems,
+  // but assumes that the records are mostly read sequentially: reading
+  // from any other offset discards the buffers read ahead.
+  int64 readahead_buffer_size = 0;
+  int readahead_num_buffers = 4;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to zlib compression.
   ZlibCompressionOptions zlib_options;
@@ -53,6 +65,12 @@ class RecordReader {
   RecordReader(RandomAccessFile* file,
                const RecordReaderOptions& options = RecordReaderOptions());
 
+  // Create a reader that will return log records from the contents of an
+  // uncompressed file mapped in "*region", e.g. by
+  // Env::NewReadOnlyMemoryRegionFromFile(). "*region" must remain live
+  // while this Reader and the records it returned are in use.
+  explicit RecordReader(ReadOnlyMemoryRegion* region);
+
   virtual ~RecordReader();
 
   // Read the record at "*offset" into *record and update *offset to
@@ -60,14 +78,40 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, string* record);
 
+  // Like ReadRecord() above, but stores in "*record" a view of the record
+  // in the memory region instead of a copy. Requires a reader created from
+  // a ReadOnlyMemoryRegion.
+  Status ReadRecord(uint64* offset, StringPiece* record);
+
+  // Loads the index written alongside the file by RecordWriter, which
+  // enables GetRecordOffset(). Replaces any previously loaded index.
+  Status ReadIndex(RandomAccessFile* index_file);
+
+  // The number of records in the loaded index, or -1 if no index has
+  // been loaded.
+  int64 num_indexed_records() const {
+    return has_index_ ? record_offsets_.size() : -1;
+  }
+
+  // Stores in "*offset" the offset of the record with the (0-based)
+  // number "record_number", to be passed to ReadRecord(). Requires a
+  // loaded index. Returns OUT_OF_RANGE if the file has fewer records.
+  Status GetRecordOffset(int64 record_number, uint64* offset) const;
+
  private:
   Status ReadChecksummed(uint64 offset, size_t n, StringPiece* result,
                          string* storage);
+  Status ReadChecksummedFromRegion(uint64 offset, size_t n,
+                                   StringPiece* result);
 
   RandomAccessFile* src_;
+  ReadOnlyMemoryRegion* region_ = nullptr;
   RecordReaderOptions options_;
+  bool has_index_ = false;
+  std::vector<uint64> record_offsets_;
 #if !defined(IS_SLIM_BUILD)
   std::unique_ptr<RandomAccessInputStream> random_input_stream_;
+  std::unique_ptr<ReadaheadInputStream> readahead_input_stream_;
   std::unique_ptr<ZlibInputStream> zlib_input_stream_;
 #endif  // IS_SLIM_BUILD
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/platform/env.h"
 
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -105,4 +107,270 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = io::RecordIndexFilename(fname);
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriter writer(file.get(), io::RecordWriterOptions(),
+                            index_file.get());
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  EXPECT_EQ(-1, reader.num_indexed_records());
+  uint64 offset;
+  EXPECT_TRUE(errors::IsFailedPrecondition(reader.GetRecordOffset(0, &offset)));
+
+  std::unique_ptr<RandomAccessFile> read_index_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &read_index_file));
+  TF_CHECK_OK(reader.ReadIndex(read_index_file.get()));
+  EXPECT_EQ(10, reader.num_indexed_records());
+
+  // Read the records in reverse order.
+  string record;
+  for (int i = 9; i >= 0; --i) {
+    TF_CHECK_OK(reader.GetRecordOffset(i, &offset));
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(strings::StrCat("record", i), record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.GetRecordOffset(10, &offset)));
+  EXPECT_TRUE(errors::IsInvalidArgument(reader.GetRecordOffset(-1, &offset)));
+
+  // A truncated index is rejected.
+  string index_contents;
+  TF_CHECK_OK(ReadFileToString(env, index_fname, &index_contents));
+  TF_CHECK_OK(WriteStringToFile(
+      env, index_fname,
+      index_contents.substr(0, index_contents.size() - 1)));
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &read_index_file));
+  EXPECT_TRUE(errors::IsDataLoss(reader.ReadIndex(read_index_file.get())));
+}
+
+TEST(RecordReaderWriterTest, TestMemoryRegion) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_region_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord(""));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::RecordReader reader(region.get());
+  const char* begin = static_cast<const char*>(region->data());
+  const char* end = begin + region->length();
+  uint64 offset = 0;
+  StringPiece view;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &view));
+  EXPECT_EQ("abc", view);
+  // The record points into the mapped file.
+  EXPECT_TRUE(view.data() >= begin && view.data() < end);
+  TF_CHECK_OK(reader.ReadRecord(&offset, &view));
+  EXPECT_EQ("", view);
+  // Records can also be copied out of the region.
+  string record;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("defg", record);
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &view)));
+
+  // Views are only available from memory regions.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader file_reader(read_file.get());
+  offset = 0;
+  EXPECT_TRUE(
+      errors::IsFailedPrecondition(file_reader.ReadRecord(&offset, &view)));
+
+  // A truncated region is detected.
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  TF_CHECK_OK(
+      WriteStringToFile(env, fname, contents.substr(0, contents.size() - 1)));
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::RecordReader truncated_reader(region.get());
+  offset = 0;
+  TF_CHECK_OK(truncated_reader.ReadRecord(&offset, &view));
+  TF_CHECK_OK(truncated_reader.ReadRecord(&offset, &view));
+  EXPECT_TRUE(errors::IsDataLoss(truncated_reader.ReadRecord(&offset, &view)));
+}
+
+TEST(RecordReaderWriterTest, TestReadahead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_readahead_test";
+
+  for (auto compression_type : {io::RecordWriterOptions::NONE,
+                                io::RecordWriterOptions::ZLIB_COMPRESSION}) {
+    std::vector<uint64> offsets;
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = compression_type;
+      io::RecordWriter writer(file.get(), options);
+      uint64 offset = 0;
+      for (int i = 0; i < 100; ++i) {
+        offsets.push_back(offset);
+        const string record = strings::StrCat("record", i);
+        TF_EXPECT_OK(writer.WriteRecord(record));
+        offset += record.size() + 16;
+      }
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    for (auto buf_size : BufferSizes()) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type =
+          compression_type == io::RecordWriterOptions::NONE
+              ? io::RecordReaderOptions::NONE
+              : io::RecordReaderOptions::ZLIB_COMPRESSION;
+      options.readahead_buffer_size = buf_size;
+      options.readahead_num_buffers = 3;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      string record;
+      for (int i = 0; i < 100; ++i) {
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(strings::StrCat("record", i), record);
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+
+      if (compression_type == io::RecordWriterOptions::NONE) {
+        // Reading from an earlier offset discards the buffers read ahead.
+        offset = offsets[42];
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ("record42", record);
+        EXPECT_EQ(offsets[43], offset);
+      }
+    }
+  }
+}
+
+// A file held in memory, which leaves out the cost of the file system.
+class InMemoryFile : public RandomAccessFile {
+ public:
+  explicit InMemoryFile(const string& contents) : contents_(contents) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset >= contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("EOF");
+    }
+    const size_t available = std::min<size_t>(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, available);
+    *result = StringPiece(scratch, available);
+    return available < n ? errors::OutOfRange("EOF") : Status::OK();
+  }
+
+ private:
+  const string contents_;
+};
+
+// Where BM_RecordReader reads the records from.
+enum RecordSource {
+  kLocalFile = 0,
+  kLocalFileZlib = 1,
+  kLocalFileReadahead = 2,
+  kMemoryRegion = 3,
+  kInMemoryFile = 4,
+};
+
+// Reads 64MB of records of "record_size" bytes from "source".
+static void BM_RecordReader(int iters, int record_size, int source) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  const string fname =
+      strings::StrCat(testing::TmpDir(), "/bm_record_reader_", source);
+  const int num_records = std::max(1, (64 << 20) / record_size);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options;
+    if (source == kLocalFileZlib) {
+      options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+    }
+    io::RecordWriter writer(file.get(), options);
+    const string record(record_size, 'x');
+    for (int i = 0; i < num_records; ++i) {
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (source == kMemoryRegion) {
+    TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  } else if (source == kInMemoryFile) {
+    string contents;
+    TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+    file.reset(new InMemoryFile(contents));
+  } else {
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  }
+  io::RecordReaderOptions options;
+  if (source == kLocalFileZlib) {
+    options.compression_type = io::RecordReaderOptions::ZLIB_COMPRESSION;
+  } else if (source == kLocalFileReadahead) {
+    options.readahead_buffer_size = 1 << 20;
+  }
+
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    std::unique_ptr<io::RecordReader> reader(
+        region != nullptr ? new io::RecordReader(region.get())
+                          : new io::RecordReader(file.get(), options));
+    uint64 offset = 0;
+    StringPiece view;
+    string record;
+    for (int j = 0; j < num_records; ++j) {
+      if (region != nullptr) {
+        TF_CHECK_OK(reader->ReadRecord(&offset, &view));
+      } else {
+        TF_CHECK_OK(reader->ReadRecord(&offset, &record));
+      }
+    }
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_records);
+  testing::BytesProcessed(static_cast<int64>(iters) * num_records *
+                          record_size);
+  TF_CHECK_OK(env->DeleteFile(fname));
+}
+BENCHMARK(BM_RecordReader)
+    ->ArgPair(100, kLocalFile)
+    ->ArgPair(100, kLocalFileZlib)
+    ->ArgPair(100, kLocalFileReadahead)
+    ->ArgPair(100, kMemoryRegion)
+    ->ArgPair(100, kInMemoryFile)
+    ->ArgPair(100000, kLocalFile)
+    ->ArgPair(100000, kLocalFileZlib)
+    ->ArgPair(100000, kLocalFileReadahead)
+    ->ArgPair(100000, kMemoryRegion)
+    ->ArgPair(100000, kInMemoryFile);
+
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -28,6 +29,12 @@ bool IsZlibCompressed(RecordWriterOptions options) {
 }
 }  // namespace
 
+const size_t RecordWriter::kIndexEntrySize;
+
+string RecordIndexFilename(const string& filename) {
+  return strings::StrCat(filename, ".index");
+}
+
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     const string& compression_type) {
   RecordWriterOptions options;
@@ -79,6 +86,15 @@ RecordWriter::RecordWriter(WritableFile* dest,
   }
 }
 
+RecordWriter::RecordWriter(WritableFile* dest,
+                           const RecordWriterOptions& options,
+                           WritableFile* index_dest)
+    : RecordWriter(dest, options) {
+  CHECK(!IsZlibCompressed(options))
+      << "Record indexes are unsupported for compressed files.";
+  index_dest_ = index_dest;
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -105,9 +121,19 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[sizeof(uint32)];
   core::EncodeFixed32(footer, MaskedCrc(data.data(), data.size()));
 
+  if (index_dest_ != nullptr) {
+    char entry[kIndexEntrySize];
+    core::EncodeFixed64(entry + 0, offset_);
+    core::EncodeFixed32(entry + sizeof(uint64),
+                        MaskedCrc(entry, sizeof(uint64)));
+    TF_RETURN_IF_ERROR(index_dest_->Append(StringPiece(entry, sizeof(entry))));
+  }
+
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  offset_ += sizeof(header) + data.size() + sizeof(footer);
+  return Status::OK();
 }
 
 Status RecordWriter::Close() {
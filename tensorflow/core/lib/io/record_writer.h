@@ -45,14 +45,34 @@ class RecordWriterOptions {
 #endif  // IS_SLIM_BUILD
 };
 
+// Returns the conventional name of the index of the record file at
+// "filename".
+string RecordIndexFilename(const string& filename);
+
 class RecordWriter {
  public:
+  // The size of each entry of a record index, which holds the offset of one
+  // record:
+  //  uint64    offset
+  //  uint32    masked crc of offset
+  static const size_t kIndexEntrySize = sizeof(uint64) + sizeof(uint32);
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Create a writer that will append data to "*dest", and the offset of
+  // each record to the index "*index_dest". The index lets a RecordReader
+  // find any record without scanning the file from the start. Indexes are
+  // only supported for uncompressed files.
+  // "*dest" and "*index_dest" must be initially empty.
+  // "*dest" and "*index_dest" must remain live while this Writer is in use.
+  // Like "*dest", "*index_dest" is not flushed or closed by the writer.
+  RecordWriter(WritableFile* dest, const RecordWriterOptions& options,
+               WritableFile* index_dest);
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -75,6 +95,9 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  WritableFile* index_dest_ = nullptr;
+  // The offset in "*dest" of the next record.
+  uint64 offset_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
@@ -62,6 +62,12 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if the filter block of the table shows that "key" is
+  // not in the table, without reading any data block.  Returns true
+  // otherwise, including when the table was opened without a
+  // filter_policy or written without a filter block.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -69,6 +75,9 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  void ReadMeta(const Footer& footer);
+  void ReadFilter(const StringPiece& filter_handle_value);
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
@@ -21,6 +21,9 @@ limitations under the License.
 namespace tensorflow {
 namespace table {
 
+class Cache;
+class FilterPolicy;
+
 // DB contents are stored in a set of blocks, each of which holds a
 // sequence of key,value pairs.  Each block may be compressed before
 // being stored in a file.  The following enum describes which
@@ -60,6 +63,17 @@ struct Options {
   // incompressible, the kSnappyCompression implementation will
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
+
+  // If non-NULL, use the specified cache for blocks read by Table.
+  // If NULL, blocks are read and decoded again on every access.  The
+  // cache may be shared by several tables.  Not owned.
+  Cache* block_cache = nullptr;
+
+  // If non-NULL, TableBuilder writes a filter block built with this
+  // policy, and Table uses it to skip reading the data blocks of keys
+  // that are not in the table.  Tables written with a filter remain
+  // readable without it.  Not owned.
+  const FilterPolicy* filter_policy = nullptr;
 };
 
 }  // namespace table
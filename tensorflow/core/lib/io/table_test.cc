@@ -17,16 +17,20 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/block_builder.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/filter_policy.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
@@ -224,6 +228,8 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    table_options.block_cache = options.block_cache;
+    table_options.filter_policy = options.filter_policy;
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -233,6 +239,10 @@ class TableConstructor : public Constructor {
     return table_->ApproximateOffsetOf(key);
   }
 
+  bool KeyMayMatch(const StringPiece& key) const {
+    return table_->KeyMayMatch(key);
+  }
+
   uint64 BytesRead() const { return source_->BytesRead(); }
 
  private:
@@ -621,5 +631,85 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+// Builds a table of "num_keys" keys, with small blocks.
+static void BuildTable(int num_keys, const Options& options,
+                       TableConstructor* c) {
+  for (int i = 0; i < num_keys; i++) {
+    c->Add(strings::Printf("k%05d", i), strings::Printf("v%05d", i));
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  c->Finish(options, &keys, &kvmap);
+}
+
+TEST(TableTest, BloomFilter) {
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10));
+  Options options;
+  options.block_size = 256;
+  options.compression = kNoCompression;
+  options.filter_policy = policy.get();
+  TableConstructor c;
+  const int kNumKeys = 1000;
+  BuildTable(kNumKeys, options, &c);
+
+  for (int i = 0; i < kNumKeys; i++) {
+    EXPECT_TRUE(c.KeyMayMatch(strings::Printf("k%05d", i)));
+  }
+  // Checking missing keys reads no data blocks, and mostly rules them out.
+  const uint64 bytes_read = c.BytesRead();
+  int false_positives = 0;
+  for (int i = 0; i < kNumKeys; i++) {
+    if (c.KeyMayMatch(strings::Printf("k%05d_missing", i))) {
+      false_positives++;
+    }
+  }
+  EXPECT_EQ(bytes_read, c.BytesRead());
+  EXPECT_LT(false_positives, kNumKeys * 0.03);
+  EXPECT_FALSE(c.KeyMayMatch("zzz"));
+
+  // The filter does not change the contents seen by iterators.
+  std::unique_ptr<Iterator> iter(c.NewIterator());
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  EXPECT_EQ(kNumKeys, count);
+}
+
+TEST(TableTest, NoFilterPolicyMatchesAllKeys) {
+  Options options;
+  TableConstructor c;
+  BuildTable(10, options, &c);
+  EXPECT_TRUE(c.KeyMayMatch("missing"));
+}
+
+TEST(TableTest, BlockCache) {
+  std::unique_ptr<Cache> cache(NewLRUCache(1 << 20));
+  Options options;
+  options.block_size = 256;
+  options.compression = kNoCompression;
+  options.block_cache = cache.get();
+  TableConstructor c;
+  const int kNumKeys = 1000;
+  BuildTable(kNumKeys, options, &c);
+
+  auto seek_all = [&c]() {
+    for (int i = kNumKeys - 1; i >= 0; i -= 7) {
+      std::unique_ptr<Iterator> iter(c.NewIterator());
+      const string key = strings::Printf("k%05d", i);
+      iter->Seek(key);
+      ASSERT_TRUE(iter->Valid());
+      EXPECT_EQ(key, iter->key());
+      EXPECT_EQ(strings::Printf("v%05d", i), iter->value());
+    }
+  };
+  seek_all();
+  const uint64 bytes_read = c.BytesRead();
+  EXPECT_GT(cache->TotalCharge(), 0);
+  // The second pass is served from the cache.
+  seek_all();
+  EXPECT_EQ(bytes_read, c.BytesRead());
+}
+
 }  // namespace table
 }  // namespace tensorflow
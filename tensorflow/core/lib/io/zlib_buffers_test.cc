@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace io {
@@ -192,5 +193,42 @@ TEST(ZlibInputStream, FailsToReadIfWindowBitsAreIncompatible) {
   CHECK(read_status.error_message().find("inflate() failed") != string::npos);
 }
 
+// Decompresses about 64MB of gzip data, with input and output buffers of
+// "buffer_size" bytes.
+static void BM_ZlibInputStream(int iters, int buffer_size) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/bm_zlib_inputstream";
+  const string data = GenTestString((64 << 20) / GetRecord().size());
+  {
+    std::unique_ptr<WritableFile> file_writer;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file_writer));
+    ZlibOutputBuffer out(file_writer.get(), 1 << 20, 1 << 20,
+                         CompressionOptions::GZIP());
+    TF_CHECK_OK(out.Init());
+    TF_CHECK_OK(out.Append(StringPiece(data)));
+    TF_CHECK_OK(out.Close());
+    TF_CHECK_OK(file_writer->Close());
+  }
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file_reader));
+
+  testing::StartTiming();
+  string result;
+  for (int i = 0; i < iters; ++i) {
+    RandomAccessInputStream input_stream(file_reader.get());
+    ZlibInputStream in(&input_stream, buffer_size, buffer_size,
+                       CompressionOptions::GZIP());
+    for (size_t read = 0; read < data.size(); read += result.size()) {
+      const size_t bytes_to_read = std::min<size_t>(1 << 20, data.size() - read);
+      TF_CHECK_OK(in.ReadNBytes(bytes_to_read, &result));
+    }
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * data.size());
+  TF_CHECK_OK(env->DeleteFile(fname));
+}
+BENCHMARK(BM_ZlibInputStream)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
 }  // namespace io
 }  // namespace tensorflow
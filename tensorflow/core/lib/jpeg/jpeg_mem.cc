@@ -92,8 +92,9 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   // if empty image, return
   if (datasize == 0 || srcdata == nullptr) return nullptr;
 
-  // Declare temporary buffer pointer here so that we can free on error paths
+  // Declare temporary buffer pointers here so that we can free on error paths
   JSAMPLE* tempdata = nullptr;
+  JSAMPLE* crop_line = nullptr;
 
   // Initialize libjpeg structures to have a memory source
   // Modify the usual jpeg error manager to catch fatal errors.
@@ -106,6 +107,7 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   jerr.error_exit = CatchError;
   if (setjmp(jpeg_jmpbuf)) {
     delete[] tempdata;
+    delete[] crop_line;
     return nullptr;
   }
 
@@ -159,8 +161,44 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
     return nullptr;
   }
 
+  // The size of the returned image, and the first line of the (scaled) image
+  // that goes into it.
+  int output_width = cinfo.output_width;
+  int output_height = cinfo.output_height;
+  int first_line = 0;
+  // The offset in pixels of the crop window within each decoded line.
+  int crop_offset = 0;
+  if (flags.crop) {
+    const int image_width = cinfo.output_width;
+    const int image_height = cinfo.output_height;
+    if (flags.crop_x < 0 || flags.crop_y < 0 || flags.crop_width <= 0 ||
+        flags.crop_height <= 0 ||
+        flags.crop_x + flags.crop_width > image_width ||
+        flags.crop_y + flags.crop_height > image_height) {
+      LOG(ERROR) << "Invalid crop window: x=" << flags.crop_x
+                 << ", y=" << flags.crop_y << ", width=" << flags.crop_width
+                 << ", height=" << flags.crop_height
+                 << " for image size: " << image_width << " x "
+                 << image_height;
+      jpeg_destroy_decompress(&cinfo);
+      return nullptr;
+    }
+    output_width = flags.crop_width;
+    output_height = flags.crop_height;
+    first_line = flags.crop_y;
+    // libjpeg can only crop at iMCU boundaries: it moves the left edge down to
+    // one and widens the window to compensate.  The extra columns are dropped
+    // when copying each line out of crop_line.
+    JDIMENSION crop_x = flags.crop_x;
+    JDIMENSION crop_width = flags.crop_width;
+    if (crop_width != cinfo.output_width) {
+      jpeg_crop_scanline(&cinfo, &crop_x, &crop_width);
+    }
+    crop_offset = flags.crop_x - crop_x;
+  }
+
   // check for compatible stride
-  const int min_stride = cinfo.output_width * components * sizeof(JSAMPLE);
+  const int min_stride = output_width * components * sizeof(JSAMPLE);
   if (stride == 0) {
     stride = min_stride;
   } else if (stride < min_stride) {
@@ -170,11 +208,11 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   }
 
   // Remember stride and height for use in Uncompress
-  argball->height_ = cinfo.output_height;
+  argball->height_ = output_height;
   argball->stride_ = stride;
 
-  uint8* const dstdata = argball->allocate_output_(
-      cinfo.output_width, cinfo.output_height, components);
+  uint8* const dstdata =
+      argball->allocate_output_(output_width, output_height, components);
   if (dstdata == nullptr) {
     jpeg_destroy_decompress(&cinfo);
     return nullptr;
@@ -185,11 +223,22 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   const bool use_cmyk = (cinfo.out_color_space == JCS_CMYK);
   tempdata = use_cmyk ? new JSAMPLE[cinfo.output_width * 4] : nullptr;
 
+  // Temporary buffer holding each decoded line when cropping, since the
+  // decoded line is wider than the crop window.
+  crop_line = flags.crop
+                  ? new JSAMPLE[cinfo.output_width * components]
+                  : nullptr;
+  if (first_line > 0) {
+    jpeg_skip_scanlines(&cinfo, first_line);
+  }
+  const int last_line = first_line + output_height;
+
   // If there is an error reading a line, this aborts the reading.
   // Save the fraction of the image that has been read.
-  argball->height_read_ = cinfo.output_height;
-  while (cinfo.output_scanline < cinfo.output_height) {
+  argball->height_read_ = output_height;
+  while (static_cast<int>(cinfo.output_scanline) < last_line) {
     int num_lines_read = 0;
+    JSAMPLE* decoded_line = flags.crop ? crop_line : output_line;
     if (cinfo.out_color_space == JCS_CMYK) {
       num_lines_read = jpeg_read_scanlines(&cinfo, &tempdata, 1);
       // Convert CMYK to RGB
@@ -208,24 +257,23 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
           g = (255 - k) * (255 - m) / 255;
           b = (255 - k) * (255 - y) / 255;
         }
-        output_line[3 * i + 0] = r;
-        output_line[3 * i + 1] = g;
-        output_line[3 * i + 2] = b;
+        decoded_line[3 * i + 0] = r;
+        decoded_line[3 * i + 1] = g;
+        decoded_line[3 * i + 2] = b;
       }
     } else {
-      num_lines_read = jpeg_read_scanlines(&cinfo, &output_line, 1);
+      num_lines_read = jpeg_read_scanlines(&cinfo, &decoded_line, 1);
     }
     // Handle error cases
     if (num_lines_read == 0) {
       LOG(ERROR) << "Premature end of JPEG data. Stopped at line "
                  << cinfo.output_scanline << "/" << cinfo.output_height;
       if (!flags.try_recover_truncated_jpeg) {
-        argball->height_read_ = cinfo.output_scanline;
+        argball->height_read_ = cinfo.output_scanline - first_line;
         error = JPEGERRORS_UNEXPECTED_END_OF_DATA;
       } else {
-        for (size_t line = cinfo.output_scanline; line < cinfo.output_height;
-             ++line) {
-          if (line == 0) {
+        for (int line = cinfo.output_scanline; line < last_line; ++line) {
+          if (line == first_line) {
             // If even the first line is missing, fill with black color
             memset(output_line, 0, min_stride);
           } else {
@@ -234,19 +282,23 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
           }
           output_line += stride;
         }
-        argball->height_read_ =
-            cinfo.output_height;  // consider all lines as read
+        argball->height_read_ = output_height;  // consider all lines as read
         // prevent error-on-exit in libjpeg:
         cinfo.output_scanline = cinfo.output_height;
       }
       break;
     }
     DCHECK_EQ(num_lines_read, 1);
+    if (flags.crop) {
+      memcpy(output_line, crop_line + crop_offset * components, min_stride);
+    }
     TF_ANNOTATE_MEMORY_IS_INITIALIZED(output_line, min_stride);
     output_line += stride;
   }
   delete[] tempdata;
   tempdata = nullptr;
+  delete[] crop_line;
+  crop_line = nullptr;
 
   // Convert the RGB data to RGBA, with alpha set to 0xFF to indicate
   // opacity.
@@ -254,17 +306,17 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   if (components == 4) {
     // Start on the last line.
     JSAMPLE* scanlineptr = static_cast<JSAMPLE*>(
-        dstdata + static_cast<int64>(cinfo.output_height - 1) * stride);
+        dstdata + static_cast<int64>(output_height - 1) * stride);
     const JSAMPLE kOpaque = -1;  // All ones appropriate for JSAMPLE.
-    const int right_rgb = (cinfo.output_width - 1) * 3;
-    const int right_rgba = (cinfo.output_width - 1) * 4;
+    const int right_rgb = (output_width - 1) * 3;
+    const int right_rgba = (output_width - 1) * 4;
 
-    for (int y = cinfo.output_height; y-- > 0;) {
+    for (int y = output_height; y-- > 0;) {
       // We do all the transformations in place, going backwards for each row.
       const JSAMPLE* rgb_pixel = scanlineptr + right_rgb;
       JSAMPLE* rgba_pixel = scanlineptr + right_rgba;
       scanlineptr -= stride;
-      for (int x = cinfo.output_width; x-- > 0;
+      for (int x = output_width; x-- > 0;
            rgba_pixel -= 4, rgb_pixel -= 3) {
         // We copy the 3 bytes at rgb_pixel into the 4 bytes at rgba_pixel
         // The "a" channel is set to be opaque.
@@ -309,7 +361,13 @@ uint8* UncompressLow(const void* srcdata, FewerArgsForCompiler* argball) {
   // Handle errors in JPEG
   switch (error) {
     case JPEGERRORS_OK:
-      jpeg_finish_decompress(&cinfo);
+      if (cinfo.output_scanline < cinfo.output_height) {
+        // The lines below the crop window are not needed, so stop decoding
+        // rather than reading them just to finish cleanly.
+        jpeg_abort(reinterpret_cast<j_common_ptr>(&cinfo));
+      } else {
+        jpeg_finish_decompress(&cinfo);
+      }
       break;
     case JPEGERRORS_UNEXPECTED_END_OF_DATA:
     case JPEGERRORS_BAD_PARAM:
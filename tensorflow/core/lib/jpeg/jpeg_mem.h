@@ -61,6 +61,20 @@ struct UncompressFlags {
   //
   // Setting this has a quality/speed trade-off implication.
   J_DCT_METHOD dct_method = JDCT_DEFAULT;
+
+  // If true, only the window of crop_width x crop_height pixels whose top left
+  // corner is at (crop_x, crop_y) is returned.  The window is given in the
+  // coordinates of the image after downscaling by ratio.  Columns left of the
+  // window are not color converted or upsampled, and rows above and below it
+  // are not inverse transformed, so decoding a small window is much cheaper
+  // than decoding the full image.  With fancy_upscaling, pixels along the
+  // edges of the window may differ slightly from a full decode, because the
+  // chroma upsampling there does not see the pixels outside the window.
+  bool crop = false;
+  int crop_x = 0;
+  int crop_y = 0;
+  int crop_width = 0;
+  int crop_height = 0;
 };
 
 // Uncompress some raw JPEG data given by the pointer srcdata and the length
@@ -95,6 +95,69 @@ TEST(JpegMemTest, Jpeg) {
   TestJPEG(env, data_path + "jpeg_merge_test1_cmyk.jpg");
 }
 
+void TestCropJPEG(Env* env, const string& jpegfile) {
+  string jpeg;
+  ReadFileToStringOrDie(env, jpegfile, &jpeg);
+  const int fsize = jpeg.size();
+  const uint8* const temp = bit_cast<const uint8*>(jpeg.data());
+
+  for (int ratio : {1, 2, 4}) {
+    UncompressFlags flags;
+    flags.components = 3;
+    flags.ratio = ratio;
+    // Chroma upsampling near the window edges differs otherwise.
+    flags.fancy_upscaling = false;
+    int w, h, c;
+    std::unique_ptr<uint8[]> full(
+        Uncompress(temp, fsize, flags, &w, &h, &c, nullptr));
+    ASSERT_TRUE(full != nullptr);
+
+    // Windows that touch each edge of the image, and one strictly inside it
+    // whose left edge is not on an iMCU boundary.
+    const int windows[][4] = {{0, 0, w, h},
+                              {0, 0, w / 2, h / 3},
+                              {w / 2, h / 3, w - w / 2, h - h / 3},
+                              {w / 5 + 1, h / 4 + 3, w / 3, h / 2}};
+    for (const auto& window : windows) {
+      UncompressFlags crop_flags = flags;
+      crop_flags.crop = true;
+      crop_flags.crop_x = window[0];
+      crop_flags.crop_y = window[1];
+      crop_flags.crop_width = window[2];
+      crop_flags.crop_height = window[3];
+      int cw, ch, cc;
+      std::unique_ptr<uint8[]> crop(
+          Uncompress(temp, fsize, crop_flags, &cw, &ch, &cc, nullptr));
+      ASSERT_TRUE(crop != nullptr);
+      EXPECT_EQ(window[2], cw);
+      EXPECT_EQ(window[3], ch);
+      EXPECT_EQ(3, cc);
+      EXPECT_EQ(0, ComputeSumAbsoluteDifference(
+                       crop.get(),
+                       full.get() + (window[1] * w + window[0]) * 3, cw, ch,
+                       cw * 3, w * 3));
+    }
+
+    // Windows that do not fit in the image are rejected.
+    UncompressFlags bad_flags = flags;
+    bad_flags.crop = true;
+    bad_flags.crop_x = w / 2;
+    bad_flags.crop_width = w - w / 2 + 1;
+    bad_flags.crop_height = h;
+    int bw, bh, bc;
+    std::unique_ptr<uint8[]> bad(
+        Uncompress(temp, fsize, bad_flags, &bw, &bh, &bc, nullptr));
+    EXPECT_TRUE(bad == nullptr);
+  }
+}
+
+TEST(JpegMemTest, Crop) {
+  Env* env = Env::Default();
+  const string data_path = kTestData;
+  TestCropJPEG(env, data_path + "jpeg_merge_test1.jpg");
+  TestCropJPEG(env, data_path + "jpeg_merge_test1_cmyk.jpg");
+}
+
 TEST(JpegMemTest, Jpeg2) {
   // create known data, for size in_w x in_h
   const int in_w = 256;
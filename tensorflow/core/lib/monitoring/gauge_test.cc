@@ -0,0 +1,64 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/gauge.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace monitoring {
+namespace {
+
+auto* gauge_with_labels = Gauge<1>::New("/tensorflow/test/gauge_with_labels",
+                                        "Gauge with one label.", "MyLabel");
+
+TEST(LabeledGaugeTest, InitializedWithZero) {
+  EXPECT_EQ(0, gauge_with_labels->GetCell("Empty")->value());
+}
+
+TEST(LabeledGaugeTest, GetCell) {
+  auto* cell = gauge_with_labels->GetCell("GetCellOp");
+  EXPECT_EQ(0, cell->value());
+
+  cell->Set(42);
+  EXPECT_EQ(42, cell->value());
+
+  auto* same_cell = gauge_with_labels->GetCell("GetCellOp");
+  EXPECT_EQ(42, same_cell->value());
+
+  same_cell->Set(58);
+  EXPECT_EQ(58, cell->value());
+  EXPECT_EQ(58, same_cell->value());
+}
+
+auto* gauge_without_labels = Gauge<0>::New(
+    "/tensorflow/test/gauge_without_labels", "Gauge without any labels.");
+
+TEST(UnlabeledGaugeTest, SetAndIncrement) {
+  auto* cell = gauge_without_labels->GetCell();
+  EXPECT_EQ(0, cell->value());
+
+  cell->Set(42);
+  cell->IncrementBy(8);
+  EXPECT_EQ(50, cell->value());
+
+  // Unlike counters, gauges may go down.
+  cell->IncrementBy(-20);
+  EXPECT_EQ(30, gauge_without_labels->GetCell()->value());
+}
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tensorflow
@@ -183,6 +183,58 @@ class PhiloxRandom {
     return counter;
   }
 
+  // The number of samples that Fill computes together.
+  static const int kFillBatchSize = 8;
+
+  // Writes the next "count" samples to output[0, 4 * count), exactly as
+  // "count" calls of operator() would, and advances the stream past them.
+  // kFillBatchSize samples are computed together in structure-of-arrays form,
+  // so that the compiler can vectorize the multiplies of each round. CPU only.
+  void Fill(uint32* output, int64 count) {
+    int64 i = 0;
+    for (; i + kFillBatchSize <= count; i += kFillBatchSize) {
+      uint32 c0[kFillBatchSize];
+      uint32 c1[kFillBatchSize];
+      uint32 c2[kFillBatchSize];
+      uint32 c3[kFillBatchSize];
+      for (int j = 0; j < kFillBatchSize; ++j) {
+        c0[j] = counter_[0];
+        c1[j] = counter_[1];
+        c2[j] = counter_[2];
+        c3[j] = counter_[3];
+        SkipOne();
+      }
+      Key key = key_;
+      for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+          RaiseKey(&key);
+        }
+        // The same computation as ComputeSingleRound, on every lane.
+        for (int j = 0; j < kFillBatchSize; ++j) {
+          const uint64 product0 = static_cast<uint64>(kPhiloxM4x32A) * c0[j];
+          const uint64 product1 = static_cast<uint64>(kPhiloxM4x32B) * c2[j];
+          c0[j] = static_cast<uint32>(product1 >> 32) ^ c1[j] ^ key[0];
+          c1[j] = static_cast<uint32>(product1);
+          c2[j] = static_cast<uint32>(product0 >> 32) ^ c3[j] ^ key[1];
+          c3[j] = static_cast<uint32>(product0);
+        }
+      }
+      uint32* out = output + i * kResultElementCount;
+      for (int j = 0; j < kFillBatchSize; ++j) {
+        out[4 * j] = c0[j];
+        out[4 * j + 1] = c1[j];
+        out[4 * j + 2] = c2[j];
+        out[4 * j + 3] = c3[j];
+      }
+    }
+    for (; i < count; ++i) {
+      const ResultType sample = (*this)();
+      for (int k = 0; k < kResultElementCount; ++k) {
+        output[i * kResultElementCount + k] = sample[k];
+      }
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static const uint32 kPhiloxW32A = 0x9E3779B9;
@@ -68,6 +68,35 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// Checks that Fill produces the same samples as repeated calls of operator(),
+// for counts that are and are not multiples of the batch size, and leaves the
+// generator at the same position.
+TEST(PhiloxRandomTest, FillMatchTest) {
+  uint64 test_seed = GetTestSeed();
+  for (int count : {1, PhiloxRandom::kFillBatchSize, 37}) {
+    // Start just below a carry into the high words of the counter.
+    PhiloxRandom gen1(test_seed, test_seed);
+    gen1.Skip(0xffffffffULL - 5);
+    PhiloxRandom gen2 = gen1;
+
+    std::vector<uint32> v1(4 * count);
+    gen1.Fill(&v1[0], count);
+
+    std::vector<uint32> v2(4 * count);
+    for (int i = 0; i < count; ++i) {
+      auto sample = gen2();
+      std::copy(&sample[0], &sample[0] + 4, &v2[4 * i]);
+    }
+    EXPECT_EQ(v1, v2);
+
+    auto next1 = gen1();
+    auto next2 = gen2();
+    for (int k = 0; k < 4; ++k) {
+      EXPECT_EQ(next1[k], next2[k]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -1093,7 +1093,8 @@ global_step.
 handle: The handle to a accumulator.
 local_step: The local_step value at which the sparse gradient was computed.
 gradient_indices: Indices of the sparse gradient to be accumulated. Must be a
-  vector.
+  vector. The indices may be in any order and may repeat, in which case the
+  slices of a repeated index are summed.
 gradient_values: Values are the non-zero slices of the gradient, and must have
   the same first dimension as indices, i.e., the nnz represented by indices and
   values must be consistent.
@@ -1131,7 +1132,8 @@ aggregate to 0.
 
 handle: The handle to a SparseConditionalAccumulator.
 num_required: Number of gradients required before we return an aggregate.
-indices: Indices of the average of the accumulated sparse gradients.
+indices: Indices of the average of the accumulated sparse gradients, sorted and
+  unique.
 values: Values of the average of the accumulated sparse gradients.
 shape: Shape of the average of the accumulated sparse gradients.
 dtype: The data type of accumulated gradients. Needs to correspond to the type
@@ -2095,6 +2097,36 @@ container: If non-empty, this queue is placed in the given container. Otherwise,
 shared_name: It is necessary to match this name to the matching Unstage Op.
 )doc");
 
+REGISTER_OP("StageToDevice")
+    .Input("values: dtypes")
+    .Attr("capacity: int >= 0 = 0")
+    .Attr("memory_limit: int >= 0 = 0")
+    .Attr("dtypes: list(type)")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .SetIsStateful()
+    .Doc(R"doc(
+Stage host values on the device of the staging area.
+
+Like Stage, but `values` stay in host memory and are copied to the device
+asynchronously.  The op completes once the copies have been issued, and the
+element only becomes available to Unstage and StagePeek once they are done.
+This hides the host to device transfer of the next element behind the
+current step.
+
+values: a list of tensors in host memory
+dtypes A list of data types that inserted values should adhere to.
+capacity: Maximum number of elements in the Staging Area. If > 0, inserts
+  on the container will block when the capacity is reached.
+memory_limit: The maximum number of bytes allowed for Tensors in the Staging Area.
+  If > 0, inserts will block until sufficient space is available.  Elements
+  whose copies are in flight count towards the limit.
+container: If non-empty, this queue is placed in the given container. Otherwise,
+  a default container is used.
+shared_name: It is necessary to match this name to the matching Unstage Op.
+)doc");
+
 REGISTER_OP("Unstage")
     .Output("values: dtypes")
     .Attr("capacity: int >= 0 = 0")
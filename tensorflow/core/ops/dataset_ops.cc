@@ -172,9 +172,29 @@ up to `num_threads` threads to process elements from `input_dataset`
 in parallel.
 
 num_threads: The number of threads to use to process elements from
-  `input_dataset`.
+  `input_dataset`, or -1 to adjust the number of threads at runtime from the
+  time that the consumer spends waiting for elements.
 output_buffer_size: The maximum number of output elements to buffer in an
-  iterator over this dataset.
+  iterator over this dataset, or -1 (when `num_threads` is -1) to buffer
+  twice as many elements as there are active threads.
+)doc");
+
+REGISTER_OP("PrefetchDataset")
+    .Input("input_dataset: resource")
+    .Input("buffer_size: int64")
+    .Output("handle: resource")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that asynchronously prefetches elements from `input_dataset`.
+
+A background thread of each iterator over this dataset reads elements from
+`input_dataset` ahead of the consumer, so that producing them overlaps with
+the computation that consumes them.
+
+buffer_size: The maximum number of elements to buffer in an iterator over
+  this dataset.
 )doc");
 
 REGISTER_OP("FlatMapDataset")
@@ -223,6 +243,41 @@ f: A function mapping elements of `input_dataset`, concatenated with
   `output_types` and `output_shapes`.
 )doc");
 
+REGISTER_OP("ParallelInterleaveDataset")
+    .Input("input_dataset: resource")
+    .Input("other_arguments: Targuments")
+    .Input("cycle_length: int64")
+    .Input("block_length: int64")
+    .Input("sloppy: bool")
+    .Input("buffer_output_elements: int64")
+    .Output("handle: resource")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset`.
+
+Like InterleaveDataset, the `f` in ParallelInterleaveDataset is expected to
+return a Dataset resource, and the results are interleaved from up to
+`cycle_length` input elements. Unlike InterleaveDataset, each open input
+element is read by its own thread into a buffer of up to
+`buffer_output_elements` elements.
+
+If `sloppy` is false, the elements are produced in the same order as
+InterleaveDataset. If `sloppy` is true, the next element is taken from
+whichever open input element has one ready, and exhausted input elements are
+replaced straight away, so the order is non-deterministic.
+
+f: A function mapping elements of `input_dataset`, concatenated with
+  `other_arguments`, to a Dataset resource that contains elements matching
+  `output_types` and `output_shapes`.
+sloppy: If true, produce elements in the order in which they become ready.
+buffer_output_elements: The maximum number of elements to buffer for each open
+  input element.
+)doc");
+
 REGISTER_OP("GroupByWindowDataset")
     .Input("input_dataset: resource")
     .Input("key_func_other_arguments: Tkey_func_other_arguments")
@@ -282,6 +337,31 @@ batch_size: A scalar representing the number of elements to accumulate in a
   batch.
 )doc");
 
+REGISTER_OP("MapAndBatchDataset")
+    .Input("input_dataset: resource")
+    .Input("other_arguments: Targuments")
+    .Input("batch_size: int64")
+    .Input("num_threads: int32")
+    .Output("handle: resource")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset` and then
+batches `batch_size` of them.
+
+Unlike a "MapDataset" followed by a "BatchDataset", this dataset applies `f`
+to the elements of each batch in parallel on up to `num_threads` threads, and
+copies each result directly into its slice of the batch.
+
+batch_size: A scalar representing the number of elements to accumulate in a
+  batch.
+num_threads: The number of threads to use to apply `f` to the elements of a
+  batch.
+)doc");
+
 REGISTER_OP("PaddedBatchDataset")
     .Input("input_dataset: resource")
     .Input("batch_size: int64")
@@ -391,6 +471,32 @@ filename: A path on the filesystem where we should cache the dataset. Note: this
   will be a directory.
 )doc");
 
+REGISTER_OP("TieredCacheDataset")
+    .Input("input_dataset: resource")
+    .Input("filename: string")
+    .Input("memory_budget_bytes: int64")
+    .Output("handle: resource")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that caches elements from `input_dataset` in two tiers.
+
+A TieredCacheDataset keeps the elements produced by the first pass over
+`input_dataset` in memory until they would exceed `memory_budget_bytes`, and
+writes the remaining elements to files at `filename`. Later iterators replay
+the in-memory elements followed by the spilled elements, without iterating
+over `input_dataset` again.
+
+Unlike CacheDataset, the spilled files do not hold a complete cache, so they
+are overwritten by each new TieredCacheDataset and deleted when it is
+destroyed.
+
+filename: A path prefix on the filesystem where the elements that do not fit
+  in the memory budget are written.
+memory_budget_bytes: The maximum total size of the tensors to keep in memory.
+)doc");
+
 REGISTER_OP("TextLineDataset")
     .Input("filenames: string")
     .Input("compression_type: string")
@@ -413,6 +519,7 @@ REGISTER_OP("FixedLengthRecordDataset")
     .Input("header_bytes: int64")
     .Input("record_bytes: int64")
     .Input("footer_bytes: int64")
+    .Input("buffer_size: int64")
     .Output("handle: resource")
     .SetShapeFn(shape_inference::ScalarShape)
     .Doc(R"doc(
@@ -425,11 +532,29 @@ header_bytes: A scalar representing the number of bytes to skip at the
 record_bytes: A scalar representing the number of bytes in each record.
 footer_bytes: A scalar representing the number of bytes to skip at the end
   of a file.
+buffer_size: A scalar representing the number of bytes in each of the large
+  sequential reads issued ahead of the current record. 0 disables read-ahead.
+)doc");
+
+REGISTER_OP("LMDBDataset")
+    .Input("filenames: string")
+    .Output("handle: resource")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits the key-value pairs of one or more LMDB databases.
+
+The records of each database are produced in key order, by a cursor scan over
+a single read-only transaction. To read several databases in parallel,
+interleave one `LMDBDataset` per file.
+
+filenames: A scalar or a vector containing the name(s) of the LMDB
+  environment directories or files to be read.
 )doc");
 
 REGISTER_OP("TFRecordDataset")
     .Input("filenames: string")
     .Input("compression_type: string")
+    .Input("buffer_size: int64")
     .Output("handle: resource")
     .SetShapeFn(shape_inference::ScalarShape)
     .Doc(R"doc(
@@ -439,6 +564,9 @@ filenames: A scalar or vector containing the name(s) of the file(s) to be
   read.
 compression_type: A scalar containing either (i) the empty string (no
   compression), (ii) "ZLIB", or (iii) "GZIP".
+buffer_size: A scalar representing the number of bytes in each of the buffers
+  that are read ahead of the current record in the background, or 0 to read
+  each record synchronously.
 )doc");
 
 REGISTER_OP("Iterator")
@@ -89,6 +89,8 @@ REGISTER_OP("DebugIdentity")
     .Attr("tensor_name: string = ''")
     .Attr("debug_urls: list(string) = []")
     .Attr("gated_grpc: bool = false")
+    .Attr("sampling_interval: int >= 1 = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     .SetShapeFn(shape_inference::UnchangedShape)
     .Doc(R"doc(
@@ -107,6 +109,11 @@ gated_grpc: Whether this op will be gated. If any of the debug_urls of this
   debug op has been enabled at the debug_url. If all of the debug_urls of this
   debug node are of the grpc:// scheme and the debug op is enabled at none of
   them, the output will be an empty Tensor.
+sampling_interval: Only every sampling_interval-th execution of this op,
+  starting with the first one, computes and publishes the debug signal. The
+  other executions output an empty Tensor.
+async_publish: Whether the debug signal is published from a background thread,
+  instead of blocking the execution of this op on the debug URLs.
 )doc");
 
 REGISTER_OP("DebugNanCount")
@@ -117,6 +124,8 @@ REGISTER_OP("DebugNanCount")
     .Attr("tensor_name: string = ''")
     .Attr("debug_urls: list(string) = []")
     .Attr("gated_grpc: bool = false")
+    .Attr("sampling_interval: int >= 1 = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     .Doc(R"doc(
 Debug NaN Value Counter Op
@@ -134,6 +143,11 @@ gated_grpc: Whether this op will be gated. If any of the debug_urls of this
   debug op has been enabled at the debug_url. If all of the debug_urls of this
   debug node are of the grpc:// scheme and the debug op is enabled at none of
   them, the output will be an empty Tensor.
+sampling_interval: Only every sampling_interval-th execution of this op,
+  starting with the first one, computes and publishes the debug signal. The
+  other executions output an empty Tensor.
+async_publish: Whether the debug signal is published from a background thread,
+  instead of blocking the execution of this op on the debug URLs.
 )doc");
 
 REGISTER_OP("DebugNumericSummary")
@@ -147,6 +161,8 @@ REGISTER_OP("DebugNumericSummary")
     .Attr("upper_bound: float = inf")
     .Attr("mute_if_healthy: bool = false")
     .Attr("gated_grpc: bool = false")
+    .Attr("sampling_interval: int >= 1 = 1")
+    .Attr("async_publish: bool = false")
     .SetAllowsUninitializedInput()
     .Doc(R"doc(
 Debug Numeric Summary Op.
@@ -198,7 +214,11 @@ gated_grpc: Whether this op will be gated. If any of the debug_urls of this
   debug op has been enabled at the debug_url. If all of the debug_urls of this
   debug node are of the grpc:// scheme and the debug op is enabled at none of
   them, the output will be an empty Tensor.
-
+sampling_interval: Only every sampling_interval-th execution of this op,
+  starting with the first one, computes and publishes the debug signal. The
+  other executions output an empty Tensor.
+async_publish: Whether the debug signal is published from a background thread,
+  instead of blocking the execution of this op on the debug URLs.
 )doc");
 
 }  // namespace tensorflow
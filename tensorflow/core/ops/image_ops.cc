@@ -404,6 +404,77 @@ dct_method: string specifying a hint about the algorithm used for
 image: 3-D with shape `[height, width, channels]`..
 )doc");
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndCropAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("align_corners: bool = false")
+    .Attr("dct_downscale: bool = true")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(unused, 0), 4, &unused_dim));
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels < 0) {
+        return errors::InvalidArgument("channels must be non-negative, got ",
+                                       channels);
+      }
+      DimensionHandle channels_dim = c->UnknownDim();
+      if (channels != 0) {
+        channels_dim = c->MakeDim(channels);
+      }
+      // Reuse the batched helper and drop the batch dimension.
+      TF_RETURN_IF_ERROR(SetOutputToSizedImage(c, c->MakeDim(1),
+                                               2 /* size_input_idx */,
+                                               channels_dim));
+      ShapeHandle image;
+      TF_RETURN_IF_ERROR(c->Subshape(c->output(0), 1, &image));
+      c->set_output(0, image);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Decode a crop of a JPEG-encoded image and resize it with bilinear
+interpolation.
+
+This is equivalent to `DecodeJpeg` followed by cropping `crop_window` out of
+the decoded image and `ResizeBilinear` of the crop to `size`, but much cheaper:
+only the crop window is decoded, and when the window is at least twice as
+large as `size` in both dimensions, the image is downscaled by a factor of 2,
+4 or 8 while decoding, in the DCT domain.
+
+The attr `channels` indicates the desired number of color channels for the
+decoded image, as for `DecodeJpeg`.
+
+contents: 0-D.  The JPEG-encoded image.
+crop_window: 1-D.  The crop window: [crop_y, crop_x, crop_height, crop_width],
+  in pixels of the full size image.
+size: = A 1-D int32 Tensor of 2 elements: `new_height, new_width`.  The
+  new size for the cropped image.
+channels: Number of color channels for the decoded image.
+align_corners: If true, rescale the crop by (new_height - 1) / (height - 1),
+  which exactly aligns the 4 corners of the crop and the resized image.  If
+  false, rescale by new_height / height.  Treat similarly the width dimension.
+dct_downscale: If false, always decode the crop at full resolution, so that
+  the result matches decoding, cropping and resizing in separate steps.
+fancy_upscaling: If true use a slower but nicer upscaling of the
+  chroma planes (yuv420/422 only).
+dct_method: string specifying a hint about the algorithm used for
+  decompression.  Defaults to "" which maps to a system-specific
+  default.  Currently valid values are ["INTEGER_FAST",
+  "INTEGER_ACCURATE"].  The hint may be ignored (e.g., the internal
+  jpeg library changes to a version that does not have that specific
+  option.)
+image: 3-D with shape `[new_height, new_width, channels]`.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -1200,4 +1271,65 @@ selected_indices: A 1-D integer tensor of shape `[M]` representing the selected
   indices from the boxes tensor, where `M <= max_output_size`.
 )doc");
 
+REGISTER_OP("BatchedNonMaxSuppression")
+    .Input("boxes: float")
+    .Input("scores: float")
+    .Input("max_output_size_per_class: int32")
+    .Input("iou_threshold: float")
+    .Input("score_threshold: float")
+    .Output("selected_indices: int32")
+    .Output("num_valid: int32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle boxes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &boxes));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 2), 4, &unused));
+      ShapeHandle scores;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &scores));
+      DimensionHandle batch_size;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 0), c->Dim(scores, 0), &batch_size));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 1), c->Dim(scores, 1), &unused));
+      for (int i = 2; i < 5; ++i) {
+        ShapeHandle scalar;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &scalar));
+      }
+      DimensionHandle max_output_size;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &max_output_size));
+      DimensionHandle num_classes = c->Dim(scores, 2);
+      c->set_output(0,
+                    c->MakeShape({batch_size, num_classes, max_output_size}));
+      c->set_output(1, c->MakeShape({batch_size, num_classes}));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Runs non max suppression independently for every image and class of a batch.
+
+For each image `b` and class `c`, greedily selects boxes of `boxes[b]` in
+descending order of `scores[b, :, c]`, the way `NonMaxSuppressionV2` does, after
+discarding the boxes whose score is not above `score_threshold`. The
+(image, class) pairs are processed in parallel, which is much faster than one
+`NonMaxSuppressionV2` op per pair for detection models with many classes.
+
+The selected indices of each pair are padded with zeros to
+`max_output_size_per_class`; only the first `num_valid[b, c]` are meaningful.
+
+boxes: A 3-D float tensor of shape `[batch_size, num_boxes, 4]`. The boxes of
+  each image are shared by all the classes.
+scores: A 3-D float tensor of shape `[batch_size, num_boxes, num_classes]`
+  holding the score of each box for each class.
+max_output_size_per_class: A scalar integer tensor representing the maximum
+  number of boxes to be selected for each image and class.
+iou_threshold: A 0-D float tensor representing the threshold for deciding
+  whether boxes overlap too much with respect to IOU.
+score_threshold: A 0-D float tensor. Boxes with a score at or below it are
+  never selected.
+selected_indices: A 3-D integer tensor of shape
+  `[batch_size, num_classes, max_output_size_per_class]` holding the selected
+  indices into the boxes of each image.
+num_valid: A 2-D integer tensor of shape `[batch_size, num_classes]` holding
+  the number of boxes selected for each image and class.
+)doc");
+
 }  // namespace tensorflow
@@ -62,6 +62,7 @@ REGISTER_OP("SaveV2")
     .Input("shape_and_slices: string")
     .Input("tensors: dtypes")
     .Attr("dtypes: list(type)")
+    .Attr("async_write: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -88,12 +89,18 @@ By default, saves the named tensors in full.  If the caller wishes to save
 specific slices of full tensors, "shape_and_slices" should be non-empty strings
 and correspondingly well-formed.
 
+If async_write is true, the op copies "tensors" into host memory and returns;
+the checkpoint is written by a background thread of the process.  The error of
+a failed background write is returned by the next SaveV2 or MergeV2Checkpoints
+op with async_write set.  RestoreV2 waits for pending writes of its prefix.
+
 prefix: Must have a single element. The prefix of the V2 checkpoint to which we
   write the tensors.
 tensor_names: shape {N}. The names of the tensors to be saved.
 shape_and_slices: shape {N}.  The slice specs of the tensors to be saved.
   Empty strings indicate that they are non-partitioned tensors.
 tensors: `N` tensors to save.
+async_write: see above.
 )doc");
 
 REGISTER_OP("RestoreV2")
@@ -142,6 +149,7 @@ REGISTER_OP("MergeV2Checkpoints")
     .Input("checkpoint_prefixes: string")
     .Input("destination_prefix: string")
     .Attr("delete_old_dirs: bool = true")
+    .Attr("async_write: bool = false")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) {
       ShapeHandle unused;
@@ -160,10 +168,16 @@ If delete_old_dirs is true, attempts to delete recursively the dirname of each
 path in the input checkpoint_prefixes.  This is useful when those paths are non
 user-facing temporary locations.
 
+If async_write is true, the merge is queued after the pending SaveV2 writes of
+this process, and the op returns immediately.  This requires the checkpoints
+to merge to be written by the same process.  Otherwise, the op first waits for
+the pending writes of the checkpoint_prefixes.
+
 checkpoint_prefixes: prefixes of V2 checkpoints to merge.
 destination_prefix: scalar.  The desired final prefix.  Allowed to be the same
   as one of the checkpoint_prefixes.
 delete_old_dirs: see above.
+async_write: see above.
 )doc");
 
 REGISTER_OP("Save")
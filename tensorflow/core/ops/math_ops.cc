@@ -354,6 +354,22 @@ Specifically, `grad = dy * y * (1 - y)`, where `y = sigmoid(x)`, and
 `dy` is the corresponding input gradient.
 )doc");
 
+REGISTER_OP("_FusedUnaryCwise")
+    .Input("x: T")
+    .Output("y: T")
+    .Attr("T: {half, float, double}")
+    .Attr("ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of unary element-wise ops to `x` in a single pass.
+
+NOTE Do not invoke this operator directly in Python. The grappler remapper is
+expected to create these operators.
+
+ops: The ops applied to each element, first to last. Each is one of Abs, Exp,
+  Log, Neg, Reciprocal, Relu, Rsqrt, Sigmoid, Sqrt, Square and Tanh.
+)doc");
+
 REGISTER_OP("Sin").UNARY_COMPLEX().Doc(R"doc(
 Computes sin of x element-wise.
 )doc");
@@ -1125,6 +1141,54 @@ The gradient computation of this operation will only take advantage of sparsity
 in the input gradient when that gradient comes from a Relu.
 )doc");
 
+REGISTER_OP("BlockSparseMatMul")
+    .Input("a: T")
+    .Input("b_values: T")
+    .Input("b_col_indices: int32")
+    .Input("b_row_ptr: int32")
+    .Output("product: T")
+    .Attr("T: {float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      ShapeHandle b_values;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &b_values));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      ShapeHandle b_row_ptr;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &b_row_ptr));
+
+      DimensionHandle num_block_rows;
+      TF_RETURN_IF_ERROR(
+          c->Subtract(c->Dim(b_row_ptr, 0), 1, &num_block_rows));
+      DimensionHandle n;
+      TF_RETURN_IF_ERROR(
+          c->Multiply(num_block_rows, c->Dim(b_values, 1), &n));
+      c->set_output(0, c->Matrix(c->Dim(a, 0), n));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Multiplies matrix `a` by the transpose of the block-sparse matrix `b`.
+
+`b` is an `[n, k]` matrix, typically a weight matrix laid out as
+`[output_features, input_features]`, whose non-zero values are grouped into
+`block_rows x block_cols` blocks and stored in block compressed sparse row
+(BSR) format. The product is `a * transpose(b)`, with shape `[m, n]`.
+
+This is faster than a dense matrix multiply when most of the blocks of `b` are
+zero, as is the case for weights pruned with a block-structured sparsity
+pattern.
+
+a: An `[m, k]` matrix.
+b_values: The non-zero blocks of `b`, with shape
+  `[num_blocks, block_rows, block_cols]`, ordered by block row and then by
+  block column.
+b_col_indices: The block column of each block, in `[0, k / block_cols)`.
+b_row_ptr: A vector of `n / block_rows + 1` offsets into `b_values`: the
+  blocks of block row `r` are `b_values[b_row_ptr[r]:b_row_ptr[r + 1]]`.
+product: `a * transpose(b)`.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -1809,6 +1873,72 @@ segment_ids: segment_ids passed to the corresponding SparseSegmentSqrtN op.
 output_dim0: dimension 0 of "data" passed to SparseSegmentSqrtN op.
 )doc");
 
+REGISTER_OP("SparseEmbeddingLookup")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: int32")
+    .Input("num_segments: int32")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params_shape));
+      ShapeHandle ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &segment_ids_shape));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+
+      // ids and segment_ids should merge.
+      TF_RETURN_IF_ERROR(c->Merge(ids_shape, segment_ids_shape, &unused));
+
+      DimensionHandle num_segments;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(3, &num_segments));
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->Vector(num_segments), subshape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Looks up the embeddings of sparse ids and combines them per segment.
+
+Computes the same result as gathering `params` at `ids` followed by
+`SparseSegmentSum`, `SparseSegmentMean` or `SparseSegmentSqrtN`, but in a
+single pass that writes the combined rows straight to the output, without
+materializing the gathered `[N, ...]` intermediate.  This is the computation of
+`embedding_lookup_sparse` with a single, unpartitioned `params` tensor and no
+weights.
+
+For example, for a batch of two examples where the first has ids 0 and 2 and
+the second has id 1:
+
+```python
+params = tf.constant([[1., 2.], [3., 4.], [5., 6.]])
+
+sparse_embedding_lookup(params, ids=[0, 2, 1], segment_ids=[0, 0, 1],
+                        num_segments=2, combiner="mean")
+# => [[3., 4.]
+#     [3., 4.]]
+```
+
+params: The embedding table.  Dimension 0 is indexed by `ids`.
+ids: A 1-D tensor of rows of `params` to look up.
+segment_ids: A 1-D tensor of the output row of each id, of the same size as
+  `ids`.  Values should be sorted and can be repeated.
+num_segments: The number of output rows.  Rows without ids are set to zero.
+combiner: How the rows of each segment are combined: "sum" adds them, "mean"
+  divides their sum by their number, and "sqrtn" divides their sum by the
+  square root of their number.
+output: Has same shape as params, except for dimension 0 which has size
+  `num_segments`.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -2138,6 +2268,50 @@ bins: 1D `Tensor` with length equal to `size`. The counts or summed weights for
     each value in the range [0, size).
 )doc");
 
+REGISTER_OP("HistogramFixedWidth")
+    .Input("values: T")
+    .Input("value_range: T")
+    .Input("nbins: int32")
+    .Output("out: dtype")
+    .Attr("T: {int32, int64, float32, float64}")
+    .Attr("dtype: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle value_range;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &value_range));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(value_range, 0), 2, &unused_dim));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      const Tensor* nbins_t = c->input_tensor(2);
+      if (nbins_t == nullptr) {
+        c->set_output(0, c->UnknownShapeOfRank(1));
+        return Status::OK();
+      }
+      const int32 nbins = nbins_t->scalar<int32>()();
+      if (nbins <= 0) {
+        return errors::InvalidArgument("nbins should be positive, got ",
+                                       nbins);
+      }
+      c->set_output(0, c->Vector(nbins));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Return histogram of values.
+
+Given the tensor `values`, this operation returns a rank 1 histogram counting
+the number of entries in `values` that fall into every bin. The bins are equal
+width and determined by the arguments `value_range` and `nbins`. Values below
+the range, and NaNs, are counted in the first bin; values at or above the end
+of the range are counted in the last bin.
+
+values: Numeric `Tensor`.
+value_range: Shape [2] `Tensor` of same `dtype` as `values`.
+  values <= value_range[0] will be mapped to hist[0],
+  values >= value_range[1] will be mapped to hist[-1].
+nbins: Scalar `int32 Tensor`. Number of histogram bins.
+out: A 1-D `Tensor` holding histogram of values.
+)doc");
+
 REGISTER_OP("Cumsum")
     .Input("x: T")
     .Input("axis: Tidx")
@@ -2273,6 +2447,66 @@ Tactivation: The type of output produced by activation function
 
 )doc");
 
+REGISTER_OP("QuantizedMatMulWithBiasAndRequantize")
+    .Input("a: T1")
+    .Input("b: T2")
+    .Input("bias: float")
+    .Input("min_a: float")
+    .Input("max_a: float")
+    .Input("min_b: float")
+    .Input("max_b: float")
+    .Input("requested_output_min: float")
+    .Input("requested_output_max: float")
+    .Output("out: Toutput")
+    .Output("min_out: float")
+    .Output("max_out: float")
+    .Attr("T1: quantizedtype")
+    .Attr("T2: quantizedtype")
+    .Attr("Toutput: quantizedtype = DT_QUINT8")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("fuse_relu: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      for (int i = 3; i < 9; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+
+      c->set_output(1, c->Scalar());
+      c->set_output(2, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Perform a quantized matrix multiplication followed by a bias addition, an
+optional ReLU and a requantization into `requested_output_min` and
+`requested_output_max`.
+
+This computes the same result as QuantizedMatMul, adding `bias` to every row,
+then Requantize and optionally QuantizedRelu, without materializing the 32-bit
+intermediate result.
+
+a: Must be a two-dimensional tensor.
+b: Must be a two-dimensional tensor.
+bias: A float vector with one value per output column, or an empty vector for
+  no bias.
+transpose_a: If true, `a` is transposed before multiplication.
+transpose_b: If true, `b` is transposed before multiplication.
+fuse_relu: If true, negative results are clamped to zero.
+min_a: The float value that the lowest quantized `a` value represents.
+max_a: The float value that the highest quantized `a` value represents.
+min_b: The float value that the lowest quantized `b` value represents.
+max_b: The float value that the highest quantized `b` value represents.
+requested_output_min: The float value that the minimum quantized output value
+  represents.  Must be <= 0.
+requested_output_max: The float value that the maximum quantized output value
+  represents.  Must be larger than `requested_output_min`.
+min_out: The requested_output_min value is copied into this output.
+max_out: The requested_output_max value is copied into this output.
+
+)doc");
+
 REGISTER_OP("QuantizedMul")
     .Input("x: T1")
     .Input("y: T2")
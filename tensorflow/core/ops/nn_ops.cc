@@ -552,6 +552,31 @@ data_format: Specify the data format of the input and output data. With the
         [batch, channels, height, width].
 )doc");
 
+REGISTER_OP("_FusedConv2D")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("bias: T")
+    .Output("output: T")
+    .Attr("T: {half, float}")
+    .Attr("strides: list(int)")
+    .Attr("use_cudnn_on_gpu: bool = true")
+    .Attr(GetPaddingAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("activation: {'Identity', 'Relu'} = 'Identity'")
+    .SetShapeFn(shape_inference::Conv2DShape)
+    .Doc(R"doc(
+Computes a Conv2D followed by a BiasAdd and an optional activation.
+
+The bias is added and the activation applied in a single pass over the output
+of the convolution.
+
+NOTE Do not invoke this operator directly in Python. The grappler remapper is
+expected to create these operators.
+
+bias: A 1-D tensor with one element per output channel.
+activation: The activation applied after adding the bias.
+)doc");
+
 REGISTER_OP("Conv2DBackpropInput")
     .Input("input_sizes: int32")
     .Input("filter: T")
@@ -265,6 +265,7 @@ REGISTER_OP("ResourceScatterAdd")
     .Input("updates: dtype")
     .Attr("dtype: numbertype")
     .Attr("Tindices: {int32, int64}")
+    .Attr("use_locking: bool = true")
     .SetShapeFn([](InferenceContext* c) {
       ShapeAndType handle_shape_and_type;
       TF_RETURN_IF_ERROR(
@@ -306,6 +307,9 @@ Requires `updates.shape = indices.shape + ref.shape[1:]`.
 resource: Should be from a `Variable` node.
 indices: A tensor of indices into the first dimension of `ref`.
 updates: A tensor of updated values to add to `ref`.
+use_locking: If True, the addition will be protected by a lock;
+  otherwise concurrent updates of the variable may run in parallel (Hogwild
+  style).  They are then only well defined if they touch disjoint rows.
 )doc");
 
 }  // namespace tensorflow
@@ -1312,6 +1312,89 @@ var - lr * momentum * accum, so in the end, the var you get is actually
 var - lr * momentum * accum.
 )doc");
 
+static Status ApplyMomentumNShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2 * n), 0, &unused));      // lr
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3 * n + 1), 0, &unused));  // momentum
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape(c, i);                           // var
+    TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, n + i), &s));  // accum
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(2 * n + 1 + i), &s));       // grad
+    if (c->num_outputs() > 0) {
+      c->set_output(i, s);
+    }
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("ApplyMomentumN")
+    .Input("var: Ref(N * T)")
+    .Input("accum: Ref(N * T)")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Output("out: Ref(N * T)")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyMomentumNShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the momentum scheme.
+
+Equivalent to one ApplyMomentum per variable, but all N variables are updated
+by a single kernel.
+The variables must be distinct.
+
+accum[i] = accum[i] * momentum + grad[i]
+var[i] -= lr * accum[i]
+
+var: Should be from Variables.
+accum: Should be from Variables.
+lr: Scaling factor. Must be a scalar.
+grad: The gradients.
+momentum: Momentum. Must be a scalar.
+out: Same as "var".
+use_locking: If `True`, updating of the var and accum tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update, as in ApplyMomentum.
+)doc");
+
+REGISTER_OP("ResourceApplyMomentumN")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyMomentumNShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the momentum scheme.
+
+Equivalent to one ResourceApplyMomentum per variable, but all N variables are
+updated by a single kernel.
+The variables must be distinct.
+
+accum[i] = accum[i] * momentum + grad[i]
+var[i] -= lr * accum[i]
+
+var: Should be from Variables.
+accum: Should be from Variables.
+lr: Scaling factor. Must be a scalar.
+grad: The gradients.
+momentum: Momentum. Must be a scalar.
+use_locking: If `True`, updating of the var and accum tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update, as in ApplyMomentum.
+)doc");
+
 static Status ApplyAdamShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
@@ -1415,6 +1498,117 @@ use_locking: If `True`, updating of the var, m, and v tensors will be protected
 use_nesterov: If `True`, uses the nesterov update.
 )doc");
 
+static Status ApplyAdamNShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+  for (int i = 3 * n; i < 3 * n + 6; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape(c, i);  // var
+    TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, n + i), &s));  // m
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, ShapeOrHandleShape(c, 2 * n + i), &s));        // v
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(3 * n + 6 + i), &s));  // grad
+    if (c->num_outputs() > 0) {
+      c->set_output(i, s);
+    }
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("ApplyAdamN")
+    .Input("var: Ref(N * T)")
+    .Input("m: Ref(N * T)")
+    .Input("v: Ref(N * T)")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Output("out: Ref(N * T)")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyAdamNShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the Adam algorithm.
+
+Equivalent to one ApplyAdam per variable, but all N variables are updated by a
+single kernel.
+The variables must be distinct.
+
+lr_t <- learning_rate * sqrt(1 - beta2^t) / (1 - beta1^t)
+m_t <- beta1 * m_{t-1} + (1 - beta1) * g_t
+v_t <- beta2 * v_{t-1} + (1 - beta2) * g_t * g_t
+variable <- variable - lr_t * m_t / (sqrt(v_t) + epsilon)
+
+var: Should be from Variables.
+m: Should be from Variables.
+v: Should be from Variables.
+beta1_power: Must be a scalar.
+beta2_power: Must be a scalar.
+lr: Scaling factor. Must be a scalar.
+beta1: Momentum factor. Must be a scalar.
+beta2: Momentum factor. Must be a scalar.
+epsilon: Ridge term. Must be a scalar.
+grad: The gradients.
+out: Same as "var".
+use_locking: If `True`, updating of the var, m, and v tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update.
+)doc");
+
+REGISTER_OP("ResourceApplyAdamN")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyAdamNShapeFn)
+    .Doc(R"doc(
+Update each '*var[i]' according to the Adam algorithm.
+
+Equivalent to one ResourceApplyAdam per variable, but all N variables are
+updated by a single kernel.
+The variables must be distinct.
+
+lr_t <- learning_rate * sqrt(1 - beta2^t) / (1 - beta1^t)
+m_t <- beta1 * m_{t-1} + (1 - beta1) * g_t
+v_t <- beta2 * v_{t-1} + (1 - beta2) * g_t * g_t
+variable <- variable - lr_t * m_t / (sqrt(v_t) + epsilon)
+
+var: Should be from Variables.
+m: Should be from Variables.
+v: Should be from Variables.
+beta1_power: Must be a scalar.
+beta2_power: Must be a scalar.
+lr: Scaling factor. Must be a scalar.
+beta1: Momentum factor. Must be a scalar.
+beta2: Momentum factor. Must be a scalar.
+epsilon: Ridge term. Must be a scalar.
+grad: The gradients.
+use_locking: If `True`, updating of the var, m, and v tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update.
+)doc");
+
 static Status ApplyRMSPropShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
@@ -20,6 +20,13 @@ limitations under the License.
 
 namespace tensorflow {
 
+FileBlockCache::~FileBlockCache() {
+  mutex_lock lock(mu_);
+  while (num_prefetches_ > 0) {
+    cond_var_.wait(lock);
+  }
+}
+
 Status FileBlockCache::Read(uint64 offset, size_t n, std::vector<char>* out) {
   out->clear();
   if (n == 0) {
@@ -44,41 +51,24 @@ Status FileBlockCache::Read(uint64 offset, size_t n, std::vector<char>* out) {
     TrimCache(0);
     timestamp_ = 0;
   }
-  // Now iterate through the blocks, reading them one at a time. Reads are
-  // locked so that only one block_fetcher call is active at any given time.
+  // A read that continues where the previous one ended is likely to be
+  // followed by reads of the next blocks.
+  const bool sequential = offset == last_read_end_;
+  last_read_end_ = offset + n;
+  // Now iterate through the blocks, reading them one at a time.
   for (uint64 pos = start; pos < finish; pos += block_size_) {
+    std::shared_ptr<Block> block;
+    TF_RETURN_IF_ERROR(GetBlock(pos, &lock, &block));
     auto entry = block_map_.find(pos);
-    if (entry == block_map_.end()) {
-      // We need to fetch the block from the remote filesystem. Trim the LRU
-      // cache if needed - we do this up front in order to avoid any period of
-      // time during which the cache size exceeds its desired limit. The
-      // tradeoff is that if the fetcher fails, the cache may evict a block
-      // prematurely.
-      TrimCache(block_count_ - 1);
-      std::unique_ptr<Block> block(new Block);
-      TF_RETURN_IF_ERROR(block_fetcher_(pos, block_size_, &block->data));
-      // Sanity check to detect interrupted reads leading to partial blocks: a
-      // partial block must have a higher key than the highest existing key in
-      // the block map.
-      if (block->data.size() < block_size_ && !block_map_.empty() &&
-          pos < block_map_.rbegin()->first) {
-        // We expected to read a full block at this position.
-        return errors::FailedPrecondition("File contents are inconsistent");
-      }
-      entry = block_map_.emplace(std::make_pair(pos, std::move(block))).first;
-      if (timestamp_ == 0) {
-        // Mark the timestamp of the first block's arrival in the cache.
-        timestamp_ = env_->NowSeconds();
-      }
-    } else {
-      // Cache hit. Remove the block from the LRU list at its prior location.
-      lru_list_.erase(entry->second->lru_iterator);
+    if (entry != block_map_.end() && entry->second == block) {
+      // Move the block to the front of the LRU list, unless it was evicted
+      // while we waited for it.
+      lru_list_.erase(block->lru_iterator);
+      lru_list_.push_front(pos);
+      block->lru_iterator = lru_list_.begin();
     }
-    // Push the block to the front of the LRU list.
-    lru_list_.push_front(pos);
-    entry->second->lru_iterator = lru_list_.begin();
     // Copy the relevant portion of the block into the result buffer.
-    const auto& data = entry->second->data;
+    const auto& data = block->data;
     if (offset >= pos + data.size()) {
       // The requested offset is at or beyond the end of the file. This can
       // happen if `offset` is not block-aligned, and the read returns the last
@@ -99,9 +89,98 @@ Status FileBlockCache::Read(uint64 offset, size_t n, std::vector<char>* out) {
       out->insert(out->end(), begin, end);
     }
   }
+  if (sequential && prefetch_block_count_ > 0) {
+    Prefetch(finish);
+  }
   return Status::OK();
 }
 
+std::shared_ptr<FileBlockCache::Block> FileBlockCache::InsertBlock(
+    uint64 pos) {
+  // Trim the LRU cache if needed - we do this up front in order to avoid any
+  // period of time during which the cache size exceeds its desired limit. The
+  // tradeoff is that if the fetcher fails, the cache may evict a block
+  // prematurely.
+  TrimCache(block_count_ - 1);
+  std::shared_ptr<Block> block(new Block);
+  block_map_[pos] = block;
+  lru_list_.push_front(pos);
+  block->lru_iterator = lru_list_.begin();
+  if (timestamp_ == 0) {
+    // Mark the timestamp of the first block's arrival in the cache.
+    timestamp_ = env_->NowSeconds();
+  }
+  return block;
+}
+
+Status FileBlockCache::FetchBlock(uint64 pos,
+                                  const std::shared_ptr<Block>& block,
+                                  mutex_lock* lock) {
+  // Fetch without holding the lock, so that other blocks can be read or
+  // fetched concurrently.
+  std::vector<char> data;
+  lock->unlock();
+  Status status = block_fetcher_(pos, block_size_, &data);
+  lock->lock();
+  if (status.ok() && data.size() < block_size_) {
+    // Sanity check to detect interrupted reads leading to partial blocks: a
+    // partial block must not precede a non-empty block. (Empty blocks past
+    // the end of the file may have been prefetched.)
+    for (auto it = block_map_.upper_bound(pos); it != block_map_.end(); ++it) {
+      if (it->second->fetched && !it->second->data.empty()) {
+        // We expected to read a full block at this position.
+        status = errors::FailedPrecondition("File contents are inconsistent");
+        break;
+      }
+    }
+  }
+  block->data.swap(data);
+  block->status = status;
+  block->fetched = true;
+  if (!status.ok()) {
+    // Remove the block, so that a later read fetches it again.
+    auto entry = block_map_.find(pos);
+    if (entry != block_map_.end() && entry->second == block) {
+      lru_list_.erase(block->lru_iterator);
+      block_map_.erase(entry);
+    }
+  }
+  cond_var_.notify_all();
+  return status;
+}
+
+Status FileBlockCache::GetBlock(uint64 pos, mutex_lock* lock,
+                                std::shared_ptr<Block>* block) {
+  auto entry = block_map_.find(pos);
+  if (entry == block_map_.end()) {
+    // We need to fetch the block from the remote filesystem.
+    *block = InsertBlock(pos);
+    return FetchBlock(pos, *block, lock);
+  }
+  // The block is cached, or another read or a prefetch is fetching it.
+  *block = entry->second;
+  while (!(*block)->fetched) {
+    cond_var_.wait(*lock);
+  }
+  return (*block)->status;
+}
+
+void FileBlockCache::Prefetch(uint64 pos) {
+  for (uint32 i = 0; i < prefetch_block_count_; ++i, pos += block_size_) {
+    if (block_map_.find(pos) != block_map_.end()) {
+      continue;
+    }
+    std::shared_ptr<Block> block = InsertBlock(pos);
+    ++num_prefetches_;
+    env_->SchedClosure([this, pos, block]() {
+      mutex_lock lock(mu_);
+      FetchBlock(pos, block, &lock).IgnoreError();
+      --num_prefetches_;
+      cond_var_.notify_all();
+    });
+  }
+}
+
 void FileBlockCache::TrimCache(size_t size) {
   while (lru_list_.size() > size) {
     block_map_.erase(lru_list_.back());
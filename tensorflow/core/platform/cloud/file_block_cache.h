@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -45,13 +46,23 @@ class FileBlockCache {
   typedef std::function<Status(uint64, size_t, std::vector<char>*)>
       BlockFetcher;
 
+  /// If `prefetch_block_count` is positive, reads that continue where the
+  /// previous read ended also fetch up to that many following blocks in the
+  /// background, while leaving room in the cache for the block being read.
   FileBlockCache(uint64 block_size, uint32 block_count, uint64 max_staleness,
-                 BlockFetcher block_fetcher, Env* env = Env::Default())
+                 BlockFetcher block_fetcher, Env* env = Env::Default(),
+                 uint32 prefetch_block_count = 0)
       : block_size_(block_size),
         block_count_(block_count),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {}
+        env_(env),
+        prefetch_block_count_(
+            block_count > 0 ? std::min(prefetch_block_count, block_count - 1)
+                            : 0) {}
+
+  /// Waits for the outstanding prefetches to finish.
+  ~FileBlockCache();
 
   /// Read `n` bytes starting at `offset` into `out`. This method will return:
   ///
@@ -66,12 +77,37 @@ class FileBlockCache {
   ///    placed in `out`.
   /// 4) OK otherwise (i.e. the read succeeded, and at least one byte was placed
   ///    in `out`).
+  ///
+  /// Concurrent reads that miss on different blocks fetch them in parallel,
+  /// and a read that misses on a block that is being fetched waits for that
+  /// fetch instead of issuing another one.
   Status Read(uint64 offset, size_t n, std::vector<char>* out);
 
  private:
+  struct Block;
+
   /// Trim the LRU cache until its size is at most `size` blocks.
   void TrimCache(size_t size) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Adds an empty block at `pos` to the block map and the front of the LRU
+  /// list, to be filled by FetchBlock().
+  std::shared_ptr<Block> InsertBlock(uint64 pos) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fills `block` from the backing filesystem, releasing `mu_` while the
+  /// fetcher runs, and wakes the readers waiting for it. The block is removed
+  /// from the cache if the fetch fails.
+  Status FetchBlock(uint64 pos, const std::shared_ptr<Block>& block,
+                    mutex_lock* lock) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Stores the block at `pos` in `*block`, fetching it unless it is cached
+  /// or already being fetched.
+  Status GetBlock(uint64 pos, mutex_lock* lock, std::shared_ptr<Block>* block)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fetches the blocks in [pos, pos + prefetch_block_count_ * block_size_)
+  /// that are not cached in the background.
+  void Prefetch(uint64 pos) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// The size of the blocks stored in the LRU cache, as well as the size of the
   /// reads from the underlying filesystem.
   const uint64 block_size_;
@@ -81,25 +117,35 @@ class FileBlockCache {
   const uint64 max_staleness_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
-  /// The Env from which we read timestamps.
+  /// The Env from which we read timestamps, and which runs the prefetches.
   Env* const env_;  // not owned
+  /// The number of blocks to prefetch after a sequential read.
+  const uint32 prefetch_block_count_;
 
   /// \brief A block of a file.
   ///
-  /// A file block consists of the block data and the block's current position
-  /// in the LRU cache.
+  /// A file block consists of the block data, the block's current position
+  /// in the LRU cache, and the state of its fetch. Blocks are shared with the
+  /// readers waiting for them, so a block that is being fetched may be evicted.
   struct Block {
     /// The block data.
     std::vector<char> data;
     /// A list iterator pointing to the block's position in the LRU list.
     std::list<uint64>::iterator lru_iterator;
+    /// True once the fetch of the block has finished.
+    bool fetched = false;
+    /// The status of the fetch, once `fetched` is true.
+    Status status;
   };
 
   /// Guards access to the block map, LRU list, and cache timestamp.
   mutex mu_;
 
+  /// Signalled when a fetch finishes.
+  condition_variable cond_var_;
+
   /// The block map (map from offset in the file to Block object).
-  std::map<uint64, std::unique_ptr<Block>> block_map_ GUARDED_BY(mu_);
+  std::map<uint64, std::shared_ptr<Block>> block_map_ GUARDED_BY(mu_);
 
   /// The LRU list of offsets in the file. The front of the list is the position
   /// of the most recently accessed block.
@@ -109,6 +155,12 @@ class FileBlockCache {
   /// transitioned from empty to non-empty.  A value of 0 means the block map is
   /// currently empty.
   uint64 timestamp_ GUARDED_BY(mu_) = 0;
+
+  /// The end of the most recent read, which detects sequential reads.
+  uint64 last_read_end_ GUARDED_BY(mu_) = 0;
+
+  /// The number of prefetches that have not finished.
+  int64 num_prefetches_ GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace tensorflow
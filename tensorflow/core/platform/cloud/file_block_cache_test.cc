@@ -14,10 +14,15 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include <algorithm>
 #include <cstring>
+#include <set>
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -263,5 +268,129 @@ TEST(FileBlockCacheTest, MaxStaleness) {
   }
 }
 
+TEST(FileBlockCacheTest, ConcurrentMisses) {
+  const uint64 block_size = 16;
+  // Each fetch waits until both blocks are being fetched, which only
+  // completes if misses on different blocks are fetched concurrently.
+  BlockingCounter both_fetching(2);
+  auto fetcher = [&both_fetching](uint64 offset, size_t n,
+                                  std::vector<char>* out) {
+    both_fetching.DecrementCount();
+    both_fetching.Wait();
+    out->resize(n, 'x');
+    return Status::OK();
+  };
+  FileBlockCache cache(block_size, 2, 0, fetcher);
+  std::vector<char> out1, out2;
+  {
+    std::unique_ptr<Thread> thread1(Env::Default()->StartThread(
+        {}, "read1", [&cache, &out1, block_size]() {
+          TF_EXPECT_OK(cache.Read(0, block_size, &out1));
+        }));
+    std::unique_ptr<Thread> thread2(Env::Default()->StartThread(
+        {}, "read2", [&cache, &out2, block_size]() {
+          TF_EXPECT_OK(cache.Read(block_size, block_size, &out2));
+        }));
+  }
+  EXPECT_EQ(out1.size(), block_size);
+  EXPECT_EQ(out2.size(), block_size);
+}
+
+TEST(FileBlockCacheTest, ConcurrentMissesOnSameBlock) {
+  const uint64 block_size = 16;
+  mutex mu;
+  int calls = 0;
+  auto fetcher = [&mu, &calls](uint64 offset, size_t n,
+                               std::vector<char>* out) {
+    {
+      mutex_lock l(mu);
+      calls++;
+    }
+    Env::Default()->SleepForMicroseconds(10000);
+    out->resize(n, 'x');
+    return Status::OK();
+  };
+  FileBlockCache cache(block_size, 1, 0, fetcher);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 4; i++) {
+      threads.emplace_back(Env::Default()->StartThread(
+          {}, "read", [&cache, block_size]() {
+            std::vector<char> out;
+            TF_EXPECT_OK(cache.Read(0, block_size, &out));
+            EXPECT_EQ(out.size(), block_size);
+          }));
+    }
+  }
+  // The readers that missed while the block was being fetched waited for
+  // that fetch.
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(FileBlockCacheTest, Prefetch) {
+  const uint64 block_size = 16;
+  mutex mu;
+  std::set<uint64_t> calls;
+  auto fetcher = [&mu, &calls](uint64 offset, size_t n,
+                               std::vector<char>* out) {
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(calls.find(offset), calls.end()) << "at offset " << offset;
+      calls.insert(offset);
+    }
+    out->resize(n, 'x');
+    return Status::OK();
+  };
+  {
+    FileBlockCache cache(block_size, 4, 0, fetcher, Env::Default(),
+                         2 /* prefetch_block_count */);
+    std::vector<char> out;
+    // The first read starts at the beginning of the file, so it is
+    // sequential and prefetches the next two blocks.
+    TF_EXPECT_OK(cache.Read(0, block_size, &out));
+    // The next sequential read is served from the prefetched block, and
+    // prefetches the fourth block.
+    TF_EXPECT_OK(cache.Read(block_size, block_size, &out));
+    EXPECT_EQ(out.size(), block_size);
+    // A read at an unrelated offset does not prefetch.
+    TF_EXPECT_OK(cache.Read(10 * block_size, block_size, &out));
+    // The cache waits for the prefetches when it is destroyed.
+  }
+  EXPECT_EQ(calls, std::set<uint64_t>({0, block_size, 2 * block_size,
+                                       3 * block_size, 10 * block_size}));
+}
+
+// Reads a 64MB file sequentially, 256KB at a time, through a cache of 8 blocks
+// of 1MB whose fetches take 1ms each, prefetching "prefetch_block_count"
+// blocks.
+void BM_FileBlockCacheSequentialRead(int iters, int prefetch_block_count) {
+  testing::StopTiming();
+  const size_t kFileSize = 64 << 20;
+  const size_t kReadSize = 256 << 10;
+  const string contents(kFileSize, 'x');
+  auto fetcher = [&contents](uint64 offset, size_t n, std::vector<char>* out) {
+    Env::Default()->SleepForMicroseconds(1000);
+    out->clear();
+    if (offset < contents.size()) {
+      const size_t end = std::min<size_t>(offset + n, contents.size());
+      out->assign(contents.begin() + offset, contents.begin() + end);
+    }
+    return Status::OK();
+  };
+
+  testing::StartTiming();
+  std::vector<char> out;
+  for (int i = 0; i < iters; ++i) {
+    FileBlockCache cache(1 << 20, 8, 0, fetcher, Env::Default(),
+                         prefetch_block_count);
+    for (size_t offset = 0; offset < kFileSize; offset += kReadSize) {
+      TF_CHECK_OK(cache.Read(offset, kReadSize, &out));
+    }
+  }
+  testing::StopTiming();
+  testing::BytesProcessed(static_cast<int64>(iters) * kFileSize);
+}
+BENCHMARK(BM_FileBlockCacheSequentialRead)->Arg(0)->Arg(2)->Arg(4);
+
 }  // namespace
 }  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/retrying_utils.h"
 #include "tensorflow/core/platform/cloud/time_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -66,6 +67,18 @@ constexpr char kBlockCount[] = "GCS_READ_CACHE_BLOCK_COUNT";
 // contents. Once any block of a file reaches this staleness, all cached blocks
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
+// The environment variable that overrides the number of blocks fetched in the
+// background ahead of sequential reads from GCS.
+constexpr char kPrefetchBlockCount[] = "GCS_READ_CACHE_PREFETCH_BLOCK_COUNT";
+// The environment variable that enables parallel composite uploads of written
+// files, and sets the size of the uploaded parts. Specified in MB.
+constexpr char kUploadChunkSize[] = "GCS_WRITE_CHUNK_SIZE_MB";
+// The maximum number of parts of a written file that are uploaded at once.
+constexpr int kMaxParallelPartUploads = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
+// The suffix of the temporary objects holding the parts of a written file.
+constexpr char kPartObjectSuffix[] = ".__upload_part_";
 // The file statistics returned by Stat() for directories.
 const FileStatistics DIRECTORY_STAT(0, 0, true);
 
@@ -257,13 +270,14 @@ class GcsWritableFile : public WritableFile {
                   AuthProvider* auth_provider,
                   HttpRequest::Factory* http_request_factory,
                   std::function<void()> file_cache_erase,
-                  int64 initial_retry_delay_usec)
+                  uint64 upload_chunk_size, int64 initial_retry_delay_usec)
       : bucket_(bucket),
         object_(object),
         auth_provider_(auth_provider),
         http_request_factory_(http_request_factory),
         file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
+        upload_chunk_size_(upload_chunk_size),
         initial_retry_delay_usec_(initial_retry_delay_usec) {
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
       outfile_.open(tmp_content_filename_,
@@ -273,6 +287,11 @@ class GcsWritableFile : public WritableFile {
 
   /// \brief Constructs the writable file in append mode.
   ///
+  /// If upload_chunk_size is positive, every upload_chunk_size bytes appended
+  /// are uploaded in the background as a temporary object, and Sync() composes
+  /// the uploaded parts into the destination object. Otherwise the whole file
+  /// is uploaded on every Sync().
+  ///
   /// tmp_content_filename should contain a path of an existing temporary file
   /// with the content to be appended. The class takes onwnership of the
   /// specified tmp file and deletes it on close.
@@ -281,20 +300,35 @@ class GcsWritableFile : public WritableFile {
                   const string& tmp_content_filename,
                   HttpRequest::Factory* http_request_factory,
                   std::function<void()> file_cache_erase,
-                  int64 initial_retry_delay_usec)
+                  uint64 upload_chunk_size, int64 initial_retry_delay_usec)
       : bucket_(bucket),
         object_(object),
         auth_provider_(auth_provider),
         http_request_factory_(http_request_factory),
         file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
+        upload_chunk_size_(upload_chunk_size),
         initial_retry_delay_usec_(initial_retry_delay_usec) {
     tmp_content_filename_ = tmp_content_filename;
     outfile_.open(tmp_content_filename_,
                   std::ofstream::binary | std::ofstream::app);
   }
 
-  ~GcsWritableFile() override { Close().IgnoreError(); }
+  ~GcsWritableFile() override {
+    Close().IgnoreError();
+    // Clean up the parts left over by a failed Sync().
+    std::vector<Part> parts;
+    {
+      mutex_lock l(mu_);
+      WaitForParts(&l);
+      parts.swap(parts_);
+    }
+    for (const Part& part : parts) {
+      if (part.uploaded) {
+        DeletePart(part.name).IgnoreError();
+      }
+    }
+  }
 
   Status Append(const StringPiece& data) override {
     TF_RETURN_IF_ERROR(CheckWritable());
@@ -304,6 +338,9 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (upload_chunk_size_ > 0) {
+      TF_RETURN_IF_ERROR(ScheduleFullParts());
+    }
     return Status::OK();
   }
 
@@ -343,6 +380,18 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    if (upload_chunk_size_ > 0) {
+      bool has_parts;
+      {
+        mutex_lock l(mu_);
+        has_parts = !parts_.empty();
+      }
+      // Files smaller than a part are uploaded in one request, unless some of
+      // their contents are already in the destination object.
+      if (composed_ || has_parts) {
+        return ComposeParts();
+      }
+    }
     string session_uri;
     TF_RETURN_IF_ERROR(CreateNewUploadSession(&session_uri));
     uint64 already_uploaded = 0;
@@ -373,9 +422,215 @@ class GcsWritableFile : public WritableFile {
           strings::StrCat("Upload to gs://", bucket_, "/", object_,
                           " failed, caused by: ", upload_status.ToString()));
     }
+    if (upload_status.ok() && upload_chunk_size_ > 0) {
+      // Later parts are appended to the uploaded object.
+      composed_ = true;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&scheduled_end_));
+    }
     return upload_status;
   }
 
+  /// A range of the file that is uploaded as a temporary object.
+  struct Part {
+    string name;
+    uint64 offset;
+    uint64 size;
+    bool uploaded;
+  };
+
+  /// Schedules the uploads of the full parts of the file that have not been
+  /// scheduled yet.
+  Status ScheduleFullParts() {
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    if (file_size - scheduled_end_ < upload_chunk_size_) {
+      return Status::OK();
+    }
+    // The parts are read back from the temporary file by the uploads.
+    outfile_.flush();
+    if (!outfile_.good()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    while (file_size - scheduled_end_ >= upload_chunk_size_) {
+      SchedulePart(upload_chunk_size_);
+    }
+    return Status::OK();
+  }
+
+  /// Schedules the upload of the next `size` bytes of the file in the
+  /// background. Blocks while kMaxParallelPartUploads uploads are in flight.
+  void SchedulePart(uint64 size) {
+    mutex_lock l(mu_);
+    while (outstanding_parts_ >= kMaxParallelPartUploads) {
+      cond_var_.wait(l);
+    }
+    Part part;
+    part.name = strings::StrCat(object_, kPartObjectSuffix, next_part_index_++);
+    part.offset = scheduled_end_;
+    part.size = size;
+    part.uploaded = false;
+    const size_t index = parts_.size();
+    parts_.push_back(part);
+    scheduled_end_ += size;
+    ++outstanding_parts_;
+    Env::Default()->SchedClosure([this, index, part]() {
+      const Status status = UploadPart(part);
+      if (!status.ok()) {
+        // Sync() uploads the part again.
+        LOG(WARNING) << "Background upload of " << part.name
+                     << " failed: " << status;
+      }
+      mutex_lock l(mu_);
+      parts_[index].uploaded = status.ok();
+      --outstanding_parts_;
+      cond_var_.notify_all();
+    });
+  }
+
+  void WaitForParts(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (outstanding_parts_ > 0) {
+      cond_var_.wait(*l);
+    }
+  }
+
+  /// Uploads the remainder of the file as a last part, and composes the parts
+  /// into the destination object, after the contents it already has.
+  Status ComposeParts() {
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    if (file_size > scheduled_end_) {
+      SchedulePart(file_size - scheduled_end_);
+    }
+    std::vector<Part> parts;
+    {
+      mutex_lock l(mu_);
+      WaitForParts(&l);
+      parts.swap(parts_);
+    }
+    size_t composed_parts = 0;
+    Status status;
+    for (Part& part : parts) {
+      if (!part.uploaded) {
+        status = UploadPart(part);
+        if (!status.ok()) {
+          break;
+        }
+        part.uploaded = true;
+      }
+    }
+    while (status.ok() && composed_parts < parts.size()) {
+      std::vector<string> sources;
+      if (composed_) {
+        sources.push_back(object_);
+      }
+      size_t end = composed_parts;
+      while (end < parts.size() && sources.size() < kMaxComposeSources) {
+        sources.push_back(parts[end++].name);
+      }
+      status = RetryingUtils::CallWithRetries(
+          [this, &sources]() { return ComposeObject(sources); },
+          initial_retry_delay_usec_);
+      if (!status.ok()) {
+        break;
+      }
+      composed_ = true;
+      // Erase the file from the file cache on every successful write.
+      file_cache_erase_();
+      for (; composed_parts < end; ++composed_parts) {
+        const Status delete_status = DeletePart(parts[composed_parts].name);
+        if (!delete_status.ok()) {
+          LOG(WARNING) << "Could not delete the temporary object "
+                       << parts[composed_parts].name << ": " << delete_status;
+        }
+      }
+    }
+    if (!status.ok()) {
+      // Keep the parts that are not composed yet for the next Sync().
+      mutex_lock l(mu_);
+      parts_.assign(parts.begin() + composed_parts, parts.end());
+    }
+    return status;
+  }
+
+  /// Uploads a part of the temporary file as the object `part.name`.
+  Status UploadPart(const Part& part) {
+    string data(part.size, '\0');
+    std::ifstream infile(tmp_content_filename_, std::ifstream::binary);
+    infile.seekg(part.offset);
+    infile.read(&data[0], part.size);
+    if (!infile.good()) {
+      return errors::Internal(
+          "Could not read from the internal temporary file.");
+    }
+    return RetryingUtils::CallWithRetries(
+        [this, &part, &data]() {
+          string auth_token;
+          TF_RETURN_IF_ERROR(
+              AuthProvider::GetToken(auth_provider_, &auth_token));
+
+          std::vector<char> output_buffer;
+          std::unique_ptr<HttpRequest> request(
+              http_request_factory_->Create());
+          TF_RETURN_IF_ERROR(request->Init());
+          TF_RETURN_IF_ERROR(request->SetUri(strings::StrCat(
+              kGcsUploadUriBase, "b/", bucket_, "/o?uploadType=media&name=",
+              request->EscapeString(part.name))));
+          TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+          TF_RETURN_IF_ERROR(request->SetPostFromBuffer(data.data(),
+                                                        data.size()));
+          TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          "gs://", bucket_, "/", part.name);
+          return Status::OK();
+        },
+        initial_retry_delay_usec_);
+  }
+
+  /// Replaces the destination object by the concatenation of `sources`.
+  Status ComposeObject(const std::vector<string>& sources) {
+    Json::Value root;
+    Json::Value& source_objects = root["sourceObjects"];
+    for (const string& source : sources) {
+      Json::Value source_object;
+      source_object["name"] = source;
+      source_objects.append(source_object);
+    }
+    const string body = Json::FastWriter().write(root);
+
+    string auth_token;
+    TF_RETURN_IF_ERROR(AuthProvider::GetToken(auth_provider_, &auth_token));
+
+    std::vector<char> output_buffer;
+    std::unique_ptr<HttpRequest> request(http_request_factory_->Create());
+    TF_RETURN_IF_ERROR(request->Init());
+    TF_RETURN_IF_ERROR(request->SetUri(
+        strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                        request->EscapeString(object_), "/compose")));
+    TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+    TF_RETURN_IF_ERROR(request->AddHeader("Content-Type", "application/json"));
+    TF_RETURN_IF_ERROR(request->SetPostFromBuffer(body.data(), body.size()));
+    TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                    GetGcsPath());
+    return Status::OK();
+  }
+
+  Status DeletePart(const string& name) {
+    string auth_token;
+    TF_RETURN_IF_ERROR(AuthProvider::GetToken(auth_provider_, &auth_token));
+
+    std::unique_ptr<HttpRequest> request(http_request_factory_->Create());
+    TF_RETURN_IF_ERROR(request->Init());
+    TF_RETURN_IF_ERROR(request->SetUri(strings::StrCat(
+        kGcsUriBase, "b/", bucket_, "/o/", request->EscapeString(name))));
+    TF_RETURN_IF_ERROR(request->AddAuthBearerHeader(auth_token));
+    TF_RETURN_IF_ERROR(request->SetDeleteRequest());
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when deleting gs://",
+                                    bucket_, "/", name);
+    return Status::OK();
+  }
+
   Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -525,6 +780,19 @@ class GcsWritableFile : public WritableFile {
   HttpRequest::Factory* http_request_factory_;
   std::function<void()> file_cache_erase_;
   bool sync_needed_;  // whether there is buffered data that needs to be synced
+  // The size of the parts uploaded in the background, or 0 to upload the
+  // whole file on Sync().
+  const uint64 upload_chunk_size_;
+  // The offset in the file up to which parts were scheduled for upload.
+  uint64 scheduled_end_ = 0;
+  // Whether the destination object holds the contents up to the first part.
+  bool composed_ = false;
+  int next_part_index_ = 0;
+  mutex mu_;
+  condition_variable cond_var_;
+  // The parts that are not composed into the destination object yet.
+  std::vector<Part> parts_ GUARDED_BY(mu_);
+  int outstanding_parts_ GUARDED_BY(mu_) = 0;
   int64 initial_retry_delay_usec_;
 };
 
@@ -576,18 +844,27 @@ GcsFileSystem::GcsFileSystem()
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &v64)) {
     max_staleness_ = v64;
   }
+  // Apply the override for the prefetch block count if provided.
+  if (GetEnvVar(kPrefetchBlockCount, strings::safe_strtou32, &v32)) {
+    prefetch_block_count_ = v32;
+  }
+  // Apply the override for the upload chunk size if provided.
+  if (GetEnvVar(kUploadChunkSize, strings::safe_strtou64, &v64)) {
+    upload_chunk_size_ = v64 * 1024 * 1024;
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
     std::unique_ptr<AuthProvider> auth_provider,
     std::unique_ptr<HttpRequest::Factory> http_request_factory,
     size_t block_size, uint32 block_count, uint64 max_staleness,
-    int64 initial_retry_delay_usec)
+    int64 initial_retry_delay_usec, uint64 upload_chunk_size)
     : auth_provider_(std::move(auth_provider)),
       http_request_factory_(std::move(http_request_factory)),
       block_size_(block_size),
       block_count_(block_count),
       max_staleness_(max_staleness),
+      upload_chunk_size_(upload_chunk_size),
       initial_retry_delay_usec_(initial_retry_delay_usec) {}
 
 Status GcsFileSystem::NewRandomAccessFile(
@@ -612,7 +889,8 @@ Status GcsFileSystem::NewRandomAccessFile(
         [this, bucket, object](uint64 offset, size_t n,
                                std::vector<char>* out) {
           return LoadBufferFromGCS(bucket, object, offset, n, out);
-        }));
+        },
+        Env::Default(), prefetch_block_count_));
     if (max_staleness_ > 0) {
       file_cache_[fname] = file_block_cache;
     }
@@ -653,6 +931,7 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       mutex_lock lock(mu_);
                                       file_cache_.erase(fname);
                                     },
+                                    upload_chunk_size_,
                                     initial_retry_delay_usec_));
   return Status::OK();
 }
@@ -698,6 +977,7 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
                                       mutex_lock lock(mu_);
                                       file_cache_.erase(fname);
                                     },
+                                    upload_chunk_size_,
                                     initial_retry_delay_usec_));
   return Status::OK();
 }
@@ -37,7 +37,7 @@ class GcsFileSystem : public FileSystem {
   GcsFileSystem(std::unique_ptr<AuthProvider> auth_provider,
                 std::unique_ptr<HttpRequest::Factory> http_request_factory,
                 size_t block_size, uint32 block_count, uint64 max_staleness,
-                int64 initial_retry_delay_usec);
+                int64 initial_retry_delay_usec, uint64 upload_chunk_size = 0);
 
   Status NewRandomAccessFile(
       const string& filename,
@@ -79,6 +79,8 @@ class GcsFileSystem : public FileSystem {
   size_t block_size() const { return block_size_; }
   uint32 block_count() const { return block_count_; }
   uint64 max_staleness() const { return max_staleness_; }
+  uint32 prefetch_block_count() const { return prefetch_block_count_; }
+  uint64 upload_chunk_size() const { return upload_chunk_size_; }
 
  private:
   /// \brief Checks if the bucket exists. Returns OK if the check succeeded.
@@ -138,6 +140,15 @@ class GcsFileSystem : public FileSystem {
   /// boundaries.
   uint64 max_staleness_ = 0;
 
+  /// The number of blocks fetched ahead of sequential reads in the
+  /// RandomAccessFile implementation. Defaults to 0, meaning no prefetching.
+  uint32 prefetch_block_count_ = 0;
+
+  /// The size of the parts of written files that are uploaded in parallel
+  /// and composed on Sync(). Defaults to 0, meaning that written files are
+  /// uploaded in a single request.
+  uint64 upload_chunk_size_ = 0;
+
   /// The initial delay for exponential backoffs when retrying failed calls.
   const int64 initial_retry_delay_usec_ = 1000000L;
 
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_HTTP_REQUEST_FAKE_H_
 #define TENSORFLOW_CORE_PLATFORM_HTTP_REQUEST_FAKE_H_
 
+#include <algorithm>
 #include <fstream>
+#include <map>
 #include <string>
 #include <vector>
 #include <curl/curl.h>
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/platform/cloud/http_request.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
@@ -193,6 +196,82 @@ class FakeHttpRequestFactory : public HttpRequest::Factory {
   int current_index_ = 0;
 };
 
+/// \brief Fake HttpRequest factory that serves range reads of in-memory
+/// objects, after a simulated latency.
+///
+/// Unlike FakeHttpRequestFactory, the requests are not checked against a list
+/// of expected ones, so any number of reads can be made in any order, e.g. by
+/// benchmarks.
+class FakeObjectHttpRequestFactory : public HttpRequest::Factory {
+ public:
+  /// `objects` maps the URIs to the contents of the objects, and must outlive
+  /// the factory. Each request takes at least `latency_micros`.
+  FakeObjectHttpRequestFactory(const std::map<string, string>* objects,
+                               int64 latency_micros)
+      : objects_(objects), latency_micros_(latency_micros) {}
+
+  HttpRequest* Create() override {
+    return new Request(objects_, latency_micros_);
+  }
+
+ private:
+  class Request : public HttpRequest {
+   public:
+    Request(const std::map<string, string>* objects, int64 latency_micros)
+        : objects_(objects), latency_micros_(latency_micros) {}
+
+    Status Init() override { return Status::OK(); }
+    Status SetUri(const string& uri) override {
+      uri_ = uri;
+      return Status::OK();
+    }
+    Status SetRange(uint64 start, uint64 end) override {
+      start_ = start;
+      end_ = end;
+      return Status::OK();
+    }
+    Status AddHeader(const string& name, const string& value) override {
+      return Status::OK();
+    }
+    Status AddAuthBearerHeader(const string& auth_token) override {
+      return Status::OK();
+    }
+    Status SetResultBuffer(std::vector<char>* buffer) override {
+      buffer->clear();
+      buffer_ = buffer;
+      return Status::OK();
+    }
+    Status Send() override {
+      Env::Default()->SleepForMicroseconds(latency_micros_);
+      const auto object = objects_->find(uri_);
+      if (object == objects_->end()) {
+        response_code_ = 404;
+        return errors::NotFound("No object at ", uri_);
+      }
+      const string& contents = object->second;
+      if (buffer_ != nullptr && start_ < contents.size()) {
+        const uint64 end = std::min<uint64>(end_ + 1, contents.size());
+        buffer_->assign(contents.begin() + start_, contents.begin() + end);
+      }
+      return Status::OK();
+    }
+    string EscapeString(const string& str) override { return str; }
+    uint64 GetResponseCode() const override { return response_code_; }
+
+   private:
+    const std::map<string, string>* objects_;
+    const int64 latency_micros_;
+    string uri_;
+    uint64 start_ = 0;
+    uint64 end_ = kuint64max;
+    std::vector<char>* buffer_ = nullptr;
+    uint64 response_code_ = 200;
+  };
+
+  const std::map<string, string>* objects_;
+  const int64 latency_micros_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_PLATFORM_HTTP_REQUEST_FAKE_H_
@@ -20,6 +20,9 @@ limitations under the License.
 #if defined(PLATFORM_IS_X86)
 #include <mutex>  // NOLINT
 #endif
+#if defined(__arm__) && defined(__linux__) && !defined(__ANDROID__)
+#include <sys/auxv.h>
+#endif
 
 // SIMD extension querying is only available on x86.
 #ifdef PLATFORM_IS_X86
@@ -308,9 +311,25 @@ void InitCPUIDInfo() {
 
 #endif  // PLATFORM_IS_X86
 
+bool HaveNeon() {
+#if defined(__aarch64__) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+  // Binaries compiled with NEON only run on CPUs which have it.
+  return true;
+#elif defined(__arm__) && defined(__linux__) && !defined(__ANDROID__)
+  // HWCAP_NEON from asm/hwcap.h.
+  return (getauxval(AT_HWCAP) & (1 << 12)) != 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace
 
 bool TestCPUFeature(CPUFeature feature) {
+  if (feature == NEON) {
+    static const bool have_neon = HaveNeon();
+    return have_neon;
+  }
 #ifdef PLATFORM_IS_X86
   return CPUIDInfo::TestFeature(feature);
 #else
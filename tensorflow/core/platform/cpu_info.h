@@ -88,6 +88,9 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+
+  // ARM Advanced SIMD (128-bit vectors), always present on AArch64.
+  NEON = 100,
 };
 
 // Checks whether the current processor supports one of the features above.
@@ -31,6 +31,15 @@ CreateClientAsyncResponseReader(::grpc::ChannelInterface* channel,
       channel, cq, method, context, request);
 }
 
+template <class ResponseMessage, class RequestMessage>
+::grpc::ClientAsyncReader<ResponseMessage>* CreateClientAsyncReader(
+    ::grpc::ChannelInterface* channel, ::grpc::CompletionQueue* cq,
+    const ::grpc::RpcMethod& method, ::grpc::ClientContext* context,
+    const RequestMessage& request, void* tag) {
+  return new ::grpc::ClientAsyncReader<ResponseMessage>(
+      channel, cq, method, context, request, tag);
+}
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_PLATFORM_DEFAULT_GRPC_RESPONSE_READER_H_
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -82,6 +83,36 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 10);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Several reads are in flight at once, including one past EOF.
+  const int kNumReads = 4;
+  char scratch[kNumReads][4];
+  Status statuses[kNumReads];
+  string results[kNumReads];
+  BlockingCounter counter(kNumReads);
+  for (int i = 0; i < kNumReads; ++i) {
+    f->ReadAsync(i * 3, 4, scratch[i],
+                 [i, &statuses, &results, &counter](const Status& s,
+                                                    StringPiece result) {
+                   statuses[i] = s;
+                   results[i] = result.ToString();
+                   counter.DecrementCount();
+                 });
+  }
+  counter.Wait();
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_EQ(input.substr(i * 3, 4), results[i]);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, statuses[3].code());
+  EXPECT_EQ(input.substr(9), results[3]);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1}) {
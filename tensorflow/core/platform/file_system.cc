@@ -35,6 +35,17 @@ namespace {
 
 constexpr int kNumThreads = 8;
 
+// The number of threads running the default RandomAccessFile::ReadAsync().
+// The reads are I/O bound, so the pool has more threads than a typical
+// machine has cores.
+constexpr int kNumAsyncReadThreads = 32;
+
+thread::ThreadPool* AsyncReadThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "async_read", kNumAsyncReadThreads);
+  return thread_pool;
+}
+
 // Run a function in parallel using a ThreadPool, but skip the ThreadPool
 // on the iOS platform due to its problems with more than a few threads.
 void ForEach(int first, int last, const std::function<void(int)>& f) {
@@ -72,6 +83,15 @@ Status FileSystem::IsDirectory(const string& name) {
 
 RandomAccessFile::~RandomAccessFile() {}
 
+void RandomAccessFile::ReadAsync(uint64 offset, size_t n, char* scratch,
+                                 ReadDoneCallback done) const {
+  AsyncReadThreadPool()->Schedule([this, offset, n, scratch, done]() {
+    StringPiece result;
+    Status s = Read(offset, n, &result, scratch);
+    done(s, result);
+  });
+}
+
 WritableFile::~WritableFile() {}
 
 FileSystemRegistry::~FileSystemRegistry() {}
@@ -235,6 +235,23 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// \brief Called with the status and the data that Read() would return.
+  typedef std::function<void(const Status&, StringPiece)> ReadDoneCallback;
+
+  /// \brief Reads up to `n` bytes from the file starting at `offset`
+  /// asynchronously, and calls `done` with the result.
+  ///
+  /// The result has the same semantics as for Read(). `scratch[0..n-1]` and
+  /// the file must stay live until `done` is called. `done` may be called on
+  /// any thread, including the calling thread before ReadAsync() returns.
+  ///
+  /// The default implementation calls Read() on a process-wide pool of I/O
+  /// threads, so that many reads can be in flight without a thread per reader.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const;
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
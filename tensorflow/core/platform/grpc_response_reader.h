@@ -42,6 +42,15 @@ CreateClientAsyncResponseReader(::grpc::ChannelInterface* channel,
                                 ::grpc::ClientContext* context,
                                 const RequestMessage& request);
 
+// Start a call of a server-streaming method and write the request out. "tag"
+// is returned by "cq" once the call has started.
+// The returned pointer is owned by the caller.
+template <class ResponseMessage, class RequestMessage>
+::grpc::ClientAsyncReader<ResponseMessage>* CreateClientAsyncReader(
+    ::grpc::ChannelInterface* channel, ::grpc::CompletionQueue* cq,
+    const ::grpc::RpcMethod& method, ::grpc::ClientContext* context,
+    const RequestMessage& request, void* tag);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_PLATFORM_MUTEX_H_
@@ -17,8 +17,15 @@ limitations under the License.
 
 #include <errno.h>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -29,6 +36,39 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// The environment variable that overrides the size of the buffer that small
+// reads of a RandomAccessFile are served from.
+constexpr char kReadaheadBufferSize[] = "HDFS_READAHEAD_BUFFER_SIZE_BYTES";
+constexpr uint64 kDefaultReadaheadBufferSize = 1 << 20;
+// The environment variable that overrides the size of the chunks that large
+// reads are split into, to be read in parallel. 0 disables parallel reads.
+constexpr char kParallelReadChunkSize[] = "HDFS_PARALLEL_READ_CHUNK_SIZE_BYTES";
+constexpr uint64 kDefaultParallelReadChunkSize = 16 << 20;
+// The number of threads reading the chunks of large reads.
+constexpr int kNumParallelReadThreads = 8;
+// The environment variable that points to the UNIX domain socket of the local
+// datanode. If the socket exists, short-circuit local reads are enabled.
+constexpr char kDomainSocketPath[] = "HDFS_DOMAIN_SOCKET_PATH";
+
+uint64 GetEnvVarOrDefault(const char* varname, uint64 default_value) {
+  const char* env_value = getenv(varname);
+  uint64 value;
+  if (env_value != nullptr && strings::safe_strtou64(env_value, &value)) {
+    return value;
+  }
+  return default_value;
+}
+
+thread::ThreadPool* ParallelReadThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "hdfs_read", kNumParallelReadThreads);
+  return thread_pool;
+}
+
+}  // namespace
+
 template <typename R, typename... Args>
 Status BindFunc(void* handle, const char* name,
                 std::function<R(Args...)>* func) {
@@ -57,6 +97,8 @@ class LibHDFS {
   std::function<hdfsFS(hdfsBuilder*)> hdfsBuilderConnect;
   std::function<hdfsBuilder*()> hdfsNewBuilder;
   std::function<void(hdfsBuilder*, const char*)> hdfsBuilderSetNameNode;
+  std::function<int(hdfsBuilder*, const char*, const char*)>
+      hdfsBuilderConfSetStr;
   std::function<int(const char*, char**)> hdfsConfGetStr;
   std::function<void(hdfsBuilder*, const char* kerbTicketCachePath)>
       hdfsBuilderSetKerbTicketCachePath;
@@ -85,6 +127,7 @@ class LibHDFS {
       BIND_HDFS_FUNC(hdfsBuilderConnect);
       BIND_HDFS_FUNC(hdfsNewBuilder);
       BIND_HDFS_FUNC(hdfsBuilderSetNameNode);
+      BIND_HDFS_FUNC(hdfsBuilderConfSetStr);
       BIND_HDFS_FUNC(hdfsConfGetStr);
       BIND_HDFS_FUNC(hdfsBuilderSetKerbTicketCachePath);
       BIND_HDFS_FUNC(hdfsCloseFile);
@@ -130,7 +173,12 @@ class LibHDFS {
   void* handle_ = nullptr;
 };
 
-HadoopFileSystem::HadoopFileSystem() : hdfs_(LibHDFS::Load()) {}
+HadoopFileSystem::HadoopFileSystem()
+    : hdfs_(LibHDFS::Load()),
+      readahead_buffer_size_(GetEnvVarOrDefault(kReadaheadBufferSize,
+                                                kDefaultReadaheadBufferSize)),
+      parallel_read_chunk_size_(GetEnvVarOrDefault(
+          kParallelReadChunkSize, kDefaultParallelReadChunkSize)) {}
 
 HadoopFileSystem::~HadoopFileSystem() {}
 
@@ -168,6 +216,17 @@ Status HadoopFileSystem::Connect(StringPiece fname, hdfsFS* fs) {
   if (ticket_cache_path != nullptr) {
     hdfs_->hdfsBuilderSetKerbTicketCachePath(builder, ticket_cache_path);
   }
+  // When a datanode runs on this host, the client reads the blocks stored
+  // here directly from the local disks instead of streaming them through the
+  // datanode. Blocks stored elsewhere are still read over the network.
+  char* domain_socket_path = getenv(kDomainSocketPath);
+  if (domain_socket_path != nullptr &&
+      Env::Default()->FileExists(domain_socket_path).ok()) {
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.client.read.shortcircuit",
+                                 "true");
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.domain.socket.path",
+                                 domain_socket_path);
+  }
   *fs = hdfs_->hdfsBuilderConnect(builder);
   if (*fs == nullptr) {
     return errors::NotFound(strerror(errno));
@@ -184,35 +243,67 @@ string HadoopFileSystem::TranslateName(const string& name) const {
 class HDFSRandomAccessFile : public RandomAccessFile {
  public:
   HDFSRandomAccessFile(const string& filename, const string& hdfs_filename,
-                       LibHDFS* hdfs, hdfsFS fs, hdfsFile file)
+                       LibHDFS* hdfs, hdfsFS fs, hdfsFile file,
+                       uint64 readahead_buffer_size,
+                       uint64 parallel_read_chunk_size)
       : filename_(filename),
         hdfs_filename_(hdfs_filename),
         hdfs_(hdfs),
         fs_(fs),
-        file_(file) {}
+        readahead_buffer_size_(readahead_buffer_size),
+        parallel_read_chunk_size_(parallel_read_chunk_size),
+        file_(WrapFile(file)) {}
 
-  ~HDFSRandomAccessFile() override {
-    if (file_ != nullptr) {
-      mutex_lock lock(mu_);
-      hdfs_->hdfsCloseFile(fs_, file_);
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    size_t bytes_read = 0;
+    Status s;
+    if (n < readahead_buffer_size_) {
+      s = ReadBuffered(offset, n, scratch, &bytes_read);
+    } else if (parallel_read_chunk_size_ > 0 &&
+               n >= 2 * parallel_read_chunk_size_) {
+      s = ReadParallel(offset, n, scratch, &bytes_read);
+    } else {
+      s = ReadDirect(offset, n, scratch, &bytes_read);
     }
+    *result = StringPiece(scratch, bytes_read);
+    return s;
   }
 
-  Status Read(uint64 offset, size_t n, StringPiece* result,
-              char* scratch) const override {
+ private:
+  // Closes the file once the last reader using the handle releases it, so
+  // that the file can be reopened while other reads are in progress.
+  std::shared_ptr<hdfsFile_internal> WrapFile(hdfsFile file) const {
+    LibHDFS* hdfs = hdfs_;
+    hdfsFS fs = fs_;
+    return std::shared_ptr<hdfsFile_internal>(file, [hdfs, fs](hdfsFile f) {
+      if (f != nullptr && hdfs->hdfsCloseFile(fs, f) != 0) {
+        LOG(WARNING) << "Failed to close an HDFS file: " << strerror(errno);
+      }
+    });
+  }
+
+  // Reads `n` bytes at `offset` into `dst` with positional reads.
+  Status ReadDirect(uint64 offset, size_t n, char* dst,
+                    size_t* bytes_read) const {
+    std::shared_ptr<hdfsFile_internal> file;
+    {
+      mutex_lock lock(mu_);
+      file = file_;
+    }
     Status s;
-    char* dst = scratch;
+    *bytes_read = 0;
     bool eof_retried = false;
     while (n > 0 && s.ok()) {
-      // We lock inside the loop rather than outside so we don't block other
-      // concurrent readers.
-      mutex_lock lock(mu_);
-      tSize r = hdfs_->hdfsPread(fs_, file_, static_cast<tOffset>(offset), dst,
-                                 static_cast<tSize>(n));
+      // The handle is not locked during the read, so that concurrent reads,
+      // including the chunks of a parallel read, don't block each other.
+      tSize r = hdfs_->hdfsPread(fs_, file.get(), static_cast<tOffset>(offset),
+                                 dst, static_cast<tSize>(n));
       if (r > 0) {
         dst += r;
         n -= r;
         offset += r;
+        *bytes_read += r;
       } else if (!eof_retried && r == 0) {
         // Always reopen the file upon reaching EOF to see if there's more data.
         // If writers are streaming contents while others are concurrently
@@ -220,14 +311,17 @@ class HDFSRandomAccessFile : public RandomAccessFile {
         // contents.
         //
         // Fixes #5438
-        if (file_ != nullptr && hdfs_->hdfsCloseFile(fs_, file_) != 0) {
-          return IOError(filename_, errno);
-        }
-        file_ =
-            hdfs_->hdfsOpenFile(fs_, hdfs_filename_.c_str(), O_RDONLY, 0, 0, 0);
-        if (file_ == nullptr) {
-          return IOError(filename_, errno);
+        mutex_lock lock(mu_);
+        if (file_ == file) {
+          hdfsFile reopened = hdfs_->hdfsOpenFile(
+              fs_, hdfs_filename_.c_str(), O_RDONLY, 0, 0, 0);
+          if (reopened == nullptr) {
+            return IOError(filename_, errno);
+          }
+          file_ = WrapFile(reopened);
         }
+        // Another reader may already have reopened the file.
+        file = file_;
         eof_retried = true;
       } else if (eof_retried && r == 0) {
         s = Status(error::OUT_OF_RANGE, "Read less bytes than requested");
@@ -237,18 +331,96 @@ class HDFSRandomAccessFile : public RandomAccessFile {
         s = IOError(filename_, errno);
       }
     }
-    *result = StringPiece(scratch, dst - scratch);
     return s;
   }
 
- private:
+  // Serves a small read from the readahead buffer, refilling the buffer at
+  // `offset` if it does not hold the requested range.
+  Status ReadBuffered(uint64 offset, size_t n, char* dst,
+                      size_t* bytes_read) const {
+    size_t copied = 0;
+    {
+      mutex_lock lock(buffer_mu_);
+      if (offset < buffer_offset_ ||
+          offset + n > buffer_offset_ + buffer_.size()) {
+        buffer_.resize(readahead_buffer_size_);
+        size_t filled = 0;
+        Status s = ReadDirect(offset, readahead_buffer_size_, &buffer_[0],
+                              &filled);
+        buffer_.resize(filled);
+        buffer_offset_ = offset;
+        if (!s.ok() && !errors::IsOutOfRange(s)) {
+          buffer_.clear();
+          return s;
+        }
+      }
+      if (offset < buffer_offset_ + buffer_.size()) {
+        copied = std::min<uint64>(n, buffer_offset_ + buffer_.size() - offset);
+        memcpy(dst, &buffer_[offset - buffer_offset_], copied);
+      }
+    }
+    *bytes_read = copied;
+    if (copied == n) {
+      return Status::OK();
+    }
+    // The buffer ends at the end of the file. Read the rest directly, which
+    // reopens the file in case more data was written.
+    size_t rest = 0;
+    Status s = ReadDirect(offset + copied, n - copied, dst + copied, &rest);
+    *bytes_read += rest;
+    return s;
+  }
+
+  // Splits a large read into chunks of `parallel_read_chunk_size_` bytes,
+  // which are read concurrently.
+  Status ReadParallel(uint64 offset, size_t n, char* dst,
+                      size_t* bytes_read) const {
+    const size_t num_chunks =
+        (n + parallel_read_chunk_size_ - 1) / parallel_read_chunk_size_;
+    std::vector<Status> statuses(num_chunks);
+    std::vector<size_t> chunk_bytes_read(num_chunks);
+    BlockingCounter counter(num_chunks - 1);
+    auto read_chunk = [this, offset, n, dst, &statuses,
+                       &chunk_bytes_read](size_t i) {
+      const uint64 start = i * parallel_read_chunk_size_;
+      const size_t size =
+          std::min<uint64>(parallel_read_chunk_size_, n - start);
+      statuses[i] = ReadDirect(offset + start, size, dst + start,
+                               &chunk_bytes_read[i]);
+    };
+    for (size_t i = 1; i < num_chunks; ++i) {
+      ParallelReadThreadPool()->Schedule([&read_chunk, &counter, i]() {
+        read_chunk(i);
+        counter.DecrementCount();
+      });
+    }
+    read_chunk(0);
+    counter.Wait();
+    // The result is the prefix of the range up to the first short read.
+    *bytes_read = 0;
+    for (size_t i = 0; i < num_chunks; ++i) {
+      *bytes_read += chunk_bytes_read[i];
+      if (!statuses[i].ok()) {
+        return statuses[i];
+      }
+    }
+    return Status::OK();
+  }
+
   string filename_;
   string hdfs_filename_;
   LibHDFS* hdfs_;
   hdfsFS fs_;
+  const uint64 readahead_buffer_size_;
+  const uint64 parallel_read_chunk_size_;
 
   mutable mutex mu_;
-  mutable hdfsFile file_ GUARDED_BY(mu_);
+  mutable std::shared_ptr<hdfsFile_internal> file_ GUARDED_BY(mu_);
+
+  mutable mutex buffer_mu_;
+  mutable std::vector<char> buffer_ GUARDED_BY(buffer_mu_);
+  // The offset in the file of the first byte of `buffer_`.
+  mutable uint64 buffer_offset_ GUARDED_BY(buffer_mu_) = 0;
 };
 
 Status HadoopFileSystem::NewRandomAccessFile(
@@ -261,8 +433,9 @@ Status HadoopFileSystem::NewRandomAccessFile(
   if (file == nullptr) {
     return IOError(fname, errno);
   }
-  result->reset(
-      new HDFSRandomAccessFile(fname, TranslateName(fname), hdfs_, fs, file));
+  result->reset(new HDFSRandomAccessFile(fname, TranslateName(fname), hdfs_,
+                                         fs, file, readahead_buffer_size_,
+                                         parallel_read_chunk_size_));
   return Status::OK();
 }
 
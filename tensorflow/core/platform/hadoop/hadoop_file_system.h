@@ -66,6 +66,12 @@ class HadoopFileSystem : public FileSystem {
  private:
   Status Connect(StringPiece fname, hdfsFS* fs);
   LibHDFS* hdfs_;
+  // Reads of RandomAccessFiles smaller than this are served from a buffer of
+  // this size. Set by HDFS_READAHEAD_BUFFER_SIZE_BYTES.
+  uint64 readahead_buffer_size_;
+  // Reads of at least twice this size are split into chunks of this size,
+  // read in parallel. Set by HDFS_PARALLEL_READ_CHUNK_SIZE_BYTES.
+  uint64 parallel_read_chunk_size_;
 };
 
 }  // namespace tensorflow
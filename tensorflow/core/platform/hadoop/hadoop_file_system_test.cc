@@ -89,6 +89,37 @@ TEST_F(HadoopFileSystemTest, RandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(HadoopFileSystemTest, RandomAccessFile_BufferedAndParallelReads) {
+  setenv("HDFS_READAHEAD_BUFFER_SIZE_BYTES", "4", 1);
+  setenv("HDFS_PARALLEL_READ_CHUNK_SIZE_BYTES", "3", 1);
+  HadoopFileSystem fs;
+  unsetenv("HDFS_READAHEAD_BUFFER_SIZE_BYTES");
+  unsetenv("HDFS_PARALLEL_READ_CHUNK_SIZE_BYTES");
+
+  const string fname = TmpDir("RandomAccessFile_BufferedAndParallelReads");
+  const string content = "abcdefghijklmnopqrstuvwxyz";
+  TF_ASSERT_OK(WriteString(fname, content));
+
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_EXPECT_OK(fs.NewRandomAccessFile(fname, &reader));
+  char scratch[64];
+  StringPiece result;
+
+  // Small reads are served from the readahead buffer.
+  for (size_t offset = 0; offset < content.size(); offset += 2) {
+    TF_EXPECT_OK(reader->Read(offset, 2, &result, scratch));
+    EXPECT_EQ(content.substr(offset, 2), result);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(24, 3, &result, scratch)));
+  EXPECT_EQ("yz", result);
+
+  // Large reads are split into chunks read in parallel.
+  TF_EXPECT_OK(reader->Read(1, 20, &result, scratch));
+  EXPECT_EQ(content.substr(1, 20), result);
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(5, 40, &result, scratch)));
+  EXPECT_EQ(content.substr(5), result);
+}
+
 TEST_F(HadoopFileSystemTest, WritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
@@ -33,6 +33,31 @@ void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
 
+// The NUMA node argument of NUMAMalloc() for memory not bound to any node.
+static const int kNUMANoAffinity = -1;
+
+// Returns the number of NUMA nodes memory can be bound to, or 1 if this
+// platform cannot bind memory to a node.
+int NUMANumNodes();
+
+// Like AlignedMalloc(), but the pages of the allocation are placed on NUMA
+// node "node" where the platform supports it. `minimum_alignment` must not
+// exceed the page size. The memory must be released with NUMAFree(), given
+// the same "size".
+void* NUMAMalloc(int node, size_t size, int minimum_alignment);
+void NUMAFree(void* ptr, size_t size);
+
+// Restricts the calling thread to the CPUs of NUMA node "node", or lifts
+// the restriction if "node" is kNUMANoAffinity. Returns false if this
+// platform cannot bind threads to a node or the binding failed.
+bool NUMASetThreadNodeAffinity(int node);
+
+// Hints that the memory in [ptr, ptr + size) is worth backing with
+// transparent huge pages. Only the whole pages in the range are affected, so
+// "ptr" should be aligned to the huge page size. A no-op on platforms without
+// transparent huge pages.
+void AdviseHugePages(void* ptr, size_t size);
+
 // Tries to release num_bytes of free memory back to the operating
 // system for reuse.  Use this routine with caution -- to get this
 // memory back may require faulting pages back in by the OS, and
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <condition_variable>
+#include <cstring>
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mem.h"
@@ -33,6 +34,40 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, NUMAMalloc) {
+  EXPECT_GE(NUMANumNodes(), 1);
+  for (int node = kNUMANoAffinity; node < NUMANumNodes(); ++node) {
+    const size_t size = 3 << 20;
+    char* p = static_cast<char*>(NUMAMalloc(node, size, 64));
+    ASSERT_TRUE(p != nullptr) << "NUMAMalloc(" << node << ", " << size << ")";
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+    memset(p, 1, size);
+    EXPECT_EQ(1, p[size - 1]);
+    NUMAFree(p, size);
+  }
+}
+
+TEST(Port, NUMAThreadAffinity) {
+  // Threads pinned to each node, or to none, start and run normally.
+  for (int node = kNUMANoAffinity; node < NUMANumNodes(); ++node) {
+    ThreadOptions thread_options;
+    thread_options.numa_node = node;
+    mutex mu;
+    int num_done = 0;
+    {
+      thread::ThreadPool pool(Env::Default(), thread_options, "numa", 2);
+      for (int i = 0; i < 4; ++i) {
+        pool.Schedule([&mu, &num_done]() {
+          mutex_lock l(mu);
+          ++num_done;
+        });
+      }
+      // The destructor waits for the scheduled closures.
+    }
+    EXPECT_EQ(4, num_done);
+  }
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
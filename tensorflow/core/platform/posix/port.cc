@@ -24,11 +24,15 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #if defined(__linux__) && !defined(__ANDROID__)
 #include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <algorithm>
+#include <vector>
 #ifdef SNAPPY
 #include "snappy.h"
 #endif
@@ -115,6 +119,131 @@ void Free(void* ptr) {
 #endif
 }
 
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+#define TF_NUMA_USE_MBIND 1
+#endif
+
+int NUMANumNodes() {
+#ifdef TF_NUMA_USE_MBIND
+  static const int num_nodes = [] {
+    // The possible nodes are listed as ranges, e.g. "0-1" or "0,2-3", the
+    // last number being the highest node.
+    int num = 1;
+    FILE* f = fopen("/sys/devices/system/node/possible", "r");
+    if (f != nullptr) {
+      char buf[256];
+      if (fgets(buf, sizeof(buf), f) != nullptr) {
+        const char* last = buf;
+        for (const char* p = buf; *p != '\0'; ++p) {
+          if (*p == ',' || *p == '-') last = p + 1;
+        }
+        num = std::max(1, atoi(last) + 1);
+      }
+      fclose(f);
+    }
+    return num;
+  }();
+  return num_nodes;
+#else
+  return 1;
+#endif
+}
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+#ifdef TF_NUMA_USE_MBIND
+  if (size == 0) return nullptr;
+  DCHECK_LE(minimum_alignment, getpagesize());
+  // Anonymous mappings are page aligned, and their pages are only placed
+  // on the first touch, i.e. after the binding below.
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return nullptr;
+  if (node != kNUMANoAffinity) {
+    const int kBitsPerWord = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> node_mask(node / kBitsPerWord + 1, 0);
+    node_mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    const int kMPolBind = 2;  // MPOL_BIND in <numaif.h>.
+    // The kernel ignores the last bit of "maxnode".
+    if (syscall(SYS_mbind, ptr, size, kMPolBind, node_mask.data(),
+                node_mask.size() * kBitsPerWord + 1, 0) != 0) {
+      VLOG(1) << "Could not bind " << size << " bytes to NUMA node " << node;
+    }
+  }
+  return ptr;
+#else
+  return AlignedMalloc(size, minimum_alignment);
+#endif
+}
+
+void NUMAFree(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+#ifdef TF_NUMA_USE_MBIND
+  munmap(ptr, size);
+#else
+  AlignedFree(ptr);
+#endif
+}
+
+bool NUMASetThreadNodeAffinity(int node) {
+#ifdef TF_NUMA_USE_MBIND
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (node == kNUMANoAffinity) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) CPU_SET(cpu, &cpuset);
+  } else {
+    // The CPUs of a node are listed as ranges, e.g. "0-27,56-83".
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+             node);
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) return false;
+    char buf[1024];
+    const bool read = fgets(buf, sizeof(buf), f) != nullptr;
+    fclose(f);
+    if (!read) return false;
+    for (char* p = buf; *p != '\0' && *p != '\n';) {
+      char* end;
+      const long first = strtol(p, &end, 10);
+      if (end == p) break;
+      long last = first;
+      p = end;
+      if (*p == '-') {
+        last = strtol(p + 1, &end, 10);
+        p = end;
+      }
+      for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+        CPU_SET(cpu, &cpuset);
+      }
+      if (*p == ',') ++p;
+    }
+    if (CPU_COUNT(&cpuset) == 0) return false;
+  }
+  // A pid of 0 applies the mask to the calling thread only.
+  if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+    VLOG(1) << "Could not bind the thread to NUMA node " << node;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void AdviseHugePages(void* ptr, size_t size) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(MADV_HUGEPAGE)
+  // madvise() requires a page aligned start.
+  const uintptr_t page_size = getpagesize();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t aligned_begin = (begin + page_size - 1) & ~(page_size - 1);
+  const uintptr_t end = begin + size;
+  if (aligned_begin >= end) return;
+  if (madvise(reinterpret_cast<void*>(aligned_begin), end - aligned_begin,
+              MADV_HUGEPAGE) != 0) {
+    VLOG(1) << "Could not advise huge pages for " << size << " bytes";
+  }
+#endif
+}
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
@@ -21,6 +21,7 @@ limitations under the License.
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -66,6 +67,22 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+#if defined(__linux__) && defined(RWF_NOWAIT)
+    // Reads whose data is in the page cache complete without blocking, so
+    // they are done on the calling thread instead of an I/O thread.
+    struct iovec iov = {scratch, n};
+    ssize_t r = preadv2(fd_, &iov, 1, static_cast<off_t>(offset), RWF_NOWAIT);
+    if (r >= 0 && static_cast<size_t>(r) == n) {
+      done(Status::OK(), StringPiece(scratch, n));
+      return;
+    }
+    // The data is not cached, or the kernel does not support RWF_NOWAIT.
+#endif
+    RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+  }
 };
 
 class PosixWritableFile : public WritableFile {
@@ -107,6 +107,20 @@ void Free(void* ptr) {
 #endif
 }
 
+int NUMANumNodes() { return 1; }
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
+bool NUMASetThreadNodeAffinity(int node) { return false; }
+
+void AdviseHugePages(void* ptr, size_t size) {
+  // No-op.
+}
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
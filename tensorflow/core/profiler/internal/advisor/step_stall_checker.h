@@ -0,0 +1,137 @@
+/* Copyright 2017 The TensorFlow Authors All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// These checkers check whether the latest step is stalled on input ops, on
+// receiving tensors from other tasks or on host<->device copies.
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_STEP_STALL_CHECKER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_STEP_STALL_CHECKER_H_
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class StepStallChecker : public Checker {
+ protected:
+  // Returns the fraction of the step above which a stall is reported. Can be
+  // set with the "min_stall_fraction" option.
+  double MinStallFraction(const AdvisorOptionsProto::CheckerOption& options) {
+    double fraction = 0.1;
+    auto option = options.options().find("min_stall_fraction");
+    if (option != options.options().end() &&
+        !strings::safe_strtod(option->second.c_str(), &fraction)) {
+      fprintf(stderr, "Invalid min_stall_fraction: %s\n",
+              option->second.c_str());
+      fraction = 0.1;
+    }
+    return fraction;
+  }
+
+  bool HasStepStats(const TFStats* stats) {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return false;
+    }
+    if (stats->latest_step_stall_stats().step_micros <= 0) {
+      fprintf(stderr, "Missing RunMetadata info. Skip %s\n", name().c_str());
+      return false;
+    }
+    return true;
+  }
+
+  // Reports the stall if it takes at least min_fraction of the step.
+  void MaybeReportStall(int64 stall_micros, int64 step_micros,
+                        double min_fraction, const string& what,
+                        const std::map<string, int64>& ops,
+                        const string& suggestion) {
+    const double fraction = 1.0 * stall_micros / step_micros;
+    if (fraction < min_fraction) {
+      return;
+    }
+    std::vector<std::pair<int64, string>> sorted_ops;
+    for (const auto& op : ops) {
+      sorted_ops.emplace_back(op.second, op.first);
+    }
+    std::sort(sorted_ops.rbegin(), sorted_ops.rend());
+    std::vector<string> top_ops;
+    for (int i = 0; i < 3 && i < sorted_ops.size(); ++i) {
+      top_ops.push_back(
+          strings::Printf("%s (%s)", sorted_ops[i].second.c_str(),
+                          FormatTime(sorted_ops[i].first).c_str()));
+    }
+    reports_.add_reports(strings::Printf(
+        "The last step spent %s (%.2f%% of %s) %s. Top ops: %s. %s",
+        FormatTime(stall_micros).c_str(), 100.0 * fraction,
+        FormatTime(step_micros).c_str(), what.c_str(),
+        str_util::Join(top_ops, ", ").c_str(), suggestion.c_str()));
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+class InputPipelineChecker : public StepStallChecker {
+ public:
+  string name() const override { return kCheckers[4]; }
+
+ private:
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!HasStepStats(stats)) {
+      return reports_;
+    }
+    const StepStallStats& stall_stats = stats->latest_step_stall_stats();
+    MaybeReportStall(
+        stall_stats.input_micros, stall_stats.step_micros,
+        MinStallFraction(options), "waiting on input ops",
+        stall_stats.input_ops,
+        "Maybe prefetch the input (e.g. Dataset.prefetch) or use more "
+        "threads to read and preprocess it.");
+    return reports_;
+  }
+};
+
+class CommunicationChecker : public StepStallChecker {
+ public:
+  string name() const override { return kCheckers[5]; }
+
+ private:
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!HasStepStats(stats)) {
+      return reports_;
+    }
+    const StepStallStats& stall_stats = stats->latest_step_stall_stats();
+    const double min_fraction = MinStallFraction(options);
+    MaybeReportStall(
+        stall_stats.remote_recv_micros, stall_stats.step_micros, min_fraction,
+        "receiving tensors from other tasks", stall_stats.remote_recv_ops,
+        "Maybe place the producers of these tensors closer to their "
+        "consumers, or balance the variables over more parameter servers.");
+    MaybeReportStall(
+        stall_stats.memcpy_micros, stall_stats.step_micros, min_fraction,
+        "copying between host and device", stall_stats.memcpy_ops,
+        "Maybe keep the tensors on the device, or overlap the copies with "
+        "computation (e.g. with StagingArea).");
+    return reports_;
+  }
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_STEP_STALL_CHECKER_H_
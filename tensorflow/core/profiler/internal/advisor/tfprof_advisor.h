@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/internal/advisor/expensive_operation_checker.h"
 #include "tensorflow/core/profiler/internal/advisor/internal_checker_runner.h"
 #include "tensorflow/core/profiler/internal/advisor/operation_checker.h"
+#include "tensorflow/core/profiler/internal/advisor/step_stall_checker.h"
 #include "tensorflow/core/profiler/tfprof_options.pb.h"
 
 namespace tensorflow {
@@ -61,6 +62,16 @@ class Advisor {
           expensive_op_checker.Run(options.checkers().at(kCheckers[2]),
                                    stats_));
     }
+    if (options.checkers().find(kCheckers[4]) != options.checkers().end()) {
+      InputPipelineChecker input_checker;
+      (*ret.mutable_checkers())[kCheckers[4]].MergeFrom(
+          input_checker.Run(options.checkers().at(kCheckers[4]), stats_));
+    }
+    if (options.checkers().find(kCheckers[5]) != options.checkers().end()) {
+      CommunicationChecker comm_checker;
+      (*ret.mutable_checkers())[kCheckers[5]].MergeFrom(
+          comm_checker.Run(options.checkers().at(kCheckers[5]), stats_));
+    }
     for (const auto& checker : ret.checkers()) {
       fprintf(stdout, "\n%s:\n", checker.first.c_str());
       for (const string& r : checker.second.reports()) {
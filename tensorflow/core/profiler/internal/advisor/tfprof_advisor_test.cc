@@ -100,5 +100,78 @@ TEST_F(TFProfAdvisorTest, ExpensiveOperationChecker) {
                   .contains("top 1 operation type: Conv2D"));
 }
 
+class TFProfStallAdvisorTest : public ::testing::Test {
+ protected:
+  TFProfStallAdvisorTest() {
+    std::unique_ptr<GraphDef> graph(new GraphDef());
+    NodeDef* dequeue = graph->add_node();
+    dequeue->set_name("dequeue");
+    dequeue->set_op("QueueDequeueV2");
+    NodeDef* conv = graph->add_node();
+    conv->set_name("conv");
+    conv->set_op("Conv2D");
+    stats_.reset(new TFStats(std::move(graph), nullptr, nullptr, nullptr));
+
+    // A 100us step: 60us waiting on the input, 15us receiving a tensor from
+    // the parameter server and a 5us host to device copy.
+    std::unique_ptr<RunMetadata> run_meta(new RunMetadata());
+    DeviceStepStats* cpu = run_meta->mutable_step_stats()->add_dev_stats();
+    cpu->set_device("/job:worker/replica:0/task:0/cpu:0");
+    AddNodeStat(cpu, "dequeue", "dequeue = QueueDequeueV2(queue)", 100, 60);
+    AddNodeStat(cpu, "conv", "conv = Conv2D(dequeue, edge_1_w)", 160, 40);
+    AddNodeStat(cpu, "edge_1_w",
+                "edge_1_w = _Recv(w:0 @/job:ps/replica:0/task:0/cpu:0", 100,
+                15);
+    DeviceStepStats* memcpy = run_meta->mutable_step_stats()->add_dev_stats();
+    memcpy->set_device("/job:worker/replica:0/task:0/gpu:0/memcpy");
+    AddNodeStat(memcpy, "edge_2_x", "MEMCPYHtoD", 150, 5);
+    stats_->AddRunMeta(0, std::move(run_meta));
+    advisor_.reset(new Advisor(stats_.get()));
+  }
+
+  void AddNodeStat(DeviceStepStats* dev_stats, const string& name,
+                   const string& label, int64 start_micros,
+                   int64 end_rel_micros) {
+    NodeExecStats* node_stat = dev_stats->add_node_stats();
+    node_stat->set_node_name(name);
+    node_stat->set_timeline_label(label);
+    node_stat->set_all_start_micros(start_micros);
+    node_stat->set_op_end_rel_micros(end_rel_micros);
+    node_stat->set_all_end_rel_micros(end_rel_micros);
+  }
+
+  std::unique_ptr<TFStats> stats_;
+  std::unique_ptr<Advisor> advisor_;
+};
+
+TEST_F(TFProfStallAdvisorTest, InputPipelineChecker) {
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[4]];
+  AdviceProto advice = advisor_->Advise(options);
+  ASSERT_EQ(advice.checkers().at(kCheckers[4]).reports_size(), 1);
+  StringPiece report(advice.checkers().at(kCheckers[4]).reports(0));
+  EXPECT_TRUE(report.contains("60.00%")) << report;
+  EXPECT_TRUE(report.contains("dequeue")) << report;
+}
+
+TEST_F(TFProfStallAdvisorTest, CommunicationChecker) {
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[5]];
+  AdviceProto advice = advisor_->Advise(options);
+  // The copy takes less than the default 10% of the step.
+  ASSERT_EQ(advice.checkers().at(kCheckers[5]).reports_size(), 1);
+  StringPiece report(advice.checkers().at(kCheckers[5]).reports(0));
+  EXPECT_TRUE(report.contains("receiving tensors from other tasks")) << report;
+  EXPECT_TRUE(report.contains("edge_1_w")) << report;
+
+  (*(*options.mutable_checkers())[kCheckers[5]]
+        .mutable_options())["min_stall_fraction"] = "0.05";
+  advice = advisor_->Advise(options);
+  ASSERT_EQ(advice.checkers().at(kCheckers[5]).reports_size(), 2);
+  report = advice.checkers().at(kCheckers[5]).reports(1);
+  EXPECT_TRUE(report.contains("copying between host and device")) << report;
+  EXPECT_TRUE(report.contains("edge_2_x")) << report;
+}
+
 }  // namespace tfprof
 }  // namespace tensorflow
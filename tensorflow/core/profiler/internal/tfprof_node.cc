@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/internal/tfprof_node.h"
 
+#include <float.h>
+
 #include "tensorflow/core/profiler/internal/tfprof_utils.h"
 
 namespace tensorflow {
@@ -30,6 +32,19 @@ bool CountAsCPUTime(const string& device) {
 
 bool IsCanonicalDevice(const string& device) { return CountAsCPUTime(device); }
 
+// Power of 2 buckets keep the per-node histograms small.
+const std::vector<double>& ExecMicrosBucketLimits() {
+  static const std::vector<double>* limits = [] {
+    auto* limits = new std::vector<double>();
+    for (double limit = 1; limit < 1e12; limit *= 2) {
+      limits->push_back(limit);
+    }
+    limits->push_back(DBL_MAX);
+    return limits;
+  }();
+  return *limits;
+}
+
 }  // namespace
 // Notes about start and end time from the NodeExecStats proto:
 // For GPU, there is no difference between op_end_rel_micros and
@@ -87,6 +102,12 @@ void ExecStep::AddMemoryStats(const string& dev,
   mem_initiated_ = true;
 
   for (const auto& mem : step_stat.memory()) {
+    if (mem.allocation_records_size() > 0) {
+      std::vector<AllocationRecord>& records =
+          allocations_[mem.allocator_name()];
+      records.insert(records.end(), mem.allocation_records().begin(),
+                     mem.allocation_records().end());
+    }
     // TODO(xpan): Fix this hack. Currently the allocator name seems quite
     // ad-hoc.
     if (mem.allocator_name().find("GPU") == mem.allocator_name().npos) {
@@ -161,6 +182,31 @@ void TFGraphNode::AddStepStat(int64 step, const string& device,
   }
 }
 
+void TFGraphNode::AggregateSteps(int64 keep_step) {
+  for (auto exec = execs_.begin(); exec != execs_.end();) {
+    if (exec->first == keep_step) {
+      ++exec;
+      continue;
+    }
+    aggregated_execs_.AddStep(exec->second);
+    exec = execs_.erase(exec);
+  }
+}
+
+void AggregatedExecStats::AddStep(const ExecStep& exec) {
+  ++num_steps_;
+  run_count_ += exec.run_count();
+  exec_micros_ += exec.exec_micros();
+  accelerator_exec_micros_ += exec.accelerator_exec_micros();
+  cpu_exec_micros_ += exec.cpu_exec_micros();
+  requested_bytes_ += exec.requested_bytes();
+  if (!exec_micros_histogram_) {
+    exec_micros_histogram_.reset(
+        new histogram::Histogram(ExecMicrosBucketLimits()));
+  }
+  exec_micros_histogram_->Add(exec.exec_micros());
+}
+
 int64 ExecStep::exec_micros() const {
   return accelerator_exec_micros() + cpu_exec_micros();
 }
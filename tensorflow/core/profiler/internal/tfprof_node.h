@@ -17,6 +17,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_TFPROF_NODE_H_
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/regexp.h"
@@ -88,6 +90,9 @@ class ExecStep {
     return output_bytes_;
   }
   int64 allocator_bytes_in_use() const { return allocator_bytes_in_use_; }
+  const std::map<string, std::vector<AllocationRecord>>& allocations() const {
+    return allocations_;
+  }
 
  private:
   TFGraphNode* node;
@@ -123,6 +128,45 @@ class ExecStep {
   int64 allocator_bytes_in_use_;
   // output_idx -> {output_bytes, memory_ptr}
   std::map<int64, std::pair<int64, uint64>> output_bytes_;
+  // allocator_name -> the lifetimes of the memory allocated by the op.
+  std::map<string, std::vector<AllocationRecord>> allocations_;
+};
+
+// Compact stats of a graph node summed over steps whose ExecStep has been
+// released. Only what is needed to answer queries over all steps is kept.
+class AggregatedExecStats {
+ public:
+  AggregatedExecStats()
+      : num_steps_(0),
+        run_count_(0),
+        exec_micros_(0),
+        accelerator_exec_micros_(0),
+        cpu_exec_micros_(0),
+        requested_bytes_(0) {}
+
+  void AddStep(const ExecStep& exec);
+
+  int64 num_steps() const { return num_steps_; }
+  // Totals over all the aggregated steps.
+  int64 run_count() const { return run_count_; }
+  int64 exec_micros() const { return exec_micros_; }
+  int64 accelerator_exec_micros() const { return accelerator_exec_micros_; }
+  int64 cpu_exec_micros() const { return cpu_exec_micros_; }
+  int64 requested_bytes() const { return requested_bytes_; }
+  // Distribution of the per-step exec_micros, for percentiles. nullptr if no
+  // step has been aggregated.
+  const histogram::Histogram* exec_micros_histogram() const {
+    return exec_micros_histogram_.get();
+  }
+
+ private:
+  int64 num_steps_;
+  int64 run_count_;
+  int64 exec_micros_;
+  int64 accelerator_exec_micros_;
+  int64 cpu_exec_micros_;
+  int64 requested_bytes_;
+  std::unique_ptr<histogram::Histogram> exec_micros_histogram_;
 };
 
 class TFGraphNode {
@@ -168,6 +212,10 @@ class TFGraphNode {
   void AddStepStat(int64 step, const string& device,
                    const NodeExecStats& step_stat);
 
+  // Folds the ExecStep of every step other than keep_step into the
+  // aggregated stats and releases it.
+  void AggregateSteps(int64 keep_step);
+
   void AddFloatOps(int64 float_ops) { float_ops_ = float_ops; }
 
   // TODO(xpan): This could take a lot of memory.
@@ -196,7 +244,7 @@ class TFGraphNode {
   // Number of times the graph node is executed. When step < 0, the
   // average number of times executed across all steps.
   int64 run_count(int64 step) const {
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return 0;
     }
     if (step >= 0) {
@@ -204,17 +252,17 @@ class TFGraphNode {
       CHECK(exec != execs_.end());
       return exec->second.run_count();
     }
-    int64 total_run_count = 0;
+    int64 total_run_count = aggregated_execs_.run_count();
     for (const auto& exec : execs_) {
       total_run_count += exec.second.run_count();
     }
-    return total_run_count / execs_.size();
+    return total_run_count / num_steps();
   }
   // This is overall computation time, including both cpu and accelerator.
   // Note, cpu and accelerator might or might not run in parallel.
   int64 exec_micros(int64 step) const {
     // Empty when no RunMetadata is provided.
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return 0;
     }
     if (step >= 0) {
@@ -223,18 +271,18 @@ class TFGraphNode {
       return exec->second.exec_micros();
     }
 
-    int64 total_micros = 0;
+    int64 total_micros = aggregated_execs_.exec_micros();
     for (const auto& exec : execs_) {
       total_micros += exec.second.exec_micros();
     }
-    return total_micros / execs_.size();
+    return total_micros / num_steps();
   }
 
   // This is accelerator computation time of a step, or average of
   // multiple step, when step < 0.
   int64 accelerator_exec_micros(int64 step) const {
     // Empty when no RunMetadata is provided.
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return 0;
     }
     if (step >= 0) {
@@ -243,18 +291,18 @@ class TFGraphNode {
       return exec->second.accelerator_exec_micros();
     }
 
-    int64 total_micros = 0;
+    int64 total_micros = aggregated_execs_.accelerator_exec_micros();
     for (const auto& exec : execs_) {
       total_micros += exec.second.accelerator_exec_micros();
     }
-    return total_micros / execs_.size();
+    return total_micros / num_steps();
   }
 
   // This is cpu computation time of a step, or average of
   // multiple step, when step < 0.
   int64 cpu_exec_micros(int64 step) const {
     // Empty when no RunMetadata is provided.
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return 0;
     }
     if (step >= 0) {
@@ -263,15 +311,15 @@ class TFGraphNode {
       return exec->second.cpu_exec_micros();
     }
 
-    int64 total_micros = 0;
+    int64 total_micros = aggregated_execs_.cpu_exec_micros();
     for (const auto& exec : execs_) {
       total_micros += exec.second.cpu_exec_micros();
     }
-    return total_micros / execs_.size();
+    return total_micros / num_steps();
   }
 
   int64 requested_bytes(int64 step) const {
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return 0;
     }
     if (step >= 0) {
@@ -280,11 +328,11 @@ class TFGraphNode {
       return exec->second.requested_bytes();
     }
 
-    int64 requested_bytes = 0;
+    int64 requested_bytes = aggregated_execs_.requested_bytes();
     for (const auto& exec : execs_) {
       requested_bytes += exec.second.requested_bytes();
     }
-    return requested_bytes / execs_.size();
+    return requested_bytes / num_steps();
   }
 
   int64 all_start_micros(int64 step) const {
@@ -307,6 +355,9 @@ class TFGraphNode {
   }
 
   const std::map<int64, ExecStep>& all_op_execs() const { return execs_; }
+  const AggregatedExecStats& aggregated_execs() const {
+    return aggregated_execs_;
+  }
 
   int64 accelerator_temp_bytes(int64 step) const {
     auto exec = execs_.find(step);
@@ -339,10 +390,16 @@ class TFGraphNode {
     CHECK(exec != execs_.end()) << "unknown step " << step;
     return exec->second.allocator_bytes_in_use();
   }
+  const std::map<string, std::vector<AllocationRecord>>& allocations(
+      int64 step) const {
+    auto exec = execs_.find(step);
+    CHECK(exec != execs_.end()) << "unknown step " << step;
+    return exec->second.allocations();
+  }
 
   int64 float_ops(int64 step) const {
     // If not run, return static analysis.
-    if (execs_.empty()) {
+    if (num_steps() == 0) {
       return float_ops_;
     }
     // Otherwise, return dynamic float_ops.
@@ -367,6 +424,11 @@ class TFGraphNode {
   }
 
  private:
+  // Number of steps the node ran in, including the aggregated ones.
+  int64 num_steps() const {
+    return execs_.size() + aggregated_execs_.num_steps();
+  }
+
   std::map<int, TFGraphNode*> inputs_;
   std::map<string, int64> src_output_idx_;
 
@@ -385,6 +447,8 @@ class TFGraphNode {
   std::map<string, const AttrValue*> op_attrs_;
 
   std::map<int64, ExecStep> execs_;
+  // Steps released from execs_ by AggregateSteps.
+  AggregatedExecStats aggregated_execs_;
 
   // /j:#/t:#/r:#/device:#. A canonical device name without extra suffix.
   string canonical_device_;
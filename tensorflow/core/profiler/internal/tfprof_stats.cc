@@ -16,20 +16,92 @@ limitations under the License.
 #include "tensorflow/core/profiler/internal/tfprof_stats.h"
 
 #include <stdio.h>
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/profiler/internal/tfprof_timeline.h"
 
 namespace tensorflow {
 namespace tfprof {
+namespace {
+// Returns the op type from a timeline label "name = type(inputs)".
+string OpTypeFromTimelineLabel(const string& label) {
+  auto type_start = label.find(" = ");
+  if (type_start == label.npos) {
+    return "";
+  }
+  type_start += 3;
+  auto type_end = label.find('(', type_start);
+  if (type_end == label.npos) {
+    return "";
+  }
+  return label.substr(type_start, type_end - type_start);
+}
+
+// Returns the device without its last component, e.g. /job:x/task:0 for
+// /job:x/task:0/gpu:0.
+string TaskOfDevice(const string& device) {
+  auto pos = device.rfind('/');
+  return pos == device.npos ? device : device.substr(0, pos);
+}
+
+bool IsInputOp(const string& type) {
+  return StringPiece(type).starts_with("QueueDequeue") ||
+         StringPiece(type).starts_with("ReaderRead") ||
+         type == "IteratorGetNext";
+}
+
+// Returns true if a _Recv receives from another task. The timeline label of
+// a _Recv is "name = _Recv(tensor_name @send_device".
+bool IsRemoteRecv(const string& device, const string& type,
+                  const string& label) {
+  if (type != "_Recv" && type != "_HostRecv") {
+    return false;
+  }
+  auto send_device_start = label.rfind(" @");
+  if (send_device_start == label.npos) {
+    return false;
+  }
+  const string send_device = label.substr(send_device_start + 2);
+  return TaskOfDevice(str_util::Lowercase(send_device)) !=
+         TaskOfDevice(str_util::Lowercase(device));
+}
+
+bool IsHostDeviceCopy(const string& device, const string& label) {
+  if (device.find("/memcpy") == device.npos) {
+    return false;
+  }
+  return label.find("DtoD") == label.npos;
+}
+
+// Returns the total length of the union of [start, end) intervals.
+int64 UnionMicros(std::vector<std::pair<int64, int64>>* intervals) {
+  std::sort(intervals->begin(), intervals->end());
+  int64 total = 0;
+  int64 covered_end = 0;
+  for (const auto& interval : *intervals) {
+    const int64 start = std::max(interval.first, covered_end);
+    if (interval.second > start) {
+      total += interval.second - start;
+      covered_end = interval.second;
+    }
+  }
+  return total;
+}
+}  // namespace
+
 TFStats::TFStats(std::unique_ptr<GraphDef> graph,
                  std::unique_ptr<RunMetadata> run_meta,
                  std::unique_ptr<OpLogProto> op_log,
                  std::unique_ptr<checkpoint::CheckpointReader> ckpt_reader)
-    : has_code_traces_(false),
+    : aggregate_steps_(false),
+      latest_step_(-1),
+      has_code_traces_(false),
       graph_(std::move(graph)),
       ckpt_reader_(std::move(ckpt_reader)) {
   CHECK(graph_) << "Must at least have GraphDef";
@@ -182,7 +254,14 @@ void TFStats::AddRunMeta(int64 step, std::unique_ptr<RunMetadata> run_meta) {
     return;
   }
   steps_.insert(step);
+  latest_step_ = step;
 
+  StepStallStats stall_stats;
+  int64 step_start_micros = 0;
+  int64 step_end_micros = 0;
+  std::vector<std::pair<int64, int64>> input_execs;
+  std::vector<std::pair<int64, int64>> remote_recv_execs;
+  std::vector<std::pair<int64, int64>> memcpy_execs;
   for (const auto& dev_stat : run_meta->step_stats().dev_stats()) {
     for (const NodeExecStats& node_stat : dev_stat.node_stats()) {
       string name = node_stat.node_name();
@@ -195,15 +274,66 @@ void TFStats::AddRunMeta(int64 step, std::unique_ptr<RunMetadata> run_meta) {
       if (node != nodes_map_.end()) {
         node->second->AddStepStat(step, dev_stat.device(), node_stat);
       }
+
+      if (node_stat.all_start_micros() <= 0) continue;
+      // Async ops, such as dequeues and receives, only finish at
+      // all_end_rel_micros.
+      const int64 start_micros = node_stat.all_start_micros();
+      const int64 end_micros = start_micros + node_stat.all_end_rel_micros();
+      if (step_start_micros == 0 || start_micros < step_start_micros) {
+        step_start_micros = start_micros;
+      }
+      step_end_micros = std::max(step_end_micros, end_micros);
+      const string type = node != nodes_map_.end()
+                              ? node->second->op()
+                              : OpTypeFromTimelineLabel(
+                                    node_stat.timeline_label());
+      const int64 micros = end_micros - start_micros;
+      if (IsInputOp(type)) {
+        input_execs.emplace_back(start_micros, end_micros);
+        stall_stats.input_ops[name] += micros;
+      } else if (IsRemoteRecv(dev_stat.device(), type,
+                              node_stat.timeline_label())) {
+        remote_recv_execs.emplace_back(start_micros, end_micros);
+        stall_stats.remote_recv_ops[name] += micros;
+      } else if (IsHostDeviceCopy(dev_stat.device(),
+                                  node_stat.timeline_label())) {
+        memcpy_execs.emplace_back(start_micros, end_micros);
+        stall_stats.memcpy_ops[name] += micros;
+      }
+    }
+  }
+  stall_stats.step_micros = step_end_micros - step_start_micros;
+  stall_stats.input_micros = UnionMicros(&input_execs);
+  stall_stats.remote_recv_micros = UnionMicros(&remote_recv_execs);
+  stall_stats.memcpy_micros = UnionMicros(&memcpy_execs);
+  latest_step_stall_stats_ = std::move(stall_stats);
+  if (aggregate_steps_) {
+    for (auto& node : nodes_map_) {
+      node.second->AggregateSteps(step);
     }
   }
 }
 
+void TFStats::EnableStepAggregation() {
+  aggregate_steps_ = true;
+  for (auto& node : nodes_map_) {
+    node.second->AggregateSteps(latest_step_);
+  }
+}
+
 bool TFStats::Validate(const Options& opts) const {
   if (opts.step >= 0 && steps_.find(opts.step) == steps_.end()) {
     fprintf(stderr, "Options -step=%lld not found\n", opts.step);
     return false;
   }
+  if (aggregate_steps_ && opts.step >= 0 && opts.step != latest_step_) {
+    fprintf(stderr,
+            "Options -step=%lld has been aggregated, only -step=%lld or "
+            "-step=-1 can be shown\n",
+            opts.step, latest_step_);
+    return false;
+  }
   return true;
 }
 
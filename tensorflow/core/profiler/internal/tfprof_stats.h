@@ -49,6 +49,28 @@ limitations under the License.
 namespace tensorflow {
 namespace tfprof {
 
+// Wall time of a step spent in the ops that a step commonly stalls on,
+// computed from the StepStats of its RunMetadata. Concurrent executions of
+// ops of the same kind are only counted once.
+struct StepStallStats {
+  StepStallStats()
+      : step_micros(0), input_micros(0), remote_recv_micros(0),
+        memcpy_micros(0) {}
+
+  // From the earliest op start to the latest op end of the step.
+  int64 step_micros;
+  // Input ops, such as QueueDequeue and IteratorGetNext.
+  int64 input_micros;
+  // _Recv ops whose sender is in another task.
+  int64 remote_recv_micros;
+  // Host to device and device to host copies, traced on the memcpy streams.
+  int64 memcpy_micros;
+  // Op name -> summed micros, for each kind above.
+  std::map<string, int64> input_ops;
+  std::map<string, int64> remote_recv_ops;
+  std::map<string, int64> memcpy_ops;
+};
+
 class TFStats {
  public:
   TFStats(std::unique_ptr<GraphDef> graph,
@@ -62,6 +84,10 @@ class TFStats {
   }
   const std::set<int64>& steps() const { return steps_; }
   bool has_code_traces() const { return has_code_traces_; }
+  // Stall stats of the latest added step.
+  const StepStallStats& latest_step_stall_stats() const {
+    return latest_step_stall_stats_;
+  }
 
   void BuildView(const string& cmd);
   void BuildAllViews();
@@ -78,6 +104,13 @@ class TFStats {
 
   // Add a step of run time meta data.
   void AddRunMeta(int64 step, std::unique_ptr<RunMetadata> run_meta);
+  // Incremental mode for profiling large graphs over many steps. Whenever a
+  // step is added, the per-step stats of all the previous steps are folded
+  // into compact per-node aggregates, so memory no longer grows with the
+  // number of steps. Queries over all steps (-step -1) are answered from the
+  // aggregates; only the latest step can still be queried with -step, e.g.
+  // for timelines.
+  void EnableStepAggregation();
   // Add tfprof operation meta data, such as customized op type, float_ops,
   // and code traces.
   void AddOpLogProto(std::unique_ptr<OpLogProto> op_log);
@@ -91,6 +124,9 @@ class TFStats {
   void ParseGraph();
 
   std::set<int64> steps_;
+  bool aggregate_steps_;
+  int64 latest_step_;
+  StepStallStats latest_step_stall_stats_;
   bool has_code_traces_;
   std::unique_ptr<GraphDef> graph_;
   std::unique_ptr<TFScope> scope_view_;
@@ -42,13 +42,7 @@ class TFProfStatsTest : public ::testing::Test {
     TF_CHECK_OK(
         ReadProtoFile(Env::Default(), graph_path, graph_pb.get(), false));
 
-    std::unique_ptr<tensorflow::RunMetadata> run_meta_pb(
-        new tensorflow::RunMetadata());
-    string run_meta_path =
-        io::JoinPath(testing::TensorFlowSrcRoot(),
-                     "core/profiler/internal/testdata/run_meta");
-    TF_CHECK_OK(
-        ReadProtoFile(Env::Default(), run_meta_path, run_meta_pb.get(), true));
+    std::unique_ptr<tensorflow::RunMetadata> run_meta_pb = ReadRunMeta();
 
     std::unique_ptr<OpLogProto> op_log_pb(new OpLogProto());
     string op_log_path =
@@ -69,6 +63,17 @@ class TFProfStatsTest : public ::testing::Test {
     tf_stats_->BuildAllViews();
   }
 
+  std::unique_ptr<tensorflow::RunMetadata> ReadRunMeta() {
+    std::unique_ptr<tensorflow::RunMetadata> run_meta_pb(
+        new tensorflow::RunMetadata());
+    string run_meta_path =
+        io::JoinPath(testing::TensorFlowSrcRoot(),
+                     "core/profiler/internal/testdata/run_meta");
+    TF_CHECK_OK(
+        ReadProtoFile(Env::Default(), run_meta_path, run_meta_pb.get(), true));
+    return run_meta_pb;
+  }
+
   std::unique_ptr<TFStats> tf_stats_;
 };
 
@@ -135,6 +140,41 @@ TEST_F(TFProfStatsTest, CustomOpType) {
   EXPECT_EQ(expected.DebugString(), root.DebugString());
 }
 
+TEST_F(TFProfStatsTest, AggregateSteps) {
+  Options opts(3, 0, 0, 0, 0, 0, -1, "name", {".*"}, {".*"}, {""}, {".*"},
+               {""}, false, {"params", "bytes", "micros", "float_ops"}, "",
+               {});
+  const string expected =
+      tf_stats_->ShowGraphNode("scope", opts).DebugString();
+
+  tf_stats_->EnableStepAggregation();
+  tf_stats_->AddRunMeta(1, ReadRunMeta());
+  tf_stats_->AddRunMeta(2, ReadRunMeta());
+
+  // All steps are the same, so the averages over aggregated steps match the
+  // single step.
+  EXPECT_EQ(expected, tf_stats_->ShowGraphNode("scope", opts).DebugString());
+
+  const TFGraphNode* node = tf_stats_->nodes().at("conv2d/kernel").get();
+  EXPECT_EQ(1, node->all_op_execs().size());
+  EXPECT_EQ(2, node->aggregated_execs().num_steps());
+  EXPECT_EQ(2 * node->exec_micros(2), node->aggregated_execs().exec_micros());
+  ASSERT_TRUE(node->aggregated_execs().exec_micros_histogram() != nullptr);
+  EXPECT_EQ(node->exec_micros(2),
+            node->aggregated_execs().exec_micros_histogram()->Median());
+
+  // Only the latest step can be shown.
+  Options latest_step_opts(3, 0, 0, 0, 0, 0, 2, "name", {".*"}, {".*"}, {""},
+                           {".*"}, {""}, false,
+                           {"params", "bytes", "micros", "float_ops"}, "", {});
+  EXPECT_EQ(expected,
+            tf_stats_->ShowGraphNode("scope", latest_step_opts).DebugString());
+  Options old_step_opts(3, 0, 0, 0, 0, 0, 0, "name", {".*"}, {".*"}, {""},
+                        {".*"}, {""}, false,
+                        {"params", "bytes", "micros", "float_ops"}, "", {});
+  EXPECT_EQ("", tf_stats_->ShowGraphNode("scope", old_step_opts).name());
+}
+
 TEST_F(TFProfStatsTest, CheckPointOpType) {
   Options opts(3, 0, 0, 0, 0, 0, -1, "name",
                {kCkptVarType},  // accout_type_regexes
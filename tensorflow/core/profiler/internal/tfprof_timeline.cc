@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/internal/tfprof_timeline.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/lib/core/status.h"
@@ -34,6 +35,11 @@ string GetTimeDevName(const string& dev) {
 string GetMemoryLaneName(const string& dev) {
   return strings::StrCat("mem usage on:", dev);
 }
+string GetTensorLifetimeLaneName(const string& allocator) {
+  return strings::StrCat("tensor lifetimes on:", allocator);
+}
+// The number of ops listed in the breakdown of the peak memory.
+const int kMaxPeakMemoryOps = 10;
 }  // namespace
 
 Json::Value ChromeTraceFormatter::CreateEvent(const string& ph,
@@ -94,6 +100,16 @@ void ChromeTraceFormatter::EmitCounter(const string& category,
   events_.push_back(event);
 }
 
+void ChromeTraceFormatter::EmitInstant(const string& category,
+                                       const string& name, int64 pid, int64 ts,
+                                       Json::Value args) {
+  Json::Value event = CreateEvent("i", category, name, pid, 0, ts);
+  // Shown across all lanes of the process.
+  event["s"] = Json::Value("p");
+  event["args"] = std::move(args);
+  events_.push_back(event);
+}
+
 string ChromeTraceFormatter::Format() {
   Json::Value trace;
   trace["traceEvents"] = Json::Value(Json::arrayValue);
@@ -120,6 +136,17 @@ void MemoryTracker::TrackNode(int64 step, const GraphNode* node) {
   }
   Device& dev = devices_[node->node->canonical_device()];
   int64 end_micros = node->node->latest_end_micros(step);
+  latest_micros_ = std::max(latest_micros_, end_micros);
+  for (const auto& allocator : node->node->allocations(step)) {
+    std::vector<Allocation>& allocations = allocations_[allocator.first];
+    for (const AllocationRecord& record : allocator.second) {
+      allocations.push_back({node->name(), record.alloc_micros(),
+                             record.dealloc_micros(), record.alloc_bytes()});
+      latest_micros_ = std::max(
+          latest_micros_, static_cast<int64>(std::max(
+                              record.alloc_micros(), record.dealloc_micros())));
+    }
+  }
   if (node->node->accelerator_persistent_bytes(step) != 0) {
     string tensor_name = strings::StrCat(node->name(), ":", -1);
     dev.earliest_ref[tensor_name] = node->node->all_start_micros(step);
@@ -287,9 +314,92 @@ void Timeline::GenerateGraphTimeline(const std::vector<GraphNode*>& gnodes) {
                                     alloc_stats.second);
     }
   }
+  EmitTensorLifetimes();
   OutputTimeline();
 }
 
+void Timeline::EmitTensorLifetimes() {
+  // The memory that is never deallocated is shown until the end of the step.
+  const int64 end_micros = mem_tracker_.latest_micros();
+  for (const auto& allocator : mem_tracker_.allocations()) {
+    std::vector<MemoryTracker::Allocation> allocations = allocator.second;
+    std::sort(allocations.begin(), allocations.end(),
+              [](const MemoryTracker::Allocation& a,
+                 const MemoryTracker::Allocation& b) {
+                return a.alloc_micros < b.alloc_micros;
+              });
+    int64 pid = AllocatePID();
+    chrome_formatter_.EmitPID(GetTensorLifetimeLaneName(allocator.first), pid);
+
+    // The end time of the last allocation in each lane.
+    std::vector<int64> lane_ends;
+    // time -> change of the allocated bytes.
+    std::map<int64, int64> bytes_deltas;
+    for (const auto& allocation : allocations) {
+      int64 dealloc_micros =
+          allocation.dealloc_micros > 0 ? allocation.dealloc_micros
+                                        : end_micros;
+      int64 lane = 0;
+      while (lane < lane_ends.size() &&
+             lane_ends[lane] > allocation.alloc_micros) {
+        ++lane;
+      }
+      if (lane == lane_ends.size()) {
+        lane_ends.push_back(dealloc_micros);
+      } else {
+        lane_ends[lane] = dealloc_micros;
+      }
+      Json::Value args(Json::objectValue);
+      args["name"] = Json::Value(allocation.name);
+      args["bytes"] = Json::Value(allocation.bytes);
+      chrome_formatter_.EmitRegion(allocation.alloc_micros,
+                                   dealloc_micros - allocation.alloc_micros,
+                                   pid, lane, "Tensor", allocation.name, args);
+      bytes_deltas[allocation.alloc_micros] += allocation.bytes;
+      if (allocation.dealloc_micros > 0) {
+        bytes_deltas[allocation.dealloc_micros] -= allocation.bytes;
+      }
+    }
+
+    int64 bytes = 0;
+    int64 peak_bytes = 0;
+    int64 peak_micros = 0;
+    for (const auto& delta : bytes_deltas) {
+      bytes += delta.second;
+      chrome_formatter_.EmitCounter("Memory", "Tensor Memory", pid,
+                                    delta.first, allocator.first, bytes);
+      if (bytes > peak_bytes) {
+        peak_bytes = bytes;
+        peak_micros = delta.first;
+      }
+    }
+    if (peak_bytes <= 0) {
+      continue;
+    }
+    // Breaks the peak down by the ops that allocated the live memory.
+    std::map<string, int64> peak_op_bytes;
+    for (const auto& allocation : allocations) {
+      if (allocation.alloc_micros <= peak_micros &&
+          (allocation.dealloc_micros == 0 ||
+           allocation.dealloc_micros > peak_micros)) {
+        peak_op_bytes[allocation.name] += allocation.bytes;
+      }
+    }
+    std::vector<std::pair<int64, string>> sorted_ops;
+    for (const auto& op : peak_op_bytes) {
+      sorted_ops.emplace_back(op.second, op.first);
+    }
+    std::sort(sorted_ops.rbegin(), sorted_ops.rend());
+    Json::Value args(Json::objectValue);
+    args["total_bytes"] = Json::Value(peak_bytes);
+    for (int i = 0; i < kMaxPeakMemoryOps && i < sorted_ops.size(); ++i) {
+      args[sorted_ops[i].second] = Json::Value(sorted_ops[i].first);
+    }
+    chrome_formatter_.EmitInstant("Memory", "Peak memory", pid, peak_micros,
+                                  args);
+  }
+}
+
 void Timeline::GenerateScopeTimeline(const ScopeNode* node) {
   std::set<int64> visited_depth;
   EmitTreeNode(node, 0, node->proto().total_exec_micros(), 0, &visited_depth);
@@ -49,6 +49,9 @@ class ChromeTraceFormatter {
   void EmitCounter(const string& category, const string& name, int64 pid,
                    int64 ts, const string& device, int64 bytes);
 
+  void EmitInstant(const string& category, const string& name, int64 pid,
+                   int64 ts, Json::Value args);
+
   string Format();
 
  private:
@@ -104,6 +107,15 @@ class MemoryTracker {
     std::map<int64, int64> allocator_stats;
   };
 
+  // The lifetime of some memory allocated by an op, e.g. for a tensor.
+  struct Allocation {
+    string name;
+    int64 alloc_micros;
+    // 0 if the memory was still allocated at the end of the step.
+    int64 dealloc_micros;
+    int64 bytes;
+  };
+
   void TrackNode(int64 step, const GraphNode* node);
 
   void TrackNodeConnection(int64 step, const GraphNode* node,
@@ -111,8 +123,18 @@ class MemoryTracker {
 
   const std::map<string, Device>& devices() const { return devices_; }
 
+  // allocator name -> allocations, recorded by the TensorFlow allocator.
+  const std::map<string, std::vector<Allocation>>& allocations() const {
+    return allocations_;
+  }
+
+  // The latest time of the tracked nodes and allocations.
+  int64 latest_micros() const { return latest_micros_; }
+
  private:
   std::map<string, Device> devices_;
+  std::map<string, std::vector<Allocation>> allocations_;
+  int64 latest_micros_ = 0;
 };
 
 class Timeline {
@@ -139,6 +161,10 @@ class Timeline {
  private:
   void OutputTimeline();
 
+  // Emits a lane per allocation, the allocated bytes over time and the ops
+  // that hold the memory at its peak, for each allocator.
+  void EmitTensorLifetimes();
+
   template <typename Node>
   void EmitTreeNode(const Node* node, int64 start_time, int64 duration,
                     int64 depth, std::set<int64>* visited_depth) {
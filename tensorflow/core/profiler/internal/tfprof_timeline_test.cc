@@ -42,6 +42,12 @@ class TFProfTimelineTest : public ::testing::Test {
     TF_CHECK_OK(
         ReadProtoFile(Env::Default(), graph_path, graph_pb.get(), false));
 
+    tf_stats_.reset(new TFStats(std::move(graph_pb), ReadRunMeta(), nullptr,
+                                nullptr));
+    tf_stats_->BuildAllViews();
+  }
+
+  std::unique_ptr<tensorflow::RunMetadata> ReadRunMeta() {
     std::unique_ptr<tensorflow::RunMetadata> run_meta_pb(
         new tensorflow::RunMetadata());
     string run_meta_path =
@@ -49,10 +55,7 @@ class TFProfTimelineTest : public ::testing::Test {
                      "core/profiler/internal/testdata/run_meta");
     TF_CHECK_OK(
         ReadProtoFile(Env::Default(), run_meta_path, run_meta_pb.get(), true));
-
-    tf_stats_.reset(new TFStats(std::move(graph_pb), std::move(run_meta_pb),
-                                nullptr, nullptr));
-    tf_stats_->BuildAllViews();
+    return run_meta_pb;
   }
 
   std::unique_ptr<TFStats> tf_stats_;
@@ -86,6 +89,56 @@ TEST_F(TFProfTimelineTest, ScopeView) {
   EXPECT_EQ(10135186027625211652ull, Hash64(dump_str));
 }
 
+TEST_F(TFProfTimelineTest, TensorLifetimes) {
+  std::unique_ptr<tensorflow::RunMetadata> run_meta_pb = ReadRunMeta();
+  DeviceStepStats* dev_stats =
+      run_meta_pb->mutable_step_stats()->mutable_dev_stats(0);
+  // "zeros" allocates a tensor that is freed before "conv2d/kernel"
+  // allocates one that stays live.
+  NodeExecStats* zeros = dev_stats->mutable_node_stats(1);
+  ASSERT_EQ("zeros", zeros->node_name());
+  AllocationRecord* record =
+      zeros->mutable_memory(0)->add_allocation_records();
+  record->set_alloc_micros(zeros->all_start_micros() + 1);
+  record->set_dealloc_micros(zeros->all_start_micros() + 10);
+  record->set_alloc_bytes(1536);
+  NodeExecStats* kernel = dev_stats->mutable_node_stats(2);
+  ASSERT_EQ("conv2d/kernel", kernel->node_name());
+  record = kernel->mutable_memory(0)->add_allocation_records();
+  record->set_alloc_micros(kernel->all_start_micros() + 2);
+  record->set_alloc_bytes(648);
+  record = kernel->mutable_memory(0)->add_allocation_records();
+  record->set_alloc_micros(kernel->all_start_micros() + 3);
+  record->set_dealloc_micros(kernel->all_start_micros() + 4);
+  record->set_alloc_bytes(100);
+
+  std::unique_ptr<tensorflow::GraphDef> graph_pb(new tensorflow::GraphDef());
+  TF_CHECK_OK(ReadProtoFile(
+      Env::Default(),
+      io::JoinPath(testing::TensorFlowSrcRoot(),
+                   "core/profiler/internal/testdata/graph.pbtxt"),
+      graph_pb.get(), false));
+  TFStats tf_stats(std::move(graph_pb), std::move(run_meta_pb), nullptr,
+                   nullptr);
+  tf_stats.BuildAllViews();
+
+  string dump_file = io::JoinPath(testing::TmpDir(), "dump");
+  Options opts(10000, 0, 0, 0, 0, 0, 0, "name", {".*"},  // accout_type_regexes
+               {".*"}, {""}, {".*"}, {""}, false,
+               {"params", "bytes", "micros", "float_ops"}, "timeline",
+               {{"outfile", dump_file}});
+  tf_stats.ShowGraphNode("graph", opts);
+
+  string dump_str;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), dump_file, &dump_str));
+  EXPECT_NE(dump_str.npos, dump_str.find("tensor lifetimes on:cpu"));
+  // The peak is reached when the second tensor of "conv2d/kernel" is
+  // allocated, while the tensor of "zeros" is still live.
+  EXPECT_NE(dump_str.npos,
+            dump_str.find("\"args\":{\"conv2d/kernel\":748,"
+                          "\"total_bytes\":2284,\"zeros\":1536}"));
+}
+
 // TODO(xpan): tfprof_log is too large to include in testdata when adding
 // code traces.
 
@@ -0,0 +1,134 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_events_writer.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+AsyncEventsWriter::AsyncEventsWriter(const string& file_prefix,
+                                     const string& file_suffix,
+                                     const Options& options)
+    : options_(options), writer_(file_prefix) {
+  if (writer_.InitWithSuffix(file_suffix)) {
+    filename_ = writer_.FileName();
+  }
+  thread_.reset(options_.env->StartThread(ThreadOptions(), "events_writer",
+                                          [this]() { WriteLoop(); }));
+}
+
+AsyncEventsWriter::~AsyncEventsWriter() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+  }
+  work_cv_.notify_one();
+  // Joins the background thread, which writes and flushes the queued events.
+  thread_.reset();
+  writer_.Close();
+}
+
+bool AsyncEventsWriter::WriteEvent(const Event& event) {
+  string record;
+  event.AppendToString(&record);
+  return WriteSerializedEvent(record);
+}
+
+bool AsyncEventsWriter::WriteSerializedEvent(StringPiece event_str) {
+  const int64 bytes = event_str.size();
+  {
+    mutex_lock l(mu_);
+    // An event larger than the whole queue is still queued once the queue
+    // is empty.
+    while (!queue_.empty() &&
+           queued_bytes_ + bytes > options_.max_queued_bytes) {
+      if (options_.overflow_policy == kDrop) {
+        ++num_dropped_events_;
+        return false;
+      }
+      done_cv_.wait(l);
+    }
+    queue_.emplace_back(event_str.data(), event_str.size());
+    queued_bytes_ += bytes;
+  }
+  work_cv_.notify_one();
+  return true;
+}
+
+bool AsyncEventsWriter::Flush() {
+  mutex_lock l(mu_);
+  const int64 flush = ++num_flushes_requested_;
+  work_cv_.notify_one();
+  while (num_flushes_done_ < flush) {
+    done_cv_.wait(l);
+  }
+  return last_flush_ok_;
+}
+
+int64 AsyncEventsWriter::num_dropped_events() const {
+  mutex_lock l(mu_);
+  return num_dropped_events_;
+}
+
+void AsyncEventsWriter::WriteLoop() {
+  Env* env = options_.env;
+  uint64 next_flush_micros = env->NowMicros() + options_.flush_interval_micros;
+  std::deque<string> events;
+  while (true) {
+    int64 flush;
+    bool flush_requested;
+    bool stop;
+    {
+      mutex_lock l(mu_);
+      while (queue_.empty() && num_flushes_requested_ == num_flushes_done_ &&
+             !stop_) {
+        const uint64 now = env->NowMicros();
+        if (now >= next_flush_micros) break;
+        WaitForMilliseconds(
+            &l, &work_cv_,
+            std::max<int64>(1, (next_flush_micros - now + 999) / 1000));
+      }
+      events.swap(queue_);
+      queued_bytes_ = 0;
+      flush = num_flushes_requested_;
+      flush_requested = flush > num_flushes_done_;
+      stop = stop_;
+    }
+    // Wakes up the writers waiting for room in the queue.
+    done_cv_.notify_all();
+
+    for (const string& event : events) {
+      writer_.WriteSerializedEvent(event);
+    }
+    events.clear();
+    const uint64 now = env->NowMicros();
+    if (flush_requested || stop || now >= next_flush_micros) {
+      const bool flush_ok = writer_.Flush();
+      next_flush_micros = now + options_.flush_interval_micros;
+      {
+        mutex_lock l(mu_);
+        num_flushes_done_ = flush;
+        last_flush_ok_ = flush_ok;
+      }
+      done_cv_.notify_all();
+    }
+    if (stop) return;
+  }
+}
+
+}  // namespace tensorflow
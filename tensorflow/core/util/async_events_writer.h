@@ -0,0 +1,113 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_UTIL_ASYNC_EVENTS_WRITER_H_
+#define TENSORFLOW_UTIL_ASYNC_EVENTS_WRITER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/event.pb.h"
+#include "tensorflow/core/util/events_writer.h"
+
+namespace tensorflow {
+
+// AsyncEventsWriter writes events to an events file from a background
+// thread, so that the threads producing the events (e.g. the training loop
+// writing summaries) never wait on the file system.
+//
+// The events are queued in memory, up to "max_queued_bytes". When the queue
+// is full, a write either blocks until the background thread catches up, or
+// drops the event, as per "overflow_policy". The background thread writes
+// the events as they come, and flushes the file every
+// "flush_interval_micros" and on Flush().
+//
+// The methods of AsyncEventsWriter are thread-safe.
+class AsyncEventsWriter {
+ public:
+  enum OverflowPolicy {
+    kBlock,  // Wait for room in the queue.
+    kDrop,   // Drop the event.
+  };
+
+  struct Options {
+    Env* env = Env::Default();
+    int64 max_queued_bytes = 16 << 20;
+    OverflowPolicy overflow_policy = kBlock;
+    int64 flush_interval_micros = 120 * 1000 * 1000;
+  };
+
+  // Opens the events file, named as by EventsWriter for "file_prefix" and
+  // "file_suffix", and starts the background thread.
+  AsyncEventsWriter(const string& file_prefix, const string& file_suffix,
+                    const Options& options);
+
+  // Writes the queued events, then flushes and closes the file.
+  ~AsyncEventsWriter();
+
+  // The name of the events file opened by the constructor, or "" if it
+  // could not be opened.
+  const string& FileName() const { return filename_; }
+
+  // Queues "event" to be appended to the file. Returns false if the event
+  // was dropped as the queue is full.
+  bool WriteEvent(const Event& event);
+  bool WriteSerializedEvent(StringPiece event_str);
+
+  // Waits until the events queued so far are written, and flushes the file.
+  // Returns false if the flush failed.
+  bool Flush();
+
+  // The number of events dropped since the construction.
+  int64 num_dropped_events() const;
+
+ private:
+  // The loop of the background thread.
+  void WriteLoop();
+
+  const Options options_;
+  EventsWriter writer_;  // Only used by the background thread once started.
+  string filename_;
+
+  mutable mutex mu_;
+  // Signaled when events are queued, a flush is requested or stop_ is set.
+  condition_variable work_cv_;
+  // Signaled when the queue is emptied or a flush is done.
+  condition_variable done_cv_;
+  std::deque<string> queue_ GUARDED_BY(mu_);
+  int64 queued_bytes_ GUARDED_BY(mu_) = 0;
+  int64 num_dropped_events_ GUARDED_BY(mu_) = 0;
+  // Flush() requests are numbered; the background thread records the last
+  // one it has served, and its result.
+  int64 num_flushes_requested_ GUARDED_BY(mu_) = 0;
+  int64 num_flushes_done_ GUARDED_BY(mu_) = 0;
+  bool last_flush_ok_ GUARDED_BY(mu_) = true;
+  bool stop_ GUARDED_BY(mu_) = false;
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncEventsWriter);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_UTIL_ASYNC_EVENTS_WRITER_H_
@@ -0,0 +1,124 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_events_writer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/event.pb.h"
+
+namespace tensorflow {
+namespace {
+
+Env* env() { return Env::Default(); }
+
+// Returns the steps of the events in "filename", after the file version.
+std::vector<int64> ReadSteps(const string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env()->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  string record;
+  std::vector<int64> steps;
+  bool first = true;
+  while (reader.ReadRecord(&offset, &record).ok()) {
+    Event event;
+    CHECK(ParseProtoUnlimited(&event, record));
+    if (first) {
+      EXPECT_FALSE(event.file_version().empty());
+      first = false;
+    } else {
+      steps.push_back(event.step());
+    }
+  }
+  return steps;
+}
+
+void WriteSteps(AsyncEventsWriter* writer, int64 num_steps,
+                int64* num_written) {
+  *num_written = 0;
+  for (int64 step = 0; step < num_steps; ++step) {
+    Event event;
+    event.set_step(step);
+    if (writer->WriteEvent(event)) ++*num_written;
+  }
+}
+
+TEST(AsyncEventsWriterTest, WritesAndFlushes) {
+  const string file_prefix =
+      io::JoinPath(testing::TmpDir(), "async_events_writer_test");
+  AsyncEventsWriter::Options options;
+  // Only explicit flushes.
+  options.flush_interval_micros = 3600LL * 1000 * 1000;
+  AsyncEventsWriter writer(file_prefix, ".flush", options);
+  ASSERT_FALSE(writer.FileName().empty());
+  int64 num_written;
+  WriteSteps(&writer, 100, &num_written);
+  EXPECT_EQ(100, num_written);
+  EXPECT_TRUE(writer.Flush());
+  const std::vector<int64> steps = ReadSteps(writer.FileName());
+  ASSERT_EQ(100, steps.size());
+  for (int64 i = 0; i < steps.size(); ++i) {
+    EXPECT_EQ(i, steps[i]);
+  }
+  EXPECT_EQ(0, writer.num_dropped_events());
+}
+
+TEST(AsyncEventsWriterTest, BlocksWhenFull) {
+  const string file_prefix =
+      io::JoinPath(testing::TmpDir(), "async_events_writer_test");
+  AsyncEventsWriter::Options options;
+  options.max_queued_bytes = 1;
+  string filename;
+  {
+    AsyncEventsWriter writer(file_prefix, ".block", options);
+    filename = writer.FileName();
+    int64 num_written;
+    WriteSteps(&writer, 100, &num_written);
+    EXPECT_EQ(100, num_written);
+  }
+  // The destructor writes the queued events.
+  EXPECT_EQ(100, ReadSteps(filename).size());
+}
+
+TEST(AsyncEventsWriterTest, DropsWhenFull) {
+  const string file_prefix =
+      io::JoinPath(testing::TmpDir(), "async_events_writer_test");
+  AsyncEventsWriter::Options options;
+  options.max_queued_bytes = 1;
+  options.overflow_policy = AsyncEventsWriter::kDrop;
+  AsyncEventsWriter writer(file_prefix, ".drop", options);
+  int64 num_written;
+  WriteSteps(&writer, 1000, &num_written);
+  EXPECT_TRUE(writer.Flush());
+  // Whether an event is dropped depends on the progress of the background
+  // thread, but each one is either written or dropped, in order.
+  const std::vector<int64> steps = ReadSteps(writer.FileName());
+  EXPECT_EQ(num_written, steps.size());
+  EXPECT_EQ(1000, num_written + writer.num_dropped_events());
+  for (int64 i = 1; i < steps.size(); ++i) {
+    EXPECT_LT(steps[i - 1], steps[i]);
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
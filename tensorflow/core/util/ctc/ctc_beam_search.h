@@ -85,6 +85,7 @@ class CTCBeamSearchDecoder : public CTCDecoder {
                        bool merge_repeated = false)
       : CTCDecoder(num_classes, batch_size, merge_repeated),
         beam_width_(beam_width),
+        input_(num_classes),
         leaves_(beam_width),
         beam_scorer_(CHECK_NOTNULL(scorer)) {
     Reset();
@@ -136,6 +137,10 @@ class CTCBeamSearchDecoder : public CTCDecoder {
   int label_selection_size_ = 0;       // zero means unlimited
   float label_selection_margin_ = -1;  // -1 means unlimited.
 
+  // Scratch space for Step, kept across steps to avoid reallocating it.
+  Eigen::ArrayXf input_;
+  std::vector<float> label_selection_input_;
+
   gtl::TopN<BeamEntry*, CTCBeamComparer> leaves_;
   std::unique_ptr<BeamEntry> beam_root_;
   BaseBeamScorer<CTCBeamState>* beam_scorer_;
@@ -206,14 +211,16 @@ template <typename CTCBeamState, typename CTCBeamComparer>
 template <typename Vector>
 void CTCBeamSearchDecoder<CTCBeamState, CTCBeamComparer>::Step(
     const Vector& raw_input) {
-  Eigen::ArrayXf input = raw_input;
+  Eigen::ArrayXf& input = input_;
+  input = raw_input;
   // Remove the max for stability when performing log-prob calculations.
   input -= input.maxCoeff();
 
   // Minimum allowed input value for label selection:
   float label_selection_input_min = -std::numeric_limits<float>::infinity();
   if (label_selection_size_ > 0 && label_selection_size_ < input.size()) {
-    std::vector<float> input_copy(input.data(), input.data() + input.size());
+    std::vector<float>& input_copy = label_selection_input_;
+    input_copy.assign(input.data(), input.data() + input.size());
     std::nth_element(input_copy.begin(),
                      input_copy.begin() + label_selection_size_ - 1,
                      input_copy.end(), [](float a, float b) { return a > b; });
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/casts.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/logging.h"
@@ -1098,5 +1099,491 @@ Status FastParseExample(const Config& config,
   return Status::OK();
 }
 
+// -----------------------------------------------------------------------------
+
+namespace {
+
+using SequenceConfig = FastParseSingleSequenceExampleConfig;
+
+// SequenceExamples at least this large have their feature lists parsed in
+// parallel.
+const size_t kMinParallelSequenceExampleBytes = 64 << 10;
+
+// The serialized value of a requested key, if the key was found.
+struct FoundFeature {
+  bool found = false;
+  StringPiece serialized;
+};
+
+// The keys requested from one of the maps of a SequenceExample, and their
+// values.  Keys requested more than once share a slot.
+class FeatureSlots {
+ public:
+  size_t Add(StringPiece key) {
+    auto it = index_.find(key);
+    if (it != index_.end()) return it->second;
+    const size_t slot = found_.size();
+    index_[key] = slot;
+    found_.emplace_back();
+    return slot;
+  }
+
+  const FoundFeature& Get(size_t slot) const { return found_[slot]; }
+
+  // Parses the body of a Features or FeatureLists message, whose field 1 is a
+  // map from string to message, and keeps the values of the requested keys.
+  // As in protobuf, if a key appears several times the last value wins.
+  bool ParseMap(StringPiece serialized) {
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+    EnableAliasing(&stream);
+    while (!stream.ExpectAtEnd()) {
+      if (!stream.ExpectTag(kDelimitedTag(1))) {
+        if (!SkipExtraneousTag(&stream)) return false;
+        continue;
+      }
+      parsed::FeatureMapEntry entry;
+      if (!ParseFeatureMapEntry(&stream, &entry)) return false;
+      auto it = index_.find(entry.first);
+      if (it != index_.end()) {
+        found_[it->second].found = true;
+        found_[it->second].serialized = entry.second.GetSerialized();
+      }
+    }
+    return true;
+  }
+
+ private:
+  gtl::FlatMap<StringPiece, size_t, StringPiece::Hasher> index_;
+  std::vector<FoundFeature> found_;
+};
+
+bool ParseSequenceExample(StringPiece serialized, FeatureSlots* context,
+                          FeatureSlots* feature_lists) {
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  // Like a merge of several messages, concatenated SequenceExamples merge
+  // their maps.
+  while (!stream.ExpectAtEnd()) {
+    StringPiece map;
+    if (stream.ExpectTag(kDelimitedTag(1))) {
+      if (!ParseString(&stream, &map) || !context->ParseMap(map)) {
+        return false;
+      }
+    } else if (stream.ExpectTag(kDelimitedTag(2))) {
+      if (!ParseString(&stream, &map) || !feature_lists->ParseMap(map)) {
+        return false;
+      }
+    } else if (!SkipExtraneousTag(&stream)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls fn on each serialized Feature of a serialized FeatureList, stopping
+// when fn returns an error.
+template <typename Fn>
+Status ForEachFeature(StringPiece feature_list, const Status& parse_error,
+                      Fn fn) {
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(feature_list.data()),
+      feature_list.size());
+  EnableAliasing(&stream);
+  while (!stream.ExpectAtEnd()) {
+    StringPiece feature;
+    if (!stream.ExpectTag(kDelimitedTag(1)) ||
+        !ParseString(&stream, &feature)) {
+      return parse_error;
+    }
+    TF_RETURN_IF_ERROR(fn(feature));
+  }
+  return Status::OK();
+}
+
+// Reads the data type of a Feature, DT_INVALID if its kind is not set.  Fails
+// unless the Feature is empty or holds exactly one list, which is what
+// protobuf serializers produce.
+bool ParseFeatureDataType(parsed::Feature* feature, DataType* dtype) {
+  if (!feature->ParseDataType(dtype).ok()) return false;
+  if (*dtype == DT_INVALID) return true;
+  const StringPiece list = feature->GetSerialized();
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(list.data()), list.size());
+  uint32 length;
+  if (!stream.ReadVarint32(&length)) return false;
+  return static_cast<size_t>(stream.CurrentPosition()) + length == list.size();
+}
+
+// Counts the values in the list of a Feature after ParseFeatureDataType,
+// without decoding or copying them.
+bool CountFeatureValues(const parsed::Feature& feature, DataType dtype,
+                        int64* count) {
+  *count = 0;
+  if (dtype == DT_INVALID) return true;
+  const StringPiece list = feature.GetSerialized();
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(list.data()), list.size());
+  EnableAliasing(&stream);
+  uint32 length;
+  if (!stream.ReadVarint32(&length)) return false;
+  auto limit = stream.PushLimit(length);
+  while (!stream.ExpectAtEnd()) {
+    const uint32 tag = stream.ReadTag();
+    if (tag == kDelimitedTag(1)) {
+      uint32 bytes_length;
+      if (!stream.ReadVarint32(&bytes_length)) return false;
+      if (dtype == DT_STRING) {
+        ++*count;
+      } else if (dtype == DT_FLOAT) {
+        // Packed floats.
+        if (bytes_length % sizeof(float) != 0) return false;
+        *count += bytes_length / sizeof(float);
+      } else if (bytes_length > 0) {
+        // Packed varints: each of them ends with the only one of its bytes
+        // that has the top bit clear.
+        const void* data;
+        int size;
+        if (!stream.GetDirectBufferPointer(&data, &size) ||
+            static_cast<uint32>(size) < bytes_length) {
+          return false;
+        }
+        const uint8* bytes = static_cast<const uint8*>(data);
+        for (uint32 i = 0; i < bytes_length; ++i) {
+          *count += (bytes[i] & 0x80) == 0;
+        }
+      }
+      if (!stream.Skip(bytes_length)) return false;
+    } else if (tag == kFixed32Tag(1) && dtype == DT_FLOAT) {
+      uint32 unused;
+      if (!stream.ReadLittleEndian32(&unused)) return false;
+      ++*count;
+    } else if (tag == kVarintTag(1) && dtype == DT_INT64) {
+      protobuf_uint64 unused;
+      if (!stream.ReadVarint64(&unused)) return false;
+      ++*count;
+    } else {
+      return false;
+    }
+  }
+  stream.PopLimit(limit);
+  return true;
+}
+
+template <typename T>
+bool ParseFeatureValues(parsed::Feature* feature, LimitedArraySlice<T>* slice);
+
+template <>
+bool ParseFeatureValues<int64>(parsed::Feature* feature,
+                               LimitedArraySlice<int64>* slice) {
+  return feature->ParseInt64List(slice);
+}
+template <>
+bool ParseFeatureValues<float>(parsed::Feature* feature,
+                               LimitedArraySlice<float>* slice) {
+  return feature->ParseFloatList(slice);
+}
+template <>
+bool ParseFeatureValues<string>(parsed::Feature* feature,
+                                LimitedArraySlice<string>* slice) {
+  return feature->ParseBytesList(slice);
+}
+
+// Parses the values of a Feature into out[offset, offset + max_values), and
+// returns their number in *num_values.  Fails if there are more values.
+template <typename T>
+bool ParseFeatureValuesInto(parsed::Feature* feature, Tensor* out,
+                            int64 offset, int64 max_values,
+                            int64* num_values) {
+  LimitedArraySlice<T> slice(out->flat<T>().data() + offset, max_values);
+  if (!ParseFeatureValues<T>(feature, &slice)) return false;
+  *num_values = max_values - slice.EndDistance();
+  return slice.EndDistance() >= 0;
+}
+
+bool ParseFeatureValuesInto(parsed::Feature* feature, DataType dtype,
+                            Tensor* out, int64 offset, int64 max_values,
+                            int64* num_values) {
+  switch (dtype) {
+    case DT_INT64:
+      return ParseFeatureValuesInto<int64>(feature, out, offset, max_values,
+                                           num_values);
+    case DT_FLOAT:
+      return ParseFeatureValuesInto<float>(feature, out, offset, max_values,
+                                           num_values);
+    case DT_STRING:
+      return ParseFeatureValuesInto<string>(feature, out, offset, max_values,
+                                            num_values);
+    default:
+      return false;
+  }
+}
+
+// Parses a Feature holding exactly row_size values of type dtype into row
+// `row` of out.
+Status ParseDenseFeature(StringPiece serialized, DataType dtype, int64 row,
+                         int64 row_size,
+                         const std::function<Status(StringPiece)>& error,
+                         Tensor* out) {
+  parsed::Feature feature(serialized);
+  DataType feature_dtype;
+  if (!ParseFeatureDataType(&feature, &feature_dtype)) {
+    return error("Can't parse serialized SequenceExample.");
+  }
+  if (feature_dtype != dtype) {
+    return error("Data types don't match.");
+  }
+  int64 num_values;
+  if (!ParseFeatureValuesInto(&feature, dtype, out, row * row_size, row_size,
+                              &num_values) ||
+      num_values != row_size) {
+    return error("Number of values != expected.");
+  }
+  return Status::OK();
+}
+
+// Parses the values of the Features of a feature list into a sparse tensor
+// whose indices are (feature, value).  Features whose kind is not set have no
+// values.
+Status ParseSparseFeatureList(StringPiece feature_list, DataType dtype,
+                              const std::function<Status(StringPiece)>& error,
+                              Tensor* indices, Tensor* values, Tensor* shape) {
+  const Status parse_error = error("Can't parse serialized SequenceExample.");
+  int64 num_features = 0;
+  int64 total_num_values = 0;
+  int64 max_num_values = 0;
+  TF_RETURN_IF_ERROR(
+      ForEachFeature(feature_list, parse_error, [&](StringPiece serialized) {
+        parsed::Feature feature(serialized);
+        DataType feature_dtype;
+        int64 num_values;
+        if (!ParseFeatureDataType(&feature, &feature_dtype) ||
+            !CountFeatureValues(feature, feature_dtype, &num_values)) {
+          return parse_error;
+        }
+        if (feature_dtype != DT_INVALID && feature_dtype != dtype) {
+          return error("Data types don't match.");
+        }
+        ++num_features;
+        total_num_values += num_values;
+        max_num_values = std::max(max_num_values, num_values);
+        return Status::OK();
+      }));
+
+  *indices = Tensor(DT_INT64, TensorShape({total_num_values, 2}));
+  *values = Tensor(dtype, TensorShape({total_num_values}));
+  *shape = Tensor(DT_INT64, TensorShape({2}));
+  shape->vec<int64>()(0) = num_features;
+  shape->vec<int64>()(1) = max_num_values;
+
+  auto indices_t = indices->matrix<int64>();
+  int64 t = 0;
+  int64 offset = 0;
+  return ForEachFeature(
+      feature_list, parse_error, [&](StringPiece serialized) {
+        parsed::Feature feature(serialized);
+        DataType feature_dtype;
+        if (!ParseFeatureDataType(&feature, &feature_dtype)) {
+          return parse_error;
+        }
+        int64 num_values = 0;
+        if (feature_dtype != DT_INVALID &&
+            !ParseFeatureValuesInto(&feature, dtype, values, offset,
+                                    total_num_values - offset, &num_values)) {
+          return parse_error;
+        }
+        for (int64 j = 0; j < num_values; ++j) {
+          indices_t(offset + j, 0) = t;
+          indices_t(offset + j, 1) = j;
+        }
+        offset += num_values;
+        ++t;
+        return Status::OK();
+      });
+}
+
+}  // namespace
+
+Status FastParseSingleSequenceExample(const SequenceConfig& config,
+                                      const string& serialized,
+                                      const string& example_name,
+                                      thread::ThreadPool* thread_pool,
+                                      Result* context_result,
+                                      Result* feature_list_result) {
+  DCHECK(context_result != nullptr);
+  DCHECK(feature_list_result != nullptr);
+  for (const auto& c : config.context_dense) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (const auto& c : config.context_sparse) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (const auto& c : config.feature_list_dense) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (const auto& c : config.feature_list_sparse) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+
+  FeatureSlots context;
+  std::vector<size_t> context_dense_slots;
+  for (const auto& c : config.context_dense) {
+    context_dense_slots.push_back(context.Add(c.feature_name));
+  }
+  std::vector<size_t> context_sparse_slots;
+  for (const auto& c : config.context_sparse) {
+    context_sparse_slots.push_back(context.Add(c.feature_name));
+  }
+  FeatureSlots feature_lists;
+  std::vector<size_t> feature_list_dense_slots;
+  for (const auto& c : config.feature_list_dense) {
+    feature_list_dense_slots.push_back(feature_lists.Add(c.feature_name));
+  }
+  std::vector<size_t> feature_list_sparse_slots;
+  for (const auto& c : config.feature_list_sparse) {
+    feature_list_sparse_slots.push_back(feature_lists.Add(c.feature_name));
+  }
+
+  if (!ParseSequenceExample(serialized, &context, &feature_lists)) {
+    return errors::InvalidArgument("Could not parse example input, value: '",
+                                   serialized, "'");
+  }
+
+  // Context Dense -------------------------------------------------------------
+  for (size_t d = 0; d < config.context_dense.size(); ++d) {
+    const auto& c = config.context_dense[d];
+    const FoundFeature& feature = context.Get(context_dense_slots[d]);
+    if (!feature.found) {
+      if (c.default_value.NumElements() == 0) {
+        return errors::InvalidArgument(
+            "Name: ", example_name, ", Context feature '", c.feature_name,
+            "' is required but could not be found.");
+      }
+      context_result->dense_values.push_back(c.default_value);
+      continue;
+    }
+    auto error = [&](StringPiece suffix) {
+      return errors::InvalidArgument("Name: ", example_name,
+                                     ", Context feature: ", c.feature_name,
+                                     ".  ", suffix);
+    };
+    Tensor out(c.dtype, c.shape);
+    TF_RETURN_IF_ERROR(ParseDenseFeature(feature.serialized, c.dtype, 0,
+                                         c.shape.num_elements(), error, &out));
+    context_result->dense_values.push_back(out);
+  }
+
+  // Context Sparse ------------------------------------------------------------
+  for (size_t d = 0; d < config.context_sparse.size(); ++d) {
+    const auto& c = config.context_sparse[d];
+    const FoundFeature& found = context.Get(context_sparse_slots[d]);
+    auto error = [&](StringPiece suffix) {
+      return errors::InvalidArgument("Name: ", example_name,
+                                     ", Context feature: ", c.feature_name,
+                                     ".  ", suffix);
+    };
+    parsed::Feature feature(found.serialized);
+    DataType feature_dtype = DT_INVALID;
+    int64 num_values = 0;
+    if (found.found &&
+        (!ParseFeatureDataType(&feature, &feature_dtype) ||
+         !CountFeatureValues(feature, feature_dtype, &num_values))) {
+      return error("Can't parse serialized SequenceExample.");
+    }
+    if (feature_dtype != DT_INVALID && feature_dtype != c.dtype) {
+      return error("Data types don't match.");
+    }
+    Tensor indices(DT_INT64, TensorShape({num_values, 1}));
+    Tensor values(c.dtype, TensorShape({num_values}));
+    Tensor shape(DT_INT64, TensorShape({1}));
+    shape.vec<int64>()(0) = num_values;
+    int64 num_parsed = 0;
+    if (num_values > 0 &&
+        (!ParseFeatureValuesInto(&feature, c.dtype, &values, 0, num_values,
+                                 &num_parsed) ||
+         num_parsed != num_values)) {
+      return error("Can't parse serialized SequenceExample.");
+    }
+    std::iota(indices.flat<int64>().data(),
+              indices.flat<int64>().data() + num_values, 0);
+    context_result->sparse_indices.push_back(indices);
+    context_result->sparse_values.push_back(values);
+    context_result->sparse_shapes.push_back(shape);
+  }
+
+  // Feature Lists -------------------------------------------------------------
+  const size_t num_dense = config.feature_list_dense.size();
+  const size_t num_sparse = config.feature_list_sparse.size();
+  feature_list_result->dense_values.resize(num_dense);
+  feature_list_result->sparse_indices.resize(num_sparse);
+  feature_list_result->sparse_values.resize(num_sparse);
+  feature_list_result->sparse_shapes.resize(num_sparse);
+  std::vector<Status> status_of_feature_list(num_dense + num_sparse);
+
+  auto ParseDenseFeatureList = [&](size_t d) -> Status {
+    const auto& c = config.feature_list_dense[d];
+    const FoundFeature& found =
+        feature_lists.Get(feature_list_dense_slots[d]);
+    if (!found.found && !c.missing_assumed_empty) {
+      return errors::InvalidArgument(
+          "Name: ", example_name, ", Feature list '", c.feature_name,
+          "' is required but could not be found.");
+    }
+    auto error = [&](StringPiece suffix) {
+      return errors::InvalidArgument("Name: ", example_name,
+                                     ", Feature list: ", c.feature_name,
+                                     ".  ", suffix);
+    };
+    const Status parse_error = error("Can't parse serialized SequenceExample.");
+    int64 num_features = 0;
+    TF_RETURN_IF_ERROR(ForEachFeature(found.serialized, parse_error,
+                                      [&num_features](StringPiece) {
+                                        ++num_features;
+                                        return Status::OK();
+                                      }));
+    TensorShape out_shape({num_features});
+    out_shape.AppendShape(c.shape);
+    Tensor out(c.dtype, out_shape);
+    int64 t = 0;
+    TF_RETURN_IF_ERROR(ForEachFeature(
+        found.serialized, parse_error, [&](StringPiece serialized) {
+          return ParseDenseFeature(serialized, c.dtype, t++,
+                                   c.shape.num_elements(), error, &out);
+        }));
+    feature_list_result->dense_values[d] = out;
+    return Status::OK();
+  };
+
+  auto ParseFeatureList = [&](size_t i) {
+    if (i < num_dense) {
+      status_of_feature_list[i] = ParseDenseFeatureList(i);
+      return;
+    }
+    const size_t d = i - num_dense;
+    const auto& c = config.feature_list_sparse[d];
+    auto error = [&](StringPiece suffix) {
+      return errors::InvalidArgument("Name: ", example_name,
+                                     ", Feature list: ", c.feature_name,
+                                     ".  ", suffix);
+    };
+    status_of_feature_list[i] = ParseSparseFeatureList(
+        feature_lists.Get(feature_list_sparse_slots[d]).serialized, c.dtype,
+        error, &feature_list_result->sparse_indices[d],
+        &feature_list_result->sparse_values[d],
+        &feature_list_result->sparse_shapes[d]);
+  };
+
+  ParallelFor(ParseFeatureList, num_dense + num_sparse,
+              serialized.size() >= kMinParallelSequenceExampleBytes
+                  ? thread_pool
+                  : nullptr);
+
+  for (const Status& status : status_of_feature_list) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
 }  // namespace example
 }  // namespace tensorflow
@@ -79,6 +79,52 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<string> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
+// FastParseSingleSequenceExampleConfig defines how to parse the context and
+// the feature lists of a SequenceExample.  The fields correspond exactly to
+// the inputs and attributes of the ParseSingleSequenceExample op.
+// Documentation is available in: tensorflow/core/ops/parsing_ops.cc
+struct FastParseSingleSequenceExampleConfig {
+  struct ContextDense {
+    string feature_name;
+    DataType dtype;
+    TensorShape shape;
+    // Empty if the feature is required.
+    Tensor default_value;
+  };
+
+  struct FeatureListDense {
+    string feature_name;
+    DataType dtype;
+    // The shape of each feature of the list.
+    TensorShape shape;
+    bool missing_assumed_empty;
+  };
+
+  struct Sparse {
+    string feature_name;
+    DataType dtype;
+  };
+
+  std::vector<ContextDense> context_dense;
+  std::vector<Sparse> context_sparse;
+  std::vector<FeatureListDense> feature_list_dense;
+  std::vector<Sparse> feature_list_sparse;
+};
+
+// Parses a serialized SequenceExample proto into the outputs of the
+// ParseSingleSequenceExample op, without deserializing it into messages: the
+// values are parsed straight into the output tensors.  The feature lists are
+// parsed in parallel on thread_pool, which may be null, when the example is
+// large enough.
+// Only the encodings produced by protobuf serializers are accepted, and the
+// error messages are terse.  Callers are expected to fall back to the full
+// protobuf parser if this returns an error.
+Status FastParseSingleSequenceExample(
+    const FastParseSingleSequenceExampleConfig& config,
+    const string& serialized, const string& example_name,
+    thread::ThreadPool* thread_pool, Result* context_result,
+    Result* feature_list_result);
+
 // This function parses serialized Example and populates given example.
 // It uses the same specialized parser as FastParseExample which is efficient.
 // But then constructs Example which is relatively slow.
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -372,6 +374,159 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+SequenceExample MakeSequenceExample() {
+  SequenceExample example;
+  auto& context = *example.mutable_context()->mutable_feature();
+  context["length"].mutable_int64_list()->add_value(3);
+  context["weights"].mutable_float_list()->add_value(0.5);
+  context["weights"].mutable_float_list()->add_value(-1.5);
+  context["tags"].mutable_bytes_list()->add_value("a");
+  context["tags"].mutable_bytes_list()->add_value("bc");
+
+  auto& feature_lists =
+      *example.mutable_feature_lists()->mutable_feature_list();
+  auto& ids = feature_lists["ids"];
+  for (int t = 0; t < 3; ++t) {
+    auto* values = ids.add_feature()->mutable_int64_list();
+    values->add_value(10 * t);
+    values->add_value(10 * t + 1);
+  }
+  auto& words = feature_lists["words"];
+  words.add_feature()->mutable_bytes_list()->add_value("x");
+  words.add_feature();
+  words.add_feature()->mutable_bytes_list()->add_value("y");
+  words.mutable_feature(2)->mutable_bytes_list()->add_value("zz");
+  return example;
+}
+
+FastParseSingleSequenceExampleConfig MakeSequenceConfig() {
+  FastParseSingleSequenceExampleConfig config;
+  config.context_dense.push_back(
+      {"length", DT_INT64, TensorShape({}), Tensor()});
+  Tensor default_value(DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&default_value, {1, 2});
+  config.context_dense.push_back(
+      {"missing", DT_FLOAT, TensorShape({2}), default_value});
+  config.context_sparse.push_back({"weights", DT_FLOAT});
+  config.context_sparse.push_back({"tags", DT_STRING});
+  config.feature_list_dense.push_back(
+      {"ids", DT_INT64, TensorShape({2}), false});
+  config.feature_list_dense.push_back(
+      {"missing_list", DT_FLOAT, TensorShape({3}), true});
+  config.feature_list_sparse.push_back({"words", DT_STRING});
+  return config;
+}
+
+TEST(FastParseSingleSequenceExample, MatchesDeserialization) {
+  Result context;
+  Result feature_lists;
+  TF_EXPECT_OK(FastParseSingleSequenceExample(
+      MakeSequenceConfig(), Serialize(MakeSequenceExample()), "example",
+      nullptr, &context, &feature_lists));
+
+  ASSERT_EQ(2, context.dense_values.size());
+  test::ExpectTensorEqual<int64>(test::AsScalar<int64>(3),
+                                 context.dense_values[0]);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1, 2}),
+                                 context.dense_values[1]);
+
+  ASSERT_EQ(2, context.sparse_values.size());
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({0, 1}, {2, 1}),
+                                 context.sparse_indices[0]);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0.5, -1.5}),
+                                 context.sparse_values[0]);
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({2}),
+                                 context.sparse_shapes[0]);
+  test::ExpectTensorEqual<string>(test::AsTensor<string>({"a", "bc"}),
+                                  context.sparse_values[1]);
+
+  ASSERT_EQ(2, feature_lists.dense_values.size());
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>({0, 1, 10, 11, 20, 21}, {3, 2}),
+      feature_lists.dense_values[0]);
+  EXPECT_EQ(TensorShape({0, 3}), feature_lists.dense_values[1].shape());
+
+  ASSERT_EQ(1, feature_lists.sparse_values.size());
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>({0, 0, 2, 0, 2, 1}, {3, 2}),
+      feature_lists.sparse_indices[0]);
+  test::ExpectTensorEqual<string>(test::AsTensor<string>({"x", "y", "zz"}),
+                                  feature_lists.sparse_values[0]);
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({3, 2}),
+                                 feature_lists.sparse_shapes[0]);
+}
+
+TEST(FastParseSingleSequenceExample, ConcatenatedExamplesMerge) {
+  // The second example overrides "length", and so does its "ids".
+  SequenceExample second;
+  (*second.mutable_context()->mutable_feature())["length"]
+      .mutable_int64_list()
+      ->add_value(7);
+  (*second.mutable_feature_lists()->mutable_feature_list())["ids"]
+      .add_feature()
+      ->mutable_int64_list()
+      ->add_value(5);
+  (*second.mutable_feature_lists()->mutable_feature_list())["ids"]
+      .mutable_feature(0)
+      ->mutable_int64_list()
+      ->add_value(6);
+
+  Result context;
+  Result feature_lists;
+  TF_EXPECT_OK(FastParseSingleSequenceExample(
+      MakeSequenceConfig(),
+      Serialize(MakeSequenceExample()) + Serialize(second), "example",
+      nullptr, &context, &feature_lists));
+  test::ExpectTensorEqual<int64>(test::AsScalar<int64>(7),
+                                 context.dense_values[0]);
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({5, 6}, {1, 2}),
+                                 feature_lists.dense_values[0]);
+}
+
+TEST(FastParseSingleSequenceExample, Errors) {
+  SequenceExample example = MakeSequenceExample();
+  Result context;
+  Result feature_lists;
+
+  // A required context feature is missing.
+  FastParseSingleSequenceExampleConfig config = MakeSequenceConfig();
+  config.context_dense[1].default_value = Tensor();
+  EXPECT_FALSE(FastParseSingleSequenceExample(config, Serialize(example),
+                                              "example", nullptr, &context,
+                                              &feature_lists)
+                   .ok());
+
+  // A required feature list is missing.
+  config = MakeSequenceConfig();
+  config.feature_list_dense[1].missing_assumed_empty = false;
+  EXPECT_FALSE(FastParseSingleSequenceExample(config, Serialize(example),
+                                              "example", nullptr, &context,
+                                              &feature_lists)
+                   .ok());
+
+  // The data type of a feature list doesn't match.
+  config = MakeSequenceConfig();
+  config.feature_list_sparse[0].dtype = DT_INT64;
+  EXPECT_FALSE(FastParseSingleSequenceExample(config, Serialize(example),
+                                              "example", nullptr, &context,
+                                              &feature_lists)
+                   .ok());
+
+  // A dense feature has the wrong number of values.
+  config = MakeSequenceConfig();
+  config.feature_list_dense[0].shape = TensorShape({3});
+  EXPECT_FALSE(FastParseSingleSequenceExample(config, Serialize(example),
+                                              "example", nullptr, &context,
+                                              &feature_lists)
+                   .ok());
+
+  // The input is not a SequenceExample.
+  EXPECT_FALSE(FastParseSingleSequenceExample(MakeSequenceConfig(),
+                                              "\x0a\x05", "example", nullptr,
+                                              &context, &feature_lists)
+                   .ok());
+}
+
 }  // namespace
 
 }  // namespace example
@@ -454,6 +454,31 @@ GPU_ATOMIC_WRAPPER(Max, uint64) {
 }
 #endif
 
+// Custom implementations of atomicMax for float and double, which CUDA only
+// provides for integers.
+GPU_ATOMIC_WRAPPER(Max, float) {
+  int32* address_as_int = reinterpret_cast<int32*>(address);
+  int32 old = *address_as_int, assumed;
+  do {
+    assumed = old;
+    old = atomicCAS(address_as_int, assumed,
+                    __float_as_int(fmaxf(val, __int_as_float(assumed))));
+  } while (assumed != old);
+  return __int_as_float(old);
+}
+
+GPU_ATOMIC_WRAPPER(Max, double) {
+  uint64* address_as_ull = reinterpret_cast<uint64*>(address);
+  uint64 old = *address_as_ull, assumed;
+  do {
+    assumed = old;
+    old = atomicCAS(
+        address_as_ull, assumed,
+        __double_as_longlong(fmax(val, __longlong_as_double(assumed))));
+  } while (assumed != old);
+  return __longlong_as_double(old);
+}
+
 // Custom implementation of atomicAdd for double.
 // This implementation is copied from CUDA manual.
 GPU_ATOMIC_WRAPPER(Add, double) {
@@ -173,6 +173,23 @@ Status MemmappedFileSystem::RenameFile(const string& filename_from,
   return errors::Unimplemented("memmapped format doesn't support RenameFile");
 }
 
+Status MemmappedFileSystem::ParseProtobuf(const string& filename,
+                                          protobuf::MessageLite* proto) {
+  if (!mapped_memory_) {
+    return errors::FailedPrecondition("MemmappedEnv is not initialized");
+  }
+  const auto dir_element = directory_.find(filename);
+  if (dir_element == directory_.end()) {
+    return errors::NotFound("Region ", filename, " is not found");
+  }
+  if (!ParseProtoUnlimited(proto,
+                           GetMemoryWithOffset(dir_element->second.offset),
+                           dir_element->second.length)) {
+    return errors::DataLoss("Can't parse ", filename, " as binary proto");
+  }
+  return Status::OK();
+}
+
 const void* MemmappedFileSystem::GetMemoryWithOffset(uint64 offset) const {
   return reinterpret_cast<const uint8*>(mapped_memory_->data()) + offset;
 }
@@ -184,6 +201,7 @@ constexpr char* MemmappedFileSystem::kMemmappedPackageDefaultGraphDef;
 constexpr char MemmappedFileSystem::kMemmappedPackagePrefix[];
 constexpr char MemmappedFileSystem::kMemmappedPackageDefaultGraphDef[];
 #endif
+constexpr uint64 MemmappedFileSystem::kTensorAlignment;
 
 Status MemmappedFileSystem::InitializeFromFile(Env* env,
                                                const string& filename) {
@@ -294,4 +312,13 @@ Status MemmappedEnv::InitializeFromFile(const string& package_filename) {
   return status;
 }
 
+Status MemmappedEnv::ParseProtobuf(const string& filename,
+                                   protobuf::MessageLite* proto) {
+  if (!memmapped_file_system_) {
+    return errors::FailedPrecondition(
+        "MemmappedEnv is not initialized from a file.");
+  }
+  return memmapped_file_system_->ParseProtobuf(filename, proto);
+}
+
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
 
@@ -37,8 +38,9 @@ namespace tensorflow {
 // - the directory starts from the encoded offset and is saved proto
 // MemmappedFileSystemDirectory with names and offsets to the regions.
 // - at the offsets in the directory the file regions are stored. Tensor regions
-// are aligned such way that when the package mapped to RAM they have the right
-// offset to be used by ImmutableConst operator.
+// are aligned to kTensorAlignment, so that when the package mapped to RAM they
+// have the right offset to be used by ImmutableConst operator with any
+// allocator alignment.
 //
 // Region naming:
 // Region naming is up to the application, all of them starts from
@@ -68,6 +70,10 @@ class MemmappedFileSystem : public FileSystem {
 #endif
       "memmapped_package://.";
 
+  // Alignment of the tensor regions in the package. A multiple of
+  // Allocator::kAllocatorAlignment in all builds.
+  static constexpr uint64 kTensorAlignment = 64;
+
   MemmappedFileSystem();
   ~MemmappedFileSystem() override = default;
   Status FileExists(const string& fname) override;
@@ -98,6 +104,10 @@ class MemmappedFileSystem : public FileSystem {
   // Initializes filesystem from a file in memmapped format.
   Status InitializeFromFile(Env* env, const string& filename);
 
+  // Parses the protobuf saved in the region filename straight from the mapped
+  // memory, as one contiguous buffer.
+  Status ParseProtobuf(const string& filename, protobuf::MessageLite* proto);
+
   // Checks if the filename has a correct prefix.
   static bool IsMemmappedPackageFilename(const string& filename);
 
@@ -130,6 +140,10 @@ class MemmappedEnv : public EnvWrapper {
   Status GetRegisteredFileSystemSchemes(std::vector<string>* schemes) override;
   Status InitializeFromFile(const string& filename);
 
+  // Parses a protobuf from the package, e.g. the default graph, faster than
+  // ReadBinaryProto. See MemmappedFileSystem::ParseProtobuf.
+  Status ParseProtobuf(const string& filename, protobuf::MessageLite* proto);
+
  protected:
   std::unique_ptr<MemmappedFileSystem> memmapped_file_system_;
 };
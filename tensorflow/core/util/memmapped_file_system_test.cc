@@ -78,6 +78,12 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
       ReadBinaryProto(&memmapped_env, kProtoFileName, &test_graph_def));
   EXPECT_EQ(kTestGraphDefVersion, test_graph_def.versions().producer());
   EXPECT_EQ(kTestGraphDefVersion, test_graph_def.versions().min_consumer());
+  // Parsing it straight from the mapped memory gives the same proto.
+  GraphDef parsed_graph_def;
+  TF_EXPECT_OK(memmapped_env.ParseProtobuf(kProtoFileName, &parsed_graph_def));
+  EXPECT_EQ(test_graph_def.DebugString(), parsed_graph_def.DebugString());
+  EXPECT_EQ(error::NOT_FOUND,
+            memmapped_env.ParseProtobuf("bla-bla", &parsed_graph_def).code());
   // Check that we can correctly get a tensor memory.
   std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
   TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor2FileName,
@@ -85,6 +91,9 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
 
   // The memory region can be bigger but not less than Tensor size.
   ASSERT_GE(memory_region->length(), test_tensor.TotalBytes());
+  // Tensors after protos of any size are aligned.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(memory_region->data()) %
+                   MemmappedFileSystem::kTensorAlignment);
   EXPECT_EQ(test_tensor.tensor_data(),
             StringPiece(static_cast<const char*>(memory_region->data()),
                         test_tensor.TotalBytes()));
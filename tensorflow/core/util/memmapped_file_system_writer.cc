@@ -46,7 +46,11 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
         "MemmappedEnvWritter: saving tensor with 0 size");
   }
   // Adds pad for correct alignment after memmapping.
-  TF_RETURN_IF_ERROR(AdjustAlignment(Allocator::kAllocatorAlignment));
+  static_assert(MemmappedFileSystem::kTensorAlignment %
+                        Allocator::kAllocatorAlignment ==
+                    0,
+                "Memmapped tensors must be aligned for the allocator");
+  TF_RETURN_IF_ERROR(AdjustAlignment(MemmappedFileSystem::kTensorAlignment));
   AddToDirectoryElement(element_name);
   const auto result = output_file_->Append(tensor_data);
   if (result.ok()) {
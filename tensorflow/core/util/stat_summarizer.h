@@ -148,6 +148,18 @@ class StatSummarizer {
     BY_TYPE,
   };
 
+  // The stats of a node over all the runs.
+  struct Detail {
+    string name;
+    string type;
+    int64 run_order;
+    Stat<int64> start_us;
+    Stat<int64> rel_end_us;
+    Stat<int64> mem_used;
+    std::vector<TensorDescription> outputs;
+    int64 times_called;
+  };
+
   explicit StatSummarizer(const StatSummarizerOptions& options);
 
   // Deprecated: Use StatSummarizer(const StatSummarizerOptions&) instead. The
@@ -191,18 +203,11 @@ class StatSummarizer {
   // Returns stats of total microseconds spent by all nodes in each run.
   const Stat<int64>& run_total_us() const { return run_total_us_; }
 
- private:
-  struct Detail {
-    string name;
-    string type;
-    int64 run_order;
-    Stat<int64> start_us;
-    Stat<int64> rel_end_us;
-    Stat<int64> mem_used;
-    std::vector<TensorDescription> outputs;
-    int64 times_called;
-  };
+  // Returns the stats of each node, by name. GPU kernels and memcpys have a
+  // " [Kernel]" or " [MemCpy]" suffix.
+  const std::map<std::string, Detail>& GetDetails() const { return details_; }
 
+ private:
   void Validate(const Detail* detail, const NodeExecStats& ns) const;
 
   void OrderNodesByMetric(SortingMetric sorting_metric,
@@ -0,0 +1,176 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/tensor_slice_util.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Copies "slice_val", the values of "slice_spec", into the full tensor "val".
+Status CopySliceToTensor(const TensorSlice& slice_spec, const Tensor& slice_val,
+                         Tensor* val) {
+  const TensorShape& full_shape = val->shape();
+  const TensorSlice full_slice(full_shape.dims());
+  switch (val->dtype()) {
+#define HANDLE_COPY(T)                                                  \
+  case DataTypeToEnum<T>::value:                                        \
+    CHECK(CopyDataFromTensorSliceToTensorSlice(                         \
+        full_shape, slice_spec, full_slice, slice_val.flat<T>().data(), \
+        val->flat<T>().data()));                                        \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    default:
+      return errors::InvalidArgument("Dtype ", DataTypeString(val->dtype()),
+                                     " not supported in delta bundles.");
+  }
+#undef HANDLE_COPY
+  return Status::OK();
+}
+
+}  // namespace
+
+DeltaBundleWriter::DeltaBundleWriter(Env* env, StringPiece prefix)
+    : writer_(env, prefix) {}
+
+Status DeltaBundleWriter::Add(StringPiece key, const Tensor& val) {
+  return writer_.Add(key, val);
+}
+
+Status DeltaBundleWriter::AddSlice(StringPiece key,
+                                   const TensorShape& full_tensor_shape,
+                                   const TensorSlice& slice_spec,
+                                   const Tensor& slice_tensor) {
+  return writer_.AddSlice(key, full_tensor_shape, slice_spec, slice_tensor);
+}
+
+Status DeltaBundleWriter::AddDirtyRows(StringPiece key, const Tensor& val,
+                                       const std::vector<bool>& dirty_rows) {
+  if (val.dims() < 1) {
+    return errors::InvalidArgument("Dirty rows of a scalar tensor: ", key);
+  }
+  const int64 num_rows = val.dim_size(0);
+  if (static_cast<int64>(dirty_rows.size()) != num_rows) {
+    return errors::InvalidArgument("Tensor ", key, " has ", num_rows,
+                                   " rows, but got ", dirty_rows.size(),
+                                   " dirty row flags");
+  }
+  int64 start = 0;
+  while (start < num_rows) {
+    if (!dirty_rows[start]) {
+      ++start;
+      continue;
+    }
+    int64 end = start + 1;
+    while (end < num_rows && dirty_rows[end]) {
+      ++end;
+    }
+    TensorSlice slice_spec(val.dims());
+    slice_spec.set_start(0, start);
+    slice_spec.set_length(0, end - start);
+    TF_RETURN_IF_ERROR(
+        writer_.AddSlice(key, val.shape(), slice_spec, val.Slice(start, end)));
+    start = end;
+  }
+  return Status::OK();
+}
+
+Status DeltaBundleWriter::Finish() { return writer_.Finish(); }
+
+DeltaBundleReader::DeltaBundleReader(Env* env, StringPiece base_prefix,
+                                     gtl::ArraySlice<string> delta_prefixes) {
+  readers_.emplace_back(new BundleReader(env, base_prefix));
+  for (const string& delta_prefix : delta_prefixes) {
+    readers_.emplace_back(new BundleReader(env, delta_prefix));
+  }
+  for (const auto& reader : readers_) {
+    status_ = reader->status();
+    if (!status_.ok()) return;
+  }
+}
+
+Status DeltaBundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
+                                              TensorShape* shape) {
+  TF_CHECK_OK(status_);
+  for (int i = static_cast<int>(readers_.size()) - 1; i >= 0; --i) {
+    if (readers_[i]->Contains(key)) {
+      return readers_[i]->LookupDtypeAndShape(key, dtype, shape);
+    }
+  }
+  return errors::NotFound("Key ", key, " not found in checkpoint");
+}
+
+Status DeltaBundleReader::Lookup(StringPiece key, Tensor* val) {
+  TF_CHECK_OK(status_);
+  // The slices stored by each bundle, from the newest one that stores the
+  // tensor in full.  The base is always read in full, even if partitioned.
+  const int num_bundles = static_cast<int>(readers_.size());
+  std::vector<std::vector<TensorSlice>> slices(num_bundles);
+  int full = -1;
+  for (int i = num_bundles - 1; i >= 0; --i) {
+    if (!readers_[i]->Contains(key)) continue;
+    TF_RETURN_IF_ERROR(readers_[i]->LookupTensorSlices(key, &slices[i]));
+    if (i == 0 || slices[i].empty()) {
+      full = i;
+      break;
+    }
+  }
+  if (full < 0) {
+    return errors::NotFound("Key ", key,
+                            " not found in full in checkpoint or its deltas");
+  }
+  TF_RETURN_IF_ERROR(readers_[full]->Lookup(key, val));
+
+  for (int i = full + 1; i < num_bundles; ++i) {
+    if (slices[i].empty()) continue;
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(readers_[i]->LookupDtypeAndShape(key, &dtype, &shape));
+    if (dtype != val->dtype() || shape != val->shape()) {
+      return errors::InvalidArgument(
+          "Delta ", i, " of tensor ", key, " has dtype ", DataTypeString(dtype),
+          " and shape ", shape.DebugString(), ", expected ",
+          DataTypeString(val->dtype()), " and ", val->shape().DebugString());
+    }
+    for (const TensorSlice& slice_spec : slices[i]) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice_spec.SliceTensorShape(shape, &slice_shape));
+      if (slice_shape.num_elements() == 0) continue;
+      Tensor slice_val(dtype, slice_shape);
+      TF_RETURN_IF_ERROR(readers_[i]->LookupSlice(key, slice_spec, &slice_val));
+      TF_RETURN_IF_ERROR(CopySliceToTensor(slice_spec, slice_val, val));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta checkpoints on top of tensor bundles.
+//
+// A delta bundle is an ordinary tensor bundle that only stores what changed
+// since a previous bundle: modified tensors are stored as slices of their full
+// tensor (see BundleWriter::AddSlice()), and replaced tensors in full.
+// Tensors that did not change are not stored at all.  A checkpoint is then a
+// base bundle followed by a chain of delta bundles, each relative to the
+// previous one, which DeltaBundleReader merges on lookup.
+//
+// Since each delta bundle is a valid bundle, the chain can be compacted by
+// reading it with a DeltaBundleReader and writing a new base with a
+// BundleWriter.
+
+#ifndef TENSORFLOW_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Writes a delta bundle under "prefix".
+//
+// On construction, attempts to create a directory given by the dirname of
+// "prefix", so "status()" must be checked before calling any member functions.
+//
+// All threads accessing the same DeltaBundleWriter must synchronize.
+class DeltaBundleWriter {
+ public:
+  DeltaBundleWriter(Env* env, StringPiece prefix);
+
+  // Records that the tensor keyed by "key" is replaced by "val" in full.
+  Status Add(StringPiece key, const Tensor& val);
+
+  // Records that "slice_spec" of the tensor keyed by "key", whose full shape
+  // is "full_tensor_shape", now holds "slice_tensor".
+  Status AddSlice(StringPiece key, const TensorShape& full_tensor_shape,
+                  const TensorSlice& slice_spec, const Tensor& slice_tensor);
+
+  // Records the rows of "val", the current value of the tensor keyed by "key",
+  // that are marked in "dirty_rows".  "dirty_rows" has one element per index
+  // of the first dimension of "val".  Each run of consecutive dirty rows is
+  // stored as one slice.  Nothing is stored if no row is dirty.
+  Status AddDirtyRows(StringPiece key, const Tensor& val,
+                      const std::vector<bool>& dirty_rows);
+
+  // Finishes the writer and flushes.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  Status status() const { return writer_.status(); }
+
+ private:
+  BundleWriter writer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleWriter);
+};
+
+// Reads the tensors of the bundle "base_prefix" with the delta bundles
+// "delta_prefixes" applied in order.
+//
+// On construction, silently attempts to read the metadata of all the bundles.
+// If caller intends to call any function afterwards, "status()" must be
+// checked.
+// All threads accessing the same DeltaBundleReader must synchronize.
+class DeltaBundleReader {
+ public:
+  DeltaBundleReader(Env* env, StringPiece base_prefix,
+                    gtl::ArraySlice<string> delta_prefixes);
+
+  // Is ok() iff the construction of all the bundle readers is successful.
+  Status status() const { return status_; }
+
+  // Looks up the dtype and the shape of the tensor keyed by "key", in the
+  // newest bundle that contains it.
+  // REQUIRES: status().ok()
+  Status LookupDtypeAndShape(StringPiece key, DataType* dtype,
+                             TensorShape* shape) TF_MUST_USE_RESULT;
+
+  // Looks up the merged tensor keyed by "key": its value in the newest bundle
+  // that stores it in full, with the slices of the later deltas applied in
+  // order.  As in BundleReader::Lookup(), the caller must make sure "val" has
+  // the same shape and dtype as the stored tensor.
+  //
+  // Returns a NotFound error if no bundle stores the tensor in full.
+  // REQUIRES: status().ok()
+  Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+ private:
+  Status status_;
+  // The base bundle followed by the deltas, oldest first.
+  std::vector<std::unique_ptr<BundleReader>> readers_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
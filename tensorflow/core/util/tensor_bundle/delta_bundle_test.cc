@@ -0,0 +1,138 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+// A 5x2 table, whose row i holds {i * 10 + offset, i * 10 + offset + 1}.
+Tensor Table(float offset) {
+  Tensor t(DT_FLOAT, TensorShape({5, 2}));
+  auto matrix = t.matrix<float>();
+  for (int i = 0; i < 5; ++i) {
+    matrix(i, 0) = i * 10 + offset;
+    matrix(i, 1) = i * 10 + offset + 1;
+  }
+  return t;
+}
+
+TEST(DeltaBundleTest, MergesDeltaChain) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("base"));
+    TF_EXPECT_OK(writer.Add("table", Table(0)));
+    TF_EXPECT_OK(writer.Add("step", test::AsScalar<int64>(1)));
+    TF_EXPECT_OK(writer.Add("unchanged", test::AsTensor<int32>({1, 2})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // Rows 1, 2 and 4 changed.
+    DeltaBundleWriter writer(env, Prefix("delta_0"));
+    TF_ASSERT_OK(writer.status());
+    TF_EXPECT_OK(writer.AddDirtyRows("table", Table(100),
+                                     {false, true, true, false, true}));
+    TF_EXPECT_OK(writer.Add("step", test::AsScalar<int64>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // Row 4 changed again.
+    DeltaBundleWriter writer(env, Prefix("delta_1"));
+    TF_ASSERT_OK(writer.status());
+    TensorSlice row_4(2);
+    row_4.set_start(0, 4);
+    row_4.set_length(0, 1);
+    TF_EXPECT_OK(
+        writer.AddSlice("table", TensorShape({5, 2}), row_4,
+                        test::AsTensor<float>({-1, -2}, TensorShape({1, 2}))));
+    TF_EXPECT_OK(writer.AddDirtyRows("clean_table", Table(0),
+                                     std::vector<bool>(5, false)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  DeltaBundleReader reader(env, Prefix("base"),
+                           {Prefix("delta_0"), Prefix("delta_1")});
+  TF_ASSERT_OK(reader.status());
+
+  DataType dtype;
+  TensorShape shape;
+  TF_ASSERT_OK(reader.LookupDtypeAndShape("table", &dtype, &shape));
+  EXPECT_EQ(DT_FLOAT, dtype);
+  EXPECT_EQ(TensorShape({5, 2}), shape);
+
+  Tensor table(DT_FLOAT, shape);
+  TF_ASSERT_OK(reader.Lookup("table", &table));
+  test::ExpectTensorEqual<float>(
+      table,
+      test::AsTensor<float>({0, 1, 110, 111, 120, 121, 30, 31, -1, -2},
+                            TensorShape({5, 2})));
+
+  Tensor step(DT_INT64, TensorShape({}));
+  TF_ASSERT_OK(reader.Lookup("step", &step));
+  test::ExpectTensorEqual<int64>(step, test::AsScalar<int64>(2));
+
+  Tensor unchanged(DT_INT32, TensorShape({2}));
+  TF_ASSERT_OK(reader.Lookup("unchanged", &unchanged));
+  test::ExpectTensorEqual<int32>(unchanged, test::AsTensor<int32>({1, 2}));
+
+  // No row of "clean_table" was dirty, so it was not written.
+  Tensor missing(DT_FLOAT, TensorShape({5, 2}));
+  EXPECT_TRUE(errors::IsNotFound(reader.Lookup("clean_table", &missing)));
+}
+
+TEST(DeltaBundleTest, Errors) {
+  Env* env = Env::Default();
+  {
+    BundleWriter writer(env, Prefix("errors_base"));
+    TF_EXPECT_OK(writer.Add("table", Table(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    DeltaBundleWriter writer(env, Prefix("errors_delta"));
+    TF_ASSERT_OK(writer.status());
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AddDirtyRows("table", Table(0), {true, false})));
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        writer.AddDirtyRows("scalar", test::AsScalar<float>(1), {})));
+    // A delta of a different shape than the base.
+    TF_EXPECT_OK(writer.AddDirtyRows("table", test::AsTensor<float>({1, 2}),
+                                     {true, false}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  DeltaBundleReader reader(env, Prefix("errors_base"),
+                           {Prefix("errors_delta")});
+  TF_ASSERT_OK(reader.status());
+  Tensor table(DT_FLOAT, TensorShape({5, 2}));
+  EXPECT_TRUE(errors::IsInvalidArgument(reader.Lookup("table", &table)));
+
+  DeltaBundleReader missing_delta(env, Prefix("errors_base"),
+                                  {Prefix("no_such_delta")});
+  EXPECT_FALSE(missing_delta.status().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
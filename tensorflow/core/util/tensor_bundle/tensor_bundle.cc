@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -26,11 +27,14 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb_text.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/filter_policy.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -256,6 +260,19 @@ Status CorruptFileError(const Status& in_status, const string& filename,
                       detail, "): ", in_status.error_message()));
 }
 
+// The bloom filter of the metadata tables, which lets BundleReader answer
+// lookups of missing keys without reading the data blocks.  Readers that do
+// not know about filters ignore it.
+const table::FilterPolicy* BundleFilterPolicy() {
+  static const table::FilterPolicy* policy =
+      table::NewBloomFilterPolicy(10 /* bits_per_key, ~1% false positives */);
+  return policy;
+}
+
+// Capacity of the block cache of each BundleReader's metadata table.  Large
+// enough to hold the index of a bundle with hundreds of thousands of tensors.
+const size_t kIndexCacheBytes = 32 << 20;
+
 table::Options TableBuilderOptions() {
   table::Options o;
   // Compressed tables cannot be read by TensorFlow releases prior to 1.1.
@@ -263,13 +280,119 @@ table::Options TableBuilderOptions() {
   // (version 1.2) with the intention that they will be enabled again at
   // some point (perhaps the 1.3 release?).
   o.compression = table::kNoCompression;
+  o.filter_policy = BundleFilterPolicy();
   return o;
 }
 
+// Validates the "size" field of "entry" against the tensor "val" to restore.
+Status ValidateEntrySize(StringPiece key, const BundleEntryProto& entry,
+                         const Tensor& val) {
+  if (entry.dtype() != DT_STRING) {
+    if (entry.size() != val.TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                              "; stored size ", entry.size(),
+                              "; expected size ", val.TotalBytes());
+    }
+  } else {
+    // Relaxes the check for string tensors as follows:
+    //   entry.size() == bytes(varint lengths) + bytes(data)
+    //                >= NumElems + bytes(data), since size bytes(varint) >= 1.
+    //   TotalBytes() == sizeof(string) * NumElems + bytes(data)
+    // Since we don't know bytes(varint lengths), we just check an inequality.
+    const size_t lower_bound = val.NumElements() + val.TotalBytes() -
+                               sizeof(string) * val.NumElements();
+    if (entry.size() < lower_bound) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                              "; stored size ", entry.size(),
+                              "; expected size is at least ", lower_bound);
+    }
+  }
+  return Status::OK();
+}
+
+// Reads the contents described by "entry" from "buffered_file" into "val",
+// and validates their checksum. Tensors whose contents can be memcpy'd are
+// read with positional reads of the underlying file, so several of them can
+// be read concurrently from the same file.
+Status ReadEntryValue(const BundleEntryProto& entry,
+                      io::InputBuffer* buffered_file, Tensor* val) {
+  uint32 actual_crc32c = 0;
+  if (DataTypeCanUseMemcpy(entry.dtype())) {
+    // Important: ReadInputByChunk() bounds the readahead as min(buffer, actual
+    // bytes needed).  This is critical when reading small tensors, so we don't
+    // rely on io::InputBuffer's blind buffering here.
+    char* backing_buffer = const_cast<char*>((val->tensor_data().data()));
+    TF_RETURN_IF_ERROR(ReadInputByChunk(buffered_file->file(), entry.offset(),
+                                        entry.size(), 8 << 20 /* 8MB buffer */,
+                                        backing_buffer));
+    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+  } else {
+    // Relies on io::InputBuffer's buffering, because we issue many neighboring
+    // reads for a single string tensor.
+    TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
+    TF_RETURN_IF_ERROR(ReadStringTensor(
+        buffered_file, val->NumElements(), entry.offset(), entry.size(),
+        GetStringBackingBuffer(*val), &actual_crc32c));
+  }
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  return Status::OK();
+}
+
+// Appends zeros to "out" until "*size" is a multiple of "alignment", and
+// updates "*size" accordingly.
+Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
+  const int bytes_over = *size % alignment;
+  if (bytes_over == 0) {
+    return Status::OK();
+  }
+  const int pad_bytes = alignment - bytes_over;
+  TF_RETURN_IF_ERROR(out->Append(string(pad_bytes, '\0')));
+  *size += pad_bytes;
+  return Status::OK();
+}
+
+// Allocates the buffer of a single tensor at "data", in a mapped data file,
+// and keeps the mapping alive until the buffer is deallocated.  Like the
+// allocator of ImmutableConstantOp, deletes itself on deallocation.
+class MappedTensorAllocator : public Allocator {
+ public:
+  MappedTensorAllocator(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        const char* data, size_t num_bytes)
+      : region_(std::move(region)), data_(data), num_bytes_(num_bytes) {}
+
+  string Name() override { return "MappedTensorAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    // Checked by the caller before allocating.
+    DCHECK_EQ(reinterpret_cast<uintptr_t>(data_) % alignment, 0);
+    DCHECK_EQ(num_bytes, num_bytes_);
+    return const_cast<char*>(data_);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    DCHECK_EQ(ptr, data_);
+    delete this;
+  }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const size_t num_bytes_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorAllocator);
+};
+
 }  // namespace
 
-BundleWriter::BundleWriter(Env* env, StringPiece prefix)
+BundleWriter::BundleWriter(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix.ToString()),
       tmp_metadata_path_(strings::StrCat(MetaFilename(prefix_), ".tempstate",
                                          random::New64())),
@@ -277,6 +400,11 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix)
                                      random::New64())),
       out_(nullptr),
       size_(0) {
+  if (options_.data_alignment < 1) {
+    status_ = errors::InvalidArgument("Invalid data alignment: ",
+                                      options_.data_alignment);
+    return;
+  }
   status_ = env_->CreateDir(io::Dirname(prefix_).ToString());
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
@@ -300,6 +428,11 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     return status_;
   }
 
+  if (options_.data_alignment > 1 && val.dtype() != DT_STRING) {
+    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+    if (!status_.ok()) return status_;
+  }
+
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
@@ -387,9 +520,7 @@ Status BundleWriter::Finish() {
   {
     // N.B.: the default use of Snappy compression may not be supported on all
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
-    table::Options options;
-    options.compression = table::kNoCompression;
-    table::TableBuilder builder(options, file.get());
+    table::TableBuilder builder(TableBuilderOptions(), file.get());
     // Header entry.
     BundleHeaderProto header;
     header.set_num_shards(1);
@@ -597,7 +728,8 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
       prefix_(prefix.ToString()),
       metadata_(nullptr),
       table_(nullptr),
-      iter_(nullptr) {
+      iter_(nullptr),
+      index_cache_(nullptr) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -608,7 +740,13 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   status_ = env_->NewRandomAccessFile(filename, &wrapper);
   if (!status_.ok()) return;
   metadata_ = wrapper.release();
-  status_ = table::Table::Open(table::Options(), metadata_, file_size, &table_);
+  // Caches the decoded blocks of the metadata table, so that lookups in any
+  // order read each block at most once.
+  index_cache_ = table::NewLRUCache(kIndexCacheBytes);
+  table::Options table_options;
+  table_options.block_cache = index_cache_;
+  table_options.filter_policy = BundleFilterPolicy();
+  status_ = table::Table::Open(table_options, metadata_, file_size, &table_);
   if (!status_.ok()) return;
   iter_ = table_->NewIterator();
 
@@ -641,6 +779,8 @@ BundleReader::~BundleReader() {
   delete metadata_;
   delete iter_;
   delete table_;
+  // After "iter_" and "table_", which may hold blocks of the cache.
+  delete index_cache_;
   // InputBuffer does not own the underlying RandomAccessFile.
   for (auto pair : data_) {
     if (pair.second->file() != nullptr) {
@@ -655,6 +795,9 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  if (!table_->KeyMayMatch(key)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -672,73 +815,51 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
-Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
-  Tensor* ret = val;
-  const TensorShape stored_shape(TensorShape(entry.shape()));
-  if (val->NumElements() == 0) {
-    ret = new Tensor(entry.dtype(), stored_shape);
-  }
-
-  // Validates the "size" field.
-  if (entry.dtype() != DT_STRING) {
-    if (entry.size() != ret->TotalBytes()) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
-                              "; stored size ", entry.size(),
-                              "; expected size ", ret->TotalBytes());
-    }
-  } else {
-    // Relaxes the check for string tensors as follows:
-    //   entry.size() == bytes(varint lengths) + bytes(data)
-    //                >= NumElems + bytes(data), since size bytes(varint) >= 1.
-    //   TotalBytes() == sizeof(string) * NumElems + bytes(data)
-    // Since we don't know bytes(varint lengths), we just check an inequality.
-    const size_t lower_bound = ret->NumElements() + ret->TotalBytes() -
-                               sizeof(string) * ret->NumElements();
-    if (entry.size() < lower_bound) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
-                              "; stored size ", entry.size(),
-                              "; expected size is at least ", lower_bound);
-    }
-  }
-
+Status BundleReader::GetDataFile(int32 shard_id,
+                                 io::InputBuffer** buffered_file) {
   // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
+  io::InputBuffer*& data_file = data_[shard_id];
+  if (data_file == nullptr) {
     std::unique_ptr<RandomAccessFile> file = nullptr;
     TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file =
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    data_file =
         new io::InputBuffer(file.release(), 256 << 10 /* 256KB buffer */);
     // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
   }
-  CHECK(buffered_file != nullptr);
+  *buffered_file = data_file;
+  return Status::OK();
+}
 
-  TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
-  uint32 actual_crc32c = 0;
-  if (DataTypeCanUseMemcpy(entry.dtype())) {
-    // Important: ReadInputByChunk() bounds the readahead as min(buffer, actual
-    // bytes needed).  This is critical when reading small tensors, so we don't
-    // rely on io::InputBuffer's blind buffering here.
-    char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
-    TF_RETURN_IF_ERROR(ReadInputByChunk(buffered_file->file(), entry.offset(),
-                                        entry.size(), 8 << 20 /* 8MB buffer */,
-                                        backing_buffer));
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
-  } else {
-    // Relies on io::InputBuffer's buffering, because we issue many neighboring
-    // reads for a single string tensor.
-    TF_RETURN_IF_ERROR(ReadStringTensor(
-        buffered_file, ret->NumElements(), entry.offset(), entry.size(),
-        GetStringBackingBuffer(*ret), &actual_crc32c));
+Status BundleReader::GetMappedDataFile(
+    int32 shard_id, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  std::shared_ptr<ReadOnlyMemoryRegion>& mapped = mapped_data_[shard_id];
+  if (mapped == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &new_region);
+    if (!s.ok()) {
+      mapped_data_.erase(shard_id);
+      return s;
+    }
+    mapped = std::move(new_region);
   }
-  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
-    return errors::DataLoss(
-        "Checksum does not match: stored ",
-        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
-        " vs. calculated on the restored bytes ", actual_crc32c);
+  *region = mapped;
+  return Status::OK();
+}
+
+Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  Tensor* ret = val;
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  if (val->NumElements() == 0) {
+    ret = new Tensor(entry.dtype(), stored_shape);
   }
 
+  TF_RETURN_IF_ERROR(ValidateEntrySize(key(), entry, *ret));
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+  TF_RETURN_IF_ERROR(ReadEntryValue(entry, buffered_file, ret));
+
   *val = *ret;
   if (ret != val) delete ret;
   return Status::OK();
@@ -758,6 +879,141 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape stored_shape(entry.shape());
+
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      stored_shape.num_elements() > 0 &&
+      entry.offset() % Allocator::kAllocatorAlignment == 0) {
+    const Status s = GetMappedDataFile(entry.shard_id(), &region);
+    // Not all file systems support memory mapping.
+    if (!s.ok() && !errors::IsUnimplemented(s)) return s;
+  }
+  const char* data = nullptr;
+  if (region != nullptr) {
+    data = static_cast<const char*>(region->data()) + entry.offset();
+    if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+        0) {
+      data = nullptr;
+    }
+  }
+  if (data == nullptr) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    if (entry.slices().empty()) {
+      return GetValue(entry, val);
+    }
+    return GetSliceValue(key, entry, TensorSlice(stored_shape.dims()), val);
+  }
+
+  const uint64 expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("Truncated data file for key ", key, ": ",
+                            region->length(), " bytes, expected at least ",
+                            entry.offset() + entry.size());
+  }
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+  *val = Tensor(new MappedTensorAllocator(region, data, entry.size()),
+                entry.dtype(), stored_shape);
+  return Status::OK();
+}
+
+Status BundleReader::LookupMany(gtl::ArraySlice<string> keys,
+                                gtl::ArraySlice<Tensor*> vals,
+                                thread::ThreadPool* thread_pool) {
+  CHECK_EQ(keys.size(), vals.size());
+  // The metadata table and the InputBuffers are not thread-safe, so the
+  // entries are looked up and their data files opened before the contents
+  // are read.
+  std::vector<BundleEntryProto> entries(keys.size());
+  std::vector<std::unique_ptr<Tensor>> owned_vals(keys.size());
+  std::vector<Tensor*> rets(keys.size(), nullptr);
+  std::vector<std::function<Status()>> reads;
+  // The string tensors are read through the InputBuffer of their data file,
+  // so all those of a data file are read by the same task.
+  std::map<int32, std::vector<size_t>> string_entries_by_shard;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto* entry = &entries[i];
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], entry));
+    if (!entry->slices().empty()) {
+      // Partitioned tensors are assembled from their slices serially.
+      TF_RETURN_IF_ERROR(GetSliceValue(
+          keys[i], *entry,
+          /* a full slice */ TensorSlice(TensorShape(entry->shape()).dims()),
+          vals[i]));
+      continue;
+    }
+    Tensor* ret = vals[i];
+    if (ret->NumElements() == 0) {
+      owned_vals[i].reset(
+          new Tensor(entry->dtype(), TensorShape(entry->shape())));
+      ret = owned_vals[i].get();
+    }
+    rets[i] = ret;
+    TF_RETURN_IF_ERROR(ValidateEntrySize(keys[i], *entry, *ret));
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry->shard_id(), &buffered_file));
+    if (DataTypeCanUseMemcpy(entry->dtype())) {
+      reads.push_back([entry, buffered_file, ret]() {
+        return ReadEntryValue(*entry, buffered_file, ret);
+      });
+    } else {
+      string_entries_by_shard[entry->shard_id()].push_back(i);
+    }
+  }
+  for (const auto& shard_and_entries : string_entries_by_shard) {
+    io::InputBuffer* buffered_file = data_[shard_and_entries.first];
+    const std::vector<size_t>* indices = &shard_and_entries.second;
+    reads.push_back([&entries, &rets, buffered_file, indices]() {
+      for (size_t i : *indices) {
+        TF_RETURN_IF_ERROR(ReadEntryValue(entries[i], buffered_file, rets[i]));
+      }
+      return Status::OK();
+    });
+  }
+
+  std::vector<Status> statuses(reads.size());
+  if (thread_pool == nullptr) {
+    for (size_t i = 0; i < reads.size(); ++i) {
+      statuses[i] = reads[i]();
+    }
+  } else {
+    BlockingCounter counter(reads.size());
+    for (size_t i = 0; i < reads.size(); ++i) {
+      thread_pool->Schedule([&reads, &statuses, &counter, i]() {
+        statuses[i] = reads[i]();
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (owned_vals[i] != nullptr) {
+      *vals[i] = *owned_vals[i];
+    }
+  }
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -911,6 +1167,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
@@ -64,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -71,6 +72,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/table.h"
@@ -85,6 +87,10 @@ namespace tensorflow {
 
 class FileOutputBuffer;
 
+namespace table {
+class Cache;
+}  // namespace table
+
 // Versioning of the tensor bundle format.
 // Follows the same rules as 3p/tf/core/public/version.h.
 //
@@ -107,7 +113,17 @@ extern const char* const kHeaderEntryKey;
 // All threads accessing the same BundleWriter must synchronize.
 class BundleWriter {
  public:
-  BundleWriter(Env* env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // Alignment, in bytes, of the data of each non-string tensor in the data
+    // file.  Must be >= 1.  The default of 1 densely packs the tensors.  An
+    // alignment that is a multiple of Allocator::kAllocatorAlignment allows
+    // BundleReader::LookupMapped() to map the tensors instead of copying them.
+    int data_alignment = 1;
+  };
+
+  BundleWriter(Env* env, StringPiece prefix,
+               const Options& options = Options());
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
@@ -140,6 +156,7 @@ class BundleWriter {
 
  private:
   Env* const env_;  // Not owned.
+  const Options options_;
   const string prefix_;
   const string tmp_metadata_path_;
   const string tmp_data_path_;
@@ -210,6 +227,30 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but "val" is allocated with the stored dtype and shape, and
+  // its buffer is a read-only memory mapping of the data file when possible:
+  // for a tensor that is not partitioned, whose dtype can be memcpy'ed, and
+  // whose data is aligned in the data file (see
+  // BundleWriter::Options::data_alignment).  Other tensors are copied.  The
+  // mapping stays alive while any tensor shares its buffer, even after the
+  // reader is destroyed.  The caller must not modify the returned tensor.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Looks up the tensors keyed by "keys" into "vals", as Lookup() does for
+  // each pair.  The metadata is read serially, but the contents of the
+  // tensors are then read concurrently on "thread_pool", across tensors and
+  // data files.  Partitioned tensors are looked up serially.  If
+  // "thread_pool" is null, the contents are read on the calling thread.
+  //
+  // Calls Seek() internally, so this call invalidates the reader's current
+  // position.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<string> keys, gtl::ArraySlice<Tensor*> vals,
+                    thread::ThreadPool* thread_pool) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -261,6 +302,17 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Stores in "*buffered_file" the data file with id "shard_id", which is
+  // opened on first use.
+  Status GetDataFile(int32 shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // Stores in "*region" a read-only memory mapping of the data file with id
+  // "shard_id", which is mapped on first use.
+  Status GetMappedDataFile(int32 shard_id,
+                           std::shared_ptr<ReadOnlyMemoryRegion>* region)
+      TF_MUST_USE_RESULT;
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
@@ -281,8 +333,14 @@ class BundleReader {
   RandomAccessFile* metadata_;  // Owned.
   table::Table* table_;
   table::Iterator* iter_;
+  // Caches the blocks of "table_".  Owned.
+  table::Cache* index_cache_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The data files mapped by LookupMapped().  Shared with the buffers of the
+  // mapped tensors.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
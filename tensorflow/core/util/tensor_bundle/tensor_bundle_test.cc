@@ -18,6 +18,7 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -460,6 +461,112 @@ TEST(TensorBundleTest, StringTensors) {
   }
 }
 
+TEST(TensorBundleTest, LookupMany) {
+  const TensorShape kFullShape({2, 3});
+  // Two bundles merged into one, so that the tensors are in two data files.
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many_0"));
+    TF_EXPECT_OK(writer.Add("floats", Constant_2x3<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("strs", test::AsTensor<string>({"a", "", "bc"})));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("0,1:-"),
+                                 Constant(0, TensorShape({1, 3}))));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", kFullShape,
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant(1, TensorShape({1, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many_1"));
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int32>(7)));
+    TF_EXPECT_OK(writer.Add("scalar", test::AsTensor<string>({"hello"})));
+    TF_EXPECT_OK(writer.Add("empty", Tensor(DT_FLOAT, TensorShape({0}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(),
+                            {Prefix("lookup_many_0"), Prefix("lookup_many_1")},
+                            Prefix("lookup_many")));
+
+  BundleReader reader(Env::Default(), Prefix("lookup_many"));
+  TF_ASSERT_OK(reader.status());
+  Tensor floats(DT_FLOAT, kFullShape);
+  Tensor strs(DT_STRING, TensorShape({3}));
+  Tensor partitioned(DT_INT32, kFullShape);
+  Tensor ints(DT_INT32, kFullShape);
+  Tensor scalar(DT_STRING, TensorShape({1}));
+  Tensor empty(DT_FLOAT, TensorShape({0}));
+  const std::vector<string> keys(
+      {"floats", "strs", "partitioned", "ints", "scalar", "empty"});
+  const std::vector<Tensor*> vals(
+      {&floats, &strs, &partitioned, &ints, &scalar, &empty});
+  for (thread::ThreadPool* thread_pool :
+       {static_cast<thread::ThreadPool*>(nullptr),
+        new thread::ThreadPool(Env::Default(), "test", 4)}) {
+    TF_ASSERT_OK(reader.LookupMany(keys, vals, thread_pool));
+    test::ExpectTensorEqual<float>(floats, Constant_2x3<float>(1.5));
+    test::ExpectTensorEqual<string>(strs,
+                                    test::AsTensor<string>({"a", "", "bc"}));
+    test::ExpectTensorEqual<int32>(
+        partitioned, test::AsTensor<int32>({0, 0, 0, 1, 1, 1}, kFullShape));
+    test::ExpectTensorEqual<int32>(ints, Constant_2x3<int32>(7));
+    test::ExpectTensorEqual<string>(scalar, test::AsTensor<string>({"hello"}));
+    EXPECT_EQ(0, empty.NumElements());
+    delete thread_pool;
+  }
+
+  // A missing key fails the whole lookup.
+  Tensor missing(DT_FLOAT, kFullShape);
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupMany({"floats", "missing"}, {&floats, &missing}, nullptr)));
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  const int kAlignment = Allocator::kAllocatorAlignment;
+  for (int data_alignment : {1, kAlignment}) {
+    const string prefix = Prefix(strings::StrCat("mapped_", data_alignment));
+    {
+      BundleWriter::Options options;
+      options.data_alignment = data_alignment;
+      BundleWriter writer(Env::Default(), prefix, options);
+      // Misaligns the data that follows, unless the writer pads it.
+      TF_EXPECT_OK(writer.Add("a_byte", Constant(uint8(1), TensorShape({1}))));
+      TF_EXPECT_OK(writer.Add("b_floats", Constant_2x3<float>(1.5)));
+      TF_EXPECT_OK(writer.Add("c_strs", test::AsTensor<string>({"a", "bc"})));
+      TF_EXPECT_OK(writer.Add("d_ints", Constant_2x3<int32>(7)));
+      TF_ASSERT_OK(writer.Finish());
+    }
+    Tensor floats;
+    Tensor strs;
+    Tensor ints;
+    const char* floats_data = nullptr;
+    {
+      BundleReader reader(Env::Default(), prefix);
+      TF_ASSERT_OK(reader.status());
+      TF_ASSERT_OK(reader.LookupMapped("b_floats", &floats));
+      TF_ASSERT_OK(reader.LookupMapped("c_strs", &strs));
+      TF_ASSERT_OK(reader.LookupMapped("d_ints", &ints));
+      floats_data = floats.tensor_data().data();
+
+      // Mapped tensors share the mapping, copies do not.
+      Tensor floats_again;
+      TF_ASSERT_OK(reader.LookupMapped("b_floats", &floats_again));
+      EXPECT_EQ(data_alignment == kAlignment,
+                floats_again.tensor_data().data() == floats_data);
+    }
+    // The tensors outlive the reader.
+    test::ExpectTensorEqual<float>(floats, Constant_2x3<float>(1.5));
+    test::ExpectTensorEqual<string>(strs, test::AsTensor<string>({"a", "bc"}));
+    test::ExpectTensorEqual<int32>(ints, Constant_2x3<int32>(7));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(floats_data) % kAlignment);
+
+    // Lookup() reads the padded bundle as well.
+    BundleReader reader(Env::Default(), prefix);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "b_floats", Constant_2x3<float>(1.5));
+    Expect<int32>(&reader, "d_ints", Constant_2x3<int32>(7));
+  }
+}
+
 TEST(TensorBundleTest, DirectoryStructure) {
   Env* env = Env::Default();
   // Writes two bundles.
@@ -30,7 +30,8 @@ TensorSliceReaderCacheWrapper::~TensorSliceReaderCacheWrapper() {
   cache_ = nullptr;
 }
 
-const TensorSliceReader* TensorSliceReaderCacheWrapper::GetReader(
+std::shared_ptr<const TensorSliceReader>
+TensorSliceReaderCacheWrapper::GetReader(
     const string& filepattern,
     TensorSliceReader::OpenTableFunction open_function,
     int preferred_shard) const {
@@ -42,15 +43,21 @@ const TensorSliceReader* TensorSliceReaderCacheWrapper::GetReader(
                            preferred_shard);
 }
 
-TensorSliceReaderCache::TensorSliceReaderCache() {}
+constexpr int TensorSliceReaderCache::kDefaultMaxReaders;
 
-TensorSliceReaderCache::~TensorSliceReaderCache() {
-  for (auto pair : readers_) {
-    delete pair.second.second;
-  }
+TensorSliceReaderCache::TensorSliceReaderCache(int max_readers)
+    : max_readers_(max_readers) {
+  CHECK_GT(max_readers, 0);
+}
+
+TensorSliceReaderCache::~TensorSliceReaderCache() {}
+
+int TensorSliceReaderCache::num_readers() {
+  mutex_lock l(mu_);
+  return readers_.size();
 }
 
-const TensorSliceReader* TensorSliceReaderCache::GetReader(
+std::shared_ptr<const TensorSliceReader> TensorSliceReaderCache::GetReader(
     const string& filepattern,
     TensorSliceReader::OpenTableFunction open_function, int preferred_shard) {
   mutex_lock l(mu_);
@@ -78,31 +85,40 @@ const TensorSliceReader* TensorSliceReaderCache::GetReader(
     cv_.wait(l);
   }
 
-  TensorSliceReader* reader = nullptr;
-  if (readers_.find(filepattern) == readers_.end()) {
+  std::shared_ptr<const TensorSliceReader> reader;
+  auto it = readers_.find(filepattern);
+  if (it == readers_.end()) {
     VLOG(1) << "Creating new TensorSliceReader for " << filepattern;
     still_opening_.insert(filepattern);
     // Release the lock temporary as constructing TensorSliceReader is
-    // expensive.
+    // expensive.  Other file patterns can be opened in the meantime.
     mu_.unlock();
-    TensorSliceReader* tmp_reader(
+    std::shared_ptr<const TensorSliceReader> tmp_reader(
         new TensorSliceReader(filepattern, open_function, preferred_shard));
     // Acquire the lock again.
     mu_.lock();
     if (tmp_reader->status().ok()) {
-      reader = tmp_reader;
-      readers_[filepattern] = std::make_pair(*func_ptr, reader);
-    } else {
-      delete tmp_reader;
+      reader = std::move(tmp_reader);
+      lru_.push_front(filepattern);
+      readers_[filepattern] = {*func_ptr, reader, lru_.begin()};
+      // Evict the least recently used readers.  They are deleted once their
+      // current users release them.
+      while (readers_.size() > static_cast<size_t>(max_readers_)) {
+        VLOG(1) << "Evicting TensorSliceReader for " << lru_.back();
+        readers_.erase(lru_.back());
+        lru_.pop_back();
+      }
     }
     CHECK_EQ(size_t{1}, still_opening_.erase(filepattern));
-    VLOG(1) << "Cached TensorSliceReader for " << filepattern << ": " << reader;
+    VLOG(1) << "Cached TensorSliceReader for " << filepattern << ": "
+            << reader.get();
   } else {
-    auto cached_val = readers_[filepattern];
-    if (cached_val.first == *func_ptr) {
-      reader = cached_val.second;
+    CachedReader& cached_val = it->second;
+    if (cached_val.open_function == *func_ptr) {
+      reader = cached_val.reader;
+      lru_.splice(lru_.begin(), lru_, cached_val.lru_position);
       VLOG(1) << "Using cached TensorSliceReader for " << filepattern << ": "
-              << reader;
+              << reader.get();
     } else {
       LOG(WARNING) << "Caching disabled because the checkpoint file "
                    << "is being opened with two different open functions: "
@@ -20,6 +20,9 @@ limitations under the License.
 #ifndef TENSORFLOW_UTIL_TENSOR_SLICE_READER_CACHE_H_
 #define TENSORFLOW_UTIL_TENSOR_SLICE_READER_CACHE_H_
 
+#include <list>
+#include <memory>
+#include <set>
 #include <unordered_map>
 
 #include "tensorflow/core/lib/core/status.h"
@@ -40,7 +43,7 @@ class TensorSliceReaderCacheWrapper {
   ~TensorSliceReaderCacheWrapper();
 
   // Same as TensorSliceReaderCache::GetReader().
-  const TensorSliceReader* GetReader(
+  std::shared_ptr<const TensorSliceReader> GetReader(
       const string& filepattern,
       TensorSliceReader::OpenTableFunction open_function,
       int preferred_shard) const;
@@ -50,30 +53,48 @@ class TensorSliceReaderCacheWrapper {
   mutable TensorSliceReaderCache* cache_ = nullptr;
 };
 
-// A cache of TensorSliceReaders.
+// A cache of TensorSliceReaders, which keeps the 'max_readers' most recently
+// used ones.  Readers of different file patterns are opened concurrently.
 class TensorSliceReaderCache {
  public:
-  TensorSliceReaderCache();
+  static constexpr int kDefaultMaxReaders = 64;
+
+  explicit TensorSliceReaderCache(int max_readers = kDefaultMaxReaders);
   ~TensorSliceReaderCache();
 
   // Returns the TensorSliceReader corresponding to 'filepattern' and the
   // open_function.  May return nullptr if we can not create a new
-  // TensorSliceReader for the filepattern/open_function combination.
-  const TensorSliceReader* GetReader(
+  // TensorSliceReader for the filepattern/open_function combination.  The
+  // returned reader stays valid after it is evicted from the cache.
+  std::shared_ptr<const TensorSliceReader> GetReader(
       const string& filepattern,
       TensorSliceReader::OpenTableFunction open_function, int preferred_shard);
 
+  // The number of readers currently cached.
+  int num_readers();
+
  private:
   // Need to use a regular function type in the key map as std::function does
   // not support ==.
   typedef Status (*OpenFuncType)(const string&, TensorSliceReader::Table**);
 
+  struct CachedReader {
+    OpenFuncType open_function;
+    std::shared_ptr<const TensorSliceReader> reader;
+    // Position of the file pattern in 'lru_'.
+    std::list<string>::iterator lru_position;
+  };
+
+  const int max_readers_;
+
   // Protects attributes below.
   mutex mu_;
 
   // Maps of opened readers.
-  std::unordered_map<string, std::pair<OpenFuncType, TensorSliceReader*>>
-      readers_;
+  std::unordered_map<string, CachedReader> readers_;
+
+  // The file patterns of 'readers_', from the most to the least recently used.
+  std::list<string> lru_;
 
   // Set of keys that a previous GetReader() call is still trying to populate.
   std::set<string> still_opening_;
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/util/tensor_slice_reader.h"
 
@@ -370,7 +372,7 @@ void CachedTensorSliceReaderTesterHelper(
   // Now we need to read the tensor slices
   TensorSliceReaderCache cache;
   const string filepattern = strings::StrCat(fname_base, "_*");
-  const TensorSliceReader* reader = cache.GetReader(
+  std::shared_ptr<const TensorSliceReader> reader = cache.GetReader(
       filepattern, open_function, TensorSliceReader::kLoadAllShards);
   EXPECT_TRUE(reader != nullptr);
   EXPECT_EQ(2, reader->num_files());
@@ -386,7 +388,7 @@ void CachedTensorSliceReaderTesterHelper(
   }
 
   // Make sure the reader is cached.
-  const TensorSliceReader* reader2 = cache.GetReader(
+  std::shared_ptr<const TensorSliceReader> reader2 = cache.GetReader(
       filepattern, open_function, TensorSliceReader::kLoadAllShards);
   EXPECT_EQ(reader, reader2);
 
@@ -400,6 +402,43 @@ TEST(CachedTensorSliceReaderTest, SimpleFloat) {
                                       OpenTableTensorSliceReader);
 }
 
+TEST(CachedTensorSliceReaderTest, EvictsLeastRecentlyUsed) {
+  std::vector<string> fnames;
+  for (int i = 0; i < 3; ++i) {
+    fnames.push_back(
+        io::JoinPath(testing::TmpDir(), strings::StrCat("lru_checkpoint_", i)));
+    TensorSliceWriter writer(fnames.back(), CreateTableTensorSliceBuilder);
+    const float data[] = {0, 1};
+    TF_CHECK_OK(writer.Add("test", TensorShape({2}),
+                           TensorSlice::ParseOrDie("-"), data));
+    TF_CHECK_OK(writer.Finish());
+  }
+
+  TensorSliceReaderCache cache(2);
+  auto get_reader = [&cache, &fnames](int i) {
+    return cache.GetReader(fnames[i], OpenTableTensorSliceReader,
+                           TensorSliceReader::kLoadAllShards);
+  };
+  std::shared_ptr<const TensorSliceReader> reader0 = get_reader(0);
+  std::shared_ptr<const TensorSliceReader> reader1 = get_reader(1);
+  ASSERT_TRUE(reader0 != nullptr);
+  ASSERT_TRUE(reader1 != nullptr);
+  // Touch reader 0, so that reader 1 is evicted to make room for reader 2.
+  EXPECT_EQ(reader0, get_reader(0));
+  std::shared_ptr<const TensorSliceReader> reader2 = get_reader(2);
+  ASSERT_TRUE(reader2 != nullptr);
+  EXPECT_EQ(2, cache.num_readers());
+  EXPECT_EQ(reader0, get_reader(0));
+  EXPECT_EQ(reader2, get_reader(2));
+
+  // The evicted reader remains usable, and is reopened on the next request.
+  EXPECT_TRUE(reader1->HasTensor("test", nullptr, nullptr));
+  std::shared_ptr<const TensorSliceReader> reopened1 = get_reader(1);
+  ASSERT_TRUE(reopened1 != nullptr);
+  EXPECT_NE(reader1, reopened1);
+  EXPECT_EQ(2, cache.num_readers());
+}
+
 static void VersionTest(const VersionDef& versions, const string& error) {
   const string path = io::JoinPath(testing::TmpDir(), "checkpoint");
 
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <atomic>
+#include <cmath>
+
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 
 namespace tensorflow {
 
@@ -74,4 +78,48 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
   counter.Wait();
 }
 
+ShardCostEstimator::ShardCostEstimator(double initial_cost_per_unit)
+    : cost_per_unit_(initial_cost_per_unit) {}
+
+double ShardCostEstimator::cost_per_unit() const {
+  mutex_lock l(mu_);
+  return cost_per_unit_;
+}
+
+void ShardCostEstimator::Record(double units, double cycles) {
+  if (units <= 0 || cycles <= 0) return;
+  mutex_lock l(mu_);
+  // Halving the sums every few records makes older measurements decay
+  // geometrically.
+  const int64 kRecordsPerHalving = 16;
+  if (++num_records_ % kRecordsPerHalving == 0) {
+    units_ /= 2;
+    cycles_ /= 2;
+  }
+  units_ += units;
+  cycles_ += cycles;
+  cost_per_unit_ = cycles_ / units_;
+}
+
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, int64 unit_size,
+                   ShardCostEstimator* estimator,
+                   std::function<void(int64, int64)> work) {
+  CHECK_GT(unit_size, 0);
+  const int64 cost_per_unit = static_cast<int64>(
+      std::ceil(estimator->cost_per_unit() * static_cast<double>(unit_size)));
+  using profile_utils::CpuUtils;
+  std::atomic<uint64> cycles(0);
+  Shard(max_parallelism, workers, total, cost_per_unit,
+        [&work, &cycles](int64 start, int64 limit) {
+          const uint64 start_cycles = CpuUtils::GetCurrentClockCycle();
+          work(start, limit);
+          cycles.fetch_add(CpuUtils::GetCurrentClockCycle() - start_cycles,
+                           std::memory_order_relaxed);
+        });
+  // Without a cycle counter the clock is constant, so nothing is recorded.
+  estimator->Record(static_cast<double>(total) * unit_size,
+                    static_cast<double>(cycles.load()));
+}
+
 }  // end namespace tensorflow
@@ -19,6 +19,9 @@ limitations under the License.
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -48,6 +51,53 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Learns the cost of a unit of work of a loop sharded by AdaptiveShard()
+// from the CPU cycles its shards take, for loops whose cost is hard to
+// estimate up front. A kernel typically keeps one estimator per loop, shared
+// by all its invocations.
+//
+// The estimate is the ratio of the cycles to the units of work recorded,
+// with older measurements decaying, so it follows changes of the inputs or
+// of the load of the machine.
+//
+// This class is thread-safe.
+class ShardCostEstimator {
+ public:
+  // "initial_cost_per_unit" is the estimate until something is recorded.
+  explicit ShardCostEstimator(double initial_cost_per_unit);
+
+  // Returns the estimated cycles per unit of work.
+  double cost_per_unit() const;
+
+  // Records that "units" units of work took "cycles" CPU cycles.
+  void Record(double units, double cycles);
+
+ private:
+  mutable mutex mu_;
+  double units_ GUARDED_BY(mu_) = 0;
+  double cycles_ GUARDED_BY(mu_) = 0;
+  int64 num_records_ GUARDED_BY(mu_) = 0;
+  double cost_per_unit_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardCostEstimator);
+};
+
+// Like Shard(), with the cost per unit of work taken from "estimator"
+// rather than given by the caller, and measured on the way to refine the
+// estimate. Each of the "total" units of work has size "unit_size", e.g.
+// the number of bytes it copies, and the estimator learns the cost of a
+// unit of size 1, so that it remains valid when the size of the units
+// changes between calls.
+//
+// Falls back to the current estimate without refining it on platforms
+// without a cycle counter.
+//
+// REQUIRES: unit_size > 0
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, int64 unit_size,
+                   ShardCostEstimator* estimator,
+                   std::function<void(int64, int64)> work);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_UTIL_WORK_SHARDER_H_
@@ -76,6 +76,39 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(ShardCostEstimator, Estimate) {
+  ShardCostEstimator estimator(100);
+  EXPECT_EQ(100, estimator.cost_per_unit());
+  // Empty measurements are ignored.
+  estimator.Record(0, 50);
+  estimator.Record(10, 0);
+  EXPECT_EQ(100, estimator.cost_per_unit());
+  estimator.Record(10, 50);
+  EXPECT_EQ(5, estimator.cost_per_unit());
+  estimator.Record(30, 50);
+  EXPECT_EQ(2.5, estimator.cost_per_unit());
+  // Older measurements decay, so the estimate converges to new costs.
+  for (int i = 0; i < 200; ++i) estimator.Record(10, 1000);
+  EXPECT_NEAR(100, estimator.cost_per_unit(), 1);
+}
+
+TEST(Shard, Adaptive) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  ShardCostEstimator estimator(1);
+  for (auto total : {0, 1, 7, 1000, 100000}) {
+    for (auto unit_size : {1, 64}) {
+      std::vector<std::atomic<int>> work(total);
+      for (auto& w : work) w = 0;
+      AdaptiveShard(16, &threads, total, unit_size, &estimator,
+                    [&work](int64 start, int64 limit) {
+                      for (int64 i = start; i < limit; ++i) ++work[i];
+                    });
+      for (const auto& w : work) EXPECT_EQ(1, w.load());
+      EXPECT_GT(estimator.cost_per_unit(), 0);
+    }
+  }
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
@@ -118,6 +118,8 @@ class BatchMatmulOpTest(test.TestCase):
     compareNonEmpty(self, [7, 2, 3], [7, 3, 1])
     compareNonEmpty(self, [7, 2, 3], [7, 3, 5])
     compareNonEmpty(self, [10, 64, 75], [10, 75, 30])
+    compareNonEmpty(self, [64, 16, 32], [64, 32, 8])
+    compareNonEmpty(self, [64, 32, 33], [64, 33, 16])
     compareNonEmpty(self, [5, 7, 2, 3], [5, 7, 3, 5])
 
   def _testEmpty(self, dtype, adjoint_a, adjoint_b, use_static_shape):
@@ -22,6 +22,7 @@ import numpy as np
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.platform import googletest
 
@@ -76,6 +77,22 @@ class BincountTest(test_util.TensorFlowTestCase):
             math_ops.bincount(arr, weights).eval(),
             np.bincount(arr, weights))
 
+  def test_random_with_weights_gpu(self):
+    np.random.seed(42)
+    # The bins fit in shared memory for the smaller sizes only.
+    for size in [10, 1000, 100000]:
+      arr = np.random.randint(0, size, 100000)
+      for dtype in [dtypes.int32, dtypes.int64, dtypes.float32, dtypes.float64]:
+        if dtype == dtypes.int32 or dtype == dtypes.int64:
+          weights = np.random.randint(-100, 100, 100000)
+        else:
+          weights = np.random.random(100000)
+        with self.test_session(use_gpu=True):
+          self.assertAllClose(
+              math_ops.bincount(
+                  arr, math_ops.cast(weights, dtype), minlength=size).eval(),
+              np.bincount(arr, weights, minlength=size))
+
   def test_zero_weights(self):
     with self.test_session():
       self.assertAllEqual(
@@ -87,6 +104,18 @@ class BincountTest(test_util.TensorFlowTestCase):
       with self.assertRaises(errors.InvalidArgumentError):
         math_ops.bincount([1, 2, 3, -1, 6, 8]).eval()
 
+  def test_negative_gpu(self):
+    # The CPU and GPU kernels both reject negative values.
+    np.random.seed(42)
+    arr = np.random.randint(0, 1000, 100000).astype(np.int32)
+    arr[54321] = -7
+    for use_gpu in [False, True]:
+      with self.test_session(use_gpu=use_gpu):
+        with self.assertRaisesOpError("must be non-negative"):
+          gen_math_ops.bincount(arr, 1000, []).eval()
+        with self.assertRaisesOpError("must be non-negative"):
+          math_ops.bincount([1, 2, 3, -1, 6, 8]).eval()
+
 
 if __name__ == "__main__":
   googletest.main()
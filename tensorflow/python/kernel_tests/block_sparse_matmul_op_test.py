@@ -0,0 +1,120 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for BlockSparseMatMul."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.python.framework import errors_impl
+from tensorflow.python.ops import gen_math_ops
+from tensorflow.python.platform import test
+
+
+def _ToBlockSparse(b, block_rows, block_cols):
+  """Returns the blocks of `b` that have a non-zero, in BSR format."""
+  values = []
+  col_indices = []
+  row_ptr = [0]
+  for r in range(b.shape[0] // block_rows):
+    for c in range(b.shape[1] // block_cols):
+      block = b[r * block_rows:(r + 1) * block_rows,
+                c * block_cols:(c + 1) * block_cols]
+      if np.any(block):
+        values.append(block)
+        col_indices.append(c)
+    row_ptr.append(len(col_indices))
+  values = np.array(values, dtype=b.dtype).reshape(
+      [len(col_indices), block_rows, block_cols])
+  return (values, np.array(col_indices, dtype=np.int32),
+          np.array(row_ptr, dtype=np.int32))
+
+
+def _RandomBlockSparse(n, k, block_rows, block_cols, density, dtype):
+  b = np.random.uniform(-1.0, 1.0, size=[n, k]).astype(dtype)
+  mask = np.random.uniform(
+      size=[n // block_rows, k // block_cols]) < density
+  mask = np.repeat(np.repeat(mask, block_rows, axis=0), block_cols, axis=1)
+  return b * mask
+
+
+class BlockSparseMatMulTest(test.TestCase):
+
+  def _testMatMul(self, m, n, k, block_rows, block_cols, density,
+                  dtype=np.float32):
+    a = np.random.uniform(-1.0, 1.0, size=[m, k]).astype(dtype)
+    b = _RandomBlockSparse(n, k, block_rows, block_cols, density, dtype)
+    values, col_indices, row_ptr = _ToBlockSparse(b, block_rows, block_cols)
+    tol = 1e-5 if dtype == np.float32 else 1e-10
+    for use_gpu in [False, True]:
+      with self.test_session(use_gpu=use_gpu):
+        product = gen_math_ops.block_sparse_mat_mul(a, values, col_indices,
+                                                    row_ptr)
+        self.assertAllClose(
+            np.matmul(a, b.T), product.eval(), rtol=tol, atol=tol)
+
+  def testBasic(self):
+    self._testMatMul(8, 16, 16, 4, 4, 0.5)
+
+  def testNonSquareBlocks(self):
+    self._testMatMul(5, 12, 32, 3, 8, 0.5)
+
+  def testLarge(self):
+    # Spans several row tiles and block rows on the CPU.
+    self._testMatMul(150, 64, 96, 16, 16, 0.3)
+
+  def testDouble(self):
+    self._testMatMul(17, 32, 32, 16, 16, 0.4, dtype=np.float64)
+
+  def testDense(self):
+    self._testMatMul(9, 8, 8, 2, 2, 1.0)
+
+  def testEmptyBlockRows(self):
+    self._testMatMul(4, 16, 16, 4, 4, 0.0)
+
+  def testShapeInference(self):
+    a = np.zeros([3, 8], dtype=np.float32)
+    values = np.zeros([2, 4, 2], dtype=np.float32)
+    product = gen_math_ops.block_sparse_mat_mul(
+        a, values, np.array([0, 3], dtype=np.int32),
+        np.array([0, 1, 2, 2], dtype=np.int32))
+    self.assertEqual([3, 12], product.get_shape().as_list())
+
+  def testInvalidIndices(self):
+    a = np.ones([2, 8], dtype=np.float32)
+    values = np.ones([2, 2, 4], dtype=np.float32)
+    with self.test_session(use_gpu=False):
+      with self.assertRaisesRegexp(errors_impl.InvalidArgumentError,
+                                   "b_col_indices"):
+        gen_math_ops.block_sparse_mat_mul(
+            a, values, np.array([0, 2], dtype=np.int32),
+            np.array([0, 1, 2], dtype=np.int32)).eval()
+      with self.assertRaisesRegexp(errors_impl.InvalidArgumentError,
+                                   "b_row_ptr"):
+        gen_math_ops.block_sparse_mat_mul(
+            a, values, np.array([0, 1], dtype=np.int32),
+            np.array([0, 1, 1], dtype=np.int32)).eval()
+      with self.assertRaisesRegexp(errors_impl.InvalidArgumentError,
+                                   "multiple of the block columns"):
+        gen_math_ops.block_sparse_mat_mul(
+            np.ones([2, 6], dtype=np.float32), values,
+            np.array([0, 1], dtype=np.int32),
+            np.array([0, 1, 2], dtype=np.int32)).eval()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -1364,6 +1364,16 @@ class DeepConv2DTest(test.TestCase):
   def testConv2D3x3FilterStride1x1Same(self):
     self._RunTestCases([1, 1], "SAME")
 
+  def testConv2D3x3FilterStride1x1Autotune(self):
+    # The first run of each shape times both implementations, later runs use
+    # the faster one; both must match the generic convolution.
+    os.environ["TF_CPU_CONV_USE_AUTOTUNE"] = "1"
+    try:
+      for _ in range(2):
+        self._RunTestCases([1, 1], "SAME")
+    finally:
+      os.environ["TF_CPU_CONV_USE_AUTOTUNE"] = "0"
+
 
 class Conv2DBenchmark(test.Benchmark):
 
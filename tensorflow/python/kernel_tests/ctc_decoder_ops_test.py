@@ -27,6 +27,7 @@ from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import ctc_ops
+from tensorflow.python.ops import sparse_ops
 from tensorflow.python.platform import test
 
 
@@ -42,6 +43,11 @@ def flatten(list_of_lists):
   return itertools.chain.from_iterable(list_of_lists)
 
 
+def densify(sparse_tensor):
+  """Convert a decoded SparseTensor to a dense one padded with -1."""
+  return sparse_ops.sparse_tensor_to_dense(sparse_tensor, default_value=-1)
+
+
 class CTCGreedyDecoderTest(test.TestCase):
 
   def _testCTCDecoder(self,
@@ -245,6 +251,35 @@ class CTCGreedyDecoderTest(test.TestCase):
           beam_width=2,
           top_paths=3)
 
+  def testCTCDecoderBeamSearchBatchMatchesSingleEntries(self):
+    """Test that batch entries decoded in parallel match decoding alone."""
+    max_time_steps = 20
+    batch_size = 16
+    depth = 7
+    np.random.seed(0)
+    inputs = np.log(
+        np.random.uniform(size=(max_time_steps, batch_size, depth)).astype(
+            np.float32))
+    seq_lens = np.random.randint(
+        1, max_time_steps + 1, size=batch_size).astype(np.int32)
+
+    with self.test_session(use_gpu=False) as sess:
+      decoded, log_probability = ctc_ops.ctc_beam_search_decoder(
+          inputs, seq_lens, beam_width=4, top_paths=2)
+      batch_dense, batch_log_probability = sess.run(
+          [[densify(st) for st in decoded], log_probability])
+      for b in range(batch_size):
+        decoded_b, log_probability_b = ctc_ops.ctc_beam_search_decoder(
+            inputs[:, b:b + 1, :], seq_lens[b:b + 1], beam_width=4,
+            top_paths=2)
+        dense_b, log_probability_b = sess.run(
+            [[densify(st) for st in decoded_b], log_probability_b])
+        self.assertAllClose(batch_log_probability[b], log_probability_b[0])
+        for path, path_b in zip(batch_dense, dense_b):
+          length = path_b.shape[1]
+          self.assertAllEqual(path[b, :length], path_b[0])
+          self.assertTrue(np.all(path[b, length:] == -1))
+
 
 if __name__ == "__main__":
   test.main()
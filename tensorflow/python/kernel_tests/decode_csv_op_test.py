@@ -207,6 +207,43 @@ class DecodeCSVOpTest(test.TestCase):
     self._test(
         args, expected_err_re="Quoted field has to end with quote followed.*")
 
+  def testLongFields(self):
+    # Fields longer than a vector register, and a float longer than the
+    # buffer it is copied to.
+    long_string = "abcdefghijklmnopqrstuvwxyz" * 4
+    long_float = "1.25" + "0" * 100
+    args = {
+        "records": [
+            long_string + ",1," + long_float,
+            '"' + long_string + '""' + long_string + '",2,2.5',
+        ],
+        "record_defaults": [[""], [1], [1.0]],
+    }
+    expected_out = [
+        [long_string.encode(), (long_string + '"' + long_string).encode()],
+        [1, 2], [1.25, 2.5]
+    ]
+    self._test(args, expected_out)
+
+  def testLargeBatch(self):
+    # Large enough to be split across several threads.
+    records = ['%d,"a""%d",%d.5' % (i, i, i) for i in range(10000)]
+    args = {
+        "records": records,
+        "record_defaults": [[0], [""], [0.0]],
+    }
+    expected_out = [
+        list(range(10000)), [('a"%d' % i).encode() for i in range(10000)],
+        [i + 0.5 for i in range(10000)]
+    ]
+    self._test(args, expected_out)
+
+    # The error of the first invalid record is reported.
+    records[7000] = "1,2"
+    records[3000] = "x,a,0.5"
+    self._test(
+        args, expected_err_re="Field 0 in record 3000 is not a valid int32: x")
+
 
 if __name__ == "__main__":
   test.main()
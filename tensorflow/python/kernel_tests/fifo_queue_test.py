@@ -430,6 +430,31 @@ class FIFOQueueTest(test.TestCase):
       self.assertAllEqual(float_elems[4:8], float_val)
       self.assertAllEqual(int_elems[4:8], int_val)
 
+  def testDequeueManyOfEnqueuedBatches(self):
+    with self.test_session() as sess:
+      q = data_flow_ops.FIFOQueue(20, (dtypes_lib.float32, dtypes_lib.string),
+                                  ((4,), ()))
+      first = np.arange(32, dtype=np.float32).reshape(8, 4)
+      second = -np.arange(24, dtype=np.float32).reshape(6, 4)
+      first_strings = [b"a%d" % i for i in range(8)]
+      second_strings = [b"b%d" % i for i in range(6)]
+      q.enqueue_many((first, first_strings)).run()
+      q.enqueue(([100.0, 101.0, 102.0, 103.0], b"c")).run()
+      q.enqueue_many((second, second_strings)).run()
+
+      # A whole batch, a dequeue that spans a single enqueue and a batch, and
+      # parts of a batch.
+      for size, expected, expected_strings in (
+          (8, first, first_strings),
+          (2, [[100.0, 101.0, 102.0, 103.0], second[0]],
+           [b"c", second_strings[0]]),
+          (2, second[1:3], second_strings[1:3]),
+          (3, second[3:6], second_strings[3:6])):
+        values, strings = sess.run(q.dequeue_many(size))
+        self.assertAllEqual(expected, values)
+        self.assertAllEqual(expected_strings, strings)
+      self.assertEqual(0, q.size().eval())
+
   def testHighDimension(self):
     with self.test_session():
       q = data_flow_ops.FIFOQueue(10, dtypes_lib.int32, (4, 4, 4, 4))
@@ -46,12 +46,13 @@ class MatrixSolveOpTest(test.TestCase):
           b = np.tile(b, batch_dims + [1, 1])
 
         np_ans = np.linalg.solve(a_np, b)
-        with self.test_session():
-          tf_ans = linalg_ops.matrix_solve(a, b, adjoint=adjoint)
-          out = tf_ans.eval()
-          self.assertEqual(tf_ans.get_shape(), out.shape)
-          self.assertEqual(np_ans.shape, out.shape)
-          self.assertAllClose(np_ans, out)
+        for use_gpu in False, True:
+          with self.test_session(use_gpu=use_gpu):
+            tf_ans = linalg_ops.matrix_solve(a, b, adjoint=adjoint)
+            out = tf_ans.eval()
+            self.assertEqual(tf_ans.get_shape(), out.shape)
+            self.assertEqual(np_ans.shape, out.shape)
+            self.assertAllClose(np_ans, out)
 
   def testSolve(self):
     matrix = np.array([[1. + 5.j, 2. + 6.j], [3. + 7j, 4. + 8.j]])
@@ -89,12 +90,13 @@ class MatrixSolveOpTest(test.TestCase):
 
   def testNotInvertible(self):
     # The input should be invertible.
-    with self.test_session():
-      with self.assertRaisesOpError("Input matrix is not invertible."):
-        # All rows of the matrix below add to zero
-        matrix = constant_op.constant(
-            [[1., 0., -1.], [-1., 1., 0.], [0., -1., 1.]])
-        linalg_ops.matrix_solve(matrix, matrix).eval()
+    for use_gpu in False, True:
+      with self.test_session(use_gpu=use_gpu):
+        with self.assertRaisesOpError("Input matrix is not invertible."):
+          # All rows of the matrix below add to zero
+          matrix = constant_op.constant(
+              [[1., 0., -1.], [-1., 1., 0.], [0., -1., 1.]])
+          linalg_ops.matrix_solve(matrix, matrix).eval()
 
 
 if __name__ == "__main__":
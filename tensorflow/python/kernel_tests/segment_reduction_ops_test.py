@@ -121,6 +121,24 @@ class SegmentReductionOpTest(SegmentReductionHelper):
           # and may therefore vary dynamically.
           self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testValuesGPU(self):
+    # Runs of repeated segment ids span several rows handled per thread by the
+    # GPU kernels, and segment 3 is empty.
+    segment_ids = [0] * 3 + [1] * 40 + [2] + [4] * 17 + [5] * 9
+    np_x = np.random.rand(len(segment_ids), 5)
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      x = np_x.astype(dtype.as_numpy_dtype)
+      for tf_op, np_op in [(math_ops.segment_sum, np.sum),
+                           (math_ops.segment_mean, np.mean),
+                           (math_ops.segment_max, np.max)]:
+        np_ans = np.zeros((segment_ids[-1] + 1, 5))
+        for segment in set(segment_ids):
+          np_ans[segment] = np_op(
+              x[np.array(segment_ids) == segment], axis=0)
+        with self.test_session(use_gpu=True):
+          tf_ans = tf_op(data=x, segment_ids=segment_ids).eval()
+        self.assertAllClose(np_ans, tf_ans)
+
   def testSegmentIdsShape(self):
     shape = [4, 4]
     tf_x, _ = self._input(shape)
@@ -256,6 +274,22 @@ class UnsortedSegmentSumTest(SegmentReductionHelper):
         self.assertAllClose(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, s)
 
+  def testHeavyDuplicates(self):
+    # Most rows go to a few segments, as in the gradients of popular
+    # embedding rows.
+    num_segments = 50
+    segment_ids = np.random.randint(0, 3, size=1000).astype(np.int32)
+    segment_ids[::10] = np.random.randint(0, num_segments, size=100)
+    np_x = np.random.rand(1000, 7)
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      x = np_x.astype(dtype.as_numpy_dtype)
+      np_ans = np.zeros((num_segments, 7))
+      np.add.at(np_ans, segment_ids, x)
+      with self.test_session(use_gpu=True):
+        tf_ans = math_ops.unsorted_segment_sum(
+            data=x, segment_ids=segment_ids, num_segments=num_segments).eval()
+      self.assertAllClose(np_ans, tf_ans)
+
   def testGradientSegmentSum(self):
     num_cols = 2
     indices_flat = np.array([0, 4, 0, 8, 3, 8, 4, 7, 7, 3])
@@ -403,6 +437,26 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           # and may therefore vary dynamically.
           self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testValuesGPU(self):
+    segment_ids = [0] * 3 + [1] * 40 + [2] + [4] * 17 + [5] * 9
+    np_indices = np.random.randint(0, 30, len(segment_ids)).astype(np.int32)
+    np_x = np.random.rand(30, 5)
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      x = np_x.astype(dtype.as_numpy_dtype)
+      for tf_op, np_op in [
+          (math_ops.sparse_segment_sum, np.sum),
+          (math_ops.sparse_segment_mean, np.mean),
+          (math_ops.sparse_segment_sqrt_n,
+           lambda a, axis: np.sum(a, axis=axis) / np.sqrt(a.shape[0]))]:
+        np_ans = np.zeros((segment_ids[-1] + 1, 5))
+        for segment in set(segment_ids):
+          rows = np_indices[np.array(segment_ids) == segment]
+          np_ans[segment] = np_op(x[rows], axis=0)
+        with self.test_session(use_gpu=True):
+          tf_ans = tf_op(
+              data=x, indices=np_indices, segment_ids=segment_ids).eval()
+        self.assertAllClose(np_ans, tf_ans)
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
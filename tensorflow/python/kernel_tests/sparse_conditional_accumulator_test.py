@@ -184,6 +184,25 @@ class IndexedSlicesConditionalAccumulatorTest(test.TestCase):
       self.assertAllEqual(val.values, [[0.5, 0.5], [0, 2], [3, 0]])
       self.assertAllEqual(val.dense_shape, [-1, 2])
 
+  def testAccumulatorTakeGradUnsortedAndRepeatedIndices(self):
+    with self.test_session() as sess:
+      q = data_flow_ops.SparseConditionalAccumulator(
+          dtypes_lib.float32, name="Q", shape=())
+
+      accum_op = q.apply_grad(
+          [2, 0, 2], np.array([[1, 0], [2, 2], [0, 3]]).astype(np.float32),
+          [6, 2])
+      accum_op.run()
+      accum_op = q.apply_grad(
+          [5, 0], np.array([[4, 4], [0, 2]]).astype(np.float32), [6, 2])
+      accum_op.run()
+
+      takeg_t = q.take_indexed_slices_grad(1)
+      val = sess.run(takeg_t)
+      # The slices of a repeated index count as one gradient.
+      self.assertAllEqual(val.indices, [0, 2, 5])
+      self.assertAllEqual(val.values, [[1, 2], [1, 3], [4, 4]])
+
   def testAccumulatorRepeatedTakeGrad(self):
     with self.test_session() as sess:
       q = data_flow_ops.SparseConditionalAccumulator(
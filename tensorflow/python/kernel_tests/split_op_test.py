@@ -245,6 +245,13 @@ class SplitOpTest(test.TestCase):
       self._compare(self._makeData((6, 7, 18), dtype), 0, 3)
       self._compare(self._makeData((6, 7, 9), dtype), 0, 3)
 
+  def testSplitLarge(self):
+    # Large enough to be copied by several threads, with shard boundaries
+    # falling in the middle of output rows.
+    inp = np.random.rand(3, 2 * 1024 * 1024 + 6).astype(np.float32)
+    self._compare(inp, 1, 2)
+    self._compare(inp.reshape(6, 1024 * 1024 + 3), 0, 3)
+
   def _RunAndVerify(self, dtype, large_num_splits=False):
     # Random dims of rank 5
     shape = np.random.randint(0, 5, size=5)
@@ -126,6 +126,21 @@ class StringSplitOpTest(test.TestCase):
                           [b"hello", b"cruel", b"world", b"hello cruel world"])
       self.assertAllEqual(shape, [2, 3])
 
+  def testStringSplitLargeBatch(self):
+    # Large enough to be split across several threads.
+    strings = ["%d a,,b %d" % (i, i) for i in range(10000)]
+
+    with self.test_session() as sess:
+      tokens = string_ops.string_split(strings, delimiter=" ,")
+      indices, values, shape = sess.run(tokens)
+      expected_values = []
+      for i in range(10000):
+        expected_values.extend([str(i).encode(), b"a", b"b", str(i).encode()])
+      self.assertAllEqual(indices, [[i, j] for i in range(10000)
+                                    for j in range(4)])
+      self.assertAllEqual(values, expected_values)
+      self.assertAllEqual(shape, [10000, 4])
+
 
 if __name__ == "__main__":
   test.main()
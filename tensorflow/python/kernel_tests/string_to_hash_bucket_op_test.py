@@ -46,6 +46,16 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  def testStringToHashBucketsFastLargeBatch(self):
+    # Large enough to be split across several threads.
+    with self.test_session():
+      input_string = array_ops.placeholder(dtypes.string)
+      output = string_ops.string_to_hash_bucket_fast(input_string, 10)
+      strings = ['a', 'b', 'c', 'd'] * 5000
+      result = output.eval(feed_dict={input_string: strings})
+
+      self.assertAllEqual([9, 2, 2, 5] * 5000, result)
+
   def testStringToOneHashBucketLegacyHash(self):
     with self.test_session():
       input_string = array_ops.placeholder(dtypes.string)
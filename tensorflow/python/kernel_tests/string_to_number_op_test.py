@@ -45,6 +45,21 @@ class StringToNumberOpTest(test.TestCase):
         with self.assertRaisesOpError(outstr):
           output.eval(feed_dict={input_string: [instr]})
 
+  def testLargeBatch(self):
+    # Large enough to be split across several threads.
+    with self.test_session():
+      input_string = array_ops.placeholder(dtypes.string)
+      output = parsing_ops.string_to_number(input_string, out_type=dtypes.int32)
+      strings = [str(i) for i in range(10000)]
+      self.assertAllEqual(
+          list(range(10000)), output.eval(feed_dict={input_string: strings}))
+
+      # The first string that can't be converted is reported.
+      strings[7000] = "7000foobar"
+      strings[3000] = "3000foobar"
+      with self.assertRaisesOpError(_ERROR_MESSAGE + "3000foobar"):
+        output.eval(feed_dict={input_string: strings})
+
   def testToFloat(self):
     self._test(dtypes.float32,
                [("0", 0), ("3", 3), ("-1", -1),
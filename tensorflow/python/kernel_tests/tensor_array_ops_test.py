@@ -126,6 +126,26 @@ class TensorArrayTest(test.TestCase):
 
       self.assertAllEqual([3, 0, 1], c0.eval().shape)
 
+  def testTensorArrayWriteStackAndConcatContiguous(self):
+    # Elements of 64 bytes are written to one contiguous buffer on CPU.
+    with self.test_session(use_gpu=True):
+      values = np.arange(48, dtype=np.float32).reshape(3, 4, 4)
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=3, clear_after_read=False)
+      for i in range(3):
+        ta = ta.write(i, values[i])
+      self.assertAllEqual(values, ta.stack().eval())
+      self.assertAllEqual(values.reshape(12, 4), ta.concat().eval())
+      self.assertAllEqual(values[1], ta.read(1).eval())
+      self.assertAllEqual(values[1:], ta.gather([1, 2]).eval())
+
+      # A value of another shape is kept as is.
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=2, infer_shape=False)
+      w1 = ta.write(0, values[0]).write(1, values[1].reshape(2, 8))
+      with self.assertRaisesOpError("TensorArray has inconsistent shapes"):
+        w1.stack().eval()
+
   def _testTensorArrayWriteConcat(self, tf_dtype):
     with self.test_session(use_gpu=True):
       ta = tensor_array_ops.TensorArray(
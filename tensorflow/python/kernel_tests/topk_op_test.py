@@ -153,6 +153,18 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testLargeStableTopK(self):
+    b = 3
+    n = 5000
+    for dtype in [np.int32, np.int64, np.float32, np.float64]:
+      for k in [64, 1000, 4999]:
+        # Lots of repeated values, including negative ones.
+        inputs = np.random.randint(-5, 5, size=(b, n)).astype(dtype)
+        indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+        values = -np.sort(-inputs, axis=1)[:, :k]
+        self._validateTopK(inputs, k, values, indices)
+        self._validateTopK(inputs, k, values, indices, sorted=False)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
@@ -49,6 +49,27 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]].decode('ascii'))
 
+  def testLargeInputs(self):
+    # Large enough to be uniquified on multiple threads on the CPU.
+    for dtype in [np.int32, np.int64, np.float32]:
+      x = np.random.randint(-5000, high=5000, size=200000).astype(dtype)
+      with self.test_session(use_gpu=True) as sess:
+        y, idx = array_ops.unique(x)
+        tf_y, tf_idx = sess.run([y, idx])
+
+      # Unique values are ordered by their first occurrence.
+      _, first = np.unique(x, return_index=True)
+      self.assertAllEqual(x[np.sort(first)], tf_y)
+      self.assertAllEqual(x, tf_y[tf_idx])
+
+  def testEmpty(self):
+    with self.test_session(use_gpu=True) as sess:
+      y, idx = array_ops.unique(np.array([], dtype=np.int64))
+      tf_y, tf_idx = sess.run([y, idx])
+
+    self.assertEqual(0, len(tf_y))
+    self.assertEqual(0, len(tf_idx))
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -81,6 +102,19 @@ class UniqueWithCountsTest(test.TestCase):
       v = [1 if x[i] == value.decode('ascii') else 0 for i in range(7000)]
       self.assertEqual(count, sum(v))
 
+  def testLargeInputs(self):
+    for dtype in [np.int32, np.int64]:
+      x = np.random.randint(0, high=3000, size=200000).astype(dtype)
+      with self.test_session(use_gpu=True) as sess:
+        y, idx, count = array_ops.unique_with_counts(x)
+        tf_y, tf_idx, tf_count = sess.run([y, idx, count])
+
+      _, first, np_count = np.unique(x, return_index=True, return_counts=True)
+      order = np.argsort(first)
+      self.assertAllEqual(x[first[order]], tf_y)
+      self.assertAllEqual(x, tf_y[tf_idx])
+      self.assertAllEqual(np_count[order], tf_count)
+
 
 if __name__ == '__main__':
   test.main()
@@ -156,6 +156,28 @@ class XentTest(test.TestCase):
         np.array([[1., 1., 1., 1.], [1., 2., 3., 4.]]).astype(np.float64),
         np.array([[0., 0., 0., 1.], [0., .5, .5, 0.]]).astype(np.float64))
 
+  def testLargeVocabulary(self):
+    # Rows longer than a tile are reduced in several tiles and merged.
+    np.random.seed(1)
+    for dtype in np.float32, np.float64:
+      features = (np.random.randn(3, 20000) * 10).astype(dtype)
+      features[1] += 100.
+      labels = np.zeros([3, 20000]).astype(dtype)
+      labels[0, 17] = 1.
+      labels[1, [3, 9000, 19999]] = [.25, .25, .5]
+      labels[2] = np.random.rand(20000).astype(dtype)
+      labels[2] /= labels[2].sum()
+      np_loss, np_backprop = self._npXent(
+          features.astype(np.float64), labels.astype(np.float64))
+      tol = 1e-4 if dtype == np.float32 else 1e-10
+      for use_gpu in False, True:
+        with self.test_session(use_gpu=use_gpu) as sess:
+          loss, backprop = gen_nn_ops._softmax_cross_entropy_with_logits(
+              features, labels)
+          tf_loss, tf_backprop = sess.run([loss, backprop])
+        self.assertAllClose(np_loss, tf_loss, rtol=tol, atol=tol)
+        self.assertAllClose(np_backprop, tf_backprop, rtol=tol, atol=tol)
+
   def testGradient(self):
     with self.test_session() as sess:
       l = constant_op.constant(
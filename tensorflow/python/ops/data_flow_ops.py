@@ -1607,7 +1607,7 @@ class StagingArea(BaseStagingArea):
   """
 
   def __init__(self, dtypes, shapes=None, names=None, shared_name=None,
-                  capacity=0, memory_limit=0):
+                  capacity=0, memory_limit=0, prefetch=False):
     """Constructs a staging area object.
 
     The two optional lists, `shapes` and `names`, must be of the same length
@@ -1637,6 +1637,11 @@ class StagingArea(BaseStagingArea):
       shared_name: (Optional.) A name to be used for the shared object. By
         passing the same name to two different python objects they will share
         the underlying staging area. Must be a string.
+      prefetch: (Optional.) If True, `put` keeps its values in host memory and
+        copies them to the device of the staging area asynchronously, on the
+        device's host to device stream.  The `put` op then completes without
+        waiting for the copy, and `get` waits for it if it is still running.
+        A `memory_limit` also bounds the device memory of copies in flight.
 
     Raises:
       ValueError: If one of the arguments is invalid.
@@ -1645,6 +1650,7 @@ class StagingArea(BaseStagingArea):
     super(StagingArea, self).__init__(dtypes, shapes,
                                           names, shared_name,
                                           capacity, memory_limit)
+    self._prefetch = prefetch
 
   def put(self, values, name=None):
     """Create an op that places a value into the staging area.
@@ -1670,10 +1676,11 @@ class StagingArea(BaseStagingArea):
                   if isinstance(values, (list, tuple)) else None)
       vals, _ = self._check_put_dtypes(values, indices)
 
+      stage = (gen_data_flow_ops.stage_to_device if self._prefetch
+               else gen_data_flow_ops.stage)
       with ops.colocate_with(self._coloc_op):
-        op = gen_data_flow_ops.stage(values=vals, shared_name=self._name,
-                                     name=scope, capacity=self._capacity,
-                                     memory_limit=self._memory_limit)
+        op = stage(values=vals, shared_name=self._name, name=scope,
+                   capacity=self._capacity, memory_limit=self._memory_limit)
 
       return op
 
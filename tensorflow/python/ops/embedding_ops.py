@@ -28,6 +28,7 @@ from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
@@ -401,6 +402,17 @@ def embedding_lookup_sparse(params,
     if segment_ids.dtype != dtypes.int32:
       segment_ids = math_ops.cast(segment_ids, dtypes.int32)
 
+    if (len(params) == 1 and ignore_weights and max_norm is None and
+        params[0].dtype.base_dtype in (dtypes.float32, dtypes.float64)):
+      # Gather and combine in a single kernel, without materializing the
+      # looked up embeddings.  As with the sparse segment ops below, the
+      # output has one row per segment up to the last non-empty one.
+      num_segments = math_ops.maximum(math_ops.reduce_max(segment_ids) + 1, 0)
+      with ops.colocate_with(params[0]):
+        return gen_math_ops.sparse_embedding_lookup(
+            params[0], sp_ids.values, segment_ids, num_segments,
+            combiner=combiner, name=name)
+
     ids = sp_ids.values
     if ignore_weights:
       ids, idx = array_ops.unique(ids)
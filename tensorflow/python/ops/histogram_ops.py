@@ -28,9 +28,16 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import clip_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 
 
+# The value types supported by the HistogramFixedWidth kernel. Histograms of
+# other types are computed by the ops below.
+_NATIVE_HISTOGRAM_VALUE_TYPES = (dtypes.int32, dtypes.int64, dtypes.float32,
+                                 dtypes.float64)
+
+
 def histogram_fixed_width(values,
                           value_range,
                           nbins=100,
@@ -71,9 +78,15 @@ def histogram_fixed_width(values,
   with ops.name_scope(name, 'histogram_fixed_width',
                       [values, value_range, nbins]) as scope:
     values = ops.convert_to_tensor(values, name='values')
-    values = array_ops.reshape(values, [-1])
     value_range = ops.convert_to_tensor(value_range, name='value_range')
     nbins = ops.convert_to_tensor(nbins, dtype=dtypes.int32, name='nbins')
+    if (values.dtype in _NATIVE_HISTOGRAM_VALUE_TYPES and
+        value_range.dtype == values.dtype and
+        dtypes.as_dtype(dtype) in (dtypes.int32, dtypes.int64)):
+      return gen_math_ops._histogram_fixed_width(
+          values, value_range, nbins, dtype=dtype, name=scope)
+
+    values = array_ops.reshape(values, [-1])
     nbins_float = math_ops.cast(nbins, values.dtype)
 
     # Map tensor values that fall within value_range to [0, 1].
@@ -89,8 +102,8 @@ def histogram_fixed_width(values,
     indices = math_ops.cast(
         clip_ops.clip_by_value(indices, 0, nbins_float - 1), dtypes.int32)
 
-    # TODO(langmore) This creates an array of ones to add up and place in the
-    # bins.  This is inefficient, so replace when a better Op is available.
+    # This creates an array of ones to add up and place in the bins, which is
+    # only done for the types the HistogramFixedWidth kernel does not support.
     return math_ops.unsorted_segment_sum(
         array_ops.ones_like(indices, dtype=dtype),
         indices,
@@ -64,6 +64,46 @@ class HistogramFixedWidthTest(test.TestCase):
       self.assertEqual(dtypes.int32, hist.dtype)
       self.assertAllClose(expected_bin_counts, hist.eval())
 
+  def test_int64_values_on_gpu(self):
+    # Bins will be:
+    #   (-inf, 2), [2, 4), [4, 6), [6, 8), [8, inf)
+    value_range = np.int64([0, 10])
+    values = np.int64([-5, 0, 3, 4, 9, 10, 100])
+    expected_bin_counts = [2, 1, 1, 0, 3]
+    with self.test_session(use_gpu=True):
+      hist = histogram_ops.histogram_fixed_width(
+          values, value_range, nbins=5, dtype=dtypes.int64)
+      self.assertEqual(dtypes.int64, hist.dtype)
+      self.assertAllEqual(expected_bin_counts, hist.eval())
+
+  def test_nan_values_go_to_first_bin(self):
+    value_range = [0.0, 5.0]
+    values = [np.nan, 1.5, np.nan, 4.5]
+    expected_bin_counts = [2, 1, 0, 0, 1]
+    with self.test_session(use_gpu=True):
+      hist = histogram_ops.histogram_fixed_width(values, value_range, nbins=5)
+      self.assertAllEqual(expected_bin_counts, hist.eval())
+
+  def test_float16_values(self):
+    # float16 is not supported by the HistogramFixedWidth kernel.
+    value_range = np.float16([0.0, 5.0])
+    values = np.float16([-1.0, 0.0, 1.5, 2.0, 5.0, 15])
+    expected_bin_counts = [2, 1, 1, 0, 2]
+    with self.test_session():
+      hist = histogram_ops.histogram_fixed_width(values, value_range, nbins=5)
+      self.assertAllEqual(expected_bin_counts, hist.eval())
+
+  def test_random_values_match_numpy(self):
+    values = self.rng.randn(100000)
+    value_range = [-2.0, 2.0]
+    expected_bin_counts, _ = np.histogram(
+        np.clip(values, -2.0, 2.0 - 1e-9), bins=100, range=value_range)
+    with self.test_session(use_gpu=True):
+      hist = histogram_ops.histogram_fixed_width(
+          values, np.float64(value_range), nbins=100)
+      # Values at the edges of the bins may be rounded differently.
+      self.assertAllClose(expected_bin_counts, hist.eval(), atol=2)
+
   def test_2d_values(self):
     # Bins will be:
     #   (-inf, 1), [1, 2), [2, 3), [3, 4), [4, inf)
@@ -21,6 +21,7 @@ See the @{$python/image} guide.
 @@decode_bmp
 @@decode_gif
 @@decode_jpeg
+@@decode_and_crop_and_resize_jpeg
 @@encode_jpeg
 @@decode_png
 @@encode_png
@@ -2460,6 +2460,44 @@ class JpegTest(test_util.TensorFlowTestCase):
         self.assertEqual(image.get_shape().as_list(),
                          [None, None, channels or None])
 
+  def testDecodeAndCropAndResize(self):
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    windows = [[0, 0, 256, 128], [17, 9, 100, 61], [200, 100, 56, 28]]
+    sizes = [[64, 32], [31, 47], [128, 64]]
+    for window, size in zip(windows, sizes):
+      with self.test_session() as sess:
+        jpeg0 = io_ops.read_file(path)
+        image0 = image_ops.decode_jpeg(jpeg0, fancy_upscaling=False)
+        crop = image_ops.crop_to_bounding_box(image0, *window)
+        expected = image_ops.resize_bilinear(
+            array_ops.expand_dims(crop, 0), size)[0]
+        exact = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, window, size, fancy_upscaling=False, dct_downscale=False)
+        scaled = image_ops.decode_and_crop_and_resize_jpeg(
+            jpeg0, window, size, fancy_upscaling=False)
+        expected, exact, scaled = sess.run([expected, exact, scaled])
+        self.assertEqual(exact.shape, tuple(size) + (3,))
+        self.assertAllClose(expected, exact, atol=1e-3)
+        # Downscaling in the DCT domain only changes the result slightly.
+        self.assertLess(np.abs(expected - scaled).mean(), 4)
+
+  def testDecodeAndCropAndResizeInvalidWindow(self):
+    path = ("tensorflow/core/lib/jpeg/testdata/"
+            "jpeg_merge_test1.jpg")
+    with self.test_session() as sess:
+      image = image_ops.decode_and_crop_and_resize_jpeg(
+          io_ops.read_file(path), [200, 100, 57, 28], [8, 8])
+      with self.assertRaisesOpError("is not inside the image"):
+        sess.run(image)
+
+  def testDecodeAndCropAndResizeShape(self):
+    jpeg = constant_op.constant("nonsense")
+    for channels in 0, 1, 3:
+      image = image_ops.decode_and_crop_and_resize_jpeg(
+          jpeg, [0, 0, 8, 8], [5, 7], channels=channels)
+      self.assertEqual(image.get_shape().as_list(), [5, 7, channels or None])
+
 
 class PngTest(test_util.TensorFlowTestCase):
 
@@ -2864,5 +2902,71 @@ class FormatTest(test_util.TensorFlowTestCase):
           decode(io_ops.read_file(path)).eval()
 
 
+class NonMaxSuppressionTest(test_util.TensorFlowTestCase):
+
+  def _RandomBoxes(self, batch_size, num_boxes):
+    # Corners in random order, clustered enough for many boxes to overlap.
+    centers = np.random.rand(batch_size, num_boxes, 2) * 10
+    sizes = np.random.rand(batch_size, num_boxes, 2) * 3
+    corners = np.concatenate([centers - sizes, centers + sizes], axis=2)
+    flip = np.random.rand(batch_size, num_boxes) < 0.5
+    corners[flip] = corners[flip][:, [2, 3, 0, 1]]
+    return corners.astype(np.float32)
+
+  def testSelectFromThreeClusters(self):
+    boxes_np = [[0, 0, 1, 1], [0, 0.1, 1, 1.1], [0, -0.1, 1, 0.9],
+                [0, 10, 1, 11], [0, 10.1, 1, 11.1], [0, 100, 1, 101]]
+    scores_np = [0.9, 0.75, 0.6, 0.95, 0.5, 0.3]
+    for use_gpu in [False, True]:
+      with self.test_session(use_gpu=use_gpu):
+        selected_indices = gen_image_ops.non_max_suppression_v2(
+            constant_op.constant(boxes_np, dtype=dtypes.float32),
+            constant_op.constant(scores_np, dtype=dtypes.float32),
+            constant_op.constant(3), constant_op.constant(0.5))
+        self.assertAllEqual([3, 0, 5], selected_indices.eval())
+
+  def testCompareGPUWithCPU(self):
+    if not test.is_gpu_available():
+      return
+    np.random.seed(5)
+    # More than 64 boxes, so that the suppression mask spans several words.
+    batch_size, num_boxes, num_classes = 2, 150, 3
+    boxes_np = self._RandomBoxes(batch_size, num_boxes)
+    scores_np = np.random.rand(batch_size, num_boxes,
+                               num_classes).astype(np.float32)
+    values = {}
+    for use_gpu in [False, True]:
+      with self.test_session(use_gpu=use_gpu, force_gpu=use_gpu) as sess:
+        boxes = constant_op.constant(boxes_np)
+        scores = constant_op.constant(scores_np)
+        single = [
+            gen_image_ops.non_max_suppression_v2(
+                boxes[b], scores[b, :, c], 40, 0.4)
+            for b in range(batch_size) for c in range(num_classes)]
+        batched = gen_image_ops.batched_non_max_suppression(
+            boxes, scores, 40, 0.4, 0.2)
+        values[use_gpu] = sess.run([single, batched])
+    cpu_single, cpu_batched = values[False]
+    gpu_single, gpu_batched = values[True]
+    for cpu_indices, gpu_indices in zip(cpu_single, gpu_single):
+      self.assertAllEqual(cpu_indices, gpu_indices)
+    self.assertAllEqual(cpu_batched[0], gpu_batched[0])
+    self.assertAllEqual(cpu_batched[1], gpu_batched[1])
+
+  def testCompareGPUWithCPUManyBoxes(self):
+    if not test.is_gpu_available():
+      return
+    np.random.seed(11)
+    boxes_np = self._RandomBoxes(1, 1000)[0]
+    scores_np = np.random.rand(1000).astype(np.float32)
+    values = {}
+    for use_gpu in [False, True]:
+      with self.test_session(use_gpu=use_gpu, force_gpu=use_gpu):
+        values[use_gpu] = gen_image_ops.non_max_suppression_v2(
+            constant_op.constant(boxes_np), constant_op.constant(scores_np),
+            1000, 0.3).eval()
+    self.assertAllEqual(values[False], values[True])
+
+
 if __name__ == "__main__":
   googletest.main()
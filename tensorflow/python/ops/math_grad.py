@@ -190,6 +190,33 @@ def _SparseSegmentSqrtNGrad(op, grad):
                                               dim0), None, None)
 
 
+@ops.RegisterGradient("SparseEmbeddingLookup")
+def _SparseEmbeddingLookupGrad(op, grad):
+  """Gradient for SparseEmbeddingLookup."""
+  params, ids, segment_ids, num_segments = op.inputs
+  values = array_ops.gather(grad, segment_ids)
+  combiner = op.get_attr("combiner")
+  if combiner != b"sum":
+    counts = math_ops.unsorted_segment_sum(
+        array_ops.ones_like(segment_ids, dtype=grad.dtype), segment_ids,
+        num_segments)
+    if combiner == b"mean":
+      scale = math_ops.reciprocal(counts)
+    else:
+      scale = math_ops.rsqrt(counts)
+    # Reshape the per-id scale to broadcast over the embedding dimensions.
+    scale = array_ops.reshape(
+        array_ops.gather(scale, segment_ids),
+        array_ops.concat([
+            array_ops.shape(segment_ids),
+            array_ops.ones([array_ops.rank(values) - 1], dtype=dtypes.int32)
+        ], 0))
+    values *= scale
+  # Like Gather, return the gradient as sparse rows of params.
+  return (ops.IndexedSlices(values, ids, array_ops.shape(params)), None, None,
+          None)
+
+
 def _SegmentMinOrMaxGrad(op, grad, is_sorted):
   """Gradient for SegmentMin and (unsorted) SegmentMax. They share similar code."""
   zeros = array_ops.zeros(array_ops.shape(op.inputs[0]),
@@ -39,6 +39,8 @@ ALL_ADVICE = {
     'AcceleratorUtilizationChecker': {},
     'JobChecker': {},  # Only available internally.
     'OperationChecker': {},
+    'InputPipelineChecker': {},
+    'CommunicationChecker': {},
 }
 
 
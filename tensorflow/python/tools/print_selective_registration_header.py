@@ -23,6 +23,9 @@ Then when compiling tensorflow, include ops_to_register.h in the include search
 path and pass -DSELECTIVE_REGISTRATION and -DSUPPORT_SELECTIVE_REGISTRATION
  - see core/framework/selective_registration.h for more details.
 
+Also pass -DSELECTIVE_REGISTRATION_STATIC_KERNEL_TABLE to look up the kernels of
+the registered ops in a table indexed by op instead of by string keys.
+
 When compiling for Android:
   bazel build -c opt --copt="-DSELECTIVE_REGISTRATION" \
     --copt="-DSUPPORT_SELECTIVE_REGISTRATION" \
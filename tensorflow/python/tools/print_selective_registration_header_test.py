@@ -194,6 +194,11 @@ constexpr inline bool ShouldRegisterOp(const char op[]) {
 }
 #define SHOULD_REGISTER_OP(op) ShouldRegisterOp(op)
 
+constexpr const char* kNecessaryOps[] = {
+"BiasAdd",
+};
+#define NECESSARY_OPS kNecessaryOps
+
 #define SHOULD_REGISTER_OP_GRADIENT false
 #endif''' % self.script_name
 
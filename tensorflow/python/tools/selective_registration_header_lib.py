@@ -147,6 +147,14 @@ def get_header_from_ops_and_kernels(ops_and_kernels,
     append('#define SHOULD_REGISTER_OP(op) ShouldRegisterOp(op)')
     append('')
 
+    line = 'constexpr const char* kNecessaryOps[] = {\n'
+    for op in sorted(ops):
+      line += '"%s",\n' % op
+    line += '};'
+    append(line)
+    append('#define NECESSARY_OPS kNecessaryOps')
+    append('')
+
     append('#define SHOULD_REGISTER_OP_GRADIENT ' + (
         'true' if 'SymbolicGradient' in ops else 'false'))
 
@@ -177,8 +177,9 @@ class BaseSaverBuilder(object):
       return resource_variable_ops.assign_variable_op(
           self.handle_op, restored_tensor)
 
-  def __init__(self, write_version=saver_pb2.SaverDef.V2):
+  def __init__(self, write_version=saver_pb2.SaverDef.V2, async_write=False):
     self._write_version = write_version
+    self._async_write = async_write
 
   def save_op(self, filename_tensor, saveables):
     """Create an Op to save 'saveables'.
@@ -216,7 +217,7 @@ class BaseSaverBuilder(object):
       # "filename_tensor" is interpreted *NOT AS A FILENAME*, but as a prefix
       # of a V2 checkpoint: e.g. "/fs/train/ckpt-<step>/tmp/worker<i>-<step>".
       return io_ops.save_v2(filename_tensor, tensor_names, tensor_slices,
-                            tensors)
+                            tensors, async_write=self._async_write)
     else:
       raise RuntimeError("Unexpected write_version: " + self._write_version)
 
@@ -340,7 +341,8 @@ class BaseSaverBuilder(object):
         # V2 format write path consists of a metadata merge step.  Once merged,
         # attempts to delete the temporary directory, "<user-fed prefix>_temp".
         merge_step = gen_io_ops.merge_v2_checkpoints(
-            sharded_prefixes, checkpoint_prefix, delete_old_dirs=True)
+            sharded_prefixes, checkpoint_prefix, delete_old_dirs=True,
+            async_write=self._async_write)
         with ops.control_dependencies([merge_step]):
           # Returns the prefix "<user-fed prefix>" only.  DOES NOT include the
           # sharded spec suffix.
@@ -1034,7 +1036,8 @@ class Saver(object):
                write_version=saver_pb2.SaverDef.V2,
                pad_step_number=False,
                save_relative_paths=False,
-               filename=None):
+               filename=None,
+               async_write=False):
     """Creates a `Saver`.
 
     The constructor adds ops to save and restore variables.
@@ -1112,6 +1115,11 @@ class Saver(object):
         checkpoint directory and reload from the copied directory.
       filename: If known at graph construction time, filename used for variable
         loading/saving.
+      async_write: If `True`, `save()` returns once the variables are copied
+        to host memory, and the V2 checkpoint is written in the background.
+        The error of a failed write is raised by the next `save()`.  The
+        checkpoint state file may name a checkpoint that is still being
+        written; restores in the same process wait for it.
 
     Raises:
       TypeError: If `var_list` is invalid.
@@ -1136,6 +1144,7 @@ class Saver(object):
     self._write_version = write_version
     self._pad_step_number = pad_step_number
     self._filename = filename
+    self._async_write = async_write
     if not defer_build:
       self.build()
     if self.saver_def:
@@ -1150,7 +1159,8 @@ class Saver(object):
     self._is_built = True
     if not self.saver_def:
       if self._builder is None:
-        self._builder = BaseSaverBuilder(self._write_version)
+        self._builder = BaseSaverBuilder(self._write_version,
+                                         async_write=self._async_write)
       if self._var_list is None:
         # pylint: disable=protected-access
         self._var_list = variables._all_saveable_objects()
@@ -169,6 +169,20 @@ class SaverTest(test.TestCase):
       save2.restore(sess, save_path)
       self.assertEquals(v.eval(), [1])
 
+  def testAsyncWrite(self):
+    save_path = os.path.join(self.get_temp_dir(), "async_write")
+    for sharded in (False, True):
+      with ops_lib.Graph().as_default(), self.test_session() as sess:
+        v = variables.Variable(10.0, name="v")
+        assign = v.assign(20.0)
+        save = saver_module.Saver(sharded=sharded, async_write=True)
+        variables.global_variables_initializer().run()
+        save.save(sess, save_path)
+        # The checkpoint holds the value at the time of the save.
+        sess.run(assign)
+        save.restore(sess, save_path)
+        self.assertEqual(10.0, v.eval())
+
   def testSaveCopyRestoreWithSaveRelativePaths(self):
     """Save, copy checkpoint dir and restore from copied dir.
 
@@ -282,6 +282,93 @@ class TrainingOpsTest(TensorFlowTestCase):
       self.assertShapeEqual(out, apply_adam)
       self.assertAllCloseAccordingToType(new_var, out)
 
+  def testApplyAdamN(self):
+    for dtype, use_gpu in itertools.product(
+        [np.float16, np.float32, np.float64], [False, True]):
+      # The last variable spans several chunks of the fused kernel.
+      self._testTypesForAdamN([7, 1, 0, 40000], dtype, use_gpu)
+
+  def _testTypesForAdamN(self, sizes, dtype, use_gpu):
+    self.setUp()
+    with self.test_session(use_gpu=use_gpu) as sess:
+      np.random.seed(len(sizes))
+      var = [np.random.rand(n).astype(dtype) for n in sizes]
+      m = [np.random.rand(n).astype(dtype) for n in sizes]
+      v = [np.random.rand(n).astype(dtype) for n in sizes]
+      grad = [(np.random.rand(n) - 0.5).astype(dtype) for n in sizes]
+      var_t = [variables.Variable(x) for x in var]
+      m_t = [variables.Variable(x) for x in m]
+      v_t = [variables.Variable(x) for x in v]
+
+      t = 2
+      beta1 = np.array(0.9, dtype=dtype)
+      beta2 = np.array(0.999, dtype=dtype)
+      lr = np.array(0.001, dtype=dtype)
+      epsilon = np.array(1e-8, dtype=dtype)
+      tf_dtype = self._toType(dtype)
+      variables.global_variables_initializer().run()
+
+      apply_adam = training_ops.apply_adam_n(
+          var_t, m_t, v_t,
+          constant_op.constant(beta1**t, tf_dtype, []),
+          constant_op.constant(beta2**t, tf_dtype, []),
+          constant_op.constant(lr, tf_dtype, []),
+          constant_op.constant(beta1, tf_dtype, []),
+          constant_op.constant(beta2, tf_dtype, []),
+          constant_op.constant(epsilon, tf_dtype, []), grad)
+      out = sess.run(apply_adam)
+      self.assertEqual(len(sizes), len(out))
+      for i in range(len(sizes)):
+        new_var, new_m, new_v = self._adamUpdateNumpy(
+            var[i], grad[i], t, m[i], v[i], lr, beta1, beta2, epsilon)
+        self.assertAllCloseAccordingToType(new_var, out[i])
+        self.assertAllCloseAccordingToType(new_m, m_t[i].eval())
+        self.assertAllCloseAccordingToType(new_v, v_t[i].eval())
+
+  def testApplyMomentumN(self):
+    for dtype, use_gpu, use_nesterov in itertools.product(
+        [np.float16, np.float32, np.float64], [False, True], [False, True]):
+      self._testTypesForMomentumN([7, 1, 0, 40000], dtype, use_gpu,
+                                  use_nesterov)
+
+  def _testTypesForMomentumN(self, sizes, dtype, use_gpu, use_nesterov):
+    self.setUp()
+    with self.test_session(use_gpu=use_gpu) as sess:
+      np.random.seed(len(sizes))
+      var = [np.random.rand(n).astype(dtype) for n in sizes]
+      accum = [np.random.rand(n).astype(dtype) for n in sizes]
+      grad = [(np.random.rand(n) - 0.5).astype(dtype) for n in sizes]
+      var_t = [variables.Variable(x) for x in var]
+      accum_t = [variables.Variable(x) for x in accum]
+      lr = np.array(0.01, dtype=dtype)
+      momentum = np.array(0.9, dtype=dtype)
+      tf_dtype = self._toType(dtype)
+      variables.global_variables_initializer().run()
+
+      apply_momentum = training_ops.apply_momentum_n(
+          var_t, accum_t, constant_op.constant(lr, tf_dtype, []), grad,
+          constant_op.constant(momentum, tf_dtype, []),
+          use_nesterov=use_nesterov)
+      out = sess.run(apply_momentum)
+      for i in range(len(sizes)):
+        new_accum = accum[i] * momentum + grad[i]
+        if use_nesterov:
+          new_var = var[i] - grad[i] * lr - new_accum * momentum * lr
+        else:
+          new_var = var[i] - lr * new_accum
+        self.assertAllCloseAccordingToType(new_var, out[i])
+        self.assertAllCloseAccordingToType(new_accum, accum_t[i].eval())
+
+  def testApplyMomentumNRejectsRepeatedVariable(self):
+    with self.test_session(use_gpu=False):
+      var = variables.Variable([1.0, 2.0])
+      accum = variables.Variable([0.0, 0.0])
+      variables.global_variables_initializer().run()
+      apply_momentum = training_ops.apply_momentum_n(
+          [var, var], [accum, accum], 0.1, [[1.0, 1.0], [1.0, 1.0]], 0.9)
+      with self.assertRaisesOpError("more than once"):
+        apply_momentum[0].op.run()
+
   def _adamUpdateNumpy(self, param, g_t, t, m, v, alpha, beta1, beta2, epsilon):
     alpha_t = alpha * np.sqrt(1 - beta2**t) / (1 - beta1**t)
 
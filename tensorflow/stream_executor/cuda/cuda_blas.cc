@@ -266,6 +266,10 @@ PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmEx)
 
 #if CUDA_VERSION >= 8000
 PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasGemmEx)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasDgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasCgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasZgemmStridedBatched)
 #endif
 
 }  // namespace wrap
@@ -2152,6 +2156,136 @@ bool CUDABlas::DoBlasGemmBatched(
   return status.ok();
 }
 
+template <typename T, typename FuncT>
+port::Status CUDABlas::DoBlasGemmStridedBatchedInternal(
+    FuncT cublas_func, Stream *stream, blas::Transpose transa,
+    blas::Transpose transb, uint64 m, uint64 n, uint64 k, T alpha,
+    const DeviceMemory<T> &a, int lda, int64 stride_a,
+    const DeviceMemory<T> &b, int ldb, int64 stride_b, T beta,
+    DeviceMemory<T> *c, int ldc, int64 stride_c, int batch_count) {
+#if CUDA_VERSION >= 8000
+  bool ok = DoBlasInternal(
+      cublas_func, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k,
+      CUDAComplex(&alpha), CUDAComplex(CUDAMemory(a)), lda, stride_a,
+      CUDAComplex(CUDAMemory(b)), ldb, stride_b, CUDAComplex(&beta),
+      CUDAComplex(CUDAMemoryMutable(c)), ldc, stride_c, batch_count);
+  if (ok) {
+    return port::Status::OK();
+  }
+  return port::Status(port::error::INTERNAL,
+                      "failed BLAS call, see log for details");
+#else
+  // cublas<t>gemmStridedBatched is only available in CUDA 8 and later, so
+  // expand the strides into the pointer arrays cublas<t>gemmBatched takes.
+  std::vector<DeviceMemory<T>> a_matrices, b_matrices, c_matrices;
+  std::vector<DeviceMemory<T> *> a_ptrs, b_ptrs, c_ptrs;
+  a_matrices.reserve(batch_count);
+  b_matrices.reserve(batch_count);
+  c_matrices.reserve(batch_count);
+  T *a_base = const_cast<T *>(CUDAMemory(a));
+  T *b_base = const_cast<T *>(CUDAMemory(b));
+  T *c_base = CUDAMemoryMutable(c);
+  for (int i = 0; i < batch_count; ++i) {
+    a_matrices.push_back(DeviceMemory<T>(
+        DeviceMemoryBase(a_base + i * stride_a, /*size=*/0)));
+    b_matrices.push_back(DeviceMemory<T>(
+        DeviceMemoryBase(b_base + i * stride_b, /*size=*/0)));
+    c_matrices.push_back(DeviceMemory<T>(
+        DeviceMemoryBase(c_base + i * stride_c, /*size=*/0)));
+    a_ptrs.push_back(&a_matrices.back());
+    b_ptrs.push_back(&b_matrices.back());
+    c_ptrs.push_back(&c_matrices.back());
+  }
+  return DoBlasGemmBatchedInternal(cublas_func, stream, transa, transb, m, n,
+                                   k, alpha, a_ptrs, lda, b_ptrs, ldb, beta,
+                                   c_ptrs, ldc, batch_count,
+                                   /*scratch_allocator=*/nullptr);
+#endif  // CUDA_VERSION >= 8000
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, float alpha, const DeviceMemory<float> &a, int lda,
+    int64 stride_a, const DeviceMemory<float> &b, int ldb, int64 stride_b,
+    float beta, DeviceMemory<float> *c, int ldc, int64 stride_c,
+    int batch_count) {
+  port::Status status = DoBlasGemmStridedBatchedInternal(
+#if CUDA_VERSION >= 8000
+      wrap::cublasSgemmStridedBatched,
+#else
+      wrap::cublasSgemmBatched,
+#endif
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return status.ok();
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, double alpha, const DeviceMemory<double> &a, int lda,
+    int64 stride_a, const DeviceMemory<double> &b, int ldb, int64 stride_b,
+    double beta, DeviceMemory<double> *c, int ldc, int64 stride_c,
+    int batch_count) {
+  port::Status status = DoBlasGemmStridedBatchedInternal(
+#if CUDA_VERSION >= 8000
+      wrap::cublasDgemmStridedBatched,
+#else
+      wrap::cublasDgemmBatched,
+#endif
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return status.ok();
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<float> alpha,
+    const DeviceMemory<std::complex<float>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<float>> &b, int ldb, int64 stride_b,
+    std::complex<float> beta, DeviceMemory<std::complex<float>> *c, int ldc,
+    int64 stride_c, int batch_count) {
+  port::Status status = DoBlasGemmStridedBatchedInternal(
+#if CUDA_VERSION >= 8000
+      wrap::cublasCgemmStridedBatched,
+#else
+      wrap::cublasCgemmBatched,
+#endif
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return status.ok();
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<double> alpha,
+    const DeviceMemory<std::complex<double>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<double>> &b, int ldb, int64 stride_b,
+    std::complex<double> beta, DeviceMemory<std::complex<double>> *c, int ldc,
+    int64 stride_c, int batch_count) {
+  port::Status status = DoBlasGemmStridedBatchedInternal(
+#if CUDA_VERSION >= 8000
+      wrap::cublasZgemmStridedBatched,
+#else
+      wrap::cublasZgemmBatched,
+#endif
+      stream, transa, transb, m, n, k, alpha, a, lda, stride_a, b, ldb,
+      stride_b, beta, c, ldc, stride_c, batch_count);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return status.ok();
+}
+
 bool CUDABlas::DoBlasHemm(Stream *stream, blas::Side side,
                           blas::UpperLower uplo, uint64 m, uint64 n,
                           std::complex<float> alpha,
@@ -112,6 +112,17 @@ class CUDABlas : public blas::BlasSupport {
       const port::ArraySlice<DeviceMemory<T> *> &c_array, int ldc,
       int batch_count, ScratchAllocator *scratch_allocator);
 
+  // A helper function to implement DoBlasGemmStridedBatched interfaces for
+  // generic types.  Before CUDA 8, cublas_func is the cublas<t>gemmBatched
+  // routine for T.
+  template <typename T, typename FuncT>
+  port::Status DoBlasGemmStridedBatchedInternal(
+      FuncT cublas_func, Stream *stream, blas::Transpose transa,
+      blas::Transpose transb, uint64 m, uint64 n, uint64 k, T alpha,
+      const DeviceMemory<T> &a, int lda, int64 stride_a,
+      const DeviceMemory<T> &b, int ldb, int64 stride_b, T beta,
+      DeviceMemory<T> *c, int ldc, int64 stride_c, int batch_count);
+
   // Helper function for implementing DoBlasGemmWithAlgorithm.
   //
   // We take alpha and beta by const reference because T might be Eigen::half,
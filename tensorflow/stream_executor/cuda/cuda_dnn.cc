@@ -244,7 +244,11 @@ CUDNN_DNN_ROUTINE_EACH_R5(PERFTOOLS_GPUTOOLS_CUDNN_WRAP)
 // clang-format off
 #if CUDNN_VERSION >= 6000
 #define CUDNN_DNN_ROUTINE_EACH_R6(__macro)                    \
-  __macro(cudnnConvolutionBiasActivationForward)
+  __macro(cudnnConvolutionBiasActivationForward)              \
+  __macro(cudnnSetRNNDescriptor_v6)                           \
+  __macro(cudnnCreatePersistentRNNPlan)                       \
+  __macro(cudnnDestroyPersistentRNNPlan)                      \
+  __macro(cudnnSetPersistentRNNPlan)
 
 // clang-format on
 CUDNN_DNN_ROUTINE_EACH_R6(PERFTOOLS_GPUTOOLS_CUDNN_WRAP)
@@ -846,6 +850,20 @@ cudnnRNNMode_t ToCudnnRnnMode(dnn::RnnMode rnn_mode) {
   }
 }
 
+#if CUDNN_VERSION >= 6000
+cudnnRNNAlgo_t ToCudnnRnnAlgo(dnn::RnnAlgorithm rnn_algorithm) {
+  switch (rnn_algorithm) {
+    case dnn::RnnAlgorithm::kRnnStandard:
+    case dnn::RnnAlgorithm::kRnnPersistStatic:
+    case dnn::RnnAlgorithm::kRnnPersistDynamic:
+      return static_cast<cudnnRNNAlgo_t>(rnn_algorithm);
+    default:
+      LOG(FATAL) << "Invalid RNN algorithm: "
+                 << static_cast<int>(rnn_algorithm);
+  }
+}
+#endif  // CUDNN_VERSION
+
 int CudnnDataTypeToByteSize(cudnnDataType_t data_type) {
   switch (data_type) {
     case CUDNN_DATA_FLOAT:
@@ -993,7 +1011,8 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
                      cudnnDirectionMode_t direction_mode,
                      cudnnRNNMode_t rnn_mode, cudnnDataType_t data_type,
                      float dropout, uint64 seed,
-                     ScratchAllocator* state_allocator)
+                     ScratchAllocator* state_allocator,
+                     dnn::RnnAlgorithm rnn_algorithm)
       : parent_(parent),
         rnn_desc_(nullptr),
         num_layers_(num_layers),
@@ -1002,7 +1021,8 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
         input_mode_(input_mode),
         direction_mode_(direction_mode),
         rnn_mode_(rnn_mode),
-        data_type_(data_type) {
+        data_type_(data_type),
+        rnn_algorithm_(rnn_algorithm) {
     // Create the dropout handle.
     cudnn_dropout_desc_.reset(new CudnnDropoutDescriptor(
         parent, cudnn_handle, dropout, seed, state_allocator));
@@ -1014,11 +1034,28 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
     // Create the RNN handle
     cudnnStatus_t status = wrap::cudnnCreateRNNDescriptor(parent_, &rnn_desc_);
     CUDNN_RETURN_IF_FAIL(status, "Unable to create RNN descriptor");
+#if CUDNN_VERSION >= 6000
+    status = wrap::cudnnSetRNNDescriptor_v6(
+        parent, cudnn_handle, rnn_desc_ /*rnnDesc*/,
+        hidden_size /*hiddenSize*/, num_layers /*numLayers*/,
+        dropout_handle() /*dropoutDesc*/, input_mode /*inputMode*/,
+        direction_mode /*direction*/, rnn_mode /*mode*/,
+        ToCudnnRnnAlgo(rnn_algorithm) /*algo*/, data_type /*dataType*/);
+#else
+    if (rnn_algorithm != dnn::RnnAlgorithm::kRnnStandard) {
+      string error_msg = port::StrCat(
+          "Persistent RNN algorithms need at least Cudnn 6.0 to work. ",
+          "Current Cudnn version: ", CUDNN_VERSION, ". ");
+      LOG(ERROR) << error_msg;
+      SetFailure(port::Status(port::error::UNIMPLEMENTED, error_msg));
+      return;
+    }
     status = wrap::cudnnSetRNNDescriptor(
         parent, rnn_desc_ /*rnnDesc*/, hidden_size /*hiddenSize*/,
         num_layers /*numLayers*/, dropout_handle() /*dropoutDesc*/,
         input_mode /*inputMode*/, direction_mode /*direction*/,
         rnn_mode /*mode*/, data_type /*dataType*/);
+#endif  // CUDNN_VERSION
     CUDNN_RETURN_IF_FAIL(status, "Unable to update RNN descriptor");
 
     // Create the params handle.
@@ -1030,6 +1067,16 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
     }
   }
   ~CudnnRnnDescriptor() override {
+#if CUDNN_VERSION >= 6000
+    if (persistent_plan_) {
+      cudnnStatus_t status =
+          wrap::cudnnDestroyPersistentRNNPlan(parent_, persistent_plan_);
+      if (status != CUDNN_STATUS_SUCCESS) {
+        LOG(ERROR) << "Unable to destroy persistent RNN plan: "
+                   << ToString(status);
+      }
+    }
+#endif  // CUDNN_VERSION
     if (rnn_desc_) {
       cudnnStatus_t status =
           wrap::cudnnDestroyRNNDescriptor(parent_, rnn_desc_);
@@ -1040,6 +1087,39 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
     if (!ok()) return nullptr;
     return rnn_desc_;
   }
+  // The dynamic persistent algorithm compiles a plan for a fixed minibatch
+  // size, which has to be bound to the descriptor before each call. The plan
+  // is rebuilt only when the batch size changes. Must be called with the
+  // cudnn handle mutex held.
+  bool PreparePersistentPlan(int batch_size) const {
+#if CUDNN_VERSION >= 6000
+    if (rnn_algorithm_ != dnn::RnnAlgorithm::kRnnPersistDynamic) return true;
+    if (persistent_plan_ && persistent_plan_batch_size_ == batch_size) {
+      return true;
+    }
+    if (persistent_plan_) {
+      wrap::cudnnDestroyPersistentRNNPlan(parent_, persistent_plan_);
+      persistent_plan_ = nullptr;
+    }
+    cudnnStatus_t status = wrap::cudnnCreatePersistentRNNPlan(
+        parent_, rnn_desc_ /*rnnDesc*/, batch_size /*minibatch*/,
+        data_type_ /*dataType*/, &persistent_plan_ /*plan*/);
+    if (status != CUDNN_STATUS_SUCCESS) {
+      LOG(ERROR) << "Unable to create persistent RNN plan: "
+                 << ToString(status);
+      persistent_plan_ = nullptr;
+      return false;
+    }
+    persistent_plan_batch_size_ = batch_size;
+    status = wrap::cudnnSetPersistentRNNPlan(parent_, rnn_desc_,
+                                             persistent_plan_);
+    if (status != CUDNN_STATUS_SUCCESS) {
+      LOG(ERROR) << "Unable to set persistent RNN plan: " << ToString(status);
+      return false;
+    }
+#endif  // CUDNN_VERSION
+    return true;
+  }
   int num_layers() const { return num_layers_; }
   int hidden_size() const { return hidden_size_; }
   int input_size() const { return input_size_; }
@@ -1077,6 +1157,11 @@ class CudnnRnnDescriptor : public CudnnDescriptorCommon<dnn::RnnDescriptor> {
   cudnnDirectionMode_t direction_mode_;
   cudnnRNNMode_t rnn_mode_;
   cudnnDataType_t data_type_;
+  dnn::RnnAlgorithm rnn_algorithm_;
+#if CUDNN_VERSION >= 6000
+  mutable cudnnPersistentRNNPlan_t persistent_plan_ = nullptr;
+  mutable int persistent_plan_batch_size_ = 0;
+#endif  // CUDNN_VERSION
   port::Status status_;
   std::unique_ptr<CudnnDropoutDescriptor> cudnn_dropout_desc_;
   std::unique_ptr<CudnnRnnParamsDescriptor> cudnn_params_desc_;
@@ -1209,38 +1294,69 @@ class CudnnRnnSequenceTensorDescriptor
   CudnnRnnSequenceTensorDescriptor(CUDAExecutor* parent, int seq_length,
                                    int batch_size, int data_size,
                                    cudnnDataType_t data_type)
+      : CudnnRnnSequenceTensorDescriptor(
+            parent,
+            std::vector<int>(seq_length > 0 ? seq_length : 0, batch_size),
+            data_size, data_type) {}
+
+  // Describes a packed batch where batch_sizes[t] sequences are active at
+  // step t. Consecutive steps with the same batch size share one handle.
+  CudnnRnnSequenceTensorDescriptor(CUDAExecutor* parent,
+                                   const std::vector<int>& batch_sizes,
+                                   int data_size, cudnnDataType_t data_type)
       : parent_(parent),
-        seq_length_(seq_length),
-        batch_size_(batch_size),
+        seq_length_(batch_sizes.size()),
+        batch_size_(batch_sizes.empty() ? 0 : batch_sizes[0]),
         data_size_(data_size),
-        data_type_(data_type) {
-    cudnnTensorDescriptor_t handle = nullptr;
-    if (seq_length <= 0) {
+        data_type_(data_type),
+        batch_sizes_(batch_sizes) {
+    if (seq_length_ <= 0) {
       string error_msg =
-          port::StrCat("sequence length must be positive: ", seq_length);
+          port::StrCat("sequence length must be positive: ", seq_length_);
       LOG(ERROR) << error_msg;
       SetFailure(port::Status(port::error::UNKNOWN, error_msg));
       return;
     }
-    cudnnStatus_t status = wrap::cudnnCreateTensorDescriptor(parent, &handle);
-    CUDNN_RETURN_IF_FAIL(status, "Failed to create tensor descriptor");
-    int dims[] = {batch_size, data_size, 1};
-    int strides[] = {dims[1] * dims[2], dims[2], 1};
-    status = wrap::cudnnSetTensorNdDescriptor(
-        parent, handle /*tensorDesc*/, data_type /*dataType*/,
-        sizeof(dims) / sizeof(dims[0]) /*nbDims*/, dims /*dimA*/,
-        strides /*strideA*/);
-    CUDNN_RETURN_IF_FAIL(status, "Failed to update tensor descriptor");
-    // Replicate handle across the number of steps.
-    handles_.assign(seq_length, handle);
+    for (int i = 0; i < seq_length_; ++i) {
+      if (batch_sizes[i] <= 0 ||
+          (i > 0 && batch_sizes[i] > batch_sizes[i - 1])) {
+        string error_msg = port::StrCat(
+            "batch sizes must be positive and non-increasing, got ",
+            batch_sizes[i], " at step ", i);
+        LOG(ERROR) << error_msg;
+        SetFailure(port::Status(port::error::INVALID_ARGUMENT, error_msg));
+        return;
+      }
+    }
+    handles_.reserve(seq_length_);
+    for (int i = 0; i < seq_length_; ++i) {
+      if (i > 0 && batch_sizes[i] == batch_sizes[i - 1]) {
+        handles_.push_back(handles_.back());
+        continue;
+      }
+      cudnnTensorDescriptor_t handle = nullptr;
+      cudnnStatus_t status = wrap::cudnnCreateTensorDescriptor(parent, &handle);
+      CUDNN_RETURN_IF_FAIL(status, "Failed to create tensor descriptor");
+      distinct_handles_.push_back(handle);
+      int dims[] = {batch_sizes[i], data_size, 1};
+      int strides[] = {dims[1] * dims[2], dims[2], 1};
+      status = wrap::cudnnSetTensorNdDescriptor(
+          parent, handle /*tensorDesc*/, data_type /*dataType*/,
+          sizeof(dims) / sizeof(dims[0]) /*nbDims*/, dims /*dimA*/,
+          strides /*strideA*/);
+      CUDNN_RETURN_IF_FAIL(status, "Failed to update tensor descriptor");
+      handles_.push_back(handle);
+    }
   }
 
   ~CudnnRnnSequenceTensorDescriptor() override {
-    // Only the first one needs to be destroyed. All others are the same.
-    cudnnStatus_t status =
-        wrap::cudnnDestroyTensorDescriptor(parent_, handles_[0]);
-    CUDNN_RETURN_IF_FAIL(status,
-                         "Failed to destroy sequence tensor descriptor");
+    // Steps of the same batch size share a handle; destroy each one once.
+    for (cudnnTensorDescriptor_t handle : distinct_handles_) {
+      cudnnStatus_t status =
+          wrap::cudnnDestroyTensorDescriptor(parent_, handle);
+      CUDNN_RETURN_IF_FAIL(status,
+                           "Failed to destroy sequence tensor descriptor");
+    }
   }
 
   const cudnnTensorDescriptor_t* handles() const {
@@ -1252,6 +1368,7 @@ class CudnnRnnSequenceTensorDescriptor
   int seq_length() const { return seq_length_; }
   int batch_size() const { return batch_size_; }
   int data_size() const { return data_size_; }
+  const std::vector<int>& batch_sizes() const { return batch_sizes_; }
 
  private:
   CUDAExecutor* parent_;
@@ -1259,7 +1376,9 @@ class CudnnRnnSequenceTensorDescriptor
   int batch_size_;
   int data_size_;
   cudnnDataType_t data_type_;
+  std::vector<int> batch_sizes_;
   std::vector<cudnnTensorDescriptor_t> handles_;
+  std::vector<cudnnTensorDescriptor_t> distinct_handles_;
   port::Status status_;
   SE_DISALLOW_COPY_AND_ASSIGN(CudnnRnnSequenceTensorDescriptor);
 };
@@ -1365,6 +1484,7 @@ bool ExtractAndCheckRnnForward(
   }
   if (!(output_desc.seq_length() == model_dims->seq_length &&
         output_desc.batch_size() == model_dims->batch_size &&
+        output_desc.batch_sizes() == input_desc.batch_sizes() &&
         output_desc.data_size() ==
             model_dims->hidden_size * model_dims->dir_count)) {
     LOG(ERROR) << "Invalid output shape";
@@ -1472,6 +1592,11 @@ bool CudnnSupport::DoRnnForwardImpl(
     return false;
   }
 
+  if (!rnn_desc.PreparePersistentPlan(model_dims.batch_size)) {
+    LOG(ERROR) << "Unable to prepare the persistent RNN plan";
+    return false;
+  }
+
   // create the workspace
   DeviceMemory<uint8> workspace;
   if (!CreateRnnWorkspace(stream, parent_, ToHandle(dnn_handle_), rnn_desc,
@@ -1594,6 +1719,11 @@ bool CudnnSupport::DoRnnBackwardImpl(
     return false;
   }
 
+  if (!rnn_desc.PreparePersistentPlan(model_dims.batch_size)) {
+    LOG(ERROR) << "Unable to prepare the persistent RNN plan";
+    return false;
+  }
+
   // create the workspace
   DeviceMemory<uint8> workspace;
   if (!CreateRnnWorkspace(stream, parent_, ToHandle(dnn_handle_), rnn_desc,
@@ -1662,14 +1792,15 @@ CudnnSupport::createRnnDescriptor(int num_layers, int hidden_size,
                                   dnn::RnnMode rnn_mode,
                                   dnn::DataType data_type, float dropout,
                                   uint64 seed,
-                                  ScratchAllocator* state_allocator) {
+                                  ScratchAllocator* state_allocator,
+                                  dnn::RnnAlgorithm rnn_algorithm) {
 #if CUDNN_VERSION >= 5000
   mutex_lock lock{dnn_handle_mutex_};
   std::unique_ptr<CudnnRnnDescriptor> rnn_desc(new CudnnRnnDescriptor(
       parent_, ToHandle(dnn_handle_), num_layers, hidden_size, input_size,
       ToCudnnRnnInputMode(input_mode), ToCudnnRnnDirectionMode(direction_mode),
       ToCudnnRnnMode(rnn_mode), ToCudnnDataType(data_type), dropout, seed,
-      state_allocator));
+      state_allocator, rnn_algorithm));
   if (!rnn_desc->ok()) {
     return rnn_desc->Status();
   }
@@ -1707,6 +1838,28 @@ CudnnSupport::createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
 #endif  // CUDNN_VERSION
 }
 
+port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+CudnnSupport::createRnnSequenceTensorDescriptor(
+    const std::vector<int>& batch_sizes, int data_size,
+    dnn::DataType data_type) {
+#if CUDNN_VERSION >= 5000
+  std::unique_ptr<CudnnRnnSequenceTensorDescriptor> seq_desc(
+      new CudnnRnnSequenceTensorDescriptor(parent_, batch_sizes, data_size,
+                                           ToCudnnDataType(data_type)));
+  if (!seq_desc->ok()) {
+    return seq_desc->Status();
+  }
+  return port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>(
+      std::move(seq_desc));
+#else
+  string error_msg = port::StrCat(
+      "createRnnSequenceTensorDescriptor needs at least Cudnn 5.0 to work. ",
+      "Current Cudnn version: ", CUDNN_VERSION, ". ");
+  LOG(ERROR) << error_msg;
+  return port::Status{port::error::UNIMPLEMENTED, error_msg};
+#endif  // CUDNN_VERSION
+}
+
 port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
 CudnnSupport::createRnnStateTensorDescriptor(int num_layer, int batch_size,
                                              int data_size,
@@ -806,6 +806,26 @@ CUDADriver::ContextGetSharedMemConfig(CudaContext* context) {
   return true;
 }
 
+/* static */ bool CUDADriver::AsynchronousMemPrefetch(CudaContext* context,
+                                                      CUdeviceptr location,
+                                                      uint64 size,
+                                                      CUdevice device,
+                                                      CUstream stream) {
+#if CUDA_VERSION >= 8000
+  ScopedActivateContext activation{context};
+  CUresult res = cuMemPrefetchAsync(location, size, device, stream);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to enqueue async prefetch operation: "
+               << ToString(res);
+    return false;
+  }
+  VLOG(2) << "successfully enqueued async prefetch operation";
+  return true;
+#else
+  return false;
+#endif
+}
+
 /* static */ bool CUDADriver::AddStreamCallback(CudaContext* context,
                                                 CUstream stream,
                                                 StreamCallback callback,
@@ -932,6 +952,23 @@ CUDADriver::ContextGetSharedMemConfig(CudaContext* context) {
   return ptr;
 }
 
+/* static */ void *CUDADriver::UnifiedMemoryAllocate(CudaContext *context,
+                                                     uint64 bytes) {
+  ScopedActivateContext activated{context};
+  CUdeviceptr result = 0;
+  CUresult res = cuMemAllocManaged(&result, bytes, CU_MEM_ATTACH_GLOBAL);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to allocate "
+               << port::HumanReadableNumBytes::ToString(bytes) << " (" << bytes
+               << " bytes) of managed memory: " << ToString(res);
+    return nullptr;
+  }
+  void *ptr = reinterpret_cast<void *>(result);
+  VLOG(2) << "allocated " << ptr << " of managed memory for context "
+          << context << " of " << bytes << " bytes";
+  return ptr;
+}
+
 /* static */ void CUDADriver::DeviceDeallocate(CudaContext* context,
                                                void *location) {
   ScopedActivateContext activation{context};
@@ -1133,6 +1170,79 @@ CUDADriver::ContextGetSharedMemConfig(CudaContext* context) {
   return false;
 }
 
+#if CUDA_VERSION >= 10010
+/* static */ port::Status CUDADriver::StreamBeginCapture(CudaContext *context,
+                                                         CUstream stream) {
+  ScopedActivateContext activated{context};
+  CUresult res =
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL);
+  if (res != CUDA_SUCCESS) {
+    return port::InternalError(port::StrCat(
+        "failed to begin capturing stream: ", ToString(res)));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status CUDADriver::StreamEndCapture(CudaContext *context,
+                                                       CUstream stream,
+                                                       CUgraph *graph) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuStreamEndCapture(stream, graph);
+  if (res != CUDA_SUCCESS) {
+    return port::InternalError(
+        port::StrCat("failed to end capturing stream: ", ToString(res)));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status CUDADriver::GraphInstantiate(CudaContext *context,
+                                                       CUgraph graph,
+                                                       CUgraphExec *exec) {
+  ScopedActivateContext activated{context};
+#if CUDA_VERSION >= 11040
+  CUresult res = cuGraphInstantiateWithFlags(exec, graph, 0 /* = flags */);
+#else
+  CUresult res = cuGraphInstantiate(exec, graph, nullptr, nullptr, 0);
+#endif
+  if (res != CUDA_SUCCESS) {
+    return port::InternalError(
+        port::StrCat("failed to instantiate graph: ", ToString(res)));
+  }
+  return port::Status::OK();
+}
+
+/* static */ port::Status CUDADriver::GraphLaunch(CudaContext *context,
+                                                  CUgraphExec exec,
+                                                  CUstream stream) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphLaunch(exec, stream);
+  if (res != CUDA_SUCCESS) {
+    return port::InternalError(
+        port::StrCat("failed to launch graph: ", ToString(res)));
+  }
+  return port::Status::OK();
+}
+
+/* static */ void CUDADriver::DestroyGraph(CudaContext *context,
+                                           CUgraph *graph, CUgraphExec *exec) {
+  ScopedActivateContext activated{context};
+  if (*exec != nullptr) {
+    CUresult res = cuGraphExecDestroy(*exec);
+    if (res != CUDA_SUCCESS) {
+      LOG(ERROR) << "failed to destroy graph instantiation: " << ToString(res);
+    }
+    *exec = nullptr;
+  }
+  if (*graph != nullptr) {
+    CUresult res = cuGraphDestroy(*graph);
+    if (res != CUDA_SUCCESS) {
+      LOG(ERROR) << "failed to destroy graph: " << ToString(res);
+    }
+    *graph = nullptr;
+  }
+}
+#endif  // CUDA_VERSION >= 10010
+
 /* static */ port::Status CUDADriver::SynchronousMemcpyD2H(CudaContext *context,
                                                            void *host_dst,
                                                            CUdeviceptr gpu_src,
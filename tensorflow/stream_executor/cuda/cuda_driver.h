@@ -107,6 +107,11 @@ class CUDADriver {
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1g89b3f154e17cc89b6eea277dbdf5c93a
   static void DeviceDeallocate(CudaContext* context, void *location);
 
+  // Allocates memory of size bytes that is accessible from the device and the
+  // host (managed memory) via cuMemAllocManaged. It is released with
+  // DeviceDeallocate.
+  static void *UnifiedMemoryAllocate(CudaContext* context, uint64 bytes);
+
   // Allocates page-locked and CUDA-registered memory on the host via
   // cuMemAllocHost.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gdd8311286d2c2691605362c689bc64e0
@@ -248,6 +253,13 @@ class CUDADriver {
                                        CUdeviceptr location, uint32 value,
                                        size_t uint32_count, CUstream stream);
 
+  // Enqueues a migration of size bytes of managed memory at location to
+  // device onto stream, via cuMemPrefetchAsync. Returns false if it could
+  // not be enqueued, including with CUDA versions before 8.0.
+  static bool AsynchronousMemPrefetch(CudaContext* context,
+                                      CUdeviceptr location, uint64 size,
+                                      CUdevice device, CUstream stream);
+
   // -- Synchronous memcopies.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1g4d32266788c440b0220b1a9ba5795169
 
@@ -317,6 +329,32 @@ class CUDADriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(CudaContext* context, CUstream stream);
 
+#if CUDA_VERSION >= 10010
+  // Starts capturing the work enqueued onto stream into a graph, via
+  // cuStreamBeginCapture. Only the unsafe API calls of the calling thread can
+  // invalidate the capture.
+  static port::Status StreamBeginCapture(CudaContext* context,
+                                         CUstream stream);
+
+  // Ends the capture of stream via cuStreamEndCapture, and returns the
+  // captured graph, owned by the caller, in graph.
+  static port::Status StreamEndCapture(CudaContext* context, CUstream stream,
+                                       CUgraph* graph);
+
+  // Instantiates graph for launching, via cuGraphInstantiate. exec is an
+  // outparam owned by the caller.
+  static port::Status GraphInstantiate(CudaContext* context, CUgraph graph,
+                                       CUgraphExec* exec);
+
+  // Enqueues exec onto stream via cuGraphLaunch.
+  static port::Status GraphLaunch(CudaContext* context, CUgraphExec exec,
+                                  CUstream stream);
+
+  // Destroys the graph and its instantiation, either of which may be null.
+  static void DestroyGraph(CudaContext* context, CUgraph* graph,
+                           CUgraphExec* exec);
+#endif  // CUDA_VERSION >= 10010
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
@@ -520,6 +520,15 @@ bool CUDAExecutor::MemZero(Stream *stream, DeviceMemoryBase *location,
   }
 }
 
+bool CUDAExecutor::MemPrefetch(Stream *stream, const DeviceMemoryBase &location,
+                               uint64 size) {
+  VLOG(2) << "enqueueing prefetch operation onto stream " << stream
+          << " at location " << location.opaque() << " with size " << size;
+  return CUDADriver::AsynchronousMemPrefetch(
+      context_, AsCudaDevicePtr(location), size, device_,
+      AsCUDAStreamValue(stream));
+}
+
 bool CUDAExecutor::Memset(Stream *stream, DeviceMemoryBase *location,
                            uint8 pattern, uint64 size) {
   VLOG(2) << "enqueueing memset8 operation onto stream " << stream
@@ -74,6 +74,10 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
 
   void Deallocate(DeviceMemoryBase *mem) override;
 
+  void *UnifiedMemoryAllocate(uint64 size) override {
+    return CUDADriver::UnifiedMemoryAllocate(context_, size);
+  }
+
   // CUDA allocation/registration functions are necessary because the driver
   // internally sets up buffers for DMA operations (and page locks them).
   // There's no external interface for us to otherwise control these DMA
@@ -115,6 +119,9 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
   bool Memset32(Stream *stream, DeviceMemoryBase *location, uint32 pattern,
                 uint64 size) override;
 
+  bool MemPrefetch(Stream *stream, const DeviceMemoryBase &location,
+                   uint64 size) override;
+
   bool Memcpy(Stream *stream, void *host_dst, const DeviceMemoryBase &gpu_src,
               uint64 size) override;
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/cuda/cuda_gpu_executor.h"
 #include "tensorflow/stream_executor/lib/status.h"
+#include "tensorflow/stream_executor/lib/status_macros.h"
 #include "tensorflow/stream_executor/stream.h"
 
 namespace perftools {
@@ -48,6 +49,44 @@ bool CUDAStream::IsIdle() const {
   return CUDADriver::IsStreamIdle(parent_->cuda_context(), cuda_stream_);
 }
 
+#if CUDA_VERSION >= 10010
+port::Status CUDAStream::BeginCapture() {
+  return CUDADriver::StreamBeginCapture(parent_->cuda_context(), cuda_stream_);
+}
+
+port::Status CUDAStream::EndCapture(
+    std::unique_ptr<internal::CapturedGraphInterface> *graph) {
+  CUgraph cuda_graph = nullptr;
+  SE_RETURN_IF_ERROR(CUDADriver::StreamEndCapture(parent_->cuda_context(),
+                                                  cuda_stream_, &cuda_graph));
+  CUgraphExec exec = nullptr;
+  port::Status status =
+      CUDADriver::GraphInstantiate(parent_->cuda_context(), cuda_graph, &exec);
+  if (!status.ok()) {
+    CUDADriver::DestroyGraph(parent_->cuda_context(), &cuda_graph, &exec);
+    return status;
+  }
+  graph->reset(new CUDACapturedGraph(parent_, cuda_graph, exec));
+  return port::Status::OK();
+}
+
+port::Status CUDAStream::LaunchGraph(
+    const internal::CapturedGraphInterface &graph) {
+  const CUDACapturedGraph &cuda_graph =
+      static_cast<const CUDACapturedGraph &>(graph);
+  if (cuda_graph.parent() != parent_) {
+    return port::FailedPreconditionError(
+        "graph was captured on a stream of a different executor");
+  }
+  return CUDADriver::GraphLaunch(parent_->cuda_context(), cuda_graph.exec(),
+                                 cuda_stream_);
+}
+
+CUDACapturedGraph::~CUDACapturedGraph() {
+  CUDADriver::DestroyGraph(parent_->cuda_context(), &graph_, &exec_);
+}
+#endif  // CUDA_VERSION >= 10010
+
 CUDAStream *AsCUDAStream(Stream *stream) {
   DCHECK(stream != nullptr);
   return static_cast<CUDAStream *>(stream->implementation());
@@ -57,6 +57,17 @@ class CUDAStream : public internal::StreamInterface {
   // Returns true if no work is pending or executing on the stream.
   bool IsIdle() const;
 
+#if CUDA_VERSION >= 10010
+  // Captures the work enqueued onto this stream into a CUDA graph, via stream
+  // capture. Older CUDA versions keep the UNIMPLEMENTED defaults of
+  // StreamInterface.
+  port::Status BeginCapture() override;
+  port::Status EndCapture(
+      std::unique_ptr<internal::CapturedGraphInterface> *graph) override;
+  port::Status LaunchGraph(
+      const internal::CapturedGraphInterface &graph) override;
+#endif  // CUDA_VERSION >= 10010
+
   // Retrieves an event which indicates that all work enqueued into the stream
   // has completed. Ownership of the event is not transferred to the caller, the
   // event is owned by this stream.
@@ -81,6 +92,27 @@ class CUDAStream : public internal::StreamInterface {
   CUevent completed_event_ = nullptr;
 };
 
+#if CUDA_VERSION >= 10010
+// A CUDA graph captured from a CUDAStream, instantiated for launching on the
+// streams of the same executor.
+class CUDACapturedGraph : public internal::CapturedGraphInterface {
+ public:
+  // Takes ownership of graph and exec.
+  CUDACapturedGraph(CUDAExecutor *parent, CUgraph graph, CUgraphExec exec)
+      : parent_(parent), graph_(graph), exec_(exec) {}
+
+  ~CUDACapturedGraph() override;
+
+  CUDAExecutor *parent() const { return parent_; }
+  CUgraphExec exec() const { return exec_; }
+
+ private:
+  CUDAExecutor *parent_;  // Executor of the stream the graph was captured on.
+  CUgraph graph_;
+  CUgraphExec exec_;
+};
+#endif  // CUDA_VERSION >= 10010
+
 // Helper functions to simplify extremely common flows.
 // Converts a Stream to the underlying CUDAStream implementation.
 CUDAStream *AsCUDAStream(Stream *stream);
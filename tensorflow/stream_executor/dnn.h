@@ -25,6 +25,7 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/lib/array_slice.h"
@@ -136,6 +137,15 @@ enum class RnnDirectionMode {
   kRnnBidirectional = 1,
 };
 
+// Specifies the algorithm used to run a RNN model. The persistent algorithms
+// keep the recurrent weights resident on chip across time steps, which is
+// considerably faster for small minibatches.
+enum class RnnAlgorithm {
+  kRnnStandard = 0,
+  kRnnPersistStatic = 1,
+  kRnnPersistDynamic = 2,
+};
+
 // Relevant to DepthToSpace and SpaceToDepth. This is the write layout when
 // performing depth to space and the read layout when performing space to depth.
 // It's specified with most-major dimension first and most-minor dimension last.
@@ -1839,13 +1849,17 @@ class DnnSupport {
   //  state_allocator: an memory allocator that will be used to store the state
   //    for dropout layer. The user has to maintain the memory until the model
   //    is no longer in use.
+  //  rnn_algorithm: an enum to specify the algorithm used to run the model.
+  //    Implementations that cannot honor a persistent algorithm may fall back
+  //    to the standard one.
   virtual port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>>
   createRnnDescriptor(int num_layers, int hidden_size, int input_size,
                       dnn::RnnInputMode input_mode,
                       dnn::RnnDirectionMode direction_mode,
                       dnn::RnnMode rnn_mode, dnn::DataType data_type,
                       float dropout, uint64 seed,
-                      ScratchAllocator* state_allocator) {
+                      ScratchAllocator* state_allocator,
+                      dnn::RnnAlgorithm rnn_algorithm) {
     return port::Status{port::error::UNIMPLEMENTED,
                         "createRnnDescriptor is unimplemented"};
   }
@@ -1865,6 +1879,22 @@ class DnnSupport {
                         "createRnnSequenceTensorDescriptor is unimplemented"};
   }
 
+  // Create a RNN sequence descriptor for a packed batch of variable-length
+  // sequences. The caller retains the ownership of the returned descriptor.
+  //
+  // Arguments:
+  //  batch_sizes: the number of sequences still active at each time step. It
+  //    must be non-increasing, i.e. the sequences are sorted by decreasing
+  //    length, and the data of step t holds batch_sizes[t] rows back to back.
+  //  data_size: the size of the state.
+  //  data_type: an enum to specify the type for the underlying data.
+  virtual port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(const std::vector<int>& batch_sizes,
+                                    int data_size, dnn::DataType data_type) {
+    return port::Status{port::error::UNIMPLEMENTED,
+                        "createRnnSequenceTensorDescriptor is unimplemented"};
+  }
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   virtual port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
@@ -15,10 +15,17 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/rocm/rocm_dnn.h"
 
+#include <stdlib.h>
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/stream_executor/rocm/rocm_activation.h"
 #include "tensorflow/stream_executor/rocm/rocm_diagnostics.h"
 #include "tensorflow/stream_executor/rocm/rocm_driver.h"
@@ -31,6 +38,8 @@ limitations under the License.
 #include "tensorflow/stream_executor/lib/env.h"
 #include "tensorflow/stream_executor/lib/error.h"
 #include "tensorflow/stream_executor/lib/initialize.h"
+#include "tensorflow/stream_executor/lib/numbers.h"
+#include "tensorflow/stream_executor/lib/str_util.h"
 #include "tensorflow/stream_executor/lib/strcat.h"
 #include "tensorflow/stream_executor/lib/stringpiece.h"
 #include "tensorflow/stream_executor/lib/threadpool.h"
@@ -41,8 +50,21 @@ limitations under the License.
 #include "tensorflow/stream_executor/stream_executor_pimpl.h"
 // clang-format off
 #include "rocm/include/miopen/miopen.h"
+#if defined(__has_include)
+#if __has_include("rocm/include/miopen/version.h")
+#include "rocm/include/miopen/version.h"
+#endif
+#endif
 // clang-format on
 
+// The fusion API first shipped with MIOpen 1.5.
+#if defined(MIOPEN_VERSION_MAJOR) && \
+    (MIOPEN_VERSION_MAJOR > 1 || MIOPEN_VERSION_MINOR >= 5)
+#define TF_MIOPEN_FUSION_API 1
+#else
+#define TF_MIOPEN_FUSION_API 0
+#endif
+
 namespace {
 
 // Converts (via narrowing) a type T value to a type U, and checks that the
@@ -149,6 +171,9 @@ static port::ThreadPool* GetROCmThreadpool() {
   __macro(miopenDestroy)                                   \
   __macro(miopenSetStream)                                 \
   __macro(miopenActivationForward)                         \
+  __macro(miopenCreateActivationDescriptor)                \
+  __macro(miopenSetActivationDescriptor)                   \
+  __macro(miopenDestroyActivationDescriptor)               \
   __macro(miopenConvolutionForward)                        \
   __macro(miopenConvolutionBackwardBias)                   \
   __macro(miopenConvolutionForwardGetWorkSpaceSize)        \
@@ -193,6 +218,28 @@ MIOPEN_DNN_ROUTINE_EACH(PERFTOOLS_GPUTOOLS_MIOPEN_WRAP)
 
 #undef MIOPEN_DNN_ROUTINE_EACH
 
+#if TF_MIOPEN_FUSION_API
+// clang-format off
+#define MIOPEN_FUSION_ROUTINE_EACH(__macro)                \
+  __macro(miopenCreateFusionPlan)                          \
+  __macro(miopenDestroyFusionPlan)                         \
+  __macro(miopenCompileFusionPlan)                         \
+  __macro(miopenCreateOpConvForward)                       \
+  __macro(miopenCreateOpBiasForward)                       \
+  __macro(miopenCreateOpActivationForward)                 \
+  __macro(miopenCreateOperatorArgs)                        \
+  __macro(miopenDestroyOperatorArgs)                       \
+  __macro(miopenSetOpArgsConvForward)                      \
+  __macro(miopenSetOpArgsBiasForward)                      \
+  __macro(miopenSetOpArgsActivForward)                     \
+  __macro(miopenExecuteFusionPlan)
+// clang-format on
+
+MIOPEN_FUSION_ROUTINE_EACH(PERFTOOLS_GPUTOOLS_MIOPEN_WRAP)
+
+#undef MIOPEN_FUSION_ROUTINE_EACH
+#endif  // TF_MIOPEN_FUSION_API
+
 }  // namespace wrap
 
 namespace {
@@ -247,6 +294,184 @@ miopenConvBwdWeightsAlgorithm_t ToConvBackwardFilterAlgo(
   }
 }
 
+// Returns false if MIOpen has no activation for "mode".
+bool ToMIOpenActivationMode(dnn::ActivationMode mode,
+                            miopenActivationMode_t* miopen_mode) {
+  switch (mode) {
+    case dnn::ActivationMode::kSigmoid:
+      *miopen_mode = miopenActivationLOGISTIC;
+      return true;
+    case dnn::ActivationMode::kRelu:
+      *miopen_mode = miopenActivationRELU;
+      return true;
+    case dnn::ActivationMode::kTanh:
+      *miopen_mode = miopenActivationTANH;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the descriptor of the biases added to "output", one per feature
+// map.
+BatchDescriptor BiasDescriptor(const BatchDescriptor& output) {
+  BatchDescriptor bias_dimensions;
+  bias_dimensions.set_count(1)
+      .set_feature_map_count(output.feature_map_count())
+      .set_height(1)
+      .set_width(1)
+      .set_layout(dnn::DataLayout::kBatchYXDepth);
+  return bias_dimensions;
+}
+
+string MIOpenVersion() {
+#if defined(MIOPEN_VERSION_MAJOR)
+  return port::StrCat(MIOPEN_VERSION_MAJOR, ".", MIOPEN_VERSION_MINOR, ".",
+                      MIOPEN_VERSION_PATCH);
+#else
+  return "unknown";
+#endif
+}
+
+// Returns the key of a convolution in MIOpenFindCache. "kind" tells the
+// forward, backward data and backward filter convolutions apart. The key
+// names the device and the MIOpen version, since the fastest algorithm
+// depends on both.
+string ConvolutionKey(Stream* stream, const char* kind, int miopen_type,
+                      const BatchDescriptor& input,
+                      const FilterDescriptor& filter,
+                      const ConvolutionDescriptor& conv,
+                      const BatchDescriptor& output) {
+  const DeviceDescription& device = stream->parent()->GetDeviceDescription();
+  return port::StrCat(device.name(), "/", device.platform_version(),
+                      "/miopen-", MIOpenVersion(), "|", kind, "|",
+                      miopen_type, "|", input.ToShortString(), "|",
+                      filter.ToShortString(), "|", conv.ToShortString(), "|",
+                      output.ToShortString());
+}
+
+// The results of MIOpen's find step, which runs the candidate algorithms
+// for a convolution to pick the fastest. Running it stalls the first step
+// using each convolution, so the results are kept for the life of the
+// process and, if TF_MIOPEN_FIND_CACHE_PATH names a file, across processes.
+//
+// Each line of the file holds one result, as
+// "<key>\t<algorithm>,<workspace bytes>". The whole file is rewritten,
+// through a temporary file and a rename, each time a result is inserted,
+// which only happens once per convolution.
+//
+// This class is thread-safe.
+class MIOpenFindCache {
+ public:
+  static MIOpenFindCache* Global() {
+    static MIOpenFindCache* cache = [] {
+      const char* path = getenv("TF_MIOPEN_FIND_CACHE_PATH");
+      return new MIOpenFindCache(path == nullptr ? "" : path);
+    }();
+    return cache;
+  }
+
+  bool Lookup(const string& key, int* algorithm, size_t* workspace_size) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *algorithm = it->second.first;
+    *workspace_size = it->second.second;
+    return true;
+  }
+
+  void Insert(const string& key, int algorithm, size_t workspace_size) {
+    mutex_lock l(mu_);
+    entries_[key] = std::make_pair(algorithm, workspace_size);
+    if (path_.empty()) return;
+    // Keep the results that other processes wrote since this one read the
+    // file.
+    ReadFile();
+    port::Status s = WriteFile();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write the MIOpen find cache to " << path_
+                   << ": " << s;
+    }
+  }
+
+ private:
+  explicit MIOpenFindCache(const string& path) : path_(path) {
+    if (path_.empty()) return;
+    mutex_lock l(mu_);
+    ReadFile();
+    VLOG(1) << "Loaded " << entries_.size() << " MIOpen find results from "
+            << path_;
+  }
+
+  // Adds the results in the file that are not in entries_. Malformed lines
+  // are skipped.
+  void ReadFile() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    port::Env* env = port::Env::Default();
+    string contents;
+    if (!env->FileExists(path_).ok() ||
+        !tensorflow::ReadFileToString(env, path_, &contents).ok()) {
+      return;
+    }
+    for (const string& line : port::Split(contents, '\n')) {
+      const size_t pos = line.rfind('\t');
+      if (pos == string::npos) continue;
+      const std::vector<string> fields = port::Split(line.substr(pos + 1), ',');
+      int32 algorithm;
+      tensorflow::uint64 workspace_size;
+      if (fields.size() != 2 || !port::safe_strto32(fields[0], &algorithm) ||
+          !tensorflow::strings::safe_strtou64(fields[1], &workspace_size)) {
+        continue;
+      }
+      entries_.emplace(line.substr(0, pos),
+                       std::make_pair(algorithm, workspace_size));
+    }
+  }
+
+  port::Status WriteFile() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    string contents;
+    for (const auto& entry : entries_) {
+      port::StrAppend(&contents, entry.first, "\t", entry.second.first, ",",
+                      entry.second.second, "\n");
+    }
+    port::Env* env = port::Env::Default();
+    const string tmp_path =
+        port::StrCat(path_, ".tmp.", tensorflow::random::New64());
+    port::Status s = tensorflow::WriteStringToFile(env, tmp_path, contents);
+    if (!s.ok()) return s;
+    return env->RenameFile(tmp_path, path_);
+  }
+
+  const string path_;
+  mutex mu_;
+  std::map<string, std::pair<int, size_t>> entries_ GUARDED_BY(mu_);
+
+  SE_DISALLOW_COPY_AND_ASSIGN(MIOpenFindCache);
+};
+
+// Looks up the result of the find step for the convolution "key" and
+// allocates the workspace of the algorithm. Returns false if the find step
+// has not run for the convolution.
+template <typename Algorithm>
+bool LookupFindResult(Stream* stream, ScratchAllocator* scratch_allocator,
+                      const string& key,
+                      std::pair<Algorithm, size_t>* algo_sz,
+                      DeviceMemory<uint8>* scratch) {
+  int algorithm;
+  size_t workspace_size;
+  if (!MIOpenFindCache::Global()->Lookup(key, &algorithm, &workspace_size)) {
+    return false;
+  }
+  algo_sz->first = static_cast<Algorithm>(algorithm);
+  algo_sz->second = workspace_size;
+  if (workspace_size != 0) {
+    auto allocated = scratch_allocator->AllocateBytes(stream, workspace_size);
+    if (allocated.ok()) {
+      *scratch = allocated.ValueOrDie();
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 MIOpenSupport::MIOpenSupport(ROCMExecutor* parent)
@@ -464,6 +689,159 @@ class ScopedConvolutionDescriptor {
   SE_DISALLOW_COPY_AND_ASSIGN(ScopedConvolutionDescriptor);
 };
 
+// Turns an activation mode into a miopen activation descriptor handle within a
+// scope.
+class ScopedActivationDescriptor {
+ public:
+  ScopedActivationDescriptor(ROCMExecutor* parent,
+                             miopenActivationMode_t activation_mode)
+      : parent_(parent), handle_(nullptr) {
+    miopenStatus_t status =
+        wrap::miopenCreateActivationDescriptor(parent_, &handle_);
+    if (status != miopenStatusSuccess) {
+      LOG(FATAL) << "could not create miopen activation descriptor: "
+                 << ToString(status);
+    }
+    // alpha and beta only scale tanh, as beta * tanh(alpha * x).
+    status = wrap::miopenSetActivationDescriptor(
+        parent_, handle_, activation_mode, /*activAlpha=*/1.0,
+        /*activBeta=*/1.0, /*activPower=*/1.0);
+    if (status != miopenStatusSuccess) {
+      LOG(FATAL) << "could not set miopen activation descriptor: "
+                 << ToString(status);
+    }
+  }
+
+  ~ScopedActivationDescriptor() {
+    miopenStatus_t status =
+        wrap::miopenDestroyActivationDescriptor(parent_, handle_);
+    if (status != miopenStatusSuccess) {
+      LOG(ERROR) << "could not destroy miopen activation descriptor: "
+                 << ToString(status);
+    }
+  }
+
+  miopenActivationDescriptor_t handle() const { return handle_; }
+
+ private:
+  ROCMExecutor* parent_;                 // Parent executor. Not owned.
+  miopenActivationDescriptor_t handle_;  // Owned.
+
+  SE_DISALLOW_COPY_AND_ASSIGN(ScopedActivationDescriptor);
+};
+
+#if TF_MIOPEN_FUSION_API
+// A convolution followed by a bias add and/or an activation, compiled into
+// one kernel by MIOpen's fusion API. The plan refers to the descriptors it
+// was created from, so it owns them. ok() is false if MIOpen cannot fuse
+// the convolution, e.g. because it has no fused kernel for the filter size.
+class MIOpenFusionPlan {
+ public:
+  MIOpenFusionPlan(ROCMExecutor* parent, miopenHandle_t handle,
+                   miopenDataType_t elem_type, const BatchDescriptor& input,
+                   const FilterDescriptor& filter,
+                   const ConvolutionDescriptor& conv,
+                   const BatchDescriptor& output, bool with_bias,
+                   bool with_activation, miopenActivationMode_t activation_mode)
+      : parent_(parent),
+        input_nd_(parent, input, elem_type),
+        output_nd_(parent, output, elem_type),
+        filter_(parent, filter, input, elem_type),
+        conv_(parent, conv, miopenFloat),
+        bias_nd_(parent, BiasDescriptor(output), elem_type) {
+    const miopenStatus_t status =
+        Create(handle, with_bias, with_activation, activation_mode);
+    ok_ = status == miopenStatusSuccess;
+    if (!ok_) {
+      VLOG(1) << "MIOpen cannot fuse the convolution: " << ToString(status);
+    }
+  }
+
+  ~MIOpenFusionPlan() {
+    if (plan_ == nullptr) return;
+    miopenStatus_t status = wrap::miopenDestroyFusionPlan(parent_, plan_);
+    if (status != miopenStatusSuccess) {
+      LOG(ERROR) << "could not destroy miopen fusion plan: "
+                 << ToString(status);
+    }
+  }
+
+  bool ok() const { return ok_; }
+
+  // Enqueues the plan on the stream of "handle".
+  miopenStatus_t Execute(miopenHandle_t handle, const void* input,
+                         const void* filter, const void* bias, void* output) {
+    miopenOperatorArgs_t args;
+    miopenStatus_t status = wrap::miopenCreateOperatorArgs(parent_, &args);
+    if (status != miopenStatusSuccess) return status;
+    const float alpha = 1.0f;
+    const float beta = 0.0f;
+    status = wrap::miopenSetOpArgsConvForward(parent_, args, conv_op_, &alpha,
+                                              &beta, filter);
+    if (status == miopenStatusSuccess && bias_op_ != nullptr) {
+      status = wrap::miopenSetOpArgsBiasForward(parent_, args, bias_op_,
+                                                &alpha, &beta, bias);
+    }
+    if (status == miopenStatusSuccess && activation_op_ != nullptr) {
+      status = wrap::miopenSetOpArgsActivForward(
+          parent_, args, activation_op_, &alpha, &beta, /*activAlpha=*/1.0,
+          /*activBeta=*/1.0, /*activGamma=*/1.0);
+    }
+    if (status == miopenStatusSuccess) {
+      status = wrap::miopenExecuteFusionPlan(parent_, handle, plan_,
+                                             input_nd_.handle(), input,
+                                             output_nd_.handle(), output, args);
+    }
+    wrap::miopenDestroyOperatorArgs(parent_, args);
+    return status;
+  }
+
+ private:
+  miopenStatus_t Create(miopenHandle_t handle, bool with_bias,
+                        bool with_activation,
+                        miopenActivationMode_t activation_mode) {
+    miopenStatus_t status = wrap::miopenCreateFusionPlan(
+        parent_, &plan_, miopenVerticalFusion, input_nd_.handle());
+    if (status != miopenStatusSuccess) {
+      plan_ = nullptr;
+      return status;
+    }
+    status = wrap::miopenCreateOpConvForward(parent_, plan_, &conv_op_,
+                                             conv_.handle(), filter_.handle());
+    if (status == miopenStatusSuccess && with_bias) {
+      status = wrap::miopenCreateOpBiasForward(parent_, plan_, &bias_op_,
+                                               bias_nd_.handle());
+    }
+    if (status == miopenStatusSuccess && with_activation) {
+      status = wrap::miopenCreateOpActivationForward(
+          parent_, plan_, &activation_op_, activation_mode);
+    }
+    if (status == miopenStatusSuccess) {
+      status = wrap::miopenCompileFusionPlan(parent_, handle, plan_);
+    }
+    return status;
+  }
+
+  ROCMExecutor* parent_;  // Parent executor. Not owned.
+  ScopedTensorDescriptor input_nd_;
+  ScopedTensorDescriptor output_nd_;
+  ScopedFilterDescriptor filter_;
+  ScopedConvolutionDescriptor conv_;
+  ScopedTensorDescriptor bias_nd_;
+  // The operators are owned by the plan.
+  miopenFusionPlanDescriptor_t plan_ = nullptr;
+  miopenFusionOpDescriptor_t conv_op_ = nullptr;
+  miopenFusionOpDescriptor_t bias_op_ = nullptr;
+  miopenFusionOpDescriptor_t activation_op_ = nullptr;
+  bool ok_ = false;
+
+  SE_DISALLOW_COPY_AND_ASSIGN(MIOpenFusionPlan);
+};
+#else
+// MIOpen only fuses convolutions from version 1.5.
+class MIOpenFusionPlan {};
+#endif  // TF_MIOPEN_FUSION_API
+
 // Turns a PoolingDescriptor structure into a miopen pooling descriptor handle
 // within a scope.
 class ScopedPoolingDescriptor {
@@ -832,37 +1210,69 @@ class MIOpenRnnSequenceTensorDescriptor
   MIOpenRnnSequenceTensorDescriptor(ROCMExecutor* parent, int seq_length,
                                    int batch_size, int data_size,
                                    miopenDataType_t data_type)
+      : MIOpenRnnSequenceTensorDescriptor(
+            parent,
+            std::vector<int>(seq_length > 0 ? seq_length : 0, batch_size),
+            data_size, data_type) {}
+
+  // Describes a packed batch where batch_sizes[t] sequences are active at
+  // step t. Consecutive steps with the same batch size share one handle.
+  MIOpenRnnSequenceTensorDescriptor(ROCMExecutor* parent,
+                                    const std::vector<int>& batch_sizes,
+                                    int data_size, miopenDataType_t data_type)
       : parent_(parent),
-        seq_length_(seq_length),
-        batch_size_(batch_size),
+        seq_length_(batch_sizes.size()),
+        batch_size_(batch_sizes.empty() ? 0 : batch_sizes[0]),
         data_size_(data_size),
-        data_type_(data_type) {
-    miopenTensorDescriptor_t handle = nullptr;
-    if (seq_length <= 0) {
+        data_type_(data_type),
+        batch_sizes_(batch_sizes) {
+    if (seq_length_ <= 0) {
       string error_msg =
-          port::StrCat("sequence length must be positive: ", seq_length);
+          port::StrCat("sequence length must be positive: ", seq_length_);
       LOG(ERROR) << error_msg;
       SetFailure(port::Status(port::error::UNKNOWN, error_msg));
       return;
     }
-    miopenStatus_t status = wrap::miopenCreateTensorDescriptor(parent, &handle);
-    ROCM_RETURN_IF_FAIL(status, "Failed to create tensor descriptor");
-    std::array<int, 2> dims = {{batch_size, data_size}};
-    status = wrap::miopenSetTensorDescriptor(
-        parent, handle /*tensorDesc*/, data_type /*dataType*/,
-        2 /*nbDims*/, dims.data() /*dimA*/,
-        nullptr /*strideA*/);
-    ROCM_RETURN_IF_FAIL(status, "Failed to update tensor descriptor");
-    // Replicate handle across the number of steps.
-    handles_.assign(seq_length, handle);
+    for (int i = 0; i < seq_length_; ++i) {
+      if (batch_sizes[i] <= 0 ||
+          (i > 0 && batch_sizes[i] > batch_sizes[i - 1])) {
+        string error_msg = port::StrCat(
+            "batch sizes must be positive and non-increasing, got ",
+            batch_sizes[i], " at step ", i);
+        LOG(ERROR) << error_msg;
+        SetFailure(port::Status(port::error::INVALID_ARGUMENT, error_msg));
+        return;
+      }
+    }
+    handles_.reserve(seq_length_);
+    for (int i = 0; i < seq_length_; ++i) {
+      if (i > 0 && batch_sizes[i] == batch_sizes[i - 1]) {
+        handles_.push_back(handles_.back());
+        continue;
+      }
+      miopenTensorDescriptor_t handle = nullptr;
+      miopenStatus_t status =
+          wrap::miopenCreateTensorDescriptor(parent, &handle);
+      ROCM_RETURN_IF_FAIL(status, "Failed to create tensor descriptor");
+      distinct_handles_.push_back(handle);
+      std::array<int, 2> dims = {{batch_sizes[i], data_size}};
+      status = wrap::miopenSetTensorDescriptor(
+          parent, handle /*tensorDesc*/, data_type /*dataType*/,
+          2 /*nbDims*/, dims.data() /*dimA*/,
+          nullptr /*strideA*/);
+      ROCM_RETURN_IF_FAIL(status, "Failed to update tensor descriptor");
+      handles_.push_back(handle);
+    }
   }
 
   ~MIOpenRnnSequenceTensorDescriptor() override {
-    // Only the first one needs to be destroyed. All others are the same.
-    miopenStatus_t status =
-        wrap::miopenDestroyTensorDescriptor(parent_, handles_[0]);
-    ROCM_RETURN_IF_FAIL(status,
-                         "Failed to destroy sequence tensor descriptor");
+    // Steps of the same batch size share a handle; destroy each one once.
+    for (miopenTensorDescriptor_t handle : distinct_handles_) {
+      miopenStatus_t status =
+          wrap::miopenDestroyTensorDescriptor(parent_, handle);
+      ROCM_RETURN_IF_FAIL(status,
+                          "Failed to destroy sequence tensor descriptor");
+    }
   }
 
   const miopenTensorDescriptor_t* handles() const {
@@ -874,6 +1284,7 @@ class MIOpenRnnSequenceTensorDescriptor
   int seq_length() const { return seq_length_; }
   int batch_size() const { return batch_size_; }
   int data_size() const { return data_size_; }
+  const std::vector<int>& batch_sizes() const { return batch_sizes_; }
 
  private:
   ROCMExecutor* parent_;
@@ -881,7 +1292,9 @@ class MIOpenRnnSequenceTensorDescriptor
   int batch_size_;
   int data_size_;
   miopenDataType_t data_type_;
+  std::vector<int> batch_sizes_;
   std::vector<miopenTensorDescriptor_t> handles_;
+  std::vector<miopenTensorDescriptor_t> distinct_handles_;
   port::Status status_;
   SE_DISALLOW_COPY_AND_ASSIGN(MIOpenRnnSequenceTensorDescriptor);
 };
@@ -986,6 +1399,7 @@ bool ExtractAndCheckRnnForward(
   }
   if (!(output_desc.seq_length() == model_dims->seq_length &&
         output_desc.batch_size() == model_dims->batch_size &&
+        output_desc.batch_sizes() == input_desc.batch_sizes() &&
         output_desc.data_size() ==
             model_dims->hidden_size * model_dims->dir_count)) {
     LOG(ERROR) << "Invalid output shape";
@@ -1401,7 +1815,13 @@ MIOpenSupport::createRnnDescriptor(int num_layers, int hidden_size,
                                   dnn::RnnMode rnn_mode,
                                   dnn::DataType data_type, float dropout,
                                   uint64 seed,
-                                  ScratchAllocator* state_allocator) {
+                                  ScratchAllocator* state_allocator,
+                                  dnn::RnnAlgorithm rnn_algorithm) {
+  if (rnn_algorithm != dnn::RnnAlgorithm::kRnnStandard) {
+    // MIOpen selects its RNN kernels internally.
+    VLOG(1) << "MIOpen does not support choosing the RNN algorithm; "
+            << "using the standard one";
+  }
   mutex_lock lock{dnn_handle_mutex_};
   std::unique_ptr<MIOpenRnnDescriptor> rnn_desc(new MIOpenRnnDescriptor(
       parent_, ToHandle(dnn_handle_), num_layers, hidden_size, input_size,
@@ -1431,6 +1851,20 @@ MIOpenSupport::createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
       std::move(seq_desc));
 }
 
+port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+MIOpenSupport::createRnnSequenceTensorDescriptor(
+    const std::vector<int>& batch_sizes, int data_size,
+    dnn::DataType data_type) {
+  std::unique_ptr<MIOpenRnnSequenceTensorDescriptor> seq_desc(
+      new MIOpenRnnSequenceTensorDescriptor(parent_, batch_sizes, data_size,
+                                            ToMIOpenDataType(data_type)));
+  if (!seq_desc->ok()) {
+    return seq_desc->Status();
+  }
+  return port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>(
+      std::move(seq_desc));
+}
+
 port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
 MIOpenSupport::createRnnStateTensorDescriptor(int num_layer, int batch_size,
                                              int data_size,
@@ -1558,12 +1992,26 @@ bool MIOpenSupport::DoConvolveImpl(
   if (status != miopenStatusSuccess) {
     LOG(FATAL) << "failed to set stream for miopen handle: " << ToString(status);
   }
+
+  const bool is_profiling = output_profile_result != nullptr;
+  const bool with_bias_or_activation =
+      biases.opaque() != nullptr ||
+      activation_mode != dnn::ActivationMode::kNone;
+  // Profiling measures the algorithm picked by algorithm_config, which the
+  // fusion plan ignores.
+  if (with_bias_or_activation && !is_profiling &&
+      DoFusedConvolveImpl(stream, miopen_type, batch_descriptor, input_data,
+                          filter_descriptor, filter_data,
+                          convolution_descriptor, biases, activation_mode,
+                          output_descriptor, output_data)) {
+    return true;
+  }
+
   // Alpha is the scaling factor for input.
   float alpha = 1.0;
   // Beta is the scaling factor for output.
   float beta = 0.0;
 
-  const bool is_profiling = output_profile_result != nullptr;
   std::pair<miopenConvFwdAlgorithm_t, size_t> algo_sz;
   DeviceMemory<uint8> scratch;
 
@@ -1607,7 +2055,15 @@ bool MIOpenSupport::DoConvolveImpl(
           return std::pair<miopenConvFwdAlgorithm_t, size_t> (preference.fwd_algo, preference.memory);
         };
 
-    algo_sz = get_algorithm();
+    const string find_key = ConvolutionKey(
+        stream, "fwd", miopen_type, batch_descriptor, filter_descriptor,
+        convolution_descriptor, output_descriptor);
+    if (!LookupFindResult(stream, scratch_allocator, find_key, &algo_sz,
+                          &scratch)) {
+      algo_sz = get_algorithm();
+      MIOpenFindCache::Global()->Insert(find_key, algo_sz.first,
+                                        algo_sz.second);
+    }
 
     // MIOpen requires workspace:
     assert (scratch != nullptr) ;
@@ -1687,6 +2143,106 @@ bool MIOpenSupport::DoConvolveImpl(
     return false;
   }
 
+  if (with_bias_or_activation) {
+    return DoBiasAddAndActivateImpl(stream, miopen_type, output_descriptor,
+                                    biases, activation_mode, output_data);
+  }
+  return true;
+}
+
+template <class T>
+bool MIOpenSupport::DoFusedConvolveImpl(
+    Stream* stream, int miopen_type, const BatchDescriptor& batch_descriptor,
+    const DeviceMemory<T>& input_data,
+    const FilterDescriptor& filter_descriptor,
+    const DeviceMemory<T>& filter_data,
+    const ConvolutionDescriptor& convolution_descriptor,
+    const DeviceMemory<T>& biases, dnn::ActivationMode activation_mode,
+    const BatchDescriptor& output_descriptor, DeviceMemory<T>* output_data) {
+#if TF_MIOPEN_FUSION_API
+  const bool with_bias = biases.opaque() != nullptr;
+  const bool with_activation = activation_mode != dnn::ActivationMode::kNone;
+  miopenActivationMode_t miopen_activation_mode = miopenActivationRELU;
+  if (with_activation &&
+      !ToMIOpenActivationMode(activation_mode, &miopen_activation_mode)) {
+    return false;
+  }
+  const string key = port::StrCat(
+      ConvolutionKey(stream, "fused", miopen_type, batch_descriptor,
+                     filter_descriptor, convolution_descriptor,
+                     output_descriptor),
+      "|", with_bias, "|", static_cast<int>(activation_mode));
+  // Compiling a plan is expensive, so the plans are kept, including the
+  // ones MIOpen does not support.
+  std::unique_ptr<MIOpenFusionPlan>& plan = fusion_plans_[key];
+  if (plan == nullptr) {
+    plan.reset(new MIOpenFusionPlan(
+        parent_, ToHandle(dnn_handle_),
+        static_cast<miopenDataType_t>(miopen_type), batch_descriptor,
+        filter_descriptor, convolution_descriptor, output_descriptor,
+        with_bias, with_activation, miopen_activation_mode));
+  }
+  if (!plan->ok()) return false;
+  const miopenStatus_t status =
+      plan->Execute(ToHandle(dnn_handle_), input_data.opaque(),
+                    filter_data.opaque(), biases.opaque(),
+                    output_data->opaque());
+  if (status != miopenStatusSuccess) {
+    // The caller falls back to running the convolution, the bias add and the
+    // activation separately, which overwrites the output.
+    LOG(ERROR) << "failed to enqueue fused convolution on stream: "
+               << ToString(status);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif  // TF_MIOPEN_FUSION_API
+}
+
+template <class T>
+bool MIOpenSupport::DoBiasAddAndActivateImpl(
+    Stream* stream, int miopen_type, const BatchDescriptor& output_descriptor,
+    const DeviceMemory<T>& biases, dnn::ActivationMode activation_mode,
+    DeviceMemory<T>* output_data) {
+  ScopedTensorDescriptor output_nd{parent_, output_descriptor,
+      static_cast<miopenDataType_t>(miopen_type)};
+  if (biases.opaque() != nullptr) {
+    ScopedTensorDescriptor bias_nd{parent_, BiasDescriptor(output_descriptor),
+        static_cast<miopenDataType_t>(miopen_type)};
+    const float alpha1 = 1.0f;
+    const float alpha2 = 0.0f;
+    const float beta = 1.0f;
+    auto status = wrap::miopenOpTensor(
+        parent_, ToHandle(dnn_handle_), miopenTensorOpAdd, &alpha1,
+        bias_nd.handle(), biases.opaque(), &alpha2, bias_nd.handle(),
+        biases.opaque(), &beta, output_nd.handle(), output_data->opaque());
+    if (status != miopenStatusSuccess) {
+      LOG(ERROR) << "stream " << stream << " could not enqueue bias addition: "
+                 << ToString(status);
+      return false;
+    }
+  }
+  if (activation_mode != dnn::ActivationMode::kNone) {
+    miopenActivationMode_t miopen_activation_mode;
+    if (!ToMIOpenActivationMode(activation_mode, &miopen_activation_mode)) {
+      LOG(ERROR) << "miopen does not support activation mode "
+                 << static_cast<int>(activation_mode);
+      return false;
+    }
+    ScopedActivationDescriptor activation{parent_, miopen_activation_mode};
+    const float alpha = 1.0f;
+    const float beta = 0.0f;
+    auto status = wrap::miopenActivationForward(
+        parent_, ToHandle(dnn_handle_), activation.handle(), &alpha,
+        output_nd.handle(), output_data->opaque(), &beta, output_nd.handle(),
+        output_data->opaque());
+    if (status != miopenStatusSuccess) {
+      LOG(ERROR) << "stream " << stream << " could not enqueue activation: "
+                 << ToString(status);
+      return false;
+    }
+  }
   return true;
 }
 
@@ -2108,7 +2664,15 @@ bool MIOpenSupport::DoConvolveBackwardDataImpl(
           preference.bwd_data_algo, preference.memory);
     };
 
-    algo_sz = get_algorithm();
+    const string find_key = ConvolutionKey(
+        stream, "bwd_data", miopen_type, input_descriptor, filter_descriptor,
+        convolution_descriptor, output_descriptor);
+    if (!LookupFindResult(stream, scratch_allocator, find_key, &algo_sz,
+                          &scratch)) {
+      algo_sz = get_algorithm();
+      MIOpenFindCache::Global()->Insert(find_key, algo_sz.first,
+                                        algo_sz.second);
+    }
 
     // MIOpen requires workspace:
     assert (scratch != nullptr) ;
@@ -2308,7 +2872,15 @@ bool MIOpenSupport::DoConvolveBackwardFilterImpl(
           preference.bwd_weights_algo, preference.memory);
     };
 
-    algo_sz = get_algorithm();
+    const string find_key = ConvolutionKey(
+        stream, "bwd_filter", miopen_type, input_descriptor, filter_descriptor,
+        convolution_descriptor, output_descriptor);
+    if (!LookupFindResult(stream, scratch_allocator, find_key, &algo_sz,
+                          &scratch)) {
+      algo_sz = get_algorithm();
+      MIOpenFindCache::Global()->Insert(find_key, algo_sz.first,
+                                        algo_sz.second);
+    }
 
     // MIOpen requires workspace:
     assert (scratch != nullptr) ;
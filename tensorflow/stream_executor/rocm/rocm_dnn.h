@@ -19,6 +19,10 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_ROCM_ROCM_DNN_H_
 #define TENSORFLOW_STREAM_EXECUTOR_ROCM_ROCM_DNN_H_
 
+#include <map>
+#include <memory>
+#include <string>
+
 #include "tensorflow/stream_executor/dnn.h"
 #include "tensorflow/stream_executor/lib/status.h"
 #include "tensorflow/stream_executor/platform/mutex.h"
@@ -31,6 +35,7 @@ namespace gputools {
 namespace rocm {
 
 class ROCMExecutor;
+class MIOpenFusionPlan;
 class MIOpenRnnDescriptor;
 class MIOpenRnnSequenceTensorDescriptor;
 class MIOpenRnnStateTensorDescriptor;
@@ -50,13 +55,19 @@ class MIOpenSupport : public dnn::DnnSupport {
       int num_layers, int hidden_size, int input_size,
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
       dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout,
-      uint64 seed, ScratchAllocator* state_allocator) override;
+      uint64 seed, ScratchAllocator* state_allocator,
+      dnn::RnnAlgorithm rnn_algorithm) override;
 
   port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
   createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
                                     int data_size,
                                     dnn::DataType data_type) override;
 
+  port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(const std::vector<int>& batch_sizes,
+                                    int data_size,
+                                    dnn::DataType data_type) override;
+
   port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
   createRnnStateTensorDescriptor(int num_layer, int batch_size, int data_size,
                                  dnn::DataType data_type) override;
@@ -475,6 +486,10 @@ class MIOpenSupport : public dnn::DnnSupport {
   // single rocm_dnn translation unit.
   void* dnn_handle_ GUARDED_BY(dnn_handle_mutex_);
 
+  // The compiled fusion plans, keyed by convolution, bias and activation.
+  std::map<string, std::unique_ptr<MIOpenFusionPlan>> fusion_plans_
+      GUARDED_BY(dnn_handle_mutex_);
+
   // NOTE(keveman): Temporary data layout transformation until MIOpen supports
   // kBatchYXDepth for backward pass. This function allocates temporary memory,
   // lays out the source data into the temporary but in the kBatchDepthXY
@@ -534,6 +549,31 @@ class MIOpenSupport : public dnn::DnnSupport {
                       const dnn::AlgorithmConfig& algorithm_config,
                       dnn::ProfileResult* output_profile_result);
 
+  // Enqueues the convolution, bias add and activation as one MIOpen fusion
+  // plan. Returns false if MIOpen cannot fuse them, in which case nothing is
+  // enqueued.
+  template <class T>
+  bool DoFusedConvolveImpl(
+      Stream* stream, int miopen_type,  // Actually miopenDataType_t.
+      const dnn::BatchDescriptor& batch_descriptor,
+      const DeviceMemory<T>& input_data,
+      const dnn::FilterDescriptor& filter_descriptor,
+      const DeviceMemory<T>& filter_data,
+      const dnn::ConvolutionDescriptor& convolution_descriptor,
+      const DeviceMemory<T>& biases, dnn::ActivationMode activation_mode,
+      const dnn::BatchDescriptor& output_descriptor,
+      DeviceMemory<T>* output_data)
+      EXCLUSIVE_LOCKS_REQUIRED(dnn_handle_mutex_);
+
+  // Adds "biases", if not null, to the convolution output in "output_data",
+  // then applies "activation_mode" to it in place.
+  template <class T>
+  bool DoBiasAddAndActivateImpl(
+      Stream* stream, int miopen_type,  // Actually miopenDataType_t.
+      const dnn::BatchDescriptor& output_descriptor,
+      const DeviceMemory<T>& biases, dnn::ActivationMode activation_mode,
+      DeviceMemory<T>* output_data) EXCLUSIVE_LOCKS_REQUIRED(dnn_handle_mutex_);
+
   template <class T>
   bool DoConvolveBackwardDataImpl(
       Stream* stream,
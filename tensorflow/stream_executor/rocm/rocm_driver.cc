@@ -743,6 +743,22 @@ ROCMDriver::ContextGetSharedMemConfig(ROCmContext* context) {
   return ptr;
 }
 
+/* static */ void *ROCMDriver::UnifiedMemoryAllocate(ROCmContext *context,
+                                                     uint64 bytes) {
+  ScopedActivateContext activated{context};
+  void *result = nullptr;
+  hipError_t res = hipMallocManaged(&result, bytes);
+  if (res != hipSuccess) {
+    LOG(ERROR) << "failed to allocate "
+               << port::HumanReadableNumBytes::ToString(bytes) << " (" << bytes
+               << " bytes) of managed memory: " << ToString(res);
+    return nullptr;
+  }
+  VLOG(2) << "allocated " << result << " of managed memory for context "
+          << context << " of " << bytes << " bytes";
+  return result;
+}
+
 /* static */ void ROCMDriver::DeviceDeallocate(ROCmContext* context,
                                                void *location) {
   ScopedActivateContext activation{context};
@@ -92,6 +92,11 @@ class ROCMDriver {
   // context via hipMemFree.
   static void DeviceDeallocate(ROCmContext* context, void *location);
 
+  // Allocates memory of size bytes that is accessible from the device and the
+  // host (managed memory) via hipMallocManaged. It is released with
+  // DeviceDeallocate.
+  static void *UnifiedMemoryAllocate(ROCmContext* context, uint64 bytes);
+
   // Allocates page-locked and ROCM-registered memory on the host via
   // hipMemAllocHost.
   static void *HostAllocate(ROCmContext* context, uint64 bytes);
@@ -73,6 +73,11 @@ class ROCMExecutor : public internal::StreamExecutorInterface {
 
   void Deallocate(DeviceMemoryBase *mem) override;
 
+  // HIP has no prefetch of managed memory, so MemPrefetch is not overridden.
+  void *UnifiedMemoryAllocate(uint64 size) override {
+    return ROCMDriver::UnifiedMemoryAllocate(context_, size);
+  }
+
   // ROCM allocation/registration functions are necessary because the driver
   // internally sets up buffers for DMA operations (and page locks them).
   // There's no external interface for us to otherwise control these DMA
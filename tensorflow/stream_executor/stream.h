@@ -53,6 +53,7 @@ class CLBlas;
 }  // namespace ocl
 
 namespace internal {
+class CapturedGraphInterface;
 class StreamInterface;
 }  // namespace internal
 
@@ -1368,6 +1369,34 @@ class Stream {
       const port::ArraySlice<DeviceMemory<std::complex<double>> *> &c, int ldc,
       int batch_count, ScratchAllocator *scratch_allocator);
 
+  // See BlasSupport::DoBlasGemmStridedBatched.
+  Stream &ThenBlasGemmStridedBatched(
+      blas::Transpose transa, blas::Transpose transb, uint64 m, uint64 n,
+      uint64 k, float alpha, const DeviceMemory<float> &a, int lda,
+      int64 stride_a, const DeviceMemory<float> &b, int ldb, int64 stride_b,
+      float beta, DeviceMemory<float> *c, int ldc, int64 stride_c,
+      int batch_count);
+  Stream &ThenBlasGemmStridedBatched(
+      blas::Transpose transa, blas::Transpose transb, uint64 m, uint64 n,
+      uint64 k, double alpha, const DeviceMemory<double> &a, int lda,
+      int64 stride_a, const DeviceMemory<double> &b, int ldb, int64 stride_b,
+      double beta, DeviceMemory<double> *c, int ldc, int64 stride_c,
+      int batch_count);
+  Stream &ThenBlasGemmStridedBatched(
+      blas::Transpose transa, blas::Transpose transb, uint64 m, uint64 n,
+      uint64 k, std::complex<float> alpha,
+      const DeviceMemory<std::complex<float>> &a, int lda, int64 stride_a,
+      const DeviceMemory<std::complex<float>> &b, int ldb, int64 stride_b,
+      std::complex<float> beta, DeviceMemory<std::complex<float>> *c, int ldc,
+      int64 stride_c, int batch_count);
+  Stream &ThenBlasGemmStridedBatched(
+      blas::Transpose transa, blas::Transpose transb, uint64 m, uint64 n,
+      uint64 k, std::complex<double> alpha,
+      const DeviceMemory<std::complex<double>> &a, int lda, int64 stride_a,
+      const DeviceMemory<std::complex<double>> &b, int ldb, int64 stride_b,
+      std::complex<double> beta, DeviceMemory<std::complex<double>> *c,
+      int ldc, int64 stride_c, int batch_count);
+
   // See BlasSupport::DoBlasHemm.
   Stream &ThenBlasHemm(blas::Side side, blas::UpperLower uplo, uint64 m,
                        uint64 n, std::complex<float> alpha,
@@ -1615,6 +1644,12 @@ class Stream {
   // The location must not be null.
   Stream &ThenMemZero(DeviceMemoryBase *location, uint64 size);
 
+  // Entrain onto the stream: a migration of size bytes of unified memory at
+  // location to the device of the stream. This is a hint: if the platform
+  // cannot prefetch, the stream is left as it is and the memory migrates
+  // when it is first accessed.
+  Stream &ThenMemPrefetch(const DeviceMemoryBase &location, uint64 size);
+
   // Entrain onto the stream: a memset of a 32-bit pattern at a GPU location of
   // size bytes, where bytes must be evenly 32-bit sized (i.e. evenly divisible
   // by 4). The location must not be null.
@@ -1693,6 +1728,32 @@ class Stream {
   // Returns true if the stream is ok().
   bool BlockHostUntilDone();
 
+  // Starts capturing the operations entrained on this stream into a graph
+  // instead of executing them, until EndCapture() is called. The graph can
+  // then be replayed with ThenLaunchGraph() for a fraction of the launch cost
+  // of the individual operations.
+  //
+  // Only operations that the platform can record may be entrained while
+  // capturing: no host callbacks, synchronous memcopies or
+  // BlockHostUntilDone(). Every replay reads and writes the same device
+  // memory as the captured operations, so the caller must keep it allocated
+  // for the lifetime of the graph.
+  //
+  // Returns UNIMPLEMENTED on platforms without stream capture (e.g. ROCm), in
+  // which case the stream is left as it was and the caller should entrain the
+  // operations directly.
+  port::Status BeginCapture();
+
+  // Ends the capture started by BeginCapture() and returns the captured
+  // operations in *graph. The stream goes back to executing the operations
+  // entrained on it, whether or not the capture succeeded.
+  port::Status EndCapture(
+      std::unique_ptr<internal::CapturedGraphInterface> *graph);
+
+  // Entrains the operations of a graph captured from a stream of the same
+  // StreamExecutor.
+  Stream &ThenLaunchGraph(const internal::CapturedGraphInterface &graph);
+
   // Warning! This method interacts with internal threads in
   // sometimes-unpredictable ways and is intended for GPU-Executor-internal
   // use
@@ -64,6 +64,17 @@ class EventInterface {
   SE_DISALLOW_COPY_AND_ASSIGN(EventInterface);
 };
 
+// Platform-dependent interface class for a sequence of operations captured
+// from a Stream, in the PIMPL style. See Stream::BeginCapture.
+class CapturedGraphInterface {
+ public:
+  CapturedGraphInterface() {}
+  virtual ~CapturedGraphInterface() {}
+
+ private:
+  SE_DISALLOW_COPY_AND_ASSIGN(CapturedGraphInterface);
+};
+
 // Pointer-to-implementation object type (i.e. the KernelBase class delegates to
 // this interface) with virtual destruction. This class exists for the
 // platform-dependent code to hang any kernel data/resource info/functionality
@@ -116,6 +127,23 @@ class StreamInterface {
   // stream-slot rather than a stream-value.
   virtual void **GPUStreamMemberHack() { return nullptr; }
 
+  // See Stream::BeginCapture, Stream::EndCapture and Stream::ThenLaunchGraph.
+  // Platforms without stream capture keep these defaults, which leave the
+  // stream untouched.
+  virtual port::Status BeginCapture() {
+    return port::UnimplementedError(
+        "stream capture is not supported on this platform");
+  }
+  virtual port::Status EndCapture(
+      std::unique_ptr<CapturedGraphInterface> *graph) {
+    return port::UnimplementedError(
+        "stream capture is not supported on this platform");
+  }
+  virtual port::Status LaunchGraph(const CapturedGraphInterface &graph) {
+    return port::UnimplementedError(
+        "stream capture is not supported on this platform");
+  }
+
  private:
   SE_DISALLOW_COPY_AND_ASSIGN(StreamInterface);
 };
@@ -174,6 +202,8 @@ class StreamExecutorInterface {
   virtual void *AllocateSubBuffer(DeviceMemoryBase *parent, uint64 offset,
                                   uint64 size) = 0;
   virtual void Deallocate(DeviceMemoryBase *mem) = 0;
+  // Platforms without unified memory return nullptr.
+  virtual void *UnifiedMemoryAllocate(uint64 size) { return nullptr; }
   virtual void *HostMemoryAllocate(uint64 size) = 0;
   virtual void HostMemoryDeallocate(void *mem) = 0;
   virtual bool HostMemoryRegister(void *mem, uint64 size) = 0;
@@ -198,6 +228,10 @@ class StreamExecutorInterface {
   }
   virtual bool Memset32(Stream *stream, DeviceMemoryBase *location,
                         uint32 pattern, uint64 size) = 0;
+  virtual bool MemPrefetch(Stream *stream, const DeviceMemoryBase &location,
+                           uint64 size) {
+    return false;
+  }
   virtual bool Memcpy(Stream *stream, void *host_dst,
                       const DeviceMemoryBase &gpu_src, uint64 size) = 0;
   virtual bool Memcpy(Stream *stream, DeviceMemoryBase *gpu_dst,
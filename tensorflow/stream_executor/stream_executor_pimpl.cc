@@ -336,7 +336,7 @@ StreamExecutor::createRnnDescriptor(
     int num_layers, int hidden_size, int input_size,
     dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
     dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout, uint64 seed,
-    ScratchAllocator *state_allocator) {
+    ScratchAllocator *state_allocator, dnn::RnnAlgorithm rnn_algorithm) {
   dnn::DnnSupport *dnn_support = AsDnn();
   if (!dnn_support) {
     return port::Status(port::error::UNKNOWN,
@@ -344,7 +344,7 @@ StreamExecutor::createRnnDescriptor(
   }
   return dnn_support->createRnnDescriptor(
       num_layers, hidden_size, input_size, input_mode, direction_mode, rnn_mode,
-      data_type, dropout, seed, state_allocator);
+      data_type, dropout, seed, state_allocator, rnn_algorithm);
 }
 
 port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
@@ -360,6 +360,19 @@ StreamExecutor::createRnnSequenceTensorDescriptor(int seq_length,
                                                         data_size, data_type);
 }
 
+port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+StreamExecutor::createRnnSequenceTensorDescriptor(
+    const std::vector<int> &batch_sizes, int data_size,
+    dnn::DataType data_type) {
+  dnn::DnnSupport *dnn_support = AsDnn();
+  if (!dnn_support) {
+    return port::Status(port::error::UNKNOWN,
+                        "Fail to find the dnn implementation.");
+  }
+  return dnn_support->createRnnSequenceTensorDescriptor(batch_sizes, data_size,
+                                                        data_type);
+}
+
 port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
 StreamExecutor::createRnnStateTensorDescriptor(int num_layer, int batch_size,
                                                int data_size,
@@ -440,6 +453,14 @@ void *StreamExecutor::Allocate(uint64 size) {
   return buf;
 }
 
+void *StreamExecutor::UnifiedMemoryAllocate(uint64 size) {
+  void *buf = implementation_->UnifiedMemoryAllocate(size);
+  VLOG(1) << "Called StreamExecutor::UnifiedMemoryAllocate(size=" << size
+          << ") returns " << buf << StackTraceIfVLOG10();
+  if (buf != nullptr) CreateAllocRecord(buf, size);
+  return buf;
+}
+
 bool StreamExecutor::GetSymbol(const string &symbol_name, void **mem,
                                size_t *bytes) {
   return implementation_->GetSymbol(symbol_name, mem, bytes);
@@ -629,6 +650,12 @@ bool StreamExecutor::Memset32(Stream *stream, DeviceMemoryBase *location,
   return implementation_->Memset32(stream, location, pattern, size);
 }
 
+bool StreamExecutor::MemPrefetch(Stream *stream,
+                                 const DeviceMemoryBase &location,
+                                 uint64 size) {
+  return implementation_->MemPrefetch(stream, location, size);
+}
+
 bool StreamExecutor::HostCallback(Stream *stream,
                                   std::function<void()> callback) {
   return implementation_->HostCallback(stream, std::move(callback));
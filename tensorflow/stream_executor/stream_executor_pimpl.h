@@ -184,6 +184,12 @@ class StreamExecutor {
   // Note: this will only be populated if --check_gpu_leaks flag is activated.
   void GetMemAllocs(std::map<void *, AllocRecord> *records_out);
 
+  // Synchronously allocates size bytes of unified (managed) memory, which is
+  // addressable from the device and the host and migrated between them by
+  // the platform on demand. Returns nullptr on failure or if the platform
+  // has no unified memory. The memory is released with Deallocate().
+  void *UnifiedMemoryAllocate(uint64 size);
+
   // Allocates a region of host memory and registers it with the platform API.
   // Memory allocated in this manner (or allocated and registered with
   // HostMemoryRegister() is required for use in asynchronous memcpy operations,
@@ -282,6 +288,12 @@ class StreamExecutor {
   bool Memset32(Stream *stream, DeviceMemoryBase *location, uint32 pattern,
                 uint64 size) SE_MUST_USE_RESULT;
 
+  // Enqueues a migration of size bytes of unified memory at location to this
+  // device onto stream. Returns false if the platform cannot prefetch, in
+  // which case the memory still migrates when it is first touched.
+  bool MemPrefetch(Stream *stream, const DeviceMemoryBase &location,
+                   uint64 size);
+
   // Enables peer access from this StreamExecutor to memory
   // allocated by other, such that launched device code, memcpies, etc may
   // access it directly.
@@ -365,7 +377,8 @@ class StreamExecutor {
       int num_layers, int hidden_size, int input_size,
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
       dnn::RnnMode rnn_mode, dnn::DataType data_type, float dropout,
-      uint64 seed, ScratchAllocator *state_allocator);
+      uint64 seed, ScratchAllocator *state_allocator,
+      dnn::RnnAlgorithm rnn_algorithm = dnn::RnnAlgorithm::kRnnStandard);
 
   // Create a RNN sequence descriptor that specifies either the input or output
   // sequence. The caller retains the ownership of the returned descriptor.
@@ -373,6 +386,13 @@ class StreamExecutor {
   createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
                                     int data_size, dnn::DataType data_type);
 
+  // Create a RNN sequence descriptor for a packed batch of variable-length
+  // sequences, with batch_sizes[t] sequences active at step t. The caller
+  // retains the ownership of the returned descriptor.
+  port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(const std::vector<int> &batch_sizes,
+                                    int data_size, dnn::DataType data_type);
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/temporary_memory_manager.h"
 
+#include <algorithm>
+
 #include "tensorflow/stream_executor/platform/logging.h"
 #include "tensorflow/stream_executor/lib/stringprintf.h"
 #include "tensorflow/stream_executor/lib/ptr_util.h"
@@ -25,6 +27,8 @@ namespace perftools {
 namespace gputools {
 namespace internal {
 
+constexpr uint64 TemporaryMemoryManager::kMaxPooledBytes;
+
 void TemporaryMemoryManager::ForceDeallocateAll() {
   mutex_lock lock(mutex_);
   VLOG(1) << "force-deallocating " << records_.size() << " remaining records";
@@ -32,6 +36,29 @@ void TemporaryMemoryManager::ForceDeallocateAll() {
     DeviceMemoryBase device_memory = it->first;
     stream_->parent()->Deallocate(&device_memory);
   }
+  records_.clear();
+  stats_.bytes_in_use = 0;
+  ReleasePool();
+}
+
+void TemporaryMemoryManager::ReleasePool() {
+  VLOG(1) << "releasing " << pool_.size() << " pooled temporaries";
+  for (auto& region : pool_) {
+    stream_->parent()->Deallocate(&region.second.device_memory);
+  }
+  pool_.clear();
+  stats_.bytes_pooled = 0;
+}
+
+DeviceMemoryBase TemporaryMemoryManager::TakePooledRegion(uint64 byte_size) {
+  auto it = pool_.lower_bound(byte_size);
+  if (it == pool_.end() || it->first > 2 * byte_size) {
+    return DeviceMemoryBase();
+  }
+  DeviceMemoryBase device_memory = it->second.device_memory;
+  pool_.erase(it);
+  stats_.bytes_pooled -= device_memory.size();
+  return device_memory;
 }
 
 void TemporaryMemoryManager::MarkFinalized(
@@ -45,22 +72,36 @@ void TemporaryMemoryManager::MarkFinalized(
     }
     return;
   }
-  it->second.finalized = true;
+  if (it->second.allocation_generation != generation) {
+    // The region was finalized and then handed out again; the record belongs
+    // to the new temporary.
+    return;
+  }
+  DeviceMemoryBase pooled = it->first;
+  records_.erase(it);
+  stats_.bytes_in_use -= pooled.size();
+  if (stats_.bytes_pooled + pooled.size() > kMaxPooledBytes) {
+    stream_->parent()->Deallocate(&pooled);
+    return;
+  }
+  stats_.bytes_pooled += pooled.size();
+  pool_.emplace(pooled.size(), PooledMemoryRegion{pooled, epoch_});
 }
 
 void TemporaryMemoryManager::DeallocateFinalizedTemporaries() {
   mutex_lock lock(mutex_);
   int deallocated_count = 0;
-  for (auto it = records_.begin(); it != records_.end();) {
-    if (it->second.finalized) {
-      DeviceMemoryBase device_memory = it->first;
-      stream_->parent()->Deallocate(&device_memory);
+  for (auto it = pool_.begin(); it != pool_.end();) {
+    if (it->second.epoch < epoch_) {
+      stats_.bytes_pooled -= it->first;
+      stream_->parent()->Deallocate(&it->second.device_memory);
       ++deallocated_count;
-      it = records_.erase(it);
+      it = pool_.erase(it);
     } else {
       ++it;
     }
   }
+  ++epoch_;
   VLOG(1) << "deallocated " << deallocated_count << " finalized temporaries";
 }
 
@@ -72,12 +113,15 @@ bool TemporaryMemoryManager::IsFinalized(const DeviceMemoryBase& device_memory,
     return true;  // If there's no record present it's vacuously finalized.
   }
 
-  if (it->second.allocation_generation == allocation_generation) {
-    return it->second.finalized;
-  }
+  // Records are removed on finalization, so a record of the same generation
+  // is live. If the allocation generation did not match, it's vacuously true.
+  return it->second.allocation_generation != allocation_generation;
+}
 
-  // If the allocation generation did not match, it's vacuously true.
-  return true;
+TemporaryMemoryManager::PoolStats TemporaryMemoryManager::GetPoolStats()
+    const {
+  mutex_lock lock(mutex_);
+  return stats_;
 }
 
 bool TemporaryMemoryManager::HasAllocated(const DeviceMemoryBase& device_memory,
@@ -94,24 +138,38 @@ port::StatusOr<std::unique_ptr<TemporaryDeviceMemoryBase>>
 TemporaryMemoryManager::AllocateArrayBase(uint64 element_count,
                                           uint64 element_size) {
   uint64 byte_size = element_count * element_size;
-  DeviceMemoryBase device_memory =
-      stream_->parent()->AllocateArray<uint8>(byte_size);
-  if (device_memory == nullptr) {
-    return port::Status(port::error::RESOURCE_EXHAUSTED,
-                        port::StrCat("could not allocate temporary memory of ",
-                                     byte_size, " bytes"));
-  }
-
   uint64 generation;
+  DeviceMemoryBase device_memory;
 
   // Add the record before instantiating the device memory instance so we can
   // check the allocation invariant at TemporaryDeviceMemory construction time.
   {
     mutex_lock lock(mutex_);
+    // Zero-sized temporaries are left to the platform.
+    if (byte_size > 0) device_memory = TakePooledRegion(byte_size);
+    if (device_memory == nullptr) {
+      device_memory = stream_->parent()->AllocateArray<uint8>(byte_size);
+      if (device_memory == nullptr && !pool_.empty()) {
+        // The pooled regions may be what keeps the allocation from fitting.
+        ReleasePool();
+        device_memory = stream_->parent()->AllocateArray<uint8>(byte_size);
+      }
+      if (device_memory == nullptr) {
+        return port::Status(
+            port::error::RESOURCE_EXHAUSTED,
+            port::StrCat("could not allocate temporary memory of ", byte_size,
+                         " bytes"));
+      }
+      ++stats_.num_platform_allocations;
+    } else {
+      ++stats_.num_pooled_allocations;
+    }
+    stats_.bytes_in_use += device_memory.size();
+    stats_.peak_bytes_in_use =
+        std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
     generation = ++generation_;
     DCHECK(records_.find(device_memory) == records_.end());
-    records_[device_memory] = {generation,
-                               /*finalized=*/false};
+    records_[device_memory] = {generation};
   }
 
   VLOG(1) << port::Printf(
@@ -14,9 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 // The temporary-memory-manager is a helper class for a Stream to keep track of
-// temporary allocations. These allocations defer their deallocation to the next
-// Stream::BlockHostUntilDone call for efficiency purposes (as deallocation
-// itself generally forces synchronization to occur).
+// temporary allocations. Rather than being deallocated, which generally forces
+// synchronization to occur, finalized temporaries go back to a pool owned by
+// the stream and serve its later temporary allocations.
 
 #ifndef TENSORFLOW_STREAM_EXECUTOR_TEMPORARY_MEMORY_MANAGER_H_
 #define TENSORFLOW_STREAM_EXECUTOR_TEMPORARY_MEMORY_MANAGER_H_
@@ -43,27 +43,56 @@ struct TemporaryMemoryRecord {
   // Currently the generation counter is bumped for every allocation, but this
   // could be made coarser if necessary.
   uint64 allocation_generation;
+};
+
+// A region of a finalized temporary, kept for later allocations.
+struct PooledMemoryRegion {
+  DeviceMemoryBase device_memory;
 
-  // Notes whether the temporary memory has been marked as finalized, such that
-  // we can release the DeviceMemory associated with this record at
-  // synchronization time.
-  bool finalized;
+  // The number of DeallocateFinalizedTemporaries calls before the region was
+  // pooled.
+  uint64 epoch;
 };
 
 // Manages temporary memories associated with a stream -- keeps records of
 // outstanding temporaries and their state, and can deallocate them
 // appropriately at points in the Stream lifecycle (e.g. BlockHostUntilDone,
 // destruction).
+//
+// The memory of a finalized temporary is kept in a pool and reused by later
+// allocations on the same stream, instead of calling into the platform
+// allocator for each temporary. This is safe without waiting for the stream:
+// the work using the new temporary is enqueued on the stream after the work
+// that used the old one, so it runs after it.
 class TemporaryMemoryManager {
  public:
-  explicit TemporaryMemoryManager(Stream* stream) : stream_(stream) {}
+  // The pool releases the regions beyond this many bytes to the platform.
+  static constexpr uint64 kMaxPooledBytes = uint64{1} << 30;
+
+  // Counters of the temporary allocations of a stream.
+  struct PoolStats {
+    // Allocations served by the platform allocator.
+    uint64 num_platform_allocations = 0;
+    // Allocations served by the pool.
+    uint64 num_pooled_allocations = 0;
+    // Bytes held by live temporaries.
+    uint64 bytes_in_use = 0;
+    // The maximum of bytes_in_use so far.
+    uint64 peak_bytes_in_use = 0;
+    // Bytes held by the pool for later allocations.
+    uint64 bytes_pooled = 0;
+  };
+
+  explicit TemporaryMemoryManager(Stream* stream)
+      : generation_(0), stream_(stream) {}
 
   // Allocates a temporary array that is then managed by this object.
   template <typename T>
   port::StatusOr<std::unique_ptr<TemporaryDeviceMemory<T>>> AllocateArray(
       uint64 element_count);
 
-  // Forces deallocation of all managed temporary memory regions.
+  // Forces deallocation of all managed temporary memory regions, including
+  // the pooled ones.
   //
   // Called, for example, when the Stream owning this temporary memory manager
   // is destroyed.
@@ -71,14 +100,17 @@ class TemporaryMemoryManager {
   // Note: These calls to Deallocate will likely force synchronization.
   void ForceDeallocateAll();
 
-  // Marks the given memory region as finalized.
+  // Marks the given memory region as finalized, and returns it to the pool.
   //
   // If must_exist is set, this will check-fail if the temporary memory record
-  // is not found.
+  // is not found. The call does nothing if the region has since been
+  // reallocated in another generation.
   void MarkFinalized(const DeviceMemoryBase& device_memory, uint64 generation,
                      bool must_exist);
 
-  // Deallocates temporary memories that have been finalized.
+  // Deallocates the pooled regions that no allocation has reused since the
+  // previous call, so that the pool follows the temporaries the stream
+  // currently needs.
   //
   // Note: These calls to Deallocate will likely force synchronization, so it is
   // meant to be called before a "BlockHostUntilDone" is about to be performed.
@@ -100,6 +132,9 @@ class TemporaryMemoryManager {
   bool HasAllocated(const DeviceMemoryBase& device_memory,
                     uint64 generation) const;
 
+  // Returns the counters of the temporary allocations so far.
+  PoolStats GetPoolStats() const;
+
  private:
   // Allocates an array without type parameterization, so that the
   // implementation can live in the source file. Without this base allocation
@@ -108,6 +143,16 @@ class TemporaryMemoryManager {
   port::StatusOr<std::unique_ptr<TemporaryDeviceMemoryBase>> AllocateArrayBase(
       uint64 element_count, uint64 element_size);
 
+  // Returns the smallest pooled region of at least "byte_size" bytes, but no
+  // more than twice as large so that small temporaries do not pin large
+  // regions, removing it from the pool. Returns a null region if there is
+  // none.
+  DeviceMemoryBase TakePooledRegion(uint64 byte_size)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Deallocates all the pooled regions.
+  void ReleasePool() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Mutex to guard temporary record state.
   mutable mutex mutex_;
 
@@ -117,6 +162,14 @@ class TemporaryMemoryManager {
   // allocated and owned by this temporary memory manager.
   std::map<DeviceMemoryBase, TemporaryMemoryRecord> records_ GUARDED_BY(mutex_);
 
+  // The regions of the finalized temporaries, keyed by size.
+  std::multimap<uint64, PooledMemoryRegion> pool_ GUARDED_BY(mutex_);
+
+  // The number of DeallocateFinalizedTemporaries calls so far.
+  uint64 epoch_ GUARDED_BY(mutex_) = 0;
+
+  PoolStats stats_ GUARDED_BY(mutex_);
+
   // Allocation generation -- we bump this counter to distinguish temporary
   // memory handles that have been deallocated and later reallocated at the same
   // device memory address.
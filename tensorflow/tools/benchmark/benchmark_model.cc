@@ -20,7 +20,11 @@ limitations under the License.
 
 #include "tensorflow/tools/benchmark/benchmark_model.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
+#include <iomanip>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -33,6 +37,11 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -45,6 +54,12 @@ limitations under the License.
 #include "tensorflow/core/util/reporter.h"
 #include "tensorflow/core/util/stat_summarizer.h"
 
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/contrib/batching/basic_batch_scheduler.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#endif
+
 namespace tensorflow {
 namespace benchmark_model {
 
@@ -310,6 +325,343 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs,
   return Status::OK();
 }
 
+namespace {
+
+#if !defined(IS_MOBILE_PLATFORM)
+// A run requested by a client, to be merged with the others into a batch.
+struct BatchedRun : public serving::BatchTask {
+  size_t size() const override { return 1; }
+
+  // Owned by the client, which waits for done. The task itself is deleted
+  // with its batch.
+  Status* status;
+  Notification* done;
+};
+
+// Runs a batch of runs at once, with the inputs repeated for each of them
+// along their first dimension.
+void ProcessBatch(const std::vector<InputLayerInfo>& inputs,
+                  const std::vector<string>& outputs, Session* session,
+                  std::unique_ptr<serving::Batch<BatchedRun>> batch) {
+  std::vector<InputLayerInfo> batch_inputs = inputs;
+  for (InputLayerInfo& input : batch_inputs) {
+    input.shape.set_dim(0, input.shape.dim_size(0) * batch->num_tasks());
+  }
+  std::vector<std::pair<string, tensorflow::Tensor> > input_tensors;
+  CreateTensorsFromInputInfo(batch_inputs, &input_tensors);
+  std::vector<tensorflow::Tensor> output_tensors;
+  const Status s = session->Run(input_tensors, outputs, {}, &output_tensors);
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    BatchedRun* run = batch->mutable_task(i);
+    *run->status = s;
+    run->done->Notify();
+  }
+}
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
+#if !defined(IS_MOBILE_PLATFORM)
+// Predicts the costs on a device that runs one operation and moves one byte
+// per nanosecond, so the compute and memory times in nanoseconds are the
+// FLOPs and the bytes of the op.
+class OpWorkEstimator : public grappler::OpLevelCostEstimator {
+ public:
+  // Returns the peak GFLOP/s and GB/s that grappler estimates for device.
+  std::pair<double, double> DevicePeaks(const DeviceProperties& device) const {
+    return OpLevelCostEstimator::GetDeviceInfo(device);
+  }
+
+ protected:
+  std::pair<double, double> GetDeviceInfo(
+      const DeviceProperties& device) const override {
+    return std::make_pair(1.0, 1.0);
+  }
+};
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
+std::ostream& RooflineField(std::ostream& stream, int width) {
+  stream << "\t" << std::right << std::setw(width) << std::fixed
+         << std::setprecision(3);
+  return stream;
+}
+
+// Logs the latency distribution and the throughput of the runs.
+void LogLatencies(std::vector<int64> latencies_us, int64 total_time_us) {
+  std::sort(latencies_us.begin(), latencies_us.end());
+  histogram::Histogram histogram;
+  for (const int64 latency : latencies_us) {
+    histogram.Add(latency);
+  }
+  LOG(INFO) << "Latency percentiles in us: "
+            << "p50: " << LatencyPercentile(latencies_us, 50) << ", "
+            << "p90: " << LatencyPercentile(latencies_us, 90) << ", "
+            << "p99: " << LatencyPercentile(latencies_us, 99) << ", "
+            << "p99.9: " << LatencyPercentile(latencies_us, 99.9) << ", "
+            << "max: " << latencies_us.back();
+  LOG(INFO) << "Throughput: "
+            << latencies_us.size() * 1000000.0 / total_time_us << " runs/s";
+  LOG(INFO) << "Latency histogram in us:\n" << histogram.ToString();
+}
+
+}  // namespace
+
+Status TimeConcurrentRuns(const LoadOptions& options, int num_runs,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          std::vector<int64>* latencies_us,
+                          int64* total_time_us) {
+  if (options.num_clients < 1) {
+    return errors::InvalidArgument("At least one client is needed, got ",
+                                   options.num_clients);
+  }
+#if defined(IS_MOBILE_PLATFORM)
+  if (options.max_batch_size > 0) {
+    return errors::Unimplemented("Batching is not supported on mobile");
+  }
+#else
+  std::unique_ptr<serving::BasicBatchScheduler<BatchedRun>> batch_scheduler;
+  if (options.max_batch_size > 0) {
+    for (const InputLayerInfo& input : inputs) {
+      if (input.shape.dims() == 0) {
+        return errors::InvalidArgument("Can't batch the scalar input ",
+                                       input.name);
+      }
+    }
+    serving::BasicBatchScheduler<BatchedRun>::Options scheduler_options;
+    scheduler_options.max_batch_size = options.max_batch_size;
+    scheduler_options.batch_timeout_micros = options.batch_timeout_us;
+    scheduler_options.thread_pool_name = "benchmark_batch_threads";
+    // Every client has at most one run in flight, so no run is rejected.
+    scheduler_options.max_enqueued_batches = options.num_clients;
+    TF_RETURN_IF_ERROR(serving::BasicBatchScheduler<BatchedRun>::Create(
+        scheduler_options,
+        [&inputs, &outputs,
+         session](std::unique_ptr<serving::Batch<BatchedRun>> batch) {
+          ProcessBatch(inputs, outputs, session, std::move(batch));
+        },
+        &batch_scheduler));
+  }
+#endif  // defined(IS_MOBILE_PLATFORM)
+
+  LOG(INFO) << "Running benchmark for " << num_runs << " iterations from "
+            << options.num_clients << " clients "
+            << (options.target_qps > 0
+                    ? strings::StrCat("at ", options.target_qps, " QPS")
+                    : string("in closed loop"))
+            << (options.max_batch_size > 0
+                    ? strings::StrCat(" in batches of up to ",
+                                      options.max_batch_size)
+                    : string())
+            << ":";
+
+  latencies_us->assign(num_runs, 0);
+  std::vector<Status> client_status(options.num_clients);
+  std::atomic<int> next_run(0);
+  Env* env = Env::Default();
+  const int64 start_time = env->NowMicros();
+  {
+    thread::ThreadPool clients(env, "benchmark_clients", options.num_clients);
+    for (int c = 0; c < options.num_clients; ++c) {
+      clients.Schedule([&, c]() {
+        std::vector<std::pair<string, tensorflow::Tensor> > input_tensors;
+        CreateTensorsFromInputInfo(inputs, &input_tensors);
+        for (int run = next_run++; run < num_runs; run = next_run++) {
+          int64 due_time = env->NowMicros();
+          if (options.target_qps > 0) {
+            due_time = start_time +
+                       static_cast<int64>(run * 1000000.0 / options.target_qps);
+            const int64 now = env->NowMicros();
+            if (due_time > now) {
+              env->SleepForMicroseconds(due_time - now);
+            }
+          }
+          Status s;
+#if !defined(IS_MOBILE_PLATFORM)
+          if (batch_scheduler) {
+            Notification done;
+            std::unique_ptr<BatchedRun> batched_run(new BatchedRun);
+            batched_run->status = &s;
+            batched_run->done = &done;
+            s = batch_scheduler->Schedule(&batched_run);
+            if (s.ok()) {
+              done.WaitForNotification();
+            }
+          } else
+#endif  // !defined(IS_MOBILE_PLATFORM)
+          {
+            std::vector<tensorflow::Tensor> output_tensors;
+            s = session->Run(input_tensors, outputs, {}, &output_tensors);
+          }
+          (*latencies_us)[run] = env->NowMicros() - due_time;
+          if (!s.ok()) {
+            LOG(ERROR) << "Error during inference: " << s;
+            client_status[c] = s;
+            // Stops the other clients too.
+            next_run = num_runs;
+            break;
+          }
+        }
+      });
+    }
+  }
+  *total_time_us = env->NowMicros() - start_time;
+  for (const Status& s : client_status) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  LogLatencies(*latencies_us, *total_time_us);
+  return Status::OK();
+}
+
+Status CalculateRoofline(const GraphDef& graph,
+                         const std::vector<InputLayerInfo>& inputs,
+                         const StatSummarizer& stats,
+                         std::vector<OpRoofline>* ops) {
+#if defined(IS_MOBILE_PLATFORM)
+  return errors::Unimplemented("The roofline is not supported on mobile");
+#else
+  const auto& details = stats.GetDetails();
+  OpWorkEstimator estimator;
+  for (const NodeDef& node : graph.node()) {
+    // The outputs are only recorded on the device that schedules the op.
+    auto detail = details.find(node.name());
+    if (detail == details.end() || detail->second.rel_end_us.empty()) {
+      continue;
+    }
+    // Prefers the accelerator time of the kernels if there is one.
+    auto time_detail = details.find(strings::StrCat(node.name(), " [Kernel]"));
+    if (time_detail == details.end()) {
+      time_detail = detail;
+    }
+
+    OpInfo op_info;
+    op_info.set_op(node.op());
+    *op_info.mutable_attr() = node.attr();
+    for (const string& input : node.input()) {
+      const TensorId input_id = ParseTensorName(input);
+      if (input_id.second < 0) {
+        // Control input.
+        continue;
+      }
+      OpInfo::TensorProperties* properties = op_info.add_inputs();
+      // The fed tensors are not produced by the graph.
+      auto fed_input = std::find_if(
+          inputs.begin(), inputs.end(), [&input_id](const InputLayerInfo& in) {
+            return ParseTensorName(in.name) == input_id;
+          });
+      if (fed_input != inputs.end()) {
+        properties->set_dtype(fed_input->data_type);
+        fed_input->shape.AsProto(properties->mutable_shape());
+        continue;
+      }
+      auto input_detail = details.find(input_id.first.ToString());
+      if (input_detail == details.end() ||
+          input_id.second >= input_detail->second.outputs.size()) {
+        properties->mutable_shape()->set_unknown_rank(true);
+        continue;
+      }
+      const TensorDescription& tensor =
+          input_detail->second.outputs[input_id.second];
+      properties->set_dtype(tensor.dtype());
+      *properties->mutable_shape() = tensor.shape();
+    }
+    for (const TensorDescription& tensor : detail->second.outputs) {
+      OpInfo::TensorProperties* properties = op_info.add_outputs();
+      properties->set_dtype(tensor.dtype());
+      *properties->mutable_shape() = tensor.shape();
+    }
+
+    const grappler::Costs costs = estimator.PredictCosts(op_info);
+    OpRoofline op;
+    op.name = node.name();
+    op.type = node.op();
+    op.avg_time_us = time_detail->second.rel_end_us.avg();
+    op.flops = costs.compute_time.count();
+    op.bytes = costs.memory_time.count();
+    op.inaccurate = costs.inaccurate;
+    ops->push_back(op);
+  }
+  return Status::OK();
+#endif  // defined(IS_MOBILE_PLATFORM)
+}
+
+void LogRoofline(std::vector<OpRoofline> ops, double peak_gflops,
+                 double peak_gbps, int limit) {
+#if !defined(IS_MOBILE_PLATFORM)
+  if (peak_gflops <= 0 || peak_gbps <= 0) {
+    OpWorkEstimator estimator;
+    const std::pair<double, double> local_peaks =
+        estimator.DevicePeaks(grappler::GetLocalCPUInfo());
+    if (peak_gflops <= 0) peak_gflops = local_peaks.first;
+    if (peak_gbps <= 0) peak_gbps = local_peaks.second;
+  }
+#endif  // !defined(IS_MOBILE_PLATFORM)
+  // The arithmetic intensity above which an op is bound by compute.
+  const double ridge_point = peak_gflops / peak_gbps;
+  std::sort(ops.begin(), ops.end(),
+            [](const OpRoofline& a, const OpRoofline& b) {
+              return a.avg_time_us > b.avg_time_us;
+            });
+
+  std::stringstream stream;
+  stream << "============================== Roofline for " << peak_gflops
+         << " GFLOP/s and " << peak_gbps
+         << " GB/s ==============================" << std::endl;
+  RooflineField(stream, 24) << "[node type]";
+  RooflineField(stream, 9) << "[avg ms]";
+  RooflineField(stream, 10) << "[MFLOPs]";
+  RooflineField(stream, 10) << "[MB]";
+  RooflineField(stream, 10) << "[FLOPs/B]";
+  RooflineField(stream, 10) << "[GFLOP/s]";
+  RooflineField(stream, 9) << "[GB/s]";
+  RooflineField(stream, 9) << "[%peak]";
+  RooflineField(stream, 8) << "[bound]";
+  stream << "\t"
+         << "[Name]" << std::endl;
+  int num_shown = 0;
+  for (const OpRoofline& op : ops) {
+    if (limit > 0 && num_shown >= limit) {
+      break;
+    }
+    if (op.avg_time_us <= 0 || (op.flops == 0 && op.bytes == 0)) {
+      continue;
+    }
+    ++num_shown;
+    // FLOPs per ns are GFLOP/s, bytes per ns are GB/s.
+    const double time_ns = op.avg_time_us * 1000.0;
+    const double gflops = op.flops / time_ns;
+    const double gbps = op.bytes / time_ns;
+    const double intensity =
+        op.bytes > 0 ? static_cast<double>(op.flops) / op.bytes : 0;
+    const bool compute_bound = op.bytes == 0 || intensity >= ridge_point;
+    // The fraction reached of the best throughput at this intensity.
+    const double percent_of_peak =
+        compute_bound ? 100.0 * gflops / peak_gflops : 100.0 * gbps / peak_gbps;
+    RooflineField(stream, 24) << op.type;
+    RooflineField(stream, 9) << op.avg_time_us / 1000.0;
+    RooflineField(stream, 10) << op.flops / 1e6;
+    RooflineField(stream, 10) << op.bytes / 1e6;
+    RooflineField(stream, 10) << intensity;
+    RooflineField(stream, 10) << gflops;
+    RooflineField(stream, 9) << gbps;
+    RooflineField(stream, 8) << percent_of_peak << "%";
+    RooflineField(stream, 8) << (compute_bound ? "compute" : "memory");
+    stream << "\t" << op.name << (op.inaccurate ? " (estimated)" : "")
+           << std::endl;
+  }
+  LOG(INFO) << stream.str();
+}
+
+int64 LatencyPercentile(const std::vector<int64>& sorted_latencies_us,
+                        double percentile) {
+  if (sorted_latencies_us.empty()) {
+    return 0;
+  }
+  // Nearest-rank percentile.
+  const int64 count = sorted_latencies_us.size();
+  int64 rank = static_cast<int64>(std::ceil(percentile * count / 100.0));
+  rank = std::min(std::max<int64>(rank, 1), count);
+  return sorted_latencies_us[rank - 1];
+}
+
 int Main(int argc, char** argv) {
   string graph = "/data/local/tmp/tensorflow_inception_graph.pb";
   string input_layer_string = "input:0";
@@ -333,6 +685,14 @@ int Main(int argc, char** argv) {
   bool show_summary = true;
   bool show_flops = false;
   int warmup_runs = 2;
+  int num_clients = 1;
+  float target_qps = 0;
+  int max_batch_size = 0;
+  int64 batch_timeout_us = 0;
+  bool show_roofline = false;
+  int roofline_limit = 10;
+  float peak_gflops = 0;
+  float peak_gbps = 0;
 
   std::vector<Flag> flag_list = {
       Flag("graph", &graph, "graph file name"),
@@ -362,6 +722,28 @@ int Main(int argc, char** argv) {
            "whether to show a summary of the stats"),
       Flag("show_flops", &show_flops, "whether to estimate the model's FLOPs"),
       Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
+      Flag("num_clients", &num_clients,
+           "number of threads running the model concurrently in the load "
+           "test (which only runs if > 1 or if --target_qps or "
+           "--max_batch_size are set)"),
+      Flag("target_qps", &target_qps,
+           "total rate at which the load test starts runs, or <= 0 to start "
+           "each as soon as a client is free"),
+      Flag("max_batch_size", &max_batch_size,
+           "if > 0, batch the runs of the load test along the first "
+           "dimension of the inputs"),
+      Flag("batch_timeout_us", &batch_timeout_us,
+           "the longest time a run of the load test waits for its batch"),
+      Flag("show_roofline", &show_roofline,
+           "whether to compare the slowest ops to the device's peaks"),
+      Flag("roofline_limit", &roofline_limit,
+           "how many items to show in the roofline"),
+      Flag("peak_gflops", &peak_gflops,
+           "peak GFLOP/s of the device for the roofline, or <= 0 to estimate "
+           "it for the local CPU"),
+      Flag("peak_gbps", &peak_gbps,
+           "peak memory bandwidth in GB/s of the device for the roofline, or "
+           "<= 0 to estimate it for the local CPU"),
   };
   string usage = Flags::Usage(argv[0], flag_list);
   const bool parse_result = Flags::Parse(&argc, argv, flag_list);
@@ -413,6 +795,9 @@ int Main(int argc, char** argv) {
   LOG(INFO) << "Output prefix: [" << output_prefix << "]";
   LOG(INFO) << "Show sizes: [" << show_sizes << "]";
   LOG(INFO) << "Warmup runs: [" << warmup_runs << "]";
+  LOG(INFO) << "Num clients: [" << num_clients << "]";
+  LOG(INFO) << "Target QPS: [" << target_qps << "]";
+  LOG(INFO) << "Max batch size: [" << max_batch_size << "]";
 
   std::unique_ptr<Session> session;
   std::unique_ptr<StatSummarizer> stats;
@@ -507,10 +892,38 @@ int Main(int argc, char** argv) {
 
   stats->PrintStepStats();
 
+  if (num_clients > 1 || target_qps > 0 || max_batch_size > 0) {
+    LoadOptions load_options;
+    load_options.num_clients = num_clients;
+    load_options.target_qps = target_qps;
+    load_options.max_batch_size = max_batch_size;
+    load_options.batch_timeout_us = batch_timeout_us;
+    std::vector<int64> latencies_us;
+    int64 load_time_us = 0;
+    Status load_status =
+        TimeConcurrentRuns(load_options, num_runs, inputs, output_layers,
+                           session.get(), &latencies_us, &load_time_us);
+    if (!load_status.ok()) {
+      LOG(ERROR) << "Load test failed with " << load_status;
+      return -1;
+    }
+  }
+
   if (show_sizes) {
     stats->PrintOutputs();
   }
 
+  if (show_roofline) {
+    std::vector<OpRoofline> roofline_ops;
+    Status roofline_status =
+        CalculateRoofline(*graph_def, inputs, *stats, &roofline_ops);
+    if (!roofline_status.ok()) {
+      LOG(ERROR) << "Roofline calculation failed with " << roofline_status;
+      return -1;
+    }
+    LogRoofline(roofline_ops, peak_gflops, peak_gbps, roofline_limit);
+  }
+
   if (show_flops) {
     int64 total_flops;
     std::unordered_map<string, int64> flops_by_op;
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 #define TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 
+#include <vector>
+
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/util/stat_summarizer.h"
 
@@ -30,6 +32,37 @@ struct InputLayerInfo {
   std::vector<float> initialization_values;
 };
 
+// Controls how TimeConcurrentRuns() drives the model.
+struct LoadOptions {
+  // The number of threads that call Session::Run() concurrently.
+  int num_clients = 1;
+  // If positive, the runs are started at this total rate, whether or not the
+  // previous ones are done, and the latency of a run includes the time it
+  // waited for a free client. Otherwise each client starts its next run as
+  // soon as the previous one is done.
+  double target_qps = 0;
+  // If positive, the runs of all the clients are merged by a
+  // BasicBatchScheduler into batches of up to this many runs, which are
+  // concatenated along the first dimension of each input.
+  int max_batch_size = 0;
+  // The longest time a run waits for its batch to fill up.
+  int64 batch_timeout_us = 0;
+};
+
+// The measured time of an op and the work that the grappler
+// OpLevelCostEstimator predicts for it.
+struct OpRoofline {
+  string name;
+  string type;
+  // The average time of one execution.
+  double avg_time_us;
+  int64 flops;
+  // The bytes of the inputs and outputs.
+  int64 bytes;
+  // Whether the estimator has no model for the op or is missing shapes.
+  bool inaccurate;
+};
+
 // Loads a model from disk into a new session.
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
@@ -46,6 +79,34 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs,
                         const std::vector<string>& outputs, Session* session,
                         StatSummarizer* stats, int64* total_time_us);
 
+// Runs the model num_runs times from options.num_clients concurrent threads.
+// Returns the latency of each run, from the time it was due to start until
+// its outputs are available, and the total wall time.
+Status TimeConcurrentRuns(const LoadOptions& options, int num_runs,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          std::vector<int64>* latencies_us,
+                          int64* total_time_us);
+
+// Returns the given percentile (between 0 and 100) of the latencies, which
+// must be sorted.
+int64 LatencyPercentile(const std::vector<int64>& sorted_latencies_us,
+                        double percentile);
+
+// Predicts the FLOPs and bytes of each node of the graph that stats has times
+// for, from the shapes of the fed inputs and of the tensors recorded in stats.
+Status CalculateRoofline(const GraphDef& graph,
+                         const std::vector<InputLayerInfo>& inputs,
+                         const StatSummarizer& stats,
+                         std::vector<OpRoofline>* ops);
+
+// Logs the achieved GFLOP/s and GB/s of the slowest ops, and whether they are
+// bound by compute or by memory, for a device with the given peak GFLOP/s and
+// GB/s. The peaks of the local CPU estimated by grappler are used for the ones
+// that are not positive.
+void LogRoofline(std::vector<OpRoofline> ops, double peak_gflops,
+                 double peak_gbps, int limit);
+
 // Handles all setup and argument parsing.
 int Main(int argc, char** argv);
 
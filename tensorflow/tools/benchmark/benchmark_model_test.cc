@@ -26,27 +26,27 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
-TEST(BenchmarkModelTest, InitializeAndRun) {
-  const string dir = testing::TmpDir();
-  const string filename_pb = io::JoinPath(dir, "graphdef.pb");
-
-  // Create a simple graph and write it to filename_pb.
+// Writes a graph multiplying the input by a constant to filename_pb. The first
+// dimension of the input is left unknown so it can be batched.
+void CreateMatMulGraph(const string& filename_pb,
+                       benchmark_model::InputLayerInfo* input,
+                       string* output_name) {
   const int input_width = 400;
   const int input_height = 10;
-  benchmark_model::InputLayerInfo input;
-  input.shape = TensorShape({input_width, input_height});
-  input.data_type = DT_FLOAT;
+  input->shape = TensorShape({input_width, input_height});
+  input->data_type = DT_FLOAT;
   const TensorShape constant_shape({input_height, input_width});
 
   Tensor constant_tensor(DT_FLOAT, constant_shape);
   test::FillFn<float>(&constant_tensor, [](int) -> float { return 3.0; });
 
   auto root = Scope::NewRootScope().ExitOnError();
-  auto placeholder =
-      ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape(input.shape));
-  input.name = placeholder.node()->name();
+  auto placeholder = ops::Placeholder(
+      root, DT_FLOAT,
+      ops::Placeholder::Shape(PartialTensorShape({-1, input_height})));
+  input->name = placeholder.node()->name();
   auto m = ops::MatMul(root, placeholder, constant_tensor);
-  const string output_name = m.node()->name();
+  *output_name = m.node()->name();
 
   GraphDef graph_def;
   TF_ASSERT_OK(root.ToGraphDef(&graph_def));
@@ -54,6 +54,14 @@ TEST(BenchmarkModelTest, InitializeAndRun) {
   graph_def.SerializeToString(&graph_def_serialized);
   TF_ASSERT_OK(
       WriteStringToFile(Env::Default(), filename_pb, graph_def_serialized));
+}
+
+TEST(BenchmarkModelTest, InitializeAndRun) {
+  const string dir = testing::TmpDir();
+  const string filename_pb = io::JoinPath(dir, "graphdef.pb");
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  CreateMatMulGraph(filename_pb, &input, &output_name);
 
   std::unique_ptr<Session> session;
   std::unique_ptr<GraphDef> loaded_graph_def;
@@ -66,5 +74,85 @@ TEST(BenchmarkModelTest, InitializeAndRun) {
       0.0, 10, {input}, {output_name}, session.get(), stats.get(), &time));
 }
 
+TEST(BenchmarkModelTest, ConcurrentRuns) {
+  const string dir = testing::TmpDir();
+  const string filename_pb = io::JoinPath(dir, "graphdef.pb");
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  CreateMatMulGraph(filename_pb, &input, &output_name);
+
+  std::unique_ptr<Session> session;
+  std::unique_ptr<GraphDef> loaded_graph_def;
+  TF_ASSERT_OK(benchmark_model::InitializeSession(1, filename_pb, &session,
+                                                  &loaded_graph_def));
+
+  benchmark_model::LoadOptions closed_loop;
+  closed_loop.num_clients = 4;
+  benchmark_model::LoadOptions fixed_rate = closed_loop;
+  fixed_rate.target_qps = 1000;
+  benchmark_model::LoadOptions batched = closed_loop;
+  batched.max_batch_size = 3;
+  batched.batch_timeout_us = 1000;
+  for (const auto& options : {closed_loop, fixed_rate, batched}) {
+    std::vector<int64> latencies_us;
+    int64 time;
+    TF_ASSERT_OK(benchmark_model::TimeConcurrentRuns(
+        options, 10, {input}, {output_name}, session.get(), &latencies_us,
+        &time));
+    ASSERT_EQ(10, latencies_us.size());
+    for (const int64 latency : latencies_us) {
+      EXPECT_LE(0, latency);
+      EXPECT_GE(time, latency);
+    }
+  }
+}
+
+TEST(BenchmarkModelTest, Roofline) {
+  const string dir = testing::TmpDir();
+  const string filename_pb = io::JoinPath(dir, "graphdef.pb");
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  CreateMatMulGraph(filename_pb, &input, &output_name);
+
+  std::unique_ptr<Session> session;
+  std::unique_ptr<GraphDef> loaded_graph_def;
+  TF_ASSERT_OK(benchmark_model::InitializeSession(1, filename_pb, &session,
+                                                  &loaded_graph_def));
+  StatSummarizer stats((StatSummarizerOptions()));
+  int64 time;
+  TF_ASSERT_OK(benchmark_model::TimeMultipleRuns(
+      0.0, 2, {input}, {output_name}, session.get(), &stats, &time));
+
+  std::vector<benchmark_model::OpRoofline> ops;
+  TF_ASSERT_OK(benchmark_model::CalculateRoofline(*loaded_graph_def, {input},
+                                                  stats, &ops));
+  const benchmark_model::OpRoofline* mat_mul = nullptr;
+  for (const auto& op : ops) {
+    if (op.type == "MatMul") {
+      mat_mul = &op;
+    }
+  }
+  ASSERT_NE(nullptr, mat_mul);
+  EXPECT_EQ(output_name, mat_mul->name);
+  EXPECT_FALSE(mat_mul->inaccurate);
+  // [400, 10] x [10, 400].
+  EXPECT_EQ(2 * 400 * 10 * 400, mat_mul->flops);
+  EXPECT_EQ((400 * 10 + 10 * 400 + 400 * 400) * 4, mat_mul->bytes);
+  benchmark_model::LogRoofline(ops, 100, 10, 10);
+}
+
+TEST(BenchmarkModelTest, LatencyPercentile) {
+  std::vector<int64> latencies_us;
+  EXPECT_EQ(0, benchmark_model::LatencyPercentile(latencies_us, 50));
+  for (int i = 1; i <= 1000; ++i) {
+    latencies_us.push_back(i);
+  }
+  EXPECT_EQ(1, benchmark_model::LatencyPercentile(latencies_us, 0));
+  EXPECT_EQ(500, benchmark_model::LatencyPercentile(latencies_us, 50));
+  EXPECT_EQ(990, benchmark_model::LatencyPercentile(latencies_us, 99));
+  EXPECT_EQ(999, benchmark_model::LatencyPercentile(latencies_us, 99.9));
+  EXPECT_EQ(1000, benchmark_model::LatencyPercentile(latencies_us, 100));
+}
+
 }  // namespace
 }  // namespace tensorflow
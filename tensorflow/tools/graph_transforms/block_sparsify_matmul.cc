@@ -0,0 +1,225 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+namespace {
+
+// Splits the [n, k] matrix `b` into blocks, and returns the blocks that
+// contain a non-zero in the layout expected by BlockSparseMatMul.  b(i, j) is
+// read from weights(i, j), or from weights(j, i) if `transpose` is set.
+template <typename T>
+void BuildBlockSparse(const Tensor& weights, bool transpose, int64 block_rows,
+                      int64 block_cols, Tensor* values, Tensor* col_indices,
+                      Tensor* row_ptr) {
+  const auto w = weights.matrix<T>();
+  const int64 n = transpose ? w.dimension(1) : w.dimension(0);
+  const int64 k = transpose ? w.dimension(0) : w.dimension(1);
+  auto b = [&w, transpose](int64 i, int64 j) {
+    return transpose ? w(j, i) : w(i, j);
+  };
+
+  std::vector<T> block_values;
+  std::vector<int32> block_col_indices;
+  std::vector<int32> block_row_ptr = {0};
+  for (int64 r = 0; r < n / block_rows; ++r) {
+    for (int64 c = 0; c < k / block_cols; ++c) {
+      bool non_zero = false;
+      for (int64 i = r * block_rows; i < (r + 1) * block_rows; ++i) {
+        for (int64 j = c * block_cols; j < (c + 1) * block_cols; ++j) {
+          non_zero |= (b(i, j) != T(0));
+        }
+      }
+      if (!non_zero) {
+        continue;
+      }
+      for (int64 i = r * block_rows; i < (r + 1) * block_rows; ++i) {
+        for (int64 j = c * block_cols; j < (c + 1) * block_cols; ++j) {
+          block_values.push_back(b(i, j));
+        }
+      }
+      block_col_indices.push_back(c);
+    }
+    block_row_ptr.push_back(block_col_indices.size());
+  }
+
+  const int64 num_blocks = block_col_indices.size();
+  *values = Tensor(DataTypeToEnum<T>::v(),
+                   TensorShape({num_blocks, block_rows, block_cols}));
+  std::copy(block_values.begin(), block_values.end(),
+            values->flat<T>().data());
+  *col_indices = Tensor(DT_INT32, TensorShape({num_blocks}));
+  std::copy(block_col_indices.begin(), block_col_indices.end(),
+            col_indices->flat<int32>().data());
+  *row_ptr = Tensor(DT_INT32,
+                    TensorShape({static_cast<int64>(block_row_ptr.size())}));
+  std::copy(block_row_ptr.begin(), block_row_ptr.end(),
+            row_ptr->flat<int32>().data());
+}
+
+}  // namespace
+
+// Replaces MatMul ops whose weights are a Const with enough all-zero blocks,
+// such as those of a model pruned with a block-structured sparsity pattern, by
+// a BlockSparseMatMul that only stores and multiplies the non-zero blocks.
+// The block size is given along the output (block_height) and input
+// (block_width) features of the weights.
+Status BlockSparsifyMatMul(const GraphDef& input_graph_def,
+                           const TransformFuncContext& context,
+                           GraphDef* output_graph_def) {
+  int32 block_height;
+  TF_RETURN_IF_ERROR(
+      context.GetOneInt32Parameter("block_height", 16, &block_height));
+  int32 block_width;
+  TF_RETURN_IF_ERROR(
+      context.GetOneInt32Parameter("block_width", 16, &block_width));
+  float min_sparsity;
+  TF_RETURN_IF_ERROR(
+      context.GetOneFloatParameter("min_sparsity", 0.5f, &min_sparsity));
+  if (block_height <= 0 || block_width <= 0) {
+    return errors::InvalidArgument(
+        "block_height and block_width must be positive, but are ",
+        block_height, " and ", block_width);
+  }
+
+  GraphDef replaced_graph_def;
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      input_graph_def,  // clang-format off
+      {"MatMul",
+          {
+              {"*"},
+              {"Const"}
+          }
+      },  // clang-format on
+      [block_height, block_width, min_sparsity](
+          const NodeMatch& match, const std::set<string>& input_nodes,
+          const std::set<string>& output_nodes,
+          std::vector<NodeDef>* new_nodes) {
+        const NodeDef& matmul_node = match.node;
+        const NodeDef& input_node = match.inputs[0].node;
+        const NodeDef& weights_node = match.inputs[1].node;
+
+        // Leave the match untouched if it can't be converted.
+        auto keep_original = [&]() {
+          new_nodes->push_back(matmul_node);
+          new_nodes->push_back(input_node);
+          new_nodes->push_back(weights_node);
+          return Status::OK();
+        };
+        DataType dtype;
+        TF_RETURN_IF_ERROR(GetNodeAttr(matmul_node, "T", &dtype));
+        bool transpose_a;
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(matmul_node, "transpose_a", &transpose_a));
+        bool transpose_b;
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(matmul_node, "transpose_b", &transpose_b));
+        if ((dtype != DT_FLOAT && dtype != DT_DOUBLE) || transpose_a) {
+          return keep_original();
+        }
+        if (!weights_node.attr().count("value")) {
+          return errors::InvalidArgument("No 'value' attribute for Const node ",
+                                         weights_node.name());
+        }
+        Tensor weights;
+        if (!weights.FromProto(weights_node.attr().at("value").tensor())) {
+          return errors::InvalidArgument("Decoding Tensor failed for node ",
+                                         weights_node.name());
+        }
+        if (weights.dims() != 2 || weights.dtype() != dtype) {
+          return keep_original();
+        }
+
+        // The weights of MatMul are [k, n] unless transpose_b is set, while
+        // BlockSparseMatMul needs them as an [n, k] matrix.
+        const int64 n = weights.dim_size(transpose_b ? 0 : 1);
+        const int64 k = weights.dim_size(transpose_b ? 1 : 0);
+        if (n == 0 || k == 0 || n % block_height != 0 ||
+            k % block_width != 0) {
+          return keep_original();
+        }
+
+        Tensor values;
+        Tensor col_indices;
+        Tensor row_ptr;
+        if (dtype == DT_FLOAT) {
+          BuildBlockSparse<float>(weights, !transpose_b, block_height,
+                                  block_width, &values, &col_indices,
+                                  &row_ptr);
+        } else {
+          BuildBlockSparse<double>(weights, !transpose_b, block_height,
+                                   block_width, &values, &col_indices,
+                                   &row_ptr);
+        }
+        const int64 total_blocks = (n / block_height) * (k / block_width);
+        const float sparsity =
+            1.0f - static_cast<float>(values.dim_size(0)) / total_blocks;
+        if (sparsity < min_sparsity) {
+          return keep_original();
+        }
+
+        new_nodes->push_back(input_node);
+
+        NodeDef values_node;
+        values_node.set_op("Const");
+        values_node.set_name(matmul_node.name() + "_bsr_values");
+        SetNodeAttr("dtype", dtype, &values_node);
+        SetNodeTensorAttr<float>("value", values, &values_node);
+        new_nodes->push_back(values_node);
+
+        NodeDef col_indices_node;
+        col_indices_node.set_op("Const");
+        col_indices_node.set_name(matmul_node.name() + "_bsr_col_indices");
+        SetNodeAttr("dtype", DT_INT32, &col_indices_node);
+        SetNodeTensorAttr<int32>("value", col_indices, &col_indices_node);
+        new_nodes->push_back(col_indices_node);
+
+        NodeDef row_ptr_node;
+        row_ptr_node.set_op("Const");
+        row_ptr_node.set_name(matmul_node.name() + "_bsr_row_ptr");
+        SetNodeAttr("dtype", DT_INT32, &row_ptr_node);
+        SetNodeTensorAttr<int32>("value", row_ptr, &row_ptr_node);
+        new_nodes->push_back(row_ptr_node);
+
+        NodeDef block_sparse_node;
+        block_sparse_node.set_op("BlockSparseMatMul");
+        block_sparse_node.set_name(matmul_node.name());
+        SetNodeAttr("T", dtype, &block_sparse_node);
+        AddNodeInput(matmul_node.input(0), &block_sparse_node);
+        AddNodeInput(values_node.name(), &block_sparse_node);
+        AddNodeInput(col_indices_node.name(), &block_sparse_node);
+        AddNodeInput(row_ptr_node.name(), &block_sparse_node);
+        new_nodes->push_back(block_sparse_node);
+
+        return Status::OK();
+      },
+      {}, &replaced_graph_def));
+  *output_graph_def = replaced_graph_def;
+  return Status::OK();
+}
+
+REGISTER_GRAPH_TRANSFORM("block_sparsify_matmul", BlockSparsifyMatMul);
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
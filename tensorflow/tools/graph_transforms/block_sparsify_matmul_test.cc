@@ -0,0 +1,140 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status BlockSparsifyMatMul(const GraphDef& input_graph_def,
+                           const TransformFuncContext& context,
+                           GraphDef* output_graph_def);
+
+class BlockSparsifyMatMulTest : public ::testing::Test {
+ protected:
+  // Builds a MatMul of a [3, 8] input with [8, 4] weights (or their
+  // transpose), where only two of the eight 2x2 blocks of the weights are
+  // non-zero, and checks the result of the transform against the original.
+  void TestBlockSparsify(bool transpose_b, const string& min_sparsity,
+                         bool expect_block_sparse) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor input_data(DT_FLOAT, TensorShape({3, 8}));
+    test::FillValues<float>(
+        &input_data,
+        {1.0f,  2.0f,  3.0f,  4.0f,  5.0f,  6.0f,  7.0f,  8.0f,
+         -1.0f, 0.5f,  -2.0f, 1.5f,  -3.0f, 2.5f,  -4.0f, 3.5f,
+         0.1f,  0.2f,  0.3f,  0.4f,  0.5f,  0.6f,  0.7f,  0.8f});
+    Output input_op =
+        Const(root.WithOpName("input_op"), Input::Initializer(input_data));
+
+    Tensor weights_data(DT_FLOAT, TensorShape({8, 4}));
+    test::FillValues<float>(
+        &weights_data,
+        {1.0f, 2.0f, 0.0f, 0.0f,
+         3.0f, 4.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 0.0f, 0.0f,
+         0.0f, 0.0f, 5.0f, 0.0f,
+         0.0f, 0.0f, 0.0f, 6.0f});
+    if (transpose_b) {
+      Tensor transposed(DT_FLOAT, TensorShape({4, 8}));
+      transposed.matrix<float>() =
+          weights_data.matrix<float>().shuffle(Eigen::array<int, 2>({1, 0}));
+      weights_data = transposed;
+    }
+    Output weights_op =
+        Const(root.WithOpName("weights_op"), Input::Initializer(weights_data));
+
+    Output matmul_op = MatMul(root.WithOpName("output"), input_op, weights_op,
+                              MatMul::TransposeB(transpose_b));
+
+    GraphDef original_graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&original_graph_def));
+
+    std::unique_ptr<Session> original_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(original_session->Create(original_graph_def));
+    std::vector<Tensor> original_outputs;
+    TF_ASSERT_OK(original_session->Run({}, {"output"}, {}, &original_outputs));
+
+    TransformFuncContext context;
+    context.output_names = {"output"};
+    context.params["block_height"] = {"2"};
+    context.params["block_width"] = {"2"};
+    context.params["min_sparsity"] = {min_sparsity};
+    GraphDef sparsified_graph_def;
+    TF_ASSERT_OK(BlockSparsifyMatMul(original_graph_def, context,
+                                     &sparsified_graph_def));
+
+    std::unique_ptr<Session> sparsified_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(sparsified_session->Create(sparsified_graph_def));
+    std::vector<Tensor> sparsified_outputs;
+    TF_ASSERT_OK(
+        sparsified_session->Run({}, {"output"}, {}, &sparsified_outputs));
+
+    test::ExpectTensorNear<float>(original_outputs[0], sparsified_outputs[0],
+                                  1e-5);
+
+    std::map<string, const NodeDef*> node_lookup;
+    MapNamesToNodes(sparsified_graph_def, &node_lookup);
+    ASSERT_EQ(1, node_lookup.count("output"));
+    if (!expect_block_sparse) {
+      EXPECT_EQ("MatMul", node_lookup.at("output")->op());
+      return;
+    }
+    EXPECT_EQ("BlockSparseMatMul", node_lookup.at("output")->op());
+    EXPECT_EQ(0, node_lookup.count("weights_op"));
+    ASSERT_EQ(1, node_lookup.count("output_bsr_values"));
+    Tensor values = GetNodeTensorAttr(*node_lookup.at("output_bsr_values"),
+                                      "value");
+    EXPECT_EQ(TensorShape({2, 2, 2}), values.shape());
+    Tensor expected_col_indices(DT_INT32, TensorShape({2}));
+    test::FillValues<int32>(&expected_col_indices, {0, 3});
+    test::ExpectTensorEqual<int32>(
+        expected_col_indices,
+        GetNodeTensorAttr(*node_lookup.at("output_bsr_col_indices"),
+                          "value"));
+    Tensor expected_row_ptr(DT_INT32, TensorShape({3}));
+    test::FillValues<int32>(&expected_row_ptr, {0, 1, 2});
+    test::ExpectTensorEqual<int32>(
+        expected_row_ptr,
+        GetNodeTensorAttr(*node_lookup.at("output_bsr_row_ptr"), "value"));
+  }
+};
+
+TEST_F(BlockSparsifyMatMulTest, TestBlockSparsify) {
+  TestBlockSparsify(false, "0.5", true);
+}
+
+TEST_F(BlockSparsifyMatMulTest, TestBlockSparsifyTransposed) {
+  TestBlockSparsify(true, "0.5", true);
+}
+
+TEST_F(BlockSparsifyMatMulTest, TestKeepsDenseMatMul) {
+  TestBlockSparsify(false, "0.9", false);
+}
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
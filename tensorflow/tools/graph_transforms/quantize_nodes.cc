@@ -541,6 +541,146 @@ Status MergeAdjacentRequantizes(const GraphDef& input_graph_def,
   return Status::OK();
 }
 
+namespace {
+
+// Returns the value of a type attribute, or default_type if it isn't set.
+DataType TypeAttrOrDefault(const NodeDef& node, const string& key,
+                           DataType default_type) {
+  auto it = node.attr().find(key);
+  return it == node.attr().end() ? default_type : it->second.type();
+}
+
+// Builds a QuantizedMatMulWithBiasAndRequantize node called `name` that
+// replaces matmul_node and a Requantize into the range given by the min_node
+// and max_node constants.  An empty bias constant is added to new_nodes.
+void AddFusedQuantizedMatMul(const string& name, const NodeDef& matmul_node,
+                             const NodeDef& min_node, const NodeDef& max_node,
+                             bool fuse_relu, std::vector<NodeDef>* new_nodes) {
+  NodeDef bias_node;
+  bias_node.set_op("Const");
+  bias_node.set_name(name + "_bias");
+  SetNodeAttr("dtype", DT_FLOAT, &bias_node);
+  SetNodeTensorAttr<float>("value", Tensor(DT_FLOAT, TensorShape({0})),
+                           &bias_node);
+  new_nodes->push_back(bias_node);
+  new_nodes->push_back(min_node);
+  new_nodes->push_back(max_node);
+
+  NodeDef fused_node;
+  fused_node.set_op("QuantizedMatMulWithBiasAndRequantize");
+  fused_node.set_name(name);
+  fused_node.set_device(matmul_node.device());
+  SetNodeAttr("T1", DT_QUINT8, &fused_node);
+  SetNodeAttr("T2", DT_QUINT8, &fused_node);
+  SetNodeAttr("Toutput", DT_QUINT8, &fused_node);
+  CopyNodeAttr(matmul_node, "transpose_a", "transpose_a", &fused_node);
+  CopyNodeAttr(matmul_node, "transpose_b", "transpose_b", &fused_node);
+  SetNodeAttr("fuse_relu", fuse_relu, &fused_node);
+  AddNodeInput(matmul_node.input(0), &fused_node);
+  AddNodeInput(matmul_node.input(1), &fused_node);
+  AddNodeInput(bias_node.name(), &fused_node);
+  for (int i = 2; i < matmul_node.input_size(); ++i) {
+    AddNodeInput(matmul_node.input(i), &fused_node);
+    if (i == 5) {
+      AddNodeInput(min_node.name(), &fused_node);
+      AddNodeInput(max_node.name(), &fused_node);
+    }
+  }
+  new_nodes->push_back(fused_node);
+}
+
+// Returns whether a QuantizedMatMul can be folded into a following
+// requantization to eight bits.
+bool CanFuseQuantizedMatMul(const NodeDef& matmul_node,
+                            const NodeDef& requantize_node) {
+  return matmul_node.input_size() >= 6 &&
+         TypeAttrOrDefault(matmul_node, "T1", DT_INVALID) == DT_QUINT8 &&
+         TypeAttrOrDefault(matmul_node, "T2", DT_INVALID) == DT_QUINT8 &&
+         TypeAttrOrDefault(matmul_node, "Toutput", DT_QINT32) == DT_QINT32 &&
+         TypeAttrOrDefault(requantize_node, "out_type", DT_INVALID) ==
+             DT_QUINT8;
+}
+
+}  // namespace
+
+// A QuantizedMatMul whose 32-bit result is requantized into a constant range,
+// either because of a trained FakeQuant or after freeze_requantization_ranges,
+// can be computed by QuantizedMatMulWithBiasAndRequantize. That op requantizes
+// in the output stage of the GEMM instead of writing out and re-reading the
+// 32-bit result, and can also absorb a following QuantizedRelu.
+Status FuseQuantizedMatMulRequantizes(const GraphDef& input_graph_def,
+                                      const TransformFuncContext& context,
+                                      GraphDef* output_graph_def) {
+  GraphDef relu_fused_graph_def;
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      input_graph_def,  // clang-format off
+      {"QuantizedRelu",
+        {
+          {"Requantize",
+            {
+              {"QuantizedMatMul"},
+              {"QuantizedMatMul"},
+              {"QuantizedMatMul"},
+              {"Const"},
+              {"Const"},
+            }
+          },
+          {"Requantize"},
+          {"Requantize"},
+        }
+      },  // clang-format on
+      [](const NodeMatch& match, const std::set<string>& input_nodes,
+         const std::set<string>& output_nodes,
+         std::vector<NodeDef>* new_nodes) {
+        const NodeDef& relu_node = match.node;
+        const NodeDef& requantize_node = match.inputs[0].node;
+        const NodeDef& matmul_node = match.inputs[0].inputs[0].node;
+        if (!CanFuseQuantizedMatMul(matmul_node, requantize_node) ||
+            TypeAttrOrDefault(relu_node, "out_type", DT_QUINT8) != DT_QUINT8 ||
+            output_nodes.count(requantize_node.name()) ||
+            output_nodes.count(matmul_node.name())) {
+          CopyOriginalMatch(match, new_nodes);
+          return Status::OK();
+        }
+        AddFusedQuantizedMatMul(relu_node.name(), matmul_node,
+                                match.inputs[0].inputs[3].node,
+                                match.inputs[0].inputs[4].node, true,
+                                new_nodes);
+        return Status::OK();
+      },
+      {}, &relu_fused_graph_def));
+
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      relu_fused_graph_def,  // clang-format off
+      {"Requantize",
+        {
+          {"QuantizedMatMul"},
+          {"QuantizedMatMul"},
+          {"QuantizedMatMul"},
+          {"Const"},
+          {"Const"},
+        }
+      },  // clang-format on
+      [](const NodeMatch& match, const std::set<string>& input_nodes,
+         const std::set<string>& output_nodes,
+         std::vector<NodeDef>* new_nodes) {
+        const NodeDef& requantize_node = match.node;
+        const NodeDef& matmul_node = match.inputs[0].node;
+        if (!CanFuseQuantizedMatMul(matmul_node, requantize_node) ||
+            output_nodes.count(matmul_node.name())) {
+          CopyOriginalMatch(match, new_nodes);
+          return Status::OK();
+        }
+        AddFusedQuantizedMatMul(requantize_node.name(), matmul_node,
+                                match.inputs[3].node, match.inputs[4].node,
+                                false, new_nodes);
+        return Status::OK();
+      },
+      {}, output_graph_def));
+
+  return Status::OK();
+}
+
 // Sometimes FakeQuantWithMinMaxVars ops are added at the end of a chain of
 // linear ops like Relu, MaxPool, etc, several steps from the Conv2D or BiasAdd
 // op that we want to apply the trained constant conversions to. This pass tries
@@ -941,11 +1081,18 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
                                               &merged_graph_def));
   TF_RETURN_IF_ERROR(IsGraphValid(merged_graph_def));
 
+  // Where the trained range of a matmul is now known, fold the requantization
+  // into the matmul itself.
+  GraphDef fused_graph_def;
+  TF_RETURN_IF_ERROR(FuseQuantizedMatMulRequantizes(merged_graph_def, context,
+                                                    &fused_graph_def));
+  TF_RETURN_IF_ERROR(IsGraphValid(fused_graph_def));
+
   // There can be duplicate quantize nodes if multiple ops pull from a single
   // input, which makes it harder to remove redundant ones, so strip them out.
   GraphDef deduped_graph_def;
   TF_RETURN_IF_ERROR(
-      MergeDuplicateNodes(merged_graph_def, context, &deduped_graph_def));
+      MergeDuplicateNodes(fused_graph_def, context, &deduped_graph_def));
   TF_RETURN_IF_ERROR(IsGraphValid(deduped_graph_def));
 
   // Look for Dequantizes that immediately go into Quantizes, and remove them
@@ -963,5 +1110,8 @@ REGISTER_GRAPH_TRANSFORM("quantize_nodes", QuantizeNodes);
 
 REGISTER_GRAPH_TRANSFORM("merge_duplicate_nodes", MergeDuplicateNodes);
 
+REGISTER_GRAPH_TRANSFORM("fuse_quantized_matmul_requantizes",
+                         FuseQuantizedMatMulRequantizes);
+
 }  // namespace graph_transforms
 }  // namespace tensorflow
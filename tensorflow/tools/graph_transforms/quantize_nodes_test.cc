@@ -53,6 +53,9 @@ Status HoistFakeQuants(const GraphDef& input_graph_def,
 Status MergeDuplicateNodes(const GraphDef& input_graph_def,
                            const TransformFuncContext& context,
                            GraphDef* output_graph_def);
+Status FuseQuantizedMatMulRequantizes(const GraphDef& input_graph_def,
+                                      const TransformFuncContext& context,
+                                      GraphDef* output_graph_def);
 
 class QuantizeNodesTest : public ::testing::Test {
  protected:
@@ -1073,6 +1076,94 @@ class QuantizeNodesTest : public ::testing::Test {
     EXPECT_EQ(1, requantize_count);
   }
 
+  void TestFuseQuantizedMatMulEndToEnd() {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor a_tensor(DT_FLOAT, TensorShape({2, 3}));
+    test::FillIota<float>(&a_tensor, 1);
+    Output a_op = Const(root.WithOpName("a_op"), Input::Initializer(a_tensor));
+
+    Tensor b_tensor(DT_FLOAT, TensorShape({3, 2}));
+    test::FillIota<float>(&b_tensor, 1);
+    Output b_op = Const(root.WithOpName("b_op"), Input::Initializer(b_tensor));
+
+    Output mat_mul_op = MatMul(root.WithOpName("mat_mul_op"), a_op, b_op);
+
+    Tensor fake_quant_min_tensor(DT_FLOAT, TensorShape({}));
+    test::FillValues<float>(&fake_quant_min_tensor, {0.0f});
+    Output fake_quant_min_op = Const(root.WithOpName("fake_quant_min_op"),
+                                     Input::Initializer(fake_quant_min_tensor));
+
+    Tensor fake_quant_max_tensor(DT_FLOAT, TensorShape({}));
+    test::FillValues<float>(&fake_quant_max_tensor, {70.0f});
+    Output fake_quant_max_op = Const(root.WithOpName("fake_quant_max_op"),
+                                     Input::Initializer(fake_quant_max_tensor));
+
+    Output fake_quant_op =
+        FakeQuantWithMinMaxVars(root.WithOpName("fake_quant_op"), mat_mul_op,
+                                fake_quant_min_op, fake_quant_max_op);
+
+    GraphDef float_graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&float_graph_def));
+
+    GraphDef converted_graph_def;
+    TestTransformedVersusFloatGraph(QuantizeNodes, float_graph_def, {}, {},
+                                    {"fake_quant_op"}, {}, 2.0,
+                                    &converted_graph_def);
+
+    int fused_count = 0;
+    for (const NodeDef& node : converted_graph_def.node()) {
+      EXPECT_NE("QuantizedMatMul", node.op());
+      EXPECT_NE("Requantize", node.op());
+      if (node.op() == "QuantizedMatMulWithBiasAndRequantize") {
+        ++fused_count;
+      }
+    }
+    EXPECT_EQ(1, fused_count);
+  }
+
+  void TestFuseQuantizedMatMulRequantizesKeepsSharedMatMul() {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor a_tensor(DT_QUINT8, TensorShape({1, 2}));
+    test::FillValues<quint8>(&a_tensor, {1, 2});
+    Output a_op = Const(root.WithOpName("a_op"), Input::Initializer(a_tensor));
+    Tensor b_tensor(DT_QUINT8, TensorShape({2, 1}));
+    test::FillValues<quint8>(&b_tensor, {3, 4});
+    Output b_op = Const(root.WithOpName("b_op"), Input::Initializer(b_tensor));
+    Output min_op = Const(root.WithOpName("min_op"), 0.0f);
+    Output max_op = Const(root.WithOpName("max_op"), 255.0f);
+
+    QuantizedMatMul mat_mul_op(root.WithOpName("mat_mul_op"), a_op, b_op,
+                               min_op, max_op, min_op, max_op);
+    Output requested_min_op = Const(root.WithOpName("requested_min_op"), 0.0f);
+    Output requested_max_op =
+        Const(root.WithOpName("requested_max_op"), 100.0f);
+    Requantize requantize_op(root.WithOpName("requantize_op"), mat_mul_op.out,
+                             mat_mul_op.min_out, mat_mul_op.max_out,
+                             requested_min_op, requested_max_op, DT_QUINT8);
+    // A second consumer of the 32-bit result prevents the fusion.
+    Dequantize dequantize_op(root.WithOpName("dequantize_op"), mat_mul_op.out,
+                             mat_mul_op.min_out, mat_mul_op.max_out);
+
+    GraphDef graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+    TransformFuncContext context;
+    context.output_names = {"requantize_op", "dequantize_op"};
+    GraphDef fused_graph_def;
+    TF_ASSERT_OK(
+        FuseQuantizedMatMulRequantizes(graph_def, context, &fused_graph_def));
+
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(fused_graph_def, &node_map);
+    ASSERT_EQ(1, node_map.count("mat_mul_op"));
+    EXPECT_EQ("QuantizedMatMul", node_map["mat_mul_op"]->op());
+    ASSERT_EQ(1, node_map.count("requantize_op"));
+    EXPECT_EQ("Requantize", node_map["requantize_op"]->op());
+  }
+
   void TestHoistFakeQuants() {
     auto root = tensorflow::Scope::NewRootScope();
     using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
@@ -1509,6 +1600,15 @@ TEST_F(QuantizeNodesTest, TestConvertFakeQuantsEndToEnd) {
   TestConvertFakeQuantsEndToEnd();
 }
 
+TEST_F(QuantizeNodesTest, TestFuseQuantizedMatMulEndToEnd) {
+  TestFuseQuantizedMatMulEndToEnd();
+}
+
+TEST_F(QuantizeNodesTest,
+       TestFuseQuantizedMatMulRequantizesKeepsSharedMatMul) {
+  TestFuseQuantizedMatMulRequantizesKeepsSharedMatMul();
+}
+
 TEST_F(QuantizeNodesTest, TestHoistFakeQuants) { TestHoistFakeQuants(); }
 
 TEST_F(QuantizeNodesTest, TestMergeDuplicateQuantizes) {